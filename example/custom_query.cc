@@ -67,7 +67,7 @@ int main(int argc, char *argv[])
   for (const auto &message : batch)
   {
     std::cout << message.TimeReceived().count()
-              << ": '" << message.Data() << "'\n";
+              << ": '" << message.DataView() << "'\n";
   }
 
   return 0;
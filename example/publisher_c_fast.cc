@@ -78,12 +78,17 @@ int main(int argc, char **argv)
   // Serialize the message.
   msgRed.SerializeToArray(bufferRed, sizeRed);
 
+  // Advertise once, so the topic isn't looked up for every message.
+  GzTransportPublisher *pub = gzTransportAdvertisePublisher(node, topic,
+      msg.GetTypeName().c_str());
+  GzTransportPublisher *pubRed = gzTransportAdvertisePublisher(nodeRed, topic,
+      msgRed.GetTypeName().c_str());
+
   // Publish messages as fast as possible.
   while (!g_terminatePub)
   {
-    gzTransportPublish(node, topic, buffer, msg.GetTypeName().c_str());
-    gzTransportPublish(nodeRed, topic, bufferRed,
-        msgRed.GetTypeName().c_str());
+    gzTransportPublishBuffer(node, pub, buffer, size);
+    gzTransportPublishBuffer(nodeRed, pubRed, bufferRed, sizeRed);
 
     printf("Publishing hello on topic %s.\n", topic);
   }
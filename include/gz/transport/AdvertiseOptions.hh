@@ -18,9 +18,12 @@
 #ifndef GZ_TRANSPORT_ADVERTISEOPTIONS_HH_
 #define GZ_TRANSPORT_ADVERTISEOPTIONS_HH_
 
+#include <chrono>
 #include <cstdint>
 #include <iostream>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "gz/transport/config.hh"
 #include "gz/transport/Export.hh"
@@ -51,6 +54,46 @@ namespace gz
       ALL
     };
 
+    /// \brief This strongly typed enum defines the codecs used to compress
+    /// the messages sent to remote subscribers.
+    enum class Compression_t
+    {
+      /// \brief Messages are not compressed (default).
+      NONE,
+      /// \brief LZ4, fast with a moderate compression ratio.
+      LZ4,
+      /// \brief Zstandard, higher compression ratio at a higher cost.
+      ZSTD
+    };
+
+    /// \brief This strongly typed enum defines the priority classes of the
+    /// traffic of a topic/service, see AdvertiseOptions::SetPriority().
+    enum class Priority_t
+    {
+      /// \brief Latency-sensitive traffic, e.g.: commands.
+      CONTROL,
+      /// \brief Default priority.
+      NORMAL,
+      /// \brief Bulk data that can wait, e.g.: point clouds or telemetry.
+      BULK
+    };
+
+    /// \brief This strongly typed enum defines how the large serialization
+    /// buffers of a publisher are backed by huge pages, see
+    /// AdvertiseMessageOptions::SetHugePages().
+    enum class HugePages_t
+    {
+      /// \brief Regular pages (default).
+      NONE,
+      /// \brief Transparent huge pages, requested with madvise(). The
+      /// kernel backs the buffers with huge pages when it can.
+      TRANSPARENT,
+      /// \brief Huge pages reserved by the administrator, e.g. with
+      /// vm.nr_hugepages. Transparent huge pages are used when none is
+      /// left.
+      EXPLICIT
+    };
+
     /// \class AdvertiseOptions AdvertiseOptions.hh
     /// gz/transport/AdvertiseOptions.hh
     /// \brief A class for customizing the publication options for a topic or
@@ -99,6 +142,10 @@ namespace gz
           _out << "Host" << std::endl;
         else
           _out << "All" << std::endl;
+        if (_other.Priority() == Priority_t::CONTROL)
+          _out << "\tPriority: Control" << std::endl;
+        else if (_other.Priority() == Priority_t::BULK)
+          _out << "\tPriority: Bulk" << std::endl;
         return _out;
       }
 
@@ -114,6 +161,27 @@ namespace gz
       /// \sa Scope_t.
       public: void SetScope(const Scope_t &_scope);
 
+      /// \brief Get the priority class of the topic or service.
+      /// \return The priority.
+      /// \sa SetPriority
+      public: Priority_t Priority() const;
+
+      /// \brief Set the priority class of the topic or service, so the
+      /// latency-sensitive traffic doesn't wait behind bulk data:
+      /// * The messages of a topic with a CONTROL or BULK priority are sent
+      ///   through a publisher socket shared by the topics of the priority,
+      ///   unless AdvertiseMessageOptions::SetChannel() selects another one.
+      ///   The socket marks its TCP traffic with the DSCP of the priority,
+      ///   see GZ_TRANSPORT_DSCP.
+      /// * The subscribers run the callbacks of the CONTROL messages first,
+      ///   and those of the BULK messages last.
+      /// * The requests of a service run by the service threads (see
+      ///   AdvertiseServiceOptions::SetConcurrency()) are started in order of
+      ///   priority.
+      /// The default value is Priority_t::NORMAL.
+      /// \param[in] _priority The priority.
+      public: void SetPriority(const Priority_t _priority);
+
 #ifdef _WIN32
 // Disable warning C4251 which is triggered by
 // std::unique_ptr
@@ -177,6 +245,76 @@ namespace gz
         else
           _out << "\tThrottled? No" << std::endl;
 
+        if (_other.RateLimited())
+        {
+          _out << "\tRate limit: " << _other.RateLimitMsgsPerSec()
+               << " msgs/sec, " << _other.RateLimitBytesPerSec()
+               << " bytes/sec, burst " << _other.RateLimitBurstMsgs()
+               << " msgs, " << _other.RateLimitBurstBytes() << " bytes"
+               << std::endl;
+        }
+
+        if (_other.BufferPoolSize() > 0)
+        {
+          _out << "\tBuffer pool: " << _other.BufferPoolSize() << " bytes"
+               << std::endl;
+        }
+
+        if (_other.HugePages() != HugePages_t::NONE)
+        {
+          _out << "\tHuge pages: "
+               << (_other.HugePages() == HugePages_t::EXPLICIT ?
+                   "explicit" : "transparent")
+               << ", from " << _other.HugePagesMinSize() << " bytes"
+               << std::endl;
+        }
+
+        if (_other.Batched())
+        {
+          _out << "\tBatching: " << _other.BatchDelay() << " us, "
+               << _other.BatchSize() << " bytes" << std::endl;
+        }
+
+        if (_other.Compression() != Compression_t::NONE)
+        {
+          _out << "\tCompression: "
+               << (_other.Compression() == Compression_t::LZ4 ?
+                   "LZ4" : "ZSTD")
+               << ", level " << _other.CompressionLevel()
+               << ", " << _other.CompressionMinSize() << " bytes"
+               << std::endl;
+        }
+
+        if (!_other.Channel().empty())
+          _out << "\tChannel: " << _other.Channel() << std::endl;
+
+        if (_other.SlowSubscriberThrottled())
+        {
+          _out << "\tSlow subscriber rate: "
+               << _other.SlowSubscriberMsgsPerSec() << " msgs/s" << std::endl;
+        }
+
+        if (_other.Reliable())
+        {
+          _out << "\tReliable: history of " << _other.HistorySize()
+               << " msgs" << std::endl;
+        }
+
+        if (_other.HistoryDepth() > 0)
+        {
+          _out << "\tHistory depth: " << _other.HistoryDepth() << " msgs"
+               << std::endl;
+        }
+
+        if (!_other.MulticastGroup().empty())
+          _out << "\tMulticast: " << _other.MulticastGroup() << std::endl;
+
+        if (!_other.Interface().empty())
+          _out << "\tInterface: " << _other.Interface() << std::endl;
+
+        for (const std::string &alias : _other.Aliases())
+          _out << "\tAlias: " << alias << std::endl;
+
         return _out;
       }
 
@@ -197,6 +335,314 @@ namespace gz
       /// \param[in] _newMsgsPerSec Maximum number of messages per second.
       public: void SetMsgsPerSec(const uint64_t _newMsgsPerSec);
 
+      /// \brief Whether the publication is limited by a token bucket.
+      /// \return True if a rate limit is set.
+      /// \sa SetRateLimit
+      public: bool RateLimited() const;
+
+      /// \brief Get the average number of messages per second allowed by
+      /// the rate limit.
+      /// \return The rate, 0 if the messages are not limited.
+      /// \sa SetRateLimit
+      public: uint64_t RateLimitMsgsPerSec() const;
+
+      /// \brief Get the average number of bytes per second allowed by the
+      /// rate limit.
+      /// \return The rate, 0 if the bytes are not limited.
+      /// \sa SetRateLimit
+      public: uint64_t RateLimitBytesPerSec() const;
+
+      /// \brief Get the number of messages that can be published at once
+      /// after an idle period.
+      /// \return The size of the message bucket.
+      /// \sa SetRateLimit
+      public: uint64_t RateLimitBurstMsgs() const;
+
+      /// \brief Get the number of bytes that can be published at once after
+      /// an idle period.
+      /// \return The size of the byte bucket.
+      /// \sa SetRateLimit
+      public: uint64_t RateLimitBurstBytes() const;
+
+      /// \brief Limit the publication with token buckets, by messages and
+      /// by bytes per second. Unlike SetMsgsPerSec(), a burst of messages
+      /// is published as long as the buckets hold enough tokens, and the
+      /// buckets refill at the given rates, so a topic gets a share of the
+      /// bandwidth of a link without losing its occasional bursts. A message
+      /// bigger than the byte bucket is published when the bucket is full,
+      /// and delays the following ones until the bucket has refilled. The
+      /// messages beyond the limit are discarded, like with SetMsgsPerSec().
+      /// This option is local to the publisher and it is not shared with
+      /// remote nodes.
+      /// \param[in] _msgsPerSec Average number of messages per second, 0 for
+      /// no limit.
+      /// \param[in] _bytesPerSec Average number of bytes per second of
+      /// serialized messages, 0 for no limit.
+      /// \param[in] _burstMsgs Size of the message bucket, 0 for one second
+      /// of messages.
+      /// \param[in] _burstBytes Size of the byte bucket, 0 for one second of
+      /// bytes.
+      public: void SetRateLimit(const uint64_t _msgsPerSec,
+                                const uint64_t _bytesPerSec,
+                                const uint64_t _burstMsgs = 0,
+                                const uint64_t _burstBytes = 0);
+
+      /// \brief Get the maximum amount of memory cached by the pool of
+      /// serialization buffers of the publisher.
+      /// \return The maximum amount of memory (bytes). A value of 0 means
+      /// that the pool is disabled.
+      /// \sa SetBufferPoolSize
+      public: uint64_t BufferPoolSize() const;
+
+      /// \brief Set the maximum amount of memory cached by the pool of
+      /// serialization buffers of the publisher. Buffers are recycled once
+      /// the message has been delivered to all raw and remote subscribers,
+      /// avoiding an allocation per publication. The default value is 0,
+      /// which disables the pool. This option is local to the publisher and
+      /// it is not shared with remote nodes.
+      /// \param[in] _bytes Maximum amount of memory (bytes).
+      public: void SetBufferPoolSize(const uint64_t _bytes);
+
+      /// \brief Get how the large serialization buffers are backed by huge
+      /// pages.
+      /// \return The kind of huge pages.
+      /// \sa SetHugePages
+      public: HugePages_t HugePages() const;
+
+      /// \brief Get the size of the smallest buffer backed by huge pages.
+      /// \return The size (bytes).
+      /// \sa SetHugePages
+      public: uint64_t HugePagesMinSize() const;
+
+      /// \brief Back the serialization buffers of large messages with huge
+      /// pages (Linux only). A 10 MB message touches 5 huge pages instead of
+      /// 2560 regular ones, which saves the page faults of a new buffer and
+      /// the TLB misses of its copies. Combine it with SetBufferPoolSize()
+      /// so that the buffers are reused. The faults saved are reported by
+      /// Node::Publisher::HugePageFaultsSaved() and by the metrics. This
+      /// option is local to the publisher and it is not shared with remote
+      /// nodes.
+      /// \param[in] _mode The kind of huge pages, NONE by default.
+      /// \param[in] _minSize Size of the smallest buffer backed by huge
+      /// pages (bytes). The default is one huge page, 2 MB.
+      public: void SetHugePages(const HugePages_t _mode,
+                                const uint64_t _minSize = 2u << 20);
+
+      /// \brief Whether the messages sent to remote subscribers are batched.
+      /// \return True if batching is enabled.
+      /// \sa SetBatchDelay
+      public: bool Batched() const;
+
+      /// \brief Get the maximum time that a message waits in a batch.
+      /// \return The maximum delay (microseconds). A value of 0 means that
+      /// batching is disabled.
+      /// \sa SetBatchDelay
+      public: uint64_t BatchDelay() const;
+
+      /// \brief Set the maximum time that a message waits in a batch.
+      /// When enabled, the messages sent to remote subscribers are buffered
+      /// and sent together as a single message once the batch is older than
+      /// this delay or bigger than BatchSize(). This trades latency for a
+      /// much higher rate of small messages. The subscribers receive the
+      /// messages one by one as usual. The default value is 0, which
+      /// disables batching. This option is local to the publisher and it is
+      /// not shared with remote nodes.
+      /// \param[in] _usec Maximum delay (microseconds).
+      public: void SetBatchDelay(const uint64_t _usec);
+
+      /// \brief Get the size that triggers sending a batch.
+      /// \return The size (bytes).
+      /// \sa SetBatchSize
+      public: uint64_t BatchSize() const;
+
+      /// \brief Set the size that triggers sending a batch, before the
+      /// batch delay has expired. Messages bigger than this size are not
+      /// batched. The default value is 65536 bytes.
+      /// \param[in] _bytes Size (bytes).
+      /// \sa SetBatchDelay
+      public: void SetBatchSize(const uint64_t _bytes);
+
+      /// \brief Get the codec used to compress the messages sent to remote
+      /// subscribers.
+      /// \return The codec.
+      /// \sa SetCompression
+      public: Compression_t Compression() const;
+
+      /// \brief Get the compression level.
+      /// \return The level. A value of 0 means the default of the codec.
+      /// \sa SetCompression
+      public: int CompressionLevel() const;
+
+      /// \brief Get the size of the smallest message compressed.
+      /// \return The size (bytes).
+      /// \sa SetCompression
+      public: uint64_t CompressionMinSize() const;
+
+      /// \brief Compress the messages sent to remote subscribers. Messages
+      /// smaller than _minSize, or that don't become smaller, are sent
+      /// uncompressed so small latency-critical messages are unaffected.
+      /// Compressed messages are never batched. The subscribers decompress
+      /// the messages transparently. If the codec is not available in this
+      /// build, the messages are sent uncompressed. This option is local to
+      /// the publisher and it is not shared with remote nodes.
+      /// \param[in] _codec The codec. The default is Compression_t::NONE.
+      /// \param[in] _level Compression level, 0 for the default of the
+      /// codec. Levels above 0 select the high compression mode of LZ4.
+      /// \param[in] _minSize Size of the smallest message compressed
+      /// (bytes).
+      public: void SetCompression(const Compression_t _codec,
+                                  const int _level = 0,
+                                  const uint64_t _minSize = 4096);
+
+      /// \brief Get the publisher channel of the topic.
+      /// \return The name of the channel, empty for the shared socket.
+      /// \sa SetChannel
+      public: std::string Channel() const;
+
+      /// \brief Send the messages to remote subscribers through a dedicated
+      /// publisher socket, with its own endpoint, queues and high water
+      /// mark. By default, all the topics of a process share one socket, so
+      /// a small message published after a large one waits until the large
+      /// one has been sent. Topics advertised with the same channel share
+      /// its socket, e.g. "bulk" for point clouds and images, or "control"
+      /// for latency-sensitive commands. The socket is created when the
+      /// first topic of the channel is advertised and its endpoint is
+      /// advertised through discovery. The messages of a channel are not
+      /// sent through the IPC endpoints or the shared memory transport.
+      /// The default value is empty, which uses the shared socket.
+      /// \param[in] _channel Name of the channel.
+      public: void SetChannel(const std::string &_channel);
+
+      /// \brief Whether the rate of the remote messages is reduced while a
+      /// subscriber is slow.
+      /// \return True if SetSlowSubscriberMsgsPerSec() set a rate.
+      public: bool SlowSubscriberThrottled() const;
+
+      /// \brief Get the rate of the remote messages while a subscriber is
+      /// slow.
+      /// \return The maximum number of messages per second, kUnthrottled if
+      /// the rate isn't reduced.
+      /// \sa SetSlowSubscriberMsgsPerSec
+      public: uint64_t SlowSubscriberMsgsPerSec() const;
+
+      /// \brief Reduce the rate of the messages sent to the remote
+      /// subscribers while one of the subscribers connected to the socket of
+      /// the topic is slow, see GZ_TRANSPORT_SLOW_SUBSCRIBER. The messages
+      /// skipped are conflated: the next one sent is the latest. ZMQ can't
+      /// send at a different rate to each subscriber of a socket, use
+      /// SetChannel() to keep a slow subscriber of another topic from
+      /// degrading this one. The local subscribers aren't affected. The
+      /// default value is kUnthrottled.
+      /// \param[in] _msgsPerSec Maximum number of messages per second.
+      public: void SetSlowSubscriberMsgsPerSec(const uint64_t _msgsPerSec);
+
+      /// \brief Whether the gaps in the publications are reported to the
+      /// subscribers.
+      /// \return True if the reliable mode is enabled.
+      /// \sa SetReliable
+      public: bool Reliable() const;
+
+      /// \brief Report the messages lost on the way to remote subscribers.
+      /// ZMQ silently drops the publications beyond its high water mark,
+      /// which is unacceptable for topics of events. In reliable mode,
+      /// every message sent to remote subscribers carries its sequence
+      /// number, even if the topic statistics are disabled, and the
+      /// subscribers report the messages missed before each one with
+      /// MessageInfo::SequenceGap(). Reliable messages are never batched.
+      /// See SetHistorySize() to retransmit the missing messages. The
+      /// default value is false.
+      /// \param[in] _reliable True to enable the reliable mode.
+      public: void SetReliable(const bool _reliable);
+
+      /// \brief Get the number of messages kept for retransmission.
+      /// \return The number of messages. A value of 0 means that the
+      /// missing messages are only reported.
+      /// \sa SetHistorySize
+      public: uint64_t HistorySize() const;
+
+      /// \brief Keep the last messages sent to remote subscribers, so a
+      /// subscriber can ask for the ones it has missed. When a subscriber
+      /// detects a gap, it requests the missing messages and receives the
+      /// ones still in the history after the message that revealed the gap,
+      /// flagged by MessageInfo::Retransmitted(). A value above 0 enables
+      /// the reliable mode, see SetReliable(). The default value is 0.
+      /// \param[in] _msgs Number of messages kept.
+      public: void SetHistorySize(const uint64_t _msgs);
+
+      /// \brief Get the number of messages delivered to the late joiners.
+      /// \return The number of messages. A value of 0 means that the new
+      /// subscribers only receive the next messages published.
+      /// \sa SetHistoryDepth
+      public: uint64_t HistoryDepth() const;
+
+      /// \brief Keep the last messages published, serialized, and deliver
+      /// them to every new subscriber, like a "latched" or transient-local
+      /// topic. The subscribers in other processes ask for them once they
+      /// are connected, the ones in this process receive them when they
+      /// subscribe. This is meant for topics published at a low rate, e.g.
+      /// configurations, that don't need to be republished periodically
+      /// for the late joiners. Unlike SetHistorySize(), the messages are
+      /// kept even if nobody subscribes. The default value is 0.
+      /// \param[in] _msgs Number of messages kept.
+      public: void SetHistoryDepth(const uint64_t _msgs);
+
+      /// \brief Get the multicast group of the topic.
+      /// \return The group, empty for unicast.
+      /// \sa SetMulticastGroup
+      public: std::string MulticastGroup() const;
+
+      /// \brief Send the messages to the subscribers of other hosts through
+      /// a multicast group instead of one TCP connection per subscriber, for
+      /// topics with many remote subscribers, e.g. sensor streams, where the
+      /// publisher would otherwise copy every message to each of them. The
+      /// messages are sent once with PGM over UDP (ZMQ "epgm" transport),
+      /// through a channel of the group that replaces the one of
+      /// SetChannel(), and the subscribers on the same host keep receiving
+      /// them through TCP.
+      /// PGM doesn't retransmit beyond its window, so this is meant for
+      /// streams tolerating losses. If ZMQ is built without PGM support,
+      /// the messages are only sent through TCP. The transfer rate is
+      /// limited by GZ_TRANSPORT_MULTICAST_RATE. The default value is
+      /// empty, which disables multicast.
+      /// \param[in] _group Multicast group and port, e.g.
+      /// "239.255.0.8:5555".
+      public: void SetMulticastGroup(const std::string &_group);
+
+      /// \brief Get the network interface of the topic.
+      /// \return The IP address of the interface, empty for the interface
+      /// of the node.
+      /// \sa SetInterface
+      public: std::string Interface() const;
+
+      /// \brief Send the messages through the network interface with a
+      /// given address, e.g. a dedicated high bandwidth sensor network, so
+      /// they don't cross the link selected by GZ_IP for the discovery and
+      /// the other topics. The topic gets a publisher socket bound to this
+      /// interface, shared by the topics of its channel (see SetChannel())
+      /// on the same interface, and the subscribers connect to it from the
+      /// interface in its subnet. The default value is empty, which uses
+      /// NodeOptions::SetInterface(), or GZ_IP if it's empty too.
+      /// \param[in] _ip IP address of a local interface.
+      public: void SetInterface(const std::string &_ip);
+
+      /// \brief Get the aliases of the topic.
+      /// \return The names, in the order they were added.
+      /// \sa AddAlias
+      public: std::vector<std::string> Aliases() const;
+
+      /// \brief Advertise the topic under another name too, e.g. its legacy
+      /// name while the subscribers migrate to the new one, without a node
+      /// republishing the messages. The alias is resolved with the partition
+      /// and the namespace of the node, like the topic, and advertised
+      /// through discovery. The subscribers of the alias receive the
+      /// messages of the topic from the same connection and the same
+      /// dispatch as its subscribers, without any copy, with
+      /// MessageInfo::Topic() set to the topic. The publishers and the
+      /// subscribers of an alias must use this version of the transport.
+      /// \param[in] _alias Name of the alias.
+      /// \return False if the name isn't valid or is already an alias.
+      public: bool AddAlias(const std::string &_alias);
+
 #ifdef _WIN32
 // Disable warning C4251 which is triggered by
 // std::unique_ptr
@@ -251,9 +697,49 @@ namespace gz
                                           const AdvertiseServiceOptions &_other)
       {
         _out << static_cast<AdvertiseOptions>(_other);
+        if (_other.Concurrency() > 0)
+          _out << "\tConcurrency: " << _other.Concurrency() << std::endl;
+        if (_other.CacheTtl().count() > 0)
+        {
+          _out << "\tCache TTL: " << _other.CacheTtl().count() << " ms"
+               << std::endl;
+        }
         return _out;
       }
 
+      /// \brief Set the number of requests received from other processes
+      /// that can be processed at the same time. With a concurrency level of
+      /// zero (default), the callback runs on the thread receiving the
+      /// requests, so a slow service delays the other services and the topic
+      /// subscriptions of the process. Otherwise the requests are processed
+      /// by a pool of service threads, up to _concurrency at a time, and the
+      /// callback must be thread safe if _concurrency is greater than one.
+      /// \param[in] _concurrency The concurrency level.
+      public: void SetConcurrency(const uint32_t _concurrency);
+
+      /// \brief Get the number of requests that can be processed at the
+      /// same time.
+      /// \return The concurrency level, or zero if the requests are processed
+      /// by the thread receiving them.
+      /// \sa SetConcurrency
+      public: uint32_t Concurrency() const;
+
+      /// \brief Mark the service as cacheable: the responses depend only on
+      /// the requests, so a response can be reused for an identical request
+      /// (same serialized bytes) during _ttl instead of running the callback
+      /// again. The responses of the successful calls received from other
+      /// processes are cached by the responser and by the requesters, which
+      /// don't send the requests answered by their cache. The batches of
+      /// requests and the requests within the process aren't cached.
+      /// \param[in] _ttl Time to live of the responses cached. Zero
+      /// (default) disables the cache.
+      public: void SetCacheTtl(const std::chrono::milliseconds &_ttl);
+
+      /// \brief Get the time to live of the responses cached.
+      /// \return The time to live, zero if the service isn't cacheable.
+      /// \sa SetCacheTtl
+      public: std::chrono::milliseconds CacheTtl() const;
+
 #ifdef _WIN32
 // Disable warning C4251 which is triggered by
 // std::unique_ptr
@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GZ_TRANSPORT_ARENAPOOL_HH_
+#define GZ_TRANSPORT_ARENAPOOL_HH_
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable: 4251)
+#endif
+#include <google/protobuf/arena.h>
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+
+#include <cstddef>
+#include <memory>
+
+#include "gz/transport/config.hh"
+#include "gz/transport/Export.hh"
+
+namespace gz
+{
+  namespace transport
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace GZ_TRANSPORT_VERSION_NAMESPACE {
+    //
+    class ArenaPoolPrivate;
+
+    /// \class ArenaPool ArenaPool.hh gz/transport/ArenaPool.hh
+    /// \brief A pool of protobuf arenas used to deserialize the received
+    /// messages without allocating every nested message on the heap.
+    ///
+    /// An arena is handed out by Acquire() and recycled when the last
+    /// reference to it is released, so a message created on it can be shared
+    /// with any number of callbacks and threads. Each arena owns an initial
+    /// block that grows to fit the biggest message it has held, messages of
+    /// a similar size are then deserialized without any allocation.
+    ///
+    /// Example:
+    ///
+    ///    auto arena = pool.Acquire();
+    ///    auto *msg = google::protobuf::Arena::CreateMessage<T>(arena.get());
+    ///    msg->ParseFromArray(data, size);
+    ///    // Share the ownership of the arena with the message.
+    ///    std::shared_ptr<T> msgPtr(arena, msg);
+    class GZ_TRANSPORT_VISIBLE ArenaPool
+    {
+      /// \brief Constructor.
+      public: ArenaPool();
+
+      /// \brief Destructor. The arenas still in use are deleted when they
+      /// are released.
+      public: ~ArenaPool();
+
+      /// \brief Get an arena from the pool, or a new one if all the arenas
+      /// are in use. This function can be called from any thread.
+      /// \return The arena. It returns to the pool when the last copy of the
+      /// pointer is released, all the objects created on it are destroyed.
+      public: std::shared_ptr<google::protobuf::Arena> Acquire();
+
+      /// \brief Get the number of arenas waiting to be acquired.
+      /// \return The number of idle arenas.
+      public: std::size_t IdleCount() const;
+
+      /// \brief Maximum number of idle arenas kept in the pool.
+#ifdef GZ_TRANSPORT_EMBEDDED
+      public: inline static const std::size_t kMaxIdle = 2;
+#else
+      public: inline static const std::size_t kMaxIdle = 8;
+#endif
+
+      /// \brief Size of the initial block of a new arena (bytes).
+      public: inline static const std::size_t kMinBlockSize = 4096;
+
+      /// \brief Maximum size of the initial block of an arena (bytes).
+      /// Bigger messages use additional blocks allocated by the arena.
+      public: inline static const std::size_t kMaxBlockSize = 16 * 1024 * 1024;
+
+#ifdef _WIN32
+// Disable warning C4251 which is triggered by
+// std::shared_ptr
+#pragma warning(push)
+#pragma warning(disable: 4251)
+#endif
+      /// \internal
+      /// \brief Private data. It is shared with the arenas in use, which
+      /// might outlive the pool.
+      private: std::shared_ptr<ArenaPoolPrivate> dataPtr;
+#ifdef _WIN32
+#pragma warning(pop)
+#endif
+    };
+    }
+  }
+}
+#endif
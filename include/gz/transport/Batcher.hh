@@ -0,0 +1,240 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GZ_TRANSPORT_BATCHER_HH_
+#define GZ_TRANSPORT_BATCHER_HH_
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "gz/transport/config.hh"
+#include "gz/transport/MessageInfo.hh"
+#include "gz/transport/TransportTypes.hh"
+
+namespace gz
+{
+  namespace transport
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace GZ_TRANSPORT_VERSION_NAMESPACE {
+    //
+    /// \class Batcher Batcher.hh gz/transport/Batcher.hh
+    /// \brief Accumulates the messages of a topic and runs a callback with
+    /// each batch of messages. Node::SubscribeBatch() feeds it from a
+    /// subscription.
+    ///
+    /// A batch is delivered once it has the maximum number of messages, or
+    /// once its oldest message has waited for the maximum delay. The
+    /// messages are kept by shared ownership, they are never copied, and
+    /// the storage of the batches is reused.
+    ///
+    /// The messages can be added from any thread. The batches are delivered
+    /// one at a time, in order, without holding the lock protecting the
+    /// pending messages: a full batch in the thread adding its last
+    /// message, an expired batch in a thread of the batcher.
+    template <typename T> class Batcher
+    {
+      /// \brief A batch of messages, from the oldest to the newest.
+      public: using Batch = std::vector<std::shared_ptr<const T>>;
+
+      /// \brief Callback receiving each batch of messages.
+      public: using Callback = std::function<void(const Batch &)>;
+
+      /// \brief Constructor.
+      /// \param[in] _maxBatch Number of messages that triggers the delivery
+      /// of a batch, at least 1.
+      /// \param[in] _maxDelay Maximum time a message waits for the delivery
+      /// of its batch. Zero to only deliver the full batches.
+      /// \param[in] _cb Callback run with each batch.
+      public: Batcher(const std::size_t _maxBatch,
+                      const std::chrono::nanoseconds &_maxDelay,
+                      Callback _cb)
+        : state(std::make_shared<State>(std::max<std::size_t>(_maxBatch, 1u),
+            std::max(_maxDelay, std::chrono::nanoseconds::zero()),
+            std::move(_cb)))
+      {
+        if (this->state->maxDelay > std::chrono::nanoseconds::zero())
+          this->flushThread = std::thread(&State::FlushLoop, this->state);
+      }
+
+      /// \brief Destructor. The pending messages are discarded.
+      public: ~Batcher()
+      {
+        {
+          std::lock_guard<std::mutex> lk(this->state->mutex);
+          this->state->exit = true;
+        }
+        this->state->condition.notify_all();
+
+        if (!this->flushThread.joinable())
+          return;
+
+        // The last reference might be released by the callback, the flush
+        // thread keeps the state alive until it returns.
+        if (this->flushThread.get_id() == std::this_thread::get_id())
+          this->flushThread.detach();
+        else
+          this->flushThread.join();
+      }
+
+      /// \brief Add a message.
+      /// \param[in] _msg The message.
+      public: void Add(const std::shared_ptr<const T> &_msg)
+      {
+        State &s = *this->state;
+        std::unique_lock<std::mutex> lk(s.mutex);
+        if (s.pending.empty())
+        {
+          s.deadline = std::chrono::steady_clock::now() + s.maxDelay;
+          if (this->flushThread.joinable())
+            s.condition.notify_one();
+        }
+        s.pending.push_back(_msg);
+
+        if (s.pending.size() >= s.maxBatch)
+          s.Deliver(lk);
+      }
+
+      /// \brief Deliver the pending messages now, if any.
+      public: void Flush()
+      {
+        std::unique_lock<std::mutex> lk(this->state->mutex);
+        if (!this->state->pending.empty())
+          this->state->Deliver(lk);
+      }
+
+      /// \brief Get a subscription callback adding the messages of a topic
+      /// to a batcher.
+      /// \param[in] _batcher The batcher, kept alive by the callback.
+      /// \return The callback.
+      public: static SharedMsgCallback<T> Input(
+        const std::shared_ptr<Batcher> &_batcher)
+      {
+        return [_batcher](const std::shared_ptr<const T> &_msg,
+                          const MessageInfo &/*_info*/)
+        {
+          _batcher->Add(_msg);
+        };
+      }
+
+      /// \brief The state shared with the flush thread.
+      private: struct State
+      {
+        /// \brief Constructor.
+        /// \param[in] _maxBatch Number of messages that triggers the
+        /// delivery of a batch.
+        /// \param[in] _maxDelay Maximum time a message waits.
+        /// \param[in] _cb Callback run with each batch.
+        State(const std::size_t _maxBatch,
+              const std::chrono::nanoseconds &_maxDelay,
+              Callback _cb)
+          : maxBatch(_maxBatch),
+            maxDelay(_maxDelay),
+            cb(std::move(_cb))
+        {
+          this->pending.reserve(this->maxBatch);
+          this->delivered.reserve(this->maxBatch);
+        }
+
+        /// \brief Deliver the pending messages. The callback runs with the
+        /// delivery lock, so the batches are delivered in order.
+        /// \param[in, out] _lk Lock of the pending messages, released
+        /// while the callback runs.
+        void Deliver(std::unique_lock<std::mutex> &_lk)
+        {
+          std::unique_lock<std::mutex> deliveryLk(this->deliveryMutex);
+          this->delivered.swap(this->pending);
+          _lk.unlock();
+
+          this->cb(this->delivered);
+          this->delivered.clear();
+
+          // Never wait for the pending messages with the delivery lock.
+          deliveryLk.unlock();
+          _lk.lock();
+        }
+
+        /// \brief Deliver the batches once their delay has elapsed.
+        /// \param[in] _state The state, kept alive by the thread.
+        static void FlushLoop(std::shared_ptr<State> _state)
+        {
+          State &s = *_state;
+          std::unique_lock<std::mutex> lk(s.mutex);
+          while (!s.exit)
+          {
+            if (s.pending.empty())
+              s.condition.wait(lk);
+            else if (std::chrono::steady_clock::now() >= s.deadline)
+              s.Deliver(lk);
+            else
+              s.condition.wait_until(lk, s.deadline);
+          }
+        }
+
+        /// \brief Number of messages that triggers the delivery of a
+        /// batch.
+        const std::size_t maxBatch;
+
+        /// \brief Maximum time a message waits for its delivery.
+        const std::chrono::nanoseconds maxDelay;
+
+        /// \brief Callback run with each batch.
+        const Callback cb;
+
+        /// \brief Protects the pending messages, the deadline and the exit
+        /// flag.
+        std::mutex mutex;
+
+        /// \brief Serializes the deliveries and protects the batch being
+        /// delivered.
+        std::mutex deliveryMutex;
+
+        /// \brief Messages waiting for their delivery.
+        Batch pending;
+
+        /// \brief Batch being delivered. Its storage is reused.
+        Batch delivered;
+
+        /// \brief Time at which the pending messages must be delivered.
+        std::chrono::steady_clock::time_point deadline;
+
+        /// \brief Notifies the flush thread of a new batch or of the exit.
+        std::condition_variable condition;
+
+        /// \brief Set when the batcher is destroyed.
+        bool exit = false;
+      };
+
+      /// \brief The state shared with the flush thread.
+      private: std::shared_ptr<State> state;
+
+      /// \brief Thread delivering the expired batches. Only started if
+      /// there's a maximum delay.
+      private: std::thread flushThread;
+    };
+    }
+  }
+}
+#endif
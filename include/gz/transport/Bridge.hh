@@ -0,0 +1,217 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GZ_TRANSPORT_BRIDGE_HH_
+#define GZ_TRANSPORT_BRIDGE_HH_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gz/transport/AdvertiseOptions.hh"
+#include "gz/transport/config.hh"
+#include "gz/transport/Export.hh"
+#include "gz/transport/NodeOptions.hh"
+
+namespace gz
+{
+  namespace transport
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace GZ_TRANSPORT_VERSION_NAMESPACE {
+    //
+    // Forward declarations.
+    class BridgePrivate;
+
+    /// \brief How a topic is forwarded by a Bridge, see Bridge::AddTopic().
+    struct BridgeTopicOptions
+    {
+      /// \brief Maximum number of messages forwarded per second, 0 for no
+      /// limit. The messages above the rate are dropped.
+      uint64_t maxRate{0};
+
+      /// \brief Codec compressing the messages on the connection.
+      Compression_t compression{Compression_t::NONE};
+
+      /// \brief Compression level, 0 for the default of the codec.
+      int compressionLevel{0};
+
+      /// \brief Send a message equal to the previous one of the topic as a
+      /// short repeat frame. With a codec, a message of the same size as the
+      /// previous one is sent as its compressed difference with it, which
+      /// is small when only a few fields change.
+      bool deltaEncoding{true};
+    };
+
+    /// \brief Counters of a Bridge, see Bridge::Statistics().
+    struct BridgeStatistics
+    {
+      /// \brief Number of local messages sent to the remote bridge
+      uint64_t sentMessages{0};
+
+      /// \brief Size (bytes) of the local messages sent
+      uint64_t sentBytes{0};
+
+      /// \brief Bytes written on the connection, after the compression and
+      /// the delta encoding
+      uint64_t sentWireBytes{0};
+
+      /// \brief Number of messages sent as a repeat frame
+      uint64_t repeatedMessages{0};
+
+      /// \brief Number of messages sent as a difference with the previous
+      /// one
+      uint64_t deltaMessages{0};
+
+      /// \brief Number of local messages dropped because the connection was
+      /// down or too slow
+      uint64_t droppedMessages{0};
+
+      /// \brief Number of remote messages published locally
+      uint64_t receivedMessages{0};
+
+      /// \brief Bytes read from the connection
+      uint64_t receivedWireBytes{0};
+
+      /// \brief Number of times the connection was established
+      uint64_t connections{0};
+
+      /// \brief Number of connections dropped because the remote bridge
+      /// didn't authenticate
+      uint64_t rejectedConnections{0};
+    };
+
+    /// \class Bridge Bridge.hh gz/transport/Bridge.hh
+    /// \brief Forward topics to a remote bridge over a single TCP
+    /// connection, e.g. from a robot to the cloud, or between partitions.
+    /// Each bridge subscribes to the topics added with AddTopic() and sends
+    /// their messages to the other bridge, which advertises the topics and
+    /// publishes the messages in its own network and partition. Both ends
+    /// can forward topics, in both directions over the same connection.
+    ///
+    /// The topics are advertised to the remote bridge as soon as their
+    /// type is known, so the remote subscribers discover them through the
+    /// remote bridge without any discovery traffic crossing the link.
+    ///
+    /// One end listens (Listen()) and the other one connects (Connect()).
+    /// The connecting end reconnects after a failure. The messages received
+    /// while the connection is down are dropped.
+    ///
+    /// A bridge only listens on the loopback interface by default. Both
+    /// ends exchange their credentials when they connect (see
+    /// SetCredentials()) and drop a peer whose credentials differ, which is
+    /// required to listen on another interface. A bridge only advertises
+    /// the remote topics allowed with AllowRemoteTopic().
+    ///
+    /// \note The messages published within the process of a bridge on a
+    /// topic received from the remote bridge aren't forwarded, so that a
+    /// topic forwarded by both ends doesn't loop.
+    class GZ_TRANSPORT_VISIBLE Bridge
+    {
+      /// \brief Default TCP port of a bridge.
+      public: static const int kDefaultPort = 10321;
+
+      /// \brief Constructor.
+      /// \param[in] _options Options of the node subscribing to the local
+      /// topics and publishing the remote ones, e.g. its partition.
+      public: explicit Bridge(const NodeOptions &_options = NodeOptions());
+
+      /// \brief Destructor. It closes the connection.
+      public: ~Bridge();
+
+      /// \brief Wait for the remote bridge to connect.
+      /// \param[in] _port TCP port to listen on. Use 0 for an ephemeral port.
+      /// \param[in] _interface IPv4 address of the interface to listen on,
+      /// e.g. "0.0.0.0" for all of them. Any interface but the loopback
+      /// requires credentials.
+      /// \return True if the bridge is listening, false if it's already
+      /// running, the port is in use, the interface isn't valid or it
+      /// requires credentials.
+      public: bool Listen(const int _port = kDefaultPort,
+                          const std::string &_interface = "127.0.0.1");
+
+      /// \brief Connect to a remote bridge, and reconnect to it whenever the
+      /// connection fails.
+      /// \param[in] _host Host name or IP address of the remote bridge.
+      /// \param[in] _port TCP port of the remote bridge.
+      /// \return True if the bridge is connecting, false if it's already
+      /// running or the port isn't valid.
+      public: bool Connect(const std::string &_host,
+                           const int _port = kDefaultPort);
+
+      /// \brief Close the connection.
+      public: void Stop();
+
+      /// \brief Get the TCP port the bridge listens on.
+      /// \return The port, or 0 if the bridge isn't listening.
+      public: int Port() const;
+
+      /// \brief Whether the connection with the remote bridge is up.
+      /// \return True if connected.
+      public: bool Connected() const;
+
+      /// \brief Forward a local topic to the remote bridge.
+      /// \param[in] _topic The topic.
+      /// \param[in] _options How the messages are forwarded.
+      /// \return True if the topic is forwarded, false if it already is, the
+      /// codec isn't available or the subscription failed.
+      public: bool AddTopic(const std::string &_topic,
+          const BridgeTopicOptions &_options = BridgeTopicOptions());
+
+      /// \brief Accept a topic forwarded by the remote bridge. The topics
+      /// not allowed are neither advertised nor published.
+      /// \param[in] _topic The topic.
+      /// \return True if the topic is allowed, false if its name isn't
+      /// valid.
+      public: bool AllowRemoteTopic(const std::string &_topic);
+
+      /// \brief Set the credentials exchanged with the remote bridge, which
+      /// must have the same ones. The default ones are read from the
+      /// GZ_TRANSPORT_USERNAME and GZ_TRANSPORT_PASSWORD environment
+      /// variables. They are sent in clear text, like with the PLAIN
+      /// security of the nodes. Call it before Listen() or Connect().
+      /// \param[in] _username The username.
+      /// \param[in] _password The password.
+      public: void SetCredentials(const std::string &_username,
+                                  const std::string &_password);
+
+      /// \brief Get the topics forwarded by the remote bridge, and
+      /// advertised locally.
+      /// \return The topics.
+      public: std::vector<std::string> RemoteTopics() const;
+
+      /// \brief Get the counters of the bridge.
+      /// \return The counters, since the construction.
+      public: BridgeStatistics Statistics() const;
+
+#ifdef _WIN32
+// Disable warning C4251 which is triggered by
+// std::unique_ptr
+#pragma warning(push)
+#pragma warning(disable: 4251)
+#endif
+      /// \brief Private data pointer.
+      private: std::unique_ptr<BridgePrivate> dataPtr;
+#ifdef _WIN32
+#pragma warning(pop)
+#endif
+    };
+    }
+  }
+}
+#endif
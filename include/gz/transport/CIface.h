@@ -18,6 +18,8 @@
 #ifndef INCLUDE_GZ_TRANSPORT_CIFACE_H_
 #define INCLUDE_GZ_TRANSPORT_CIFACE_H_
 
+#include <stddef.h>
+
 #include "gz/transport/Export.hh"
 
 #ifdef __cplusplus
@@ -32,6 +34,9 @@ extern "C" {
   /// \brief A transport node.
   typedef struct GzTransportNode GzTransportNode;
 
+  /// \brief A publisher of a topic, see gzTransportAdvertisePublisher.
+  typedef struct GzTransportPublisher GzTransportPublisher;
+
   /// \brief Create a transport node.
   /// \param[in] _partition Optional name of the partition to use.
   /// Use nullptr to use the default value, which is specified via the
@@ -57,6 +62,18 @@ extern "C" {
                       const char *_msgType);
 
 
+  /// \brief Advertise a topic and get its publisher, to publish messages
+  /// with gzTransportPublishBuffer without looking up the topic every time.
+  /// \param[in] _node Pointer to a node.
+  /// \param[in] _topic Topic on which to publish the messages.
+  /// \param[in] _msgType Name of the message type.
+  /// \return The publisher or nullptr on error. It's owned by the node, do
+  /// not use it after gzTransportNodeDestroy.
+  GzTransportPublisher GZ_TRANSPORT_VISIBLE *gzTransportAdvertisePublisher(
+      GzTransportNode *_node,
+      const char *_topic,
+      const char *_msgType);
+
   /// \brief Publishes a message on a topic.
   /// \param[in] _node Pointer to a node.
   /// \param[in] _topic Topic on which to publish the message.
@@ -69,6 +86,41 @@ extern "C" {
                       const void *_data,
                       const char *_msgType);
 
+  /// \brief Publishes a serialized message of a given size, which may
+  /// contain null bytes. The message is copied once, the caller keeps the
+  /// ownership of _data.
+  /// \param[in] _node Pointer to a node.
+  /// \param[in] _pub Publisher returned by gzTransportAdvertisePublisher.
+  /// \param[in] _data Byte array of serialized data to publish.
+  /// \param[in] _size Size of _data (bytes).
+  /// \return 0 on success.
+  int GZ_TRANSPORT_VISIBLE
+  gzTransportPublishBuffer(GzTransportNode *_node,
+                           GzTransportPublisher *_pub,
+                           const void *_data,
+                           size_t _size);
+
+  /// \brief Publishes a serialized message without copying it. The
+  /// transport takes the ownership of _data and releases it with
+  /// _deallocator when it doesn't need it anymore, possibly from another
+  /// thread after this function returns. _deallocator is called even if the
+  /// publication fails.
+  /// \param[in] _node Pointer to a node.
+  /// \param[in] _pub Publisher returned by gzTransportAdvertisePublisher.
+  /// \param[in] _data Byte array of serialized data to publish.
+  /// \param[in] _size Size of _data (bytes).
+  /// \param[in] _deallocator Function called with _data and _hint to
+  /// release _data, or NULL if _data is never released.
+  /// \param[in] _hint Arbitrary user data pointer passed to _deallocator.
+  /// \return 0 on success.
+  int GZ_TRANSPORT_VISIBLE
+  gzTransportPublishBufferOwned(GzTransportNode *_node,
+                                GzTransportPublisher *_pub,
+                                void *_data,
+                                size_t _size,
+                                void (*_deallocator)(void *, void *),
+                                void *_hint);
+
   /// \brief Subscribe to a topic, and register a callback.
   /// \param[in] _node Pointer to a node.
   /// \param[in] _topic Name of the topic.
@@ -105,7 +157,61 @@ extern "C" {
                             void (*_callback)(char *, size_t, char *, void *),
                             void *_userData);
 
-  /// \brief Unsubscribe from a topic.
+  /// \brief Subscribe to a topic, and register a callback invoked by
+  /// gzTransportSpinOnce on the caller's thread instead of the thread of the
+  /// transport. This integrates the subscriptions with the event loop of
+  /// the caller, see gzTransportEventFd.
+  /// \param[in] _node Pointer to a node.
+  /// \param[in] _topic Name of the topic.
+  /// \param[in] _callback The function to call when a message is received.
+  /// \param[in] _userData Arbitrary user data pointer.
+  /// \return 0 on success.
+  int GZ_TRANSPORT_VISIBLE
+  gzTransportSubscribeDeferred(GzTransportNode *_node,
+                const char *_topic,
+                void (*_callback)(const char *, size_t, const char *, void *),
+                void *_userData);
+
+  /// \brief Get a file descriptor readable while messages of the deferred
+  /// subscriptions are waiting for gzTransportSpinOnce, to be watched with
+  /// poll(), select() or the event loop of the caller. Don't read from it or
+  /// close it, it's owned by the node.
+  /// \param[in] _node Pointer to a node.
+  /// \return The file descriptor, or -1 on error and on Windows, where
+  /// gzTransportSpinOnce has to be called periodically instead.
+  int GZ_TRANSPORT_VISIBLE
+  gzTransportEventFd(GzTransportNode *_node);
+
+  /// \brief Invoke the callbacks of the pending messages of the deferred
+  /// subscriptions on the caller's thread, oldest first. It doesn't wait
+  /// for messages.
+  /// \param[in] _node Pointer to a node.
+  /// \param[in] _maxMessages Maximum number of callbacks to invoke, 0 for
+  /// all the pending messages.
+  /// \return The number of callbacks invoked, or -1 on error.
+  int GZ_TRANSPORT_VISIBLE
+  gzTransportSpinOnce(GzTransportNode *_node, size_t _maxMessages);
+
+  /// \brief Set the maximum number of pending messages of the deferred
+  /// subscriptions. The oldest message is dropped when it's reached, see
+  /// gzTransportDroppedMessages. The default is 1000.
+  /// \param[in] _node Pointer to a node.
+  /// \param[in] _maxMessages Maximum number of pending messages, 0 for no
+  /// limit.
+  /// \return 0 on success.
+  int GZ_TRANSPORT_VISIBLE
+  gzTransportSetMaxDeferredMessages(GzTransportNode *_node,
+                                    size_t _maxMessages);
+
+  /// \brief Get the number of pending messages of the deferred
+  /// subscriptions dropped because the maximum was reached.
+  /// \param[in] _node Pointer to a node.
+  /// \return The number of dropped messages, or 0 on error.
+  size_t GZ_TRANSPORT_VISIBLE
+  gzTransportDroppedMessages(GzTransportNode *_node);
+
+  /// \brief Unsubscribe from a topic. The pending messages of a deferred
+  /// subscription to the topic are dropped.
   /// \param[in] _node Pointer to a node.
   /// \param[in] _topic Name of the topic.
   /// \return 0 on success.
@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GZ_TRANSPORT_CALLBACKSTATISTICS_HH_
+#define GZ_TRANSPORT_CALLBACKSTATISTICS_HH_
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#include "gz/transport/config.hh"
+
+namespace gz
+{
+  namespace transport
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace GZ_TRANSPORT_VERSION_NAMESPACE {
+    //
+    /// \brief Execution time of the callbacks of a subscription, see
+    /// Node::SubscriptionStats(). Only the callbacks executed while the
+    /// accounting was enabled are counted.
+    struct CallbackStatistics
+    {
+      /// \brief Topic name, without the partition.
+      std::string topic;
+
+      /// \brief Type of the messages accepted by the callback, or
+      /// kGenericMessageType.
+      std::string msgType;
+
+      /// \brief UUID of the subscription handler.
+      std::string handlerUuid;
+
+      /// \brief Whether the callback receives the serialized messages, see
+      /// Node::SubscribeRaw().
+      bool raw{false};
+
+      /// \brief Number of callbacks executed.
+      uint64_t calls{0};
+
+      /// \brief Total duration of the callbacks.
+      std::chrono::nanoseconds totalDuration{0};
+
+      /// \brief Longest callback.
+      std::chrono::nanoseconds maxDuration{0};
+    };
+    }
+  }
+}
+#endif
@@ -18,6 +18,7 @@
 #define GZ_TRANSPORT_CLOCK_HH_
 
 #include <chrono>
+#include <functional>
 #include <memory>
 #include <string>
 
@@ -45,6 +46,23 @@ namespace gz
         /// \return True if clock is ready to be used, false otherwise
         public: virtual bool IsReady() const = 0;
 
+        /// \brief Block until the clock reaches a time. NetworkClock and
+        /// WallClock sleep until the clock is updated or the time is due,
+        /// the default implementation polls Time() every millisecond.
+        /// \param[in] _time Time of the clock to wait for
+        /// \param[in] _timeout Maximum duration of the wait, in real time.
+        /// std::chrono::nanoseconds::max() waits as long as needed.
+        /// \return True if the clock reached _time, false if the wait timed
+        /// out or was interrupted by WakeUp().
+        public: virtual bool WaitUntil(
+                    const std::chrono::nanoseconds &_time,
+                    const std::chrono::nanoseconds &_timeout) const;
+
+        /// \brief Interrupt the calls to WaitUntil() in progress, e.g. to
+        /// stop a thread waiting on the clock. The default implementation
+        /// does nothing, the waits end by themselves.
+        public: virtual void WakeUp() const;
+
         /// \brief Virtual destructor
         public: virtual ~Clock() = default;
       };
@@ -85,6 +103,16 @@ namespace gz
         // Documentation inherited
         public: bool IsReady() const override;
 
+        /// \brief Block until a clock message reaches a time, sleeping
+        /// between the messages.
+        /// \sa Clock::WaitUntil()
+        public: bool WaitUntil(
+                    const std::chrono::nanoseconds &_time,
+                    const std::chrono::nanoseconds &_timeout) const override;
+
+        // Documentation inherited
+        public: void WakeUp() const override;
+
         /// \internal Implementation of this class
         private: class Implementation;
 
@@ -108,6 +136,14 @@ namespace gz
         // Documentation inherited
         public: bool IsReady() const override;
 
+        // Documentation inherited
+        public: bool WaitUntil(
+                    const std::chrono::nanoseconds &_time,
+                    const std::chrono::nanoseconds &_timeout) const override;
+
+        // Documentation inherited
+        public: void WakeUp() const override;
+
         /// \internal Private singleton constructor
         private: WallClock();
 
@@ -122,6 +158,42 @@ namespace gz
         private: std::unique_ptr<Implementation> dataPtr;
         GZ_UTILS_WARN_RESUME__DLL_INTERFACE_MISSING
       };
+
+      //////////////////////////////////////////////////
+      /// \brief Calls a function periodically, in the time of a Clock. With a
+      /// NetworkClock, the timer follows the simulation time: it sleeps while
+      /// the simulation is paused and fires faster when it runs faster than
+      /// real time, without polling the clock.
+      class GZ_TRANSPORT_VISIBLE ClockTimer
+      {
+        /// \brief Constructor, starts the timer.
+        /// \param[in] _clock The clock, whose lifetime must exceed that of
+        /// this timer
+        /// \param[in] _period Period of the timer, in the time of the clock
+        /// \param[in] _callback Function called from the thread of the timer
+        /// every period, with the time of the clock. When the callback takes
+        /// longer than a period, the missed periods are skipped.
+        public: ClockTimer(const Clock &_clock,
+                           const std::chrono::nanoseconds &_period,
+                           const std::function<void(
+                               const std::chrono::nanoseconds &_time)>
+                               &_callback);
+
+        /// \brief Destructor, stops the timer.
+        public: ~ClockTimer();
+
+        /// \brief Stop the timer and wait for the callback to return. It
+        /// must not be called from the callback.
+        public: void Stop();
+
+        /// \internal Implementation of this class
+        private: class Implementation;
+
+        /// \internal Pointer to the implementation of this class
+        GZ_UTILS_WARN_IGNORE__DLL_INTERFACE_MISSING
+        private: std::unique_ptr<Implementation> dataPtr;
+        GZ_UTILS_WARN_RESUME__DLL_INTERFACE_MISSING
+      };
     }
   }
 }
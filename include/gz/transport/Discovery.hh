@@ -59,13 +59,25 @@
 #include <gz/msgs/discovery.pb.h>
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <functional>
 #include <limits>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <random>
+#include <regex>
+#include <set>
 #include <string>
 #include <thread>
+#include <tuple>
 #include <vector>
 
 #include <gz/msgs/Utility.hh>
@@ -76,7 +88,9 @@
 #include "gz/transport/NetUtils.hh"
 #include "gz/transport/Publisher.hh"
 #include "gz/transport/TopicStorage.hh"
+#include "gz/transport/TopicUtils.hh"
 #include "gz/transport/TransportTypes.hh"
+#include "gz/transport/detail/Probes.hh"
 
 namespace gz
 {
@@ -95,6 +109,23 @@ namespace gz
       ALL
     };
 
+    /// \brief Datagrams sent and received by a discovery, see
+    /// Discovery::Traffic().
+    struct DiscoveryTraffic
+    {
+      /// \brief Number of datagrams sent.
+      uint64_t sentDatagrams = 0;
+
+      /// \brief Size (bytes) of the datagrams sent.
+      uint64_t sentBytes = 0;
+
+      /// \brief Number of datagrams received.
+      uint64_t receivedDatagrams = 0;
+
+      /// \brief Size (bytes) of the datagrams received.
+      uint64_t receivedBytes = 0;
+    };
+
     //
     /// \internal
     /// \brief Discovery helper function to poll sockets.
@@ -105,6 +136,40 @@ namespace gz
       const std::vector<int> &_sockets,
       const int _timeout);
 
+    /// \internal
+    /// \brief Discovery helper function to poll several sockets.
+    /// \param[in] _sockets Sockets on which to listen.
+    /// \param[in] _timeout Length of time to poll (milliseconds). A negative
+    /// value waits until the sockets receive data.
+    /// \param[out] _ready For each socket, true if it received data.
+    void GZ_TRANSPORT_VISIBLE pollSockets(
+      const std::vector<int> &_sockets,
+      const int _timeout,
+      std::vector<bool> &_ready);
+
+    /// \internal
+    /// \brief Steps of the reception loop of a discovery running in the
+    /// reception thread of another one, see Discovery::Start(Discovery &).
+    /// The steps are cleared when the guest is destroyed.
+    struct DiscoveryGuest
+    {
+      /// \brief Protects the steps, locked by the host while it runs them.
+      std::mutex mutex;
+
+      /// \brief Append the sockets of the guest to poll.
+      std::function<void(std::vector<int> &)> pollSockets;
+
+      /// \brief Timeout until the next deadline of the guest (ms).
+      std::function<int()> nextTimeout;
+
+      /// \brief Read a socket ready, return false if it isn't a socket of
+      /// the guest.
+      std::function<bool(const int)> handleSocket;
+
+      /// \brief Run the periodic tasks of the guest.
+      std::function<void()> runTasks;
+    };
+
     /// \class Discovery Discovery.hh gz/transport/Discovery.hh
     /// \brief A discovery class that implements a distributed topic discovery
     /// protocol. It uses UDP multicast for sending/receiving messages and
@@ -244,6 +309,8 @@ namespace gz
         for (auto const &relayAddr : relays)
           this->AddRelayAddress(relayAddr);
 
+        this->CreateWakeSocket();
+
         if (this->verbose)
           this->PrintCurrentState();
       }
@@ -251,10 +318,21 @@ namespace gz
       /// \brief Destructor.
       public: virtual ~Discovery()
       {
+        // Stop running in the reception thread of the host.
+        if (this->host)
+        {
+          std::lock_guard<std::mutex> lock(this->host->mutex);
+          this->host->pollSockets = nullptr;
+          this->host->nextTimeout = nullptr;
+          this->host->handleSocket = nullptr;
+          this->host->runTasks = nullptr;
+        }
+
         // Tell the service thread to terminate.
         this->exitMutex.lock();
         this->exit = true;
         this->exitMutex.unlock();
+        this->Wake();
 
         // Wait for the service threads to finish before exit.
         if (this->threadReception.joinable())
@@ -273,31 +351,200 @@ namespace gz
           WSACleanup();
 #else
           close(sock);
+#endif
+        }
+
+        for (const auto &sock : {this->wakeSocket, this->serverSocket})
+        {
+          if (sock < 0)
+            continue;
+#ifdef _WIN32
+          closesocket(sock);
+#else
+          close(sock);
 #endif
         }
       }
 
-      /// \brief Start the discovery service. You probably want to register the
-      /// callbacks for receiving discovery notifications before starting the
-      /// service.
-      public: void Start()
+      /// \brief Use a discovery server in addition to the multicast group.
+      /// All our discovery messages are sent to the server, which forwards
+      /// them to its other clients. The messages are only sent to the
+      /// multicast group while the server doesn't answer. It should be called
+      /// before Start().
+      /// \param[in] _ip IP address of the discovery server.
+      /// \param[in] _port UDP port of the discovery server.
+      /// \return True if the server was set or false otherwise (e.g.: invalid
+      /// IP address or the discovery has been started).
+      /// \sa DiscoveryServer
+      public: bool SetServer(const std::string &_ip, const int _port)
       {
         {
           std::lock_guard<std::mutex> lock(this->mutex);
+          if (this->enabled || this->serverSocket >= 0)
+            return false;
+        }
 
-          // The service is already running.
-          if (this->enabled)
-            return;
+        sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<u_short>(_port));
+        if (_port <= 0 || _port > 65535 ||
+            inet_pton(AF_INET, _ip.c_str(), &addr.sin_addr) != 1)
+        {
+          std::cerr << "Invalid discovery server [" << _ip << ":" << _port
+                    << "]" << std::endl;
+          return false;
+        }
 
-          this->enabled = true;
+        int sock = static_cast<int>(socket(PF_INET, SOCK_DGRAM, IPPROTO_UDP));
+        if (sock < 0)
+        {
+          std::cerr << "Discovery: unable to create the server socket."
+                    << std::endl;
+          return false;
         }
 
-        auto now = std::chrono::steady_clock::now();
-        this->timeNextHeartbeat = now;
-        this->timeNextActivity = now;
+        // The server answers to the ephemeral port chosen here.
+        sockaddr_in localAddr;
+        memset(&localAddr, 0, sizeof(localAddr));
+        localAddr.sin_family = AF_INET;
+        localAddr.sin_addr.s_addr = htonl(INADDR_ANY);
+        localAddr.sin_port = 0;
+        if (bind(sock, reinterpret_cast<sockaddr *>(&localAddr),
+              sizeof(localAddr)) < 0)
+        {
+          std::cerr << "Discovery: unable to bind the server socket."
+                    << std::endl;
+#ifdef _WIN32
+          closesocket(sock);
+#else
+          close(sock);
+#endif
+          return false;
+        }
+
+        this->serverSocket = sock;
+        this->serverAddr = addr;
+        return true;
+      }
+
+      /// \brief Check if the discovery server answers.
+      /// \return True if we heard from the discovery server during the last
+      /// silence interval.
+      /// \sa SetServer
+      public: bool ServerReachable() const
+      {
+        return this->serverReachable;
+      }
+
+      /// \brief Persist the remote publishers known to a file, rewritten
+      /// every heartbeat interval, and warm start from it: the publishers
+      /// of the file heard during the last few silence intervals are known
+      /// right away and the discovery is initialized, instead of waiting
+      /// for the peers. They are discarded unless their processes advertise
+      /// them again within the silence interval. A process must not share
+      /// its file with another one. It should be called before Start().
+      /// \param[in] _path Path of the file.
+      /// \return False if the discovery has been started.
+      public: bool SetCache(const std::string &_path)
+      {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        if (this->enabled)
+          return false;
+
+        this->cachePath = _path;
+        return true;
+      }
+
+      /// \brief Only keep track of the remote publishers of the topics
+      /// matching one of the patterns, plus the topics passed to Discover().
+      /// A pattern must match the whole topic name, without the partition.
+      /// The remote publishers already known are kept.
+      /// \param[in] _patterns Patterns of the interesting topics. An empty
+      /// list, the default, makes all the topics interesting.
+      public: void SetInterest(const std::vector<std::regex> &_patterns)
+      {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->interest = _patterns;
+      }
+
+      /// \brief Check if we keep track of the remote publishers of a topic.
+      /// \param[in] _topic Fully qualified topic name.
+      /// \return True if the topic is interesting.
+      /// \sa SetInterest
+      public: bool Interested(const std::string &_topic) const
+      {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        return this->IsInteresting(_topic);
+      }
+
+      /// \brief Start the discovery service. You probably want to register the
+      /// callbacks for receiving discovery notifications before starting the
+      /// service.
+      public: void Start()
+      {
+        if (!this->Enable())
+          return;
 
         // Start the thread that receives discovery information.
         this->threadReception = std::thread(&Discovery::RecvMessages, this);
+
+        this->RequestCatalogs();
+      }
+
+      /// \brief Start the discovery service in the reception thread of
+      /// another discovery, e.g.: the service discovery in the thread of the
+      /// message discovery, so a process only has one discovery thread. Each
+      /// discovery keeps its sockets, heartbeats and peers. The host can be
+      /// started before or after, it only hosts one guest and both can be
+      /// destroyed in any order. If the host already has a guest, this
+      /// discovery starts its own thread.
+      /// \param[in] _host The discovery running the reception thread.
+      public: template<typename HostPub>
+      void Start(Discovery<HostPub> &_host)
+      {
+        std::shared_ptr<DiscoveryGuest> hostGuest = _host.guest;
+        {
+          std::lock_guard<std::mutex> lock(hostGuest->mutex);
+          if (hostGuest->runTasks || static_cast<void *>(&_host) == this)
+          {
+            std::cerr << "Discovery: the host already has a guest, starting "
+                      << "a reception thread." << std::endl;
+            hostGuest = nullptr;
+          }
+        }
+        if (!hostGuest)
+        {
+          this->Start();
+          return;
+        }
+
+        if (!this->Enable())
+          return;
+
+        {
+          std::lock_guard<std::mutex> lock(hostGuest->mutex);
+          hostGuest->pollSockets = [this](std::vector<int> &_socks)
+          {
+            this->AppendPollSockets(_socks);
+          };
+          hostGuest->nextTimeout = [this]()
+          {
+            return this->NextTimeout();
+          };
+          hostGuest->handleSocket = [this](const int _sock)
+          {
+            return this->HandleSocket(_sock);
+          };
+          hostGuest->runTasks = [this]()
+          {
+            this->RunTasks();
+          };
+          this->host = hostGuest;
+        }
+        _host.Wake();
+
+        this->RequestCatalogs();
       }
 
       /// \brief Advertise a new message.
@@ -327,8 +574,37 @@ namespace gz
         // Only advertise a message outside this process if the scope
         // is not 'Process'
         if (_publisher.Options().Scope() != Scope_t::PROCESS)
-          this->SendMsg(DestinationType::ALL, msgs::Discovery::ADVERTISE,
-              _publisher);
+          this->PublishChange(msgs::Discovery::ADVERTISE, _publisher);
+
+        return true;
+      }
+
+      /// \brief Update the information of a publisher already advertised,
+      /// such as its options. The peers that know the publisher replace
+      /// its information, without the disconnection and connection of an
+      /// unadvertise and advertise. The scope can't change.
+      /// \param[in] _publisher New information of the publisher.
+      /// \return True if the method succeed or false otherwise
+      /// (e.g. if the publisher is not advertised).
+      public: bool Update(const Pub &_publisher)
+      {
+        {
+          std::lock_guard<std::mutex> lock(this->mutex);
+
+          if (!this->enabled ||
+              !this->info.HasPublisher(_publisher.Topic(), this->pUuid,
+                _publisher.NUuid()))
+          {
+            return false;
+          }
+
+          this->info.DelPublisherByNode(_publisher.Topic(), this->pUuid,
+            _publisher.NUuid());
+          this->info.AddPublisher(_publisher);
+        }
+
+        if (_publisher.Options().Scope() != Scope_t::PROCESS)
+          this->PublishChange(msgs::Discovery::ADVERTISE, _publisher, true);
 
         return true;
       }
@@ -356,6 +632,9 @@ namespace gz
             return false;
 
           cb = this->connectionCb;
+
+          // The topics that we look for are always interesting.
+          this->discoveredTopics.insert(_topic);
         }
 
         Pub pub;
@@ -473,10 +752,7 @@ namespace gz
         // Only unadvertise a message outside this process if the scope
         // is not 'Process'.
         if (inf.Options().Scope() != Scope_t::PROCESS)
-        {
-          this->SendMsg(DestinationType::ALL,
-              msgs::Discovery::UNADVERTISE, inf);
-        }
+          this->PublishChange(msgs::Discovery::UNADVERTISE, inf);
 
         return true;
       }
@@ -525,8 +801,12 @@ namespace gz
       /// \param[in] _ms New value in milliseconds.
       public: void SetActivityInterval(const unsigned int _ms)
       {
-        std::lock_guard<std::mutex> lock(this->mutex);
-        this->activityInterval = _ms;
+        {
+          std::lock_guard<std::mutex> lock(this->mutex);
+          this->activityInterval = _ms;
+          this->timeNextActivity = std::chrono::steady_clock::now();
+        }
+        this->Wake();
       }
 
       /// \brief Set the heartbeat interval.
@@ -534,17 +814,66 @@ namespace gz
       /// \param[in] _ms New value in milliseconds.
       public: void SetHeartbeatInterval(const unsigned int _ms)
       {
-        std::lock_guard<std::mutex> lock(this->mutex);
-        this->heartbeatInterval = _ms;
+        {
+          std::lock_guard<std::mutex> lock(this->mutex);
+          this->heartbeatInterval = _ms;
+          this->timeNextHeartbeat = std::min(this->timeNextHeartbeat,
+            std::chrono::steady_clock::now() + std::chrono::milliseconds(_ms));
+        }
+        this->Wake();
       }
 
       /// \brief Set the maximum silence interval.
       /// \sa SilenceInterval.
       /// \param[in] _ms New value in milliseconds.
       public: void SetSilenceInterval(const unsigned int _ms)
+      {
+        {
+          std::lock_guard<std::mutex> lock(this->mutex);
+          this->silenceInterval = _ms;
+          this->timeNextActivity = std::chrono::steady_clock::now();
+        }
+        this->Wake();
+      }
+
+      /// \brief Enable or disable the adaptive intervals. When enabled, the
+      /// heartbeat interval grows with the number of peers, so every process
+      /// receives a bounded number of heartbeats per second, and each
+      /// heartbeat is sent with a random jitter to avoid synchronized bursts.
+      /// The heartbeats carry their interval, so the peers expire us after
+      /// missing a few of them instead of after their silence interval.
+      /// \param[in] _enabled True to enable the adaptive intervals.
+      /// \sa CurrentHeartbeatInterval
+      public: void SetAdaptiveIntervals(const bool _enabled)
+      {
+        {
+          std::lock_guard<std::mutex> lock(this->mutex);
+          this->adaptive = _enabled;
+          this->timeNextHeartbeat = std::min(this->timeNextHeartbeat,
+            std::chrono::steady_clock::now() +
+              std::chrono::milliseconds(this->HeartbeatPeriod()));
+        }
+        this->Wake();
+      }
+
+      /// \brief Check if the adaptive intervals are enabled.
+      /// \return True if enabled.
+      /// \sa SetAdaptiveIntervals
+      public: bool AdaptiveIntervals() const
+      {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        return this->adaptive;
+      }
+
+      /// \brief Get the average interval between our heartbeats: the
+      /// heartbeat interval, or the value derived from the number of peers
+      /// if the adaptive intervals are enabled.
+      /// \return The value in milliseconds.
+      /// \sa SetAdaptiveIntervals
+      public: unsigned int CurrentHeartbeatInterval() const
       {
         std::lock_guard<std::mutex> lock(this->mutex);
-        this->silenceInterval = _ms;
+        return this->HeartbeatPeriod();
       }
 
       /// \brief Register a callback to receive discovery connection events.
@@ -594,6 +923,32 @@ namespace gz
         this->subscribersCb = _cb;
       }
 
+      /// \brief Register a callback providing the address given to the peers
+      /// of the previous wire protocol (gz-transport 13 and before) in
+      /// place of the address of our publishers. It's called once, when the
+      /// first one of these peers is discovered. They are ignored without a
+      /// callback or if it returns an empty address.
+      /// \param[in] _cb Function callback.
+      /// \sa LegacyPeer
+      public: void LegacyAddressCb(const std::function<std::string()> &_cb)
+      {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->legacyAddressCb = _cb;
+      }
+
+      /// \brief Check whether a remote process uses the previous wire
+      /// protocol. Its publications, requests and responses don't carry the
+      /// additions of the current protocol.
+      /// \param[in] _pUuid UUID of the process.
+      /// \return True if the process uses the previous wire protocol.
+      /// \sa LegacyAddressCb
+      public: bool LegacyPeer(const std::string &_pUuid) const
+      {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        auto it = this->remoteStates.find(_pUuid);
+        return it != this->remoteStates.end() && it->second.legacy;
+      }
+
       /// \brief Print the current discovery state.
       public: void PrintCurrentState() const
       {
@@ -639,7 +994,12 @@ namespace gz
       /// \brief Get the list of topics currently advertised and subscribed
       /// in the network.
       /// \param[out] _topics List of advertised topics.
-      public: void TopicList(std::vector<std::string> &_topics)
+      /// \param[in] _timeout Maximum time to wait for the initialization
+      /// of the discovery, see WaitForInit(). A negative value waits until
+      /// it's initialized.
+      public: void TopicList(std::vector<std::string> &_topics,
+          const std::chrono::milliseconds &_timeout =
+            std::chrono::milliseconds(-1))
       {
         {
           std::lock_guard<std::mutex> lock(this->mutex);
@@ -651,7 +1011,7 @@ namespace gz
         this->SendMsg(
           DestinationType::ALL, msgs::Discovery::SUBSCRIBERS_REQ, pub);
 
-        this->WaitForInit();
+        this->WaitForInit(_timeout);
         std::lock_guard<std::mutex> lock(this->mutex);
         this->info.TopicList(_topics);
 
@@ -668,8 +1028,33 @@ namespace gz
         }
       }
 
+      /// \brief Get the datagrams sent and received since the discovery
+      /// was created. The datagrams sent to several destinations are
+      /// counted once per destination.
+      /// \return The traffic.
+      public: DiscoveryTraffic Traffic() const
+      {
+        DiscoveryTraffic traffic;
+        traffic.sentDatagrams = this->sentDatagrams;
+        traffic.sentBytes = this->sentBytes;
+        traffic.receivedDatagrams = this->receivedDatagrams;
+        traffic.receivedBytes = this->receivedBytes;
+        return traffic;
+      }
+
+      /// \brief Estimate the memory used by the publishers and the remote
+      /// subscribers known by the discovery.
+      /// \return The estimated size (bytes).
+      public: uint64_t MemoryUsage() const
+      {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        return this->info.MemoryUsage() +
+          this->remoteSubscribers.MemoryUsage();
+      }
+
       /// \brief Check if ready/initialized. If not, then wait on the
-      /// initializedCv condition variable.
+      /// initializedCv condition variable. The discovery is initialized once
+      /// a peer sends its catalog or after two heartbeats.
       public: void WaitForInit() const
       {
         std::unique_lock<std::mutex> lk(this->mutex);
@@ -680,6 +1065,34 @@ namespace gz
         }
       }
 
+      /// \brief Wait for the initialization, at most a given time. The
+      /// state of the other processes might be incomplete until then.
+      /// \param[in] _timeout Maximum time to wait. A negative value waits
+      /// until the discovery is initialized.
+      /// \return True if the discovery is initialized.
+      public: bool WaitForInit(const std::chrono::milliseconds &_timeout) const
+      {
+        if (_timeout.count() < 0)
+        {
+          this->WaitForInit();
+          return true;
+        }
+
+        std::unique_lock<std::mutex> lk(this->mutex);
+        return this->initializedCv.wait_for(lk, _timeout,
+          [this]{return this->initialized;});
+      }
+
+      /// \brief Mark the discovery as initialized and notify anyone waiting
+      /// for it. Must be called with the mutex locked.
+      private: void SetInitialized()
+      {
+        this->initialized = true;
+
+        // Notify anyone waiting for the initialization phase to finish.
+        this->initializedCv.notify_all();
+      }
+
       /// \brief Check the validity of the topic information. Each topic update
       /// has its own timestamp. This method iterates over the list of topics
       /// and invalids the old topics.
@@ -701,6 +1114,9 @@ namespace gz
 
           disconnectCb = this->disconnectionCb;
 
+          // Time at which the oldest remaining entry will expire.
+          Timestamp nextExpiration = Timestamp::max();
+
           for (auto it = this->activity.cbegin(); it != this->activity.cend();)
           {
             // Elapsed time since the last update from this publisher.
@@ -708,10 +1124,11 @@ namespace gz
 
             // This publisher has expired.
             if (std::chrono::duration_cast<std::chrono::milliseconds>
-                 (elapsed).count() > this->silenceInterval)
+                 (elapsed).count() > this->PeerSilence(it->first))
             {
               // Remove all the info entries for this process UUID.
               this->info.DelPublishersByProc(it->first);
+              this->remoteStates.erase(it->first);
 
               uuids.push_back(it->first);
 
@@ -719,11 +1136,19 @@ namespace gz
               this->activity.erase(it++);
             }
             else
+            {
+              nextExpiration =
+                std::min(nextExpiration,
+                  this->Expiration(it->second, this->PeerSilence(it->first)));
               ++it;
+            }
           }
 
-          this->timeNextActivity = std::chrono::steady_clock::now() +
-            std::chrono::milliseconds(this->activityInterval);
+          // Wake up when the next entry expires, but don't check more often
+          // than every activity interval.
+          this->timeNextActivity = std::max(nextExpiration,
+            std::chrono::steady_clock::now() +
+              std::chrono::milliseconds(this->activityInterval));
         }
 
         if (!disconnectCb)
@@ -752,25 +1177,61 @@ namespace gz
             return;
         }
 
+        // The heartbeat carries the version of our state instead of
+        // re-advertising all our topics. The peers request what they miss.
+        msgs::Discovery heartbeat;
         Publisher pub("", "", this->pUuid, "", AdvertiseOptions());
-        this->SendMsg(DestinationType::ALL, msgs::Discovery::HEARTBEAT, pub);
-
-        std::map<std::string, std::vector<Pub>> nodes;
+        this->FillMsg(msgs::Discovery::HEARTBEAT, pub, heartbeat);
+        unsigned int period;
         {
           std::lock_guard<std::mutex> lock(this->mutex);
-
-          // Re-advertise topics that are advertised inside this process.
-          this->info.PublishersByProc(this->pUuid, nodes);
+          SetHeaderData(heartbeat, kStateKey,
+            {std::to_string(this->stateVersion)});
+          period = this->HeartbeatPeriod();
+          if (this->adaptive)
+            SetHeaderData(heartbeat, kHeartbeatKey, {std::to_string(period)});
+
+          // The heartbeats are only compact if every peer understands them,
+          // otherwise they announce that we do.
+          bool compact = true;
+          for (const auto &peer : this->activity)
+          {
+            auto it = this->remoteStates.find(peer.first);
+            compact = compact && it != this->remoteStates.end() &&
+              it->second.compact;
+          }
+          this->compactHeartbeats = compact;
+          if (!compact)
+            SetHeaderData(heartbeat, kCompactKey, {});
         }
+        this->Queue(DestinationType::ALL, {heartbeat});
 
-        for (const auto &topic : nodes)
+        // The peers of the previous wire protocol expect our topics to be
+        // advertised again with each heartbeat.
+        std::vector<msgs::Discovery> legacy;
         {
-          for (const auto &node : topic.second)
+          std::lock_guard<std::mutex> lock(this->mutex);
+          if (!this->legacyAddress.empty() && this->LegacyPeers())
           {
-            this->SendMsg(DestinationType::ALL,
-                msgs::Discovery::ADVERTISE, node);
+            legacy.emplace_back();
+            this->FillMsg(msgs::Discovery::HEARTBEAT, pub, legacy.back());
+
+            std::map<std::string, std::vector<Pub>> nodes;
+            this->info.PublishersByProc(this->pUuid, nodes);
+            for (const auto &topic : nodes)
+            {
+              for (const auto &node : topic.second)
+              {
+                if (node.Options().Scope() == Scope_t::PROCESS)
+                  continue;
+                legacy.emplace_back();
+                this->FillMsg(msgs::Discovery::ADVERTISE, node,
+                  legacy.back());
+              }
+            }
           }
         }
+        this->SendLegacy(std::move(legacy));
 
         {
           std::lock_guard<std::mutex> lock(this->mutex);
@@ -778,87 +1239,589 @@ namespace gz
           {
             if (this->numHeartbeatsUninitialized == 2u)
             {
-              // We consider discovery initialized after two heartbeat cycles.
-              this->initialized = true;
-
-              // Notify anyone waiting for the initialization phase to finish.
-              this->initializedCv.notify_all();
+              // We consider discovery initialized after two heartbeat cycles
+              // if no peer has sent us its catalog.
+              this->SetInitialized();
             }
             ++this->numHeartbeatsUninitialized;
           }
 
-          this->timeNextHeartbeat = std::chrono::steady_clock::now() +
-            std::chrono::milliseconds(this->heartbeatInterval);
+          auto next = std::chrono::milliseconds(period);
+          if (this->adaptive)
+          {
+            std::uniform_real_distribution<double> jitter(
+              1.0 - kHeartbeatJitter, 1.0 + kHeartbeatJitter);
+            next = std::chrono::milliseconds(
+              static_cast<int64_t>(period * jitter(this->rng)));
+          }
+          this->timeNextHeartbeat = std::chrono::steady_clock::now() + next;
         }
       }
 
+      /// \brief Get the average interval between our heartbeats. Must be
+      /// called with the mutex locked.
+      /// \return The value in milliseconds.
+      /// \sa CurrentHeartbeatInterval
+      private: unsigned int HeartbeatPeriod() const
+      {
+        if (!this->adaptive)
+          return this->heartbeatInterval;
+
+        const std::size_t period =
+          this->activity.size() * kAdaptivePeerInterval;
+        return static_cast<unsigned int>(std::min<std::size_t>(
+          std::max<std::size_t>(period, kMinAdaptiveHeartbeat),
+          kMaxAdaptiveHeartbeat));
+      }
+
+      /// \brief Get the time without news from a process after which it
+      /// expires. Must be called with the mutex locked.
+      /// \param[in] _pUuid UUID of the process.
+      /// \return Several of its heartbeat intervals if its heartbeats carry
+      /// the interval, or the silence interval otherwise (milliseconds).
+      private: unsigned int PeerSilence(const std::string &_pUuid) const
+      {
+        auto it = this->remoteStates.find(_pUuid);
+        if (it == this->remoteStates.end() || it->second.heartbeat == 0)
+          return this->silenceInterval;
+
+        return kMissedHeartbeats * it->second.heartbeat;
+      }
+
       /// \brief Calculate the next timeout. There are three main activities to
       /// perform by the discovery component:
       /// 1. Receive discovery messages.
       /// 2. Send heartbeats.
       /// 3. Maintain the discovery information up to date.
       ///
-      /// Tasks (2) and (3) need to be checked at fixed intervals. This function
-      /// calculates the next timeout to satisfy (2) and (3).
+      /// Tasks (2) and (3) have their own deadlines. This function calculates
+      /// the timeout until the earliest one, so the reception thread sleeps
+      /// until a message arrives, a deadline is reached or it's woken up.
       /// \return A timeout (milliseconds).
       private: int NextTimeout() const
       {
-        auto now = std::chrono::steady_clock::now();
-        auto timeUntilNextHeartbeat = this->timeNextHeartbeat - now;
-        auto timeUntilNextActivity = this->timeNextActivity - now;
+        Timestamp next;
+        {
+          std::lock_guard<std::mutex> lock(this->mutex);
+          next = std::min({this->timeNextHeartbeat, this->timeNextActivity,
+            this->timeNextStateBurst, this->timeNextCache,
+            this->warmDeadline});
+          for (const auto &req : this->catalogRequests)
+            next = std::min(next, req.second.deadline);
+        }
 
-        int t = static_cast<int>(
-          std::chrono::duration_cast<std::chrono::milliseconds>
-            (std::min(timeUntilNextHeartbeat, timeUntilNextActivity)).count());
-        int t2 = std::min(t, this->kTimeout);
-        return std::max(t2, 0);
+        if (this->serverReachable)
+          next = std::min(next, this->Expiration(this->serverLastSeen));
+
+        auto now = std::chrono::steady_clock::now();
+        if (next <= now)
+          return 0;
+
+        // Round up, otherwise we would wake up right before the deadline.
+        auto t = std::chrono::ceil<std::chrono::milliseconds>(next - now);
+
+        // Without a wake up socket the exit and the new intervals are only
+        // noticed after a timeout.
+        auto maxTimeout = this->wakeSocket < 0 ?
+          std::chrono::milliseconds(this->kTimeout) :
+          std::chrono::milliseconds(std::numeric_limits<int>::max());
+        return static_cast<int>(std::min(t, maxTimeout).count());
       }
 
-      /// \brief Receive discovery messages.
-      private: void RecvMessages()
+      /// \brief Get the time at which an activity entry expires.
+      /// \param[in] _lastUpdate Last time we heard from the process.
+      /// \return The first time at which UpdateActivity() removes it.
+      private: Timestamp Expiration(const Timestamp &_lastUpdate) const
       {
-        bool timeToExit = false;
-        while (!timeToExit)
-        {
-          // Calculate the timeout.
-          int timeout = this->NextTimeout();
+        return this->Expiration(_lastUpdate, this->silenceInterval);
+      }
 
-          if (pollSockets(this->sockets, timeout))
-          {
-            this->RecvDiscoveryUpdate();
+      /// \brief Get the time at which an activity entry expires.
+      /// \param[in] _lastUpdate Last time we heard from the process.
+      /// \param[in] _silence Silence allowed for the process (ms).
+      /// \return The first time at which UpdateActivity() removes it.
+      private: Timestamp Expiration(const Timestamp &_lastUpdate,
+                                    const unsigned int _silence) const
+      {
+        // UpdateActivity() removes the entries older than their silence,
+        // with millisecond resolution.
+        return _lastUpdate + std::chrono::milliseconds(_silence + 1);
+      }
 
-            if (this->verbose)
-              this->PrintCurrentState();
-          }
+      /// \brief Create the socket used to wake up the reception thread. It's
+      /// bound to an ephemeral port in the loopback interface.
+      private: void CreateWakeSocket()
+      {
+        int sock = static_cast<int>(socket(PF_INET, SOCK_DGRAM, IPPROTO_UDP));
+        if (sock < 0)
+        {
+          std::cerr << "Discovery: unable to create the wake up socket."
+                    << std::endl;
+          return;
+        }
 
-          this->UpdateHeartbeat();
-          this->UpdateActivity();
+        sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = 0;
+        socklen_t addrLen = sizeof(addr);
 
-          // Is it time to exit?
-          {
-            std::lock_guard<std::mutex> lock(this->exitMutex);
-            if (this->exit)
-              timeToExit = true;
-          }
+        if (bind(sock, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0 ||
+            getsockname(sock, reinterpret_cast<sockaddr *>(&addr),
+              &addrLen) < 0)
+        {
+          std::cerr << "Discovery: unable to bind the wake up socket."
+                    << std::endl;
+#ifdef _WIN32
+          closesocket(sock);
+#else
+          close(sock);
+#endif
+          return;
         }
+
+        this->wakeSocket = sock;
+        this->wakeAddr = addr;
       }
 
-      /// \brief Method in charge of receiving the discovery updates.
-      private: void RecvDiscoveryUpdate()
+      /// \brief Interrupt the wait of the reception thread, so it notices the
+      /// exit request or the new deadlines.
+      private: void Wake() const
       {
-        char rcvStr[Discovery::kMaxRcvStr];
-        sockaddr_in clntAddr;
-        socklen_t addrLen = sizeof(clntAddr);
+        if (this->wakeSocket < 0)
+          return;
 
-        int64_t received = recvfrom(this->sockets.at(0),
-              reinterpret_cast<raw_type *>(rcvStr),
+        const char byte = 0;
+        sendto(this->wakeSocket, reinterpret_cast<const raw_type *>(&byte),
+          sizeof(byte), 0, reinterpret_cast<const sockaddr *>(&this->wakeAddr),
+          sizeof(this->wakeAddr));
+      }
+
+      /// \brief Enable the discovery service and schedule the first
+      /// heartbeat and activity check.
+      /// \return False if the service was already running.
+      private: bool Enable()
+      {
+        {
+          std::lock_guard<std::mutex> lock(this->mutex);
+
+          // The service is already running.
+          if (this->enabled)
+            return false;
+
+          this->enabled = true;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        this->timeNextHeartbeat = now;
+        this->timeNextActivity = now;
+        this->LoadCache();
+        return true;
+      }
+
+      /// \brief Warm start from the publishers of the cache file, if any.
+      /// Must be called without the mutex locked.
+      /// \sa SetCache
+      private: void LoadCache()
+      {
+        std::vector<Pub> loaded;
+        DiscoveryCallback<Pub> connectCb;
+        {
+          std::lock_guard<std::mutex> lock(this->mutex);
+          if (this->cachePath.empty())
+            return;
+
+          const Timestamp now = std::chrono::steady_clock::now();
+          this->timeNextCache = now;
+
+          std::ifstream file(this->cachePath, std::ios::binary);
+          const int64_t wallNow =
+            std::chrono::duration_cast<std::chrono::milliseconds>(
+              std::chrono::system_clock::now().time_since_epoch()).count();
+          const int64_t maxAge =
+            int64_t{kCacheSilences} * this->silenceInterval;
+
+          // Records: the size of a message, then an ADVERTISE message
+          // carrying the last time its process was heard.
+          uint32_t size;
+          std::string data;
+          while (file.read(reinterpret_cast<char *>(&size), sizeof(size)))
+          {
+            data.resize(size);
+            if (size > 0 && !file.read(&data[0], size))
+              break;
+
+            msgs::Discovery msg;
+            std::vector<std::string> seen;
+            if (!msg.ParseFromString(data) || !msg.has_pub() ||
+                !HeaderData(msg, kCacheSeenKey, seen) || seen.size() != 1u)
+            {
+              continue;
+            }
+
+            // The processes silent for too long are most likely gone.
+            const int64_t age =
+              wallNow - std::strtoll(seen[0].c_str(), nullptr, 10);
+            const auto &pubMsg = msg.pub();
+            if (age < 0 || age > maxAge ||
+                pubMsg.process_uuid() == this->pUuid ||
+                !this->IsInteresting(pubMsg.topic()))
+            {
+              continue;
+            }
+
+            Pub publisher;
+            publisher.SetFromDiscovery(msg);
+            if (!this->info.AddPublisher(publisher))
+              continue;
+
+            // The process expires unless we hear from it.
+            this->activity.emplace(publisher.PUuid(), now);
+            this->warmPublishers.emplace(publisher.Topic(),
+              publisher.PUuid(), publisher.NUuid());
+            loaded.push_back(publisher);
+          }
+
+          if (!loaded.empty())
+          {
+            this->warmDeadline =
+              now + std::chrono::milliseconds(this->silenceInterval);
+            this->SetInitialized();
+          }
+          connectCb = this->connectionCb;
+        }
+
+        if (!connectCb)
+          return;
+
+        for (const auto &publisher : loaded)
+          connectCb(publisher);
+      }
+
+      /// \brief Rewrite the cache file every heartbeat interval with the
+      /// remote publishers and the last time we heard from their processes.
+      /// \sa SetCache
+      private: void UpdateCache()
+      {
+        std::string data;
+        std::string path;
+        {
+          std::lock_guard<std::mutex> lock(this->mutex);
+          const Timestamp now = std::chrono::steady_clock::now();
+          if (now < this->timeNextCache)
+            return;
+
+          this->timeNextCache =
+            now + std::chrono::milliseconds(this->heartbeatInterval);
+          path = this->cachePath;
+
+          const auto wallNow = std::chrono::system_clock::now();
+          std::vector<std::string> topics;
+          this->info.TopicList(topics);
+          for (const auto &topic : topics)
+          {
+            Addresses_M<Pub> addresses;
+            this->info.Publishers(topic, addresses);
+            for (const auto &proc : addresses)
+            {
+              auto act = this->activity.find(proc.first);
+              if (proc.first == this->pUuid || act == this->activity.end())
+                continue;
+
+              const auto seen =
+                std::chrono::duration_cast<std::chrono::milliseconds>(
+                  (wallNow - (now - act->second)).time_since_epoch());
+              for (const auto &pub : proc.second)
+              {
+                msgs::Discovery msg;
+                msg.set_type(msgs::Discovery::ADVERTISE);
+                msg.set_process_uuid(proc.first);
+                pub.FillDiscovery(msg);
+                SetHeaderData(msg, kCacheSeenKey,
+                  {std::to_string(seen.count())});
+
+                const std::string record = msg.SerializeAsString();
+                const uint32_t size = static_cast<uint32_t>(record.size());
+                data.append(reinterpret_cast<const char *>(&size),
+                  sizeof(size));
+                data.append(record);
+              }
+            }
+          }
+        }
+
+        // Replace the file at once, a crash never leaves it half written.
+        const std::string tmpPath = path + ".tmp";
+        {
+          std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+          file.write(data.data(), static_cast<std::streamsize>(data.size()));
+          if (!file.flush())
+          {
+            file.close();
+            std::remove(tmpPath.c_str());
+            return;
+          }
+        }
+#ifdef _WIN32
+        std::remove(path.c_str());
+#endif
+        if (std::rename(tmpPath.c_str(), path.c_str()) != 0)
+          std::remove(tmpPath.c_str());
+      }
+
+      /// \brief Discard the publishers of the warm start that their
+      /// processes didn't advertise again within the silence interval.
+      /// \sa SetCache
+      private: void DiscardUnconfirmed()
+      {
+        std::vector<Pub> discarded;
+        DiscoveryCallback<Pub> disconnectCb;
+        {
+          std::lock_guard<std::mutex> lock(this->mutex);
+          if (std::chrono::steady_clock::now() < this->warmDeadline)
+            return;
+
+          this->warmDeadline = Timestamp::max();
+          for (const auto &key : this->warmPublishers)
+          {
+            Pub publisher;
+            if (this->info.Publisher(std::get<0>(key), std::get<1>(key),
+                  std::get<2>(key), publisher) &&
+                this->info.DelPublisherByNode(std::get<0>(key),
+                  std::get<1>(key), std::get<2>(key)))
+            {
+              discarded.push_back(publisher);
+            }
+          }
+          this->warmPublishers.clear();
+          disconnectCb = this->disconnectionCb;
+        }
+
+        if (!disconnectCb)
+          return;
+
+        for (const auto &publisher : discarded)
+          disconnectCb(publisher);
+      }
+
+      /// \brief Ask the peers for everything they know, so we don't have to
+      /// wait for the heartbeats of each process.
+      private: void RequestCatalogs()
+      {
+        msgs::Discovery req;
+        Publisher pub("", "", this->pUuid, "", AdvertiseOptions());
+        this->FillMsg(msgs::Discovery::SUBSCRIBE, pub, req);
+        SetHeaderData(req, kCatalogReqKey, {this->pUuid});
+        this->SendMsgs(DestinationType::ALL, {req});
+      }
+
+      /// \brief Append the sockets polled by the reception thread.
+      /// \param[in, out] _socks The sockets to poll.
+      private: void AppendPollSockets(std::vector<int> &_socks) const
+      {
+        _socks.push_back(this->sockets.at(0));
+        for (const auto &sock : {this->wakeSocket, this->serverSocket})
+        {
+          if (sock >= 0)
+            _socks.push_back(sock);
+        }
+      }
+
+      /// \brief Read a socket with pending data.
+      /// \param[in] _sock The socket.
+      /// \return False if the socket isn't one of this discovery.
+      private: bool HandleSocket(const int _sock)
+      {
+        if (_sock == this->wakeSocket)
+        {
+          // Consume the wake up datagram.
+          char byte;
+          recv(this->wakeSocket, reinterpret_cast<raw_type *>(&byte),
+            sizeof(byte), 0);
+          return true;
+        }
+
+        if (_sock != this->sockets.at(0) && _sock != this->serverSocket)
+          return false;
+
+        this->RecvDiscoveryUpdate(_sock);
+
+        if (this->verbose)
+          this->PrintCurrentState();
+        return true;
+      }
+
+      /// \brief Run the periodic tasks of the reception thread.
+      private: void RunTasks()
+      {
+        this->UpdateServer();
+        this->UpdateHeartbeat();
+        this->UpdateActivity();
+        this->DiscardUnconfirmed();
+        this->UpdateCache();
+        this->SendCatalogs();
+        this->SendStateBurst();
+        this->Flush();
+      }
+
+      /// \brief Receive discovery messages, also for the guest if any.
+      private: void RecvMessages()
+      {
+        configureThread("discovery");
+
+        bool timeToExit = false;
+        while (!timeToExit)
+        {
+          // Calculate the timeout.
+          int timeout = this->NextTimeout();
+
+          std::vector<int> pollSocks;
+          this->AppendPollSockets(pollSocks);
+          {
+            std::lock_guard<std::mutex> lock(this->guest->mutex);
+            if (this->guest->runTasks)
+            {
+              timeout = std::min(timeout, this->guest->nextTimeout());
+              this->guest->pollSockets(pollSocks);
+            }
+          }
+
+          std::vector<bool> ready;
+          pollSockets(pollSocks, timeout, ready);
+          for (std::size_t i = 0; i < pollSocks.size(); ++i)
+          {
+            if (!ready[i] || this->HandleSocket(pollSocks[i]))
+              continue;
+
+            // The guest might be gone since the sockets were polled.
+            std::lock_guard<std::mutex> lock(this->guest->mutex);
+            if (this->guest->handleSocket)
+              this->guest->handleSocket(pollSocks[i]);
+          }
+
+          this->RunTasks();
+          {
+            std::lock_guard<std::mutex> lock(this->guest->mutex);
+            if (this->guest->runTasks)
+              this->guest->runTasks();
+          }
+
+          // Is it time to exit?
+          {
+            std::lock_guard<std::mutex> lock(this->exitMutex);
+            if (this->exit)
+              timeToExit = true;
+          }
+        }
+      }
+
+      /// \brief Method in charge of receiving the discovery updates. All the
+      /// pending datagrams are read at once when the platform supports it.
+      /// \param[in] _sock Socket with pending data: the multicast socket or
+      /// the discovery server socket.
+      private: void RecvDiscoveryUpdate(const int _sock)
+      {
+        // The buffers are only needed by the reception thread, they're
+        // allocated the first time and reused afterwards.
+        if (this->rcvBuffer.empty())
+        {
+          this->rcvBuffer.resize(kRecvBatch * kMaxRcvStr);
+          this->rcvAddrs.resize(kRecvBatch);
+#ifdef __linux__
+          this->rcvIovs.resize(kRecvBatch);
+          this->rcvHdrs.resize(kRecvBatch);
+          for (std::size_t i = 0; i < kRecvBatch; ++i)
+          {
+            this->rcvIovs[i].iov_base = &this->rcvBuffer[i * kMaxRcvStr];
+            this->rcvIovs[i].iov_len = kMaxRcvStr;
+            memset(&this->rcvHdrs[i], 0, sizeof(this->rcvHdrs[i]));
+            this->rcvHdrs[i].msg_hdr.msg_iov = &this->rcvIovs[i];
+            this->rcvHdrs[i].msg_hdr.msg_iovlen = 1;
+            this->rcvHdrs[i].msg_hdr.msg_name = &this->rcvAddrs[i];
+          }
+#endif
+        }
+
+#ifdef __linux__
+        for (auto &hdr : this->rcvHdrs)
+          hdr.msg_hdr.msg_namelen = sizeof(sockaddr_in);
+
+        // The socket is ready, so at least one datagram is available.
+        int count = recvmmsg(_sock, this->rcvHdrs.data(),
+          static_cast<unsigned int>(kRecvBatch), MSG_DONTWAIT, nullptr);
+        if (count < 0)
+        {
+          if (errno != EAGAIN && errno != EWOULDBLOCK)
+          {
+            std::cerr << "Discovery::RecvDiscoveryUpdate() recvmmsg error"
+              << std::endl;
+          }
+          return;
+        }
+
+        for (int i = 0; i < count; ++i)
+        {
+          this->RecvDatagram(_sock, this->rcvAddrs[i],
+            &this->rcvBuffer[i * kMaxRcvStr], this->rcvHdrs[i].msg_len);
+        }
+#else
+        socklen_t addrLen = sizeof(sockaddr_in);
+        int64_t received = recvfrom(_sock,
+              reinterpret_cast<raw_type *>(this->rcvBuffer.data()),
               this->kMaxRcvStr, 0,
-              reinterpret_cast<sockaddr *>(&clntAddr),
+              reinterpret_cast<sockaddr *>(&this->rcvAddrs[0]),
               reinterpret_cast<socklen_t *>(&addrLen));
-        if (received > 0)
+
+        if (received < 0)
+        {
+          std::cerr << "Discovery::RecvDiscoveryUpdate() recvfrom error"
+            << std::endl;
+          return;
+        }
+
+        this->RecvDatagram(_sock, this->rcvAddrs[0], this->rcvBuffer.data(),
+          received);
+#endif
+      }
+
+      /// \brief Process a datagram received by the discovery.
+      /// \param[in] _sock Socket that received the datagram.
+      /// \param[in] _clntAddr Address of the sender.
+      /// \param[in] _rcvStr Content of the datagram.
+      /// \param[in] _received Size of the datagram in octets.
+      private: void RecvDatagram(const int _sock, const sockaddr_in &_clntAddr,
+                                 char *_rcvStr, const int64_t _received)
+      {
+        GZ_TRANSPORT_PROBE1(discovery__recv, _received);
+        ++this->receivedDatagrams;
+        this->receivedBytes += static_cast<uint64_t>(std::max<int64_t>(
+          _received, 0));
+
+        const bool fromServer = _sock == this->serverSocket;
+        if (fromServer)
+        {
+          if (_clntAddr.sin_addr.s_addr != this->serverAddr.sin_addr.s_addr ||
+              _clntAddr.sin_port != this->serverAddr.sin_port)
+          {
+            return;
+          }
+
+          // Every datagram of the server, including its empty
+          // acknowledgements, proves that it's alive.
+          this->serverLastSeen = std::chrono::steady_clock::now();
+          if (!this->serverReachable.exchange(true) && this->verbose)
+          {
+            std::cout << "Discovery server [" << inet_ntoa(_clntAddr.sin_addr)
+                      << ":" << ntohs(_clntAddr.sin_port) << "] reachable"
+                      << std::endl;
+          }
+        }
+
+        if (_received > 0)
         {
           uint16_t len = 0;
-          memcpy(&len, &rcvStr[0], sizeof(len));
+          memcpy(&len, &_rcvStr[0], sizeof(len));
 
           // Gazebo Transport delimits each discovery message with a
           // frame_delimiter that contains byte size information.
@@ -881,11 +1844,15 @@ namespace gz
           // Transport exist on the same network. If we receive an
           // unexpected size, then we ignore the message.
 
+          //
+          // A datagram might contain several discovery messages, one after
+          // the other with their own frame_delimiter.
+
           // If-condition for version 8+
-          if (len + sizeof(len) == static_cast<uint16_t>(received))
+          if (len + sizeof(len) <= static_cast<uint64_t>(_received))
           {
-            std::string srcAddr = inet_ntoa(clntAddr.sin_addr);
-            uint16_t srcPort = ntohs(clntAddr.sin_port);
+            std::string srcAddr = inet_ntoa(_clntAddr.sin_addr);
+            uint16_t srcPort = ntohs(_clntAddr.sin_port);
 
             if (this->verbose)
             {
@@ -893,36 +1860,59 @@ namespace gz
                 << srcAddr << ": " << srcPort << std::endl;
             }
 
-            this->DispatchDiscoveryMsg(srcAddr, rcvStr + sizeof(len), len);
+            int64_t offset = 0;
+            while (offset + static_cast<int64_t>(sizeof(len)) <= _received)
+            {
+              memcpy(&len, &_rcvStr[offset], sizeof(len));
+              offset += sizeof(len);
+              if (offset + len > _received)
+                break;
+
+              this->DispatchDiscoveryMsg(srcAddr, _rcvStr + offset, len,
+                fromServer);
+              offset += len;
+            }
           }
         }
-        else if (received < 0)
-        {
-          std::cerr << "Discovery::RecvDiscoveryUpdate() recvfrom error"
-            << std::endl;
-        }
       }
 
       /// \brief Parse a discovery message received via the UDP socket
       /// \param[in] _fromIp IP address of the message sender.
       /// \param[in] _msg Received message.
       /// \param[in] _len Entire length of the package in octets.
+      /// \param[in] _fromServer True if the message was forwarded by the
+      /// discovery server.
       private: void DispatchDiscoveryMsg(const std::string &_fromIp,
-                                         char *_msg, uint16_t _len)
+                                         char *_msg, uint16_t _len,
+                                         const bool _fromServer = false)
       {
-        gz::msgs::Discovery msg;
+        // The parsed message is reused, so its fields keep their memory
+        // between messages.
+        gz::msgs::Discovery &msg = this->rcvMsg;
 
         // Parse the message, and return if parsing failed. Parsing could
         // fail when another discovery node is publishing messages using an
         // older (or newer) format.
-        if (!msg.ParseFromArray(_msg, _len))
+        const bool compact =
+          _len > 0 && static_cast<uint8_t>(_msg[0]) == kCompactMagic;
+        if (compact ? !DecodeCompact(_msg, _len, msg) :
+            !msg.ParseFromArray(_msg, _len))
+        {
           return;
+        }
 
-        // Discard the message if the wire protocol is different than mine.
-        if (this->Version() != msg.version())
+        // Discard the message if the wire protocol is different than mine,
+        // unless it's the previous one and we can answer in it.
+        const bool legacy = this->Version() != msg.version();
+        if (legacy &&
+            (compact || msg.version() != this->Version(kLegacyWireVersion) ||
+             !this->LegacySupported()))
+        {
+          this->IgnorePeer(_fromIp, msg);
           return;
+        }
 
-        std::string recvPUuid = msg.process_uuid();
+        const std::string &recvPUuid = msg.process_uuid();
 
         // Discard our own discovery messages.
         if (recvPUuid == this->pUuid)
@@ -942,7 +1932,7 @@ namespace gz
           // Unset the RELAY flag in the header and set the NO_RELAY.
           msg.mutable_flags()->set_relay(false);
           msg.mutable_flags()->set_no_relay(true);
-          this->SendMulticast(msg);
+          this->outMulticast.push_back(msg);
 
           // A unicast peer contacted me. I need to save its address for
           // sending future messages in the future.
@@ -957,13 +1947,22 @@ namespace gz
         else if (!msg.has_flags() || !msg.flags().no_relay())
         {
           msg.mutable_flags()->set_relay(true);
-          this->SendUnicast(msg);
+          if (!this->relayAddrs.empty())
+            this->outUnicast.push_back(msg);
         }
 
         bool isSenderLocal = (std::find(this->hostInterfaces.begin(),
           this->hostInterfaces.end(), _fromIp) != this->hostInterfaces.end()) ||
           (_fromIp.find("127.") == 0);
 
+        // The discovery server tells us if the original sender is in our
+        // host, its own address doesn't say anything about it.
+        if (_fromServer)
+        {
+          std::vector<std::string> values;
+          isSenderLocal = HeaderData(msg, kServerLocalKey, values);
+        }
+
         // Update timestamp and cache the callbacks.
         DiscoveryCallback<Pub> connectCb;
         DiscoveryCallback<Pub> disconnectCb;
@@ -972,7 +1971,19 @@ namespace gz
         std::function<void()> subscribersReqCb;
         {
           std::lock_guard<std::mutex> lock(this->mutex);
-          this->activity[recvPUuid] = std::chrono::steady_clock::now();
+          Timestamp now = std::chrono::steady_clock::now();
+          this->activity[recvPUuid] = now;
+          this->timeNextActivity = std::min(this->timeNextActivity,
+            this->Expiration(now, this->PeerSilence(recvPUuid)));
+
+          std::vector<std::string> values;
+          if (compact || (msg.type() == msgs::Discovery::HEARTBEAT &&
+                HeaderData(msg, kCompactKey, values)))
+          {
+            this->remoteStates[recvPUuid].compact = true;
+          }
+          if (legacy)
+            this->remoteStates[recvPUuid].legacy = true;
           connectCb = this->connectionCb;
           disconnectCb = this->disconnectionCb;
           registerCb = this->registrationCb;
@@ -984,23 +1995,50 @@ namespace gz
         {
           case msgs::Discovery::ADVERTISE:
           {
-            // Read the rest of the fields.
-            Pub publisher;
-            publisher.SetFromDiscovery(msg);
-
             // Check scope of the topic.
-            if ((publisher.Options().Scope() == Scope_t::PROCESS) ||
-                (publisher.Options().Scope() == Scope_t::HOST &&
-                 !isSenderLocal))
-            {
-              return;
-            }
-
-            // Register an advertised address for the topic.
-            bool added;
+            const auto &pubMsg = msg.pub();
+            bool accepted =
+              pubMsg.scope() == msgs::Discovery::Publisher::ALL ||
+              (pubMsg.scope() == msgs::Discovery::Publisher::HOST &&
+               isSenderLocal);
+
+            // Register an advertised address for the topic. The publishers
+            // of the topics that aren't interesting still count for the
+            // version of the state of the process. The publishers that we
+            // already know (e.g.: repeated by several catalogs) aren't
+            // read again.
+            Pub publisher;
+            bool added = false;
+            std::vector<std::string> update;
             {
               std::lock_guard<std::mutex> lock(this->mutex);
-              added = this->info.AddPublisher(publisher);
+
+              // A publisher of the warm start is confirmed.
+              if (accepted && !this->warmPublishers.empty())
+              {
+                this->warmPublishers.erase(std::make_tuple(pubMsg.topic(),
+                  pubMsg.process_uuid(), pubMsg.node_uuid()));
+              }
+
+              if (accepted && this->IsInteresting(pubMsg.topic()) &&
+                  !this->info.HasPublisher(pubMsg.topic(),
+                    pubMsg.process_uuid(), pubMsg.node_uuid()))
+              {
+                // Read the rest of the fields.
+                publisher.SetFromDiscovery(msg);
+                added = this->info.AddPublisher(publisher);
+              }
+              else if (accepted && HeaderData(msg, kUpdateKey, update))
+              {
+                // The publisher stays connected, only its information is
+                // replaced.
+                publisher.SetFromDiscovery(msg);
+                this->info.DelPublisherByNode(pubMsg.topic(),
+                  pubMsg.process_uuid(), pubMsg.node_uuid());
+                this->info.AddPublisher(publisher);
+              }
+              this->UpdateRemoteState(pubMsg.process_uuid(), msg, accepted,
+                isSenderLocal);
             }
 
             if (added && connectCb)
@@ -1013,6 +2051,27 @@ namespace gz
           }
           case msgs::Discovery::SUBSCRIBE:
           {
+            // A peer is missing part of the state of a process.
+            std::vector<std::string> stateReq;
+            if (HeaderData(msg, kStateReqKey, stateReq))
+            {
+              if (stateReq.size() == 2u && stateReq[0] == this->pUuid)
+              {
+                this->SendState(
+                  std::strtoull(stateReq[1].c_str(), nullptr, 10));
+              }
+              break;
+            }
+
+            // A new peer wants to know everything that we know.
+            std::vector<std::string> catalogReq;
+            if (HeaderData(msg, kCatalogReqKey, catalogReq))
+            {
+              if (catalogReq.size() == 1u)
+                this->ScheduleCatalog(catalogReq[0], isSenderLocal);
+              break;
+            }
+
             std::string recvTopic;
             // Read the topic information.
             if (msg.has_sub())
@@ -1039,6 +2098,7 @@ namespace gz
                 break;
             }
 
+            std::vector<msgs::Discovery> answers;
             for (const auto &nodeInfo : addresses[this->pUuid])
             {
               // Check scope of the topic.
@@ -1050,10 +2110,17 @@ namespace gz
               }
 
               // Answer an ADVERTISE message.
-              this->SendMsg(DestinationType::ALL,
-                  msgs::Discovery::ADVERTISE, nodeInfo);
+              answers.emplace_back();
+              this->FillMsg(msgs::Discovery::ADVERTISE, nodeInfo,
+                answers.back());
             }
 
+            // A peer of the previous wire protocol only understands the
+            // answers in that protocol.
+            if (legacy)
+              this->SendLegacy(std::move(answers));
+            else
+              this->Queue(DestinationType::ALL, std::move(answers));
             break;
           }
           case msgs::Discovery::SUBSCRIBERS_REQ:
@@ -1099,7 +2166,61 @@ namespace gz
           }
           case msgs::Discovery::HEARTBEAT:
           {
-            // The timestamp has already been updated.
+            // The header of a catalog.
+            std::vector<std::string> catalog;
+            if (HeaderData(msg, kCatalogKey, catalog))
+            {
+              if (catalog.size() == 2u)
+              {
+                std::lock_guard<std::mutex> lock(this->mutex);
+
+                // Another peer is answering, don't send the same catalog.
+                this->catalogRequests.erase(catalog[0]);
+
+                if (catalog[0] == this->pUuid && !this->initialized)
+                {
+                  this->catalogExpected =
+                    std::strtoull(catalog[1].c_str(), nullptr, 10);
+                  if (this->catalogReceived >= this->catalogExpected)
+                    this->SetInitialized();
+                }
+              }
+              break;
+            }
+
+            // The interval between the heartbeats of an adaptive peer.
+            std::vector<std::string> period;
+            const bool hasPeriod = HeaderData(msg, kHeartbeatKey, period) &&
+              period.size() == 1u;
+            {
+              std::lock_guard<std::mutex> lock(this->mutex);
+              this->remoteStates[recvPUuid].heartbeat = hasPeriod ?
+                static_cast<unsigned int>(
+                  std::strtoul(period[0].c_str(), nullptr, 10)) : 0u;
+            }
+
+            // The timestamp has already been updated. Request the changes
+            // of the state of the process that we haven't received.
+            std::vector<std::string> state;
+            if (!HeaderData(msg, kStateKey, state) || state.size() != 1u)
+              break;
+
+            uint64_t version = std::strtoull(state[0].c_str(), nullptr, 10);
+            uint64_t known;
+            {
+              std::lock_guard<std::mutex> lock(this->mutex);
+              known = this->remoteStates[recvPUuid].version;
+            }
+
+            if (version != known)
+            {
+              msgs::Discovery req;
+              Publisher pub("", "", this->pUuid, "", AdvertiseOptions());
+              this->FillMsg(msgs::Discovery::SUBSCRIBE, pub, req);
+              SetHeaderData(req, kStateReqKey,
+                {recvPUuid, std::to_string(known)});
+              this->Queue(DestinationType::ALL, {req});
+            }
             break;
           }
           case msgs::Discovery::BYE:
@@ -1108,6 +2229,7 @@ namespace gz
             {
               std::lock_guard<std::mutex> lock(this->mutex);
               this->activity.erase(recvPUuid);
+              this->remoteStates.erase(recvPUuid);
             }
 
             if (disconnectCb)
@@ -1132,10 +2254,17 @@ namespace gz
             Pub publisher;
             publisher.SetFromDiscovery(msg);
 
+            bool interesting;
+            {
+              std::lock_guard<std::mutex> lock(this->mutex);
+              this->UpdateRemoteState(recvPUuid, msg, false, isSenderLocal);
+              interesting = this->IsInteresting(publisher.Topic());
+            }
+
             // Check scope of the topic.
             if ((publisher.Options().Scope() == Scope_t::PROCESS) ||
                 (publisher.Options().Scope() == Scope_t::HOST &&
-                 !isSenderLocal))
+                 !isSenderLocal) || !interesting)
             {
               return;
             }
@@ -1155,193 +2284,1072 @@ namespace gz
 
             break;
           }
-          default:
+          default:
+          {
+            std::cerr << "Unknown message type [" << msg.type() << "].\n";
+            break;
+          }
+        }
+      }
+
+      /// \brief Broadcast a discovery message.
+      /// \param[in] _type Message type.
+      /// \param[in] _pub Publishers's information to send.
+      /// \param[in] _flags Optional flags. Currently, the flags are not used
+      /// but they will in the future for specifying things like compression,
+      /// or encryption.
+      private: template<typename T>
+      void SendMsg(const DestinationType &_destType,
+                   const msgs::Discovery::Type _type,
+                   const T &_pub) const
+      {
+        gz::msgs::Discovery discoveryMsg;
+        if (!this->FillMsg(_type, _pub, discoveryMsg))
+          return;
+
+        this->SendMsgs(_destType, {discoveryMsg});
+      }
+
+      /// \brief Fill a discovery message.
+      /// \param[in] _type Message type.
+      /// \param[in] _pub Publishers's information to send.
+      /// \param[out] _msg Discovery message.
+      /// \return True if the type is valid or false otherwise.
+      private: template<typename T>
+      bool FillMsg(const msgs::Discovery::Type _type,
+                   const T &_pub,
+                   msgs::Discovery &_msg) const
+      {
+        _msg.set_version(this->Version());
+        _msg.set_type(_type);
+        _msg.set_process_uuid(this->pUuid);
+        _pub.FillDiscovery(_msg);
+
+        switch (_type)
+        {
+          case msgs::Discovery::ADVERTISE:
+          case msgs::Discovery::UNADVERTISE:
+          case msgs::Discovery::NEW_CONNECTION:
+          case msgs::Discovery::END_CONNECTION:
+          {
+            _pub.FillDiscovery(_msg);
+            break;
+          }
+          case msgs::Discovery::SUBSCRIBE:
+          {
+            _msg.mutable_sub()->set_topic(_pub.Topic());
+            break;
+          }
+          case msgs::Discovery::HEARTBEAT:
+          case msgs::Discovery::BYE:
+          case msgs::Discovery::SUBSCRIBERS_REQ:
+          case msgs::Discovery::SUBSCRIBERS_REP:
+            break;
+          default:
+            std::cerr << "Discovery::SendMsg() error: Unrecognized message"
+                      << " type [" << _type << "]" << std::endl;
+            return false;
+        }
+
+        if (this->verbose)
+        {
+          std::cout << "\t* Sending " << msgs::ToString(_type)
+                    << " msg [" << _pub.Topic() << "]" << std::endl;
+        }
+
+        return true;
+      }
+
+      /// \brief Broadcast discovery messages. The messages are packed in as
+      /// few datagrams as possible.
+      /// \param[in] _destType Destination of the messages.
+      /// \param[in] _msgs Discovery messages.
+      private: void SendMsgs(const DestinationType &_destType,
+                             std::vector<msgs::Discovery> _msgs) const
+      {
+        if (_msgs.empty())
+          return;
+
+        // The peers of the previous wire protocol receive their own copy.
+        if (_destType != DestinationType::UNICAST)
+          this->SendLegacy(_msgs);
+
+        if (_destType == DestinationType::MULTICAST ||
+            _destType == DestinationType::ALL)
+        {
+          // The discovery server replaces the multicast group while it
+          // answers.
+          this->SendServer(_msgs);
+          if (!this->serverReachable)
+            this->SendMulticast(_msgs);
+        }
+
+        // Send the discovery messages to the unicast relays.
+        if (_destType == DestinationType::UNICAST ||
+            _destType == DestinationType::ALL)
+        {
+          // Set the RELAY flag in the header.
+          for (auto &msg : _msgs)
+            msg.mutable_flags()->set_relay(true);
+          this->SendUnicast(_msgs);
+        }
+      }
+
+      /// \brief Queue discovery messages sent by the reception thread. They
+      /// are packed and sent together by Flush() at the end of the current
+      /// iteration of the thread.
+      /// \param[in] _destType Destination of the messages.
+      /// \param[in] _msgs Discovery messages.
+      private: void Queue(const DestinationType &_destType,
+                          std::vector<msgs::Discovery> _msgs)
+      {
+        for (auto &msg : _msgs)
+        {
+          if ((_destType == DestinationType::UNICAST ||
+               _destType == DestinationType::ALL) && !this->relayAddrs.empty())
+          {
+            this->outUnicast.push_back(msg);
+            this->outUnicast.back().mutable_flags()->set_relay(true);
+          }
+
+          if (_destType == DestinationType::MULTICAST ||
+              _destType == DestinationType::ALL)
+          {
+            this->outbox.push_back(std::move(msg));
+          }
+        }
+      }
+
+      /// \brief Send the messages queued by the reception thread.
+      private: void Flush()
+      {
+        // The discovery server replaces the multicast group while it
+        // answers.
+        this->SendServer(this->outbox);
+        if (!this->serverReachable)
+        {
+          this->outMulticast.insert(this->outMulticast.end(),
+            std::make_move_iterator(this->outbox.begin()),
+            std::make_move_iterator(this->outbox.end()));
+        }
+        this->SendMulticast(this->outMulticast);
+        this->SendUnicast(this->outUnicast);
+
+        this->outbox.clear();
+        this->outMulticast.clear();
+        this->outUnicast.clear();
+      }
+
+      /// \brief Pack discovery messages in datagrams. Each message is
+      /// preceded by its size and the datagrams don't exceed
+      /// kMaxDatagramSize unless a single message is bigger.
+      /// \param[in] _msgs Discovery messages.
+      /// \param[out] _datagrams The datagrams to send.
+      /// \param[in] _compact True to encode the heartbeats in the compact
+      /// format, see EncodeCompact().
+      /// \return True if all the messages were serialized.
+      private: bool Pack(const std::vector<msgs::Discovery> &_msgs,
+                         std::vector<std::string> &_datagrams,
+                         const bool _compact = false) const
+      {
+        std::string compact;
+        for (const auto &msg : _msgs)
+        {
+          uint16_t msgSize;
+
+          if (_compact && EncodeCompact(msg, compact))
+          {
+            msgSize = static_cast<uint16_t>(compact.size());
+            if (_datagrams.empty() || _datagrams.back().size() +
+                sizeof(msgSize) + msgSize > this->kMaxDatagramSize)
+            {
+              _datagrams.emplace_back();
+            }
+            std::string &datagram = _datagrams.back();
+            datagram.append(reinterpret_cast<const char *>(&msgSize),
+              sizeof(msgSize));
+            datagram.append(compact);
+            continue;
+          }
+
+#if GOOGLE_PROTOBUF_VERSION >= 3004000
+          size_t msgSizeFull = msg.ByteSizeLong();
+#else
+          int msgSizeFull = msg.ByteSize();
+#endif
+          if (msgSizeFull + sizeof(msgSize) > this->kMaxRcvStr)
+          {
+            std::cerr << "Discovery message too large to send. Discovery "
+              << "won't work. This shouldn't happen.\n";
+            return false;
+          }
+          msgSize = static_cast<uint16_t>(msgSizeFull);
+
+          if (_datagrams.empty() || _datagrams.back().size() +
+              sizeof(msgSize) + msgSize > this->kMaxDatagramSize)
+          {
+            _datagrams.emplace_back();
+          }
+
+          std::string &datagram = _datagrams.back();
+          const std::size_t offset = datagram.size();
+          datagram.resize(offset + sizeof(msgSize) + msgSize);
+          memcpy(&datagram[offset], &msgSize, sizeof(msgSize));
+          if (!msg.SerializeToArray(&datagram[offset + sizeof(msgSize)],
+                msgSize))
+          {
+            std::cerr << "Discovery::Pack: Error serializing data."
+              << std::endl;
+            return false;
+          }
+        }
+
+        return true;
+      }
+
+      /// \brief Send discovery messages through all unicast relays.
+      /// \param[in] _msgs Discovery messages.
+      private: void SendUnicast(const std::vector<msgs::Discovery> &_msgs)
+        const
+      {
+        std::vector<std::string> datagrams;
+        if (this->relayAddrs.empty() ||
+            !this->Pack(_msgs, datagrams, this->compactHeartbeats))
+        {
+          return;
+        }
+
+        errno = 0;
+        if (!SendDatagrams(this->sockets.at(0), datagrams,
+              this->relayAddrs))
+        {
+          std::cerr << "Exception sending a unicast message:" << std::endl;
+          std::cerr << "  Error code: " << strerror(errno) << std::endl;
+        }
+      }
+
+      /// \brief Send discovery messages through the multicast group.
+      /// \param[in] _msgs Discovery messages.
+      private: void SendMulticast(const std::vector<msgs::Discovery> &_msgs)
+        const
+      {
+        std::vector<std::string> datagrams;
+        if (!this->Pack(_msgs, datagrams, this->compactHeartbeats))
+          return;
+
+        // Send the discovery messages to the multicast group through all
+        // the sockets.
+        for (const auto &sock : this->Sockets())
+        {
+          errno = 0;
+          if (!SendDatagrams(sock, datagrams, {*this->MulticastAddr()}))
+          {
+            // Ignore EPERM and ENOBUFS errors.
+            //
+            // See issue #106
+            //
+            // Rationale drawn from:
+            //
+            // * https://groups.google.com/forum/#!topic/comp.protocols.tcp-ip/Qou9Sfgr77E
+            // * https://stackoverflow.com/questions/16555101/sendto-dgrams-do-not-block-for-enobufs-on-osx
+            if (errno != EPERM && errno != ENOBUFS)
+            {
+              std::cerr << "Exception sending a multicast message:"
+                << strerror(errno) << std::endl;
+            }
+          }
+        }
+      }
+
+      /// \brief Send discovery messages to the discovery server, if any.
+      /// \param[in] _msgs Discovery messages.
+      private: void SendServer(const std::vector<msgs::Discovery> &_msgs)
+        const
+      {
+        if (this->serverSocket < 0)
+          return;
+
+        // The server parses the messages, it only understands protobuf.
+        std::vector<std::string> datagrams;
+        if (!this->Pack(_msgs, datagrams))
+          return;
+
+        // The server might not be running yet, the multicast group is used
+        // meanwhile.
+        errno = 0;
+        if (!SendDatagrams(this->serverSocket, datagrams,
+              {this->serverAddr}) &&
+            errno != ECONNREFUSED && errno != EPERM && errno != ENOBUFS)
+        {
+          std::cerr << "Exception sending a message to the discovery "
+                    << "server: " << strerror(errno) << std::endl;
+        }
+      }
+
+      /// \brief Send discovery messages to the peers of the previous wire
+      /// protocol, if any, through the multicast group. The messages are
+      /// converted to that protocol: one message per datagram, without the
+      /// header data, and with the address given to these peers in our
+      /// advertisements. The requests of the state of a process are dropped.
+      /// \param[in] _msgs Discovery messages.
+      /// \sa LegacyAddressCb
+      private: void SendLegacy(std::vector<msgs::Discovery> _msgs) const
+      {
+        std::string addr;
+        {
+          std::lock_guard<std::mutex> lock(this->mutex);
+          if (this->legacyAddress.empty() || !this->LegacyPeers())
+            return;
+          addr = this->legacyAddress;
+        }
+
+        std::vector<std::string> datagrams;
+        for (auto &msg : _msgs)
+        {
+          if (msg.type() == msgs::Discovery::SUBSCRIBE && msg.has_header())
+            continue;
+
+          msg.set_version(this->Version(kLegacyWireVersion));
+          msg.clear_header();
+          if (msg.type() == msgs::Discovery::ADVERTISE ||
+              msg.type() == msgs::Discovery::UNADVERTISE)
+          {
+            msg.mutable_pub()->set_address(addr);
+          }
+
+          std::vector<std::string> datagram;
+          if (this->Pack({msg}, datagram))
+            datagrams.push_back(std::move(datagram.front()));
+        }
+
+        for (const auto &sock : this->Sockets())
+        {
+          errno = 0;
+          if (!SendDatagrams(sock, datagrams, {*this->MulticastAddr()}) &&
+              errno != EPERM && errno != ENOBUFS)
+          {
+            std::cerr << "Exception sending a multicast message:"
+              << strerror(errno) << std::endl;
+          }
+        }
+      }
+
+      /// \brief Check whether we know a peer of the previous wire protocol.
+      /// Must be called with the mutex locked.
+      /// \return True if one of the remote processes uses it.
+      private: bool LegacyPeers() const
+      {
+        for (const auto &state : this->remoteStates)
+        {
+          if (state.second.legacy)
+            return true;
+        }
+        return false;
+      }
+
+      /// \brief Check whether the peers of the previous wire protocol are
+      /// supported. The address given to them is requested the first time.
+      /// \return True if they are supported.
+      /// \sa LegacyAddressCb
+      private: bool LegacySupported()
+      {
+        std::function<std::string()> cb;
+        {
+          std::lock_guard<std::mutex> lock(this->mutex);
+          if (this->legacyAsked)
+            return !this->legacyAddress.empty();
+          this->legacyAsked = true;
+          cb = this->legacyAddressCb;
+        }
+
+        // The callback might create sockets, it isn't run with the mutex
+        // locked.
+        const std::string addr = cb ? cb() : "";
+
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->legacyAddress = addr;
+        return !addr.empty();
+      }
+
+      /// \brief Report that the discovery messages of a process are ignored
+      /// because of its wire protocol. Each process is only reported once.
+      /// \param[in] _fromIp IP address of the sender.
+      /// \param[in] _msg Discovery message received.
+      private: void IgnorePeer(const std::string &_fromIp,
+                               const msgs::Discovery &_msg)
+      {
+        {
+          std::lock_guard<std::mutex> lock(this->mutex);
+          if (this->ignoredPeers.size() >= kMaxIgnoredPeers)
+            this->ignoredPeers.clear();
+          if (!this->ignoredPeers.insert(_msg.process_uuid()).second)
+            return;
+        }
+
+        std::cerr << "Ignoring the discovery messages of process ["
+                  << _msg.process_uuid() << "] at [" << _fromIp
+                  << "]: its wire protocol version [" << _msg.version()
+                  << "] is not compatible with ours ["
+                  << static_cast<int>(this->Version()) << "]." << std::endl;
+      }
+
+      /// \brief Send datagrams through a socket. Each datagram is sent to
+      /// every destination with as few system calls as possible.
+      /// \param[in] _sock Socket.
+      /// \param[in] _datagrams Datagrams to send.
+      /// \param[in] _dests Destinations.
+      /// \return True if all the datagrams were sent or false otherwise. In
+      /// that case errno contains the error.
+      private: bool SendDatagrams(const int _sock,
+        const std::vector<std::string> &_datagrams,
+        const std::vector<sockaddr_in> &_dests) const
+      {
+        const std::size_t total = _datagrams.size() * _dests.size();
+        if (total == 0u)
+          return true;
+
+        GZ_TRANSPORT_PROBE1(discovery__send, total);
+
+#ifdef __linux__
+        std::vector<iovec> iovs(total);
+        std::vector<mmsghdr> hdrs(total);
+        for (std::size_t i = 0; i < total; ++i)
+        {
+          const std::string &datagram = _datagrams[i / _dests.size()];
+          iovs[i].iov_base = const_cast<char *>(datagram.data());
+          iovs[i].iov_len = datagram.size();
+          memset(&hdrs[i], 0, sizeof(hdrs[i]));
+          hdrs[i].msg_hdr.msg_iov = &iovs[i];
+          hdrs[i].msg_hdr.msg_iovlen = 1;
+          hdrs[i].msg_hdr.msg_name =
+            const_cast<sockaddr_in *>(&_dests[i % _dests.size()]);
+          hdrs[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+        }
+
+        // The kernel might send less datagrams than requested per call.
+        std::size_t sent = 0;
+        while (sent < total)
+        {
+          int count = sendmmsg(_sock, &hdrs[sent],
+            static_cast<unsigned int>(total - sent), 0);
+          if (count <= 0)
+            return false;
+
+          for (std::size_t i = 0; i < static_cast<std::size_t>(count); ++i)
+            this->sentBytes += hdrs[sent + i].msg_len;
+          this->sentDatagrams += static_cast<uint64_t>(count);
+          sent += static_cast<std::size_t>(count);
+        }
+#else
+        for (const auto &datagram : _datagrams)
+        {
+          for (const auto &dest : _dests)
+          {
+            auto sent = sendto(_sock,
+              reinterpret_cast<const raw_type *>(datagram.data()),
+              datagram.size(), 0,
+              reinterpret_cast<const sockaddr *>(&dest), sizeof(dest));
+            if (sent != static_cast<int64_t>(datagram.size()))
+              return false;
+
+            ++this->sentDatagrams;
+            this->sentBytes += datagram.size();
+          }
+        }
+#endif
+        return true;
+      }
+
+      /// \brief Fall back to the multicast group when the discovery server
+      /// doesn't answer anymore.
+      private: void UpdateServer()
+      {
+        if (!this->serverReachable ||
+            std::chrono::steady_clock::now() <
+              this->Expiration(this->serverLastSeen))
+        {
+          return;
+        }
+
+        this->serverReachable = false;
+        std::cerr << "Discovery server ["
+                  << inet_ntoa(this->serverAddr.sin_addr) << ":"
+                  << ntohs(this->serverAddr.sin_port)
+                  << "] unreachable. Using the multicast group." << std::endl;
+      }
+
+      /// \brief Record a change of the publishers advertised by this process
+      /// and broadcast it, tagged with the new version of our state.
+      /// \param[in] _type ADVERTISE or UNADVERTISE.
+      /// \param[in] _pub Publisher advertised or unadvertised.
+      /// \param[in] _update True if an ADVERTISE updates a publisher
+      /// already advertised, see Update().
+      private: void PublishChange(const msgs::Discovery::Type _type,
+                                  const Pub &_pub,
+                                  const bool _update = false)
+      {
+        msgs::Discovery msg;
+        if (!this->FillMsg(_type, _pub, msg))
+          return;
+
+        if (_update)
+          SetHeaderData(msg, kUpdateKey, {});
+
+        {
+          std::lock_guard<std::mutex> lock(this->mutex);
+          const uint64_t version = ++this->stateVersion;
+          this->stateChanges.push_back({version, _type, _pub, _update});
+          if (this->stateChanges.size() > kMaxStateChanges)
+            this->stateChanges.pop_front();
+
+          SetHeaderData(msg, kStateKey, {std::to_string(version)});
+        }
+
+        this->SendMsgs(DestinationType::ALL, {msg});
+      }
+
+      /// \brief Answer a request of the state of this process. The changes
+      /// made after the version known by the peer are sent if we still have
+      /// them, otherwise all our publishers are advertised. The messages are
+      /// queued and sent in bursts by SendStateBurst().
+      /// \param[in] _known Version of our state known by the peer.
+      private: void SendState(const uint64_t _known)
+      {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        const uint64_t version = this->stateVersion;
+        if (_known == version)
+          return;
+
+        if (_known < version && !this->stateChanges.empty() &&
+            this->stateChanges.front().version <= _known + 1)
+        {
+          for (const auto &change : this->stateChanges)
+          {
+            if (change.version <= _known)
+              continue;
+
+            msgs::Discovery msg;
+            this->FillMsg(change.type, change.pub, msg);
+            if (change.update)
+              SetHeaderData(msg, kUpdateKey, {});
+            SetHeaderData(msg, kStateKey, {std::to_string(change.version)});
+            this->pendingState.push_back(std::move(msg));
+          }
+        }
+        else
+        {
+          // Several peers usually request the whole state at the same
+          // time, the first multicast answer serves all of them.
+          Timestamp now = std::chrono::steady_clock::now();
+          if (this->lastFullStateVersion == version &&
+              (!this->pendingState.empty() ||
+               now - this->lastFullState <
+                 std::chrono::milliseconds(this->heartbeatInterval)))
+          {
+            return;
+          }
+          this->lastFullStateVersion = version;
+          this->lastFullState = now;
+
+          std::map<std::string, std::vector<Pub>> nodes;
+          this->info.PublishersByProc(this->pUuid, nodes);
+
+          // Number of publishers accepted by any peer and by the peers in
+          // this host only.
+          std::size_t numAll = 0;
+          std::size_t numHost = 0;
+          for (const auto &topic : nodes)
+          {
+            for (const auto &node : topic.second)
+            {
+              if (node.Options().Scope() == Scope_t::ALL)
+                ++numAll;
+              else if (node.Options().Scope() == Scope_t::HOST)
+                ++numHost;
+            }
+          }
+
+          for (const auto &topic : nodes)
+          {
+            for (const auto &node : topic.second)
+            {
+              if (node.Options().Scope() == Scope_t::PROCESS)
+                continue;
+
+              msgs::Discovery msg;
+              this->FillMsg(msgs::Discovery::ADVERTISE, node, msg);
+              SetHeaderData(msg, kFullStateKey,
+                {std::to_string(version), std::to_string(numAll),
+                 std::to_string(numHost)});
+              this->pendingState.push_back(std::move(msg));
+            }
+          }
+        }
+
+        this->timeNextStateBurst = std::min(this->timeNextStateBurst,
+          std::chrono::steady_clock::now());
+      }
+
+      /// \brief Send the next burst of the messages queued by SendState().
+      /// Sending thousands of messages at once would overflow the buffers of
+      /// the network and the peers.
+      private: void SendStateBurst()
+      {
+        std::vector<msgs::Discovery> burst;
+        {
+          std::lock_guard<std::mutex> lock(this->mutex);
+          Timestamp now = std::chrono::steady_clock::now();
+          if (this->pendingState.empty() || now < this->timeNextStateBurst)
+            return;
+
+          while (!this->pendingState.empty() && burst.size() < kStateBurst)
           {
-            std::cerr << "Unknown message type [" << msg.type() << "].\n";
-            break;
+            burst.push_back(std::move(this->pendingState.front()));
+            this->pendingState.pop_front();
           }
+
+          this->timeNextStateBurst = this->pendingState.empty() ?
+            Timestamp::max() :
+            now + std::chrono::milliseconds(kStateBurstInterval);
         }
+
+        this->Queue(DestinationType::ALL, std::move(burst));
       }
 
-      /// \brief Broadcast a discovery message.
-      /// \param[in] _type Message type.
-      /// \param[in] _pub Publishers's information to send.
-      /// \param[in] _flags Optional flags. Currently, the flags are not used
-      /// but they will in the future for specifying things like compression,
-      /// or encryption.
-      private: template<typename T>
-      void SendMsg(const DestinationType &_destType,
-                   const msgs::Discovery::Type _type,
-                   const T &_pub) const
+      /// \brief What we know about the state of a remote process.
+      private: struct RemoteState
       {
-        gz::msgs::Discovery discoveryMsg;
-        discoveryMsg.set_version(this->Version());
-        discoveryMsg.set_type(_type);
-        discoveryMsg.set_process_uuid(this->pUuid);
-        _pub.FillDiscovery(discoveryMsg);
+        /// \brief Version of the state received completely.
+        uint64_t version = 0;
+
+        /// \brief Version of the whole state being received.
+        uint64_t fullVersion = 0;
+
+        /// \brief Publishers received of the whole state.
+        std::set<std::string> fullReceived;
+
+        /// \brief Interval between its heartbeats (ms), or 0 if they don't
+        /// carry it.
+        unsigned int heartbeat = 0;
+
+        /// \brief True if it understands the compact heartbeats.
+        bool compact = false;
+
+        /// \brief True if it uses the previous wire protocol.
+        bool legacy = false;
+      };
+
+      /// \brief Update the version known of the state of a remote process
+      /// after receiving one of its publishers. Must be called with the mutex
+      /// locked.
+      /// \param[in] _pUuid UUID of the process owning the publisher.
+      /// \param[in] _msg ADVERTISE or UNADVERTISE message received.
+      /// \param[in] _accepted True if the publisher was stored.
+      /// \param[in] _isSenderLocal True if the sender is in this host.
+      private: void UpdateRemoteState(const std::string &_pUuid,
+                                      const msgs::Discovery &_msg,
+                                      const bool _accepted,
+                                      const bool _isSenderLocal)
+      {
+        RemoteState &state = this->remoteStates[_pUuid];
 
-        switch (_type)
+        std::vector<std::string> values;
+        if (HeaderData(_msg, kStateKey, values) && values.size() == 1u)
         {
-          case msgs::Discovery::ADVERTISE:
-          case msgs::Discovery::UNADVERTISE:
-          case msgs::Discovery::NEW_CONNECTION:
-          case msgs::Discovery::END_CONNECTION:
+          // Only move forward if we didn't miss any previous change.
+          const uint64_t version =
+            std::strtoull(values[0].c_str(), nullptr, 10);
+          if (version == state.version + 1)
+            state.version = version;
+        }
+        else if (HeaderData(_msg, kFullStateKey, values) &&
+                 values.size() == 3u)
+        {
+          std::size_t expected = std::strtoull(values[1].c_str(), nullptr, 10);
+          if (_isSenderLocal)
+            expected += std::strtoull(values[2].c_str(), nullptr, 10);
+
+          this->AddToFullState(state,
+            std::strtoull(values[0].c_str(), nullptr, 10), expected, _msg,
+            _accepted);
+        }
+        else if (HeaderData(_msg, kCatalogKey, values) && values.size() == 3u)
+        {
+          this->AddToFullState(state,
+            std::strtoull(values[1].c_str(), nullptr, 10),
+            std::strtoull(values[2].c_str(), nullptr, 10), _msg, _accepted);
+
+          // The catalog might contain processes that we haven't heard from.
+          // They'll expire unless we receive their heartbeats.
+          if (_pUuid != _msg.process_uuid() &&
+              this->activity.find(_pUuid) == this->activity.end())
           {
-            _pub.FillDiscovery(discoveryMsg);
-            break;
+            Timestamp now = std::chrono::steady_clock::now();
+            this->activity[_pUuid] = now;
+            this->timeNextActivity =
+              std::min(this->timeNextActivity, this->Expiration(now));
           }
-          case msgs::Discovery::SUBSCRIBE:
+
+          if (values[0] == this->pUuid && !this->initialized &&
+              ++this->catalogReceived >= this->catalogExpected)
           {
-            discoveryMsg.mutable_sub()->set_topic(_pub.Topic());
-            break;
+            this->SetInitialized();
           }
-          case msgs::Discovery::HEARTBEAT:
-          case msgs::Discovery::BYE:
-          case msgs::Discovery::SUBSCRIBERS_REQ:
-          case msgs::Discovery::SUBSCRIBERS_REP:
-            break;
-          default:
-            std::cerr << "Discovery::SendMsg() error: Unrecognized message"
-                      << " type [" << _type << "]" << std::endl;
-            return;
         }
+      }
 
-        if (_destType == DestinationType::MULTICAST ||
-            _destType == DestinationType::ALL)
+      /// \brief Account for a publisher received as part of the whole state
+      /// of a process. Must be called with the mutex locked.
+      /// \param[in, out] _state State of the process.
+      /// \param[in] _version Version of the whole state.
+      /// \param[in] _expected Number of publishers of the whole state.
+      /// \param[in] _msg ADVERTISE message received.
+      /// \param[in] _accepted True if the publisher was stored.
+      private: static void AddToFullState(RemoteState &_state,
+        const uint64_t _version, const std::size_t _expected,
+        const msgs::Discovery &_msg, const bool _accepted)
+      {
+        if (_version != _state.fullVersion)
         {
-          this->SendMulticast(discoveryMsg);
+          _state.fullVersion = _version;
+          _state.fullReceived.clear();
         }
 
-        // Send the discovery message to the unicast relays.
-        if (_destType == DestinationType::UNICAST ||
-            _destType == DestinationType::ALL)
+        // The whole state might take several requests to arrive, count
+        // each publisher once.
+        if (_accepted)
         {
-          // Set the RELAY flag in the header.
-          discoveryMsg.mutable_flags()->set_relay(true);
-          this->SendUnicast(discoveryMsg);
+          _state.fullReceived.insert(
+            _msg.pub().topic() + "@" + _msg.pub().node_uuid());
         }
 
-        if (this->verbose)
+        if (_state.fullReceived.size() >= _expected)
         {
-          std::cout << "\t* Sending " << msgs::ToString(_type)
-                    << " msg [" << _pub.Topic() << "]" << std::endl;
+          _state.version = _version;
+          _state.fullReceived.clear();
         }
       }
 
-      /// \brief Send a discovery message through all unicast relays.
-      /// \param[in] _msg Discovery message.
-      private: void SendUnicast(const msgs::Discovery &_msg) const
+      /// \brief Schedule the answer to a catalog request. The answer is
+      /// delayed a few milliseconds, so only the first peer answering sends
+      /// it. Must be called without the mutex locked.
+      /// \param[in] _pUuid UUID of the process requesting the catalog.
+      /// \param[in] _isSenderLocal True if the process is in this host.
+      private: void ScheduleCatalog(const std::string &_pUuid,
+                                    const bool _isSenderLocal)
       {
-        uint16_t msgSize;
+        std::lock_guard<std::mutex> lock(this->mutex);
 
-#if GOOGLE_PROTOBUF_VERSION >= 3004000
-        size_t msgSizeFull = _msg.ByteSizeLong();
-#else
-        int msgSizeFull = _msg.ByteSize();
-#endif
-        if (msgSizeFull + sizeof(msgSize) > this->kMaxRcvStr)
-        {
-          std::cerr << "Discovery message too large to send. Discovery won't "
-            << "work. This shouldn't happen.\n";
+        // We might not know everything yet.
+        if (!this->initialized)
           return;
-        }
-        msgSize = msgSizeFull;
 
-        uint16_t totalSize = sizeof(msgSize) + msgSize;
-        char *buffer = static_cast<char *>(new char[totalSize]);
-        memcpy(&buffer[0], &msgSize, sizeof(msgSize));
+        std::uniform_int_distribution<int> delay(0, kCatalogMaxDelay);
+        this->catalogRequests[_pUuid] = {std::chrono::steady_clock::now() +
+          std::chrono::milliseconds(delay(this->rng)),
+          _isSenderLocal};
+      }
 
-        if (_msg.SerializeToArray(buffer + sizeof(msgSize), msgSize))
+      /// \brief Queue the catalogs whose delay has elapsed. A catalog is a
+      /// HEARTBEAT with the number of publishers that follow, and then an
+      /// ADVERTISE message per publisher that we know. The publishers of
+      /// the other processes are sent only if their scope is 'All'.
+      private: void SendCatalogs()
+      {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        Timestamp now = std::chrono::steady_clock::now();
+        for (auto it = this->catalogRequests.begin();
+             it != this->catalogRequests.end();)
         {
-          // Send the discovery message to the unicast relays.
-          for (const auto &sockAddr : this->relayAddrs)
+          if (it->second.deadline > now)
           {
-            errno = 0;
-            auto sent = sendto(this->sockets.at(0),
-              reinterpret_cast<const raw_type *>(
-                reinterpret_cast<const unsigned char*>(buffer)),
-              totalSize, 0,
-              reinterpret_cast<const sockaddr *>(&sockAddr),
-              sizeof(sockAddr));
+            ++it;
+            continue;
+          }
 
-            if (sent != totalSize)
+          // The publishers to send, grouped by process.
+          std::map<std::string, std::vector<Pub>> procs;
+          std::vector<std::string> topics;
+          this->info.TopicList(topics);
+          for (const auto &topic : topics)
+          {
+            Addresses_M<Pub> addresses;
+            this->info.Publishers(topic, addresses);
+            for (const auto &proc : addresses)
             {
-              std::cerr << "Exception sending a unicast message:" << std::endl;
-              std::cerr << "  Return value: " << sent << std::endl;
-              std::cerr << "  Error code: " << strerror(errno) << std::endl;
-              break;
+              for (const auto &pub : proc.second)
+              {
+                // Don't spread the publishers of the warm start that might
+                // be gone.
+                if (this->warmPublishers.count(
+                      std::make_tuple(topic, proc.first, pub.NUuid())) > 0)
+                {
+                  continue;
+                }
+
+                const Scope_t scope = pub.Options().Scope();
+                if (scope == Scope_t::ALL ||
+                    (scope == Scope_t::HOST && proc.first == this->pUuid &&
+                     it->second.isLocal))
+                {
+                  procs[proc.first].push_back(pub);
+                }
+              }
+            }
+          }
+
+          std::size_t total = 0;
+          for (const auto &proc : procs)
+            total += proc.second.size();
+
+          msgs::Discovery header;
+          Publisher pub("", "", this->pUuid, "", AdvertiseOptions());
+          this->FillMsg(msgs::Discovery::HEARTBEAT, pub, header);
+          SetHeaderData(header, kCatalogKey,
+            {it->first, std::to_string(total)});
+          this->pendingState.push_back(std::move(header));
+
+          for (const auto &proc : procs)
+          {
+            const uint64_t version = proc.first == this->pUuid ?
+              this->stateVersion : this->remoteStates[proc.first].version;
+            for (const auto &node : proc.second)
+            {
+              msgs::Discovery msg;
+              this->FillMsg(msgs::Discovery::ADVERTISE, node, msg);
+              SetHeaderData(msg, kCatalogKey, {it->first,
+                std::to_string(version), std::to_string(proc.second.size())});
+              this->pendingState.push_back(std::move(msg));
             }
           }
+
+          this->timeNextStateBurst = std::min(this->timeNextStateBurst, now);
+          it = this->catalogRequests.erase(it);
         }
-        else
+      }
+
+      /// \brief Check if we keep track of the remote publishers of a topic.
+      /// Must be called with the mutex locked.
+      /// \param[in] _topic Fully qualified topic name.
+      /// \return True if the topic is interesting.
+      /// \sa SetInterest
+      private: bool IsInteresting(const std::string &_topic) const
+      {
+        if (this->interest.empty() ||
+            this->discoveredTopics.find(_topic) != this->discoveredTopics.end())
         {
-          std::cerr << "Discovery::SendUnicast: Error serializing data."
-            << std::endl;
+          return true;
+        }
+
+        std::string partition;
+        std::string topic;
+        if (!TopicUtils::DecomposeFullyQualifiedTopic(_topic, partition, topic))
+          topic = _topic;
+
+        for (const auto &pattern : this->interest)
+        {
+          if (std::regex_match(topic, pattern))
+            return true;
+        }
+        return false;
+      }
+
+      /// \brief Encode a heartbeat in the compact format: kCompactMagic,
+      /// the wire version, the flags, the process UUID (16 bytes), the
+      /// version of the state (8 bytes) and, for the adaptive processes, the
+      /// interval between the heartbeats (4 bytes). The integers are little
+      /// endian. It is about a quarter of the protobuf heartbeat.
+      /// \param[in] _msg The message.
+      /// \param[out] _out The encoded message.
+      /// \return False if the message isn't a heartbeat that can be encoded,
+      /// e.g.: it carries a catalog or its process UUID isn't a UUID.
+      private: static bool EncodeCompact(const msgs::Discovery &_msg,
+                                         std::string &_out)
+      {
+        if (_msg.type() != msgs::Discovery::HEARTBEAT || !_msg.has_header())
+          return false;
+
+        uint8_t flags = 0;
+        uint64_t state = 0;
+        uint32_t period = 0;
+        bool hasState = false;
+        for (const auto &data : _msg.header().data())
+        {
+          if (data.value_size() != 1)
+            return false;
+          if (data.key() == kStateKey)
+          {
+            state = std::strtoull(data.value(0).c_str(), nullptr, 10);
+            hasState = true;
+          }
+          else if (data.key() == kHeartbeatKey)
+          {
+            period = static_cast<uint32_t>(
+              std::strtoul(data.value(0).c_str(), nullptr, 10));
+            flags |= kCompactPeriod;
+          }
+          else
+          {
+            return false;
+          }
         }
 
-        delete [] buffer;
+        uint8_t uuid[16];
+        if (!hasState || !UuidBytes(_msg.process_uuid(), uuid))
+          return false;
+
+        if (_msg.has_flags() && _msg.flags().relay())
+          flags |= kCompactRelay;
+        if (_msg.has_flags() && _msg.flags().no_relay())
+          flags |= kCompactNoRelay;
+
+        _out.clear();
+        _out.push_back(static_cast<char>(kCompactMagic));
+        _out.push_back(static_cast<char>(_msg.version()));
+        _out.push_back(static_cast<char>(flags));
+        _out.append(reinterpret_cast<const char *>(uuid), sizeof(uuid));
+        for (int i = 0; i < 8; ++i)
+          _out.push_back(static_cast<char>((state >> (8 * i)) & 0xff));
+        if (flags & kCompactPeriod)
+        {
+          for (int i = 0; i < 4; ++i)
+            _out.push_back(static_cast<char>((period >> (8 * i)) & 0xff));
+        }
+        return true;
       }
 
-      /// \brief Send a discovery message through the multicast group.
-      /// \param[in] _msg Discovery message.
-      private: void SendMulticast(const msgs::Discovery &_msg) const
+      /// \brief Decode a compact heartbeat, see EncodeCompact().
+      /// \param[in] _data The encoded heartbeat.
+      /// \param[in] _len Its size.
+      /// \param[out] _msg The equivalent protobuf heartbeat.
+      /// \return False if the heartbeat is malformed.
+      private: static bool DecodeCompact(const char *_data,
+                                         const uint16_t _len,
+                                         msgs::Discovery &_msg)
       {
-        uint16_t msgSize;
+        const auto *data = reinterpret_cast<const uint8_t *>(_data);
+        if (_len < kCompactSize || data[0] != kCompactMagic)
+          return false;
 
-#if GOOGLE_PROTOBUF_VERSION >= 3004000
-        size_t msgSizeFull = _msg.ByteSizeLong();
-#else
-        int msgSizeFull = _msg.ByteSize();
-#endif
-        if (msgSizeFull + sizeof(msgSize) > this->kMaxRcvStr)
+        const uint8_t flags = data[2];
+        const bool hasPeriod = (flags & kCompactPeriod) != 0;
+        if (_len != kCompactSize + (hasPeriod ? 4 : 0))
+          return false;
+
+        _msg.Clear();
+        _msg.set_version(data[1]);
+        _msg.set_type(msgs::Discovery::HEARTBEAT);
+        if (flags & (kCompactRelay | kCompactNoRelay))
         {
-          std::cerr << "Discovery message too large to send. Discovery won't "
-            << "work. This shouldn't happen.\n";
-          return;
+          _msg.mutable_flags()->set_relay((flags & kCompactRelay) != 0);
+          _msg.mutable_flags()->set_no_relay((flags & kCompactNoRelay) != 0);
+        }
+        _msg.set_process_uuid(UuidString(&data[3]));
+
+        uint64_t state = 0;
+        for (int i = 0; i < 8; ++i)
+          state |= static_cast<uint64_t>(data[19 + i]) << (8 * i);
+        SetHeaderData(_msg, kStateKey, {std::to_string(state)});
+
+        if (hasPeriod)
+        {
+          uint32_t period = 0;
+          for (int i = 0; i < 4; ++i)
+            period |= static_cast<uint32_t>(data[kCompactSize + i]) << (8 * i);
+          SetHeaderData(_msg, kHeartbeatKey, {std::to_string(period)});
         }
+        return true;
+      }
 
-        msgSize = msgSizeFull;
-        uint16_t totalSize = sizeof(msgSize) + msgSize;
-        char *buffer = static_cast<char *>(new char[totalSize]);
-        memcpy(&buffer[0], &msgSize, sizeof(msgSize));
+      /// \brief Convert a UUID in its canonical form (lowercase) to bytes.
+      /// \param[in] _uuid The UUID.
+      /// \param[out] _bytes The 16 bytes of the UUID.
+      /// \return False if _uuid isn't a canonical UUID.
+      private: static bool UuidBytes(const std::string &_uuid,
+                                     uint8_t *_bytes)
+      {
+        if (_uuid.size() != 36u)
+          return false;
 
-        if (_msg.SerializeToArray(buffer + sizeof(msgSize), msgSize))
+        auto nibble = [](const char _c) -> int
+        {
+          if (_c >= '0' && _c <= '9')
+            return _c - '0';
+          if (_c >= 'a' && _c <= 'f')
+            return _c - 'a' + 10;
+          return -1;
+        };
+
+        std::size_t n = 0;
+        for (std::size_t i = 0; i < _uuid.size(); ++i)
         {
-          // Send the discovery message to the multicast group through all the
-          // sockets.
-          for (const auto &sock : this->Sockets())
+          if (i == 8 || i == 13 || i == 18 || i == 23)
           {
-            errno = 0;
-            if (sendto(sock, reinterpret_cast<const raw_type *>(
-              reinterpret_cast<const unsigned char*>(buffer)),
-              totalSize, 0,
-              reinterpret_cast<const sockaddr *>(this->MulticastAddr()),
-              sizeof(*(this->MulticastAddr()))) != totalSize)
-            {
-              // Ignore EPERM and ENOBUFS errors.
-              //
-              // See issue #106
-              //
-              // Rationale drawn from:
-              //
-              // * https://groups.google.com/forum/#!topic/comp.protocols.tcp-ip/Qou9Sfgr77E
-              // * https://stackoverflow.com/questions/16555101/sendto-dgrams-do-not-block-for-enobufs-on-osx
-              if (errno != EPERM && errno != ENOBUFS)
-              {
-                std::cerr << "Exception sending a multicast message:"
-                  << strerror(errno) << std::endl;
-              }
-              break;
-            }
+            if (_uuid[i] != '-')
+              return false;
+            continue;
           }
+          const int high = nibble(_uuid[i]);
+          const int low = nibble(_uuid[++i]);
+          if (high < 0 || low < 0)
+            return false;
+          _bytes[n++] = static_cast<uint8_t>((high << 4) | low);
         }
-        else
+        return n == 16u;
+      }
+
+      /// \brief Convert 16 bytes to a UUID in its canonical form.
+      /// \param[in] _bytes The bytes of the UUID.
+      /// \return The UUID.
+      private: static std::string UuidString(const uint8_t *_bytes)
+      {
+        static const char kHex[] = "0123456789abcdef";
+        std::string uuid;
+        uuid.reserve(36);
+        for (int i = 0; i < 16; ++i)
         {
-          std::cerr << "Discovery::SendMulticast: Error serializing data."
-            << std::endl;
+          if (i == 4 || i == 6 || i == 8 || i == 10)
+            uuid.push_back('-');
+          uuid.push_back(kHex[_bytes[i] >> 4]);
+          uuid.push_back(kHex[_bytes[i] & 0x0f]);
         }
+        return uuid;
+      }
+
+      /// \brief Set a key of the header of a discovery message.
+      /// \param[out] _msg Discovery message.
+      /// \param[in] _key Key.
+      /// \param[in] _values Values of the key.
+      private: static void SetHeaderData(msgs::Discovery &_msg,
+        const std::string &_key, const std::vector<std::string> &_values)
+      {
+        auto *data = _msg.mutable_header()->add_data();
+        data->set_key(_key);
+        for (const auto &value : _values)
+          data->add_value(value);
+      }
+
+      /// \brief Get a key of the header of a discovery message.
+      /// \param[in] _msg Discovery message.
+      /// \param[in] _key Key.
+      /// \param[out] _values Values of the key.
+      /// \return True if the key is present or false otherwise.
+      private: static bool HeaderData(const msgs::Discovery &_msg,
+                                      const std::string &_key,
+                                      std::vector<std::string> &_values)
+      {
+        if (!_msg.has_header())
+          return false;
 
-        delete [] buffer;
+        for (const auto &data : _msg.header().data())
+        {
+          if (data.key() == _key)
+          {
+            _values.assign(data.value().begin(), data.value().end());
+            return true;
+          }
+        }
+        return false;
       }
 
       /// \brief Get the list of sockets used for discovery.
@@ -1359,8 +3367,9 @@ namespace gz
       }
 
       /// \brief Get the discovery protocol version.
+      /// \param[in] _wire Version of the wire protocol.
       /// \return The discovery version.
-      private: uint8_t Version() const
+      private: uint8_t Version(const uint8_t _wire = kWireVersion) const
       {
         static std::string gzStats;
         static int topicStats;
@@ -1370,7 +3379,7 @@ namespace gz
           topicStats = (gzStats == "1");
         }
 
-        return this->kWireVersion + (topicStats * 100);
+        return static_cast<uint8_t>(_wire + (topicStats * 100));
       }
 
       /// \brief Register a new network interface in the discovery system.
@@ -1400,6 +3409,35 @@ namespace gz
           return false;
         }
 
+#ifdef IP_TOS
+        // Socket option: IP_TOS. Mark the discovery traffic with a DSCP, so
+        // it isn't delayed on a congested link.
+        std::string dscpStr;
+        if (env("GZ_DISCOVERY_DSCP", dscpStr) && !dscpStr.empty())
+        {
+          int dscp = -1;
+          try
+          {
+            dscp = std::stoi(dscpStr);
+          }
+          catch (...)
+          {
+          }
+
+          int tos = dscp << 2;
+          if (dscp < 0 || dscp > 63)
+          {
+            std::cerr << "GZ_DISCOVERY_DSCP must be a number from 0 to 63, "
+                      << "ignoring [" << dscpStr << "]" << std::endl;
+          }
+          else if (setsockopt(sock, IPPROTO_IP, IP_TOS,
+            reinterpret_cast<const char*>(&tos), sizeof(tos)) != 0)
+          {
+            std::cerr << "Error setting socket option (IP_TOS)." << std::endl;
+          }
+        }
+#endif
+
         this->sockets.push_back(sock);
 
         // Join the multicast group. We have to do it for each network interface
@@ -1458,16 +3496,136 @@ namespace gz
       /// \brief IP Address used for multicast.
       private: std::string multicastGroup;
 
-      /// \brief Timeout used for receiving messages (ms.).
+      /// \brief Longest wait for messages when the reception thread can't be
+      /// woken up (ms.).
       private: const int kTimeout = 250;
 
+      /// \brief Longest datagram sent with several discovery messages. It fits
+      /// in an Ethernet MTU with the IP and UDP headers (bytes).
+      private: static const uint16_t kMaxDatagramSize = 1472;
+
+      /// \brief Number of changes of our state kept for the peers that miss
+      /// some of them.
+#ifdef GZ_TRANSPORT_EMBEDDED
+      private: static const std::size_t kMaxStateChanges = 128;
+#else
+      private: static const std::size_t kMaxStateChanges = 1024;
+#endif
+
+      /// \brief Number of messages sent together when answering a request
+      /// of our state.
+      private: static const std::size_t kStateBurst = 32;
+
+      /// \brief Time between two bursts of messages answering a request of
+      /// our state (ms.).
+      private: static constexpr int kStateBurstInterval = 2;
+
+      /// \brief Header key with the version of the state of a process.
+      private: static constexpr const char *kStateKey = "state";
+
+      /// \brief Header key of a request of the state of a process, with its
+      /// UUID and the version already known.
+      private: static constexpr const char *kStateReqKey = "state_req";
+
+      /// \brief Header key of the messages with the whole state of a
+      /// process, with its version and the number of publishers accepted by
+      /// any peer and by the peers in the same host.
+      private: static constexpr const char *kFullStateKey = "state_full";
+
+      /// \brief Longest delay before answering a catalog request (ms.).
+      private: static const int kCatalogMaxDelay = 20;
+
+      /// \brief Header key of a catalog request, with the UUID of the process
+      /// requesting it.
+      private: static constexpr const char *kCatalogReqKey = "catalog_req";
+
+      /// \brief Header key of the messages of a catalog. The HEARTBEAT with
+      /// the key contains the UUID of the process that requested the catalog
+      /// and the number of publishers. Each publisher is an ADVERTISE with
+      /// the UUID of the requester, and the version of the state of the
+      /// process owning the publisher and its number of publishers.
+      private: static constexpr const char *kCatalogKey = "catalog";
+
+      /// \brief Header key of an ADVERTISE updating a publisher already
+      /// advertised, see Update().
+      private: static constexpr const char *kUpdateKey = "update";
+
+      /// \brief Header key of the interval between the heartbeats of a
+      /// process using the adaptive intervals.
+      private: static constexpr const char *kHeartbeatKey = "heartbeat";
+
+      /// \brief Header key of the heartbeats announcing that the process
+      /// understands the compact heartbeats.
+      private: static constexpr const char *kCompactKey = "compact";
+
+      /// \brief First byte of a compact heartbeat. As a protobuf tag it has
+      /// the invalid wire type 7, so the peers without compact support fail
+      /// to parse the frame and discard it.
+      private: static constexpr uint8_t kCompactMagic = 'G';
+
+      /// \brief Size of a compact heartbeat without the heartbeat interval.
+      private: static constexpr uint16_t kCompactSize = 27;
+
+      /// \brief Flag of a compact heartbeat with the RELAY flag set.
+      private: static constexpr uint8_t kCompactRelay = 1;
+
+      /// \brief Flag of a compact heartbeat with the NO_RELAY flag set.
+      private: static constexpr uint8_t kCompactNoRelay = 2;
+
+      /// \brief Flag of a compact heartbeat carrying the heartbeat interval.
+      private: static constexpr uint8_t kCompactPeriod = 4;
+
+      /// \brief Heartbeat interval per known peer when the adaptive intervals
+      /// are enabled (ms). Every process receives at most 1000 /
+      /// kAdaptivePeerInterval heartbeats per second.
+      private: static const unsigned int kAdaptivePeerInterval = 20;
+
+      /// \brief Shortest adaptive heartbeat interval (ms).
+      private: static const unsigned int kMinAdaptiveHeartbeat = 250;
+
+      /// \brief Longest adaptive heartbeat interval (ms).
+      private: static const unsigned int kMaxAdaptiveHeartbeat = 30000;
+
+      /// \brief Maximum deviation of the adaptive heartbeats from their
+      /// interval, as a fraction of the interval.
+      private: static constexpr double kHeartbeatJitter = 0.2;
+
+      /// \brief Number of heartbeats of an adaptive peer that we can miss
+      /// before it expires.
+      private: static const unsigned int kMissedHeartbeats = 4;
+
+      /// \brief Header key added by the discovery server to the messages sent
+      /// by a process in the host of the recipient.
+      /// \sa DiscoveryServer
+      private: static constexpr const char *kServerLocalKey = "server_local";
+
+      /// \brief Header key of the records of the cache file, the last time
+      /// the process of the publisher was heard (ms since the epoch).
+      /// \sa SetCache
+      private: static constexpr const char *kCacheSeenKey = "cache_seen";
+
+      /// \brief Silence intervals after which the records of the cache
+      /// file are too old to warm start from.
+      private: static const unsigned int kCacheSilences = 10;
+
       /// \brief Longest string to receive.
       private: static const uint16_t kMaxRcvStr =
                std::numeric_limits<uint16_t>::max();
 
+      /// \brief Maximum number of datagrams read at once.
+      private: static const std::size_t kRecvBatch = 8;
+
       /// \brief Wire protocol version. Bump up the version number if you modify
       /// the wire protocol (for discovery or message/service exchange).
-      private: static const uint8_t kWireVersion = 10;
+      private: static const uint8_t kWireVersion = 13;
+
+      /// \brief Version of the wire protocol of gz-transport 13 and
+      /// before, still understood, see LegacyAddressCb().
+      private: static const uint8_t kLegacyWireVersion = 10;
+
+      /// \brief Maximum number of processes remembered as ignored, see
+      /// IgnorePeer().
+      private: static const std::size_t kMaxIgnoredPeers = 1024;
 
       /// \brief Port used to broadcast the discovery messages.
       private: int port;
@@ -1523,24 +3681,212 @@ namespace gz
       /// key is the process uuid.
       protected: std::map<std::string, Timestamp> activity;
 
+      /// \brief A change of the publishers advertised by this process.
+      private: struct StateChange
+      {
+        /// \brief Version of the state after the change.
+        uint64_t version;
+
+        /// \brief ADVERTISE or UNADVERTISE.
+        msgs::Discovery::Type type;
+
+        /// \brief Publisher advertised or unadvertised.
+        Pub pub;
+
+        /// \brief True if an ADVERTISE updates a publisher already
+        /// advertised.
+        bool update;
+      };
+
+      /// \brief Version of the state of this process. It's increased each
+      /// time that a publisher is advertised or unadvertised.
+      private: uint64_t stateVersion = 0;
+
+      /// \brief Last changes of the state of this process.
+      private: std::deque<StateChange> stateChanges;
+
+      /// \brief Version of the state last sent completely.
+      private: uint64_t lastFullStateVersion =
+        std::numeric_limits<uint64_t>::max();
+
+      /// \brief Time at which the state was last sent completely.
+      private: Timestamp lastFullState;
+
+      /// \brief Messages answering the requests of our state, waiting to be
+      /// sent.
+      private: std::deque<msgs::Discovery> pendingState;
+
+      /// \brief Time at which the next burst of pendingState will be sent.
+      private: Timestamp timeNextStateBurst = Timestamp::max();
+
+      /// \brief A catalog request to answer.
+      private: struct CatalogRequest
+      {
+        /// \brief Time at which the catalog will be sent.
+        Timestamp deadline;
+
+        /// \brief True if the process requesting it is in this host.
+        bool isLocal;
+      };
+
+      /// \brief Catalog requests to answer. The key is the UUID of the
+      /// process requesting the catalog.
+      private: std::map<std::string, CatalogRequest> catalogRequests;
+
+      /// \brief Generator of the delays of the catalog answers and the
+      /// jitter of the heartbeats.
+      private: std::mt19937 rng{std::random_device{}()};
+
+      /// \brief Number of publishers of the catalog sent to us.
+      private: std::size_t catalogExpected =
+        std::numeric_limits<std::size_t>::max();
+
+      /// \brief Number of publishers of our catalog received.
+      private: std::size_t catalogReceived = 0;
+
+      /// \brief State of the remote processes. The key is the process uuid.
+      private: std::map<std::string, RemoteState> remoteStates;
+
+      /// \brief Provides the address given to the peers of the previous wire
+      /// protocol. \sa LegacyAddressCb
+      private: std::function<std::string()> legacyAddressCb;
+
+      /// \brief True once legacyAddressCb has been called.
+      private: bool legacyAsked = false;
+
+      /// \brief Address given to the peers of the previous wire protocol, or
+      /// empty if they are ignored.
+      private: std::string legacyAddress;
+
+      /// \brief UUIDs of the processes whose discovery messages are ignored
+      /// because of their wire protocol, each one is only reported once.
+      private: std::set<std::string> ignoredPeers;
+
+      /// \brief True if the adaptive intervals are enabled.
+      /// \sa SetAdaptiveIntervals
+      private: bool adaptive = false;
+
+      /// \brief Patterns of the interesting topics.
+      /// \sa SetInterest
+      private: std::vector<std::regex> interest;
+
+      /// \brief Topics passed to Discover().
+      private: mutable std::set<std::string> discoveredTopics;
+
+      /// \brief Path of the cache file, empty if not persisted.
+      /// \sa SetCache
+      private: std::string cachePath;
+
+      /// \brief Time at which the cache file is rewritten next.
+      private: Timestamp timeNextCache = Timestamp::max();
+
+      /// \brief Publishers of the warm start (topic, process and node UUIDs)
+      /// not advertised again by their processes yet.
+      private: std::set<std::tuple<std::string, std::string, std::string>>
+        warmPublishers;
+
+      /// \brief Time at which the unconfirmed publishers of the warm start
+      /// are discarded.
+      private: Timestamp warmDeadline = Timestamp::max();
+
       /// \brief Print discovery information to stdout.
       private: bool verbose;
 
       /// \brief UDP socket used for sending/receiving discovery messages.
       private: std::vector<int> sockets;
 
+      /// \brief UDP socket used to wake up the reception thread or -1 if it
+      /// couldn't be created.
+      private: int wakeSocket = -1;
+
+      /// \brief Address of the wake up socket.
+      private: sockaddr_in wakeAddr;
+
+      /// \brief UDP socket used to talk to the discovery server, or -1.
+      private: int serverSocket = -1;
+
+      /// \brief Address of the discovery server.
+      private: sockaddr_in serverAddr;
+
+      /// \brief True while the discovery server answers.
+      private: std::atomic<bool> serverReachable{false};
+
+      /// \brief True if all the peers understand the compact heartbeats, so
+      /// our heartbeats are sent in the compact format. See EncodeCompact().
+      private: std::atomic<bool> compactHeartbeats{false};
+
+      /// \brief Number of datagrams sent, see Traffic().
+      private: mutable std::atomic<uint64_t> sentDatagrams{0};
+
+      /// \brief Size (bytes) of the datagrams sent.
+      private: mutable std::atomic<uint64_t> sentBytes{0};
+
+      /// \brief Number of datagrams received. Only updated by the
+      /// reception thread.
+      private: std::atomic<uint64_t> receivedDatagrams{0};
+
+      /// \brief Size (bytes) of the datagrams received.
+      private: std::atomic<uint64_t> receivedBytes{0};
+
+      /// \brief Last time we heard from the discovery server. Only used by
+      /// the reception thread.
+      private: Timestamp serverLastSeen;
+
       /// \brief Internet socket address for sending to the multicast group.
       private: sockaddr_in mcastAddr;
 
       /// \brief Collection of socket addresses used as remote relays.
       private: std::vector<sockaddr_in> relayAddrs;
 
+      /// \brief Buffer where the datagrams are received, kMaxRcvStr bytes
+      /// for each datagram of a batch.
+      private: std::vector<char> rcvBuffer;
+
+      /// \brief Senders of the datagrams of a batch.
+      private: std::vector<sockaddr_in> rcvAddrs;
+
+#ifdef __linux__
+      /// \brief Buffers of the datagrams of a batch.
+      private: std::vector<iovec> rcvIovs;
+
+      /// \brief Headers of the datagrams of a batch.
+      private: std::vector<mmsghdr> rcvHdrs;
+#endif
+
+      /// \brief Messages queued by the reception thread for the discovery
+      /// server, or the multicast group while the server doesn't answer.
+      private: std::vector<msgs::Discovery> outbox;
+
+      /// \brief Messages queued by the reception thread for the multicast
+      /// group only.
+      private: std::vector<msgs::Discovery> outMulticast;
+
+      /// \brief Messages queued by the reception thread for the unicast
+      /// relays.
+      private: std::vector<msgs::Discovery> outUnicast;
+
+      /// \brief Last discovery message received. It's only used by the
+      /// reception thread.
+      private: msgs::Discovery rcvMsg;
+
       /// \brief Mutex to guarantee exclusive access between the threads.
       private: mutable std::mutex mutex;
 
       /// \brief Thread in charge of receiving and handling incoming messages.
       private: std::thread threadReception;
 
+      /// \brief Steps of the discovery running in our reception thread, see
+      /// Start(Discovery &).
+      private: std::shared_ptr<DiscoveryGuest> guest =
+        std::make_shared<DiscoveryGuest>();
+
+      /// \brief Steps registered in the host when running in its reception
+      /// thread, nullptr otherwise.
+      private: std::shared_ptr<DiscoveryGuest> host;
+
+      /// \brief The discoveries of other types host each other.
+      template<typename> friend class Discovery;
+
       /// \brief Time at which the next heartbeat cycle will be sent.
       private: Timestamp timeNextHeartbeat;
 
@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GZ_TRANSPORT_DISCOVERYSERVER_HH_
+#define GZ_TRANSPORT_DISCOVERYSERVER_HH_
+
+#include <cstddef>
+#include <memory>
+
+#include "gz/transport/config.hh"
+#include "gz/transport/Export.hh"
+
+namespace gz
+{
+  namespace transport
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace GZ_TRANSPORT_VERSION_NAMESPACE {
+    //
+    // Forward declarations.
+    class DiscoveryServerPrivate;
+
+    /// \class DiscoveryServer DiscoveryServer.hh
+    /// gz/transport/DiscoveryServer.hh
+    /// \brief A discovery broker for networks without multicast (e.g.: cloud
+    /// VPCs). The clients send their discovery messages to the server, which
+    /// forwards them to its other clients. The requests of the state of a
+    /// process are only forwarded to that process.
+    ///
+    /// The server doesn't store any discovery information, a new client
+    /// learns the state of the other processes from their replies to its
+    /// catalog request.
+    ///
+    /// A server handles a single discovery channel: the messages and the
+    /// services require their own server.
+    /// \sa Discovery::SetServer
+    class GZ_TRANSPORT_VISIBLE DiscoveryServer
+    {
+      /// \brief Default UDP port of the server used for messages discovery.
+      /// The server of the services discovery uses the next port.
+      public: static const int kDefaultPort = 10319;
+
+      /// \brief Constructor.
+      /// \param[in] _port UDP port to listen on. Use 0 for an ephemeral port.
+      /// \param[in] _verbose true for enabling verbose mode.
+      public: explicit DiscoveryServer(const int _port,
+                                       const bool _verbose = false);
+
+      /// \brief Destructor. It stops the server.
+      public: ~DiscoveryServer();
+
+      /// \brief Start the server.
+      /// \return True if the server is running or false otherwise (e.g.: the
+      /// port is already in use).
+      public: bool Start();
+
+      /// \brief Stop the server.
+      public: void Stop();
+
+      /// \brief Get the UDP port the server listens on.
+      /// \return The port, or 0 if the server isn't running.
+      public: int Port() const;
+
+      /// \brief Get the number of clients that sent a message during the
+      /// last silence interval.
+      /// \return The number of clients.
+      public: std::size_t ClientCount() const;
+
+      /// \brief Get the silence interval: the clients are forgotten after
+      /// this time without receiving any message from them.
+      /// \return The interval (milliseconds).
+      public: unsigned int SilenceInterval() const;
+
+      /// \brief Set the silence interval.
+      /// \param[in] _ms New interval (milliseconds).
+      /// \sa SilenceInterval
+      public: void SetSilenceInterval(const unsigned int _ms);
+
+#ifdef _WIN32
+// Disable warning C4251 which is triggered by
+// std::unique_ptr
+#pragma warning(push)
+#pragma warning(disable: 4251)
+#endif
+      /// \brief Private data pointer.
+      private: std::unique_ptr<DiscoveryServerPrivate> dataPtr;
+#ifdef _WIN32
+#pragma warning(pop)
+#endif
+    };
+    }
+  }
+}
+#endif
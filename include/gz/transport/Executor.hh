@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GZ_TRANSPORT_EXECUTOR_HH_
+#define GZ_TRANSPORT_EXECUTOR_HH_
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <memory>
+
+#include "gz/transport/config.hh"
+#include "gz/transport/Export.hh"
+
+namespace gz
+{
+  namespace transport
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace GZ_TRANSPORT_VERSION_NAMESPACE {
+    //
+    class ExecutorPrivate;
+
+    /// \class Executor Executor.hh gz/transport/Executor.hh
+    /// \brief Runs the subscription callbacks bound to it, instead of the
+    /// threads of the transport. Bind a subscription with
+    /// SubscribeOptions::SetCallbackExecutor(), or all the subscriptions of
+    /// a node with NodeOptions::SetCallbackExecutor().
+    ///
+    /// An executor created without threads is spun by the application,
+    /// with SpinOnce(), SpinSome() or Spin(), so the callbacks run in the
+    /// threads of the application, e.g. in its main loop, without any lock.
+    /// An executor with one thread runs the callbacks one at a time, in
+    /// order. An executor with several threads runs them concurrently.
+    ///
+    /// The messages of a topic are handed over to the executor in order. The
+    /// queue depth and policy of the subscriptions bound to an executor
+    /// bound the messages waiting for it.
+    ///
+    /// E.g.:
+    ///
+    ///    auto executor = std::make_shared<Executor>();
+    ///    SubscribeOptions opts;
+    ///    opts.SetCallbackExecutor(executor);
+    ///    node.Subscribe("/foo", cb, opts);
+    ///    while (running)
+    ///      executor->SpinOnce(std::chrono::milliseconds(100));
+    class GZ_TRANSPORT_VISIBLE Executor
+    {
+      /// \brief Constructor.
+      /// \param[in] _threads Number of threads owned by the executor, 0 for
+      /// an executor spun by the application.
+      public: explicit Executor(const std::size_t _threads = 0);
+
+      /// \brief Constructor of an executor whose threads run on the CPUs of
+      /// a NUMA node, e.g. the node of the network interface receiving a
+      /// high bandwidth topic. The callbacks run, and first touch the
+      /// memory they allocate, on that node.
+      /// \param[in] _threads Number of threads owned by the executor.
+      /// \param[in] _numaNode The NUMA node. The threads aren't bound if
+      /// the node has no CPUs.
+      public: Executor(const std::size_t _threads, const int _numaNode);
+
+      /// \brief Destructor. Stop and join the threads of the executor. The
+      /// pending callbacks are discarded.
+      public: ~Executor();
+
+      /// \brief Queue a function to be run by the executor.
+      /// \param[in] _work The function.
+      public: void Post(std::function<void()> _work);
+
+      /// \brief Run the oldest pending function, waiting for one if needed.
+      /// \param[in] _timeout Maximum time to wait. Zero to not wait.
+      /// \return True if a function was run.
+      public: bool SpinOnce(
+        const std::chrono::nanoseconds &_timeout =
+          std::chrono::nanoseconds::zero());
+
+      /// \brief Run the functions pending, without waiting for new ones.
+      /// \return Number of functions run.
+      public: std::size_t SpinSome();
+
+      /// \brief Run the functions as they are queued, until Stop() is
+      /// called.
+      public: void Spin();
+
+      /// \brief Make Spin() return, in every thread spinning the executor,
+      /// and for good. The functions still pending can be run with
+      /// SpinOnce() or SpinSome(). The threads of the executor keep
+      /// running the functions.
+      public: void Stop();
+
+      /// \brief Whether Stop() was called.
+      /// \return True if the executor is stopped.
+      public: bool Stopped() const;
+
+      /// \brief Get the number of functions waiting to be run.
+      /// \return Number of pending functions.
+      public: std::size_t Pending() const;
+
+      /// \brief Get the number of threads owned by the executor.
+      /// \return Number of threads, 0 if it is spun by the application.
+      public: std::size_t ThreadCount() const;
+
+      /// \brief Get the NUMA node the threads of the executor run on.
+      /// \return The node, or -1 if the threads aren't bound to a node.
+      public: int NumaNode() const;
+
+#ifdef _WIN32
+// Disable warning C4251 which is triggered by
+// std::unique_ptr
+#pragma warning(push)
+#pragma warning(disable: 4251)
+#endif
+      /// \internal
+      /// \brief Pointer to private data.
+      private: std::unique_ptr<ExecutorPrivate> dataPtr;
+#ifdef _WIN32
+#pragma warning(pop)
+#endif
+    };
+    }
+  }
+}
+#endif
@@ -18,10 +18,13 @@
 #ifndef GZ_TRANSPORT_HANDLERSTORAGE_HH_
 #define GZ_TRANSPORT_HANDLERSTORAGE_HH_
 
+#include <cstdint>
 #include <map>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "gz/transport/config.hh"
 #include "gz/transport/TransportTypes.hh"
@@ -36,6 +39,15 @@ namespace gz
     /// \class HandlerStorage HandlerStorage.hh
     /// gz/transport/HandlerStorage.hh
     /// \brief Class to store and manage service call handlers.
+    ///
+    /// The handlers of each topic are stored in a contiguous list indexed by
+    /// a hash table on the topic name. The lists are copied on write: adding
+    /// or removing a handler replaces the list of the topic, so a list
+    /// retrieved with TopicHandlers() or MatchingHandlers() remains valid and
+    /// unchanged while it is iterated without holding any lock.
+    ///
+    /// This class is not thread-safe, the caller must serialize the calls.
+    /// The only exception is Version(), which can be called from any thread.
     template<typename T> class HandlerStorage
     {
       /// \brief Stores all the service call data for each topic. The key of
@@ -49,6 +61,26 @@ namespace gz
       using TopicServiceCalls_M =
         std::map<std::string, UUIDHandler_Collection_M>;
 
+      /// \brief An immutable list of handlers.
+      public: using HandlerListPtr =
+        std::shared_ptr<const std::vector<std::shared_ptr<T>>>;
+
+      /// \brief A handler stored for a topic.
+      public: struct Entry
+      {
+        /// \brief UUID of the node owning the handler.
+        std::string nUuid;
+
+        /// \brief UUID of the handler.
+        std::string hUuid;
+
+        /// \brief The handler.
+        std::shared_ptr<T> handler;
+      };
+
+      /// \brief An immutable list of handler entries.
+      public: using EntryListPtr = std::shared_ptr<const std::vector<Entry>>;
+
       /// \brief Constructor.
       public: HandlerStorage() = default;
 
@@ -67,13 +99,30 @@ namespace gz
         std::map<std::string,
           std::map<std::string, std::shared_ptr<T> >> &_handlers) const
       {
-        if (this->data.find(_topic) == this->data.end())
+        EntryListPtr entries = this->TopicHandlers(_topic);
+        if (!entries)
           return false;
 
-        _handlers = this->data.at(_topic);
+        _handlers.clear();
+        for (const Entry &entry : *entries)
+          _handlers[entry.nUuid][entry.hUuid] = entry.handler;
         return true;
       }
 
+      /// \brief Get a snapshot of the handlers of a topic. No memory is
+      /// allocated.
+      /// \param[in] _topic Topic name.
+      /// \return The handlers or nullptr if the topic has no handlers. The
+      /// list is not modified by later changes to the storage.
+      public: EntryListPtr TopicHandlers(const std::string &_topic) const
+      {
+        auto topicIt = this->data.find(_topic);
+        if (topicIt == this->data.end())
+          return nullptr;
+
+        return topicIt->second.entries;
+      }
+
       /// \brief Get the first handler for a topic that matches a specific pair
       /// of request/response types.
       /// \param[in] _topic Topic name.
@@ -86,20 +135,17 @@ namespace gz
                                 const std::string &_repTypeName,
                                 std::shared_ptr<T> &_handler) const
       {
-        if (this->data.find(_topic) == this->data.end())
+        EntryListPtr entries = this->TopicHandlers(_topic);
+        if (!entries)
           return false;
 
-        const auto &m = this->data.at(_topic);
-        for (const auto &node : m)
+        for (const Entry &entry : *entries)
         {
-          for (const auto &handler : node.second)
+          if (_reqTypeName == entry.handler->ReqTypeName() &&
+              _repTypeName == entry.handler->RepTypeName())
           {
-            if (_reqTypeName == handler.second->ReqTypeName() &&
-                _repTypeName == handler.second->RepTypeName())
-            {
-              _handler = handler.second;
-              return true;
-            }
+            _handler = entry.handler;
+            return true;
           }
         }
         return false;
@@ -115,25 +161,58 @@ namespace gz
                                 const std::string &_msgTypeName,
                                 std::shared_ptr<T> &_handler) const
       {
-        if (this->data.find(_topic) == this->data.end())
+        EntryListPtr entries = this->TopicHandlers(_topic);
+        if (!entries)
           return false;
 
-        const auto &m = this->data.at(_topic);
-        for (const auto &node : m)
+        for (const Entry &entry : *entries)
         {
-          for (const auto &handler : node.second)
+          if (_msgTypeName == entry.handler->TypeName() ||
+              entry.handler->TypeName() == kGenericMessageType)
           {
-            if (_msgTypeName == handler.second->TypeName() ||
-                handler.second->TypeName() == kGenericMessageType)
-            {
-              _handler = handler.second;
-              return true;
-            }
+            _handler = entry.handler;
+            return true;
           }
         }
         return false;
       }
 
+      /// \brief Get all the handlers of a topic accepting a specific message
+      /// type, including the generic handlers. The list is computed once and
+      /// cached until the handlers of the topic change, so the message type
+      /// is not compared against each handler for every message.
+      /// \param[in] _topic Topic name.
+      /// \param[in] _msgTypeName Type of the msg in string format.
+      /// \return The handlers, or nullptr if no handler accepts the type.
+      /// The list is shared and must not be modified.
+      public: HandlerListPtr MatchingHandlers(const std::string &_topic,
+                  const std::string &_msgTypeName) const
+      {
+        auto topicIt = this->data.find(_topic);
+        if (topicIt == this->data.end())
+          return nullptr;
+
+        const TopicEntry &topicEntry = topicIt->second;
+        auto cachedIt = topicEntry.matching.find(_msgTypeName);
+        if (cachedIt == topicEntry.matching.end())
+        {
+          auto handlers = std::make_shared<std::vector<std::shared_ptr<T>>>();
+          for (const Entry &entry : *topicEntry.entries)
+          {
+            const std::string typeName = entry.handler->TypeName();
+            if (typeName == _msgTypeName || typeName == kGenericMessageType)
+              handlers->push_back(entry.handler);
+          }
+
+          HandlerListPtr list;
+          if (!handlers->empty())
+            list = std::move(handlers);
+          cachedIt = topicEntry.matching.emplace(_msgTypeName, list).first;
+        }
+
+        return cachedIt->second;
+      }
+
       /// \brief Get a specific handler.
       /// \param[in] _topic Topic name.
       /// \param[in] _nUuid Node UUID of the handler.
@@ -145,25 +224,45 @@ namespace gz
                            const std::string &_hUuid,
                            std::shared_ptr<T> &_handler) const
       {
-        if (this->data.find(_topic) == this->data.end())
+        EntryListPtr entries = this->TopicHandlers(_topic);
+        if (!entries)
           return false;
 
-        auto const &m = this->data.at(_topic);
-        if (m.find(_nUuid) == m.end())
-          return false;
-
-        if (m.at(_nUuid).find(_hUuid) == m.at(_nUuid).end())
-          return false;
+        for (const Entry &entry : *entries)
+        {
+          if (entry.hUuid == _hUuid && entry.nUuid == _nUuid)
+          {
+            _handler = entry.handler;
+            return true;
+          }
+        }
+        return false;
+      }
 
-        _handler = m.at(_nUuid).at(_hUuid);
-        return true;
+      /// \brief Get all the handlers.
+      /// \return A copy of all the handlers. The key is the topic name and
+      /// the value is another map, where the key is the node UUID and the
+      /// value is a map of handler UUIDs to handlers.
+      public: TopicServiceCalls_M AllHandlers() const
+      {
+        TopicServiceCalls_M all;
+        for (const auto &topic : this->data)
+        {
+          for (const Entry &entry : *topic.second.entries)
+            all[topic.first][entry.nUuid][entry.hUuid] = entry.handler;
+        }
+        return all;
       }
 
-      /// \brief Get a reference to all the handlers.
-      /// \return All the handlers.
-      public: TopicServiceCalls_M &AllHandlers()
+      /// \brief Get the version of the storage. The version is incremented
+      /// every time a handler is added or removed. This function can be
+      /// called concurrently with the other functions, so the callers can
+      /// check whether the content they cached is up to date without
+      /// locking.
+      /// \return The version.
+      public: uint64_t Version() const
       {
-        return this->data;
+        return this->version.Load();
       }
 
       /// \brief Add a request handler to a topic. A request handler stores
@@ -175,17 +274,25 @@ namespace gz
                               const std::string &_nUuid,
                               const std::shared_ptr<T> &_handler)
       {
-        // Create the topic entry.
-        if (this->data.find(_topic) == this->data.end())
-          this->data[_topic] = UUIDHandler_Collection_M();
+        const std::string hUuid = _handler->HandlerUuid();
+
+        auto entries = std::make_shared<std::vector<Entry>>();
+        auto topicIt = this->data.find(_topic);
+        if (topicIt != this->data.end())
+        {
+          // Keep the existing handler, if any.
+          for (const Entry &entry : *topicIt->second.entries)
+          {
+            if (entry.hUuid == hUuid && entry.nUuid == _nUuid)
+              return;
+          }
 
-        // Create the Node UUID entry.
-        if (this->data[_topic].find(_nUuid) == this->data[_topic].end())
-          this->data[_topic][_nUuid] = UUIDHandler_M();
+          entries->reserve(topicIt->second.entries->size() + 1);
+          *entries = *topicIt->second.entries;
+        }
 
-        // Add/Replace the Req handler.
-        this->data[_topic][_nUuid].insert(
-          std::make_pair(_handler->HandlerUuid(), _handler));
+        entries->push_back({_nUuid, hUuid, _handler});
+        this->SetEntries(_topic, std::move(entries));
       }
 
       /// \brief Return true if we have stored at least one request for the
@@ -194,10 +301,7 @@ namespace gz
       /// \return true if we have stored at least one request for the topic.
       public: bool HasHandlersForTopic(const std::string &_topic) const
       {
-        if (this->data.find(_topic) == this->data.end())
-          return false;
-
-        return !this->data.at(_topic).empty();
+        return this->data.find(_topic) != this->data.end();
       }
 
       /// \brief Check if a node has at least one handler.
@@ -207,11 +311,16 @@ namespace gz
       public: bool HasHandlersForNode(const std::string &_topic,
                                       const std::string &_nUuid) const
       {
-        if (this->data.find(_topic) == this->data.end())
+        EntryListPtr entries = this->TopicHandlers(_topic);
+        if (!entries)
           return false;
 
-        return this->data.at(_topic).find(_nUuid) !=
-               this->data.at(_topic).end();
+        for (const Entry &entry : *entries)
+        {
+          if (entry.nUuid == _nUuid)
+            return true;
+        }
+        return false;
       }
 
       /// \brief Remove a request handler. The node's uuid is used as a key to
@@ -224,20 +333,10 @@ namespace gz
                                  const std::string &_nUuid,
                                  const std::string &_reqUuid)
       {
-        size_t counter = 0;
-        if (this->data.find(_topic) != this->data.end())
+        return this->RemoveIf(_topic, [&](const Entry &_entry)
         {
-          if (this->data[_topic].find(_nUuid) != this->data[_topic].end())
-          {
-            counter = this->data[_topic][_nUuid].erase(_reqUuid);
-            if (this->data[_topic][_nUuid].empty())
-              this->data[_topic].erase(_nUuid);
-            if (this->data[_topic].empty())
-              this->data.erase(_topic);
-          }
-        }
-
-        return counter > 0;
+          return _entry.hUuid == _reqUuid && _entry.nUuid == _nUuid;
+        });
       }
 
       /// \brief Remove all the handlers from a given node.
@@ -247,21 +346,75 @@ namespace gz
       public: bool RemoveHandlersForNode(const std::string &_topic,
                                          const std::string &_nUuid)
       {
-        size_t counter = 0;
-        if (this->data.find(_topic) != this->data.end())
+        return this->RemoveIf(_topic, [&](const Entry &_entry)
         {
-          counter = this->data[_topic].erase(_nUuid);
-          if (this->data[_topic].empty())
-            this->data.erase(_topic);
+          return _entry.nUuid == _nUuid;
+        });
+      }
+
+      /// \brief Remove the handlers of a topic satisfying a predicate.
+      /// \param[in] _topic Topic name.
+      /// \param[in] _pred The predicate.
+      /// \return True when at least one handler was removed.
+      private: template<typename PredT>
+      bool RemoveIf(const std::string &_topic, const PredT &_pred)
+      {
+        auto topicIt = this->data.find(_topic);
+        if (topicIt == this->data.end())
+          return false;
+
+        const std::vector<Entry> &current = *topicIt->second.entries;
+        auto entries = std::make_shared<std::vector<Entry>>();
+        entries->reserve(current.size());
+        for (const Entry &entry : current)
+        {
+          if (!_pred(entry))
+            entries->push_back(entry);
         }
 
-        return counter > 0;
+        if (entries->size() == current.size())
+          return false;
+
+        this->SetEntries(_topic, std::move(entries));
+        return true;
       }
 
-      /// \brief Stores all the service call data for each topic. The key of
-      /// _data is the topic name. The value is another map, where the key is
-      /// the node UUID and the value is a smart pointer to the handler.
-      private: TopicServiceCalls_M data;
+      /// \brief Replace the handlers of a topic. The topic is removed if
+      /// the list is empty.
+      /// \param[in] _topic Topic name.
+      /// \param[in] _entries The new handlers.
+      private: void SetEntries(const std::string &_topic,
+                               std::shared_ptr<std::vector<Entry>> _entries)
+      {
+        if (_entries->empty())
+          this->data.erase(_topic);
+        else
+        {
+          TopicEntry &topicEntry = this->data[_topic];
+          topicEntry.entries = std::move(_entries);
+          topicEntry.matching.clear();
+        }
+
+        this->version.Increment();
+      }
+
+      /// \brief The handlers of a topic.
+      private: struct TopicEntry
+      {
+        /// \brief All the handlers, never empty. The list is replaced when
+        /// the handlers change.
+        EntryListPtr entries;
+
+        /// \brief Cache of the handlers matching a message type. The key is
+        /// the message type.
+        mutable std::unordered_map<std::string, HandlerListPtr> matching;
+      };
+
+      /// \brief The handlers of each topic. The key is the topic name.
+      private: std::unordered_map<std::string, TopicEntry> data;
+
+      /// \brief Version of the storage, see Version().
+      private: StorageVersion version;
     };
     }
   }
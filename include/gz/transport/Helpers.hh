@@ -72,6 +72,13 @@ namespace gz
     /// \returns id of current process
     unsigned int GZ_TRANSPORT_VISIBLE getProcessId();
 
+    /// \brief Configure the calling thread, an internal thread of the
+    /// transport: name it "gz-<_name>" and apply the CPU affinity and
+    /// scheduling set by the GZ_TRANSPORT_THREAD_AFFINITY and
+    /// GZ_TRANSPORT_THREAD_PRIORITY environment variables.
+    /// \param[in] _name Name of the thread, e.g.: "reception".
+    void GZ_TRANSPORT_VISIBLE configureThread(const std::string &_name);
+
     // Use safer functions on Windows
     #ifdef _MSC_VER
       #define gz_strcat strcat_s
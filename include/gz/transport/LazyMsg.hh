@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GZ_TRANSPORT_LAZYMSG_HH_
+#define GZ_TRANSPORT_LAZYMSG_HH_
+
+#include <cstddef>
+#include <iostream>
+#include <memory>
+
+#include "gz/transport/config.hh"
+
+namespace gz
+{
+  namespace transport
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace GZ_TRANSPORT_VERSION_NAMESPACE {
+    //
+    /// \class LazyMsg LazyMsg.hh gz/transport/LazyMsg.hh
+    /// \brief A view of a serialized message received by a subscriber. The
+    /// message is only deserialized the first time it is accessed, so a
+    /// callback that discards some updates (e.g.: after checking the
+    /// MessageInfo or the size of the data) doesn't pay for parsing them.
+    ///
+    /// The view doesn't own the serialized data, it is only valid during the
+    /// execution of the callback. Copy the message returned by Msg() to keep
+    /// it.
+    ///
+    /// Example:
+    ///
+    ///    std::function<void(const LazyMsg<msgs::Image> &)> cb =
+    ///      [](const LazyMsg<msgs::Image> &_msg)
+    ///    {
+    ///      // Skip the empty images without parsing them.
+    ///      if (_msg.Size() == 0)
+    ///        return;
+    ///      std::cout << _msg->width() << std::endl;
+    ///    };
+    ///    node.Subscribe("/camera", cb);
+    template <typename T>
+    class LazyMsg
+    {
+      /// \brief Constructor.
+      /// \param[in] _data The serialized message.
+      /// \param[in] _size Size of the serialized message (bytes).
+      public: LazyMsg(const char *_data, const std::size_t _size)
+        : data(_data), size(_size)
+      {
+      }
+
+      /// \brief No copy constructor, the view must not outlive the callback.
+      public: LazyMsg(const LazyMsg &) = delete;
+
+      /// \brief No assignment operator.
+      public: LazyMsg &operator=(const LazyMsg &) = delete;
+
+      /// \brief Get the serialized message.
+      /// \return Pointer to the serialized data.
+      public: const char *Data() const
+      {
+        return this->data;
+      }
+
+      /// \brief Get the size of the serialized message.
+      /// \return The size (bytes).
+      public: std::size_t Size() const
+      {
+        return this->size;
+      }
+
+      /// \brief Whether the message has already been deserialized.
+      /// \return True if Parse() or Msg() has been called.
+      public: bool Parsed() const
+      {
+        return this->msg != nullptr;
+      }
+
+      /// \brief Deserialize the message, if not done yet.
+      /// \return True on success or false if the data is not a valid message.
+      public: bool Parse() const
+      {
+        if (!this->msg)
+        {
+          this->msg.reset(new T());
+          this->valid = this->msg->ParseFromArray(
+            this->data, static_cast<int>(this->size));
+          if (!this->valid)
+          {
+            std::cerr << "LazyMsg::Parse() error: ParseFromArray failed"
+                      << std::endl;
+          }
+        }
+        return this->valid;
+      }
+
+      /// \brief Get the message, deserializing it on first access. If the
+      /// data is not a valid message, the fields parsed before the error are
+      /// set.
+      /// \return The message.
+      public: const T &Msg() const
+      {
+        this->Parse();
+        return *this->msg;
+      }
+
+      /// \brief Access a field of the message, deserializing it on first
+      /// access.
+      /// \return Pointer to the message.
+      public: const T *operator->() const
+      {
+        return &this->Msg();
+      }
+
+      /// \brief Get the message, deserializing it on first access.
+      /// \return The message.
+      public: const T &operator*() const
+      {
+        return this->Msg();
+      }
+
+      /// \brief The serialized message.
+      private: const char *data;
+
+      /// \brief Size of the serialized message (bytes).
+      private: std::size_t size;
+
+      /// \brief The message, once deserialized.
+      private: mutable std::unique_ptr<T> msg;
+
+      /// \brief Whether the deserialization succeeded.
+      private: mutable bool valid = false;
+    };
+    }
+  }
+}
+#endif
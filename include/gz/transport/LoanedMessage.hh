@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GZ_TRANSPORT_LOANEDMESSAGE_HH_
+#define GZ_TRANSPORT_LOANEDMESSAGE_HH_
+
+#include <cstddef>
+#include <memory>
+
+#include "gz/transport/config.hh"
+#include "gz/transport/Export.hh"
+
+namespace gz
+{
+  namespace transport
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace GZ_TRANSPORT_VERSION_NAMESPACE {
+    //
+    class LoanedMessagePrivate;
+    class Node;
+
+    /// \class LoanedMessage LoanedMessage.hh gz/transport/LoanedMessage.hh
+    /// \brief A buffer owned by the transport in which a publisher writes a
+    /// serialized message. A loan is obtained with Node::Publisher::Loan()
+    /// and handed back with Node::Publisher::PublishLoaned(). The very same
+    /// buffer is then shared with the raw subscribers and the ZMQ socket, so
+    /// the message is never copied before being sent.
+    ///
+    /// Example:
+    ///
+    ///    auto loan = pub.Loan(msg.ByteSizeLong());
+    ///    msg.SerializeToArray(loan.Data(), static_cast<int>(loan.Size()));
+    ///    pub.PublishLoaned(std::move(loan), msg.GetTypeName());
+    class GZ_TRANSPORT_VISIBLE LoanedMessage
+    {
+      /// \brief Default constructor. The loan is not valid.
+      public: LoanedMessage();
+
+      /// \brief Move constructor.
+      /// \param[in] _other The loan to move. It is no longer valid.
+      public: LoanedMessage(LoanedMessage &&_other);  // NOLINT
+
+      /// \brief Move assignment operator.
+      /// \param[in] _other The loan to move. It is no longer valid.
+      /// \return Reference to this object.
+      public: LoanedMessage &operator=(LoanedMessage &&_other);  // NOLINT
+
+      /// \brief No copy constructor.
+      public: LoanedMessage(const LoanedMessage &) = delete;
+
+      /// \brief No assignment operator.
+      public: LoanedMessage &operator=(const LoanedMessage &) = delete;
+
+      /// \brief Destructor. The buffer is released if it was not published.
+      public: ~LoanedMessage();
+
+      /// \brief Get the buffer where the message is written.
+      /// \return Pointer to the buffer or nullptr if the loan is not valid.
+      public: char *Data();
+
+      /// \brief Get the size of the message.
+      /// \return The size of the message (bytes) or 0 if the loan is not
+      /// valid.
+      public: std::size_t Size() const;
+
+      /// \brief Shrink the message. This is useful when only an upper bound
+      /// of the size was known when the buffer was loaned.
+      /// \param[in] _size New size of the message (bytes).
+      /// \return True on success or false if the loan is not valid or
+      /// _size is larger than the buffer.
+      public: bool Resize(const std::size_t _size);
+
+      /// \brief Whether a buffer is loaned.
+      /// \return True if the message can be written and published.
+      public: bool Valid() const;
+
+      /// \brief Allows this class to be evaluated as a boolean.
+      /// \return True if valid.
+      /// \sa Valid
+      public: explicit operator bool() const;
+
+      /// \brief Node::Publisher creates and publishes the loans.
+      private: friend Node;
+
+      /// \internal
+      /// \brief Private data.
+#ifdef _WIN32
+// Disable warning C4251 which is triggered by
+// std::unique_ptr
+#pragma warning(push)
+#pragma warning(disable: 4251)
+#endif
+      private: std::unique_ptr<LoanedMessagePrivate> dataPtr;
+#ifdef _WIN32
+#pragma warning(pop)
+#endif
+    };
+    }
+  }
+}
+#endif
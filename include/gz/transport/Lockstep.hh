@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GZ_TRANSPORT_LOCKSTEP_HH_
+#define GZ_TRANSPORT_LOCKSTEP_HH_
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gz/transport/Clock.hh"
+#include "gz/transport/config.hh"
+#include "gz/transport/Export.hh"
+#include "gz/transport/NodeOptions.hh"
+
+namespace gz
+{
+  namespace transport
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace GZ_TRANSPORT_VERSION_NAMESPACE {
+    //
+    // Forward declarations.
+    class LockstepPrivate;
+
+    /// \class Lockstep Lockstep.hh gz/transport/Lockstep.hh
+    /// \brief Barrier of a pipeline run in lockstep, e.g. a simulation
+    /// whose plugins and consumers exchange messages at every step. After
+    /// publishing the messages of a step, the process driving the pipeline
+    /// calls WaitForQuiescence(), or Step() with a NetworkClock, which
+    /// returns once every message published on the topics of the lockstep
+    /// has been delivered to all the subscribers of the pipeline and their
+    /// callbacks have returned, including the messages that these callbacks
+    /// published in turn. The pipeline runs as fast as its slowest
+    /// consumer, without fixed sleeps.
+    ///
+    /// Every process of the pipeline creates a Lockstep with the same group
+    /// and adds the same topics. For each topic, every process counts the
+    /// messages sent to each remote process, the messages received, and the
+    /// deliveries whose callbacks are still running or queued. The barrier
+    /// probes the processes of the group over the network and returns when
+    /// two consecutive rounds of counters are balanced and unchanged.
+    ///
+    /// \note A message lost on the way, e.g. dropped by a full queue, keeps
+    /// the counters unbalanced until the barrier times out. The messages
+    /// missing at that point are then forgiven, they don't block the next
+    /// steps.
+    class GZ_TRANSPORT_VISIBLE Lockstep
+    {
+      /// \brief Constructor.
+      /// \param[in] _group Name of the group, the prefix of the topics
+      /// probing the processes of the pipeline.
+      /// \param[in] _options Options of the node probing the processes,
+      /// e.g. its partition. The topics added are in the same partition
+      /// and namespace.
+      public: explicit Lockstep(const std::string &_group = "/lockstep",
+                                const NodeOptions &_options = NodeOptions());
+
+      /// \brief Destructor. The topics are no longer tracked by this object.
+      public: ~Lockstep();
+
+      /// \brief Track the messages of a topic.
+      /// \param[in] _topic The topic.
+      /// \return True if the topic is tracked, false if it already is or
+      /// it isn't valid.
+      public: bool AddTopic(const std::string &_topic);
+
+      /// \brief Get the topics added with AddTopic().
+      /// \return The topics.
+      public: std::vector<std::string> Topics() const;
+
+      /// \brief Block until the messages of the topics have been processed
+      /// by all the subscribers of the group.
+      /// \param[in] _timeout Maximum duration of the wait. A negative value
+      /// waits as long as needed.
+      /// \return True if the group is quiescent, false if the wait timed
+      /// out or the group isn't valid.
+      public: bool WaitForQuiescence(const std::chrono::milliseconds &_timeout
+                  = std::chrono::milliseconds(-1));
+
+      /// \brief Advance a clock and wait for the messages of the step. The
+      /// topic of the clock should be added with AddTopic(), so that the
+      /// subscribers of the clock are waited for too.
+      /// \param[in] _clock The clock, which publishes the new time.
+      /// \param[in] _time Time of the new step.
+      /// \param[in] _timeout Maximum duration of the wait, see
+      /// WaitForQuiescence().
+      /// \return True if the group is quiescent.
+      public: bool Step(NetworkClock &_clock,
+                        const std::chrono::nanoseconds &_time,
+                        const std::chrono::milliseconds &_timeout =
+                          std::chrono::milliseconds(-1));
+
+      /// \brief Get the number of processes that answered the last probe
+      /// of WaitForQuiescence(), this one included.
+      /// \return The number of processes.
+      public: std::size_t Participants() const;
+
+#ifdef _WIN32
+// Disable warning C4251 which is triggered by
+// std::unique_ptr
+#pragma warning(push)
+#pragma warning(disable: 4251)
+#endif
+      /// \brief Private data pointer.
+      private: std::unique_ptr<LockstepPrivate> dataPtr;
+#ifdef _WIN32
+#pragma warning(pop)
+#endif
+    };
+    }
+  }
+}
+#endif
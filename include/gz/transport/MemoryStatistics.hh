@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GZ_TRANSPORT_MEMORYSTATISTICS_HH_
+#define GZ_TRANSPORT_MEMORYSTATISTICS_HH_
+
+#include <cstdint>
+
+#include "gz/transport/config.hh"
+
+namespace gz
+{
+  namespace transport
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace GZ_TRANSPORT_VERSION_NAMESPACE {
+    //
+    /// \brief Memory held by the queues and the caches of the transport in
+    /// this process, see NodeShared::MemoryStats(). The sizes count the
+    /// messages and the requests, not the overhead of the containers.
+    struct MemoryStatistics
+    {
+      /// \brief Publications waiting for the dispatch threads to run the
+      /// callbacks of the local subscribers (bytes).
+      uint64_t publishQueueBytes{0};
+
+      /// \brief Messages handed to ZMQ and not released yet: queued for a
+      /// slow subscriber, up to the high water mark, or being sent (bytes).
+      uint64_t zmqSendBytes{0};
+
+      /// \brief Service requests waiting for a service thread (bytes).
+      uint64_t serviceQueueBytes{0};
+
+      /// \brief Messages kept for the retransmissions and the late joiners
+      /// (bytes).
+      uint64_t historyBytes{0};
+
+      /// \brief Estimated size of the tables of the discovery (bytes).
+      uint64_t discoveryBytes{0};
+
+      /// \brief Memory reported with NodeShared::AddExternalMemory(), e.g.:
+      /// the messages buffered by a log::Recorder (bytes).
+      uint64_t externalBytes{0};
+
+      /// \brief Sum of all the above (bytes).
+      uint64_t totalBytes{0};
+
+      /// \brief Memory cap, 0 if there is none (bytes).
+      uint64_t capBytes{0};
+
+      /// \brief Publications dropped because the memory cap was exceeded.
+      uint64_t capDroppedMessages{0};
+    };
+    }
+  }
+}
+#endif
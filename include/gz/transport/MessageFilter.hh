@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef GZ_TRANSPORT_MESSAGEFILTER_HH_
+#define GZ_TRANSPORT_MESSAGEFILTER_HH_
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include "gz/transport/config.hh"
+#include "gz/transport/Export.hh"
+#include "gz/transport/TransportTypes.hh"
+
+namespace gz
+{
+  namespace transport
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace GZ_TRANSPORT_VERSION_NAMESPACE {
+    //
+    class MessageFilterPrivate;
+
+    /// \class MessageFilter MessageFilter.hh gz/transport/MessageFilter.hh
+    /// \brief A filter on the content of messages, made of conditions on
+    /// the value of their fields. A message matches the filter when it
+    /// satisfies all the conditions.
+    ///
+    /// A condition compares a field, given by the path of the field names
+    /// from the message (e.g. "header.stamp.sec"), to a value written as
+    /// text: the decimal representation of a number, true or false for a
+    /// boolean, the name or number of an enum value, or the string itself.
+    /// When a field of the path is repeated, it is enough that one of the
+    /// elements satisfies the condition, e.g. "header.data.key=frame_id".
+    /// A field which isn't set has its default value.
+    ///
+    /// The serialized messages are matched without deserializing them, the
+    /// fields outside of the paths are skipped. A message whose type isn't
+    /// known by protobuf in this process always matches.
+    ///
+    /// Example:
+    ///
+    ///    MessageFilter filter;
+    ///    filter.AddCondition("header.data.value", "base_link");
+    ///    SubscribeOptions opts;
+    ///    opts.SetFilter(filter);
+    ///    node.Subscribe(topic, cb, opts);
+    class GZ_TRANSPORT_VISIBLE MessageFilter
+    {
+      /// \brief Constructor of a filter without condition, matching every
+      /// message.
+      public: MessageFilter();
+
+      /// \brief Copy constructor.
+      /// \param[in] _other The filter to copy.
+      public: MessageFilter(const MessageFilter &_other);
+
+      /// \brief Destructor.
+      public: ~MessageFilter();
+
+      /// \brief Assignment operator.
+      /// \param[in] _other The filter to copy.
+      /// \return A reference to this filter.
+      public: MessageFilter &operator=(const MessageFilter &_other);
+
+      /// \brief Equality operator.
+      /// \param[in] _other The filter to compare.
+      /// \return True if both filters have the same conditions.
+      public: bool operator==(const MessageFilter &_other) const;
+
+      /// \brief Inequality operator.
+      /// \param[in] _other The filter to compare.
+      /// \return True if the filters have different conditions.
+      public: bool operator!=(const MessageFilter &_other) const;
+
+      /// \brief Add a condition on the value of a field.
+      /// \param[in] _fieldPath Names of the fields from the message,
+      /// separated by dots, e.g. "header.stamp.sec".
+      /// \param[in] _value Expected value of the field, as text.
+      /// \return False if the path is empty or malformed.
+      public: bool AddCondition(const std::string &_fieldPath,
+                                const std::string &_value);
+
+      /// \brief Whether the filter has no condition.
+      /// \return True if every message matches the filter.
+      public: bool Empty() const;
+
+      /// \brief Check if a message matches the filter.
+      /// \param[in] _msg The message.
+      /// \return True if the message satisfies all the conditions.
+      public: bool Match(const ProtoMsg &_msg) const;
+
+      /// \brief Check if a serialized message matches the filter, without
+      /// deserializing it.
+      /// \param[in] _data The serialized message.
+      /// \param[in] _size Size of the serialized message.
+      /// \param[in] _msgType Fully qualified name of the type of the message.
+      /// \return True if the message satisfies all the conditions, or if
+      /// the type isn't known.
+      public: bool Match(const char *_data, const std::size_t _size,
+                         const std::string &_msgType) const;
+
+      /// \brief Get the filter as text, the conditions written as
+      /// "path=value" and separated by '&'. The '&' and '\' characters of
+      /// the values are escaped by a '\'.
+      /// \return The text of the filter, empty without condition.
+      /// \sa Parse
+      public: std::string ToString() const;
+
+      /// \brief Replace the conditions with those of a filter written as
+      /// text by ToString().
+      /// \param[in] _str The text of the filter.
+      /// \return False if the text is malformed, the filter is then empty.
+      public: bool Parse(const std::string &_str);
+
+#ifdef _WIN32
+// Disable warning C4251 which is triggered by
+// std::unique_ptr
+#pragma warning(push)
+#pragma warning(disable: 4251)
+#endif
+      /// \internal
+      /// \brief Private data.
+      private: std::unique_ptr<MessageFilterPrivate> dataPtr;
+#ifdef _WIN32
+#pragma warning(pop)
+#endif
+    };
+    }
+  }
+}
+#endif
@@ -18,6 +18,7 @@
 #ifndef GZ_TRANSPORT_MESSAGEINFO_HH_
 #define GZ_TRANSPORT_MESSAGEINFO_HH_
 
+#include <cstdint>
 #include <memory>
 #include <string>
 
@@ -40,7 +41,9 @@ namespace gz
       public: MessageInfo();
 
       /// \brief Explicit copy constructor (The copy constructor is deleted by
-      /// default due to the use of std::unique_ptr member).
+      /// default due to the use of std::unique_ptr member). The topic,
+      /// partition and type names are shared with _other instead of being
+      /// copied, they are only copied by the first setter called.
       /// \param[in] _other an instance to copy data from
       public: MessageInfo(const MessageInfo &_other);
 
@@ -51,6 +54,12 @@ namespace gz
       /// \brief Destructor.
       public: ~MessageInfo();
 
+      /// \brief Copy assignment operator, sharing the names like the copy
+      /// constructor.
+      /// \param[in] _other an instance to copy data from
+      /// \return A reference to this instance.
+      public: MessageInfo &operator=(const MessageInfo &_other);
+
       /// \brief Get the topic name associated to the message.
       /// \return The topic name.
       public: const std::string &Topic() const;
@@ -89,6 +98,37 @@ namespace gz
       /// \param[in] _value The intra-process value.
       public: void SetIntraProcess(bool _value);
 
+      /// \brief Get the sequence number of the message, set by the
+      /// publisher of a reliable topic (see
+      /// AdvertiseMessageOptions::SetReliable()).
+      /// \return The sequence number, or 0 if the message is not reliable.
+      public: uint64_t Sequence() const;
+
+      /// \brief Set the sequence number of the message.
+      /// \param[in] _seq The sequence number.
+      public: void SetSequence(uint64_t _seq);
+
+      /// \brief Get the number of messages of the same publisher missed just
+      /// before this one, e.g.: dropped by ZMQ at the high water mark. Only
+      /// reported for the messages received from a reliable publisher.
+      /// \return The number of missing messages, 0 if there is no gap.
+      public: uint64_t SequenceGap() const;
+
+      /// \brief Set the number of messages missed before this one.
+      /// \param[in] _gap The number of missing messages.
+      public: void SetSequenceGap(uint64_t _gap);
+
+      /// \brief Whether the message was missed and has been sent again from
+      /// the history of the publisher (see
+      /// AdvertiseMessageOptions::SetHistorySize()). It is received after
+      /// the message that revealed the gap.
+      /// \return True if the message has been retransmitted.
+      public: bool Retransmitted() const;
+
+      /// \brief Set whether the message has been retransmitted.
+      /// \param[in] _value True if the message has been retransmitted.
+      public: void SetRetransmitted(bool _value);
+
 #ifdef _WIN32
 // Disable warning C4251 which is triggered by
 // std::unique_ptr
@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GZ_TRANSPORT_MESSAGETYPES_HH_
+#define GZ_TRANSPORT_MESSAGETYPES_HH_
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable: 4251)
+#endif
+#include <google/protobuf/message.h>
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+
+#include <string>
+
+#include "gz/transport/config.hh"
+#include "gz/transport/Export.hh"
+
+namespace gz
+{
+  namespace transport
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace GZ_TRANSPORT_VERSION_NAMESPACE {
+    //
+    /// \class MessageTypes MessageTypes.hh gz/transport/MessageTypes.hh
+    /// \brief The message types known by the process, used to create the
+    /// messages of the generic subscriptions.
+    ///
+    /// A type is looked up in the protobuf classes compiled in the process,
+    /// then in the descriptors added at runtime with AddDescriptors(), and
+    /// finally in the gz-msgs factory. The prototype of each type is cached,
+    /// so a generic subscription creates its messages as fast as a typed
+    /// one. All the functions can be called from any thread.
+    class GZ_TRANSPORT_VISIBLE MessageTypes
+    {
+      /// \brief Get the prototype of a message type. Create the messages
+      /// with prototype->New().
+      /// \param[in] _type Fully qualified name of the type, e.g.
+      /// "gz.msgs.StringMsg".
+      /// \return The prototype, valid until the end of the process, or
+      /// nullptr if the type is unknown.
+      public: static const google::protobuf::Message *Prototype(
+        const std::string &_type);
+
+      /// \brief Add the descriptors of message types unknown at compile
+      /// time, e.g. read from a log file or received from another process.
+      /// The dependencies missing from the set are taken from the protobuf
+      /// classes compiled in the process. A type already known keeps its
+      /// first definition.
+      /// \param[in] _descriptors A serialized
+      /// google.protobuf.FileDescriptorSet.
+      /// \return True if the descriptors were parsed and added.
+      public: static bool AddDescriptors(const std::string &_descriptors);
+
+      /// \brief Get the descriptors of a message type, e.g. to store them in
+      /// a log file so it can be decoded without the type compiled in.
+      /// \param[in] _type Fully qualified name of the type.
+      /// \return A serialized google.protobuf.FileDescriptorSet with the file
+      /// defining the type and all its dependencies, the dependencies first,
+      /// or an empty string if the type is unknown.
+      public: static std::string Descriptors(const std::string &_type);
+    };
+    }
+  }
+}
+#endif
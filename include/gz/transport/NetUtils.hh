@@ -18,6 +18,8 @@
 #ifndef GZ_TRANSPORT_NETUTILS_HH_
 #define GZ_TRANSPORT_NETUTILS_HH_
 
+#include <chrono>
+#include <map>
 #include <string>
 #include <vector>
 
@@ -38,7 +40,9 @@ namespace gz
     /// \return true if the IP address is private.
     bool isPrivateIP(const char *_ip);
 
-    /// \brief Determine if an IP is private.
+    /// \brief Determine the IPv4 address of a hostname.
+    /// The lookup gives up after GZ_TRANSPORT_RESOLVE_TIMEOUT milliseconds
+    /// (1000 by default), so a slow DNS server can't block the process.
     /// \param[in] _hostname Hostname
     /// \param[out] _ip IP associated to the input hostname.
     /// \return 0 when success.
@@ -47,25 +51,49 @@ namespace gz
     /// \brief Determine IP or hostname.
     /// Reference: https://github.com/ros/ros_comm/blob/hydro-devel/clients/
     /// roscpp/src/libros/network.cpp
+    /// Unless GZ_IP is set, the result is determined once per process.
     /// \return The IP or hostname of this host.
     std::string GZ_TRANSPORT_VISIBLE determineHost();
 
     /// \brief Determine the list of network interfaces for this machine.
     /// Reference: https://github.com/ros/ros_comm/blob/hydro-devel/clients/
     /// roscpp/src/libros/network.cpp
+    /// The list is determined once per process.
     /// \return The list of network interfaces.
     std::vector<std::string> GZ_TRANSPORT_VISIBLE determineInterfaces();
 
-    /// \brief Determine the computer's hostname.
+    /// \brief Determine the local interface in the subnet of a remote IPv4
+    /// address. The traffic to the remote host goes through this interface
+    /// without crossing a router, e.g. on a dedicated sensor network while
+    /// the default route uses another interface. The longest prefix wins.
+    /// A local address is its own interface.
+    /// \param[in] _remoteIp IPv4 address of the remote host.
+    /// \return The IP address of the local interface, or an empty string if
+    /// no interface is in the subnet of _remoteIp.
+    std::string GZ_TRANSPORT_VISIBLE determineLocalInterface(
+      const std::string &_remoteIp);
+
+    /// \brief Determine the computer's hostname, once per process.
     /// \return The computer's hostname.
     std::string GZ_TRANSPORT_VISIBLE hostname();
 
-    /// \brief Determine your login name.
+    /// \brief Determine your login name, once per process.
     /// \return Name used to gain access to the computer.
     /// On linux and Mac only, if determination
     /// of your login name failes then a string of the form "error-UUID"
     /// is returned where UUID is a universally unique identifier.
     std::string GZ_TRANSPORT_VISIBLE username();
+
+    /// \brief Get the time spent by the lookups of this process that slow
+    /// down the creation of the first node, to find out why a process is
+    /// slow to start: "hostname", "username", "interfaces", "resolve" (the
+    /// hostname resolution) and "host" (determineHost(), including the
+    /// resolution and the interfaces). Only the lookups done so far are
+    /// listed. GZ_VERBOSE=1 also prints them when the first node is
+    /// created.
+    /// \return The duration of every lookup.
+    std::map<std::string, std::chrono::nanoseconds> GZ_TRANSPORT_VISIBLE
+      startupTimes();
     }
   }
 }
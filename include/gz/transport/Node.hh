@@ -18,24 +18,40 @@
 #define GZ_TRANSPORT_NODE_HH_
 
 #include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
 #include <functional>
+#include <future>
 #include <memory>
 #include <mutex>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "gz/transport/AdvertiseOptions.hh"
+#include "gz/transport/Batcher.hh"
+#include "gz/transport/CallbackStatistics.hh"
 #include "gz/transport/config.hh"
+#include "gz/transport/Executor.hh"
 #include "gz/transport/Export.hh"
+#include "gz/transport/LazyMsg.hh"
+#include "gz/transport/LoanedMessage.hh"
 #include "gz/transport/NodeOptions.hh"
 #include "gz/transport/NodeShared.hh"
 #include "gz/transport/Publisher.hh"
 #include "gz/transport/RepHandler.hh"
 #include "gz/transport/ReqHandler.hh"
+#include "gz/transport/RequestAwaitable.hh"
+#include "gz/transport/ServiceResponder.hh"
+#include "gz/transport/ServiceStatistics.hh"
 #include "gz/transport/SubscribeOptions.hh"
 #include "gz/transport/SubscriptionHandler.hh"
+#include "gz/transport/Synchronizer.hh"
+#include "gz/transport/SyncOptions.hh"
 #include "gz/transport/TopicStatistics.hh"
 #include "gz/transport/TopicUtils.hh"
 #include "gz/transport/TransportTypes.hh"
@@ -137,6 +153,23 @@ namespace gz
         /// \return true when success.
         public: bool Publish(const ProtoMsg &_msg);
 
+        /// \brief Publish a message by shared ownership. Local
+        /// (intraprocess) subscribers receive the very same object, so no
+        /// deep copy is performed. The message must not be modified after
+        /// calling this function. The message is still serialized when
+        /// publishing to raw or interprocess subscribers.
+        /// \param[in] _msg Shared pointer to a google::protobuf message.
+        /// \return true when success.
+        public: bool Publish(const std::shared_ptr<const ProtoMsg> &_msg);
+
+        /// \brief Publish a message transferring its ownership. Local
+        /// (intraprocess) subscribers receive the very same object, so no
+        /// deep copy is performed.
+        /// \param[in] _msg Unique pointer to a google::protobuf message.
+        /// \return true when success.
+        public: template<typename MessageT>
+        bool Publish(std::unique_ptr<MessageT> &&_msg);
+
         /// \brief Publish a raw pre-serialized message.
         ///
         /// \warning This function is only intended for advanced users. The
@@ -162,6 +195,64 @@ namespace gz
           const std::string &_msgData,
           const std::string &_msgType);
 
+        /// \brief Publish a raw pre-serialized message of the advertised
+        /// type, read from a buffer of the caller such as the frame of a
+        /// driver, without building a std::string first. The buffer can be
+        /// reused when this function returns: it is copied once, when
+        /// publishing to remote subscribers.
+        ///
+        /// \warning Same as PublishRaw(const std::string &,
+        /// const std::string &), the data must be a valid serialized
+        /// message of the advertised type.
+        ///
+        /// \param[in] _msgData The serialized message.
+        /// \return true when success, false if this publisher is not valid
+        /// or was advertised with kGenericMessageType, which doesn't name
+        /// the type of the message.
+        public: bool PublishRaw(std::string_view _msgData);
+
+        /// \brief Borrow a buffer to write a serialized message directly
+        /// into the transport. The buffer is taken from the serialization
+        /// buffer pool if enabled. Publish it with PublishLoaned().
+        /// \param[in] _size Size of the serialized message (bytes).
+        /// \return The loaned buffer or an invalid loan if this publisher
+        /// is not valid.
+        /// \sa AdvertiseMessageOptions::SetBufferPoolSize
+        public: LoanedMessage Loan(const std::size_t _size);
+
+        /// \brief Publish a message written into a buffer obtained with
+        /// Loan(). Unlike PublishRaw(), the message is not copied: raw
+        /// (intraprocess) subscribers and the interprocess subscribers share
+        /// the loaned buffer. Local subscribers deserialize the message.
+        ///
+        /// \warning Same as PublishRaw(), the content of the buffer must be
+        /// a valid serialized message of type _msgType.
+        ///
+        /// \param[in] _msg The loaned buffer. It is no longer valid after
+        /// this call, even if the publication fails.
+        /// \param[in] _msgType A std::string that contains the message type
+        /// name.
+        /// \return true when success.
+        public: bool PublishLoaned(
+          LoanedMessage &&_msg,
+          const std::string &_msgType);
+
+        /// \brief Take the ownership of a buffer storing a serialized
+        /// message, so it can be published with PublishLoaned() without
+        /// copying it. This is useful when the message was serialized by
+        /// someone else, e.g. a client of the C interface.
+        /// \param[in] _data The buffer.
+        /// \param[in] _size Size of the message (bytes).
+        /// \param[in] _release Function releasing the buffer when the
+        /// transport doesn't use it anymore, possibly from another thread
+        /// after PublishLoaned() returns. It's also called right away if the
+        /// buffer can't be adopted. Empty if the buffer is never released.
+        /// \return The loan or an invalid loan if this publisher is not
+        /// valid or _data is nullptr.
+        public: LoanedMessage Adopt(char *_data,
+          const std::size_t _size,
+          const std::function<void(char *_data)> &_release);
+
         /// \brief Check if message publication is throttled. If so, verify
         /// whether the next message should be published or not.
         ///
@@ -177,10 +268,103 @@ namespace gz
         /// \return true if the message should be published or false otherwise.
         private: bool UpdateThrottling();
 
+        /// \brief Publish a raw pre-serialized message whose type was
+        /// checked against the advertised type.
+        /// \param[in] _msgData The serialized message.
+        /// \param[in] _msgType Type of the message.
+        /// \return true when success.
+        private: bool PublishRawData(std::string_view _msgData,
+                                     const std::string &_msgType);
+
+        /// \brief Publish a message whose type is known to match the
+        /// advertised type at compile time, skipping the type check.
+        /// \param[in] _msg A google::protobuf message.
+        /// \return true when success.
+        /// \sa TypedPublisher
+        protected: bool PublishTyped(const ProtoMsg &_msg);
+
         /// \brief Return true if this publisher has subscribers.
         /// \return True if subscribers have connected to this publisher.
         public: bool HasConnections() const;
 
+        /// \brief Cheap check of whether a publication would be sent now:
+        /// the topic has a subscriber, a tap or a history for the late
+        /// joiners, and the throttling allows it. Use it to avoid building an
+        /// expensive message that nobody would receive.
+        /// \return True if a message published now would be sent.
+        /// \sa PublishLazy
+        public: bool WantsData() const;
+
+        /// \brief Publish a message built only if it would be sent, see
+        /// WantsData(). Otherwise the message isn't constructed, filled or
+        /// serialized at all.
+        /// \param[in] _fill Function filling a default constructed message.
+        /// \return true when success, including when nothing was published
+        /// because nobody would receive the message.
+        public: template<typename MessageT>
+        bool PublishLazy(const std::function<void(MessageT &)> &_fill);
+
+        /// \brief Number of publications that reused a buffer from the
+        /// serialization buffer pool.
+        /// \return The number of hits or 0 if the pool is disabled.
+        /// \sa AdvertiseMessageOptions::SetBufferPoolSize
+        public: uint64_t BufferPoolHits() const;
+
+        /// \brief Number of publications that required a new serialization
+        /// buffer because none was available in the pool.
+        /// \return The number of misses or 0 if the pool is disabled.
+        /// \sa AdvertiseMessageOptions::SetBufferPoolSize
+        public: uint64_t BufferPoolMisses() const;
+
+        /// \brief Page faults saved by backing the serialization buffers
+        /// with huge pages, compared to regular pages. It is an estimate:
+        /// the kernel might split a transparent huge page later.
+        /// \return The number of page faults or 0 if the huge pages are
+        /// disabled or unavailable.
+        /// \sa AdvertiseMessageOptions::SetHugePages
+        public: uint64_t HugePageFaultsSaved() const;
+
+        /// \brief Set a function called when a subscriber connected to the
+        /// socket of this publisher becomes slow: its send queue stays above
+        /// GZ_TRANSPORT_SLOW_SUBSCRIBER bytes. It is called again when the
+        /// subscriber recovers or disconnects. The function is called from
+        /// an internal thread and must not call this function. The topics
+        /// share the socket of the process unless they are advertised on a
+        /// channel.
+        /// \param[in] _cb The function, or an empty one to stop.
+        /// \return False if the detection is disabled or the publisher is
+        /// invalid.
+        /// \sa AdvertiseMessageOptions::SetChannel
+        /// \sa AdvertiseMessageOptions::SetSlowSubscriberMsgsPerSec
+        public: bool SetSlowSubscriberCallback(
+                    const SlowSubscriberCallback &_cb);
+
+        /// \brief Number of the subscribers connected to the socket of this
+        /// publisher that are slow now.
+        /// \return The number of slow subscribers.
+        public: uint32_t SlowSubscribers() const;
+
+        /// \brief Get the options of this publisher, including the changes
+        /// made by UpdateOptions().
+        /// \return The options.
+        public: AdvertiseMessageOptions Options() const;
+
+        /// \brief Change the options of this publisher without advertising
+        /// it again. Only these options can change:
+        /// * the throttling, see AdvertiseMessageOptions::SetMsgsPerSec();
+        /// * the rate limit, see AdvertiseMessageOptions::SetRateLimit();
+        /// * the priority, see AdvertiseOptions::SetPriority();
+        /// * the throttling of a slow subscriber, see
+        ///   AdvertiseMessageOptions::SetSlowSubscriberMsgsPerSec().
+        /// The next publication uses the new options. The other processes
+        /// learn them through a single discovery update, the subscribers
+        /// stay connected.
+        /// \param[in] _options The new options, usually a copy of Options()
+        /// with some of the above changed.
+        /// \return False if the publisher is invalid or if another option is
+        /// different. The options are unchanged then.
+        public: bool UpdateOptions(const AdvertiseMessageOptions &_options);
+
         /// \internal
         /// \brief Smart pointer to private data.
         /// This is std::shared_ptr because we want to trigger the destructor
@@ -198,6 +382,53 @@ namespace gz
 #endif
       };
 
+      /// \brief A publisher of a message type known at compile time,
+      /// returned by Advertise<MessageT>(). Publishing a MessageT doesn't
+      /// compare the type names, which the compiler already checked. It
+      /// converts to Publisher, and the other Publish() overloads are still
+      /// checked at runtime.
+      public: template<typename MessageT>
+      class TypedPublisher : public Publisher
+      {
+        /// \brief Default constructor.
+        public: TypedPublisher() = default;
+
+        /// \brief Constructor.
+        /// \param[in] _publisher A publisher advertising MessageT.
+        public: explicit TypedPublisher(const Publisher &_publisher)
+          : Publisher(_publisher)
+        {
+        }
+
+        public: using Publisher::Publish;
+
+        /// \brief Publish a message. Same as Publisher::Publish(), without
+        /// checking the type of the message at runtime.
+        /// \param[in] _msg The message.
+        /// \return true when success.
+        public: bool Publish(const MessageT &_msg)
+        {
+          return this->PublishTyped(_msg);
+        }
+
+        public: using Publisher::PublishLazy;
+
+        /// \brief Publish a message built only if it would be sent. Same as
+        /// Publisher::PublishLazy(), without checking the type of the message
+        /// at runtime.
+        /// \param[in] _fill Function filling a default constructed message.
+        /// \return true when success.
+        public: bool PublishLazy(const std::function<void(MessageT &)> &_fill)
+        {
+          if (!this->WantsData())
+            return this->Valid();
+
+          MessageT msg;
+          _fill(msg);
+          return this->PublishTyped(msg);
+        }
+      };
+
       public: Node();
 
       /// \brief Constructor.
@@ -215,8 +446,9 @@ namespace gz
       /// The PublisherId also acts as boolean, where true occurs if the topic
       /// was succesfully advertised.
       /// \sa AdvertiseOptions.
+      /// \sa TypedPublisher
       public: template<typename MessageT>
-      Node::Publisher Advertise(
+      Node::TypedPublisher<MessageT> Advertise(
           const std::string &_topic,
           const AdvertiseMessageOptions &_options = AdvertiseMessageOptions());
 
@@ -318,6 +550,57 @@ namespace gz
                              const MessageInfo &_info)> _callback,
           const SubscribeOptions &_opts = SubscribeOptions());
 
+      /// \brief Subscribe to a topic registering a callback that receives
+      /// the message by shared ownership.
+      /// Messages published within the same process through
+      /// Node::Publisher::Publish(const std::shared_ptr<const ProtoMsg> &)
+      /// are delivered without any copy.
+      /// \param[in] _topic Topic to be subscribed.
+      /// \param[in] _callback Lambda function with the following parameters:
+      ///   * _msg Shared pointer to the message containing a new topic update.
+      ///   * _info Message information (e.g.: topic name).
+      /// \param[in] _opts Subscription options.
+      /// \return true when successfully subscribed or false otherwise.
+      public: template<typename MessageT>
+      bool Subscribe(
+          const std::string &_topic,
+          std::function<void(const std::shared_ptr<const MessageT> &_msg,
+                             const MessageInfo &_info)> _callback,
+          const SubscribeOptions &_opts = SubscribeOptions());
+
+      /// \brief Subscribe to a topic registering a callback that receives a
+      /// view of the serialized message. The message is only deserialized
+      /// when the callback accesses it, see LazyMsg. Messages published
+      /// within the same process are serialized for this subscriber.
+      /// Note that this callback does not include any message information.
+      /// \param[in] _topic Topic to be subscribed.
+      /// \param[in] _callback Lambda function with the following parameters:
+      ///   * _msg View of the message containing a new topic update.
+      /// \param[in] _opts Subscription options.
+      /// \return true when successfully subscribed or false otherwise.
+      public: template<typename MessageT>
+      bool Subscribe(
+          const std::string &_topic,
+          std::function<void(const LazyMsg<MessageT> &_msg)> _callback,
+          const SubscribeOptions &_opts = SubscribeOptions());
+
+      /// \brief Subscribe to a topic registering a callback that receives a
+      /// view of the serialized message. The message is only deserialized
+      /// when the callback accesses it, see LazyMsg. Messages published
+      /// within the same process are serialized for this subscriber.
+      /// \param[in] _topic Topic to be subscribed.
+      /// \param[in] _callback Lambda function with the following parameters:
+      ///   * _msg View of the message containing a new topic update.
+      ///   * _info Message information (e.g.: topic name).
+      /// \param[in] _opts Subscription options.
+      /// \return true when successfully subscribed or false otherwise.
+      public: template<typename MessageT>
+      bool Subscribe(
+          const std::string &_topic,
+          std::function<void(const LazyMsg<MessageT> &_msg,
+                             const MessageInfo &_info)> _callback,
+          const SubscribeOptions &_opts = SubscribeOptions());
+
       /// \brief Subscribe to a topic registering a callback.
       /// Note that this callback includes message information.
       /// In this version the callback is a member function.
@@ -337,6 +620,61 @@ namespace gz
           ClassT *_obj,
           const SubscribeOptions &_opts = SubscribeOptions());
 
+      /// \brief Subscribe to several topics and receive their messages in
+      /// sets whose header stamps match, see Synchronizer and SyncOptions.
+      /// Each message type must have a gz.msgs.Header field named header.
+      /// The messages are received by shared ownership, without any copy.
+      /// Use Unsubscribe() on each topic to stop receiving them.
+      ///
+      /// E.g.:
+      ///
+      ///    node.SubscribeSynchronized<msgs::Image, msgs::IMU>(
+      ///      {"/camera", "/imu"},
+      ///      [](const std::shared_ptr<const msgs::Image> &_image,
+      ///         const std::shared_ptr<const msgs::IMU> &_imu) {...});
+      ///
+      /// \param[in] _topics Topics to be subscribed, one per message type.
+      /// \param[in] _callback Callable with one parameter per topic, in the
+      /// same order:
+      ///   * const std::shared_ptr<const MessageT> & Message of the topic.
+      /// \param[in] _opts Synchronization options.
+      /// \return true when all the topics were successfully subscribed or
+      /// false otherwise.
+      public: template<typename... MessageTs, typename CallbackT>
+      bool SubscribeSynchronized(
+          const std::array<std::string, sizeof...(MessageTs)> &_topics,
+          CallbackT &&_callback,
+          const SyncOptions &_opts = SyncOptions());
+
+      /// \brief Subscribe to a topic and receive its messages in batches,
+      /// see Batcher. A batch is delivered once it has _maxBatch messages,
+      /// or once its oldest message has waited for _maxDelay. The messages
+      /// are received by shared ownership, without any copy.
+      ///
+      /// E.g.:
+      ///
+      ///    node.SubscribeBatch<msgs::IMU>("/imu",
+      ///      [](const std::vector<std::shared_ptr<const msgs::IMU>> &_msgs)
+      ///      {...}, 100, std::chrono::milliseconds(10));
+      ///
+      /// \param[in] _topic Topic to be subscribed.
+      /// \param[in] _callback Callable with the following parameter:
+      ///   * const std::vector<std::shared_ptr<const MessageT>> & Batch of
+      ///     messages, from the oldest to the newest.
+      /// \param[in] _maxBatch Number of messages that triggers the delivery
+      /// of a batch.
+      /// \param[in] _maxDelay Maximum time a message waits for the delivery
+      /// of its batch. Zero to only deliver the full batches.
+      /// \param[in] _opts Subscription options.
+      /// \return true when successfully subscribed or false otherwise.
+      public: template<typename MessageT, typename CallbackT>
+      bool SubscribeBatch(
+          const std::string &_topic,
+          CallbackT &&_callback,
+          const std::size_t _maxBatch,
+          const std::chrono::nanoseconds &_maxDelay,
+          const SubscribeOptions &_opts = SubscribeOptions());
+
       /// \brief Get the list of topics subscribed by this node. Note that
       /// we might be interested in one topic but we still don't know the
       /// address of a publisher.
@@ -349,6 +687,34 @@ namespace gz
       /// \return true when successfully unsubscribed or false otherwise.
       public: bool Unsubscribe(const std::string &_topic);
 
+      /// \brief Change the rate of the callbacks and the intra-process
+      /// queue of the subscriptions of this node to a topic, without
+      /// subscribing again. The options set by
+      /// SubscribeOptions::SetMsgsPerSec(), SubscribeOptions::SetQueueDepth()
+      /// and SubscribeOptions::SetQueuePolicy() are applied to every
+      /// callback of the topic, the others are ignored. The remote
+      /// publishers learn the new rate through a discovery update, the
+      /// connections stay.
+      /// \param[in] _topic Topic name.
+      /// \param[in] _opts The options.
+      /// \return False if the topic is not valid or not subscribed by this
+      /// node.
+      /// \sa SubscriptionHandlerBase::UpdateOptions
+      public: bool UpdateSubscription(const std::string &_topic,
+                                      const SubscribeOptions &_opts);
+
+      /// \brief Run the oldest pending callback of the executor of this
+      /// node, waiting for one if needed. This is how a single-threaded
+      /// application runs the callbacks of its subscriptions in its own
+      /// loop, without any hand-off to another thread.
+      /// \param[in] _timeout Maximum time to wait. Zero to not wait.
+      /// \return True if a callback was run, false if there was none or if
+      /// the node has no executor.
+      /// \sa NodeOptions::SetCallbackExecutor
+      public: bool SpinOnce(
+        const std::chrono::nanoseconds &_timeout =
+          std::chrono::nanoseconds::zero());
+
       /// \brief Advertise a new service.
       /// In this version the callback is a plain function pointer.
       /// \param[in] _topic Topic name associated to the service.
@@ -419,6 +785,27 @@ namespace gz
                              ReplyT &_reply)> _callback,
           const AdvertiseServiceOptions &_options = AdvertiseServiceOptions());
 
+      /// \brief Advertise a new service whose response can be sent after
+      /// the callback returns, e.g.: from a worker thread. No thread is
+      /// blocked while a request is being processed.
+      /// In this version the callback is a std::function object.
+      /// \param[in] _topic Topic name associated to the service.
+      /// \param[in] _callback Callback to handle the service request with the
+      /// following parameters:
+      ///   * _request Protobuf message containing the request.
+      ///   * _responder Handle used to send the response, once, from any
+      ///     thread. See ServiceResponder.
+      /// \param[in] _options Advertise options.
+      /// \return true when the topic has been successfully advertised or
+      /// false otherwise.
+      /// \sa AdvertiseOptions.
+      public: template<typename RequestT, typename ReplyT>
+      bool Advertise(
+          const std::string &_topic,
+          std::function<void(const RequestT &_request,
+                             ServiceResponder<ReplyT> _responder)> _callback,
+          const AdvertiseServiceOptions &_options = AdvertiseServiceOptions());
+
       /// \brief Advertise a new service without input parameter.
       /// In this version the callback is a lambda function.
       /// \param[in] _topic Topic name associated to the service.
@@ -579,6 +966,40 @@ namespace gz
           std::function<void(const ReplyT &_reply,
                              const bool _result)> &_callback);
 
+      /// \brief Request a new service using a non-blocking call, the
+      /// response is delivered through a future. Many requests can be in
+      /// flight without blocking a thread for each of them.
+      /// \param[in] _topic Service name requested.
+      /// \param[in] _request Protobuf message containing the request's
+      /// parameters.
+      /// \param[in] _timeout The request is abandoned after _timeout
+      /// milliseconds without response. Zero means no timeout.
+      /// \return A future with the response and the result of the service
+      /// call. The result is false if the call failed, timed out or couldn't
+      /// be requested.
+      public: template<typename RequestT, typename ReplyT>
+      std::future<std::pair<ReplyT, bool>> RequestAsync(
+          const std::string &_topic,
+          const RequestT &_request,
+          const unsigned int _timeout);
+
+#ifdef GZ_TRANSPORT_HAS_COROUTINES
+      /// \brief Request a new service from a C++20 coroutine. The coroutine
+      /// is suspended until the response arrives, see RequestAwaitable.
+      /// \param[in] _topic Service name requested.
+      /// \param[in] _request Protobuf message containing the request's
+      /// parameters.
+      /// \param[in] _timeout The request is abandoned after _timeout
+      /// milliseconds without response. Zero means no timeout.
+      /// \return An object to co_await, producing the response and the
+      /// result of the service call.
+      public: template<typename RequestT, typename ReplyT>
+      RequestAwaitable<ReplyT> RequestAwait(
+          const std::string &_topic,
+          const RequestT &_request,
+          const unsigned int _timeout);
+#endif
+
       /// \brief Request a new service using a non-blocking call.
       /// In this version the callback is a member function.
       /// \param[in] _topic Service name requested.
@@ -632,6 +1053,27 @@ namespace gz
           ReplyT &_reply,
           bool &_result);
 
+      /// \brief Request a service several times using a blocking call. All
+      /// the requests are sent to the responser in a single message and all
+      /// the responses come back together, saving a round trip per request.
+      /// The requests are processed in order by the responser.
+      /// \param[in] _topic Service name requested.
+      /// \param[in] _requests Protobuf messages containing the parameters of
+      /// each request.
+      /// \param[in] _timeout The batch will timeout after '_timeout' ms.
+      /// \param[out] _replies Protobuf messages containing the responses, in
+      /// the order of the requests.
+      /// \param[out] _results Results of the service calls.
+      /// \return true when the batch was executed or false if the timeout
+      /// expired.
+      public: template<typename RequestT, typename ReplyT>
+      bool RequestBatch(
+          const std::string &_topic,
+          const std::vector<RequestT> &_requests,
+          const unsigned int &_timeout,
+          std::vector<ReplyT> &_replies,
+          std::vector<bool> &_results);
+
       /// \brief Request a new service without input parameter using a blocking
       /// call.
       /// \param[in] _topic Service name requested.
@@ -675,6 +1117,41 @@ namespace gz
                   std::string &_response,
                   bool &_result);
 
+      /// \brief Request a new service using a non-blocking call. This
+      /// request function expects a serialized protobuf message as the
+      /// request and delivers a serialized protobuf message as the response,
+      /// so many requests of types unknown at compile time can be in flight
+      /// without blocking a thread for each of them.
+      /// \param[in] _topic Service name requested.
+      /// \param[in] _request Protobuf message serialized into a string
+      /// containing the request's parameters.
+      /// \param[in] _requestType Message type of the request.
+      /// \param[in] _responseType Message type of the response.
+      /// \param[in] _timeout The request is abandoned after _timeout
+      /// milliseconds without response. Zero means no timeout.
+      /// \param[in] _callback Function executed when the response arrives,
+      /// from a thread of the transport. Its parameters are the serialized
+      /// response and the result of the service call.
+      /// \return true when the service call was succesfully requested.
+      public: bool RequestRaw(const std::string &_topic,
+                  const std::string &_request, const std::string &_requestType,
+                  const std::string &_responseType, unsigned int _timeout,
+                  const std::function<void(const std::string &_response,
+                                           const bool _result)> &_callback);
+
+      /// \brief Discover the responsers of a service and connect to them
+      /// ahead of the first request, so it doesn't pay the discovery and the
+      /// connection latency. The responsers discovered later are connected
+      /// in the background.
+      /// \param[in] _topic Service name.
+      /// \param[in] _timeout Maximum time to wait for a responser (ms). Zero
+      /// doesn't wait.
+      /// \return True if a responser is ready to receive the requests, false
+      /// if none was found before the timeout or the service name is not
+      /// valid.
+      public: bool PrepareService(const std::string &_topic,
+                                  const unsigned int _timeout = 0);
+
       /// \brief Unadvertise a service.
       /// \param[in] _topic Service name to be unadvertised.
       /// \return true if the service was successfully unadvertised.
@@ -685,6 +1162,7 @@ namespace gz
       /// discovery is in its initialization phase.
       /// The value of the "heartbeatInterval" constant, with a default
       /// value of 1000 ms, sets the maximum blocking time period.
+      /// NodeOptions::SetDiscoveryTimeout() bounds it.
       /// \param[out] _topics List of advertised topics.
       public: void TopicList(std::vector<std::string> &_topics) const;
 
@@ -709,6 +1187,7 @@ namespace gz
       /// discovery is in its initialization phase.
       /// The value of the "heartbeatInterval" constant, with a default
       /// value of 1000ms, sets the maximum blocking time period.
+      /// NodeOptions::SetDiscoveryTimeout() bounds it.
       /// \param[out] _services List of advertised services.
       public: void ServiceList(std::vector<std::string> &_services) const;
 
@@ -739,6 +1218,48 @@ namespace gz
         const std::string &_msgType = kGenericMessageType,
         const SubscribeOptions &_opts = SubscribeOptions());
 
+      /// \brief Subscribe to a topic registering a callback that receives
+      /// the message data by shared ownership. The callback can keep a
+      /// reference to the data, such as the buffer received from the
+      /// transport, after returning instead of copying it. Note that a
+      /// message received in a batch keeps the whole batch alive.
+      /// \param[in] _topic Name of the topic to subscribe to
+      /// \param[in] _callback A function pointer or std::function object that
+      /// has a void return value and accepts three arguments:
+      /// (const std::shared_ptr<const char> &_msgData, const size_t _size,
+      /// const MessageInfo &_info).
+      /// \param[in] _msgType The type of message to subscribe to. Using
+      /// kGenericMessageType (the default) will allow this subscriber to listen
+      /// to all message types.
+      /// \param[in] _opts Options for subscribing.
+      /// \return True if subscribing was successful.
+      /// \sa SubscribeRaw(const std::string &, const RawCallback &,
+      /// const std::string &, const SubscribeOptions &)
+      public: bool SubscribeRaw(
+        const std::string &_topic,
+        const SharedRawCallback &_callback,
+        const std::string &_msgType = kGenericMessageType,
+        const SubscribeOptions &_opts = SubscribeOptions());
+
+      /// \brief Subscribe to a topic registering a callback that receives
+      /// a view of the message data, valid until the callback returns.
+      /// \param[in] _topic Name of the topic to subscribe to
+      /// \param[in] _callback A function pointer or std::function object that
+      /// has a void return value and accepts two arguments:
+      /// (std::string_view _msgData, const MessageInfo &_info).
+      /// \param[in] _msgType The type of message to subscribe to. Using
+      /// kGenericMessageType (the default) will allow this subscriber to listen
+      /// to all message types.
+      /// \param[in] _opts Options for subscribing.
+      /// \return True if subscribing was successful.
+      /// \sa SubscribeRaw(const std::string &, const RawCallback &,
+      /// const std::string &, const SubscribeOptions &)
+      public: bool SubscribeRaw(
+        const std::string &_topic,
+        const RawViewCallback &_callback,
+        const std::string &_msgType = kGenericMessageType,
+        const SubscribeOptions &_opts = SubscribeOptions());
+
       /// \brief Get the reference to the current node options.
       /// \return Reference to the current node options.
       public: const NodeOptions &Options() const;
@@ -762,11 +1283,59 @@ namespace gz
       public: std::optional<TopicStatistics> TopicStats(
                   const std::string &_topic) const;
 
+      /// \brief Turn the statistics of a service on or off. The statistics
+      /// are shared by all the nodes of the process: they include the
+      /// requests served and the requests sent by any node. This function
+      /// is not needed when the GZ_TRANSPORT_SERVICE_STATISTICS environment
+      /// variable is set to 1.
+      /// \param[in] _service The name of the service.
+      /// \param[in] _enable True to enable statistics, false to disable.
+      /// \return True on success or false if the service name is not valid.
+      /// \sa ServiceStatistics
+      public: bool EnableServiceStats(const std::string &_service,
+                                      bool _enable);
+
+      /// \brief Get the current statistics of a service. Statistics must
+      /// have been enabled using EnableServiceStats() or the
+      /// GZ_TRANSPORT_SERVICE_STATISTICS environment variable, otherwise
+      /// the return value will be std::nullopt.
+      /// \param[in] _service The name of the service.
+      /// \return The statistics, or std::nullopt if statistics were not
+      /// enabled.
+      public: std::optional<ServiceStatistics> ServiceStats(
+                  const std::string &_service) const;
+
+      /// \brief Turn the accounting of the execution time of the
+      /// subscription callbacks on or off. The accounting is shared by all
+      /// the nodes of the process. This function is not needed when the
+      /// GZ_TRANSPORT_CALLBACK_STATISTICS environment variable is set to 1.
+      /// \param[in] _enable True to enable the accounting, false to disable.
+      /// \sa SubscriptionStats
+      public: void EnableCallbackStats(bool _enable);
+
+      /// \brief Get the number of callbacks executed by each subscription
+      /// of this node and their execution time, to find a slow callback
+      /// delaying the other subscriptions. Only the callbacks executed while
+      /// the accounting was enabled (see EnableCallbackStats()) are counted.
+      /// \return The statistics of each subscription handler. Empty if the
+      /// accounting is disabled.
+      public: std::vector<CallbackStatistics> SubscriptionStats() const;
+
       /// \brief Get a pointer to the shared node (singleton shared by all the
       /// nodes).
       /// \return The pointer to the shared node.
       private: NodeShared *Shared() const;
 
+      /// \brief Remap and fully qualify a topic or service name with the
+      /// options of this node. The valid names are cached, so that the
+      /// callers making many requests don't validate and qualify the same
+      /// name again.
+      /// \param[in] _topic Topic or service name, before remapping.
+      /// \return The fully qualified name, or nullptr if it is not valid.
+      /// \sa TopicUtils::FullyQualifiedName
+      private: std::shared_ptr<const std::string> ResolveTopic(
+        const std::string &_topic) const;
+
       /// \brief Get the UUID of this node.
       /// \return The node UUID.
       private: const std::string &NodeUuid() const;
@@ -784,6 +1353,70 @@ namespace gz
       /// \return True on success.
       private: bool SubscribeHelper(const std::string &_fullyQualifiedTopic);
 
+      /// \brief Subscribe to a topic with a handler storing the callback
+      /// inline, see CallableSubscriptionHandler.
+      /// \param[in] _topic Topic to be subscribed.
+      /// \param[in] _cb Callable accepting (const MessageT &,
+      /// const MessageInfo &).
+      /// \param[in] _opts Subscription options.
+      /// \return true when successfully subscribed or false otherwise.
+      private: template<typename MessageT, typename CallableT>
+      bool SubscribeCallable(
+          const std::string &_topic,
+          CallableT &&_cb,
+          const SubscribeOptions &_opts);
+
+      /// \brief Subscribe the inputs of a synchronizer to their topics.
+      /// \param[in] _topics Topics to be subscribed, one per message type.
+      /// \param[in] _sync The synchronizer.
+      /// \param[in] _opts Subscription options.
+      /// \return true when all the topics were successfully subscribed or
+      /// false otherwise.
+      private: template<typename... MessageTs, std::size_t... Is>
+      bool SubscribeSynchronizer(
+          const std::array<std::string, sizeof...(Is)> &_topics,
+          const std::shared_ptr<Synchronizer<MessageTs...>> &_sync,
+          const SubscribeOptions &_opts,
+          std::index_sequence<Is...>);
+
+      /// \brief Helper function for the non-blocking requests.
+      /// \param[in] _topic Service name requested.
+      /// \param[in] _request Protobuf message containing the request's
+      /// parameters.
+      /// \param[in] _cb Callback executed with the response.
+      /// \param[in] _timeout Timeout (ms), zero means no timeout.
+      /// \param[in] _useExecutor True to run the callback on the response
+      /// executor of the node, see NodeOptions::SetResponseExecutor().
+      /// \return true when the service call was succesfully requested.
+      private: template<typename RequestT, typename ReplyT>
+      bool RequestHelper(
+          const std::string &_topic,
+          const RequestT &_request,
+          const std::function<void(const ReplyT &, const bool)> &_cb,
+          const unsigned int _timeout,
+          const bool _useExecutor = true);
+
+      /// \brief Send a oneway request to a remote responser that is already
+      /// connected, without storing any request handler.
+      /// \param[in] _topic Service name requested.
+      /// \param[in] _request Protobuf message containing the request's
+      /// parameters.
+      /// \return True if the request was sent or false if the request has
+      /// to go through RequestHelper(): there is a responser in this
+      /// process, no responser is connected yet or the service name is not
+      /// valid.
+      private: bool RequestOneway(const std::string &_topic,
+                                  const ProtoMsg &_request);
+
+      /// \brief Helper function for Advertise (services).
+      /// \param[in] _topic Service name.
+      /// \param[in] _repHandler Handler of the service, with a callback.
+      /// \param[in] _options Advertise options.
+      /// \return True on success.
+      private: bool AdvertiseHelper(const std::string &_topic,
+                                    const IRepHandlerPtr &_repHandler,
+                                    const AdvertiseServiceOptions &_options);
+
 #ifdef _WIN32
 // Disable warning C4251 which is triggered by
 // std::unique_ptr
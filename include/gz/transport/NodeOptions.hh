@@ -18,6 +18,7 @@
 #ifndef GZ_TRANSPORT_NODEOPTIONS_HH_
 #define GZ_TRANSPORT_NODEOPTIONS_HH_
 
+#include <chrono>
 #include <memory>
 #include <string>
 
@@ -32,8 +33,28 @@ namespace gz
     inline namespace GZ_TRANSPORT_VERSION_NAMESPACE {
     //
     // Forward declarations.
+    class Executor;
     class NodeOptionsPrivate;
 
+    /// \brief This strongly typed enum defines how the service requests are
+    /// distributed when several processes provide the same service.
+    /// \sa NodeOptions::SetLoadBalancing
+    enum class LoadBalancing_t
+    {
+      /// \brief Send all the requests to the first responser found (default
+      /// policy).
+      FIRST,
+      /// \brief Send each request to the next responser, in turn.
+      ROUND_ROBIN,
+      /// \brief Send each request to the responser with the fewest requests
+      /// waiting for a response from this process.
+      LEAST_OUTSTANDING,
+      /// \brief Pick a responser at random, with a probability inversely
+      /// proportional to its measured response time. The responsers without
+      /// any response measured yet are tried first.
+      LATENCY_WEIGHTED
+    };
+
     /// \class NodeOptions NodeOptions.hh gz/transport/NodeOptions.hh
     /// \brief A class for customizing the behavior of the Node.
     /// E.g.: Set a custom namespace or a partition name.
@@ -126,6 +147,85 @@ namespace gz
       public: bool TopicRemap(const std::string &_fromTopic,
                               std::string &_toTopic) const;
 
+      /// \brief Set how the service requests of this node are distributed
+      /// among the processes providing the same service. The default policy
+      /// is LoadBalancing_t::FIRST.
+      /// \param[in] _policy The policy.
+      public: void SetLoadBalancing(const LoadBalancing_t _policy);
+
+      /// \brief Get how the service requests of this node are distributed
+      /// among the processes providing the same service.
+      /// \return The policy.
+      public: LoadBalancing_t LoadBalancing() const;
+
+      /// \brief Send the messages of the topics advertised by this node
+      /// through the network interface with a given address, instead of
+      /// the one selected by GZ_IP, e.g. a dedicated sensor network. The
+      /// topics get their own publisher socket bound to this interface, see
+      /// AdvertiseMessageOptions::SetInterface(), which overrides it for a
+      /// topic. The default value is empty, which uses the interface of
+      /// GZ_IP.
+      /// \param[in] _ip IP address of a local interface.
+      public: void SetInterface(const std::string &_ip);
+
+      /// \brief Get the network interface of the topics of this node.
+      /// \return The IP address of the interface, empty for the interface
+      /// selected by GZ_IP.
+      /// \sa SetInterface
+      public: const std::string &Interface() const;
+
+      /// \brief Run the callbacks of the subscriptions of this node on an
+      /// executor, see Executor. A subscription bound to another executor
+      /// with SubscribeOptions::SetCallbackExecutor() keeps it. Only the
+      /// subscriptions created afterwards are affected.
+      /// \param[in] _executor The executor, or nullptr to run the callbacks
+      /// on the threads of the transport (default).
+      /// \sa Node::SpinOnce
+      public: void SetCallbackExecutor(
+        const std::shared_ptr<Executor> &_executor);
+
+      /// \brief Get the executor running the callbacks of this node.
+      /// \return The executor, or nullptr if none.
+      /// \sa SetCallbackExecutor
+      public: const std::shared_ptr<Executor> &CallbackExecutor() const;
+
+      /// \brief Run the response callbacks of the non-blocking service
+      /// requests of this node on an executor, instead of the thread
+      /// receiving the responses. A slow response callback then doesn't
+      /// delay the reception of the messages and of the other responses.
+      /// The callbacks of the requests that fail, time out or are answered
+      /// from the cache run on the executor as well. The futures of
+      /// Node::RequestAsync() are set without it.
+      /// \param[in] _executor The executor, or nullptr to run the callbacks
+      /// on the threads of the transport (default).
+      public: void SetResponseExecutor(
+        const std::shared_ptr<Executor> &_executor);
+
+      /// \brief Get the executor running the response callbacks of this
+      /// node.
+      /// \return The executor, or nullptr if none.
+      /// \sa SetResponseExecutor
+      public: const std::shared_ptr<Executor> &ResponseExecutor() const;
+
+      /// \brief Set the maximum time TopicList(), TopicInfo(),
+      /// ServiceList() and ServiceInfo() of the node wait for the discovery
+      /// to learn the state of the other processes. It's learnt as soon as a
+      /// peer sends its catalog, or after two heartbeats without any peer.
+      /// Once the time is over, they return what the discovery knows so far,
+      /// which might be incomplete. The default value is negative: they wait
+      /// until the discovery is initialized.
+      /// \param[in] _timeout The maximum time, or a negative value.
+      /// \sa Node::TopicList
+      public: void SetDiscoveryTimeout(
+        const std::chrono::milliseconds &_timeout);
+
+      /// \brief Get the maximum time the introspection functions of the
+      /// node wait for the discovery.
+      /// \return The maximum time, or a negative value if they wait until
+      /// the discovery is initialized.
+      /// \sa SetDiscoveryTimeout
+      public: std::chrono::milliseconds DiscoveryTimeout() const;
+
 #ifdef _WIN32
 // Disable warning C4251 which is triggered by
 // std::unique_ptr
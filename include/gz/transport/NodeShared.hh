@@ -27,6 +27,8 @@
 #pragma warning(pop)
 #endif
 
+#include <chrono>
+#include <cstddef>
 #include <memory>
 #include <mutex>
 #include <optional>
@@ -35,15 +37,20 @@
 #include <vector>
 #include <map>
 
+#include "gz/transport/CallbackStatistics.hh"
 #include "gz/transport/config.hh"
 #include "gz/transport/Export.hh"
 #include "gz/transport/HandlerStorage.hh"
+#include "gz/transport/Helpers.hh"
+#include "gz/transport/MemoryStatistics.hh"
 #include "gz/transport/Publisher.hh"
 #include "gz/transport/RepHandler.hh"
 #include "gz/transport/ReqHandler.hh"
+#include "gz/transport/ServiceStatistics.hh"
 #include "gz/transport/SubscriptionHandler.hh"
 #include "gz/transport/TopicStorage.hh"
 #include "gz/transport/TopicStatistics.hh"
+#include "gz/transport/TransportBackend.hh"
 #include "gz/transport/TransportTypes.hh"
 #include "gz/transport/Uuid.hh"
 
@@ -55,11 +62,13 @@ namespace gz
     inline namespace GZ_TRANSPORT_VERSION_NAMESPACE {
     //
     // Forward declarations.
+    class Lockstep;
     class Node;
     class NodePrivate;
 
     /// \brief Private data pointer
     class NodeSharedPrivate;
+    class SerializedBuffer;
 
     /// \class NodeShared NodeShared.hh gz/transport/NodeShared.hh
     /// \brief Private data for the Node class. This class should not be
@@ -84,15 +93,19 @@ namespace gz
       /// deallocates the buffer containing the published data.
       /// \sa http://zeromq.org/blog:zero-copy
       /// \param[in] _msgType Message type in string format.
+      /// \param[in] _hint Opaque pointer passed to _ffn along with _data.
       /// \return true when success or false otherwise.
       public: bool Publish(const std::string &_topic,
                            char *_data,
                            const size_t _dataSize,
                            DeallocFunc *_ffn,
-                           const std::string &_msgType);
+                           const std::string &_msgType,
+                           void *_hint = nullptr);
 
       /// \brief Method in charge of receiving the topic updates.
-      public: void RecvMsgUpdate();
+      /// \param[in] _shard Index of the subscriber socket receiving them,
+      /// see GZ_TRANSPORT_RECEPTION_THREADS.
+      public: void RecvMsgUpdate(const std::size_t _shard = 0);
 
       /// \brief HandlerInfo contains information about callback handlers which
       /// is useful for local publishers and message receivers. You should only
@@ -174,12 +187,150 @@ namespace gz
         const std::string &_msgData,
         const HandlerInfo &_handlerInfo);
 
+      /// \brief MatchingHandlerInfo contains the local and raw handlers of a
+      /// topic accepting a given message type. The lists are cached by the
+      /// handler storage, so retrieving them doesn't compare the message type
+      /// against every handler. You should only retrieve a
+      /// MatchingHandlerInfo by calling CheckMatchingHandlers().
+      public: struct MatchingHandlerInfo
+      {
+        /// \brief Standard local handlers, or nullptr if there are none.
+        public: HandlerStorage<ISubscriptionHandler>::HandlerListPtr
+                  localHandlers;
+
+        /// \brief Raw local handlers, or nullptr if there are none.
+        public: HandlerStorage<RawSubscriptionHandler>::HandlerListPtr
+                  rawHandlers;
+      };
+
+      /// \brief Get the local and raw handlers of a topic accepting a
+      /// message type.
+      /// \param[in] _topic Topic name.
+      /// \param[in] _msgType Message type.
+      /// \return The matching handlers.
+      public: MatchingHandlerInfo CheckMatchingHandlers(
+          const std::string &_topic,
+          const std::string &_msgType) const;
+
+      /// \brief The local handlers of a topic accepting a message type and
+      /// whether there are remote subscribers, see CheckMatchingSubscribers().
+      public: struct MatchingSubscriberInfo : public MatchingHandlerInfo
+      {
+        /// \brief True if this Publisher has any remote subscribers
+        public: bool haveRemote = false;
+
+        /// \brief Highest rate requested by the remote subscribers, or
+        /// kUnthrottled if any of them isn't throttled. The messages beyond
+        /// this rate are not sent to the remote subscribers.
+        public: uint64_t remoteMsgsPerSec = kUnthrottled;
+      };
+
+      /// \brief Get the local handlers and remote subscribers of a topic
+      /// accepting a message type.
+      /// \param[in] _topic Topic name.
+      /// \param[in] _msgType Message type.
+      /// \return Information about subscribers.
+      public: MatchingSubscriberInfo CheckMatchingSubscribers(
+          const std::string &_topic,
+          const std::string &_msgType) const;
+
+      /// \brief Call the SubscriptionHandler callbacks (local and raw) of
+      /// the handlers accepting the message type.
+      /// \param[in] _info Message information.
+      /// \param[in] _msgData The raw serialized data for the message
+      /// \param[in] _handlerInfo Handlers accepting the type of the message,
+      /// as generated by CheckMatchingHandlers().
+      public: void TriggerCallbacks(
+        const MessageInfo &_info,
+        const std::string &_msgData,
+        const MatchingHandlerInfo &_handlerInfo);
+
       /// \brief Method in charge of receiving the service call requests.
       public: void RecvSrvRequest();
 
       /// \brief Method in charge of receiving the service call responses.
       public: void RecvSrvResponse();
 
+      /// \brief Deliver a message received by the data-plane backend, see
+      /// TransportBackend.
+      /// \param[in] _topic Fully qualified topic name.
+      /// \param[in] _msgType Type of the message.
+      /// \param[in] _data Serialized message.
+      /// \param[in] _size Size of the message (bytes).
+      public: void RecvBackendMsg(const std::string &_topic,
+                                  const std::string &_msgType,
+                                  const char *_data,
+                                  const std::size_t _size);
+
+      /// \brief Run a service request received by the data-plane backend.
+      /// \param[in] _request The request.
+      /// \param[in] _reply Function sending the response.
+      public: void RecvBackendRequest(const BackendRequest &_request,
+        TransportBackendListener::ReplyFunc _reply);
+
+      /// \brief Notify the response of a service request received by the
+      /// data-plane backend.
+      /// \param[in] _topic Service name.
+      /// \param[in] _nodeUuid UUID of the requesting node.
+      /// \param[in] _reqUuid UUID of the request.
+      /// \param[in] _rep Serialized response.
+      /// \param[in] _result Result of the service call.
+      public: void RecvBackendResponse(const std::string &_topic,
+                                       const std::string &_nodeUuid,
+                                       const std::string &_reqUuid,
+                                       const std::string &_rep,
+                                       const bool _result);
+
+      /// \brief Store a service call request waiting to be sent. If the
+      /// handler has a deadline (see IReqHandler::SetDeadline()) the
+      /// reception thread removes the request at that time and abandons it
+      /// (see IReqHandler::Expire()). The requests sent are also abandoned
+      /// when their responser is gone. NodeShared::mutex must be locked by
+      /// the caller.
+      /// \param[in] _topic Service name.
+      /// \param[in] _handler The request handler.
+      public: void AddRequest(const std::string &_topic,
+                              const IReqHandlerPtr &_handler);
+
+      /// \brief Remove a service call request. NodeShared::mutex must be
+      /// locked by the caller.
+      /// \param[in] _hUuid UUID of the request handler.
+      /// \return True if the request was removed or false if it wasn't
+      /// stored.
+      public: bool RemoveRequest(const std::string &_hUuid);
+
+      /// \brief Abandon the requests whose deadline has passed and the
+      /// messages whose reassembly has stalled.
+      /// \return The time until the next deadline, at most the polling
+      /// timeout of the reception thread.
+      private: std::chrono::milliseconds ExpireRequests();
+
+      /// \brief Send a service call response through the replier socket.
+      /// \param[in] _sender Address of the requester.
+      /// \param[in] _dstId ZMQ identity of the requester.
+      /// \param[in] _topic Service name.
+      /// \param[in] _nodeUuid UUID of the requesting node.
+      /// \param[in] _reqUuid UUID of the request.
+      /// \param[in] _rep Serialized response.
+      /// \param[in] _result Result of the service call.
+      /// \param[in] _timing Queue and callback times of the call, sent in an
+      /// additional frame when not empty.
+      /// \param[in] _cacheTtl Time to live of the response, sent in an
+      /// additional frame when not zero.
+      private: void SendSrvReply(const std::string &_sender,
+                                 const std::string &_dstId,
+                                 const std::string &_topic,
+                                 const std::string &_nodeUuid,
+                                 const std::string &_reqUuid,
+                                 const std::string &_rep,
+                                 const bool _result,
+                                 const std::string &_timing,
+                                 const std::chrono::milliseconds &_cacheTtl);
+
+      /// \brief Send the responses produced by the service threads. Only
+      /// called by the reception thread.
+      private: void SendSrvReplies();
+
       /// \brief Try to send all the requests for a given service call and a
       /// pair of request/response types.
       /// \param[in] _topic Topic name.
@@ -189,6 +340,25 @@ namespace gz
                                          const std::string &_reqType,
                                          const std::string &_repType);
 
+      /// \brief Send a oneway request straight to a connected responser.
+      /// Only the frames read by the responser are filled, no handler is
+      /// stored and no response is expected.
+      /// \param[in] _topic Fully qualified service name.
+      /// \param[in] _request Protobuf message containing the request.
+      /// \param[in] _policy How to select the responser.
+      /// \return True if the request was sent or false if no responser is
+      /// connected yet, some requests for this service are still waiting to
+      /// be sent or the request couldn't be sent.
+      public: bool SendOnewayRequest(const std::string &_topic,
+                                     const ProtoMsg &_request,
+                                     const LoadBalancing_t _policy);
+
+      /// \brief Connect the requester socket to a service responser, if it
+      /// isn't connected yet, and store it as a route for its service.
+      /// NodeShared::mutex must be locked by the caller.
+      /// \param[in] _pub The responser.
+      private: void ConnectToResponser(const ServicePublisher &_pub);
+
       /// \brief Callback executed when the discovery detects new topics.
       /// \param[in] _pub Information of the publisher in charge of the topic.
       public: void OnNewConnection(const MessagePublisher &_pub);
@@ -284,17 +454,156 @@ namespace gz
       public: std::optional<TopicStatistics> TopicStats(
                   const std::string &_topic) const;
 
+      /// \brief Account for intra-process publications dropped because the
+      /// queue of a local subscriber was full. Nothing is recorded if
+      /// statistics are not enabled for the topic.
+      /// \param[in] _topic The fully qualified topic name.
+      /// \param[in] _count Number of dropped publications.
+      public: void AddQueueDrops(const std::string &_topic,
+                  const uint64_t _count);
+
+      /// \brief Turn the statistics of a service on or off.
+      /// \param[in] _topic The fully qualified service name.
+      /// \param[in] _enable True to enable statistics, false to disable.
+      public: void EnableServiceStats(const std::string &_topic,
+                                      bool _enable);
+
+      /// \brief Get the current statistics of a service.
+      /// \param[in] _topic The fully qualified service name.
+      /// \return The statistics, or std::nullopt if statistics were not
+      /// enabled.
+      public: std::optional<ServiceStatistics> ServiceStats(
+                  const std::string &_topic) const;
+
+      /// \brief Turn the accounting of the execution time of the
+      /// subscription callbacks on or off, for all the nodes.
+      /// \param[in] _enable True to enable the accounting, false to
+      /// disable it.
+      public: void EnableCallbackStats(const bool _enable);
+
+      /// \brief Get the execution time of the subscription callbacks.
+      /// \param[in] _nUuid UUID of the node owning the subscriptions, or an
+      /// empty string for all the nodes.
+      /// \return The statistics of each subscription handler, with the
+      /// fully qualified topic names. Empty if the accounting is disabled.
+      public: std::vector<CallbackStatistics> CallbackStats(
+                  const std::string &_nUuid) const;
+
+      /// \brief Get the metrics of the transport in the Prometheus text
+      /// exposition format: the messages and bytes sent and received per
+      /// topic, the depth of the queues, the dispatch latency, the service
+      /// calls and the discovery traffic. The metrics are enabled with
+      /// GZ_TRANSPORT_METRICS=1, they are also published periodically on
+      /// the /gz/transport/metrics topic.
+      /// \return The metrics, or an empty string if they are disabled.
+      public: std::string MetricsText() const;
+
+      /// \brief Get the memory held by the queues and the caches of the
+      /// transport in this process: the publications waiting for the
+      /// dispatch threads or for ZMQ, the service requests queued, the
+      /// histories of the topics and the discovery tables.
+      /// \return The memory statistics.
+      public: MemoryStatistics MemoryStats() const;
+
+      /// \brief Set a cap on the memory held by the publish queues, the
+      /// messages handed to ZMQ and the external buffers (see
+      /// AddExternalMemory()). Above it, the publications that aren't
+      /// CONTROL messages are dropped, and the log::Recorder drops its
+      /// oldest buffered messages. The cap can also be set with
+      /// GZ_TRANSPORT_MEMORY_CAP (MiB).
+      /// \param[in] _bytes The cap (bytes), 0 for no cap.
+      public: void SetMemoryCap(const uint64_t _bytes);
+
+      /// \brief Get the memory cap.
+      /// \return The cap (bytes), 0 if there is none.
+      /// \sa SetMemoryCap
+      public: uint64_t MemoryCap() const;
+
+      /// \brief Check whether the capped memory exceeds the cap.
+      /// \param[in] _extra Bytes about to be added.
+      /// \return True if there is a cap and the memory held plus _extra
+      /// exceeds it.
+      public: bool MemoryCapExceeded(const uint64_t _extra = 0) const;
+
+      /// \brief Account for memory held by a component buffering messages
+      /// outside of the transport, e.g.: a log::Recorder.
+      /// \param[in] _bytes Bytes allocated, or negative for the bytes
+      /// released.
+      public: void AddExternalMemory(const int64_t _bytes);
+
+      /// \brief Tap the messages of a topic published within this process.
+      /// The callback runs on the publishing thread and receives the
+      /// serialized buffer built by the publisher, without a copy nor a
+      /// hand-off to the dispatch threads, e.g.: for a recorder embedded in
+      /// the process. It must be fast and thread safe. The tap can replace
+      /// the delivery of these messages to a raw subscription, which still
+      /// receives the messages of the other processes (see
+      /// SubscribeOptions::SetTap()).
+      /// \param[in] _topic Fully qualified topic name.
+      /// \param[in] _hUuid UUID of the raw subscription handler replaced,
+      /// or an empty string.
+      /// \param[in] _callback The callback.
+      /// \return Identifier of the tap, see RemoveTap().
+      public: uint64_t AddTap(const std::string &_topic,
+                              const std::string &_hUuid,
+                              const SharedRawCallback &_callback);
+
+      /// \brief Remove a tap. A callback running concurrently might still
+      /// complete after returning.
+      /// \param[in] _id Identifier returned by AddTap().
+      /// \return True if the tap was removed.
+      public: bool RemoveTap(const uint64_t _id);
+
       /// \brief Constructor.
       protected: NodeShared();
 
       /// \brief Destructor.
       protected: virtual ~NodeShared();
 
+      /// \brief Initialize the sockets and the threads of the topics, on
+      /// first use with GZ_TRANSPORT_LAZY_SOCKETS=1. It does nothing if they
+      /// are already initialized.
+      /// \return True when the sockets are initialized, false if any
+      /// operation on a ZMQ socket triggered an exception.
+      public: bool InitializeTopicSockets();
+
+      /// \brief Initialize the sockets of the services, on first use with
+      /// GZ_TRANSPORT_LAZY_SOCKETS=1. It does nothing if they are already
+      /// initialized.
+      /// \return True when the sockets are initialized, false if any
+      /// operation on a ZMQ socket triggered an exception.
+      public: bool InitializeServiceSockets();
+
       /// \brief Initialize all sockets.
       /// \return True when success or false otherwise. This function might
       /// return false if any operation on a ZMQ socket triggered an exception.
       private: bool InitializeSockets();
 
+      /// \brief Start the reception thread if it isn't running.
+      private: void StartReception();
+
+      /// \brief Call the callbacks of the handlers accepting the message
+      /// type with a serialized message stored in a buffer.
+      /// \param[in] _info Message information.
+      /// \param[in] _msgData The serialized message.
+      /// \param[in] _msgSize Size of the serialized message (bytes).
+      /// \param[in] _msgBuffer If not null, buffer storing _msgData that the
+      /// asynchronous raw callbacks share. Otherwise _msgData is copied.
+      /// \param[in] _handlerInfo Handlers accepting the type of the message,
+      /// as generated by CheckMatchingHandlers().
+      /// \param[in] _priority Priority of the publisher, which orders the
+      /// asynchronous callbacks.
+      /// \param[in] _lockstep Token of the delivery if the topic is in
+      /// lockstep, kept by the asynchronous callbacks until they run.
+      private: void TriggerCallbacks(
+        const MessageInfo &_info,
+        const char *_msgData,
+        const std::size_t _msgSize,
+        const SerializedBuffer *_msgBuffer,
+        const MatchingHandlerInfo &_handlerInfo,
+        const Priority_t _priority = Priority_t::NORMAL,
+        const std::shared_ptr<void> &_lockstep = nullptr);
+
       //////////////////////////////////////////////////
       /////// Declare here other member variables //////
       //////////////////////////////////////////////////
@@ -382,6 +691,21 @@ namespace gz
             const std::string &_fullyQualifiedTopic,
             const std::string &_msgTypeName) const;
 
+        /// \brief Get the highest rate requested by the subscribers of a
+        /// node that match the topic and message type criteria.
+        /// \param[in] _fullyQualifiedTopic Fully-qualified topic name that the
+        /// subscribers must be listening to.
+        /// \param[in] _msgTypeName Name of the message type that the
+        /// subscribers must be listening for.
+        /// \param[in] _nUuid UUID of the node of the subscribers.
+        /// \return Maximum number of messages per second, or kUnthrottled if
+        /// any subscriber isn't throttled.
+        /// \sa SubscribeOptions::SetMsgsPerSec
+        public: uint64_t MsgsPerSec(
+            const std::string &_fullyQualifiedTopic,
+            const std::string &_msgTypeName,
+            const std::string &_nUuid) const;
+
         /// \brief Remove the handlers for the given topic name that belong to
         /// a specific node.
         /// \param[in] _fullyQualifiedTopic The fully-qualified name of the
@@ -420,9 +744,6 @@ namespace gz
       /// \brief Service call repliers.
       public: HandlerStorage<IRepHandler> repliers;
 
-      /// \brief Pending service call requests.
-      public: HandlerStorage<IReqHandler> requests;
-
       /// \brief Print activity to stdout.
       public: int verbose;
 
@@ -446,8 +767,10 @@ namespace gz
 #ifdef _WIN32
 #pragma warning(pop)
 #endif
+      private: friend Lockstep;
       private: friend Node;
       private: friend NodePrivate;
+      private: friend NodeSharedPrivate;
     };
     }
   }
@@ -31,13 +31,18 @@
 #pragma warning(pop)
 #endif
 
+#include <chrono>
+#include <cstdint>
 #include <functional>
+#include <future>
 #include <iostream>
 #include <memory>
 #include <string>
 
+#include "gz/transport/AdvertiseOptions.hh"
 #include "gz/transport/config.hh"
 #include "gz/transport/Export.hh"
+#include "gz/transport/ServiceResponder.hh"
 #include "gz/transport/TransportTypes.hh"
 #include "gz/transport/Uuid.hh"
 
@@ -68,6 +73,17 @@ namespace gz
       public: virtual bool RunLocalCallback(const transport::ProtoMsg &_msgReq,
                                             transport::ProtoMsg &_msgRep) = 0;
 
+      /// \brief Executes the local callback registered for this handler,
+      /// without blocking when the response is deferred (see Deferred()).
+      /// \param[in] _msgReq Input parameter (Protobuf message).
+      /// \param[in] _reply Function receiving the response. It is called
+      /// once, from the calling thread unless the response is deferred. The
+      /// response is only valid during the call.
+      public: virtual void RunLocalDeferredCallback(
+        const transport::ProtoMsg &_msgReq,
+        const std::function<void(const transport::ProtoMsg &_msgRep,
+                                 const bool _result)> &_reply) = 0;
+
       /// \brief Executes the callback registered for this handler.
       /// \param[in] _req Serialized data received. The data will be used
       /// to compose a specific protobuf message and will be passed to the
@@ -77,6 +93,28 @@ namespace gz
       public: virtual bool RunCallback(const std::string &_req,
                                        std::string &_rep) = 0;
 
+      /// \brief Executes the callback registered for this handler. The
+      /// response might be sent after this function returns, see Deferred().
+      /// \param[in] _req Serialized request.
+      /// \param[in] _reply Function sending the serialized response. It can
+      /// be called from any thread, once.
+      public: virtual void RunDeferredCallback(const std::string &_req,
+        const std::function<void(const std::string &_rep,
+                                 const bool _result)> &_reply)
+      {
+        std::string rep;
+        const bool result = this->RunCallback(_req, rep);
+        _reply(rep, result);
+      }
+
+      /// \brief Whether the callback can send the response after returning
+      /// (see ServiceResponder).
+      /// \return True if the response can be deferred.
+      public: virtual bool Deferred() const
+      {
+        return false;
+      }
+
       /// \brief Get the unique UUID of this handler.
       /// \return a string representation of the handler UUID.
       public: std::string HandlerUuid() const
@@ -92,6 +130,64 @@ namespace gz
       /// \return Message type name.
       public: virtual std::string RepTypeName() const = 0;
 
+      /// \brief Set the number of requests that can be processed at the same
+      /// time, see AdvertiseServiceOptions::SetConcurrency().
+      /// \param[in] _concurrency The concurrency level.
+      public: void SetConcurrency(const uint32_t _concurrency)
+      {
+        this->concurrency = _concurrency;
+      }
+
+      /// \brief Get the number of requests that can be processed at the same
+      /// time.
+      /// \return The concurrency level, or zero if the requests are processed
+      /// by the thread receiving them.
+      public: uint32_t Concurrency() const
+      {
+        return this->concurrency;
+      }
+
+      /// \brief Set the time to live of the responses cached, see
+      /// AdvertiseServiceOptions::SetCacheTtl().
+      /// \param[in] _ttl The time to live, zero if the service isn't
+      /// cacheable.
+      public: void SetCacheTtl(const std::chrono::milliseconds &_ttl)
+      {
+        this->cacheTtl = _ttl;
+      }
+
+      /// \brief Get the time to live of the responses cached.
+      /// \return The time to live, zero if the service isn't cacheable.
+      public: std::chrono::milliseconds CacheTtl() const
+      {
+        return this->cacheTtl;
+      }
+
+      /// \brief Set the priority of the requests run by the service
+      /// threads, see AdvertiseOptions::SetPriority().
+      /// \param[in] _priority The priority.
+      public: void SetPriority(const Priority_t _priority)
+      {
+        this->priority = _priority;
+      }
+
+      /// \brief Get the priority of the requests run by the service
+      /// threads.
+      /// \return The priority.
+      public: Priority_t Priority() const
+      {
+        return this->priority;
+      }
+
+      /// \brief Number of requests processed at the same time.
+      protected: uint32_t concurrency = 0;
+
+      /// \brief Time to live of the responses cached.
+      protected: std::chrono::milliseconds cacheTtl{0};
+
+      /// \brief Priority of the requests.
+      protected: Priority_t priority = Priority_t::NORMAL;
+
 #ifdef _WIN32
 // Disable warning C4251 which is triggered by
 // std::string
@@ -157,6 +253,17 @@ namespace gz
         return this->cb(*msgReq, *msgRep);
       }
 
+      // Documentation inherited.
+      public: void RunLocalDeferredCallback(
+        const transport::ProtoMsg &_msgReq,
+        const std::function<void(const transport::ProtoMsg &_msgRep,
+                                 const bool _result)> &_reply)
+      {
+        Rep msgRep;
+        const bool result = this->RunLocalCallback(_msgReq, msgRep);
+        _reply(msgRep, result);
+      }
+
       // Documentation inherited.
       public: bool RunCallback(const std::string &_req,
                                std::string &_rep)
@@ -193,13 +300,15 @@ namespace gz
       // Documentation inherited.
       public: virtual std::string ReqTypeName() const
       {
-        return Req().GetTypeName();
+        static const std::string name = Req().GetTypeName();
+        return name;
       }
 
       // Documentation inherited.
       public: virtual std::string RepTypeName() const
       {
-        return Rep().GetTypeName();
+        static const std::string name = Rep().GetTypeName();
+        return name;
       }
 
       /// \brief Create a specific protobuf message given its serialized data.
@@ -223,6 +332,180 @@ namespace gz
       /// \brief Callback to the function registered for this handler.
       private: std::function<bool(const Req &, Rep &)> cb;
     };
+
+    /// \class DeferredRepHandler RepHandler.hh
+    /// \brief A service reply handler whose callback receives a
+    /// ServiceResponder. The response is sent when the responder is
+    /// completed, possibly from another thread after the callback returned.
+    template <typename Req, typename Rep> class DeferredRepHandler
+      : public IRepHandler
+    {
+      // Documentation inherited.
+      public: DeferredRepHandler() = default;
+
+      /// \brief Set the callback for this handler.
+      /// \param[in] _cb The callback with the following parameters:
+      /// * _req Protobuf message containing the service request params
+      /// * _responder Handle used to send the service response.
+      public: void SetCallback(
+        const std::function<void(const Req &, ServiceResponder<Rep>)> &_cb)
+      {
+        this->cb = _cb;
+      }
+
+      // Documentation inherited.
+      // The calling thread is blocked until the response is sent.
+      public: bool RunLocalCallback(const transport::ProtoMsg &_msgReq,
+                                    transport::ProtoMsg &_msgRep)
+      {
+        if (!this->cb)
+        {
+          std::cerr << "DeferredRepHandler::RunLocalCallback() error: "
+                    << "Callback is NULL" << std::endl;
+          return false;
+        }
+
+#if GOOGLE_PROTOBUF_VERSION >= 4022000
+        auto msgReq =
+          google::protobuf::internal::DownCast<const Req*>(&_msgReq);
+        auto msgRep = google::protobuf::internal::DownCast<Rep*>(&_msgRep);
+#elif GOOGLE_PROTOBUF_VERSION > 2999999
+        auto msgReq = google::protobuf::down_cast<const Req*>(&_msgReq);
+        auto msgRep = google::protobuf::down_cast<Rep*>(&_msgRep);
+#else
+        auto msgReq =
+          google::protobuf::internal::down_cast<const Req*>(&_msgReq);
+        auto msgRep = google::protobuf::internal::down_cast<Rep*>(&_msgRep);
+#endif
+
+        auto done = std::make_shared<std::promise<bool>>();
+        std::future<bool> result = done->get_future();
+        this->cb(*msgReq, ServiceResponder<Rep>(
+          [msgRep, done](const Rep &_rep, const bool _result)
+          {
+            if (_result)
+              *msgRep = _rep;
+            done->set_value(_result);
+          }));
+
+        return result.get();
+      }
+
+      // Documentation inherited.
+      public: void RunLocalDeferredCallback(
+        const transport::ProtoMsg &_msgReq,
+        const std::function<void(const transport::ProtoMsg &_msgRep,
+                                 const bool _result)> &_reply)
+      {
+        if (!this->cb)
+        {
+          std::cerr << "DeferredRepHandler::RunLocalDeferredCallback() error: "
+                    << "Callback is NULL" << std::endl;
+          _reply(Rep(), false);
+          return;
+        }
+
+#if GOOGLE_PROTOBUF_VERSION >= 4022000
+        auto msgReq =
+          google::protobuf::internal::DownCast<const Req*>(&_msgReq);
+#elif GOOGLE_PROTOBUF_VERSION > 2999999
+        auto msgReq = google::protobuf::down_cast<const Req*>(&_msgReq);
+#else
+        auto msgReq =
+          google::protobuf::internal::down_cast<const Req*>(&_msgReq);
+#endif
+
+        auto reply = _reply;
+        this->cb(*msgReq, ServiceResponder<Rep>(
+          [reply](const Rep &_rep, const bool _result)
+          {
+            reply(_rep, _result);
+          }));
+      }
+
+      // Documentation inherited.
+      // The calling thread is blocked until the response is sent.
+      public: bool RunCallback(const std::string &_req,
+                               std::string &_rep)
+      {
+        auto done = std::make_shared<std::promise<bool>>();
+        std::future<bool> result = done->get_future();
+        this->RunDeferredCallback(_req,
+          [&_rep, done](const std::string &_data, const bool _result)
+          {
+            _rep = _data;
+            done->set_value(_result);
+          });
+
+        return result.get();
+      }
+
+      // Documentation inherited.
+      public: void RunDeferredCallback(const std::string &_req,
+        const std::function<void(const std::string &_rep,
+                                 const bool _result)> &_reply)
+      {
+        // Check if we have a callback registered.
+        if (!this->cb)
+        {
+          std::cerr << "DeferredRepHandler::RunDeferredCallback() error: "
+                    << "Callback is NULL" << std::endl;
+          _reply("", false);
+          return;
+        }
+
+        Req msgReq;
+        if (!msgReq.ParseFromString(_req))
+        {
+          std::cerr << "DeferredRepHandler::RunDeferredCallback() error: "
+                    << "ParseFromString failed" << std::endl;
+        }
+
+        this->cb(msgReq, ServiceResponder<Rep>(
+          [_reply](const Rep &_rep, const bool _result)
+          {
+            std::string data;
+            if (!_result)
+            {
+              _reply(data, false);
+              return;
+            }
+
+            if (!_rep.SerializeToString(&data))
+            {
+              std::cerr << "DeferredRepHandler: Error serializing the "
+                        << "response" << std::endl;
+              _reply("", false);
+              return;
+            }
+
+            _reply(data, true);
+          }));
+      }
+
+      // Documentation inherited.
+      public: bool Deferred() const
+      {
+        return true;
+      }
+
+      // Documentation inherited.
+      public: virtual std::string ReqTypeName() const
+      {
+        static const std::string name = Req().GetTypeName();
+        return name;
+      }
+
+      // Documentation inherited.
+      public: virtual std::string RepTypeName() const
+      {
+        static const std::string name = Rep().GetTypeName();
+        return name;
+      }
+
+      /// \brief Callback to the function registered for this handler.
+      private: std::function<void(const Req &, ServiceResponder<Rep>)> cb;
+    };
     }
   }
 }
@@ -28,12 +28,17 @@
 #endif
 
 #include <condition_variable>
+#include <cstdint>
+#include <cstring>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 
 #include "gz/transport/config.hh"
 #include "gz/transport/Export.hh"
+#include "gz/transport/NodeOptions.hh"
 #include "gz/transport/TransportTypes.hh"
 #include "gz/transport/Uuid.hh"
 
@@ -44,6 +49,8 @@ namespace gz
     // Inline bracket to help doxygen filtering.
     inline namespace GZ_TRANSPORT_VERSION_NAMESPACE {
     //
+    class Executor;
+
     /// \class IReqHandler ReqHandler.hh gz/transport/ReqHandler.hh
     /// \brief Interface class used to manage a request handler.
     class GZ_TRANSPORT_VISIBLE IReqHandler
@@ -107,11 +114,108 @@ namespace gz
         this->requested = _value;
       }
 
+      /// \brief Set the time after which the request is abandoned, see
+      /// NodeShared::AddRequest().
+      /// \param[in] _deadline The deadline.
+      public: void SetDeadline(const Timestamp &_deadline)
+      {
+        this->deadline = _deadline;
+      }
+
+      /// \brief Get the time after which the request is abandoned.
+      /// \return The deadline, Timestamp::max() if the request never expires.
+      public: Timestamp Deadline() const
+      {
+        return this->deadline;
+      }
+
+      /// \brief Run the callback of the request on an executor instead of
+      /// the thread receiving the response, see
+      /// NodeOptions::SetResponseExecutor().
+      /// \param[in] _executor The executor, or nullptr for none.
+      public: void SetCallbackExecutor(
+        const std::shared_ptr<Executor> &_executor)
+      {
+        this->executor = _executor;
+      }
+
+      /// \brief Get the executor running the callback of the request.
+      /// \return The executor, or nullptr if none.
+      public: const std::shared_ptr<Executor> &CallbackExecutor() const
+      {
+        return this->executor;
+      }
+
+      /// \brief Set how the responser of the request is chosen when several
+      /// processes provide the service.
+      /// \param[in] _policy The policy.
+      public: void SetLoadBalancing(const LoadBalancing_t _policy)
+      {
+        this->loadBalancing = _policy;
+      }
+
+      /// \brief Get how the responser of the request is chosen.
+      /// \return The policy.
+      public: LoadBalancing_t LoadBalancing() const
+      {
+        return this->loadBalancing;
+      }
+
       /// \brief Serialize the Req protobuf message stored.
       /// \param[out] _buffer The serialized data.
       /// \return True if the serialization succeed or false otherwise.
       public: virtual bool Serialize(std::string &_buffer) const = 0;
 
+      /// \brief Whether the request is a batch of requests, see
+      /// BatchReqHandler.
+      /// \return True if Serialize() produces a batch.
+      public: virtual bool Batch() const
+      {
+        return false;
+      }
+
+      /// \brief Pack serialized messages into a batch. Each message is
+      /// preceded by its size as a 32-bit integer.
+      /// \param[in] _msgs The messages.
+      /// \param[out] _batch The batch.
+      public: static void PackBatch(const std::vector<std::string> &_msgs,
+                                    std::string &_batch)
+      {
+        _batch.clear();
+        for (const auto &msg : _msgs)
+        {
+          const uint32_t size = static_cast<uint32_t>(msg.size());
+          _batch.append(reinterpret_cast<const char *>(&size), sizeof(size));
+          _batch.append(msg);
+        }
+      }
+
+      /// \brief Unpack a batch created by PackBatch().
+      /// \param[in] _batch The batch.
+      /// \param[out] _msgs The messages.
+      /// \return True on success or false if the batch is malformed.
+      public: static bool UnpackBatch(const std::string &_batch,
+                                      std::vector<std::string> &_msgs)
+      {
+        _msgs.clear();
+        std::size_t pos = 0;
+        while (pos < _batch.size())
+        {
+          uint32_t size;
+          if (_batch.size() - pos < sizeof(size))
+            return false;
+
+          std::memcpy(&size, _batch.data() + pos, sizeof(size));
+          pos += sizeof(size);
+          if (_batch.size() - pos < size)
+            return false;
+
+          _msgs.emplace_back(_batch, pos, size);
+          pos += size;
+        }
+        return true;
+      }
+
       /// \brief Returns the unique handler UUID.
       /// \return The handler's UUID.
       public: std::string HandlerUuid() const
@@ -138,6 +242,38 @@ namespace gz
           });
       }
 
+      /// \brief Block the current thread until the response to the
+      /// service request is available or until the request is abandoned
+      /// (see Expire()). Unlike WaitUntil(), the thread doesn't wait with a
+      /// timeout of its own, the deadline of the request is enforced by the
+      /// reception thread of NodeShared.
+      /// \param[in] _lock Lock released while waiting.
+      /// \return True if the service call was executed or false if it was
+      /// abandoned.
+      public: template<typename Lock> bool Wait(Lock &_lock)
+      {
+        _lock.unlock();
+        {
+          std::unique_lock<std::mutex> lk(this->repMutex);
+          this->condition.wait(lk, [this]
+          {
+            return this->repAvailable;
+          });
+        }
+        _lock.lock();
+        return !this->expired;
+      }
+
+      /// \brief Abandon the request, because its deadline has passed or its
+      /// responser is gone. A thread blocked in Wait() returns false and the
+      /// callback of a non-blocking request is executed with a failed
+      /// result.
+      public: void Expire()
+      {
+        this->expired = true;
+        this->NotifyResult("", false);
+      }
+
       /// \brief Get the message type name used in the service request.
       /// \return Message type name.
       public: virtual std::string ReqTypeName() const = 0;
@@ -146,6 +282,17 @@ namespace gz
       /// \return Message type name.
       public: virtual std::string RepTypeName() const = 0;
 
+      /// \brief Mark the response as available and wake up the thread
+      /// blocked in Wait() or WaitUntil().
+      protected: void NotifyAvailable()
+      {
+        {
+          std::lock_guard<std::mutex> lk(this->repMutex);
+          this->repAvailable = true;
+        }
+        this->condition.notify_one();
+      }
+
 #ifdef _WIN32
 // Disable warning C4251 which is triggered by
 // std::*
@@ -156,6 +303,10 @@ namespace gz
       /// available.
       protected: std::condition_variable_any condition;
 
+      /// \brief Protect repAvailable for Wait(), so a response notified
+      /// while the requester starts waiting isn't missed.
+      private: std::mutex repMutex;
+
       /// \brief Stores the service response as raw bytes.
       protected: std::string rep;
 
@@ -164,6 +315,9 @@ namespace gz
 
       /// \brief Node UUID.
       private: std::string nUuid;
+
+      /// \brief Executor running the callback, or nullptr.
+      private: std::shared_ptr<Executor> executor;
 #ifdef _WIN32
 #pragma warning(pop)
 #endif
@@ -175,6 +329,15 @@ namespace gz
       /// its way. Used to not resend the same REQ more than one time.
       private: bool requested;
 
+      /// \brief Time after which the request is abandoned.
+      private: Timestamp deadline = Timestamp::max();
+
+      /// \brief True if the request was abandoned, see Expire().
+      private: bool expired = false;
+
+      /// \brief How the responser of the request is chosen.
+      private: LoadBalancing_t loadBalancing = LoadBalancing_t::FIRST;
+
       /// \brief When there is a blocking service call request, the call can
       /// be unlocked when a service call REP is available. This variable
       /// captures if we have found a node that can satisty our request.
@@ -278,8 +441,7 @@ namespace gz
           this->result = _result;
         }
 
-        this->repAvailable = true;
-        this->condition.notify_one();
+        this->NotifyAvailable();
       }
 
       // Documentation inherited.
@@ -305,6 +467,104 @@ namespace gz
       private: std::function<void(const Rep &_rep, const bool _result)> cb;
     };
 
+    /// \class BatchReqHandler ReqHandler.hh
+    /// \brief A handler sending several requests to a service in a single
+    /// message, see Node::RequestBatch(). The responder processes them in
+    /// order and sends all the responses back in a single message.
+    /// Each response of the batch is preceded by a byte containing the
+    /// result of the service call.
+    template <typename Req, typename Rep> class BatchReqHandler
+      : public IReqHandler
+    {
+      // Documentation inherited.
+      public: explicit BatchReqHandler(const std::string &_nUuid)
+        : IReqHandler(_nUuid)
+      {
+      }
+
+      /// \brief Set the requests of the batch.
+      /// \param[in] _reqs The requests.
+      /// \return True on success or false if a request couldn't be
+      /// serialized.
+      public: bool SetMessages(const std::vector<Req> &_reqs)
+      {
+        std::vector<std::string> data(_reqs.size());
+        for (std::size_t i = 0; i < _reqs.size(); ++i)
+        {
+          if (!_reqs[i].SerializeToString(&data[i]))
+          {
+            std::cerr << "BatchReqHandler::SetMessages(): Error serializing "
+                      << "the request" << std::endl;
+            return false;
+          }
+        }
+
+        PackBatch(data, this->batch);
+        return true;
+      }
+
+      // Documentation inherited.
+      public: bool Serialize(std::string &_buffer) const
+      {
+        _buffer = this->batch;
+        return true;
+      }
+
+      // Documentation inherited.
+      public: bool Batch() const
+      {
+        return true;
+      }
+
+      // Documentation inherited.
+      public: void NotifyResult(const std::string &_rep, const bool _result)
+      {
+        this->rep = _rep;
+        this->result = _result;
+        this->NotifyAvailable();
+      }
+
+      /// \brief Get the responses, once the result has been notified.
+      /// \param[out] _reps The responses.
+      /// \param[out] _results The results of the service calls.
+      /// \return True on success or false if the responses are malformed.
+      public: bool Responses(std::vector<Rep> &_reps,
+                             std::vector<bool> &_results) const
+      {
+        std::vector<std::string> data;
+        if (!UnpackBatch(this->rep, data))
+          return false;
+
+        _reps.assign(data.size(), Rep());
+        _results.assign(data.size(), false);
+        for (std::size_t i = 0; i < data.size(); ++i)
+        {
+          if (data[i].empty())
+            return false;
+
+          _results[i] = data[i][0] != 0 &&
+            _reps[i].ParseFromArray(data[i].data() + 1,
+              static_cast<int>(data[i].size() - 1));
+        }
+        return true;
+      }
+
+      // Documentation inherited.
+      public: virtual std::string ReqTypeName() const
+      {
+        return Req().GetTypeName();
+      }
+
+      // Documentation inherited.
+      public: virtual std::string RepTypeName() const
+      {
+        return Rep().GetTypeName();
+      }
+
+      /// \brief The requests, packed with PackBatch().
+      private: std::string batch;
+    };
+
     /// \class ReqHandler<google::protobuf::Message> ReqHandler.hh
     /// \brief Template specialization for google::protobuf::Message.
     /// This is only used by some gz command line tools.
@@ -349,6 +609,18 @@ namespace gz
         this->repMsg->CopyFrom(*_repMsg);
       }
 
+      /// \brief Set the callback for this handler, executed with the
+      /// serialized response.
+      /// \param[in] _cb The callback with the following parameters:
+      /// * _rep Serialized protobuf message containing the service response.
+      /// * _result True when the service request was successful or
+      /// false otherwise.
+      public: void SetCallback(const std::function <void(
+        const std::string &_rep, const bool _result)> &_cb)
+      {
+        this->cb = _cb;
+      }
+
       // Documentation inherited
       public: bool Serialize(std::string &_buffer) const
       {
@@ -371,11 +643,18 @@ namespace gz
       // Documentation inherited.
       public: void NotifyResult(const std::string &_rep, const bool _result)
       {
-        this->rep = _rep;
-        this->result = _result;
+        // Execute the callback (if existing).
+        if (this->cb)
+        {
+          this->cb(_rep, _result);
+        }
+        else
+        {
+          this->rep = _rep;
+          this->result = _result;
+        }
 
-        this->repAvailable = true;
-        this->condition.notify_one();
+        this->NotifyAvailable();
       }
 
       // Documentation inherited.
@@ -409,6 +688,10 @@ namespace gz
 
       /// \brief Protobuf message containing the response.
       private: google::protobuf::Message *repMsg = nullptr;
+
+      /// \brief Callback to the function registered for this handler.
+      private: std::function<void(const std::string &_rep,
+                                  const bool _result)> cb;
     };
     }
   }
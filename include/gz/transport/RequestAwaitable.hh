@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GZ_TRANSPORT_REQUESTAWAITABLE_HH_
+#define GZ_TRANSPORT_REQUESTAWAITABLE_HH_
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#define GZ_TRANSPORT_HAS_COROUTINES
+#endif
+
+#ifdef GZ_TRANSPORT_HAS_COROUTINES
+
+#include <atomic>
+#include <coroutine>
+#include <functional>
+#include <memory>
+#include <utility>
+
+#include "gz/transport/config.hh"
+
+namespace gz
+{
+  namespace transport
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace GZ_TRANSPORT_VERSION_NAMESPACE {
+    //
+    /// \class RequestAwaitable RequestAwaitable.hh
+    /// gz/transport/RequestAwaitable.hh
+    /// \brief The result of Node::RequestAwait(), to be awaited by a C++20
+    /// coroutine. The request is sent when the coroutine is suspended and
+    /// the coroutine is resumed with the response, on the thread receiving
+    /// it. Only available when compiling with coroutine support.
+    ///
+    /// Example:
+    ///
+    ///    Task work(transport::Node &_node, const msgs::Int32 &_req)
+    ///    {
+    ///      auto [rep, result] =
+    ///        co_await _node.RequestAwait<msgs::Int32, msgs::Int32>(
+    ///          "/echo", _req, 1000);
+    ///      ...
+    ///    }
+    template <typename Rep>
+    class RequestAwaitable
+    {
+      /// \brief Function sending the request. Its argument is the callback
+      /// executed with the response.
+      public: using StartFunc = std::function<void(
+        const std::function<void(const Rep &_rep, const bool _result)> &)>;
+
+      /// \brief Constructor.
+      /// \param[in] _start Function sending the request.
+      public: explicit RequestAwaitable(StartFunc _start)
+        : start(std::move(_start)),
+          state(std::make_shared<State>())
+      {
+      }
+
+      /// \brief The request is only sent once the coroutine is suspended.
+      /// \return Always false.
+      public: bool await_ready() const noexcept
+      {
+        return false;
+      }
+
+      /// \brief Send the request.
+      /// \param[in] _handle The coroutine awaiting the response.
+      /// \return False if the response is already available (e.g.: the
+      /// service is provided by this process), the coroutine keeps running.
+      public: bool await_suspend(std::coroutine_handle<> _handle)
+      {
+        auto st = this->state;
+        st->handle = _handle;
+        this->start([st](const Rep &_rep, const bool _result)
+        {
+          st->rep = _rep;
+          st->result = _result;
+
+          // Only resume the coroutine once it is suspended.
+          if (st->done.exchange(true))
+            st->handle.resume();
+        });
+
+        return !st->done.exchange(true);
+      }
+
+      /// \brief Get the response.
+      /// \return The response and the result of the service call. The
+      /// result is false if the call failed or timed out.
+      public: std::pair<Rep, bool> await_resume()
+      {
+        return std::make_pair(std::move(this->state->rep),
+          this->state->result);
+      }
+
+      /// \brief State shared with the callback.
+      private: struct State
+      {
+        /// \brief The coroutine awaiting the response.
+        std::coroutine_handle<> handle;
+
+        /// \brief The response.
+        Rep rep;
+
+        /// \brief Result of the service call.
+        bool result = false;
+
+        /// \brief Set by the first of the callback and await_suspend().
+        std::atomic<bool> done{false};
+      };
+
+      /// \brief Function sending the request.
+      private: StartFunc start;
+
+      /// \brief State shared with the callback.
+      private: std::shared_ptr<State> state;
+    };
+    }
+  }
+}
+
+#endif
+#endif
@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GZ_TRANSPORT_SERVICERESPONDER_HH_
+#define GZ_TRANSPORT_SERVICERESPONDER_HH_
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <utility>
+
+#include "gz/transport/config.hh"
+
+namespace gz
+{
+  namespace transport
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace GZ_TRANSPORT_VERSION_NAMESPACE {
+    //
+    /// \class ServiceResponder ServiceResponder.hh
+    /// gz/transport/ServiceResponder.hh
+    /// \brief A handle used to send the response of a service request after
+    /// the service callback has returned. The handle can be copied and
+    /// moved to another thread, Reply() can be called from any thread but
+    /// only the first call sends a response. If all the copies are
+    /// destroyed without replying, a failed response is sent so the
+    /// requester doesn't wait until its timeout.
+    ///
+    /// Example:
+    ///
+    ///    std::function<void(const msgs::Int32 &,
+    ///                       ServiceResponder<msgs::Int32>)> cb =
+    ///      [&pool](const msgs::Int32 &_req,
+    ///              ServiceResponder<msgs::Int32> _responder)
+    ///    {
+    ///      pool.Run([_req, _responder]()
+    ///      {
+    ///        msgs::Int32 rep;
+    ///        rep.set_data(slowComputation(_req.data()));
+    ///        _responder.Reply(rep);
+    ///      });
+    ///    };
+    ///    node.Advertise("/compute", cb);
+    template <typename Rep>
+    class ServiceResponder
+    {
+      /// \brief Function sending the response.
+      /// \param[in] _rep The response.
+      /// \param[in] _result Result of the service call.
+      public: using ReplyFunc =
+        std::function<void(const Rep &_rep, const bool _result)>;
+
+      /// \brief Default constructor. The responder is not valid.
+      public: ServiceResponder() = default;
+
+      /// \brief Constructor.
+      /// \param[in] _func Function sending the response.
+      public: explicit ServiceResponder(ReplyFunc _func)
+        : state(std::make_shared<State>(std::move(_func)))
+      {
+      }
+
+      /// \brief Send the response.
+      /// \param[in] _rep The response.
+      /// \param[in] _result Result of the service call. The response is not
+      /// sent to the requester if the call failed.
+      /// \return True on success or false if the responder is not valid or
+      /// a response has already been sent.
+      public: bool Reply(const Rep &_rep, const bool _result = true) const
+      {
+        if (!this->state || this->state->replied.exchange(true))
+          return false;
+
+        this->state->func(_rep, _result);
+        return true;
+      }
+
+      /// \brief Send a failed response.
+      /// \return True on success or false if the responder is not valid or
+      /// a response has already been sent.
+      public: bool Fail() const
+      {
+        return this->Reply(Rep(), false);
+      }
+
+      /// \brief Whether a response can still be sent.
+      /// \return True if the responder is valid and no response has been
+      /// sent yet.
+      public: bool Pending() const
+      {
+        return this->state && !this->state->replied;
+      }
+
+      /// \brief State shared by the copies of a responder.
+      private: struct State
+      {
+        /// \brief Constructor.
+        /// \param[in] _func Function sending the response.
+        explicit State(ReplyFunc _func)
+          : func(std::move(_func))
+        {
+        }
+
+        /// \brief Destructor. Send a failed response if none was sent.
+        ~State()
+        {
+          if (!this->replied && this->func)
+            this->func(Rep(), false);
+        }
+
+        /// \brief Function sending the response.
+        ReplyFunc func;
+
+        /// \brief True once a response has been sent.
+        std::atomic<bool> replied{false};
+      };
+
+      /// \brief Shared state, nullptr if the responder is not valid.
+      private: std::shared_ptr<State> state;
+    };
+    }
+  }
+}
+
+#endif
@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GZ_TRANSPORT_SERVICESTATISTICS_HH_
+#define GZ_TRANSPORT_SERVICESTATISTICS_HH_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gz/transport/config.hh"
+#include "gz/transport/Export.hh"
+#include "gz/transport/TopicStatistics.hh"
+
+namespace gz
+{
+  namespace transport
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace GZ_TRANSPORT_VERSION_NAMESPACE {
+    //
+    // Forward declarations.
+    class ServiceStatisticsPrivate;
+
+    /// \brief Encapsulates the latencies of a service. A service call is
+    /// split in:
+    ///
+    /// 1. Queue time: between the reception of the request by the
+    ///    responser and the start of its callback. It is spent waiting for
+    ///    a service thread (see AdvertiseServiceOptions::SetConcurrency).
+    /// 2. Callback time: running the callback of the responser, until
+    ///    the response is ready.
+    /// 3. Wire time: the rest of the round trip measured by the requester,
+    ///    that is, sending the request and the response.
+    ///
+    /// A process serving the service measures the queue and callback times
+    /// of the requests it receives. A process requesting the service
+    /// measures the round trip time of each responser, the responsers
+    /// report their queue and callback times with the responses.
+    class GZ_TRANSPORT_VISIBLE ServiceStatistics
+    {
+      /// \brief Default constructor.
+      public: ServiceStatistics();
+
+      /// \brief Copy constructor.
+      /// \param[in] _stats Statistics to copy.
+      public: ServiceStatistics(const ServiceStatistics &_stats);
+
+      /// \brief Default destructor.
+      public: ~ServiceStatistics();
+
+      /// \brief Account for a request served by this process.
+      /// \param[in] _queue Queue time (ms).
+      /// \param[in] _callback Callback time (ms).
+      public: void Update(double _queue, double _callback);
+
+      /// \brief Account for a response from a responser that didn't report
+      /// its queue and callback times.
+      /// \param[in] _responser Process UUID of the responser.
+      /// \param[in] _roundTrip Round trip time (ms).
+      public: void UpdateResponse(const std::string &_responser,
+                                  double _roundTrip);
+
+      /// \brief Account for a response.
+      /// \param[in] _responser Process UUID of the responser.
+      /// \param[in] _roundTrip Round trip time (ms).
+      /// \param[in] _queue Queue time reported by the responser (ms).
+      /// \param[in] _callback Callback time reported by the responser (ms).
+      public: void UpdateResponse(const std::string &_responser,
+                                  double _roundTrip,
+                                  double _queue,
+                                  double _callback);
+
+      /// \brief Get the queue time of the requests served by this process.
+      /// \return The queue times.
+      public: LatencyHistogram QueueTime() const;
+
+      /// \brief Get the callback time of the requests served by this
+      /// process.
+      /// \return The callback times.
+      public: LatencyHistogram CallbackTime() const;
+
+      /// \brief Get the responsers that answered the requests of this
+      /// process.
+      /// \return The process UUIDs of the responsers.
+      public: std::vector<std::string> Responsers() const;
+
+      /// \brief Get the round trip time of the requests sent to a
+      /// responser.
+      /// \param[in] _responser Process UUID of the responser.
+      /// \return The round trip times.
+      public: LatencyHistogram RoundTripTime(
+                  const std::string &_responser) const;
+
+      /// \brief Get the queue time reported by a responser.
+      /// \param[in] _responser Process UUID of the responser.
+      /// \return The queue times.
+      public: LatencyHistogram QueueTime(const std::string &_responser) const;
+
+      /// \brief Get the callback time reported by a responser.
+      /// \param[in] _responser Process UUID of the responser.
+      /// \return The callback times.
+      public: LatencyHistogram CallbackTime(
+                  const std::string &_responser) const;
+
+      /// \brief Get the wire time of the requests sent to a responser. Only
+      /// the responses reporting the queue and callback times are counted.
+      /// \param[in] _responser Process UUID of the responser.
+      /// \return The wire times.
+      public: LatencyHistogram WireTime(const std::string &_responser) const;
+#ifdef _WIN32
+// Disable warning C4251 which is triggered by
+// std::unique_ptr
+#pragma warning(push)
+#pragma warning(disable: 4251)
+#endif
+      /// \brief Private data pointer.
+      private: std::unique_ptr<ServiceStatisticsPrivate> dataPtr;
+#ifdef _WIN32
+#pragma warning(pop)
+#endif
+    };
+    }
+  }
+}
+#endif
@@ -0,0 +1,161 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GZ_TRANSPORT_STATSAGGREGATOR_HH_
+#define GZ_TRANSPORT_STATSAGGREGATOR_HH_
+
+#include <gz/msgs/statistic.pb.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gz/transport/config.hh"
+#include "gz/transport/Export.hh"
+#include "gz/transport/NodeOptions.hh"
+
+namespace gz
+{
+  namespace transport
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace GZ_TRANSPORT_VERSION_NAMESPACE {
+    //
+    // Forward declarations.
+    class StatsAggregatorPrivate;
+
+    /// \brief System-wide statistics of a topic, see
+    /// StatsAggregator::Topics(). The rates are the sums of the rates of
+    /// the processes, measured between their last two reports.
+    struct AggregatedTopicStatistics
+    {
+      /// \brief Fully qualified topic name.
+      std::string topic;
+
+      /// \brief Number of processes sending or receiving the topic.
+      std::size_t processes{0};
+
+      /// \brief Messages sent per second.
+      double sentMsgsPerSec{0};
+
+      /// \brief Bytes sent per second.
+      double sentBytesPerSec{0};
+
+      /// \brief Messages received per second, from remote publishers and
+      /// within the processes.
+      double receivedMsgsPerSec{0};
+
+      /// \brief Bytes received per second.
+      double receivedBytesPerSec{0};
+
+      /// \brief Messages dropped per second: the send failures, the
+      /// messages dropped by the subscriber queues and, with topic
+      /// statistics, the gaps in the sequence numbers.
+      double droppedMsgsPerSec{0};
+
+      /// \brief Fraction of the messages dropped, in the range [0, 1]:
+      /// the dropped messages over the received and dropped messages.
+      double dropRate{0};
+
+      /// \brief Number of messages whose age was measured by the processes
+      /// with topic statistics enabled, since they were enabled.
+      uint64_t latencyCount{0};
+
+      /// \brief Median message age (ms), the average of the medians of the
+      /// processes weighted by their number of messages.
+      double latencyP50{0};
+
+      /// \brief 99th percentile of the message age (ms), the worst of the
+      /// processes.
+      double latencyP99{0};
+
+      /// \brief Maximum message age (ms).
+      double latencyMax{0};
+    };
+
+    /// \class StatsAggregator StatsAggregator.hh
+    /// gz/transport/StatsAggregator.hh
+    /// \brief Aggregate the statistics of the topics across all the
+    /// processes of a partition. Every process running with
+    /// GZ_TRANSPORT_METRICS=1 publishes the counters of all its topics in
+    /// a single message every GZ_TRANSPORT_METRICS_PERIOD, so the
+    /// aggregator only receives one low rate topic whatever the number of
+    /// processes and topics. The message age is only reported for the
+    /// topics with topic statistics enabled (GZ_TRANSPORT_TOPIC_STATISTICS
+    /// and Node::EnableStats()) in the subscribing process.
+    ///
+    /// The processes that stop reporting for three periods are forgotten.
+    class GZ_TRANSPORT_VISIBLE StatsAggregator
+    {
+      /// \brief Constructor.
+      /// \param[in] _options Options of the node subscribing to the
+      /// metrics, e.g. its partition.
+      public: explicit StatsAggregator(
+                  const NodeOptions &_options = NodeOptions());
+
+      /// \brief Destructor.
+      public: ~StatsAggregator();
+
+      /// \brief Subscribe to the metrics of the processes.
+      /// \return True on success, false if the aggregator is already
+      /// started or the subscription failed.
+      public: bool Start();
+
+      /// \brief Stop the subscription. The statistics received are kept.
+      public: void Stop();
+
+      /// \brief Add a metric message published by a process. Start() calls
+      /// it for every message received. The messages that don't identify
+      /// their process, e.g.: published by Node::EnableStats(), are
+      /// ignored.
+      /// \param[in] _msg The message.
+      /// \param[in] _now Reception time of the message.
+      public: void AddMetrics(const msgs::Metric &_msg,
+                  const std::chrono::steady_clock::time_point &_now =
+                    std::chrono::steady_clock::now());
+
+      /// \brief Get the system-wide statistics of the topics.
+      /// \param[in] _now Current time, used to forget the processes that
+      /// stopped reporting.
+      /// \return The statistics, sorted by topic name.
+      public: std::vector<AggregatedTopicStatistics> Topics(
+                  const std::chrono::steady_clock::time_point &_now =
+                    std::chrono::steady_clock::now()) const;
+
+      /// \brief Get the number of processes reporting their metrics.
+      /// \return The number of processes.
+      public: std::size_t ProcessCount() const;
+
+#ifdef _WIN32
+// Disable warning C4251 which is triggered by
+// std::unique_ptr
+#pragma warning(push)
+#pragma warning(disable: 4251)
+#endif
+      /// \brief Private data pointer.
+      private: std::unique_ptr<StatsAggregatorPrivate> dataPtr;
+#ifdef _WIN32
+#pragma warning(pop)
+#endif
+    };
+    }
+  }
+}
+#endif
@@ -23,6 +23,8 @@
 
 #include "gz/transport/config.hh"
 #include "gz/transport/Export.hh"
+#include "gz/transport/MessageFilter.hh"
+#include "gz/transport/TransportTypes.hh"
 
 namespace gz
 {
@@ -31,8 +33,27 @@ namespace gz
     // Inline bracket to help doxygen filtering.
     inline namespace GZ_TRANSPORT_VERSION_NAMESPACE {
     //
+    class Executor;
     class SubscribeOptionsPrivate;
 
+    /// \brief This strongly typed enum defines what happens when a
+    /// publication is delivered to a subscription whose intra-process queue
+    /// is full.
+    /// \sa SubscribeOptions::SetQueueDepth
+    enum class QueuePolicy_t
+    {
+      /// \brief Discard the oldest pending message to make room for the new
+      /// one (default policy).
+      DROP_OLDEST,
+      /// \brief Discard the new message.
+      DROP_NEWEST,
+      /// \brief Block the publisher until the subscriber catches up. Never
+      /// publish on the topic from its own callback with this policy. The
+      /// messages received from other processes are discarded instead, the
+      /// thread receiving them never waits.
+      BLOCK_PUBLISHER
+    };
+
     /// \class SubscribeOptions SubscribeOptions.hh
     /// gz/transport/SubscribeOptions.hh
     /// \brief A class to provide different options for a subscription.
@@ -58,6 +79,9 @@ namespace gz
       /// topic. Note that we calculate the minimum period of a message based
       /// on the msgs/sec rate. Any message received since the last subscription
       /// callback and the duration of the period will be discarded.
+      /// The publishers in other processes are told the highest rate of the
+      /// subscribers of a node, and don't send the messages beyond about
+      /// twice this rate when all their remote subscribers are throttled.
       /// \param[in] _newMsgsPerSec Maximum number of messages per second.
       public: void SetMsgsPerSec(const uint64_t _newMsgsPerSec);
 
@@ -66,6 +90,178 @@ namespace gz
       /// \return The maximum number of messages per second.
       public: uint64_t MsgsPerSec() const;
 
+      /// \brief Set the maximum number of messages published within the
+      /// same process that can be pending for this subscription. When the
+      /// limit is reached, the queue policy selects what happens with the
+      /// next message. A depth of zero means unbounded (default).
+      /// \param[in] _depth Maximum number of pending messages.
+      /// \sa SetQueuePolicy
+      public: void SetQueueDepth(const uint64_t _depth);
+
+      /// \brief Get the maximum number of pending intra-process messages.
+      /// \return The queue depth or zero if the queue is unbounded.
+      public: uint64_t QueueDepth() const;
+
+      /// \brief Set the policy applied when the intra-process queue of this
+      /// subscription is full. The policy is ignored when the queue depth is
+      /// zero.
+      /// \param[in] _policy The queue policy.
+      /// \sa SetQueueDepth
+      public: void SetQueuePolicy(const QueuePolicy_t _policy);
+
+      /// \brief Get the policy applied when the intra-process queue is full.
+      /// \return The queue policy.
+      public: QueuePolicy_t QueuePolicy() const;
+
+      /// \brief Size the intra-process queue of this subscription from the
+      /// measured load: the arrival rate, the size of the messages, the
+      /// execution time of the callback and the bursts of pending messages.
+      /// The queues of all the adaptive subscriptions of the process share a
+      /// memory budget (see GZ_TRANSPORT_QUEUE_BUDGET), split in proportion
+      /// to their needs when it is exceeded. A queue depth set with
+      /// SetQueueDepth() is the maximum depth. The queue policy applies when
+      /// the queue is full. The default value is false.
+      /// \param[in] _adaptive True to size the queue from the load.
+      public: void SetAdaptiveQueue(const bool _adaptive);
+
+      /// \brief Whether the intra-process queue is sized from the load.
+      /// \return True if the queue is adaptive.
+      /// \sa SetAdaptiveQueue
+      public: bool AdaptiveQueue() const;
+
+      /// \brief Only keep the newest pending message of the topic. When the
+      /// callback is slower than the publisher, the messages received in the
+      /// meantime are replaced by the latest one instead of being delivered
+      /// in order. This applies to messages published within the same process
+      /// and to messages already queued by the transport when receiving from
+      /// other processes. Unlike SetMsgsPerSec(), messages are only dropped
+      /// when the callback is not ready to process them.
+      /// \param[in] _conflate True to only deliver the newest message.
+      public: void SetConflate(const bool _conflate);
+
+      /// \brief Whether only the newest pending message is delivered.
+      /// \return True if the subscription is conflated.
+      /// \sa SetConflate
+      public: bool Conflate() const;
+
+      /// \brief Run the callbacks of messages received from other processes
+      /// on the dispatch threads, the threads already running the callbacks
+      /// of messages published within the process, instead of the thread
+      /// receiving messages. A slow callback then doesn't delay the
+      /// reception of other topics nor the service calls. The hand-off is
+      /// bounded by the queue depth and policy of the subscription.
+      /// \param[in] _async True to run the callbacks asynchronously.
+      /// \sa SetQueueDepth
+      public: void SetAsyncCallbacks(const bool _async);
+
+      /// \brief Whether the callbacks of remote messages run on the dispatch
+      /// threads.
+      /// \return True if the callbacks are asynchronous.
+      /// \sa SetAsyncCallbacks
+      public: bool AsyncCallbacks() const;
+
+      /// \brief Deserialize the messages received from other processes on
+      /// a protobuf arena instead of the heap. The arenas are recycled once
+      /// all the references to a message are released, so nested messages
+      /// don't require any allocation in the steady state. The messages of
+      /// a topic are deserialized once for all the subscribers of the
+      /// process, using the options of one of them.
+      /// \param[in] _arena True to deserialize the messages on an arena.
+      public: void SetArenaAllocation(const bool _arena);
+
+      /// \brief Whether the messages received from other processes are
+      /// deserialized on a protobuf arena.
+      /// \return True if the messages are allocated on an arena.
+      /// \sa SetArenaAllocation
+      public: bool ArenaAllocation() const;
+
+      /// \brief Recycle the messages received from other processes: they
+      /// are deserialized into a few messages owned by the subscription,
+      /// reused once no callback holds them anymore. Since deserializing
+      /// into a message keeps the capacity of its strings and repeated
+      /// fields, the steady state doesn't allocate. The message passed to a
+      /// callback is only valid during the call, don't keep its address.
+      /// Shared ownership callbacks may keep their pointer, the message is
+      /// not recycled until it's released. The messages of a topic are
+      /// deserialized once for all the subscribers of the process, using
+      /// the options of one of them. Ignored with SetArenaAllocation().
+      /// \param[in] _reuse True to recycle the messages.
+      public: void SetReuseMessage(const bool _reuse);
+
+      /// \brief Whether the messages received from other processes are
+      /// recycled.
+      /// \return True if the messages are recycled.
+      /// \sa SetReuseMessage
+      public: bool ReuseMessage() const;
+
+      /// \brief Only deliver the messages matching a filter on their
+      /// content. The filter is evaluated before the messages are
+      /// deserialized and before they are queued for the callback, so the
+      /// discarded messages cost neither the deserialization nor the
+      /// dispatch. They don't count for the throttling either.
+      /// \param[in] _filter The filter. An empty filter delivers every
+      /// message (default).
+      /// \sa MessageFilter
+      public: void SetFilter(const MessageFilter &_filter);
+
+      /// \brief Get the filter on the content of the messages.
+      /// \return The filter, empty if every message is delivered.
+      /// \sa SetFilter
+      public: const MessageFilter &Filter() const;
+
+      /// \brief Run the callbacks on an executor instead of the threads of
+      /// the transport, see Executor. The messages published within the
+      /// process and received from other processes are handed over to the
+      /// executor, bounded by the queue depth and policy of the
+      /// subscription.
+      /// \param[in] _executor The executor, or nullptr to run the callbacks
+      /// on the threads of the transport (default), or on the executor of
+      /// the node if it has one.
+      /// \sa NodeOptions::SetCallbackExecutor
+      public: void SetCallbackExecutor(
+        const std::shared_ptr<Executor> &_executor);
+
+      /// \brief Get the executor running the callbacks.
+      /// \return The executor, or nullptr if none.
+      /// \sa SetCallbackExecutor
+      public: const std::shared_ptr<Executor> &CallbackExecutor() const;
+
+      /// \brief Receive the fragments of the large messages published in
+      /// other processes as they arrive (see GZ_TRANSPORT_FRAGMENT_SIZE),
+      /// e.g. to start processing a map before it is fully received. The
+      /// callback runs on the reception thread, in the order of the
+      /// fragments, and is followed by the regular callback once the
+      /// message is complete. A message lost halfway doesn't reach the
+      /// regular callback. The compressed messages are only delivered
+      /// whole.
+      /// \param[in] _callback The callback, or nullptr to disable it
+      /// (default).
+      public: void SetFragmentCallback(
+        const transport::FragmentCallback &_callback);
+
+      /// \brief Get the callback receiving the fragments of the messages.
+      /// \return The callback, empty if disabled.
+      /// \sa SetFragmentCallback
+      public: const transport::FragmentCallback &FragmentCallback() const;
+
+      /// \brief Deliver the messages published within the process to a raw
+      /// subscription through a tap (see NodeShared::AddTap()): the callback
+      /// runs on the publishing thread and receives the serialized buffer
+      /// built by the publisher, without a copy nor a hand-off to the
+      /// dispatch threads. The callback must be fast and thread safe. The
+      /// message type, the throttling, the queue and the filter of the
+      /// subscription don't apply to these messages. The other
+      /// subscriptions ignore this option.
+      /// \param[in] _tap True to tap the messages published within the
+      /// process.
+      public: void SetTap(const bool _tap);
+
+      /// \brief Whether the messages published within the process are
+      /// tapped.
+      /// \return True if they are tapped.
+      /// \sa SetTap
+      public: bool Tap() const;
+
 #ifdef _WIN32
 // Disable warning C4251 which is triggered by
 // std::unique_ptr
@@ -31,17 +31,23 @@
 #pragma warning(pop)
 #endif
 
+#include <atomic>
 #include <chrono>
+#include <cstddef>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include <gz/msgs/Factory.hh>
 
+#include "gz/transport/ArenaPool.hh"
 #include "gz/transport/config.hh"
 #include "gz/transport/Export.hh"
 #include "gz/transport/MessageInfo.hh"
+#include "gz/transport/MessageTypes.hh"
 #include "gz/transport/SubscribeOptions.hh"
 #include "gz/transport/TransportTypes.hh"
 #include "gz/transport/Uuid.hh"
@@ -53,6 +59,8 @@ namespace gz
     // Inline bracket to help doxygen filtering.
     inline namespace GZ_TRANSPORT_VERSION_NAMESPACE {
     //
+    class SubscriptionHandlerBasePrivate;
+
     /// \brief SubscriptionHandlerBase contains functions and data which are
     /// common to all SubscriptionHandler types.
     class GZ_TRANSPORT_VISIBLE SubscriptionHandlerBase
@@ -80,6 +88,171 @@ namespace gz
       /// \return A string representation of the handler UUID.
       public: std::string HandlerUuid() const;
 
+      /// \brief Whether the handler is still subscribed. A handler is
+      /// disabled when its node unsubscribes, so publications already queued
+      /// are not delivered to it anymore.
+      /// \return True if the callback can be executed.
+      public: bool Enabled() const;
+
+      /// \brief Disable this handler. This can't be undone, a new
+      /// subscription creates a new handler.
+      public: void Disable();
+
+      /// \brief Reserve a slot in the intra-process queue of this handler
+      /// before queuing a publication for it. The queue depth and policy are
+      /// taken from the subscribe options, a conflated subscription behaves as
+      /// a queue of depth one with QueuePolicy_t::DROP_OLDEST. An adaptive
+      /// queue is sized from the load. With QueuePolicy_t::DROP_OLDEST,
+      /// the oldest pending publications are invalidated to make room, with
+      /// QueuePolicy_t::BLOCK_PUBLISHER this call waits until the handler
+      /// catches up or is disabled.
+      /// \param[out] _seq Sequence number of the publication, to be passed
+      /// to ReleaseQueueSlot().
+      /// \param[out] _dropped Number of publications dropped by this call.
+      /// \param[in] _size Size of the serialized publication (bytes), used
+      /// to size an adaptive queue.
+      /// \param[in] _wait False if the caller can't wait, e.g.: the thread
+      /// receiving the messages from other processes. The publication is
+      /// dropped instead of waiting with QueuePolicy_t::BLOCK_PUBLISHER.
+      /// \return True if the publication has to be queued or false if it was
+      /// dropped.
+      /// \sa ReleaseQueueSlot
+      /// \sa SubscribeOptions::SetAdaptiveQueue
+      public: bool ReserveQueueSlot(uint64_t &_seq, uint64_t &_dropped,
+                                    const std::size_t _size = 0,
+                                    const bool _wait = true);
+
+      /// \brief Release the slot of a queued publication before delivering
+      /// it.
+      /// \param[in] _seq Sequence number returned by ReserveQueueSlot().
+      /// \return True if the publication has to be delivered or false if it
+      /// was dropped while it was queued.
+      public: bool ReleaseQueueSlot(const uint64_t _seq);
+
+      /// \brief Release the slot of a publication that is dropped before
+      /// being queued, e.g.: its publish queue is full. The publication is
+      /// counted as dropped.
+      /// \param[in] _seq Sequence number returned by ReserveQueueSlot().
+      public: void DropQueueSlot(const uint64_t _seq);
+
+      /// \brief Whether the publishers of this process wait for this
+      /// handler when a queue is full, see QueuePolicy_t::BLOCK_PUBLISHER.
+      /// \return True if the publishers wait.
+      public: bool BlocksPublisher() const;
+
+      /// \brief Get the number of intra-process publications dropped because
+      /// the queue of this handler was full.
+      /// \return Number of dropped publications.
+      public: uint64_t QueueDroppedMsgCount() const;
+
+      /// \brief Whether the intra-process queue of this handler is sized
+      /// from the load.
+      /// \return True if the queue is adaptive.
+      /// \sa SubscribeOptions::SetAdaptiveQueue
+      public: bool AdaptiveQueue() const;
+
+      /// \brief Account for the execution time of a callback, to size an
+      /// adaptive queue. Nothing is done if the queue isn't adaptive.
+      /// \param[in] _duration Duration of the callback.
+      public: void AddServiceTime(const std::chrono::nanoseconds _duration);
+
+      /// \brief Get the current depth of the intra-process queue.
+      /// \return The depth, or zero if the queue is unbounded.
+      public: uint64_t CurrentQueueDepth() const;
+
+      /// \brief Whether only the newest pending message is delivered to this
+      /// handler.
+      /// \return True if the subscription is conflated.
+      /// \sa SubscribeOptions::SetConflate
+      public: bool Conflate() const;
+
+      /// \brief Whether the callbacks of remote messages are handed over
+      /// instead of running on the reception thread: to the dispatch threads,
+      /// or to the executor of the handler.
+      /// \return True if the callbacks are asynchronous.
+      /// \sa SubscribeOptions::SetAsyncCallbacks
+      public: bool AsyncCallbacks() const;
+
+      /// \brief Get the executor running the callbacks of this handler.
+      /// \return The executor, or nullptr to run them on the threads of the
+      /// transport.
+      /// \sa SubscribeOptions::SetCallbackExecutor
+      public: const std::shared_ptr<Executor> &CallbackExecutor() const;
+
+      /// \brief Get the callback receiving the fragments of the large
+      /// remote messages.
+      /// \return The callback, empty if disabled.
+      /// \sa SubscribeOptions::SetFragmentCallback
+      public: const transport::FragmentCallback &FragmentCallback() const;
+
+      /// \brief Run the callbacks on an executor, unless the subscribe
+      /// options already select one. Must be called before the handler is
+      /// registered.
+      /// \param[in] _executor The executor of the node, or nullptr.
+      /// \sa NodeOptions::SetCallbackExecutor
+      public: void SetDefaultExecutor(
+        const std::shared_ptr<Executor> &_executor);
+
+      /// \brief Get the maximum rate of the callbacks of this handler.
+      /// \return Maximum number of messages per second, or kUnthrottled.
+      /// \sa SubscribeOptions::SetMsgsPerSec
+      public: uint64_t MsgsPerSec() const;
+
+      /// \brief Change the rate of the callbacks and the intra-process
+      /// queue of this handler while it is subscribed: the options set by
+      /// SubscribeOptions::SetMsgsPerSec(), SubscribeOptions::SetQueueDepth()
+      /// and SubscribeOptions::SetQueuePolicy(). The other options of
+      /// _opts are ignored. The depth of an adaptive or a conflated queue
+      /// doesn't change. The publications already queued when the queue
+      /// changes from or to an unbounded one are not counted.
+      /// \param[in] _opts The options.
+      /// \sa Node::UpdateSubscription
+      public: void UpdateOptions(const SubscribeOptions &_opts);
+
+      /// \brief Check the subscription throttling option without updating
+      /// it. This is used to discard a message before deserializing it when
+      /// the callback would not be executed anyway.
+      /// \return True if the callback would be executed now or false if the
+      /// message would be discarded by the throttling.
+      public: bool CheckThrottling() const;
+
+      /// \brief Check if a serialized message matches the filter of the
+      /// subscription, without deserializing it.
+      /// \param[in] _msgData The serialized message.
+      /// \param[in] _size Size of the serialized message.
+      /// \param[in] _msgType Type of the message.
+      /// \return True if the message has to be delivered.
+      /// \sa SubscribeOptions::SetFilter
+      public: bool CheckFilter(const char *_msgData, const std::size_t _size,
+                               const std::string &_msgType) const;
+
+      /// \brief Check if a message matches the filter of the subscription.
+      /// \param[in] _msg The message.
+      /// \return True if the message has to be delivered.
+      /// \sa SubscribeOptions::SetFilter
+      public: bool CheckFilter(const ProtoMsg &_msg) const;
+
+      /// \brief Account for the execution of a callback of this handler.
+      /// \param[in] _duration Duration of the callback.
+      /// \sa Node::EnableCallbackStats
+      public: void AddCallbackDuration(
+        const std::chrono::nanoseconds _duration);
+
+      /// \brief Get the number of callbacks accounted with
+      /// AddCallbackDuration().
+      /// \return Number of callbacks.
+      public: uint64_t CallbackCount() const;
+
+      /// \brief Get the total duration of the callbacks accounted with
+      /// AddCallbackDuration().
+      /// \return Total duration.
+      public: std::chrono::nanoseconds CallbackDuration() const;
+
+      /// \brief Get the longest callback accounted with
+      /// AddCallbackDuration().
+      /// \return Longest duration.
+      public: std::chrono::nanoseconds MaxCallbackDuration() const;
+
       /// \brief Check if message subscription is throttled. If so, verify
       /// whether the callback should be executed or not.
       /// \return true if the callback should be executed or false otherwise.
@@ -89,7 +262,8 @@ namespace gz
       protected: SubscribeOptions opts;
 
       /// \brief If throttling is enabled, the minimum period for receiving a
-      /// message in nanoseconds.
+      /// message in nanoseconds. Updated by UpdateOptions(), the handler
+      /// itself reads a synchronized copy.
       protected: double periodNs;
 
 #ifdef _WIN32
@@ -106,11 +280,37 @@ namespace gz
 
       /// \brief Node UUID.
       private: std::string nUuid;
+
+      /// \brief Private data: the options updated while subscribed, the
+      /// intra-process queue and the callback statistics. Shared, so the
+      /// handlers stay copyable.
+      private: std::shared_ptr<SubscriptionHandlerBasePrivate> dataPtr;
 #ifdef _WIN32
 #pragma warning(pop)
 #endif
     };
 
+    /// \class SharedSubscriptionHandler SubscriptionHandler.hh
+    /// gz/transport/SubscriptionHandler.hh
+    /// \brief Interface of the subscription handlers able to receive the
+    /// messages by shared ownership. It is not part of ISubscriptionHandler,
+    /// so the virtual functions of the existing handlers are unchanged.
+    /// \sa ISubscriptionHandler::RunLocalCallback
+    class GZ_TRANSPORT_VISIBLE SharedSubscriptionHandler
+    {
+      /// \brief Destructor.
+      public: virtual ~SharedSubscriptionHandler() = default;
+
+      /// \brief Executes the local callback registered for this handler,
+      /// sharing ownership of the message.
+      /// \param[in] _msg Protobuf message received, not null.
+      /// \param[in] _info Message information (e.g.: topic name).
+      /// \return True when success, false otherwise.
+      public: virtual bool RunSharedCallback(
+        const std::shared_ptr<const ProtoMsg> &_msg,
+        const MessageInfo &_info) = 0;
+    };
+
     /// \class ISubscriptionHandler SubscriptionHandler.hh
     /// gz/transport/SubscriptionHandler.hh
     /// \brief Interface class used to manage generic protobuf messages.
@@ -140,6 +340,19 @@ namespace gz
         const ProtoMsg &_msg,
         const MessageInfo &_info) = 0;
 
+      /// \brief Executes the local callback registered for this handler,
+      /// sharing ownership of the message instead of passing a reference.
+      /// Handlers registered with a SharedMsgCallback receive the very same
+      /// object, so no deep copy is required. The other handlers, those not
+      /// implementing SharedSubscriptionHandler, are called through
+      /// RunLocalCallback(const ProtoMsg &, const MessageInfo &).
+      /// \param[in] _msg Protobuf message received.
+      /// \param[in] _info Message information (e.g.: topic name).
+      /// \return True when success, false otherwise.
+      public: bool RunLocalCallback(
+        const std::shared_ptr<const ProtoMsg> &_msg,
+        const MessageInfo &_info);
+
       /// \brief Create a specific protobuf message given its serialized data.
       /// \param[in] _data The serialized data.
       /// \param[in] _type The data type.
@@ -147,6 +360,45 @@ namespace gz
       public: virtual const std::shared_ptr<ProtoMsg> CreateMsg(
         const std::string &_data,
         const std::string &_type) const = 0;
+
+      /// \brief Create a specific protobuf message given its serialized data
+      /// stored in a buffer. By default this copies the data into a string
+      /// and forwards to CreateMsg(const std::string &, const std::string &).
+      /// \param[in] _data The serialized data.
+      /// \param[in] _size Size of the serialized data (bytes).
+      /// \param[in] _type The data type.
+      /// \return Pointer to the specific protobuf message.
+      public: virtual const std::shared_ptr<ProtoMsg> CreateMsg(
+        const char *_data,
+        const std::size_t _size,
+        const std::string &_type) const;
+
+      /// \brief Deserialize a message and execute the local callback
+      /// registered for this handler. The message only lives during the
+      /// callback, so handlers may parse it into a message reused between
+      /// deliveries. By default this calls CreateMsg() and
+      /// RunLocalCallback().
+      /// \param[in] _data The serialized data.
+      /// \param[in] _size Size of the serialized data (bytes).
+      /// \param[in] _info Message information (e.g.: topic name).
+      /// \return True when success, false otherwise.
+      public: virtual bool ParseAndRunLocalCallback(
+        const char *_data,
+        const std::size_t _size,
+        const MessageInfo &_info);
+
+#ifdef _WIN32
+// Disable warning C4251 which is triggered by
+// std::unique_ptr
+#pragma warning(push)
+#pragma warning(disable: 4251)
+#endif
+      /// \brief Arenas used to deserialize the messages, only set when
+      /// SubscribeOptions::ArenaAllocation() is enabled.
+      protected: std::unique_ptr<ArenaPool> arenaPool;
+#ifdef _WIN32
+#pragma warning(pop)
+#endif
     };
 
     /// \class SubscriptionHandler SubscriptionHandler.hh
@@ -154,12 +406,13 @@ namespace gz
     /// message. 'T' is the Protobuf message type that will be used for this
     /// particular handler.
     template <typename T> class SubscriptionHandler
-      : public ISubscriptionHandler
+      : public ISubscriptionHandler, public SharedSubscriptionHandler
     {
       // Documentation inherited.
       public: explicit SubscriptionHandler(const std::string &_nUuid,
         const SubscribeOptions &_opts = SubscribeOptions())
-        : ISubscriptionHandler(_nUuid, _opts)
+        : ISubscriptionHandler(_nUuid, _opts),
+          reuseMessage(_opts.ReuseMessage())
       {
       }
 
@@ -169,7 +422,7 @@ namespace gz
         const std::string &/*_type*/) const
       {
         // Instantiate a specific protobuf message
-        auto msgPtr = std::make_shared<T>();
+        std::shared_ptr<T> msgPtr = this->NewMsg();
 
         // Create the message using some serialized data
         if (!msgPtr->ParseFromString(_data))
@@ -181,6 +434,62 @@ namespace gz
         return msgPtr;
       }
 
+      // Documentation inherited.
+      public: const std::shared_ptr<ProtoMsg> CreateMsg(
+        const char *_data,
+        const std::size_t _size,
+        const std::string &/*_type*/) const
+      {
+        std::shared_ptr<T> msgPtr = this->NewMsg();
+
+        if (!msgPtr->ParseFromArray(_data, static_cast<int>(_size)))
+        {
+          std::cerr << "SubscriptionHandler::CreateMsg() error: ParseFromArray"
+                    << " failed" << std::endl;
+        }
+
+        return msgPtr;
+      }
+
+      /// \brief Create an empty message, on an arena if the arena allocation
+      /// is enabled.
+      /// \return Pointer to the message. When it is allocated on an arena,
+      /// the pointer shares the ownership of the arena.
+      protected: std::shared_ptr<T> NewMsg() const
+      {
+        if (!this->arenaPool)
+        {
+          if (!this->reuseMessage)
+            return std::make_shared<T>();
+
+          // A message is free when the pool holds its only reference: no
+          // one else can take a new one.
+          std::lock_guard<std::mutex> lk(this->recycledMutex);
+          for (const std::shared_ptr<T> &msg : this->recycled)
+          {
+            if (msg.use_count() == 1)
+            {
+              // See the writes of the last callback that released it.
+              std::atomic_thread_fence(std::memory_order_acquire);
+              return msg;
+            }
+          }
+          auto msg = std::make_shared<T>();
+          if (this->recycled.size() < kMaxRecycledMsgs)
+            this->recycled.push_back(msg);
+          return msg;
+        }
+
+        std::shared_ptr<google::protobuf::Arena> arena =
+          this->arenaPool->Acquire();
+#if GOOGLE_PROTOBUF_VERSION >= 5026000
+        T *msg = google::protobuf::Arena::Create<T>(arena.get());
+#else
+        T *msg = google::protobuf::Arena::CreateMessage<T>(arena.get());
+#endif
+        return std::shared_ptr<T>(arena, msg);
+      }
+
       // Documentation inherited.
       public: std::string TypeName()
       {
@@ -194,12 +503,20 @@ namespace gz
         this->cb = _cb;
       }
 
+      /// \brief Set a callback for this handler that receives the message
+      /// by shared ownership.
+      /// \param[in] _cb The callback.
+      public: void SetCallback(const SharedMsgCallback<T> &_cb)
+      {
+        this->sharedCb = _cb;
+      }
+
       // Documentation inherited.
       public: bool RunLocalCallback(const ProtoMsg &_msg,
                                     const MessageInfo &_info)
       {
         // No callback stored.
-        if (!this->cb)
+        if (!this->cb && !this->sharedCb)
         {
           std::cerr << "SubscriptionHandler::RunLocalCallback() error: "
                     << "Callback is NULL" << std::endl;
@@ -218,23 +535,82 @@ namespace gz
         auto msgPtr = google::protobuf::internal::down_cast<const T*>(&_msg);
 #endif
 
-        this->cb(*msgPtr, _info);
+        if (this->cb)
+        {
+          this->cb(*msgPtr, _info);
+          return true;
+        }
+
+        // The caller does not own the message, so a shared callback
+        // requires a copy here.
+        auto msgCopy = std::make_shared<T>(*msgPtr);
+        this->sharedCb(msgCopy, _info);
+        return true;
+      }
+
+      public: using ISubscriptionHandler::RunLocalCallback;
+
+      // Documentation inherited.
+      public: bool RunSharedCallback(
+        const std::shared_ptr<const ProtoMsg> &_msg,
+        const MessageInfo &_info) override
+      {
+        if (!this->sharedCb)
+          return this->RunLocalCallback(*_msg, _info);
+
+        // The message might come from a handler of another type registered
+        // on the same topic.
+        std::shared_ptr<const T> msg = std::dynamic_pointer_cast<const T>(_msg);
+        if (!msg)
+        {
+          std::cerr << "SubscriptionHandler::RunSharedCallback() error: "
+                    << "Received a [" << _msg->GetTypeName() << "] message "
+                    << "instead of [" << this->TypeName() << "]" << std::endl;
+          return false;
+        }
+
+        // Check the subscription throttling option.
+        if (!this->UpdateThrottling())
+          return true;
+
+        this->sharedCb(msg, _info);
         return true;
       }
 
       /// \brief Callback to the function registered for this handler.
       private: MsgCallback<T> cb;
+
+      /// \brief Shared ownership callback registered for this handler.
+      private: SharedMsgCallback<T> sharedCb;
+
+      /// \brief Maximum number of recycled messages, the messages still
+      /// referenced beyond this number are allocated.
+#ifdef GZ_TRANSPORT_EMBEDDED
+      private: static constexpr std::size_t kMaxRecycledMsgs = 1;
+#else
+      private: static constexpr std::size_t kMaxRecycledMsgs = 4;
+#endif
+
+      /// \brief Recycle the messages, see SubscribeOptions::ReuseMessage().
+      private: const bool reuseMessage;
+
+      /// \brief Protects recycled.
+      private: mutable std::mutex recycledMutex;
+
+      /// \brief Recycled messages.
+      private: mutable std::vector<std::shared_ptr<T>> recycled;
     };
 
     /// \brief Specialized template when the user prefers a callbacks that
     /// accepts a generic google::protobuf::message instead of a specific type.
     template <> class SubscriptionHandler<ProtoMsg>
-      : public ISubscriptionHandler
+      : public ISubscriptionHandler, public SharedSubscriptionHandler
     {
       // Documentation inherited.
       public: explicit SubscriptionHandler(const std::string &_nUuid,
         const SubscribeOptions &_opts = SubscribeOptions())
-        : ISubscriptionHandler(_nUuid, _opts)
+        : ISubscriptionHandler(_nUuid, _opts),
+          reuseMessage(_opts.ReuseMessage())
       {
       }
 
@@ -243,38 +619,81 @@ namespace gz
         const std::string &_data,
         const std::string &_type) const
       {
-        std::shared_ptr<google::protobuf::Message> msgPtr;
-
-        const google::protobuf::Descriptor *desc =
-          google::protobuf::DescriptorPool::generated_pool()
-            ->FindMessageTypeByName(_type);
+        std::shared_ptr<google::protobuf::Message> msgPtr = NewMsg(_type);
+        if (!msgPtr)
+          return nullptr;
 
-        // First, check if we have the descriptor from the generated proto
-        // classes.
-        if (desc)
-        {
-          msgPtr.reset(google::protobuf::MessageFactory::generated_factory()
-            ->GetPrototype(desc)->New());
-        }
-        else
+        // Create the message using some serialized data
+        if (!msgPtr->ParseFromString(_data))
         {
-          // Fallback on Gazebo Msgs if the message type is not found.
-          msgPtr = gz::msgs::Factory::New(_type);
+          std::cerr << "CreateMsg() error: ParseFromString failed" << std::endl;
+          return nullptr;
         }
 
+        return msgPtr;
+      }
+
+      // Documentation inherited.
+      public: const std::shared_ptr<ProtoMsg> CreateMsg(
+        const char *_data,
+        const std::size_t _size,
+        const std::string &_type) const
+      {
+        std::shared_ptr<google::protobuf::Message> msgPtr = NewMsg(_type);
         if (!msgPtr)
           return nullptr;
 
-        // Create the message using some serialized data
-        if (!msgPtr->ParseFromString(_data))
+        if (!msgPtr->ParseFromArray(_data, static_cast<int>(_size)))
         {
-          std::cerr << "CreateMsg() error: ParseFromString failed" << std::endl;
+          std::cerr << "CreateMsg() error: ParseFromArray failed" << std::endl;
           return nullptr;
         }
 
         return msgPtr;
       }
 
+      /// \brief Create an empty protobuf message of a given type, on an
+      /// arena if the arena allocation is enabled, or a recycled one if the
+      /// messages are reused.
+      /// \param[in] _type The message type.
+      /// \return Pointer to the message or nullptr if the type is unknown.
+      /// \sa MessageTypes
+      private: std::shared_ptr<ProtoMsg> NewMsg(const std::string &_type) const
+      {
+        const ProtoMsg *prototype = MessageTypes::Prototype(_type);
+        if (!prototype)
+          return nullptr;
+
+        if (this->arenaPool)
+        {
+          std::shared_ptr<google::protobuf::Arena> arena =
+            this->arenaPool->Acquire();
+          return std::shared_ptr<ProtoMsg>(arena,
+            prototype->New(arena.get()));
+        }
+
+        if (!this->reuseMessage)
+          return std::shared_ptr<ProtoMsg>(prototype->New());
+
+        // A message is free when the pool holds its only reference. The
+        // topic might carry several types.
+        std::lock_guard<std::mutex> lk(this->recycledMutex);
+        for (const std::shared_ptr<ProtoMsg> &msg : this->recycled)
+        {
+          if (msg.use_count() == 1 &&
+              msg->GetDescriptor() == prototype->GetDescriptor())
+          {
+            // See the writes of the last callback that released it.
+            std::atomic_thread_fence(std::memory_order_acquire);
+            return msg;
+          }
+        }
+        std::shared_ptr<ProtoMsg> msg(prototype->New());
+        if (this->recycled.size() < kMaxRecycledMsgs)
+          this->recycled.push_back(msg);
+        return msg;
+      }
+
       // Documentation inherited.
       public: std::string TypeName()
       {
@@ -288,12 +707,20 @@ namespace gz
         this->cb = _cb;
       }
 
+      /// \brief Set a callback for this handler that receives the message
+      /// by shared ownership.
+      /// \param[in] _cb The callback.
+      public: void SetCallback(const SharedMsgCallback<ProtoMsg> &_cb)
+      {
+        this->sharedCb = _cb;
+      }
+
       // Documentation inherited.
       public: bool RunLocalCallback(const ProtoMsg &_msg,
                                     const MessageInfo &_info)
       {
         // No callback stored.
-        if (!this->cb)
+        if (!this->cb && !this->sharedCb)
         {
           std::cerr << "SubscriptionHandler::RunLocalCallback() "
                     << "error: Callback is NULL" << std::endl;
@@ -304,12 +731,136 @@ namespace gz
         if (!this->UpdateThrottling())
           return true;
 
-        this->cb(_msg, _info);
+        if (this->cb)
+        {
+          this->cb(_msg, _info);
+          return true;
+        }
+
+        // The caller does not own the message, so a shared callback
+        // requires a copy here.
+        std::shared_ptr<ProtoMsg> msgCopy(_msg.New());
+        msgCopy->CopyFrom(_msg);
+        this->sharedCb(msgCopy, _info);
+        return true;
+      }
+
+      public: using ISubscriptionHandler::RunLocalCallback;
+
+      // Documentation inherited.
+      public: bool RunSharedCallback(
+        const std::shared_ptr<const ProtoMsg> &_msg,
+        const MessageInfo &_info) override
+      {
+        if (!this->sharedCb)
+          return this->RunLocalCallback(*_msg, _info);
+
+        // Check the subscription throttling option.
+        if (!this->UpdateThrottling())
+          return true;
+
+        this->sharedCb(_msg, _info);
         return true;
       }
 
       /// \brief Callback to the function registered for this handler.
       private: MsgCallback<ProtoMsg> cb;
+
+      /// \brief Shared ownership callback registered for this handler.
+      private: SharedMsgCallback<ProtoMsg> sharedCb;
+
+      /// \brief Maximum number of recycled messages, the messages still
+      /// referenced beyond this number are allocated.
+#ifdef GZ_TRANSPORT_EMBEDDED
+      private: static constexpr std::size_t kMaxRecycledMsgs = 1;
+#else
+      private: static constexpr std::size_t kMaxRecycledMsgs = 4;
+#endif
+
+      /// \brief Recycle the messages, see SubscribeOptions::ReuseMessage().
+      private: const bool reuseMessage;
+
+      /// \brief Protects recycled.
+      private: mutable std::mutex recycledMutex;
+
+      /// \brief Recycled messages.
+      private: mutable std::vector<std::shared_ptr<ProtoMsg>> recycled;
+    };
+
+    /// \class CallableSubscriptionHandler SubscriptionHandler.hh
+    /// \brief A subscription handler storing its callable inline, such as
+    /// the lambda binding a member function created by Node::Subscribe(), so
+    /// a delivery costs a single virtual call instead of one or two
+    /// std::function calls. The messages received from other processes are
+    /// parsed into a message reused between deliveries when possible.
+    /// 'T' is the Protobuf message type and 'F' is a callable accepting
+    /// (const T &, const MessageInfo &).
+    template <typename T, typename F> class CallableSubscriptionHandler
+      : public SubscriptionHandler<T>
+    {
+      /// \brief Constructor.
+      /// \param[in] _nUuid UUID of the node registering the handler.
+      /// \param[in] _opts Subscription options.
+      /// \param[in] _callable The callable.
+      public: CallableSubscriptionHandler(const std::string &_nUuid,
+        const SubscribeOptions &_opts, F _callable)
+        : SubscriptionHandler<T>(_nUuid, _opts),
+          callable(std::move(_callable))
+      {
+      }
+
+      public: using SubscriptionHandler<T>::RunLocalCallback;
+
+      // Documentation inherited.
+      public: bool RunLocalCallback(const ProtoMsg &_msg,
+                                    const MessageInfo &_info) override
+      {
+        // Check the subscription throttling option.
+        if (!this->UpdateThrottling())
+          return true;
+
+        this->callable(static_cast<const T &>(_msg), _info);
+        return true;
+      }
+
+      // Documentation inherited.
+      public: bool ParseAndRunLocalCallback(const char *_data,
+        const std::size_t _size, const MessageInfo &_info) override
+      {
+        // The reusable message is taken by one delivery at a time. The
+        // concurrent or nested deliveries, and the arena allocations, use
+        // a new message.
+        if (this->arenaPool || this->reusableBusy.exchange(true))
+        {
+          return ISubscriptionHandler::ParseAndRunLocalCallback(
+            _data, _size, _info);
+        }
+
+        bool result = true;
+        if (this->UpdateThrottling())
+        {
+          result = this->reusable.ParseFromArray(_data,
+            static_cast<int>(_size));
+          if (result)
+            this->callable(this->reusable, _info);
+          else
+          {
+            std::cerr << "CallableSubscriptionHandler: ParseFromArray failed"
+                      << std::endl;
+          }
+        }
+        this->reusableBusy.store(false);
+        return result;
+      }
+
+      /// \brief The callable.
+      private: F callable;
+
+      /// \brief Message reused to deserialize the messages received.
+      private: T reusable;
+
+      /// \brief True while a delivery uses the reusable message.
+      private: std::atomic<bool> reusableBusy{false};
     };
 
     //////////////////////////////////////////////////
@@ -336,7 +887,14 @@ namespace gz
       /// a message is received.
       public: void SetCallback(const RawCallback &_callback);
 
+      /// \brief Set a callback for this handler that receives the message
+      /// data by shared ownership.
+      /// \param[in] _callback The callback function that will be triggered
+      /// when a message is received.
+      public: void SetCallback(const SharedRawCallback &_callback);
+
       /// \brief Executes the raw callback registered for this handler.
+      /// The data is copied if the callback takes it by shared ownership.
       /// \param[in] _msgData Serialized string of message data
       /// \param[in] _size Number of bytes in the serialized message data
       /// \param[in] _info Meta-data for the message
@@ -345,6 +903,17 @@ namespace gz
       public: bool RunRawCallback(const char *_msgData, const size_t _size,
                                   const MessageInfo &_info);
 
+      /// \brief Executes the raw callback registered for this handler with
+      /// data that can be shared, so no copy is performed.
+      /// \param[in] _msgData Shared serialized message data
+      /// \param[in] _size Number of bytes in the serialized message data
+      /// \param[in] _info Meta-data for the message
+      /// \return True if the callback was triggered, false if the callback was
+      /// not set.
+      public: bool RunRawCallback(const std::shared_ptr<const char> &_msgData,
+                                  const size_t _size,
+                                  const MessageInfo &_info);
+
       /// \brief Destructor
       public: ~RawSubscriptionHandler();
 
@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GZ_TRANSPORT_SYNCOPTIONS_HH_
+#define GZ_TRANSPORT_SYNCOPTIONS_HH_
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+
+#include "gz/transport/config.hh"
+#include "gz/transport/Export.hh"
+#include "gz/transport/SubscribeOptions.hh"
+
+namespace gz
+{
+  namespace transport
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace GZ_TRANSPORT_VERSION_NAMESPACE {
+    //
+    class SyncOptionsPrivate;
+
+    /// \brief This strongly typed enum defines how the messages of the
+    /// topics of a synchronized subscription are matched, using the stamp
+    /// of their header.
+    /// \sa Node::SubscribeSynchronized
+    enum class SyncPolicy_t
+    {
+      /// \brief Only match the messages with the same stamp (default
+      /// policy).
+      EXACT,
+      /// \brief Match the messages whose stamps differ by at most the
+      /// maximum interval.
+      APPROXIMATE
+    };
+
+    /// \class SyncOptions SyncOptions.hh gz/transport/SyncOptions.hh
+    /// \brief A class to provide different options for a synchronized
+    /// subscription.
+    /// \sa Node::SubscribeSynchronized
+    class GZ_TRANSPORT_VISIBLE SyncOptions
+    {
+      /// \brief Constructor.
+      public: SyncOptions();
+
+      /// \brief Copy constructor.
+      /// \param[in] _other SyncOptions to copy.
+      public: SyncOptions(const SyncOptions &_other);
+
+      /// \brief Destructor.
+      public: ~SyncOptions();
+
+      /// \brief Assignment operator.
+      /// \param[in] _other The new SyncOptions.
+      /// \return A reference to this instance.
+      public: SyncOptions &operator=(const SyncOptions &_other);
+
+      /// \brief Set the policy used to match the messages.
+      /// \param[in] _policy The policy.
+      public: void SetPolicy(const SyncPolicy_t _policy);
+
+      /// \brief Get the policy used to match the messages.
+      /// \return The policy.
+      public: SyncPolicy_t Policy() const;
+
+      /// \brief Set the maximum number of messages of each topic waiting
+      /// for the messages of the other topics. The oldest message of a full
+      /// queue is dropped. The default is 10.
+      /// \param[in] _size The queue size, at least 1.
+      public: void SetQueueSize(const std::size_t _size);
+
+      /// \brief Get the maximum number of messages waiting per topic.
+      /// \return The queue size.
+      public: std::size_t QueueSize() const;
+
+      /// \brief Set the maximum difference between the stamps of the
+      /// messages matched with SyncPolicy_t::APPROXIMATE. The default is
+      /// 10 ms.
+      /// \param[in] _interval The maximum interval.
+      public: void SetMaxInterval(const std::chrono::nanoseconds &_interval);
+
+      /// \brief Get the maximum difference between the stamps of the
+      /// messages matched with SyncPolicy_t::APPROXIMATE.
+      /// \return The maximum interval.
+      public: std::chrono::nanoseconds MaxInterval() const;
+
+      /// \brief Set the options of the subscription to each topic.
+      /// \param[in] _opts The subscription options.
+      public: void SetSubscriptionOptions(const SubscribeOptions &_opts);
+
+      /// \brief Get the options of the subscription to each topic.
+      /// \return The subscription options.
+      public: const SubscribeOptions &SubscriptionOptions() const;
+
+#ifdef _WIN32
+// Disable warning C4251 which is triggered by
+// std::unique_ptr
+#pragma warning(push)
+#pragma warning(disable: 4251)
+#endif
+      /// \internal
+      /// \brief Pointer to private data.
+      private: std::unique_ptr<SyncOptionsPrivate> dataPtr;
+#ifdef _WIN32
+#pragma warning(pop)
+#endif
+    };
+    }
+  }
+}
+#endif
@@ -0,0 +1,260 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GZ_TRANSPORT_SYNCHRONIZER_HH_
+#define GZ_TRANSPORT_SYNCHRONIZER_HH_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "gz/transport/config.hh"
+#include "gz/transport/MessageInfo.hh"
+#include "gz/transport/SyncOptions.hh"
+#include "gz/transport/TransportTypes.hh"
+
+namespace gz
+{
+  namespace transport
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace GZ_TRANSPORT_VERSION_NAMESPACE {
+    //
+    /// \class Synchronizer Synchronizer.hh gz/transport/Synchronizer.hh
+    /// \brief Matches the messages of several topics by the stamp of their
+    /// header, and runs a callback with each set of matching messages.
+    /// Node::SubscribeSynchronized() feeds it from the subscriptions.
+    ///
+    /// Each message type must have a gz.msgs.Header field named header, and
+    /// the stamps of each topic must increase. The messages are kept by
+    /// shared ownership until they are matched or dropped, they are never
+    /// copied. A set of messages is matched when the difference between its
+    /// stamps is at most the maximum interval (zero for
+    /// SyncPolicy_t::EXACT). The sets are matched in the order of their
+    /// stamps, and each message belongs to one set at most.
+    ///
+    /// All the functions can be called from any thread. The callback runs
+    /// in the thread adding the last message of a set, without any lock.
+    template <typename... MessageTs> class Synchronizer
+    {
+      /// \brief Callback receiving one message per topic, in the order of
+      /// MessageTs.
+      public: using Callback =
+        std::function<void(const std::shared_ptr<const MessageTs> &...)>;
+
+      /// \brief The type of the messages of a topic.
+      public: template<std::size_t I>
+      using Msg = std::tuple_element_t<I, std::tuple<MessageTs...>>;
+
+      /// \brief Constructor.
+      /// \param[in] _opts Synchronization options.
+      /// \param[in] _cb Callback run with each set of matching messages.
+      public: Synchronizer(const SyncOptions &_opts, Callback _cb)
+        : queueSize(_opts.QueueSize()),
+          maxInterval(_opts.Policy() == SyncPolicy_t::EXACT ?
+            0 : _opts.MaxInterval().count()),
+          cb(std::move(_cb))
+      {
+      }
+
+      /// \brief Add a message of a topic.
+      /// \param[in] _msg The message of the topic with index I.
+      public: template<std::size_t I>
+      void Add(const std::shared_ptr<const Msg<I>> &_msg)
+      {
+        std::vector<Matched> matches;
+        {
+          std::lock_guard<std::mutex> lk(this->mutex);
+          auto &queue = std::get<I>(this->queues);
+          queue.push_back({Stamp(*_msg), _msg});
+          if (queue.size() > this->queueSize)
+          {
+            queue.pop_front();
+            ++this->dropped;
+          }
+          this->Match(matches);
+        }
+
+        for (const Matched &match : matches)
+          std::apply(this->cb, match);
+      }
+
+      /// \brief Get a subscription callback adding the messages of a topic
+      /// to a synchronizer.
+      /// \param[in] _sync The synchronizer, kept alive by the callback.
+      /// \return The callback.
+      public: template<std::size_t I>
+      static SharedMsgCallback<Msg<I>> Input(
+        const std::shared_ptr<Synchronizer> &_sync)
+      {
+        return [_sync](const std::shared_ptr<const Msg<I>> &_msg,
+                       const MessageInfo &/*_info*/)
+        {
+          _sync->template Add<I>(_msg);
+        };
+      }
+
+      /// \brief Get the number of messages dropped without a match, because
+      /// their queue was full or no message of another topic was close
+      /// enough.
+      /// \return The number of messages dropped.
+      public: uint64_t Dropped() const
+      {
+        std::lock_guard<std::mutex> lk(this->mutex);
+        return this->dropped;
+      }
+
+      /// \brief A message waiting for a match.
+      private: template<typename T> struct Entry
+      {
+        /// \brief Stamp of the message (ns).
+        int64_t stamp;
+
+        /// \brief The message.
+        std::shared_ptr<const T> msg;
+      };
+
+      /// \brief A set of matching messages.
+      private: using Matched = std::tuple<std::shared_ptr<const MessageTs>...>;
+
+      /// \brief Indices of the topics.
+      private: using Indices = std::index_sequence_for<MessageTs...>;
+
+      /// \brief Get the stamp of a message.
+      /// \param[in] _msg The message.
+      /// \return The stamp (ns).
+      private: template<typename T>
+      static int64_t Stamp(const T &_msg)
+      {
+        return static_cast<int64_t>(_msg.header().stamp().sec()) *
+          1000000000 + _msg.header().stamp().nsec();
+      }
+
+      /// \brief Extract the sets of matching messages from the queues.
+      /// \param[out] _matches The sets matched are appended.
+      private: void Match(std::vector<Matched> &_matches)
+      {
+        while (this->AllReady(Indices()))
+        {
+          // The newest of the oldest messages of each topic: the other
+          // topics keep their newest message not after it.
+          const int64_t pivot = this->NewestFront(Indices());
+          this->DropBefore(pivot, Indices());
+
+          const int64_t oldest = this->OldestFront(Indices());
+          if (pivot - oldest <= this->maxInterval)
+            _matches.push_back(this->PopFronts(Indices()));
+          else
+            this->DropOldest(oldest, Indices());
+        }
+      }
+
+      /// \brief Whether every topic has a message waiting.
+      /// \return True if no queue is empty.
+      private: template<std::size_t... Is>
+      bool AllReady(std::index_sequence<Is...>) const
+      {
+        return (!std::get<Is>(this->queues).empty() && ...);
+      }
+
+      /// \brief Get the newest stamp of the oldest message of each topic.
+      /// \return The stamp (ns).
+      private: template<std::size_t... Is>
+      int64_t NewestFront(std::index_sequence<Is...>) const
+      {
+        return std::max({std::get<Is>(this->queues).front().stamp...});
+      }
+
+      /// \brief Get the oldest stamp of the oldest message of each topic.
+      /// \return The stamp (ns).
+      private: template<std::size_t... Is>
+      int64_t OldestFront(std::index_sequence<Is...>) const
+      {
+        return std::min({std::get<Is>(this->queues).front().stamp...});
+      }
+
+      /// \brief Drop the messages followed by a message not after a stamp.
+      /// \param[in] _stamp The stamp (ns).
+      private: template<std::size_t... Is>
+      void DropBefore(const int64_t _stamp, std::index_sequence<Is...>)
+      {
+        auto drop = [this, _stamp](auto &_queue)
+        {
+          while (_queue.size() > 1 && _queue[1].stamp <= _stamp)
+          {
+            _queue.pop_front();
+            ++this->dropped;
+          }
+        };
+        (drop(std::get<Is>(this->queues)), ...);
+      }
+
+      /// \brief Drop the oldest messages, which can't be matched anymore.
+      /// \param[in] _stamp Stamp of the oldest messages (ns).
+      private: template<std::size_t... Is>
+      void DropOldest(const int64_t _stamp, std::index_sequence<Is...>)
+      {
+        auto drop = [this, _stamp](auto &_queue)
+        {
+          if (_queue.front().stamp == _stamp)
+          {
+            _queue.pop_front();
+            ++this->dropped;
+          }
+        };
+        (drop(std::get<Is>(this->queues)), ...);
+      }
+
+      /// \brief Remove the oldest message of each topic.
+      /// \return The messages removed.
+      private: template<std::size_t... Is>
+      Matched PopFronts(std::index_sequence<Is...>)
+      {
+        Matched match(std::move(std::get<Is>(this->queues).front().msg)...);
+        (std::get<Is>(this->queues).pop_front(), ...);
+        return match;
+      }
+
+      /// \brief Maximum number of messages waiting per topic.
+      private: const std::size_t queueSize;
+
+      /// \brief Maximum difference between the stamps of a set (ns).
+      private: const int64_t maxInterval;
+
+      /// \brief Callback run with each set of matching messages.
+      private: const Callback cb;
+
+      /// \brief Protects the queues and the drop count.
+      private: mutable std::mutex mutex;
+
+      /// \brief Messages waiting for a match, per topic.
+      private: std::tuple<std::deque<Entry<MessageTs>>...> queues;
+
+      /// \brief Number of messages dropped without a match.
+      private: uint64_t dropped = 0;
+    };
+    }
+  }
+}
+#endif
@@ -20,6 +20,8 @@
 #include <gz/msgs/statistic.pb.h>
 
 #include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <limits>
 #include <memory>
 #include <string>
@@ -98,6 +100,50 @@ namespace gz
       private: double max = std::numeric_limits<double>::min();
     };
 
+    /// \brief A histogram of durations, used to compute percentiles. The
+    /// buckets grow exponentially, eight buckets per power of two starting
+    /// at one microsecond, so a percentile is within 10% of the real value.
+    /// Longer durations than the last bucket are counted in the last bucket.
+    class GZ_TRANSPORT_VISIBLE LatencyHistogram
+    {
+      /// \brief Number of buckets.
+      public: static constexpr std::size_t kNumBuckets = 224;
+
+      /// \brief Default constructor.
+      public: LatencyHistogram() = default;
+
+      /// \brief Add a sample.
+      /// \param[in] _duration Duration (ms).
+      public: void Update(double _duration);
+
+      /// \brief Get the number of samples.
+      /// \return The number of samples.
+      public: uint64_t Count() const;
+
+      /// \brief Get a percentile of the samples.
+      /// \param[in] _percent Percentage of the samples, in the range
+      /// [0, 100]. E.g.: 99 returns the p99.
+      /// \return The duration (ms) not exceeded by _percent of the samples,
+      /// or 0 if there are no samples.
+      public: double Percentile(double _percent) const;
+
+      /// \brief Get the average, standard deviation, minimum and maximum of
+      /// the samples.
+      /// \return The statistics of the samples (ms).
+      public: Statistics Summary() const;
+
+      /// \brief Get the bucket of a duration.
+      /// \param[in] _duration Duration (ms).
+      /// \return Index of the bucket.
+      private: static std::size_t Bucket(double _duration);
+
+      /// \brief Number of samples per bucket.
+      private: uint64_t buckets[kNumBuckets] = {};
+
+      /// \brief Statistics of the samples.
+      private: Statistics summary;
+    };
+
     /// \brief Encapsulates statistics for a single topic. The set of
     /// statistics include:
     ///
@@ -123,12 +169,23 @@ namespace gz
       public: ~TopicStatistics();
 
       /// \brief Update the topic statistics.
-      /// \param[in] _sender Address of the sender.
+      /// \param[in] _sender Address of the sender. It is reduced to a hash,
+      /// don't mix this function with the other Update() on the same
+      /// statistics.
       /// \param[in] _stamp Publication time stamp.
       /// \param[in] _seq Publication sequence number.
       public: void Update(const std::string &_sender,
                           uint64_t _stamp, uint64_t _seq);
 
+      /// \brief Update the topic statistics with the identifier of the
+      /// sender instead of its address. The identifier is only compared
+      /// with those of the previous updates, the update doesn't allocate
+      /// memory once every sender has been seen.
+      /// \param[in] _senderId Unique identifier of the sender.
+      /// \param[in] _stamp Publication time stamp.
+      /// \param[in] _seq Publication sequence number.
+      public: void Update(uint64_t _senderId, uint64_t _stamp, uint64_t _seq);
+
       /// \brief Populate a gz::msgs::Metric message with topic
       /// statistics.
       /// \param[in] _msg Message to populate.
@@ -138,6 +195,29 @@ namespace gz
       /// \return Number of dropped messages.
       public: uint64_t DroppedMsgCount() const;
 
+      /// \brief Account for intra-process messages dropped because the
+      /// queue of a local subscriber was full.
+      /// \param[in] _count Number of dropped messages.
+      /// \sa SubscribeOptions::SetQueueDepth
+      public: void AddQueueDrops(uint64_t _count);
+
+      /// \brief Get the number of intra-process messages dropped because the
+      /// queue of a local subscriber was full. These drops are not included
+      /// in DroppedMsgCount().
+      /// \return Number of messages dropped by subscriber queues.
+      public: uint64_t QueueDroppedMsgCount() const;
+
+      /// \brief Account for the subscribers detected as slow by a
+      /// publisher of the topic in this process: their send queue stayed
+      /// above the GZ_TRANSPORT_SLOW_SUBSCRIBER threshold.
+      /// \param[in] _count Number of slow subscribers detected.
+      /// \sa Node::Publisher::SetSlowSubscriberCallback
+      public: void AddSlowSubscribers(uint64_t _count);
+
+      /// \brief Get the number of times a subscriber was detected as slow.
+      /// \return Number of slow subscribers detected.
+      public: uint64_t SlowSubscriberCount() const;
+
       /// \brief Get statistics about publication of messages.
       /// \return Publication statistics.
       public: Statistics PublicationStatistics() const;
@@ -149,6 +229,17 @@ namespace gz
       /// \brief Get the message age statistics.
       /// \return Age statistics.
       public: Statistics AgeStatistics() const;
+
+      /// \brief Get the histogram of the time between the reception of
+      /// messages, to compute its percentiles.
+      /// \return Reception histogram (ms).
+      public: LatencyHistogram ReceptionHistogram() const;
+
+      /// \brief Get the histogram of the message age, the time between the
+      /// publication and the reception of messages, to compute its
+      /// percentiles.
+      /// \return Age histogram (ms).
+      public: LatencyHistogram AgeHistogram() const;
 #ifdef _WIN32
 // Disable warning C4251 which is triggered by
 // std::unique_ptr
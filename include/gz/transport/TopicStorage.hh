@@ -19,8 +19,11 @@
 #define GZ_TRANSPORT_TOPICSTORAGE_HH_
 
 #include <algorithm>
+#include <cstdint>
 #include <map>
+#include <set>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "gz/transport/config.hh"
@@ -37,7 +40,9 @@ namespace gz
     //
     /// \class TopicStorage TopicStorage.hh gz/transport/TopicStorage.hh
     /// \brief Store address information about topics and provide convenient
-    /// methods for adding new topics, removing them, etc.
+    /// methods for adding new topics, removing them, etc. The publishers are
+    /// also indexed by process UUID and by address, so the operations on a
+    /// process don't depend on the total number of topics.
     template<typename T> class TopicStorage
     {
       /// \brief Constructor.
@@ -80,6 +85,9 @@ namespace gz
 
         // Add a new Publisher entry.
         m[_publisher.PUuid()].push_back(T(_publisher));
+        this->topicsByProc[_publisher.PUuid()].insert(_publisher.Topic());
+        ++this->pubsByAddr[_publisher.Addr()];
+        this->version.Increment();
         return true;
       }
 
@@ -146,18 +154,32 @@ namespace gz
       /// \return true if the publisher's address is stored.
       public: bool HasPublisher(const std::string &_addr) const
       {
-        for (auto const &topic : this->data)
-        {
-          for (auto const &proc : topic.second)
+        return this->pubsByAddr.find(_addr) != this->pubsByAddr.end();
+      }
+
+      /// \brief Return if a publisher is stored for a given topic and node
+      /// UUID.
+      /// \param[in] _topic Topic name.
+      /// \param[in] _pUuid Process UUID of the publisher.
+      /// \param[in] _nUuid Node UUID of the publisher.
+      /// \return true if a publisher is found for the given topic and UUID pair
+      public: bool HasPublisher(const std::string &_topic,
+                                const std::string &_pUuid,
+                                const std::string &_nUuid) const
+      {
+        auto topicIt = this->data.find(_topic);
+        if (topicIt == this->data.end())
+          return false;
+
+        auto procIt = topicIt->second.find(_pUuid);
+        if (procIt == topicIt->second.end())
+          return false;
+
+        return std::any_of(procIt->second.begin(), procIt->second.end(),
+          [&](const T &_pub)
           {
-            for (auto const &pub : proc.second)
-            {
-              if (pub.Addr() == _addr)
-                return true;
-            }
-          }
-        }
-        return false;
+            return _pub.NUuid() == _nUuid;
+          });
       }
 
       /// \brief Get the address information for a given topic and node UUID.
@@ -240,19 +262,28 @@ namespace gz
             v.erase(std::remove_if(v.begin(), v.end(),
               [&](const T &_pub)
               {
-                return _pub.NUuid() == _nUuid;
+                if (_pub.NUuid() != _nUuid)
+                  return false;
+                this->ReleaseAddr(_pub.Addr());
+                return true;
               }),
               v.end());
             counter = priorSize - v.size();
 
             if (v.empty())
+            {
               m.erase(_pUuid);
+              this->ReleaseTopic(_pUuid, _topic);
+            }
 
             if (m.empty())
               this->data.erase(_topic);
           }
         }
 
+        if (counter > 0)
+          this->version.Increment();
+
         return counter > 0;
       }
 
@@ -263,17 +294,35 @@ namespace gz
       {
         size_t counter = 0;
 
-        // Iterate over all the topics.
-        for (auto it = this->data.begin(); it != this->data.end();)
+        auto procIt = this->topicsByProc.find(_pUuid);
+        if (procIt == this->topicsByProc.end())
+          return false;
+
+        // Iterate over the topics of the process.
+        for (auto const &topic : procIt->second)
         {
+          auto it = this->data.find(topic);
+          if (it == this->data.end())
+            continue;
+
           // m is {pUUID=>Publisher}.
           auto &m = it->second;
-          counter += m.erase(_pUuid);
+          auto procPubs = m.find(_pUuid);
+          if (procPubs == m.end())
+            continue;
+
+          for (auto const &pub : procPubs->second)
+            this->ReleaseAddr(pub.Addr());
+
+          m.erase(procPubs);
+          ++counter;
           if (m.empty())
-            this->data.erase(it++);
-          else
-            ++it;
+            this->data.erase(it);
         }
+        this->topicsByProc.erase(procIt);
+
+        if (counter > 0)
+          this->version.Increment();
 
         return counter > 0;
       }
@@ -288,11 +337,15 @@ namespace gz
       {
         _pubs.clear();
 
-        // Iterate over all the topics.
-        for (auto const &topic : this->data)
+        auto procIt = this->topicsByProc.find(_pUuid);
+        if (procIt == this->topicsByProc.end())
+          return;
+
+        // Iterate over the topics of the process.
+        for (auto const &topic : procIt->second)
         {
           // m is {pUUID=>Publisher}.
-          auto &m = topic.second;
+          auto const &m = this->data.at(topic);
           if (m.find(_pUuid) != m.end())
           {
             auto &v = m.at(_pUuid);
@@ -315,11 +368,15 @@ namespace gz
       {
         _pubs.clear();
 
-        // Iterate over all the topics.
-        for (auto const &topic : this->data)
+        auto procIt = this->topicsByProc.find(_pUuid);
+        if (procIt == this->topicsByProc.end())
+          return;
+
+        // Iterate over the topics of the process.
+        for (auto const &topic : procIt->second)
         {
           // m is {pUUID=>Publisher}.
-          auto const &m = topic.second;
+          auto const &m = this->data.at(topic);
           if (m.find(_pUuid) != m.end())
           {
             auto const &v = m.at(_pUuid);
@@ -362,16 +419,100 @@ namespace gz
         }
       }
 
+      /// \brief Estimate the memory used by the stored publishers: their
+      /// strings, the entries of the maps and the indexes.
+      /// \return The estimated size (bytes).
+      public: uint64_t MemoryUsage() const
+      {
+        // Pointers and color of a node of a tree, or of a hash table.
+        const uint64_t kNodeOverhead = 4 * sizeof(void *);
+
+        uint64_t bytes = 0;
+        for (auto const &topic : this->data)
+        {
+          bytes += kNodeOverhead + sizeof(topic) + topic.first.size();
+          for (auto const &proc : topic.second)
+          {
+            bytes += kNodeOverhead + sizeof(proc) + proc.first.size() +
+              proc.second.capacity() * sizeof(T);
+            for (auto const &publisher : proc.second)
+            {
+              bytes += publisher.Topic().size() + publisher.Addr().size() +
+                publisher.PUuid().size() + publisher.NUuid().size();
+            }
+          }
+        }
+
+        for (auto const &proc : this->topicsByProc)
+        {
+          bytes += kNodeOverhead + sizeof(proc) + proc.first.size();
+          for (auto const &topic : proc.second)
+            bytes += kNodeOverhead + sizeof(topic) + topic.size();
+        }
+
+        for (auto const &addr : this->pubsByAddr)
+          bytes += kNodeOverhead + sizeof(addr) + addr.first.size();
+
+        return bytes;
+      }
+
       /// \brief Clear the content.
       public: void Clear()
       {
         this->data.clear();
+        this->topicsByProc.clear();
+        this->pubsByAddr.clear();
+        this->version.Increment();
+      }
+
+      /// \brief Get the version of the storage. The version is incremented
+      /// every time a publisher is added or removed. Unlike the rest of the
+      /// functions, this one can be called without synchronization.
+      /// \return The version.
+      public: uint64_t Version() const
+      {
+        return this->version.Load();
+      }
+
+      /// \brief Remove a topic from the index of a process. Called when the
+      /// process doesn't have publishers of the topic anymore.
+      /// \param[in] _pUuid Process UUID.
+      /// \param[in] _topic Topic name.
+      private: void ReleaseTopic(const std::string &_pUuid,
+                                 const std::string &_topic)
+      {
+        auto it = this->topicsByProc.find(_pUuid);
+        if (it == this->topicsByProc.end())
+          return;
+
+        it->second.erase(_topic);
+        if (it->second.empty())
+          this->topicsByProc.erase(it);
+      }
+
+      /// \brief Account for a publisher removed from the index of addresses.
+      /// \param[in] _addr Address of the publisher.
+      private: void ReleaseAddr(const std::string &_addr)
+      {
+        auto it = this->pubsByAddr.find(_addr);
+        if (it != this->pubsByAddr.end() && --it->second == 0)
+          this->pubsByAddr.erase(it);
       }
 
       /// \brief The keys are topics. The values are another map, where the key
       /// is the process UUID and the value a vector of publishers.
       private: std::map<std::string,
                         std::map<std::string, std::vector<T>>> data;
+
+      /// \brief Topics with publishers of each process UUID.
+      private: std::unordered_map<std::string, std::set<std::string>>
+        topicsByProc;
+
+      /// \brief Number of publishers using each address.
+      private: std::unordered_map<std::string, std::size_t> pubsByAddr;
+
+      /// \brief Version of the storage, see Version().
+      private: StorageVersion version;
     };
     }
   }
@@ -0,0 +1,211 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GZ_TRANSPORT_TRANSPORTBACKEND_HH_
+#define GZ_TRANSPORT_TRANSPORTBACKEND_HH_
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gz/transport/config.hh"
+#include "gz/transport/Export.hh"
+#include "gz/transport/Publisher.hh"
+
+namespace gz
+{
+  namespace transport
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace GZ_TRANSPORT_VERSION_NAMESPACE {
+    //
+    /// \brief A service request carried by a TransportBackend.
+    struct BackendRequest
+    {
+      /// \brief Fully qualified service name.
+      std::string topic;
+
+      /// \brief UUID of the node sending the request.
+      std::string nodeUuid;
+
+      /// \brief UUID of the request, which identifies its response.
+      std::string reqUuid;
+
+      /// \brief Type of the request.
+      std::string reqType;
+
+      /// \brief Type of the response. A request whose response type is
+      /// gz.msgs.Empty is oneway, it has no response.
+      std::string repType;
+
+      /// \brief Serialized request.
+      std::string data;
+
+      /// \brief Whether the request is a batch of requests, see
+      /// Node::RequestBatch().
+      bool batch{false};
+    };
+
+    /// \class TransportBackendListener TransportBackend.hh
+    /// gz/transport/TransportBackend.hh
+    /// \brief Receives the data delivered by a TransportBackend. It is
+    /// implemented by the transport, the backend calls it from any of its
+    /// threads.
+    class GZ_TRANSPORT_VISIBLE TransportBackendListener
+    {
+      /// \brief Function sending the response of a service request.
+      /// \param[in] _rep Serialized response.
+      /// \param[in] _result Result of the service call.
+      public: using ReplyFunc =
+        std::function<void(const std::string &_rep, const bool _result)>;
+
+      /// \brief Destructor.
+      public: virtual ~TransportBackendListener() = default;
+
+      /// \brief Deliver a message received on a topic connected with
+      /// TransportBackend::Connect().
+      /// \param[in] _topic Fully qualified topic name.
+      /// \param[in] _msgType Type of the message.
+      /// \param[in] _data Serialized message, only valid during the call.
+      /// \param[in] _size Size of the message (bytes).
+      public: virtual void OnMessage(const std::string &_topic,
+                                     const std::string &_msgType,
+                                     const char *_data,
+                                     const std::size_t _size) = 0;
+
+      /// \brief Run a service request sent to this process.
+      /// \param[in] _request The request.
+      /// \param[in] _reply Function sending the response, called once from
+      /// any thread, possibly after returning. It isn't called for the
+      /// oneway requests, nor if the service isn't advertised.
+      public: virtual void OnRequest(const BackendRequest &_request,
+                                     ReplyFunc _reply) = 0;
+
+      /// \brief Deliver the response of a request sent with
+      /// TransportBackend::Request().
+      /// \param[in] _topic Fully qualified service name.
+      /// \param[in] _nodeUuid UUID of the node that sent the request.
+      /// \param[in] _reqUuid UUID of the request.
+      /// \param[in] _rep Serialized response.
+      /// \param[in] _result Result of the service call.
+      public: virtual void OnResponse(const std::string &_topic,
+                                      const std::string &_nodeUuid,
+                                      const std::string &_reqUuid,
+                                      const std::string &_rep,
+                                      const bool _result) = 0;
+    };
+
+    /// \class TransportBackend TransportBackend.hh
+    /// gz/transport/TransportBackend.hh
+    /// \brief Moves the messages of the topics and the service requests
+    /// between the processes, in place of the built-in ZMQ sockets, e.g.
+    /// through shared memory or RDMA. The discovery is unchanged, it
+    /// advertises the Address() of the backend.
+    ///
+    /// A backend is registered by name, usually from a static initializer
+    /// of the library implementing it, and selected with the
+    /// GZ_TRANSPORT_BACKEND environment variable before the first node of
+    /// the process is created. All the processes exchanging data must use
+    /// the same backend. The name "zmq" selects the built-in sockets, which
+    /// is the default. The functions of a backend might be called from
+    /// several threads concurrently.
+    ///
+    /// The messages go through the backend as they are serialized: the
+    /// compression, the batching, the channels and the reliable delivery
+    /// of the publishers are features of the ZMQ sockets.
+    class GZ_TRANSPORT_VISIBLE TransportBackend
+    {
+      /// \brief Function creating a backend.
+      public: using Factory =
+        std::function<std::unique_ptr<TransportBackend>()>;
+
+      /// \brief Name of the built-in backend.
+      public: static constexpr const char *kZmq = "zmq";
+
+      /// \brief Destructor. Stop delivering data to the listener.
+      public: virtual ~TransportBackend() = default;
+
+      /// \brief Start the backend, with the first topic or service of the
+      /// process.
+      /// \param[in] _pUuid UUID of the process.
+      /// \param[in] _listener Receives the data, valid until the backend is
+      /// destroyed.
+      /// \return True on success.
+      public: virtual bool Start(const std::string &_pUuid,
+                                 TransportBackendListener &_listener) = 0;
+
+      /// \brief Get the address of the process, advertised for its topics
+      /// and services. It is only valid once the backend is started.
+      /// \return The address, e.g. "shm://<host>/<id>".
+      public: virtual std::string Address() const = 0;
+
+      /// \brief Send a message to the processes connected to the topic.
+      /// \param[in] _topic Fully qualified topic name.
+      /// \param[in] _msgType Type of the message.
+      /// \param[in] _data Serialized message, only valid during the call.
+      /// \param[in] _size Size of the message (bytes).
+      /// \return True if the message was sent.
+      public: virtual bool Publish(const std::string &_topic,
+                                   const std::string &_msgType,
+                                   const char *_data,
+                                   const std::size_t _size) = 0;
+
+      /// \brief Receive the messages of a publisher discovered, which has a
+      /// local subscriber.
+      /// \param[in] _pub The publisher, its address is the Address() of its
+      /// process.
+      public: virtual void Connect(const MessagePublisher &_pub) = 0;
+
+      /// \brief Stop receiving the messages of a topic.
+      /// \param[in] _topic Fully qualified topic name.
+      /// \param[in] _addr Address of the publisher, or empty when there are
+      /// no local subscribers left.
+      public: virtual void Disconnect(const std::string &_topic,
+                                      const std::string &_addr) = 0;
+
+      /// \brief Send a service request. The response is delivered with
+      /// TransportBackendListener::OnResponse().
+      /// \param[in] _addr Address of the responser.
+      /// \param[in] _request The request.
+      /// \return True if the request was sent.
+      public: virtual bool Request(const std::string &_addr,
+                                   const BackendRequest &_request) = 0;
+
+      /// \brief Register a backend.
+      /// \param[in] _name Name selecting the backend.
+      /// \param[in] _factory Function creating the backend.
+      /// \return False if the name is empty or already registered.
+      public: static bool Register(const std::string &_name,
+                                   Factory _factory);
+
+      /// \brief Create a backend registered.
+      /// \param[in] _name Name of the backend.
+      /// \return The backend, or nullptr if it isn't registered.
+      public: static std::unique_ptr<TransportBackend> Create(
+        const std::string &_name);
+
+      /// \brief Get the names of the backends registered, including the
+      /// built-in one.
+      /// \return The names, sorted.
+      public: static std::vector<std::string> Names();
+    };
+    }
+  }
+}
+#endif
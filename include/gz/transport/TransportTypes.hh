@@ -26,11 +26,14 @@
 #pragma warning(pop)
 #endif
 
+#include <atomic>
 #include <chrono>
+#include <cstdint>
 #include <functional>
 #include <map>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "gz/transport/config.hh"
@@ -49,6 +52,7 @@ namespace gz
     class ISubscriptionHandler;
     class RawSubscriptionHandler;
     class MessageInfo;
+    template <typename T> class LazyMsg;
 
     /// \def Addresses_M
     /// \brief Map that stores all generic publishers.
@@ -141,6 +145,26 @@ namespace gz
     using MsgCallback =
       std::function<void(const T &_msg, const MessageInfo &_info)>;
 
+    /// \def SharedMsgCallback
+    /// \brief User callback used for receiving messages by shared ownership.
+    /// The message is shared (read-only) with the publisher and any other
+    /// local subscriber, no copy is performed within the same process:
+    ///   \param[in] _msg Shared pointer to the topic update.
+    ///   \param[in] _info Message information (e.g.: topic name).
+    template <typename T>
+    using SharedMsgCallback =
+      std::function<void(const std::shared_ptr<const T> &_msg,
+                         const MessageInfo &_info)>;
+
+    /// \def LazyMsgCallback
+    /// \brief User callback used for receiving messages that are only
+    /// deserialized when the callback accesses them:
+    ///   \param[in] _msg View of the serialized topic update.
+    ///   \param[in] _info Message information (e.g.: topic name).
+    template <typename T>
+    using LazyMsgCallback =
+      std::function<void(const LazyMsg<T> &_msg, const MessageInfo &_info)>;
+
     /// \def RawCallback
     /// \brief User callback used for receiving raw message data:
     /// \param[in] _msgData string of a serialized protobuf message
@@ -151,6 +175,52 @@ namespace gz
         std::function<void(const char *_msgData, const size_t _size,
                            const MessageInfo &_info)>;
 
+    /// \def SharedRawCallback
+    /// \brief User callback used for receiving raw message data by shared
+    /// ownership. The callback can keep a reference to the serialized data
+    /// (e.g.: the received transport buffer) after it returns, instead of
+    /// copying it:
+    /// \param[in] _msgData Shared pointer to a serialized protobuf message.
+    /// \param[in] _size Number of bytes in the serialized message data.
+    /// \param[in] _info Message information
+    using SharedRawCallback =
+        std::function<void(const std::shared_ptr<const char> &_msgData,
+                           const size_t _size, const MessageInfo &_info)>;
+
+    /// \def RawViewCallback
+    /// \brief User callback used for receiving raw message data as a view,
+    /// valid until the callback returns:
+    /// \param[in] _msgData The serialized protobuf message.
+    /// \param[in] _info Message information
+    using RawViewCallback =
+        std::function<void(std::string_view _msgData,
+                           const MessageInfo &_info)>;
+
+    /// \def SlowSubscriberCallback
+    /// \brief Callback used when a subscriber connected to a publisher
+    /// becomes slow or recovers:
+    /// \param[in] _peer Address of the subscriber, "host:port".
+    /// \param[in] _slow True if the subscriber became slow, false if it
+    /// recovered or disconnected.
+    /// \param[in] _backlog Bytes queued for the subscriber when the change
+    /// was detected.
+    using SlowSubscriberCallback =
+        std::function<void(const std::string &_peer, const bool _slow,
+                           const uint64_t _backlog)>;
+
+    /// \def FragmentCallback
+    /// \brief User callback receiving the fragments of a large serialized
+    /// message as they arrive, see SubscribeOptions::SetFragmentCallback():
+    /// \param[in] _data The fragment.
+    /// \param[in] _size Number of bytes in the fragment.
+    /// \param[in] _offset Position of the fragment in the message.
+    /// \param[in] _total Number of bytes in the message.
+    /// \param[in] _info Message information
+    using FragmentCallback =
+        std::function<void(const char *_data, const size_t _size,
+                           const size_t _offset, const size_t _total,
+                           const MessageInfo &_info)>;
+
     /// \def Timestamp
     /// \brief Used to evaluate the validity of a discovery entry.
     using Timestamp = std::chrono::steady_clock::time_point;
@@ -174,6 +244,15 @@ namespace gz
     /// \brief The string type used for generic messages.
     const std::string kGenericMessageType = "google.protobuf.Message";
 
+#ifdef GZ_TRANSPORT_EMBEDDED
+    /// \brief The high water mark of the recieve message buffer.
+    /// \sa NodeShared::RcvHwm
+    const int kDefaultRcvHwm = 100;
+
+    /// \brief The high water mark of the send message buffer.
+    /// \sa NodeShared::SndHwm
+    const int kDefaultSndHwm = 100;
+#else
     /// \brief The high water mark of the recieve message buffer.
     /// \sa NodeShared::RcvHwm
     const int kDefaultRcvHwm = 1000;
@@ -181,6 +260,54 @@ namespace gz
     /// \brief The high water mark of the send message buffer.
     /// \sa NodeShared::SndHwm
     const int kDefaultSndHwm = 1000;
+#endif
+
+    /// \class StorageVersion TransportTypes.hh
+    /// gz/transport/TransportTypes.hh
+    /// \brief Version of a storage, incremented every time the storage
+    /// changes. It can be read concurrently with the changes. Unlike
+    /// std::atomic, it can be copied, so the storages keeping it stay
+    /// copyable.
+    /// \sa HandlerStorage::Version
+    /// \sa TopicStorage::Version
+    class StorageVersion
+    {
+      /// \brief Constructor.
+      public: StorageVersion() = default;
+
+      /// \brief Copy constructor. The copy starts at the same version.
+      /// \param[in] _other The version to copy.
+      public: StorageVersion(const StorageVersion &_other)
+        : value(_other.Load())
+      {
+      }
+
+      /// \brief Assignment operator. The content of the storage is replaced,
+      /// so the version is incremented instead of copied.
+      /// \param[in] _other Unused.
+      /// \return Reference to this object.
+      public: StorageVersion &operator=(const StorageVersion &/*_other*/)
+      {
+        this->Increment();
+        return *this;
+      }
+
+      /// \brief Get the version.
+      /// \return The version.
+      public: uint64_t Load() const
+      {
+        return this->value.load(std::memory_order_acquire);
+      }
+
+      /// \brief Increment the version.
+      public: void Increment()
+      {
+        this->value.fetch_add(1, std::memory_order_release);
+      }
+
+      /// \brief The version.
+      private: std::atomic<uint64_t> value{0};
+    };
     }
   }
 }
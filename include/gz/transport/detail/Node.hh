@@ -20,9 +20,13 @@
 
 #include <gz/msgs/empty.pb.h>
 
+#include <array>
+#include <chrono>
 #include <memory>
 #include <string>
+#include <type_traits>
 #include <utility>
+#include <vector>
 
 namespace gz
 {
@@ -30,11 +34,33 @@ namespace gz
   {
     //////////////////////////////////////////////////
     template<typename MessageT>
-    Node::Publisher Node::Advertise(
+    Node::TypedPublisher<MessageT> Node::Advertise(
         const std::string &_topic,
         const AdvertiseMessageOptions &_options)
     {
-      return this->Advertise(_topic, MessageT().GetTypeName(), _options);
+      static const std::string kTypeName = MessageT().GetTypeName();
+      return Node::TypedPublisher<MessageT>(
+        this->Advertise(_topic, kTypeName, _options));
+    }
+
+    //////////////////////////////////////////////////
+    template<typename MessageT>
+    bool Node::Publisher::Publish(std::unique_ptr<MessageT> &&_msg)
+    {
+      return this->Publish(std::shared_ptr<const ProtoMsg>(std::move(_msg)));
+    }
+
+    //////////////////////////////////////////////////
+    template<typename MessageT>
+    bool Node::Publisher::PublishLazy(
+        const std::function<void(MessageT &)> &_fill)
+    {
+      if (!this->WantsData())
+        return this->Valid();
+
+      MessageT msg;
+      _fill(msg);
+      return this->Publish(msg);
     }
 
     //////////////////////////////////////////////////
@@ -44,14 +70,13 @@ namespace gz
         void(*_cb)(const MessageT &_msg),
         const SubscribeOptions &_opts)
     {
-      std::function<void(const MessageT &, const MessageInfo &)> f =
-        [_cb](const MessageT & _internalMsg,
-              const MessageInfo &/*_internalInfo*/)
+      auto f = [_cb](const MessageT & _internalMsg,
+                     const MessageInfo &/*_internalInfo*/)
       {
         (*_cb)(_internalMsg);
       };
 
-      return this->Subscribe<MessageT>(_topic, f, _opts);
+      return this->SubscribeCallable<MessageT>(_topic, std::move(f), _opts);
     }
 
     //////////////////////////////////////////////////
@@ -61,14 +86,13 @@ namespace gz
         std::function<void(const MessageT &_msg)> _cb,
         const SubscribeOptions &_opts)
     {
-      std::function<void(const MessageT &, const MessageInfo &)> f =
-        [cb = std::move(_cb)](const MessageT & _internalMsg,
-              const MessageInfo &/*_internalInfo*/)
+      auto f = [cb = std::move(_cb)](const MessageT & _internalMsg,
+                                     const MessageInfo &/*_internalInfo*/)
       {
         cb(_internalMsg);
       };
 
-      return this->Subscribe<MessageT>(_topic, f, _opts);
+      return this->SubscribeCallable<MessageT>(_topic, std::move(f), _opts);
     }
 
     //////////////////////////////////////////////////
@@ -79,15 +103,13 @@ namespace gz
         ClassT *_obj,
         const SubscribeOptions &_opts)
     {
-      std::function<void(const MessageT &, const MessageInfo &)> f =
-        [_cb, _obj](const MessageT & _internalMsg,
-                    const MessageInfo &/*_internalInfo*/)
+      auto f = [_cb, _obj](const MessageT & _internalMsg,
+                           const MessageInfo &/*_internalInfo*/)
       {
-        auto cb = std::bind(_cb, _obj, std::placeholders::_1);
-        cb(_internalMsg);
+        (_obj->*_cb)(_internalMsg);
       };
 
-      return this->Subscribe<MessageT>(_topic, f, _opts);
+      return this->SubscribeCallable<MessageT>(_topic, std::move(f), _opts);
     }
 
     //////////////////////////////////////////////////
@@ -97,14 +119,13 @@ namespace gz
         void(*_cb)(const MessageT &_msg, const MessageInfo &_info),
         const SubscribeOptions &_opts)
     {
-      std::function<void(const MessageT &, const MessageInfo &)> f =
-        [_cb](const MessageT & _internalMsg,
-              const MessageInfo &_internalInfo)
+      auto f = [_cb](const MessageT & _internalMsg,
+                     const MessageInfo &_internalInfo)
       {
         (*_cb)(_internalMsg, _internalInfo);
       };
 
-      return this->Subscribe<MessageT>(_topic, f, _opts);
+      return this->SubscribeCallable<MessageT>(_topic, std::move(f), _opts);
     }
 
     //////////////////////////////////////////////////
@@ -115,6 +136,17 @@ namespace gz
                            const MessageInfo &_info)> _cb,
         const SubscribeOptions &_opts)
     {
+      // The generic messages don't have a type to store inline, and an
+      // empty callback is reported by the handler.
+      if constexpr (!std::is_same_v<MessageT, ProtoMsg>)
+      {
+        if (_cb)
+        {
+          return this->SubscribeCallable<MessageT>(_topic, std::move(_cb),
+            _opts);
+        }
+      }
+
       // Topic remapping.
       std::string topic = _topic;
       this->Options().TopicRemap(_topic, topic);
@@ -133,6 +165,7 @@ namespace gz
 
       // Insert the callback into the handler.
       subscrHandlerPtr->SetCallback(std::move(_cb));
+      subscrHandlerPtr->SetDefaultExecutor(this->Options().CallbackExecutor());
 
       std::lock_guard<std::recursive_mutex> lk(this->Shared()->mutex);
 
@@ -146,6 +179,128 @@ namespace gz
       return this->SubscribeHelper(fullyQualifiedTopic);
     }
 
+    //////////////////////////////////////////////////
+    template<typename MessageT, typename CallableT>
+    bool Node::SubscribeCallable(
+        const std::string &_topic,
+        CallableT &&_cb,
+        const SubscribeOptions &_opts)
+    {
+      // Topic remapping.
+      std::string topic = _topic;
+      this->Options().TopicRemap(_topic, topic);
+
+      std::string fullyQualifiedTopic;
+      if (!TopicUtils::FullyQualifiedName(this->Options().Partition(),
+        this->Options().NameSpace(), topic, fullyQualifiedTopic))
+      {
+        std::cerr << "Topic [" << topic << "] is not valid." << std::endl;
+        return false;
+      }
+
+      // The generic messages don't have a type to store inline, nor to
+      // reuse, they go through the handler creating them from their name.
+      std::shared_ptr<SubscriptionHandler<MessageT>> subscrHandlerPtr;
+      if constexpr (std::is_same_v<MessageT, ProtoMsg>)
+      {
+        subscrHandlerPtr = std::make_shared<SubscriptionHandler<MessageT>>(
+          this->NodeUuid(), _opts);
+        subscrHandlerPtr->SetCallback(
+          MsgCallback<MessageT>(std::forward<CallableT>(_cb)));
+      }
+      else
+      {
+        // Create a new subscription handler storing the callable.
+        using HandlerT =
+          CallableSubscriptionHandler<MessageT, std::decay_t<CallableT>>;
+        subscrHandlerPtr = std::make_shared<HandlerT>(
+          this->NodeUuid(), _opts, std::forward<CallableT>(_cb));
+      }
+      subscrHandlerPtr->SetDefaultExecutor(this->Options().CallbackExecutor());
+
+      std::lock_guard<std::recursive_mutex> lk(this->Shared()->mutex);
+
+      this->Shared()->localSubscribers.normal.AddHandler(
+        fullyQualifiedTopic, this->NodeUuid(), subscrHandlerPtr);
+
+      return this->SubscribeHelper(fullyQualifiedTopic);
+    }
+
+    //////////////////////////////////////////////////
+    template<typename MessageT>
+    bool Node::Subscribe(
+        const std::string &_topic,
+        std::function<void(const std::shared_ptr<const MessageT> &_msg,
+                           const MessageInfo &_info)> _cb,
+        const SubscribeOptions &_opts)
+    {
+      // Topic remapping.
+      std::string topic = _topic;
+      this->Options().TopicRemap(_topic, topic);
+
+      std::string fullyQualifiedTopic;
+      if (!TopicUtils::FullyQualifiedName(this->Options().Partition(),
+        this->Options().NameSpace(), topic, fullyQualifiedTopic))
+      {
+        std::cerr << "Topic [" << topic << "] is not valid." << std::endl;
+        return false;
+      }
+
+      // Create a new subscription handler.
+      std::shared_ptr<SubscriptionHandler<MessageT>> subscrHandlerPtr(
+          new SubscriptionHandler<MessageT>(this->NodeUuid(), _opts));
+
+      // Insert the shared ownership callback into the handler.
+      subscrHandlerPtr->SetCallback(
+        SharedMsgCallback<MessageT>(std::move(_cb)));
+      subscrHandlerPtr->SetDefaultExecutor(this->Options().CallbackExecutor());
+
+      std::lock_guard<std::recursive_mutex> lk(this->Shared()->mutex);
+
+      this->Shared()->localSubscribers.normal.AddHandler(
+        fullyQualifiedTopic, this->NodeUuid(), subscrHandlerPtr);
+
+      return this->SubscribeHelper(fullyQualifiedTopic);
+    }
+
+    //////////////////////////////////////////////////
+    template<typename MessageT>
+    bool Node::Subscribe(
+        const std::string &_topic,
+        std::function<void(const LazyMsg<MessageT> &_msg)> _cb,
+        const SubscribeOptions &_opts)
+    {
+      LazyMsgCallback<MessageT> f =
+        [cb = std::move(_cb)](const LazyMsg<MessageT> &_internalMsg,
+              const MessageInfo &/*_internalInfo*/)
+      {
+        cb(_internalMsg);
+      };
+
+      return this->Subscribe<MessageT>(_topic, f, _opts);
+    }
+
+    //////////////////////////////////////////////////
+    template<typename MessageT>
+    bool Node::Subscribe(
+        const std::string &_topic,
+        std::function<void(const LazyMsg<MessageT> &_msg,
+                           const MessageInfo &_info)> _cb,
+        const SubscribeOptions &_opts)
+    {
+      // A raw subscription filtered by type delivers the serialized data,
+      // which is wrapped in a view parsed on demand.
+      RawCallback f =
+        [cb = std::move(_cb)](const char *_msgData, const size_t _size,
+              const MessageInfo &_info)
+      {
+        const LazyMsg<MessageT> msg(_msgData, _size);
+        cb(msg, _info);
+      };
+
+      return this->SubscribeRaw(_topic, f, MessageT().GetTypeName(), _opts);
+    }
+
     //////////////////////////////////////////////////
     template<typename ClassT, typename MessageT>
     bool Node::Subscribe(
@@ -154,16 +309,61 @@ namespace gz
         ClassT *_obj,
         const SubscribeOptions &_opts)
     {
-      std::function<void(const MessageT &, const MessageInfo &)> f =
-        [_cb, _obj](const MessageT & _internalMsg,
-                    const MessageInfo &_internalInfo)
+      auto f = [_cb, _obj](const MessageT & _internalMsg,
+                           const MessageInfo &_internalInfo)
       {
-        auto cb = std::bind(_cb, _obj, std::placeholders::_1,
-          std::placeholders::_2);
-        cb(_internalMsg, _internalInfo);
+        (_obj->*_cb)(_internalMsg, _internalInfo);
       };
 
-      return this->Subscribe<MessageT>(_topic, f, _opts);
+      return this->SubscribeCallable<MessageT>(_topic, std::move(f), _opts);
+    }
+
+    //////////////////////////////////////////////////
+    template<typename... MessageTs, typename CallbackT>
+    bool Node::SubscribeSynchronized(
+        const std::array<std::string, sizeof...(MessageTs)> &_topics,
+        CallbackT &&_callback,
+        const SyncOptions &_opts)
+    {
+      auto sync = std::make_shared<Synchronizer<MessageTs...>>(_opts,
+        typename Synchronizer<MessageTs...>::Callback(
+          std::forward<CallbackT>(_callback)));
+
+      return this->SubscribeSynchronizer(_topics, sync,
+        _opts.SubscriptionOptions(), std::index_sequence_for<MessageTs...>());
+    }
+
+    //////////////////////////////////////////////////
+    template<typename MessageT, typename CallbackT>
+    bool Node::SubscribeBatch(
+        const std::string &_topic,
+        CallbackT &&_callback,
+        const std::size_t _maxBatch,
+        const std::chrono::nanoseconds &_maxDelay,
+        const SubscribeOptions &_opts)
+    {
+      auto batcher = std::make_shared<Batcher<MessageT>>(_maxBatch,
+        _maxDelay, typename Batcher<MessageT>::Callback(
+          std::forward<CallbackT>(_callback)));
+
+      return this->Subscribe(_topic, Batcher<MessageT>::Input(batcher),
+        _opts);
+    }
+
+    //////////////////////////////////////////////////
+    template<typename... MessageTs, std::size_t... Is>
+    bool Node::SubscribeSynchronizer(
+        const std::array<std::string, sizeof...(Is)> &_topics,
+        const std::shared_ptr<Synchronizer<MessageTs...>> &_sync,
+        const SubscribeOptions &_opts,
+        std::index_sequence<Is...>)
+    {
+      // Subscribe to all the topics, even if one of them fails.
+      bool result = true;
+      ((result = this->Subscribe(_topics[Is],
+          Synchronizer<MessageTs...>::template Input<Is>(_sync), _opts) &&
+        result), ...);
+      return result;
     }
 
     //////////////////////////////////////////////////
@@ -231,18 +431,6 @@ namespace gz
       std::function<bool(const RequestT &, ReplyT &)> _cb,
       const AdvertiseServiceOptions &_options)
     {
-      // Topic remapping.
-      std::string topic = _topic;
-      this->Options().TopicRemap(_topic, topic);
-
-      std::string fullyQualifiedTopic;
-      if (!TopicUtils::FullyQualifiedName(this->Options().Partition(),
-        this->Options().NameSpace(), topic, fullyQualifiedTopic))
-      {
-        std::cerr << "Service [" << topic << "] is not valid." << std::endl;
-        return false;
-      }
-
       // Create a new service reply handler.
       std::shared_ptr<RepHandler<RequestT, ReplyT>> repHandlerPtr(
         new RepHandler<RequestT, ReplyT>());
@@ -250,35 +438,24 @@ namespace gz
       // Insert the callback into the handler.
       repHandlerPtr->SetCallback(_cb);
 
-      std::lock_guard<std::recursive_mutex> lk(this->Shared()->mutex);
-
-      // Add the topic to the list of advertised services.
-      this->SrvsAdvertised().insert(fullyQualifiedTopic);
-
-      // Store the replier handler. Each replier handler is
-      // associated with a topic. When the receiving thread gets new requests,
-      // it will recover the replier handler associated to the topic and
-      // will invoke the service call.
-      this->Shared()->repliers.AddHandler(
-        fullyQualifiedTopic, this->NodeUuid(), repHandlerPtr);
+      return this->AdvertiseHelper(_topic, repHandlerPtr, _options);
+    }
 
-      // Notify the discovery service to register and advertise my responser.
-      ServicePublisher publisher(fullyQualifiedTopic,
-        this->Shared()->myReplierAddress,
-        this->Shared()->replierId.ToString(),
-        this->Shared()->pUuid, this->NodeUuid(),
-        RequestT().GetTypeName(), ReplyT().GetTypeName(), _options);
+    //////////////////////////////////////////////////
+    template<typename RequestT, typename ReplyT>
+    bool Node::Advertise(
+      const std::string &_topic,
+      std::function<void(const RequestT &, ServiceResponder<ReplyT>)> _cb,
+      const AdvertiseServiceOptions &_options)
+    {
+      // Create a new service reply handler.
+      std::shared_ptr<DeferredRepHandler<RequestT, ReplyT>> repHandlerPtr(
+        new DeferredRepHandler<RequestT, ReplyT>());
 
-      if (!this->Shared()->AdvertisePublisher(publisher))
-      {
-        std::cerr << "Node::Advertise(): Error advertising service ["
-                  << topic
-                  << "]. Did you forget to start the discovery service?"
-                  << std::endl;
-        return false;
-      }
+      // Insert the callback into the handler.
+      repHandlerPtr->SetCallback(_cb);
 
-      return true;
+      return this->AdvertiseHelper(_topic, repHandlerPtr, _options);
     }
 
     //////////////////////////////////////////////////
@@ -402,37 +579,102 @@ namespace gz
       const RequestT &_request,
       std::function<void(const ReplyT &_reply, const bool _result)> &_cb)
     {
-      // Topic remapping.
-      std::string topic = _topic;
-      this->Options().TopicRemap(_topic, topic);
+      return this->RequestHelper(_topic, _request, _cb, 0);
+    }
 
-      std::string fullyQualifiedTopic;
-      if (!TopicUtils::FullyQualifiedName(this->Options().Partition(),
-        this->Options().NameSpace(), topic, fullyQualifiedTopic))
+    //////////////////////////////////////////////////
+    template<typename RequestT, typename ReplyT>
+    std::future<std::pair<ReplyT, bool>> Node::RequestAsync(
+      const std::string &_topic,
+      const RequestT &_request,
+      const unsigned int _timeout)
+    {
+      auto promise = std::make_shared<std::promise<std::pair<ReplyT, bool>>>();
+      std::future<std::pair<ReplyT, bool>> future = promise->get_future();
+
+      std::function<void(const ReplyT &, const bool)> cb =
+        [promise](const ReplyT &_reply, const bool _result)
+      {
+        promise->set_value(std::make_pair(_reply, _result));
+      };
+
+      // Setting the promise is cheap, it doesn't need the executor.
+      if (!this->RequestHelper(_topic, _request, cb, _timeout, false))
+        promise->set_value(std::make_pair(ReplyT(), false));
+
+      return future;
+    }
+
+#ifdef GZ_TRANSPORT_HAS_COROUTINES
+    //////////////////////////////////////////////////
+    template<typename RequestT, typename ReplyT>
+    RequestAwaitable<ReplyT> Node::RequestAwait(
+      const std::string &_topic,
+      const RequestT &_request,
+      const unsigned int _timeout)
+    {
+      return RequestAwaitable<ReplyT>(
+        [this, _topic, _request, _timeout](
+          const std::function<void(const ReplyT &, const bool)> &_cb)
+        {
+          if (!this->RequestHelper(_topic, _request, _cb, _timeout))
+            _cb(ReplyT(), false);
+        });
+    }
+#endif
+
+    //////////////////////////////////////////////////
+    template<typename RequestT, typename ReplyT>
+    bool Node::RequestHelper(
+      const std::string &_topic,
+      const RequestT &_request,
+      const std::function<void(const ReplyT &, const bool)> &_cb,
+      const unsigned int _timeout,
+      const bool _useExecutor)
+    {
+      // The names are remapped and qualified once.
+      const std::shared_ptr<const std::string> resolved =
+        this->ResolveTopic(_topic);
+      if (!resolved)
       {
-        std::cerr << "Service [" << topic << "] is not valid." << std::endl;
+        std::cerr << "Service [" << _topic << "] is not valid." << std::endl;
         return false;
       }
+      const std::string &fullyQualifiedTopic = *resolved;
+
+      // The type names are only computed once.
+      static const std::string kReqType = RequestT().GetTypeName();
+      static const std::string kRepType = ReplyT().GetTypeName();
 
       bool localResponserFound;
       IRepHandlerPtr repHandler;
       {
         std::lock_guard<std::recursive_mutex> lk(this->Shared()->mutex);
         localResponserFound = this->Shared()->repliers.FirstHandler(
-              fullyQualifiedTopic,
-              RequestT().GetTypeName(),
-              ReplyT().GetTypeName(),
-              repHandler);
+              fullyQualifiedTopic, kReqType, kRepType, repHandler);
       }
 
       // If the responser is within my process.
       if (localResponserFound)
       {
-        // There is a responser in my process, let's use it.
-        ReplyT rep;
-        bool result = repHandler->RunLocalCallback(_request, rep);
+        // There is a responser in my process, let's use it. The messages
+        // are passed without serialization.
+        if (!repHandler->Deferred())
+        {
+          ReplyT rep;
+          bool result = repHandler->RunLocalCallback(_request, rep);
 
-        _cb(rep, result);
+          _cb(rep, result);
+          return true;
+        }
+
+        // Don't wait for a deferred response, the callback is executed by
+        // the thread completing the response.
+        repHandler->RunLocalDeferredCallback(_request,
+          [_cb](const ProtoMsg &_rep, const bool _result)
+          {
+            _cb(static_cast<const ReplyT &>(_rep), _result);
+          });
         return true;
       }
 
@@ -445,20 +687,31 @@ namespace gz
 
       // Insert the callback into the handler.
       reqHandlerPtr->SetCallback(_cb);
+      if (_useExecutor)
+        reqHandlerPtr->SetCallbackExecutor(this->Options().ResponseExecutor());
 
       {
         std::lock_guard<std::recursive_mutex> lk(this->Shared()->mutex);
 
+        // The reception thread abandons the request after the timeout.
+        if (_timeout > 0)
+        {
+          const Timestamp deadline = std::chrono::steady_clock::now() +
+            std::chrono::milliseconds(_timeout);
+          reqHandlerPtr->SetDeadline(deadline);
+        }
+
+        reqHandlerPtr->SetLoadBalancing(this->Options().LoadBalancing());
+
         // Store the request handler.
-        this->Shared()->requests.AddHandler(
-          fullyQualifiedTopic, this->NodeUuid(), reqHandlerPtr);
+        this->Shared()->AddRequest(fullyQualifiedTopic, reqHandlerPtr);
 
         // If the responser's address is known, make the request.
         SrvAddresses_M addresses;
         if (this->Shared()->TopicPublishers(fullyQualifiedTopic, addresses))
         {
           this->Shared()->SendPendingRemoteReqs(fullyQualifiedTopic,
-            RequestT().GetTypeName(), ReplyT().GetTypeName());
+            kReqType, kRepType);
         }
         else
         {
@@ -466,9 +719,10 @@ namespace gz
           if (!this->Shared()->DiscoverService(fullyQualifiedTopic))
           {
             std::cerr << "Node::Request(): Error discovering service ["
-                      << topic
+                      << _topic
                       << "]. Did you forget to start the discovery service?"
                       << std::endl;
+            this->Shared()->RemoveRequest(reqHandlerPtr->HandlerUuid());
             return false;
           }
         }
@@ -526,17 +780,15 @@ namespace gz
             ReplyT &_reply,
             bool &_result)
     {
-      // Topic remapping.
-      std::string topic = _topic;
-      this->Options().TopicRemap(_topic, topic);
-
-      std::string fullyQualifiedTopic;
-      if (!TopicUtils::FullyQualifiedName(this->Options().Partition(),
-        this->Options().NameSpace(), topic, fullyQualifiedTopic))
+      // The names are remapped and qualified once.
+      const std::shared_ptr<const std::string> resolved =
+        this->ResolveTopic(_topic);
+      if (!resolved)
       {
-        std::cerr << "Service [" << topic << "] is not valid." << std::endl;
+        std::cerr << "Service [" << _topic << "] is not valid." << std::endl;
         return false;
       }
+      const std::string &fullyQualifiedTopic = *resolved;
 
       // Create a new request handler.
       std::shared_ptr<ReqHandler<RequestT, ReplyT>> reqHandlerPtr(
@@ -553,14 +805,21 @@ namespace gz
       if (this->Shared()->repliers.FirstHandler(fullyQualifiedTopic,
         _request.GetTypeName(), _reply.GetTypeName(), repHandler))
       {
-        // There is a responser in my process, let's use it.
+        // There is a responser in my process, let's use it. The callback
+        // doesn't need the lock, it might use the transport as well.
+        lk.unlock();
         _result = repHandler->RunLocalCallback(_request, _reply);
         return true;
       }
 
+      // The reception thread abandons the request after the timeout and
+      // wakes us up.
+      reqHandlerPtr->SetDeadline(std::chrono::steady_clock::now() +
+        std::chrono::milliseconds(_timeout));
+      reqHandlerPtr->SetLoadBalancing(this->Options().LoadBalancing());
+
       // Store the request handler.
-      this->Shared()->requests.AddHandler(
-        fullyQualifiedTopic, this->NodeUuid(), reqHandlerPtr);
+      this->Shared()->AddRequest(fullyQualifiedTopic, reqHandlerPtr);
 
       // If the responser's address is known, make the request.
       SrvAddresses_M addresses;
@@ -575,19 +834,24 @@ namespace gz
         if (!this->Shared()->DiscoverService(fullyQualifiedTopic))
         {
           std::cerr << "Node::Request(): Error discovering service ["
-                    << topic
+                    << _topic
                     << "]. Did you forget to start the discovery service?"
                     << std::endl;
+          this->Shared()->RemoveRequest(reqHandlerPtr->HandlerUuid());
           return false;
         }
       }
 
       // Wait until the REP is available.
-      bool executed = reqHandlerPtr->WaitUntil(lk, _timeout);
+      bool executed = reqHandlerPtr->Wait(lk);
 
-      // The request was not executed.
+      // The request was not executed, the response can't be received
+      // anymore.
       if (!executed)
+      {
+        this->Shared()->RemoveRequest(reqHandlerPtr->HandlerUuid());
         return false;
+      }
 
       // The request was executed but did not succeed.
       if (!reqHandlerPtr->Result())
@@ -609,6 +873,102 @@ namespace gz
       return true;
     }
 
+    //////////////////////////////////////////////////
+    template<typename RequestT, typename ReplyT>
+    bool Node::RequestBatch(
+            const std::string &_topic,
+            const std::vector<RequestT> &_requests,
+            const unsigned int &_timeout,
+            std::vector<ReplyT> &_replies,
+            std::vector<bool> &_results)
+    {
+      // The names are remapped and qualified once.
+      const std::shared_ptr<const std::string> resolved =
+        this->ResolveTopic(_topic);
+      if (!resolved)
+      {
+        std::cerr << "Service [" << _topic << "] is not valid." << std::endl;
+        return false;
+      }
+      const std::string &fullyQualifiedTopic = *resolved;
+
+      static const std::string reqType = RequestT().GetTypeName();
+      static const std::string repType = ReplyT().GetTypeName();
+
+      std::unique_lock<std::recursive_mutex> lk(this->Shared()->mutex);
+
+      // If the responser is within my process.
+      IRepHandlerPtr repHandler;
+      if (this->Shared()->repliers.FirstHandler(fullyQualifiedTopic,
+        reqType, repType, repHandler))
+      {
+        // There is a responser in my process, let's use it.
+        lk.unlock();
+        _replies.assign(_requests.size(), ReplyT());
+        _results.assign(_requests.size(), false);
+        for (std::size_t i = 0; i < _requests.size(); ++i)
+        {
+          _results[i] =
+            repHandler->RunLocalCallback(_requests[i], _replies[i]);
+        }
+        return true;
+      }
+
+      // Create a new request handler, sending all the requests at once.
+      std::shared_ptr<BatchReqHandler<RequestT, ReplyT>> reqHandlerPtr(
+        new BatchReqHandler<RequestT, ReplyT>(this->NodeUuid()));
+      if (!reqHandlerPtr->SetMessages(_requests))
+        return false;
+
+      reqHandlerPtr->SetDeadline(std::chrono::steady_clock::now() +
+        std::chrono::milliseconds(_timeout));
+      reqHandlerPtr->SetLoadBalancing(this->Options().LoadBalancing());
+
+      // Store the request handler.
+      this->Shared()->AddRequest(fullyQualifiedTopic, reqHandlerPtr);
+
+      // If the responser's address is known, make the request.
+      SrvAddresses_M addresses;
+      if (this->Shared()->TopicPublishers(fullyQualifiedTopic, addresses))
+      {
+        this->Shared()->SendPendingRemoteReqs(fullyQualifiedTopic,
+          reqType, repType);
+      }
+      else
+      {
+        // Discover the service responser.
+        if (!this->Shared()->DiscoverService(fullyQualifiedTopic))
+        {
+          std::cerr << "Node::RequestBatch(): Error discovering service ["
+                    << _topic
+                    << "]. Did you forget to start the discovery service?"
+                    << std::endl;
+          this->Shared()->RemoveRequest(reqHandlerPtr->HandlerUuid());
+          return false;
+        }
+      }
+
+      // Wait until the REP is available.
+      if (!reqHandlerPtr->Wait(lk))
+      {
+        this->Shared()->RemoveRequest(reqHandlerPtr->HandlerUuid());
+        return false;
+      }
+
+      // The batch was executed but its responses couldn't be parsed.
+      if (!reqHandlerPtr->Result() ||
+          !reqHandlerPtr->Responses(_replies, _results) ||
+          _replies.size() != _requests.size())
+      {
+        std::cerr << "Node::RequestBatch(): Error parsing the responses"
+                  << std::endl;
+        _replies.assign(_requests.size(), ReplyT());
+        _results.assign(_requests.size(), false);
+      }
+
+      return true;
+    }
+
     //////////////////////////////////////////////////
     template<typename ReplyT>
     bool Node::Request(
@@ -627,6 +987,10 @@ namespace gz
         const std::string &_topic,
         const RequestT &_request)
     {
+      // Skip the request handler when the responser is already connected.
+      if (this->RequestOneway(_topic, _request))
+        return true;
+
       // This callback is here for reusing the regular Request() call with
       // input and output parameters.
       std::function<void(const gz::msgs::Empty &, const bool)> f =
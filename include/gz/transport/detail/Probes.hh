@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GZ_TRANSPORT_DETAIL_PROBES_HH_
+#define GZ_TRANSPORT_DETAIL_PROBES_HH_
+
+#include "gz/transport/config.hh"
+
+/// \file Probes.hh
+/// \brief Static probes (USDT) on the hot paths of the transport, provider
+/// "gz_transport". A probe is a single nop instruction until a tracer such
+/// as bpftrace attaches to it, e.g.:
+///
+///   bpftrace -e 'usdt:/usr/lib/libgz-transport14.so:gz_transport:recv
+///     { @bytes[str(arg0)] = sum(arg1); }'
+///
+/// The probes are compiled in when the SystemTap header <sys/sdt.h> is found
+/// and the CMake option GZ_TRANSPORT_USDT_PROBES is on. Otherwise the macros
+/// expand to nothing.
+
+#if defined(HAVE_USDT) && defined(__has_include)
+#  if __has_include(<sys/sdt.h>)
+#    include <sys/sdt.h>
+#    define GZ_TRANSPORT_USDT_ENABLED 1
+#  endif
+#endif
+
+#ifdef GZ_TRANSPORT_USDT_ENABLED
+
+/// \brief Fire a probe without arguments.
+#define GZ_TRANSPORT_PROBE(_name) \
+  DTRACE_PROBE(gz_transport, _name)
+
+/// \brief Fire a probe with one argument.
+#define GZ_TRANSPORT_PROBE1(_name, _a1) \
+  DTRACE_PROBE1(gz_transport, _name, _a1)
+
+/// \brief Fire a probe with two arguments.
+#define GZ_TRANSPORT_PROBE2(_name, _a1, _a2) \
+  DTRACE_PROBE2(gz_transport, _name, _a1, _a2)
+
+/// \brief Fire the probes <_name>__start and <_name>__end when entering
+/// and leaving the current scope, with the topic as argument. The topic
+/// must outlive the scope.
+#define GZ_TRANSPORT_PROBE_SCOPE(_name, _topic) \
+  struct GzProbeScope_##_name \
+  { \
+    explicit GzProbeScope_##_name(const char *_t) : topic(_t) \
+    { \
+      DTRACE_PROBE1(gz_transport, _name##__start, topic); \
+    } \
+    ~GzProbeScope_##_name() \
+    { \
+      DTRACE_PROBE1(gz_transport, _name##__end, topic); \
+    } \
+    const char *topic; \
+  } gzProbeScope_##_name(_topic)
+
+#else
+
+#define GZ_TRANSPORT_PROBE(_name)
+#define GZ_TRANSPORT_PROBE1(_name, _a1)
+#define GZ_TRANSPORT_PROBE2(_name, _a1, _a2)
+#define GZ_TRANSPORT_PROBE_SCOPE(_name, _topic)
+
+#endif
+
+#endif
@@ -18,6 +18,7 @@
 #ifndef GZ_TRANSPORT_LOG_BATCH_HH_
 #define GZ_TRANSPORT_LOG_BATCH_HH_
 
+#include <cstddef>
 #include <memory>
 
 #include <gz/transport/config.hh>
@@ -71,6 +72,37 @@ namespace gz
         ///   to a valid message
         public: iterator end();
 
+        /// \brief typedef for prettiness
+        public: using reverse_iterator = MsgIter;
+
+        /// \brief Iterator to the last message in batch. It visits the
+        /// messages in the reverse order of begin(): the statements of the
+        /// query from the last, each one from its latest message. The
+        /// messages are looked up in the reverse order, not read then
+        /// reversed.
+        /// \return an iterator to the end of the messages
+        public: reverse_iterator rbegin();
+
+        /// \brief Iterator to one before the first message in a batch
+        /// \return an iterator that is not equal to any iterator that points
+        ///   to a valid message
+        public: reverse_iterator rend();
+
+        /// \brief Fetch the messages from the log by batches of rows
+        /// copied to a buffer that the iterators reuse, instead of one row
+        /// at a time. Scanning many small messages then doesn't allocate for
+        /// every message, and the names of the topics and the message types
+        /// are only copied once. It applies to the iterators created after
+        /// this call.
+        /// \param[in] _rows Maximum number of rows fetched at once, 0 to
+        /// fetch them one by one (the default).
+        /// \param[in] _bytes Size (in bytes) of the data of the rows fetched
+        /// at once after which no more rows are fetched, which caps the
+        /// memory of an iterator to about this size plus the largest
+        /// message. 0 for no limit.
+        public: void SetPrefetch(const std::size_t _rows,
+                                 const std::size_t _bytes = 0);
+
 #ifdef _WIN32
 // Disable warning C4251 which is triggered by
 // std::*
@@ -0,0 +1,223 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GZ_TRANSPORT_LOG_CHUNKEDLOG_HH_
+#define GZ_TRANSPORT_LOG_CHUNKEDLOG_HH_
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <ios>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gz/transport/config.hh>
+#include <gz/transport/log/Export.hh>
+#include <gz/transport/log/Log.hh>
+#include <gz/transport/log/LogOptions.hh>
+
+namespace gz
+{
+  namespace transport
+  {
+    namespace log
+    {
+      // Inline bracket to help doxygen filtering.
+      inline namespace GZ_TRANSPORT_VERSION_NAMESPACE {
+      //
+      /// \brief Callback receiving the messages of a ChunkedLog.
+      /// The arguments are the time the message was received, the name of
+      /// its topic, the name of its type and its data (pointer and size).
+      /// The data is only valid during the call.
+      /// Return false to stop the iteration.
+      using ChunkedLogCallback = std::function<bool(
+          const std::chrono::nanoseconds &_time,
+          const std::string &_topic, const std::string &_type,
+          const char *_data, std::size_t _len)>;
+
+      /// \brief A log file in an append-only chunked format, an alternative
+      /// to the SQLite database of Log for long and high bandwidth
+      /// recordings.
+      ///
+      /// The messages are buffered in memory and written as a chunk when
+      /// its size reaches LogOptions::ChunkSize(). Every chunk is
+      /// self-contained: it starts with a header (number of messages, time
+      /// range and sizes) and the list of its topics, followed by its
+      /// messages sorted by time and optionally compressed
+      /// (LogOptions::ChunkCompression()). Reading only needs the headers
+      /// to skip the chunks outside of a time range or without the
+      /// requested topics, and the file is memory mapped.
+      ///
+      /// Nothing is written after the last chunk, so a crash only loses the
+      /// messages that weren't written yet. A truncated chunk at the end of
+      /// the file is ignored when reading and discarded when appending.
+      ///
+      /// Use ConvertLog() to convert a chunked log to a SQLite log, for
+      /// instance to play it back, and vice versa.
+      class GZ_TRANSPORT_LOG_VISIBLE ChunkedLog
+      {
+        /// \brief Constructor
+        public: ChunkedLog();
+
+        /// \brief Move constructor
+        /// \param[in] _old the instance being moved into this one
+        public: ChunkedLog(ChunkedLog &&_old);  // NOLINT
+
+        /// \brief Destructor. Writes the last chunk.
+        public: ~ChunkedLog();
+
+        /// \brief Open a log file.
+        /// \param[in] _file Path to the log file.
+        /// \param[in] _mode std::ios_base::in to read the file, or
+        /// std::ios_base::out to create it or append messages to it.
+        /// \param[in] _options The chunk size and compression, used when
+        /// writing.
+        /// \return True if the file was successfully opened.
+        public: bool Open(const std::string &_file,
+            std::ios_base::openmode _mode = std::ios_base::in,
+            const LogOptions &_options = LogOptions());
+
+        /// \brief Indicate if a log has been successfully opened.
+        /// \return True if a log is open.
+        public: bool Valid() const;
+
+        /// \brief Get the name of the log file.
+        /// \return The name of the log file, or an empty string if Open has
+        /// not been successfully called.
+        public: std::string Filename() const;
+
+        /// \brief Close the log file. The last chunk is written first.
+        public: void Close();
+
+        /// \brief Insert a message into the log file.
+        /// \param[in] _time Time the message was received (ns since Unix epoch)
+        /// \param[in] _topic Name of the topic the message was on
+        /// \param[in] _type Name of the message type
+        /// \param[in] _data pointer to a buffer containing the message data
+        /// \param[in] _len number of bytes of data
+        /// \return True if the message was successfully inserted.
+        public: bool InsertMessage(
+            const std::chrono::nanoseconds &_time,
+            const std::string &_topic, const std::string &_type,
+            const void *_data, std::size_t _len);
+
+        /// \brief Insert several messages into the log file.
+        /// \param[in] _messages Messages to insert, in order.
+        /// \return Number of messages inserted.
+        public: std::size_t InsertMessages(
+            const std::vector<MessageRecord> &_messages);
+
+        /// \brief Write the buffered messages as a chunk. With
+        /// LogOptions::ChunkIoDepth(), wait for the writes in flight too.
+        /// \return True on success or if there was nothing to write.
+        public: bool Flush();
+
+        /// \brief Get the number of chunks of the log file.
+        /// \return The number of chunks written or read.
+        public: std::size_t ChunkCount() const;
+
+        /// \brief Get the number of messages of the log file.
+        /// \return The number of messages, including the buffered ones.
+        public: uint64_t MessageCount() const;
+
+        /// \brief Get the time of the first message of the log.
+        /// \return Start time of the log, or zero if it's empty.
+        public: std::chrono::nanoseconds StartTime() const;
+
+        /// \brief Get the time of the last message of the log.
+        /// \return End time of the log, or zero if it's empty.
+        public: std::chrono::nanoseconds EndTime() const;
+
+        /// \brief Get the topics of the log.
+        /// \return Pairs with the name of the topic and the name of the
+        /// message type.
+        public: std::set<std::pair<std::string, std::string>> Topics() const;
+
+        /// \brief Iterate over the messages of a log opened for reading, in
+        /// time order.
+        /// \param[in] _cb Callback receiving the messages.
+        /// \param[in] _topics Names of the topics to read. All the topics are
+        /// read when it's empty.
+        /// \param[in] _start Time of the first message to read (inclusive).
+        /// \param[in] _end Time of the last message to read (inclusive).
+        /// \return False if the log is not open for reading or a chunk is
+        /// malformed.
+        public: bool ForEachMessage(const ChunkedLogCallback &_cb,
+            const std::set<std::string> &_topics = {},
+            const std::chrono::nanoseconds &_start =
+              std::chrono::nanoseconds::min(),
+            const std::chrono::nanoseconds &_end =
+              std::chrono::nanoseconds::max()) const;
+
+        /// \brief Check the checksum and the messages of every chunk of a
+        /// log opened for reading, with several threads, and whether the
+        /// last chunk is truncated.
+        /// \param[in] _threads Number of threads, 0 for one per core.
+        /// \param[out] _result What was found.
+        /// \return True if nothing is corrupt.
+        public: bool Verify(unsigned int _threads,
+            LogVerification &_result) const;
+
+        /// \brief Check if a file is a chunked log.
+        /// \param[in] _file Path to the file.
+        /// \return True if the file starts like a chunked log.
+        public: static bool IsChunkedLog(const std::string &_file);
+
+        /// \internal Implementation for this class
+        private: class Implementation;
+
+#ifdef _WIN32
+// Disable warning C4251 which is triggered by
+// std::*
+#pragma warning(push)
+#pragma warning(disable: 4251)
+#endif
+        /// \brief Private implementation
+        private: std::unique_ptr<Implementation> dataPtr;
+#ifdef _WIN32
+#pragma warning(pop)
+#endif
+      };
+
+      /// \brief Convert a log file between the SQLite and the chunked
+      /// formats. The format of _src is detected and the messages are
+      /// written to _dst in _options.Format().
+      /// \param[in] _src Path to the log file to read.
+      /// \param[in] _dst Path to the log file to create. It must not exist.
+      /// \param[in] _options Format and options of _dst.
+      /// \return True if every message was converted.
+      GZ_TRANSPORT_LOG_VISIBLE
+      bool ConvertLog(const std::string &_src, const std::string &_dst,
+          const LogOptions &_options);
+
+      /// \brief Check the integrity of a log file in any format, see
+      /// Log::Verify() and ChunkedLog::Verify().
+      /// \param[in] _file Path to the log file.
+      /// \param[in] _threads Number of threads, 0 for one per core.
+      /// \param[out] _result What was found.
+      /// \return True if the log file was opened and nothing is corrupt.
+      GZ_TRANSPORT_LOG_VISIBLE
+      bool VerifyLog(const std::string &_file, unsigned int _threads,
+          LogVerification &_result);
+      }
+    }
+  }
+}
+#endif
@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GZ_TRANSPORT_LOG_COLUMNEXPORT_HH_
+#define GZ_TRANSPORT_LOG_COLUMNEXPORT_HH_
+
+#include <regex>
+#include <string>
+
+#include <gz/transport/config.hh>
+#include <gz/transport/log/Export.hh>
+
+namespace gz
+{
+  namespace transport
+  {
+    namespace log
+    {
+      // Inline bracket to help doxygen filtering.
+      inline namespace GZ_TRANSPORT_VERSION_NAMESPACE {
+      //
+      /// \brief A column export is a directory holding the messages of some
+      /// topics of a log as flat arrays, which analysis tools load without
+      /// parsing, e.g. with numpy.fromfile():
+      ///
+      /// - "topics.csv" has the columns "id,topic,type", one row for every
+      ///   exported topic and message type.
+      /// - Every "part-<time>" directory holds the messages received in a
+      ///   range of time, in order. <time> is the time of its first message
+      ///   in nanoseconds, padded with zeros, so the parts sort by time and
+      ///   their ranges don't overlap.
+      /// - Every part has four files of the same number of rows: "time"
+      ///   (int64, nanoseconds), "topic" (int64, id in topics.csv) and
+      ///   "size" (uint64, bytes), in the byte order of the host (little
+      ///   endian on the supported platforms), and "data", the serialized
+      ///   messages one after the other.
+
+      /// \brief Export the messages of some topics of a log to a column
+      /// export. The parts are written in parallel, each by a thread reading
+      /// its range of time with Log::ParallelScan().
+      /// \param[in] _src Path to the SQLite log file.
+      /// \param[in] _dir Path to the directory to create.
+      /// \param[in] _topics ECMAScript regular expression matching the names
+      /// of the topics to export.
+      /// \param[in] _threads Number of threads, 0 for one per core.
+      /// \return True if every matching message was exported.
+      GZ_TRANSPORT_LOG_VISIBLE
+      bool ExportColumns(const std::string &_src, const std::string &_dir,
+          const std::regex &_topics, const unsigned int _threads = 0);
+      }
+    }
+  }
+}
+
+#endif
@@ -18,16 +18,22 @@
 #ifndef GZ_TRANSPORT_LOG_LOG_HH_
 #define GZ_TRANSPORT_LOG_LOG_HH_
 
+#include <array>
 #include <chrono>
+#include <cstdint>
+#include <functional>
 #include <ios>
+#include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <gz/transport/config.hh>
 #include <gz/transport/log/Batch.hh>
 #include <gz/transport/log/QueryOptions.hh>
 #include <gz/transport/log/Descriptor.hh>
 #include <gz/transport/log/Export.hh>
+#include <gz/transport/log/LogOptions.hh>
 
 namespace gz
 {
@@ -41,6 +47,105 @@ namespace gz
       /// \brief Name of Environment variable containing path to schema
       const std::string SchemaLocationEnvVar = "GZ_TRANSPORT_LOG_SQL_PATH";
 
+      /// \brief A message to insert in a log file with Log::InsertMessages().
+      /// It doesn't own its content, which must outlive the call.
+      struct MessageRecord
+      {
+        /// \brief Time the message was received (ns since Unix epoch)
+        std::chrono::nanoseconds time;
+
+        /// \brief Name of the topic the message was on
+        const std::string *topic;
+
+        /// \brief Name of the message type
+        const std::string *type;
+
+        /// \brief Pointer to a buffer containing the message data
+        const void *data;
+
+        /// \brief Number of bytes of data
+        std::size_t len;
+      };
+
+      /// \brief Summary of the messages of a topic in a log, see
+      /// Log::Summary()
+      struct TopicSummary
+      {
+        /// \brief Number of messages
+        uint64_t messages{0};
+
+        /// \brief Size (in bytes) of the messages
+        uint64_t bytes{0};
+
+        /// \brief Time the first message was received
+        std::chrono::nanoseconds startTime{0};
+
+        /// \brief Time the last message was received
+        std::chrono::nanoseconds endTime{0};
+      };
+
+      /// \brief Number of bins of TopicStatistics::gapHistogram
+      constexpr std::size_t kGapHistogramBins = 64;
+
+      /// \brief Statistics of the messages of a topic received in a time
+      /// range, see Log::Statistics()
+      struct TopicStatistics
+      {
+        /// \brief Number of messages
+        uint64_t messages{0};
+
+        /// \brief Size (in bytes) of the messages as they are stored, see
+        /// Log::Statistics()
+        uint64_t storedBytes{0};
+
+        /// \brief Time the first message was received
+        std::chrono::nanoseconds startTime{0};
+
+        /// \brief Time the last message was received
+        std::chrono::nanoseconds endTime{0};
+
+        /// \brief Average number of messages received per second, zero
+        /// with less than two messages or if they were all received at the
+        /// same time
+        double rate{0};
+
+        /// \brief Shortest time between two consecutive messages
+        std::chrono::nanoseconds minGap{0};
+
+        /// \brief Longest time between two consecutive messages
+        std::chrono::nanoseconds maxGap{0};
+
+        /// \brief Time the message before the longest gap was received
+        std::chrono::nanoseconds maxGapStart{0};
+
+        /// \brief Standard deviation of the time between two consecutive
+        /// messages
+        std::chrono::nanoseconds gapStdDev{0};
+
+        /// \brief Histogram of the times between two consecutive messages.
+        /// Bin 0 counts the messages received at the same time as the
+        /// previous one, bin i > 0 the gaps of [2^(i-1), 2^i) nanoseconds.
+        std::array<uint64_t, kGapHistogramBins> gapHistogram{};
+      };
+
+      /// \brief Result of the verification of a log file, see
+      /// Log::Verify()
+      struct LogVerification
+      {
+        /// \brief Number of messages read
+        uint64_t messages{0};
+
+        /// \brief Number of messages with a checksum, which were checked
+        uint64_t checked{0};
+
+        /// \brief Number of messages that are corrupt or can't be read
+        uint64_t corrupt{0};
+
+        /// \brief False if the structure of the file is corrupt, so some
+        /// messages might not have been found
+        bool intact{true};
+      };
+
       /// \brief Interface to a log file
       class GZ_TRANSPORT_LOG_VISIBLE Log
       {
@@ -51,7 +156,8 @@ namespace gz
         /// \param[in] _old the instance being moved into this one
         public: Log(Log &&_old);  // NOLINT
 
-        /// \brief destructor
+        /// \brief destructor. A log file opened for writing is closed after
+        /// its messages are indexed by topic, see LatestMessages.
         public: ~Log();
 
         /// \brief Indicate if a log has been successfully opened
@@ -72,6 +178,19 @@ namespace gz
         public: bool Open(const std::string &_file,
             std::ios_base::openmode _mode = std::ios_base::in);
 
+        /// \brief Open a log file with some tuning of its database.
+        /// \param[in] _file path to log file
+        /// \param[in] _mode flag indicating read only or read/write
+        ///   Can use (in or out)
+        /// \param[in] _options Tuning of the database. The journal and
+        /// synchronous modes only apply when writing, and the page size only
+        /// applies to new files.
+        /// \return True if the log file was successfully opened, false
+        /// otherwise.
+        /// \sa LogOptions
+        public: bool Open(const std::string &_file,
+            std::ios_base::openmode _mode, const LogOptions &_options);
+
         /// \brief Get the name of the log file.
         /// \return The name of the log file, or an empty string if Open has
         /// not been successfully called.
@@ -96,6 +215,55 @@ namespace gz
             const std::string &_topic, const std::string &_type,
             const void *_data, std::size_t _len);
 
+        /// \brief Insert several messages into the log file. The messages are
+        /// inserted by groups with a single statement, which is much faster
+        /// than inserting them one by one.
+        /// \param[in] _messages Messages to insert, in order
+        /// \return Number of messages inserted. Empty messages aren't
+        /// inserted.
+        public: std::size_t InsertMessages(
+            const std::vector<MessageRecord> &_messages);
+
+        /// \brief Function called once a message queued with
+        /// InsertMessageAsync() is inserted, or failed to be. It is called
+        /// from the writer thread, so it must not block.
+        /// \param[in] _success True if the message was inserted
+        public: using InsertCallback = std::function<void(bool _success)>;
+
+        /// \brief Insert a message into the log file from a background
+        /// thread. The message is copied into a queue and the queued
+        /// messages are inserted by groups, like InsertMessages(). The call
+        /// blocks while the queue holds LogOptions::AsyncQueueBytes() of
+        /// data. The other functions of the log must not be called while
+        /// messages are queued: call Flush() first.
+        /// \param[in] _time Time the message was received (ns since Unix epoch)
+        /// \param[in] _topic Name of the topic the message was on
+        /// \param[in] _type Name of the message type
+        /// \param[in] _data pointer to a buffer containing the message data
+        /// \param[in] _len number of bytes of data
+        /// \param[in] _callback Function called once the message is
+        /// inserted, or nullptr
+        /// \return Sequence number of the message, see Fence(), or 0 if the
+        /// log isn't open for writing. The numbers start at 1.
+        public: uint64_t InsertMessageAsync(
+            const std::chrono::nanoseconds &_time,
+            const std::string &_topic, const std::string &_type,
+            const void *_data, std::size_t _len,
+            const InsertCallback &_callback = nullptr);
+
+        /// \brief Wait until a message queued with InsertMessageAsync(), and
+        /// all the ones queued before it, are inserted. They might not be
+        /// committed yet.
+        /// \param[in] _seq Sequence number of the message
+        public: void Fence(const uint64_t _seq);
+
+        /// \brief Wait until all the messages queued with
+        /// InsertMessageAsync() are inserted, then commit them, so they are
+        /// on disk and the other functions of the log can be called.
+        /// \return True if all the messages queued since the previous Flush()
+        /// were inserted.
+        public: bool Flush();
+
         /// \brief Get messages according to the specified options. By default,
         /// it will query all messages over the entire time range of the log.
         /// \param[in] _options A QueryOptions type to indicate what kind of
@@ -104,6 +272,51 @@ namespace gz
         public: Batch QueryMessages(
             const QueryOptions &_options = AllTopics());
 
+        /// \brief Visit the messages matching the options with several
+        /// threads, e.g. to mine a whole log on all the cores. The time
+        /// range of the log is split in consecutive slices, each one read by
+        /// a thread from its own read-only connection. The options must
+        /// query every matching message, as the standard QueryOptions do;
+        /// a query limiting its results (e.g. LatestMessages) is applied to
+        /// each slice.
+        /// \param[in] _options A QueryOptions type to indicate what kind of
+        /// messages you would like to visit.
+        /// \param[in] _threads Number of threads, 0 for one per core.
+        /// \param[in] _callback Function called with every message. It is
+        /// called concurrently by the threads, each one in the order of its
+        /// slice. The message is only valid during the call.
+        /// \return False if the log is not valid or a thread could not open
+        /// it, e.g. it's an in-memory database that is not shared. The
+        /// messages of the other threads may have been visited.
+        public: bool ParallelScan(const QueryOptions &_options,
+            unsigned int _threads,
+            const std::function<void(const Message &_message)> &_callback)
+            const;
+
+        /// \brief Check the integrity of the log file: the structure of the
+        /// SQLite database, then every message with several threads. The
+        /// messages with a checksum (see LogOptions::SetMessageChecksums())
+        /// are compared with it, the compressed messages are decompressed.
+        /// The log must have been opened from a file.
+        /// \param[in] _threads Number of threads, 0 for one per core.
+        /// \param[out] _result What was found.
+        /// \return True if nothing is corrupt.
+        public: bool Verify(unsigned int _threads,
+            LogVerification &_result) const;
+
+        /// \brief Get the rate, the size and the gaps of the messages of
+        /// the topics and time range of a query, by topic. Only the times
+        /// and the sizes of the messages are read, not the messages: the
+        /// size of a message is the size of its row, which includes a
+        /// prefix in the log files of version 0.2.0 and is the size of a
+        /// reference to its block for a compressed topic (see
+        /// LogOptions::AddTopicCompression()).
+        /// \param[in] _options The query.
+        /// \return The statistics by topic name, without the topics that
+        /// have no message. Empty if the log is not valid.
+        public: std::map<std::string, TopicStatistics> Statistics(
+            const QueryOptions &_options = AllTopics()) const;
+
         /// \brief Get start time of the log, or in other words the
         /// time of the first message found in the log
         /// \return start time of the log, or zero if the log is not
@@ -116,6 +329,40 @@ namespace gz
         /// valid or if data retrieval failed.
         public: std::chrono::nanoseconds EndTime() const;
 
+        /// \brief Get the number, size and time range of the messages of
+        /// every topic. A log file stores them when it's closed after being
+        /// written, so they're read without visiting the messages; they're
+        /// only counted for the log files written by older versions.
+        /// StartTime() and EndTime() also use them.
+        /// \return The summary by topic name. Empty if the log is not valid.
+        public: std::map<std::string, TopicSummary> Summary() const;
+
+        /// \brief Store a key/value pair in the metadata of the log file,
+        /// e.g.: statistics of the recording. The metadata table is created
+        /// on demand, so the log stays readable by older tools.
+        /// \param[in] _key Name of the entry. An existing entry is replaced.
+        /// \param[in] _value Value of the entry.
+        /// \return True on success, false if the log is not valid or can't
+        /// be written.
+        public: bool SetMetadata(const std::string &_key,
+            const std::string &_value);
+
+        /// \brief Get the metadata of the log file.
+        /// \return The key/value pairs stored with SetMetadata(). Empty if
+        /// the log is not valid or has no metadata.
+        public: std::map<std::string, std::string> Metadata() const;
+
+        /// \brief Get the descriptors of a message type, captured by the
+        /// recording process when the type was first logged, so a generic
+        /// decoder can parse the messages without the type compiled in,
+        /// see MessageTypes::AddDescriptors().
+        /// \param[in] _type Fully qualified name of the message type.
+        /// \return A serialized google.protobuf.FileDescriptorSet, or an
+        /// empty string if the type wasn't known by the recording process
+        /// or the log is not valid.
+        public: std::string MessageTypeDescriptors(
+            const std::string &_type) const;
+
         /// \internal Implementation for this class
         private: class Implementation;
 
@@ -131,6 +378,40 @@ namespace gz
 #pragma warning(pop)
 #endif
       };
+
+      /// \brief Update the indexes of a SQLite log file created by an older
+      /// version, so the queries for some topics and LatestMessages don't
+      /// scan all the messages. The messages and the version of the log are
+      /// unchanged.
+      /// \param[in] _file Path to the log file.
+      /// \return True if the log file was reindexed.
+      GZ_TRANSPORT_LOG_VISIBLE
+      bool ReindexLog(const std::string &_file);
+
+      /// \brief Copy the messages of a SQLite log file received in a time
+      /// range to a new log file. The messages are copied as they are
+      /// stored, without decoding them, so cutting a large log is about as
+      /// fast as copying the part of the file kept.
+      /// \param[in] _src Path to the log file to cut.
+      /// \param[in] _dst Path to the new log file, which must not exist.
+      /// \param[in] _range Time range of the messages copied.
+      /// \return True if the messages were copied. The new log file might be
+      /// incomplete otherwise.
+      GZ_TRANSPORT_LOG_VISIBLE
+      bool CutLog(const std::string &_src, const std::string &_dst,
+                  const QualifiedTimeRange &_range);
+
+      /// \brief Copy the messages of several SQLite log files to a new log
+      /// file, like CutLog(). The topics with the same name and message type
+      /// are merged. The metadata of the first log file having a key is
+      /// kept.
+      /// \param[in] _srcs Paths to the log files to merge.
+      /// \param[in] _dst Path to the new log file, which must not exist.
+      /// \return True if the messages were copied. The new log file might be
+      /// incomplete otherwise.
+      GZ_TRANSPORT_LOG_VISIBLE
+      bool MergeLogs(const std::vector<std::string> &_srcs,
+                     const std::string &_dst);
       }
     }
   }
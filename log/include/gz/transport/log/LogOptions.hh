@@ -0,0 +1,388 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GZ_TRANSPORT_LOG_LOGOPTIONS_HH_
+#define GZ_TRANSPORT_LOG_LOGOPTIONS_HH_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <regex>
+#include <string>
+
+#include <gz/transport/AdvertiseOptions.hh>
+#include <gz/transport/config.hh>
+#include <gz/transport/log/Export.hh>
+
+namespace gz
+{
+  namespace transport
+  {
+    namespace log
+    {
+      // Inline bracket to help doxygen filtering.
+      inline namespace GZ_TRANSPORT_VERSION_NAMESPACE {
+      //
+      /// \brief How SQLite keeps the changes of a transaction until they're
+      /// written to the log file.
+      /// See https://www.sqlite.org/pragma.html#pragma_journal_mode
+      enum class JournalMode
+      {
+        /// \brief Keep the SQLite default (a rollback journal deleted at the
+        /// end of each transaction).
+        DEFAULT,
+
+        /// \brief Write-ahead log. The writes of a transaction are appended
+        /// to a separate file, which is much faster for a single writer
+        /// inserting many messages.
+        WAL,
+
+        /// \brief Keep the rollback journal in memory. A crash in the middle
+        /// of a transaction might corrupt the log file.
+        MEMORY,
+
+        /// \brief No rollback journal. A crash in the middle of a transaction
+        /// might corrupt the log file.
+        OFF
+      };
+
+      /// \brief How often SQLite waits for the data to reach the disk.
+      /// See https://www.sqlite.org/pragma.html#pragma_synchronous
+      enum class SyncMode
+      {
+        /// \brief Keep the SQLite default (FULL).
+        DEFAULT,
+
+        /// \brief Don't wait for the disk. A crash of the operating system or
+        /// a power loss might corrupt the log file.
+        OFF,
+
+        /// \brief Wait for the disk at the critical moments only. With the
+        /// WAL journal, a power loss might lose the last transactions, but
+        /// it doesn't corrupt the log file.
+        NORMAL,
+
+        /// \brief Wait for the disk at the end of every transaction.
+        FULL
+      };
+
+      /// \brief Format of a log file.
+      enum class LogFormat
+      {
+        /// \brief A SQLite database. Playback and the queries need it.
+        SQLITE,
+
+        /// \brief The append-only chunked format of ChunkedLog, faster to
+        /// record long and high bandwidth logs. Use ConvertLog() or
+        /// `gz log convert` to play them back.
+        CHUNKED
+      };
+
+      /// \brief Tuning of the SQLite database of a log file. The default
+      /// options keep the SQLite defaults, which favour durability over
+      /// throughput. HighThroughput() returns options suitable for recording
+      /// many high bandwidth topics, such as several camera streams.
+      ///
+      /// The durability trade-offs:
+      ///   - The messages of the ongoing transaction (see Log) are lost on a
+      ///     crash with any options.
+      ///   - JournalMode::WAL with SyncMode::NORMAL might lose the last
+      ///     transactions on a power loss, but it never corrupts the file.
+      ///   - SyncMode::OFF, JournalMode::MEMORY or JournalMode::OFF might
+      ///     corrupt the whole file on a crash of the operating system or a
+      ///     power loss.
+      class GZ_TRANSPORT_LOG_VISIBLE LogOptions
+      {
+        /// \brief Default constructor. All the options keep the SQLite
+        /// defaults.
+        public: LogOptions();
+
+        /// \brief Copy constructor.
+        /// \param[in] _other LogOptions to copy.
+        public: LogOptions(const LogOptions &_other);
+
+        /// \brief Destructor.
+        public: ~LogOptions();
+
+        /// \brief Assignment operator.
+        /// \param[in] _other The other LogOptions.
+        /// \return Reference to this LogOptions object.
+        public: LogOptions &operator=(const LogOptions &_other);
+
+        /// \brief Options for recording at a high rate: WAL journal with
+        /// SyncMode::NORMAL, 64 KiB pages, a 64 MiB cache, 256 MiB of
+        /// memory mapped I/O and transactions of up to 64 MiB.
+        /// \return The options.
+        public: static LogOptions HighThroughput();
+
+        /// \brief Get the journal mode.
+        /// \return The journal mode.
+        public: log::JournalMode JournalMode() const;
+
+        /// \brief Set the journal mode.
+        /// \param[in] _mode The journal mode.
+        public: void SetJournalMode(const log::JournalMode _mode);
+
+        /// \brief Get the synchronous mode.
+        /// \return The synchronous mode.
+        public: SyncMode Synchronous() const;
+
+        /// \brief Set the synchronous mode.
+        /// \param[in] _mode The synchronous mode.
+        public: void SetSynchronous(const SyncMode _mode);
+
+        /// \brief Get the size of the pages of the database.
+        /// \return Page size in bytes, 0 keeps the SQLite default.
+        public: uint32_t PageSize() const;
+
+        /// \brief Set the size of the pages of the database. It must be a
+        /// power of two between 512 and 65536. Only new log files use it.
+        /// \param[in] _size Page size in bytes, 0 keeps the SQLite default.
+        /// \return True if the size is valid or false otherwise.
+        public: bool SetPageSize(const uint32_t _size);
+
+        /// \brief Get the maximum size of the page cache.
+        /// \return Cache size in KiB, 0 keeps the SQLite default.
+        public: uint64_t CacheSize() const;
+
+        /// \brief Set the maximum size of the page cache.
+        /// \param[in] _size Cache size in KiB, 0 keeps the SQLite default.
+        public: void SetCacheSize(const uint64_t _size);
+
+        /// \brief Get the maximum size of the log file mapped in memory.
+        /// \return Size in bytes, 0 disables the memory mapped I/O.
+        public: uint64_t MmapSize() const;
+
+        /// \brief Set the maximum size of the log file mapped in memory.
+        /// SQLite might limit it further.
+        /// \param[in] _size Size in bytes, 0 disables the memory mapped I/O.
+        public: void SetMmapSize(const uint64_t _size);
+
+        /// \brief Get the maximum duration of a transaction.
+        /// \return The duration. The default is 500 ms.
+        public: std::chrono::milliseconds TransactionPeriod() const;
+
+        /// \brief Set the maximum duration of a transaction. The messages
+        /// are written to the disk when a transaction ends, so a longer
+        /// transaction is faster but a crash loses more messages.
+        /// \param[in] _period The duration.
+        public: void SetTransactionPeriod(
+            const std::chrono::milliseconds &_period);
+
+        /// \brief Get the maximum size of the messages inserted in a
+        /// transaction.
+        /// \return Size in bytes, 0 means no limit.
+        public: uint64_t MaxTransactionBytes() const;
+
+        /// \brief Set the maximum size of the messages inserted in a
+        /// transaction. A transaction ends when its duration or its size
+        /// reaches the limit, which bounds the time needed to commit it.
+        /// \param[in] _bytes Size in bytes, 0 means no limit.
+        public: void SetMaxTransactionBytes(const uint64_t _bytes);
+
+        /// \brief Get the maximum number of messages inserted in a
+        /// transaction.
+        /// \return Number of messages, 0 means no limit.
+        public: uint64_t MaxTransactionRows() const;
+
+        /// \brief Set the maximum number of messages inserted in a
+        /// transaction.
+        /// \param[in] _rows Number of messages, 0 means no limit.
+        public: void SetMaxTransactionRows(const uint64_t _rows);
+
+        /// \brief Get the size of the messages queued by
+        /// Log::InsertMessageAsync() after which it blocks.
+        /// \return Size in bytes, 0 means no limit. The default is 64 MiB.
+        public: uint64_t AsyncQueueBytes() const;
+
+        /// \brief Set the size of the messages queued by
+        /// Log::InsertMessageAsync() after which it blocks until the writer
+        /// thread catches up, which bounds the memory used.
+        /// \param[in] _bytes Size in bytes, 0 means no limit.
+        public: void SetAsyncQueueBytes(const uint64_t _bytes);
+
+        /// \brief Get the format of the log files created by a Recorder.
+        /// \return The format. The default is LogFormat::SQLITE.
+        public: LogFormat Format() const;
+
+        /// \brief Set the format of the log files created by a Recorder.
+        /// \param[in] _format The format.
+        public: void SetFormat(const LogFormat _format);
+
+        /// \brief Get the size of the chunks of a chunked log.
+        /// \return Size in bytes. The default is 4 MiB.
+        public: uint64_t ChunkSize() const;
+
+        /// \brief Set the size of the chunks of a chunked log. The messages
+        /// of a chunk are written to the disk when it's full, so bigger
+        /// chunks are faster but a crash loses more messages.
+        /// \param[in] _size Size in bytes. It must be between 1 KiB and
+        /// 1 GiB.
+        /// \return True if the size is valid or false otherwise.
+        public: bool SetChunkSize(const uint64_t _size);
+
+        /// \brief Get the codec used to compress the chunks of a chunked
+        /// log.
+        /// \return The codec. The default is Compression_t::NONE.
+        public: Compression_t ChunkCompression() const;
+
+        /// \brief Set the codec used to compress the chunks of a chunked
+        /// log. The codecs are optional dependencies of Gazebo Transport.
+        /// \param[in] _codec The codec.
+        /// \return True if the codec is available or false otherwise.
+        public: bool SetChunkCompression(const Compression_t _codec);
+
+        /// \brief Get the number of blocks of a chunked log written at the
+        /// same time.
+        /// \return Number of blocks, 0 for synchronous writes. The default
+        /// is 0.
+        public: uint32_t ChunkIoDepth() const;
+
+        /// \brief Write the chunks of a chunked log asynchronously, with
+        /// io_uring and O_DIRECT on Linux, so that the writer keeps several
+        /// MiB of I/O in flight without waiting for the disk or filling the
+        /// page cache. The chunks are split into blocks of 1 MiB. The
+        /// writes fall back to pwrite() when io_uring isn't available, and
+        /// to the page cache when the file system doesn't support O_DIRECT.
+        /// The errors of a write are reported by the next call, and
+        /// ChunkedLog::Flush() waits for every write in flight. It is
+        /// ignored on Windows.
+        /// \param[in] _depth Number of blocks, 0 for synchronous writes. It
+        /// must not be greater than 256.
+        /// \return True if the depth is valid or false otherwise.
+        public: bool SetChunkIoDepth(const uint32_t _depth);
+
+        /// \brief Compress the messages of the topics matching a pattern.
+        /// Consecutive messages of a topic are compressed together in blocks,
+        /// which compresses much better than each message on its own. The
+        /// messages are decompressed transparently when reading, but the log
+        /// file can't be read by versions of Gazebo Transport without this
+        /// feature. The first matching pattern gives the codec of a topic.
+        /// \param[in] _topics ECMAScript regular expression matching the
+        /// names of the topics.
+        /// \param[in] _codec The codec. Compression_t::NONE leaves the
+        /// matching topics uncompressed.
+        /// \return True if the codec is available or false otherwise.
+        public: bool AddTopicCompression(const std::regex &_topics,
+            const Compression_t _codec);
+
+        /// \brief Get the codec compressing the messages of a topic.
+        /// \param[in] _topic Name of the topic.
+        /// \return The codec of the first pattern matching _topic, or
+        /// Compression_t::NONE.
+        public: Compression_t TopicCompression(const std::string &_topic) const;
+
+        /// \brief Whether the messages of some topics are compressed.
+        /// \return True if AddTopicCompression() was called with a codec.
+        public: bool HasTopicCompression() const;
+
+        /// \brief Get the maximum size of a block of compressed messages.
+        /// \return Size in bytes before compression. The default is 1 MiB.
+        public: uint64_t CompressionBlockSize() const;
+
+        /// \brief Set the maximum size of a block of compressed messages. A
+        /// block is also written at the end of every transaction, so the
+        /// transactions bound the age of the messages kept in memory.
+        /// \param[in] _size Size in bytes before compression. It must be
+        /// between 1 KiB and 1 GiB.
+        /// \return True if the size is valid or false otherwise.
+        public: bool SetCompressionBlockSize(const uint64_t _size);
+
+        /// \brief Whether the CRC-32C of every message is stored in a SQLite
+        /// log file.
+        /// \return True if the messages are checked. The default is false.
+        public: bool MessageChecksums() const;
+
+        /// \brief Store the CRC-32C of every message in a SQLite log file,
+        /// computed with the CRC instructions of the CPU when it has them.
+        /// The messages are checked when they are read, and all at once by
+        /// VerifyLog(). Like the compressed topics, the log file can't be
+        /// read by versions of Gazebo Transport without this feature. The
+        /// chunks of a chunked log always have a checksum.
+        /// \param[in] _checksums True to store the checksums.
+        public: void SetMessageChecksums(const bool _checksums);
+
+        /// \brief Record the topics matching a pattern in a separate shard.
+        /// A Recorder writes every shard in its own file, with its own
+        /// writer thread, which scales the recording bandwidth with the
+        /// number of disks or the I/O parallelism of an NVMe drive. The
+        /// shards are listed in a shard set file (see ShardSet.hh) that
+        /// Playback opens as a single log. The topics that match no pattern
+        /// are recorded in the shard 0. The first matching pattern gives the
+        /// shard of a topic.
+        /// \param[in] _topics ECMAScript regular expression matching the
+        /// names of the topics.
+        public: void AddShard(const std::regex &_topics);
+
+        /// \brief Get the number of shards.
+        /// \return One plus the number of calls to AddShard(). A single
+        /// shard records a plain log file.
+        public: std::size_t ShardCount() const;
+
+        /// \brief Get the shard recording a topic.
+        /// \param[in] _topic Name of the topic.
+        /// \return Index of the shard, 0 if no pattern matches _topic.
+        public: std::size_t TopicShard(const std::string &_topic) const;
+
+        /// \brief Get the duration after which a Recorder rolls over to a
+        /// new log file.
+        /// \return The duration, 0 means no rotation by time.
+        public: std::chrono::milliseconds RotationPeriod() const;
+
+        /// \brief Set the duration after which a Recorder rolls over to a
+        /// new log file. The rotation happens between two writes, so no
+        /// message is lost, and the finished file is closed and can be
+        /// processed while the recording continues. With a rotation, the
+        /// files are listed in a shard set file (see ShardSet.hh) like the
+        /// shards, and each shard rolls over on its own.
+        /// \param[in] _period The duration, 0 means no rotation by time.
+        public: void SetRotationPeriod(
+            const std::chrono::milliseconds &_period);
+
+        /// \brief Get the size of the messages recorded in a log file after
+        /// which a Recorder rolls over to a new log file.
+        /// \return Size in bytes, 0 means no rotation by size.
+        public: uint64_t RotationBytes() const;
+
+        /// \brief Set the size of the messages recorded in a log file after
+        /// which a Recorder rolls over to a new log file, see
+        /// SetRotationPeriod(). The size of the file is slightly bigger
+        /// than the size of its messages.
+        /// \param[in] _bytes Size in bytes, 0 means no rotation by size.
+        public: void SetRotationBytes(const uint64_t _bytes);
+
+        /// \internal Implementation of this class
+        private: class Implementation;
+
+#ifdef _WIN32
+// Disable warning C4251 which is triggered by
+// std::*
+#pragma warning(push)
+#pragma warning(disable: 4251)
+#endif
+        /// \internal Pointer to the implementation of this class
+        private: std::unique_ptr<Implementation> dataPtr;
+#ifdef _WIN32
+#pragma warning(pop)
+#endif
+      };
+      }
+    }
+  }
+}
+#endif
@@ -20,6 +20,7 @@
 #include <chrono>
 #include <memory>
 #include <string>
+#include <string_view>
 
 #include <gz/transport/config.hh>
 #include <gz/transport/log/Export.hh>
@@ -35,6 +36,7 @@ namespace gz
       //
       /// \brief Forward Declarations
       class MessagePrivate;
+      class MsgIterPrivate;
 
       /// \brief Represents a message in a bag file.
       class GZ_TRANSPORT_LOG_VISIBLE Message
@@ -76,6 +78,11 @@ namespace gz
         /// \return The raw data for this message
         public: std::string Data() const;
 
+        /// \brief Get the message data without copying it.
+        /// \return A view of the raw data for this message. It's only valid
+        /// while this message is, i.e. until its MsgIter is advanced.
+        public: std::string_view DataView() const;
+
         /// \brief Get the message type as a string
         /// \return The message type name
         public: std::string Type() const;
@@ -88,6 +95,25 @@ namespace gz
         /// \return The time the message was received
         public: const std::chrono::nanoseconds &TimeReceived() const;
 
+        /// \brief Point this message to another message, so an iterator
+        /// reuses it instead of allocating one for every row.
+        /// \internal
+        /// \param[in] _timeRecv time the message was received
+        /// \param[in] _data the serialized message
+        /// \param[in] _dataLen number of bytes in _data
+        /// \param[in] _type the name of the message type
+        /// \param[in] _typeLen the length of _type
+        /// \param[in] _topic the name of the topic the message was published to
+        /// \param[in] _topicLen the length of _topic
+        private: void Reset(
+            const std::chrono::nanoseconds &_timeRecv,
+            const void *_data, std::size_t _dataLen,
+            const char *_type, std::size_t _typeLen,
+            const char *_topic, std::size_t _topicLen);
+
+        /// \brief MsgIterPrivate can reuse its message
+        friend class MsgIterPrivate;
+
 #ifdef _WIN32
 // Disable warning C4251 which is triggered by
 // std::*
@@ -18,12 +18,15 @@
 #define GZ_TRANSPORT_LOG_PLAYBACK_HH_
 
 #include <chrono>
+#include <cstddef>
 #include <memory>
 #include <regex>
 #include <string>
+#include <vector>
 
 #include <gz/transport/config.hh>
 #include <gz/transport/log/Export.hh>
+#include <gz/transport/log/QualifiedTime.hh>
 #include <gz/transport/NodeOptions.hh>
 
 namespace gz
@@ -47,11 +50,25 @@ namespace gz
       class GZ_TRANSPORT_LOG_VISIBLE Playback
       {
         /// \brief Constructor
-        /// \param[in] _file path to log file
+        /// \param[in] _file path to log file, or to the shard set file of a
+        /// sharded recording (see LogOptions::AddShard()). The messages of
+        /// the shards are played back together, in the order they were
+        /// received.
         /// \param[in] _nodeOptions Options for creating a node.
         public: explicit Playback(const std::string &_file,
                                const NodeOptions &_nodeOptions = NodeOptions());
 
+        /// \brief Constructor playing several logs together, e.g. recorded
+        /// simultaneously by several robots. Their messages are merged in
+        /// the order they were received and published on a single
+        /// timeline by one playback thread. The reception times come from
+        /// the clocks of the recorders, which must be synchronized.
+        /// \param[in] _files paths to the log files or shard set files. A
+        /// log file listed several times is played once.
+        /// \param[in] _nodeOptions Options for creating a node.
+        public: explicit Playback(const std::vector<std::string> &_files,
+                               const NodeOptions &_nodeOptions = NodeOptions());
+
         /// \brief move constructor
         /// \param[in] _old the instance being moved into this one
         public: Playback(Playback &&_old);  // NOLINT
@@ -136,6 +153,26 @@ namespace gz
         /// due to this function call.
         public: int64_t RemoveTopic(const std::regex &_topic);
 
+        /// \brief Load the messages of the topics selected so far into
+        /// memory, once. The playbacks started afterwards, and their seeks
+        /// and loops, read the messages from memory instead of the log
+        /// file, which makes repeated replays of the same recording free of
+        /// I/O. Adding or removing a topic discards the loaded messages.
+        /// \param[in] _range Time range of the messages to load
+        /// \return True if the messages were loaded, false if the log is not
+        /// valid.
+        public: bool Preload(const QualifiedTimeRange &_range =
+            QualifiedTimeRange::AllTime());
+
+        /// \brief Check whether the messages are loaded in memory.
+        /// \return True if Preload() succeeded and no topic was added or
+        /// removed since.
+        public: bool Preloaded() const;
+
+        /// \brief Get the size of the messages loaded in memory.
+        /// \return Size of the data of the messages (bytes), 0 if none.
+        public: std::size_t PreloadedBytes() const;
+
         /// \internal Implementation of this class
         private: class Implementation;
 
@@ -169,6 +206,15 @@ namespace gz
         /// \param[in] _newElapsedTime Elapsed time at which playback will jump
         public: void Seek(const std::chrono::nanoseconds &_newElapsedTime);
 
+        /// \brief Set the topics whose state is restored by Seek(): after
+        /// jumping, the last message of each of these topics received before
+        /// the new time is published again, e.g. a map or a static transform
+        /// published only once at the beginning of the recording.
+        /// \param[in] _topics ECMAScript regular expression matching the
+        /// names of the played back topics. std::regex("") disables it.
+        /// \return Number of played back topics matching the pattern.
+        public: std::size_t SetStateTopics(const std::regex &_topics);
+
         /// \brief Step the playback by a given amount of nanoseconds
         /// \pre Playback must be previously paused
         /// \param[in] _stepDuration Length of the step in nanoseconds
@@ -190,6 +236,58 @@ namespace gz
         /// \return true if all messages have finished playing; false otherwise.
         public: bool Finished() const;
 
+        /// \brief Set the speed of the playback, e.g. 10 to replay an hour
+        /// of recording in six minutes. The rate applies from the next
+        /// message.
+        /// \param[in] _rate Factor of the speed of the recording. It must be
+        /// positive. std::numeric_limits<double>::infinity() publishes the
+        /// messages as fast as possible, like Playback::Start() without
+        /// waiting between the messages.
+        /// \return True if the rate is valid or false otherwise.
+        public: bool SetRate(const double _rate);
+
+        /// \brief Get the speed of the playback.
+        /// \return Factor of the speed of the recording. The default is 1.
+        public: double Rate() const;
+
+        /// \brief Publish every message only after a subscriber
+        /// acknowledged the previous one by publishing any message on a
+        /// topic. Combined with an infinite rate, the messages are played
+        /// back as fast as the subscriber can process them.
+        /// \param[in] _ackTopic Topic of the acknowledgments. An empty topic
+        /// disables the lockstep.
+        /// \param[in] _timeout Maximum time to wait for an acknowledgment.
+        /// The next message is published anyway after it.
+        /// \return True if the topic could be subscribed to.
+        public: bool SetLockstep(const std::string &_ackTopic,
+            const std::chrono::nanoseconds &_timeout =
+              std::chrono::seconds(1));
+
+        /// \brief Publish every topic from its own thread. The messages are
+        /// still due at the same times, but publishing a large message, e.g.
+        /// a point cloud, no longer delays the messages of the other topics.
+        /// The messages of a topic are published in order; a topic that can't
+        /// keep up lags behind without slowing down the others.
+        /// \param[in] _parallel True to publish the topics in parallel,
+        /// false to publish all of them from the playback thread (default).
+        public: void SetParallelPublishing(const bool _parallel);
+
+        /// \brief Check whether the topics are published in parallel.
+        /// \return True if every topic is published from its own thread.
+        public: bool ParallelPublishing() const;
+
+        /// \brief Start over from the first message once the last one is
+        /// published, until the playback is stopped. A looping playback
+        /// only finishes when it is stopped. Combined with
+        /// Playback::Preload(), the loops don't read the log file.
+        /// \param[in] _loop True to loop, false to finish after the last
+        /// message (default).
+        public: void SetLoop(const bool _loop);
+
+        /// \brief Check whether the playback loops.
+        /// \return True if the playback starts over after the last message.
+        public: bool Loop() const;
+
         /// \brief Gets start time of the log being played
         /// \return start time of the log, in nanoseconds
         public: std::chrono::nanoseconds StartTime() const;
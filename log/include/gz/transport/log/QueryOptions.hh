@@ -18,6 +18,7 @@
 #ifndef GZ_TRANSPORT_LOG_QUERYOPTIONS_HH_
 #define GZ_TRANSPORT_LOG_QUERYOPTIONS_HH_
 
+#include <chrono>
 #include <memory>
 #include <regex>
 #include <set>
@@ -104,7 +105,22 @@ namespace gz
         /// for.
         public: const QualifiedTimeRange &TimeRange() const;
 
-        /// \brief Generate a SQL string to represent the time conditions.
+        /// \brief Only query the first message of every topic in every
+        /// interval of time, e.g. to show the messages of a long range at a
+        /// lower rate. The intervals begin at the multiples of _interval
+        /// since the epoch. The messages that are skipped are not read.
+        /// \param[in] _interval Duration of the intervals, 0 (the default)
+        /// to query every message.
+        public: void SetSampleInterval(
+            const std::chrono::nanoseconds &_interval);
+
+        /// \brief Duration of the intervals of the sampling, see
+        /// SetSampleInterval().
+        /// \return The duration, 0 if every message is queried.
+        public: std::chrono::nanoseconds SampleInterval() const;
+
+        /// \brief Generate a SQL string to represent the time conditions:
+        /// the time range and the sampling.
         /// This should be appended to a SQL statement after a WHERE keyword.
         /// \return A partial SqlStatement that specifies the time conditions
         /// that this TimeRangeOption has been set with.
@@ -287,6 +303,66 @@ namespace gz
         /// \internal Implementation of this class
         private: class Implementation;
 
+#ifdef _WIN32
+// Disable warning C4251 which is triggered by
+// std::*
+#pragma warning(push)
+#pragma warning(disable: 4251)
+#endif
+        /// \internal Pointer to the implementation
+        private: std::unique_ptr<Implementation> dataPtr;
+#ifdef _WIN32
+#pragma warning(pop)
+#endif
+      };
+
+      //////////////////////////////////////////////////
+      /// \brief Query for the last message of each topic of a list within a
+      /// time range, e.g. to restore the state published on these topics at
+      /// the end of the range. Each topic yields at most one message (one by
+      /// message type), in the order of the topics. A log written by this
+      /// version indexes its messages by topic and time when it's closed, so
+      /// each topic is found in O(log n).
+      class GZ_TRANSPORT_LOG_VISIBLE LatestMessages final
+          : public virtual QueryOptions,
+            public virtual TimeRangeOption
+      {
+        /// \brief Query for the last message of each topic received within
+        /// the specified time range (by default, all time).
+        /// \param[in] _topics The topics to include
+        /// \param[in] _timeRange The time range to query over
+        public: explicit LatestMessages(
+          const std::set<std::string> &_topics,
+          const QualifiedTimeRange &_timeRange = QualifiedTimeRange::AllTime());
+
+        /// \brief Copy constructor
+        /// \param[in] _other Another LatestMessages
+        public: LatestMessages(const LatestMessages &_other);
+
+        /// \brief Move constructor
+        /// \param[in] _other Another LatestMessages
+        public: LatestMessages(LatestMessages &&_other);  // NOLINT
+
+        /// \brief Topics of this LatestMessages
+        /// \return A mutable reference to the topics that this option should
+        /// query for.
+        public: std::set<std::string> &Topics();
+
+        /// \brief Topics of this LatestMessages
+        /// \return A const reference to the topics that this option should
+        /// query for.
+        public: const std::set<std::string> &Topics() const;
+
+        // Documentation inherited
+        public: std::vector<SqlStatement> GenerateStatements(
+          const Descriptor &_descriptor) const override;
+
+        /// \brief Destructor
+        public: ~LatestMessages();
+
+        /// \internal Implementation of this class
+        private: class Implementation;
+
 #ifdef _WIN32
 // Disable warning C4251 which is triggered by
 // std::*
@@ -17,7 +17,11 @@
 #ifndef GZ_TRANSPORT_LOG_RECORDER_HH_
 #define GZ_TRANSPORT_LOG_RECORDER_HH_
 
+#include <array>
+#include <chrono>
 #include <cstdint>
+#include <functional>
+#include <map>
 #include <memory>
 #include <regex>
 #include <set>
@@ -26,6 +30,7 @@
 #include <gz/transport/Clock.hh>
 #include <gz/transport/config.hh>
 #include <gz/transport/log/Export.hh>
+#include <gz/transport/log/LogOptions.hh>
 
 namespace gz
 {
@@ -45,12 +50,66 @@ namespace gz
         INVALID_TOPIC = -4,
         TOPIC_NOT_FOUND = -5,
         ALREADY_SUBSCRIBED_TO_TOPIC = -6,
+        INVALID_PARTITION = -7,
+      };
+
+      /// \brief Counters of a recording, see Recorder::Statistics(). They
+      /// are reset when the recording starts.
+      struct RecorderStatistics
+      {
+        /// \brief Number of messages received
+        uint64_t receivedMessages{0};
+
+        /// \brief Size (in bytes) of the messages received
+        uint64_t receivedBytes{0};
+
+        /// \brief Number of messages written to the log files
+        uint64_t writtenMessages{0};
+
+        /// \brief Size (in bytes) of the messages written to the log files
+        uint64_t writtenBytes{0};
+
+        /// \brief Number of messages dropped because the buffer was full,
+        /// see Recorder::DroppedMessages()
+        uint64_t droppedMessages{0};
+
+        /// \brief Size (in bytes) of the messages dropped
+        uint64_t droppedBytes{0};
+
+        /// \brief Number of messages waiting in the buffer
+        uint64_t queuedMessages{0};
+
+        /// \brief Size (in bytes) of the messages waiting in the buffer
+        uint64_t queuedBytes{0};
+
+        /// \brief Largest size (in bytes) of the messages waiting in the
+        /// buffer
+        uint64_t maxQueuedBytes{0};
+
+        /// \brief Number of batches of messages taken from the buffer and
+        /// written to the log files
+        uint64_t writes{0};
+
+        /// \brief Total duration of the writes
+        std::chrono::nanoseconds writeDuration{0};
+
+        /// \brief Longest write
+        std::chrono::nanoseconds maxWriteDuration{0};
+
+        /// \brief Histogram of the durations of the writes. The element i
+        /// counts the writes that took less than 2^i microseconds, but not
+        /// less than 2^(i-1), and the last one also counts the longer ones.
+        std::array<uint64_t, 24> writeDurationHistogram{};
       };
 
       /// \brief Records Gazebo Transport topics
       /// This class makes it easy to record topics to a log file.
       /// Responsibilities: topic name matching, time received tracking,
       /// multiple thread safety, subscribing to topics
+      ///
+      /// The messages published by the process of the recorder are queued
+      /// on the publishing thread with the buffer serialized by the
+      /// publisher, see SubscribeOptions::SetTap().
       class GZ_TRANSPORT_LOG_VISIBLE Recorder
       {
         /// \brief Default constructor
@@ -71,12 +130,47 @@ namespace gz
         /// \remarks Clock lifetime must exceed that of this Recorder.
         public: RecorderError Sync(const Clock *_clockIn);
 
+        /// \brief Stamp the messages with a time of the clock cached every
+        /// _resolution, in the time of the clock, instead of reading the
+        /// clock for every message. The stamp of a message may then be up to
+        /// _resolution before it was received, and the messages received
+        /// during a period share a stamp; they are still recorded in order.
+        /// It saves a read of the clock per message at high rates.
+        /// \param[in] _resolution Period of the updates of the time, 0 (the
+        /// default) to read the clock for every message.
+        /// \return SUCCESS if the resolution was changed,
+        /// ALREADY_RECORDING if a recording is already in progress.
+        public: RecorderError SetTimestampResolution(
+            const std::chrono::nanoseconds &_resolution);
+
+        /// \brief Resolution of the timestamps, see
+        /// SetTimestampResolution().
+        /// \return The resolution, 0 if the clock is read for every message.
+        public: std::chrono::nanoseconds TimestampResolution() const;
+
         /// \brief Begin recording topics
         /// \param[in] _file path to log file
         /// \return NO_ERROR if recording was successfully started. If the file
         /// already existed, this will return FAILED_TO_OPEN.
         public: RecorderError Start(const std::string &_file);
 
+        /// \brief Begin recording topics with some tuning of the database of
+        /// the log file.
+        /// \param[in] _file path to log file
+        /// \param[in] _options Tuning of the database, e.g.:
+        /// LogOptions::HighThroughput() when recording many high bandwidth
+        /// topics. LogFormat::CHUNKED records a ChunkedLog instead, and
+        /// LogOptions::AddTopicCompression() compresses the messages of some
+        /// topics. With LogOptions::AddShard(), the topics are recorded in
+        /// several files written in parallel, and _file is the shard set
+        /// file listing them (see ShardSet.hh). The shard set file also
+        /// lists the files created by a rotation, see
+        /// LogOptions::SetRotationPeriod().
+        /// \return NO_ERROR if recording was successfully started. If the file
+        /// already existed, this will return FAILED_TO_OPEN.
+        public: RecorderError Start(const std::string &_file,
+                                    const LogOptions &_options);
+
         /// \brief Stop recording topics. This function will block if there is
         /// any data in the internal buffer that has not yet been written to
         /// disk.
@@ -98,6 +192,20 @@ namespace gz
         /// \return number of topics subscribed or negative number on error
         public: int64_t AddTopic(const std::regex &_topic);
 
+        /// \brief Also record the topics of another partition. The topics
+        /// added with AddTopic() are recorded in every partition, through
+        /// the same discovery and the same log file. The topics of the
+        /// partition of the recorder keep their names, the others are
+        /// recorded with their fully qualified name, e.g. "@/robot2@/pose",
+        /// which Playback publishes back in their partition.
+        /// \param[in] _partition The name of the partition
+        /// \note The topic priorities (AddTopicPriority()) and LogOptions
+        /// match the fully qualified names of the topics of the partition.
+        /// \return SUCCESS if the partition is recorded, INVALID_PARTITION
+        /// if the name isn't valid or FAILED_TO_SUBSCRIBE if a topic already
+        /// added couldn't be subscribed in the partition.
+        public: RecorderError AddPartition(const std::string &_partition);
+
         /// \brief Get the name of the log file.
         /// \return The name of the log file, or an empty string if Start has
         /// not been successfully called.
@@ -105,7 +213,8 @@ namespace gz
 
         /// \brief Get the set of topics have have been added.
         /// \return The set of topic names that have been added using the
-        /// AddTopic functions.
+        /// AddTopic functions. The topics of the partitions added with
+        /// AddPartition() have their fully qualified name.
         public: const std::set<std::string> &Topics() const;
 
         /// \brief Get the buffer size of the queue that is used to store data
@@ -116,10 +225,58 @@ namespace gz
         /// \brief Set the maximum size (in MB) of the buffer that is used to
         /// store data from topic callbacks. When the buffer reaches this size,
         /// the recorder will start dropping older messages to make room for new
-        /// ones.
+        /// ones, see AddTopicPriority(). The messages buffered also count
+        /// towards the memory cap of the transport, which drops them the same
+        /// way (see NodeShared::SetMemoryCap()).
         /// \param[in] _size Buffer size in MB
         public: void SetBufferSize(std::size_t _size);
 
+        /// \brief Set the priority of the messages of the topics matching a
+        /// pattern in the buffer. When the buffer is full, the oldest message
+        /// of the lowest priority is dropped to make room for a new one. A
+        /// new message is dropped instead if only messages with a higher
+        /// priority are buffered, so a burst of camera images can't evict
+        /// the messages of a critical topic such as /clock. The first
+        /// matching pattern gives the priority of a topic, the topics that
+        /// match no pattern have the priority 0.
+        /// \param[in] _topics ECMAScript regular expression matching the
+        /// names of the topics.
+        /// \param[in] _priority Priority of the topics. The messages with a
+        /// higher priority are kept longer.
+        /// \param[in] _quota Maximum size (in bytes) of the messages of each
+        /// matching topic in the buffer. When it's reached, the oldest
+        /// message of the topic is dropped even if the buffer isn't full.
+        /// 0 means no quota.
+        public: void AddTopicPriority(const std::regex &_topics,
+                                      const int _priority,
+                                      const std::size_t _quota = 0);
+
+        /// \brief Get the number of messages dropped from the buffer, by
+        /// topic, since the recording started. When the recording stops, the
+        /// counters are also stored in the metadata of a SQLite log file
+        /// (see Log::Metadata()): "dropped_messages" is the total number of
+        /// messages dropped, and "dropped_messages:<topic>" and
+        /// "dropped_bytes:<topic>" are set for every topic with dropped
+        /// messages.
+        /// \return Number of messages dropped by topic name. The topics
+        /// without dropped messages are omitted.
+        public: std::map<std::string, uint64_t> DroppedMessages() const;
+
+        /// \brief Set a function called when a log file is finished: after
+        /// a rotation (see LogOptions::SetRotationPeriod()) and for the last
+        /// files when the recording stops. The file is closed and can be
+        /// processed, moved or uploaded while the recording continues.
+        /// \param[in] _callback The function, called with the path of the
+        /// log file from the thread writing the messages, so it shouldn't
+        /// block. nullptr removes it.
+        public: void SetFileFinishedCallback(
+            const std::function<void(const std::string &_file)> &_callback);
+
+        /// \brief Get the counters of the recording, to find out where the
+        /// time goes when the recorder can't keep up.
+        /// \return The counters since the recording started.
+        public: RecorderStatistics Statistics() const;
+
         /// \internal Implementation of this class
         private: class Implementation;
 
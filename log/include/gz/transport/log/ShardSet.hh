@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GZ_TRANSPORT_LOG_SHARDSET_HH_
+#define GZ_TRANSPORT_LOG_SHARDSET_HH_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <gz/transport/config.hh>
+#include <gz/transport/log/Export.hh>
+
+namespace gz
+{
+  namespace transport
+  {
+    namespace log
+    {
+      // Inline bracket to help doxygen filtering.
+      inline namespace GZ_TRANSPORT_VERSION_NAMESPACE {
+      //
+      /// \brief A shard set file lists the log files (shards) recorded
+      /// together by a Recorder, see LogOptions::AddShard(). Playback opens
+      /// it as a single log. It is a text file: the first line is
+      /// "gz-transport-log-shards 1", followed by the path of every shard,
+      /// one per line, relative to the directory of the shard set file.
+
+      /// \brief Check if a file is a shard set file.
+      /// \param[in] _file Path to the file.
+      /// \return True if the file starts like a shard set file.
+      GZ_TRANSPORT_LOG_VISIBLE
+      bool IsShardSet(const std::string &_file);
+
+      /// \brief Read the shards of a shard set file.
+      /// \param[in] _file Path to the shard set file.
+      /// \param[out] _shards Path to every shard, relative to the current
+      /// directory.
+      /// \return False if the file can't be read or isn't a shard set file.
+      GZ_TRANSPORT_LOG_VISIBLE
+      bool ReadShardSet(const std::string &_file,
+          std::vector<std::string> &_shards);
+
+      /// \brief Write a shard set file. The file is replaced atomically, so
+      /// a reader never sees a partial list of shards.
+      /// \param[in] _file Path to the shard set file.
+      /// \param[in] _shards Path to every shard. They must be in the
+      /// directory of _file or in one of its subdirectories.
+      /// \return True on success.
+      GZ_TRANSPORT_LOG_VISIBLE
+      bool WriteShardSet(const std::string &_file,
+          const std::vector<std::string> &_shards);
+
+      /// \brief Get the path of a shard recorded by a Recorder: the index
+      /// of the shard is inserted before the extension of _file, e.g.
+      /// "run.1.tlog" for the shard 1 of "run.tlog".
+      /// \param[in] _file Path to the shard set file.
+      /// \param[in] _index Index of the shard.
+      /// \return The path of the shard.
+      GZ_TRANSPORT_LOG_VISIBLE
+      std::string ShardFilename(const std::string &_file,
+          const std::size_t _index);
+      }
+    }
+  }
+}
+#endif
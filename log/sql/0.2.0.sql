@@ -0,0 +1,40 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+/* Migrates a database from 0.1.0 to 0.2.0, which adds compressed messages.
+ *
+ * The first byte of messages.message tells how the message is stored:
+ *   0: the serialized message follows.
+ *   1: the message is in a block of message_blocks. The id of the block
+ *      (int64) and the index of the message in the block (uint32) follow,
+ *      in little endian.
+ *   2: like 0, preceded by the CRC-32C of the message (uint32).
+ *   3: like 1, followed by the CRC-32C of the message (uint32).
+ */
+
+/* Contains consecutive messages of a topic, compressed together */
+CREATE TABLE message_blocks (
+  /* Uniquely identifies a row in this table. Sqlite3 will make it an alias of rowid. */
+  id INTEGER PRIMARY KEY AUTOINCREMENT,
+  /* Codec of the block: 1 for LZ4, 2 for Zstandard */
+  codec INTEGER NOT NULL,
+  /* The compressed block. Once decompressed: the number of messages (uint32),
+     the size of each message (uint32) and the messages, in little endian. */
+  data BLOB NOT NULL
+);
+
+INSERT INTO migrations (from_version, to_version) VALUES ('0.1.0', '0.2.0');
@@ -0,0 +1,644 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef _WIN32
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/syscall.h>
+  #include <unistd.h>
+#endif
+
+#if defined(__linux__) && defined(__NR_io_uring_setup) && \
+    __has_include(<linux/io_uring.h>)
+  #include <linux/io_uring.h>
+  #define HAVE_IO_URING
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "AsyncFileWriter.hh"
+#include "Console.hh"
+
+using namespace gz::transport;
+using namespace gz::transport::log;
+
+/// \brief Alignment of the offsets, sizes and buffers of O_DIRECT writes.
+static const std::size_t kDirectAlignment = 4096;
+
+//////////////////////////////////////////////////
+class gz::transport::log::AsyncFileWriter::Implementation
+{
+  /// \brief A block of data being filled or written.
+  public: struct Block
+  {
+    /// \brief Data, aligned for O_DIRECT.
+    char *data = nullptr;
+
+    /// \brief Offset of the block in the file.
+    uint64_t offset = 0;
+
+    /// \brief Bytes of data in the block.
+    std::size_t fill = 0;
+
+    /// \brief Bytes submitted, including the padding.
+    std::size_t length = 0;
+
+    /// \brief Bytes written so far.
+    std::size_t written = 0;
+
+    /// \brief True while the block is written.
+    bool busy = false;
+  };
+
+  /// \brief Set up the io_uring instance.
+  /// \param[in] _entries Number of writes in flight.
+  /// \return True on success.
+  public: bool SetupRing(const unsigned int _entries);
+
+  /// \brief Release the io_uring instance.
+  public: void TeardownRing();
+
+  /// \brief Write the first bytes of a block, or submit the write.
+  /// \param[in] _block Index of the block.
+  /// \param[in] _offset First byte to write in the block.
+  /// \return False on failure.
+  public: bool Submit(const std::size_t _block, const std::size_t _offset);
+
+  /// \brief Process the completed writes. A failed write sets failed.
+  /// \param[in] _wait Wait for at least one completion.
+  /// \return False if it was not possible to wait.
+  public: bool Reap(const bool _wait);
+
+  /// \brief Wait until no write is in flight.
+  /// \return False on failure.
+  public: bool Drain();
+
+  /// \brief Get a block that isn't written, other than the current one.
+  /// \return Index of the block or blocks.size() on failure.
+  public: std::size_t FreeBlock();
+
+  /// \brief File descriptor, -1 if closed.
+  public: int fd = -1;
+
+  /// \brief Whether the file was opened with O_DIRECT.
+  public: bool direct = false;
+
+  /// \brief Alignment of the writes: kDirectAlignment with O_DIRECT, 1
+  /// otherwise.
+  public: std::size_t alignment = 1;
+
+  /// \brief Blocks of data.
+  public: std::vector<Block> blocks;
+
+  /// \brief Index of the block being filled.
+  public: std::size_t current = 0;
+
+  /// \brief Number of blocks in flight.
+  public: unsigned int inflight = 0;
+
+  /// \brief True once a write failed.
+  public: bool failed = false;
+
+  /// \brief Path to the file.
+  public: std::string filename;
+
+#ifdef HAVE_IO_URING
+  /// \brief io_uring file descriptor, -1 without io_uring.
+  public: int ringFd = -1;
+
+  /// \brief Mapping of the submission queue.
+  public: void *sqRing = nullptr;
+
+  /// \brief Size of the mapping of the submission queue.
+  public: std::size_t sqRingSize = 0;
+
+  /// \brief Mapping of the completion queue. It may be sqRing.
+  public: void *cqRing = nullptr;
+
+  /// \brief Size of the mapping of the completion queue.
+  public: std::size_t cqRingSize = 0;
+
+  /// \brief Submission queue entries.
+  public: io_uring_sqe *sqes = nullptr;
+
+  /// \brief Number of submission queue entries.
+  public: unsigned int sqEntries = 0;
+
+  /// \brief Tail of the submission queue.
+  public: unsigned int *sqTail = nullptr;
+
+  /// \brief Mask of the submission queue indexes.
+  public: unsigned int sqMask = 0;
+
+  /// \brief Array of the submission queue, indexes of the entries.
+  public: unsigned int *sqArray = nullptr;
+
+  /// \brief Head of the completion queue.
+  public: unsigned int *cqHead = nullptr;
+
+  /// \brief Tail of the completion queue.
+  public: unsigned int *cqTail = nullptr;
+
+  /// \brief Mask of the completion queue indexes.
+  public: unsigned int cqMask = 0;
+
+  /// \brief Completion queue entries.
+  public: io_uring_cqe *cqes = nullptr;
+#endif
+};
+
+#ifdef HAVE_IO_URING
+//////////////////////////////////////////////////
+bool AsyncFileWriter::Implementation::SetupRing(const unsigned int _entries)
+{
+  io_uring_params params;
+  std::memset(&params, 0, sizeof(params));
+  const int ring = static_cast<int>(
+    syscall(__NR_io_uring_setup, _entries, &params));
+  if (ring < 0)
+    return false;
+
+  this->ringFd = ring;
+  this->sqRingSize = params.sq_off.array +
+    params.sq_entries * sizeof(unsigned int);
+  this->cqRingSize = params.cq_off.cqes +
+    params.cq_entries * sizeof(io_uring_cqe);
+  const bool singleMmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+  if (singleMmap)
+  {
+    this->sqRingSize = std::max(this->sqRingSize, this->cqRingSize);
+    this->cqRingSize = this->sqRingSize;
+  }
+
+  void *sq = mmap(nullptr, this->sqRingSize, PROT_READ | PROT_WRITE,
+    MAP_SHARED | MAP_POPULATE, ring, IORING_OFF_SQ_RING);
+  if (sq == MAP_FAILED)
+  {
+    this->TeardownRing();
+    return false;
+  }
+  this->sqRing = sq;
+
+  void *cq = sq;
+  if (!singleMmap)
+  {
+    cq = mmap(nullptr, this->cqRingSize, PROT_READ | PROT_WRITE,
+      MAP_SHARED | MAP_POPULATE, ring, IORING_OFF_CQ_RING);
+    if (cq == MAP_FAILED)
+    {
+      this->TeardownRing();
+      return false;
+    }
+  }
+  this->cqRing = cq;
+
+  this->sqEntries = params.sq_entries;
+  void *sqes = mmap(nullptr, params.sq_entries * sizeof(io_uring_sqe),
+    PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring,
+    IORING_OFF_SQES);
+  if (sqes == MAP_FAILED)
+  {
+    this->TeardownRing();
+    return false;
+  }
+  this->sqes = static_cast<io_uring_sqe *>(sqes);
+
+  char *sqBase = static_cast<char *>(sq);
+  char *cqBase = static_cast<char *>(cq);
+  this->sqTail = reinterpret_cast<unsigned int *>(sqBase + params.sq_off.tail);
+  this->sqMask =
+    *reinterpret_cast<unsigned int *>(sqBase + params.sq_off.ring_mask);
+  this->sqArray =
+    reinterpret_cast<unsigned int *>(sqBase + params.sq_off.array);
+  this->cqHead = reinterpret_cast<unsigned int *>(cqBase + params.cq_off.head);
+  this->cqTail = reinterpret_cast<unsigned int *>(cqBase + params.cq_off.tail);
+  this->cqMask =
+    *reinterpret_cast<unsigned int *>(cqBase + params.cq_off.ring_mask);
+  this->cqes = reinterpret_cast<io_uring_cqe *>(cqBase + params.cq_off.cqes);
+  return true;
+}
+
+//////////////////////////////////////////////////
+void AsyncFileWriter::Implementation::TeardownRing()
+{
+  if (this->sqes)
+    munmap(this->sqes, this->sqEntries * sizeof(io_uring_sqe));
+  if (this->cqRing && this->cqRing != this->sqRing)
+    munmap(this->cqRing, this->cqRingSize);
+  if (this->sqRing)
+    munmap(this->sqRing, this->sqRingSize);
+  if (this->ringFd >= 0)
+    close(this->ringFd);
+
+  this->sqes = nullptr;
+  this->cqRing = nullptr;
+  this->sqRing = nullptr;
+  this->ringFd = -1;
+}
+#else
+//////////////////////////////////////////////////
+bool AsyncFileWriter::Implementation::SetupRing(const unsigned int)
+{
+  return false;
+}
+
+//////////////////////////////////////////////////
+void AsyncFileWriter::Implementation::TeardownRing()
+{
+}
+#endif
+
+//////////////////////////////////////////////////
+bool AsyncFileWriter::Implementation::Submit(const std::size_t _block,
+    const std::size_t _offset)
+{
+  Block &block = this->blocks[_block];
+#ifdef HAVE_IO_URING
+  if (this->ringFd >= 0)
+  {
+    // The kernel has consumed the previous entries when io_uring_enter()
+    // returned, and a block has one write in flight at most, so there is
+    // always a free entry.
+    const unsigned int tail = *this->sqTail;
+    const unsigned int index = tail & this->sqMask;
+    io_uring_sqe &sqe = this->sqes[index];
+    std::memset(&sqe, 0, sizeof(sqe));
+    sqe.opcode = IORING_OP_WRITE;
+    sqe.fd = this->fd;
+    sqe.addr = reinterpret_cast<uint64_t>(block.data + _offset);
+    sqe.len = static_cast<uint32_t>(block.length - _offset);
+    sqe.off = block.offset + _offset;
+    sqe.user_data = _block;
+    this->sqArray[index] = index;
+    __atomic_store_n(this->sqTail, tail + 1, __ATOMIC_RELEASE);
+
+    while (syscall(__NR_io_uring_enter, this->ringFd, 1, 0, 0, nullptr, 0) < 0)
+    {
+      if (errno != EINTR)
+      {
+        LERR("Unable to submit a write to [" << this->filename << "]: "
+             << std::strerror(errno) << "\n");
+        this->failed = true;
+        return false;
+      }
+    }
+
+    if (!block.busy)
+    {
+      block.busy = true;
+      ++this->inflight;
+    }
+    return true;
+  }
+#endif
+
+#ifndef _WIN32
+  for (std::size_t done = _offset; done < block.length;)
+  {
+    const ssize_t written = pwrite(this->fd, block.data + done,
+      block.length - done, static_cast<off_t>(block.offset + done));
+    if (written < 0 && errno == EINTR)
+      continue;
+    if (written <= 0)
+    {
+      LERR("Unable to write to [" << this->filename << "]: "
+           << std::strerror(errno) << "\n");
+      this->failed = true;
+      return false;
+    }
+    done += static_cast<std::size_t>(written);
+  }
+#endif
+  block.written = block.length;
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool AsyncFileWriter::Implementation::Reap(const bool _wait)
+{
+#ifdef HAVE_IO_URING
+  if (this->ringFd < 0 || this->inflight == 0)
+    return true;
+
+  if (_wait)
+  {
+    while (syscall(__NR_io_uring_enter, this->ringFd, 0, 1,
+             IORING_ENTER_GETEVENTS, nullptr, 0) < 0)
+    {
+      if (errno != EINTR)
+      {
+        LERR("Unable to wait for the writes to [" << this->filename
+             << "]: " << std::strerror(errno) << "\n");
+        this->failed = true;
+        return false;
+      }
+    }
+  }
+
+  unsigned int head = *this->cqHead;
+  const unsigned int tail = __atomic_load_n(this->cqTail, __ATOMIC_ACQUIRE);
+  for (; head != tail; ++head)
+  {
+    const io_uring_cqe &cqe = this->cqes[head & this->cqMask];
+    const std::size_t index = static_cast<std::size_t>(cqe.user_data);
+    Block &block = this->blocks[index];
+    if (cqe.res <= 0)
+    {
+      LERR("Unable to write to [" << this->filename << "]: "
+           << std::strerror(cqe.res < 0 ? -cqe.res : EIO) << "\n");
+      this->failed = true;
+      block.busy = false;
+      --this->inflight;
+      continue;
+    }
+
+    // A short write is resubmitted from where it stopped.
+    block.written += static_cast<std::size_t>(cqe.res);
+    if (block.written < block.length && !this->failed)
+    {
+      __atomic_store_n(this->cqHead, head + 1, __ATOMIC_RELEASE);
+      if (this->Submit(index, block.written))
+        continue;
+    }
+    block.busy = false;
+    --this->inflight;
+  }
+  __atomic_store_n(this->cqHead, head, __ATOMIC_RELEASE);
+#else
+  (void)_wait;
+#endif
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool AsyncFileWriter::Implementation::Drain()
+{
+  // The writes in flight use the blocks, wait for them even after a
+  // failure.
+  while (this->inflight > 0 && this->Reap(true))
+  {
+  }
+  return !this->failed;
+}
+
+//////////////////////////////////////////////////
+std::size_t AsyncFileWriter::Implementation::FreeBlock()
+{
+  while (true)
+  {
+    for (std::size_t i = 0; i < this->blocks.size(); ++i)
+    {
+      if (i != this->current && !this->blocks[i].busy)
+        return i;
+    }
+
+    if (this->inflight == 0 || !this->Reap(true))
+      return this->blocks.size();
+  }
+}
+
+//////////////////////////////////////////////////
+AsyncFileWriter::AsyncFileWriter()
+  : dataPtr(new Implementation)
+{
+}
+
+//////////////////////////////////////////////////
+AsyncFileWriter::~AsyncFileWriter()
+{
+  this->Close();
+}
+
+//////////////////////////////////////////////////
+bool AsyncFileWriter::Open(const std::string &_file, const uint64_t _offset,
+    const unsigned int _depth)
+{
+#ifdef _WIN32
+  (void)_offset;
+  (void)_depth;
+  LERR("Asynchronous writes to [" << _file << "] are not supported\n");
+  return false;
+#else
+  if (this->IsOpen())
+    return false;
+
+  Implementation &impl = *this->dataPtr;
+  // The file is also read to rewrite its last partial page.
+  const int flags = O_RDWR | O_CREAT | O_CLOEXEC;
+  impl.fd = -1;
+#ifdef O_DIRECT
+  impl.fd = open(_file.c_str(), flags | O_DIRECT, 0644);
+#endif
+  impl.direct = impl.fd >= 0;
+  if (impl.fd < 0)
+    impl.fd = open(_file.c_str(), flags, 0644);
+  if (impl.fd < 0)
+  {
+    LERR("Unable to open [" << _file << "] for writing: "
+         << std::strerror(errno) << "\n");
+    return false;
+  }
+
+  impl.filename = _file;
+  impl.failed = false;
+  impl.alignment = impl.direct ? kDirectAlignment : 1;
+
+  // One block is filled while the other ones are written.
+  const unsigned int depth = std::max(1u, _depth);
+  impl.blocks.resize(depth + 1);
+  for (auto &block : impl.blocks)
+  {
+    void *data = nullptr;
+    if (posix_memalign(&data, kDirectAlignment, kBlockSize) != 0)
+    {
+      LERR("Unable to allocate the buffers of [" << _file << "]\n");
+      this->Close();
+      return false;
+    }
+    block.data = static_cast<char *>(data);
+  }
+
+  // The partial aligned block at the end of the file is rewritten.
+  impl.current = 0;
+  Implementation::Block &first = impl.blocks[0];
+  first.offset = _offset - _offset % impl.alignment;
+  first.fill = static_cast<std::size_t>(_offset - first.offset);
+  if (first.fill > 0)
+  {
+    const ssize_t bytes = pread(impl.fd, first.data, impl.alignment,
+      static_cast<off_t>(first.offset));
+    if (bytes < static_cast<ssize_t>(first.fill))
+    {
+      LERR("Unable to read the end of [" << _file << "]\n");
+      this->Close();
+      return false;
+    }
+  }
+
+  if (!impl.SetupRing(depth + 1))
+  {
+    LDBG("io_uring is not available, writing [" << _file
+         << "] synchronously\n");
+  }
+  return true;
+#endif
+}
+
+//////////////////////////////////////////////////
+bool AsyncFileWriter::Write(const char *_data, std::size_t _size)
+{
+  Implementation &impl = *this->dataPtr;
+  if (impl.fd < 0 || impl.failed)
+    return false;
+
+  while (_size > 0)
+  {
+    Implementation::Block &block = impl.blocks[impl.current];
+    const std::size_t size = std::min(_size, kBlockSize - block.fill);
+    std::memcpy(block.data + block.fill, _data, size);
+    block.fill += size;
+    _data += size;
+    _size -= size;
+
+    if (block.fill == kBlockSize)
+    {
+      block.length = kBlockSize;
+      block.written = 0;
+      if (!impl.Submit(impl.current, 0))
+        return false;
+
+      const uint64_t next = block.offset + kBlockSize;
+      impl.current = impl.FreeBlock();
+      if (impl.current == impl.blocks.size())
+      {
+        impl.current = 0;
+        impl.failed = true;
+        return false;
+      }
+      impl.blocks[impl.current].offset = next;
+      impl.blocks[impl.current].fill = 0;
+    }
+  }
+
+  // Report the failures of the previous writes early.
+  impl.Reap(false);
+  return !impl.failed;
+}
+
+//////////////////////////////////////////////////
+bool AsyncFileWriter::Sync()
+{
+  Implementation &impl = *this->dataPtr;
+  if (impl.fd < 0)
+    return false;
+
+  Implementation::Block &block = impl.blocks[impl.current];
+  const std::size_t tail = block.fill % impl.alignment;
+  if (block.fill > 0 && !impl.failed)
+  {
+    // O_DIRECT writes a whole number of aligned pages.
+    block.length = block.fill + (tail > 0 ? impl.alignment - tail : 0);
+    std::memset(block.data + block.fill, 0, block.length - block.fill);
+    block.written = 0;
+    impl.Submit(impl.current, 0);
+  }
+
+  if (!impl.Drain())
+    return false;
+
+#ifndef _WIN32
+  if (tail > 0 && ftruncate(impl.fd, static_cast<off_t>(this->Size())) != 0)
+  {
+    LERR("Unable to truncate [" << impl.filename << "]: "
+         << std::strerror(errno) << "\n");
+    impl.failed = true;
+    return false;
+  }
+#endif
+
+  // Keep the partial aligned page, it is rewritten with the next data.
+  const std::size_t written = block.fill - tail;
+  if (written > 0)
+  {
+    std::memmove(block.data, block.data + written, tail);
+    block.offset += written;
+    block.fill = tail;
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool AsyncFileWriter::Close()
+{
+  Implementation &impl = *this->dataPtr;
+  bool result = !impl.failed;
+  if (impl.fd >= 0)
+  {
+    result = this->Sync() && result;
+#ifndef _WIN32
+    close(impl.fd);
+#endif
+  }
+
+  impl.TeardownRing();
+  for (auto &block : impl.blocks)
+    free(block.data);
+  impl.blocks.clear();
+  impl.fd = -1;
+  impl.inflight = 0;
+  impl.current = 0;
+  return result;
+}
+
+//////////////////////////////////////////////////
+bool AsyncFileWriter::IsOpen() const
+{
+  return this->dataPtr->fd >= 0;
+}
+
+//////////////////////////////////////////////////
+bool AsyncFileWriter::Direct() const
+{
+  return this->dataPtr->fd >= 0 && this->dataPtr->direct;
+}
+
+//////////////////////////////////////////////////
+bool AsyncFileWriter::Asynchronous() const
+{
+#ifdef HAVE_IO_URING
+  return this->dataPtr->ringFd >= 0;
+#else
+  return false;
+#endif
+}
+
+//////////////////////////////////////////////////
+uint64_t AsyncFileWriter::Size() const
+{
+  if (this->dataPtr->blocks.empty())
+    return 0;
+
+  const Implementation::Block &block =
+    this->dataPtr->blocks[this->dataPtr->current];
+  return block.offset + block.fill;
+}
@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GZ_TRANSPORT_LOG_ASYNCFILEWRITER_HH_
+#define GZ_TRANSPORT_LOG_ASYNCFILEWRITER_HH_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include <gz/transport/config.hh>
+
+namespace gz
+{
+  namespace transport
+  {
+    namespace log
+    {
+      // Inline bracket to help doxygen filtering.
+      inline namespace GZ_TRANSPORT_VERSION_NAMESPACE {
+      //
+      /// \internal
+      /// \brief Append data to a file with several writes in flight, so that
+      /// the thread producing the data doesn't wait for the disk.
+      ///
+      /// The data is copied into blocks of kBlockSize bytes, and every full
+      /// block is submitted to io_uring on Linux. Up to the queue depth
+      /// blocks are written at the same time. The file is opened with
+      /// O_DIRECT when the file system supports it, which skips the page
+      /// cache: the last partial block is then written padded to the
+      /// alignment and the file is truncated back to its size by Sync().
+      ///
+      /// Without io_uring (older kernels, seccomp filters, other POSIX
+      /// systems), the blocks are written synchronously with pwrite().
+      /// The errors of the writes in flight are reported by the following
+      /// calls.
+      class AsyncFileWriter
+      {
+        /// \brief Size of the blocks written (bytes).
+        public: static constexpr std::size_t kBlockSize = 1u << 20;
+
+        /// \brief Constructor.
+        public: AsyncFileWriter();
+
+        /// \brief Destructor. Calls Close().
+        public: ~AsyncFileWriter();
+
+        /// \brief Open a file to append data to it. It is created if it
+        /// doesn't exist.
+        /// \param[in] _file Path to the file.
+        /// \param[in] _offset Offset of the first write. The file must not
+        /// be shorter.
+        /// \param[in] _depth Maximum number of blocks written at the same
+        /// time.
+        /// \return True on success.
+        public: bool Open(const std::string &_file, const uint64_t _offset,
+                          const unsigned int _depth);
+
+        /// \brief Append data. It may return before the data is written.
+        /// \param[in] _data The data.
+        /// \param[in] _size Size of the data (bytes).
+        /// \return False if this write or a previous one failed.
+        public: bool Write(const char *_data, std::size_t _size);
+
+        /// \brief Write the data appended so far and wait for every write in
+        /// flight.
+        /// \return False if a write failed.
+        public: bool Sync();
+
+        /// \brief Sync and close the file.
+        /// \return False if a write failed.
+        public: bool Close();
+
+        /// \brief Whether a file is open.
+        /// \return True if open.
+        public: bool IsOpen() const;
+
+        /// \brief Whether the file was opened with O_DIRECT.
+        /// \return True if the page cache is skipped.
+        public: bool Direct() const;
+
+        /// \brief Whether the writes are submitted to io_uring.
+        /// \return True for asynchronous writes, false for pwrite().
+        public: bool Asynchronous() const;
+
+        /// \brief Size of the file once everything is written.
+        /// \return Size (bytes).
+        public: uint64_t Size() const;
+
+        /// \internal
+        /// \brief Private implementation.
+        private: class Implementation;
+
+        /// \brief Pointer to the private implementation.
+        private: std::unique_ptr<Implementation> dataPtr;
+      };
+      }
+    }
+  }
+}
+#endif
@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include "gtest/gtest.h"
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include "AsyncFileWriter.hh"
+
+#include "test_utils.hh"
+
+using namespace gz;
+using namespace gz::transport;
+
+//////////////////////////////////////////////////
+/// \brief Read a whole file.
+/// \param[in] _file Path to the file.
+/// \return The content.
+static std::string readFile(const std::filesystem::path &_file)
+{
+  std::ifstream in(_file, std::ios_base::binary);
+  return std::string(std::istreambuf_iterator<char>(in),
+    std::istreambuf_iterator<char>());
+}
+
+//////////////////////////////////////////////////
+TEST(AsyncFileWriter, WriteSyncAndAppend)
+{
+  const std::filesystem::path file = std::filesystem::temp_directory_path() /
+    ("gz_async_" + testing::getRandomNumber() + ".bin");
+
+  // Several blocks in flight, and a last partial block.
+  std::string expected;
+  for (int i = 0; expected.size() < 5 * log::AsyncFileWriter::kBlockSize;
+       ++i)
+  {
+    expected += "message " + std::to_string(i) + "\n";
+  }
+
+  log::AsyncFileWriter writer;
+  EXPECT_FALSE(writer.IsOpen());
+  EXPECT_FALSE(writer.Write("a", 1));
+  ASSERT_TRUE(writer.Open(file.string(), 0, 2));
+  EXPECT_TRUE(writer.IsOpen());
+  for (std::size_t i = 0; i < expected.size(); i += 1000)
+  {
+    EXPECT_TRUE(writer.Write(expected.data() + i,
+      std::min<std::size_t>(1000, expected.size() - i)));
+  }
+  EXPECT_EQ(expected.size(), writer.Size());
+
+  // The padding of O_DIRECT is truncated.
+  EXPECT_TRUE(writer.Sync());
+  EXPECT_EQ(expected, readFile(file));
+
+  // More data after a sync rewrites the partial page.
+  EXPECT_TRUE(writer.Write("tail", 4));
+  EXPECT_TRUE(writer.Close());
+  expected += "tail";
+  EXPECT_EQ(expected, readFile(file));
+
+  // Append to the file.
+  ASSERT_TRUE(writer.Open(file.string(), expected.size(), 4));
+  EXPECT_TRUE(writer.Write("end", 3));
+  EXPECT_TRUE(writer.Close());
+  EXPECT_FALSE(writer.IsOpen());
+  expected += "end";
+  EXPECT_EQ(expected, readFile(file));
+
+  std::filesystem::remove(file);
+}
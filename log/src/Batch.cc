@@ -15,6 +15,9 @@
  *
 */
 
+#include <memory>
+#include <string>
+#include <utility>
 #include <vector>
 
 #include "gz/transport/log/Batch.hh"
@@ -28,8 +31,10 @@ using namespace gz::transport::log;
 
 //////////////////////////////////////////////////
 BatchPrivate::BatchPrivate(const std::shared_ptr<raii_sqlite3::Database> &_db,
-      std::vector<SqlStatement> &&_statements)  // NOLINT(build/c++11)
-  : statements(new std::vector<SqlStatement>(std::move(_statements))), db(_db)
+      std::vector<SqlStatement> &&_statements,  // NOLINT(build/c++11)
+      const bool _encoded)
+  : statements(new std::vector<SqlStatement>(std::move(_statements))), db(_db),
+    encoded(_encoded)
 {
 }
 
@@ -74,7 +79,9 @@ Batch::iterator Batch::begin()
   }
 
   std::unique_ptr<MsgIterPrivate> msgPriv(new MsgIterPrivate(
-        this->dataPtr->db, this->dataPtr->statements));
+        this->dataPtr->db, this->dataPtr->statements,
+        this->dataPtr->encoded, this->dataPtr->prefetchRows,
+        this->dataPtr->prefetchBytes));
   return Batch::iterator(std::move(msgPriv));
 }
 
@@ -84,6 +91,55 @@ Batch::iterator Batch::end()
   return Batch::iterator();
 }
 
+//////////////////////////////////////////////////
+Batch::reverse_iterator Batch::rbegin()
+{
+  if (!this->dataPtr)
+  {
+    return Batch::reverse_iterator();
+  }
+
+  if (!this->dataPtr->reversedStatements)
+  {
+    // The messages with the same time are visited in the reverse order of
+    // idx_time_recv, which orders them by topic and id.
+    auto reversed = std::make_shared<std::vector<SqlStatement>>();
+    const std::vector<SqlStatement> &statements = *this->dataPtr->statements;
+    for (auto it = statements.rbegin(); it != statements.rend(); ++it)
+    {
+      const std::size_t last = it->statement.find_last_not_of("; \n");
+      SqlStatement sql;
+      sql.statement = "SELECT * FROM (" + it->statement.substr(0, last + 1) +
+        ") ORDER BY time_recv DESC, topic_id DESC, id DESC;";
+      sql.parameters = it->parameters;
+      reversed->push_back(std::move(sql));
+    }
+    this->dataPtr->reversedStatements = std::move(reversed);
+  }
+
+  std::unique_ptr<MsgIterPrivate> msgPriv(new MsgIterPrivate(
+        this->dataPtr->db, this->dataPtr->reversedStatements,
+        this->dataPtr->encoded, this->dataPtr->prefetchRows,
+        this->dataPtr->prefetchBytes));
+  return Batch::reverse_iterator(std::move(msgPriv));
+}
+
+//////////////////////////////////////////////////
+Batch::reverse_iterator Batch::rend()
+{
+  return Batch::reverse_iterator();
+}
+
+//////////////////////////////////////////////////
+void Batch::SetPrefetch(const std::size_t _rows, const std::size_t _bytes)
+{
+  if (!this->dataPtr)
+    return;
+
+  this->dataPtr->prefetchRows = _rows;
+  this->dataPtr->prefetchBytes = _bytes;
+}
+
 //////////////////////////////////////////////////
 Batch::Batch(std::unique_ptr<BatchPrivate> &&_pimpl)  // NOLINT(build/c++11)
   : dataPtr(std::move(_pimpl))
@@ -17,6 +17,7 @@
 #ifndef GZ_TRANSPORT_LOG_BATCHPRIVATE_HH_
 #define GZ_TRANSPORT_LOG_BATCHPRIVATE_HH_
 
+#include <cstddef>
 #include <memory>
 #include <vector>
 
@@ -33,9 +34,12 @@ class gz::transport::log::BatchPrivate
   /// \brief constructor
   /// \param[in] _db an open sqlite3 database handle wrapper
   /// \param[in] _statements a list of statments to be executed to get messages
+  /// \param[in] _encoded true if the messages use the encoding of the 0.2.0
+  /// schema
   public: explicit BatchPrivate(
       const std::shared_ptr<raii_sqlite3::Database> &_db,
-      std::vector<SqlStatement> &&_statements);  // NOLINT(build/c++11)
+      std::vector<SqlStatement> &&_statements,  // NOLINT(build/c++11)
+      bool _encoded = false);
 
   /// \brief destructor
   public: ~BatchPrivate();
@@ -43,8 +47,21 @@ class gz::transport::log::BatchPrivate
   /// \brief topic names that should be queried
   public: std::shared_ptr<std::vector<SqlStatement>> statements;
 
+  /// \brief statements in the reverse order, which query the messages in
+  /// the reverse order, see Batch::rbegin(). Generated on demand.
+  public: std::shared_ptr<std::vector<SqlStatement>> reversedStatements;
+
   /// \brief SQLite3 database pointer wrapper
   public: std::shared_ptr<raii_sqlite3::Database> db;
+
+  /// \brief true if the messages use the encoding of the 0.2.0 schema
+  public: bool encoded = false;
+
+  /// \brief Number of rows fetched at once, see Batch::SetPrefetch()
+  public: std::size_t prefetchRows = 0;
+
+  /// \brief Size of the data of the rows fetched at once
+  public: std::size_t prefetchBytes = 0;
 };
 
 #endif
@@ -26,3 +26,18 @@ TEST(Batch, DefaultNoMessages)
   transport::log::Batch batch;
   EXPECT_EQ(batch.begin(), batch.end());
 }
+
+//////////////////////////////////////////////////
+TEST(Batch, DefaultPrefetch)
+{
+  transport::log::Batch batch;
+  batch.SetPrefetch(16, 1024);
+  EXPECT_EQ(batch.begin(), batch.end());
+}
+
+//////////////////////////////////////////////////
+TEST(Batch, DefaultReverse)
+{
+  transport::log::Batch batch;
+  EXPECT_EQ(batch.rbegin(), batch.rend());
+}
@@ -0,0 +1,1353 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifdef _WIN32
+  #ifndef NOMINMAX
+    #define NOMINMAX
+  #endif
+  #include <windows.h>
+#else
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <set>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "gz/transport/log/ChunkedLog.hh"
+#include "gz/transport/log/Log.hh"
+#include "gz/transport/log/LogOptions.hh"
+#include "gz/transport/log/Message.hh"
+#include "AsyncFileWriter.hh"
+#include "Compression.hh"
+#include "Console.hh"
+#include "Crc32c.hh"
+
+using namespace gz::transport;
+using namespace gz::transport::log;
+
+/// \brief First bytes of a chunked log.
+static const char kFileMagic[] = {'G', 'Z', 'L', 'O', 'G', 'C', 'H', 'K'};
+
+/// \brief Version of the chunked format written. The version 1 has a
+/// FNV-1a checksum, the version 2 a CRC-32C.
+static const uint32_t kFormatVersion = 2;
+
+/// \brief Size of the file header: magic, version and a reserved field.
+static const std::size_t kFileHeaderSize = 16;
+
+/// \brief First bytes of a chunk ("CHNK").
+static const uint32_t kChunkMagic = 0x4B4E4843;
+
+/// \brief Size of the header of a chunk. Layout (little endian):
+///   0 u32 magic, 4 u8 codec, 5 u8[3] reserved, 8 u32 number of messages,
+///   12 u32 number of topics, 16 i64 start time, 24 i64 end time,
+///   32 u32 size of the topic index, 36 u32 checksum of the index and the
+///   stored messages, 40 u64 size of the messages, 48 u64 size of the
+///   stored (maybe compressed) messages.
+static const std::size_t kChunkHeaderSize = 56;
+
+/// \brief Size of the chunks that ChunkedLog::ForEachMessage() asks the
+/// kernel to read ahead of the chunk being read (bytes).
+static const uint64_t kReadAheadBytes = 16u << 20;
+
+/// \brief Size of the header of a message inside a chunk: i64 time,
+/// u32 topic (index in the topic index of the chunk) and u32 size.
+static const std::size_t kRecordHeaderSize = 16;
+
+//////////////////////////////////////////////////
+/// \brief Append an unsigned integer in little endian.
+/// \param[in] _value The integer.
+/// \param[in] _bytes Number of bytes to append.
+/// \param[out] _buffer Destination.
+static void PutUint(const uint64_t _value, const std::size_t _bytes,
+    std::string &_buffer)
+{
+  for (std::size_t i = 0; i < _bytes; ++i)
+    _buffer.push_back(static_cast<char>((_value >> (8 * i)) & 0xFF));
+}
+
+//////////////////////////////////////////////////
+/// \brief Read an unsigned integer in little endian.
+/// \param[in] _data Source.
+/// \param[in] _bytes Number of bytes to read.
+/// \return The integer.
+static uint64_t GetUint(const char *_data, const std::size_t _bytes)
+{
+  uint64_t value = 0;
+  for (std::size_t i = 0; i < _bytes; ++i)
+  {
+    value |= static_cast<uint64_t>(static_cast<unsigned char>(_data[i]))
+      << (8 * i);
+  }
+  return value;
+}
+
+//////////////////////////////////////////////////
+/// \brief Update a FNV-1a checksum.
+/// \param[in] _data Data.
+/// \param[in] _size Size of the data (bytes).
+/// \param[in] _hash Current checksum.
+/// \return The new checksum.
+static uint32_t Checksum(const char *_data, const std::size_t _size,
+    uint32_t _hash = 2166136261u)
+{
+  for (std::size_t i = 0; i < _size; ++i)
+  {
+    _hash ^= static_cast<unsigned char>(_data[i]);
+    _hash *= 16777619u;
+  }
+  return _hash;
+}
+
+/// \brief Description of a chunk.
+struct ChunkInfo
+{
+  /// \brief Codec of the messages.
+  Compression_t codec = Compression_t::NONE;
+
+  /// \brief Number of messages.
+  uint32_t count = 0;
+
+  /// \brief Time of the first message (ns).
+  int64_t start = 0;
+
+  /// \brief Time of the last message (ns).
+  int64_t end = 0;
+
+  /// \brief Checksum of the topic index and the stored messages.
+  uint32_t checksum = 0;
+
+  /// \brief Whether the checksum is a CRC-32C rather than a FNV-1a.
+  bool crc32c = true;
+
+  /// \brief Size of the messages (bytes).
+  uint64_t rawSize = 0;
+
+  /// \brief Size of the stored messages (bytes).
+  uint64_t storedSize = 0;
+
+  /// \brief Topic index: names of the topics and their types.
+  std::vector<std::pair<std::string, std::string>> topics;
+
+  /// \brief Topic index in the memory mapped file, or nullptr when writing.
+  const char *index = nullptr;
+
+  /// \brief Size of the topic index (bytes).
+  uint32_t indexSize = 0;
+
+  /// \brief Stored messages in the memory mapped file, or nullptr when
+  /// writing.
+  const char *payload = nullptr;
+};
+
+//////////////////////////////////////////////////
+/// \brief Compute the checksum of a chunk.
+/// \param[in] _chunk The chunk.
+/// \param[in] _index Topic index.
+/// \param[in] _stored Stored messages.
+/// \return The checksum.
+static uint32_t ChunkChecksum(const ChunkInfo &_chunk, const char *_index,
+    const char *_stored)
+{
+  if (_chunk.crc32c)
+  {
+    return Crc32c(_stored, _chunk.storedSize,
+      Crc32c(_index, _chunk.indexSize));
+  }
+  return Checksum(_stored, _chunk.storedSize,
+    Checksum(_index, _chunk.indexSize));
+}
+
+/// \brief A message buffered until its chunk is written.
+struct PendingRecord
+{
+  /// \brief Time of the message (ns).
+  int64_t time;
+
+  /// \brief Topic (index in the topic index of the chunk).
+  uint32_t topic;
+
+  /// \brief Position of the data in the buffer of the chunk.
+  std::size_t offset;
+
+  /// \brief Size of the data (bytes).
+  uint32_t len;
+};
+
+//////////////////////////////////////////////////
+/// \brief Read the chunks of a chunked log.
+/// \param[in] _data Content of the file.
+/// \param[in] _size Size of the file (bytes).
+/// \param[out] _chunks The chunks.
+/// \return Size of the valid part of the file (bytes), or 0 if the file is
+/// not a chunked log.
+static uint64_t ScanChunks(const char *_data, const uint64_t _size,
+    std::vector<ChunkInfo> &_chunks)
+{
+  _chunks.clear();
+  if (_size < kFileHeaderSize ||
+      std::memcmp(_data, kFileMagic, sizeof(kFileMagic)) != 0)
+  {
+    LERR("Not a chunked log file\n");
+    return 0;
+  }
+
+  const uint32_t version = static_cast<uint32_t>(GetUint(_data + 8, 4));
+  if (version < 1 || version > kFormatVersion)
+  {
+    LERR("Unsupported version [" << version << "] of the chunked log\n");
+    return 0;
+  }
+
+  uint64_t offset = kFileHeaderSize;
+  while (_size - offset >= kChunkHeaderSize)
+  {
+    const char *header = _data + offset;
+    if (GetUint(header, 4) != kChunkMagic)
+      break;
+
+    ChunkInfo chunk;
+    chunk.crc32c = version >= 2;
+    chunk.codec = static_cast<Compression_t>(header[4]);
+    chunk.count = static_cast<uint32_t>(GetUint(header + 8, 4));
+    const uint32_t topicCount = static_cast<uint32_t>(GetUint(header + 12, 4));
+    chunk.start = static_cast<int64_t>(GetUint(header + 16, 8));
+    chunk.end = static_cast<int64_t>(GetUint(header + 24, 8));
+    chunk.indexSize = static_cast<uint32_t>(GetUint(header + 32, 4));
+    chunk.checksum = static_cast<uint32_t>(GetUint(header + 36, 4));
+    chunk.rawSize = GetUint(header + 40, 8);
+    chunk.storedSize = GetUint(header + 48, 8);
+
+    const uint64_t remaining = _size - offset - kChunkHeaderSize;
+    if (chunk.indexSize > remaining ||
+        chunk.storedSize > remaining - chunk.indexSize)
+    {
+      break;
+    }
+
+    chunk.index = header + kChunkHeaderSize;
+    chunk.payload = chunk.index + chunk.indexSize;
+
+    // The topic index.
+    bool valid = true;
+    const char *pos = chunk.index;
+    const char *indexEnd = chunk.index + chunk.indexSize;
+    for (uint32_t i = 0; i < topicCount && valid; ++i)
+    {
+      std::string names[2];
+      for (auto &name : names)
+      {
+        if (indexEnd - pos < 4)
+        {
+          valid = false;
+          break;
+        }
+        const uint64_t len = GetUint(pos, 4);
+        pos += 4;
+        if (static_cast<uint64_t>(indexEnd - pos) < len)
+        {
+          valid = false;
+          break;
+        }
+        name.assign(pos, len);
+        pos += len;
+      }
+      chunk.topics.emplace_back(names[0], names[1]);
+    }
+    if (!valid)
+      break;
+
+    _chunks.push_back(std::move(chunk));
+    offset += kChunkHeaderSize + _chunks.back().indexSize +
+      _chunks.back().storedSize;
+  }
+
+  // Only the last chunk might have been partially written.
+  if (!_chunks.empty())
+  {
+    const ChunkInfo &last = _chunks.back();
+    if (ChunkChecksum(last, last.index, last.payload) != last.checksum)
+    {
+      offset = static_cast<uint64_t>(last.index - kChunkHeaderSize - _data);
+      _chunks.pop_back();
+    }
+  }
+
+  return offset;
+}
+
+//////////////////////////////////////////////////
+/// \brief Ask the kernel to read a chunk of the memory mapped file in the
+/// background.
+/// \param[in] _chunk The chunk.
+static void ReadAhead(const ChunkInfo &_chunk)
+{
+#ifdef _WIN32
+  (void)_chunk;
+#else
+  static const uintptr_t kPageSize =
+    static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+  const uintptr_t begin = reinterpret_cast<uintptr_t>(_chunk.index);
+  const uintptr_t end =
+    reinterpret_cast<uintptr_t>(_chunk.payload) + _chunk.storedSize;
+  const uintptr_t start = begin - begin % kPageSize;
+  madvise(reinterpret_cast<void *>(start), end - start, MADV_WILLNEED);
+#endif
+}
+
+//////////////////////////////////////////////////
+/// \brief Iterator over the messages of a chunk.
+class ChunkCursor
+{
+  /// \brief Constructor.
+  /// \param[in] _chunk The chunk.
+  /// \param[in] _order Position of the chunk in the log, to keep the order
+  /// of the messages with the same time.
+  /// \param[in] _wanted The topics to read, by index.
+  public: ChunkCursor(const ChunkInfo &_chunk, const std::size_t _order,
+      std::vector<bool> _wanted)
+    : chunk(_chunk), order(_order), wanted(std::move(_wanted))
+  {
+  }
+
+  /// \brief Check the chunk and decompress it if needed.
+  /// \return True if the chunk is valid.
+  public: bool Load()
+  {
+    if (ChunkChecksum(this->chunk, this->chunk.index, this->chunk.payload) !=
+        this->chunk.checksum)
+    {
+      LERR("Chunk with an invalid checksum\n");
+      return false;
+    }
+
+    std::size_t size = this->chunk.storedSize;
+    if (this->chunk.codec == Compression_t::NONE)
+    {
+      this->pos = this->chunk.payload;
+    }
+    else
+    {
+      if (!Decompress(this->chunk.codec, this->chunk.payload,
+            this->chunk.storedSize, this->buffer))
+      {
+        LERR("Unable to decompress a chunk with codec ["
+             << CompressionName(this->chunk.codec) << "]\n");
+        return false;
+      }
+      this->pos = this->buffer.data();
+      size = this->buffer.size();
+    }
+
+    if (size != this->chunk.rawSize)
+    {
+      LERR("Chunk with an invalid size\n");
+      return false;
+    }
+    this->end = this->pos + size;
+    return true;
+  }
+
+  /// \brief Move to the next message to read.
+  /// \param[in] _start Time of the first message to read.
+  /// \param[in] _end Time of the last message to read.
+  /// \param[out] _error True if the chunk is malformed.
+  /// \return True if there's a message or false at the end of the chunk.
+  public: bool Next(const int64_t _start, const int64_t _end, bool &_error)
+  {
+    while (this->end - this->pos >=
+           static_cast<std::ptrdiff_t>(kRecordHeaderSize))
+    {
+      this->time = static_cast<int64_t>(GetUint(this->pos, 8));
+      this->topic = static_cast<uint32_t>(GetUint(this->pos + 8, 4));
+      this->len = static_cast<uint32_t>(GetUint(this->pos + 12, 4));
+      this->data = this->pos + kRecordHeaderSize;
+      if (this->topic >= this->wanted.size() ||
+          static_cast<uint64_t>(this->end - this->data) < this->len)
+      {
+        LERR("Malformed message in a chunk\n");
+        _error = true;
+        return false;
+      }
+      this->pos = this->data + this->len;
+
+      // The messages of a chunk are sorted by time.
+      if (this->time > _end)
+        return false;
+
+      if (this->time >= _start && this->wanted[this->topic])
+        return true;
+    }
+
+    if (this->pos != this->end)
+    {
+      LERR("Malformed message in a chunk\n");
+      _error = true;
+    }
+    return false;
+  }
+
+  /// \brief The chunk.
+  public: const ChunkInfo &chunk;
+
+  /// \brief Position of the chunk in the log.
+  public: std::size_t order;
+
+  /// \brief The topics to read, by index.
+  public: std::vector<bool> wanted;
+
+  /// \brief Decompressed messages.
+  public: std::string buffer;
+
+  /// \brief Next message to parse.
+  public: const char *pos = nullptr;
+
+  /// \brief End of the messages.
+  public: const char *end = nullptr;
+
+  /// \brief Time of the current message.
+  public: int64_t time = 0;
+
+  /// \brief Topic of the current message.
+  public: uint32_t topic = 0;
+
+  /// \brief Size of the current message.
+  public: uint32_t len = 0;
+
+  /// \brief Data of the current message.
+  public: const char *data = nullptr;
+};
+
+//////////////////////////////////////////////////
+class gz::transport::log::ChunkedLog::Implementation
+{
+  /// \brief Map a file in memory.
+  /// \param[in] _file Path to the file.
+  /// \return True on success.
+  public: bool Map(const std::string &_file);
+
+  /// \brief Release the memory mapping.
+  public: void Unmap();
+
+  /// \brief Open a file for writing.
+  /// \param[in] _file Path to the file.
+  /// \return True on success.
+  public: bool OpenForWriting(const std::string &_file);
+
+  /// \brief Write the buffered messages as a chunk.
+  /// \return True on success.
+  public: bool WriteChunk();
+
+  /// \brief Append data to the file being written.
+  /// \param[in] _data The data.
+  /// \return True on success.
+  public: bool Append(const std::string &_data);
+
+  /// \brief Whether the chunks are written with asyncOut.
+  /// \return True for asynchronous writes.
+  public: bool Async() const;
+
+  /// \brief Name of the log file.
+  public: std::string filename;
+
+  /// \brief True when the log is open for reading.
+  public: bool reading = false;
+
+  /// \brief True when the log is open for writing.
+  public: bool writing = false;
+
+  /// \brief Chunk size and compression.
+  public: LogOptions options;
+
+  /// \brief The chunks of the file.
+  public: std::vector<ChunkInfo> chunks;
+
+  /// \brief Version of the format of the file.
+  public: uint32_t version = kFormatVersion;
+
+  /// \brief Size of the valid part of the file opened for reading.
+  public: uint64_t validSize = 0;
+
+  /// \brief File being written.
+  public: std::ofstream out;
+
+  /// \brief File being written, when LogOptions::ChunkIoDepth() isn't 0.
+  public: AsyncFileWriter asyncOut;
+
+  /// \brief Messages of the next chunk.
+  public: std::vector<PendingRecord> pending;
+
+  /// \brief Data of the messages of the next chunk.
+  public: std::string pendingData;
+
+  /// \brief Topics of the next chunk.
+  public: std::vector<std::pair<std::string, std::string>> pendingTopics;
+
+  /// \brief Index of the topics of the next chunk.
+  public: std::map<std::pair<std::string, std::string>, uint32_t>
+    pendingTopicIds;
+
+  /// \brief Memory mapped file, or nullptr.
+  public: const char *mapping = nullptr;
+
+  /// \brief Size of the memory mapped file.
+  public: uint64_t mappingSize = 0;
+
+#ifdef _WIN32
+  /// \brief Handle of the mapping.
+  public: HANDLE mappingHandle = nullptr;
+#endif
+};
+
+//////////////////////////////////////////////////
+bool ChunkedLog::Implementation::Map(const std::string &_file)
+{
+#ifdef _WIN32
+  HANDLE file = CreateFileA(_file.c_str(), GENERIC_READ, FILE_SHARE_READ,
+    nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if (file == INVALID_HANDLE_VALUE)
+  {
+    LERR("Unable to open [" << _file << "]\n");
+    return false;
+  }
+
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+  {
+    LERR("Unable to read [" << _file << "]\n");
+    CloseHandle(file);
+    return false;
+  }
+
+  this->mappingHandle =
+    CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  CloseHandle(file);
+  if (!this->mappingHandle)
+  {
+    LERR("Unable to map [" << _file << "]\n");
+    return false;
+  }
+
+  this->mapping = static_cast<const char *>(
+    MapViewOfFile(this->mappingHandle, FILE_MAP_READ, 0, 0, 0));
+  if (!this->mapping)
+  {
+    LERR("Unable to map [" << _file << "]\n");
+    CloseHandle(this->mappingHandle);
+    this->mappingHandle = nullptr;
+    return false;
+  }
+  this->mappingSize = static_cast<uint64_t>(size.QuadPart);
+#else
+  const int fd = open(_file.c_str(), O_RDONLY);
+  if (fd < 0)
+  {
+    LERR("Unable to open [" << _file << "]\n");
+    return false;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size == 0)
+  {
+    LERR("Unable to read [" << _file << "]\n");
+    close(fd);
+    return false;
+  }
+
+  void *addr = mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ,
+    MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (addr == MAP_FAILED)
+  {
+    LERR("Unable to map [" << _file << "]\n");
+    return false;
+  }
+
+  // The messages are mostly read in order.
+  madvise(addr, static_cast<std::size_t>(st.st_size), MADV_SEQUENTIAL);
+  this->mapping = static_cast<const char *>(addr);
+  this->mappingSize = static_cast<uint64_t>(st.st_size);
+#endif
+  return true;
+}
+
+//////////////////////////////////////////////////
+void ChunkedLog::Implementation::Unmap()
+{
+  if (!this->mapping)
+    return;
+
+#ifdef _WIN32
+  UnmapViewOfFile(this->mapping);
+  CloseHandle(this->mappingHandle);
+  this->mappingHandle = nullptr;
+#else
+  munmap(const_cast<char *>(this->mapping),
+    static_cast<std::size_t>(this->mappingSize));
+#endif
+  this->mapping = nullptr;
+  this->mappingSize = 0;
+}
+
+//////////////////////////////////////////////////
+bool ChunkedLog::Implementation::OpenForWriting(const std::string &_file)
+{
+  std::error_code ec;
+  const bool exists = std::filesystem::exists(_file, ec) &&
+    std::filesystem::file_size(_file, ec) > 0;
+
+  if (exists)
+  {
+    // Append to the file, after its last complete chunk.
+    if (!this->Map(_file))
+      return false;
+
+    const uint64_t validSize =
+      ScanChunks(this->mapping, this->mappingSize, this->chunks);
+    const uint64_t fileSize = this->mappingSize;
+
+    // The new chunks have the checksum of the version of the file.
+    if (validSize > 0)
+      this->version = static_cast<uint32_t>(GetUint(this->mapping + 8, 4));
+    this->Unmap();
+    for (auto &chunk : this->chunks)
+    {
+      chunk.index = nullptr;
+      chunk.payload = nullptr;
+    }
+
+    if (validSize == 0)
+      return false;
+
+    if (validSize < fileSize)
+    {
+      LWRN("Discarding [" << fileSize - validSize << "] bytes of a truncated "
+           << "chunk at the end of [" << _file << "]\n");
+      std::filesystem::resize_file(_file, validSize, ec);
+      if (ec)
+      {
+        LERR("Unable to truncate [" << _file << "]: " << ec.message() << "\n");
+        return false;
+      }
+    }
+
+    if (this->Async())
+      this->asyncOut.Open(_file, validSize, this->options.ChunkIoDepth());
+    else
+      this->out.open(_file, std::ios_base::binary | std::ios_base::app);
+  }
+  else
+  {
+    this->version = kFormatVersion;
+    std::string header(kFileMagic, sizeof(kFileMagic));
+    PutUint(kFormatVersion, 4, header);
+    PutUint(0, 4, header);
+    if (this->Async())
+    {
+      if (this->asyncOut.Open(_file, 0, this->options.ChunkIoDepth()))
+        this->asyncOut.Write(header.data(), header.size());
+    }
+    else
+    {
+      this->out.open(_file, std::ios_base::binary | std::ios_base::trunc);
+      if (this->out)
+      {
+        this->out.write(header.data(),
+          static_cast<std::streamsize>(header.size()));
+        this->out.flush();
+      }
+    }
+  }
+
+  if (this->Async() ? !this->asyncOut.IsOpen() : !this->out)
+  {
+    LERR("Unable to open [" << _file << "] for writing\n");
+    this->out.close();
+    this->chunks.clear();
+    return false;
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool ChunkedLog::Implementation::Async() const
+{
+#ifdef _WIN32
+  return false;
+#else
+  return this->options.ChunkIoDepth() > 0;
+#endif
+}
+
+//////////////////////////////////////////////////
+bool ChunkedLog::Implementation::Append(const std::string &_data)
+{
+  if (this->Async())
+    return this->asyncOut.Write(_data.data(), _data.size());
+
+  this->out.write(_data.data(), static_cast<std::streamsize>(_data.size()));
+  return static_cast<bool>(this->out);
+}
+
+//////////////////////////////////////////////////
+bool ChunkedLog::Implementation::WriteChunk()
+{
+  if (this->pending.empty())
+    return true;
+
+  // The messages of a chunk are sorted by time. They are received almost
+  // in order, and the messages with the same time keep their order.
+  std::vector<std::size_t> order(this->pending.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+    [this](const std::size_t _a, const std::size_t _b)
+    {
+      return this->pending[_a].time < this->pending[_b].time;
+    });
+
+  std::string raw;
+  raw.reserve(this->pendingData.size() +
+    kRecordHeaderSize * this->pending.size());
+  for (const std::size_t i : order)
+  {
+    const PendingRecord &record = this->pending[i];
+    PutUint(static_cast<uint64_t>(record.time), 8, raw);
+    PutUint(record.topic, 4, raw);
+    PutUint(record.len, 4, raw);
+    raw.append(this->pendingData, record.offset, record.len);
+  }
+
+  std::string index;
+  for (const auto &topic : this->pendingTopics)
+  {
+    PutUint(topic.first.size(), 4, index);
+    index.append(topic.first);
+    PutUint(topic.second.size(), 4, index);
+    index.append(topic.second);
+  }
+
+  ChunkInfo chunk;
+  chunk.count = static_cast<uint32_t>(this->pending.size());
+  chunk.start = this->pending[order.front()].time;
+  chunk.end = this->pending[order.back()].time;
+  chunk.indexSize = static_cast<uint32_t>(index.size());
+  chunk.rawSize = raw.size();
+  chunk.topics = std::move(this->pendingTopics);
+
+  // Keep the messages uncompressed if the codec fails.
+  std::string compressed;
+  const std::string *stored = &raw;
+  const Compression_t codec = this->options.ChunkCompression();
+  if (codec != Compression_t::NONE)
+  {
+    const std::size_t bound = CompressBound(codec, raw.size());
+    compressed.resize(bound);
+    const std::size_t size = bound == 0 ? 0 : Compress(codec, 0, raw.data(),
+      raw.size(), &compressed[0], bound);
+    if (size > 0)
+    {
+      compressed.resize(size);
+      stored = &compressed;
+      chunk.codec = codec;
+    }
+    else
+    {
+      LWRN("Unable to compress a chunk with codec ["
+           << CompressionName(codec) << "]\n");
+    }
+  }
+  chunk.storedSize = stored->size();
+  chunk.crc32c = this->version >= 2;
+  chunk.checksum = ChunkChecksum(chunk, index.data(), stored->data());
+
+  std::string header;
+  header.reserve(kChunkHeaderSize);
+  PutUint(kChunkMagic, 4, header);
+  PutUint(static_cast<uint8_t>(chunk.codec), 1, header);
+  PutUint(0, 3, header);
+  PutUint(chunk.count, 4, header);
+  PutUint(chunk.topics.size(), 4, header);
+  PutUint(static_cast<uint64_t>(chunk.start), 8, header);
+  PutUint(static_cast<uint64_t>(chunk.end), 8, header);
+  PutUint(chunk.indexSize, 4, header);
+  PutUint(chunk.checksum, 4, header);
+  PutUint(chunk.rawSize, 8, header);
+  PutUint(chunk.storedSize, 8, header);
+
+  // The asynchronous writes are only waited for by Flush() and Close().
+  bool written = this->Append(header) && this->Append(index) &&
+    this->Append(*stored);
+  if (!this->Async())
+  {
+    this->out.flush();
+    written = written && this->out;
+  }
+
+  this->pending.clear();
+  this->pendingData.clear();
+  this->pendingTopics.clear();
+  this->pendingTopicIds.clear();
+
+  if (!written)
+  {
+    LERR("Failed to write a chunk of [" << chunk.count << "] messages to ["
+         << this->filename << "]\n");
+    return false;
+  }
+
+  this->chunks.push_back(std::move(chunk));
+  return true;
+}
+
+//////////////////////////////////////////////////
+ChunkedLog::ChunkedLog()
+  : dataPtr(new Implementation)
+{
+}
+
+//////////////////////////////////////////////////
+ChunkedLog::ChunkedLog(ChunkedLog &&_old)  // NOLINT
+  : dataPtr(std::move(_old.dataPtr))
+{
+}
+
+//////////////////////////////////////////////////
+ChunkedLog::~ChunkedLog()
+{
+  if (this->dataPtr)
+    this->Close();
+}
+
+//////////////////////////////////////////////////
+bool ChunkedLog::Open(const std::string &_file,
+    std::ios_base::openmode _mode, const LogOptions &_options)
+{
+  if (this->Valid())
+  {
+    LERR("A log file is already open\n");
+    return false;
+  }
+
+  this->dataPtr->options = _options;
+  if (_mode & std::ios_base::out)
+  {
+    if (!this->dataPtr->OpenForWriting(_file))
+      return false;
+    this->dataPtr->writing = true;
+  }
+  else
+  {
+    if (!this->dataPtr->Map(_file))
+      return false;
+
+    const uint64_t validSize = ScanChunks(this->dataPtr->mapping,
+      this->dataPtr->mappingSize, this->dataPtr->chunks);
+    if (validSize == 0)
+    {
+      this->dataPtr->Unmap();
+      return false;
+    }
+    this->dataPtr->validSize = validSize;
+    if (validSize < this->dataPtr->mappingSize)
+    {
+      LWRN("Ignoring [" << this->dataPtr->mappingSize - validSize
+           << "] bytes of a truncated chunk at the end of [" << _file
+           << "]\n");
+    }
+    this->dataPtr->reading = true;
+  }
+
+  this->dataPtr->filename = _file;
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool ChunkedLog::Valid() const
+{
+  return this->dataPtr->reading || this->dataPtr->writing;
+}
+
+//////////////////////////////////////////////////
+std::string ChunkedLog::Filename() const
+{
+  return this->dataPtr->filename;
+}
+
+//////////////////////////////////////////////////
+void ChunkedLog::Close()
+{
+  if (this->dataPtr->writing)
+  {
+    this->dataPtr->WriteChunk();
+    if (this->dataPtr->asyncOut.IsOpen() && !this->dataPtr->asyncOut.Close())
+    {
+      LERR("Failed to write the last chunks to [" << this->dataPtr->filename
+           << "]\n");
+    }
+    this->dataPtr->out.close();
+  }
+  this->dataPtr->Unmap();
+  this->dataPtr->chunks.clear();
+  this->dataPtr->filename.clear();
+  this->dataPtr->reading = false;
+  this->dataPtr->writing = false;
+}
+
+//////////////////////////////////////////////////
+bool ChunkedLog::InsertMessage(
+    const std::chrono::nanoseconds &_time,
+    const std::string &_topic, const std::string &_type,
+    const void *_data, std::size_t _len)
+{
+  if (!this->dataPtr->writing)
+  {
+    LERR("The log file is not open for writing\n");
+    return false;
+  }
+
+  if (_len > std::numeric_limits<uint32_t>::max())
+  {
+    LERR("Message of [" << _len << "] bytes too big for a chunked log\n");
+    return false;
+  }
+
+  auto key = std::make_pair(_topic, _type);
+  auto it = this->dataPtr->pendingTopicIds.find(key);
+  if (it == this->dataPtr->pendingTopicIds.end())
+  {
+    const uint32_t id =
+      static_cast<uint32_t>(this->dataPtr->pendingTopics.size());
+    this->dataPtr->pendingTopics.push_back(key);
+    it = this->dataPtr->pendingTopicIds.emplace(std::move(key), id).first;
+  }
+
+  this->dataPtr->pending.push_back({_time.count(), it->second,
+    this->dataPtr->pendingData.size(), static_cast<uint32_t>(_len)});
+  this->dataPtr->pendingData.append(static_cast<const char *>(_data), _len);
+
+  const uint64_t size = this->dataPtr->pendingData.size() +
+    kRecordHeaderSize * this->dataPtr->pending.size();
+  if (size >= this->dataPtr->options.ChunkSize())
+    return this->dataPtr->WriteChunk();
+
+  return true;
+}
+
+//////////////////////////////////////////////////
+std::size_t ChunkedLog::InsertMessages(
+    const std::vector<MessageRecord> &_messages)
+{
+  std::size_t inserted = 0;
+  for (const auto &msg : _messages)
+  {
+    if (this->InsertMessage(msg.time, *msg.topic, *msg.type, msg.data,
+          msg.len))
+    {
+      ++inserted;
+    }
+  }
+  return inserted;
+}
+
+//////////////////////////////////////////////////
+bool ChunkedLog::Flush()
+{
+  if (!this->dataPtr->writing)
+    return false;
+
+  const bool written = this->dataPtr->WriteChunk();
+  if (this->dataPtr->asyncOut.IsOpen())
+    return this->dataPtr->asyncOut.Sync() && written;
+  return written;
+}
+
+//////////////////////////////////////////////////
+std::size_t ChunkedLog::ChunkCount() const
+{
+  return this->dataPtr->chunks.size();
+}
+
+//////////////////////////////////////////////////
+uint64_t ChunkedLog::MessageCount() const
+{
+  uint64_t count = this->dataPtr->pending.size();
+  for (const auto &chunk : this->dataPtr->chunks)
+    count += chunk.count;
+  return count;
+}
+
+//////////////////////////////////////////////////
+std::chrono::nanoseconds ChunkedLog::StartTime() const
+{
+  int64_t start = std::numeric_limits<int64_t>::max();
+  for (const auto &chunk : this->dataPtr->chunks)
+    start = std::min(start, chunk.start);
+  for (const auto &record : this->dataPtr->pending)
+    start = std::min(start, record.time);
+
+  if (start == std::numeric_limits<int64_t>::max())
+    return std::chrono::nanoseconds(0);
+  return std::chrono::nanoseconds(start);
+}
+
+//////////////////////////////////////////////////
+std::chrono::nanoseconds ChunkedLog::EndTime() const
+{
+  int64_t end = std::numeric_limits<int64_t>::min();
+  for (const auto &chunk : this->dataPtr->chunks)
+    end = std::max(end, chunk.end);
+  for (const auto &record : this->dataPtr->pending)
+    end = std::max(end, record.time);
+
+  if (end == std::numeric_limits<int64_t>::min())
+    return std::chrono::nanoseconds(0);
+  return std::chrono::nanoseconds(end);
+}
+
+//////////////////////////////////////////////////
+std::set<std::pair<std::string, std::string>> ChunkedLog::Topics() const
+{
+  std::set<std::pair<std::string, std::string>> topics(
+    this->dataPtr->pendingTopics.begin(), this->dataPtr->pendingTopics.end());
+  for (const auto &chunk : this->dataPtr->chunks)
+    topics.insert(chunk.topics.begin(), chunk.topics.end());
+  return topics;
+}
+
+//////////////////////////////////////////////////
+bool ChunkedLog::ForEachMessage(const ChunkedLogCallback &_cb,
+    const std::set<std::string> &_topics,
+    const std::chrono::nanoseconds &_start,
+    const std::chrono::nanoseconds &_end) const
+{
+  if (!this->dataPtr->reading)
+  {
+    LERR("The log file is not open for reading\n");
+    return false;
+  }
+
+  const int64_t start = _start.count();
+  const int64_t end = _end.count();
+
+  // Select the chunks with messages in the time range and on the topics.
+  std::vector<std::unique_ptr<ChunkCursor>> selected;
+  for (std::size_t i = 0; i < this->dataPtr->chunks.size(); ++i)
+  {
+    const ChunkInfo &chunk = this->dataPtr->chunks[i];
+    if (chunk.end < start || chunk.start > end)
+      continue;
+
+    std::vector<bool> wanted(chunk.topics.size(), true);
+    bool any = _topics.empty();
+    if (!_topics.empty())
+    {
+      for (std::size_t t = 0; t < chunk.topics.size(); ++t)
+      {
+        wanted[t] = _topics.count(chunk.topics[t].first) > 0;
+        any = any || wanted[t];
+      }
+    }
+
+    if (any)
+      selected.emplace_back(new ChunkCursor(chunk, i, std::move(wanted)));
+  }
+
+  std::stable_sort(selected.begin(), selected.end(),
+    [](const std::unique_ptr<ChunkCursor> &_a,
+       const std::unique_ptr<ChunkCursor> &_b)
+    {
+      return _a->chunk.start < _b->chunk.start;
+    });
+
+  // Merge the chunks whose time ranges overlap. A chunk is only loaded when
+  // its first message might be the next one.
+  auto later = [](const ChunkCursor *_a, const ChunkCursor *_b)
+  {
+    if (_a->time != _b->time)
+      return _a->time > _b->time;
+    return _a->order > _b->order;
+  };
+
+  // The next chunks are read in the background while the current ones are
+  // processed, so the reads of the disk are in flight all the time.
+  std::size_t readAhead = 0;
+  uint64_t readAheadBytes = 0;
+
+  std::vector<ChunkCursor *> active;
+  std::size_t next = 0;
+  bool error = false;
+  while (true)
+  {
+    while (next < selected.size() &&
+           (active.empty() || selected[next]->chunk.start <=
+                              active.front()->time))
+    {
+      ChunkCursor *cursor = selected[next++].get();
+      if (next <= readAhead)
+        readAheadBytes -= cursor->chunk.storedSize;
+      for (readAhead = std::max(readAhead, next);
+           readAhead < selected.size() && readAheadBytes < kReadAheadBytes;
+           ++readAhead)
+      {
+        ReadAhead(selected[readAhead]->chunk);
+        readAheadBytes += selected[readAhead]->chunk.storedSize;
+      }
+
+      if (!cursor->Load())
+        return false;
+
+      if (cursor->Next(start, end, error))
+      {
+        active.push_back(cursor);
+        std::push_heap(active.begin(), active.end(), later);
+      }
+      else if (error)
+      {
+        return false;
+      }
+    }
+
+    if (active.empty())
+      break;
+
+    std::pop_heap(active.begin(), active.end(), later);
+    ChunkCursor *cursor = active.back();
+    active.pop_back();
+
+    const auto &topic = cursor->chunk.topics[cursor->topic];
+    if (!_cb(std::chrono::nanoseconds(cursor->time), topic.first,
+          topic.second, cursor->data, cursor->len))
+    {
+      return true;
+    }
+
+    if (cursor->Next(start, end, error))
+    {
+      active.push_back(cursor);
+      std::push_heap(active.begin(), active.end(), later);
+    }
+    else if (error)
+    {
+      return false;
+    }
+    else
+    {
+      // Release the decompressed messages.
+      std::string().swap(cursor->buffer);
+    }
+  }
+
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool ChunkedLog::Verify(const unsigned int _threads,
+    LogVerification &_result) const
+{
+  _result = LogVerification();
+  if (!this->dataPtr->reading)
+  {
+    LERR("The log file is not open for reading\n");
+    return false;
+  }
+
+  if (this->dataPtr->validSize < this->dataPtr->mappingSize)
+  {
+    LERR("Truncated chunk of [" << this->dataPtr->mappingSize -
+         this->dataPtr->validSize << "] bytes at the end of ["
+         << this->dataPtr->filename << "]\n");
+    _result.intact = false;
+  }
+
+  // Every thread takes the next chunk to check.
+  const std::vector<ChunkInfo> &chunks = this->dataPtr->chunks;
+  const std::size_t threads = std::min<std::size_t>(chunks.size(),
+    _threads > 0 ? _threads : std::thread::hardware_concurrency());
+  std::atomic<std::size_t> next(0);
+  std::atomic<uint64_t> messages(0);
+  std::atomic<uint64_t> corrupt(0);
+  std::vector<std::thread> workers;
+  for (std::size_t t = 0; t < std::max<std::size_t>(1, threads); ++t)
+  {
+    workers.emplace_back([&]()
+    {
+      for (std::size_t i = next++; i < chunks.size(); i = next++)
+      {
+        const ChunkInfo &chunk = chunks[i];
+        ChunkCursor cursor(chunk, i,
+          std::vector<bool>(chunk.topics.size(), true));
+        bool error = !cursor.Load();
+        uint32_t count = 0;
+        while (!error && cursor.Next(std::numeric_limits<int64_t>::min(),
+                 std::numeric_limits<int64_t>::max(), error))
+        {
+          ++count;
+        }
+        if (!error && count != chunk.count)
+        {
+          LERR("Chunk with an invalid number of messages\n");
+          error = true;
+        }
+
+        messages += chunk.count;
+        if (error)
+          corrupt += chunk.count;
+      }
+    });
+  }
+
+  for (std::thread &worker : workers)
+    worker.join();
+
+  _result.messages = messages;
+  _result.checked = messages;
+  _result.corrupt = corrupt;
+  return _result.intact && _result.corrupt == 0;
+}
+
+//////////////////////////////////////////////////
+bool ChunkedLog::IsChunkedLog(const std::string &_file)
+{
+  std::ifstream in(_file, std::ios_base::binary);
+  char magic[sizeof(kFileMagic)];
+  return in.read(magic, sizeof(magic)) &&
+    std::memcmp(magic, kFileMagic, sizeof(kFileMagic)) == 0;
+}
+
+//////////////////////////////////////////////////
+bool log::ConvertLog(const std::string &_src, const std::string &_dst,
+    const LogOptions &_options)
+{
+  std::error_code ec;
+  if (std::filesystem::exists(_dst, ec))
+  {
+    LERR("The file [" << _dst << "] already exists\n");
+    return false;
+  }
+
+  const bool srcIsChunked = ChunkedLog::IsChunkedLog(_src);
+  Log sqliteSrc;
+  ChunkedLog chunkedSrc;
+  if (srcIsChunked ? !chunkedSrc.Open(_src) : !sqliteSrc.Open(_src))
+    return false;
+
+  Log sqliteDst;
+  ChunkedLog chunkedDst;
+  ChunkedLogCallback insert;
+  if (_options.Format() == LogFormat::CHUNKED)
+  {
+    if (!chunkedDst.Open(_dst, std::ios_base::out, _options))
+      return false;
+
+    insert = [&chunkedDst](const std::chrono::nanoseconds &_time,
+        const std::string &_topic, const std::string &_type,
+        const char *_data, std::size_t _len)
+    {
+      return chunkedDst.InsertMessage(_time, _topic, _type, _data, _len);
+    };
+  }
+  else
+  {
+    if (!sqliteDst.Open(_dst, std::ios_base::out, _options))
+      return false;
+
+    insert = [&sqliteDst](const std::chrono::nanoseconds &_time,
+        const std::string &_topic, const std::string &_type,
+        const char *_data, std::size_t _len)
+    {
+      // A SQLite log can't store empty messages, see Log::InsertMessage.
+      return _len == 0 ||
+        sqliteDst.InsertMessage(_time, _topic, _type, _data, _len);
+    };
+  }
+
+  uint64_t count = 0;
+  bool success = true;
+  if (srcIsChunked)
+  {
+    success = chunkedSrc.ForEachMessage(
+      [&](const std::chrono::nanoseconds &_time, const std::string &_topic,
+          const std::string &_type, const char *_data, std::size_t _len)
+      {
+        if (!insert(_time, _topic, _type, _data, _len))
+          return false;
+        ++count;
+        return true;
+      });
+    success = success && count == chunkedSrc.MessageCount();
+  }
+  else
+  {
+    for (const Message &msg : sqliteSrc.QueryMessages())
+    {
+      const std::string_view data = msg.DataView();
+      if (!insert(msg.TimeReceived(), msg.Topic(), msg.Type(), data.data(),
+            data.size()))
+      {
+        success = false;
+        break;
+      }
+      ++count;
+    }
+  }
+
+  if (!success)
+  {
+    LERR("Failed to convert [" << _src << "] after [" << count
+         << "] messages\n");
+    return false;
+  }
+
+  LDBG("Converted [" << count << "] messages from [" << _src << "] to ["
+       << _dst << "]\n");
+  if (_options.Format() == LogFormat::CHUNKED)
+    return chunkedDst.Flush();
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool log::VerifyLog(const std::string &_file, const unsigned int _threads,
+    LogVerification &_result)
+{
+  _result = LogVerification();
+  if (ChunkedLog::IsChunkedLog(_file))
+  {
+    ChunkedLog chunked;
+    return chunked.Open(_file) && chunked.Verify(_threads, _result);
+  }
+
+  Log sqlite;
+  return sqlite.Open(_file, std::ios_base::in) &&
+    sqlite.Verify(_threads, _result);
+}
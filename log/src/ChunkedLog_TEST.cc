@@ -0,0 +1,398 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <ios>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "gz/transport/log/ChunkedLog.hh"
+#include "gz/transport/log/Log.hh"
+#include "gz/transport/log/LogOptions.hh"
+
+#include "test_utils.hh"
+
+using namespace gz;
+using namespace gz::transport;
+
+/// \brief A message read from a log.
+struct ReadMessage
+{
+  int64_t time;
+  std::string topic;
+  std::string type;
+  std::string data;
+};
+
+//////////////////////////////////////////////////
+/// \brief Get a temporary file name.
+/// \param[in] _name Prefix of the name.
+/// \return The path.
+static std::filesystem::path tempLog(const std::string &_name)
+{
+  return std::filesystem::temp_directory_path() /
+    ("gz_" + _name + "_" + testing::getRandomNumber() + ".tlog");
+}
+
+//////////////////////////////////////////////////
+/// \brief Read the messages of a chunked log.
+/// \param[in] _log The log.
+/// \param[in] _topics Topics to read.
+/// \param[in] _start Time of the first message.
+/// \param[in] _end Time of the last message.
+/// \return The messages.
+static std::vector<ReadMessage> readAll(const log::ChunkedLog &_log,
+  const std::set<std::string> &_topics = {},
+  const std::chrono::nanoseconds &_start = std::chrono::nanoseconds::min(),
+  const std::chrono::nanoseconds &_end = std::chrono::nanoseconds::max())
+{
+  std::vector<ReadMessage> messages;
+  EXPECT_TRUE(_log.ForEachMessage(
+    [&messages](const std::chrono::nanoseconds &_time,
+      const std::string &_topic, const std::string &_type,
+      const char *_data, std::size_t _len)
+    {
+      messages.push_back({_time.count(), _topic, _type,
+        std::string(_data, _len)});
+      return true;
+    }, _topics, _start, _end));
+  return messages;
+}
+
+//////////////////////////////////////////////////
+/// \brief Write 300 messages on three topics. The times of the topics are
+/// interleaved and slightly out of order between consecutive messages.
+/// \param[in] _file Path to the log file.
+/// \param[in] _options Options of the log.
+static void writeLog(const std::string &_file,
+  const log::LogOptions &_options)
+{
+  log::ChunkedLog logFile;
+  ASSERT_TRUE(logFile.Open(_file, std::ios_base::out, _options));
+  EXPECT_TRUE(logFile.Valid());
+  EXPECT_EQ(_file, logFile.Filename());
+
+  const std::string topics[] = {"/foo", "/bar", "/baz"};
+  const std::string type = "gz.msgs.StringMsg";
+  for (int i = 0; i < 300; ++i)
+  {
+    const std::string data = "message " + std::to_string(i);
+    const int64_t time = (i % 2 == 0) ? i + 1 : i - 1;
+    EXPECT_TRUE(logFile.InsertMessage(std::chrono::nanoseconds(time),
+      topics[i % 3], type, data.data(), data.size()));
+  }
+  EXPECT_EQ(300u, logFile.MessageCount());
+  EXPECT_EQ(0, logFile.StartTime().count());
+  EXPECT_EQ(299, logFile.EndTime().count());
+}
+
+//////////////////////////////////////////////////
+TEST(ChunkedLog, UnopenedLog)
+{
+  log::ChunkedLog logFile;
+  EXPECT_FALSE(logFile.Valid());
+  EXPECT_EQ("", logFile.Filename());
+  EXPECT_EQ(0u, logFile.ChunkCount());
+  EXPECT_EQ(0, logFile.StartTime().count());
+  EXPECT_FALSE(logFile.InsertMessage(std::chrono::nanoseconds(1), "/foo",
+    "type", "data", 4));
+  EXPECT_FALSE(logFile.Flush());
+  EXPECT_FALSE(logFile.ForEachMessage(
+    [](const std::chrono::nanoseconds &, const std::string &,
+      const std::string &, const char *, std::size_t)
+    {
+      return true;
+    }));
+  EXPECT_FALSE(logFile.Open("/this/path/does/not/exist.tlog"));
+  EXPECT_FALSE(log::ChunkedLog::IsChunkedLog("/this/path/does/not/exist"));
+}
+
+//////////////////////////////////////////////////
+TEST(ChunkedLog, WriteAndRead)
+{
+  const std::filesystem::path file = tempLog("chunked");
+  log::LogOptions options;
+  ASSERT_TRUE(options.SetChunkSize(1024));
+  writeLog(file.string(), options);
+  EXPECT_TRUE(log::ChunkedLog::IsChunkedLog(file.string()));
+
+  log::ChunkedLog logFile;
+  ASSERT_TRUE(logFile.Open(file.string()));
+  EXPECT_GT(logFile.ChunkCount(), 4u);
+  EXPECT_EQ(300u, logFile.MessageCount());
+  EXPECT_EQ(0, logFile.StartTime().count());
+  EXPECT_EQ(299, logFile.EndTime().count());
+  EXPECT_EQ(3u, logFile.Topics().size());
+  EXPECT_EQ(1u, logFile.Topics().count({"/bar", "gz.msgs.StringMsg"}));
+
+  // All the messages, in time order across the chunks.
+  std::vector<ReadMessage> messages = readAll(logFile);
+  ASSERT_EQ(300u, messages.size());
+  for (std::size_t i = 1; i < messages.size(); ++i)
+    EXPECT_LE(messages[i - 1].time, messages[i].time);
+  EXPECT_EQ("message 1", messages[0].data);
+  EXPECT_EQ("/bar", messages[0].topic);
+  EXPECT_EQ("gz.msgs.StringMsg", messages[0].type);
+
+  // A topic.
+  messages = readAll(logFile, {"/baz"});
+  ASSERT_EQ(100u, messages.size());
+  for (const auto &msg : messages)
+    EXPECT_EQ("/baz", msg.topic);
+
+  // A time range.
+  messages = readAll(logFile, {}, std::chrono::nanoseconds(100),
+    std::chrono::nanoseconds(109));
+  ASSERT_EQ(10u, messages.size());
+  EXPECT_EQ(100, messages.front().time);
+  EXPECT_EQ(109, messages.back().time);
+
+  // Nothing.
+  EXPECT_TRUE(readAll(logFile, {"/nothing"}).empty());
+
+  // Stop early.
+  int count = 0;
+  EXPECT_TRUE(logFile.ForEachMessage(
+    [&count](const std::chrono::nanoseconds &, const std::string &,
+      const std::string &, const char *, std::size_t)
+    {
+      return ++count < 5;
+    }));
+  EXPECT_EQ(5, count);
+
+  // A log can't be open twice.
+  EXPECT_FALSE(logFile.Open(file.string()));
+  logFile.Close();
+  EXPECT_FALSE(logFile.Valid());
+
+  std::filesystem::remove(file);
+}
+
+//////////////////////////////////////////////////
+TEST(ChunkedLog, Compression)
+{
+  for (const auto codec : {Compression_t::LZ4, Compression_t::ZSTD})
+  {
+    log::LogOptions options;
+    ASSERT_TRUE(options.SetChunkSize(4096));
+    if (!options.SetChunkCompression(codec))
+      continue;
+
+    const std::filesystem::path file = tempLog("compressed");
+    writeLog(file.string(), options);
+
+    log::ChunkedLog logFile;
+    ASSERT_TRUE(logFile.Open(file.string()));
+    const std::vector<ReadMessage> messages = readAll(logFile);
+    ASSERT_EQ(300u, messages.size());
+    EXPECT_EQ("message 1", messages[0].data);
+    logFile.Close();
+
+    std::filesystem::remove(file);
+  }
+}
+
+//////////////////////////////////////////////////
+TEST(ChunkedLog, TruncatedAndAppend)
+{
+  const std::filesystem::path file = tempLog("truncated");
+  log::LogOptions options;
+  ASSERT_TRUE(options.SetChunkSize(1024));
+  writeLog(file.string(), options);
+
+  std::size_t chunks;
+  {
+    log::ChunkedLog logFile;
+    ASSERT_TRUE(logFile.Open(file.string()));
+    chunks = logFile.ChunkCount();
+  }
+
+  // A crash in the middle of the last chunk.
+  std::filesystem::resize_file(file, std::filesystem::file_size(file) - 10);
+  uint64_t remaining;
+  {
+    log::ChunkedLog logFile;
+    ASSERT_TRUE(logFile.Open(file.string()));
+    EXPECT_EQ(chunks - 1, logFile.ChunkCount());
+    remaining = logFile.MessageCount();
+    EXPECT_LT(remaining, 300u);
+    EXPECT_EQ(remaining, readAll(logFile).size());
+  }
+
+  // Appending discards the truncated chunk.
+  {
+    log::ChunkedLog logFile;
+    ASSERT_TRUE(logFile.Open(file.string(), std::ios_base::out, options));
+    EXPECT_EQ(remaining, logFile.MessageCount());
+    EXPECT_TRUE(logFile.InsertMessage(std::chrono::nanoseconds(1000), "/new",
+      "type", "data", 4));
+  }
+  {
+    log::ChunkedLog logFile;
+    ASSERT_TRUE(logFile.Open(file.string()));
+    EXPECT_EQ(chunks, logFile.ChunkCount());
+    const std::vector<ReadMessage> messages = readAll(logFile);
+    ASSERT_EQ(remaining + 1, messages.size());
+    EXPECT_EQ("/new", messages.back().topic);
+  }
+
+  std::filesystem::remove(file);
+}
+
+//////////////////////////////////////////////////
+TEST(ChunkedLog, AsyncIo)
+{
+  const std::filesystem::path file = tempLog("async");
+  log::LogOptions options;
+  ASSERT_TRUE(options.SetChunkSize(64 * 1024));
+  ASSERT_TRUE(options.SetChunkIoDepth(4));
+
+  // Several MiB, so that blocks are in flight, plus a flushed chunk.
+  const std::string data(10000, 'x');
+  {
+    log::ChunkedLog logFile;
+    ASSERT_TRUE(logFile.Open(file.string(), std::ios_base::out, options));
+    for (int i = 0; i < 1000; ++i)
+    {
+      EXPECT_TRUE(logFile.InsertMessage(std::chrono::nanoseconds(i), "/big",
+        "type", data.data(), data.size()));
+    }
+    EXPECT_TRUE(logFile.Flush());
+
+    log::ChunkedLog reader;
+    ASSERT_TRUE(reader.Open(file.string()));
+    EXPECT_EQ(1000u, reader.MessageCount());
+  }
+
+  // Append asynchronously to the file.
+  {
+    log::ChunkedLog logFile;
+    ASSERT_TRUE(logFile.Open(file.string(), std::ios_base::out, options));
+    EXPECT_TRUE(logFile.InsertMessage(std::chrono::nanoseconds(1000), "/new",
+      "type", "data", 4));
+  }
+
+  log::ChunkedLog logFile;
+  ASSERT_TRUE(logFile.Open(file.string()));
+  const std::vector<ReadMessage> messages = readAll(logFile);
+  ASSERT_EQ(1001u, messages.size());
+  EXPECT_EQ(data, messages[500].data);
+  EXPECT_EQ("/new", messages.back().topic);
+
+  log::LogVerification result;
+  EXPECT_TRUE(logFile.Verify(2, result));
+  EXPECT_TRUE(result.intact);
+
+  std::filesystem::remove(file);
+}
+
+//////////////////////////////////////////////////
+TEST(ChunkedLog, Verify)
+{
+  const std::filesystem::path file = tempLog("verify");
+  log::LogOptions options;
+  ASSERT_TRUE(options.SetChunkSize(1024));
+  writeLog(file.string(), options);
+
+  log::LogVerification result;
+  EXPECT_TRUE(log::VerifyLog(file.string(), 4, result));
+  EXPECT_EQ(300u, result.messages);
+  EXPECT_EQ(300u, result.checked);
+  EXPECT_EQ(0u, result.corrupt);
+  EXPECT_TRUE(result.intact);
+
+  // A byte flipped in the messages of the first chunk.
+  {
+    std::fstream stream(file, std::ios_base::in | std::ios_base::out |
+      std::ios_base::binary);
+    stream.seekg(600);
+    const char c = static_cast<char>(stream.get());
+    stream.seekp(600);
+    stream.put(static_cast<char>(c ^ 0x20));
+  }
+  {
+    log::ChunkedLog logFile;
+    ASSERT_TRUE(logFile.Open(file.string()));
+    EXPECT_FALSE(logFile.Verify(2, result));
+    EXPECT_EQ(300u, result.messages);
+    EXPECT_LT(0u, result.corrupt);
+    EXPECT_GT(300u, result.corrupt);
+    EXPECT_TRUE(result.intact);
+  }
+
+  // A truncated last chunk.
+  std::filesystem::resize_file(file, std::filesystem::file_size(file) - 10);
+  EXPECT_FALSE(log::VerifyLog(file.string(), 0, result));
+  EXPECT_FALSE(result.intact);
+
+  EXPECT_FALSE(log::VerifyLog("/this/path/does/not/exist.tlog", 0, result));
+  std::filesystem::remove(file);
+}
+
+//////////////////////////////////////////////////
+TEST(ChunkedLog, Convert)
+{
+  const std::filesystem::path chunked = tempLog("convert");
+  const std::filesystem::path sqlite = tempLog("convert");
+  const std::filesystem::path back = tempLog("convert");
+  log::LogOptions options;
+  ASSERT_TRUE(options.SetChunkSize(1024));
+  writeLog(chunked.string(), options);
+
+  // Chunked to SQLite.
+  EXPECT_TRUE(log::ConvertLog(chunked.string(), sqlite.string(),
+    log::LogOptions()));
+  EXPECT_FALSE(log::ChunkedLog::IsChunkedLog(sqlite.string()));
+  {
+    log::Log logFile;
+    ASSERT_TRUE(logFile.Open(sqlite.string()));
+    EXPECT_EQ(0, logFile.StartTime().count());
+    EXPECT_EQ(299, logFile.EndTime().count());
+    int count = 0;
+    for (const auto &msg : logFile.QueryMessages())
+    {
+      EXPECT_FALSE(msg.Data().empty());
+      ++count;
+    }
+    EXPECT_EQ(300, count);
+  }
+
+  // The destination must not exist.
+  EXPECT_FALSE(log::ConvertLog(chunked.string(), sqlite.string(),
+    log::LogOptions()));
+
+  // SQLite to chunked.
+  options.SetFormat(log::LogFormat::CHUNKED);
+  EXPECT_TRUE(log::ConvertLog(sqlite.string(), back.string(), options));
+  {
+    log::ChunkedLog logFile;
+    ASSERT_TRUE(logFile.Open(back.string()));
+    const std::vector<ReadMessage> messages = readAll(logFile);
+    ASSERT_EQ(300u, messages.size());
+    EXPECT_EQ("message 1", messages[0].data);
+    EXPECT_EQ(3u, logFile.Topics().size());
+  }
+
+  std::filesystem::remove(chunked);
+  std::filesystem::remove(sqlite);
+  std::filesystem::remove(back);
+}
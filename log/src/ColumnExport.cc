@@ -0,0 +1,181 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <regex>
+#include <set>
+#include <string>
+#include <system_error>
+#include <thread>
+
+#include "gz/transport/log/ColumnExport.hh"
+#include "gz/transport/log/Log.hh"
+#include "Console.hh"
+
+using namespace gz::transport;
+using namespace gz::transport::log;
+
+namespace
+{
+/// \brief Files of a part of a column export, written by one thread
+struct Part
+{
+  /// \brief Temporary directory of the part, renamed after its first time
+  /// when it's complete
+  std::filesystem::path dir;
+
+  /// \brief Time of the first message
+  int64_t firstTime{0};
+
+  /// \brief Time of every message
+  std::ofstream time;
+
+  /// \brief Topic id of every message
+  std::ofstream topic;
+
+  /// \brief Size of every message
+  std::ofstream size;
+
+  /// \brief The messages
+  std::ofstream data;
+};
+
+//////////////////////////////////////////////////
+/// \brief Append a value to a column.
+/// \param[in] _column The column
+/// \param[in] _value The value
+template <typename T>
+void Append(std::ofstream &_column, const T _value)
+{
+  _column.write(reinterpret_cast<const char *>(&_value), sizeof(_value));
+}
+}
+
+//////////////////////////////////////////////////
+bool log::ExportColumns(const std::string &_src, const std::string &_dir,
+    const std::regex &_topics, const unsigned int _threads)
+{
+  Log logFile;
+  if (!logFile.Open(_src, std::ios_base::in))
+  {
+    LERR("Could not open file [" << _src << "]\n");
+    return false;
+  }
+
+  const std::filesystem::path dir(_dir);
+  std::error_code ec;
+  if (std::filesystem::exists(dir, ec) ||
+      !std::filesystem::create_directories(dir, ec))
+  {
+    LERR("Could not create the directory [" << _dir << "]\n");
+    return false;
+  }
+
+  const Descriptor *desc = logFile.Descriptor();
+  std::set<std::string> topics;
+  std::ofstream csv(dir / "topics.csv");
+  csv << "id,topic,type\n";
+  for (const auto &topic : desc->TopicsToMsgTypesToId())
+  {
+    if (!std::regex_match(topic.first, _topics))
+      continue;
+
+    topics.insert(topic.first);
+    for (const auto &type : topic.second)
+      csv << type.second << "," << topic.first << "," << type.first << "\n";
+  }
+  csv.close();
+  if (!csv)
+  {
+    LERR("Could not write [" << (dir / "topics.csv").string() << "]\n");
+    return false;
+  }
+
+  if (topics.empty())
+    return true;
+
+  // Every thread of the scan reads its own range of time, so it writes its
+  // own part
+  std::mutex partsMutex;
+  std::map<std::thread::id, Part> parts;
+  auto callback = [&](const Message &_msg)
+  {
+    Part *part;
+    {
+      std::lock_guard<std::mutex> lock(partsMutex);
+      part = &parts[std::this_thread::get_id()];
+      if (part->dir.empty())
+      {
+        part->dir = dir / ("tmp-" + std::to_string(parts.size()));
+        part->firstTime = _msg.TimeReceived().count();
+      }
+    }
+
+    if (!part->data.is_open())
+    {
+      std::filesystem::create_directory(part->dir);
+      const auto mode = std::ios_base::out | std::ios_base::binary;
+      part->time.open(part->dir / "time", mode);
+      part->topic.open(part->dir / "topic", mode);
+      part->size.open(part->dir / "size", mode);
+      part->data.open(part->dir / "data", mode);
+    }
+
+    const std::string_view data = _msg.DataView();
+    Append<int64_t>(part->time, _msg.TimeReceived().count());
+    Append<int64_t>(part->topic, desc->TopicId(_msg.Topic(), _msg.Type()));
+    Append<uint64_t>(part->size, data.size());
+    part->data.write(data.data(), data.size());
+  };
+
+  bool success = logFile.ParallelScan(TopicList(topics), _threads, callback);
+
+  for (auto &entry : parts)
+  {
+    Part &part = entry.second;
+    part.time.close();
+    part.topic.close();
+    part.size.close();
+    part.data.close();
+    if (!part.time || !part.topic || !part.size || !part.data)
+    {
+      LERR("Could not write [" << part.dir.string() << "]\n");
+      success = false;
+      continue;
+    }
+
+    char name[32];
+    std::snprintf(name, sizeof(name), "part-%020lld",
+        static_cast<long long>(part.firstTime));
+    std::filesystem::rename(part.dir, dir / name, ec);
+    if (ec)
+    {
+      LERR("Could not rename [" << part.dir.string() << "]: "
+          << ec.message() << "\n");
+      success = false;
+    }
+  }
+
+  return success;
+}
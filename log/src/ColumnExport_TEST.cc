@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <regex>
+#include <string>
+#include <vector>
+
+#include "gz/transport/log/ColumnExport.hh"
+#include "gz/transport/log/Log.hh"
+
+#include "test_utils.hh"
+
+using namespace gz;
+using namespace gz::transport;
+
+//////////////////////////////////////////////////
+/// \brief Read a column of a column export.
+/// \param[in] _file The file of the column
+/// \return The values
+template <typename T>
+std::vector<T> ReadColumn(const std::filesystem::path &_file)
+{
+  std::vector<T> values(std::filesystem::file_size(_file) / sizeof(T));
+  std::ifstream fin(_file, std::ios_base::binary);
+  fin.read(reinterpret_cast<char *>(values.data()),
+      static_cast<std::streamsize>(values.size() * sizeof(T)));
+  return values;
+}
+
+//////////////////////////////////////////////////
+TEST(ColumnExport, Export)
+{
+  const std::filesystem::path dir = std::filesystem::temp_directory_path() /
+    ("gz_export_" + testing::getRandomNumber());
+  ASSERT_TRUE(std::filesystem::create_directory(dir));
+  const std::string file = (dir / "run.tlog").string();
+
+  {
+    log::Log logFile;
+    ASSERT_TRUE(logFile.Open(file, std::ios_base::out));
+    for (int i = 0; i < 1000; ++i)
+    {
+      const std::string data = std::to_string(i);
+      EXPECT_TRUE(logFile.InsertMessage(std::chrono::milliseconds(i),
+          i % 4 == 0 ? "/a" : "/b", "some.message.type", data.c_str(),
+          data.size()));
+    }
+  }
+
+  const std::filesystem::path out = dir / "export";
+  ASSERT_TRUE(log::ExportColumns(file, out.string(), std::regex("/a"), 3));
+
+  // The existing directory isn't overwritten
+  EXPECT_FALSE(log::ExportColumns(file, out.string(), std::regex("/a"), 3));
+
+  {
+    std::ifstream csv(out / "topics.csv");
+    std::string line;
+    std::getline(csv, line);
+    EXPECT_EQ("id,topic,type", line);
+    std::getline(csv, line);
+    EXPECT_EQ(",/a,some.message.type", line.substr(line.find(',')));
+    EXPECT_FALSE(std::getline(csv, line));
+  }
+
+  std::vector<std::filesystem::path> parts;
+  for (const auto &entry : std::filesystem::directory_iterator(out))
+  {
+    if (entry.is_directory())
+      parts.push_back(entry.path());
+  }
+  std::sort(parts.begin(), parts.end());
+  EXPECT_EQ(3u, parts.size());
+
+  // The parts sorted by name have the messages in order
+  int expected = 0;
+  for (const auto &part : parts)
+  {
+    const auto times = ReadColumn<int64_t>(part / "time");
+    const auto topics = ReadColumn<int64_t>(part / "topic");
+    const auto sizes = ReadColumn<uint64_t>(part / "size");
+    ASSERT_EQ(times.size(), topics.size());
+    ASSERT_EQ(times.size(), sizes.size());
+    ASSERT_FALSE(times.empty());
+
+    char name[32];
+    std::snprintf(name, sizeof(name), "part-%020lld",
+        static_cast<long long>(times[0]));
+    EXPECT_EQ(name, part.filename().string());
+
+    std::ifstream data(part / "data", std::ios_base::binary);
+    for (std::size_t i = 0; i < times.size(); ++i)
+    {
+      EXPECT_EQ(std::chrono::nanoseconds(
+          std::chrono::milliseconds(expected)).count(), times[i]);
+      EXPECT_EQ(topics[0], topics[i]);
+      std::string msg(sizes[i], '\0');
+      data.read(&msg[0], static_cast<std::streamsize>(msg.size()));
+      EXPECT_EQ(std::to_string(expected), msg);
+      expected += 4;
+    }
+  }
+  EXPECT_EQ(1000, expected);
+
+  // No matching topic only writes topics.csv
+  const std::filesystem::path empty = dir / "empty";
+  EXPECT_TRUE(log::ExportColumns(file, empty.string(),
+      std::regex("/none"), 0));
+  EXPECT_TRUE(std::filesystem::exists(empty / "topics.csv"));
+
+  EXPECT_FALSE(log::ExportColumns((dir / "missing.tlog").string(),
+      (dir / "missing").string(), std::regex(".+"), 0));
+
+  std::filesystem::remove_all(dir);
+}
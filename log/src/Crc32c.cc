@@ -0,0 +1,199 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+  #include <nmmintrin.h>
+  #define GZ_TRANSPORT_CRC32C_SSE42
+  #define GZ_TRANSPORT_CRC32C_TARGET __attribute__((target("sse4.2")))
+#elif defined(_M_X64)
+  #include <intrin.h>
+  #include <nmmintrin.h>
+  #define GZ_TRANSPORT_CRC32C_SSE42
+  #define GZ_TRANSPORT_CRC32C_TARGET
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+  #include <arm_acle.h>
+  #define GZ_TRANSPORT_CRC32C_ARMV8
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "Crc32c.hh"
+
+using namespace gz::transport;
+using namespace gz::transport::log;
+
+/// \brief Tables of the portable version, which processes 8 bytes at once
+/// ("slicing-by-8"). tables[0] is the usual byte-wise table of the
+/// reflected polynomial 0x82F63B78.
+struct Crc32cTables
+{
+  /// \brief The tables.
+  uint32_t tables[8][256];
+};
+
+//////////////////////////////////////////////////
+/// \brief Build the tables of the portable version.
+/// \return The tables.
+static constexpr Crc32cTables MakeTables()
+{
+  Crc32cTables result{};
+  for (uint32_t i = 0; i < 256; ++i)
+  {
+    uint32_t crc = i;
+    for (int bit = 0; bit < 8; ++bit)
+      crc = (crc >> 1) ^ ((crc & 1) ? 0x82F63B78u : 0u);
+    result.tables[0][i] = crc;
+  }
+  for (uint32_t i = 0; i < 256; ++i)
+  {
+    for (int t = 1; t < 8; ++t)
+    {
+      const uint32_t previous = result.tables[t - 1][i];
+      result.tables[t][i] =
+        (previous >> 8) ^ result.tables[0][previous & 0xFF];
+    }
+  }
+  return result;
+}
+
+/// \brief Tables of the portable version.
+static constexpr Crc32cTables kTables = MakeTables();
+
+//////////////////////////////////////////////////
+/// \brief Portable version of Crc32c(), on the inverted CRC.
+/// \param[in] _data The data.
+/// \param[in] _size Size of the data (bytes).
+/// \param[in] _crc Inverted CRC of the previous data.
+/// \return The inverted CRC.
+static uint32_t Crc32cPortable(const unsigned char *_data, std::size_t _size,
+    uint32_t _crc)
+{
+  const auto &t = kTables.tables;
+  while (_size >= 8)
+  {
+    const uint32_t low = _crc ^ (static_cast<uint32_t>(_data[0]) |
+      static_cast<uint32_t>(_data[1]) << 8 |
+      static_cast<uint32_t>(_data[2]) << 16 |
+      static_cast<uint32_t>(_data[3]) << 24);
+    _crc = t[7][low & 0xFF] ^ t[6][(low >> 8) & 0xFF] ^
+      t[5][(low >> 16) & 0xFF] ^ t[4][low >> 24] ^
+      t[3][_data[4]] ^ t[2][_data[5]] ^ t[1][_data[6]] ^ t[0][_data[7]];
+    _data += 8;
+    _size -= 8;
+  }
+  while (_size-- > 0)
+    _crc = (_crc >> 8) ^ t[0][(_crc ^ *_data++) & 0xFF];
+  return _crc;
+}
+
+#if defined(GZ_TRANSPORT_CRC32C_SSE42)
+//////////////////////////////////////////////////
+/// \brief Version of Crc32c() with the CRC32 instruction of SSE 4.2, on the
+/// inverted CRC.
+/// \param[in] _data The data.
+/// \param[in] _size Size of the data (bytes).
+/// \param[in] _crc Inverted CRC of the previous data.
+/// \return The inverted CRC.
+GZ_TRANSPORT_CRC32C_TARGET
+static uint32_t Crc32cHardware(const unsigned char *_data, std::size_t _size,
+    uint32_t _crc)
+{
+  uint64_t crc = _crc;
+  while (_size >= 8)
+  {
+    uint64_t word;
+    std::memcpy(&word, _data, sizeof(word));
+    crc = _mm_crc32_u64(crc, word);
+    _data += 8;
+    _size -= 8;
+  }
+  _crc = static_cast<uint32_t>(crc);
+  while (_size-- > 0)
+    _crc = _mm_crc32_u8(_crc, *_data++);
+  return _crc;
+}
+
+//////////////////////////////////////////////////
+/// \brief Check whether the CPU has the CRC32 instruction of SSE 4.2.
+/// \return True if it has it.
+static bool HasCrcInstructions()
+{
+#if defined(_M_X64)
+  int info[4];
+  __cpuid(info, 1);
+  return (info[2] & (1 << 20)) != 0;
+#else
+  return __builtin_cpu_supports("sse4.2");
+#endif
+}
+#elif defined(GZ_TRANSPORT_CRC32C_ARMV8)
+//////////////////////////////////////////////////
+/// \brief Version of Crc32c() with the CRC32C instructions of ARMv8, on the
+/// inverted CRC.
+/// \param[in] _data The data.
+/// \param[in] _size Size of the data (bytes).
+/// \param[in] _crc Inverted CRC of the previous data.
+/// \return The inverted CRC.
+static uint32_t Crc32cHardware(const unsigned char *_data, std::size_t _size,
+    uint32_t _crc)
+{
+  while (_size >= 8)
+  {
+    uint64_t word;
+    std::memcpy(&word, _data, sizeof(word));
+    _crc = __crc32cd(_crc, word);
+    _data += 8;
+    _size -= 8;
+  }
+  while (_size-- > 0)
+    _crc = __crc32cb(_crc, *_data++);
+  return _crc;
+}
+
+//////////////////////////////////////////////////
+/// \brief The CRC32C instructions are part of the target architecture.
+/// \return True.
+static bool HasCrcInstructions()
+{
+  return true;
+}
+#endif
+
+//////////////////////////////////////////////////
+bool log::Crc32cAccelerated()
+{
+#if defined(GZ_TRANSPORT_CRC32C_SSE42) || defined(GZ_TRANSPORT_CRC32C_ARMV8)
+  static const bool accelerated = HasCrcInstructions();
+  return accelerated;
+#else
+  return false;
+#endif
+}
+
+//////////////////////////////////////////////////
+uint32_t log::Crc32c(const void *_data, const std::size_t _size,
+    const uint32_t _crc)
+{
+  const unsigned char *data = static_cast<const unsigned char *>(_data);
+#if defined(GZ_TRANSPORT_CRC32C_SSE42) || defined(GZ_TRANSPORT_CRC32C_ARMV8)
+  if (Crc32cAccelerated())
+    return ~Crc32cHardware(data, _size, ~_crc);
+#endif
+  return ~Crc32cPortable(data, _size, ~_crc);
+}
@@ -0,0 +1,55 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GZ_TRANSPORT_LOG_CRC32C_HH_
+#define GZ_TRANSPORT_LOG_CRC32C_HH_
+
+#include <cstddef>
+#include <cstdint>
+
+#include <gz/transport/config.hh>
+
+namespace gz
+{
+  namespace transport
+  {
+    namespace log
+    {
+      // Inline bracket to help doxygen filtering.
+      inline namespace GZ_TRANSPORT_VERSION_NAMESPACE {
+      //
+      /// \internal
+      /// \brief Compute the CRC-32C (Castagnoli) of some data, with the CRC
+      /// instructions of SSE 4.2 or ARMv8 when the CPU has them. The CRC of
+      /// consecutive pieces of data is computed by passing the CRC of the
+      /// previous pieces: Crc32c(b, Crc32c(a)) is the CRC of a followed by b.
+      /// \param[in] _data The data.
+      /// \param[in] _size Size of the data (bytes).
+      /// \param[in] _crc CRC of the previous data.
+      /// \return The CRC.
+      uint32_t Crc32c(const void *_data, const std::size_t _size,
+          const uint32_t _crc = 0);
+
+      /// \internal
+      /// \brief Whether Crc32c() uses the CRC instructions of the CPU.
+      /// \return True if they are used, false for the portable version.
+      bool Crc32cAccelerated();
+      }
+    }
+  }
+}
+#endif
@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "Crc32c.hh"
+#include "gtest/gtest.h"
+
+using namespace gz::transport;
+
+//////////////////////////////////////////////////
+/// \brief The test vectors of RFC 3720, appendix B.4.
+TEST(Crc32c, KnownValues)
+{
+  EXPECT_EQ(0u, log::Crc32c(nullptr, 0));
+
+  const std::string digits = "123456789";
+  EXPECT_EQ(0xE3069283u, log::Crc32c(digits.data(), digits.size()));
+
+  std::string data(32, '\0');
+  EXPECT_EQ(0x8A9136AAu, log::Crc32c(data.data(), data.size()));
+
+  data.assign(32, '\xFF');
+  EXPECT_EQ(0x62A8AB43u, log::Crc32c(data.data(), data.size()));
+
+  for (std::size_t i = 0; i < data.size(); ++i)
+    data[i] = static_cast<char>(i);
+  EXPECT_EQ(0x46DD794Eu, log::Crc32c(data.data(), data.size()));
+
+  for (std::size_t i = 0; i < data.size(); ++i)
+    data[i] = static_cast<char>(31 - i);
+  EXPECT_EQ(0x113FDB5Cu, log::Crc32c(data.data(), data.size()));
+}
+
+//////////////////////////////////////////////////
+/// \brief The CRC of some data is the same in any number of pieces, at any
+/// alignment.
+TEST(Crc32c, Pieces)
+{
+  std::string data;
+  for (int i = 0; i < 1000; ++i)
+    data.push_back(static_cast<char>(i * 7 + 3));
+  const uint32_t whole = log::Crc32c(data.data(), data.size());
+
+  for (std::size_t split = 0; split <= 17; ++split)
+  {
+    uint32_t crc = log::Crc32c(data.data(), split);
+    crc = log::Crc32c(data.data() + split, data.size() - split, crc);
+    EXPECT_EQ(whole, crc) << split;
+  }
+
+  uint32_t crc = 0;
+  for (const char c : data)
+    crc = log::Crc32c(&c, 1, crc);
+  EXPECT_EQ(whole, crc);
+}
@@ -38,6 +38,13 @@ void Descriptor::Implementation::Reset(const TopicKeyMap &_columns)
   }
 }
 
+//////////////////////////////////////////////////
+void Descriptor::Implementation::Add(const TopicKey &_key, int64_t _id)
+{
+  this->topicsToMsgTypesToId[_key.topic][_key.type] = _id;
+  this->msgTypesToTopicsToId[_key.type][_key.topic] = _id;
+}
+
 //////////////////////////////////////////////////
 auto Descriptor::TopicsToMsgTypesToId() const -> const NameToMap &
 {
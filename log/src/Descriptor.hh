@@ -78,6 +78,11 @@ namespace gz
         /// \param[in] _topics The map of topics that the log contains.
         public: void Reset(const TopicKeyMap &_topics);
 
+        /// \internal Add a topic inserted in the log file being written.
+        /// \param[in] _key The topic name and message type.
+        /// \param[in] _id The topic_id of the topic.
+        public: void Add(const TopicKey &_key, int64_t _id);
+
 #ifdef _WIN32
 // Disable warning C4251 which is triggered by
 // std::unique_ptr
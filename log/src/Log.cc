@@ -17,22 +17,36 @@
 
 #include <sqlite3.h>
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cmath>
+#include <condition_variable>
 #include <cstdint>
 #include <cstdlib>
+#include <deque>
 #include <fstream>
 #include <functional>
+#include <limits>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <utility>
+#include <vector>
 
+#include "gz/transport/MessageTypes.hh"
 #include "gz/transport/log/Descriptor.hh"
 #include "gz/transport/log/Log.hh"
+#include "gz/transport/log/LogOptions.hh"
 #include "gz/transport/log/SqlStatement.hh"
 #include "BatchPrivate.hh"
 #include "build_config.hh"
 #include "Console.hh"
+#include "Crc32c.hh"
 #include "Descriptor.hh"
+#include "MessageBlocks.hh"
 #include "raii-sqlite3.hh"
 
 using namespace gz::transport;
@@ -58,18 +72,204 @@ class gz::transport::log::Log::Implementation
 
   /// \brief Get topic_id associated with a topic name and message type
   /// If the topic is not in the log it will be added
-  /// \note Invalidates the descriptor if a topic is inserted
+  /// \note Adds the topic to the descriptor if it is inserted
   /// \param[in] _name the name of the topic
   /// \param[in] _type the name of the message type
   /// \return topic_id or -1 if one could not be produced
   public: int64_t InsertOrGetTopicId(
       const std::string &_name, const std::string &_type);
 
+  /// \brief A message ready to be inserted in the messages table
+  public: struct Row
+  {
+    /// \brief Time the message was received
+    std::chrono::nanoseconds time;
+
+    /// \brief topic_id of the message
+    int64_t topic;
+
+    /// \brief Message data
+    const void *data;
+
+    /// \brief Number of bytes of data
+    std::size_t len;
+  };
+
+  /// \brief Add a message to the summary of its topic
+  /// \param[in] _topic topic_id of the message
+  /// \param[in] _time Time the message was received
+  /// \param[in] _len Size of the message
+  public: void CountMessage(int64_t _topic,
+      const std::chrono::nanoseconds &_time, std::size_t _len);
+
+  /// \brief Get the summary of the messages by topic_id: counted while they
+  /// are inserted in a log file being written, or else read from the
+  /// topic_summary table.
+  /// \return The summary or nullptr if the log file has no topic_summary
+  /// table.
+  public: const std::map<int64_t, TopicSummary> *Summary();
+
+  /// \brief Store the summary in the topic_summary table
+  /// \return true on success
+  public: bool WriteSummary();
+
+  /// \internal \sa Log::InsertMessages()
+  /// \param[out] _inserted Whether each message was inserted, or nullptr
+  public: std::size_t InsertMessages(
+      const std::vector<MessageRecord> &_messages,
+      std::vector<bool> *_inserted = nullptr);
+
+  /// \brief A message queued by Log::InsertMessageAsync()
+  public: struct AsyncMessage
+  {
+    /// \brief Time the message was received
+    std::chrono::nanoseconds time;
+
+    /// \brief Name of the topic
+    std::string topic;
+
+    /// \brief Name of the message type
+    std::string type;
+
+    /// \brief Message data
+    std::string data;
+
+    /// \brief Function called once the message is inserted, or nullptr
+    InsertCallback callback;
+  };
+
+  /// \brief Insert the messages queued by Log::InsertMessageAsync(), until
+  /// StopAsyncWriter() is called
+  public: void AsyncWriterThread();
+
+  /// \brief Wait until the queued messages are inserted, then stop the
+  /// writer thread
+  public: void StopAsyncWriter();
+
+  /// \brief Protects the asynchronous queue and counters
+  public: std::mutex asyncMutex;
+
+  /// \brief Serializes the insertions of the writer thread with the commit
+  /// of Log::Flush()
+  public: std::mutex writeMutex;
+
+  /// \brief Notified when messages are queued or inserted
+  public: std::condition_variable asyncCondVar;
+
+  /// \brief Messages queued by Log::InsertMessageAsync()
+  public: std::deque<AsyncMessage> asyncQueue;
+
+  /// \brief Size of the data of the queued messages
+  public: uint64_t asyncQueueBytes = 0;
+
+  /// \brief Sequence number of the last message queued
+  public: uint64_t asyncQueued = 0;
+
+  /// \brief Sequence number of the last message inserted, or which failed
+  public: uint64_t asyncDone = 0;
+
+  /// \brief True if a queued message failed since the last Log::Flush()
+  public: bool asyncFailed = false;
+
+  /// \brief True when the writer thread must exit
+  public: bool asyncStop = false;
+
+  /// \brief Thread inserting the queued messages, started by the first
+  /// Log::InsertMessageAsync()
+  public: std::thread asyncWriter;
+
   /// \brief Insert a message into the database
   public: bool InsertMessage(const std::chrono::nanoseconds &_time,
       int64_t _topic, const void *_data, std::size_t _len);
 
+  /// \brief Insert consecutive rows with a single statement
+  /// \param[in] _rows Rows
+  /// \param[in] _begin Index of the first row to insert
+  /// \param[in] _count Number of rows to insert, up to kMaxRowsPerStatement
+  /// \return true if the rows were inserted
+  public: bool InsertRows(const std::vector<Row> &_rows, std::size_t _begin,
+      std::size_t _count);
+
+  /// \brief Get the compiled statement inserting a number of rows
+  /// \param[in] _count Number of rows
+  /// \return The statement or nullptr if it couldn't be compiled
+  public: raii_sqlite3::Statement *InsertStatement(std::size_t _count);
+
+  /// \brief Messages of a topic waiting to be compressed together
+  public: struct PendingBlock
+  {
+    /// \brief Codec of the topic
+    Compression_t codec = Compression_t::NONE;
+
+    /// \brief Time each message was received
+    std::vector<std::chrono::nanoseconds> times;
+
+    /// \brief Size of each message
+    std::vector<uint32_t> sizes;
+
+    /// \brief The messages, one after the other
+    std::string data;
+  };
+
+  /// \brief Get the codec compressing the messages of a topic
+  /// \param[in] _topic topic_id of the topic
+  /// \param[in] _name Name of the topic
+  /// \return The codec
+  public: Compression_t TopicCodec(int64_t _topic, const std::string &_name);
+
+  /// \brief Add a message to the block of its topic. The block is written
+  /// when it's full.
+  /// \param[in] _topic topic_id of the message
+  /// \param[in] _codec Codec of the topic
+  /// \param[in] _time Time the message was received
+  /// \param[in] _data Message data
+  /// \param[in] _len Number of bytes of data
+  /// \return false if the block had to be written and it failed
+  public: bool BufferMessage(int64_t _topic, Compression_t _codec,
+      const std::chrono::nanoseconds &_time, const void *_data,
+      std::size_t _len);
+
+  /// \brief Compress a block and insert it with its messages
+  /// \param[in] _topic topic_id of the messages
+  /// \param[in] _block The block, emptied
+  /// \return true if the messages were inserted
+  public: bool FlushBlock(int64_t _topic, PendingBlock &_block);
+
+  /// \brief Insert the messages of all the blocks
+  /// \return true if all the messages were inserted
+  public: bool FlushBlocks();
+
+  /// \brief Read a schema file
+  /// \param[in] _version Version of the schema
+  /// \param[out] _schema Content of the file
+  /// \return True if the file was read
+  public: static bool ReadSchema(const std::string &_version,
+      std::string &_schema);
+
+  /// \brief Apply the options that must be set before creating the tables.
+  /// \param[in] _db Database.
+  /// \param[in] _options Log options.
+  /// \return True if the options were applied.
+  public: static bool ApplyCreationOptions(raii_sqlite3::Database &_db,
+      const LogOptions &_options);
+
+  /// \brief Apply the options of an open database.
+  /// \param[in] _db Database.
+  /// \param[in] _options Log options.
+  /// \param[in] _write True if the database is open for writing.
+  /// \return True if the options were applied.
+  public: static bool ApplyOptions(raii_sqlite3::Database &_db,
+      const LogOptions &_options, const bool _write);
+
+  /// \brief Run a PRAGMA statement.
+  /// \param[in] _db Database.
+  /// \param[in] _pragma The statement without the PRAGMA keyword.
+  /// \return True if the statement succeeded.
+  public: static bool Pragma(raii_sqlite3::Database &_db,
+      const std::string &_pragma);
+
   /// \brief Return true if enough time has passed since the last transaction
+  /// or if the transaction reached its maximum size
   /// \return true if the transaction has lasted long enough
   public: bool TimeForNewTransaction() const;
 
@@ -88,6 +288,16 @@ class gz::transport::log::Log::Implementation
   /// \brief duration between transactions
   public: std::chrono::milliseconds transactionPeriod;
 
+  /// \brief Bytes of message data inserted in the current transaction
+  public: uint64_t transactionBytes = 0;
+
+  /// \brief Messages inserted in the current transaction
+  public: uint64_t transactionRows = 0;
+
+  /// \brief Maximum number of rows inserted by a single statement. Each row
+  /// uses 3 of the 999 parameters that SQLite accepts by default.
+  public: static const std::size_t kMaxRowsPerStatement = 64;
+
   /// \brief Flag to track whether we need to generate a new Descriptor
   private: mutable bool needNewDescriptor = true;
 
@@ -102,8 +312,77 @@ class gz::transport::log::Log::Implementation
 
   /// \brief Time of the last message in the log file.
   public: std::chrono::nanoseconds endTime = std::chrono::nanoseconds(-1);
+
+  /// \brief Options used to open the log file.
+  public: LogOptions options;
+
+  /// \brief Compiled statements to insert messages, indexed by the number
+  /// of rows that they insert. The numbers are powers of two. They must be
+  /// destroyed before the database.
+  public: std::map<std::size_t, std::unique_ptr<raii_sqlite3::Statement>>
+    insertStatements;
+
+  /// \brief Compiled statement to insert a block of compressed messages
+  public: std::unique_ptr<raii_sqlite3::Statement> blockStatement;
+
+  /// \brief True if the messages use the encoding of the 0.2.0 schema,
+  /// see log/sql/0.2.0.sql
+  public: bool encodedBlobs = false;
+
+  /// \brief True if the CRC-32C of the messages written is stored.
+  public: bool checksums = false;
+
+  /// \brief True if the log file was opened for writing
+  public: bool writable = false;
+
+  /// \brief Summary of the messages by topic_id, see Summary()
+  public: std::map<int64_t, TopicSummary> summary;
+
+  /// \brief True if summary was counted or read
+  public: bool hasSummary = false;
+
+  /// \brief Codec of each topic_id
+  public: std::map<int64_t, Compression_t> topicCodecs;
+
+  /// \brief Messages waiting to be compressed, by topic_id
+  public: std::map<int64_t, PendingBlock> pendingBlocks;
 };
 
+/// \brief Add messages to a summary
+/// \param[in,out] _summary The summary
+/// \param[in] _messages Summary of the messages to add
+static void AddToSummary(TopicSummary &_summary,
+    const TopicSummary &_messages)
+{
+  if (_messages.messages == 0)
+    return;
+
+  if (_summary.messages == 0 || _messages.startTime < _summary.startTime)
+    _summary.startTime = _messages.startTime;
+  if (_summary.messages == 0 || _messages.endTime > _summary.endTime)
+    _summary.endTime = _messages.endTime;
+  _summary.messages += _messages.messages;
+  _summary.bytes += _messages.bytes;
+}
+
+/// \brief Index of the messages by topic and time, built when a log file
+/// that was written is closed, see LatestMessages
+static const char *kTopicTimeIndex =
+    "CREATE INDEX IF NOT EXISTS idx_topic_time_recv"
+    " ON messages (topic_id, time_recv);";
+
+/// \brief Creates the table of the metadata of a log, see Log::SetMetadata()
+static const char *kMetadataTable =
+    "CREATE TABLE IF NOT EXISTS metadata ("
+    "key TEXT PRIMARY KEY NOT NULL, value TEXT NOT NULL);";
+
+/// \brief Rows fetched at once by every thread of Log::ParallelScan()
+static const std::size_t kScanPrefetchRows = 1024;
+
+/// \brief Size of the data fetched at once by every thread of
+/// Log::ParallelScan()
+static const std::size_t kScanPrefetchBytes = 4 * 1024 * 1024;
+
 //////////////////////////////////////////////////
 const log::Descriptor *Log::Implementation::Descriptor() const
 {
@@ -119,7 +398,7 @@ const log::Descriptor *Log::Implementation::Descriptor() const
       "SELECT topics.id, topics.name, message_types.name FROM topics"
       " JOIN message_types ON topics.message_type_id = message_types.id;";
 
-    raii_sqlite3::Statement topicStatement(*(this->db), sql);
+    raii_sqlite3::CachedStatement topicStatement(this->db, sql);
     if (!topicStatement)
     {
       LERR("Failed to compile statement to get topic ids\n");
@@ -171,6 +450,95 @@ const log::Descriptor *Log::Implementation::Descriptor() const
   return &this->descriptor;
 }
 
+//////////////////////////////////////////////////
+bool Log::Implementation::Pragma(raii_sqlite3::Database &_db,
+    const std::string &_pragma)
+{
+  const std::string sql = "PRAGMA " + _pragma + ";";
+  int returnCode = sqlite3_exec(_db.Handle(), sql.c_str(), NULL, 0, nullptr);
+  if (returnCode != SQLITE_OK)
+  {
+    LERR("Failed to run [" << sql << "]: " << sqlite3_errmsg(_db.Handle())
+        << "\n");
+    return false;
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool Log::Implementation::ApplyCreationOptions(raii_sqlite3::Database &_db,
+    const LogOptions &_options)
+{
+  // The page size can't change once the tables exist.
+  if (_options.PageSize() != 0u &&
+      !Pragma(_db, "page_size = " + std::to_string(_options.PageSize())))
+  {
+    return false;
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool Log::Implementation::ApplyOptions(raii_sqlite3::Database &_db,
+    const LogOptions &_options, const bool _write)
+{
+  if (_write)
+  {
+    switch (_options.JournalMode())
+    {
+      case JournalMode::WAL:
+        if (!Pragma(_db, "journal_mode = WAL"))
+          return false;
+        break;
+      case JournalMode::MEMORY:
+        if (!Pragma(_db, "journal_mode = MEMORY"))
+          return false;
+        break;
+      case JournalMode::OFF:
+        if (!Pragma(_db, "journal_mode = OFF"))
+          return false;
+        break;
+      case JournalMode::DEFAULT:
+      default:
+        break;
+    }
+
+    switch (_options.Synchronous())
+    {
+      case SyncMode::OFF:
+        if (!Pragma(_db, "synchronous = OFF"))
+          return false;
+        break;
+      case SyncMode::NORMAL:
+        if (!Pragma(_db, "synchronous = NORMAL"))
+          return false;
+        break;
+      case SyncMode::FULL:
+        if (!Pragma(_db, "synchronous = FULL"))
+          return false;
+        break;
+      case SyncMode::DEFAULT:
+      default:
+        break;
+    }
+  }
+
+  // A negative cache size is a number of KiB instead of pages.
+  if (_options.CacheSize() != 0u &&
+      !Pragma(_db, "cache_size = -" + std::to_string(_options.CacheSize())))
+  {
+    return false;
+  }
+
+  if (_options.MmapSize() != 0u &&
+      !Pragma(_db, "mmap_size = " + std::to_string(_options.MmapSize())))
+  {
+    return false;
+  }
+
+  return true;
+}
+
 //////////////////////////////////////////////////
 int Log::Implementation::EndTransactionIfEnoughTimeHasPassed()
 {
@@ -186,6 +554,9 @@ int Log::Implementation::EndTransactionIfEnoughTimeHasPassed()
 //////////////////////////////////////////////////
 int Log::Implementation::EndTransaction()
 {
+  // The compressed messages belong to the transaction too
+  this->FlushBlocks();
+
   // End the transaction
   int returnCode = sqlite3_exec(
       this->db->Handle(), "END;", NULL, 0, nullptr);
@@ -213,6 +584,8 @@ int Log::Implementation::BeginTransactionIfNotInOne()
     return returnCode;
   }
   this->inTransaction = true;
+  this->transactionBytes = 0;
+  this->transactionRows = 0;
   LDBG("Began transaction\n");
   this->lastTransaction = std::chrono::steady_clock::now();
   return returnCode;
@@ -221,6 +594,14 @@ int Log::Implementation::BeginTransactionIfNotInOne()
 //////////////////////////////////////////////////
 bool Log::Implementation::TimeForNewTransaction() const
 {
+  const uint64_t maxBytes = this->options.MaxTransactionBytes();
+  const uint64_t maxRows = this->options.MaxTransactionRows();
+  if ((maxBytes > 0u && this->transactionBytes >= maxBytes) ||
+      (maxRows > 0u && this->transactionRows >= maxRows))
+  {
+    return true;
+  }
+
   auto now = std::chrono::steady_clock::now();
   return now - this->transactionPeriod > this->lastTransaction;
 }
@@ -244,25 +625,31 @@ int64_t Log::Implementation::InsertOrGetTopicId(
     return topicId;
   }
 
-  // Inserting a new topic invalidates the descriptor
-  this->needNewDescriptor = true;
+  // The descriptors of a message type are captured once, with its first
+  // topic, so the log can be decoded without the type compiled in. They
+  // are NULL if the type isn't known by this process.
+  const bool newType =
+    desc->MsgTypesToTopicsToId().count(_type) == 0;
+  const std::string protoDescriptor =
+    newType ? MessageTypes::Descriptors(_type) : std::string();
 
   // Otherwise insert it into the database and return the new topic_id
   const std::string sqlMessageType =
-    "INSERT OR IGNORE INTO message_types (name) VALUES (?001);";
+    "INSERT OR IGNORE INTO message_types (name, proto_descriptor)"
+    " VALUES (?001, ?002);";
   const std::string sqlTopic =
     "INSERT INTO topics (name, message_type_id)"
     " SELECT ?002, id FROM message_types WHERE name = ?001 LIMIT 1;";
 
-  raii_sqlite3::Statement messageTypeStatement(
-      *(this->db), sqlMessageType);
+  raii_sqlite3::CachedStatement messageTypeStatement(
+      this->db, sqlMessageType);
   if (!messageTypeStatement)
   {
     LERR("Failed to compile statement to insert message type\n");
     return -1;
   }
-  raii_sqlite3::Statement topicStatement(
-      *(this->db), sqlTopic);
+  raii_sqlite3::CachedStatement topicStatement(
+      this->db, sqlTopic);
   if (!topicStatement)
   {
     LERR("Failed to compile statement to insert topic\n");
@@ -282,6 +669,16 @@ int64_t Log::Implementation::InsertOrGetTopicId(
     LERR("Failed to bind message type name(1): " << returnCode << "\n");
     return -1;
   }
+  returnCode = protoDescriptor.empty() ?
+    sqlite3_bind_null(messageTypeStatement.Handle(), 2) :
+    sqlite3_bind_blob(messageTypeStatement.Handle(), 2,
+      protoDescriptor.data(), static_cast<int>(protoDescriptor.size()),
+      nullptr);
+  if (returnCode != SQLITE_OK)
+  {
+    LERR("Failed to bind message type descriptor: " << returnCode << "\n");
+    return -1;
+  }
   returnCode = sqlite3_bind_text(
       topicStatement.Handle(), 1, _type.c_str(), _type.size(), nullptr);
   if (returnCode != SQLITE_OK)
@@ -314,6 +711,10 @@ int64_t Log::Implementation::InsertOrGetTopicId(
   // topics.id is an alias for rowid
   int64_t id = sqlite3_last_insert_rowid(this->db->Handle());
   LDBG("Inserted '" << _name << "'[" << _type << "]\n");
+
+  // Add the topic to the descriptor rather than reading all the topics
+  // again, which made a burst of new topics quadratic.
+  this->descriptor.dataPtr->Add({_name, _type}, id);
   return id;
 }
 
@@ -332,246 +733,1065 @@ bool Log::Implementation::InsertMessage(
   if (_len == 0)
     return false;
 
-  int returnCode;
-  const std::string sql =
-    "INSERT INTO messages (time_recv, message, topic_id)"
-    "VALUES (?001, ?002, ?003);";
+  if (!this->encodedBlobs)
+    return this->InsertRows({{_time, _topic, _data, _len}}, 0, 1);
 
-  // Compile the statement
-  raii_sqlite3::Statement statement(*(this->db), sql);
-  if (!statement)
+  const std::string blob = EncodeRawMessage(_data, _len, this->checksums);
+  return this->InsertRows({{_time, _topic, blob.data(), blob.size()}}, 0, 1);
+}
+
+//////////////////////////////////////////////////
+raii_sqlite3::Statement *Log::Implementation::InsertStatement(
+    const std::size_t _count)
+{
+  auto &statement = this->insertStatements[_count];
+  if (statement)
+    return statement.get();
+
+  // Compile the statement once and reuse it
+  std::string sql = "INSERT INTO messages (time_recv, message, topic_id)"
+    " VALUES (?, ?, ?)";
+  for (std::size_t i = 1; i < _count; ++i)
+    sql += ", (?, ?, ?)";
+  sql += ";";
+
+  statement.reset(new raii_sqlite3::Statement(*(this->db), sql));
+  if (!*statement)
   {
     LERR("Failed to compile insert message statement\n");
-    return false;
+    statement.reset();
+    return nullptr;
   }
+  return statement.get();
+}
 
-  // Bind parameters
-  returnCode = sqlite3_bind_int64(statement.Handle(), 1, _time.count());
-  if (returnCode != SQLITE_OK)
-  {
-    LERR("Failed to bind time received: " << returnCode << "\n");
-    return false;
-  }
-  returnCode = sqlite3_bind_blob(statement.Handle(), 2, _data, _len, nullptr);
-  if (returnCode != SQLITE_OK)
-  {
-    LERR("Failed to bind message data: " << returnCode << "\n");
+//////////////////////////////////////////////////
+bool Log::Implementation::InsertRows(const std::vector<Row> &_rows,
+    const std::size_t _begin, const std::size_t _count)
+{
+  raii_sqlite3::Statement *statement = this->InsertStatement(_count);
+  if (!statement)
     return false;
-  }
-  returnCode = sqlite3_bind_int(statement.Handle(), 3, _topic);
-  if (returnCode != SQLITE_OK)
+
+  // Bind parameters
+  int returnCode = SQLITE_OK;
+  for (std::size_t i = 0; i < _count && returnCode == SQLITE_OK; ++i)
   {
-    LERR("Failed to bind topic_id: " << returnCode << "\n");
-    return false;
+    const Row &row = _rows[_begin + i];
+    const int param = static_cast<int>(3 * i);
+    returnCode = sqlite3_bind_int64(statement->Handle(), param + 1,
+        row.time.count());
+    if (returnCode != SQLITE_OK)
+    {
+      LERR("Failed to bind time received: " << returnCode << "\n");
+      break;
+    }
+    returnCode = sqlite3_bind_blob(statement->Handle(), param + 2, row.data,
+        row.len, nullptr);
+    if (returnCode != SQLITE_OK)
+    {
+      LERR("Failed to bind message data: " << returnCode << "\n");
+      break;
+    }
+    returnCode = sqlite3_bind_int64(statement->Handle(), param + 3,
+        row.topic);
+    if (returnCode != SQLITE_OK)
+    {
+      LERR("Failed to bind topic_id: " << returnCode << "\n");
+      break;
+    }
   }
 
   // Reset startTime and endTime
   this->startTime = std::chrono::nanoseconds(-1);
   this->endTime = std::chrono::nanoseconds(-1);
 
-
-  // Execute the statement
-  returnCode = sqlite3_step(statement.Handle());
+  // Execute the statement, and make it ready for the next messages
+  if (returnCode == SQLITE_OK)
+    returnCode = sqlite3_step(statement->Handle());
+  sqlite3_reset(statement->Handle());
+  sqlite3_clear_bindings(statement->Handle());
   if (returnCode != SQLITE_DONE)
   {
-    LERR("Failed to insert message. sqlite3 return code[" << returnCode
-        << "] data[" << _data << "] len[" << _len << "]\n");
+    LERR("Failed to insert " << _count << " messages. sqlite3 return code["
+        << returnCode << "]\n");
     return false;
   }
+
+  for (std::size_t i = 0; i < _count; ++i)
+    this->transactionBytes += _rows[_begin + i].len;
+  this->transactionRows += _count;
   return true;
 }
 
 //////////////////////////////////////////////////
-Log::Log()
-  : dataPtr(new Implementation)
+Compression_t Log::Implementation::TopicCodec(const int64_t _topic,
+    const std::string &_name)
 {
-  // Default to 2 transactions per second
-  this->dataPtr->transactionPeriod = std::chrono::milliseconds(500);
+  if (!this->encodedBlobs)
+    return Compression_t::NONE;
+
+  auto it = this->topicCodecs.find(_topic);
+  if (it == this->topicCodecs.end())
+  {
+    it = this->topicCodecs.emplace(
+      _topic, this->options.TopicCompression(_name)).first;
+  }
+  return it->second;
 }
 
 //////////////////////////////////////////////////
-Log::Log(Log &&_other)  // NOLINT
-  : dataPtr(std::move(_other.dataPtr))
+bool Log::Implementation::BufferMessage(const int64_t _topic,
+    const Compression_t _codec, const std::chrono::nanoseconds &_time,
+    const void *_data, const std::size_t _len)
 {
+  PendingBlock &block = this->pendingBlocks[_topic];
+  block.codec = _codec;
+  block.times.push_back(_time);
+  block.sizes.push_back(static_cast<uint32_t>(_len));
+  block.data.append(static_cast<const char *>(_data), _len);
+
+  if (block.data.size() < this->options.CompressionBlockSize())
+    return true;
+
+  return this->FlushBlock(_topic, block);
 }
 
 //////////////////////////////////////////////////
-Log::~Log()
+void Log::Implementation::CountMessage(const int64_t _topic,
+    const std::chrono::nanoseconds &_time, const std::size_t _len)
 {
-  if (this->dataPtr && this->dataPtr->inTransaction)
-  {
-    this->dataPtr->EndTransaction();
-  }
+  AddToSummary(this->summary[_topic], TopicSummary{1, _len, _time, _time});
 }
 
 //////////////////////////////////////////////////
-bool Log::Valid() const
+const std::map<int64_t, TopicSummary> *Log::Implementation::Summary()
 {
-  return this->dataPtr && this->dataPtr->db && *(this->dataPtr->db);
+  if (this->hasSummary)
+    return &this->summary;
+
+  // The table isn't part of a schema version, like the metadata table
+  raii_sqlite3::Statement statement(*this->db,
+      "SELECT topic_id, messages, bytes, start_time, end_time"
+      " FROM topic_summary;");
+  if (!statement)
+    return nullptr;
+
+  while (sqlite3_step(statement.Handle()) == SQLITE_ROW)
+  {
+    TopicSummary &topic =
+      this->summary[sqlite3_column_int64(statement.Handle(), 0)];
+    topic.messages = sqlite3_column_int64(statement.Handle(), 1);
+    topic.bytes = sqlite3_column_int64(statement.Handle(), 2);
+    topic.startTime =
+      std::chrono::nanoseconds(sqlite3_column_int64(statement.Handle(), 3));
+    topic.endTime =
+      std::chrono::nanoseconds(sqlite3_column_int64(statement.Handle(), 4));
+  }
+
+  this->hasSummary = true;
+  return &this->summary;
 }
 
 //////////////////////////////////////////////////
-bool Log::Open(const std::string &_file, const std::ios_base::openmode _mode)
+bool Log::Implementation::WriteSummary()
 {
-  // Open the SQLite3 database
-  if (this->dataPtr->db)
+  const char *createTable =
+    "BEGIN; CREATE TABLE IF NOT EXISTS topic_summary ("
+    "topic_id INTEGER PRIMARY KEY REFERENCES topics (id) ON DELETE CASCADE,"
+    " messages INTEGER NOT NULL, bytes INTEGER NOT NULL,"
+    " start_time INTEGER NOT NULL, end_time INTEGER NOT NULL);"
+    " DELETE FROM topic_summary;";
+  if (sqlite3_exec(this->db->Handle(), createTable, NULL, 0, nullptr) !=
+      SQLITE_OK)
   {
-    LERR("A database is already open\n");
+    LERR("Failed to create the topic_summary table: "
+        << sqlite3_errmsg(this->db->Handle()) << "\n");
+    sqlite3_exec(this->db->Handle(), "ROLLBACK;", NULL, 0, nullptr);
     return false;
   }
-  int64_t modeSQL = SQLITE_OPEN_URI;
-  if (std::ios_base::out & _mode)
-  {
-    modeSQL = modeSQL | SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE;
-  }
-  else if (std::ios_base::in & _mode)
-  {
-    modeSQL = modeSQL | SQLITE_OPEN_READONLY;
-  }
 
-  std::unique_ptr<raii_sqlite3::Database> db(
-      new raii_sqlite3::Database(_file, modeSQL));
-  if (!*(db))
+  raii_sqlite3::Statement statement(*this->db,
+      "INSERT INTO topic_summary (topic_id, messages, bytes, start_time,"
+      " end_time) VALUES (?, ?, ?, ?, ?);");
+  if (!statement)
   {
-    // The constructor of raii_sqlite3::Database will print out the reason that
-    // the database failed to open.
+    LERR("Failed to compile statement to insert topic summary\n");
+    sqlite3_exec(this->db->Handle(), "ROLLBACK;", NULL, 0, nullptr);
     return false;
   }
 
-  // Don't need to create a schema if this is read only
-  if (std::ios_base::out & _mode)
+  for (const auto &entry : this->summary)
   {
-    // Test hook so tests can be run before `make install`
-    std::string schemaFile;
-    const char *envPath = std::getenv(SchemaLocationEnvVar.c_str());
-
-    if (envPath)
-    {
-      schemaFile = envPath;
-    }
-    else
-    {
-      schemaFile = SCHEMA_INSTALL_PATH;
-    }
-    schemaFile += "/0.1.0.sql";
-
-    // Assume the database is uninitialized; use the schema to initialize it
-    LDBG("Schema file: " << schemaFile << "\n");
-    std::ifstream fin(schemaFile, std::ifstream::in);
-    if (!fin)
+    sqlite3_reset(statement.Handle());
+    sqlite3_bind_int64(statement.Handle(), 1, entry.first);
+    sqlite3_bind_int64(statement.Handle(), 2,
+        static_cast<sqlite3_int64>(entry.second.messages));
+    sqlite3_bind_int64(statement.Handle(), 3,
+        static_cast<sqlite3_int64>(entry.second.bytes));
+    sqlite3_bind_int64(statement.Handle(), 4,
+        entry.second.startTime.count());
+    sqlite3_bind_int64(statement.Handle(), 5, entry.second.endTime.count());
+    if (sqlite3_step(statement.Handle()) != SQLITE_DONE)
     {
-      LERR("Failed to open schema [" << schemaFile << "].\n"
-          << " Set " << SchemaLocationEnvVar << " to the schema location.\n");
+      LERR("Failed to insert topic summary: "
+          << sqlite3_errmsg(this->db->Handle()) << "\n");
+      sqlite3_exec(this->db->Handle(), "ROLLBACK;", NULL, 0, nullptr);
       return false;
     }
+  }
 
-    // Read the schema file
-    std::string schema;
-    char buffer[4096];
-    while (fin)
-    {
-      fin.read(buffer, sizeof(buffer));
-      schema.insert(schema.size(), buffer, fin.gcount());
-    }
-    if (schema.empty())
-    {
-      LERR("Failed to read schema file [" << schemaFile << "]\n");
-      return false;
-    }
+  return sqlite3_exec(this->db->Handle(), "COMMIT;", NULL, 0, nullptr) ==
+    SQLITE_OK;
+}
 
-    // Apply the schema to the database
-    int returnCode = sqlite3_exec(db->Handle(), schema.c_str(), NULL, 0, NULL);
-    if (returnCode != SQLITE_OK)
+//////////////////////////////////////////////////
+bool Log::Implementation::FlushBlock(const int64_t _topic,
+    PendingBlock &_block)
+{
+  if (_block.times.empty())
+    return true;
+
+  PendingBlock block;
+  std::swap(block, _block);
+
+  std::string compressed;
+  if (!EncodeBlock(block.codec, block.sizes, block.data, compressed))
+  {
+    LERR("Failed to compress " << block.times.size() << " messages\n");
+    return false;
+  }
+
+  // Insert the block
+  if (!this->blockStatement)
+  {
+    this->blockStatement.reset(new raii_sqlite3::Statement(*(this->db),
+      "INSERT INTO message_blocks (codec, data) VALUES (?001, ?002);"));
+    if (!*(this->blockStatement))
     {
-      LERR("Failed to open log: " << sqlite3_errmsg(db->Handle()) << "\n");
+      LERR("Failed to compile insert block statement\n");
+      this->blockStatement.reset();
       return false;
     }
   }
 
-  this->dataPtr->db = std::move(db);
-
-  // Check the schema version
-  // TODO(sloretz) handle multiple versions
-  std::string version = this->Version();
-  if ("0.1.0" != this->Version())
+  sqlite3_stmt *handle = this->blockStatement->Handle();
+  sqlite3_bind_int(handle, 1, static_cast<int>(block.codec));
+  sqlite3_bind_blob(handle, 2, compressed.data(),
+    static_cast<int>(compressed.size()), nullptr);
+  const int returnCode = sqlite3_step(handle);
+  sqlite3_reset(handle);
+  sqlite3_clear_bindings(handle);
+  if (returnCode != SQLITE_DONE)
   {
-    LERR("Log file Version '" << version << "' is unsupported by this tool\n");
-    this->dataPtr->db.reset();
+    LERR("Failed to insert a block of " << block.times.size()
+         << " messages. sqlite3 return code[" << returnCode << "]\n");
     return false;
   }
+  const int64_t blockId = sqlite3_last_insert_rowid(this->db->Handle());
+  this->transactionBytes += compressed.size();
+
+  // Insert the references to the messages of the block. The references
+  // don't move, their storage is reserved.
+  std::vector<std::string> references;
+  std::vector<Row> rows;
+  references.reserve(block.times.size());
+  rows.reserve(block.times.size());
+  BlockReference reference;
+  reference.block = blockId;
+  reference.checked = this->checksums;
+  std::size_t offset = 0;
+  for (std::size_t i = 0; i < block.times.size(); ++i)
+  {
+    reference.index = static_cast<uint32_t>(i);
+    if (this->checksums)
+      reference.crc = Crc32c(block.data.data() + offset, block.sizes[i]);
+    offset += block.sizes[i];
+    references.push_back(EncodeBlockReference(reference));
+    rows.push_back({block.times[i], _topic, references.back().data(),
+      references.back().size()});
+  }
 
-  this->dataPtr->filename = _file;
+  std::size_t inserted = 0;
+  while (inserted < rows.size())
+  {
+    std::size_t count = kMaxRowsPerStatement;
+    while (count > rows.size() - inserted)
+      count /= 2;
+
+    if (!this->InsertRows(rows, inserted, count))
+      return false;
+    inserted += count;
+  }
   return true;
 }
 
 //////////////////////////////////////////////////
-const log::Descriptor *Log::Descriptor() const
+bool Log::Implementation::FlushBlocks()
 {
-  return this->dataPtr->Descriptor();
+  bool success = true;
+  for (auto &block : this->pendingBlocks)
+    success = this->FlushBlock(block.first, block.second) && success;
+  return success;
 }
 
 //////////////////////////////////////////////////
-bool Log::InsertMessage(
-    const std::chrono::nanoseconds &_time,
-    const std::string &_topic, const std::string &_type,
-    const void *_data, const std::size_t _len)
+bool Log::Implementation::ReadSchema(const std::string &_version,
+    std::string &_schema)
 {
-  if (!this->Valid())
+  // Test hook so tests can be run before `make install`
+  std::string schemaFile;
+  const char *envPath = std::getenv(SchemaLocationEnvVar.c_str());
+
+  if (envPath)
   {
-    return false;
+    schemaFile = envPath;
   }
-
-  // Need to insert multiple messages pertransaction for best performance
-  if (SQLITE_OK != this->dataPtr->BeginTransactionIfNotInOne())
+  else
   {
-    return false;
+    schemaFile = SCHEMA_INSTALL_PATH;
   }
+  schemaFile += "/" + _version + ".sql";
 
-  // Get the topics.id for this name and message type
-  int64_t topicId = this->dataPtr->InsertOrGetTopicId(_topic, _type);
-  if (topicId < 0)
+  LDBG("Schema file: " << schemaFile << "\n");
+  std::ifstream fin(schemaFile, std::ifstream::in);
+  if (!fin)
   {
+    LERR("Failed to open schema [" << schemaFile << "].\n"
+        << " Set " << SchemaLocationEnvVar << " to the schema location.\n");
     return false;
   }
 
-  // Insert the message into the database
-  if (!this->dataPtr->InsertMessage(_time, topicId, _data, _len))
+  // Read the schema file
+  _schema.clear();
+  char buffer[4096];
+  while (fin)
   {
-    return false;
+    fin.read(buffer, sizeof(buffer));
+    _schema.insert(_schema.size(), buffer, fin.gcount());
   }
-
-  // Finish the transaction if enough time has passed
-  if (SQLITE_OK != this->dataPtr->EndTransactionIfEnoughTimeHasPassed())
+  if (_schema.empty())
   {
-    // Something is really busted if this happens
-    LERR("Failed to end transcation: "<< sqlite3_errmsg(
-        this->dataPtr->db->Handle()) << "\n");
+    LERR("Failed to read schema file [" << schemaFile << "]\n");
     return false;
   }
-
   return true;
 }
 
 //////////////////////////////////////////////////
-Batch Log::QueryMessages(const QueryOptions &_options)
+std::size_t Log::Implementation::InsertMessages(
+    const std::vector<MessageRecord> &_messages, std::vector<bool> *_inserted)
 {
-  const log::Descriptor *desc = this->Descriptor();
+  if (_inserted)
+    _inserted->assign(_messages.size(), false);
 
-  // Make sure the log has been initialized.
-  // TODO(anyone): Should we print a warning here?
-  if (!desc)
-    return Batch();
+  if (!this->db || !*this->db || _messages.empty())
+    return 0u;
 
-  std::unique_ptr<BatchPrivate> batchPriv(
-        new BatchPrivate(this->dataPtr->db,
-                         _options.GenerateStatements(*desc)));
+  // Need to insert multiple messages pertransaction for best performance
+  if (SQLITE_OK != this->BeginTransactionIfNotInOne())
+  {
+    return 0u;
+  }
 
-  return Batch(std::move(batchPriv));
-}
+  // Get the topics.id of every message. Consecutive messages usually belong
+  // to the same topic.
+  // The messages of the compressed topics go to the blocks of their topics.
+  // In a log with compressed topics, the other messages are prefixed with
+  // their encoding; the storage of the copies is reserved, so they don't
+  // move.
+  std::vector<Row> rows;
+  std::vector<std::size_t> rowMessages;
+  std::vector<std::string> blobs;
+  rows.reserve(_messages.size());
+  if (_inserted)
+    rowMessages.reserve(_messages.size());
+  if (this->encodedBlobs)
+    blobs.reserve(_messages.size());
+  std::size_t buffered = 0;
+  const MessageRecord *last = nullptr;
+  int64_t lastTopicId = -1;
+  Compression_t lastCodec = Compression_t::NONE;
+  for (std::size_t m = 0; m < _messages.size(); ++m)
+  {
+    const MessageRecord &msg = _messages[m];
+
+    // See Implementation::InsertMessage()
+    if (msg.len == 0 || !msg.topic || !msg.type)
+      continue;
+
+    if (!last || *last->topic != *msg.topic || *last->type != *msg.type)
+    {
+      last = &msg;
+      lastTopicId = this->InsertOrGetTopicId(*msg.topic, *msg.type);
+      if (lastTopicId >= 0)
+        lastCodec = this->TopicCodec(lastTopicId, *msg.topic);
+    }
+
+    if (lastTopicId < 0)
+      continue;
+
+    if (lastCodec != Compression_t::NONE)
+    {
+      if (this->BufferMessage(lastTopicId, lastCodec, msg.time,
+            msg.data, msg.len))
+      {
+        ++buffered;
+        this->CountMessage(lastTopicId, msg.time, msg.len);
+        if (_inserted)
+          (*_inserted)[m] = true;
+      }
+      continue;
+    }
+
+    if (this->encodedBlobs)
+    {
+      blobs.push_back(EncodeRawMessage(msg.data, msg.len, this->checksums));
+      rows.push_back({msg.time, lastTopicId, blobs.back().data(),
+        blobs.back().size()});
+    }
+    else
+    {
+      rows.push_back({msg.time, lastTopicId, msg.data, msg.len});
+    }
+    if (_inserted)
+      rowMessages.push_back(m);
+  }
+
+  // Insert the messages with as few statements as possible. The number of
+  // rows of each statement is a power of two, so only a few statements are
+  // compiled.
+  std::size_t inserted = 0;
+  while (inserted < rows.size())
+  {
+    std::size_t count = kMaxRowsPerStatement;
+    while (count > rows.size() - inserted)
+      count /= 2;
+
+    if (!this->InsertRows(rows, inserted, count))
+      break;
+
+    // The encoding isn't part of the message
+    const std::size_t prefix =
+      this->encodedBlobs ? RawMessageOverhead(this->checksums) : 0;
+    for (std::size_t i = inserted; i < inserted + count; ++i)
+    {
+      this->CountMessage(rows[i].topic, rows[i].time,
+          rows[i].len - prefix);
+      if (_inserted)
+        (*_inserted)[rowMessages[i]] = true;
+    }
+    inserted += count;
+
+    // Finish the transaction if it's long or big enough
+    if (SQLITE_OK != this->EndTransactionIfEnoughTimeHasPassed() ||
+        SQLITE_OK != this->BeginTransactionIfNotInOne())
+    {
+      // Something is really busted if this happens
+      LERR("Failed to end transcation: "<< sqlite3_errmsg(
+          this->db->Handle()) << "\n");
+      break;
+    }
+  }
+
+  // Finish the transaction if it's long enough, even if all the messages
+  // were buffered
+  if (SQLITE_OK != this->EndTransactionIfEnoughTimeHasPassed())
+  {
+    LERR("Failed to end transcation: "<< sqlite3_errmsg(
+        this->db->Handle()) << "\n");
+  }
+
+  return inserted + buffered;
+}
+
+//////////////////////////////////////////////////
+Log::Log()
+  : dataPtr(new Implementation)
+{
+  // Default to 2 transactions per second
+  this->dataPtr->transactionPeriod = std::chrono::milliseconds(500);
+}
+
+//////////////////////////////////////////////////
+Log::Log(Log &&_other)  // NOLINT
+  : dataPtr(std::move(_other.dataPtr))
+{
+}
+
+//////////////////////////////////////////////////
+Log::~Log()
+{
+  if (!this->dataPtr)
+    return;
+
+  this->dataPtr->StopAsyncWriter();
+
+  if (this->dataPtr->inTransaction)
+  {
+    this->dataPtr->EndTransaction();
+  }
+  this->dataPtr->insertStatements.clear();
+  this->dataPtr->blockStatement.reset();
+
+  if (this->dataPtr->writable && this->dataPtr->db && *(this->dataPtr->db))
+    this->dataPtr->WriteSummary();
+
+  // Index the messages by topic once they are all written, rather than on
+  // every insertion, so LatestMessages finds the last message of a topic
+  // without slowing the recording down.
+  if (this->dataPtr->writable && this->dataPtr->db && *(this->dataPtr->db))
+  {
+    if (sqlite3_exec(this->dataPtr->db->Handle(), kTopicTimeIndex, NULL, 0,
+          NULL) != SQLITE_OK)
+    {
+      LWRN("Failed to index the messages by topic: "
+          << sqlite3_errmsg(this->dataPtr->db->Handle()) << "\n");
+    }
+  }
+
+  // Leave a self-contained file: the write-ahead log is merged into the
+  // database and removed.
+  if (this->dataPtr->db && *(this->dataPtr->db) &&
+      this->dataPtr->options.JournalMode() == JournalMode::WAL)
+  {
+    Implementation::Pragma(*(this->dataPtr->db), "journal_mode = DELETE");
+  }
+}
+
+//////////////////////////////////////////////////
+bool Log::Valid() const
+{
+  return this->dataPtr && this->dataPtr->db && *(this->dataPtr->db);
+}
+
+//////////////////////////////////////////////////
+bool Log::Open(const std::string &_file, const std::ios_base::openmode _mode)
+{
+  return this->Open(_file, _mode, LogOptions());
+}
+
+//////////////////////////////////////////////////
+bool Log::Open(const std::string &_file, const std::ios_base::openmode _mode,
+    const LogOptions &_options)
+{
+  // Open the SQLite3 database
+  if (this->dataPtr->db)
+  {
+    LERR("A database is already open\n");
+    return false;
+  }
+  int64_t modeSQL = SQLITE_OPEN_URI;
+  if (std::ios_base::out & _mode)
+  {
+    modeSQL = modeSQL | SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE;
+  }
+  else if (std::ios_base::in & _mode)
+  {
+    modeSQL = modeSQL | SQLITE_OPEN_READONLY;
+  }
+
+  std::unique_ptr<raii_sqlite3::Database> db(
+      new raii_sqlite3::Database(_file, modeSQL));
+  if (!*(db))
+  {
+    // The constructor of raii_sqlite3::Database will print out the reason that
+    // the database failed to open.
+    return false;
+  }
+
+  // Don't need to create a schema if this is read only
+  if (std::ios_base::out & _mode)
+  {
+    // Assume the database is uninitialized; use the schema to initialize it
+    std::string schema;
+    if (!Implementation::ReadSchema("0.1.0", schema))
+      return false;
+
+    // The messages of a log with compressed topics or checksums use the
+    // 0.2.0 encoding
+    std::string migration;
+    if ((_options.HasTopicCompression() || _options.MessageChecksums()) &&
+        !Implementation::ReadSchema("0.2.0", migration))
+    {
+      return false;
+    }
+    schema += migration;
+
+    if (!Implementation::ApplyCreationOptions(*db, _options))
+      return false;
+
+    // Apply the schema to the database
+    int returnCode = sqlite3_exec(db->Handle(), schema.c_str(), NULL, 0, NULL);
+    if (returnCode != SQLITE_OK)
+    {
+      LERR("Failed to open log: " << sqlite3_errmsg(db->Handle()) << "\n");
+      return false;
+    }
+  }
+
+  if (!Implementation::ApplyOptions(*db, _options,
+        (std::ios_base::out & _mode) != 0))
+  {
+    return false;
+  }
+
+  this->dataPtr->db = std::move(db);
+  this->dataPtr->options = _options;
+  this->dataPtr->transactionPeriod = _options.TransactionPeriod();
+
+  // Check the schema version
+  std::string version = this->Version();
+  if ("0.1.0" != version && "0.2.0" != version)
+  {
+    LERR("Log file Version '" << version << "' is unsupported by this tool\n");
+    this->dataPtr->db.reset();
+    return false;
+  }
+  this->dataPtr->encodedBlobs = "0.2.0" == version;
+  this->dataPtr->checksums = this->dataPtr->encodedBlobs &&
+    _options.MessageChecksums();
+  this->dataPtr->writable = (std::ios_base::out & _mode) != 0;
+  this->dataPtr->hasSummary = this->dataPtr->writable;
+
+  this->dataPtr->filename = _file;
+  return true;
+}
+
+//////////////////////////////////////////////////
+const log::Descriptor *Log::Descriptor() const
+{
+  return this->dataPtr->Descriptor();
+}
+
+//////////////////////////////////////////////////
+bool Log::InsertMessage(
+    const std::chrono::nanoseconds &_time,
+    const std::string &_topic, const std::string &_type,
+    const void *_data, const std::size_t _len)
+{
+  if (!this->Valid())
+  {
+    return false;
+  }
+
+  // Need to insert multiple messages pertransaction for best performance
+  if (SQLITE_OK != this->dataPtr->BeginTransactionIfNotInOne())
+  {
+    return false;
+  }
+
+  // Get the topics.id for this name and message type
+  int64_t topicId = this->dataPtr->InsertOrGetTopicId(_topic, _type);
+  if (topicId < 0)
+  {
+    return false;
+  }
+
+  // Insert the message into the database, or into the block of its topic
+  const Compression_t codec = this->dataPtr->TopicCodec(topicId, _topic);
+  if (codec != Compression_t::NONE && _len > 0)
+  {
+    if (!this->dataPtr->BufferMessage(topicId, codec, _time, _data, _len))
+    {
+      return false;
+    }
+  }
+  else if (!this->dataPtr->InsertMessage(_time, topicId, _data, _len))
+  {
+    return false;
+  }
+  this->dataPtr->CountMessage(topicId, _time, _len);
+
+  // Finish the transaction if enough time has passed
+  if (SQLITE_OK != this->dataPtr->EndTransactionIfEnoughTimeHasPassed())
+  {
+    // Something is really busted if this happens
+    LERR("Failed to end transcation: "<< sqlite3_errmsg(
+        this->dataPtr->db->Handle()) << "\n");
+    return false;
+  }
+
+  return true;
+}
+
+//////////////////////////////////////////////////
+std::size_t Log::InsertMessages(const std::vector<MessageRecord> &_messages)
+{
+  if (!this->Valid())
+    return 0u;
+
+  return this->dataPtr->InsertMessages(_messages);
+}
+
+//////////////////////////////////////////////////
+void Log::Implementation::AsyncWriterThread()
+{
+  std::unique_lock<std::mutex> lk(this->asyncMutex);
+  while (true)
+  {
+    this->asyncCondVar.wait(lk, [this]
+    {
+      return this->asyncStop || !this->asyncQueue.empty();
+    });
+    if (this->asyncQueue.empty())
+      return;
+
+    // Take all the queued messages at once, so they are inserted by groups
+    // and the callers can queue more in the meantime
+    std::deque<AsyncMessage> batch;
+    batch.swap(this->asyncQueue);
+    this->asyncQueueBytes = 0;
+    this->asyncCondVar.notify_all();
+
+    std::vector<MessageRecord> records;
+    records.reserve(batch.size());
+    for (const AsyncMessage &msg : batch)
+    {
+      records.push_back(
+        {msg.time, &msg.topic, &msg.type, msg.data.data(), msg.data.size()});
+    }
+
+    lk.unlock();
+    std::vector<bool> inserted;
+    {
+      std::lock_guard<std::mutex> writeLk(this->writeMutex);
+      this->InsertMessages(records, &inserted);
+    }
+
+    bool success = true;
+    for (std::size_t i = 0; i < batch.size(); ++i)
+    {
+      success = success && inserted[i];
+      if (batch[i].callback)
+        batch[i].callback(inserted[i]);
+    }
+
+    lk.lock();
+    this->asyncDone += batch.size();
+    this->asyncFailed = this->asyncFailed || !success;
+    this->asyncCondVar.notify_all();
+  }
+}
+
+//////////////////////////////////////////////////
+void Log::Implementation::StopAsyncWriter()
+{
+  {
+    std::lock_guard<std::mutex> lk(this->asyncMutex);
+    if (!this->asyncWriter.joinable())
+      return;
+    this->asyncStop = true;
+  }
+  this->asyncCondVar.notify_all();
+  this->asyncWriter.join();
+  this->asyncStop = false;
+}
+
+//////////////////////////////////////////////////
+uint64_t Log::InsertMessageAsync(const std::chrono::nanoseconds &_time,
+    const std::string &_topic, const std::string &_type, const void *_data,
+    const std::size_t _len, const InsertCallback &_callback)
+{
+  if (!this->Valid() || !this->dataPtr->writable)
+    return 0u;
+
+  const uint64_t maxBytes = this->dataPtr->options.AsyncQueueBytes();
+  std::unique_lock<std::mutex> lk(this->dataPtr->asyncMutex);
+  if (!this->dataPtr->asyncWriter.joinable())
+  {
+    this->dataPtr->asyncWriter = std::thread(
+      &Implementation::AsyncWriterThread, this->dataPtr.get());
+  }
+
+  // A message bigger than the limit is queued alone
+  this->dataPtr->asyncCondVar.wait(lk, [&]
+  {
+    return maxBytes == 0u || this->dataPtr->asyncQueue.empty() ||
+      this->dataPtr->asyncQueueBytes + _len <= maxBytes;
+  });
+
+  this->dataPtr->asyncQueue.push_back({_time, _topic, _type,
+    std::string(static_cast<const char *>(_data), _len), _callback});
+  this->dataPtr->asyncQueueBytes += _len;
+  const uint64_t seq = ++this->dataPtr->asyncQueued;
+  lk.unlock();
+
+  this->dataPtr->asyncCondVar.notify_all();
+  return seq;
+}
+
+//////////////////////////////////////////////////
+void Log::Fence(const uint64_t _seq)
+{
+  if (!this->dataPtr)
+    return;
+
+  std::unique_lock<std::mutex> lk(this->dataPtr->asyncMutex);
+  this->dataPtr->asyncCondVar.wait(lk, [&]
+  {
+    return this->dataPtr->asyncDone >= std::min(_seq,
+      this->dataPtr->asyncQueued);
+  });
+}
+
+//////////////////////////////////////////////////
+bool Log::Flush()
+{
+  if (!this->Valid())
+    return false;
+
+  bool success;
+  {
+    std::unique_lock<std::mutex> lk(this->dataPtr->asyncMutex);
+    this->dataPtr->asyncCondVar.wait(lk, [this]
+    {
+      return this->dataPtr->asyncDone == this->dataPtr->asyncQueued;
+    });
+    success = !this->dataPtr->asyncFailed;
+    this->dataPtr->asyncFailed = false;
+  }
+
+  std::lock_guard<std::mutex> writeLk(this->dataPtr->writeMutex);
+  if (this->dataPtr->inTransaction &&
+      SQLITE_OK != this->dataPtr->EndTransaction())
+  {
+    LERR("Failed to end transcation: "<< sqlite3_errmsg(
+        this->dataPtr->db->Handle()) << "\n");
+    success = false;
+  }
+  return success;
+}
+
+//////////////////////////////////////////////////
+Batch Log::QueryMessages(const QueryOptions &_options)
+{
+  const log::Descriptor *desc = this->Descriptor();
+
+  // Make sure the log has been initialized.
+  // TODO(anyone): Should we print a warning here?
+  if (!desc)
+    return Batch();
+
+  // The buffered messages must be in the database to be found
+  this->dataPtr->FlushBlocks();
+
+  std::unique_ptr<BatchPrivate> batchPriv(
+        new BatchPrivate(this->dataPtr->db,
+                         _options.GenerateStatements(*desc),
+                         this->dataPtr->encodedBlobs));
+
+  return Batch(std::move(batchPriv));
+}
+
+//////////////////////////////////////////////////
+bool Log::ParallelScan(const QueryOptions &_options,
+    const unsigned int _threads,
+    const std::function<void(const Message &_message)> &_callback) const
+{
+  const log::Descriptor *desc = this->Descriptor();
+  if (!desc)
+    return false;
+
+  const std::vector<SqlStatement> statements =
+    _options.GenerateStatements(*desc);
+
+  const int64_t start = this->StartTime().count();
+  const int64_t end = this->EndTime().count() + 1;
+
+  // The other connections only see the committed messages
+  if (this->dataPtr->inTransaction)
+    this->dataPtr->EndTransaction();
+
+  const int64_t threads = std::max<int64_t>(1, _threads > 0 ? _threads :
+      std::thread::hardware_concurrency());
+  const int64_t slice = std::max<int64_t>(1,
+      (end - start + threads - 1) / threads);
+
+  std::atomic_bool success(true);
+  std::vector<std::thread> workers;
+  for (int64_t sliceStart = start; sliceStart < end; sliceStart += slice)
+  {
+    const int64_t sliceEnd = std::min(sliceStart + slice, end);
+    workers.emplace_back([&, sliceStart, sliceEnd]()
+    {
+      Log logFile;
+      if (!logFile.Open(this->dataPtr->filename, std::ios_base::in))
+      {
+        success = false;
+        return;
+      }
+
+      // Restrict every statement to the slice. SQLite flattens the
+      // subquery, so the slice is still looked up in idx_time_recv.
+      std::vector<SqlStatement> sliced;
+      for (const SqlStatement &statement : statements)
+      {
+        SqlStatement sql;
+        const std::size_t last =
+          statement.statement.find_last_not_of("; \n");
+        sql.statement = "SELECT * FROM (" +
+          statement.statement.substr(0, last + 1) +
+          ") WHERE time_recv >= ? AND time_recv < ?;";
+        sql.parameters = statement.parameters;
+        sql.parameters.emplace_back(sliceStart);
+        sql.parameters.emplace_back(sliceEnd);
+        sliced.push_back(sql);
+      }
+
+      std::unique_ptr<BatchPrivate> batchPriv(
+          new BatchPrivate(logFile.dataPtr->db, std::move(sliced),
+                           logFile.dataPtr->encodedBlobs));
+      Batch batch(std::move(batchPriv));
+      batch.SetPrefetch(kScanPrefetchRows, kScanPrefetchBytes);
+      for (const Message &msg : batch)
+        _callback(msg);
+    });
+  }
+
+  for (std::thread &worker : workers)
+    worker.join();
+
+  return success;
+}
+
+//////////////////////////////////////////////////
+bool Log::Verify(const unsigned int _threads, LogVerification &_result) const
+{
+  _result = LogVerification();
+  if (!this->Valid())
+    return false;
+
+  // The other connections only see the committed messages
+  if (this->dataPtr->inTransaction)
+    this->dataPtr->EndTransaction();
+
+  // The pages, the indexes and the constraints of the database
+  {
+    raii_sqlite3::Statement check(*this->dataPtr->db, "PRAGMA quick_check;");
+    int returnCode = check ? sqlite3_step(check.Handle()) : SQLITE_ERROR;
+    for (; returnCode == SQLITE_ROW; returnCode = sqlite3_step(check.Handle()))
+    {
+      const std::string problem(reinterpret_cast<const char *>(
+          sqlite3_column_text(check.Handle(), 0)));
+      if (problem != "ok")
+      {
+        LERR("Corrupt log file [" << this->dataPtr->filename << "]: "
+            << problem << "\n");
+        _result.intact = false;
+      }
+    }
+    if (returnCode != SQLITE_DONE)
+    {
+      LERR("Failed to check [" << this->dataPtr->filename << "]: "
+          << sqlite3_errmsg(this->dataPtr->db->Handle()) << "\n");
+      _result.intact = false;
+    }
+  }
+
+  int64_t first = 0;
+  int64_t last = -1;
+  {
+    raii_sqlite3::Statement range(*this->dataPtr->db,
+        "SELECT MIN(id), MAX(id) FROM messages;");
+    if (range && sqlite3_step(range.Handle()) == SQLITE_ROW &&
+        sqlite3_column_type(range.Handle(), 0) != SQLITE_NULL)
+    {
+      first = sqlite3_column_int64(range.Handle(), 0);
+      last = sqlite3_column_int64(range.Handle(), 1);
+    }
+  }
+
+  // Every thread reads consecutive messages from its own connection, in
+  // the order they were written.
+  const int64_t threads = std::max<int64_t>(1, _threads > 0 ? _threads :
+      std::thread::hardware_concurrency());
+  const int64_t slice = std::max<int64_t>(1,
+      (last - first + threads) / threads);
+
+  std::atomic<uint64_t> messages(0);
+  std::atomic<uint64_t> checked(0);
+  std::atomic<uint64_t> corrupt(0);
+  std::atomic_bool intact(_result.intact);
+  std::vector<std::thread> workers;
+  for (int64_t sliceStart = first; sliceStart <= last; sliceStart += slice)
+  {
+    const int64_t sliceEnd = std::min(sliceStart + slice, last + 1);
+    workers.emplace_back([&, sliceStart, sliceEnd]()
+    {
+      Log logFile;
+      if (!logFile.Open(this->dataPtr->filename, std::ios_base::in))
+      {
+        intact = false;
+        return;
+      }
+
+      std::unique_ptr<BlockCache> blocks;
+      if (logFile.dataPtr->encodedBlobs)
+        blocks.reset(new BlockCache(logFile.dataPtr->db));
+
+      raii_sqlite3::Statement statement(*logFile.dataPtr->db,
+          "SELECT message FROM messages WHERE id >= ? AND id < ?;");
+      if (!statement)
+      {
+        intact = false;
+        return;
+      }
+      sqlite3_bind_int64(statement.Handle(), 1, sliceStart);
+      sqlite3_bind_int64(statement.Handle(), 2, sliceEnd);
+
+      uint64_t sliceMessages = 0;
+      uint64_t sliceChecked = 0;
+      uint64_t sliceCorrupt = 0;
+      int returnCode;
+      while ((returnCode = sqlite3_step(statement.Handle())) == SQLITE_ROW)
+      {
+        ++sliceMessages;
+        if (!blocks)
+          continue;
+
+        const void *blob = sqlite3_column_blob(statement.Handle(), 0);
+        const std::size_t len = static_cast<std::size_t>(
+            sqlite3_column_bytes(statement.Handle(), 0));
+        if (HasChecksum(blob, len))
+          ++sliceChecked;
+
+        const void *data;
+        std::size_t size;
+        if (!blocks->Decode(blob, len, data, size))
+          ++sliceCorrupt;
+      }
+
+      if (returnCode != SQLITE_DONE)
+      {
+        LERR("Failed to read the messages [" << sliceStart << ", "
+            << sliceEnd << ") of [" << this->dataPtr->filename << "]: "
+            << sqlite3_errmsg(logFile.dataPtr->db->Handle()) << "\n");
+        intact = false;
+      }
+
+      messages += sliceMessages;
+      checked += sliceChecked;
+      corrupt += sliceCorrupt;
+    });
+  }
+
+  for (std::thread &worker : workers)
+    worker.join();
+
+  _result.messages = messages;
+  _result.checked = checked;
+  _result.corrupt = corrupt;
+  _result.intact = intact;
+  return _result.intact && _result.corrupt == 0;
+}
+
+//////////////////////////////////////////////////
+std::chrono::nanoseconds Log::StartTime() const
+{
+  // The buffered messages must be in the database to be found
+  this->dataPtr->FlushBlocks();
 
-//////////////////////////////////////////////////
-std::chrono::nanoseconds Log::StartTime() const
-{
   // Short circuit if we already looked up the start time once.
   if (this->dataPtr->startTime >= std::chrono::nanoseconds::zero())
     return this->dataPtr->startTime;
@@ -584,6 +1804,16 @@ std::chrono::nanoseconds Log::StartTime() const
     return this->dataPtr->startTime;
   }
 
+  // Read the summary if it's known, or else fall back to the messages
+  if (const auto *summary = this->dataPtr->Summary())
+  {
+    TopicSummary all;
+    for (const auto &entry : *summary)
+      AddToSummary(all, entry.second);
+    this->dataPtr->startTime = all.startTime;
+    return this->dataPtr->startTime;
+  }
+
   // Compile the statement
   const char* const getStartTimeStatement =
       "SELECT MIN(time_recv) AS start_time FROM messages;";
@@ -616,15 +1846,29 @@ std::chrono::nanoseconds Log::StartTime() const
 //////////////////////////////////////////////////
 std::chrono::nanoseconds Log::EndTime() const
 {
+  // The buffered messages must be in the database to be found
+  this->dataPtr->FlushBlocks();
+
   // Short circuit if we already looked up the end time once.
   if (this->dataPtr->endTime >= std::chrono::nanoseconds::zero())
     return this->dataPtr->endTime;
 
   this->dataPtr->endTime = std::chrono::nanoseconds::zero();
 
-  if (!this->Valid())
+  if (!this->Valid())
+  {
+    LERR("Cannot get end time of an invalid log.\n");
+    return this->dataPtr->endTime;
+  }
+
+  // Read the summary if it's known. Only the logs without summary, e.g.
+  // because the recording crashed, need the recovery scan below.
+  if (const auto *summary = this->dataPtr->Summary())
   {
-    LERR("Cannot get end time of an invalid log.\n");
+    TopicSummary all;
+    for (const auto &entry : *summary)
+      AddToSummary(all, entry.second);
+    this->dataPtr->endTime = all.endTime;
     return this->dataPtr->endTime;
   }
 
@@ -681,6 +1925,336 @@ std::chrono::nanoseconds Log::EndTime() const
   return this->dataPtr->endTime;
 }
 
+//////////////////////////////////////////////////
+std::map<std::string, TopicSummary> Log::Summary() const
+{
+  std::map<std::string, TopicSummary> result;
+  const log::Descriptor *desc = this->Descriptor();
+  if (!desc)
+    return result;
+
+  std::map<int64_t, TopicSummary> counted;
+  const std::map<int64_t, TopicSummary> *summary = this->dataPtr->Summary();
+  if (!summary)
+  {
+    // Count the messages of a log file written by an older version
+    Batch batch(std::unique_ptr<BatchPrivate>(new BatchPrivate(
+        this->dataPtr->db, AllTopics().GenerateStatements(*desc),
+        this->dataPtr->encodedBlobs)));
+    for (const Message &msg : batch)
+    {
+      AddToSummary(counted[desc->TopicId(msg.Topic(), msg.Type())],
+          TopicSummary{1, msg.DataView().size(), msg.TimeReceived(),
+            msg.TimeReceived()});
+    }
+    summary = &counted;
+  }
+
+  for (const auto &topic : desc->TopicsToMsgTypesToId())
+  {
+    for (const auto &type : topic.second)
+    {
+      const auto it = summary->find(type.second);
+      if (it != summary->end())
+        AddToSummary(result[topic.first], it->second);
+    }
+  }
+
+  return result;
+}
+
+//////////////////////////////////////////////////
+/// \brief Bind the parameters of a statement.
+/// \param[in] _statement The statement.
+/// \param[in] _parameters Its parameters.
+static void BindParameters(sqlite3_stmt *_statement,
+    const std::vector<SqlParameter> &_parameters)
+{
+  int index = 1;
+  for (const SqlParameter &parameter : _parameters)
+  {
+    if (parameter.QueryInteger())
+    {
+      sqlite3_bind_int64(_statement, index, *parameter.QueryInteger());
+    }
+    else if (parameter.QueryReal())
+    {
+      sqlite3_bind_double(_statement, index, *parameter.QueryReal());
+    }
+    else if (parameter.QueryText())
+    {
+      sqlite3_bind_text(_statement, index, parameter.QueryText()->c_str(),
+          static_cast<int>(parameter.QueryText()->size()), SQLITE_TRANSIENT);
+    }
+    ++index;
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief Get the number of bits needed to represent a value.
+/// \param[in] _value The value.
+/// \return The number of bits, 0 for 0.
+static std::size_t BitWidth(uint64_t _value)
+{
+  std::size_t width = 0;
+  for (unsigned int shift = 32; shift > 0; shift /= 2)
+  {
+    if (_value >> shift)
+    {
+      _value >>= shift;
+      width += shift;
+    }
+  }
+  return width + static_cast<std::size_t>(_value);
+}
+
+//////////////////////////////////////////////////
+/// \brief Compute the time statistics of the messages of a topic. The
+/// loops over the times only depend on each other through the reductions,
+/// so the compiler vectorizes them.
+/// \param[in] _times Times the messages were received, in ascending order.
+/// \param[in,out] _stats The statistics.
+static void ReduceTimes(const std::vector<int64_t> &_times,
+    TopicStatistics &_stats)
+{
+  const std::size_t count = _times.size();
+  if (count == 0)
+    return;
+
+  const int64_t *times = _times.data();
+  _stats.startTime = std::chrono::nanoseconds(times[0]);
+  _stats.endTime = std::chrono::nanoseconds(times[count - 1]);
+  if (count < 2)
+    return;
+
+  int64_t minGap = std::numeric_limits<int64_t>::max();
+  int64_t maxGap = 0;
+  for (std::size_t i = 1; i < count; ++i)
+  {
+    const int64_t gap = times[i] - times[i - 1];
+    minGap = std::min(minGap, gap);
+    maxGap = std::max(maxGap, gap);
+  }
+
+  // Independent sums, so the additions don't wait for each other
+  const int64_t duration = times[count - 1] - times[0];
+  const double mean =
+    static_cast<double>(duration) / static_cast<double>(count - 1);
+  double sums[4] = {0, 0, 0, 0};
+  std::size_t i = 1;
+  for (; i + 4 <= count; i += 4)
+  {
+    for (std::size_t lane = 0; lane < 4; ++lane)
+    {
+      const double deviation = static_cast<double>(
+          times[i + lane] - times[i + lane - 1]) - mean;
+      sums[lane] += deviation * deviation;
+    }
+  }
+  for (; i < count; ++i)
+  {
+    const double deviation =
+      static_cast<double>(times[i] - times[i - 1]) - mean;
+    sums[0] += deviation * deviation;
+  }
+  const double variance = (sums[0] + sums[1] + sums[2] + sums[3]) /
+    static_cast<double>(count - 1);
+
+  for (i = 1; i < count; ++i)
+    ++_stats.gapHistogram[BitWidth(
+        static_cast<uint64_t>(times[i] - times[i - 1]))];
+
+  i = 1;
+  while (times[i] - times[i - 1] != maxGap)
+    ++i;
+
+  _stats.minGap = std::chrono::nanoseconds(minGap);
+  _stats.maxGap = std::chrono::nanoseconds(maxGap);
+  _stats.maxGapStart = std::chrono::nanoseconds(times[i - 1]);
+  _stats.gapStdDev = std::chrono::nanoseconds(
+      static_cast<int64_t>(std::sqrt(variance)));
+  if (duration > 0)
+  {
+    _stats.rate = static_cast<double>(count - 1) /
+      std::chrono::duration<double>(std::chrono::nanoseconds(duration))
+      .count();
+  }
+}
+
+//////////////////////////////////////////////////
+std::map<std::string, TopicStatistics> Log::Statistics(
+    const QueryOptions &_options) const
+{
+  std::map<std::string, TopicStatistics> result;
+  const log::Descriptor *desc = this->Descriptor();
+  if (!desc)
+    return result;
+
+  std::map<int64_t, const std::string *> names;
+  for (const auto &topic : desc->TopicsToMsgTypesToId())
+  {
+    for (const auto &type : topic.second)
+      names[type.second] = &topic.first;
+  }
+
+  // The times of the messages of every topic, in a column
+  std::map<std::string, std::vector<int64_t>> times;
+  for (const SqlStatement &statement : _options.GenerateStatements(*desc))
+  {
+    // SQLite only flattens a subquery ordered by time into a query that is
+    // too. Then length() doesn't read the part of a message that doesn't
+    // fit in its row.
+    const std::size_t last = statement.statement.find_last_not_of("; \n");
+    const std::string sql = "SELECT topic_id, time_recv, length(message)"
+      " FROM (" + statement.statement.substr(0, last + 1) +
+      ") ORDER BY time_recv;";
+    raii_sqlite3::Statement query(*this->dataPtr->db, sql);
+    if (!query)
+    {
+      LERR("Failed to compile [" << sql << "]\n");
+      return {};
+    }
+    BindParameters(query.Handle(), statement.parameters);
+
+    int returnCode;
+    while ((returnCode = sqlite3_step(query.Handle())) == SQLITE_ROW)
+    {
+      const auto name = names.find(sqlite3_column_int64(query.Handle(), 0));
+      if (name == names.end())
+        continue;
+
+      TopicStatistics &stats = result[*name->second];
+      ++stats.messages;
+      stats.storedBytes += static_cast<uint64_t>(
+          sqlite3_column_int64(query.Handle(), 2));
+      times[*name->second].push_back(
+          sqlite3_column_int64(query.Handle(), 1));
+    }
+    if (returnCode != SQLITE_DONE)
+    {
+      LERR("Failed to read the times of the messages: " << sqlite3_errmsg(
+          this->dataPtr->db->Handle()) << "\n");
+      return {};
+    }
+  }
+
+  for (auto &topic : times)
+  {
+    // A topic may be in several statements.
+    if (!std::is_sorted(topic.second.begin(), topic.second.end()))
+      std::sort(topic.second.begin(), topic.second.end());
+    ReduceTimes(topic.second, result[topic.first]);
+  }
+
+  return result;
+}
+
+//////////////////////////////////////////////////
+bool Log::SetMetadata(const std::string &_key, const std::string &_value)
+{
+  if (!this->Valid())
+    return false;
+
+  // The table isn't part of a schema version: the tools that don't know it
+  // just ignore it.
+  int returnCode = sqlite3_exec(this->dataPtr->db->Handle(),
+      kMetadataTable, NULL, 0, nullptr);
+  if (returnCode != SQLITE_OK)
+  {
+    LERR("Failed to create the metadata table: " << sqlite3_errmsg(
+        this->dataPtr->db->Handle()) << "\n");
+    return false;
+  }
+
+  raii_sqlite3::Statement statement(*(this->dataPtr->db),
+      "INSERT OR REPLACE INTO metadata (key, value) VALUES (?, ?);");
+  if (!statement)
+  {
+    LERR("Failed to compile metadata statement\n");
+    return false;
+  }
+
+  if (sqlite3_bind_text(statement.Handle(), 1, _key.c_str(),
+        static_cast<int>(_key.size()), nullptr) != SQLITE_OK ||
+      sqlite3_bind_text(statement.Handle(), 2, _value.c_str(),
+        static_cast<int>(_value.size()), nullptr) != SQLITE_OK)
+  {
+    LERR("Failed to bind metadata [" << _key << "]\n");
+    return false;
+  }
+
+  returnCode = sqlite3_step(statement.Handle());
+  if (returnCode != SQLITE_DONE)
+  {
+    LERR("Failed to store metadata [" << _key << "]: " << sqlite3_errmsg(
+        this->dataPtr->db->Handle()) << "\n");
+    return false;
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+std::map<std::string, std::string> Log::Metadata() const
+{
+  std::map<std::string, std::string> metadata;
+  if (!this->Valid())
+    return metadata;
+
+  // Logs without metadata don't have the table.
+  raii_sqlite3::Statement exists(*(this->dataPtr->db),
+      "SELECT 1 FROM sqlite_master WHERE type = 'table' AND "
+      "name = 'metadata';");
+  if (!exists || sqlite3_step(exists.Handle()) != SQLITE_ROW)
+    return metadata;
+
+  raii_sqlite3::Statement statement(*(this->dataPtr->db),
+      "SELECT key, value FROM metadata;");
+  if (!statement)
+  {
+    LERR("Failed to compile metadata query statement\n");
+    return metadata;
+  }
+
+  while (sqlite3_step(statement.Handle()) == SQLITE_ROW)
+  {
+    const unsigned char *key = sqlite3_column_text(statement.Handle(), 0);
+    const int keySize = sqlite3_column_bytes(statement.Handle(), 0);
+    const unsigned char *value = sqlite3_column_text(statement.Handle(), 1);
+    const int valueSize = sqlite3_column_bytes(statement.Handle(), 1);
+    metadata[std::string(reinterpret_cast<const char *>(key), keySize)] =
+      std::string(reinterpret_cast<const char *>(value), valueSize);
+  }
+  return metadata;
+}
+
+//////////////////////////////////////////////////
+std::string Log::MessageTypeDescriptors(const std::string &_type) const
+{
+  if (!this->Valid())
+    return "";
+
+  raii_sqlite3::Statement statement(*(this->dataPtr->db),
+      "SELECT proto_descriptor FROM message_types WHERE name = ?001;");
+  if (!statement)
+  {
+    LERR("Failed to compile message type descriptor query statement\n");
+    return "";
+  }
+
+  if (sqlite3_bind_text(statement.Handle(), 1, _type.c_str(),
+        static_cast<int>(_type.size()), nullptr) != SQLITE_OK ||
+      sqlite3_step(statement.Handle()) != SQLITE_ROW)
+  {
+    return "";
+  }
+
+  const void *data = sqlite3_column_blob(statement.Handle(), 0);
+  const int size = sqlite3_column_bytes(statement.Handle(), 0);
+  if (!data || size <= 0)
+    return "";
+  return std::string(static_cast<const char *>(data), size);
+}
+
 //////////////////////////////////////////////////
 std::string Log::Version() const
 {
@@ -717,3 +2291,318 @@ std::string Log::Filename() const
 {
   return this->dataPtr->filename;
 }
+
+//////////////////////////////////////////////////
+bool log::ReindexLog(const std::string &_file)
+{
+  {
+    // Check that this is a log file of a supported version
+    Log log;
+    if (!log.Open(_file, std::ios_base::in))
+      return false;
+  }
+
+  raii_sqlite3::Database db(_file, SQLITE_OPEN_URI | SQLITE_OPEN_READWRITE);
+  if (!db)
+    return false;
+
+  // idx_time_recv is replaced by the one of log/sql/0.1.0.sql
+  const std::string sql = std::string(
+      "BEGIN;"
+      " DROP INDEX IF EXISTS idx_time_recv;"
+      " CREATE INDEX idx_time_recv ON messages (time_recv, topic_id); ") +
+      kTopicTimeIndex + " COMMIT;";
+  if (sqlite3_exec(db.Handle(), sql.c_str(), NULL, 0, NULL) != SQLITE_OK)
+  {
+    LERR("Failed to reindex [" << _file << "]: "
+        << sqlite3_errmsg(db.Handle()) << "\n");
+    sqlite3_exec(db.Handle(), "ROLLBACK;", NULL, 0, NULL);
+    return false;
+  }
+
+  return true;
+}
+
+//////////////////////////////////////////////////
+/// \brief SQL function gz_block_id(message): the id of the block referenced
+/// by the content of messages.message, or NULL.
+static void BlockIdFunction(sqlite3_context *_context, int,
+    sqlite3_value **_args)
+{
+  const void *blob = sqlite3_value_blob(_args[0]);
+  const int len = sqlite3_value_bytes(_args[0]);
+  BlockReference reference;
+  if (DecodeBlockReference(blob, static_cast<std::size_t>(len), reference))
+    sqlite3_result_int64(_context, reference.block);
+  else
+    sqlite3_result_null(_context);
+}
+
+//////////////////////////////////////////////////
+/// \brief SQL function gz_encode(message, encoded, offset): the content of
+/// messages.message in a log with the 0.2.0 schema. The messages of a log
+/// with the 0.1.0 schema (encoded = 0) are prefixed with
+/// BlobEncoding::RAW, the references to blocks are moved by offset.
+static void EncodeFunction(sqlite3_context *_context, int,
+    sqlite3_value **_args)
+{
+  const char *blob = static_cast<const char *>(sqlite3_value_blob(_args[0]));
+  const int len = sqlite3_value_bytes(_args[0]);
+  if (!sqlite3_value_int(_args[1]))
+  {
+    std::string raw(1, static_cast<char>(BlobEncoding::RAW));
+    if (len > 0)
+      raw.append(blob, static_cast<std::size_t>(len));
+    sqlite3_result_blob(_context, raw.data(), static_cast<int>(raw.size()),
+        SQLITE_TRANSIENT);
+    return;
+  }
+
+  BlockReference reference;
+  if (DecodeBlockReference(blob, static_cast<std::size_t>(len), reference))
+  {
+    reference.block += sqlite3_value_int64(_args[2]);
+    const std::string moved = EncodeBlockReference(reference);
+    sqlite3_result_blob(_context, moved.data(),
+        static_cast<int>(moved.size()), SQLITE_TRANSIENT);
+    return;
+  }
+
+  sqlite3_result_value(_context, _args[0]);
+}
+
+//////////////////////////////////////////////////
+/// \brief Run a statement copying data between log files.
+/// \param[in] _db The database.
+/// \param[in] _sql The statement.
+/// \param[in] _parameters Its parameters.
+/// \return True on success.
+static bool RunCopyStatement(raii_sqlite3::Database &_db,
+    const std::string &_sql,
+    const std::vector<SqlParameter> &_parameters = {})
+{
+  raii_sqlite3::Statement statement(_db, _sql);
+  if (!statement)
+  {
+    LERR("Failed to compile [" << _sql << "]\n");
+    return false;
+  }
+  BindParameters(statement.Handle(), _parameters);
+
+  if (sqlite3_step(statement.Handle()) != SQLITE_DONE)
+  {
+    LERR("Failed to copy the messages: " << sqlite3_errmsg(_db.Handle())
+        << "\n");
+    return false;
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+/// \brief Copy the messages of a log file attached as "src" to the main
+/// database, within a transaction.
+/// \param[in] _db The database.
+/// \param[in] _range Time range of the messages copied.
+/// \param[in] _srcEncoded Whether the source has the 0.2.0 schema.
+/// \param[in] _dstEncoded Whether the destination has the 0.2.0 schema.
+/// \return True on success.
+static bool CopyAttachedLog(raii_sqlite3::Database &_db,
+    const QualifiedTimeRange &_range, const bool _srcEncoded,
+    const bool _dstEncoded)
+{
+  // The message types and the topics are matched by name, the ids of the
+  // messages and of the blocks are left to the destination.
+  const char *copyTopics =
+    "INSERT INTO main.message_types (name, proto_descriptor)"
+    " SELECT name, proto_descriptor FROM src.message_types"
+    " WHERE id IN (SELECT MIN(id) FROM src.message_types GROUP BY name)"
+    " AND name NOT IN (SELECT name FROM main.message_types);"
+    " INSERT OR IGNORE INTO main.topics (name, message_type_id)"
+    " SELECT t.name, (SELECT MIN(d.id) FROM main.message_types d"
+    " WHERE d.name = s.name)"
+    " FROM src.topics t JOIN src.message_types s"
+    " ON s.id = t.message_type_id;"
+    " CREATE TEMP TABLE IF NOT EXISTS topic_map ("
+    "src_id INTEGER PRIMARY KEY, dst_id INTEGER NOT NULL);"
+    " DELETE FROM temp.topic_map;"
+    " INSERT INTO temp.topic_map (src_id, dst_id)"
+    " SELECT t.id, d.id FROM src.topics t JOIN src.message_types s"
+    " ON s.id = t.message_type_id JOIN main.topics d"
+    " ON d.name = t.name AND d.message_type_id ="
+    " (SELECT MIN(m.id) FROM main.message_types m WHERE m.name = s.name);";
+  if (sqlite3_exec(_db.Handle(), copyTopics, NULL, 0, NULL) != SQLITE_OK)
+  {
+    LERR("Failed to copy the topics: " << sqlite3_errmsg(_db.Handle())
+        << "\n");
+    return false;
+  }
+
+  const SqlStatement time = TimeRangeOption(_range).GenerateTimeConditions();
+  const std::string where =
+    time.statement.empty() ? "" : " WHERE " + time.statement;
+
+  // The blocks keep their order, after the ones already copied.
+  int64_t offset = 0;
+  if (_srcEncoded)
+  {
+    raii_sqlite3::Statement last(_db,
+        "SELECT IFNULL(MAX(id), 0) FROM main.message_blocks;");
+    if (!last || sqlite3_step(last.Handle()) != SQLITE_ROW)
+    {
+      LERR("Failed to get the last block: " << sqlite3_errmsg(_db.Handle())
+          << "\n");
+      return false;
+    }
+    offset = sqlite3_column_int64(last.Handle(), 0);
+
+    std::string copyBlocks =
+      "INSERT INTO main.message_blocks (id, codec, data)"
+      " SELECT id + " + std::to_string(offset) + ", codec, data"
+      " FROM src.message_blocks";
+    if (!where.empty())
+    {
+      copyBlocks += " WHERE id IN (SELECT gz_block_id(message)"
+        " FROM src.messages" + where + ")";
+    }
+    if (!RunCopyStatement(_db, copyBlocks + ";", time.parameters))
+      return false;
+  }
+
+  const std::string message = _dstEncoded ?
+    "gz_encode(m.message, " + std::to_string(_srcEncoded ? 1 : 0) + ", " +
+      std::to_string(offset) + ")" : "m.message";
+  return RunCopyStatement(_db,
+      "INSERT INTO main.messages (time_recv, topic_id, message)"
+      " SELECT m.time_recv, map.dst_id, " + message +
+      " FROM src.messages m JOIN temp.topic_map map"
+      " ON map.src_id = m.topic_id" + where + " ORDER BY m.time_recv;",
+      time.parameters);
+}
+
+//////////////////////////////////////////////////
+/// \brief Copy the messages of log files to a new log file with SQL, see
+/// CutLog() and MergeLogs().
+/// \param[in] _srcs Paths to the log files.
+/// \param[in] _dst Path to the new log file.
+/// \param[in] _range Time range of the messages copied.
+/// \return True on success.
+static bool CopyLogs(const std::vector<std::string> &_srcs,
+    const std::string &_dst, const QualifiedTimeRange &_range)
+{
+  if (_srcs.empty())
+  {
+    LERR("No log file to copy\n");
+    return false;
+  }
+
+  // Check that these are log files of a supported version
+  std::vector<bool> srcEncoded;
+  for (const std::string &src : _srcs)
+  {
+    Log log;
+    if (!log.Open(src, std::ios_base::in))
+      return false;
+    srcEncoded.push_back(log.Version() == "0.2.0");
+  }
+  const bool dstEncoded =
+    std::find(srcEncoded.begin(), srcEncoded.end(), true) != srcEncoded.end();
+
+  {
+    Log log;
+    if (!log.Open(_dst, std::ios_base::out))
+      return false;
+  }
+
+  raii_sqlite3::Database db(_dst, SQLITE_OPEN_URI | SQLITE_OPEN_READWRITE);
+  if (!db)
+    return false;
+
+  if (sqlite3_create_function(db.Handle(), "gz_block_id", 1,
+        SQLITE_UTF8 | SQLITE_DETERMINISTIC, nullptr, &BlockIdFunction,
+        nullptr, nullptr) != SQLITE_OK ||
+      sqlite3_create_function(db.Handle(), "gz_encode", 3,
+        SQLITE_UTF8 | SQLITE_DETERMINISTIC, nullptr, &EncodeFunction,
+        nullptr, nullptr) != SQLITE_OK)
+  {
+    LERR("Failed to register the copy functions: "
+        << sqlite3_errmsg(db.Handle()) << "\n");
+    return false;
+  }
+
+  bool hasBlocks = false;
+  for (std::size_t i = 0; i < _srcs.size(); ++i)
+  {
+    if (!RunCopyStatement(db, "ATTACH DATABASE ? AS src;",
+          {SqlParameter(_srcs[i])}))
+    {
+      return false;
+    }
+
+    // The destination takes the 0.2.0 schema from the first source having
+    // it.
+    std::string migration;
+    if (srcEncoded[i] && !hasBlocks)
+    {
+      raii_sqlite3::Statement table(db,
+          "SELECT sql FROM src.sqlite_master WHERE type = 'table' AND"
+          " name = 'message_blocks';");
+      if (table && sqlite3_step(table.Handle()) == SQLITE_ROW)
+      {
+        migration = reinterpret_cast<const char *>(
+            sqlite3_column_text(table.Handle(), 0));
+        migration += "; INSERT INTO main.migrations (from_version,"
+          " to_version) VALUES ('0.1.0', '0.2.0');";
+      }
+      hasBlocks = true;
+    }
+
+    {
+      raii_sqlite3::Statement metadata(db,
+          "SELECT 1 FROM src.sqlite_master WHERE type = 'table' AND"
+          " name = 'metadata';");
+      if (metadata && sqlite3_step(metadata.Handle()) == SQLITE_ROW)
+      {
+        migration += std::string(" ") + kMetadataTable +
+          " INSERT OR IGNORE INTO main.metadata (key, value)"
+          " SELECT key, value FROM src.metadata;";
+      }
+    }
+
+    bool copied =
+      sqlite3_exec(db.Handle(), ("BEGIN; " + migration).c_str(), NULL, 0,
+          NULL) == SQLITE_OK &&
+      CopyAttachedLog(db, _range, srcEncoded[i], dstEncoded) &&
+      sqlite3_exec(db.Handle(), "COMMIT;", NULL, 0, NULL) == SQLITE_OK;
+    if (!copied)
+    {
+      LERR("Failed to copy [" << _srcs[i] << "] to [" << _dst << "]: "
+          << sqlite3_errmsg(db.Handle()) << "\n");
+      sqlite3_exec(db.Handle(), "ROLLBACK;", NULL, 0, NULL);
+    }
+
+    if (sqlite3_exec(db.Handle(), "DETACH DATABASE src;", NULL, 0, NULL) !=
+        SQLITE_OK || !copied)
+    {
+      return false;
+    }
+  }
+
+  // The summary written when the new log was created is empty: the next
+  // reader counts the messages instead.
+  return sqlite3_exec(db.Handle(), "DROP TABLE IF EXISTS topic_summary;",
+      NULL, 0, NULL) == SQLITE_OK;
+}
+
+//////////////////////////////////////////////////
+bool log::CutLog(const std::string &_src, const std::string &_dst,
+    const QualifiedTimeRange &_range)
+{
+  return CopyLogs({_src}, _dst, _range);
+}
+
+//////////////////////////////////////////////////
+bool log::MergeLogs(const std::vector<std::string> &_srcs,
+    const std::string &_dst)
+{
+  return CopyLogs(_srcs, _dst, QualifiedTimeRange::AllTime());
+}
@@ -64,3 +64,68 @@ TEST(LogCommandAPI, PlaybackFailedToOpen)
   EXPECT_EQ(FAILED_TO_OPEN,
     playbackTopics("!@#$%^&*(:;[{]})?/.'|", ".*", 0, "", false));
 }
+
+//////////////////////////////////////////////////
+TEST(LogCommandAPI, ConvertInvalid)
+{
+  EXPECT_EQ(FAILED_TO_CONVERT,
+    convertLog("/this/path/does/not/exist", "/tmp/out.tlog", "", ""));
+  EXPECT_EQ(FAILED_TO_CONVERT,
+    convertLog(":memory:", "/tmp/out.tlog", "mcap", ""));
+  EXPECT_EQ(FAILED_TO_CONVERT,
+    convertLog(":memory:", "/tmp/out.tlog", "chunked", "gzip"));
+}
+
+//////////////////////////////////////////////////
+TEST(LogCommandAPI, ReindexFailedToOpen)
+{
+  EXPECT_EQ(FAILED_TO_REINDEX, reindexLog("/this/path/does/not/exist"));
+}
+
+//////////////////////////////////////////////////
+TEST(LogCommandAPI, ExportBadRegex)
+{
+  EXPECT_EQ(BAD_REGEX, exportLog("file", "dir", "*", 0));
+}
+
+//////////////////////////////////////////////////
+TEST(LogCommandAPI, ExportFailedToOpen)
+{
+  EXPECT_EQ(FAILED_TO_EXPORT,
+      exportLog("/this/path/does/not/exist", "dir", ".+", 0));
+}
+
+//////////////////////////////////////////////////
+TEST(LogCommandAPI, CutFailedToOpen)
+{
+  EXPECT_EQ(FAILED_TO_OPEN,
+      cutLog("/this/path/does/not/exist", "/tmp/out.tlog", 1.0, -1.0));
+}
+
+//////////////////////////////////////////////////
+TEST(LogCommandAPI, MergeFailedToOpen)
+{
+  EXPECT_EQ(FAILED_TO_COPY, mergeLogs("", "/tmp/out.tlog"));
+  EXPECT_EQ(FAILED_TO_COPY,
+      mergeLogs("/this/path/does/not/exist\n", "/tmp/out.tlog"));
+}
+
+//////////////////////////////////////////////////
+TEST(LogCommandAPI, VerifyFailedToOpen)
+{
+  EXPECT_EQ(FAILED_TO_VERIFY, verifyLog("/this/path/does/not/exist", 0));
+  EXPECT_EQ(FAILED_TO_VERIFY, verifyLog("/this/path/does/not/exist", -1));
+}
+
+//////////////////////////////////////////////////
+TEST(LogCommandAPI, InfoBadRegex)
+{
+  EXPECT_EQ(BAD_REGEX, infoLog("file", "*", -1.0, -1.0, 1));
+}
+
+//////////////////////////////////////////////////
+TEST(LogCommandAPI, InfoFailedToOpen)
+{
+  EXPECT_EQ(FAILED_TO_OPEN,
+      infoLog("/this/path/does/not/exist", ".+", -1.0, -1.0, 1));
+}
@@ -0,0 +1,434 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <regex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gz/transport/log/LogOptions.hh"
+
+#include "Compression.hh"
+#include "Console.hh"
+
+using namespace gz::transport;
+using namespace gz::transport::log;
+
+//////////////////////////////////////////////////
+class gz::transport::log::LogOptions::Implementation
+{
+  /// \brief Journal mode.
+  public: log::JournalMode journalMode = log::JournalMode::DEFAULT;
+
+  /// \brief Synchronous mode.
+  public: SyncMode synchronous = SyncMode::DEFAULT;
+
+  /// \brief Page size in bytes.
+  public: uint32_t pageSize = 0;
+
+  /// \brief Cache size in KiB.
+  public: uint64_t cacheSize = 0;
+
+  /// \brief Size of the memory mapped I/O in bytes.
+  public: uint64_t mmapSize = 0;
+
+  /// \brief Maximum duration of a transaction.
+  public: std::chrono::milliseconds transactionPeriod{500};
+
+  /// \brief Maximum size of a transaction in bytes.
+  public: uint64_t maxTransactionBytes = 0;
+
+  /// \brief Maximum number of messages of a transaction.
+  public: uint64_t maxTransactionRows = 0;
+
+  /// \brief Size of the messages queued by Log::InsertMessageAsync(), 0 if
+  /// unlimited.
+  public: uint64_t asyncQueueBytes = 64u << 20;
+
+  /// \brief Format of the log files created by a Recorder.
+  public: LogFormat format = LogFormat::SQLITE;
+
+  /// \brief Size of the chunks of a chunked log in bytes.
+  public: uint64_t chunkSize = 4u << 20;
+
+  /// \brief Codec of the chunks of a chunked log.
+  public: Compression_t chunkCompression = Compression_t::NONE;
+
+  /// \brief Number of blocks of a chunked log written at the same time.
+  public: uint32_t chunkIoDepth = 0;
+
+  /// \brief Patterns of the topics and their codecs.
+  public: std::vector<std::pair<std::regex, Compression_t>> topicCompression;
+
+  /// \brief Maximum size of a block of compressed messages in bytes.
+  public: uint64_t compressionBlockSize = 1u << 20;
+
+  /// \brief Whether the CRC-32C of the messages is stored.
+  public: bool messageChecksums = false;
+
+  /// \brief Patterns of the topics of each shard, from the shard 1.
+  public: std::vector<std::regex> shards;
+
+  /// \brief Duration of a log file before a rotation, 0 if none.
+  public: std::chrono::milliseconds rotationPeriod{0};
+
+  /// \brief Size of the messages of a log file before a rotation, 0 if none.
+  public: uint64_t rotationBytes = 0;
+};
+
+//////////////////////////////////////////////////
+LogOptions::LogOptions()
+  : dataPtr(new Implementation)
+{
+}
+
+//////////////////////////////////////////////////
+LogOptions::LogOptions(const LogOptions &_other)
+  : dataPtr(new Implementation(*_other.dataPtr))
+{
+}
+
+//////////////////////////////////////////////////
+LogOptions::~LogOptions()
+{
+}
+
+//////////////////////////////////////////////////
+LogOptions &LogOptions::operator=(const LogOptions &_other)
+{
+  *this->dataPtr = *_other.dataPtr;
+  return *this;
+}
+
+//////////////////////////////////////////////////
+LogOptions LogOptions::HighThroughput()
+{
+  LogOptions options;
+  options.SetJournalMode(log::JournalMode::WAL);
+  options.SetSynchronous(SyncMode::NORMAL);
+  options.SetPageSize(65536);
+  options.SetCacheSize(64 * 1024);
+  options.SetMmapSize(256u << 20);
+  options.SetMaxTransactionBytes(64u << 20);
+  return options;
+}
+
+//////////////////////////////////////////////////
+log::JournalMode LogOptions::JournalMode() const
+{
+  return this->dataPtr->journalMode;
+}
+
+//////////////////////////////////////////////////
+void LogOptions::SetJournalMode(const log::JournalMode _mode)
+{
+  this->dataPtr->journalMode = _mode;
+}
+
+//////////////////////////////////////////////////
+SyncMode LogOptions::Synchronous() const
+{
+  return this->dataPtr->synchronous;
+}
+
+//////////////////////////////////////////////////
+void LogOptions::SetSynchronous(const SyncMode _mode)
+{
+  this->dataPtr->synchronous = _mode;
+}
+
+//////////////////////////////////////////////////
+uint32_t LogOptions::PageSize() const
+{
+  return this->dataPtr->pageSize;
+}
+
+//////////////////////////////////////////////////
+bool LogOptions::SetPageSize(const uint32_t _size)
+{
+  // A power of two between 512 and 65536.
+  if (_size != 0 &&
+      (_size < 512 || _size > 65536 || (_size & (_size - 1)) != 0))
+  {
+    LERR("Invalid page size [" << _size << "]. It must be a power of two "
+         << "between 512 and 65536\n");
+    return false;
+  }
+
+  this->dataPtr->pageSize = _size;
+  return true;
+}
+
+//////////////////////////////////////////////////
+uint64_t LogOptions::CacheSize() const
+{
+  return this->dataPtr->cacheSize;
+}
+
+//////////////////////////////////////////////////
+void LogOptions::SetCacheSize(const uint64_t _size)
+{
+  this->dataPtr->cacheSize = _size;
+}
+
+//////////////////////////////////////////////////
+uint64_t LogOptions::MmapSize() const
+{
+  return this->dataPtr->mmapSize;
+}
+
+//////////////////////////////////////////////////
+void LogOptions::SetMmapSize(const uint64_t _size)
+{
+  this->dataPtr->mmapSize = _size;
+}
+
+//////////////////////////////////////////////////
+std::chrono::milliseconds LogOptions::TransactionPeriod() const
+{
+  return this->dataPtr->transactionPeriod;
+}
+
+//////////////////////////////////////////////////
+void LogOptions::SetTransactionPeriod(const std::chrono::milliseconds &_period)
+{
+  this->dataPtr->transactionPeriod = _period;
+}
+
+//////////////////////////////////////////////////
+uint64_t LogOptions::MaxTransactionBytes() const
+{
+  return this->dataPtr->maxTransactionBytes;
+}
+
+//////////////////////////////////////////////////
+void LogOptions::SetMaxTransactionBytes(const uint64_t _bytes)
+{
+  this->dataPtr->maxTransactionBytes = _bytes;
+}
+
+//////////////////////////////////////////////////
+uint64_t LogOptions::MaxTransactionRows() const
+{
+  return this->dataPtr->maxTransactionRows;
+}
+
+//////////////////////////////////////////////////
+void LogOptions::SetMaxTransactionRows(const uint64_t _rows)
+{
+  this->dataPtr->maxTransactionRows = _rows;
+}
+
+//////////////////////////////////////////////////
+uint64_t LogOptions::AsyncQueueBytes() const
+{
+  return this->dataPtr->asyncQueueBytes;
+}
+
+//////////////////////////////////////////////////
+void LogOptions::SetAsyncQueueBytes(const uint64_t _bytes)
+{
+  this->dataPtr->asyncQueueBytes = _bytes;
+}
+
+//////////////////////////////////////////////////
+LogFormat LogOptions::Format() const
+{
+  return this->dataPtr->format;
+}
+
+//////////////////////////////////////////////////
+void LogOptions::SetFormat(const LogFormat _format)
+{
+  this->dataPtr->format = _format;
+}
+
+//////////////////////////////////////////////////
+uint64_t LogOptions::ChunkSize() const
+{
+  return this->dataPtr->chunkSize;
+}
+
+//////////////////////////////////////////////////
+bool LogOptions::SetChunkSize(const uint64_t _size)
+{
+  if (_size < 1024u || _size > (1u << 30))
+  {
+    LERR("Invalid chunk size [" << _size << "]. It must be between 1 KiB "
+         << "and 1 GiB\n");
+    return false;
+  }
+
+  this->dataPtr->chunkSize = _size;
+  return true;
+}
+
+//////////////////////////////////////////////////
+Compression_t LogOptions::ChunkCompression() const
+{
+  return this->dataPtr->chunkCompression;
+}
+
+//////////////////////////////////////////////////
+bool LogOptions::SetChunkCompression(const Compression_t _codec)
+{
+  if (_codec != Compression_t::NONE && !CompressionAvailable(_codec))
+  {
+    LERR("Compression codec [" << CompressionName(_codec) << "] is not "
+         << "available in this build\n");
+    return false;
+  }
+
+  this->dataPtr->chunkCompression = _codec;
+  return true;
+}
+
+//////////////////////////////////////////////////
+uint32_t LogOptions::ChunkIoDepth() const
+{
+  return this->dataPtr->chunkIoDepth;
+}
+
+//////////////////////////////////////////////////
+bool LogOptions::SetChunkIoDepth(const uint32_t _depth)
+{
+  if (_depth > 256u)
+  {
+    LERR("Invalid chunk I/O depth [" << _depth << "]. It must not be "
+         << "greater than 256\n");
+    return false;
+  }
+
+  this->dataPtr->chunkIoDepth = _depth;
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool LogOptions::AddTopicCompression(const std::regex &_topics,
+    const Compression_t _codec)
+{
+  if (_codec != Compression_t::NONE && !CompressionAvailable(_codec))
+  {
+    LERR("Compression codec [" << CompressionName(_codec) << "] is not "
+         << "available in this build\n");
+    return false;
+  }
+
+  this->dataPtr->topicCompression.emplace_back(_topics, _codec);
+  return true;
+}
+
+//////////////////////////////////////////////////
+Compression_t LogOptions::TopicCompression(const std::string &_topic) const
+{
+  for (const auto &rule : this->dataPtr->topicCompression)
+  {
+    if (std::regex_match(_topic, rule.first))
+      return rule.second;
+  }
+  return Compression_t::NONE;
+}
+
+//////////////////////////////////////////////////
+bool LogOptions::HasTopicCompression() const
+{
+  for (const auto &rule : this->dataPtr->topicCompression)
+  {
+    if (rule.second != Compression_t::NONE)
+      return true;
+  }
+  return false;
+}
+
+//////////////////////////////////////////////////
+uint64_t LogOptions::CompressionBlockSize() const
+{
+  return this->dataPtr->compressionBlockSize;
+}
+
+//////////////////////////////////////////////////
+bool LogOptions::SetCompressionBlockSize(const uint64_t _size)
+{
+  if (_size < 1024u || _size > (1u << 30))
+  {
+    LERR("Invalid compression block size [" << _size << "]. It must be "
+         << "between 1 KiB and 1 GiB\n");
+    return false;
+  }
+
+  this->dataPtr->compressionBlockSize = _size;
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool LogOptions::MessageChecksums() const
+{
+  return this->dataPtr->messageChecksums;
+}
+
+//////////////////////////////////////////////////
+void LogOptions::SetMessageChecksums(const bool _checksums)
+{
+  this->dataPtr->messageChecksums = _checksums;
+}
+
+//////////////////////////////////////////////////
+void LogOptions::AddShard(const std::regex &_topics)
+{
+  this->dataPtr->shards.push_back(_topics);
+}
+
+//////////////////////////////////////////////////
+std::size_t LogOptions::ShardCount() const
+{
+  return this->dataPtr->shards.size() + 1u;
+}
+
+//////////////////////////////////////////////////
+std::size_t LogOptions::TopicShard(const std::string &_topic) const
+{
+  for (std::size_t i = 0; i < this->dataPtr->shards.size(); ++i)
+  {
+    if (std::regex_match(_topic, this->dataPtr->shards[i]))
+      return i + 1u;
+  }
+  return 0u;
+}
+
+//////////////////////////////////////////////////
+std::chrono::milliseconds LogOptions::RotationPeriod() const
+{
+  return this->dataPtr->rotationPeriod;
+}
+
+//////////////////////////////////////////////////
+void LogOptions::SetRotationPeriod(const std::chrono::milliseconds &_period)
+{
+  this->dataPtr->rotationPeriod = _period;
+}
+
+//////////////////////////////////////////////////
+uint64_t LogOptions::RotationBytes() const
+{
+  return this->dataPtr->rotationBytes;
+}
+
+//////////////////////////////////////////////////
+void LogOptions::SetRotationBytes(const uint64_t _bytes)
+{
+  this->dataPtr->rotationBytes = _bytes;
+}
@@ -0,0 +1,160 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <regex>
+
+#include "gz/transport/log/LogOptions.hh"
+
+using namespace gz;
+using namespace gz::transport;
+
+//////////////////////////////////////////////////
+TEST(LogOptions, Defaults)
+{
+  log::LogOptions options;
+  EXPECT_EQ(log::JournalMode::DEFAULT, options.JournalMode());
+  EXPECT_EQ(log::SyncMode::DEFAULT, options.Synchronous());
+  EXPECT_EQ(0u, options.PageSize());
+  EXPECT_EQ(0u, options.CacheSize());
+  EXPECT_EQ(0u, options.MmapSize());
+  EXPECT_EQ(std::chrono::milliseconds(500), options.TransactionPeriod());
+  EXPECT_EQ(0u, options.MaxTransactionBytes());
+  EXPECT_EQ(0u, options.MaxTransactionRows());
+  EXPECT_EQ(64u << 20, options.AsyncQueueBytes());
+  EXPECT_EQ(log::LogFormat::SQLITE, options.Format());
+  EXPECT_EQ(4u << 20, options.ChunkSize());
+  EXPECT_EQ(Compression_t::NONE, options.ChunkCompression());
+  EXPECT_EQ(0u, options.ChunkIoDepth());
+  EXPECT_FALSE(options.MessageChecksums());
+}
+
+//////////////////////////////////////////////////
+TEST(LogOptions, Accessors)
+{
+  log::LogOptions options;
+  options.SetJournalMode(log::JournalMode::MEMORY);
+  EXPECT_EQ(log::JournalMode::MEMORY, options.JournalMode());
+  options.SetSynchronous(log::SyncMode::OFF);
+  EXPECT_EQ(log::SyncMode::OFF, options.Synchronous());
+  options.SetCacheSize(2048);
+  EXPECT_EQ(2048u, options.CacheSize());
+  options.SetMmapSize(1u << 20);
+  EXPECT_EQ(1u << 20, options.MmapSize());
+
+  EXPECT_TRUE(options.SetPageSize(4096));
+  EXPECT_EQ(4096u, options.PageSize());
+  EXPECT_FALSE(options.SetPageSize(256));
+  EXPECT_FALSE(options.SetPageSize(5000));
+  EXPECT_FALSE(options.SetPageSize(131072));
+  EXPECT_EQ(4096u, options.PageSize());
+  EXPECT_TRUE(options.SetPageSize(0));
+  EXPECT_EQ(0u, options.PageSize());
+
+  options.SetTransactionPeriod(std::chrono::milliseconds(100));
+  EXPECT_EQ(std::chrono::milliseconds(100), options.TransactionPeriod());
+  options.SetMaxTransactionBytes(1u << 20);
+  EXPECT_EQ(1u << 20, options.MaxTransactionBytes());
+  options.SetMaxTransactionRows(1000);
+  EXPECT_EQ(1000u, options.MaxTransactionRows());
+  options.SetAsyncQueueBytes(0);
+  EXPECT_EQ(0u, options.AsyncQueueBytes());
+
+  options.SetFormat(log::LogFormat::CHUNKED);
+  EXPECT_EQ(log::LogFormat::CHUNKED, options.Format());
+  EXPECT_TRUE(options.SetChunkSize(1u << 20));
+  EXPECT_EQ(1u << 20, options.ChunkSize());
+  EXPECT_FALSE(options.SetChunkSize(100));
+  EXPECT_FALSE(options.SetChunkSize(2ull << 30));
+  EXPECT_EQ(1u << 20, options.ChunkSize());
+  EXPECT_TRUE(options.SetChunkCompression(Compression_t::NONE));
+  EXPECT_EQ(Compression_t::NONE, options.ChunkCompression());
+  EXPECT_TRUE(options.SetChunkIoDepth(8));
+  EXPECT_EQ(8u, options.ChunkIoDepth());
+  EXPECT_FALSE(options.SetChunkIoDepth(1000));
+  EXPECT_EQ(8u, options.ChunkIoDepth());
+
+  EXPECT_FALSE(options.HasTopicCompression());
+  EXPECT_EQ(Compression_t::NONE, options.TopicCompression("/foo"));
+  EXPECT_TRUE(options.AddTopicCompression(std::regex("/foo"),
+    Compression_t::NONE));
+  EXPECT_FALSE(options.HasTopicCompression());
+  EXPECT_TRUE(options.SetCompressionBlockSize(1u << 16));
+  EXPECT_EQ(1u << 16, options.CompressionBlockSize());
+  EXPECT_FALSE(options.SetCompressionBlockSize(100));
+  EXPECT_EQ(1u << 16, options.CompressionBlockSize());
+
+  options.SetMessageChecksums(true);
+  EXPECT_TRUE(options.MessageChecksums());
+}
+
+//////////////////////////////////////////////////
+TEST(LogOptions, Shards)
+{
+  log::LogOptions options;
+  EXPECT_EQ(1u, options.ShardCount());
+  EXPECT_EQ(0u, options.TopicShard("/camera/left"));
+
+  options.AddShard(std::regex("/camera/.*"));
+  options.AddShard(std::regex("/lidar|/camera/left"));
+  EXPECT_EQ(3u, options.ShardCount());
+  EXPECT_EQ(1u, options.TopicShard("/camera/left"));
+  EXPECT_EQ(2u, options.TopicShard("/lidar"));
+  EXPECT_EQ(0u, options.TopicShard("/clock"));
+
+  log::LogOptions copy(options);
+  EXPECT_EQ(3u, copy.ShardCount());
+}
+
+//////////////////////////////////////////////////
+TEST(LogOptions, Rotation)
+{
+  log::LogOptions options;
+  EXPECT_EQ(std::chrono::milliseconds::zero(), options.RotationPeriod());
+  EXPECT_EQ(0u, options.RotationBytes());
+
+  options.SetRotationPeriod(std::chrono::minutes(10));
+  options.SetRotationBytes(1u << 30);
+  EXPECT_EQ(std::chrono::minutes(10), options.RotationPeriod());
+  EXPECT_EQ(1u << 30, options.RotationBytes());
+
+  log::LogOptions copy(options);
+  EXPECT_EQ(std::chrono::minutes(10), copy.RotationPeriod());
+  EXPECT_EQ(1u << 30, copy.RotationBytes());
+}
+
+//////////////////////////////////////////////////
+TEST(LogOptions, HighThroughputAndCopy)
+{
+  const log::LogOptions options = log::LogOptions::HighThroughput();
+  EXPECT_EQ(log::JournalMode::WAL, options.JournalMode());
+  EXPECT_EQ(log::SyncMode::NORMAL, options.Synchronous());
+  EXPECT_EQ(65536u, options.PageSize());
+  EXPECT_EQ(64u * 1024u, options.CacheSize());
+  EXPECT_EQ(256u << 20, options.MmapSize());
+  EXPECT_EQ(64u << 20, options.MaxTransactionBytes());
+
+  log::LogOptions copy(options);
+  EXPECT_EQ(log::JournalMode::WAL, copy.JournalMode());
+
+  log::LogOptions assigned;
+  assigned = options;
+  EXPECT_EQ(65536u, assigned.PageSize());
+  assigned.SetJournalMode(log::JournalMode::OFF);
+  EXPECT_EQ(log::JournalMode::WAL, options.JournalMode());
+}
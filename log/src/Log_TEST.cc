@@ -16,12 +16,24 @@
 */
 #include "gtest/gtest.h"
 
+#include <algorithm>
 #include <chrono>
+#include <filesystem>
+#include <fstream>
 #include <ios>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <regex>
 #include <string>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
+#include "gz/transport/MessageTypes.hh"
+#include "gz/transport/log/Descriptor.hh"
 #include "gz/transport/log/Log.hh"
+#include "gz/transport/log/LogOptions.hh"
 
 #include "test_utils.hh"
 
@@ -104,6 +116,391 @@ TEST(Log, InsertMessage)
       data.size()));
 }
 
+//////////////////////////////////////////////////
+/// \brief The topics inserted are added to the descriptor, and the
+/// descriptors of the message types known by the process are captured.
+TEST(Log, MessageTypeDescriptors)
+{
+  log::Log logFile;
+  EXPECT_TRUE(logFile.MessageTypeDescriptors("gz.msgs.Int32").empty());
+  ASSERT_TRUE(logFile.Open(":memory:", std::ios_base::out));
+
+  std::string data("Hello World");
+  const std::vector<std::pair<std::string, std::string>> topics =
+  {
+    {"/a", "gz.msgs.Int32"}, {"/b", "gz.msgs.Int32"},
+    {"/c", "some.message.type"}
+  };
+  for (const auto &topic : topics)
+  {
+    EXPECT_TRUE(logFile.InsertMessage(1s, topic.first, topic.second,
+        data.c_str(), data.size()));
+  }
+
+  const log::Descriptor *desc = logFile.Descriptor();
+  ASSERT_NE(nullptr, desc);
+  EXPECT_EQ(3u, desc->TopicsToMsgTypesToId().size());
+  EXPECT_EQ(2u, desc->MsgTypesToTopicsToId().at("gz.msgs.Int32").size());
+  EXPECT_NE(desc->TopicId("/a", "gz.msgs.Int32"),
+    desc->TopicId("/b", "gz.msgs.Int32"));
+
+  const std::string descriptors =
+    logFile.MessageTypeDescriptors("gz.msgs.Int32");
+  EXPECT_FALSE(descriptors.empty());
+  EXPECT_TRUE(MessageTypes::AddDescriptors(descriptors));
+  EXPECT_TRUE(logFile.MessageTypeDescriptors("some.message.type").empty());
+  EXPECT_TRUE(logFile.MessageTypeDescriptors("unknown.type").empty());
+}
+
+//////////////////////////////////////////////////
+TEST(Log, Metadata)
+{
+  log::Log unopened;
+  EXPECT_FALSE(unopened.SetMetadata("key", "value"));
+  EXPECT_TRUE(unopened.Metadata().empty());
+
+  log::Log logFile;
+  ASSERT_TRUE(logFile.Open(":memory:", std::ios_base::out));
+  EXPECT_TRUE(logFile.Metadata().empty());
+
+  EXPECT_TRUE(logFile.SetMetadata("key", "value"));
+  EXPECT_TRUE(logFile.SetMetadata("other", "1"));
+  EXPECT_TRUE(logFile.SetMetadata("other", "2"));
+
+  const std::map<std::string, std::string> metadata = logFile.Metadata();
+  ASSERT_EQ(2u, metadata.size());
+  EXPECT_EQ("value", metadata.at("key"));
+  EXPECT_EQ("2", metadata.at("other"));
+}
+
+//////////////////////////////////////////////////
+TEST(Log, OpenWithOptions)
+{
+  const std::filesystem::path file = std::filesystem::temp_directory_path() /
+    ("gz_log_options_" + testing::getRandomNumber() + ".tlog");
+  std::string data("Hello World");
+
+  {
+    log::Log logFile;
+    ASSERT_TRUE(logFile.Open(file.string(), std::ios_base::out,
+      log::LogOptions::HighThroughput()));
+    for (int i = 0; i < 3; ++i)
+    {
+      EXPECT_TRUE(logFile.InsertMessage(
+          std::chrono::seconds(i),
+          "/some/topic/name",
+          "some.message.type",
+          reinterpret_cast<const void *>(data.c_str()),
+          data.size()));
+    }
+  }
+
+  // The write-ahead log is merged when the log is closed.
+  EXPECT_FALSE(std::filesystem::exists(file.string() + "-wal"));
+
+  {
+    log::Log logFile;
+    ASSERT_TRUE(logFile.Open(file.string()));
+    int count = 0;
+    for (const auto &msg : logFile.QueryMessages())
+    {
+      EXPECT_EQ(data, msg.Data());
+      ++count;
+    }
+    EXPECT_EQ(3, count);
+  }
+
+  std::filesystem::remove(file);
+}
+
+//////////////////////////////////////////////////
+TEST(Log, InsertMessages)
+{
+  log::Log logFile;
+  EXPECT_EQ(0u, logFile.InsertMessages({}));
+  ASSERT_TRUE(logFile.Open(":memory:", std::ios_base::out));
+
+  const std::string topic1("/some/topic/name");
+  const std::string topic2("/other/topic/name");
+  const std::string type("some.message.type");
+  std::vector<std::string> data;
+  for (int i = 0; i < 201; ++i)
+    data.push_back("data_" + std::to_string(i));
+  // Empty messages aren't inserted.
+  data[100].clear();
+
+  std::vector<log::MessageRecord> records;
+  for (std::size_t i = 0; i < data.size(); ++i)
+  {
+    records.push_back({std::chrono::seconds(i), i % 3 ? &topic1 : &topic2,
+      &type, data[i].data(), data[i].size()});
+  }
+  EXPECT_EQ(200u, logFile.InsertMessages(records));
+
+  std::size_t i = 0;
+  for (const auto &msg : logFile.QueryMessages())
+  {
+    if (i == 100u)
+      ++i;
+    ASSERT_LT(i, data.size());
+    EXPECT_EQ(data[i], msg.Data());
+    EXPECT_EQ(i % 3 ? topic1 : topic2, msg.Topic());
+    ++i;
+  }
+  EXPECT_EQ(data.size(), i);
+}
+
+//////////////////////////////////////////////////
+TEST(Log, InsertMessageAsync)
+{
+  log::Log logFile;
+  EXPECT_EQ(0u, logFile.InsertMessageAsync(std::chrono::seconds(0), "/t",
+    "some.message.type", "data", 4));
+  log::LogOptions options;
+  // Small enough for the callers to wait for the writer thread
+  options.SetAsyncQueueBytes(64);
+  ASSERT_TRUE(logFile.Open(":memory:", std::ios_base::out, options));
+
+  const std::string topic("/some/topic/name");
+  const std::string type("some.message.type");
+  std::mutex mutex;
+  std::size_t succeeded = 0;
+  std::size_t failed = 0;
+  auto callback = [&](bool _success)
+  {
+    std::lock_guard<std::mutex> lk(mutex);
+    ++(_success ? succeeded : failed);
+  };
+
+  uint64_t seq = 0;
+  for (int i = 0; i < 500; ++i)
+  {
+    const std::string data = "data_" + std::to_string(i);
+    const uint64_t next = logFile.InsertMessageAsync(std::chrono::seconds(i),
+      topic, type, data.data(), data.size(), callback);
+    EXPECT_EQ(seq + 1, next);
+    seq = next;
+  }
+  logFile.Fence(seq);
+  {
+    std::lock_guard<std::mutex> lk(mutex);
+    EXPECT_EQ(500u, succeeded);
+  }
+
+  // Empty messages aren't inserted.
+  logFile.InsertMessageAsync(std::chrono::seconds(500), topic, type, "", 0,
+    callback);
+  EXPECT_FALSE(logFile.Flush());
+  EXPECT_EQ(1u, failed);
+  EXPECT_TRUE(logFile.Flush());
+
+  int i = 0;
+  for (const auto &msg : logFile.QueryMessages())
+  {
+    EXPECT_EQ("data_" + std::to_string(i), msg.Data());
+    EXPECT_EQ(topic, msg.Topic());
+    ++i;
+  }
+  EXPECT_EQ(500, i);
+}
+
+//////////////////////////////////////////////////
+TEST(Log, CompressedTopics)
+{
+  for (const auto codec : {Compression_t::LZ4, Compression_t::ZSTD})
+  {
+    log::LogOptions options;
+    if (!options.AddTopicCompression(std::regex("/compressed/.*"), codec))
+      continue;
+    ASSERT_TRUE(options.SetCompressionBlockSize(1024));
+    EXPECT_EQ(codec, options.TopicCompression("/compressed/topic"));
+    EXPECT_EQ(Compression_t::NONE, options.TopicCompression("/raw/topic"));
+
+    const std::filesystem::path file = std::filesystem::temp_directory_path()
+      / ("gz_log_compressed_" + testing::getRandomNumber() + ".tlog");
+
+    const std::string compressed("/compressed/topic");
+    const std::string raw("/raw/topic");
+    const std::string type("some.message.type");
+    std::vector<std::string> data;
+    for (int i = 0; i < 300; ++i)
+      data.push_back("data_" + std::to_string(i));
+
+    {
+      log::Log logFile;
+      ASSERT_TRUE(logFile.Open(file.string(), std::ios_base::out, options));
+      EXPECT_EQ("0.2.0", logFile.Version());
+
+      std::vector<log::MessageRecord> records;
+      for (std::size_t i = 0; i < 200; ++i)
+      {
+        records.push_back({std::chrono::seconds(i),
+          i % 2 ? &compressed : &raw, &type, data[i].data(),
+          data[i].size()});
+      }
+      EXPECT_EQ(200u, logFile.InsertMessages(records));
+
+      for (std::size_t i = 200; i < data.size(); ++i)
+      {
+        EXPECT_TRUE(logFile.InsertMessage(std::chrono::seconds(i),
+          i % 2 ? compressed : raw, type, data[i].data(), data[i].size()));
+      }
+
+      // The buffered messages are found before the end of the transaction.
+      EXPECT_EQ(std::chrono::seconds(299), logFile.EndTime());
+      std::size_t count = 0;
+      for (const auto &msg : logFile.QueryMessages())
+      {
+        EXPECT_EQ(data[count], msg.Data());
+        ++count;
+      }
+      EXPECT_EQ(data.size(), count);
+    }
+
+    {
+      log::Log logFile;
+      ASSERT_TRUE(logFile.Open(file.string()));
+      EXPECT_EQ("0.2.0", logFile.Version());
+      std::size_t i = 0;
+      for (const auto &msg : logFile.QueryMessages())
+      {
+        ASSERT_LT(i, data.size());
+        EXPECT_EQ(data[i], msg.Data());
+        EXPECT_EQ(i % 2 ? compressed : raw, msg.Topic());
+        ++i;
+      }
+      EXPECT_EQ(data.size(), i);
+
+      // A single topic.
+      i = 1;
+      for (const auto &msg : logFile.QueryMessages(
+             log::TopicList(compressed)))
+      {
+        ASSERT_LT(i, data.size());
+        EXPECT_EQ(data[i], msg.Data());
+        i += 2;
+      }
+      EXPECT_EQ(data.size() + 1, i);
+    }
+
+    std::filesystem::remove(file);
+  }
+}
+
+//////////////////////////////////////////////////
+TEST(Log, MessageChecksums)
+{
+  log::LogOptions options;
+  options.SetMessageChecksums(true);
+  // Checked blocks when LZ4 is available, checked raw messages otherwise.
+  options.AddTopicCompression(std::regex("/compressed"), Compression_t::LZ4);
+
+  const std::filesystem::path file = std::filesystem::temp_directory_path()
+    / ("gz_log_checksums_" + testing::getRandomNumber() + ".tlog");
+  const std::string type("some.message.type");
+  {
+    log::Log logFile;
+    ASSERT_TRUE(logFile.Open(file.string(), std::ios_base::out, options));
+    EXPECT_EQ("0.2.0", logFile.Version());
+    for (int i = 0; i < 100; ++i)
+    {
+      const std::string data = "checked_message_" + std::to_string(i);
+      EXPECT_TRUE(logFile.InsertMessage(std::chrono::seconds(i),
+          i % 2 ? "/compressed" : "/raw", type, data.data(), data.size()));
+    }
+  }
+
+  {
+    log::Log logFile;
+    ASSERT_TRUE(logFile.Open(file.string()));
+    int i = 0;
+    for (const auto &msg : logFile.QueryMessages())
+      EXPECT_EQ("checked_message_" + std::to_string(i++), msg.Data());
+    EXPECT_EQ(100, i);
+
+    log::LogVerification result;
+    EXPECT_TRUE(logFile.Verify(3, result));
+    EXPECT_EQ(100u, result.messages);
+    EXPECT_EQ(100u, result.checked);
+    EXPECT_EQ(0u, result.corrupt);
+    EXPECT_TRUE(result.intact);
+  }
+
+  // A byte flipped in a message stored as it is. SQLite doesn't notice it.
+  {
+    std::fstream stream(file, std::ios_base::in | std::ios_base::out |
+      std::ios_base::binary);
+    const std::string content((std::istreambuf_iterator<char>(stream)),
+        std::istreambuf_iterator<char>());
+    const std::size_t pos = content.find("checked_message_42");
+    ASSERT_NE(std::string::npos, pos);
+    stream.clear();
+    stream.seekp(static_cast<std::streamoff>(pos));
+    stream.put('C');
+  }
+
+  {
+    log::Log logFile;
+    ASSERT_TRUE(logFile.Open(file.string()));
+    for (const auto &msg : logFile.QueryMessages(log::TopicList("/raw")))
+    {
+      if (msg.TimeReceived() == 42s)
+        EXPECT_TRUE(msg.Data().empty());
+      else
+        EXPECT_FALSE(msg.Data().empty());
+    }
+
+    log::LogVerification result;
+    EXPECT_FALSE(logFile.Verify(0, result));
+    EXPECT_EQ(100u, result.messages);
+    EXPECT_EQ(1u, result.corrupt);
+    EXPECT_TRUE(result.intact);
+  }
+  std::filesystem::remove(file);
+}
+
+//////////////////////////////////////////////////
+TEST(Log, TransactionSize)
+{
+  const std::filesystem::path file = std::filesystem::temp_directory_path() /
+    ("gz_log_transaction_" + testing::getRandomNumber() + ".tlog");
+  const std::string topic("/some/topic/name");
+  const std::string type("some.message.type");
+  const std::string data("Hello World");
+
+  log::LogOptions options;
+  options.SetTransactionPeriod(std::chrono::hours(1));
+  options.SetMaxTransactionRows(64);
+
+  log::Log logFile;
+  ASSERT_TRUE(logFile.Open(file.string(), std::ios_base::out, options));
+  std::vector<log::MessageRecord> records(100,
+    {0ns, &topic, &type, data.data(), data.size()});
+  EXPECT_EQ(100u, logFile.InsertMessages(records));
+
+  // Only the first full transaction is committed.
+  auto countMessages = [&file]()
+  {
+    log::Log reader;
+    EXPECT_TRUE(reader.Open(file.string()));
+    int count = 0;
+    for (const auto &msg : reader.QueryMessages())
+    {
+      (void)msg;
+      ++count;
+    }
+    return count;
+  };
+  EXPECT_EQ(64, countMessages());
+
+  // Reaching the size ends the transaction.
+  records.resize(28);
+  EXPECT_EQ(28u, logFile.InsertMessages(records));
+  EXPECT_EQ(128, countMessages());
+
+  std::filesystem::remove(file);
+}
+
 //////////////////////////////////////////////////
 TEST(Log, AllMessagesNone)
 {
@@ -207,6 +604,477 @@ TEST(Log, Insert2Get1MessageByTopic)
   }
 }
 
+//////////////////////////////////////////////////
+TEST(Log, LatestMessages)
+{
+  log::Log logFile;
+  ASSERT_TRUE(logFile.Open(":memory:", std::ios_base::out));
+
+  const std::vector<std::pair<std::chrono::nanoseconds, std::string>> rows =
+  {
+    {1s, "/a"}, {2s, "/a"}, {3s, "/b"}, {4s, "/a"}
+  };
+  for (const auto &row : rows)
+  {
+    const std::string data = std::to_string(row.first.count());
+    EXPECT_TRUE(logFile.InsertMessage(row.first, row.second,
+        "some.message.type", data.c_str(), data.size()));
+  }
+
+  {
+    auto batch = logFile.QueryMessages(
+        log::LatestMessages({"/a", "/b", "/none"}));
+    auto iter = batch.begin();
+    ASSERT_NE(batch.end(), iter);
+    EXPECT_EQ("/a", iter->Topic());
+    EXPECT_EQ(4s, iter->TimeReceived());
+    ++iter;
+    ASSERT_NE(batch.end(), iter);
+    EXPECT_EQ("/b", iter->Topic());
+    EXPECT_EQ(3s, iter->TimeReceived());
+    ++iter;
+    EXPECT_EQ(batch.end(), iter);
+  }
+
+  {
+    // The state just before 3s
+    auto batch = logFile.QueryMessages(
+        log::LatestMessages({"/a", "/b"}, log::QualifiedTimeRange::Until(
+            log::QualifiedTime(3s, log::QualifiedTime::Qualifier::EXCLUSIVE))));
+    auto iter = batch.begin();
+    ASSERT_NE(batch.end(), iter);
+    EXPECT_EQ("/a", iter->Topic());
+    EXPECT_EQ(std::to_string(std::chrono::nanoseconds(2s).count()),
+        iter->Data());
+    ++iter;
+    EXPECT_EQ(batch.end(), iter);
+  }
+}
+
+//////////////////////////////////////////////////
+TEST(Log, QueryMessagesPrefetch)
+{
+  log::Log logFile;
+  ASSERT_TRUE(logFile.Open(":memory:", std::ios_base::out));
+  for (int i = 0; i < 100; ++i)
+  {
+    const std::string data(i % 10 + 1, 'x');
+    EXPECT_TRUE(logFile.InsertMessage(std::chrono::milliseconds(i),
+        i % 3 == 0 ? "/a" : "/b", i % 3 == 0 ? "type.A" : "type.B",
+        data.c_str(), data.size()));
+  }
+
+  auto read = [](log::Batch &_batch)
+  {
+    std::vector<std::string> messages;
+    for (const log::Message &msg : _batch)
+    {
+      messages.push_back(std::to_string(msg.TimeReceived().count()) + " " +
+          msg.Topic() + " " + msg.Type() + " " + msg.Data());
+    }
+    return messages;
+  };
+
+  auto batch = logFile.QueryMessages();
+  const std::vector<std::string> expected = read(batch);
+  ASSERT_EQ(100u, expected.size());
+
+  // Rows are fetched by 7, or until there are at least 20 bytes of data
+  batch.SetPrefetch(7);
+  EXPECT_EQ(expected, read(batch));
+  batch.SetPrefetch(7, 20);
+  EXPECT_EQ(expected, read(batch));
+
+  // Every statement of the query is fetched in turn
+  batch = logFile.QueryMessages(log::LatestMessages({"/a", "/b"}));
+  batch.SetPrefetch(7, 20);
+  const std::vector<std::string> latest = read(batch);
+  ASSERT_EQ(2u, latest.size());
+  EXPECT_EQ("99000000 /a type.A xxxxxxxxxx", latest[0]);
+  EXPECT_EQ("98000000 /b type.B xxxxxxxxx", latest[1]);
+}
+
+//////////////////////////////////////////////////
+TEST(Log, Reindex)
+{
+  const std::filesystem::path file = std::filesystem::temp_directory_path() /
+    ("gz_log_reindex_" + testing::getRandomNumber() + ".tlog");
+  const std::string data("Hello World");
+
+  {
+    log::Log logFile;
+    ASSERT_TRUE(logFile.Open(file.string(), std::ios_base::out));
+    EXPECT_TRUE(logFile.InsertMessage(1s, "/a", "some.message.type",
+        data.c_str(), data.size()));
+    EXPECT_TRUE(logFile.InsertMessage(2s, "/b", "some.message.type",
+        data.c_str(), data.size()));
+  }
+
+  // Reindexing twice is harmless
+  EXPECT_TRUE(log::ReindexLog(file.string()));
+  EXPECT_TRUE(log::ReindexLog(file.string()));
+  EXPECT_FALSE(log::ReindexLog("/this/path/does/not/exist.tlog"));
+
+  {
+    log::Log logFile;
+    ASSERT_TRUE(logFile.Open(file.string(), std::ios_base::in));
+    EXPECT_EQ("0.1.0", logFile.Version());
+    auto batch = logFile.QueryMessages(log::TopicList("/b"));
+    auto iter = batch.begin();
+    ASSERT_NE(batch.end(), iter);
+    EXPECT_EQ(2s, iter->TimeReceived());
+    ++iter;
+    EXPECT_EQ(batch.end(), iter);
+  }
+
+  std::filesystem::remove(file);
+}
+
+//////////////////////////////////////////////////
+TEST(Log, CutAndMerge)
+{
+  const std::string prefix = (std::filesystem::temp_directory_path() /
+    ("gz_log_copy_" + testing::getRandomNumber())).string();
+  const std::string raw = prefix + "_raw.tlog";
+  const std::string compressed = prefix + "_compressed.tlog";
+  const std::string cut = prefix + "_cut.tlog";
+  const std::string cutBlocks = prefix + "_cut_blocks.tlog";
+  const std::string merged = prefix + "_merged.tlog";
+  const std::string type("some.message.type");
+  std::string encoded = "0.2.0";
+
+  {
+    log::Log logFile;
+    ASSERT_TRUE(logFile.Open(raw, std::ios_base::out));
+    for (int i = 1; i <= 10; ++i)
+    {
+      const std::string data = "raw_" + std::to_string(i);
+      EXPECT_TRUE(logFile.InsertMessage(std::chrono::seconds(i),
+          i % 2 ? "/a" : "/b", type, data.data(), data.size()));
+    }
+    EXPECT_TRUE(logFile.SetMetadata("robot", "first"));
+  }
+
+  {
+    // The blocks are copied as they are when the codec is available.
+    log::LogOptions options;
+    if (!options.AddTopicCompression(std::regex("/a"), Compression_t::LZ4))
+      encoded = "0.1.0";
+    log::Log logFile;
+    ASSERT_TRUE(logFile.Open(compressed, std::ios_base::out, options));
+    for (int i = 1; i <= 10; ++i)
+    {
+      const std::string data = "compressed_" + std::to_string(i);
+      EXPECT_TRUE(logFile.InsertMessage(std::chrono::milliseconds(1500) +
+          std::chrono::seconds(i), i % 2 ? "/a" : "/c", type, data.data(),
+          data.size()));
+    }
+    EXPECT_TRUE(logFile.SetMetadata("robot", "second"));
+  }
+
+  EXPECT_TRUE(log::CutLog(raw, cut,
+      log::QualifiedTimeRange(log::QualifiedTime(3s),
+        log::QualifiedTime(6s, log::QualifiedTime::Qualifier::EXCLUSIVE))));
+  EXPECT_FALSE(log::CutLog(raw, cut, log::QualifiedTimeRange::AllTime()));
+  EXPECT_FALSE(log::CutLog("/this/path/does/not/exist.tlog", prefix,
+      log::QualifiedTimeRange::AllTime()));
+
+  {
+    log::Log logFile;
+    ASSERT_TRUE(logFile.Open(cut));
+    EXPECT_EQ("0.1.0", logFile.Version());
+    std::vector<std::string> data;
+    for (const auto &msg : logFile.QueryMessages())
+      data.push_back(msg.Topic() + ":" + msg.Data());
+    EXPECT_EQ(std::vector<std::string>({"/a:raw_3", "/b:raw_4", "/a:raw_5"}),
+        data);
+    EXPECT_EQ("first", logFile.Metadata()["robot"]);
+  }
+
+  EXPECT_TRUE(log::CutLog(compressed, cutBlocks,
+      log::QualifiedTimeRange(log::QualifiedTime(4s), log::QualifiedTime(6s))));
+
+  {
+    log::Log logFile;
+    ASSERT_TRUE(logFile.Open(cutBlocks));
+    EXPECT_EQ(encoded, logFile.Version());
+    std::vector<std::string> data;
+    for (const auto &msg : logFile.QueryMessages())
+      data.push_back(msg.Topic() + ":" + msg.Data());
+    EXPECT_EQ(std::vector<std::string>({"/a:compressed_3", "/c:compressed_4"}),
+        data);
+  }
+
+  EXPECT_TRUE(log::MergeLogs({raw, compressed}, merged));
+
+  {
+    log::Log logFile;
+    ASSERT_TRUE(logFile.Open(merged));
+    EXPECT_EQ(encoded, logFile.Version());
+    std::vector<std::string> data;
+    for (const auto &msg : logFile.QueryMessages(
+           log::TopicList::Create(std::vector<std::string>({"/a", "/c"}))))
+    {
+      data.push_back(msg.Topic() + ":" + msg.Data());
+    }
+    EXPECT_EQ(std::vector<std::string>({"/a:raw_1", "/a:compressed_1",
+        "/a:raw_3", "/c:compressed_2", "/a:compressed_3", "/a:raw_5",
+        "/c:compressed_4", "/a:compressed_5", "/a:raw_7", "/c:compressed_6",
+        "/a:compressed_7", "/a:raw_9", "/c:compressed_8", "/a:compressed_9",
+        "/c:compressed_10"}), data);
+    EXPECT_EQ(1u, logFile.Descriptor()->TopicsToMsgTypesToId().at(
+        "/a").size());
+
+    const auto summary = logFile.Summary();
+    ASSERT_EQ(3u, summary.size());
+    EXPECT_EQ(10u, summary.at("/a").messages);
+    EXPECT_EQ(5u, summary.at("/b").messages);
+    EXPECT_EQ(5u, summary.at("/c").messages);
+    EXPECT_EQ(1s, logFile.StartTime());
+    EXPECT_EQ(11500ms, logFile.EndTime());
+    EXPECT_EQ("first", logFile.Metadata()["robot"]);
+  }
+
+  for (const std::string &file : {raw, compressed, cut, cutBlocks, merged})
+    std::filesystem::remove(file);
+}
+
+//////////////////////////////////////////////////
+TEST(Log, ParallelScan)
+{
+  const std::filesystem::path file = std::filesystem::temp_directory_path() /
+    ("gz_log_parallel_" + testing::getRandomNumber() + ".tlog");
+
+  log::Log logFile;
+  ASSERT_TRUE(logFile.Open(file.string(), std::ios_base::out));
+  for (int i = 0; i < 1000; ++i)
+  {
+    const std::string data = std::to_string(i);
+    EXPECT_TRUE(logFile.InsertMessage(std::chrono::milliseconds(i),
+        i % 4 == 0 ? "/a" : "/b", "some.message.type", data.c_str(),
+        data.size()));
+  }
+
+  std::mutex mutex;
+  std::map<int64_t, std::string> visited;
+  auto callback = [&](const log::Message &_msg)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    EXPECT_TRUE(visited.emplace(_msg.TimeReceived().count(),
+        _msg.Data()).second);
+  };
+
+  EXPECT_TRUE(logFile.ParallelScan(log::TopicList("/a"), 3, callback));
+  ASSERT_EQ(250u, visited.size());
+  for (const auto &entry : visited)
+  {
+    const int i = static_cast<int>(entry.first / 1000000);
+    EXPECT_EQ(0, i % 4);
+    EXPECT_EQ(std::to_string(i), entry.second);
+  }
+
+  visited.clear();
+  EXPECT_TRUE(logFile.ParallelScan(log::AllTopics(), 0, callback));
+  EXPECT_EQ(1000u, visited.size());
+
+  // Other connections can't open a private in-memory database
+  log::Log memoryLog;
+  ASSERT_TRUE(memoryLog.Open(":memory:", std::ios_base::out));
+  EXPECT_FALSE(memoryLog.ParallelScan(log::AllTopics(), 2, callback));
+
+  std::filesystem::remove(file);
+}
+
+//////////////////////////////////////////////////
+TEST(Log, Summary)
+{
+  const std::filesystem::path file = std::filesystem::temp_directory_path() /
+    ("gz_log_summary_" + testing::getRandomNumber() + ".tlog");
+  const std::string shared = "file:logSummary?mode=memory&cache=shared";
+
+  auto check = [](const log::Log &_log)
+  {
+    const auto summary = _log.Summary();
+    ASSERT_EQ(2u, summary.size());
+    EXPECT_EQ(2u, summary.at("/a").messages);
+    EXPECT_EQ(8u, summary.at("/a").bytes);
+    EXPECT_EQ(1s, summary.at("/a").startTime);
+    EXPECT_EQ(3s, summary.at("/a").endTime);
+    EXPECT_EQ(1u, summary.at("/b").messages);
+    EXPECT_EQ(2s, summary.at("/b").startTime);
+    EXPECT_EQ(1s, _log.StartTime());
+    EXPECT_EQ(3s, _log.EndTime());
+  };
+
+  // Commit every message, so the reader of the shared log sees them
+  log::LogOptions options;
+  options.SetMaxTransactionRows(1);
+
+  for (const std::string &name : {file.string(), shared})
+  {
+    log::Log logFile;
+    ASSERT_TRUE(logFile.Open(name, std::ios_base::out, options));
+    const std::string data("data");
+    EXPECT_TRUE(logFile.InsertMessage(1s, "/a", "some.message.type",
+        data.c_str(), data.size()));
+    EXPECT_TRUE(logFile.InsertMessage(2s, "/b", "some.message.type",
+        data.c_str(), data.size()));
+    EXPECT_TRUE(logFile.InsertMessage(3s, "/a", "some.message.type",
+        data.c_str(), data.size()));
+
+    // Counted while writing
+    check(logFile);
+
+    if (name == shared)
+    {
+      // Without the summary of a closed log, the messages are counted
+      log::Log reader;
+      ASSERT_TRUE(reader.Open(name, std::ios_base::in));
+      check(reader);
+    }
+  }
+
+  // Stored when the log is closed
+  log::Log reader;
+  ASSERT_TRUE(reader.Open(file.string(), std::ios_base::in));
+  check(reader);
+
+  std::filesystem::remove(file);
+}
+
+//////////////////////////////////////////////////
+TEST(Log, ReverseAndSampledQueries)
+{
+  log::Log logFile;
+  ASSERT_TRUE(logFile.Open(":memory:", std::ios_base::out));
+  const std::string type("some.message.type");
+
+  // /a every 10 ms and /b every 25 ms during 1 s
+  for (int i = 0; i < 100; ++i)
+  {
+    const std::string data = std::to_string(i);
+    EXPECT_TRUE(logFile.InsertMessage(1s + i * 10ms, "/a", type,
+        data.c_str(), data.size()));
+    if (i < 40)
+    {
+      EXPECT_TRUE(logFile.InsertMessage(1s + i * 25ms, "/b", type,
+          data.c_str(), data.size()));
+    }
+  }
+
+  // Backward
+  std::vector<std::chrono::nanoseconds> forward;
+  for (const auto &msg : logFile.QueryMessages())
+    forward.push_back(msg.TimeReceived());
+  ASSERT_EQ(140u, forward.size());
+
+  auto batch = logFile.QueryMessages();
+  std::vector<std::chrono::nanoseconds> backward;
+  for (auto it = batch.rbegin(); it != batch.rend(); ++it)
+    backward.push_back(it->TimeReceived());
+  std::reverse(backward.begin(), backward.end());
+  EXPECT_EQ(forward, backward);
+
+  batch = logFile.QueryMessages(log::TopicList("/a"));
+  auto it = batch.rbegin();
+  ASSERT_NE(batch.rend(), it);
+  EXPECT_EQ("99", it->Data());
+  EXPECT_EQ("98", (++it)->Data());
+
+  // Sampled: the first message of every topic every 100 ms, of /a between
+  // 1.2 s and 1.5 s
+  log::AllTopics all;
+  all.SetSampleInterval(100ms);
+  EXPECT_EQ(100ms, all.SampleInterval());
+  std::map<std::string, std::vector<std::string>> sampled;
+  for (const auto &msg : logFile.QueryMessages(all))
+    sampled[msg.Topic()].push_back(msg.Data());
+  ASSERT_EQ(2u, sampled.size());
+  EXPECT_EQ(10u, sampled["/a"].size());
+  EXPECT_EQ("0", sampled["/a"][0]);
+  EXPECT_EQ("10", sampled["/a"][1]);
+  EXPECT_EQ(10u, sampled["/b"].size());
+
+  log::TopicList range("/a",
+      log::QualifiedTimeRange(1s + 200ms, 1s + 500ms));
+  range.SetSampleInterval(100ms);
+  std::vector<std::string> data;
+  for (const auto &msg : logFile.QueryMessages(range))
+    data.push_back(msg.Data());
+  EXPECT_EQ(std::vector<std::string>({"20", "30", "40", "50"}), data);
+
+  // Sampled and backward
+  data.clear();
+  batch = logFile.QueryMessages(range);
+  for (auto rit = batch.rbegin(); rit != batch.rend(); ++rit)
+    data.push_back(rit->Data());
+  EXPECT_EQ(std::vector<std::string>({"50", "40", "30", "20"}), data);
+}
+
+//////////////////////////////////////////////////
+TEST(Log, Statistics)
+{
+  log::Log logFile;
+  ASSERT_TRUE(logFile.Open(":memory:", std::ios_base::out));
+  const std::string type("some.message.type");
+  const std::string data("data");
+
+  // /a every 10 ms, with a gap of 1 s after the 50th message
+  std::chrono::nanoseconds time = 1s;
+  for (int i = 0; i < 100; ++i)
+  {
+    EXPECT_TRUE(logFile.InsertMessage(time, "/a", type, data.c_str(),
+        data.size()));
+    time += i == 49 ? std::chrono::nanoseconds(1s) : 10ms;
+  }
+  for (int i = 0; i < 3; ++i)
+  {
+    EXPECT_TRUE(logFile.InsertMessage(2s, "/b", type, data.c_str(),
+        data.size()));
+  }
+
+  auto stats = logFile.Statistics();
+  ASSERT_EQ(2u, stats.size());
+
+  const log::TopicStatistics &a = stats.at("/a");
+  EXPECT_EQ(100u, a.messages);
+  EXPECT_EQ(400u, a.storedBytes);
+  EXPECT_EQ(1s, a.startTime);
+  EXPECT_EQ(1s + 98 * 10ms + 1s, a.endTime);
+  EXPECT_EQ(10ms, a.minGap);
+  EXPECT_EQ(1s, a.maxGap);
+  EXPECT_EQ(1s + 49 * 10ms, a.maxGapStart);
+  EXPECT_NEAR(99 / 1.98, a.rate, 1e-9);
+  EXPECT_LT(0, a.gapStdDev.count());
+  // 10 ms is in [2^23, 2^24) ns, 1 s in [2^29, 2^30) ns
+  EXPECT_EQ(98u, a.gapHistogram[24]);
+  EXPECT_EQ(1u, a.gapHistogram[30]);
+  uint64_t gaps = 0;
+  for (const uint64_t bin : a.gapHistogram)
+    gaps += bin;
+  EXPECT_EQ(99u, gaps);
+
+  const log::TopicStatistics &b = stats.at("/b");
+  EXPECT_EQ(3u, b.messages);
+  EXPECT_EQ(0, b.maxGap.count());
+  EXPECT_EQ(2u, b.gapHistogram[0]);
+  EXPECT_EQ(0.0, b.rate);
+
+  // The messages of /a of the first second
+  stats = logFile.Statistics(log::TopicList("/a",
+      log::QualifiedTimeRange(1s, 2s)));
+  ASSERT_EQ(1u, stats.size());
+  EXPECT_EQ(50u, stats.at("/a").messages);
+  EXPECT_EQ(10ms, stats.at("/a").maxGap);
+  EXPECT_EQ(0, stats.at("/a").gapStdDev.count());
+
+  stats = logFile.Statistics(log::TopicList("/c"));
+  EXPECT_TRUE(stats.empty());
+
+  log::Log invalid;
+  EXPECT_TRUE(invalid.Statistics().empty());
+}
+
 //////////////////////////////////////////////////
 TEST(Log, CheckLogTimes)
 {
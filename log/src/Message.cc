@@ -17,6 +17,7 @@
 
 #include <chrono>
 #include <string>
+#include <string_view>
 
 #include "gz/transport/log/Message.hh"
 
@@ -60,6 +61,15 @@ Message::Message(const std::chrono::nanoseconds &_timeRecv,
             const char *_type, std::size_t _typeLen,
             const char *_topic, std::size_t _topicLen)
   : dataPtr(new MessagePrivate)
+{
+  this->Reset(_timeRecv, _data, _dataLen, _type, _typeLen, _topic, _topicLen);
+}
+
+//////////////////////////////////////////////////
+void Message::Reset(const std::chrono::nanoseconds &_timeRecv,
+            const void *_data, std::size_t _dataLen,
+            const char *_type, std::size_t _typeLen,
+            const char *_topic, std::size_t _topicLen)
 {
   this->dataPtr->timeReceived = _timeRecv;
   this->dataPtr->data = _data;
@@ -82,6 +92,13 @@ std::string Message::Data() const
       this->dataPtr->dataLen);
 }
 
+//////////////////////////////////////////////////
+std::string_view Message::DataView() const
+{
+  return std::string_view(reinterpret_cast<const char *>(this->dataPtr->data),
+      this->dataPtr->dataLen);
+}
+
 //////////////////////////////////////////////////
 std::string Message::Type() const
 {
@@ -0,0 +1,320 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <sqlite3.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Compression.hh"
+#include "Console.hh"
+#include "Crc32c.hh"
+#include "MessageBlocks.hh"
+
+using namespace gz::transport;
+using namespace gz::transport::log;
+
+//////////////////////////////////////////////////
+/// \brief Append an unsigned integer in little endian.
+/// \param[in] _value The integer.
+/// \param[in] _bytes Number of bytes to append.
+/// \param[out] _buffer Destination.
+static void PutUint(const uint64_t _value, const std::size_t _bytes,
+    std::string &_buffer)
+{
+  for (std::size_t i = 0; i < _bytes; ++i)
+    _buffer.push_back(static_cast<char>((_value >> (8 * i)) & 0xFF));
+}
+
+//////////////////////////////////////////////////
+/// \brief Read an unsigned integer in little endian.
+/// \param[in] _data Source.
+/// \param[in] _bytes Number of bytes to read.
+/// \return The integer.
+static uint64_t GetUint(const char *_data, const std::size_t _bytes)
+{
+  uint64_t value = 0;
+  for (std::size_t i = 0; i < _bytes; ++i)
+  {
+    value |= static_cast<uint64_t>(static_cast<unsigned char>(_data[i]))
+      << (8 * i);
+  }
+  return value;
+}
+
+//////////////////////////////////////////////////
+std::string log::EncodeRawMessage(const void *_data, const std::size_t _len,
+    const bool _checked)
+{
+  std::string blob;
+  blob.reserve(RawMessageOverhead(_checked) + _len);
+  if (_checked)
+  {
+    blob.push_back(static_cast<char>(BlobEncoding::CHECKED_RAW));
+    PutUint(Crc32c(_data, _len), 4, blob);
+  }
+  else
+  {
+    blob.push_back(static_cast<char>(BlobEncoding::RAW));
+  }
+  blob.append(static_cast<const char *>(_data), _len);
+  return blob;
+}
+
+//////////////////////////////////////////////////
+std::size_t log::RawMessageOverhead(const bool _checked)
+{
+  return _checked ? 5 : 1;
+}
+
+//////////////////////////////////////////////////
+std::string log::EncodeBlockReference(const BlockReference &_reference)
+{
+  std::string reference;
+  reference.reserve(kCheckedBlockReferenceSize);
+  reference.push_back(static_cast<char>(_reference.checked ?
+    BlobEncoding::CHECKED_BLOCK : BlobEncoding::BLOCK));
+  PutUint(static_cast<uint64_t>(_reference.block), 8, reference);
+  PutUint(_reference.index, 4, reference);
+  if (_reference.checked)
+    PutUint(_reference.crc, 4, reference);
+  return reference;
+}
+
+//////////////////////////////////////////////////
+bool log::DecodeBlockReference(const void *_blob, const std::size_t _len,
+    BlockReference &_reference)
+{
+  const char *blob = static_cast<const char *>(_blob);
+  if (_len == kBlockReferenceSize &&
+      static_cast<BlobEncoding>(blob[0]) == BlobEncoding::BLOCK)
+  {
+    _reference.checked = false;
+    _reference.crc = 0;
+  }
+  else if (_len == kCheckedBlockReferenceSize &&
+      static_cast<BlobEncoding>(blob[0]) == BlobEncoding::CHECKED_BLOCK)
+  {
+    _reference.checked = true;
+    _reference.crc = static_cast<uint32_t>(GetUint(blob + 13, 4));
+  }
+  else
+  {
+    return false;
+  }
+
+  _reference.block = static_cast<int64_t>(GetUint(blob + 1, 8));
+  _reference.index = static_cast<uint32_t>(GetUint(blob + 9, 4));
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool log::HasChecksum(const void *_blob, const std::size_t _len)
+{
+  if (_len == 0)
+    return false;
+
+  const BlobEncoding encoding =
+    static_cast<BlobEncoding>(*static_cast<const char *>(_blob));
+  return encoding == BlobEncoding::CHECKED_RAW ||
+    encoding == BlobEncoding::CHECKED_BLOCK;
+}
+
+//////////////////////////////////////////////////
+bool log::EncodeBlock(const Compression_t _codec,
+    const std::vector<uint32_t> &_sizes, const std::string &_data,
+    std::string &_block)
+{
+  std::string raw;
+  raw.reserve(4 * (_sizes.size() + 1) + _data.size());
+  PutUint(_sizes.size(), 4, raw);
+  for (const uint32_t size : _sizes)
+    PutUint(size, 4, raw);
+  raw.append(_data);
+
+  const std::size_t bound = CompressBound(_codec, raw.size());
+  if (bound == 0)
+    return false;
+
+  _block.resize(bound);
+  const std::size_t size =
+    Compress(_codec, 0, raw.data(), raw.size(), &_block[0], bound);
+  _block.resize(size);
+  return size > 0;
+}
+
+//////////////////////////////////////////////////
+BlockCache::BlockCache(const std::shared_ptr<raii_sqlite3::Database> &_db)
+  : db(_db)
+{
+}
+
+//////////////////////////////////////////////////
+BlockCache::~BlockCache()
+{
+  // The statement must be destroyed before the database.
+  this->statement.reset();
+}
+
+//////////////////////////////////////////////////
+bool BlockCache::Decode(const void *_blob, const std::size_t _len,
+    const void *&_data, std::size_t &_size)
+{
+  const char *blob = static_cast<const char *>(_blob);
+  if (_len == 0)
+  {
+    LERR("Empty message in a log with compressed messages\n");
+    return false;
+  }
+
+  if (static_cast<BlobEncoding>(blob[0]) == BlobEncoding::RAW)
+  {
+    _data = blob + 1;
+    _size = _len - 1;
+    return true;
+  }
+
+  if (static_cast<BlobEncoding>(blob[0]) == BlobEncoding::CHECKED_RAW &&
+      _len >= RawMessageOverhead(true))
+  {
+    _data = blob + RawMessageOverhead(true);
+    _size = _len - RawMessageOverhead(true);
+    if (Crc32c(_data, _size) != static_cast<uint32_t>(GetUint(blob + 1, 4)))
+    {
+      LERR("Message with an invalid checksum\n");
+      return false;
+    }
+    return true;
+  }
+
+  BlockReference reference;
+  if (!DecodeBlockReference(_blob, _len, reference))
+  {
+    LERR("Unknown encoding of a message\n");
+    return false;
+  }
+  const int64_t id = reference.block;
+  const uint32_t index = reference.index;
+
+  auto it = this->blocks.begin();
+  while (it != this->blocks.end() && it->id != id)
+    ++it;
+
+  if (it != this->blocks.end())
+  {
+    this->blocks.splice(this->blocks.begin(), this->blocks, it);
+  }
+  else
+  {
+    Block block;
+    if (!this->Load(id, block))
+      return false;
+
+    this->blocks.push_front(std::move(block));
+    if (this->blocks.size() > kMaxBlocks)
+      this->blocks.pop_back();
+  }
+
+  const Block &block = this->blocks.front();
+  if (index >= block.messages.size())
+  {
+    LERR("Invalid message [" << index << "] of block [" << id << "]\n");
+    return false;
+  }
+
+  _data = block.data.data() + block.messages[index].first;
+  _size = block.messages[index].second;
+  if (reference.checked && Crc32c(_data, _size) != reference.crc)
+  {
+    LERR("Message [" << index << "] of block [" << id
+         << "] with an invalid checksum\n");
+    return false;
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool BlockCache::Load(const int64_t _id, Block &_block)
+{
+  if (!this->statement)
+  {
+    this->statement.reset(new raii_sqlite3::CachedStatement(this->db,
+      "SELECT codec, data FROM message_blocks WHERE id = ?001;"));
+    if (!*(this->statement))
+    {
+      LERR("Failed to compile the block query: "
+           << sqlite3_errmsg(this->db->Handle()) << "\n");
+      this->statement.reset();
+      return false;
+    }
+  }
+
+  sqlite3_stmt *handle = this->statement->Handle();
+  sqlite3_bind_int64(handle, 1, _id);
+
+  bool success = false;
+  if (sqlite3_step(handle) == SQLITE_ROW)
+  {
+    const Compression_t codec =
+      static_cast<Compression_t>(sqlite3_column_int(handle, 0));
+    const char *data =
+      static_cast<const char *>(sqlite3_column_blob(handle, 1));
+    const std::size_t size =
+      static_cast<std::size_t>(sqlite3_column_bytes(handle, 1));
+    success = data && Decompress(codec, data, size, _block.data);
+    if (!success)
+    {
+      LERR("Unable to decompress block [" << _id << "] with codec ["
+           << CompressionName(codec) << "]\n");
+    }
+  }
+  else
+  {
+    LERR("Block [" << _id << "] not found\n");
+  }
+  sqlite3_reset(handle);
+  sqlite3_clear_bindings(handle);
+
+  if (!success)
+    return false;
+
+  // The sizes of the messages.
+  const std::string &raw = _block.data;
+  const uint64_t count = raw.size() >= 4 ? GetUint(raw.data(), 4) : 0;
+  std::size_t offset = 4 * (count + 1);
+  if (raw.size() < 4 || offset > raw.size())
+  {
+    LERR("Malformed block [" << _id << "]\n");
+    return false;
+  }
+
+  _block.id = _id;
+  _block.messages.reserve(count);
+  for (uint64_t i = 0; i < count; ++i)
+  {
+    const std::size_t size = GetUint(raw.data() + 4 * (i + 1), 4);
+    if (size > raw.size() - offset)
+    {
+      LERR("Malformed block [" << _id << "]\n");
+      return false;
+    }
+    _block.messages.emplace_back(offset, size);
+    offset += size;
+  }
+  return true;
+}
@@ -0,0 +1,199 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GZ_TRANSPORT_LOG_MESSAGEBLOCKS_HH_
+#define GZ_TRANSPORT_LOG_MESSAGEBLOCKS_HH_
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gz/transport/AdvertiseOptions.hh>
+#include <gz/transport/config.hh>
+
+#include "raii-sqlite3.hh"
+
+namespace gz
+{
+  namespace transport
+  {
+    namespace log
+    {
+      // Inline bracket to help doxygen filtering.
+      inline namespace GZ_TRANSPORT_VERSION_NAMESPACE {
+      //
+      /// \internal
+      /// \brief How a message is stored in messages.message in a log with
+      /// the 0.2.0 schema. See log/sql/0.2.0.sql.
+      enum class BlobEncoding : uint8_t
+      {
+        /// \brief The message follows.
+        RAW = 0,
+
+        /// \brief A reference to a message of message_blocks follows.
+        BLOCK = 1,
+
+        /// \brief The CRC-32C of the message and the message follow.
+        CHECKED_RAW = 2,
+
+        /// \brief A reference to a message of message_blocks and the
+        /// CRC-32C of the message follow.
+        CHECKED_BLOCK = 3
+      };
+
+      /// \internal
+      /// \brief Size of a reference to a message of a block: the encoding,
+      /// the id of the block and the index of the message.
+      const std::size_t kBlockReferenceSize = 13;
+
+      /// \internal
+      /// \brief Size of a reference to a message of a block followed by the
+      /// CRC-32C of the message.
+      const std::size_t kCheckedBlockReferenceSize = 17;
+
+      /// \internal
+      /// \brief A reference to a message of a block.
+      struct BlockReference
+      {
+        /// \brief Id of the block.
+        int64_t block = 0;
+
+        /// \brief Index of the message in the block.
+        uint32_t index = 0;
+
+        /// \brief Whether the reference has the CRC-32C of the message.
+        bool checked = false;
+
+        /// \brief CRC-32C of the message, if checked.
+        uint32_t crc = 0;
+      };
+
+      /// \internal
+      /// \brief Get the content of messages.message of a message stored as
+      /// it is.
+      /// \param[in] _data The message.
+      /// \param[in] _len Size of the message (bytes).
+      /// \param[in] _checked Whether to store the CRC-32C of the message.
+      /// \return The content of messages.message.
+      std::string EncodeRawMessage(const void *_data, const std::size_t _len,
+          const bool _checked);
+
+      /// \internal
+      /// \brief Get the size of what EncodeRawMessage() adds to a message.
+      /// \param[in] _checked Whether the CRC-32C of the message is stored.
+      /// \return The size (bytes).
+      std::size_t RawMessageOverhead(const bool _checked);
+
+      /// \internal
+      /// \brief Get the reference to a message of a block.
+      /// \param[in] _reference The reference.
+      /// \return The content of messages.message.
+      std::string EncodeBlockReference(const BlockReference &_reference);
+
+      /// \internal
+      /// \brief Read a reference to a message of a block.
+      /// \param[in] _blob The content of messages.message.
+      /// \param[in] _len Size of the content (bytes).
+      /// \param[out] _reference The reference.
+      /// \return False if the content isn't a reference to a block.
+      bool DecodeBlockReference(const void *_blob, const std::size_t _len,
+          BlockReference &_reference);
+
+      /// \internal
+      /// \brief Check whether the content of messages.message has the
+      /// CRC-32C of its message.
+      /// \param[in] _blob The content of messages.message.
+      /// \param[in] _len Size of the content (bytes).
+      /// \return True if the message is checked when it's decoded.
+      bool HasChecksum(const void *_blob, const std::size_t _len);
+
+      /// \internal
+      /// \brief Compress consecutive messages into a block.
+      /// \param[in] _codec The codec.
+      /// \param[in] _sizes Size of each message.
+      /// \param[in] _data The messages, one after the other.
+      /// \param[out] _block The compressed block.
+      /// \return True on success.
+      bool EncodeBlock(const Compression_t _codec,
+          const std::vector<uint32_t> &_sizes, const std::string &_data,
+          std::string &_block);
+
+      /// \internal
+      /// \brief Decode the content of messages.message in a log with the
+      /// 0.2.0 schema. The last decompressed blocks are kept, so reading the
+      /// messages in time order decompresses each block once.
+      class BlockCache
+      {
+        /// \brief Constructor.
+        /// \param[in] _db The database.
+        public: explicit BlockCache(
+            const std::shared_ptr<raii_sqlite3::Database> &_db);
+
+        /// \brief Destructor.
+        public: ~BlockCache();
+
+        /// \brief Get a message.
+        /// \param[in] _blob Content of messages.message.
+        /// \param[in] _len Size of _blob.
+        /// \param[out] _data The message. It's valid until the next call.
+        /// \param[out] _size Size of the message.
+        /// \return False if _blob is malformed, its block can't be read or
+        /// the message doesn't match its CRC-32C.
+        public: bool Decode(const void *_blob, const std::size_t _len,
+            const void *&_data, std::size_t &_size);
+
+        /// \brief A decompressed block.
+        private: struct Block
+        {
+          /// \brief Id of the block.
+          int64_t id;
+
+          /// \brief Decompressed content.
+          std::string data;
+
+          /// \brief Offset and size of each message in data.
+          std::vector<std::pair<std::size_t, std::size_t>> messages;
+        };
+
+        /// \brief Read and decompress a block.
+        /// \param[in] _id Id of the block.
+        /// \param[out] _block The block.
+        /// \return True on success.
+        private: bool Load(const int64_t _id, Block &_block);
+
+        /// \brief Maximum number of decompressed blocks kept.
+        private: static const std::size_t kMaxBlocks = 32;
+
+        /// \brief The database.
+        private: std::shared_ptr<raii_sqlite3::Database> db;
+
+        /// \brief Statement reading a block.
+        private: std::unique_ptr<raii_sqlite3::CachedStatement> statement;
+
+        /// \brief Decompressed blocks, the most recently used first.
+        private: std::list<Block> blocks;
+      };
+      }
+    }
+  }
+}
+
+#endif
@@ -29,6 +29,7 @@ TEST(Message, DefaultConstructor)
 {
   transport::log::Message msg;
   EXPECT_EQ(std::string(""), msg.Data());
+  EXPECT_TRUE(msg.DataView().empty());
   EXPECT_EQ(std::string(""), msg.Topic());
   EXPECT_EQ(std::string(""), msg.Type());
   EXPECT_EQ(0ns, msg.TimeReceived());
@@ -48,6 +49,8 @@ TEST(Message, DataConstructor)
       topic.c_str(), topic.size());
 
   EXPECT_EQ(data, msg.Data());
+  EXPECT_EQ(data, msg.DataView());
+  EXPECT_EQ(data.c_str(), msg.DataView().data());
   EXPECT_EQ(msgType, msg.Type());
   EXPECT_EQ(topic, msg.Topic());
   EXPECT_EQ(goldenTime, msg.TimeReceived());
@@ -18,6 +18,7 @@
 #include <sqlite3.h>
 
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "Console.hh"
@@ -36,9 +37,15 @@ MsgIterPrivate::MsgIterPrivate()
 //////////////////////////////////////////////////
 MsgIterPrivate::MsgIterPrivate(
     const std::shared_ptr<raii_sqlite3::Database> &_db,
-    const std::shared_ptr<std::vector<SqlStatement>> &_statements)
-  : db(_db), statements(_statements)
+    const std::shared_ptr<std::vector<SqlStatement>> &_statements,
+    const bool _encoded, const std::size_t _prefetchRows,
+    const std::size_t _prefetchBytes)
+  : db(_db), statements(_statements), prefetchRows(_prefetchRows),
+    prefetchBytes(_prefetchBytes)
 {
+  if (_encoded)
+    this->blocks.reset(new BlockCache(_db));
+
   PrepareNextStatement();
 }
 
@@ -59,9 +66,9 @@ bool MsgIterPrivate::PrepareNextStatement()
   // Get next statement in list
   const SqlStatement & query = this->statements->at(this->statementIndex);
 
-  // Compile the statement
-  std::unique_ptr<raii_sqlite3::Statement> nextStatement(
-      new raii_sqlite3::Statement(*(this->db), query.statement));
+  // Compile the statement, or reuse the one compiled by a previous query
+  std::unique_ptr<raii_sqlite3::CachedStatement> nextStatement(
+      new raii_sqlite3::CachedStatement(this->db, query.statement));
   if (!*nextStatement)
   {
     LERR("Failed to prepare query: "<< sqlite3_errmsg(
@@ -108,7 +115,15 @@ bool MsgIterPrivate::PrepareNextStatement()
 //////////////////////////////////////////////////
 void MsgIterPrivate::StepStatement()
 {
-  if (this->statement)
+  if (this->prefetchRows > 0)
+  {
+    this->StepPrefetched();
+    return;
+  }
+
+  // The next statement is stepped when one is out of data, so its first
+  // row is reached
+  while (this->statement)
   {
     // Get the results from the statement
     int returnCode = sqlite3_step(this->statement->Handle());
@@ -141,11 +156,22 @@ void MsgIterPrivate::StepStatement()
       const void *data = sqlite3_column_blob(this->statement->Handle(), 4);
       std::size_t numData = sqlite3_column_bytes(this->statement->Handle(), 4);
 
-      this->message.reset(new Message(
+      // Compressed messages are decompressed
+      if (this->blocks && !this->blocks->Decode(data, numData, data, numData))
+      {
+        data = nullptr;
+        numData = 0;
+      }
+
+      // The message is reused for every row
+      if (!this->message)
+        this->message.reset(new Message);
+      this->message->Reset(
             timeRecv,
             data, numData,
             reinterpret_cast<const char*>(type), numType,
-            reinterpret_cast<const char*>(topic), numTopic));
+            reinterpret_cast<const char*>(topic), numTopic);
+      return;
     }
     else
     {
@@ -161,6 +187,115 @@ void MsgIterPrivate::StepStatement()
   }
 }
 
+//////////////////////////////////////////////////
+void MsgIterPrivate::StepPrefetched()
+{
+  // The statement is kept until its rows have all been read, so this
+  // iterator doesn't compare equal to the end in the meantime
+  while (this->statement)
+  {
+    if (this->nextRow < this->rows.size())
+    {
+      const Row &row = this->rows[this->nextRow++];
+      if (!this->message)
+        this->message.reset(new Message);
+      this->message->Reset(row.timeRecv,
+          this->arena.data() + row.offset, row.size,
+          row.names->second.data(), row.names->second.size(),
+          row.names->first.data(), row.names->first.size());
+      return;
+    }
+
+    if (!this->statementDone)
+    {
+      this->Prefetch();
+      continue;
+    }
+
+    // Out of data
+    this->statement.reset();
+    this->statementDone = false;
+    ++this->statementIndex;
+    this->PrepareNextStatement();
+  }
+}
+
+//////////////////////////////////////////////////
+void MsgIterPrivate::Prefetch()
+{
+  this->rows.clear();
+  this->arena.clear();
+  this->nextRow = 0;
+
+  sqlite3_stmt *handle = this->statement->Handle();
+  while (this->rows.size() < this->prefetchRows &&
+      (this->prefetchBytes == 0 || this->rows.empty() ||
+       this->arena.size() < this->prefetchBytes))
+  {
+    const int returnCode = sqlite3_step(handle);
+    if (returnCode != SQLITE_ROW)
+    {
+      if (returnCode != SQLITE_DONE)
+      {
+        LERR("Failed to get message [" << returnCode << "]\n");
+      }
+      this->statementDone = true;
+      return;
+    }
+
+    // Same column order as in StepStatement()
+    const void *data = sqlite3_column_blob(handle, 4);
+    std::size_t numData = sqlite3_column_bytes(handle, 4);
+
+    // Compressed messages are decompressed
+    if (this->blocks && !this->blocks->Decode(data, numData, data, numData))
+    {
+      data = nullptr;
+      numData = 0;
+    }
+
+    Row row;
+    row.timeRecv = std::chrono::nanoseconds(
+        sqlite3_column_int64(handle, 1));
+    row.offset = this->arena.size();
+    row.size = numData;
+    row.names = this->InternNames();
+    if (numData > 0)
+      this->arena.append(static_cast<const char *>(data), numData);
+    this->rows.push_back(row);
+  }
+}
+
+//////////////////////////////////////////////////
+const MsgIterPrivate::Names *MsgIterPrivate::InternNames()
+{
+  sqlite3_stmt *handle = this->statement->Handle();
+  auto columnText = [handle](const int _column)
+  {
+    const unsigned char *text = sqlite3_column_text(handle, _column);
+    if (!text)
+      return std::string();
+    return std::string(reinterpret_cast<const char *>(text),
+        sqlite3_column_bytes(handle, _column));
+  };
+
+  // The statements of QueryOptions select the topic id, so the names are
+  // only copied the first time a topic is seen
+  if (sqlite3_column_count(handle) > 5)
+  {
+    const int64_t id = sqlite3_column_int64(handle, 5);
+    auto it = this->namesById.find(id);
+    if (it == this->namesById.end())
+    {
+      it = this->namesById.emplace(
+          id, Names(columnText(2), columnText(3))).first;
+    }
+    return &it->second;
+  }
+
+  return &*this->names.insert(Names(columnText(2), columnText(3))).first;
+}
+
 //////////////////////////////////////////////////
 MsgIter::MsgIter()
   : dataPtr(new MsgIterPrivate)
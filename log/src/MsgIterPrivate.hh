@@ -18,11 +18,18 @@
 #ifndef GZ_TRANSPORT_LOG_MSGITERPRIVATE_HH_
 #define GZ_TRANSPORT_LOG_MSGITERPRIVATE_HH_
 
+#include <chrono>
+#include <cstdint>
 #include <memory>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "gz/transport/log/Message.hh"
 #include "gz/transport/log/SqlStatement.hh"
+#include "MessageBlocks.hh"
 #include "raii-sqlite3.hh"
 
 using namespace gz::transport;
@@ -39,6 +46,25 @@ inline namespace GZ_TRANSPORT_VERSION_NAMESPACE
 {
   class MsgIterPrivate
   {
+    /// \brief Names of the topic and the message type of a message
+    public: using Names = std::pair<std::string, std::string>;
+
+    /// \brief A row fetched in advance, see Prefetch()
+    public: struct Row
+    {
+      /// \brief Time received
+      std::chrono::nanoseconds timeRecv;
+
+      /// \brief Offset of the message data in the arena
+      std::size_t offset;
+
+      /// \brief Size of the message data
+      std::size_t size;
+
+      /// \brief Interned names of the topic and the message type
+      const Names *names;
+    };
+
     /// \brief constructor
     public: MsgIterPrivate();
 
@@ -46,8 +72,16 @@ inline namespace GZ_TRANSPORT_VERSION_NAMESPACE
     /// \param[in] _db Shared reference to a database
     /// \param[in] _statements A set of SQL statements that this message will
     /// iterate through
+    /// \param[in] _encoded true if the messages use the encoding of the 0.2.0
+    /// schema
+    /// \param[in] _prefetchRows Number of rows fetched at once, 0 to fetch
+    /// them one by one, see Batch::SetPrefetch()
+    /// \param[in] _prefetchBytes Size of the data of the rows fetched at once
+    /// after which no more rows are fetched, 0 for no limit
     public: MsgIterPrivate(const std::shared_ptr<raii_sqlite3::Database> &_db,
-        const std::shared_ptr<std::vector<SqlStatement>> &_statements);
+        const std::shared_ptr<std::vector<SqlStatement>> &_statements,
+        bool _encoded = false, std::size_t _prefetchRows = 0,
+        std::size_t _prefetchBytes = 0);
 
     /// \brief destructor
     public: ~MsgIterPrivate();
@@ -59,8 +93,20 @@ inline namespace GZ_TRANSPORT_VERSION_NAMESPACE
     /// \return true if the statement was sucessfully prepared
     public: bool PrepareNextStatement();
 
+    /// \brief Points the message to the next row fetched in advance,
+    /// fetching more rows when they have all been read
+    public: void StepPrefetched();
+
+    /// \brief Fetches the next rows of the statement into the arena
+    public: void Prefetch();
+
+    /// \brief Gets the interned names of the topic and the message type of
+    /// the current row of the statement
+    /// \return The names, valid as long as this iterator
+    public: const Names *InternNames();
+
     /// \brief a statement that is being stepped
-    public: std::unique_ptr<raii_sqlite3::Statement> statement;
+    public: std::unique_ptr<raii_sqlite3::CachedStatement> statement;
 
     /// \brief which statement is the msg iterator iterating on
     public: std::size_t statementIndex = 0;
@@ -73,6 +119,36 @@ inline namespace GZ_TRANSPORT_VERSION_NAMESPACE
 
     /// \brief the message this iterator is at
     public: std::unique_ptr<Message> message;
+
+    /// \brief decodes the messages of a log with the 0.2.0 schema, or
+    /// nullptr
+    public: std::unique_ptr<BlockCache> blocks;
+
+    /// \brief Number of rows fetched at once, 0 to fetch them one by one
+    public: std::size_t prefetchRows = 0;
+
+    /// \brief Size of the data of the rows fetched at once after which no
+    /// more rows are fetched, 0 for no limit
+    public: std::size_t prefetchBytes = 0;
+
+    /// \brief Rows fetched in advance
+    public: std::vector<Row> rows;
+
+    /// \brief Index of the next row to read in rows
+    public: std::size_t nextRow = 0;
+
+    /// \brief The data of the rows, reused for every fetch so it doesn't
+    /// allocate once it has grown to the size of a fetch
+    public: std::string arena;
+
+    /// \brief true if the statement has no more rows to fetch
+    public: bool statementDone = false;
+
+    /// \brief Interned names by topic id (the ids of the Descriptor)
+    public: std::unordered_map<int64_t, Names> namesById;
+
+    /// \brief Interned names of statements without the topic id column
+    public: std::set<Names> names;
   };
 }
 }
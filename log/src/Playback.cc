@@ -17,19 +17,33 @@
 
 #include <sqlite3.h>
 
+#include <algorithm>
 #include <atomic>
+#include <cmath>
 #include <chrono>
 #include <condition_variable>
+#include <deque>
 #include <functional>
+#include <limits>
+#include <map>
 #include <memory>
 #include <mutex>
+#include <regex>
+#include <set>
+#include <string>
+#include <string_view>
 #include <thread>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include <gz/transport/Node.hh>
+#include <gz/transport/NodeOptions.hh>
+#include <gz/transport/TopicUtils.hh>
 #include <gz/transport/log/Log.hh>
 #include <gz/transport/log/Playback.hh>
+#include <gz/transport/log/ShardSet.hh>
 #include "Console.hh"
 #include "build_config.hh"
 #include "raii-sqlite3.hh"
@@ -43,25 +57,639 @@ using namespace gz::transport::log;
 // See: https://www.sqlite.org/threadsafe.html
 static const bool kSqlite3Threadsafe = (sqlite3_threadsafe() != 0);
 
+/// \brief Log files played together, i.e. the shards of a recording
+using LogFiles = std::vector<std::shared_ptr<Log>>;
+
+//////////////////////////////////////////////////
+/// \brief Check whether all the log files were opened.
+/// \param[in] _logFiles The log files
+/// \return True if there is at least one log file and all of them are valid.
+static bool AllValid(const LogFiles &_logFiles)
+{
+  if (_logFiles.empty())
+    return false;
+
+  for (const auto &logFile : _logFiles)
+  {
+    if (!logFile->Valid())
+      return false;
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+/// \brief Get the topics and message types of all the log files.
+/// \param[in] _logFiles The log files, which must be valid
+/// \return Map of the topic names to the message types
+static Descriptor::NameToMap LogTopics(const LogFiles &_logFiles)
+{
+  Descriptor::NameToMap allTopics;
+  for (const auto &logFile : _logFiles)
+  {
+    for (const auto &entry : logFile->Descriptor()->TopicsToMsgTypesToId())
+      allTopics[entry.first].insert(entry.second.begin(), entry.second.end());
+  }
+  return allTopics;
+}
+
+//////////////////////////////////////////////////
+/// \brief Messages of several log files, merged in the order they were
+/// received with a k-way merge: the next message of every log file is kept
+/// in a min-heap, so a message costs O(log k) for k log files. With a
+/// single log file, it's just a Batch.
+class MergedBatch
+{
+  /// \brief Default constructor, without messages
+  public: MergedBatch() = default;
+
+  /// \brief Query the messages of some log files.
+  /// \param[in] _logFiles The log files
+  /// \param[in] _options The messages to query from every log file
+  public: MergedBatch(const LogFiles &_logFiles, const QueryOptions &_options)
+  {
+    this->batches.reserve(_logFiles.size());
+    for (const auto &logFile : _logFiles)
+      this->batches.push_back(logFile->QueryMessages(_options));
+
+    for (auto &batch : this->batches)
+    {
+      this->iters.push_back(batch.begin());
+      this->ends.push_back(batch.end());
+    }
+
+    this->heap.reserve(this->iters.size());
+    for (std::size_t i = 0; i < this->iters.size(); ++i)
+      this->Push(i);
+  }
+
+  /// \brief Whether all the messages were visited.
+  /// \return True if there is no current message.
+  public: bool Done() const
+  {
+    return this->heap.empty();
+  }
+
+  /// \brief Get the current message.
+  /// \pre Done() is false and the messages are not preloaded
+  /// \return The oldest message not yet visited
+  public: const Message &operator*() const
+  {
+    return *this->iters[this->heap.front().second];
+  }
+
+  /// \brief Get the current message.
+  /// \pre Done() is false and the messages are not preloaded
+  /// \return The oldest message not yet visited
+  public: const Message *operator->() const
+  {
+    return &**this;
+  }
+
+  /// \brief Get the time of the current message.
+  /// \return Time the current message was received, or the time of the
+  /// last message when all of them were visited.
+  public: std::chrono::nanoseconds TimeReceived() const
+  {
+    return this->Done() ? this->lastTime : (*this)->TimeReceived();
+  }
+
+  /// \brief Move to the next message.
+  /// \pre Done() is false
+  public: void Next()
+  {
+    this->lastTime = this->heap.front().first;
+    const std::size_t current = this->heap.front().second;
+    std::pop_heap(this->heap.begin(), this->heap.end(), std::greater<>());
+    this->heap.pop_back();
+    ++this->iters[current];
+    this->Push(current);
+  }
+
+  /// \brief Add the next message of a log file to the heap.
+  /// \param[in] _index Index of the log file
+  private: void Push(const std::size_t _index)
+  {
+    if (this->iters[_index] == this->ends[_index])
+      return;
+
+    // On a tie, the log file listed first wins.
+    this->heap.emplace_back(this->iters[_index]->TimeReceived(), _index);
+    std::push_heap(this->heap.begin(), this->heap.end(), std::greater<>());
+  }
+
+  /// \brief The messages of every log file
+  private: std::vector<Batch> batches;
+
+  /// \brief Next message of every log file
+  private: std::vector<Batch::iterator> iters;
+
+  /// \brief End of the messages of every log file
+  private: std::vector<Batch::iterator> ends;
+
+  /// \brief Min-heap of the time of the next message of every log file
+  /// and the index of the log file. The current message is at the front.
+  private: std::vector<std::pair<std::chrono::nanoseconds, std::size_t>>
+    heap;
+
+  /// \brief Time of the last visited message
+  private: std::chrono::nanoseconds lastTime{0};
+};
+
+//////////////////////////////////////////////////
+/// \brief A message read ahead of its publication
+struct PrefetchedMessage
+{
+  /// \brief Time the message was received
+  std::chrono::nanoseconds time;
+
+  /// \brief Name of the topic
+  std::string topic;
+
+  /// \brief Name of the message type
+  std::string type;
+
+  /// \brief Serialized message
+  std::string data;
+};
+
+//////////////////////////////////////////////////
+/// \brief Messages loaded in memory by Playback::Preload(), in the order
+/// they were received. Their data are stored one after the other in a
+/// single arena and their names are interned.
+class PreloadedMessages
+{
+  /// \brief A message
+  public: struct Entry
+  {
+    /// \brief Time the message was received
+    std::chrono::nanoseconds time;
+
+    /// \brief Offset of the data in the arena
+    std::size_t offset;
+
+    /// \brief Size of the data
+    std::size_t size;
+
+    /// \brief Index of the topic and type in names
+    std::size_t names;
+  };
+
+  /// \brief Load the messages.
+  /// \param[in] _batch The messages
+  /// \param[in] _topics The topics of the messages
+  public: PreloadedMessages(MergedBatch &&_batch,
+      const std::unordered_set<std::string> &_topics)
+    : topics(_topics)
+  {
+    std::unordered_map<std::string, std::size_t> index;
+    for (; !_batch.Done(); _batch.Next())
+    {
+      const std::string key = _batch->Topic() + '\0' + _batch->Type();
+      auto it = index.find(key);
+      if (it == index.end())
+      {
+        it = index.emplace(key, this->names.size()).first;
+        this->names.emplace_back(_batch->Topic(), _batch->Type());
+      }
+
+      const std::string_view data = _batch->DataView();
+      this->entries.push_back(
+        {_batch.TimeReceived(), this->arena.size(), data.size(), it->second});
+      this->arena.append(data.data(), data.size());
+    }
+    this->arena.shrink_to_fit();
+    this->entries.shrink_to_fit();
+  }
+
+  /// \brief Get the index of the first message received at or after a
+  /// time.
+  /// \param[in] _time The time
+  /// \return The index, or the number of messages if there is none.
+  public: std::size_t Find(const std::chrono::nanoseconds &_time) const
+  {
+    return static_cast<std::size_t>(std::lower_bound(
+      this->entries.begin(), this->entries.end(), _time,
+      [](const Entry &_entry, const std::chrono::nanoseconds &_t)
+      {
+        return _entry.time < _t;
+      }) - this->entries.begin());
+  }
+
+  /// \brief Copy a message.
+  /// \param[in] _index Index of the message
+  /// \return The message
+  public: PrefetchedMessage Message(const std::size_t _index) const;
+
+  /// \brief The messages
+  public: std::vector<Entry> entries;
+
+  /// \brief Topic and type of the messages
+  public: std::vector<std::pair<std::string, std::string>> names;
+
+  /// \brief Data of the messages, one after the other
+  public: std::string arena;
+
+  /// \brief Topics of the messages
+  public: const std::unordered_set<std::string> topics;
+};
+
+//////////////////////////////////////////////////
+PrefetchedMessage PreloadedMessages::Message(const std::size_t _index) const
+{
+  const Entry &entry = this->entries[_index];
+  const auto &name = this->names[entry.names];
+  return PrefetchedMessage{entry.time, name.first, name.second,
+    this->arena.substr(entry.offset, entry.size)};
+}
+
+//////////////////////////////////////////////////
+/// \brief Reads the messages of a MergedBatch ahead in its own thread, so
+/// the playback thread doesn't wait for SQLite between two publications.
+/// The messages read ahead are bounded by kPrefetchMessages and
+/// kPrefetchBytes. With PreloadedMessages, nothing is read: the messages
+/// are taken from memory.
+class PrefetchedBatch
+{
+  /// \brief Maximum number of messages read ahead
+  public: static constexpr std::size_t kPrefetchMessages = 1024;
+
+  /// \brief Maximum size (in bytes) of the messages read ahead. A larger
+  /// message is still read, alone.
+  public: static constexpr std::size_t kPrefetchBytes = 64u << 20;
+
+  /// \brief Start reading the messages.
+  /// \param[in] _batch The messages
+  public: explicit PrefetchedBatch(MergedBatch &&_batch)
+  {
+    this->Reset(std::move(_batch));
+  }
+
+  /// \brief Take the messages from memory.
+  /// \param[in] _preloaded The messages
+  public: explicit PrefetchedBatch(
+      const std::shared_ptr<const PreloadedMessages> &_preloaded)
+    : preloaded(_preloaded)
+  {
+  }
+
+  /// \brief Destructor. Stops reading.
+  public: ~PrefetchedBatch()
+  {
+    this->StopReading();
+  }
+
+  /// \brief Replace the messages, the ones read ahead are discarded.
+  /// \param[in] _batch The new messages
+  public: void Reset(MergedBatch &&_batch)
+  {
+    this->StopReading();
+    this->preloaded.reset();
+
+    {
+      std::lock_guard<std::mutex> lock(this->mutex);
+      this->messages.clear();
+      this->bytes = 0;
+      this->finished = false;
+      this->stopReading = false;
+      this->lastTime = std::chrono::nanoseconds::zero();
+      this->batch = std::move(_batch);
+    }
+    this->reader = std::thread(&PrefetchedBatch::Read, this);
+  }
+
+  /// \brief Move to the first preloaded message received at or after a
+  /// time.
+  /// \pre The messages are preloaded
+  /// \param[in] _time The time
+  public: void Reset(const std::chrono::nanoseconds &_time)
+  {
+    this->next = this->preloaded->Find(_time);
+  }
+
+  /// \brief Get the preloaded messages.
+  /// \return The messages, or nullptr if they are read from the log files.
+  public: const std::shared_ptr<const PreloadedMessages> &Preloaded() const
+  {
+    return this->preloaded;
+  }
+
+  /// \brief Whether all the messages were visited. Waits until the next
+  /// message is read.
+  /// \return True if there is no current message.
+  public: bool Done()
+  {
+    if (this->preloaded)
+      return this->next >= this->preloaded->entries.size();
+
+    std::unique_lock<std::mutex> lock(this->mutex);
+    this->WaitForMessage(lock);
+    return this->messages.empty();
+  }
+
+  /// \brief Get the current message.
+  /// \pre Done() is false and the messages are not preloaded
+  /// \return The oldest message not yet visited
+  public: const PrefetchedMessage &Front()
+  {
+    std::unique_lock<std::mutex> lock(this->mutex);
+    this->WaitForMessage(lock);
+    return this->messages.front();
+  }
+
+  /// \brief Get the time of the current message. Waits until the next
+  /// message is read.
+  /// \return Time the current message was received, or the time of the
+  /// last message when all of them were visited.
+  public: std::chrono::nanoseconds TimeReceived()
+  {
+    if (this->preloaded)
+    {
+      if (this->next < this->preloaded->entries.size())
+        return this->preloaded->entries[this->next].time;
+      return this->next > 0 ?
+        this->preloaded->entries[this->next - 1].time : this->lastTime;
+    }
+
+    std::unique_lock<std::mutex> lock(this->mutex);
+    this->WaitForMessage(lock);
+    return this->messages.empty() ? this->lastTime :
+      this->messages.front().time;
+  }
+
+  /// \brief Move to the next message.
+  /// \pre Done() is false
+  public: void Next()
+  {
+    if (this->preloaded)
+    {
+      ++this->next;
+      return;
+    }
+
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->lastTime = this->messages.front().time;
+    this->bytes -= this->messages.front().data.size();
+    this->messages.pop_front();
+    this->condVar.notify_all();
+  }
+
+  /// \brief Take the current message and move to the next one.
+  /// \pre Done() is false
+  /// \return The oldest message not yet visited
+  public: PrefetchedMessage Pop()
+  {
+    if (this->preloaded)
+      return this->preloaded->Message(this->next++);
+
+    std::lock_guard<std::mutex> lock(this->mutex);
+    PrefetchedMessage message = std::move(this->messages.front());
+    this->lastTime = message.time;
+    this->bytes -= message.data.size();
+    this->messages.pop_front();
+    this->condVar.notify_all();
+    return message;
+  }
+
+  /// \brief Wait until a message was read or all of them were.
+  /// \param[in] _lock Lock of mutex
+  private: void WaitForMessage(std::unique_lock<std::mutex> &_lock)
+  {
+    this->condVar.wait(_lock, [this]
+      {
+        return !this->messages.empty() || this->finished;
+      });
+  }
+
+  /// \brief Worker thread function that reads the messages ahead.
+  private: void Read()
+  {
+    while (true)
+    {
+      {
+        std::unique_lock<std::mutex> lock(this->mutex);
+        this->condVar.wait(lock, [this]
+          {
+            return this->stopReading ||
+              (this->messages.size() < kPrefetchMessages &&
+               (this->messages.empty() || this->bytes < kPrefetchBytes));
+          });
+        if (this->stopReading)
+          return;
+      }
+
+      // Only this thread uses the batch while reading, without holding the
+      // lock, so SQLite doesn't delay the playback thread.
+      if (this->batch.Done())
+        break;
+
+      // This is the only copy of the message data: SQLite reuses the blob
+      // when the batch moves on, and PublishRaw() takes it by reference.
+      PrefetchedMessage message{this->batch->TimeReceived(),
+        this->batch->Topic(), this->batch->Type(),
+        std::string(this->batch->DataView())};
+      this->batch.Next();
+
+      std::lock_guard<std::mutex> lock(this->mutex);
+      this->bytes += message.data.size();
+      this->messages.push_back(std::move(message));
+      this->condVar.notify_all();
+    }
+
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->finished = true;
+    this->condVar.notify_all();
+  }
+
+  /// \brief Stop the reader thread.
+  private: void StopReading()
+  {
+    {
+      std::lock_guard<std::mutex> lock(this->mutex);
+      this->stopReading = true;
+      this->condVar.notify_all();
+    }
+    if (this->reader.joinable())
+      this->reader.join();
+  }
+
+  /// \brief The messages not yet read. Only the reader thread uses it while
+  /// it runs.
+  private: MergedBatch batch;
+
+  /// \brief The messages loaded in memory, or nullptr
+  private: std::shared_ptr<const PreloadedMessages> preloaded;
+
+  /// \brief Index of the next preloaded message
+  private: std::size_t next{0};
+
+  /// \brief The messages read ahead
+  private: std::deque<PrefetchedMessage> messages;
+
+  /// \brief Size of the messages read ahead
+  private: std::size_t bytes{0};
+
+  /// \brief True when all the messages were read
+  private: bool finished{false};
+
+  /// \brief True when the reader thread must exit
+  private: bool stopReading{false};
+
+  /// \brief Time of the last visited message
+  private: std::chrono::nanoseconds lastTime{0};
+
+  /// \brief Mutex to synchronize access to the members but batch
+  private: std::mutex mutex;
+
+  /// \brief Condition variable signaling changes of the messages
+  private: std::condition_variable condVar;
+
+  /// \brief Thread reading the messages
+  private: std::thread reader;
+};
+
+//////////////////////////////////////////////////
+/// \brief Publishes the messages of a topic from its own thread, so that
+/// publishing a large message doesn't delay the messages of the other
+/// topics. The playback thread still decides when each message is due.
+class PublishLane
+{
+  /// \brief Start the thread of the lane.
+  /// \param[in] _publishers Publishers of the topic by message type. They
+  /// must outlive the lane.
+  public: explicit PublishLane(
+      std::unordered_map<std::string, Node::Publisher> &_publishers)
+    : publishers(_publishers),
+      thread(&PublishLane::Run, this)
+  {
+  }
+
+  /// \brief Destructor. Discards the messages not yet published.
+  public: ~PublishLane()
+  {
+    {
+      std::lock_guard<std::mutex> lock(this->mutex);
+      this->messages.clear();
+      this->stop = true;
+      this->condVar.notify_all();
+    }
+    this->thread.join();
+  }
+
+  /// \brief Queue a message that is due.
+  /// \param[in] _message The message
+  public: void Push(PrefetchedMessage &&_message)
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->messages.push_back(std::move(_message));
+    this->condVar.notify_all();
+  }
+
+  /// \brief Discard the messages not yet published, e.g. after a seek.
+  public: void Clear()
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->messages.clear();
+  }
+
+  /// \brief Wait until all the queued messages are published.
+  public: void Drain()
+  {
+    std::unique_lock<std::mutex> lock(this->mutex);
+    this->condVar.wait(lock, [this]
+      {
+        return this->messages.empty() && !this->publishing;
+      });
+  }
+
+  /// \brief Worker thread function that publishes the messages.
+  private: void Run()
+  {
+    std::unique_lock<std::mutex> lock(this->mutex);
+    while (true)
+    {
+      this->condVar.wait(lock, [this]
+        {
+          return this->stop || !this->messages.empty();
+        });
+      if (this->stop)
+        return;
+
+      PrefetchedMessage message = std::move(this->messages.front());
+      this->messages.pop_front();
+      this->publishing = true;
+      lock.unlock();
+
+      this->publishers[message.type].PublishRaw(message.data, message.type);
+
+      lock.lock();
+      this->publishing = false;
+      this->condVar.notify_all();
+    }
+  }
+
+  /// \brief Publishers of the topic by message type
+  private: std::unordered_map<std::string, Node::Publisher> &publishers;
+
+  /// \brief Messages waiting to be published
+  private: std::deque<PrefetchedMessage> messages;
+
+  /// \brief True while a message is being published
+  private: bool publishing{false};
+
+  /// \brief True when the thread must exit
+  private: bool stop{false};
+
+  /// \brief Mutex to synchronize access to the members
+  private: std::mutex mutex;
+
+  /// \brief Condition variable signaling changes of the messages
+  private: std::condition_variable condVar;
+
+  /// \brief Thread publishing the messages
+  private: std::thread thread;
+};
+
 //////////////////////////////////////////////////
 /// \brief Private implementation of Playback
 class gz::transport::log::Playback::Implementation
 {
-  /// \brief Constructor. Creates and initializes the log file
-  /// \param[in] _file The full path of the file to open
+  /// \brief Constructor. Creates and initializes the log files, the
+  /// shard sets are replaced by their shards
+  /// \param[in] _paths The full paths of the files to open
   public: Implementation(
-    const std::string &_file, const NodeOptions &_nodeOptions)
-    : logFile(std::make_shared<Log>()),
-      addTopicWasUsed(false),
+    const std::vector<std::string> &_paths, const NodeOptions &_nodeOptions)
+    : addTopicWasUsed(false),
       nodeOptions(_nodeOptions)
   {
-    if (!this->logFile->Open(_file, std::ios_base::in))
+    std::vector<std::string> files;
+    for (const std::string &path : _paths)
     {
-      LERR("Could not open file [" << _file << "]\n");
+      std::vector<std::string> shards;
+      if (!IsShardSet(path))
+        shards.push_back(path);
+      else if (!ReadShardSet(path, shards))
+        return;
+
+      // A log file listed twice would play its messages twice.
+      for (const std::string &shard : shards)
+      {
+        if (std::find(files.begin(), files.end(), shard) == files.end())
+          files.push_back(shard);
+      }
     }
-    else
+
+    for (const std::string &file : files)
     {
-      LDBG("Playback opened file [" << _file << "]\n");
+      auto logFile = std::make_shared<Log>();
+      if (!logFile->Open(file, std::ios_base::in))
+      {
+        LERR("Could not open file [" << file << "]\n");
+      }
+      else
+      {
+        LDBG("Playback opened file [" << file << "]\n");
+      }
+      this->logFiles.push_back(logFile);
     }
   }
 
@@ -71,9 +699,7 @@ class gz::transport::log::Playback::Implementation
   {
     if (!this->addTopicWasUsed)
     {
-      const Descriptor *desc = this->logFile->Descriptor();
-      const Descriptor::NameToMap &allTopics = desc->TopicsToMsgTypesToId();
-      for (const auto &entry : allTopics)
+      for (const auto &entry : LogTopics(this->logFiles))
         this->topicNames.insert(entry.first);
 
       // Topics have been set, so we change this flag to true
@@ -81,8 +707,23 @@ class gz::transport::log::Playback::Implementation
     }
   }
 
-  /// \brief log file to play from
-  public: std::shared_ptr<Log> logFile;
+  /// \brief Get the topics to play back.
+  /// \return The topics added, or all the topics if none was.
+  std::unordered_set<std::string> SelectedTopics() const
+  {
+    if (this->addTopicWasUsed)
+      return this->topicNames;
+
+    LDBG("No topics added, defaulting to all topics\n");
+    std::unordered_set<std::string> topics;
+    for (const auto &entry : LogTopics(this->logFiles))
+      topics.insert(entry.first);
+    return topics;
+  }
+
+  /// \brief log files to play from, several for a shard set or when
+  /// several logs are played together
+  public: LogFiles logFiles;
 
   /// \brief topics that are being played back
   public: std::unordered_set<std::string> topicNames;
@@ -97,6 +738,10 @@ class gz::transport::log::Playback::Implementation
 
   /// \brief The node options.
   public: NodeOptions nodeOptions;
+
+  /// \brief Messages loaded by Preload(), or nullptr. They are shared with
+  /// the handles playing them.
+  public: std::shared_ptr<const PreloadedMessages> preloaded;
 };
 
 //////////////////////////////////////////////////
@@ -104,19 +749,22 @@ class gz::transport::log::Playback::Implementation
 class PlaybackHandle::Implementation
 {
   /// \brief Constructor
-  /// \param[in] _logFile A reference to the Log instance
+  /// \param[in] _logFiles The Log instances, whose messages are merged
   /// \param[in] _topics A set of all topics to publish
   /// \param[in] _waitAfterAdvertising How long to wait after advertising the
   /// topics
   /// \param[in] _msgWaiting True to wait between publication of
   /// messages based on the message timestamps. False to playback
   /// messages as fast as possible. Default value is true.
+  /// \param[in] _preloaded Messages of _topics loaded in memory, or nullptr
+  /// to read them from the log files
   public: Implementation(
-      const std::shared_ptr<Log> &_logFile,
+      const LogFiles &_logFiles,
       const std::unordered_set<std::string> &_topics,
       const std::chrono::nanoseconds &_waitAfterAdvertising,
       const NodeOptions &_nodeOptions,
-      bool _msgWaiting);
+      bool _msgWaiting,
+      const std::shared_ptr<const PreloadedMessages> &_preloaded);
 
   /// \brief Look through the types of data that _topic can publish and create
   /// a publisher for each type.
@@ -164,17 +812,84 @@ class PlaybackHandle::Implementation
   /// \brief Wait until playback has finished playing
   public: void WaitUntilFinished();
 
+  /// \brief Set the speed of the playback.
+  /// \param[in] _rate Factor of the speed of the recording
+  /// \return True if the rate is valid.
+  /// \sa PlaybackHandle::SetRate()
+  public: bool SetRate(const double _rate);
+
+  /// \brief Publish every message only after a subscriber acknowledged the
+  /// previous one.
+  /// \param[in] _ackTopic Topic of the acknowledgments, empty to disable
+  /// \param[in] _timeout Maximum time to wait for an acknowledgment
+  /// \return True if the topic could be subscribed to.
+  /// \sa PlaybackHandle::SetLockstep()
+  public: bool SetLockstep(const std::string &_ackTopic,
+                           const std::chrono::nanoseconds &_timeout);
+
+  /// \brief Publish a message that is due, from its topic's lane in
+  /// parallel mode. batchMutex must be locked.
+  /// \param[in] _message The message
+  public: void Publish(PrefetchedMessage &&_message);
+
+  /// \brief Wait until the lanes published all their messages.
+  public: void DrainLanes();
+
+  /// \brief Set the topics whose state is restored by Seek().
+  /// \param[in] _topics Pattern matching the names of the topics
+  /// \return Number of played back topics matching the pattern.
+  /// \sa PlaybackHandle::SetStateTopics()
+  public: std::size_t SetStateTopics(const std::regex &_topics);
+
+  /// \brief Publish the last message of each state topic received before a
+  /// time. batchMutex must be locked.
+  /// \param[in] _time Time of the recording
+  public: void RepublishState(const std::chrono::nanoseconds &_time);
+
+  /// \brief Convert a duration of the recording to the duration of its
+  /// playback at the current rate.
+  /// \param[in] _logDuration Duration in the playback frame
+  /// \return Duration in the realtime frame
+  public: std::chrono::nanoseconds RealDuration(
+      const std::chrono::nanoseconds &_logDuration) const;
+
+  /// \brief Wait for the acknowledgment of the last published message.
+  public: void WaitForAck();
+
+  /// \brief Start over from the first message, see SetLoop().
+  /// \return False if there are no messages.
+  public: bool Rewind();
+
   /// \brief node used to create publishers
   /// \note This member needs to come before the publishers member so that they
   /// get destructed in the correct order
   public: std::unique_ptr<gz::transport::Node> node;
 
+  /// \brief Nodes publishing the topics recorded with their fully qualified
+  /// name (see log::Recorder::AddPartition()), by name of partition
+  /// \note This member needs to come before the publishers member so that they
+  /// get destructed in the correct order
+  public: std::map<std::string, std::unique_ptr<gz::transport::Node>>
+          partitionNodes;
+
   /// \brief Map whose key is a topic name and value is another map whose
   /// key is a message type name and value is a publisher
   public: std::unordered_map<std::string,
           std::unordered_map<std::string,
             gz::transport::Node::Publisher>> publishers;
 
+  /// \brief Publishing lane of each topic in parallel mode, guarded by
+  /// batchMutex
+  /// \note This member needs to come after the publishers member so that the
+  /// lanes stop before the publishers are destructed
+  public: std::unordered_map<std::string, std::unique_ptr<PublishLane>> lanes;
+
+  /// \brief True to publish every topic from its own lane
+  public: std::atomic_bool parallelPublishing{false};
+
+  /// \brief True to start over after the last message
+  public: std::atomic_bool loop{false};
+
   /// \brief a mutex to use when waiting for playback to finish
   public: std::mutex waitMutex;
 
@@ -224,8 +939,11 @@ class PlaybackHandle::Implementation
   /// \brief thread running playback
   public: std::thread playbackThread;
 
-  /// \brief log file to play from
-  public: std::shared_ptr<Log> logFile;
+  /// \brief log files to play from
+  public: LogFiles logFiles;
+
+  /// \brief Topics and message types of the log files
+  public: const Descriptor::NameToMap allTopics;
 
   /// \brief List of topics currently tracked
   public: const std::unordered_set<std::string> trackedTopics;
@@ -233,14 +951,15 @@ class PlaybackHandle::Implementation
   /// \brief mutex for thread safety with log file
   public: std::mutex logFileMutex;
 
-  // \brief Set of messages to be played-back
-  public: Batch batch;
+  // \brief Set of messages to be played-back, iterated in order and read
+  // ahead by another thread
+  public: PrefetchedBatch batch;
 
   // \brief Mutex to operate the batch variable in a thread-safe way
   public: std::mutex batchMutex;
 
-  // \brief Iterator to loop over the messages found in batch
-  public: Batch::iterator messageIter;
+  /// \brief Topics whose state is restored by Seek(), guarded by batchMutex
+  public: std::set<std::string> stateTopics;
 
   // \brief The wall clock time of the first message in batch
   public: const std::chrono::nanoseconds firstMessageTime;
@@ -249,11 +968,42 @@ class PlaybackHandle::Implementation
   /// messages based on the message timestamps. False to playback
   /// messages as fast as possible.
   public: bool msgWaiting = true;
+
+  /// \brief Factor of the speed of the recording, infinity to publish as
+  /// fast as possible
+  public: std::atomic<double> rate{1.0};
+
+  /// \brief Topic of the acknowledgments in lockstep mode, empty if the
+  /// playback isn't in lockstep
+  public: std::string ackTopic;
+
+  /// \brief Maximum time to wait for an acknowledgment
+  public: std::chrono::nanoseconds ackTimeout{std::chrono::seconds(1)};
+
+  /// \brief Number of acknowledgments received
+  public: uint64_t acks{0};
+
+  /// \brief Number of messages published in lockstep mode
+  public: uint64_t expectedAcks{0};
+
+  /// \brief Mutex to synchronize access to the lockstep members
+  public: std::mutex ackMutex;
+
+  /// \brief Condition variable signaling the acknowledgments
+  public: std::condition_variable ackConditionVariable;
 };
 
 //////////////////////////////////////////////////
 Playback::Playback(const std::string &_file, const NodeOptions &_nodeOptions)
-  : dataPtr(new Implementation(_file, _nodeOptions))
+  : dataPtr(new Implementation({_file}, _nodeOptions))
+{
+  // Do nothing
+}
+
+//////////////////////////////////////////////////
+Playback::Playback(const std::vector<std::string> &_files,
+                   const NodeOptions &_nodeOptions)
+  : dataPtr(new Implementation(_files, _nodeOptions))
 {
   // Do nothing
 }
@@ -276,7 +1026,7 @@ PlaybackHandlePtr Playback::Start(
     const std::chrono::nanoseconds &_waitAfterAdvertising,
     bool _msgWaiting) const
 {
-  if (!this->dataPtr->logFile->Valid())
+  if (!AllValid(this->dataPtr->logFiles))
   {
     LERR("Could not start: Failed to open log file\n");
     return nullptr;
@@ -295,25 +1045,16 @@ PlaybackHandlePtr Playback::Start(
     }
   }
 
-  std::unordered_set<std::string> topics;
-  if (!this->dataPtr->addTopicWasUsed)
-  {
-    LDBG("No topics added, defaulting to all topics\n");
-    const Descriptor *desc = this->dataPtr->logFile->Descriptor();
-    const Descriptor::NameToMap &allTopics = desc->TopicsToMsgTypesToId();
-    for (const auto &entry : allTopics)
-      topics.insert(entry.first);
-  }
-  else
-  {
-    topics = this->dataPtr->topicNames;
-  }
+  // The preloaded messages are played back with their topics
+  const auto &preloaded = this->dataPtr->preloaded;
+  const std::unordered_set<std::string> topics = preloaded ?
+    preloaded->topics : this->dataPtr->SelectedTopics();
 
   PlaybackHandlePtr newHandle(
         new PlaybackHandle(
           std::make_unique<PlaybackHandle::Implementation>(
-            this->dataPtr->logFile, topics, _waitAfterAdvertising,
-            this->dataPtr->nodeOptions, _msgWaiting)));
+            this->dataPtr->logFiles, topics, _waitAfterAdvertising,
+            this->dataPtr->nodeOptions, _msgWaiting, preloaded)));
 
   // We only need to store this if sqlite3 was not compiled in threadsafe mode.
   if (!kSqlite3Threadsafe)
@@ -325,7 +1066,7 @@ PlaybackHandlePtr Playback::Start(
 //////////////////////////////////////////////////
 bool Playback::Valid() const
 {
-  return this->dataPtr->logFile->Valid();
+  return AllValid(this->dataPtr->logFiles);
 }
 
 //////////////////////////////////////////////////
@@ -335,15 +1076,15 @@ bool Playback::AddTopic(const std::string &_topic)
   // calling this function, the user has expressed an intention to explicitly
   // specify which topics to publish.
   this->dataPtr->addTopicWasUsed = true;
+  this->dataPtr->preloaded.reset();
 
-  if (!this->dataPtr->logFile->Valid())
+  if (!AllValid(this->dataPtr->logFiles))
   {
     LERR("Failed to open log file\n");
     return false;
   }
 
-  const Descriptor *desc = this->dataPtr->logFile->Descriptor();
-  const Descriptor::NameToMap &allTopics = desc->TopicsToMsgTypesToId();
+  const Descriptor::NameToMap allTopics = LogTopics(this->dataPtr->logFiles);
 
   const Descriptor::NameToMap::const_iterator it = allTopics.find(_topic);
   if (it == allTopics.end())
@@ -364,16 +1105,16 @@ int64_t Playback::AddTopic(const std::regex &_topic)
   // calling this function, the user has expressed an intention to explicitly
   // specify which topics to publish.
   this->dataPtr->addTopicWasUsed = true;
+  this->dataPtr->preloaded.reset();
 
-  if (!this->dataPtr->logFile->Valid())
+  if (!AllValid(this->dataPtr->logFiles))
   {
     LERR("Failed to open log file\n");
     return -1;
   }
 
   int64_t numMatches = 0;
-  const Descriptor *desc = this->dataPtr->logFile->Descriptor();
-  const Descriptor::NameToMap &allTopics = desc->TopicsToMsgTypesToId();
+  const Descriptor::NameToMap allTopics = LogTopics(this->dataPtr->logFiles);
 
   for (const auto &topicEntry : allTopics)
   {
@@ -391,6 +1132,7 @@ int64_t Playback::AddTopic(const std::regex &_topic)
 bool Playback::RemoveTopic(const std::string &_topic)
 {
   this->dataPtr->DefaultToAllTopics();
+  this->dataPtr->preloaded.reset();
 
   return (this->dataPtr->topicNames.erase(_topic) > 0);
 }
@@ -399,6 +1141,7 @@ bool Playback::RemoveTopic(const std::string &_topic)
 int64_t Playback::RemoveTopic(const std::regex &_topic)
 {
   this->dataPtr->DefaultToAllTopics();
+  this->dataPtr->preloaded.reset();
 
   uint64_t count = 0;
   std::unordered_set<std::string>::iterator it =
@@ -420,21 +1163,55 @@ int64_t Playback::RemoveTopic(const std::regex &_topic)
   return count;
 }
 
+//////////////////////////////////////////////////
+bool Playback::Preload(const QualifiedTimeRange &_range)
+{
+  if (!AllValid(this->dataPtr->logFiles))
+  {
+    LERR("Could not preload: Failed to open log file\n");
+    return false;
+  }
+
+  const std::unordered_set<std::string> topics =
+    this->dataPtr->SelectedTopics();
+  this->dataPtr->preloaded = std::make_shared<const PreloadedMessages>(
+    MergedBatch(this->dataPtr->logFiles, TopicList::Create(topics, _range)),
+    topics);
+  LDBG("Preloaded " << this->dataPtr->preloaded->entries.size()
+       << " messages\n");
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool Playback::Preloaded() const
+{
+  return this->dataPtr->preloaded != nullptr;
+}
+
+//////////////////////////////////////////////////
+std::size_t Playback::PreloadedBytes() const
+{
+  return this->dataPtr->preloaded ?
+    this->dataPtr->preloaded->arena.size() : 0u;
+}
+
 //////////////////////////////////////////////////
 PlaybackHandle::Implementation::Implementation(
-    const std::shared_ptr<Log> &_logFile,
+    const LogFiles &_logFiles,
     const std::unordered_set<std::string> &_topics,
     const std::chrono::nanoseconds &_waitAfterAdvertising,
     const NodeOptions &_nodeOptions,
-    bool _msgWaiting)
+    bool _msgWaiting,
+    const std::shared_ptr<const PreloadedMessages> &_preloaded)
   : stop(true),
     finished(false),
     paused(false),
-    logFile(_logFile),
+    logFiles(_logFiles),
+    allTopics(LogTopics(_logFiles)),
     trackedTopics(_topics),
-    batch(logFile->QueryMessages(TopicList::Create(_topics))),
-    messageIter(batch.begin()),
-    firstMessageTime(messageIter->TimeReceived()),
+    batch(_preloaded ? PrefetchedBatch(_preloaded) :
+      PrefetchedBatch(MergedBatch(logFiles, TopicList::Create(_topics)))),
+    firstMessageTime(batch.TimeReceived()),
     msgWaiting(_msgWaiting)
 {
   this->node.reset(new transport::Node(_nodeOptions));
@@ -446,7 +1223,7 @@ PlaybackHandle::Implementation::Implementation(
 
   std::this_thread::sleep_for(_waitAfterAdvertising);
 
-  if (this->batch.begin() == this->batch.end())
+  if (this->batch.Done())
   {
     LWRN("There are no messages to play\n");
   }
@@ -458,10 +1235,8 @@ PlaybackHandle::Implementation::Implementation(
 void PlaybackHandle::Implementation::AddTopic(
     const std::string &_topic)
 {
-  const Descriptor *desc = this->logFile->Descriptor();
-  const Descriptor::NameToMap &allTopics = desc->TopicsToMsgTypesToId();
-
-  const Descriptor::NameToMap::const_iterator it = allTopics.find(_topic);
+  const Descriptor::NameToMap::const_iterator it =
+    this->allTopics.find(_topic);
   for (const auto &typeEntry : it->second)
   {
     const std::string &type = typeEntry.first;
@@ -492,15 +1267,35 @@ void PlaybackHandle::Implementation::CreatePublisher(
     return;
   }
 
+  // The topics recorded with their fully qualified name are published in
+  // their partition.
+  Node *publisherNode = this->node.get();
+  std::string partition;
+  std::string topic = _topic;
+  if (!_topic.empty() && _topic[0] == '@' &&
+      TopicUtils::DecomposeFullyQualifiedTopic(_topic, partition, topic))
+  {
+    if (!partition.empty() && partition[0] == '/')
+      partition.erase(partition.begin());
+    std::unique_ptr<Node> &partitionNode = this->partitionNodes[partition];
+    if (!partitionNode)
+    {
+      NodeOptions opts = this->node->Options();
+      opts.SetPartition(partition);
+      partitionNode = std::make_unique<Node>(opts);
+    }
+    publisherNode = partitionNode.get();
+  }
+
   // Create a publisher for the topic and type combo
-  firstMapIter->second[_type] = this->node->Advertise(_topic, _type);
+  firstMapIter->second[_type] = publisherNode->Advertise(topic, _type);
   LDBG("Creating publisher for " << _topic << " " << _type << "\n");
 }
 
 //////////////////////////////////////////////////
 void PlaybackHandle::Implementation::WaitUntilFinished()
 {
-  if (this->logFile->Valid() && !this->stop)
+  if (AllValid(this->logFiles) && !this->stop)
   {
     std::unique_lock<std::mutex> lk(this->waitMutex);
     this->waitConditionVariable.wait(lk, [this]{return this->finished.load();});
@@ -518,17 +1313,38 @@ void PlaybackHandle::Implementation::StartPlayback()
 
   // Set time in the playback frame equal to the first message in batch
   // so that it gets played back right after playback starts
-  this->playbackStartTime = this->logFile->StartTime();
+  this->playbackStartTime = std::chrono::nanoseconds::max();
+  this->playbackEndTime = std::chrono::nanoseconds::min();
+  for (const auto &logFile : this->logFiles)
+  {
+    // An empty shard has no messages, its times are zero.
+    if (logFile->EndTime() == std::chrono::nanoseconds::zero())
+      continue;
+    this->playbackStartTime =
+      std::min(this->playbackStartTime, logFile->StartTime());
+    this->playbackEndTime =
+      std::max(this->playbackEndTime, logFile->EndTime());
+  }
+  if (this->playbackStartTime > this->playbackEndTime)
+  {
+    this->playbackStartTime = this->logFiles.front()->StartTime();
+    this->playbackEndTime = this->logFiles.front()->EndTime();
+  }
   this->playbackTime = this->playbackStartTime;
-  this->playbackEndTime = this->logFile->EndTime();
 
-  this->nextMessageTime = this->messageIter->TimeReceived();
+  this->nextMessageTime = this->batch.TimeReceived();
 
   this->lastEventTime = std::chrono::steady_clock::now().time_since_epoch();
 
   this->playbackThread = std::thread([this] () mutable
     {
-      while (!this->stop && (this->messageIter != this->batch.end())) {
+      while (!this->stop) {
+        if (this->batch.Done())
+        {
+          if (!this->loop || !this->Rewind())
+            break;
+          continue;
+        }
         // Lock if paused
         if (this->paused)
         {
@@ -548,7 +1364,7 @@ void PlaybackHandle::Implementation::StartPlayback()
           const std::chrono::nanoseconds timeDelta(
               this->nextMessageTime - this->playbackTime);
           const std::chrono::nanoseconds timeToWaitUntil(
-              this->lastEventTime + timeDelta);
+              this->lastEventTime + this->RealDuration(timeDelta));
           // Wait until target time is reached or playback is stopped/paused
           // In the latter case, break the iteration step
           if (this->msgWaiting && !this->WaitUntil(timeToWaitUntil))
@@ -559,17 +1375,14 @@ void PlaybackHandle::Implementation::StartPlayback()
           {
           std::unique_lock<std::mutex> lk(this->batchMutex);
           LDBG("publishing\n");
-          this->publishers[
-            this->messageIter->Topic()][
-              this->messageIter->Type()].PublishRaw(
-                this->messageIter->Data(), this->messageIter->Type());
-          // Advance iterator to next message
-          ++this->messageIter;
+          // Take the message and advance iterator to next message
+          this->Publish(this->batch.Pop());
           this->playbackTime = this->nextMessageTime;
           this->lastEventTime =
               std::chrono::steady_clock::now().time_since_epoch();
-          this->nextMessageTime = messageIter->TimeReceived();
+          this->nextMessageTime = this->batch.TimeReceived();
           }
+          this->WaitForAck();
         }
         // If a custom step has been requested, always from a paused state,
         // playback gets resumed until the step requested is completed,
@@ -581,7 +1394,7 @@ void PlaybackHandle::Implementation::StartPlayback()
               this->boundaryTime - this->playbackTime);
           // Target time in the realtime frame
           const std::chrono::nanoseconds timeToWaitUntil(
-              this->lastEventTime + timeDelta);
+              this->lastEventTime + this->RealDuration(timeDelta));
           // Wait until target time is reached or playback is stopped/paused
           // In the latter case, break the iteration step
           if (!this->WaitUntil(timeToWaitUntil))
@@ -591,11 +1404,37 @@ void PlaybackHandle::Implementation::StartPlayback()
           this->Pause();
         }
       }
+      if (!this->stop)
+        this->DrainLanes();
       this->finished = true;
       this->waitConditionVariable.notify_all();
   });
 }
 
+//////////////////////////////////////////////////
+void PlaybackHandle::Implementation::Publish(PrefetchedMessage &&_message)
+{
+  if (!this->parallelPublishing)
+  {
+    this->publishers[_message.topic][_message.type].PublishRaw(
+      _message.data, _message.type);
+    return;
+  }
+
+  std::unique_ptr<PublishLane> &lane = this->lanes[_message.topic];
+  if (!lane)
+    lane.reset(new PublishLane(this->publishers[_message.topic]));
+  lane->Push(std::move(_message));
+}
+
+//////////////////////////////////////////////////
+void PlaybackHandle::Implementation::DrainLanes()
+{
+  std::lock_guard<std::mutex> lk(this->batchMutex);
+  for (auto &lane : this->lanes)
+    lane.second->Drain();
+}
+
 //////////////////////////////////////////////////
 bool PlaybackHandle::Implementation::WaitUntil(
     const std::chrono::nanoseconds &_targetTime)
@@ -661,26 +1500,137 @@ void PlaybackHandle::Implementation::Seek(
   const QualifiedTimeRange timeRange(beginTime, endTime);
   {
     std::unique_lock<std::mutex> lk(this->batchMutex);
-    this->batch = this->logFile->QueryMessages(
-        TopicList::Create(this->trackedTopics, timeRange));
-    this->messageIter = this->batch.begin();
+    if (this->batch.Preloaded())
+    {
+      this->batch.Reset(*beginTime.GetTime());
+    }
+    else
+    {
+      this->batch.Reset(MergedBatch(this->logFiles,
+          TopicList::Create(this->trackedTopics, timeRange)));
+    }
+    for (auto &lane : this->lanes)
+      lane.second->Clear();
+    this->RepublishState(*beginTime.GetTime());
   }
-  this->playbackTime = this->messageIter->TimeReceived();
-  this->nextMessageTime = this->messageIter->TimeReceived();
+  this->playbackTime = this->batch.TimeReceived();
+  this->nextMessageTime = this->batch.TimeReceived();
   this->boundaryTime = std::chrono::nanoseconds::max();
   this->lastEventTime = std::chrono::steady_clock::now().time_since_epoch();
 }
 
+//////////////////////////////////////////////////
+std::size_t PlaybackHandle::Implementation::SetStateTopics(
+    const std::regex &_topics)
+{
+  std::set<std::string> topics;
+  for (const std::string &topic : this->trackedTopics)
+  {
+    if (std::regex_match(topic, _topics))
+      topics.insert(topic);
+  }
+
+  std::unique_lock<std::mutex> lk(this->batchMutex);
+  this->stateTopics = std::move(topics);
+  return this->stateTopics.size();
+}
+
+//////////////////////////////////////////////////
+void PlaybackHandle::Implementation::RepublishState(
+    const std::chrono::nanoseconds &_time)
+{
+  if (this->stateTopics.empty())
+    return;
+
+  // A topic can be in several files, e.g. after a rotation, so keep the
+  // last of their messages
+  const QualifiedTimeRange range = QualifiedTimeRange::Until(
+      QualifiedTime(_time, QualifiedTime::Qualifier::EXCLUSIVE));
+  std::unordered_map<std::string, PrefetchedMessage> latest;
+  if (const auto &preloaded = this->batch.Preloaded())
+  {
+    // Walk back from the time until every state topic is found
+    for (std::size_t i = preloaded->Find(_time);
+         i > 0 && latest.size() < this->stateTopics.size(); --i)
+    {
+      const auto &name =
+        preloaded->names[preloaded->entries[i - 1].names];
+      if (this->stateTopics.count(name.first) && !latest.count(name.first))
+        latest[name.first] = preloaded->Message(i - 1);
+    }
+  }
+  for (const auto &logFile : this->logFiles)
+  {
+    if (this->batch.Preloaded())
+      break;
+
+    for (const Message &msg : logFile->QueryMessages(
+           LatestMessages(this->stateTopics, range)))
+    {
+      const std::chrono::nanoseconds time = msg.TimeReceived();
+      auto it = latest.find(msg.Topic());
+      if (it != latest.end() && it->second.time >= time)
+        continue;
+
+      latest[msg.Topic()] =
+          PrefetchedMessage{time, msg.Topic(), msg.Type(), msg.Data()};
+    }
+  }
+
+  std::vector<const PrefetchedMessage *> messages;
+  for (const auto &entry : latest)
+    messages.push_back(&entry.second);
+  std::sort(messages.begin(), messages.end(),
+      [](const PrefetchedMessage *_a, const PrefetchedMessage *_b)
+      {
+        return _a->time < _b->time;
+      });
+
+  for (const PrefetchedMessage *message : messages)
+  {
+    this->publishers[message->topic][message->type].PublishRaw(
+        message->data, message->type);
+  }
+}
+
+//////////////////////////////////////////////////
+bool PlaybackHandle::Implementation::Rewind()
+{
+  {
+    std::unique_lock<std::mutex> lk(this->batchMutex);
+    if (this->batch.Preloaded())
+    {
+      this->batch.Reset(std::chrono::nanoseconds::min());
+    }
+    else
+    {
+      this->batch.Reset(MergedBatch(this->logFiles,
+          TopicList::Create(this->trackedTopics)));
+    }
+  }
+  if (this->batch.Done())
+    return false;
+
+  this->playbackTime = this->batch.TimeReceived();
+  this->nextMessageTime = this->playbackTime;
+  this->lastEventTime = std::chrono::steady_clock::now().time_since_epoch();
+  return true;
+}
+
 //////////////////////////////////////////////////
 void PlaybackHandle::Implementation::Stop()
 {
-  if (!this->logFile->Valid())
+  if (!AllValid(this->logFiles))
   {
     return;
   }
 
   this->stop = true;
   this->stopConditionVariable.notify_all();
+  {
+    std::lock_guard<std::mutex> lk(this->ackMutex);
+    this->ackConditionVariable.notify_all();
+  }
 
   if (this->paused)
   {
@@ -691,6 +1641,9 @@ void PlaybackHandle::Implementation::Stop()
 
   if (this->playbackThread.joinable())
     this->playbackThread.join();
+
+  std::lock_guard<std::mutex> lk(this->batchMutex);
+  this->lanes.clear();
 }
 
 //////////////////////////////////////////////////
@@ -703,8 +1656,13 @@ void PlaybackHandle::Implementation::Pause()
     std::chrono::nanoseconds now(
         std::chrono::steady_clock::now().time_since_epoch());
     // Advance time in the playback frame to the moment when pause started
-    this->playbackTime = this->playbackTime +
-        now - this->lastEventTime;
+    const double elapsed = static_cast<double>((now - this->lastEventTime)
+      .count()) * this->rate;
+    if (std::isfinite(elapsed))
+    {
+      this->playbackTime +=
+        std::chrono::nanoseconds(static_cast<int64_t>(elapsed));
+    }
     // Update last event time in the realtime frame.
     this->lastEventTime = now;
     this->boundaryTime = std::chrono::nanoseconds::max();
@@ -728,6 +1686,95 @@ bool PlaybackHandle::Implementation::IsPaused() const
   return this->paused;
 }
 
+//////////////////////////////////////////////////
+bool PlaybackHandle::Implementation::SetRate(const double _rate)
+{
+  if (!(_rate > 0.0))
+  {
+    LERR("Invalid playback rate [" << _rate << "]. It must be positive\n");
+    return false;
+  }
+
+  // The rate applies from the next message.
+  this->rate = _rate;
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool PlaybackHandle::Implementation::SetLockstep(const std::string &_ackTopic,
+    const std::chrono::nanoseconds &_timeout)
+{
+  std::lock_guard<std::mutex> lk(this->ackMutex);
+  if (!this->ackTopic.empty())
+    this->node->Unsubscribe(this->ackTopic);
+  this->ackTopic.clear();
+  this->ackTimeout = _timeout;
+
+  if (_ackTopic.empty())
+  {
+    this->ackConditionVariable.notify_all();
+    return true;
+  }
+
+  auto cb = [this](const char *, std::size_t, const MessageInfo &)
+  {
+    std::lock_guard<std::mutex> ackLock(this->ackMutex);
+    ++this->acks;
+    this->ackConditionVariable.notify_all();
+  };
+
+  if (!this->node->SubscribeRaw(_ackTopic, cb))
+  {
+    LERR("Failed to subscribe to [" << _ackTopic << "]\n");
+    return false;
+  }
+
+  // Only the messages published from now on are acknowledged.
+  this->acks = 0;
+  this->expectedAcks = 0;
+  this->ackTopic = _ackTopic;
+  return true;
+}
+
+//////////////////////////////////////////////////
+std::chrono::nanoseconds PlaybackHandle::Implementation::RealDuration(
+    const std::chrono::nanoseconds &_logDuration) const
+{
+  const double rateFactor = this->rate;
+  if (rateFactor == 1.0)
+    return _logDuration;
+
+  if (std::isinf(rateFactor))
+    return std::chrono::nanoseconds::zero();
+
+  return std::chrono::nanoseconds(static_cast<int64_t>(
+    static_cast<double>(_logDuration.count()) / rateFactor));
+}
+
+//////////////////////////////////////////////////
+void PlaybackHandle::Implementation::WaitForAck()
+{
+  std::unique_lock<std::mutex> lk(this->ackMutex);
+  if (this->ackTopic.empty())
+    return;
+
+  ++this->expectedAcks;
+  const bool acknowledged = this->ackConditionVariable.wait_for(lk,
+    this->ackTimeout, [this]
+    {
+      return this->acks >= this->expectedAcks || this->stop ||
+        this->ackTopic.empty();
+    });
+
+  if (!acknowledged)
+  {
+    LWRN("No acknowledgment received on [" << this->ackTopic
+         << "], publishing the next message\n");
+    // Don't wait for the late acknowledgment of this message.
+    this->acks = this->expectedAcks;
+  }
+}
+
 //////////////////////////////////////////////////
 PlaybackHandle::~PlaybackHandle()
 {
@@ -761,6 +1808,36 @@ void PlaybackHandle::Seek(const std::chrono::nanoseconds &_newElapsedTime)
   this->dataPtr->Seek(_newElapsedTime);
 }
 
+//////////////////////////////////////////////////
+void PlaybackHandle::SetParallelPublishing(const bool _parallel)
+{
+  this->dataPtr->parallelPublishing = _parallel;
+}
+
+//////////////////////////////////////////////////
+bool PlaybackHandle::ParallelPublishing() const
+{
+  return this->dataPtr->parallelPublishing;
+}
+
+//////////////////////////////////////////////////
+void PlaybackHandle::SetLoop(const bool _loop)
+{
+  this->dataPtr->loop = _loop;
+}
+
+//////////////////////////////////////////////////
+bool PlaybackHandle::Loop() const
+{
+  return this->dataPtr->loop;
+}
+
+//////////////////////////////////////////////////
+std::size_t PlaybackHandle::SetStateTopics(const std::regex &_topics)
+{
+  return this->dataPtr->SetStateTopics(_topics);
+}
+
 //////////////////////////////////////////////////
 void PlaybackHandle::Resume()
 {
@@ -785,6 +1862,25 @@ bool PlaybackHandle::Finished() const
   return this->dataPtr->finished;
 }
 
+//////////////////////////////////////////////////
+bool PlaybackHandle::SetRate(const double _rate)
+{
+  return this->dataPtr->SetRate(_rate);
+}
+
+//////////////////////////////////////////////////
+double PlaybackHandle::Rate() const
+{
+  return this->dataPtr->rate;
+}
+
+//////////////////////////////////////////////////
+bool PlaybackHandle::SetLockstep(const std::string &_ackTopic,
+    const std::chrono::nanoseconds &_timeout)
+{
+  return this->dataPtr->SetLockstep(_ackTopic, _timeout);
+}
+
 //////////////////////////////////////////////////
 std::chrono::nanoseconds PlaybackHandle::StartTime() const
 {
@@ -15,6 +15,7 @@
  *
 */
 
+#include <chrono>
 #include <cstdint>
 #include <regex>
 #include <set>
@@ -33,7 +34,10 @@ using namespace gz::transport::log;
 static void AppendTopicListClause(
     SqlStatement &_sql, const std::vector<int64_t> &_ids)
 {
-  _sql.statement += "topic_id in (";
+  // The unary + keeps SQLite from using idx_topic_time_recv for this term,
+  // which would then sort the whole result instead of following
+  // idx_time_recv in order of time received.
+  _sql.statement += "+topic_id in (";
   bool first = true;
   for (const int64_t id : _ids)
   {
@@ -59,7 +63,8 @@ SqlStatement QueryOptions::StandardMessageQueryPreamble()
   SqlStatement sql;
   sql.statement =
       "SELECT messages.id, messages.time_recv, topics.name,"
-      " message_types.name, messages.message FROM messages JOIN topics ON"
+      " message_types.name, messages.message, messages.topic_id FROM"
+      " messages JOIN topics ON"
       " topics.id = messages.topic_id JOIN message_types ON"
       " message_types.id = topics.message_type_id ";
 
@@ -75,10 +80,39 @@ SqlStatement QueryOptions::StandardMessageQueryClose()
 //////////////////////////////////////////////////
 class TimeRangeOption::Implementation
 {
-  /// \brief Convert the QualifiedTimeRange into a SqlStatement clause that
-  /// can be appended to the complete clause.
-  /// \return SqlStatement time range clause
+  /// \brief Convert the QualifiedTimeRange and the sampling into a
+  /// SqlStatement clause that can be appended to the complete clause.
+  /// \return SqlStatement time clause
   public: SqlStatement GenerateTimeConditions() const
+  {
+    const SqlStatement range = this->GenerateRangeConditions();
+    if (this->interval.count() <= 0)
+      return range;
+
+    // The first message of every topic in every interval, found in
+    // idx_topic_time_recv or idx_time_recv without reading the messages.
+    // SQLite takes the id from the row of MIN(time_recv).
+    SqlStatement sql;
+    if (!range.statement.empty())
+    {
+      sql.Append(range);
+      sql.statement += " AND ";
+    }
+    sql.statement += "messages.id IN (SELECT id FROM"
+      " (SELECT id, MIN(time_recv) FROM messages AS sampled";
+    if (!range.statement.empty())
+    {
+      sql.statement += " WHERE ";
+      sql.Append(range);
+    }
+    sql.statement += " GROUP BY topic_id, time_recv / ?))";
+    sql.parameters.emplace_back(this->interval.count());
+    return sql;
+  }
+
+  /// \brief Convert the QualifiedTimeRange into a SqlStatement clause.
+  /// \return SqlStatement time range clause
+  public: SqlStatement GenerateRangeConditions() const
   {
     SqlStatement sql;
 
@@ -130,6 +164,9 @@ class TimeRangeOption::Implementation
 
   /// \brief Range for this option
   public: QualifiedTimeRange range;
+
+  /// \brief Interval of the sampling, 0 for every message
+  public: std::chrono::nanoseconds interval{0};
 };
 
 //////////////////////////////////////////////////
@@ -166,6 +203,19 @@ const QualifiedTimeRange &TimeRangeOption::TimeRange() const
   return this->dataPtr->range;
 }
 
+//////////////////////////////////////////////////
+void TimeRangeOption::SetSampleInterval(
+    const std::chrono::nanoseconds &_interval)
+{
+  this->dataPtr->interval = _interval;
+}
+
+//////////////////////////////////////////////////
+std::chrono::nanoseconds TimeRangeOption::SampleInterval() const
+{
+  return this->dataPtr->interval;
+}
+
 //////////////////////////////////////////////////
 SqlStatement TimeRangeOption::GenerateTimeConditions() const
 {
@@ -444,3 +494,91 @@ AllTopics::~AllTopics()
 {
   // Destroy the pimpl
 }
+
+//////////////////////////////////////////////////
+class LatestMessages::Implementation
+{
+  /// \brief Topics for this option
+  public: std::set<std::string> topics;
+};
+
+//////////////////////////////////////////////////
+LatestMessages::LatestMessages(
+    const std::set<std::string> &_topics,
+    const QualifiedTimeRange &_timeRange)
+  : TimeRangeOption(_timeRange),
+    dataPtr(new Implementation{_topics})
+{
+  // Do nothing
+}
+
+//////////////////////////////////////////////////
+LatestMessages::LatestMessages(const LatestMessages &_other)
+  : TimeRangeOption(_other),
+    dataPtr(new Implementation{*_other.dataPtr})
+{
+  // Do nothing
+}
+
+//////////////////////////////////////////////////
+LatestMessages::LatestMessages(LatestMessages &&_other)  // NOLINT
+  : TimeRangeOption(std::move(_other)),
+    dataPtr(std::move(_other.dataPtr))
+{
+  // Do nothing
+}
+
+//////////////////////////////////////////////////
+std::set<std::string> &LatestMessages::Topics()
+{
+  return this->dataPtr->topics;
+}
+
+//////////////////////////////////////////////////
+const std::set<std::string> &LatestMessages::Topics() const
+{
+  return this->dataPtr->topics;
+}
+
+//////////////////////////////////////////////////
+std::vector<SqlStatement> LatestMessages::GenerateStatements(
+    const Descriptor &_descriptor) const
+{
+  const Descriptor::NameToMap &map = _descriptor.TopicsToMsgTypesToId();
+  const SqlStatement &timeCondition = this->GenerateTimeConditions();
+
+  // A statement by topic id, so each one is a single lookup in
+  // idx_topic_time_recv
+  std::vector<SqlStatement> statements;
+  for (const auto &topic : this->dataPtr->topics)
+  {
+    Descriptor::NameToMap::const_iterator it = map.find(topic);
+    if (it == map.end())
+      continue;
+
+    for (const auto &msgEntry : it->second)
+    {
+      SqlStatement sql = QueryOptions::StandardMessageQueryPreamble();
+      sql.statement += "WHERE messages.topic_id = ?";
+      sql.parameters.emplace_back(msgEntry.second);
+
+      if (!timeCondition.statement.empty())
+      {
+        sql.statement += " AND (";
+        sql.Append(timeCondition);
+        sql.statement += ")";
+      }
+
+      sql.statement += " ORDER BY messages.time_recv DESC LIMIT 1;";
+      statements.push_back(sql);
+    }
+  }
+
+  return statements;
+}
+
+//////////////////////////////////////////////////
+LatestMessages::~LatestMessages()
+{
+  // Destroy the pimpl
+}
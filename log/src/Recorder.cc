@@ -15,52 +15,146 @@
  *
 */
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <cstdint>
 #include <deque>
+#include <filesystem>
 #include <functional>
+#include <limits>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <regex>
 #include <set>
+#include <string>
 #include <utility>
 #include <vector>
 #include <thread>
+#include <unordered_map>
+#include <unordered_set>
 
 #include <gz/transport/Clock.hh>
 #include <gz/transport/Discovery.hh>
+#include <gz/transport/log/ChunkedLog.hh>
 #include <gz/transport/log/Log.hh>
 #include <gz/transport/log/Recorder.hh>
+#include <gz/transport/log/ShardSet.hh>
 #include <gz/transport/MessageInfo.hh>
 #include <gz/transport/Node.hh>
+#include <gz/transport/NodeOptions.hh>
+#include <gz/transport/TopicUtils.hh>
 #include <gz/transport/TransportTypes.hh>
 
 #include "Console.hh"
+#include "TopicKey.hh"
 #include "raii-sqlite3.hh"
 #include "build_config.hh"
 
 using namespace gz::transport;
 using namespace gz::transport::log;
 
+/// \brief Value of Recorder::Implementation::cachedTime when the messages
+/// are stamped with the time of the clock
+static const int64_t kNoCachedTime = std::numeric_limits<int64_t>::min();
+
 /// \brief Private implementation
 class gz::transport::log::Recorder::Implementation
 {
+  /// \brief Priority and quota of the topics matching a pattern
+  public: struct TopicPriority
+  {
+    /// \brief Pattern matching the topic names
+    std::regex pattern;
+    /// \brief Priority of the topics, see Recorder::AddTopicPriority()
+    int priority;
+    /// \brief Maximum size (in bytes) of the messages of a topic in the
+    /// buffer, 0 means no quota
+    std::size_t quota;
+  };
+
+  /// \brief State of a topic in the buffer
+  public: struct TopicBuffer
+  {
+    /// \brief Priority of the topic
+    int priority{0};
+    /// \brief Maximum size (in bytes) of the messages of the topic in the
+    /// buffer, 0 means no quota
+    std::size_t quota{0};
+    /// \brief Size (in bytes) of the messages of the topic in the buffer
+    std::size_t bytes{0};
+    /// \brief Sequence numbers of the messages of the topic in the buffer,
+    /// oldest first. It might contain messages already dropped.
+    std::deque<uint64_t> seqs;
+    /// \brief Number of messages dropped since the recording started
+    uint64_t droppedMessages{0};
+    /// \brief Size (in bytes) of the messages dropped since the recording
+    /// started
+    uint64_t droppedBytes{0};
+    /// \brief Index of the shard recording the topic
+    std::size_t shard{0};
+  };
+
+  /// \brief A log file being recorded. When the recording is split in
+  /// several shards, each one but the first is written by its own thread.
+  public: struct Shard
+  {
+    /// \brief SQLite log file, or nullptr
+    std::unique_ptr<Log> logFile;
+    /// \brief Chunked log file, or nullptr
+    std::unique_ptr<ChunkedLog> chunkedLogFile;
+    /// \brief Path of the log file
+    std::string file;
+    /// \brief When the log file was created
+    std::chrono::steady_clock::time_point opened;
+    /// \brief Size of the messages recorded in the log file
+    uint64_t bytes{0};
+    /// \brief Messages of the batch being written to this shard
+    std::vector<MessageRecord> records;
+    /// \brief Thread writing the records of this shard
+    std::thread writer;
+    /// \brief Mutex to synchronize access to pending and stop
+    std::mutex mutex;
+    /// \brief Condition variable signaling changes of pending and stop
+    std::condition_variable condVar;
+    /// \brief True while the records are waiting to be written
+    bool pending{false};
+    /// \brief True when the writer thread must exit
+    bool stop{false};
+  };
+
   /// \brief Data type stored in dataQueue
   public: struct LogData
   {
     /// \brief Constructor
-    LogData(std::chrono::nanoseconds _stamp, std::vector<char> &&_msgData, // NOLINT
-            const transport::MessageInfo &_msgInfo)
-        : stamp(_stamp), msgData(std::move(_msgData)), msgInfo(_msgInfo)
+    LogData(std::chrono::nanoseconds _stamp,
+            const std::shared_ptr<const char> &_msgData,
+            std::size_t _msgSize,
+            const transport::MessageInfo &_msgInfo,
+            TopicBuffer *_topic)
+        : stamp(_stamp), msgData(_msgData), msgSize(_msgSize),
+          msgInfo(_msgInfo), topic(_topic), shard(_topic->shard)
     {
     }
     /// \brief Time stamp of when the message was received by the log recorder
     std::chrono::nanoseconds stamp;
-    /// Serialized message data
-    std::vector<char> msgData;
+    /// Serialized message data. This is a reference to the buffer received
+    /// by the subscription, it is bound as is to the insert statement.
+    std::shared_ptr<const char> msgData;
+    /// Size of the serialized message data (bytes)
+    std::size_t msgSize;
     /// Extra information about the message, such as its topic.
     transport::MessageInfo msgInfo;
+    /// State of the topic in the buffer
+    TopicBuffer *topic;
+    /// Index of the shard recording the message
+    std::size_t shard;
+    /// Whether the message was dropped to make room for other messages.
+    /// Such a message stays in the queue until the messages before it are
+    /// taken by the writer, but it isn't written.
+    bool dropped{false};
   };
 
   /// \brief constructor
@@ -70,11 +164,11 @@ class gz::transport::log::Recorder::Implementation
   public: ~Implementation();
 
   /// \brief Subscriber callback
-  /// \param[in] _data Data of the message
+  /// \param[in] _data Data of the message, shared with the subscription
   /// \param[in] _len The size of the message data
   /// \param[in] _info The meta-info of the message
   public: void OnMessageReceived(
-          const char *_data,
+          const std::shared_ptr<const char> &_data,
           std::size_t _len,
           const transport::MessageInfo &_info);
 
@@ -88,6 +182,35 @@ class gz::transport::log::Recorder::Implementation
   /// \sa Recorder::AddTopic(const std::regex&)
   public: int64_t AddTopic(const std::regex &_pattern);
 
+  /// \brief Subscribe to a topic in one partition
+  /// \param[in] _node The node of the partition
+  /// \param[in] _name Name of the topic in the log
+  /// \param[in] _topic Name of the topic in the partition
+  /// \return SUCCESS, FAILED_TO_SUBSCRIBE or ALREADY_SUBSCRIBED_TO_TOPIC
+  public: RecorderError AddTopic(Node &_node, const std::string &_name,
+                                 const std::string &_topic);
+
+  /// \sa Recorder::AddPartition()
+  public: RecorderError AddPartition(const std::string &_partition);
+
+  /// \brief Get the node subscribing in a partition
+  /// \param[in] _partition Name of the partition, with or without the
+  /// leading slash
+  /// \return The node, or nullptr if the partition isn't recorded
+  public: Node *NodeOf(const std::string &_partition);
+
+  /// \brief Get the nodes of the partitions added with AddPartition()
+  /// \return The nodes, by name of partition
+  public: std::vector<std::pair<std::string, Node *>> PartitionNodes();
+
+  /// \brief Get the name of a topic in the log: the topics of the partition
+  /// of the recorder keep their name, the others are fully qualified.
+  /// \param[in] _partition Partition of the topic
+  /// \param[in] _topic Absolute name of the topic in its partition
+  /// \return The name in the log
+  public: std::string RecordedName(const std::string &_partition,
+                                   const std::string &_topic) const;
+
   /// \brief Worker thread function that writes data from the dataQueue to the
   /// database
   public: void DataWriterThread();
@@ -102,25 +225,142 @@ class gz::transport::log::Recorder::Implementation
   /// \param[in] _len The amount to decrement
   public: void DecrementBufferSize(std::size_t _len);
 
+  /// \brief Get the state of a topic in the buffer. Its priority and quota
+  /// are set the first time the topic is seen.
+  /// \param[in] _topic Name of the topic
+  /// \return The state of the topic
+  public: TopicBuffer &TopicBufferOf(const std::string &_topic);
+
+  /// \brief Set the priority and the quota of a topic from the first
+  /// pattern of `priorities` matching its name.
+  /// \param[in] _name Name of the topic
+  /// \param[out] _topic State of the topic
+  public: void ApplyTopicPriority(const std::string &_name,
+                                  TopicBuffer &_topic);
+
+  /// \brief Drop messages from the buffer to make room for a new message,
+  /// according to the priorities and the quotas of the topics.
+  /// \param[in] _topic Topic of the new message
+  /// \param[in] _len Size of the new message
+  /// \return False if the new message must be dropped instead, because
+  /// only messages with a higher priority are buffered.
+  public: bool MakeRoom(TopicBuffer &_topic, std::size_t _len);
+
+  /// \brief Remove the messages that are not in the buffer anymore from the
+  /// front of a list of sequence numbers.
+  /// \param[in,out] _seqs Sequence numbers, oldest first
+  public: void PruneSeqs(std::deque<uint64_t> &_seqs);
+
+  /// \brief Drop the oldest message of a list of sequence numbers.
+  /// \param[in,out] _seqs Sequence numbers, oldest first
+  /// \return False if there was no message to drop.
+  public: bool DropOldest(std::deque<uint64_t> &_seqs);
+
+  /// \brief Take all the messages of the buffer, so they can be written
+  /// while the callbacks keep queuing. dataQueueMutex must be locked.
+  /// \param[out] _batch The messages, in order. Some might be dropped.
+  public: void TakeDataQueue(std::deque<LogData> &_batch);
+
+  /// \brief Store the drop counters in the metadata of the log file.
+  /// logFileMutex and dataQueueMutex must be locked.
+  public: void WriteDropCounters();
+
   /// \brief Write any data left in the queue to the log file
   public: void FlushDataQueue();
 
   /// \brief Write data to log file
-  /// \param[in] _logData data to be written
-  public: void WriteToLogFile(const LogData &_logData);
-
-  /// \brief log file or nullptr if not recording
-  public: std::unique_ptr<Log> logFile;
+  /// \param[in] _batch data to be written, in order
+  public: void WriteToLogFile(const std::deque<LogData> &_batch);
+
+  /// \brief Create a log file.
+  /// \param[in] _file Path to the log file
+  /// \param[in] _options Options of the log file
+  /// \return The log file, or nullptr on error.
+  public: static std::unique_ptr<Shard> OpenShard(const std::string &_file,
+                                                  const LogOptions &_options);
+
+  /// \brief Insert the records of a shard into its log file.
+  /// \param[in] _shard The shard
+  public: static void InsertRecords(Shard &_shard);
+
+  /// \brief Worker thread function that writes the records of a shard.
+  /// \param[in] _shard The shard
+  public: static void ShardWriterThread(Shard *_shard);
+
+  /// \brief Stop the writer threads of the shards.
+  public: void StopShardWriters();
+
+  /// \brief Whether a shard must roll over to a new log file before
+  /// writing its records.
+  /// \param[in] _shard The shard
+  /// \return True if the log file reached the rotation period or size.
+  public: bool RotationDue(const Shard &_shard) const;
+
+  /// \brief Replace the log file of a shard by a new one, listed in the
+  /// shard set file. The shard keeps its log file if the new one can't be
+  /// created.
+  /// \param[in] _shard The shard
+  public: void Rotate(Shard &_shard);
+
+  /// \brief Report that a log file was closed.
+  /// \param[in] _file Path of the log file
+  public: void FileFinished(const std::string &_file) const;
+
+  /// \brief Whether a log file is being recorded.
+  /// \return True if there is a shard.
+  public: bool Recording() const;
+
+  /// \brief Files being recorded, empty if not recording. The options of
+  /// Recorder::Start() give the number of shards.
+  public: std::vector<std::unique_ptr<Shard>> shards;
+
+  /// \brief Name of the log file, or of the shard set file when recording
+  /// several shards or rotating the log files
+  public: std::string filename;
+
+  /// \brief Log files listed in the shard set file, in order of creation
+  public: std::vector<std::string> files;
+
+  /// \brief Add a write to the statistics.
+  /// \param[in] _messages Number of messages written
+  /// \param[in] _bytes Size of the messages written
+  /// \param[in] _duration Duration of the write
+  public: void CountWrite(uint64_t _messages, uint64_t _bytes,
+                          const std::chrono::nanoseconds &_duration);
+
+  /// \brief Counters of the recording. The counters of the written messages
+  /// are protected by statsMutex, the others by dataQueueMutex.
+  public: RecorderStatistics stats;
+
+  /// \brief Mutex to synchronize access to the counters of the written
+  /// messages in stats
+  public: std::mutex statsMutex;
+
+  /// \brief Function called when a log file is closed, or nullptr
+  public: std::function<void(const std::string &_file)> fileFinishedCallback;
+
+  /// \brief Options of the recording, used to find the shard of a topic
+  public: LogOptions options;
 
   /// \brief A set of topic patterns that we want to subscribe to
   public: std::vector<std::regex> patterns;
 
+  /// \brief Topics added by name with Recorder::AddTopic(), subscribed in
+  /// every partition
+  public: std::set<std::string> addedTopics;
+
+  /// \brief Advertised topics that match none of the patterns. Every new
+  /// publisher of a topic advertises it again, and matching it against all
+  /// the patterns is slow, so the decision is kept until a pattern is added.
+  public: std::unordered_set<std::string> unmatchedTopics;
+
   /// \brief A set of topic names that we have already subscribed to. When new
   /// publishers advertise topics that we are already subscribed to, our
   /// OnAdvertisement callback can just ignore it.
   public: std::set<std::string> alreadySubscribed;
 
-  /// \brief mutex for thread safety when evaluating newly advertised topics
+  /// \brief mutex for thread safety when evaluating newly advertised topics,
+  /// protects patterns, addedTopics, unmatchedTopics and partitionNodes
   public: std::mutex topicMutex;
 
   /// \brief mutex for thread safety with log file
@@ -129,11 +369,50 @@ class gz::transport::log::Recorder::Implementation
   /// \brief node used to create subscriptions
   public: Node node;
 
-  /// \brief Clock to synchronize and stamp messages with.
-  public: const Clock *clock;
+  /// \brief Name of the partition of node, without the leading slash
+  public: std::string partition;
+
+  /// \brief Nodes subscribing in the partitions added with
+  /// Recorder::AddPartition(), by name of partition without the leading
+  /// slash. They are never removed, so pointers to them stay valid.
+  public: std::map<std::string, std::unique_ptr<Node>> partitionNodes;
+
+  /// \brief True once a partition is added. Until then every message is
+  /// from the partition of node, and its partition isn't checked.
+  public: std::atomic<bool> otherPartitions{false};
+
+  /// \brief Time to stamp a received message with: the time of the clock,
+  /// or the time cached by timestampTimer.
+  /// \return The time.
+  public: std::chrono::nanoseconds Now() const;
+
+  /// \brief Start updating cachedTime if the timestamps have a resolution.
+  public: void StartTimestampTimer();
+
+  /// \brief Stop updating cachedTime, the messages are stamped with the
+  /// time of the clock again.
+  public: void StopTimestampTimer();
+
+  /// \brief Clock to synchronize and stamp messages with. It's only
+  /// changed while not recording, but read by every callback.
+  public: std::atomic<const Clock *> clock;
+
+  /// \brief Resolution of the timestamps, see
+  /// Recorder::SetTimestampResolution()
+  public: std::chrono::nanoseconds timestampResolution{0};
+
+  /// \brief Time of the clock cached every timestampResolution while
+  /// recording (nanoseconds), or kNoCachedTime to read the clock for every
+  /// message.
+  public: std::atomic<int64_t> cachedTime{kNoCachedTime};
 
-  /// \brief callback used on every subscriber
-  public: RawCallback rawCallback;
+  /// \brief Updates cachedTime, or nullptr
+  public: std::unique_ptr<ClockTimer> timestampTimer;
+
+  /// \brief callback used on every subscriber. It takes the data by shared
+  /// ownership, so the received buffer is kept until it is written instead
+  /// of being copied.
+  public: SharedRawCallback rawCallback;
 
   /// \brief Object for discovering new publishers as they advertise themselves
   public: std::unique_ptr<MsgDiscovery> discovery;
@@ -150,13 +429,33 @@ class gz::transport::log::Recorder::Implementation
   /// \brief This is a temporary FIFO queue that is used to store data from
   /// callbacks until they are written to disk. If the queue fills up before
   /// the dataWriter thread has a chance to process it, old data will be
-  /// overwritten. Thus, it is important to set the queue size appropriately for
-  /// your application. The maximum size of this queue is determined by
-  /// `maxBufferSize`. The current size of the buffer is calculated from
-  /// `msgData`.
+  /// dropped, starting with the topics of the lowest priority. Thus, it is
+  /// important to set the queue size appropriately for your application. The
+  /// maximum size of this queue is determined by `maxBufferSize`. The current
+  /// size of the buffer is calculated from `msgSize`.
   public: std::deque<LogData> dataQueue;
 
-  /// \brief Mutex to synchronize access to dataQueue and bufferSize
+  /// \brief Sequence number of the first message of dataQueue. The messages
+  /// of the queue are numbered in order, which identifies them in
+  /// TopicBuffer::seqs and priorityQueues.
+  public: uint64_t queueBase{0};
+
+  /// \brief Priority and quota of the topics, the first matching pattern is
+  /// used.
+  public: std::vector<TopicPriority> priorities;
+
+  /// \brief State of every topic received since the recording started.
+  /// It is looked up for every message received.
+  public: std::unordered_map<std::string, TopicBuffer, TopicNameHash>
+    topicBuffers;
+
+  /// \brief Sequence numbers of the messages in the buffer by priority,
+  /// oldest first. When the buffer is full, the oldest message of the lowest
+  /// priority is dropped.
+  public: std::map<int, std::deque<uint64_t>> priorityQueues;
+
+  /// \brief Mutex to synchronize access to dataQueue, bufferSize and the
+  /// state of the topics in the buffer
   public: std::mutex dataQueueMutex;
 
   /// \brief Condition variable to synchronize access to dataQueue
@@ -176,14 +475,40 @@ class gz::transport::log::Recorder::Implementation
   public: std::atomic<bool> stopQueue{false};
 };
 
+//////////////////////////////////////////////////
+/// \brief Remove the leading slash of the name of a partition
+/// \param[in] _partition The name of the partition
+/// \return The name without the leading slash
+static std::string PartitionName(const std::string &_partition)
+{
+  if (!_partition.empty() && _partition[0] == '/')
+    return _partition.substr(1);
+  return _partition;
+}
+
+//////////////////////////////////////////////////
+/// \brief Compare the names of two partitions, with or without their
+/// leading slash
+/// \param[in] _a Name of a partition
+/// \param[in] _b Name of another partition
+/// \return True if they are the same partition
+static bool SamePartition(const std::string &_a, const std::string &_b)
+{
+  const std::size_t startA = !_a.empty() && _a[0] == '/' ? 1 : 0;
+  const std::size_t startB = !_b.empty() && _b[0] == '/' ? 1 : 0;
+  return _a.compare(startA, std::string::npos,
+      _b, startB, std::string::npos) == 0;
+}
+
 //////////////////////////////////////////////////
 Recorder::Implementation::Implementation()
+  : partition(PartitionName(node.Options().Partition()))
 {
   // Use wall clock for synchronization by default.
   this->clock = WallClock::Instance();
   // Make a lambda to wrap a member function callback
-  this->rawCallback = [this](
-      const char *_data, std::size_t _len, const transport::MessageInfo &_info)
+  this->rawCallback = [this](const std::shared_ptr<const char> &_data,
+      std::size_t _len, const transport::MessageInfo &_info)
   {
     this->OnMessageReceived(_data, _len, _info);
   };
@@ -206,17 +531,53 @@ Recorder::Implementation::Implementation()
 Recorder::Implementation::~Implementation()
 {
   this->StopDataWriter();
+
+  // Release the memory of the messages left in the buffer, if any.
+  std::lock_guard<std::mutex> lock(this->dataQueueMutex);
+  this->DecrementBufferSize(this->bufferSize);
+}
+
+//////////////////////////////////////////////////
+std::chrono::nanoseconds Recorder::Implementation::Now() const
+{
+  const int64_t cached = this->cachedTime.load(std::memory_order_relaxed);
+  if (cached != kNoCachedTime)
+    return std::chrono::nanoseconds(cached);
+  return this->clock.load(std::memory_order_acquire)->Time();
+}
+
+//////////////////////////////////////////////////
+void Recorder::Implementation::StartTimestampTimer()
+{
+  if (this->timestampResolution <= std::chrono::nanoseconds::zero())
+    return;
+
+  const Clock *timeSource = this->clock.load();
+  this->cachedTime = timeSource->Time().count();
+  this->timestampTimer = std::make_unique<ClockTimer>(*timeSource,
+      this->timestampResolution,
+      [this](const std::chrono::nanoseconds &_time)
+      {
+        this->cachedTime.store(_time.count(), std::memory_order_relaxed);
+      });
+}
+
+//////////////////////////////////////////////////
+void Recorder::Implementation::StopTimestampTimer()
+{
+  this->timestampTimer.reset();
+  this->cachedTime = kNoCachedTime;
 }
 
 //////////////////////////////////////////////////
 void Recorder::Implementation::OnMessageReceived(
-          const char *_data,
+          const std::shared_ptr<const char> &_data,
           std::size_t _len,
           const MessageInfo &_info)
 {
   LDBG("RX'" << _info.Topic() << "'[" << _info.Type() << "]\n");
 
-  if (!this->clock->IsReady()) {
+  if (!this->clock.load(std::memory_order_acquire)->IsReady()) {
     LWRN("Clock isn't ready yet. Dropping message\n");
   }
 
@@ -224,26 +585,46 @@ void Recorder::Implementation::OnMessageReceived(
   // happens when Recorder::Start is called.
   if (this->dataWriterState)
   {
-    std::vector<char> tmp(_data, _data+_len);
+    // Read the clock before waiting for the queue
+    const std::chrono::nanoseconds time = this->Now();
+
+    // The messages of the other partitions are recorded under the fully
+    // qualified name of their topic.
+    std::string qualifiedName;
+    if (this->otherPartitions.load(std::memory_order_relaxed) &&
+        !SamePartition(_info.Partition(), this->partition))
+    {
+      qualifiedName = this->RecordedName(_info.Partition(), _info.Topic());
+    }
+    const std::string &name =
+      qualifiedName.empty() ? _info.Topic() : qualifiedName;
 
     std::lock_guard<std::mutex> lock(this->dataQueueMutex);
-    // If the maxBufferSize is zero, we have an infinite queue
-    if (this->maxBufferSize > 0)
+    ++this->stats.receivedMessages;
+    this->stats.receivedBytes += _len;
+    TopicBuffer &topic = this->TopicBufferOf(name);
+    if (!this->MakeRoom(topic, _len))
     {
-      // Only pop if we have a message in the queue.
-      if ((this->bufferSize + _len > this->maxBufferSize) &&
-          !this->dataQueue.empty())
-      {
-        this->DecrementBufferSize(this->dataQueue.front().msgData.size());
-        this->dataQueue.pop_front();
-      }
+      ++topic.droppedMessages;
+      topic.droppedBytes += _len;
+      return;
     }
 
-    this->bufferSize += _len;
     // If the message being added here is larger than maxBufferSize, it should
     // still be recorded. It just means that the buffer cannot hold another
     // message until it is recorded.
-    this->dataQueue.emplace_back(this->clock->Time(), std::move(tmp), _info);
+    const uint64_t seq = this->queueBase + this->dataQueue.size();
+    this->dataQueue.emplace_back(time, _data, _len, _info, &topic);
+    if (!qualifiedName.empty())
+      this->dataQueue.back().msgInfo.SetTopic(qualifiedName);
+    this->bufferSize += _len;
+    NodeShared::Instance()->AddExternalMemory(static_cast<int64_t>(_len));
+    ++this->stats.queuedMessages;
+    this->stats.maxQueuedBytes =
+      std::max<uint64_t>(this->stats.maxQueuedBytes, this->bufferSize);
+    topic.bytes += _len;
+    topic.seqs.push_back(seq);
+    this->priorityQueues[topic.priority].push_back(seq);
     this->dataQueueCondVar.notify_one();
   }
 }
@@ -257,45 +638,92 @@ void Recorder::Implementation::OnAdvertisement(const Publisher &_publisher)
   TopicUtils::DecomposeFullyQualifiedTopic(
         _publisher.Topic(), partition, topic);
 
-  const std::string &nodePartition = this->node.Options().Partition();
-
-  // If the first character in our node's partition is a slash, then we should
-  // start our comparison from index 0 of the incoming publisher's partition.
-  // Otherwise, we should start the comparison from index 1. The incoming
-  // publisher's partition is guaranteed to begin with the forward slash.
-  const std::size_t startCmp = nodePartition[0] == '/' ? 0 : 1;
-
-  // If the advertised partition does not match ours, ignore this advertisement
-  if (strcmp(nodePartition.c_str(), partition.c_str() + startCmp) != 0)
+  // If the advertised partition isn't recorded, ignore this advertisement
+  Node *subscriber = this->NodeOf(partition);
+  if (!subscriber)
     return;
 
   // If we are already subscribed to the topic, ignore this advertisement
-  if (this->alreadySubscribed.find(topic) != this->alreadySubscribed.end())
+  const std::string name = this->RecordedName(partition, topic);
+  if (this->alreadySubscribed.find(name) != this->alreadySubscribed.end())
     return;
 
-  for (const std::regex &pattern : this->patterns)
   {
-    if (std::regex_match(topic, pattern))
+    std::lock_guard<std::mutex> lock(this->topicMutex);
+    if (this->unmatchedTopics.find(topic) != this->unmatchedTopics.end())
+      return;
+
+    // One matching pattern is enough to subscribe.
+    const bool matched = std::any_of(
+      this->patterns.begin(), this->patterns.end(),
+      [&topic](const std::regex &_pattern)
+      {
+        return std::regex_match(topic, _pattern);
+      });
+
+    if (!matched)
     {
-      this->AddTopic(topic);
+      this->unmatchedTopics.insert(topic);
+      return;
     }
   }
+
+  this->AddTopic(*subscriber, name, topic);
 }
 
 //////////////////////////////////////////////////
 RecorderError Recorder::Implementation::AddTopic(const std::string &_topic)
+{
+  RecorderError result = this->AddTopic(this->node, _topic, _topic);
+  if (result == RecorderError::FAILED_TO_SUBSCRIBE)
+    return result;
+
+  {
+    std::lock_guard<std::mutex> lock(this->topicMutex);
+    this->addedTopics.insert(_topic);
+  }
+
+  for (const auto &partitionNode : this->PartitionNodes())
+  {
+    std::string name;
+    if (!TopicUtils::FullyQualifiedName(partitionNode.first,
+          this->node.Options().NameSpace(), _topic, name))
+    {
+      LERR("Invalid topic [" << _topic << "]\n");
+      return RecorderError::INVALID_TOPIC;
+    }
+
+    const RecorderError added =
+      this->AddTopic(*partitionNode.second, name, _topic);
+    if (added == RecorderError::FAILED_TO_SUBSCRIBE)
+      return added;
+    if (added == RecorderError::SUCCESS)
+      result = added;
+  }
+
+  return result;
+}
+
+//////////////////////////////////////////////////
+RecorderError Recorder::Implementation::AddTopic(Node &_node,
+    const std::string &_name, const std::string &_topic)
 {
   // Do not subscribe to a topic if we are already subscribed.
-  if (this->alreadySubscribed.find(_topic) == this->alreadySubscribed.end())
+  if (this->alreadySubscribed.find(_name) == this->alreadySubscribed.end())
   {
-    LDBG("Recording [" << _topic << "]\n");
-    // Subscribe to the topic whether it exists or not
-    if (!this->node.SubscribeRaw(_topic, this->rawCallback))
+    LDBG("Recording [" << _name << "]\n");
+    // Subscribe to the topic whether it exists or not. The messages
+    // published within this process are tapped on the publishing thread,
+    // the buffer of the publisher is queued as is.
+    SubscribeOptions opts;
+    opts.SetTap(true);
+    if (!_node.SubscribeRaw(_topic, this->rawCallback,
+          kGenericMessageType, opts))
     {
-      LERR("Failed to subscribe to [" << _topic << "]\n");
+      LERR("Failed to subscribe to [" << _name << "]\n");
       return RecorderError::FAILED_TO_SUBSCRIBE;
     }
-    this->alreadySubscribed.insert(_topic);
+    this->alreadySubscribed.insert(_name);
     return RecorderError::SUCCESS;
   }
 
@@ -305,29 +733,146 @@ RecorderError Recorder::Implementation::AddTopic(const std::string &_topic)
 //////////////////////////////////////////////////
 int64_t Recorder::Implementation::AddTopic(const std::regex &_pattern)
 {
+  std::vector<std::pair<std::string, Node *>> nodes = this->PartitionNodes();
+  nodes.emplace_back(this->partition, &this->node);
+
   int numSubscriptions = 0;
   std::vector<std::string> allTopics;
-  this->node.TopicList(allTopics);
-  for (auto topic : allTopics)
+  for (const auto &partitionNode : nodes)
   {
-    if (std::regex_match(topic, _pattern))
+    partitionNode.second->TopicList(allTopics);
+    for (auto topic : allTopics)
     {
-      // Subscribe to the topic
-      if (this->AddTopic(topic) == RecorderError::FAILED_TO_SUBSCRIBE)
+      if (std::regex_match(topic, _pattern))
+      {
+        // Subscribe to the topic
+        const std::string name =
+          this->RecordedName(partitionNode.first, topic);
+        if (this->AddTopic(*partitionNode.second, name, topic) ==
+            RecorderError::FAILED_TO_SUBSCRIBE)
+        {
+          return static_cast<int64_t>(RecorderError::FAILED_TO_SUBSCRIBE);
+        }
+        ++numSubscriptions;
+      }
+      else
       {
-        return static_cast<int64_t>(RecorderError::FAILED_TO_SUBSCRIBE);
+        LDBG("Not recording " << topic << "\n");
       }
-      ++numSubscriptions;
     }
-    else
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(this->topicMutex);
+    this->patterns.push_back(_pattern);
+    // The new pattern might match some of the topics.
+    this->unmatchedTopics.clear();
+  }
+
+  return numSubscriptions;
+}
+
+//////////////////////////////////////////////////
+RecorderError Recorder::Implementation::AddPartition(
+    const std::string &_partition)
+{
+  if (!TopicUtils::IsValidPartition(_partition))
+  {
+    LERR("Invalid partition [" << _partition << "]\n");
+    return RecorderError::INVALID_PARTITION;
+  }
+
+  const std::string name = PartitionName(_partition);
+  if (SamePartition(name, this->partition))
+    return RecorderError::SUCCESS;
+
+  Node *subscriber;
+  std::vector<std::regex> currentPatterns;
+  std::set<std::string> currentTopics;
+  {
+    std::lock_guard<std::mutex> lock(this->topicMutex);
+    std::unique_ptr<Node> &partitionNode = this->partitionNodes[name];
+    if (partitionNode)
+      return RecorderError::SUCCESS;
+
+    // Same namespace and remappings as the node of the recorder
+    NodeOptions opts = this->node.Options();
+    opts.SetPartition(name);
+    partitionNode = std::make_unique<Node>(opts);
+    subscriber = partitionNode.get();
+    currentPatterns = this->patterns;
+    currentTopics = this->addedTopics;
+  }
+  this->otherPartitions = true;
+
+  // Subscribe to the topics already added, the topics advertised later are
+  // handled by OnAdvertisement().
+  for (const std::string &topic : currentTopics)
+  {
+    std::string qualifiedName;
+    if (TopicUtils::FullyQualifiedName(name,
+          subscriber->Options().NameSpace(), topic, qualifiedName) &&
+        this->AddTopic(*subscriber, qualifiedName, topic) ==
+          RecorderError::FAILED_TO_SUBSCRIBE)
+    {
+      return RecorderError::FAILED_TO_SUBSCRIBE;
+    }
+  }
+
+  std::vector<std::string> allTopics;
+  subscriber->TopicList(allTopics);
+  for (const std::string &topic : allTopics)
+  {
+    const bool matched = std::any_of(
+      currentPatterns.begin(), currentPatterns.end(),
+      [&topic](const std::regex &_pattern)
+      {
+        return std::regex_match(topic, _pattern);
+      });
+
+    if (matched && this->AddTopic(*subscriber,
+          this->RecordedName(name, topic), topic) ==
+        RecorderError::FAILED_TO_SUBSCRIBE)
     {
-      LDBG("Not recording " << topic << "\n");
+      return RecorderError::FAILED_TO_SUBSCRIBE;
     }
   }
 
-  this->patterns.push_back(_pattern);
+  return RecorderError::SUCCESS;
+}
 
-  return numSubscriptions;
+//////////////////////////////////////////////////
+Node *Recorder::Implementation::NodeOf(const std::string &_partition)
+{
+  if (SamePartition(_partition, this->partition))
+    return &this->node;
+
+  std::lock_guard<std::mutex> lock(this->topicMutex);
+  auto it = this->partitionNodes.find(PartitionName(_partition));
+  return it == this->partitionNodes.end() ? nullptr : it->second.get();
+}
+
+//////////////////////////////////////////////////
+std::vector<std::pair<std::string, Node *>>
+Recorder::Implementation::PartitionNodes()
+{
+  std::vector<std::pair<std::string, Node *>> nodes;
+  std::lock_guard<std::mutex> lock(this->topicMutex);
+  for (const auto &partitionNode : this->partitionNodes)
+    nodes.emplace_back(partitionNode.first, partitionNode.second.get());
+  return nodes;
+}
+
+//////////////////////////////////////////////////
+std::string Recorder::Implementation::RecordedName(
+    const std::string &_partition, const std::string &_topic) const
+{
+  if (SamePartition(_partition, this->partition))
+    return _topic;
+
+  std::string name;
+  TopicUtils::FullyQualifiedName(PartitionName(_partition), "", _topic, name);
+  return name;
 }
 
 //////////////////////////////////////////////////
@@ -350,12 +895,14 @@ void Recorder::Implementation::DataWriterThread()
       }
     }
 
-    const auto logData = std::move(this->dataQueue.front());
-    this->dataQueue.pop_front();
+    // Take all the queued messages at once, so the callbacks can keep
+    // queuing while they're written.
+    std::deque<LogData> batch;
+    this->TakeDataQueue(batch);
     // Unlock before locking another mutex.
     lock.unlock();
 
-    this->WriteToLogFile(logData);
+    this->WriteToLogFile(batch);
   }
 }
 
@@ -385,16 +932,189 @@ void Recorder::Implementation::DecrementBufferSize(std::size_t _len)
   if (this->bufferSize >= _len)
   {
     this->bufferSize -= _len;
+    NodeShared::Instance()->AddExternalMemory(-static_cast<int64_t>(_len));
   }
   else
   {
     // This shouldn't happen
     LERR("Buffer size was decremented to a value less than zero. "
         "This should not happen\n");
+    NodeShared::Instance()->AddExternalMemory(
+      -static_cast<int64_t>(this->bufferSize));
     this->bufferSize = 0;
   }
 }
 
+//////////////////////////////////////////////////
+Recorder::Implementation::TopicBuffer &
+Recorder::Implementation::TopicBufferOf(const std::string &_topic)
+{
+  auto it = this->topicBuffers.find(_topic);
+  if (it == this->topicBuffers.end())
+  {
+    it = this->topicBuffers.emplace(_topic, TopicBuffer()).first;
+    this->ApplyTopicPriority(_topic, it->second);
+    it->second.shard = this->options.TopicShard(_topic);
+  }
+  return it->second;
+}
+
+//////////////////////////////////////////////////
+void Recorder::Implementation::ApplyTopicPriority(const std::string &_name,
+    TopicBuffer &_topic)
+{
+  _topic.priority = 0;
+  _topic.quota = 0;
+  for (const TopicPriority &priority : this->priorities)
+  {
+    if (std::regex_match(_name, priority.pattern))
+    {
+      _topic.priority = priority.priority;
+      _topic.quota = priority.quota;
+      return;
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+bool Recorder::Implementation::MakeRoom(TopicBuffer &_topic, std::size_t _len)
+{
+  // A topic over its quota drops its own oldest messages, even if the
+  // buffer isn't full.
+  if (_topic.quota > 0)
+  {
+    while (_topic.bytes + _len > _topic.quota && this->DropOldest(_topic.seqs))
+    {
+    }
+  }
+
+  // The buffer is bounded by maxBufferSize, unless it is zero, and by the
+  // memory cap of the transport.
+  const NodeShared *shared = NodeShared::Instance();
+  auto full = [&]()
+  {
+    return (this->maxBufferSize > 0 &&
+            this->bufferSize + _len > this->maxBufferSize) ||
+           shared->MemoryCapExceeded(_len);
+  };
+
+  while (full())
+  {
+    // Find the lowest priority with buffered messages.
+    auto victims = this->priorityQueues.begin();
+    while (victims != this->priorityQueues.end())
+    {
+      this->PruneSeqs(victims->second);
+      if (!victims->second.empty())
+        break;
+      victims = this->priorityQueues.erase(victims);
+    }
+
+    // The buffer is empty, the message is recorded whatever its size.
+    if (victims == this->priorityQueues.end())
+      return true;
+
+    // Never drop a message to make room for a less important one.
+    if (victims->first > _topic.priority)
+      return false;
+
+    this->DropOldest(victims->second);
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+void Recorder::Implementation::PruneSeqs(std::deque<uint64_t> &_seqs)
+{
+  while (!_seqs.empty() && (_seqs.front() < this->queueBase ||
+         this->dataQueue[_seqs.front() - this->queueBase].dropped))
+  {
+    _seqs.pop_front();
+  }
+}
+
+//////////////////////////////////////////////////
+bool Recorder::Implementation::DropOldest(std::deque<uint64_t> &_seqs)
+{
+  this->PruneSeqs(_seqs);
+  if (_seqs.empty())
+    return false;
+
+  LogData &logData = this->dataQueue[_seqs.front() - this->queueBase];
+  _seqs.pop_front();
+
+  logData.dropped = true;
+  logData.msgData.reset();
+  this->DecrementBufferSize(logData.msgSize);
+  --this->stats.queuedMessages;
+  logData.topic->bytes -= logData.msgSize;
+  ++logData.topic->droppedMessages;
+  logData.topic->droppedBytes += logData.msgSize;
+
+  // There is no need to keep the dropped messages at the front of the queue.
+  while (!this->dataQueue.empty() && this->dataQueue.front().dropped)
+  {
+    this->dataQueue.pop_front();
+    ++this->queueBase;
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+void Recorder::Implementation::TakeDataQueue(std::deque<LogData> &_batch)
+{
+  _batch.clear();
+  _batch.swap(this->dataQueue);
+  this->queueBase += _batch.size();
+  for (const auto &logData : _batch)
+  {
+    if (!logData.dropped)
+      this->DecrementBufferSize(logData.msgSize);
+  }
+
+  // None of the messages are in the buffer anymore.
+  this->stats.queuedMessages = 0;
+  for (auto &topic : this->topicBuffers)
+  {
+    topic.second.bytes = 0;
+    topic.second.seqs.clear();
+  }
+  this->priorityQueues.clear();
+}
+
+//////////////////////////////////////////////////
+void Recorder::Implementation::WriteDropCounters()
+{
+  // The counters of all the shards are stored in the first one.
+  Log *logFile = this->shards.empty() ? nullptr :
+    this->shards.front()->logFile.get();
+
+  uint64_t total = 0;
+  for (const auto &topic : this->topicBuffers)
+  {
+    if (topic.second.droppedMessages == 0)
+      continue;
+
+    total += topic.second.droppedMessages;
+    LWRN("Dropped " << topic.second.droppedMessages << " messages ("
+         << topic.second.droppedBytes << " bytes) of [" << topic.first
+         << "] because the buffer was full\n");
+
+    if (logFile)
+    {
+      logFile->SetMetadata("dropped_messages:" + topic.first,
+          std::to_string(topic.second.droppedMessages));
+      logFile->SetMetadata("dropped_bytes:" + topic.first,
+          std::to_string(topic.second.droppedBytes));
+    }
+  }
+
+  // The chunked format has no metadata, the counters are only reported
+  // above and by Recorder::DroppedMessages().
+  if (logFile)
+    logFile->SetMetadata("dropped_messages", std::to_string(total));
+}
+
 //////////////////////////////////////////////////
 void Recorder::Implementation::FlushDataQueue()
 {
@@ -404,36 +1124,263 @@ void Recorder::Implementation::FlushDataQueue()
     if (this->dataQueue.empty())
       return;
 
-    const auto logData = std::move(this->dataQueue.front());
-    this->dataQueue.pop_front();
+    std::deque<LogData> batch;
+    this->TakeDataQueue(batch);
     // Unlock before locking another mutex.
     lock.unlock();
 
-    this->WriteToLogFile(logData);
+    this->WriteToLogFile(batch);
   }
 }
 
 //////////////////////////////////////////////////
-void Recorder::Implementation::WriteToLogFile(const LogData &_logData)
+void Recorder::Implementation::WriteToLogFile(
+  const std::deque<LogData> &_batch)
 {
   std::lock_guard<std::mutex> logLock(this->logFileMutex);
-  // Note: this->logFile will only be a nullptr before Start() has been
-  // called or after Stop() has been called. If it is a nullptr, then we are
-  // not recording anything yet, so we can just skip inserting the message.
-  if (this->logFile &&
-      !this->logFile->InsertMessage(
-        _logData.stamp, _logData.msgInfo.Topic(), _logData.msgInfo.Type(),
-        reinterpret_cast<const void *>(_logData.msgData.data()),
-        _logData.msgData.size()))
+  // Note: there will only be no shards before Start() has been called or
+  // after Stop() has been called. Then we are not recording anything yet,
+  // so we can just skip inserting the message.
+  if (!this->Recording())
+    return;
+
+  const auto writeStart = std::chrono::steady_clock::now();
+  uint64_t messages = 0;
+  uint64_t bytes = 0;
+
+  for (auto &shard : this->shards)
+    shard->records.clear();
+
+  for (const auto &logData : _batch)
   {
-    LWRN("Failed to insert message into log file\n");
+    if (logData.dropped)
+      continue;
+
+    ++messages;
+    bytes += logData.msgSize;
+
+    this->shards[logData.shard]->records.push_back({logData.stamp,
+      &logData.msgInfo.Topic(), &logData.msgInfo.Type(),
+      reinterpret_cast<const void *>(logData.msgData.get()),
+      logData.msgSize});
+  }
+
+  // A shard rolls over before writing, so an idle shard doesn't create
+  // empty log files. The messages wait in the buffer in the meantime.
+  for (auto &shard : this->shards)
+  {
+    if (!shard->records.empty() && this->RotationDue(*shard))
+      this->Rotate(*shard);
+  }
+
+  // The shards are written in parallel, the first one by this thread.
+  for (std::size_t i = 1; i < this->shards.size(); ++i)
+  {
+    Shard &shard = *this->shards[i];
+    if (shard.records.empty())
+      continue;
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.pending = true;
+    shard.condVar.notify_one();
+  }
+
+  InsertRecords(*this->shards.front());
+
+  // Wait for the other shards, the records point to the messages of _batch.
+  for (std::size_t i = 1; i < this->shards.size(); ++i)
+  {
+    Shard &shard = *this->shards[i];
+    std::unique_lock<std::mutex> lock(shard.mutex);
+    shard.condVar.wait(lock, [&shard] { return !shard.pending; });
   }
+
+  this->CountWrite(messages, bytes,
+    std::chrono::steady_clock::now() - writeStart);
+
   // TODO(anyone) It would be nice for testing to simulate long delays
   // associated with disk writes. In the mean time, a sleep can be added here
   // for testing.
   // std::this_thread::sleep_for(std::chrono::milliseconds(30));
 }
 
+//////////////////////////////////////////////////
+void Recorder::Implementation::CountWrite(uint64_t _messages,
+    uint64_t _bytes, const std::chrono::nanoseconds &_duration)
+{
+  std::lock_guard<std::mutex> lock(this->statsMutex);
+  this->stats.writtenMessages += _messages;
+  this->stats.writtenBytes += _bytes;
+  ++this->stats.writes;
+  this->stats.writeDuration += _duration;
+  this->stats.maxWriteDuration =
+    std::max(this->stats.maxWriteDuration, _duration);
+
+  // Index of the power of 2 above the duration in microseconds.
+  auto &histogram = this->stats.writeDurationHistogram;
+  uint64_t us = static_cast<uint64_t>(
+    std::chrono::duration_cast<std::chrono::microseconds>(_duration).count());
+  std::size_t bucket = 0;
+  while (us > 0u && bucket + 1u < histogram.size())
+  {
+    us >>= 1;
+    ++bucket;
+  }
+  ++histogram[bucket];
+}
+
+//////////////////////////////////////////////////
+std::unique_ptr<Recorder::Implementation::Shard>
+Recorder::Implementation::OpenShard(const std::string &_file,
+    const LogOptions &_options)
+{
+  std::unique_ptr<Shard> shard(new Shard());
+  shard->file = _file;
+  shard->opened = std::chrono::steady_clock::now();
+  if (_options.Format() == LogFormat::CHUNKED)
+  {
+    // Like a SQLite log, don't record over an existing file. A chunked log
+    // would be appended to it.
+    std::error_code ec;
+    if (std::filesystem::exists(_file, ec))
+    {
+      LERR("Failed to create file [" << _file << "]: it already exists\n");
+      return nullptr;
+    }
+
+    shard->chunkedLogFile.reset(new ChunkedLog());
+    if (!shard->chunkedLogFile->Open(_file, std::ios_base::out, _options))
+    {
+      LERR("Failed to open or create file [" << _file << "]\n");
+      return nullptr;
+    }
+  }
+  else
+  {
+    shard->logFile.reset(new Log());
+    if (!shard->logFile->Open(_file, std::ios_base::out, _options))
+    {
+      LERR("Failed to open or create file [" << _file << "]\n");
+      return nullptr;
+    }
+  }
+  return shard;
+}
+
+//////////////////////////////////////////////////
+void Recorder::Implementation::InsertRecords(Shard &_shard)
+{
+  if (_shard.records.empty())
+    return;
+
+  for (const MessageRecord &record : _shard.records)
+    _shard.bytes += record.len;
+
+  const std::size_t inserted = _shard.logFile ?
+    _shard.logFile->InsertMessages(_shard.records) :
+    _shard.chunkedLogFile->InsertMessages(_shard.records);
+  if (inserted < _shard.records.size())
+  {
+    LWRN("Failed to insert " << _shard.records.size() - inserted
+         << " messages into log file\n");
+  }
+}
+
+//////////////////////////////////////////////////
+void Recorder::Implementation::ShardWriterThread(Shard *_shard)
+{
+  std::unique_lock<std::mutex> lock(_shard->mutex);
+  while (true)
+  {
+    _shard->condVar.wait(lock,
+      [_shard] { return _shard->pending || _shard->stop; });
+    if (!_shard->pending)
+      return;
+
+    // The records don't change until the write is reported as done.
+    lock.unlock();
+    InsertRecords(*_shard);
+    lock.lock();
+
+    _shard->pending = false;
+    _shard->condVar.notify_all();
+  }
+}
+
+//////////////////////////////////////////////////
+void Recorder::Implementation::StopShardWriters()
+{
+  for (auto &shard : this->shards)
+  {
+    {
+      std::lock_guard<std::mutex> lock(shard->mutex);
+      shard->stop = true;
+      shard->condVar.notify_all();
+    }
+    if (shard->writer.joinable())
+      shard->writer.join();
+  }
+}
+
+//////////////////////////////////////////////////
+bool Recorder::Implementation::RotationDue(const Shard &_shard) const
+{
+  const auto period = this->options.RotationPeriod();
+  if (period > std::chrono::milliseconds::zero() &&
+      std::chrono::steady_clock::now() - _shard.opened >= period)
+  {
+    return true;
+  }
+
+  const uint64_t bytes = this->options.RotationBytes();
+  return bytes > 0u && _shard.bytes >= bytes;
+}
+
+//////////////////////////////////////////////////
+void Recorder::Implementation::Rotate(Shard &_shard)
+{
+  const std::string file = ShardFilename(this->filename, this->files.size());
+  std::unique_ptr<Shard> next = OpenShard(file, this->options);
+  if (!next)
+  {
+    // Try again after another period.
+    LWRN("Failed to roll over, recording continues in [" << _shard.file
+         << "]\n");
+    _shard.opened = std::chrono::steady_clock::now();
+    _shard.bytes = 0;
+    return;
+  }
+
+  // The new file is listed before the messages are written to it, and the
+  // previous file is finished when it's closed.
+  this->files.push_back(file);
+  if (!WriteShardSet(this->filename, this->files))
+    LWRN("Failed to add [" << file << "] to [" << this->filename << "]\n");
+
+  const std::string finished = _shard.file;
+  _shard.logFile = std::move(next->logFile);
+  _shard.chunkedLogFile = std::move(next->chunkedLogFile);
+  _shard.file = next->file;
+  _shard.opened = next->opened;
+  _shard.bytes = 0;
+
+  LDBG("Rolled over from [" << finished << "] to [" << file << "]\n");
+  this->FileFinished(finished);
+}
+
+//////////////////////////////////////////////////
+void Recorder::Implementation::FileFinished(const std::string &_file) const
+{
+  if (this->fileFinishedCallback)
+    this->fileFinishedCallback(_file);
+}
+
+//////////////////////////////////////////////////
+bool Recorder::Implementation::Recording() const
+{
+  return !this->shards.empty();
+}
+
 //////////////////////////////////////////////////
 Recorder::Recorder()
   : dataPtr(new Implementation)
@@ -457,7 +1404,7 @@ Recorder::~Recorder()
 
 //////////////////////////////////////////////////
 RecorderError Recorder::Sync(const Clock *_clockIn) {
-  if (this->dataPtr->logFile)
+  if (this->dataPtr->Recording())
   {
     LERR("Recording is already in progress\n");
     return RecorderError::ALREADY_RECORDING;
@@ -466,24 +1413,107 @@ RecorderError Recorder::Sync(const Clock *_clockIn) {
   return RecorderError::SUCCESS;
 }
 
+//////////////////////////////////////////////////
+RecorderError Recorder::SetTimestampResolution(
+    const std::chrono::nanoseconds &_resolution)
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->logFileMutex);
+  if (this->dataPtr->Recording())
+  {
+    LERR("Recording is already in progress\n");
+    return RecorderError::ALREADY_RECORDING;
+  }
+  this->dataPtr->timestampResolution =
+    std::max(_resolution, std::chrono::nanoseconds::zero());
+  return RecorderError::SUCCESS;
+}
+
+//////////////////////////////////////////////////
+std::chrono::nanoseconds Recorder::TimestampResolution() const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->logFileMutex);
+  return this->dataPtr->timestampResolution;
+}
+
 //////////////////////////////////////////////////
 RecorderError Recorder::Start(const std::string &_file)
+{
+  return this->Start(_file, LogOptions());
+}
+
+//////////////////////////////////////////////////
+RecorderError Recorder::Start(const std::string &_file,
+    const LogOptions &_options)
 {
   std::lock_guard<std::mutex> lock(this->dataPtr->logFileMutex);
-  if (this->dataPtr->logFile)
+  if (this->dataPtr->Recording())
   {
     LWRN("Recording is already in progress\n");
     return RecorderError::ALREADY_RECORDING;
   }
 
-  this->dataPtr->logFile.reset(new Log());
-  if (!this->dataPtr->logFile->Open(_file, std::ios_base::out))
   {
-    LERR("Failed to open or create file [" << _file << "]\n");
-    this->dataPtr->logFile.reset(nullptr);
-    return RecorderError::FAILED_TO_OPEN;
+    // The drop counters are reset for every recording. The messages are
+    // routed to their shard as soon as the first one is open.
+    std::lock_guard<std::mutex> queueLock(this->dataPtr->dataQueueMutex);
+    std::lock_guard<std::mutex> statsLock(this->dataPtr->statsMutex);
+    this->dataPtr->topicBuffers.clear();
+    this->dataPtr->priorityQueues.clear();
+    this->dataPtr->options = _options;
+    this->dataPtr->stats = RecorderStatistics();
+  }
+
+  const bool rotation =
+    _options.RotationPeriod() > std::chrono::milliseconds::zero() ||
+    _options.RotationBytes() > 0u;
+  if (_options.ShardCount() == 1u && !rotation)
+  {
+    std::unique_ptr<Implementation::Shard> shard =
+      Implementation::OpenShard(_file, _options);
+    if (!shard)
+      return RecorderError::FAILED_TO_OPEN;
+    this->dataPtr->shards.push_back(std::move(shard));
+  }
+  else
+  {
+    std::error_code ec;
+    if (std::filesystem::exists(_file, ec))
+    {
+      LERR("Failed to create file [" << _file << "]: it already exists\n");
+      return RecorderError::FAILED_TO_OPEN;
+    }
+
+    std::vector<std::string> files;
+    for (std::size_t i = 0; i < _options.ShardCount(); ++i)
+    {
+      files.push_back(ShardFilename(_file, i));
+      std::unique_ptr<Implementation::Shard> shard =
+        Implementation::OpenShard(files.back(), _options);
+      if (!shard)
+      {
+        this->dataPtr->shards.clear();
+        return RecorderError::FAILED_TO_OPEN;
+      }
+      this->dataPtr->shards.push_back(std::move(shard));
+    }
+
+    if (!WriteShardSet(_file, files))
+    {
+      this->dataPtr->shards.clear();
+      return RecorderError::FAILED_TO_OPEN;
+    }
+    this->dataPtr->files = files;
+
+    for (std::size_t i = 1; i < this->dataPtr->shards.size(); ++i)
+    {
+      Implementation::Shard *shard = this->dataPtr->shards[i].get();
+      shard->writer =
+        std::thread(&Implementation::ShardWriterThread, shard);
+    }
   }
+  this->dataPtr->filename = _file;
 
+  this->dataPtr->StartTimestampTimer();
   this->dataPtr->StartDataWriter();
   LMSG("Started recording to [" << _file << "]\n");
 
@@ -495,19 +1525,33 @@ void Recorder::Stop()
 {
   {
     std::lock_guard<std::mutex> lock(this->dataPtr->logFileMutex);
-    // If the logFile is null, the recorder has already stopped.
-    if (nullptr == this->dataPtr->logFile)
+    // If there are no shards, the recorder has already stopped.
+    if (!this->dataPtr->Recording())
       return;
   }
   this->dataPtr->stopQueue = true;
   this->dataPtr->StopDataWriter();
+  this->dataPtr->StopTimestampTimer();
   // If there is any data left in the dataQueue, write it all to disk
   LMSG("Log Recorder finalizing log file. This might take some time...");
   this->dataPtr->FlushDataQueue();
   LMSG("Done\n");
 
   std::lock_guard<std::mutex> lock(this->dataPtr->logFileMutex);
-  this->dataPtr->logFile.reset(nullptr);
+  this->dataPtr->StopShardWriters();
+  {
+    std::lock_guard<std::mutex> queueLock(this->dataPtr->dataQueueMutex);
+    this->dataPtr->WriteDropCounters();
+  }
+  std::vector<std::string> finished;
+  for (const auto &shard : this->dataPtr->shards)
+    finished.push_back(shard->file);
+  this->dataPtr->shards.clear();
+  this->dataPtr->filename.clear();
+  this->dataPtr->files.clear();
+
+  for (const std::string &file : finished)
+    this->dataPtr->FileFinished(file);
 }
 
 //////////////////////////////////////////////////
@@ -522,11 +1566,16 @@ int64_t Recorder::AddTopic(const std::regex &_topic)
   return this->dataPtr->AddTopic(_topic);
 }
 
+//////////////////////////////////////////////////
+RecorderError Recorder::AddPartition(const std::string &_partition)
+{
+  return this->dataPtr->AddPartition(_partition);
+}
+
 //////////////////////////////////////////////////
 std::string Recorder::Filename() const
 {
-  return this->dataPtr->logFile == nullptr ? "" :
-         this->dataPtr->logFile->Filename();
+  return this->dataPtr->filename;
 }
 
 //////////////////////////////////////////////////
@@ -548,3 +1597,65 @@ void Recorder::SetBufferSize(std::size_t _size)
   // Shift by 20 to convert to bytes
   this->dataPtr->maxBufferSize = _size << 20;
 }
+
+//////////////////////////////////////////////////
+void Recorder::AddTopicPriority(const std::regex &_topics,
+    const int _priority, const std::size_t _quota)
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->dataQueueMutex);
+  this->dataPtr->priorities.push_back({_topics, _priority, _quota});
+
+  // The topics already received might match the new pattern.
+  for (auto &topic : this->dataPtr->topicBuffers)
+    this->dataPtr->ApplyTopicPriority(topic.first, topic.second);
+}
+
+//////////////////////////////////////////////////
+void Recorder::SetFileFinishedCallback(
+    const std::function<void(const std::string &_file)> &_callback)
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->logFileMutex);
+  this->dataPtr->fileFinishedCallback = _callback;
+}
+
+//////////////////////////////////////////////////
+RecorderStatistics Recorder::Statistics() const
+{
+  RecorderStatistics stats;
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->statsMutex);
+    const RecorderStatistics &written = this->dataPtr->stats;
+    stats.writtenMessages = written.writtenMessages;
+    stats.writtenBytes = written.writtenBytes;
+    stats.writes = written.writes;
+    stats.writeDuration = written.writeDuration;
+    stats.maxWriteDuration = written.maxWriteDuration;
+    stats.writeDurationHistogram = written.writeDurationHistogram;
+  }
+
+  std::lock_guard<std::mutex> lock(this->dataPtr->dataQueueMutex);
+  stats.receivedMessages = this->dataPtr->stats.receivedMessages;
+  stats.receivedBytes = this->dataPtr->stats.receivedBytes;
+  stats.queuedMessages = this->dataPtr->stats.queuedMessages;
+  stats.queuedBytes = this->dataPtr->bufferSize;
+  stats.maxQueuedBytes = this->dataPtr->stats.maxQueuedBytes;
+  for (const auto &topic : this->dataPtr->topicBuffers)
+  {
+    stats.droppedMessages += topic.second.droppedMessages;
+    stats.droppedBytes += topic.second.droppedBytes;
+  }
+  return stats;
+}
+
+//////////////////////////////////////////////////
+std::map<std::string, uint64_t> Recorder::DroppedMessages() const
+{
+  std::map<std::string, uint64_t> dropped;
+  std::lock_guard<std::mutex> lock(this->dataPtr->dataQueueMutex);
+  for (const auto &topic : this->dataPtr->topicBuffers)
+  {
+    if (topic.second.droppedMessages > 0)
+      dropped[topic.first] = topic.second.droppedMessages;
+  }
+  return dropped;
+}
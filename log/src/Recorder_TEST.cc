@@ -89,6 +89,36 @@ TEST(Record, AddTopicRegex)
   EXPECT_EQ(0, recorder.AddTopic(std::regex("////")));
 }
 
+//////////////////////////////////////////////////
+TEST(Record, AddPartition)
+{
+  transport::log::Recorder recorder;
+  EXPECT_EQ(transport::log::RecorderError::SUCCESS,
+      recorder.AddTopic(std::string("/foo")));
+  EXPECT_EQ(transport::log::RecorderError::INVALID_PARTITION,
+      recorder.AddPartition("bad@partition"));
+
+  // The topics already added are subscribed in the new partition, with
+  // their fully qualified name.
+  EXPECT_EQ(transport::log::RecorderError::SUCCESS,
+      recorder.AddPartition("robot2"));
+  EXPECT_EQ(transport::log::RecorderError::SUCCESS,
+      recorder.AddPartition("/robot2"));
+  EXPECT_EQ(2u, recorder.Topics().size());
+  EXPECT_NE(recorder.Topics().end(), recorder.Topics().find("/foo"));
+  EXPECT_NE(recorder.Topics().end(),
+      recorder.Topics().find("@/robot2@/foo"));
+
+  // The topics added later are subscribed in every partition.
+  EXPECT_EQ(transport::log::RecorderError::SUCCESS,
+      recorder.AddTopic(std::string("/bar")));
+  EXPECT_EQ(transport::log::RecorderError::ALREADY_SUBSCRIBED_TO_TOPIC,
+      recorder.AddTopic(std::string("/bar")));
+  EXPECT_EQ(4u, recorder.Topics().size());
+  EXPECT_NE(recorder.Topics().end(),
+      recorder.Topics().find("@/robot2@/bar"));
+}
+
 //////////////////////////////////////////////////
 TEST(Record, SetBufferSize)
 {
@@ -102,3 +132,58 @@ TEST(Record, SetBufferSize)
   recorder.SetBufferSize(40);
   EXPECT_EQ(40u, recorder.BufferSize());
 }
+
+//////////////////////////////////////////////////
+TEST(Record, SetTimestampResolution)
+{
+  transport::log::Recorder recorder;
+  EXPECT_EQ(0, recorder.TimestampResolution().count());
+
+  EXPECT_EQ(transport::log::RecorderError::SUCCESS,
+      recorder.SetTimestampResolution(std::chrono::milliseconds(1)));
+  EXPECT_EQ(std::chrono::milliseconds(1), recorder.TimestampResolution());
+
+  EXPECT_EQ(transport::log::RecorderError::SUCCESS,
+      recorder.SetTimestampResolution(std::chrono::milliseconds(-1)));
+  EXPECT_EQ(0, recorder.TimestampResolution().count());
+
+  EXPECT_EQ(transport::log::RecorderError::SUCCESS,
+      recorder.SetTimestampResolution(std::chrono::milliseconds(5)));
+  EXPECT_EQ(transport::log::RecorderError::SUCCESS,
+      recorder.Start(":memory:"));
+  EXPECT_EQ(transport::log::RecorderError::ALREADY_RECORDING,
+      recorder.SetTimestampResolution(std::chrono::milliseconds(1)));
+  EXPECT_EQ(std::chrono::milliseconds(5), recorder.TimestampResolution());
+  recorder.Stop();
+}
+
+//////////////////////////////////////////////////
+TEST(Record, AddTopicPriority)
+{
+  transport::log::Recorder recorder;
+  recorder.AddTopicPriority(std::regex("/clock"), 10);
+  recorder.AddTopicPriority(std::regex("/camera/.*"), -1, 1000);
+  EXPECT_TRUE(recorder.DroppedMessages().empty());
+
+  EXPECT_EQ(transport::log::RecorderError::SUCCESS,
+      recorder.Start(":memory:"));
+  EXPECT_TRUE(recorder.DroppedMessages().empty());
+  recorder.Stop();
+}
+
+//////////////////////////////////////////////////
+TEST(Record, Statistics)
+{
+  transport::log::Recorder recorder;
+  transport::log::RecorderStatistics stats = recorder.Statistics();
+  EXPECT_EQ(0u, stats.receivedMessages);
+  EXPECT_EQ(0u, stats.writes);
+
+  EXPECT_EQ(transport::log::RecorderError::SUCCESS,
+      recorder.Start(":memory:"));
+  stats = recorder.Statistics();
+  EXPECT_EQ(0u, stats.receivedMessages);
+  EXPECT_EQ(0u, stats.droppedMessages);
+  EXPECT_EQ(0u, stats.queuedBytes);
+  recorder.Stop();
+}
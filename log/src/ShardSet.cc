@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "gz/transport/log/ShardSet.hh"
+#include "Console.hh"
+
+using namespace gz::transport;
+using namespace gz::transport::log;
+
+/// \brief First line of a shard set file.
+static const char kShardSetHeader[] = "gz-transport-log-shards 1";
+
+//////////////////////////////////////////////////
+bool log::IsShardSet(const std::string &_file)
+{
+  std::ifstream fin(_file, std::ios_base::in | std::ios_base::binary);
+  std::string header;
+  return fin && std::getline(fin, header) && header == kShardSetHeader;
+}
+
+//////////////////////////////////////////////////
+bool log::ReadShardSet(const std::string &_file,
+    std::vector<std::string> &_shards)
+{
+  _shards.clear();
+  std::ifstream fin(_file, std::ios_base::in);
+  std::string line;
+  if (!fin || !std::getline(fin, line) || line != kShardSetHeader)
+  {
+    LERR("[" << _file << "] is not a shard set file\n");
+    return false;
+  }
+
+  const std::filesystem::path dir =
+    std::filesystem::path(_file).parent_path();
+  while (std::getline(fin, line))
+  {
+    // Tolerate the files edited on Windows.
+    if (!line.empty() && line.back() == '\r')
+      line.pop_back();
+    if (line.empty())
+      continue;
+    _shards.push_back((dir / line).string());
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool log::WriteShardSet(const std::string &_file,
+    const std::vector<std::string> &_shards)
+{
+  const std::filesystem::path path(_file);
+  const std::filesystem::path dir = path.parent_path();
+  const std::string tmpFile = _file + ".tmp";
+  {
+    std::ofstream fout(tmpFile, std::ios_base::out | std::ios_base::trunc);
+    if (!fout)
+    {
+      LERR("Failed to create shard set file [" << tmpFile << "]\n");
+      return false;
+    }
+
+    fout << kShardSetHeader << "\n";
+    for (const std::string &shard : _shards)
+    {
+      const std::filesystem::path shardPath(shard);
+      fout << (dir.empty() ? shardPath :
+        shardPath.lexically_relative(dir)).generic_string() << "\n";
+    }
+
+    if (!fout.flush())
+    {
+      LERR("Failed to write shard set file [" << tmpFile << "]\n");
+      return false;
+    }
+  }
+
+  std::error_code ec;
+  std::filesystem::rename(tmpFile, path, ec);
+  if (ec)
+  {
+    LERR("Failed to write shard set file [" << _file << "]: "
+         << ec.message() << "\n");
+    std::filesystem::remove(tmpFile, ec);
+    return false;
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+std::string log::ShardFilename(const std::string &_file,
+    const std::size_t _index)
+{
+  std::filesystem::path path(_file);
+  path.replace_filename(path.stem().string() + "." + std::to_string(_index) +
+    path.extension().string());
+  return path.string();
+}
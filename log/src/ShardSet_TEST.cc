@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include "gtest/gtest.h"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "gz/transport/log/ShardSet.hh"
+
+#include "test_utils.hh"
+
+using namespace gz;
+using namespace gz::transport;
+
+//////////////////////////////////////////////////
+TEST(ShardSet, Filename)
+{
+  EXPECT_EQ("run.1.tlog", log::ShardFilename("run.tlog", 1));
+  EXPECT_EQ("run.0", log::ShardFilename("run", 0));
+  EXPECT_EQ((std::filesystem::path("dir") / "run.2.tlog").string(),
+    log::ShardFilename((std::filesystem::path("dir") / "run.tlog").string(),
+      2));
+}
+
+//////////////////////////////////////////////////
+TEST(ShardSet, WriteRead)
+{
+  const std::filesystem::path dir = std::filesystem::temp_directory_path() /
+    ("gz_shards_" + testing::getRandomNumber());
+  ASSERT_TRUE(std::filesystem::create_directory(dir));
+  const std::string file = (dir / "run.tlog").string();
+
+  EXPECT_FALSE(log::IsShardSet(file));
+  std::vector<std::string> shards;
+  EXPECT_FALSE(log::ReadShardSet(file, shards));
+
+  const std::vector<std::string> written = {
+    log::ShardFilename(file, 0), log::ShardFilename(file, 1)};
+  ASSERT_TRUE(log::WriteShardSet(file, written));
+  EXPECT_TRUE(log::IsShardSet(file));
+
+  // The shards are stored relative to the shard set file.
+  {
+    std::ifstream fin(file);
+    std::string line;
+    std::getline(fin, line);
+    std::getline(fin, line);
+    EXPECT_EQ("run.0.tlog", line);
+  }
+
+  ASSERT_TRUE(log::ReadShardSet(file, shards));
+  ASSERT_EQ(2u, shards.size());
+  EXPECT_TRUE(std::filesystem::equivalent(dir,
+    std::filesystem::path(shards[0]).parent_path()));
+  EXPECT_EQ("run.0.tlog",
+    std::filesystem::path(shards[0]).filename().string());
+  EXPECT_EQ("run.1.tlog",
+    std::filesystem::path(shards[1]).filename().string());
+
+  // Any other file isn't a shard set.
+  {
+    std::ofstream fout(file, std::ios_base::trunc);
+    fout << "SQLite format 3";
+  }
+  EXPECT_FALSE(log::IsShardSet(file));
+
+  std::filesystem::remove_all(dir);
+}
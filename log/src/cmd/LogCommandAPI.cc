@@ -17,12 +17,20 @@
 
 #include "LogCommandAPI.hh"
 
+#include <chrono>
+#include <cmath>
 #include <csignal>
 #include <iostream>
 #include <regex>
+#include <sstream>
 #include <string>
+#include <vector>
 
+#include <gz/transport/log/ChunkedLog.hh>
+#include <gz/transport/log/ColumnExport.hh>
 #include <gz/transport/log/Export.hh>
+#include <gz/transport/log/Log.hh>
+#include <gz/transport/log/LogOptions.hh>
 #include <gz/transport/log/Playback.hh>
 #include <gz/transport/log/Recorder.hh>
 #include <gz/transport/Node.hh>
@@ -112,6 +120,13 @@ int playbackTopics(const char *_file, const char *_pattern, const int _wait_ms,
       return INVALID_REMAP;
   }
 
+  if (transport::log::ChunkedLog::IsChunkedLog(_file))
+  {
+    LERR("[" << _file << "] is a chunked log. Convert it with "
+         << "`gz log convert` to play it back\n");
+    return FAILED_TO_OPEN;
+  }
+
   transport::log::Playback player(_file, nodeOptions);
   if (!player.Valid())
     return FAILED_TO_OPEN;
@@ -137,3 +152,268 @@ int playbackTopics(const char *_file, const char *_pattern, const int _wait_ms,
   LDBG("Shutting down\n");
   return SUCCESS;
 }
+
+//////////////////////////////////////////////////
+int convertLog(const char *_src, const char *_dst, const char *_format,
+  const char *_compression)
+{
+  transport::log::LogOptions options;
+  const std::string format = _format;
+  if (format == "chunked" ||
+      (format.empty() && !transport::log::ChunkedLog::IsChunkedLog(_src)))
+  {
+    options.SetFormat(transport::log::LogFormat::CHUNKED);
+  }
+  else if (format != "sqlite" && !format.empty())
+  {
+    LERR("Invalid format [" << format << "]\n");
+    return FAILED_TO_CONVERT;
+  }
+
+  const std::string compression = _compression;
+  transport::Compression_t codec = transport::Compression_t::NONE;
+  if (compression == "lz4")
+    codec = transport::Compression_t::LZ4;
+  else if (compression == "zstd")
+    codec = transport::Compression_t::ZSTD;
+  else if (compression != "none" && !compression.empty())
+  {
+    LERR("Invalid compression [" << compression << "]\n");
+    return FAILED_TO_CONVERT;
+  }
+
+  if (options.Format() == transport::log::LogFormat::CHUNKED)
+  {
+    if (!options.SetChunkCompression(codec))
+      return FAILED_TO_CONVERT;
+  }
+  else if (!options.AddTopicCompression(std::regex(".*"), codec))
+  {
+    return FAILED_TO_CONVERT;
+  }
+
+  if (!transport::log::ConvertLog(_src, _dst, options))
+    return FAILED_TO_CONVERT;
+
+  return SUCCESS;
+}
+
+//////////////////////////////////////////////////
+int reindexLog(const char *_file)
+{
+  if (!transport::log::ReindexLog(_file))
+    return FAILED_TO_REINDEX;
+
+  return SUCCESS;
+}
+
+//////////////////////////////////////////////////
+int exportLog(const char *_file, const char *_output, const char *_pattern,
+    int _threads)
+{
+  std::regex regexPattern;
+  try
+  {
+    regexPattern = _pattern;
+  }
+  catch (const std::regex_error &e)
+  {
+    LERR("Regex pattern is invalid\n");
+    return BAD_REGEX;
+  }
+
+  if (_threads < 0 ||
+      !transport::log::ExportColumns(_file, _output, regexPattern,
+          static_cast<unsigned int>(_threads)))
+  {
+    return FAILED_TO_EXPORT;
+  }
+
+  return SUCCESS;
+}
+
+//////////////////////////////////////////////////
+/// \brief Get a range of time from the first message of a log.
+/// \param[in] _first Time of the first message.
+/// \param[in] _start Beginning of the range (seconds from _first), or a
+/// negative value for no beginning.
+/// \param[in] _end End of the range (seconds from _first), or a negative
+/// value for no end.
+/// \return The range.
+static transport::log::QualifiedTimeRange TimeRange(
+    const std::chrono::nanoseconds &_first, double _start, double _end)
+{
+  using Qualified = transport::log::QualifiedTime;
+  auto since = [&_first](double _seconds)
+  {
+    return _first + std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::duration<double>(_seconds));
+  };
+  return transport::log::QualifiedTimeRange(
+      _start < 0 ? Qualified() : Qualified(since(_start)),
+      _end < 0 ? Qualified() : Qualified(since(_end)));
+}
+
+//////////////////////////////////////////////////
+/// \brief Get a duration in seconds, to print it.
+/// \param[in] _duration The duration.
+/// \return The duration (seconds).
+static double Seconds(const std::chrono::nanoseconds &_duration)
+{
+  return std::chrono::duration<double>(_duration).count();
+}
+
+//////////////////////////////////////////////////
+int cutLog(const char *_src, const char *_dst, double _start, double _end)
+{
+  if (transport::log::ChunkedLog::IsChunkedLog(_src))
+  {
+    LERR("Only SQLite log files can be cut, convert [" << _src
+        << "] first\n");
+    return FAILED_TO_COPY;
+  }
+
+  std::chrono::nanoseconds first;
+  {
+    transport::log::Log log;
+    if (!log.Open(_src, std::ios_base::in))
+      return FAILED_TO_OPEN;
+    first = log.StartTime();
+  }
+
+  if (!transport::log::CutLog(_src, _dst, TimeRange(first, _start, _end)))
+    return FAILED_TO_COPY;
+
+  return SUCCESS;
+}
+
+//////////////////////////////////////////////////
+int mergeLogs(const char *_srcs, const char *_dst)
+{
+  std::vector<std::string> srcs;
+  std::istringstream lines(_srcs);
+  std::string src;
+  while (std::getline(lines, src))
+  {
+    if (src.empty())
+      continue;
+
+    if (transport::log::ChunkedLog::IsChunkedLog(src))
+    {
+      LERR("Only SQLite log files can be merged, convert [" << src
+          << "] first\n");
+      return FAILED_TO_COPY;
+    }
+    srcs.push_back(src);
+  }
+
+  if (!transport::log::MergeLogs(srcs, _dst))
+    return FAILED_TO_COPY;
+
+  return SUCCESS;
+}
+
+//////////////////////////////////////////////////
+int verifyLog(const char *_file, int _threads)
+{
+  transport::log::LogVerification result;
+  const bool valid = _threads >= 0 && transport::log::VerifyLog(_file,
+      static_cast<unsigned int>(_threads), result);
+
+  std::cout << "Messages: " << result.messages << "\n"
+            << "Checked:  " << result.checked << "\n"
+            << "Corrupt:  " << result.corrupt << "\n"
+            << "Intact:   " << (result.intact ? "yes" : "no") << "\n";
+
+  if (!valid)
+    return FAILED_TO_VERIFY;
+
+  return SUCCESS;
+}
+
+//////////////////////////////////////////////////
+int infoLog(const char *_file, const char *_pattern, double _start,
+    double _end, int _stats)
+{
+  std::regex regexPattern;
+  try
+  {
+    regexPattern = _pattern;
+  }
+  catch (const std::regex_error &e)
+  {
+    LERR("Regex pattern is invalid\n");
+    return BAD_REGEX;
+  }
+
+  if (transport::log::ChunkedLog::IsChunkedLog(_file))
+  {
+    LERR("Only the SQLite log files are described, convert [" << _file
+        << "] first\n");
+    return FAILED_TO_QUERY;
+  }
+
+  transport::log::Log log;
+  if (!log.Open(_file, std::ios_base::in))
+    return FAILED_TO_OPEN;
+
+  const std::chrono::nanoseconds first = log.StartTime();
+  std::cout << "Version:  " << log.Version() << "\n"
+            << "Duration: " << Seconds(log.EndTime() - first) << " s\n";
+
+  for (const auto &topic : log.Summary())
+  {
+    if (!std::regex_match(topic.first, regexPattern))
+      continue;
+
+    std::cout << topic.first << "\n"
+              << "  Messages: " << topic.second.messages << "\n"
+              << "  Size:     " << topic.second.bytes << " B\n"
+              << "  Range:    [" << Seconds(topic.second.startTime - first)
+              << " s, " << Seconds(topic.second.endTime - first) << " s]\n";
+  }
+
+  if (_stats <= 0)
+    return SUCCESS;
+
+  const auto statistics = log.Statistics(transport::log::TopicPattern(
+      regexPattern, TimeRange(first, _start, _end)));
+  std::cout << "\nStatistics of the messages received in the range:\n";
+  for (const auto &topic : statistics)
+  {
+    const transport::log::TopicStatistics &stats = topic.second;
+    std::cout << topic.first << "\n"
+              << "  Messages:     " << stats.messages << "\n"
+              << "  Stored size:  " << stats.storedBytes << " B\n"
+              << "  Range:        [" << Seconds(stats.startTime - first)
+              << " s, " << Seconds(stats.endTime - first) << " s]\n"
+              << "  Rate:         " << stats.rate << " Hz\n";
+    if (stats.messages < 2)
+      continue;
+
+    std::cout << "  Minimum gap:  " << Seconds(stats.minGap) << " s\n"
+              << "  Maximum gap:  " << Seconds(stats.maxGap) << " s at "
+              << Seconds(stats.maxGapStart - first) << " s\n"
+              << "  Gap std dev:  " << Seconds(stats.gapStdDev) << " s\n"
+              << "  Gaps:\n";
+    for (std::size_t i = 0; i < stats.gapHistogram.size(); ++i)
+    {
+      if (stats.gapHistogram[i] == 0)
+        continue;
+
+      // Bin i > 0 holds the gaps of [2^(i-1), 2^i) ns
+      std::cout << "    ";
+      if (i == 0)
+        std::cout << "0 s";
+      else
+      {
+        const int exponent = static_cast<int>(i);
+        std::cout << "[" << std::ldexp(1e-9, exponent - 1) << " s, "
+                  << std::ldexp(1e-9, exponent) << " s)";
+      }
+      std::cout << ": " << stats.gapHistogram[i] << "\n";
+    }
+  }
+
+  return SUCCESS;
+}
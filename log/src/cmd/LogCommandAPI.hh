@@ -27,6 +27,12 @@ extern "C"
     FAILED_TO_SUBSCRIBE = 4,
     INVALID_VERSION     = 5,
     INVALID_REMAP       = 6,
+    FAILED_TO_CONVERT   = 7,
+    FAILED_TO_REINDEX   = 8,
+    FAILED_TO_EXPORT    = 9,
+    FAILED_TO_COPY      = 10,
+    FAILED_TO_VERIFY    = 11,
+    FAILED_TO_QUERY     = 12,
   };
 
   /// \brief Sets verbosity of library
@@ -52,4 +58,82 @@ extern "C"
     const int _wait_ms,
     const char *_remap,
     int _fast);
+
+  /// \brief Convert a log file between the SQLite and the chunked formats
+  /// \param[in] _src Path to the log file to convert
+  /// \param[in] _dst Path to the log file to create
+  /// \param[in] _format Format of _dst: "sqlite", "chunked", or an empty
+  /// string for the format that _src doesn't have
+  /// \param[in] _compression Codec of the chunks of a chunked _dst, or of
+  /// the messages of a SQLite _dst: "none", "lz4" or "zstd"
+  int GZ_TRANSPORT_LOG_VISIBLE convertLog(
+    const char *_src,
+    const char *_dst,
+    const char *_format,
+    const char *_compression);
+
+  /// \brief Update the indexes of a SQLite log file created by an older
+  /// version
+  /// \param[in] _file Path to the log file to reindex
+  int GZ_TRANSPORT_LOG_VISIBLE reindexLog(const char *_file);
+
+  /// \brief Export the messages of the topics whose name matches the given
+  /// pattern to a column export, see ColumnExport.hh
+  /// \param[in] _file Path to the log file to export
+  /// \param[in] _output Path to the directory to create
+  /// \param[in] _pattern ECMAScript regular expression to match against topics
+  /// \param[in] _threads Number of threads writing the export, 0 for one per
+  /// core
+  int GZ_TRANSPORT_LOG_VISIBLE exportLog(
+    const char *_file,
+    const char *_output,
+    const char *_pattern,
+    int _threads);
+
+  /// \brief Copy the messages of a SQLite log file received in a time range
+  /// to a new log file
+  /// \param[in] _src Path to the log file to cut
+  /// \param[in] _dst Path to the log file to create
+  /// \param[in] _start Beginning of the range, in seconds from the first
+  /// message, or a negative value for no beginning
+  /// \param[in] _end End of the range (included), in seconds from the first
+  /// message, or a negative value for no end
+  int GZ_TRANSPORT_LOG_VISIBLE cutLog(
+    const char *_src,
+    const char *_dst,
+    double _start,
+    double _end);
+
+  /// \brief Copy the messages of several SQLite log files to a new log file
+  /// \param[in] _srcs Paths to the log files to merge, one per line
+  /// \param[in] _dst Path to the log file to create
+  int GZ_TRANSPORT_LOG_VISIBLE mergeLogs(
+    const char *_srcs,
+    const char *_dst);
+
+  /// \brief Check the checksums and the messages of a log file, and print
+  /// what was found
+  /// \param[in] _file Path to the log file to verify
+  /// \param[in] _threads Number of threads reading the log file, 0 for one
+  /// per core
+  int GZ_TRANSPORT_LOG_VISIBLE verifyLog(
+    const char *_file,
+    int _threads);
+
+  /// \brief Print the number, size and time range of the messages of the
+  /// topics of a SQLite log file whose name matches the given pattern
+  /// \param[in] _file Path to the log file
+  /// \param[in] _pattern ECMAScript regular expression to match against topics
+  /// \param[in] _start Beginning of the range of the statistics, in seconds
+  /// from the first message, or a negative value for no beginning
+  /// \param[in] _end End of the range of the statistics (included), in
+  /// seconds from the first message, or a negative value for no end
+  /// \param[in] _stats Set to > 0 to also print the rate and the gaps of the
+  /// messages received in the range
+  int GZ_TRANSPORT_LOG_VISIBLE infoLog(
+    const char *_file,
+    const char *_pattern,
+    double _start,
+    double _end,
+    int _stats);
 }
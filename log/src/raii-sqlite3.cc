@@ -17,7 +17,10 @@
 
 #include <sqlite3.h>
 
+#include <memory>
+#include <mutex>
 #include <string>
+#include <utility>
 
 #include "Console.hh"
 #include "raii-sqlite3.hh"
@@ -66,6 +69,9 @@ Database::Database(const std::string &_path, int _flags)
 //////////////////////////////////////////////////
 Database::~Database()
 {
+  // The statements must be finalized for the connection to close
+  this->cache.clear();
+
   if (this->handle)
   {
     sqlite3_close(this->handle);
@@ -85,6 +91,45 @@ Database::operator bool() const
   return this->handle != nullptr;
 }
 
+//////////////////////////////////////////////////
+std::unique_ptr<Statement> Database::Acquire(const std::string &_sql)
+{
+  {
+    std::lock_guard<std::mutex> lk(this->cacheMutex);
+    auto it = this->cache.find(_sql);
+    if (it != this->cache.end())
+    {
+      std::unique_ptr<Statement> statement = std::move(it->second);
+      this->cache.erase(it);
+      return statement;
+    }
+  }
+
+  return std::make_unique<Statement>(*this, _sql);
+}
+
+//////////////////////////////////////////////////
+void Database::Release(const std::string &_sql,
+    std::unique_ptr<Statement> _statement)
+{
+  if (!_statement || !*_statement)
+    return;
+
+  sqlite3_reset(_statement->Handle());
+  sqlite3_clear_bindings(_statement->Handle());
+
+  std::lock_guard<std::mutex> lk(this->cacheMutex);
+  if (this->cache.size() < kMaxCachedStatements)
+    this->cache.emplace(_sql, std::move(_statement));
+}
+
+//////////////////////////////////////////////////
+std::size_t Database::CachedStatements() const
+{
+  std::lock_guard<std::mutex> lk(this->cacheMutex);
+  return this->cache.size();
+}
+
 //////////////////////////////////////////////////
 Statement::Statement(Database &_db, const std::string &_sql)
 {
@@ -125,3 +170,28 @@ Statement::operator bool() const
 {
   return this->handle != nullptr;
 }
+
+//////////////////////////////////////////////////
+CachedStatement::CachedStatement(const std::shared_ptr<Database> &_db,
+    const std::string &_sql)
+  : db(_db), sql(_sql), statement(_db->Acquire(_sql))
+{
+}
+
+//////////////////////////////////////////////////
+CachedStatement::~CachedStatement()
+{
+  this->db->Release(this->sql, std::move(this->statement));
+}
+
+//////////////////////////////////////////////////
+sqlite3_stmt *CachedStatement::Handle()
+{
+  return this->statement->Handle();
+}
+
+//////////////////////////////////////////////////
+CachedStatement::operator bool() const
+{
+  return *this->statement;
+}
@@ -17,7 +17,11 @@
 #ifndef GZ_TRANSPORT_LOG_RAIISQLITE3_HH_
 #define GZ_TRANSPORT_LOG_RAIISQLITE3_HH_
 
+#include <cstddef>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 
 // Forward declarations.
 struct sqlite3;
@@ -27,6 +31,8 @@ struct sqlite3_stmt;
 /// \remarks Not using PIMPL because these classes are for internal use only
 namespace raii_sqlite3
 {
+  class Statement;
+
   /// \brief Thin RAII wrapper for a (sqlite3 *)
   /// Automatically calls sqlite_close()
   /// \internal
@@ -47,8 +53,38 @@ namespace raii_sqlite3
     /// \brief Return true if the database is valid.
     operator bool() const;
 
+    /// \brief Get a compiled statement, reusing one given back with
+    /// Release() when there is one for the same SQL text. The caller owns
+    /// the statement until it gives it back.
+    /// \param[in] _sql A single SQL statement to compile
+    /// \return The statement, which is invalid if it fails to compile
+    public: std::unique_ptr<Statement> Acquire(const std::string &_sql);
+
+    /// \brief Give back a statement obtained with Acquire(). It is reset
+    /// and its bindings cleared, then kept for the next Acquire() of the
+    /// same SQL text, unless the cache is full.
+    /// \param[in] _sql The SQL text the statement was compiled from
+    /// \param[in] _statement The statement
+    public: void Release(const std::string &_sql,
+                         std::unique_ptr<Statement> _statement);
+
+    /// \brief Get the number of statements kept for reuse
+    /// \return The number of statements
+    public: std::size_t CachedStatements() const;
+
+    /// \brief Maximum number of statements kept for reuse
+    public: static const std::size_t kMaxCachedStatements = 32;
+
     /// \brief the pointer this is wrapping
     protected: sqlite3 *handle = nullptr;
+
+    /// \brief Protects the cache
+    private: mutable std::mutex cacheMutex;
+
+    /// \brief Statements kept for reuse, by SQL text. They are finalized
+    /// before the database is closed.
+    private: std::unordered_multimap<std::string, std::unique_ptr<Statement>>
+      cache;
   };
 
   /// \brief Thin RAII wrapper for a (sqlite3_stmt *)
@@ -73,6 +109,44 @@ namespace raii_sqlite3
     /// \brief the pointer this is wrapping
     protected: sqlite3_stmt *handle = nullptr;
   };
+
+  /// \brief A statement taken from the cache of a database, see
+  /// Database::Acquire(). It is given back to the cache when destroyed, so
+  /// the statements run repeatedly are only compiled once per connection.
+  /// The database is kept open as long as the statement.
+  /// \internal
+  class CachedStatement
+  {
+    /// \brief Constructor
+    /// \param[in] _db The database the statement is being used on
+    /// \param[in] _sql A single SQL statement to compile
+    public: CachedStatement(const std::shared_ptr<Database> &_db,
+                            const std::string &_sql);
+
+    /// \brief Destructor
+    public: ~CachedStatement();
+
+    /// \brief No copy constructor
+    public: CachedStatement(const CachedStatement &) = delete;
+
+    /// \brief No assignment operator
+    public: CachedStatement &operator=(const CachedStatement &) = delete;
+
+    /// \brief Handle
+    public: sqlite3_stmt *Handle();
+
+    /// \brief Return true if the statement is valid.
+    operator bool() const;
+
+    /// \brief The database the statement comes from
+    private: std::shared_ptr<Database> db;
+
+    /// \brief The SQL text of the statement
+    private: std::string sql;
+
+    /// \brief The statement
+    private: std::unique_ptr<Statement> statement;
+  };
 }
 
 #endif
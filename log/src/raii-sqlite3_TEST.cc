@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <sqlite3.h>
+
+#include <memory>
+#include <string>
+
+#include "raii-sqlite3.hh"
+#include "gtest/gtest.h"
+
+using namespace raii_sqlite3;
+
+//////////////////////////////////////////////////
+/// \brief The statements are compiled once per database and SQL text, and
+/// given back reset.
+TEST(raii_sqlite3, CachedStatement)
+{
+  auto db = std::make_shared<Database>(":memory:",
+    SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE);
+  ASSERT_TRUE(*db);
+  ASSERT_EQ(SQLITE_OK, sqlite3_exec(db->Handle(),
+    "CREATE TABLE t (v INTEGER); INSERT INTO t VALUES (1), (2);",
+    nullptr, nullptr, nullptr));
+
+  const std::string sql = "SELECT v FROM t WHERE v >= ?001 ORDER BY v;";
+  sqlite3_stmt *first = nullptr;
+  {
+    CachedStatement statement(db, sql);
+    ASSERT_TRUE(statement);
+    first = statement.Handle();
+    sqlite3_bind_int64(first, 1, 2);
+    ASSERT_EQ(SQLITE_ROW, sqlite3_step(first));
+    EXPECT_EQ(2, sqlite3_column_int64(first, 0));
+
+    // The statement is in use, another one is compiled.
+    CachedStatement other(db, sql);
+    ASSERT_TRUE(other);
+    EXPECT_NE(first, other.Handle());
+    EXPECT_EQ(0u, db->CachedStatements());
+  }
+  EXPECT_EQ(2u, db->CachedStatements());
+
+  // A statement given back starts over, without bindings, so the unbound
+  // parameter is NULL and nothing matches.
+  CachedStatement again(db, sql);
+  ASSERT_TRUE(again);
+  EXPECT_EQ(1u, db->CachedStatements());
+  EXPECT_EQ(SQLITE_DONE, sqlite3_step(again.Handle()));
+  sqlite3_reset(again.Handle());
+  sqlite3_bind_int64(again.Handle(), 1, 1);
+  EXPECT_EQ(SQLITE_ROW, sqlite3_step(again.Handle()));
+  EXPECT_EQ(SQLITE_ROW, sqlite3_step(again.Handle()));
+  EXPECT_EQ(SQLITE_DONE, sqlite3_step(again.Handle()));
+
+  // The statements which don't compile aren't kept.
+  {
+    CachedStatement invalid(db, "SELECT FROM nothing;");
+    EXPECT_FALSE(invalid);
+  }
+  EXPECT_EQ(1u, db->CachedStatements());
+}
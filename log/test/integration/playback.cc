@@ -17,9 +17,12 @@
 
 #include <gtest/gtest.h>
 
+#include <filesystem>
+
 #include <gz/transport/log/Log.hh>
 #include <gz/transport/log/Playback.hh>
 #include <gz/transport/log/Recorder.hh>
+#include <gz/transport/log/ShardSet.hh>
 #include <gz/transport/Node.hh>
 
 #include <gz/utils/Environment.hh>
@@ -180,6 +183,510 @@ TEST(playback, GZ_UTILS_TEST_DISABLED_ON_MAC(ReplayLog))
 }
 
 
+//////////////////////////////////////////////////
+/// \brief Record the topics in two shards and play back the shard set.
+TEST(playback, GZ_UTILS_TEST_DISABLED_ON_MAC(ReplayShardedLog))
+{
+  std::vector<std::string> topics = {"/foo", "/bar", "/baz"};
+
+  std::vector<MessageInformation> incomingData;
+
+  auto callback = [&incomingData](
+      const char *_data,
+      std::size_t _len,
+      const gz::transport::MessageInfo &_msgInfo)
+  {
+    TrackMessages(incomingData, _data, _len, _msgInfo);
+  };
+
+  gz::transport::Node node;
+  gz::transport::log::Recorder recorder;
+
+  for (const std::string &topic : topics)
+  {
+    node.SubscribeRaw(topic, callback);
+    recorder.AddTopic(topic);
+  }
+
+  const std::filesystem::path dir = std::filesystem::temp_directory_path() /
+    ("gz_playback_shards_" + testing::getRandomNumber());
+  ASSERT_TRUE(std::filesystem::create_directory(dir));
+  const std::string logName = (dir / "sharded.tlog").string();
+
+  gz::transport::log::LogOptions options;
+  options.AddShard(std::regex("/bar"));
+  EXPECT_EQ(gz::transport::log::RecorderError::SUCCESS,
+    recorder.Start(logName, options));
+  EXPECT_EQ(logName, recorder.Filename());
+
+  const int numChirps = 100;
+  auto chirper =
+    gz::transport::log::test::BeginChirps(topics, numChirps, partition);
+
+  // Wait for the chirping to finish
+  chirper.Join();
+
+  // Wait to make sure our callbacks are done processing the incoming messages
+  std::this_thread::sleep_for(std::chrono::seconds(1));
+  recorder.Stop();
+
+  // Only /bar is recorded in the second shard.
+  ASSERT_TRUE(gz::transport::log::IsShardSet(logName));
+  std::vector<std::string> shards;
+  ASSERT_TRUE(gz::transport::log::ReadShardSet(logName, shards));
+  ASSERT_EQ(2u, shards.size());
+  {
+    gz::transport::log::Log shard;
+    ASSERT_TRUE(shard.Open(shards[1]));
+    const auto &shardTopics = shard.Descriptor()->TopicsToMsgTypesToId();
+    ASSERT_EQ(1u, shardTopics.size());
+    EXPECT_EQ("/bar", shardTopics.begin()->first);
+  }
+
+  // Make a copy of the data so we can compare it later
+  std::vector<MessageInformation> originalData = incomingData;
+
+  // Clear out the old data so we can recreate it during the playback
+  incomingData.clear();
+
+  gz::transport::log::Playback playback(logName);
+  EXPECT_TRUE(playback.Valid());
+  EXPECT_EQ(3, playback.AddTopic(std::regex(".*")));
+
+  const auto handle = playback.Start();
+  ASSERT_NE(nullptr, handle);
+  handle->WaitUntilFinished();
+  handle->Stop();
+
+  // Wait to make sure our callbacks are done processing the incoming messages
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  // The messages of both shards are played back in the order they were
+  // received.
+  EXPECT_TRUE(ExpectSameMessages(originalData, incomingData));
+
+  std::filesystem::remove_all(dir);
+}
+
+//////////////////////////////////////////////////
+/// \brief Record the topics with two recorders, e.g. on two robots, and
+/// play back both logs together.
+TEST(playback, GZ_UTILS_TEST_DISABLED_ON_MAC(ReplayMultipleLogs))
+{
+  std::vector<std::string> topics = {"/foo", "/bar", "/baz"};
+
+  std::vector<MessageInformation> incomingData;
+
+  auto callback = [&incomingData](
+      const char *_data,
+      std::size_t _len,
+      const gz::transport::MessageInfo &_msgInfo)
+  {
+    TrackMessages(incomingData, _data, _len, _msgInfo);
+  };
+
+  gz::transport::Node node;
+  gz::transport::log::Recorder recorderA;
+  gz::transport::log::Recorder recorderB;
+
+  for (const std::string &topic : topics)
+  {
+    node.SubscribeRaw(topic, callback);
+    if (topic == "/bar")
+      recorderB.AddTopic(topic);
+    else
+      recorderA.AddTopic(topic);
+  }
+
+  const std::filesystem::path dir = std::filesystem::temp_directory_path() /
+    ("gz_playback_logs_" + testing::getRandomNumber());
+  ASSERT_TRUE(std::filesystem::create_directory(dir));
+  const std::vector<std::string> logNames =
+    {(dir / "a.tlog").string(), (dir / "b.tlog").string()};
+  EXPECT_EQ(gz::transport::log::RecorderError::SUCCESS,
+    recorderA.Start(logNames[0]));
+  EXPECT_EQ(gz::transport::log::RecorderError::SUCCESS,
+    recorderB.Start(logNames[1]));
+
+  const int numChirps = 100;
+  auto chirper =
+    gz::transport::log::test::BeginChirps(topics, numChirps, partition);
+
+  // Wait for the chirping to finish
+  chirper.Join();
+
+  // Wait to make sure our callbacks are done processing the incoming messages
+  std::this_thread::sleep_for(std::chrono::seconds(1));
+  recorderA.Stop();
+  recorderB.Stop();
+
+  // Make a copy of the data so we can compare it later
+  std::vector<MessageInformation> originalData = incomingData;
+
+  // Clear out the old data so we can recreate it during the playback
+  incomingData.clear();
+
+  // A log listed twice is played once.
+  gz::transport::log::Playback playback(
+    std::vector<std::string>{logNames[0], logNames[1], logNames[0]});
+  EXPECT_TRUE(playback.Valid());
+  EXPECT_EQ(3, playback.AddTopic(std::regex(".*")));
+
+  const auto handle = playback.Start();
+  ASSERT_NE(nullptr, handle);
+  handle->WaitUntilFinished();
+  handle->Stop();
+
+  // Wait to make sure our callbacks are done processing the incoming messages
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  // The messages of both logs are played back on a single timeline, in the
+  // order they were received.
+  EXPECT_TRUE(ExpectSameMessages(originalData, incomingData));
+
+  std::filesystem::remove_all(dir);
+}
+
+//////////////////////////////////////////////////
+/// \brief Record with a rotation by size and play back all the log files.
+TEST(playback, GZ_UTILS_TEST_DISABLED_ON_MAC(ReplayRotatedLog))
+{
+  std::vector<std::string> topics = {"/foo", "/bar", "/baz"};
+
+  std::vector<MessageInformation> incomingData;
+
+  auto callback = [&incomingData](
+      const char *_data,
+      std::size_t _len,
+      const gz::transport::MessageInfo &_msgInfo)
+  {
+    TrackMessages(incomingData, _data, _len, _msgInfo);
+  };
+
+  gz::transport::Node node;
+  gz::transport::log::Recorder recorder;
+
+  for (const std::string &topic : topics)
+  {
+    node.SubscribeRaw(topic, callback);
+    recorder.AddTopic(topic);
+  }
+
+  std::vector<std::string> finished;
+  recorder.SetFileFinishedCallback([&finished](const std::string &_file)
+  {
+    finished.push_back(_file);
+  });
+
+  const std::filesystem::path dir = std::filesystem::temp_directory_path() /
+    ("gz_playback_rotation_" + testing::getRandomNumber());
+  ASSERT_TRUE(std::filesystem::create_directory(dir));
+  const std::string logName = (dir / "rotated.tlog").string();
+
+  gz::transport::log::LogOptions options;
+  options.SetRotationBytes(256);
+  EXPECT_EQ(gz::transport::log::RecorderError::SUCCESS,
+    recorder.Start(logName, options));
+
+  const int numChirps = 100;
+  auto chirper =
+    gz::transport::log::test::BeginChirps(topics, numChirps, partition);
+
+  // Wait for the chirping to finish
+  chirper.Join();
+
+  // Wait to make sure our callbacks are done processing the incoming messages
+  std::this_thread::sleep_for(std::chrono::seconds(1));
+  recorder.Stop();
+
+  // Every log file is finished exactly once and listed in the shard set.
+  std::vector<std::string> files;
+  ASSERT_TRUE(gz::transport::log::ReadShardSet(logName, files));
+  EXPECT_LT(1u, files.size());
+  ASSERT_EQ(files.size(), finished.size());
+  for (const std::string &file : finished)
+  {
+    EXPECT_TRUE(std::filesystem::exists(file));
+    gz::transport::log::Log log;
+    EXPECT_TRUE(log.Open(file));
+  }
+
+  // Make a copy of the data so we can compare it later
+  std::vector<MessageInformation> originalData = incomingData;
+
+  // Clear out the old data so we can recreate it during the playback
+  incomingData.clear();
+
+  gz::transport::log::Playback playback(logName);
+  EXPECT_EQ(3, playback.AddTopic(std::regex(".*")));
+
+  const auto handle = playback.Start();
+  ASSERT_NE(nullptr, handle);
+  handle->WaitUntilFinished();
+  handle->Stop();
+
+  // Wait to make sure our callbacks are done processing the incoming messages
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  // No message is lost when rolling over.
+  EXPECT_TRUE(ExpectSameMessages(originalData, incomingData));
+
+  std::filesystem::remove_all(dir);
+}
+
+//////////////////////////////////////////////////
+/// \brief Record a log and play it back faster than it was recorded.
+TEST(playback, GZ_UTILS_TEST_DISABLED_ON_MAC(ReplayRate))
+{
+  std::vector<std::string> topics = {"/foo", "/bar"};
+
+  std::vector<MessageInformation> incomingData;
+
+  auto callback = [&incomingData](
+      const char *_data,
+      std::size_t _len,
+      const gz::transport::MessageInfo &_msgInfo)
+  {
+    TrackMessages(incomingData, _data, _len, _msgInfo);
+  };
+
+  gz::transport::Node node;
+  gz::transport::log::Recorder recorder;
+
+  for (const std::string &topic : topics)
+  {
+    node.SubscribeRaw(topic, callback);
+    recorder.AddTopic(topic);
+  }
+
+  const std::string logName =
+    "file:playbackReplayRate?mode=memory&cache=shared";
+  EXPECT_EQ(gz::transport::log::RecorderError::SUCCESS,
+    recorder.Start(logName));
+
+  const int numChirps = 100;
+  auto chirper =
+    gz::transport::log::test::BeginChirps(topics, numChirps, partition);
+
+  // Wait for the chirping to finish
+  chirper.Join();
+
+  // Wait to make sure our callbacks are done processing the incoming messages
+  std::this_thread::sleep_for(std::chrono::seconds(1));
+
+  // Create playback before stopping so sqlite memory database is shared
+  gz::transport::log::Playback playback(logName);
+  recorder.Stop();
+
+  std::vector<MessageInformation> originalData = incomingData;
+  incomingData.clear();
+
+  for (const std::string &topic : topics)
+    playback.AddTopic(topic);
+
+  const auto handle = playback.Start(std::chrono::seconds(1));
+  ASSERT_NE(nullptr, handle);
+  EXPECT_DOUBLE_EQ(1.0, handle->Rate());
+  EXPECT_FALSE(handle->SetRate(0.0));
+  EXPECT_TRUE(handle->SetRate(10.0));
+  EXPECT_DOUBLE_EQ(10.0, handle->Rate());
+
+  const auto start = std::chrono::steady_clock::now();
+  handle->WaitUntilFinished();
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+  handle->Stop();
+
+  // Publishing takes some time too, so only check a fraction of the speedup.
+  const auto recorded = handle->EndTime() - handle->StartTime();
+  EXPECT_LT(elapsed, recorded / 2);
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  EXPECT_TRUE(ExpectSameMessages(originalData, incomingData));
+}
+
+//////////////////////////////////////////////////
+/// \brief Record a log, load it in memory and play it back twice, the
+/// second time in a loop.
+TEST(playback, GZ_UTILS_TEST_DISABLED_ON_MAC(ReplayPreloaded))
+{
+  std::vector<std::string> topics = {"/foo", "/bar"};
+
+  std::vector<MessageInformation> incomingData;
+
+  auto callback = [&incomingData](
+      const char *_data,
+      std::size_t _len,
+      const gz::transport::MessageInfo &_msgInfo)
+  {
+    TrackMessages(incomingData, _data, _len, _msgInfo);
+  };
+
+  gz::transport::Node node;
+  gz::transport::log::Recorder recorder;
+
+  for (const std::string &topic : topics)
+  {
+    node.SubscribeRaw(topic, callback);
+    recorder.AddTopic(topic);
+  }
+
+  const std::string logName =
+    "file:playbackReplayPreloaded?mode=memory&cache=shared";
+  EXPECT_EQ(gz::transport::log::RecorderError::SUCCESS,
+    recorder.Start(logName));
+
+  const int numChirps = 50;
+  auto chirper =
+    gz::transport::log::test::BeginChirps(topics, numChirps, partition);
+
+  // Wait for the chirping to finish
+  chirper.Join();
+
+  // Wait to make sure our callbacks are done processing the incoming messages
+  std::this_thread::sleep_for(std::chrono::seconds(1));
+
+  // Create playback before stopping so sqlite memory database is shared
+  gz::transport::log::Playback playback(logName);
+  recorder.Stop();
+
+  std::vector<MessageInformation> originalData = incomingData;
+  incomingData.clear();
+
+  for (const std::string &topic : topics)
+    playback.AddTopic(topic);
+
+  EXPECT_FALSE(playback.Preloaded());
+  ASSERT_TRUE(playback.Preload());
+  EXPECT_TRUE(playback.Preloaded());
+  EXPECT_GT(playback.PreloadedBytes(), 0u);
+
+  auto handle = playback.Start(std::chrono::seconds(1), false);
+  ASSERT_NE(nullptr, handle);
+  EXPECT_FALSE(handle->Loop());
+  handle->WaitUntilFinished();
+  handle->Stop();
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  {
+    std::lock_guard<std::mutex> lock(dataMutex);
+    EXPECT_TRUE(ExpectSameMessages(originalData, incomingData));
+    incomingData.clear();
+  }
+
+  // The loop starts over until it's stopped
+  handle = playback.Start(std::chrono::seconds(1), false);
+  ASSERT_NE(nullptr, handle);
+  handle->SetLoop(true);
+  EXPECT_TRUE(handle->Loop());
+  const auto deadline = std::chrono::steady_clock::now() +
+    std::chrono::seconds(10);
+  while (std::chrono::steady_clock::now() < deadline)
+  {
+    {
+      std::lock_guard<std::mutex> lock(dataMutex);
+      if (incomingData.size() >= 2 * originalData.size())
+        break;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  EXPECT_FALSE(handle->Finished());
+  handle->Stop();
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  std::lock_guard<std::mutex> lock(dataMutex);
+  ASSERT_GE(incomingData.size(), 2 * originalData.size());
+  for (std::size_t i = 0; i < 2 * originalData.size(); ++i)
+  {
+    EXPECT_TRUE(MessagesAreEqual(originalData[i % originalData.size()],
+      incomingData[i]));
+  }
+
+  // Adding a topic discards the preloaded messages
+  playback.AddTopic(topics.front());
+  EXPECT_FALSE(playback.Preloaded());
+}
+
+//////////////////////////////////////////////////
+/// \brief Record a log and play it back publishing every topic from its own
+/// thread. Each topic keeps its order.
+TEST(playback, GZ_UTILS_TEST_DISABLED_ON_MAC(ReplayParallelPublishing))
+{
+  std::vector<std::string> topics = {"/foo", "/bar", "/baz"};
+
+  std::vector<MessageInformation> incomingData;
+
+  auto callback = [&incomingData](
+      const char *_data,
+      std::size_t _len,
+      const gz::transport::MessageInfo &_msgInfo)
+  {
+    TrackMessages(incomingData, _data, _len, _msgInfo);
+  };
+
+  gz::transport::Node node;
+  gz::transport::log::Recorder recorder;
+
+  for (const std::string &topic : topics)
+  {
+    node.SubscribeRaw(topic, callback);
+    recorder.AddTopic(topic);
+  }
+
+  const std::string logName =
+    "file:playbackReplayParallel?mode=memory&cache=shared";
+  EXPECT_EQ(gz::transport::log::RecorderError::SUCCESS,
+    recorder.Start(logName));
+
+  const int numChirps = 100;
+  auto chirper =
+    gz::transport::log::test::BeginChirps(topics, numChirps, partition);
+
+  // Wait for the chirping to finish
+  chirper.Join();
+
+  // Wait to make sure our callbacks are done processing the incoming messages
+  std::this_thread::sleep_for(std::chrono::seconds(1));
+
+  // Create playback before stopping so sqlite memory database is shared
+  gz::transport::log::Playback playback(logName);
+  recorder.Stop();
+
+  std::vector<MessageInformation> originalData = incomingData;
+  incomingData.clear();
+
+  for (const std::string &topic : topics)
+    playback.AddTopic(topic);
+
+  const auto handle = playback.Start(std::chrono::seconds(1));
+  ASSERT_NE(nullptr, handle);
+  EXPECT_FALSE(handle->ParallelPublishing());
+  handle->SetParallelPublishing(true);
+  EXPECT_TRUE(handle->ParallelPublishing());
+  handle->WaitUntilFinished();
+  handle->Stop();
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  // The topics are interleaved differently, but each one is complete and in
+  // order.
+  auto byTopic = [](const std::vector<MessageInformation> &_messages,
+                    const std::string &_topic)
+  {
+    std::vector<MessageInformation> filtered;
+    for (const MessageInformation &message : _messages)
+    {
+      if (message.topic == _topic)
+        filtered.push_back(message);
+    }
+    return filtered;
+  };
+  for (const std::string &topic : topics)
+  {
+    EXPECT_TRUE(ExpectSameMessages(byTopic(originalData, topic),
+                                   byTopic(incomingData, topic)));
+  }
+}
+
 //////////////////////////////////////////////////
 TEST(playback, GZ_UTILS_TEST_DISABLED_ON_MAC(ReplayNoSuchTopic))
 {
@@ -798,6 +1305,81 @@ TEST(playback, GZ_UTILS_TEST_DISABLED_ON_MAC(ReplaySeek))
   std::this_thread::sleep_for(std::chrono::milliseconds(100));
 }
 
+//////////////////////////////////////////////////
+/// \brief Seek into a log and check that the last message of a state topic,
+/// published long before the new time, is published again.
+TEST(playback, GZ_UTILS_TEST_DISABLED_ON_MAC(ReplayStateAfterSeek))
+{
+  using namespace std::chrono_literals;
+
+  const std::filesystem::path dir = std::filesystem::temp_directory_path() /
+    ("gz_playback_state_" + testing::getRandomNumber());
+  ASSERT_TRUE(std::filesystem::create_directory(dir));
+  const std::string logName = (dir / "state.tlog").string();
+
+  {
+    gz::transport::log::Log log;
+    ASSERT_TRUE(log.Open(logName, std::ios_base::out));
+    const std::string type = "gz.msgs.StringMsg";
+    const std::string map = "map";
+    EXPECT_TRUE(log.InsertMessage(1ms, "/state", type, map.data(),
+        map.size()));
+    for (int i = 0; i < 100; ++i)
+    {
+      const std::string data = std::to_string(i);
+      EXPECT_TRUE(log.InsertMessage(i * 10ms, "/data", type, data.data(),
+          data.size()));
+    }
+  }
+
+  std::vector<MessageInformation> incomingData;
+  auto callback = [&incomingData](
+      const char *_data,
+      std::size_t _len,
+      const gz::transport::MessageInfo &_msgInfo)
+  {
+    TrackMessages(incomingData, _data, _len, _msgInfo);
+  };
+
+  gz::transport::Node node;
+  node.SubscribeRaw("/state", callback);
+
+  gz::transport::log::Playback playback(logName);
+  EXPECT_EQ(2, playback.AddTopic(std::regex(".*")));
+
+  const auto handle = playback.Start();
+  ASSERT_NE(nullptr, handle);
+  EXPECT_EQ(1u, handle->SetStateTopics(std::regex("/state")));
+  handle->Pause();
+  std::this_thread::sleep_for(100ms);
+  {
+    std::lock_guard<std::mutex> lk(dataMutex);
+    incomingData.clear();
+  }
+
+  // The state is published again when seeking past it
+  handle->Seek(500ms);
+  std::this_thread::sleep_for(100ms);
+  {
+    std::lock_guard<std::mutex> lk(dataMutex);
+    ASSERT_EQ(1u, incomingData.size());
+    EXPECT_EQ("/state", incomingData[0].topic);
+    EXPECT_EQ("map", incomingData[0].data);
+    incomingData.clear();
+  }
+
+  // Not when seeking before it
+  handle->Seek(0ms);
+  std::this_thread::sleep_for(100ms);
+  {
+    std::lock_guard<std::mutex> lk(dataMutex);
+    EXPECT_TRUE(incomingData.empty());
+  }
+
+  handle->Stop();
+  std::filesystem::remove_all(dir);
+}
+
 //////////////////////////////////////////////////
 int main(int argc, char **argv)
 {
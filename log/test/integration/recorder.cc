@@ -18,8 +18,10 @@
 
 #include <gtest/gtest.h>
 
+#include <iostream>
 #include <optional>
 #include <numeric>
+#include <vector>
 
 #include <gz/transport/log/Log.hh>
 #include <gz/transport/log/Recorder.hh>
@@ -28,6 +30,7 @@
 #include <gz/utils/Environment.hh>
 #include <gz/utils/ExtraTestMacros.hh>
 
+#include "allocation_counter.hh"
 #include "test_utils.hh"
 
 #include "ChirpParams.hh"
@@ -445,6 +448,67 @@ TEST(recorder, DataWriterQueueClockUpdates)
   }
 }
 
+//////////////////////////////////////////////////
+TEST(recorder, DataWriterQueueCoarseTimestamps)
+{
+  std::string topic{"/foo"};
+
+  gz::transport::log::Recorder recorder;
+  EXPECT_EQ(gz::transport::log::RecorderError::SUCCESS,
+            recorder.AddTopic(topic));
+
+  const std::string logName =
+    "file:recorderDataWriterQueueCoarseTimestamps?mode=memory&cache=shared";
+
+  using MsgType = gz::transport::log::test::ChirpMsgType;
+
+  gz::transport::Node node;
+  auto pub = node.Advertise<MsgType>(topic);
+
+  const std::string clockTopic{"/test_coarse_clock"};
+  gz::transport::NetworkClock clock(clockTopic);
+  clock.SetTime(std::chrono::seconds(5));
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  recorder.Sync(&clock);
+
+  // The time is cached when the recording starts, then every 10 s of the
+  // clock
+  EXPECT_EQ(gz::transport::log::RecorderError::SUCCESS,
+            recorder.SetTimestampResolution(std::chrono::seconds(10)));
+  EXPECT_EQ(recorder.Start(logName),
+            gz::transport::log::RecorderError::SUCCESS);
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+  MsgType msg;
+  for (int i = 1; i <= 3; ++i)
+  {
+    clock.SetTime(std::chrono::seconds(5 + i));
+    msg.set_data(i);
+    pub.Publish(msg);
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  clock.SetTime(std::chrono::seconds(16));
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  msg.set_data(4);
+  pub.Publish(msg);
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  // Open log before stopping so sqlite memory database is shared
+  gz::transport::log::Log log;
+  EXPECT_TRUE(log.Open(logName));
+  recorder.Stop();
+
+  std::vector<std::chrono::nanoseconds> stamps;
+  for (const auto &logMsg : log.QueryMessages())
+    stamps.push_back(logMsg.TimeReceived());
+
+  const std::vector<std::chrono::nanoseconds> expected{
+    std::chrono::seconds(5), std::chrono::seconds(5),
+    std::chrono::seconds(5), std::chrono::seconds(16)};
+  EXPECT_EQ(expected, stamps);
+}
+
 //////////////////////////////////////////////////
 /// Test various buffer size settings.
 void TestBufferSizeSettings(const std::optional<std::size_t> &_bufferSize,
@@ -535,6 +599,49 @@ TEST(recorder, DataWriterQueueLargeMessages)
   TestBufferSizeSettings(1, 1);
 }
 
+//////////////////////////////////////////////////
+/// Bound the mean number of allocations of the write path of the recorder,
+/// in steady state, from the publication to the insertion in the database.
+/// The ones made by SQLite use malloc and are not counted. Lower the bound
+/// when an allocation is removed, so that it stays removed.
+TEST(recorder, WritePathAllocations)
+{
+  const double kMaxAllocsPerMessage = 64;
+  const int kMessages = 1000;
+  std::string topic{"/alloc"};
+
+  gz::transport::log::Recorder recorder;
+  EXPECT_EQ(gz::transport::log::RecorderError::SUCCESS,
+            recorder.AddTopic(topic));
+  EXPECT_EQ(recorder.Start(
+      "file:recorderWritePathAllocations?mode=memory&cache=shared"),
+    gz::transport::log::RecorderError::SUCCESS);
+
+  using MsgType = gz::transport::log::test::ChirpMsgType;
+  gz::transport::Node node;
+  auto pub = node.Advertise<MsgType>(topic);
+  MsgType msg;
+  msg.set_data(1);
+
+  // Warm up the write path.
+  for (int i = 0; i < 100; ++i)
+    pub.Publish(msg);
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+  testing::AllocationCounter counter;
+  for (int i = 0; i < kMessages; ++i)
+    pub.Publish(msg);
+  // Sleep so data writer can write the messages.
+  std::this_thread::sleep_for(std::chrono::milliseconds(500));
+  const double allocs =
+    static_cast<double>(counter.Allocations()) / kMessages;
+  recorder.Stop();
+
+  std::cout << "Recorder write path: " << allocs
+            << " allocations per message" << std::endl;
+  EXPECT_LE(allocs, kMaxAllocsPerMessage);
+}
+
 //////////////////////////////////////////////////
 int main(int argc, char **argv)
 {
@@ -0,0 +1,220 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "gz/transport/Node.hh"
+#include "gz/transport/log/LogOptions.hh"
+#include "gz/transport/log/Recorder.hh"
+
+#include <gz/utils/Environment.hh>
+
+#include "test_utils.hh"
+
+using namespace gz;
+
+/// \brief A recording scenario.
+struct Scenario
+{
+  /// \brief Number of topics
+  int topics;
+
+  /// \brief Size of the messages (bytes)
+  std::size_t msgSize;
+
+  /// \brief Publication rate of each topic (Hz)
+  int rate;
+};
+
+/// \brief Scenarios: a few large messages, many small ones, and in between.
+static const std::vector<Scenario> kScenarios =
+  {{2, 4u << 20, 30}, {10, 64u << 10, 200}, {100, 1024, 1000}};
+
+/// \brief Duration of the publication in every scenario (ms).
+static const int kDuration = 3000;
+
+/// \brief Buffer size of the recorder (MB), small enough to see drops when
+/// the disk can't keep up.
+static const std::size_t kBufferSize = 256;
+
+//////////////////////////////////////////////////
+/// \brief Get the directories to record in: the temporary directory, a
+/// tmpfs if there is one, and the directory set in
+/// GZ_TRANSPORT_BENCH_LOG_DIR, e.g. on an SSD.
+/// \return The directories.
+static std::vector<std::filesystem::path> logDirectories()
+{
+  std::vector<std::filesystem::path> dirs =
+    {std::filesystem::temp_directory_path()};
+
+  std::error_code ec;
+  if (std::filesystem::is_directory("/dev/shm", ec))
+    dirs.push_back("/dev/shm");
+
+  std::string dir;
+  if (utils::env("GZ_TRANSPORT_BENCH_LOG_DIR", dir) && !dir.empty())
+    dirs.push_back(dir);
+
+  return dirs;
+}
+
+//////////////////////////////////////////////////
+/// \brief Get a percentile of the write durations.
+/// \param[in] _stats Counters of the recorder.
+/// \param[in] _percentile Percentile, between 0 and 1.
+/// \return Upper bound of the percentile (us).
+static uint64_t writePercentile(
+  const transport::log::RecorderStatistics &_stats, double _percentile)
+{
+  const auto &histogram = _stats.writeDurationHistogram;
+  const double target = _percentile * static_cast<double>(_stats.writes);
+  uint64_t count = 0;
+  for (std::size_t i = 0; i < histogram.size(); ++i)
+  {
+    count += histogram[i];
+    if (static_cast<double>(count) >= target)
+      return uint64_t(1) << i;
+  }
+  return uint64_t(1) << histogram.size();
+}
+
+//////////////////////////////////////////////////
+/// \brief Record a scenario and print its throughput.
+/// \param[in] _dir Directory of the log file.
+/// \param[in] _scenario The scenario.
+/// \param[in] _options Options of the log file.
+static void record(const std::filesystem::path &_dir,
+  const Scenario &_scenario, const transport::log::LogOptions &_options)
+{
+  const std::filesystem::path file =
+    _dir / ("gz_recorder_ingest_" + testing::getRandomNumber() + ".tlog");
+
+  transport::Node node;
+  transport::log::Recorder recorder;
+  recorder.SetBufferSize(kBufferSize);
+
+  std::vector<transport::Node::Publisher> publishers;
+  for (int i = 0; i < _scenario.topics; ++i)
+  {
+    const std::string topic = "/ingest_" + std::to_string(i);
+    EXPECT_EQ(transport::log::RecorderError::SUCCESS,
+      recorder.AddTopic(topic));
+    publishers.push_back(node.Advertise(topic, "gz.msgs.Bytes"));
+  }
+
+  ASSERT_EQ(transport::log::RecorderError::SUCCESS,
+    recorder.Start(file.string(), _options));
+
+  // The content doesn't matter, the recorder doesn't parse the messages.
+  const std::string data(_scenario.msgSize, 'x');
+  const auto period = std::chrono::nanoseconds(
+    std::chrono::seconds(1)) / _scenario.rate;
+  const auto start = std::chrono::steady_clock::now();
+  auto next = start;
+  uint64_t published = 0;
+  while (next - start < std::chrono::milliseconds(kDuration))
+  {
+    for (auto &publisher : publishers)
+    {
+      publisher.PublishRaw(data, "gz.msgs.Bytes");
+      ++published;
+    }
+    next += period;
+    std::this_thread::sleep_until(next);
+  }
+
+  recorder.Stop();
+  const double elapsed = std::chrono::duration<double>(
+    std::chrono::steady_clock::now() - start).count();
+  const transport::log::RecorderStatistics stats = recorder.Statistics();
+
+  EXPECT_EQ(stats.receivedMessages,
+    stats.writtenMessages + stats.droppedMessages);
+
+  std::cout << std::setw(8) << _scenario.topics
+            << std::setw(10) << _scenario.msgSize
+            << std::setw(8) << _scenario.rate
+            << std::setw(10) << published
+            << std::setw(10) << stats.writtenMessages
+            << std::setw(10) << stats.droppedMessages
+            << std::setw(12) << std::fixed << std::setprecision(1)
+            << stats.writtenBytes / elapsed / (1 << 20)
+            << std::setw(12) << stats.maxQueuedBytes / (1 << 20)
+            << std::setw(10) << writePercentile(stats, 0.5)
+            << std::setw(10) << writePercentile(stats, 0.99)
+            << std::setw(10) << std::chrono::duration_cast<
+                 std::chrono::microseconds>(stats.maxWriteDuration).count()
+            << std::endl;
+
+  std::filesystem::remove(file);
+  std::filesystem::remove(file.string() + "-wal");
+  std::filesystem::remove(file.string() + "-shm");
+}
+
+//////////////////////////////////////////////////
+/// \brief Measure the sustained throughput of the recorder, with the
+/// default options and the high throughput ones, in every directory.
+TEST(recorderIngest, Throughput)
+{
+  const std::vector<std::pair<std::string, transport::log::LogOptions>>
+    options = {{"default", transport::log::LogOptions()},
+               {"high throughput",
+                transport::log::LogOptions::HighThroughput()}};
+
+  for (const auto &dir : logDirectories())
+  {
+    for (const auto &option : options)
+    {
+      std::cout << "\n[" << dir.string() << "] " << option.first
+                << " options\n"
+                << std::setw(8) << "topics"
+                << std::setw(10) << "size"
+                << std::setw(8) << "Hz"
+                << std::setw(10) << "sent"
+                << std::setw(10) << "written"
+                << std::setw(10) << "dropped"
+                << std::setw(12) << "MB/s"
+                << std::setw(12) << "max MB"
+                << std::setw(10) << "p50 us"
+                << std::setw(10) << "p99 us"
+                << std::setw(10) << "max us" << std::endl;
+
+      for (const Scenario &scenario : kScenarios)
+        record(dir, scenario, option.second);
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  // Get a random partition name.
+  std::string partition = testing::getRandomNumber();
+
+  // Set the partition name for this process.
+  gz::utils::setenv("GZ_PARTITION", partition);
+
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
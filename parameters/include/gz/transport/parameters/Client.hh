@@ -20,6 +20,8 @@
 
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "google/protobuf/message.h"
 
@@ -101,6 +103,40 @@ namespace gz
         public: gz::msgs::ParameterDeclarations
           ListParameters() const final;
 
+        /// \brief Request the values of several parameters with a single
+        /// request, instead of a request per parameter.
+        /// \param[in] _parameterNames Names of the parameters.
+        /// \param[out] _parameters Values of the parameters, in the order of
+        ///   _parameterNames. The value is nullptr when it couldn't be got.
+        /// \return A ParameterResult per parameter, see Parameter().
+        public: std::vector<ParameterResult> Parameters(
+          const std::vector<std::string> &_parameterNames,
+          std::vector<std::unique_ptr<google::protobuf::Message>>
+            &_parameters) const;
+
+        /// \brief Set the values of several parameters with a single
+        /// request.
+        /// \param[in] _parameters Name and value of every parameter.
+        /// \return A ParameterResult per parameter, see SetParameter().
+        public: std::vector<ParameterResult> SetParameters(
+          const std::vector<std::pair<std::string,
+            const google::protobuf::Message *>> &_parameters);
+
+        /// \brief Declare several parameters with a single request.
+        /// \param[in] _parameters Name and initial value of every parameter.
+        /// \return A ParameterResult per parameter, see DeclareParameter().
+        public: std::vector<ParameterResult> DeclareParameters(
+          const std::vector<std::pair<std::string,
+            const google::protobuf::Message *>> &_parameters);
+
+        /// \brief Keep a local copy of all the parameters of the registry,
+        /// so Parameter() doesn't send a request anymore. The copy is
+        /// updated with the parameter_updates topic of the registry, see
+        /// ParametersRegistry.
+        /// \return True if the parameters were synchronized with the
+        ///   registry.
+        public: bool EnableCache();
+
 #ifdef _WIN32
 // Disable warning C4251 which is triggered by
 // std::unique_ptr
@@ -18,6 +18,7 @@
 #ifndef GZ_TRANSPORT_PARAMETERS_REGISTRY_HH_
 #define GZ_TRANSPORT_PARAMETERS_REGISTRY_HH_
 
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <string>
@@ -52,6 +53,17 @@ namespace gz
       /// * /${_parametersServicesNamespace}/list_parameters
       /// * /${_parametersServicesNamespace}/set_parameter
       /// * /${_parametersServicesNamespace}/declare_parameter
+      ///
+      /// Several parameters can be get, set or declared with a single
+      /// Node::RequestBatch() on these services.
+      ///
+      /// The values are immutable snapshots replaced by every set, so the
+      /// reads don't take a lock and ParameterSnapshot() doesn't copy.
+      ///
+      /// Published topics:
+      /// * /${_parametersServicesNamespace}/parameter_updates
+      ///   (gz::msgs::Parameter), the new value of a parameter every time
+      ///   it's declared or set. ParametersClient::EnableCache() uses it.
       class GZ_TRANSPORT_PARAMETERS_VISIBLE ParametersRegistry
       : public ParametersInterface
       {
@@ -125,6 +137,33 @@ namespace gz
           const std::string & _parameterName,
           std::unique_ptr<google::protobuf::Message> _value);
 
+        /// \brief Get the current value of a parameter without copying it,
+        /// for the readers of the same process. The value never changes, a
+        /// set replaces it, so it can be kept as long as needed.
+        /// \param[in] _parameterName Name of the parameter.
+        /// \return The value, or nullptr if the parameter isn't declared.
+        public: std::shared_ptr<const google::protobuf::Message>
+          ParameterSnapshot(const std::string & _parameterName) const;
+
+        /// \brief Get the current value of a parameter of a known type
+        /// without copying it, see ParameterSnapshot().
+        /// \param[in] _parameterName Name of the parameter.
+        /// \return The value, or nullptr if the parameter isn't declared or
+        ///   isn't a T.
+        public: template<typename T>
+          std::shared_ptr<const T> ParameterSnapshot(
+            const std::string & _parameterName) const
+        {
+          return std::dynamic_pointer_cast<const T>(
+            this->ParameterSnapshot(_parameterName));
+        }
+
+        /// \brief Get the version of the parameters, incremented every time
+        /// a parameter is declared or set. A reader can keep the snapshots
+        /// of its parameters until the version changes.
+        /// \return The version.
+        public: uint64_t Version() const;
+
 #ifdef _WIN32
 // Disable warning C4251 which is triggered by
 // std::unique_ptr
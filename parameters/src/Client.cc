@@ -17,9 +17,15 @@
 
 #include "gz/transport/parameters/Client.hh"
 
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include <gz/msgs/boolean.pb.h>
 #include <gz/msgs/parameter.pb.h>
@@ -43,9 +49,54 @@ struct transport::parameters::ParametersClientPrivate
   : serverNamespace{_serverNamespace},
     timeoutMs{_timeoutMs}
   {}
+  /// \brief Callback of the parameter_updates topic.
+  /// \param[in] _msg The new value of a parameter.
+  void OnUpdate(const msgs::Parameter &_msg)
+  {
+    std::lock_guard guard{this->cacheMutex};
+    this->cache[_msg.name()] = _msg.value();
+  }
+
+  /// \brief Get a parameter from the cache.
+  /// \param[in] _parameterName Name of the parameter.
+  /// \param[out] _value Value of the parameter.
+  /// \return True if the cache is enabled and has the parameter.
+  bool Cached(const std::string &_parameterName,
+    google::protobuf::Any &_value) const
+  {
+    std::lock_guard guard{this->cacheMutex};
+    if (!this->cacheEnabled)
+      return false;
+    auto it = this->cache.find(_parameterName);
+    if (it == this->cache.end())
+      return false;
+    _value = it->second;
+    return true;
+  }
+
+  /// \brief Store the value of a parameter in the cache, if enabled.
+  /// \param[in] _parameterName Name of the parameter.
+  /// \param[in] _value Value of the parameter.
+  void Cache(const std::string &_parameterName,
+    const google::protobuf::Any &_value)
+  {
+    std::lock_guard guard{this->cacheMutex};
+    if (this->cacheEnabled)
+      this->cache[_parameterName] = _value;
+  }
+
   std::string serverNamespace;
   mutable transport::Node node;
   unsigned int timeoutMs;
+
+  /// \brief Protects cacheEnabled and cache.
+  mutable std::mutex cacheMutex;
+
+  /// \brief Whether Parameter() reads the cache, see EnableCache().
+  bool cacheEnabled{false};
+
+  /// \brief Value of every parameter of the registry.
+  std::unordered_map<std::string, google::protobuf::Any> cache;
 };
 
 //////////////////////////////////////////////////
@@ -73,6 +124,9 @@ getParameterCommon(
   const std::string & _parameterName,
   msgs::ParameterValue & _parameterValue)
 {
+  if (_dataPtr.Cached(_parameterName, *_parameterValue.mutable_data()))
+    return ParameterResult{ParameterResultType::Success};
+
   bool result{false};
   const std::string service{_dataPtr.serverNamespace + "/get_parameter"};
 
@@ -93,39 +147,112 @@ getParameterCommon(
 }
 
 //////////////////////////////////////////////////
-ParameterResult
-ParametersClient::Parameter(
+/// \brief Unpack the value of a parameter.
+/// \param[in] _parameterName Name of the parameter.
+/// \param[in] _value The packed value.
+/// \param[out] _parameter The value of the parameter.
+/// \return The result.
+static ParameterResult
+unpackParameter(
   const std::string & _parameterName,
-  google::protobuf::Message & _parameter) const
+  const google::protobuf::Any & _value,
+  std::unique_ptr<google::protobuf::Message> & _parameter)
 {
-  msgs::ParameterValue res;
-  auto ret = getParameterCommon(*this->dataPtr, _parameterName, res);
-  auto gzTypeOpt = getGzTypeFromAnyProto(res.data());
+  auto gzTypeOpt = getGzTypeFromAnyProto(_value);
   if (!gzTypeOpt) {
     return ParameterResult{
       ParameterResultType::Unexpected,
       _parameterName};
   }
   auto gzType = *gzTypeOpt;
-  if (gzType != _parameter.GetDescriptor()->name()) {
+  _parameter = gz::msgs::Factory::New(gzType);
+  if (!_parameter) {
     return ParameterResult{
-      ParameterResultType::InvalidType, _parameterName, gzType};
+      ParameterResultType::Unexpected, _parameterName, gzType};
   }
-  if (!res.data().UnpackTo(&_parameter)) {
+  if (!_value.UnpackTo(_parameter.get())) {
+    _parameter.reset();
     return ParameterResult{
       ParameterResultType::Unexpected, _parameterName, gzType};
   }
   return ParameterResult{ParameterResultType::Success};
 }
 
+//////////////////////////////////////////////////
+/// \brief Convert the response of the set_parameter service.
+/// \param[in] _parameterName Name of the parameter.
+/// \param[in] _result Result of the service call.
+/// \param[in] _res Response of the service.
+/// \return The result.
+static ParameterResult
+setParameterResult(
+  const std::string & _parameterName,
+  const bool _result,
+  const msgs::ParameterError & _res)
+{
+  if (!_result)
+  {
+    return ParameterResult{ParameterResultType::Unexpected, _parameterName};
+  }
+  if (_res.data() == msgs::ParameterError::SUCCESS) {
+    return ParameterResult{ParameterResultType::Success};
+  }
+  if (_res.data() == msgs::ParameterError::NOT_DECLARED) {
+    return ParameterResult{ParameterResultType::NotDeclared, _parameterName};
+  }
+  if (_res.data() == msgs::ParameterError::INVALID_TYPE) {
+    return ParameterResult{
+      ParameterResultType::InvalidType,
+      _parameterName};
+  }
+  return ParameterResult{ParameterResultType::Unexpected, _parameterName};
+}
+
+//////////////////////////////////////////////////
+/// \brief Convert the response of the declare_parameter service.
+/// \param[in] _parameterName Name of the parameter.
+/// \param[in] _msg Initial value of the parameter.
+/// \param[in] _result Result of the service call.
+/// \param[in] _res Response of the service.
+/// \return The result.
+static ParameterResult
+declareParameterResult(
+  const std::string & _parameterName,
+  const google::protobuf::Message & _msg,
+  const bool _result,
+  const msgs::ParameterError & _res)
+{
+  if (!_result)
+  {
+    return ParameterResult{ParameterResultType::Unexpected, _parameterName};
+  }
+  if (_res.data() == msgs::ParameterError::SUCCESS) {
+    return ParameterResult{ParameterResultType::Success};
+  }
+  if (_res.data() == msgs::ParameterError::ALREADY_DECLARED) {
+    return ParameterResult{
+      ParameterResultType::AlreadyDeclared, _parameterName};
+  }
+  if (_res.data() == msgs::ParameterError::INVALID_TYPE) {
+    return ParameterResult{
+      ParameterResultType::InvalidType,
+      _parameterName,
+      _msg.GetDescriptor()->name()};
+  }
+  return ParameterResult{ParameterResultType::Unexpected, _parameterName};
+}
+
 //////////////////////////////////////////////////
 ParameterResult
 ParametersClient::Parameter(
   const std::string & _parameterName,
-  std::unique_ptr<google::protobuf::Message> & _parameter) const
+  google::protobuf::Message & _parameter) const
 {
   msgs::ParameterValue res;
   auto ret = getParameterCommon(*this->dataPtr, _parameterName, res);
+  if (!ret) {
+    return ret;
+  }
   auto gzTypeOpt = getGzTypeFromAnyProto(res.data());
   if (!gzTypeOpt) {
     return ParameterResult{
@@ -133,18 +260,31 @@ ParametersClient::Parameter(
       _parameterName};
   }
   auto gzType = *gzTypeOpt;
-  _parameter = gz::msgs::Factory::New(gzType);
-  if (!_parameter) {
+  if (gzType != _parameter.GetDescriptor()->name()) {
     return ParameterResult{
-      ParameterResultType::Unexpected, _parameterName, gzType};
+      ParameterResultType::InvalidType, _parameterName, gzType};
   }
-  if (!res.data().UnpackTo(_parameter.get())) {
+  if (!res.data().UnpackTo(&_parameter)) {
     return ParameterResult{
       ParameterResultType::Unexpected, _parameterName, gzType};
   }
   return ParameterResult{ParameterResultType::Success};
 }
 
+//////////////////////////////////////////////////
+ParameterResult
+ParametersClient::Parameter(
+  const std::string & _parameterName,
+  std::unique_ptr<google::protobuf::Message> & _parameter) const
+{
+  msgs::ParameterValue res;
+  auto ret = getParameterCommon(*this->dataPtr, _parameterName, res);
+  if (!ret) {
+    return ret;
+  }
+  return unpackParameter(_parameterName, res.data(), _parameter);
+}
+
 //////////////////////////////////////////////////
 ParameterResult
 ParametersClient::SetParameter(
@@ -164,22 +304,11 @@ ParametersClient::SetParameter(
   {
     return ParameterResult{ParameterResultType::ClientTimeout, _parameterName};
   }
-  if (!result)
-  {
-    return ParameterResult{ParameterResultType::Unexpected, _parameterName};
-  }
-  if (res.data() == msgs::ParameterError::SUCCESS) {
-    return ParameterResult{ParameterResultType::Success};
-  }
-  if (res.data() == msgs::ParameterError::NOT_DECLARED) {
-    return ParameterResult{ParameterResultType::NotDeclared, _parameterName};
+  auto ret = setParameterResult(_parameterName, result, res);
+  if (ret) {
+    this->dataPtr->Cache(_parameterName, req.value());
   }
-  if (res.data() == msgs::ParameterError::INVALID_TYPE) {
-    return ParameterResult{
-      ParameterResultType::InvalidType,
-      _parameterName};
-  }
-  return ParameterResult{ParameterResultType::Unexpected, _parameterName};
+  return ret;
 }
 
 //////////////////////////////////////////////////
@@ -201,24 +330,11 @@ ParametersClient::DeclareParameter(
   {
     return ParameterResult{ParameterResultType::ClientTimeout, _parameterName};
   }
-  if (!result)
-  {
-    return ParameterResult{ParameterResultType::Unexpected, _parameterName};
-  }
-  if (res.data() == msgs::ParameterError::SUCCESS) {
-    return ParameterResult{ParameterResultType::Success};
+  auto ret = declareParameterResult(_parameterName, _msg, result, res);
+  if (ret) {
+    this->dataPtr->Cache(_parameterName, req.value());
   }
-  if (res.data() == msgs::ParameterError::ALREADY_DECLARED) {
-    return ParameterResult{
-      ParameterResultType::AlreadyDeclared, _parameterName};
-  }
-  if (res.data() == msgs::ParameterError::INVALID_TYPE) {
-    return ParameterResult{
-      ParameterResultType::InvalidType,
-      _parameterName,
-      _msg.GetDescriptor()->name()};
-  }
-  return ParameterResult{ParameterResultType::Unexpected, _parameterName};
+  return ret;
 }
 
 //////////////////////////////////////////////////
@@ -243,3 +359,189 @@ ParametersClient::ListParameters() const
   }
   return res;
 }
+
+//////////////////////////////////////////////////
+std::vector<ParameterResult>
+ParametersClient::Parameters(
+  const std::vector<std::string> & _parameterNames,
+  std::vector<std::unique_ptr<google::protobuf::Message>> & _parameters) const
+{
+  std::vector<ParameterResult> ret(_parameterNames.size(),
+    ParameterResult{ParameterResultType::Success});
+  _parameters.clear();
+  _parameters.resize(_parameterNames.size());
+
+  // Request only the parameters missing from the cache.
+  std::vector<std::size_t> indices;
+  std::vector<msgs::ParameterName> reqs;
+  for (std::size_t i = 0; i < _parameterNames.size(); ++i)
+  {
+    google::protobuf::Any value;
+    if (this->dataPtr->Cached(_parameterNames[i], value))
+    {
+      ret[i] = unpackParameter(_parameterNames[i], value, _parameters[i]);
+      continue;
+    }
+    indices.push_back(i);
+    reqs.emplace_back();
+    reqs.back().set_name(_parameterNames[i]);
+  }
+  if (reqs.empty())
+    return ret;
+
+  const std::string service{dataPtr->serverNamespace + "/get_parameter"};
+  std::vector<msgs::ParameterValue> reps;
+  std::vector<bool> results;
+  if (!dataPtr->node.RequestBatch(
+    service, reqs, dataPtr->timeoutMs, reps, results))
+  {
+    for (auto i : indices)
+    {
+      ret[i] = ParameterResult{
+        ParameterResultType::ClientTimeout, _parameterNames[i]};
+    }
+    return ret;
+  }
+  for (std::size_t j = 0; j < indices.size(); ++j)
+  {
+    const auto i = indices[j];
+    if (!results[j])
+    {
+      ret[i] = ParameterResult{
+        ParameterResultType::NotDeclared, _parameterNames[i]};
+      continue;
+    }
+    ret[i] = unpackParameter(_parameterNames[i], reps[j].data(),
+      _parameters[i]);
+  }
+  return ret;
+}
+
+//////////////////////////////////////////////////
+/// \brief Send a batch of set or declare requests.
+/// \param[in] _dataPtr Private data of the client.
+/// \param[in] _service Name of the service.
+/// \param[in] _parameters Name and value of every parameter.
+/// \param[in] _result Convert the response of a request.
+/// \return A ParameterResult per parameter.
+static std::vector<ParameterResult>
+modifyParameters(
+  ParametersClientPrivate & _dataPtr,
+  const std::string & _service,
+  const std::vector<std::pair<std::string,
+    const google::protobuf::Message *>> & _parameters,
+  const std::function<ParameterResult(const std::string &,
+    const google::protobuf::Message &, bool,
+    const msgs::ParameterError &)> & _result)
+{
+  std::vector<msgs::Parameter> reqs(_parameters.size());
+  for (std::size_t i = 0; i < _parameters.size(); ++i)
+  {
+    reqs[i].set_name(_parameters[i].first);
+    reqs[i].mutable_value()->PackFrom(*_parameters[i].second);
+  }
+
+  std::vector<ParameterResult> ret;
+  ret.reserve(_parameters.size());
+  std::vector<msgs::ParameterError> reps;
+  std::vector<bool> results;
+  if (!_dataPtr.node.RequestBatch(
+    _dataPtr.serverNamespace + _service, reqs, _dataPtr.timeoutMs, reps,
+    results))
+  {
+    for (const auto & param : _parameters)
+    {
+      ret.push_back(ParameterResult{
+        ParameterResultType::ClientTimeout, param.first});
+    }
+    return ret;
+  }
+  for (std::size_t i = 0; i < _parameters.size(); ++i)
+  {
+    ret.push_back(_result(_parameters[i].first, *_parameters[i].second,
+      results[i], reps[i]));
+    if (ret.back()) {
+      _dataPtr.Cache(_parameters[i].first, reqs[i].value());
+    }
+  }
+  return ret;
+}
+
+//////////////////////////////////////////////////
+std::vector<ParameterResult>
+ParametersClient::SetParameters(
+  const std::vector<std::pair<std::string,
+    const google::protobuf::Message *>> & _parameters)
+{
+  return modifyParameters(*this->dataPtr, "/set_parameter", _parameters,
+    [](const std::string & _name, const google::protobuf::Message &,
+       bool _result, const msgs::ParameterError & _res)
+    {
+      return setParameterResult(_name, _result, _res);
+    });
+}
+
+//////////////////////////////////////////////////
+std::vector<ParameterResult>
+ParametersClient::DeclareParameters(
+  const std::vector<std::pair<std::string,
+    const google::protobuf::Message *>> & _parameters)
+{
+  return modifyParameters(*this->dataPtr, "/declare_parameter", _parameters,
+    declareParameterResult);
+}
+
+//////////////////////////////////////////////////
+bool
+ParametersClient::EnableCache()
+{
+  {
+    std::lock_guard guard{this->dataPtr->cacheMutex};
+    if (this->dataPtr->cacheEnabled)
+      return true;
+  }
+
+  // Subscribe first, so no update is missed while synchronizing.
+  const std::string topic{
+    this->dataPtr->serverNamespace + "/parameter_updates"};
+  if (!this->dataPtr->node.Subscribe(topic,
+    &ParametersClientPrivate::OnUpdate, this->dataPtr.get()))
+  {
+    return false;
+  }
+
+  std::vector<msgs::ParameterName> reqs;
+  try
+  {
+    for (const auto & decl : this->ListParameters().parameter_declarations())
+    {
+      reqs.emplace_back();
+      reqs.back().set_name(decl.name());
+    }
+  }
+  catch (const std::runtime_error &)
+  {
+    this->dataPtr->node.Unsubscribe(topic);
+    return false;
+  }
+
+  std::vector<msgs::ParameterValue> reps;
+  std::vector<bool> results;
+  if (!reqs.empty() && !this->dataPtr->node.RequestBatch(
+    this->dataPtr->serverNamespace + "/get_parameter", reqs,
+    this->dataPtr->timeoutMs, reps, results))
+  {
+    this->dataPtr->node.Unsubscribe(topic);
+    return false;
+  }
+
+  std::lock_guard guard{this->dataPtr->cacheMutex};
+  for (std::size_t i = 0; i < reps.size(); ++i)
+  {
+    // Keep the values received from the topic, they are newer.
+    if (results[i])
+      this->dataPtr->cache.emplace(reqs[i].name(), reps[i].data());
+  }
+  this->dataPtr->cacheEnabled = true;
+  return true;
+}
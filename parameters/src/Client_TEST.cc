@@ -18,6 +18,11 @@
 #include "gz/transport/parameters/Client.hh"
 #include "gz/transport/parameters/Registry.hh"
 
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
 #include <gz/msgs/boolean.pb.h>
 #include <gz/msgs/stringmsg.pb.h>
 
@@ -212,3 +217,87 @@ TEST_F(ParametersClientTest, ListParameters)
       << "expected to find declaration for another_param2";
   }
 }
+
+//////////////////////////////////////////////////
+TEST_F(ParametersClientTest, Parameters)
+{
+  ParametersClient client;
+  std::vector<std::unique_ptr<google::protobuf::Message>> msgs;
+  auto ret = client.Parameters(
+    {"parameter1", "parameter3", "not_a_param"}, msgs);
+  ASSERT_EQ(3u, ret.size());
+  ASSERT_EQ(3u, msgs.size());
+  EXPECT_TRUE(ret[0]);
+  ASSERT_NE(nullptr, msgs[0]);
+  EXPECT_FALSE(dynamic_cast<msgs::Boolean *>(msgs[0].get())->data());
+  EXPECT_TRUE(ret[1]);
+  ASSERT_NE(nullptr, msgs[1]);
+  EXPECT_EQ("asd", dynamic_cast<msgs::StringMsg *>(msgs[1].get())->data());
+  EXPECT_EQ(ret[2].ResultType(), ParameterResultType::NotDeclared);
+  EXPECT_EQ(nullptr, msgs[2]);
+}
+
+//////////////////////////////////////////////////
+TEST_F(ParametersClientTest, SetAndDeclareParameters)
+{
+  ParametersClient client;
+  msgs::Boolean boolMsg;
+  boolMsg.set_data(true);
+  msgs::StringMsg strMsg;
+  strMsg.set_data("new");
+
+  auto ret = client.DeclareParameters(
+    {{"parameter1", &boolMsg}, {"new_parameter", &strMsg}});
+  ASSERT_EQ(2u, ret.size());
+  EXPECT_EQ(ret[0].ResultType(), ParameterResultType::AlreadyDeclared);
+  EXPECT_TRUE(ret[1]);
+
+  ret = client.SetParameters(
+    {{"parameter1", &boolMsg}, {"parameter2", &boolMsg},
+     {"not_a_param", &boolMsg}});
+  ASSERT_EQ(3u, ret.size());
+  EXPECT_TRUE(ret[0]);
+  EXPECT_EQ(ret[1].ResultType(), ParameterResultType::InvalidType);
+  EXPECT_EQ(ret[2].ResultType(), ParameterResultType::NotDeclared);
+
+  msgs::Boolean res;
+  EXPECT_TRUE(registry_.Parameter("parameter1", res));
+  EXPECT_TRUE(res.data());
+  msgs::StringMsg strRes;
+  EXPECT_TRUE(registry_.Parameter("new_parameter", strRes));
+  EXPECT_EQ("new", strRes.data());
+}
+
+//////////////////////////////////////////////////
+TEST_F(ParametersClientTest, EnableCache)
+{
+  ParametersClient client;
+  EXPECT_TRUE(client.EnableCache());
+
+  msgs::StringMsg strMsg;
+  EXPECT_TRUE(client.Parameter("parameter3", strMsg));
+  EXPECT_EQ("asd", strMsg.data());
+
+  // The cache follows the changes made by the registry.
+  strMsg.set_data("changed");
+  EXPECT_TRUE(registry_.SetParameter("parameter3", strMsg));
+  for (int i = 0; i < 100; ++i)
+  {
+    msgs::StringMsg res;
+    EXPECT_TRUE(client.Parameter("parameter3", res));
+    if (res.data() == "changed")
+      break;
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  msgs::StringMsg res;
+  EXPECT_TRUE(client.Parameter("parameter3", res));
+  EXPECT_EQ("changed", res.data());
+
+  // And the changes made by the client.
+  msgs::Boolean boolMsg;
+  boolMsg.set_data(true);
+  EXPECT_TRUE(client.SetParameter("parameter1", boolMsg));
+  msgs::Boolean boolRes;
+  EXPECT_TRUE(client.Parameter("parameter1", boolRes));
+  EXPECT_TRUE(boolRes.data());
+}
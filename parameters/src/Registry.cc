@@ -17,6 +17,8 @@
 
 #include "gz/transport/parameters/Registry.hh"
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -42,10 +44,45 @@ using namespace gz;
 using namespace transport;
 using namespace parameters;
 
+/// \brief A declared parameter. The value is never modified, a set
+/// replaces it, so readers can keep it without a lock or a copy.
+struct ParameterEntry
+{
+  /// \brief Current value, accessed with std::atomic_load/atomic_store.
+  std::shared_ptr<const google::protobuf::Message> value;
+};
+
 struct transport::parameters::ParametersRegistryPrivate
 {
+  /// \brief Parameters by name. A declaration replaces the whole map, so
+  /// a snapshot of it can be searched without a lock.
   using ParametersMapT = std::unordered_map<
-    std::string, std::unique_ptr<google::protobuf::Message>>;
+    std::string, std::shared_ptr<ParameterEntry>>;
+
+  /// \brief Get the current value of a parameter, without locking.
+  /// \param[in] _name Name of the parameter.
+  /// \return The value, or nullptr if the parameter isn't declared.
+  std::shared_ptr<const google::protobuf::Message> Find(
+    const std::string &_name) const;
+
+  /// \brief Find the entry of a parameter. writeMutex must be locked.
+  /// \param[in] _name Name of the parameter.
+  /// \return The entry, or nullptr if the parameter isn't declared.
+  ParameterEntry *Entry(const std::string &_name) const;
+
+  /// \brief Declare a parameter. writeMutex must be locked.
+  /// \param[in] _name Name of the parameter.
+  /// \param[in] _value Initial value of the parameter.
+  /// \return False if the parameter was already declared.
+  bool Declare(const std::string &_name,
+    std::shared_ptr<const google::protobuf::Message> _value);
+
+  /// \brief Replace the value of a parameter. writeMutex must be locked.
+  /// \param[in] _name Name of the parameter.
+  /// \param[in] _entry Entry of the parameter.
+  /// \param[in] _value New value of the parameter.
+  void Set(const std::string &_name, ParameterEntry &_entry,
+    std::shared_ptr<const google::protobuf::Message> _value);
 
   /// \brief Get parameter service callback.
   /// \param[in] _req Request specifying the parameter name.
@@ -74,9 +111,26 @@ struct transport::parameters::ParametersRegistryPrivate
   bool DeclareParameter(
     const msgs::Parameter &_req, msgs::ParameterError &_res);
 
+  /// \brief Publish the new value of a parameter. writeMutex must be
+  /// locked by the caller, so the updates are published in order.
+  /// \param[in] _name Name of the parameter.
+  /// \param[in] _value Value of the parameter.
+  void PublishUpdate(const std::string &_name,
+    const google::protobuf::Message &_value);
+
   transport::Node node;
-  std::mutex parametersMapMutex;
-  ParametersMapT parametersMap;
+  transport::Node::Publisher updatesPub;
+
+  /// \brief Serializes the declarations and sets. Reads don't lock it.
+  std::mutex writeMutex;
+
+  /// \brief Current map of the parameters, accessed with
+  /// std::atomic_load/atomic_store.
+  std::shared_ptr<const ParametersMapT> parametersMap{
+    std::make_shared<const ParametersMapT>()};
+
+  /// \brief Incremented by every declaration and set.
+  std::atomic<uint64_t> version{0};
 };
 
 //////////////////////////////////////////////////
@@ -103,6 +157,9 @@ ParametersRegistry::ParametersRegistry(
     _parametersServicesNamespace + "/declare_parameter"};
   this->dataPtr->node.Advertise(declareParameterSrvName,
     &ParametersRegistryPrivate::DeclareParameter, this->dataPtr.get());
+
+  this->dataPtr->updatesPub = this->dataPtr->node.Advertise<msgs::Parameter>(
+    _parametersServicesNamespace + "/parameter_updates");
 }
 
 //////////////////////////////////////////////////
@@ -115,18 +172,77 @@ ParametersRegistry::ParametersRegistry(ParametersRegistry &&) = default;
 ParametersRegistry & ParametersRegistry::operator=(
   ParametersRegistry &&) = default;
 
+//////////////////////////////////////////////////
+std::shared_ptr<const google::protobuf::Message>
+ParametersRegistryPrivate::Find(const std::string &_name) const
+{
+  auto map = std::atomic_load(&this->parametersMap);
+  auto it = map->find(_name);
+  if (it == map->end())
+    return nullptr;
+  return std::atomic_load(&it->second->value);
+}
+
+//////////////////////////////////////////////////
+ParameterEntry *ParametersRegistryPrivate::Entry(
+  const std::string &_name) const
+{
+  // Only the writers replace the map, so no atomic load is needed.
+  auto it = this->parametersMap->find(_name);
+  if (it == this->parametersMap->end())
+    return nullptr;
+  return it->second.get();
+}
+
+//////////////////////////////////////////////////
+bool ParametersRegistryPrivate::Declare(const std::string &_name,
+  std::shared_ptr<const google::protobuf::Message> _value)
+{
+  if (this->Entry(_name))
+    return false;
+  auto map = std::make_shared<ParametersMapT>(*this->parametersMap);
+  auto entry = std::make_shared<ParameterEntry>();
+  entry->value = std::move(_value);
+  map->emplace(_name, entry);
+  std::atomic_store(&this->parametersMap,
+    std::shared_ptr<const ParametersMapT>(std::move(map)));
+  ++this->version;
+  this->PublishUpdate(_name, *entry->value);
+  return true;
+}
+
+//////////////////////////////////////////////////
+void ParametersRegistryPrivate::Set(const std::string &_name,
+  ParameterEntry &_entry,
+  std::shared_ptr<const google::protobuf::Message> _value)
+{
+  std::atomic_store(&_entry.value, _value);
+  ++this->version;
+  this->PublishUpdate(_name, *_value);
+}
+
+//////////////////////////////////////////////////
+void ParametersRegistryPrivate::PublishUpdate(const std::string &_name,
+  const google::protobuf::Message &_value)
+{
+  if (!this->updatesPub.HasConnections())
+    return;
+
+  msgs::Parameter msg;
+  msg.set_name(_name);
+  msg.mutable_value()->PackFrom(_value, "gz_msgs");
+  this->updatesPub.Publish(msg);
+}
+
 //////////////////////////////////////////////////
 bool ParametersRegistryPrivate::GetParameter(const msgs::ParameterName &_req,
   msgs::ParameterValue &_res)
 {
-  {
-    std::lock_guard guard{this->parametersMapMutex};
-    auto it = this->parametersMap.find(_req.name());
-    if (it == this->parametersMap.end()) {
-      return false;
-    }
-    _res.mutable_data()->PackFrom(*it->second, "gz_msgs");
+  auto value = this->Find(_req.name());
+  if (!value) {
+    return false;
   }
+  _res.mutable_data()->PackFrom(*value, "gz_msgs");
   return true;
 }
 
@@ -138,14 +254,13 @@ bool ParametersRegistryPrivate::ListParameters(const msgs::Empty &,
   // maybe only names and types (?)
   // Including the component key doesn't seem to matter much,
   // though it's also not wrong.
-  {
-    std::lock_guard guard{this->parametersMapMutex};
-    for (const auto & paramPair : this->parametersMap) {
-      auto * decl = _res.add_parameter_declarations();
-      decl->set_name(paramPair.first);
-      decl->set_type(addGzMsgsPrefix(
-        paramPair.second->GetDescriptor()->name()));
-    }
+  auto map = std::atomic_load(&this->parametersMap);
+  for (const auto & paramPair : *map) {
+    auto * decl = _res.add_parameter_declarations();
+    decl->set_name(paramPair.first);
+    // The type of a parameter never changes, any value gives it.
+    auto value = std::atomic_load(&paramPair.second->value);
+    decl->set_type(addGzMsgsPrefix(value->GetDescriptor()->name()));
   }
   return true;
 }
@@ -157,9 +272,9 @@ bool ParametersRegistryPrivate::SetParameter(
   (void)_res;
   const auto & paramName = _req.name();
   {
-    std::lock_guard guard{this->parametersMapMutex};
-    auto it = this->parametersMap.find(paramName);
-    if (it == this->parametersMap.end()) {
+    std::lock_guard guard{this->writeMutex};
+    auto entry = this->Entry(paramName);
+    if (!entry) {
       _res.set_data(msgs::ParameterError::NOT_DECLARED);
       return true;
     }
@@ -170,14 +285,17 @@ bool ParametersRegistryPrivate::SetParameter(
       return true;
     }
     auto requestedGzType = *requestedGzTypeOpt;
-    if (it->second->GetDescriptor()->name() != requestedGzType) {
+    if (entry->value->GetDescriptor()->name() != requestedGzType) {
       _res.set_data(msgs::ParameterError::INVALID_TYPE);
       return true;
     }
-    if (!_req.value().UnpackTo(it->second.get())) {
+    std::shared_ptr<google::protobuf::Message> newValue{
+      entry->value->New()};
+    if (!_req.value().UnpackTo(newValue.get())) {
       // unexpected error
       return false;
     }
+    this->Set(paramName, *entry, std::move(newValue));
   }
   return true;
 }
@@ -202,11 +320,10 @@ bool ParametersRegistryPrivate::DeclareParameter(
     // unexpected error
     return false;
   }
-  std::lock_guard guard{this->parametersMapMutex};
-  auto it_emplaced_pair = this->parametersMap.emplace(
-    std::make_pair(_req.name(), std::move(paramValue)));
-  if (!it_emplaced_pair.second) {
+  std::lock_guard guard{this->writeMutex};
+  if (!this->Declare(_req.name(), std::move(paramValue))) {
     _res.set_data(msgs::ParameterError::ALREADY_DECLARED);
+    return true;
   }
   return true;
 }
@@ -221,10 +338,8 @@ ParametersRegistry::DeclareParameter(
     throw std::invalid_argument{
       "ParametersRegistry::DeclareParameter(): `_parameterName` is nullptr"};
   }
-  std::lock_guard guard{this->dataPtr->parametersMapMutex};
-  auto it_emplaced_pair = this->dataPtr->parametersMap.emplace(
-    std::make_pair(_parameterName, std::move(_initialValue)));
-  if (!it_emplaced_pair.second) {
+  std::lock_guard guard{this->dataPtr->writeMutex};
+  if (!this->dataPtr->Declare(_parameterName, std::move(_initialValue))) {
     return ParameterResult{
       ParameterResultType::AlreadyDeclared,
       _parameterName};
@@ -247,8 +362,7 @@ ParametersRegistry::DeclareParameter(
       protoType};
   }
   newParam->CopyFrom(_msg);
-  this->DeclareParameter(_parameterName, std::move(newParam));
-  return ParameterResult{ParameterResultType::Success};
+  return this->DeclareParameter(_parameterName, std::move(newParam));
 }
 
 //////////////////////////////////////////////////
@@ -257,22 +371,21 @@ ParametersRegistry::Parameter(
   const std::string & _parameterName,
   google::protobuf::Message & _parameter) const
 {
-  std::lock_guard guard{this->dataPtr->parametersMapMutex};
-  auto it = dataPtr->parametersMap.find(_parameterName);
-  if (it == dataPtr->parametersMap.end()) {
+  auto value = this->dataPtr->Find(_parameterName);
+  if (!value) {
     return ParameterResult{
       ParameterResultType::NotDeclared,
       _parameterName};
   }
   const auto & newProtoType = _parameter.GetDescriptor()->name();
-  const auto & protoType = it->second->GetDescriptor()->name();
+  const auto & protoType = value->GetDescriptor()->name();
   if (newProtoType != protoType) {
     return ParameterResult{
       ParameterResultType::InvalidType,
       _parameterName,
       addGzMsgsPrefix(protoType)};
   }
-  _parameter.CopyFrom(*it->second);
+  _parameter.CopyFrom(*value);
   return ParameterResult{ParameterResultType::Success};
 }
 
@@ -282,14 +395,13 @@ ParametersRegistry::Parameter(
   const std::string & _parameterName,
   std::unique_ptr<google::protobuf::Message> & _parameter) const
 {
-  std::lock_guard guard{this->dataPtr->parametersMapMutex};
-  auto it = dataPtr->parametersMap.find(_parameterName);
-  if (it == dataPtr->parametersMap.end()) {
+  auto value = this->dataPtr->Find(_parameterName);
+  if (!value) {
     return ParameterResult{
       ParameterResultType::NotDeclared,
       _parameterName};
   }
-  const auto & protoType = it->second->GetDescriptor()->name();
+  const auto & protoType = value->GetDescriptor()->name();
   _parameter = gz::msgs::Factory::New(protoType);
   if (!_parameter) {
     return ParameterResult{
@@ -298,7 +410,7 @@ ParametersRegistry::Parameter(
       addGzMsgsPrefix(protoType)};
 
   }
-  _parameter->CopyFrom(*it->second);
+  _parameter->CopyFrom(*value);
   return ParameterResult{ParameterResultType::Success};
 }
 
@@ -308,21 +420,21 @@ ParametersRegistry::SetParameter(
   const std::string & _parameterName,
   std::unique_ptr<google::protobuf::Message> _value)
 {
-  std::lock_guard guard{this->dataPtr->parametersMapMutex};
-  auto it = this->dataPtr->parametersMap.find(_parameterName);
-  if (it == this->dataPtr->parametersMap.end()) {
+  std::lock_guard guard{this->dataPtr->writeMutex};
+  auto entry = this->dataPtr->Entry(_parameterName);
+  if (!entry) {
     return ParameterResult{
       ParameterResultType::NotDeclared,
       _parameterName};
   }
   // Validate the type matches before copying.
-  if (it->second->GetDescriptor() != _value->GetDescriptor()) {
+  if (entry->value->GetDescriptor() != _value->GetDescriptor()) {
     return ParameterResult{
       ParameterResultType::InvalidType,
       _parameterName,
-      addGzMsgsPrefix(it->second->GetDescriptor()->name())};
+      addGzMsgsPrefix(entry->value->GetDescriptor()->name())};
   }
-  it->second = std::move(_value);
+  this->dataPtr->Set(_parameterName, *entry, std::move(_value));
   return ParameterResult{ParameterResultType::Success};
 }
 
@@ -332,20 +444,22 @@ ParametersRegistry::SetParameter(
   const std::string & _parameterName,
   const google::protobuf::Message & _value)
 {
-  std::lock_guard guard{this->dataPtr->parametersMapMutex};
-  auto it = this->dataPtr->parametersMap.find(_parameterName);
-  if (it == this->dataPtr->parametersMap.end()) {
+  std::lock_guard guard{this->dataPtr->writeMutex};
+  auto entry = this->dataPtr->Entry(_parameterName);
+  if (!entry) {
     return ParameterResult{
       ParameterResultType::NotDeclared,
       _parameterName};
   }
   // Validate the type matches before copying.
-  if (it->second->GetDescriptor() != _value.GetDescriptor()) {
+  if (entry->value->GetDescriptor() != _value.GetDescriptor()) {
     return ParameterResult{
       ParameterResultType::InvalidType,
       _parameterName};
   }
-  it->second->CopyFrom(_value);
+  std::shared_ptr<google::protobuf::Message> newValue{_value.New()};
+  newValue->CopyFrom(_value);
+  this->dataPtr->Set(_parameterName, *entry, std::move(newValue));
   return ParameterResult{ParameterResultType::Success};
 }
 
@@ -359,3 +473,17 @@ ParametersRegistry::ListParameters() const
   dataPtr->ListParameters(unused, ret);
   return ret;
 }
+
+//////////////////////////////////////////////////
+std::shared_ptr<const google::protobuf::Message>
+ParametersRegistry::ParameterSnapshot(
+  const std::string & _parameterName) const
+{
+  return this->dataPtr->Find(_parameterName);
+}
+
+//////////////////////////////////////////////////
+uint64_t ParametersRegistry::Version() const
+{
+  return this->dataPtr->version.load(std::memory_order_acquire);
+}
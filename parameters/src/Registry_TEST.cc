@@ -126,3 +126,34 @@ int main(int argc, char **argv)
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
 }
+
+//////////////////////////////////////////////////
+TEST(ParametersRegistry, ParameterSnapshot)
+{
+  ParametersRegistry registry{""};
+  EXPECT_EQ(nullptr, registry.ParameterSnapshot("not_declared"));
+  auto version = registry.Version();
+
+  auto msg = std::make_unique<gz::msgs::StringMsg>();
+  msg->set_data("first");
+  EXPECT_TRUE(registry.DeclareParameter("parameter1", std::move(msg)));
+  EXPECT_LT(version, registry.Version());
+  version = registry.Version();
+
+  auto first = registry.ParameterSnapshot<gz::msgs::StringMsg>("parameter1");
+  ASSERT_NE(nullptr, first);
+  EXPECT_EQ("first", first->data());
+  EXPECT_EQ(nullptr,
+    registry.ParameterSnapshot<gz::msgs::Boolean>("parameter1"));
+
+  // A set replaces the value, the old snapshot doesn't change.
+  gz::msgs::StringMsg second;
+  second.set_data("second");
+  EXPECT_TRUE(registry.SetParameter("parameter1", second));
+  EXPECT_LT(version, registry.Version());
+  EXPECT_EQ("first", first->data());
+  auto snapshot = registry.ParameterSnapshot<gz::msgs::StringMsg>(
+    "parameter1");
+  ASSERT_NE(nullptr, snapshot);
+  EXPECT_EQ("second", snapshot->data());
+}
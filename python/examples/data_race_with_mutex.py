@@ -14,7 +14,7 @@
 #
 
 from gz.msgs10.vector3d_pb2 import Vector3d
-from gz.transport13 import Node
+from gz.transport14 import Node
 
 from threading import Lock
 import time
@@ -15,7 +15,7 @@
 
 #! [complete]
 from gz.msgs10.stringmsg_pb2 import StringMsg
-from gz.transport13 import Node
+from gz.transport14 import Node
 
 def main():
     node = Node()
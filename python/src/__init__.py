@@ -15,6 +15,9 @@
 
 from ._transport import Node as _Node
 from ._transport import *
+import asyncio
+import inspect
+import itertools
 import sys
 from typing import TypeVar, Callable
 import traceback
@@ -54,6 +57,47 @@ class Publisher(_Node.Publisher):
         return self.publish_raw(msg_string, msg_type)
 
 
+class _AsyncDispatcher:
+    """
+    Dispatches the messages and the service responses queued by the
+    transport threads on the thread of an asyncio event loop. The loop is
+    woken up through the file descriptor of an AsyncQueue.
+
+    """
+
+    def __init__(self, loop):
+        self.loop = loop
+        self.queue = _transport.AsyncQueue()
+        self.handlers = {}
+        self.tokens = itertools.count()
+        if self.queue.fileno() < 0:
+            raise RuntimeError("asyncio is not supported on this platform")
+        loop.add_reader(self.queue.fileno(), self._drain)
+
+    def add(self, handler: Callable, once: bool):
+        token = next(self.tokens)
+        self.handlers[token] = (handler, once)
+        return token
+
+    def remove(self, token: int):
+        self.handlers.pop(token, None)
+
+    def close(self):
+        self.loop.remove_reader(self.queue.fileno())
+
+    def _drain(self):
+        for token, data, result in self.queue.drain():
+            handler, once = self.handlers.get(token, (None, False))
+            if handler is None:
+                continue
+            if once:
+                del self.handlers[token]
+            try:
+                handler(data, result)
+            except Exception:
+                print(traceback.format_exc(), file=sys.stderr)
+
+
 class Node(_Node):
     """
     A wrapper class that extends the _Node class for managing
@@ -120,6 +164,111 @@ class Node(_Node):
             topic, cb_deserialize, msg_type.DESCRIPTOR.full_name, options
         )
 
+    def _async_dispatcher(self):
+        loop = asyncio.get_running_loop()
+        dispatcher = getattr(self, "_dispatcher", None)
+        if dispatcher is None or dispatcher.loop is not loop:
+            if dispatcher is not None and not dispatcher.loop.is_closed():
+                dispatcher.close()
+            dispatcher = _AsyncDispatcher(loop)
+            self._dispatcher = dispatcher
+        return dispatcher
+
+    async def subscribe_async(
+        self,
+        msg_type: ProtoMsg,
+        topic: str,
+        callback: Callable,
+        options=_transport.SubscribeOptions(),
+    ):
+        """
+        Subscribes to a topic and invokes a callback for each received
+        message on the thread of the running asyncio event loop. The
+        callback may be a coroutine function, it's then scheduled as a task.
+
+        Args:
+            msg_type (ProtoMsg): The type of the messages to subscribe to.
+            topic (str): The name of the topic to subscribe to.
+            callback (Callable): The callback function to be invoked
+            options (SubscribeOptions): Options for subscribing to
+              the topic. Defaults to SubscribeOptions().
+
+        Returns:
+            bool: True if the subscription succeeded.
+
+        """
+        dispatcher = self._async_dispatcher()
+
+        def cb_deserialize(data, _result):
+            msg = msg_type()
+            msg.ParseFromString(data)
+            if inspect.iscoroutinefunction(callback):
+                dispatcher.loop.create_task(callback(msg))
+            else:
+                callback(msg)
+
+        token = dispatcher.add(cb_deserialize, once=False)
+        if not self.subscribe_raw_async(dispatcher.queue, token, topic,
+                                        msg_type.DESCRIPTOR.full_name,
+                                        options):
+            dispatcher.remove(token)
+            return False
+        return True
+
+    async def request_async(
+        self,
+        service: str,
+        request: ProtoMsg,
+        request_type: ProtoMsgType,
+        response_type: ProtoMsgType,
+        timeout: int,
+    ):
+        """
+        Sends a request to a service and awaits the response without
+        blocking the running asyncio event loop, so many requests can be in
+        flight on a single thread.
+
+        Args:
+            service (str): The name of the service to send the request to.
+            request (ProtoMsg): The request message to be sent.
+            request_type (ProtoMsgType): The type of the request.
+            response_type (ProtoMsgType): The expected type of the response.
+            timeout (int): The maximum time (in ms) to wait for a response.
+              Zero means no timeout.
+
+        Returns:
+            tuple: A tuple containing the result of the request (bool) and the
+              deserialized response message.
+
+        """
+        dispatcher = self._async_dispatcher()
+        future = dispatcher.loop.create_future()
+
+        def on_response(data, result):
+            if not future.done():
+                future.set_result((data, result))
+
+        token = dispatcher.add(on_response, once=True)
+        if not self.request_raw_async(
+            dispatcher.queue,
+            token,
+            service,
+            request.SerializeToString(),
+            request_type.DESCRIPTOR.full_name,
+            response_type.DESCRIPTOR.full_name,
+            timeout,
+        ):
+            dispatcher.remove(token)
+            return False, response_type()
+
+        try:
+            serialized_response, result = await future
+        finally:
+            dispatcher.remove(token)
+        deserialized_response = response_type()
+        deserialized_response.ParseFromString(serialized_response)
+        return result, deserialized_response
+
     def request(
         self,
         service: str,
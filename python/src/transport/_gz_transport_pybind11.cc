@@ -16,6 +16,11 @@
  *
 */
 
+#ifndef _WIN32
+  #include <fcntl.h>
+  #include <unistd.h>
+#endif
+
 #include <google/protobuf/message.h>
 #include <gz/transport/Node.hh>
 
@@ -23,9 +28,18 @@
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
 #include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
 #include <tuple>
 #include <utility>
+#include <vector>
 
 namespace py = pybind11;
 
@@ -36,6 +50,288 @@ namespace transport
 namespace python
 {
 
+/// \brief A message received by a raw subscription queue. Python reads it
+/// through the buffer protocol, e.g. memoryview(msg), without copying it.
+struct RawMessage
+{
+  /// \brief The serialized message.
+  std::string data;
+
+  /// \brief Topic of the message.
+  std::string topic;
+
+  /// \brief Name of the message type.
+  std::string msgType;
+};
+
+/// \brief Queue filled by a raw subscription on the threads of the
+/// transport without taking the GIL, and emptied by Python in batches, so
+/// the GIL is taken once per batch instead of once per message.
+class RawMessageQueue
+{
+  /// \brief Constructor.
+  /// \param[in] _depth Maximum number of queued messages, the oldest
+  /// message is dropped when it's reached. 0 means no limit.
+  public: explicit RawMessageQueue(const std::size_t _depth)
+    : depth(_depth)
+  {
+  }
+
+  /// \brief Queue a message. Called by the transport, without the GIL.
+  /// \param[in] _data The serialized message.
+  /// \param[in] _size Size of the message (bytes).
+  /// \param[in] _info Information about the message.
+  public: void Push(const char *_data, const std::size_t _size,
+                    const MessageInfo &_info)
+  {
+    auto msg = std::make_shared<RawMessage>();
+    msg->data.assign(_data, _size);
+    msg->topic = _info.Topic();
+    msg->msgType = _info.Type();
+    {
+      std::lock_guard<std::mutex> lk(this->mutex);
+      if (this->depth > 0 && this->messages.size() >= this->depth)
+      {
+        this->messages.pop_front();
+        ++this->dropped;
+      }
+      this->messages.push_back(std::move(msg));
+    }
+    this->cv.notify_one();
+  }
+
+  /// \brief Take the queued messages, oldest first. Called without the
+  /// GIL.
+  /// \param[in] _max Maximum number of messages, 0 for all of them.
+  /// \param[in] _timeout Time (ms) to wait for a message if the queue is
+  /// empty. 0 doesn't wait, a negative value waits forever.
+  /// \return The messages.
+  public: std::vector<std::shared_ptr<RawMessage>> Take(
+    const std::size_t _max, const int _timeout)
+  {
+    std::unique_lock<std::mutex> lk(this->mutex);
+    auto ready = [this]{return !this->messages.empty();};
+    if (_timeout < 0)
+      this->cv.wait(lk, ready);
+    else if (_timeout > 0)
+      this->cv.wait_for(lk, std::chrono::milliseconds(_timeout), ready);
+
+    const std::size_t n = _max == 0 ? this->messages.size() :
+      std::min(_max, this->messages.size());
+    std::vector<std::shared_ptr<RawMessage>> result(
+      std::make_move_iterator(this->messages.begin()),
+      std::make_move_iterator(this->messages.begin() + n));
+    this->messages.erase(this->messages.begin(), this->messages.begin() + n);
+    return result;
+  }
+
+  /// \brief Number of queued messages.
+  /// \return The number of messages.
+  public: std::size_t Size()
+  {
+    std::lock_guard<std::mutex> lk(this->mutex);
+    return this->messages.size();
+  }
+
+  /// \brief Number of messages dropped because the queue was full.
+  /// \return The number of messages.
+  public: uint64_t Dropped()
+  {
+    std::lock_guard<std::mutex> lk(this->mutex);
+    return this->dropped;
+  }
+
+  /// \brief Maximum number of queued messages, 0 means no limit.
+  private: const std::size_t depth;
+
+  /// \brief Protects messages and dropped.
+  private: std::mutex mutex;
+
+  /// \brief Notified when a message is queued.
+  private: std::condition_variable cv;
+
+  /// \brief The queued messages, oldest first.
+  private: std::deque<std::shared_ptr<RawMessage>> messages;
+
+  /// \brief Number of messages dropped.
+  private: uint64_t dropped = 0;
+};
+
+/// \brief A message or a service response waiting for the asyncio event
+/// loop, see AsyncQueue.
+struct AsyncCompletion
+{
+  /// \brief Token of the subscription or the request, chosen by Python.
+  uint64_t token;
+
+  /// \brief The serialized message or response.
+  std::string data;
+
+  /// \brief Result of the service call, always true for a message.
+  bool result;
+};
+
+/// \brief Queue of the messages and the service responses for an asyncio
+/// event loop. It's filled by the threads of the transport without the GIL.
+/// A pipe becomes readable when the queue isn't empty, so the loop wakes
+/// up (loop.add_reader) and drains the queue on its own thread. Thousands
+/// of requests can then be in flight on a single Python thread.
+class AsyncQueue
+{
+  /// \brief Constructor.
+  public: AsyncQueue()
+  {
+#ifndef _WIN32
+    if (pipe(this->fds) != 0)
+    {
+      this->fds[0] = this->fds[1] = -1;
+      return;
+    }
+
+    for (int fd : this->fds)
+    {
+      fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+      fcntl(fd, F_SETFD, FD_CLOEXEC);
+    }
+#endif
+  }
+
+  /// \brief Destructor.
+  public: ~AsyncQueue()
+  {
+#ifndef _WIN32
+    if (this->fds[0] >= 0)
+    {
+      close(this->fds[0]);
+      close(this->fds[1]);
+    }
+#endif
+  }
+
+  /// \brief Queue a completion and wake up the event loop. Called by the
+  /// transport, without the GIL.
+  /// \param[in] _token Token of the subscription or the request.
+  /// \param[in] _data The serialized message or response.
+  /// \param[in] _result Result of the service call.
+  public: void Push(const uint64_t _token, std::string _data,
+                    const bool _result)
+  {
+    std::lock_guard<std::mutex> lk(this->mutex);
+    this->completions.push_back({_token, std::move(_data), _result});
+#ifndef _WIN32
+    if (this->completions.size() == 1 && this->fds[1] >= 0)
+    {
+      const char byte = 1;
+      if (write(this->fds[1], &byte, 1) < 0)
+      {
+        // The pipe is full, so it's already readable.
+      }
+    }
+#endif
+  }
+
+  /// \brief Take all the completions. Called by the event loop.
+  /// \return The completions, oldest first.
+  public: std::deque<AsyncCompletion> Drain()
+  {
+    std::lock_guard<std::mutex> lk(this->mutex);
+#ifndef _WIN32
+    char bytes[64];
+    while (this->fds[0] >= 0 && read(this->fds[0], bytes, sizeof(bytes)) > 0)
+    {
+    }
+#endif
+    return std::exchange(this->completions, {});
+  }
+
+  /// \brief File descriptor readable when completions are queued.
+  /// \return The file descriptor or -1 on Windows.
+  public: int FileNo() const
+  {
+    return this->fds[0];
+  }
+
+  /// \brief Protects completions.
+  private: std::mutex mutex;
+
+  /// \brief The queued completions, oldest first.
+  private: std::deque<AsyncCompletion> completions;
+
+  /// \brief Read and write ends of the wake up pipe.
+  private: int fds[2] = {-1, -1};
+};
+
+/// \brief Views of the Python objects published with publish_buffer,
+/// released once the transport sent them. The transport drops its loans on
+/// its own threads, where taking the GIL could stall the publishers, so the
+/// views are queued without the GIL and released later by the interpreter
+/// (Py_AddPendingCall), by the next publish_buffer or at exit.
+class BufferReleaseQueue
+{
+  /// \brief Get the queue of the module. It's never destroyed because the
+  /// transport can drop its loans after the static destructors.
+  /// \return The queue.
+  public: static BufferReleaseQueue &Instance()
+  {
+    static auto *queue = new BufferReleaseQueue();
+    return *queue;
+  }
+
+  /// \brief Queue a view. Called by the transport, without the GIL.
+  /// \param[in] _view The view, released and deleted later.
+  public: void Push(Py_buffer *_view)
+  {
+    // The objects are gone with the interpreter.
+    if (!Py_IsInitialized())
+      return;
+
+    bool schedule;
+    {
+      std::lock_guard<std::mutex> lk(this->mutex);
+      schedule = this->views.empty();
+      this->views.push_back(_view);
+    }
+
+    // If the interpreter can't take the call, the views are released by
+    // the next publish_buffer or at exit.
+    if (schedule)
+      Py_AddPendingCall(&BufferReleaseQueue::PendingCall, nullptr);
+  }
+
+  /// \brief Release the queued views. Called with the GIL.
+  public: void Release()
+  {
+    std::vector<Py_buffer *> pending;
+    {
+      std::lock_guard<std::mutex> lk(this->mutex);
+      pending.swap(this->views);
+    }
+
+    if (!Py_IsInitialized())
+      return;
+
+    for (auto *view : pending)
+    {
+      PyBuffer_Release(view);
+      delete view;
+    }
+  }
+
+  /// \brief Callback of Py_AddPendingCall.
+  /// \return Always 0.
+  private: static int PendingCall(void *)
+  {
+    Instance().Release();
+    return 0;
+  }
+
+  /// \brief Protects views.
+  private: std::mutex mutex;
+
+  /// \brief The views waiting for the GIL.
+  private: std::vector<Py_buffer *> views;
+};
+
 PYBIND11_MODULE(BINDINGS_MODULE_NAME, m) {
     py::class_<AdvertiseOptions>(
       m, "AdvertiseOptions",
@@ -68,6 +364,10 @@ PYBIND11_MODULE(BINDINGS_MODULE_NAME, m) {
           &AdvertiseMessageOptions::MsgsPerSec,
           &AdvertiseMessageOptions::SetMsgsPerSec,
           "The maximum number of messages per second to be published")
+      .def_property("buffer_pool_size",
+          &AdvertiseMessageOptions::BufferPoolSize,
+          &AdvertiseMessageOptions::SetBufferPoolSize,
+          "The maximum memory (bytes) cached by the serialization buffer pool")
       .def("__copy__", 
           [](const AdvertiseMessageOptions &self)
           {
@@ -123,6 +423,12 @@ PYBIND11_MODULE(BINDINGS_MODULE_NAME, m) {
             return NodeOptions(self);
           });
 
+    py::enum_<QueuePolicy_t>(m, "QueuePolicy",
+      "Policy applied when the intra-process queue of a subscription is full")
+      .value("DROP_OLDEST", QueuePolicy_t::DROP_OLDEST)
+      .value("DROP_NEWEST", QueuePolicy_t::DROP_NEWEST)
+      .value("BLOCK_PUBLISHER", QueuePolicy_t::BLOCK_PUBLISHER);
+
     py::class_<SubscribeOptions>(
       m, "SubscribeOptions",
       "A class to provide different options for a subscription")
@@ -135,6 +441,22 @@ PYBIND11_MODULE(BINDINGS_MODULE_NAME, m) {
           &SubscribeOptions::MsgsPerSec,
           &SubscribeOptions::SetMsgsPerSec,
           "Set the maximum number of messages per second received per topic")
+      .def_property("queue_depth",
+          &SubscribeOptions::QueueDepth,
+          &SubscribeOptions::SetQueueDepth,
+          "Set the maximum number of pending intra-process messages")
+      .def_property("queue_policy",
+          &SubscribeOptions::QueuePolicy,
+          &SubscribeOptions::SetQueuePolicy,
+          "Set the policy applied when the intra-process queue is full")
+      .def_property("conflate",
+          &SubscribeOptions::Conflate,
+          &SubscribeOptions::SetConflate,
+          "Only deliver the newest pending message of the topic")
+      .def_property("async_callbacks",
+          &SubscribeOptions::AsyncCallbacks,
+          &SubscribeOptions::SetAsyncCallbacks,
+          "Run the callbacks of remote messages on the dispatch threads")
       .def("__copy__", 
           [](const SubscribeOptions &self)
           {
@@ -153,6 +475,74 @@ PYBIND11_MODULE(BINDINGS_MODULE_NAME, m) {
       "A class that provides information about the message received.")
       .def(py::init<>());
 
+    py::class_<RawMessage, std::shared_ptr<RawMessage>>(
+      m, "RawMessage", py::buffer_protocol(),
+      "A serialized message received by a RawMessageQueue. It supports the"
+      " buffer protocol, so memoryview(msg) reads it without a copy.")
+      .def_buffer([](RawMessage &_msg) -> py::buffer_info
+          {
+            return py::buffer_info(_msg.data.data(), _msg.data.size(),
+                true);
+          })
+      .def("__len__", [](const RawMessage &_msg)
+          {
+            return _msg.data.size();
+          })
+      .def_property_readonly("topic", [](const RawMessage &_msg)
+          {
+            return _msg.topic;
+          },
+          "Get the topic of the message.")
+      .def_property_readonly("msg_type", [](const RawMessage &_msg)
+          {
+            return _msg.msgType;
+          },
+          "Get the name of the message type.");
+
+    py::class_<RawMessageQueue, std::shared_ptr<RawMessageQueue>>(
+      m, "RawMessageQueue",
+      "The messages of a subscription queued without taking the GIL, see"
+      " Node.subscribe_raw_queue.")
+      .def("take", [](RawMessageQueue &_queue, const std::size_t _max,
+                      const int _timeout)
+          {
+            py::gil_scoped_release release;
+            return _queue.Take(_max, _timeout);
+          },
+          py::arg("max_messages") = 0,
+          py::arg("timeout") = 0,
+          "Take the queued messages, oldest first. Wait at most timeout ms"
+          " for a message if the queue is empty, forever if negative."
+          " max_messages = 0 takes all of them.")
+      .def("__len__", &RawMessageQueue::Size)
+      .def_property_readonly("dropped", &RawMessageQueue::Dropped,
+          "Get the number of messages dropped because the queue was full.");
+
+    py::class_<AsyncQueue, std::shared_ptr<AsyncQueue>>(
+      m, "AsyncQueue",
+      "Messages and service responses queued for an asyncio event loop."
+      " Use Node.subscribe_async and Node.request_async instead.")
+      .def(py::init<>())
+      .def("fileno", &AsyncQueue::FileNo,
+          "Get the file descriptor readable when completions are queued,"
+          " -1 if not supported.")
+      .def("drain", [](AsyncQueue &_queue)
+          {
+            std::deque<AsyncCompletion> completions;
+            {
+              py::gil_scoped_release release;
+              completions = _queue.Drain();
+            }
+            py::list result;
+            for (const auto &completion : completions)
+            {
+              result.append(py::make_tuple(completion.token,
+                py::bytes(completion.data), completion.result));
+            }
+            return result;
+          },
+          "Take the queued (token, data, result) tuples, oldest first.");
+
     py::class_<MessagePublisher>(
       m, "MessagePublisher",
       "This class stores all the information about a message publisher.")
@@ -224,8 +614,12 @@ PYBIND11_MODULE(BINDINGS_MODULE_NAME, m) {
           {
             bool result{false};
             std::string _response;
-            result = _node.RequestRaw(_service, _request, _reqType,
-                            _repType, _timeout, _response, result);
+            {
+              // Other Python threads run while waiting for the response.
+              py::gil_scoped_release release;
+              result = _node.RequestRaw(_service, _request, _reqType,
+                              _repType, _timeout, _response, result);
+            }
             return py::make_tuple(result, py::bytes(_response.c_str(), _response.size()));
           },
           py::arg("topic"),
@@ -235,6 +629,34 @@ PYBIND11_MODULE(BINDINGS_MODULE_NAME, m) {
           py::arg("timeout"),
           "Request a new service without input parameter using"
           " a blocking call")
+      // Send a service request without blocking, the response is queued
+      .def("request_raw_async", [](
+          Node &_node,
+          std::shared_ptr<AsyncQueue> _queue,
+          const uint64_t _token,
+          const std::string &_service,
+          const std::string &_request,
+          const std::string &_reqType,
+          const std::string &_repType,
+          const unsigned int _timeout)
+          {
+            py::gil_scoped_release release;
+            return _node.RequestRaw(_service, _request, _reqType, _repType,
+              _timeout, [_queue, _token](const std::string &_response,
+                                         const bool _result)
+              {
+                _queue->Push(_token, _response, _result);
+              });
+          },
+          py::arg("queue"),
+          py::arg("token"),
+          py::arg("topic"),
+          py::arg("request"),
+          py::arg("request_type"),
+          py::arg("response_type"),
+          py::arg("timeout"),
+          "Request a service without blocking. The response is queued in"
+          " queue with token")
       .def("topic_list", [](
           Node &_node)
           {
@@ -291,6 +713,52 @@ PYBIND11_MODULE(BINDINGS_MODULE_NAME, m) {
           py::arg("callback"),
           py::arg("msg_type"),
           py::arg("options"))
+      .def("subscribe_raw_async", [](
+          Node &_node,
+          std::shared_ptr<AsyncQueue> _queue,
+          const uint64_t _token,
+          const std::string &_topic,
+          const std::string &_msgType,
+          const SubscribeOptions &_opts)
+          {
+            auto _cb = [_queue, _token](const char *_msgData,
+                           const size_t _size, const MessageInfo &)
+            {
+              _queue->Push(_token, std::string(_msgData, _size), true);
+            };
+            return _node.SubscribeRaw(_topic, _cb, _msgType, _opts);
+          },
+          py::arg("queue"),
+          py::arg("token"),
+          py::arg("topic"),
+          py::arg("msg_type"),
+          py::arg("options"),
+          "Subscribe to a topic and queue its messages in queue with token")
+      .def("subscribe_raw_queue", [](
+          Node &_node,
+          const std::string &_topic,
+          const std::string &_msgType,
+          const SubscribeOptions &_opts,
+          const std::size_t _depth)
+          {
+            auto queue = std::make_shared<RawMessageQueue>(_depth);
+            auto _cb = [queue](const char *_msgData, const size_t _size,
+                           const MessageInfo &_info)
+            {
+              queue->Push(_msgData, _size, _info);
+            };
+            if (!_node.SubscribeRaw(_topic, _cb, _msgType, _opts))
+              queue.reset();
+            return queue;
+          },
+          py::arg("topic"),
+          py::arg("msg_type"),
+          py::arg("options"),
+          py::arg("depth") = 0,
+          "Subscribe to a topic and queue its serialized messages without"
+          " taking the GIL. The messages are taken in batches with"
+          " RawMessageQueue.take. At most depth messages are queued, 0"
+          " means no limit. Return None on error.")
       .def_property_readonly("options", &Node::Options,
           "Get the reference to the current node options.")
       .def("enable_stats", &Node::EnableStats,
@@ -316,14 +784,52 @@ PYBIND11_MODULE(BINDINGS_MODULE_NAME, m) {
           " topic name, is present.")
       .def("publish_raw", &gz::transport::Node::Publisher::PublishRaw,
           py::arg("msg_data"),
-          py::arg("msg_type"))
+          py::arg("msg_type"),
+          py::call_guard<py::gil_scoped_release>())
+      .def("publish_buffer", [](
+          gz::transport::Node::Publisher &_pub,
+          py::buffer _data,
+          const std::string &_msgType)
+          {
+            // The transport keeps a view of the Python object until the
+            // message is sent, so it's never copied.
+            BufferReleaseQueue::Instance().Release();
+            auto view = new Py_buffer();
+            if (PyObject_GetBuffer(_data.ptr(), view,
+                                   PyBUF_C_CONTIGUOUS) != 0)
+            {
+              delete view;
+              throw py::error_already_set();
+            }
+
+            auto loan = _pub.Adopt(static_cast<char *>(view->buf),
+              static_cast<std::size_t>(view->len),
+              [view](char *)
+              {
+                BufferReleaseQueue::Instance().Push(view);
+              });
+            py::gil_scoped_release release;
+            return _pub.PublishLoaned(std::move(loan), _msgType);
+          },
+          py::arg("msg_data"),
+          py::arg("msg_type"),
+          "Publish a serialized message stored in an object supporting the"
+          " buffer protocol, such as bytes, bytearray or a numpy array,"
+          " without copying it. Don't modify the object until the"
+          " subscribers received the message.")
       .def("throttled_update_ready",
           &gz::transport::Node::Publisher::ThrottledUpdateReady,
           "")
       .def("has_connections",
           &gz::transport::Node::Publisher::HasConnections,
           "Return true if this publisher has subscribers");
-}  // gz-transport13 module
+
+    // Release the views of the messages sent since the last pending call.
+    py::module_::import("atexit").attr("register")(py::cpp_function([]()
+      {
+        BufferReleaseQueue::Instance().Release();
+      }));
+}  // gz-transport14 module
 
 }  // python
 }  // transport
@@ -1,5 +1,5 @@
 from gz.msgs10.stringmsg_pb2 import StringMsg
-from gz.transport13 import Node, AdvertiseMessageOptions, SubscribeOptions, NodeOptions
+from gz.transport14 import Node, AdvertiseMessageOptions, SubscribeOptions, NodeOptions, QueuePolicy
 
 import unittest
 
@@ -30,6 +30,21 @@ class OptionsTEST(unittest.TestCase):
         self.assertEqual(opts.msgs_per_sec, msgs_per_sec)
         self.assertTrue(opts.throttled)
 
+        self.assertEqual(opts.queue_depth, 0)
+        self.assertEqual(opts.queue_policy, QueuePolicy.DROP_OLDEST)
+        opts.queue_depth = 5
+        opts.queue_policy = QueuePolicy.DROP_NEWEST
+        self.assertEqual(opts.queue_depth, 5)
+        self.assertEqual(opts.queue_policy, QueuePolicy.DROP_NEWEST)
+
+        self.assertFalse(opts.conflate)
+        opts.conflate = True
+        self.assertTrue(opts.conflate)
+
+        self.assertFalse(opts.async_callbacks)
+        opts.async_callbacks = True
+        self.assertTrue(opts.async_callbacks)
+
         node = Node()
         self.assertTrue(
             node.subscribe(StringMsg, "/test_topic", self.stringmsg_cb, opts)
@@ -15,10 +15,11 @@
 
 from gz.msgs10.stringmsg_pb2 import StringMsg
 from gz.msgs10.vector3d_pb2 import Vector3d
-from gz.transport13 import Node, AdvertiseMessageOptions, SubscribeOptions, TopicStatistics
+from gz.transport14 import Node, AdvertiseMessageOptions, SubscribeOptions, TopicStatistics
 
 from threading import Lock
 
+import asyncio
 import time
 import unittest
 
@@ -174,6 +175,64 @@ class PubSubTEST(unittest.TestCase):
         self.assertTrue(sub_node.unsubscribe(throttle_topic))
         self.assertFalse(pub.has_connections())
 
+    # Checks the raw subscriptions queued without the GIL and the
+    # publications of buffers.
+    def test_raw_queue(self):
+        sub_node = Node()
+        queue = sub_node.subscribe_raw_queue(
+            self.vector3d_topic, Vector3d.DESCRIPTOR.full_name,
+            SubscribeOptions(), 2)
+        self.assertIsNotNone(queue)
+        self.assertEqual(len(queue.take()), 0)
+
+        serialized = self.vector3d_msg.SerializeToString()
+        self.assertTrue(self.pub.publish_buffer(
+            serialized, Vector3d.DESCRIPTOR.full_name))
+        self.assertTrue(self.pub.publish_buffer(
+            bytearray(serialized), Vector3d.DESCRIPTOR.full_name))
+        self.assertTrue(self.pub.publish(self.vector3d_msg))
+
+        # Wait until the 3 messages are delivered, the oldest one is
+        # dropped.
+        for _ in range(100):
+            if len(queue) + queue.dropped == 3:
+                break
+            time.sleep(0.01)
+        msgs = queue.take(max_messages=0, timeout=1000)
+        self.assertEqual(len(msgs), 2)
+        self.assertEqual(queue.dropped, 1)
+        for raw in msgs:
+            self.assertEqual(raw.topic, self.vector3d_topic)
+            self.assertEqual(raw.msg_type, Vector3d.DESCRIPTOR.full_name)
+            msg = Vector3d()
+            msg.ParseFromString(bytes(memoryview(raw)))
+            self.assertEqual(msg.x, self.vector3d_msg.x)
+        self.assertEqual(len(queue), 0)
+        self.assertTrue(sub_node.unsubscribe(self.vector3d_topic))
+
+    # Checks that the asynchronous subscriptions run the callbacks on the
+    # thread of the event loop.
+    def test_subscribe_async(self):
+        sub_node = Node()
+        received = []
+
+        async def callback(msg: Vector3d):
+            received.append(msg.x)
+
+        async def run():
+            self.assertTrue(await sub_node.subscribe_async(
+                Vector3d, self.vector3d_topic, callback))
+            for _ in range(3):
+                self.assertTrue(self.pub.publish(self.vector3d_msg))
+            for _ in range(100):
+                if len(received) == 3:
+                    break
+                await asyncio.sleep(0.01)
+
+        asyncio.run(run())
+        self.assertEqual(received, [self.vector3d_msg.x] * 3)
+        self.assertTrue(sub_node.unsubscribe(self.vector3d_topic))
+
     # Checks that the node is able to retrieve the list of topics.
     def test_topic_list(self):
         # Second Publisher set up
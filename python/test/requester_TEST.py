@@ -15,8 +15,9 @@
 
 from gz.msgs10.int32_pb2 import Int32
 from gz.msgs10.stringmsg_pb2 import StringMsg
-from gz.transport13 import Node
+from gz.transport14 import Node
 
+import asyncio
 import os
 import subprocess
 import unittest
@@ -71,6 +72,30 @@ class RequesterTEST(unittest.TestCase):
         self.assertFalse(result)
         self.assertNotEqual(response.data, self.request.data)
 
+    # Checks that many asynchronous requests are in flight on one thread.
+    def test_request_async(self):
+        async def run():
+            requests = []
+            for i in range(100):
+                request = Int32()
+                request.data = i
+                requests.append(self.node.request_async(
+                    self.service_name, request, Int32, Int32, self.timeout))
+            return await asyncio.gather(*requests)
+
+        responses = asyncio.run(run())
+        self.assertEqual(len(responses), 100)
+        for i, (result, response) in enumerate(responses):
+            self.assertTrue(result)
+            self.assertEqual(response.data, i)
+
+        async def run_wrong_type():
+            return await self.node.request_async(
+                self.service_name, self.request, StringMsg, Int32, self.timeout)
+
+        result, _ = asyncio.run(run_wrong_type())
+        self.assertFalse(result)
+
     # Checks that the node is able to retrieve the list of services.
     def test_service_list(self):
         services = self.node.service_list()
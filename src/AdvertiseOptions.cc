@@ -15,12 +15,17 @@
  *
 */
 
+#include <algorithm>
+#include <chrono>
 #include <cstdint>
 #include <cstring>
 #include <iostream>
+#include <string>
+#include <vector>
 
 #include "gz/transport/AdvertiseOptions.hh"
 #include "gz/transport/Helpers.hh"
+#include "gz/transport/TopicUtils.hh"
 
 using namespace gz;
 using namespace transport;
@@ -43,6 +48,9 @@ namespace gz
 
       /// \brief Default scope value.
       public: Scope_t scope = Scope_t::ALL;
+
+      /// \brief Priority class.
+      public: Priority_t priority = Priority_t::NORMAL;
     };
 
     /// \internal
@@ -57,6 +65,67 @@ namespace gz
 
       /// \brief Default message publication rate.
       public: uint64_t msgsPerSec = kUnthrottled;
+
+      /// \brief Rate of the message bucket, 0 for no limit.
+      public: uint64_t rateLimitMsgsPerSec = 0;
+
+      /// \brief Rate of the byte bucket, 0 for no limit.
+      public: uint64_t rateLimitBytesPerSec = 0;
+
+      /// \brief Size of the message bucket.
+      public: uint64_t rateLimitBurstMsgs = 0;
+
+      /// \brief Size of the byte bucket.
+      public: uint64_t rateLimitBurstBytes = 0;
+
+      /// \brief Maximum memory cached by the buffer pool (bytes).
+      public: uint64_t bufferPoolSize = 0;
+
+      /// \brief Kind of huge pages of the large buffers.
+      public: HugePages_t hugePages = HugePages_t::NONE;
+
+      /// \brief Size of the smallest buffer backed by huge pages (bytes).
+      public: uint64_t hugePagesMinSize = 2u << 20;
+
+      /// \brief Maximum delay of a batched message (microseconds).
+      public: uint64_t batchDelay = 0;
+
+      /// \brief Size that triggers sending a batch (bytes).
+      public: uint64_t batchSize = 65536;
+
+      /// \brief Codec used to compress the messages.
+      public: Compression_t compression = Compression_t::NONE;
+
+      /// \brief Compression level.
+      public: int compressionLevel = 0;
+
+      /// \brief Size of the smallest message compressed (bytes).
+      public: uint64_t compressionMinSize = 4096;
+
+      /// \brief Name of the publisher channel, empty for the shared socket.
+      public: std::string channel;
+
+      /// \brief Rate of the remote messages while a subscriber is slow.
+      public: uint64_t slowSubscriberMsgsPerSec = kUnthrottled;
+
+      /// \brief Whether the gaps in the publications are reported.
+      public: bool reliable = false;
+
+      /// \brief Number of messages kept for retransmission.
+      public: uint64_t historySize = 0;
+
+      /// \brief Number of messages delivered to the late joiners.
+      public: uint64_t historyDepth = 0;
+
+      /// \brief Multicast group of the data, empty for unicast.
+      public: std::string multicastGroup;
+
+      /// \brief Address of the interface of the data, empty for the one of
+      /// the node.
+      public: std::string interfaceIp;
+
+      /// \brief Other names of the topic.
+      public: std::vector<std::string> aliases;
     };
 
     /// \internal
@@ -68,6 +137,12 @@ namespace gz
 
       /// \brief Destructor.
       public: virtual ~AdvertiseServiceOptionsPrivate() = default;
+
+      /// \brief Number of requests processed at the same time.
+      public: uint32_t concurrency = 0;
+
+      /// \brief Time to live of the responses cached.
+      public: std::chrono::milliseconds cacheTtl{0};
     };
     }
   }
@@ -95,13 +170,15 @@ AdvertiseOptions::~AdvertiseOptions()
 AdvertiseOptions &AdvertiseOptions::operator=(const AdvertiseOptions &_other)
 {
   this->SetScope(_other.Scope());
+  this->SetPriority(_other.Priority());
   return *this;
 }
 
 //////////////////////////////////////////////////
 bool AdvertiseOptions::operator==(const AdvertiseOptions &_other) const
 {
-  return this->Scope() == _other.Scope();
+  return this->Scope() == _other.Scope() &&
+         this->Priority() == _other.Priority();
 }
 
 //////////////////////////////////////////////////
@@ -122,6 +199,18 @@ void AdvertiseOptions::SetScope(const Scope_t &_scope)
   this->dataPtr->scope = _scope;
 }
 
+//////////////////////////////////////////////////
+Priority_t AdvertiseOptions::Priority() const
+{
+  return this->dataPtr->priority;
+}
+
+//////////////////////////////////////////////////
+void AdvertiseOptions::SetPriority(const Priority_t _priority)
+{
+  this->dataPtr->priority = _priority;
+}
+
 //////////////////////////////////////////////////
 AdvertiseMessageOptions::AdvertiseMessageOptions()
   : AdvertiseOptions(),
@@ -148,6 +237,23 @@ AdvertiseMessageOptions &AdvertiseMessageOptions::operator=(
 {
   AdvertiseOptions::operator=(_other);
   this->SetMsgsPerSec(_other.MsgsPerSec());
+  this->SetRateLimit(_other.RateLimitMsgsPerSec(),
+    _other.RateLimitBytesPerSec(), _other.RateLimitBurstMsgs(),
+    _other.RateLimitBurstBytes());
+  this->SetBufferPoolSize(_other.BufferPoolSize());
+  this->SetHugePages(_other.HugePages(), _other.HugePagesMinSize());
+  this->SetBatchDelay(_other.BatchDelay());
+  this->SetBatchSize(_other.BatchSize());
+  this->SetCompression(_other.Compression(), _other.CompressionLevel(),
+    _other.CompressionMinSize());
+  this->SetChannel(_other.Channel());
+  this->SetSlowSubscriberMsgsPerSec(_other.SlowSubscriberMsgsPerSec());
+  this->SetReliable(_other.Reliable());
+  this->SetHistorySize(_other.HistorySize());
+  this->SetHistoryDepth(_other.HistoryDepth());
+  this->SetMulticastGroup(_other.MulticastGroup());
+  this->SetInterface(_other.Interface());
+  this->dataPtr->aliases = _other.dataPtr->aliases;
   return *this;
 }
 
@@ -156,7 +262,28 @@ bool AdvertiseMessageOptions::operator==(
   const AdvertiseMessageOptions &_other) const
 {
   return AdvertiseOptions::operator==(_other) &&
-         this->MsgsPerSec() == _other.MsgsPerSec();
+         this->MsgsPerSec() == _other.MsgsPerSec() &&
+         this->RateLimitMsgsPerSec() == _other.RateLimitMsgsPerSec() &&
+         this->RateLimitBytesPerSec() == _other.RateLimitBytesPerSec() &&
+         this->RateLimitBurstMsgs() == _other.RateLimitBurstMsgs() &&
+         this->RateLimitBurstBytes() == _other.RateLimitBurstBytes() &&
+         this->BufferPoolSize() == _other.BufferPoolSize() &&
+         this->HugePages() == _other.HugePages() &&
+         this->HugePagesMinSize() == _other.HugePagesMinSize() &&
+         this->BatchDelay() == _other.BatchDelay() &&
+         this->BatchSize() == _other.BatchSize() &&
+         this->Compression() == _other.Compression() &&
+         this->CompressionLevel() == _other.CompressionLevel() &&
+         this->CompressionMinSize() == _other.CompressionMinSize() &&
+         this->Channel() == _other.Channel() &&
+         this->SlowSubscriberMsgsPerSec() ==
+           _other.SlowSubscriberMsgsPerSec() &&
+         this->Reliable() == _other.Reliable() &&
+         this->HistorySize() == _other.HistorySize() &&
+         this->HistoryDepth() == _other.HistoryDepth() &&
+         this->MulticastGroup() == _other.MulticastGroup() &&
+         this->Interface() == _other.Interface() &&
+         this->Aliases() == _other.Aliases();
 }
 
 //////////////////////////////////////////////////
@@ -184,6 +311,251 @@ void AdvertiseMessageOptions::SetMsgsPerSec(const uint64_t _newMsgsPerSec)
   this->dataPtr->msgsPerSec = _newMsgsPerSec;
 }
 
+//////////////////////////////////////////////////
+bool AdvertiseMessageOptions::RateLimited() const
+{
+  return this->RateLimitMsgsPerSec() > 0 || this->RateLimitBytesPerSec() > 0;
+}
+
+//////////////////////////////////////////////////
+uint64_t AdvertiseMessageOptions::RateLimitMsgsPerSec() const
+{
+  return this->dataPtr->rateLimitMsgsPerSec;
+}
+
+//////////////////////////////////////////////////
+uint64_t AdvertiseMessageOptions::RateLimitBytesPerSec() const
+{
+  return this->dataPtr->rateLimitBytesPerSec;
+}
+
+//////////////////////////////////////////////////
+uint64_t AdvertiseMessageOptions::RateLimitBurstMsgs() const
+{
+  return this->dataPtr->rateLimitBurstMsgs;
+}
+
+//////////////////////////////////////////////////
+uint64_t AdvertiseMessageOptions::RateLimitBurstBytes() const
+{
+  return this->dataPtr->rateLimitBurstBytes;
+}
+
+//////////////////////////////////////////////////
+void AdvertiseMessageOptions::SetRateLimit(const uint64_t _msgsPerSec,
+  const uint64_t _bytesPerSec, const uint64_t _burstMsgs,
+  const uint64_t _burstBytes)
+{
+  this->dataPtr->rateLimitMsgsPerSec = _msgsPerSec;
+  this->dataPtr->rateLimitBytesPerSec = _bytesPerSec;
+  this->dataPtr->rateLimitBurstMsgs =
+    _msgsPerSec == 0 ? 0 : (_burstMsgs > 0 ? _burstMsgs : _msgsPerSec);
+  this->dataPtr->rateLimitBurstBytes =
+    _bytesPerSec == 0 ? 0 : (_burstBytes > 0 ? _burstBytes : _bytesPerSec);
+}
+
+//////////////////////////////////////////////////
+uint64_t AdvertiseMessageOptions::BufferPoolSize() const
+{
+  return this->dataPtr->bufferPoolSize;
+}
+
+//////////////////////////////////////////////////
+void AdvertiseMessageOptions::SetBufferPoolSize(const uint64_t _bytes)
+{
+  this->dataPtr->bufferPoolSize = _bytes;
+}
+
+//////////////////////////////////////////////////
+HugePages_t AdvertiseMessageOptions::HugePages() const
+{
+  return this->dataPtr->hugePages;
+}
+
+//////////////////////////////////////////////////
+uint64_t AdvertiseMessageOptions::HugePagesMinSize() const
+{
+  return this->dataPtr->hugePagesMinSize;
+}
+
+//////////////////////////////////////////////////
+void AdvertiseMessageOptions::SetHugePages(const HugePages_t _mode,
+  const uint64_t _minSize)
+{
+  this->dataPtr->hugePages = _mode;
+  this->dataPtr->hugePagesMinSize = _minSize;
+}
+
+//////////////////////////////////////////////////
+bool AdvertiseMessageOptions::Batched() const
+{
+  return this->BatchDelay() > 0;
+}
+
+//////////////////////////////////////////////////
+uint64_t AdvertiseMessageOptions::BatchDelay() const
+{
+  return this->dataPtr->batchDelay;
+}
+
+//////////////////////////////////////////////////
+void AdvertiseMessageOptions::SetBatchDelay(const uint64_t _usec)
+{
+  this->dataPtr->batchDelay = _usec;
+}
+
+//////////////////////////////////////////////////
+uint64_t AdvertiseMessageOptions::BatchSize() const
+{
+  return this->dataPtr->batchSize;
+}
+
+//////////////////////////////////////////////////
+void AdvertiseMessageOptions::SetBatchSize(const uint64_t _bytes)
+{
+  this->dataPtr->batchSize = _bytes;
+}
+
+//////////////////////////////////////////////////
+Compression_t AdvertiseMessageOptions::Compression() const
+{
+  return this->dataPtr->compression;
+}
+
+//////////////////////////////////////////////////
+int AdvertiseMessageOptions::CompressionLevel() const
+{
+  return this->dataPtr->compressionLevel;
+}
+
+//////////////////////////////////////////////////
+uint64_t AdvertiseMessageOptions::CompressionMinSize() const
+{
+  return this->dataPtr->compressionMinSize;
+}
+
+//////////////////////////////////////////////////
+void AdvertiseMessageOptions::SetCompression(const Compression_t _codec,
+  const int _level, const uint64_t _minSize)
+{
+  this->dataPtr->compression = _codec;
+  this->dataPtr->compressionLevel = _level;
+  this->dataPtr->compressionMinSize = _minSize;
+}
+
+//////////////////////////////////////////////////
+std::string AdvertiseMessageOptions::Channel() const
+{
+  return this->dataPtr->channel;
+}
+
+//////////////////////////////////////////////////
+void AdvertiseMessageOptions::SetChannel(const std::string &_channel)
+{
+  this->dataPtr->channel = _channel;
+}
+
+//////////////////////////////////////////////////
+bool AdvertiseMessageOptions::SlowSubscriberThrottled() const
+{
+  return this->SlowSubscriberMsgsPerSec() != kUnthrottled;
+}
+
+//////////////////////////////////////////////////
+uint64_t AdvertiseMessageOptions::SlowSubscriberMsgsPerSec() const
+{
+  return this->dataPtr->slowSubscriberMsgsPerSec;
+}
+
+//////////////////////////////////////////////////
+void AdvertiseMessageOptions::SetSlowSubscriberMsgsPerSec(
+    const uint64_t _msgsPerSec)
+{
+  this->dataPtr->slowSubscriberMsgsPerSec = _msgsPerSec;
+}
+
+//////////////////////////////////////////////////
+bool AdvertiseMessageOptions::Reliable() const
+{
+  return this->dataPtr->reliable;
+}
+
+//////////////////////////////////////////////////
+void AdvertiseMessageOptions::SetReliable(const bool _reliable)
+{
+  this->dataPtr->reliable = _reliable;
+}
+
+//////////////////////////////////////////////////
+uint64_t AdvertiseMessageOptions::HistorySize() const
+{
+  return this->dataPtr->historySize;
+}
+
+//////////////////////////////////////////////////
+void AdvertiseMessageOptions::SetHistorySize(const uint64_t _msgs)
+{
+  this->dataPtr->historySize = _msgs;
+  if (_msgs > 0)
+    this->dataPtr->reliable = true;
+}
+
+//////////////////////////////////////////////////
+uint64_t AdvertiseMessageOptions::HistoryDepth() const
+{
+  return this->dataPtr->historyDepth;
+}
+
+//////////////////////////////////////////////////
+void AdvertiseMessageOptions::SetHistoryDepth(const uint64_t _msgs)
+{
+  this->dataPtr->historyDepth = _msgs;
+}
+
+//////////////////////////////////////////////////
+std::string AdvertiseMessageOptions::MulticastGroup() const
+{
+  return this->dataPtr->multicastGroup;
+}
+
+//////////////////////////////////////////////////
+void AdvertiseMessageOptions::SetMulticastGroup(const std::string &_group)
+{
+  this->dataPtr->multicastGroup = _group;
+}
+
+//////////////////////////////////////////////////
+std::string AdvertiseMessageOptions::Interface() const
+{
+  return this->dataPtr->interfaceIp;
+}
+
+//////////////////////////////////////////////////
+void AdvertiseMessageOptions::SetInterface(const std::string &_ip)
+{
+  this->dataPtr->interfaceIp = _ip;
+}
+
+//////////////////////////////////////////////////
+std::vector<std::string> AdvertiseMessageOptions::Aliases() const
+{
+  return this->dataPtr->aliases;
+}
+
+//////////////////////////////////////////////////
+bool AdvertiseMessageOptions::AddAlias(const std::string &_alias)
+{
+  auto &aliases = this->dataPtr->aliases;
+  if (!TopicUtils::IsValidTopic(_alias) ||
+      std::find(aliases.begin(), aliases.end(), _alias) != aliases.end())
+  {
+    return false;
+  }
+
+  aliases.push_back(_alias);
+  return true;
+}
+
 //////////////////////////////////////////////////
 AdvertiseServiceOptions::AdvertiseServiceOptions()
   : AdvertiseOptions(),
@@ -209,6 +581,8 @@ AdvertiseServiceOptions &AdvertiseServiceOptions::operator=(
   const AdvertiseServiceOptions &_other)
 {
   AdvertiseOptions::operator=(_other);
+  this->SetConcurrency(_other.Concurrency());
+  this->SetCacheTtl(_other.CacheTtl());
   return *this;
 }
 
@@ -216,7 +590,9 @@ AdvertiseServiceOptions &AdvertiseServiceOptions::operator=(
 bool AdvertiseServiceOptions::operator==(
   const AdvertiseServiceOptions &_other) const
 {
-  return AdvertiseOptions::operator==(_other);
+  return AdvertiseOptions::operator==(_other) &&
+    this->Concurrency() == _other.Concurrency() &&
+    this->CacheTtl() == _other.CacheTtl();
 }
 
 //////////////////////////////////////////////////
@@ -225,3 +601,28 @@ bool AdvertiseServiceOptions::operator!=(
 {
   return !(*this == _other);
 }
+
+//////////////////////////////////////////////////
+void AdvertiseServiceOptions::SetConcurrency(const uint32_t _concurrency)
+{
+  this->dataPtr->concurrency = _concurrency;
+}
+
+//////////////////////////////////////////////////
+uint32_t AdvertiseServiceOptions::Concurrency() const
+{
+  return this->dataPtr->concurrency;
+}
+
+//////////////////////////////////////////////////
+void AdvertiseServiceOptions::SetCacheTtl(
+  const std::chrono::milliseconds &_ttl)
+{
+  this->dataPtr->cacheTtl = _ttl;
+}
+
+//////////////////////////////////////////////////
+std::chrono::milliseconds AdvertiseServiceOptions::CacheTtl() const
+{
+  return this->dataPtr->cacheTtl;
+}
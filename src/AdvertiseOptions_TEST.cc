@@ -15,6 +15,7 @@
  *
 */
 
+#include <chrono>
 #include <iostream>
 #include <string>
 #include <vector>
@@ -67,6 +68,8 @@ TEST(AdvertiseOptionsTest, equalityOp)
   opts2.SetScope(Scope_t::PROCESS);
   EXPECT_TRUE(opts1 == opts2);
   EXPECT_FALSE(opts1 != opts2);
+  opts1.SetPriority(Priority_t::CONTROL);
+  EXPECT_TRUE(opts1 != opts2);
 }
 
 //////////////////////////////////////////////////
@@ -81,6 +84,11 @@ TEST(AdvertiseOptionsTest, streamInsertion)
     "\tScope: All\n";
 
   EXPECT_EQ(output.str(), expectedOutput);
+
+  opts.SetPriority(Priority_t::BULK);
+  output.str("");
+  output << opts;
+  EXPECT_EQ(output.str(), expectedOutput + "\tPriority: Bulk\n");
 }
 
 //////////////////////////////////////////////////
@@ -92,6 +100,14 @@ TEST(AdvertiseOptionsTest, accessors)
   EXPECT_EQ(opts.Scope(), Scope_t::ALL);
   opts.SetScope(Scope_t::HOST);
   EXPECT_EQ(opts.Scope(), Scope_t::HOST);
+
+  // Priority.
+  EXPECT_EQ(opts.Priority(), Priority_t::NORMAL);
+  opts.SetPriority(Priority_t::CONTROL);
+  EXPECT_EQ(opts.Priority(), Priority_t::CONTROL);
+
+  AdvertiseOptions opts2(opts);
+  EXPECT_EQ(opts2.Priority(), Priority_t::CONTROL);
 }
 
 //////////////////////////////////////////////////
@@ -184,6 +200,182 @@ TEST(AdvertiseOptionsTest, msgAccessors)
   opts.SetMsgsPerSec(10u);
   EXPECT_EQ(opts.MsgsPerSec(), 10u);
   EXPECT_TRUE(opts.Throttled());
+
+  // Rate limit
+  EXPECT_FALSE(opts.RateLimited());
+  EXPECT_EQ(opts.RateLimitMsgsPerSec(), 0u);
+  EXPECT_EQ(opts.RateLimitBytesPerSec(), 0u);
+  opts.SetRateLimit(100u, 0u);
+  EXPECT_TRUE(opts.RateLimited());
+  EXPECT_EQ(opts.RateLimitMsgsPerSec(), 100u);
+  EXPECT_EQ(opts.RateLimitBurstMsgs(), 100u);
+  EXPECT_EQ(opts.RateLimitBurstBytes(), 0u);
+  opts.SetRateLimit(100u, 1000000u, 5u, 4096u);
+  EXPECT_EQ(opts.RateLimitBytesPerSec(), 1000000u);
+  EXPECT_EQ(opts.RateLimitBurstMsgs(), 5u);
+  EXPECT_EQ(opts.RateLimitBurstBytes(), 4096u);
+  {
+    AdvertiseMessageOptions limited(opts);
+    EXPECT_EQ(opts, limited);
+    limited.SetRateLimit(0u, 0u);
+    EXPECT_FALSE(limited.RateLimited());
+    EXPECT_NE(opts, limited);
+  }
+
+  // BufferPoolSize
+  EXPECT_EQ(opts.BufferPoolSize(), 0u);
+  opts.SetBufferPoolSize(1024u);
+  EXPECT_EQ(opts.BufferPoolSize(), 1024u);
+
+  AdvertiseMessageOptions opts2(opts);
+  EXPECT_EQ(opts2.BufferPoolSize(), 1024u);
+  opts2.SetBufferPoolSize(0u);
+  EXPECT_NE(opts, opts2);
+
+  // Huge pages
+  EXPECT_EQ(HugePages_t::NONE, opts.HugePages());
+  EXPECT_EQ(2u << 20, opts.HugePagesMinSize());
+  opts.SetHugePages(HugePages_t::EXPLICIT, 8u << 20);
+  EXPECT_EQ(HugePages_t::EXPLICIT, opts.HugePages());
+  EXPECT_EQ(8u << 20, opts.HugePagesMinSize());
+  {
+    AdvertiseMessageOptions huge(opts);
+    EXPECT_EQ(opts, huge);
+    huge.SetHugePages(HugePages_t::TRANSPARENT);
+    EXPECT_NE(opts, huge);
+  }
+
+  // Batching
+  EXPECT_FALSE(opts.Batched());
+  EXPECT_EQ(opts.BatchDelay(), 0u);
+  EXPECT_EQ(opts.BatchSize(), 65536u);
+  opts.SetBatchDelay(500u);
+  opts.SetBatchSize(4096u);
+  EXPECT_TRUE(opts.Batched());
+  EXPECT_EQ(opts.BatchDelay(), 500u);
+  EXPECT_EQ(opts.BatchSize(), 4096u);
+
+  AdvertiseMessageOptions opts3(opts);
+  EXPECT_EQ(opts, opts3);
+  opts3.SetBatchDelay(0u);
+  EXPECT_NE(opts, opts3);
+
+  // Compression
+  EXPECT_EQ(opts.Compression(), Compression_t::NONE);
+  EXPECT_EQ(opts.CompressionLevel(), 0);
+  EXPECT_EQ(opts.CompressionMinSize(), 4096u);
+  opts.SetCompression(Compression_t::ZSTD, 5, 1000u);
+  EXPECT_EQ(opts.Compression(), Compression_t::ZSTD);
+  EXPECT_EQ(opts.CompressionLevel(), 5);
+  EXPECT_EQ(opts.CompressionMinSize(), 1000u);
+
+  AdvertiseMessageOptions opts4(opts);
+  EXPECT_EQ(opts, opts4);
+  opts4.SetCompression(Compression_t::LZ4);
+  EXPECT_NE(opts, opts4);
+
+  // Channel
+  EXPECT_TRUE(opts.Channel().empty());
+  opts.SetChannel("bulk");
+  EXPECT_EQ(opts.Channel(), "bulk");
+
+  AdvertiseMessageOptions opts5(opts);
+  EXPECT_EQ(opts, opts5);
+  opts5.SetChannel("");
+  EXPECT_NE(opts, opts5);
+
+  // Rate while a subscriber is slow
+  EXPECT_FALSE(opts.SlowSubscriberThrottled());
+  EXPECT_EQ(opts.SlowSubscriberMsgsPerSec(), kUnthrottled);
+  opts.SetSlowSubscriberMsgsPerSec(5);
+  EXPECT_TRUE(opts.SlowSubscriberThrottled());
+  EXPECT_EQ(opts.SlowSubscriberMsgsPerSec(), 5u);
+
+  AdvertiseMessageOptions opts5b(opts);
+  EXPECT_EQ(opts, opts5b);
+  opts5b.SetSlowSubscriberMsgsPerSec(kUnthrottled);
+  EXPECT_NE(opts, opts5b);
+
+  // Reliability
+  EXPECT_FALSE(opts.Reliable());
+  EXPECT_EQ(opts.HistorySize(), 0u);
+  opts.SetReliable(true);
+  EXPECT_TRUE(opts.Reliable());
+  opts.SetReliable(false);
+  opts.SetHistorySize(100);
+  EXPECT_TRUE(opts.Reliable());
+  EXPECT_EQ(opts.HistorySize(), 100u);
+
+  AdvertiseMessageOptions opts6(opts);
+  EXPECT_EQ(opts, opts6);
+  opts6.SetHistorySize(10);
+  EXPECT_NE(opts, opts6);
+
+  // Late joiners
+  EXPECT_EQ(opts.HistoryDepth(), 0u);
+  opts.SetHistoryDepth(3);
+  EXPECT_EQ(opts.HistoryDepth(), 3u);
+
+  AdvertiseMessageOptions opts7(opts);
+  EXPECT_EQ(opts, opts7);
+  opts7.SetHistoryDepth(1);
+  EXPECT_NE(opts, opts7);
+
+  // Multicast
+  EXPECT_TRUE(opts.MulticastGroup().empty());
+  opts.SetMulticastGroup("239.255.0.8:5555");
+  EXPECT_EQ(opts.MulticastGroup(), "239.255.0.8:5555");
+
+  AdvertiseMessageOptions opts8(opts);
+  EXPECT_EQ(opts, opts8);
+  opts8.SetMulticastGroup("");
+  EXPECT_NE(opts, opts8);
+
+  // Interface
+  EXPECT_TRUE(opts.Interface().empty());
+  opts.SetInterface("192.168.10.2");
+  EXPECT_EQ(opts.Interface(), "192.168.10.2");
+
+  AdvertiseMessageOptions opts9(opts);
+  EXPECT_EQ(opts, opts9);
+  opts9.SetInterface("");
+  EXPECT_NE(opts, opts9);
+
+  // Aliases
+  EXPECT_TRUE(opts.Aliases().empty());
+  EXPECT_TRUE(opts.AddAlias("/legacy/scan"));
+  EXPECT_TRUE(opts.AddAlias("scan_old"));
+  EXPECT_FALSE(opts.AddAlias("/legacy/scan"));
+  EXPECT_FALSE(opts.AddAlias("invalid topic"));
+  ASSERT_EQ(2u, opts.Aliases().size());
+  EXPECT_EQ("/legacy/scan", opts.Aliases()[0]);
+  EXPECT_EQ("scan_old", opts.Aliases()[1]);
+
+  AdvertiseMessageOptions opts10(opts);
+  EXPECT_EQ(opts, opts10);
+  EXPECT_EQ(opts.Aliases(), opts10.Aliases());
+  opts10.AddAlias("/other");
+  EXPECT_NE(opts, opts10);
+
+  std::ostringstream output;
+  output << opts;
+  EXPECT_NE(output.str().find("\tBuffer pool: 1024 bytes\n"),
+            std::string::npos);
+  EXPECT_NE(output.str().find("\tBatching: 500 us, 4096 bytes\n"),
+            std::string::npos);
+  EXPECT_NE(output.str().find("\tCompression: ZSTD, level 5, 1000 bytes\n"),
+            std::string::npos);
+  EXPECT_NE(output.str().find("\tChannel: bulk\n"), std::string::npos);
+  EXPECT_NE(output.str().find("\tReliable: history of 100 msgs\n"),
+            std::string::npos);
+  EXPECT_NE(output.str().find("\tHistory depth: 3 msgs\n"),
+            std::string::npos);
+  EXPECT_NE(output.str().find("\tMulticast: 239.255.0.8:5555\n"),
+            std::string::npos);
+  EXPECT_NE(output.str().find("\tInterface: 192.168.10.2\n"),
+            std::string::npos);
+  EXPECT_NE(output.str().find("\tAlias: /legacy/scan\n"),
+            std::string::npos);
 }
 
 //////////////////////////////////////////////////
@@ -200,6 +392,8 @@ TEST(AdvertiseOptionsTest, srvCopyConstructor)
 {
   AdvertiseServiceOptions opts1;
   opts1.SetScope(Scope_t::HOST);
+  opts1.SetConcurrency(4u);
+  opts1.SetCacheTtl(std::chrono::milliseconds(500));
   AdvertiseServiceOptions opts2(opts1);
   EXPECT_EQ(opts1, opts2);
 }
@@ -227,6 +421,12 @@ TEST(AdvertiseOptionsTest, srvEqualityOp)
   opts2.SetScope(Scope_t::PROCESS);
   EXPECT_TRUE(opts1 == opts2);
   EXPECT_FALSE(opts1 != opts2);
+  opts1.SetConcurrency(2u);
+  EXPECT_TRUE(opts1 != opts2);
+  opts2.SetConcurrency(2u);
+  EXPECT_TRUE(opts1 == opts2);
+  opts1.SetCacheTtl(std::chrono::milliseconds(100));
+  EXPECT_TRUE(opts1 != opts2);
 }
 
 //////////////////////////////////////////////////
@@ -240,6 +440,25 @@ TEST(AdvertiseOptionsTest, srvStreamInsertion)
     "Advertise options:\n"
     "\tScope: All\n";
   EXPECT_EQ(output.str(), expectedOutput);
+
+  opts.SetConcurrency(3u);
+  output.str("");
+  output << opts;
+  expectedOutput =
+    "Advertise options:\n"
+    "\tScope: All\n"
+    "\tConcurrency: 3\n";
+  EXPECT_EQ(output.str(), expectedOutput);
+
+  opts.SetCacheTtl(std::chrono::milliseconds(250));
+  output.str("");
+  output << opts;
+  expectedOutput =
+    "Advertise options:\n"
+    "\tScope: All\n"
+    "\tConcurrency: 3\n"
+    "\tCache TTL: 250 ms\n";
+  EXPECT_EQ(output.str(), expectedOutput);
 }
 
 //////////////////////////////////////////////////
@@ -251,4 +470,14 @@ TEST(AdvertiseOptionsTest, srvAccessors)
   EXPECT_EQ(opts.Scope(), Scope_t::ALL);
   opts.SetScope(Scope_t::HOST);
   EXPECT_EQ(opts.Scope(), Scope_t::HOST);
+
+  // Concurrency.
+  EXPECT_EQ(0u, opts.Concurrency());
+  opts.SetConcurrency(8u);
+  EXPECT_EQ(8u, opts.Concurrency());
+
+  // Cache.
+  EXPECT_EQ(0, opts.CacheTtl().count());
+  opts.SetCacheTtl(std::chrono::milliseconds(1000));
+  EXPECT_EQ(1000, opts.CacheTtl().count());
 }
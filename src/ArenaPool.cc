@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "gz/transport/ArenaPool.hh"
+
+using namespace gz;
+using namespace transport;
+
+namespace gz
+{
+  namespace transport
+  {
+    inline namespace GZ_TRANSPORT_VERSION_NAMESPACE
+    {
+    /// \internal
+    /// \brief An arena and its initial block.
+    struct ArenaBlock
+    {
+      /// \brief Constructor.
+      /// \param[in] _size Size of the initial block (bytes).
+      explicit ArenaBlock(const std::size_t _size)
+        : block(new char[_size]), size(_size)
+      {
+        google::protobuf::ArenaOptions options;
+        options.initial_block = this->block.get();
+        options.initial_block_size = this->size;
+        this->arena.reset(new google::protobuf::Arena(options));
+      }
+
+      /// \brief Initial block. It must outlive the arena.
+      std::unique_ptr<char[]> block;
+
+      /// \brief Size of the initial block (bytes).
+      std::size_t size;
+
+      /// \brief The arena.
+      std::unique_ptr<google::protobuf::Arena> arena;
+    };
+
+    /// \internal
+    /// \brief Private data for ArenaPool class.
+    class ArenaPoolPrivate
+    {
+      /// \brief Reset an arena no longer in use and store it in the pool.
+      /// \param[in] _block The arena.
+      public: void Release(ArenaBlock *_block)
+      {
+        std::unique_ptr<ArenaBlock> block(_block);
+
+        // Destroy the objects created on the arena. Grow the initial block if
+        // the arena needed more memory, so the next message fits in it.
+        const uint64_t allocated = block->arena->Reset();
+        if (allocated > block->size &&
+            block->size < ArenaPool::kMaxBlockSize)
+        {
+          std::size_t size = block->size;
+          while (size < allocated && size < ArenaPool::kMaxBlockSize)
+            size *= 2;
+          block.reset(new ArenaBlock(size));
+        }
+
+        std::lock_guard<std::mutex> lk(this->mutex);
+        if (this->idle.size() < ArenaPool::kMaxIdle)
+          this->idle.push_back(std::move(block));
+      }
+
+      /// \brief Protects the idle arenas.
+      public: mutable std::mutex mutex;
+
+      /// \brief Arenas waiting to be acquired.
+      public: std::vector<std::unique_ptr<ArenaBlock>> idle;
+    };
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+ArenaPool::ArenaPool()
+  : dataPtr(std::make_shared<ArenaPoolPrivate>())
+{
+}
+
+//////////////////////////////////////////////////
+ArenaPool::~ArenaPool()
+{
+}
+
+//////////////////////////////////////////////////
+std::shared_ptr<google::protobuf::Arena> ArenaPool::Acquire()
+{
+  std::unique_ptr<ArenaBlock> block;
+  {
+    std::lock_guard<std::mutex> lk(this->dataPtr->mutex);
+    if (!this->dataPtr->idle.empty())
+    {
+      block = std::move(this->dataPtr->idle.back());
+      this->dataPtr->idle.pop_back();
+    }
+  }
+
+  if (!block)
+    block.reset(new ArenaBlock(kMinBlockSize));
+
+  // The arena returns to the pool once released, the pool data is kept
+  // alive until then.
+  std::shared_ptr<ArenaPoolPrivate> pool = this->dataPtr;
+  std::shared_ptr<ArenaBlock> owner(block.release(),
+    [pool](ArenaBlock *_block)
+    {
+      pool->Release(_block);
+    });
+
+  return std::shared_ptr<google::protobuf::Arena>(owner, owner->arena.get());
+}
+
+//////////////////////////////////////////////////
+std::size_t ArenaPool::IdleCount() const
+{
+  std::lock_guard<std::mutex> lk(this->dataPtr->mutex);
+  return this->dataPtr->idle.size();
+}
@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gz/msgs/stringmsg_v.pb.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gz/transport/ArenaPool.hh"
+#include "gtest/gtest.h"
+
+using namespace gz;
+using namespace transport;
+
+//////////////////////////////////////////////////
+/// \brief Create a message with a few nested messages on an arena.
+/// \param[in] _arena The arena.
+/// \return The message.
+msgs::StringMsg_V *createMsg(google::protobuf::Arena *_arena)
+{
+  msgs::StringMsg_V msg;
+  for (int i = 0; i < 100; ++i)
+    msg.add_data(std::string(100, 'a' + i % 26));
+
+  std::string data;
+  EXPECT_TRUE(msg.SerializeToString(&data));
+
+  auto *arenaMsg =
+    google::protobuf::Arena::CreateMessage<msgs::StringMsg_V>(_arena);
+  EXPECT_TRUE(arenaMsg->ParseFromString(data));
+  EXPECT_EQ(_arena, arenaMsg->GetArena());
+  return arenaMsg;
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that the arenas are recycled once released.
+TEST(ArenaPoolTest, Recycle)
+{
+  ArenaPool pool;
+  EXPECT_EQ(0u, pool.IdleCount());
+
+  google::protobuf::Arena *first;
+  {
+    auto arena = pool.Acquire();
+    ASSERT_NE(nullptr, arena);
+    first = arena.get();
+  }
+  EXPECT_EQ(1u, pool.IdleCount());
+
+  // The same arena is handed out again, while a second one is created when
+  // the first one is in use.
+  {
+    auto arena1 = pool.Acquire();
+    EXPECT_EQ(first, arena1.get());
+    EXPECT_EQ(0u, pool.IdleCount());
+    auto arena2 = pool.Acquire();
+    EXPECT_NE(arena1.get(), arena2.get());
+  }
+  EXPECT_EQ(2u, pool.IdleCount());
+
+  // The message shares the ownership of the arena.
+  {
+    auto arena = pool.Acquire();
+    std::shared_ptr<msgs::StringMsg_V> msg(arena, createMsg(arena.get()));
+    arena.reset();
+    EXPECT_EQ(1u, pool.IdleCount());
+    EXPECT_EQ(100, msg->data_size());
+  }
+  EXPECT_EQ(2u, pool.IdleCount());
+
+  // Once the initial block has grown, the same message fits in it.
+  uint64_t allocated = 0;
+  for (int i = 0; i < 3; ++i)
+  {
+    auto arena1 = pool.Acquire();
+    auto arena2 = pool.Acquire();
+    createMsg(arena1.get());
+    createMsg(arena2.get());
+    if (i > 0)
+    {
+      EXPECT_EQ(allocated, arena1->SpaceAllocated());
+      EXPECT_EQ(allocated, arena2->SpaceAllocated());
+    }
+    allocated = std::max(arena1->SpaceAllocated(), arena2->SpaceAllocated());
+  }
+
+  // The number of idle arenas is bounded.
+  {
+    std::vector<std::shared_ptr<google::protobuf::Arena>> arenas;
+    for (std::size_t i = 0; i < 2 * ArenaPool::kMaxIdle; ++i)
+      arenas.push_back(pool.Acquire());
+  }
+  EXPECT_EQ(ArenaPool::kMaxIdle, pool.IdleCount());
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that an arena can be released from another thread and
+/// after the destruction of the pool.
+TEST(ArenaPoolTest, Release)
+{
+  std::shared_ptr<msgs::StringMsg_V> msg;
+  {
+    ArenaPool pool;
+    auto arena = pool.Acquire();
+    msg = std::shared_ptr<msgs::StringMsg_V>(arena, createMsg(arena.get()));
+
+    std::thread t([&pool]()
+    {
+      auto other = pool.Acquire();
+      createMsg(other.get());
+    });
+    t.join();
+    EXPECT_EQ(1u, pool.IdleCount());
+  }
+
+  EXPECT_EQ(100, msg->data_size());
+  msg.reset();
+}
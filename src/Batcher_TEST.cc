@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gz/msgs/int32.pb.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "gz/transport/Batcher.hh"
+#include "gtest/gtest.h"
+
+using namespace gz;
+using namespace transport;
+
+using IntBatcher = Batcher<msgs::Int32>;
+
+//////////////////////////////////////////////////
+/// \brief Create a message.
+/// \param[in] _data Data of the message.
+/// \return The message.
+std::shared_ptr<const msgs::Int32> int32Msg(const int _data)
+{
+  auto msg = std::make_shared<msgs::Int32>();
+  msg->set_data(_data);
+  return msg;
+}
+
+//////////////////////////////////////////////////
+/// \brief The full batches are delivered in order, without copies.
+TEST(BatcherTest, FullBatches)
+{
+  std::vector<std::vector<int>> batches;
+  const msgs::Int32 *first = nullptr;
+  auto batcher = std::make_shared<IntBatcher>(3,
+    std::chrono::nanoseconds::zero(),
+    [&](const IntBatcher::Batch &_batch)
+    {
+      if (!first)
+        first = _batch.front().get();
+      std::vector<int> data;
+      for (const auto &msg : _batch)
+        data.push_back(msg->data());
+      batches.push_back(data);
+    });
+
+  auto msg = int32Msg(0);
+  auto input = IntBatcher::Input(batcher);
+  input(msg, MessageInfo());
+  for (int i = 1; i < 8; ++i)
+    input(int32Msg(i), MessageInfo());
+
+  ASSERT_EQ(2u, batches.size());
+  EXPECT_EQ(std::vector<int>({0, 1, 2}), batches[0]);
+  EXPECT_EQ(std::vector<int>({3, 4, 5}), batches[1]);
+  EXPECT_EQ(msg.get(), first);
+
+  batcher->Flush();
+  ASSERT_EQ(3u, batches.size());
+  EXPECT_EQ(std::vector<int>({6, 7}), batches[2]);
+
+  // Nothing pending.
+  batcher->Flush();
+  EXPECT_EQ(3u, batches.size());
+}
+
+//////////////////////////////////////////////////
+/// \brief The pending messages are delivered after the maximum delay.
+TEST(BatcherTest, MaxDelay)
+{
+  std::mutex mutex;
+  std::vector<std::size_t> sizes;
+  auto batcher = std::make_shared<IntBatcher>(100,
+    std::chrono::milliseconds(20),
+    [&](const IntBatcher::Batch &_batch)
+    {
+      std::lock_guard<std::mutex> lk(mutex);
+      sizes.push_back(_batch.size());
+    });
+
+  batcher->Add(int32Msg(1));
+  batcher->Add(int32Msg(2));
+  {
+    std::lock_guard<std::mutex> lk(mutex);
+    EXPECT_TRUE(sizes.empty());
+  }
+
+  for (int i = 0; i < 100; ++i)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    std::lock_guard<std::mutex> lk(mutex);
+    if (!sizes.empty())
+      break;
+  }
+
+  std::lock_guard<std::mutex> lk(mutex);
+  ASSERT_EQ(1u, sizes.size());
+  EXPECT_EQ(2u, sizes[0]);
+}
+
+//////////////////////////////////////////////////
+/// \brief The batcher can be destroyed by its own callback.
+TEST(BatcherTest, DestroyedByCallback)
+{
+  std::atomic<bool> delivered{false};
+  auto batcher = std::make_shared<std::shared_ptr<IntBatcher>>();
+  *batcher = std::make_shared<IntBatcher>(100,
+    std::chrono::milliseconds(1),
+    [batcher, &delivered](const IntBatcher::Batch &)
+    {
+      batcher->reset();
+      delivered = true;
+    });
+
+  (*batcher)->Add(int32Msg(1));
+  for (int i = 0; i < 100 && !delivered; ++i)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_TRUE(delivered);
+}
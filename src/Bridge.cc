@@ -0,0 +1,1351 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef _WIN32
+  #include <arpa/inet.h>
+  #include <fcntl.h>
+  #include <netinet/tcp.h>
+#endif
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <zmq.hpp>
+
+#include "gz/transport/Bridge.hh"
+#include "gz/transport/Discovery.hh"
+#include "gz/transport/MessageInfo.hh"
+#include "gz/transport/Node.hh"
+#include "gz/transport/SubscribeOptions.hh"
+#include "gz/transport/TopicUtils.hh"
+#include "gz/transport/TransportTypes.hh"
+
+#include "Compression.hh"
+#include "SecurityOptions.hh"
+
+// Compatibility macro for ZMQ_FD_T
+#if (ZMQ_VERSION >= 40303)
+  #define ZMQ_FD_T zmq_fd_t
+#else
+// Logic from newer zmq.h
+  #if defined _WIN32
+  // Windows uses a pointer-sized unsigned integer to store the socket fd.
+    #if defined _WIN64
+      #define ZMQ_FD_T unsigned __int64
+    #else
+      #define ZMQ_FD_T unsigned int
+    #endif
+  #else
+    #define ZMQ_FD_T int
+  #endif
+#endif
+
+using namespace gz;
+using namespace transport;
+
+/// \brief Kinds of the frames exchanged by the bridges. A frame is
+/// <uint32 size><uint8 kind><uint32 topic id>, followed by:
+///   - HELLO: <uint32 username size><username><password>, the first frame
+///     of each end, with a topic id of 0.
+///   - ADVERTISE: <uint32 topic size><topic><type>
+///   - MESSAGE: <uint32 seq><uint8 codec><message>
+///   - DELTA: <uint32 seq><uint8 codec><message xor the previous one>
+///   - REPEAT: <uint32 seq>, the message is the previous one.
+/// The integers are little endian.
+enum class BridgeFrame : uint8_t
+{
+  ADVERTISE = 1,
+  MESSAGE = 2,
+  DELTA = 3,
+  REPEAT = 4,
+  HELLO = 5
+};
+
+/// \brief Largest frame accepted (bytes).
+static const uint32_t kMaxFrameSize = 1u << 30;
+
+/// \brief Largest size of the frames waiting to be sent (bytes). The
+/// messages are dropped above it.
+static const std::size_t kMaxQueueBytes = 64u << 20;
+
+/// \brief Number of messages of a topic between two full messages, which
+/// bound the damage of a lost frame.
+static const uint32_t kKeyframeInterval = 100;
+
+/// \brief Longest wait for the sockets (milliseconds), Stop() is noticed
+/// after this time.
+static const int kPollTimeout = 100;
+
+/// \brief Longest wait for the connection to the remote bridge, and for
+/// its credentials (milliseconds).
+static const int kConnectTimeout = 3000;
+
+/// \brief Time between two attempts to connect to the remote bridge.
+static const std::chrono::seconds kReconnectInterval(1);
+
+/// \brief A local topic forwarded to the remote bridge. Its fields are
+/// protected by its mutex.
+struct BridgeLocalTopic
+{
+  /// \brief Identifies the topic in the frames.
+  uint32_t id;
+
+  /// \brief Topic name.
+  std::string topic;
+
+  /// \brief How the messages are forwarded.
+  BridgeTopicOptions options;
+
+  /// \brief Message type, empty until the first message is received.
+  std::string type;
+
+  /// \brief Previous message, the base of the delta encoding.
+  std::string last;
+
+  /// \brief Whether the remote bridge has the previous message.
+  bool lastValid = false;
+
+  /// \brief Sequence number of the previous message.
+  uint32_t seq = 0;
+
+  /// \brief Number of messages since the last full message.
+  uint32_t sinceKeyframe = 0;
+
+  /// \brief Scratch buffer of the delta encoding and the compression.
+  std::string scratch;
+
+  /// \brief Protects the topic.
+  std::mutex mutex;
+};
+
+/// \brief A topic forwarded by the remote bridge. Only used by the thread
+/// of the connection.
+struct BridgeRemoteTopic
+{
+  /// \brief Topic name.
+  std::string topic;
+
+  /// \brief Message type.
+  std::string type;
+
+  /// \brief Previous message, the base of the delta encoding.
+  std::string last;
+
+  /// \brief Whether last is the previous message of the remote bridge.
+  bool lastValid = false;
+
+  /// \brief Sequence number of the previous message.
+  uint32_t seq = 0;
+};
+
+//////////////////////////////////////////////////
+/// \brief Append a little endian integer to a frame.
+/// \param[in, out] _frame The frame.
+/// \param[in] _value The integer.
+static void appendU32(std::string &_frame, const uint32_t _value)
+{
+  for (int i = 0; i < 4; ++i)
+    _frame.push_back(static_cast<char>((_value >> (8 * i)) & 0xFF));
+}
+
+//////////////////////////////////////////////////
+/// \brief Read a little endian integer.
+/// \param[in] _data The integer.
+/// \return The value.
+static uint32_t readU32(const char *_data)
+{
+  uint32_t value = 0;
+  for (int i = 0; i < 4; ++i)
+    value |= static_cast<uint32_t>(static_cast<unsigned char>(_data[i])) <<
+      (8 * i);
+  return value;
+}
+
+//////////////////////////////////////////////////
+/// \brief Start a frame, its size is set by finishFrame().
+/// \param[in] _kind Kind of the frame.
+/// \param[in] _id Topic id.
+/// \param[in] _reserve Expected size of the rest of the frame (bytes).
+/// \return The frame.
+static std::string startFrame(const BridgeFrame _kind, const uint32_t _id,
+  const std::size_t _reserve = 0)
+{
+  std::string frame;
+  frame.reserve(13 + _reserve);
+  appendU32(frame, 0);
+  frame.push_back(static_cast<char>(_kind));
+  appendU32(frame, _id);
+  return frame;
+}
+
+//////////////////////////////////////////////////
+/// \brief Set the size of a frame.
+/// \param[in, out] _frame The frame.
+static void finishFrame(std::string &_frame)
+{
+  const uint32_t size = static_cast<uint32_t>(_frame.size() - 4);
+  for (int i = 0; i < 4; ++i)
+    _frame[i] = static_cast<char>((size >> (8 * i)) & 0xFF);
+}
+
+//////////////////////////////////////////////////
+/// \brief Close a socket.
+/// \param[in] _sock The socket.
+static void closeSocket(const int _sock)
+{
+#ifdef _WIN32
+  closesocket(_sock);
+#else
+  close(_sock);
+#endif
+}
+
+//////////////////////////////////////////////////
+/// \brief Shut down both directions of a socket, which wakes up the
+/// threads blocked on it.
+/// \param[in] _sock The socket.
+static void shutdownSocket(const int _sock)
+{
+#ifdef _WIN32
+  shutdown(_sock, SD_BOTH);
+#else
+  shutdown(_sock, SHUT_RDWR);
+#endif
+}
+
+//////////////////////////////////////////////////
+/// \brief Switch a socket between blocking and non-blocking mode.
+/// \param[in] _sock The socket.
+/// \param[in] _blocking True for the blocking mode.
+/// \return True on success.
+static bool setBlocking(const int _sock, const bool _blocking)
+{
+#ifdef _WIN32
+  u_long mode = _blocking ? 0 : 1;
+  return ioctlsocket(_sock, FIONBIO, &mode) == 0;
+#else
+  const int flags = fcntl(_sock, F_GETFL, 0);
+  if (flags < 0)
+    return false;
+  return fcntl(_sock, F_SETFL,
+    _blocking ? (flags & ~O_NONBLOCK) : (flags | O_NONBLOCK)) == 0;
+#endif
+}
+
+//////////////////////////////////////////////////
+/// \brief Send the messages of a TCP connection right away, they are
+/// already batched by the frames.
+/// \param[in] _sock The socket.
+static void setNoDelay(const int _sock)
+{
+  int noDelay = 1;
+  setsockopt(_sock, IPPROTO_TCP, TCP_NODELAY,
+    reinterpret_cast<const char *>(&noDelay), sizeof(noDelay));
+#ifdef SO_NOSIGPIPE
+  int noSigPipe = 1;
+  setsockopt(_sock, SOL_SOCKET, SO_NOSIGPIPE,
+    reinterpret_cast<const char *>(&noSigPipe), sizeof(noSigPipe));
+#endif
+}
+
+//////////////////////////////////////////////////
+/// \brief Send a whole buffer on a blocking socket.
+/// \param[in] _sock The socket.
+/// \param[in] _data The buffer.
+/// \return True on success, false if the connection failed.
+static bool sendAll(const int _sock, const std::string &_data)
+{
+#ifdef MSG_NOSIGNAL
+  const int flags = MSG_NOSIGNAL;
+#else
+  const int flags = 0;
+#endif
+  std::size_t offset = 0;
+  while (offset < _data.size())
+  {
+    const auto sent = send(_sock,
+      reinterpret_cast<const raw_type *>(_data.data() + offset),
+      static_cast<int>(_data.size() - offset), flags);
+    if (sent <= 0)
+      return false;
+    offset += static_cast<std::size_t>(sent);
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+/// \brief Compare two secrets in a time independent of their content.
+/// \param[in] _a A secret.
+/// \param[in] _b Another secret.
+/// \return True if they are equal.
+static bool sameSecret(const std::string &_a, const std::string &_b)
+{
+  unsigned char diff = _a.size() == _b.size() ? 0 : 1;
+  for (std::size_t i = 0; i < _a.size(); ++i)
+  {
+    diff |= static_cast<unsigned char>(
+      _a[i] ^ (_b.empty() ? 0 : _b[i % _b.size()]));
+  }
+  return diff == 0;
+}
+
+/// \internal
+/// \brief Private data for Bridge class.
+class gz::transport::BridgePrivate
+{
+  /// \brief Constructor.
+  /// \param[in] _options Options of the node.
+  public: explicit BridgePrivate(const NodeOptions &_options)
+    : node(_options)
+  {
+    const SecurityOptions security = SecurityOptions::FromEnv();
+    this->username = security.username;
+    this->password = security.password;
+  }
+
+  /// \brief Forward a local message, called by the subscriptions.
+  /// \param[in] _topic The topic.
+  /// \param[in] _data The message.
+  /// \param[in] _size Size of the message (bytes).
+  /// \param[in] _info Information of the message.
+  public: void OnMessage(BridgeLocalTopic &_topic, const char *_data,
+                         const std::size_t _size, const MessageInfo &_info);
+
+  /// \brief Encode a message of a topic as a frame.
+  /// \param[in, out] _topic The topic.
+  /// \param[in] _data The message.
+  /// \param[in] _size Size of the message (bytes).
+  /// \return The frame.
+  public: std::string Encode(BridgeLocalTopic &_topic, const char *_data,
+                             const std::size_t _size);
+
+  /// \brief Get the frame advertising a local topic.
+  /// \param[in] _topic The topic, its type is known.
+  /// \return The frame.
+  public: static std::string AdvertiseFrame(const BridgeLocalTopic &_topic);
+
+  /// \brief Queue a frame for the writer thread.
+  /// \param[in] _frame The frame.
+  /// \param[in] _force Queue it even when the queue is full.
+  /// \return False if the frame was dropped.
+  public: bool Enqueue(std::string &&_frame, const bool _force);
+
+  /// \brief Get the frame with the credentials of this end.
+  /// \return The frame.
+  public: std::string HelloFrame() const;
+
+  /// \brief Start using a new connection, whose remote bridge isn't
+  /// authenticated yet.
+  /// \param[in] _sock The socket of the connection.
+  public: void OnConnected(const int _sock);
+
+  /// \brief Check the first frame of the remote bridge, and start
+  /// forwarding the topics if it has our credentials.
+  /// \param[in] _data The frame, after its topic id.
+  /// \param[in] _size Size of _data (bytes).
+  /// \return False if the frame is malformed or the credentials differ.
+  public: bool Authenticate(const char *_data, const std::size_t _size);
+
+  /// \brief Close the connection.
+  public: void Disconnect();
+
+  /// \brief Connect to the remote bridge.
+  /// \return The socket, or -1 on failure.
+  public: int ConnectToRemote() const;
+
+  /// \brief Read the pending data of the connection and handle the complete
+  /// frames.
+  /// \return False if the connection failed or sent a malformed frame.
+  public: bool ReadFrames();
+
+  /// \brief Handle a frame of the remote bridge.
+  /// \param[in] _data The frame, without its size.
+  /// \param[in] _size Size of the frame (bytes).
+  /// \return False if the frame is malformed.
+  public: bool HandleFrame(const char *_data, const std::size_t _size);
+
+  /// \brief Decode the message of a MESSAGE or DELTA frame.
+  /// \param[in] _data The codec followed by the message.
+  /// \param[in] _size Size of _data (bytes).
+  /// \param[out] _msg The message.
+  /// \return False if it's malformed.
+  public: static bool DecodePayload(const char *_data,
+                                    const std::size_t _size,
+                                    std::string &_msg);
+
+  /// \brief Manage the connection and read it until Stop() is called.
+  public: void RunConnection();
+
+  /// \brief Write the queued frames until Stop() is called.
+  public: void RunWriter();
+
+  /// \brief Node subscribing to the local topics and publishing the remote
+  /// ones.
+  public: Node node;
+
+  /// \brief Local topics by name. They are never removed.
+  public: std::map<std::string, std::unique_ptr<BridgeLocalTopic>> locals;
+
+  /// \brief Id of the next local topic.
+  public: uint32_t nextId = 1;
+
+  /// \brief Protects locals and nextId.
+  public: std::mutex localsMutex;
+
+  /// \brief Remote topics by id, only used by the thread of the connection.
+  public: std::map<uint32_t, BridgeRemoteTopic> remotes;
+
+  /// \brief Publishers of the remote topics, by topic. They are kept across
+  /// the connections.
+  public: std::map<std::string, Node::Publisher> publishers;
+
+  /// \brief Message type of the publishers, by topic.
+  public: std::map<std::string, std::string> publisherTypes;
+
+  /// \brief Names of the remote topics.
+  public: std::set<std::string> remoteNames;
+
+  /// \brief Remote topics advertised and published, see
+  /// Bridge::AllowRemoteTopic().
+  public: std::set<std::string> allowedNames;
+
+  /// \brief Remote topics not allowed, each one is reported once.
+  public: std::set<std::string> rejectedNames;
+
+  /// \brief Protects remoteNames, allowedNames and rejectedNames.
+  public: mutable std::mutex namesMutex;
+
+  /// \brief Username exchanged with the remote bridge.
+  public: std::string username;
+
+  /// \brief Password exchanged with the remote bridge.
+  public: std::string password;
+
+  /// \brief Frames waiting to be sent.
+  public: std::deque<std::string> queue;
+
+  /// \brief Size of the frames of queue (bytes).
+  public: std::size_t queueBytes = 0;
+
+  /// \brief Protects queue and queueBytes.
+  public: std::mutex queueMutex;
+
+  /// \brief Wakes up the writer thread.
+  public: std::condition_variable queueCondition;
+
+  /// \brief Socket of the connection used by the writer thread, or -1.
+  public: int writerSock = -1;
+
+  /// \brief Protects writerSock, held while writing a frame.
+  public: std::mutex sendMutex;
+
+  /// \brief Socket of the connection, or -1. Only used by the thread of
+  /// the connection.
+  public: int sock = -1;
+
+  /// \brief Listening socket, or -1 when connecting.
+  public: int listenSock = -1;
+
+  /// \brief TCP port of listenSock.
+  public: int boundPort = 0;
+
+  /// \brief Host of the remote bridge when connecting.
+  public: std::string remoteHost;
+
+  /// \brief Port of the remote bridge when connecting.
+  public: int remotePort = 0;
+
+  /// \brief Data read from the connection, not handled yet.
+  public: std::string rcvBuffer;
+
+  /// \brief Scratch buffer of the delta decoding.
+  public: std::string rcvScratch;
+
+  /// \brief Whether the remote bridge of the connection has sent its
+  /// credentials. Only used by the thread of the connection.
+  public: bool authenticated = false;
+
+  /// \brief When the connection was established. Only used by the thread
+  /// of the connection.
+  public: std::chrono::steady_clock::time_point connectedAt;
+
+  /// \brief Whether the connection is up and authenticated.
+  public: std::atomic<bool> connected{false};
+
+  /// \brief Counters.
+  public: BridgeStatistics stats;
+
+  /// \brief Protects stats.
+  public: mutable std::mutex statsMutex;
+
+  /// \brief True when the threads should exit.
+  public: std::atomic<bool> exit{false};
+
+  /// \brief Whether the threads are running.
+  public: bool running = false;
+
+  /// \brief Thread of the connection.
+  public: std::thread connectionThread;
+
+  /// \brief Thread writing the frames.
+  public: std::thread writerThread;
+};
+
+//////////////////////////////////////////////////
+void BridgePrivate::OnMessage(BridgeLocalTopic &_topic, const char *_data,
+  const std::size_t _size, const MessageInfo &_info)
+{
+  // Don't send back the messages of the remote bridge.
+  if (_info.IntraProcess())
+  {
+    std::lock_guard<std::mutex> lock(this->namesMutex);
+    if (this->remoteNames.count(_topic.topic) > 0)
+      return;
+  }
+
+  std::lock_guard<std::mutex> lock(_topic.mutex);
+  if (!this->connected)
+  {
+    std::lock_guard<std::mutex> statsLock(this->statsMutex);
+    ++this->stats.droppedMessages;
+    return;
+  }
+
+  if (_topic.type != _info.Type())
+  {
+    _topic.type = _info.Type();
+    _topic.lastValid = false;
+    this->Enqueue(AdvertiseFrame(_topic), true);
+  }
+
+  std::string frame = this->Encode(_topic, _data, _size);
+  const auto kind = static_cast<BridgeFrame>(frame[4]);
+  const bool queued = this->Enqueue(std::move(frame), false);
+  if (!queued)
+    _topic.lastValid = false;
+
+  std::lock_guard<std::mutex> statsLock(this->statsMutex);
+  if (!queued)
+  {
+    ++this->stats.droppedMessages;
+    return;
+  }
+  ++this->stats.sentMessages;
+  this->stats.sentBytes += _size;
+  if (kind == BridgeFrame::REPEAT)
+    ++this->stats.repeatedMessages;
+  else if (kind == BridgeFrame::DELTA)
+    ++this->stats.deltaMessages;
+}
+
+//////////////////////////////////////////////////
+std::string BridgePrivate::Encode(BridgeLocalTopic &_topic,
+  const char *_data, const std::size_t _size)
+{
+  const BridgeTopicOptions &options = _topic.options;
+  const bool keyframe = !options.deltaEncoding || !_topic.lastValid ||
+    _topic.last.size() != _size || ++_topic.sinceKeyframe >= kKeyframeInterval;
+
+  ++_topic.seq;
+  BridgeFrame kind = BridgeFrame::MESSAGE;
+  const char *payload = _data;
+  if (!keyframe)
+  {
+    if (_size == 0 || memcmp(_topic.last.data(), _data, _size) == 0)
+    {
+      kind = BridgeFrame::REPEAT;
+    }
+    else if (options.compression != Compression_t::NONE)
+    {
+      // The difference is mostly zeros when a few fields change, which the
+      // codec shrinks to almost nothing.
+      kind = BridgeFrame::DELTA;
+      _topic.scratch.resize(_size);
+      for (std::size_t i = 0; i < _size; ++i)
+        _topic.scratch[i] = static_cast<char>(_topic.last[i] ^ _data[i]);
+      payload = _topic.scratch.data();
+    }
+  }
+  if (kind == BridgeFrame::MESSAGE)
+    _topic.sinceKeyframe = 0;
+
+  std::string frame = startFrame(kind, _topic.id,
+    kind == BridgeFrame::REPEAT ? 4 : 5 + _size);
+  appendU32(frame, _topic.seq);
+  if (kind != BridgeFrame::REPEAT)
+  {
+    std::size_t compressed = 0;
+    if (options.compression != Compression_t::NONE)
+    {
+      const std::size_t bound = CompressBound(options.compression, _size);
+      if (bound > 0)
+      {
+        frame.push_back(static_cast<char>(options.compression));
+        const std::size_t start = frame.size();
+        frame.resize(start + bound);
+        compressed = Compress(options.compression, options.compressionLevel,
+          payload, _size, &frame[start], bound);
+        frame.resize(compressed > 0 ? start + compressed : start - 1);
+      }
+    }
+
+    if (compressed == 0)
+    {
+      // A delta can't be sent without the codec, send the message itself.
+      if (kind == BridgeFrame::DELTA)
+      {
+        frame[4] = static_cast<char>(BridgeFrame::MESSAGE);
+        payload = _data;
+        _topic.sinceKeyframe = 0;
+      }
+      frame.push_back(static_cast<char>(Compression_t::NONE));
+      frame.append(payload, _size);
+    }
+  }
+  finishFrame(frame);
+
+  if (options.deltaEncoding)
+  {
+    _topic.last.assign(_data, _size);
+    _topic.lastValid = true;
+  }
+  return frame;
+}
+
+//////////////////////////////////////////////////
+std::string BridgePrivate::AdvertiseFrame(const BridgeLocalTopic &_topic)
+{
+  std::string frame = startFrame(BridgeFrame::ADVERTISE, _topic.id,
+    4 + _topic.topic.size() + _topic.type.size());
+  appendU32(frame, static_cast<uint32_t>(_topic.topic.size()));
+  frame.append(_topic.topic);
+  frame.append(_topic.type);
+  finishFrame(frame);
+  return frame;
+}
+
+//////////////////////////////////////////////////
+bool BridgePrivate::Enqueue(std::string &&_frame, const bool _force)
+{
+  {
+    std::lock_guard<std::mutex> lock(this->queueMutex);
+    if (!_force && this->queueBytes + _frame.size() > kMaxQueueBytes)
+      return false;
+    this->queueBytes += _frame.size();
+    this->queue.push_back(std::move(_frame));
+  }
+  this->queueCondition.notify_one();
+  return true;
+}
+
+//////////////////////////////////////////////////
+void BridgePrivate::OnConnected(const int _sock)
+{
+  setNoDelay(_sock);
+  this->sock = _sock;
+  this->rcvBuffer.clear();
+
+  // The remote bridge advertises its topics again.
+  this->remotes.clear();
+
+  // The frames of the previous connection are obsolete.
+  {
+    std::lock_guard<std::mutex> lock(this->queueMutex);
+    this->queue.clear();
+    this->queueBytes = 0;
+  }
+  {
+    std::lock_guard<std::mutex> lock(this->sendMutex);
+    this->writerSock = _sock;
+  }
+
+  // Nothing else is sent until the remote bridge is authenticated.
+  this->authenticated = false;
+  this->connectedAt = std::chrono::steady_clock::now();
+  this->Enqueue(this->HelloFrame(), true);
+}
+
+//////////////////////////////////////////////////
+std::string BridgePrivate::HelloFrame() const
+{
+  std::string frame = startFrame(BridgeFrame::HELLO, 0,
+    4 + this->username.size() + this->password.size());
+  appendU32(frame, static_cast<uint32_t>(this->username.size()));
+  frame.append(this->username);
+  frame.append(this->password);
+  finishFrame(frame);
+  return frame;
+}
+
+//////////////////////////////////////////////////
+bool BridgePrivate::Authenticate(const char *_data, const std::size_t _size)
+{
+  if (_size < 4 || readU32(_data) > _size - 4)
+    return false;
+
+  const uint32_t usernameSize = readU32(_data);
+  const std::string remoteUsername(_data + 4, usernameSize);
+  const std::string remotePassword(_data + 4 + usernameSize,
+    _size - 4 - usernameSize);
+
+  // Both secrets are always compared.
+  const bool sameUsername = sameSecret(remoteUsername, this->username);
+  const bool samePassword = sameSecret(remotePassword, this->password);
+  if (!sameUsername || !samePassword)
+  {
+    std::cerr << "Bridge: the credentials of the remote bridge don't match"
+              << std::endl;
+    return false;
+  }
+  this->authenticated = true;
+
+  // Advertise the topics whose type is known, the others are advertised
+  // with their first message.
+  std::vector<BridgeLocalTopic *> topics;
+  {
+    std::lock_guard<std::mutex> lock(this->localsMutex);
+    for (auto &local : this->locals)
+      topics.push_back(local.second.get());
+  }
+  for (BridgeLocalTopic *topic : topics)
+  {
+    std::lock_guard<std::mutex> lock(topic->mutex);
+    topic->lastValid = false;
+    if (!topic->type.empty())
+      this->Enqueue(AdvertiseFrame(*topic), true);
+  }
+
+  this->connected = true;
+  {
+    std::lock_guard<std::mutex> lock(this->statsMutex);
+    ++this->stats.connections;
+  }
+  this->queueCondition.notify_one();
+  return true;
+}
+
+//////////////////////////////////////////////////
+void BridgePrivate::Disconnect()
+{
+  if (this->sock < 0)
+    return;
+
+  this->connected = false;
+  this->authenticated = false;
+
+  // Wake up the writer if it's blocked on the socket.
+  shutdownSocket(this->sock);
+  {
+    std::lock_guard<std::mutex> lock(this->sendMutex);
+    this->writerSock = -1;
+  }
+  closeSocket(this->sock);
+  this->sock = -1;
+}
+
+//////////////////////////////////////////////////
+int BridgePrivate::ConnectToRemote() const
+{
+  addrinfo hints;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
+  addrinfo *result = nullptr;
+  if (getaddrinfo(this->remoteHost.c_str(),
+        std::to_string(this->remotePort).c_str(), &hints, &result) != 0 ||
+      !result)
+  {
+    return -1;
+  }
+
+  int sock = static_cast<int>(
+    socket(result->ai_family, result->ai_socktype, result->ai_protocol));
+  if (sock < 0)
+  {
+    freeaddrinfo(result);
+    return -1;
+  }
+
+  // Connect without blocking, so Stop() isn't delayed by an unreachable
+  // host.
+  setBlocking(sock, false);
+  connect(sock, result->ai_addr, static_cast<socklen_t>(result->ai_addrlen));
+  freeaddrinfo(result);
+
+  bool connectedSock = false;
+  for (int waited = 0; waited < kConnectTimeout && !this->exit;
+       waited += kPollTimeout)
+  {
+    zmq::pollitem_t item = {0, static_cast<ZMQ_FD_T>(sock), ZMQ_POLLOUT, 0};
+    try
+    {
+      zmq::poll(&item, 1, std::chrono::milliseconds(kPollTimeout));
+    }
+    catch (...)
+    {
+      break;
+    }
+
+    if (item.revents & (ZMQ_POLLOUT | ZMQ_POLLERR))
+    {
+      int error = 0;
+      socklen_t len = sizeof(error);
+      getsockopt(sock, SOL_SOCKET, SO_ERROR,
+        reinterpret_cast<char *>(&error), &len);
+      connectedSock = error == 0;
+      break;
+    }
+  }
+
+  if (!connectedSock || !setBlocking(sock, true))
+  {
+    closeSocket(sock);
+    return -1;
+  }
+  return sock;
+}
+
+//////////////////////////////////////////////////
+bool BridgePrivate::ReadFrames()
+{
+  char buffer[65536];
+  const auto received = recv(this->sock,
+    reinterpret_cast<raw_type *>(buffer), sizeof(buffer), 0);
+  if (received <= 0)
+    return false;
+
+  {
+    std::lock_guard<std::mutex> lock(this->statsMutex);
+    this->stats.receivedWireBytes += static_cast<uint64_t>(received);
+  }
+  this->rcvBuffer.append(buffer, static_cast<std::size_t>(received));
+
+  std::size_t offset = 0;
+  while (this->rcvBuffer.size() - offset >= 4)
+  {
+    const uint32_t size = readU32(&this->rcvBuffer[offset]);
+    if (size > kMaxFrameSize)
+      return false;
+    if (this->rcvBuffer.size() - offset - 4 < size)
+      break;
+
+    if (!this->HandleFrame(&this->rcvBuffer[offset + 4], size))
+      return false;
+    offset += 4 + size;
+  }
+  this->rcvBuffer.erase(0, offset);
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool BridgePrivate::DecodePayload(const char *_data, const std::size_t _size,
+  std::string &_msg)
+{
+  if (_size < 1)
+    return false;
+
+  const auto codec = static_cast<Compression_t>(_data[0]);
+  if (codec == Compression_t::NONE)
+  {
+    _msg.assign(_data + 1, _size - 1);
+    return true;
+  }
+  return Decompress(codec, _data + 1, _size - 1, _msg);
+}
+
+//////////////////////////////////////////////////
+bool BridgePrivate::HandleFrame(const char *_data, const std::size_t _size)
+{
+  if (_size < 5)
+    return false;
+
+  const auto kind = static_cast<BridgeFrame>(_data[0]);
+  const uint32_t id = readU32(_data + 1);
+  _data += 5;
+  std::size_t size = _size - 5;
+
+  // The remote bridge starts with its credentials, and only sends them
+  // once.
+  if (!this->authenticated || kind == BridgeFrame::HELLO)
+  {
+    if (this->authenticated || kind != BridgeFrame::HELLO ||
+        !this->Authenticate(_data, size))
+    {
+      std::lock_guard<std::mutex> lock(this->statsMutex);
+      ++this->stats.rejectedConnections;
+      return false;
+    }
+    return true;
+  }
+
+  if (kind == BridgeFrame::ADVERTISE)
+  {
+    if (size < 4 || readU32(_data) > size - 4)
+      return false;
+
+    const uint32_t topicSize = readU32(_data);
+    const std::string topic(_data + 4, topicSize);
+    {
+      std::lock_guard<std::mutex> lock(this->namesMutex);
+      if (this->allowedNames.count(topic) == 0)
+      {
+        if (this->rejectedNames.insert(topic).second)
+        {
+          std::cerr << "Bridge: ignoring the remote topic [" << topic
+                    << "], it isn't allowed" << std::endl;
+        }
+        // Its messages are ignored, see below.
+        this->remotes.erase(id);
+        return true;
+      }
+    }
+
+    BridgeRemoteTopic &remote = this->remotes[id];
+    remote.topic = topic;
+    remote.type.assign(_data + 4 + topicSize, size - 4 - topicSize);
+    remote.lastValid = false;
+
+    // The publisher is kept if the type doesn't change.
+    Node::Publisher &publisher = this->publishers[remote.topic];
+    std::string &type = this->publisherTypes[remote.topic];
+    if (!publisher || type != remote.type)
+    {
+      publisher = Node::Publisher();
+      publisher = this->node.Advertise(remote.topic, remote.type);
+      type = remote.type;
+      if (!publisher)
+      {
+        std::cerr << "Bridge: failed to advertise the remote topic ["
+                  << remote.topic << "]" << std::endl;
+      }
+    }
+
+    std::lock_guard<std::mutex> lock(this->namesMutex);
+    this->remoteNames.insert(remote.topic);
+    return true;
+  }
+
+  if (kind != BridgeFrame::MESSAGE && kind != BridgeFrame::DELTA &&
+      kind != BridgeFrame::REPEAT)
+  {
+    return false;
+  }
+  if (size < 4)
+    return false;
+
+  const uint32_t seq = readU32(_data);
+  _data += 4;
+  size -= 4;
+
+  auto it = this->remotes.find(id);
+  if (it == this->remotes.end())
+    return true;
+  BridgeRemoteTopic &remote = it->second;
+
+  if (kind == BridgeFrame::MESSAGE)
+  {
+    remote.lastValid = DecodePayload(_data, size, remote.last);
+  }
+  else if (!remote.lastValid || seq != remote.seq + 1)
+  {
+    // A frame was lost, wait for the next full message.
+    remote.lastValid = false;
+  }
+  else if (kind == BridgeFrame::DELTA)
+  {
+    std::string &delta = this->rcvScratch;
+    remote.lastValid = DecodePayload(_data, size, delta) &&
+      delta.size() == remote.last.size();
+    for (std::size_t i = 0; remote.lastValid && i < delta.size(); ++i)
+      remote.last[i] = static_cast<char>(remote.last[i] ^ delta[i]);
+  }
+  remote.seq = seq;
+
+  if (!remote.lastValid)
+    return true;
+
+  Node::Publisher &publisher = this->publishers[remote.topic];
+  if (publisher)
+    publisher.PublishRaw(remote.last, remote.type);
+
+  std::lock_guard<std::mutex> lock(this->statsMutex);
+  ++this->stats.receivedMessages;
+  return true;
+}
+
+//////////////////////////////////////////////////
+void BridgePrivate::RunConnection()
+{
+  auto nextAttempt = std::chrono::steady_clock::now();
+  while (!this->exit)
+  {
+    std::vector<bool> ready;
+    if (this->sock >= 0)
+    {
+      pollSockets({this->sock}, kPollTimeout, ready);
+      if (ready[0] && !this->ReadFrames())
+      {
+        this->Disconnect();
+      }
+      else if (!this->authenticated &&
+               std::chrono::steady_clock::now() - this->connectedAt >
+               std::chrono::milliseconds(kConnectTimeout))
+      {
+        // A silent peer would prevent the remote bridge from connecting.
+        std::cerr << "Bridge: the remote bridge didn't send its credentials"
+                  << std::endl;
+        {
+          std::lock_guard<std::mutex> lock(this->statsMutex);
+          ++this->stats.rejectedConnections;
+        }
+        this->Disconnect();
+      }
+    }
+    else if (this->listenSock >= 0)
+    {
+      pollSockets({this->listenSock}, kPollTimeout, ready);
+      if (!ready[0] || this->exit)
+        continue;
+
+      const int peer = static_cast<int>(accept(this->listenSock, nullptr,
+        nullptr));
+      if (peer >= 0)
+        this->OnConnected(peer);
+    }
+    else if (std::chrono::steady_clock::now() >= nextAttempt)
+    {
+      const int peer = this->ConnectToRemote();
+      if (peer >= 0)
+        this->OnConnected(peer);
+      else
+        nextAttempt = std::chrono::steady_clock::now() + kReconnectInterval;
+    }
+    else
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(kPollTimeout));
+    }
+  }
+
+  this->Disconnect();
+}
+
+//////////////////////////////////////////////////
+void BridgePrivate::RunWriter()
+{
+  while (true)
+  {
+    std::string frame;
+    {
+      std::unique_lock<std::mutex> lock(this->queueMutex);
+      this->queueCondition.wait(lock, [this]
+        {
+          return this->exit || !this->queue.empty();
+        });
+      if (this->exit)
+        return;
+
+      frame = std::move(this->queue.front());
+      this->queue.pop_front();
+      this->queueBytes -= frame.size();
+    }
+
+    std::lock_guard<std::mutex> lock(this->sendMutex);
+    if (this->writerSock < 0)
+      continue;
+
+    if (!sendAll(this->writerSock, frame))
+    {
+      // The thread of the connection notices the failure and closes it.
+      shutdownSocket(this->writerSock);
+      continue;
+    }
+
+    std::lock_guard<std::mutex> statsLock(this->statsMutex);
+    this->stats.sentWireBytes += frame.size();
+  }
+}
+
+//////////////////////////////////////////////////
+Bridge::Bridge(const NodeOptions &_options)
+  : dataPtr(new BridgePrivate(_options))
+{
+}
+
+//////////////////////////////////////////////////
+Bridge::~Bridge()
+{
+  this->Stop();
+
+  // Stop the callbacks before the state they use is destroyed.
+  std::lock_guard<std::mutex> lock(this->dataPtr->localsMutex);
+  for (const auto &local : this->dataPtr->locals)
+    this->dataPtr->node.Unsubscribe(local.first);
+}
+
+//////////////////////////////////////////////////
+bool Bridge::Listen(const int _port, const std::string &_interface)
+{
+  if (this->dataPtr->running)
+    return false;
+
+  if (_port < 0 || _port > 65535)
+  {
+    std::cerr << "Bridge: invalid port [" << _port << "]" << std::endl;
+    return false;
+  }
+
+  sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(static_cast<u_short>(_port));
+  if (inet_pton(AF_INET, _interface.c_str(), &addr.sin_addr) != 1)
+  {
+    std::cerr << "Bridge: invalid interface [" << _interface << "]"
+              << std::endl;
+    return false;
+  }
+
+  // Any host reaching the other interfaces could connect.
+  const bool loopback = (ntohl(addr.sin_addr.s_addr) >> 24) == 127;
+  if (!loopback && this->dataPtr->username.empty() &&
+      this->dataPtr->password.empty())
+  {
+    std::cerr << "Bridge: listening on [" << _interface << "] requires "
+              << "credentials, see GZ_TRANSPORT_USERNAME and "
+              << "GZ_TRANSPORT_PASSWORD" << std::endl;
+    return false;
+  }
+
+#ifdef _WIN32
+  WSADATA wsaData;
+  if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0)
+  {
+    std::cerr << "Unable to load WinSock DLL" << std::endl;
+    return false;
+  }
+#endif
+
+  int sock = static_cast<int>(socket(PF_INET, SOCK_STREAM, IPPROTO_TCP));
+  if (sock < 0)
+  {
+    std::cerr << "Bridge: socket creation failed." << std::endl;
+    return false;
+  }
+
+  int reuseAddr = 1;
+  setsockopt(sock, SOL_SOCKET, SO_REUSEADDR,
+    reinterpret_cast<const char *>(&reuseAddr), sizeof(reuseAddr));
+
+  socklen_t addrLen = sizeof(addr);
+
+  if (bind(sock, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0 ||
+      listen(sock, 1) < 0 ||
+      getsockname(sock, reinterpret_cast<sockaddr *>(&addr), &addrLen) < 0)
+  {
+    std::cerr << "Bridge: listening on port [" << _port << "] failed: "
+              << strerror(errno) << std::endl;
+    closeSocket(sock);
+#ifdef _WIN32
+    WSACleanup();
+#endif
+    return false;
+  }
+
+  this->dataPtr->listenSock = sock;
+  this->dataPtr->boundPort = ntohs(addr.sin_port);
+  this->dataPtr->exit = false;
+  this->dataPtr->running = true;
+  this->dataPtr->connectionThread =
+    std::thread(&BridgePrivate::RunConnection, this->dataPtr.get());
+  this->dataPtr->writerThread =
+    std::thread(&BridgePrivate::RunWriter, this->dataPtr.get());
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool Bridge::Connect(const std::string &_host, const int _port)
+{
+  if (this->dataPtr->running)
+    return false;
+
+  if (_port <= 0 || _port > 65535)
+  {
+    std::cerr << "Bridge: invalid port [" << _port << "]" << std::endl;
+    return false;
+  }
+
+#ifdef _WIN32
+  WSADATA wsaData;
+  if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0)
+  {
+    std::cerr << "Unable to load WinSock DLL" << std::endl;
+    return false;
+  }
+#endif
+
+  this->dataPtr->remoteHost = _host;
+  this->dataPtr->remotePort = _port;
+  this->dataPtr->exit = false;
+  this->dataPtr->running = true;
+  this->dataPtr->connectionThread =
+    std::thread(&BridgePrivate::RunConnection, this->dataPtr.get());
+  this->dataPtr->writerThread =
+    std::thread(&BridgePrivate::RunWriter, this->dataPtr.get());
+  return true;
+}
+
+//////////////////////////////////////////////////
+void Bridge::Stop()
+{
+  if (!this->dataPtr->running)
+    return;
+
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->queueMutex);
+    this->dataPtr->exit = true;
+  }
+  this->dataPtr->queueCondition.notify_all();
+
+  // The thread of the connection closes it, which also wakes up the writer
+  // if it's blocked on the socket.
+  if (this->dataPtr->connectionThread.joinable())
+    this->dataPtr->connectionThread.join();
+  if (this->dataPtr->writerThread.joinable())
+    this->dataPtr->writerThread.join();
+
+  if (this->dataPtr->listenSock >= 0)
+  {
+    closeSocket(this->dataPtr->listenSock);
+    this->dataPtr->listenSock = -1;
+    this->dataPtr->boundPort = 0;
+  }
+#ifdef _WIN32
+  WSACleanup();
+#endif
+  this->dataPtr->running = false;
+}
+
+//////////////////////////////////////////////////
+int Bridge::Port() const
+{
+  return this->dataPtr->boundPort;
+}
+
+//////////////////////////////////////////////////
+bool Bridge::Connected() const
+{
+  return this->dataPtr->connected;
+}
+
+//////////////////////////////////////////////////
+bool Bridge::AddTopic(const std::string &_topic,
+  const BridgeTopicOptions &_options)
+{
+  if (_options.compression != Compression_t::NONE &&
+      !CompressionAvailable(_options.compression))
+  {
+    std::cerr << "Bridge: the codec ["
+              << CompressionName(_options.compression)
+              << "] isn't available in this build" << std::endl;
+    return false;
+  }
+
+  BridgeLocalTopic *topic;
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->localsMutex);
+    auto &local = this->dataPtr->locals[_topic];
+    if (local)
+      return false;
+
+    local = std::make_unique<BridgeLocalTopic>();
+    local->id = this->dataPtr->nextId++;
+    local->topic = _topic;
+    local->options = _options;
+    topic = local.get();
+  }
+
+  SubscribeOptions opts;
+  if (_options.maxRate > 0)
+    opts.SetMsgsPerSec(_options.maxRate);
+
+  BridgePrivate *bridge = this->dataPtr.get();
+  RawCallback cb = [bridge, topic](const char *_data, const size_t _size,
+    const MessageInfo &_info)
+  {
+    bridge->OnMessage(*topic, _data, _size, _info);
+  };
+
+  if (!this->dataPtr->node.SubscribeRaw(_topic, cb, kGenericMessageType,
+        opts))
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->localsMutex);
+    this->dataPtr->locals.erase(_topic);
+    return false;
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool Bridge::AllowRemoteTopic(const std::string &_topic)
+{
+  if (!TopicUtils::IsValidTopic(_topic))
+  {
+    std::cerr << "Bridge: invalid topic [" << _topic << "]" << std::endl;
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(this->dataPtr->namesMutex);
+  this->dataPtr->allowedNames.insert(_topic);
+  this->dataPtr->rejectedNames.erase(_topic);
+  return true;
+}
+
+//////////////////////////////////////////////////
+void Bridge::SetCredentials(const std::string &_username,
+  const std::string &_password)
+{
+  this->dataPtr->username = _username;
+  this->dataPtr->password = _password;
+}
+
+//////////////////////////////////////////////////
+std::vector<std::string> Bridge::RemoteTopics() const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->namesMutex);
+  return std::vector<std::string>(this->dataPtr->remoteNames.begin(),
+    this->dataPtr->remoteNames.end());
+}
+
+//////////////////////////////////////////////////
+BridgeStatistics Bridge::Statistics() const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->statsMutex);
+  return this->dataPtr->stats;
+}
@@ -0,0 +1,194 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gz/msgs/int32.pb.h>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include "gz/transport/Bridge.hh"
+#include "gz/transport/Node.hh"
+#include "gz/transport/NodeOptions.hh"
+
+#include "gtest/gtest.h"
+#include "test_utils.hh"
+
+using namespace gz;
+using namespace transport;
+
+//////////////////////////////////////////////////
+/// \brief Check the misuses of the API.
+TEST(BridgeTest, Api)
+{
+  Bridge bridge;
+  EXPECT_EQ(0, bridge.Port());
+  EXPECT_FALSE(bridge.Connected());
+  EXPECT_FALSE(bridge.Connect("127.0.0.1", 0));
+  EXPECT_FALSE(bridge.Listen(70000));
+
+  EXPECT_TRUE(bridge.AddTopic("/foo"));
+  EXPECT_FALSE(bridge.AddTopic("/foo"));
+  EXPECT_FALSE(bridge.AddTopic("////"));
+
+  EXPECT_TRUE(bridge.AllowRemoteTopic("/bar"));
+  EXPECT_FALSE(bridge.AllowRemoteTopic("////"));
+
+  // The interfaces other than the loopback require credentials.
+  EXPECT_FALSE(bridge.Listen(0, "not an address"));
+  bridge.SetCredentials("", "");
+  EXPECT_FALSE(bridge.Listen(0, "0.0.0.0"));
+
+  ASSERT_TRUE(bridge.Listen(0));
+  EXPECT_NE(0, bridge.Port());
+  EXPECT_FALSE(bridge.Listen(0));
+  bridge.Stop();
+  EXPECT_EQ(0, bridge.Port());
+
+  bridge.SetCredentials("user", "pass");
+  ASSERT_TRUE(bridge.Listen(0, "0.0.0.0"));
+  bridge.Stop();
+}
+
+//////////////////////////////////////////////////
+/// \brief Forward a topic from a partition to another one through two
+/// bridges.
+TEST(BridgeTest, ForwardBetweenPartitions)
+{
+  NodeOptions optionsA;
+  optionsA.SetPartition("bridge_a_" + testing::getRandomNumber());
+  NodeOptions optionsB;
+  optionsB.SetPartition("bridge_b_" + testing::getRandomNumber());
+  const std::string topic = "/bridged";
+
+  Bridge bridgeB(optionsB);
+  ASSERT_TRUE(bridgeB.AllowRemoteTopic(topic));
+  ASSERT_TRUE(bridgeB.Listen(0));
+
+  Bridge bridgeA(optionsA);
+  BridgeTopicOptions topicOptions;
+  topicOptions.maxRate = 1000;
+  ASSERT_TRUE(bridgeA.AddTopic(topic, topicOptions));
+  ASSERT_TRUE(bridgeA.Connect("127.0.0.1", bridgeB.Port()));
+
+  std::atomic<int> received{0};
+  std::atomic<int> lastValue{0};
+  Node subscriber(optionsB);
+  std::function<void(const msgs::Int32 &)> cb =
+    [&received, &lastValue](const msgs::Int32 &_msg)
+    {
+      lastValue = _msg.data();
+      ++received;
+    };
+  ASSERT_TRUE(subscriber.Subscribe(topic, cb));
+
+  Node publisherNode(optionsA);
+  auto publisher = publisherNode.Advertise<msgs::Int32>(topic);
+  ASSERT_TRUE(publisher);
+
+  for (int i = 0; i < 300 && !bridgeA.Connected(); ++i)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  ASSERT_TRUE(bridgeA.Connected());
+
+  // The same message is sent as repeat frames once the remote bridge has
+  // it.
+  msgs::Int32 msg;
+  msg.set_data(42);
+  for (int i = 0; i < 300 && received < 5; ++i)
+  {
+    EXPECT_TRUE(publisher.Publish(msg));
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  EXPECT_GE(received, 5);
+  EXPECT_EQ(42, lastValue);
+
+  ASSERT_EQ(1u, bridgeB.RemoteTopics().size());
+  EXPECT_EQ(topic, bridgeB.RemoteTopics()[0]);
+
+  const BridgeStatistics stats = bridgeA.Statistics();
+  EXPECT_EQ(1u, stats.connections);
+  EXPECT_GT(stats.sentMessages, 0u);
+  EXPECT_GT(stats.repeatedMessages, 0u);
+  EXPECT_GT(bridgeB.Statistics().receivedMessages, 0u);
+
+  // A new value is sent in full.
+  msg.set_data(7);
+  for (int i = 0; i < 300 && lastValue != 7; ++i)
+  {
+    EXPECT_TRUE(publisher.Publish(msg));
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  EXPECT_EQ(7, lastValue);
+}
+
+//////////////////////////////////////////////////
+/// \brief The remote bridges with other credentials are dropped, and the
+/// remote topics not allowed are ignored.
+TEST(BridgeTest, Authentication)
+{
+  NodeOptions optionsA;
+  optionsA.SetPartition("bridge_a_" + testing::getRandomNumber());
+  NodeOptions optionsB;
+  optionsB.SetPartition("bridge_b_" + testing::getRandomNumber());
+  const std::string topic = "/bridged";
+
+  Bridge bridgeB(optionsB);
+  bridgeB.SetCredentials("user", "pass");
+  ASSERT_TRUE(bridgeB.Listen(0));
+
+  Node publisherNode(optionsA);
+  auto publisher = publisherNode.Advertise<msgs::Int32>(topic);
+  ASSERT_TRUE(publisher);
+  msgs::Int32 msg;
+  msg.set_data(42);
+
+  {
+    Bridge bridgeA(optionsA);
+    bridgeA.SetCredentials("user", "wrong");
+    ASSERT_TRUE(bridgeA.AddTopic(topic));
+    ASSERT_TRUE(bridgeA.Connect("127.0.0.1", bridgeB.Port()));
+
+    for (int i = 0; i < 300 &&
+         bridgeB.Statistics().rejectedConnections == 0; ++i)
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_GT(bridgeB.Statistics().rejectedConnections, 0u);
+    EXPECT_FALSE(bridgeA.Connected());
+    EXPECT_FALSE(bridgeB.Connected());
+  }
+
+  // The right credentials, but the topic isn't allowed.
+  Bridge bridgeA(optionsA);
+  bridgeA.SetCredentials("user", "pass");
+  ASSERT_TRUE(bridgeA.AddTopic(topic));
+  ASSERT_TRUE(bridgeA.Connect("127.0.0.1", bridgeB.Port()));
+
+  for (int i = 0; i < 300 && !bridgeA.Connected(); ++i)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  ASSERT_TRUE(bridgeA.Connected());
+
+  for (int i = 0; i < 50; ++i)
+  {
+    EXPECT_TRUE(publisher.Publish(msg));
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  EXPECT_GT(bridgeA.Statistics().sentMessages, 0u);
+  EXPECT_TRUE(bridgeB.RemoteTopics().empty());
+  EXPECT_EQ(0u, bridgeB.Statistics().receivedMessages);
+}
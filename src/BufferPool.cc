@@ -0,0 +1,275 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "BufferPool.hh"
+#include "HugePages.hh"
+#include "ThreadSettings.hh"
+
+namespace gz
+{
+  namespace transport
+  {
+    inline namespace GZ_TRANSPORT_VERSION_NAMESPACE
+    {
+    /// \brief Log2 of the smallest size class.
+    static const std::size_t kMinClassLog2 = 8;
+
+    /// \brief Log2 of the largest size class.
+    static const std::size_t kMaxClassLog2 = 30;
+
+    /// \brief Number of size classes.
+    static const std::size_t kNumClasses = kMaxClassLog2 - kMinClassLog2 + 1;
+
+    /// \brief Get the size class used for a given buffer size.
+    /// \param[in] _size Buffer size (bytes).
+    /// \return The size class index or kNumClasses if the size is too big.
+    static std::size_t sizeClass(const std::size_t _size)
+    {
+      std::size_t log2 = kMinClassLog2;
+      while (log2 <= kMaxClassLog2 && (std::size_t(1) << log2) < _size)
+        ++log2;
+      return log2 - kMinClassLog2;
+    }
+
+    /// \brief Get the capacity of the buffers of a size class.
+    /// \param[in] _class The size class index.
+    /// \return The capacity (bytes).
+    static std::size_t classCapacity(const std::size_t _class)
+    {
+      return std::size_t(1) << (_class + kMinClassLog2);
+    }
+
+    /// \internal
+    /// \brief Private data for BufferPool class.
+    class BufferPoolPrivate
+    {
+      /// \brief Constructor.
+      /// \param[in] _maxBytes Maximum memory cached by the pool (bytes).
+      /// \param[in] _hugePages Kind of huge pages backing the large buffers.
+      /// \param[in] _hugePagesMinSize Size of the smallest buffer backed by
+      /// huge pages (bytes).
+      public: BufferPoolPrivate(const uint64_t _maxBytes,
+                                const HugePages_t _hugePages,
+                                const uint64_t _hugePagesMinSize)
+        : maxBytes(_maxBytes),
+          hugePages(_hugePages),
+          hugePagesMinSize(_hugePagesMinSize),
+          freeLists(NumaTopology::Host().NodeCount())
+      {
+      }
+
+      /// \brief Allocate a buffer, with huge pages if it is large enough.
+      /// \param[in] _size Size of the buffer (bytes).
+      /// \param[out] _faultsSaved Page faults saved by the huge pages.
+      /// \return The buffer, freed when released.
+      public: std::shared_ptr<char> Allocate(const std::size_t _size,
+                                             uint64_t &_faultsSaved)
+      {
+        _faultsSaved = 0;
+        if (this->hugePages != HugePages_t::NONE &&
+            _size >= this->hugePagesMinSize)
+        {
+          std::shared_ptr<char> buffer =
+            AllocateHugePages(_size, this->hugePages, _faultsSaved);
+          if (buffer)
+          {
+            if (_faultsSaved > 0)
+            {
+              ++this->hugePageBuffers;
+              this->hugePageFaultsSaved += _faultsSaved;
+            }
+            return buffer;
+          }
+        }
+        return std::shared_ptr<char>(new char[_size],
+                                     std::default_delete<char[]>());
+      }
+
+      /// \brief Return a buffer to the pool or free it if the pool is full.
+      /// \param[in] _buffer The buffer.
+      /// \param[in] _class The size class of the buffer.
+      /// \param[in] _node NUMA node where the buffer was first used.
+      public: void Release(std::shared_ptr<char> _buffer,
+                           const std::size_t _class,
+                           const std::size_t _node)
+      {
+        const std::size_t capacity = classCapacity(_class);
+        std::lock_guard<std::mutex> lk(this->mutex);
+        if (this->cachedBytes + capacity <= this->maxBytes)
+        {
+          this->freeLists[_node][_class].push_back(std::move(_buffer));
+          this->cachedBytes += capacity;
+        }
+      }
+
+      /// \brief Maximum memory cached by the pool (bytes).
+      public: const uint64_t maxBytes;
+
+      /// \brief Kind of huge pages backing the large buffers.
+      public: const HugePages_t hugePages;
+
+      /// \brief Size of the smallest buffer backed by huge pages (bytes).
+      public: const uint64_t hugePagesMinSize;
+
+      /// \brief Memory currently cached by the pool (bytes).
+      public: uint64_t cachedBytes = 0;
+
+      /// \brief Free buffers for each NUMA node and size class. A buffer is
+      /// reused on the node whose memory it was first written from, so that
+      /// a publisher doesn't serialize into the memory of another socket.
+      public: std::vector<std::array<std::vector<std::shared_ptr<char>>,
+        kNumClasses>> freeLists;
+
+      /// \brief Mutex to protect the free lists.
+      public: mutable std::mutex mutex;
+
+      /// \brief Number of hits.
+      public: std::atomic<uint64_t> hits{0};
+
+      /// \brief Number of misses.
+      public: std::atomic<uint64_t> misses{0};
+
+      /// \brief Number of buffers allocated with huge pages.
+      public: std::atomic<uint64_t> hugePageBuffers{0};
+
+      /// \brief Page faults saved by the huge pages.
+      public: std::atomic<uint64_t> hugePageFaultsSaved{0};
+    };
+
+    //////////////////////////////////////////////////
+    BufferPool::BufferPool(const uint64_t _maxBytes,
+      const HugePages_t _hugePages, const uint64_t _hugePagesMinSize)
+      : dataPtr(std::make_shared<BufferPoolPrivate>(_maxBytes, _hugePages,
+          _hugePagesMinSize))
+    {
+    }
+
+    //////////////////////////////////////////////////
+    BufferPool::~BufferPool()
+    {
+    }
+
+    //////////////////////////////////////////////////
+    SerializedBuffer BufferPool::Acquire(const std::size_t _size,
+                                         uint64_t *_faultsSaved)
+    {
+      uint64_t faultsSaved = 0;
+      if (_faultsSaved)
+        *_faultsSaved = 0;
+
+      const std::size_t cls = sizeClass(_size);
+
+      // Too big to be cached: plain allocation.
+      if (cls >= kNumClasses || classCapacity(cls) > this->dataPtr->maxBytes)
+      {
+        ++this->dataPtr->misses;
+        if (this->dataPtr->hugePages == HugePages_t::NONE)
+          return SerializedBuffer(_size);
+        SerializedBuffer buffer(
+          this->dataPtr->Allocate(_size, faultsSaved), _size);
+        if (_faultsSaved)
+          *_faultsSaved = faultsSaved;
+        return buffer;
+      }
+
+      // A new buffer is allocated on the node of the calling thread when it
+      // is first written to.
+      std::size_t node = static_cast<std::size_t>(CurrentNumaNode());
+      if (node >= this->dataPtr->freeLists.size())
+        node = 0;
+
+      std::shared_ptr<char> buffer;
+      {
+        std::lock_guard<std::mutex> lk(this->dataPtr->mutex);
+        auto &freeList = this->dataPtr->freeLists[node][cls];
+        if (!freeList.empty())
+        {
+          buffer = std::move(freeList.back());
+          freeList.pop_back();
+          this->dataPtr->cachedBytes -= classCapacity(cls);
+        }
+      }
+
+      if (buffer)
+        ++this->dataPtr->hits;
+      else
+      {
+        ++this->dataPtr->misses;
+        buffer = this->dataPtr->Allocate(classCapacity(cls), faultsSaved);
+        if (_faultsSaved)
+          *_faultsSaved = faultsSaved;
+      }
+
+      // The deleter keeps the pool alive, the buffer might be released by
+      // ZMQ after this object is destroyed.
+      std::shared_ptr<BufferPoolPrivate> pool = this->dataPtr;
+      char *data = buffer.get();
+      std::shared_ptr<char> storage(data,
+        [pool, buffer, cls, node](char *) mutable
+        {
+          pool->Release(std::move(buffer), cls, node);
+        });
+
+      return SerializedBuffer(std::move(storage), _size);
+    }
+
+    //////////////////////////////////////////////////
+    uint64_t BufferPool::Hits() const
+    {
+      return this->dataPtr->hits;
+    }
+
+    //////////////////////////////////////////////////
+    uint64_t BufferPool::Misses() const
+    {
+      return this->dataPtr->misses;
+    }
+
+    //////////////////////////////////////////////////
+    uint64_t BufferPool::HugePageBuffers() const
+    {
+      return this->dataPtr->hugePageBuffers;
+    }
+
+    //////////////////////////////////////////////////
+    uint64_t BufferPool::HugePageFaultsSaved() const
+    {
+      return this->dataPtr->hugePageFaultsSaved;
+    }
+
+    //////////////////////////////////////////////////
+    uint64_t BufferPool::CachedBytes() const
+    {
+      std::lock_guard<std::mutex> lk(this->dataPtr->mutex);
+      return this->dataPtr->cachedBytes;
+    }
+
+    //////////////////////////////////////////////////
+    uint64_t BufferPool::MaxBytes() const
+    {
+      return this->dataPtr->maxBytes;
+    }
+    }
+  }
+}
@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GZ_TRANSPORT_BUFFERPOOL_HH_
+#define GZ_TRANSPORT_BUFFERPOOL_HH_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "gz/transport/AdvertiseOptions.hh"
+#include "gz/transport/config.hh"
+
+#include "SerializedBuffer.hh"
+
+namespace gz
+{
+  namespace transport
+  {
+    inline namespace GZ_TRANSPORT_VERSION_NAMESPACE
+    {
+    class BufferPoolPrivate;
+
+    /// \internal
+    /// \brief A pool of serialization buffers organized in power of two size
+    /// classes. Buffers returned by Acquire() go back to the pool when the
+    /// last reference is released, e.g.: when ZMQ calls the deallocation
+    /// function after sending the message. The amount of memory cached by
+    /// the pool is capped, extra buffers are freed. The buffers are cached
+    /// by NUMA node, a thread only reuses the buffers of its own node. The
+    /// large buffers can be backed by huge pages.
+    class BufferPool
+    {
+      /// \brief Constructor.
+      /// \param[in] _maxBytes Maximum memory cached by the pool (bytes).
+      /// \param[in] _hugePages Kind of huge pages backing the large buffers.
+      /// \param[in] _hugePagesMinSize Size of the smallest buffer backed by
+      /// huge pages (bytes).
+      public: explicit BufferPool(const uint64_t _maxBytes,
+                  const HugePages_t _hugePages = HugePages_t::NONE,
+                  const uint64_t _hugePagesMinSize = 0);
+
+      /// \brief Destructor. Buffers still in use remain valid.
+      public: ~BufferPool();
+
+      /// \brief Get a buffer of at least _size bytes.
+      /// \param[in] _size Requested size (bytes).
+      /// \param[out] _faultsSaved If not null, set to the page faults saved
+      /// by a new buffer backed by huge pages, 0 otherwise.
+      /// \return A buffer with Size() equal to _size.
+      public: SerializedBuffer Acquire(const std::size_t _size,
+                                       uint64_t *_faultsSaved = nullptr);
+
+      /// \brief Number of requests served with a cached buffer.
+      /// \return The number of hits.
+      public: uint64_t Hits() const;
+
+      /// \brief Number of requests that required a new allocation.
+      /// \return The number of misses.
+      public: uint64_t Misses() const;
+
+      /// \brief Number of buffers allocated with huge pages.
+      /// \return The number of buffers.
+      public: uint64_t HugePageBuffers() const;
+
+      /// \brief Page faults saved by the buffers allocated with huge pages,
+      /// compared to regular pages.
+      /// \return The number of page faults.
+      public: uint64_t HugePageFaultsSaved() const;
+
+      /// \brief Memory currently cached by the pool.
+      /// \return The cached memory (bytes).
+      public: uint64_t CachedBytes() const;
+
+      /// \brief Maximum memory cached by the pool.
+      /// \return The maximum memory (bytes).
+      public: uint64_t MaxBytes() const;
+
+      /// \brief Private data. This is shared with the outstanding buffers.
+      private: std::shared_ptr<BufferPoolPrivate> dataPtr;
+    };
+    }
+  }
+}
+#endif
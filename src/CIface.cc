@@ -15,23 +15,122 @@
  *
 */
 
+#ifndef _WIN32
+  #include <fcntl.h>
+  #include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <iterator>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
 
 #include "gz/transport/Node.hh"
 #include "gz/transport/SubscribeOptions.hh"
 #include "gz/transport/CIface.h"
 
+/// \brief A wrapper to store a publisher and its message type.
+struct GzTransportPublisher
+{
+  /// \brief The publisher.
+  gz::transport::Node::Publisher publisher;
+
+  /// \brief Name of the message type.
+  std::string msgType;
+};
+
+/// \brief A message received by a deferred subscription, waiting for
+/// gzTransportSpinOnce.
+struct GzTransportDeferredMessage
+{
+  /// \brief Topic of the subscription.
+  std::string topic;
+
+  /// \brief Serialized message.
+  std::string data;
+
+  /// \brief Name of the message type.
+  std::string msgType;
+
+  /// \brief The callback of the subscription.
+  void (*callback)(const char *, size_t, const char *, void *);
+
+  /// \brief Arbitrary user data pointer of the subscription.
+  void *userData;
+};
+
+/// \brief Default maximum number of messages of the deferred subscriptions
+/// waiting for gzTransportSpinOnce.
+static const size_t kDefaultMaxDeferred = 1000;
+
 /// \brief A wrapper to store a Gazebo Transport node and its publishers.
 struct GzTransportNode
 {
+  /// \brief Destructor. The node is destroyed first, so no deferred
+  /// message arrives afterwards.
+  ~GzTransportNode()
+  {
+    this->nodePtr.reset();
+#ifndef _WIN32
+    if (this->eventFds[0] >= 0)
+    {
+      close(this->eventFds[0]);
+      close(this->eventFds[1]);
+    }
+#endif
+  }
+
   /// \brief Pointer to the node.
   std::unique_ptr<gz::transport::Node> nodePtr;
 
-  /// \brief All publishers of this node.
-  std::map<std::string, gz::transport::Node::Publisher> publishers;
+  /// \brief All publishers of this node. The publishers have a stable
+  /// address, so they can be handed out as GzTransportPublisher.
+  std::map<std::string, std::unique_ptr<GzTransportPublisher>> publishers;
+
+  /// \brief Protects deferred, maxDeferred, droppedDeferred and eventFds.
+  std::mutex deferredMutex;
+
+  /// \brief Messages of the deferred subscriptions, oldest first.
+  std::deque<GzTransportDeferredMessage> deferred;
+
+  /// \brief Maximum size of deferred, the oldest message is dropped when
+  /// it's reached. 0 means no limit.
+  size_t maxDeferred = kDefaultMaxDeferred;
+
+  /// \brief Number of messages dropped from deferred.
+  size_t droppedDeferred = 0;
+
+  /// \brief Pipe readable while deferred isn't empty. One byte is written
+  /// when the first message is queued and read when the queue is emptied.
+  int eventFds[2] = {-1, -1};
 };
 
+/////////////////////////////////////////////////
+/// \brief Empty the pipe of a node after its deferred queue was emptied.
+/// The caller holds deferredMutex.
+/// \param[in] _node The node.
+static void drainEventFd(GzTransportNode *_node)
+{
+#ifndef _WIN32
+  if (_node->deferred.empty() && _node->eventFds[0] >= 0)
+  {
+    char bytes[64];
+    while (read(_node->eventFds[0], bytes, sizeof(bytes)) > 0)
+    {
+    }
+  }
+#else
+  (void)_node;
+#endif
+}
+
 /////////////////////////////////////////////////
 GzTransportNode *gzTransportNodeCreate(const char *_partition)
 {
@@ -62,11 +161,30 @@ int gzTransportAdvertise(GzTransportNode *_node, const char *_topic,
 
   // Create a publisher if one does not exist.
   if (_node->publishers.find(_topic) == _node->publishers.end())
-    _node->publishers[_topic] = _node->nodePtr->Advertise(_topic, _msgType);
+  {
+    auto pub = std::make_unique<GzTransportPublisher>();
+    pub->publisher = _node->nodePtr->Advertise(_topic, _msgType);
+    pub->msgType = _msgType;
+    _node->publishers[_topic] = std::move(pub);
+  }
 
   return 0;
 }
 
+/////////////////////////////////////////////////
+GzTransportPublisher *gzTransportAdvertisePublisher(GzTransportNode *_node,
+    const char *_topic, const char *_msgType)
+{
+  if (!_node || !_topic || !_msgType ||
+      gzTransportAdvertise(_node, _topic, _msgType) != 0)
+  {
+    return nullptr;
+  }
+
+  GzTransportPublisher *pub = _node->publishers[_topic].get();
+  return pub->publisher ? pub : nullptr;
+}
+
 /////////////////////////////////////////////////
 int gzTransportPublish(GzTransportNode *_node, const char *_topic,
     const void *_data, const char *_msgType)
@@ -78,13 +196,60 @@ int gzTransportPublish(GzTransportNode *_node, const char *_topic,
   if (gzTransportAdvertise(_node, _topic, _msgType) == 0)
   {
     // Publish the message.
-    return _node->publishers[_topic].PublishRaw(
+    return _node->publishers[_topic]->publisher.PublishRaw(
       reinterpret_cast<const char*>(_data), _msgType) ? 0 : 1;
   }
 
   return 1;
 }
 
+/////////////////////////////////////////////////
+int gzTransportPublishBuffer(GzTransportNode *_node,
+    GzTransportPublisher *_pub, const void *_data, size_t _size)
+{
+  if (!_node || !_pub || (!_data && _size > 0))
+    return 1;
+
+  // Copy the message once, into a buffer that the transport shares with the
+  // subscribers and the sockets.
+  auto loan = _pub->publisher.Loan(_size);
+  if (!loan)
+    return 1;
+  if (_size > 0)
+    std::memcpy(loan.Data(), _data, _size);
+
+  return _pub->publisher.PublishLoaned(std::move(loan), _pub->msgType) ? 0 : 1;
+}
+
+/////////////////////////////////////////////////
+int gzTransportPublishBufferOwned(GzTransportNode *_node,
+    GzTransportPublisher *_pub, void *_data, size_t _size,
+    void (*_deallocator)(void *, void *), void *_hint)
+{
+  std::function<void(char *)> release;
+  if (_deallocator)
+  {
+    release = [_deallocator, _hint](char *_buffer)
+    {
+      _deallocator(_buffer, _hint);
+    };
+  }
+
+  if (!_node || !_pub || !_data)
+  {
+    if (release && _data)
+      release(static_cast<char *>(_data));
+    return 1;
+  }
+
+  auto loan = _pub->publisher.Adopt(static_cast<char *>(_data), _size,
+    release);
+  if (!loan)
+    return 1;
+
+  return _pub->publisher.PublishLoaned(std::move(loan), _pub->msgType) ? 0 : 1;
+}
+
 /////////////////////////////////////////////////
 int gzTransportSubscribe(GzTransportNode *_node, const char *_topic,
     void (*_callback)(const char *, size_t, const char *, void *),
@@ -145,13 +310,157 @@ int gzTransportSubscribeNonConst(GzTransportNode *_node, char *_topic,
                   }) ? 0 : 1;
 }
 
+/////////////////////////////////////////////////
+int gzTransportSubscribeDeferred(GzTransportNode *_node, const char *_topic,
+    void (*_callback)(const char *, size_t, const char *, void *),
+    void *_userData)
+{
+  if (!_node || !_topic || !_callback)
+    return 1;
+
+  const std::string topic = _topic;
+  return _node->nodePtr->SubscribeRaw(_topic,
+      [_node, topic, _callback, _userData](const char *_msg,
+                  const size_t _size,
+                  const gz::transport::MessageInfo &_info) -> void
+                  {
+                    std::lock_guard<std::mutex> lk(_node->deferredMutex);
+                    if (_node->maxDeferred > 0 &&
+                        _node->deferred.size() >= _node->maxDeferred)
+                    {
+                      _node->deferred.pop_front();
+                      ++_node->droppedDeferred;
+                    }
+                    _node->deferred.push_back({topic,
+                      std::string(_msg, _size), _info.Type(), _callback,
+                      _userData});
+#ifndef _WIN32
+                    if (_node->deferred.size() == 1 &&
+                        _node->eventFds[1] >= 0)
+                    {
+                      const char byte = 1;
+                      if (write(_node->eventFds[1], &byte, 1) < 0)
+                      {
+                        // The pipe is full, so it's already readable.
+                      }
+                    }
+#endif
+                  }) ? 0 : 1;
+}
+
+/////////////////////////////////////////////////
+int gzTransportEventFd(GzTransportNode *_node)
+{
+  if (!_node)
+    return -1;
+
+#ifdef _WIN32
+  return -1;
+#else
+  std::lock_guard<std::mutex> lk(_node->deferredMutex);
+  if (_node->eventFds[0] < 0)
+  {
+    if (pipe(_node->eventFds) != 0)
+    {
+      _node->eventFds[0] = _node->eventFds[1] = -1;
+      return -1;
+    }
+
+    for (int fd : _node->eventFds)
+    {
+      fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+      fcntl(fd, F_SETFD, FD_CLOEXEC);
+    }
+
+    // Messages could be pending already.
+    if (!_node->deferred.empty())
+    {
+      const char byte = 1;
+      if (write(_node->eventFds[1], &byte, 1) < 0)
+      {
+        // The pipe was just created, it can't be full.
+      }
+    }
+  }
+  return _node->eventFds[0];
+#endif
+}
+
+/////////////////////////////////////////////////
+int gzTransportSpinOnce(GzTransportNode *_node, size_t _maxMessages)
+{
+  if (!_node)
+    return -1;
+
+  std::deque<GzTransportDeferredMessage> messages;
+  {
+    std::lock_guard<std::mutex> lk(_node->deferredMutex);
+    const size_t n = _maxMessages == 0 ? _node->deferred.size() :
+      std::min(_maxMessages, _node->deferred.size());
+    auto last = _node->deferred.begin() + static_cast<std::ptrdiff_t>(n);
+    std::move(_node->deferred.begin(), last, std::back_inserter(messages));
+    _node->deferred.erase(_node->deferred.begin(), last);
+
+    // If the queue is empty, the pipe isn't readable anymore.
+    drainEventFd(_node);
+  }
+
+  // The callbacks are invoked without the lock, so they can subscribe,
+  // unsubscribe or publish.
+  for (const auto &msg : messages)
+  {
+    msg.callback(msg.data.data(), msg.data.size(), msg.msgType.c_str(),
+      msg.userData);
+  }
+
+  return static_cast<int>(messages.size());
+}
+
 /////////////////////////////////////////////////
 int gzTransportUnsubscribe(GzTransportNode *_node, const char *_topic)
 {
   if (!_node)
     return 1;
 
-  return _node->nodePtr->Unsubscribe(_topic) ? 0 : 1;
+  if (!_node->nodePtr->Unsubscribe(_topic))
+    return 1;
+
+  // Drop the messages of the topic not dispatched yet.
+  std::lock_guard<std::mutex> lk(_node->deferredMutex);
+  _node->deferred.erase(std::remove_if(_node->deferred.begin(),
+    _node->deferred.end(), [_topic](const GzTransportDeferredMessage &_msg)
+    {
+      return _msg.topic == _topic;
+    }), _node->deferred.end());
+  drainEventFd(_node);
+  return 0;
+}
+
+/////////////////////////////////////////////////
+int gzTransportSetMaxDeferredMessages(GzTransportNode *_node,
+    size_t _maxMessages)
+{
+  if (!_node)
+    return 1;
+
+  std::lock_guard<std::mutex> lk(_node->deferredMutex);
+  _node->maxDeferred = _maxMessages;
+  while (_maxMessages > 0 && _node->deferred.size() > _maxMessages)
+  {
+    _node->deferred.pop_front();
+    ++_node->droppedDeferred;
+  }
+  return 0;
+}
+
+/////////////////////////////////////////////////
+size_t gzTransportDroppedMessages(GzTransportNode *_node)
+{
+  if (!_node)
+    return 0;
+
+  std::lock_guard<std::mutex> lk(_node->deferredMutex);
+  return _node->droppedDeferred;
 }
 
 
@@ -16,6 +16,16 @@
 */
 #include "gtest/gtest.h"
 
+#ifndef _WIN32
+  #include <poll.h>
+#endif
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+
 #include <gz/msgs/stringmsg.pb.h>
 
 #include "gz/transport/CIface.h"
@@ -176,6 +186,173 @@ TEST(CIfaceTest, PubSubPartitions)
   EXPECT_EQ(nullptr, nodeBar);
 }
 
+//////////////////////////////////////////////////
+/// \brief Deallocator of the buffers published with
+/// gzTransportPublishBufferOwned.
+void release(void *_data, void *_hint)
+{
+  free(_data);
+  ++*static_cast<int *>(_hint);
+}
+
+//////////////////////////////////////////////////
+TEST(CIfaceTest, PublishBuffer)
+{
+  count = 0;
+  GzTransportNode *node = gzTransportNodeCreate(nullptr);
+  ASSERT_NE(nullptr, node);
+
+  const char *topic = "/foo_buffer";
+  int userData = 42;
+  ASSERT_EQ(0, gzTransportSubscribe(node, topic, cb, &userData));
+
+  gz::msgs::StringMsg msg;
+  msg.set_data("HELLO");
+  const std::string serialized = msg.SerializeAsString();
+
+  EXPECT_EQ(nullptr, gzTransportAdvertisePublisher(nullptr, topic,
+    msg.GetTypeName().c_str()));
+  EXPECT_EQ(nullptr, gzTransportAdvertisePublisher(node, "invalid topic",
+    msg.GetTypeName().c_str()));
+  GzTransportPublisher *pub = gzTransportAdvertisePublisher(node, topic,
+    msg.GetTypeName().c_str());
+  ASSERT_NE(nullptr, pub);
+  EXPECT_EQ(pub, gzTransportAdvertisePublisher(node, topic,
+    msg.GetTypeName().c_str()));
+
+  // The caller keeps the ownership of the buffer.
+  EXPECT_EQ(0, gzTransportPublishBuffer(node, pub, serialized.data(),
+    serialized.size()));
+  EXPECT_EQ(1, count);
+  EXPECT_NE(0, gzTransportPublishBuffer(node, nullptr, serialized.data(),
+    serialized.size()));
+  EXPECT_EQ(1, count);
+
+  // The transport takes the ownership of the buffer.
+  int released = 0;
+  void *buffer = malloc(serialized.size());
+  ASSERT_NE(nullptr, buffer);
+  memcpy(buffer, serialized.data(), serialized.size());
+  EXPECT_EQ(0, gzTransportPublishBufferOwned(node, pub, buffer,
+    serialized.size(), release, &released));
+  EXPECT_EQ(2, count);
+
+  // Released even if the publication fails.
+  buffer = malloc(serialized.size());
+  ASSERT_NE(nullptr, buffer);
+  EXPECT_NE(0, gzTransportPublishBufferOwned(node, nullptr, buffer,
+    serialized.size(), release, &released));
+  EXPECT_EQ(2, count);
+
+  gzTransportNodeDestroy(&node);
+  EXPECT_EQ(nullptr, node);
+
+  for (int i = 0; i < 100 && released < 2; ++i)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_EQ(2, released);
+}
+
+//////////////////////////////////////////////////
+/// \brief Thread of the last callback invoked.
+static std::thread::id callbackThread;
+
+//////////////////////////////////////////////////
+/// \brief Callback of the deferred subscriptions.
+void cbDeferred(const char *_data, size_t _size, const char *_msgType,
+  void *_userData)
+{
+  callbackThread = std::this_thread::get_id();
+  cb(_data, _size, _msgType, _userData);
+}
+
+//////////////////////////////////////////////////
+TEST(CIfaceTest, SpinOnce)
+{
+  count = 0;
+  GzTransportNode *node = gzTransportNodeCreate(nullptr);
+  ASSERT_NE(nullptr, node);
+  EXPECT_EQ(-1, gzTransportSpinOnce(nullptr, 0));
+  EXPECT_EQ(0, gzTransportSpinOnce(node, 0));
+
+  const char *topic = "/foo_deferred";
+  int userData = 42;
+  ASSERT_EQ(0, gzTransportSubscribeDeferred(node, topic, cbDeferred,
+    &userData));
+
+  gz::msgs::StringMsg msg;
+  msg.set_data("HELLO");
+  const std::string serialized = msg.SerializeAsString();
+  GzTransportPublisher *pub = gzTransportAdvertisePublisher(node, topic,
+    msg.GetTypeName().c_str());
+  ASSERT_NE(nullptr, pub);
+
+#ifndef _WIN32
+  const int fd = gzTransportEventFd(node);
+  ASSERT_GE(fd, 0);
+  EXPECT_EQ(fd, gzTransportEventFd(node));
+  struct pollfd pfd = {fd, POLLIN, 0};
+  EXPECT_EQ(0, poll(&pfd, 1, 0));
+#endif
+
+  // The callbacks wait for the caller.
+  for (int i = 0; i < 3; ++i)
+  {
+    EXPECT_EQ(0, gzTransportPublishBuffer(node, pub, serialized.data(),
+      serialized.size()));
+  }
+  EXPECT_EQ(0, count);
+
+#ifndef _WIN32
+  EXPECT_EQ(1, poll(&pfd, 1, 1000));
+#endif
+
+  EXPECT_EQ(2, gzTransportSpinOnce(node, 2));
+  EXPECT_EQ(2, count);
+  EXPECT_EQ(std::this_thread::get_id(), callbackThread);
+
+#ifndef _WIN32
+  EXPECT_EQ(1, poll(&pfd, 1, 0));
+#endif
+
+  EXPECT_EQ(1, gzTransportSpinOnce(node, 0));
+  EXPECT_EQ(3, count);
+
+#ifndef _WIN32
+  EXPECT_EQ(0, poll(&pfd, 1, 0));
+#endif
+
+  // The oldest messages are dropped when the queue is full.
+  EXPECT_EQ(1, gzTransportSetMaxDeferredMessages(nullptr, 2));
+  EXPECT_EQ(0u, gzTransportDroppedMessages(nullptr));
+  EXPECT_EQ(0, gzTransportSetMaxDeferredMessages(node, 2));
+  EXPECT_EQ(0u, gzTransportDroppedMessages(node));
+  for (int i = 0; i < 3; ++i)
+  {
+    EXPECT_EQ(0, gzTransportPublishBuffer(node, pub, serialized.data(),
+      serialized.size()));
+  }
+  for (int i = 0; i < 100 && gzTransportDroppedMessages(node) == 0; ++i)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_EQ(1u, gzTransportDroppedMessages(node));
+  EXPECT_EQ(2, gzTransportSpinOnce(node, 0));
+  EXPECT_EQ(5, count);
+
+  // The pending messages are dropped when unsubscribing.
+  EXPECT_EQ(0, gzTransportPublishBuffer(node, pub, serialized.data(),
+    serialized.size()));
+#ifndef _WIN32
+  EXPECT_EQ(1, poll(&pfd, 1, 1000));
+#endif
+  ASSERT_EQ(0, gzTransportUnsubscribe(node, topic));
+#ifndef _WIN32
+  EXPECT_EQ(0, poll(&pfd, 1, 0));
+#endif
+  EXPECT_EQ(0, gzTransportSpinOnce(node, 0));
+  EXPECT_EQ(5, count);
+
+  gzTransportNodeDestroy(&node);
+}
+
 //////////////////////////////////////////////////
 int main(int argc, char **argv)
 {
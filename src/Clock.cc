@@ -17,16 +17,130 @@
 #include <gz/msgs/clock.pb.h>
 #include <gz/msgs/time.pb.h>
 
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <cstdint>
 #include <ctime>
+#include <functional>
 #include <iostream>
 #include <mutex>
+#include <thread>
 
 #include <gz/transport/Clock.hh>
 #include <gz/transport/Node.hh>
 
 using namespace gz::transport;
 
+namespace
+{
+//////////////////////////////////////////////////
+/// \brief Threads blocked in Clock::WaitUntil().
+class ClockWaiters
+{
+  /// \brief Block until a clock reaches a time, see Clock::WaitUntil().
+  /// \param[in] _clock The clock
+  /// \param[in] _time Time of the clock to wait for
+  /// \param[in] _timeout Maximum duration of the wait, in real time
+  /// \param[in] _realTime True if the clock advances with the real time, so
+  /// the wait can end when the remaining time elapsed. Otherwise, the clock
+  /// must call Notify() when it's updated.
+  /// \return True if the clock reached _time.
+  public: bool Wait(const Clock &_clock,
+                    const std::chrono::nanoseconds &_time,
+                    const std::chrono::nanoseconds &_timeout,
+                    const bool _realTime)
+  {
+    using SteadyClock = std::chrono::steady_clock;
+    const bool forever = _timeout == std::chrono::nanoseconds::max();
+    const auto deadline = forever ? SteadyClock::time_point::max() :
+      SteadyClock::now() + _timeout;
+
+    std::unique_lock<std::mutex> lk(this->mutex);
+    this->waiters.fetch_add(1);
+    // Pairs with the fence of Notify(), so either this thread sees the new
+    // time or the updating thread sees this waiter.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const uint64_t wakeUps = this->wakeUps;
+    while (_clock.Time() < _time && this->wakeUps == wakeUps)
+    {
+      const auto now = SteadyClock::now();
+      if (now >= deadline)
+        break;
+      auto until = deadline;
+      if (_realTime)
+      {
+        const std::chrono::nanoseconds remaining = _time - _clock.Time();
+        if (remaining < until - now)
+          until = now + remaining;
+      }
+      if (until == SteadyClock::time_point::max())
+        this->condition.wait(lk);
+      else
+        this->condition.wait_until(lk, until);
+    }
+    this->waiters.fetch_sub(1);
+    return _clock.Time() >= _time;
+  }
+
+  /// \brief Wake up the waiting threads after the clock was updated.
+  public: void Notify()
+  {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (this->waiters.load() == 0)
+      return;
+    // Locking ensures a waiter either checked the new time or is waiting.
+    { std::lock_guard<std::mutex> lk(this->mutex); }
+    this->condition.notify_all();
+  }
+
+  /// \brief Interrupt the waits in progress.
+  public: void WakeUp()
+  {
+    {
+      std::lock_guard<std::mutex> lk(this->mutex);
+      ++this->wakeUps;
+    }
+    this->condition.notify_all();
+  }
+
+  /// \brief Protects wakeUps and the wait on condition.
+  private: std::mutex mutex;
+
+  /// \brief Signaled when the clock is updated or WakeUp() is called.
+  private: std::condition_variable condition;
+
+  /// \brief Number of calls to WakeUp().
+  private: uint64_t wakeUps{0};
+
+  /// \brief Number of waiting threads, so the updates of the clock don't
+  /// take the mutex when there are none.
+  private: std::atomic<int> waiters{0};
+};
+}
+
+//////////////////////////////////////////////////
+bool Clock::WaitUntil(const std::chrono::nanoseconds &_time,
+                      const std::chrono::nanoseconds &_timeout) const
+{
+  const auto start = std::chrono::steady_clock::now();
+  while (this->Time() < _time)
+  {
+    if (_timeout != std::chrono::nanoseconds::max() &&
+        std::chrono::steady_clock::now() - start >= _timeout)
+    {
+      return false;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+void Clock::WakeUp() const
+{
+}
+
 //////////////////////////////////////////////////
 class gz::transport::NetworkClock::Implementation
 {
@@ -40,7 +154,7 @@ class gz::transport::NetworkClock::Implementation
 
   /// \brief Gets clock time
   /// \return Current clock time, in nanoseconds
-  /// \remarks Reads are synchronized
+  /// \remarks Reads are lock-free
   public: std::chrono::nanoseconds Time();
 
   /// \brief Sets and distributes the given clock time
@@ -50,21 +164,22 @@ class gz::transport::NetworkClock::Implementation
 
   /// \brief Updates current clock time from a message
   /// \param[in] _msg Message to update clock time from
-  /// \remarks Writes are synchronized
+  /// \remarks Writes are atomic
   public: void UpdateTimeFromMessage(const gz::msgs::Time &_msg);
 
   /// \brief Clock message subscriber callback.
   /// \param[in] _msg Received clock message
   public: void OnClockMessageReceived(const gz::msgs::Clock &_msg);
 
-  /// \brief Current clock time, in nanoseconds.
-  public: std::chrono::nanoseconds clockTimeNS;
+  /// \brief Current clock time, in nanoseconds. It fits in a single
+  /// atomic, so the readers never block nor contend with the updates.
+  public: std::atomic<int64_t> clockTimeNS;
 
   /// \brief Time base to use for the clock.
   public: NetworkClock::TimeBase clockTimeBase;
 
-  /// \brief Lock to synchronize clock accesses.
-  public: std::mutex clockMutex;
+  /// \brief Threads waiting for a time of the clock.
+  public: ClockWaiters waiters;
 
   /// \brief Node to publish/subscribe clock messages.
   public: Node node;
@@ -76,7 +191,7 @@ class gz::transport::NetworkClock::Implementation
 //////////////////////////////////////////////////
 NetworkClock::Implementation::Implementation(const std::string& _topicName,
                                              NetworkClock::TimeBase _timeBase)
-    : clockTimeNS(std::chrono::nanoseconds::zero()),
+    : clockTimeNS(0),
       clockTimeBase(_timeBase)
 {
   if (!node.Subscribe(
@@ -90,8 +205,8 @@ NetworkClock::Implementation::Implementation(const std::string& _topicName,
 //////////////////////////////////////////////////
 std::chrono::nanoseconds NetworkClock::Implementation::Time()
 {
-  std::lock_guard<std::mutex> lock(this->clockMutex);
-  return this->clockTimeNS;
+  return std::chrono::nanoseconds(
+    this->clockTimeNS.load(std::memory_order_acquire));
 }
 
 //////////////////////////////////////////////////
@@ -131,9 +246,10 @@ void NetworkClock::Implementation::SetTime(std::chrono::nanoseconds _time)
 void NetworkClock::Implementation::UpdateTimeFromMessage(
     const gz::msgs::Time& msg)
 {
-  std::lock_guard<std::mutex> lock(this->clockMutex);
-  this->clockTimeNS = std::chrono::seconds(msg.sec()) +
-                      std::chrono::nanoseconds(msg.nsec());
+  const std::chrono::nanoseconds time = std::chrono::seconds(msg.sec()) +
+                                        std::chrono::nanoseconds(msg.nsec());
+  this->clockTimeNS.store(time.count(), std::memory_order_release);
+  this->waiters.Notify();
 }
 
 //////////////////////////////////////////////////
@@ -206,6 +322,19 @@ bool NetworkClock::IsReady() const {
   return (this->dataPtr->Time().count() != 0);
 }
 
+//////////////////////////////////////////////////
+bool NetworkClock::WaitUntil(const std::chrono::nanoseconds &_time,
+                             const std::chrono::nanoseconds &_timeout) const
+{
+  return this->dataPtr->waiters.Wait(*this, _time, _timeout, false);
+}
+
+//////////////////////////////////////////////////
+void NetworkClock::WakeUp() const
+{
+  this->dataPtr->waiters.WakeUp();
+}
+
 //////////////////////////////////////////////////
 class gz::transport::WallClock::Implementation
 {
@@ -219,6 +348,9 @@ class gz::transport::WallClock::Implementation
   /// \brief Offset duration for a monotonic clock to
   /// become an UTC one, in nanoseconds
   public: std::chrono::nanoseconds wallMinusMono;
+
+  /// \brief Threads waiting for a time of the clock.
+  public: ClockWaiters waiters;
 };
 
 //////////////////////////////////////////////////
@@ -272,3 +404,103 @@ bool WallClock::IsReady() const
 {
   return true;  // Always ready.
 }
+
+//////////////////////////////////////////////////
+bool WallClock::WaitUntil(const std::chrono::nanoseconds &_time,
+                          const std::chrono::nanoseconds &_timeout) const
+{
+  return this->dataPtr->waiters.Wait(*this, _time, _timeout, true);
+}
+
+//////////////////////////////////////////////////
+void WallClock::WakeUp() const
+{
+  this->dataPtr->waiters.WakeUp();
+}
+
+//////////////////////////////////////////////////
+class gz::transport::ClockTimer::Implementation
+{
+  /// \brief Constructor.
+  /// \param[in] _clock The clock
+  /// \param[in] _period Period of the timer
+  /// \param[in] _callback Function called every period
+  public: Implementation(const Clock &_clock,
+                         const std::chrono::nanoseconds &_period,
+                         const std::function<void(
+                             const std::chrono::nanoseconds &)> &_callback)
+    : clock(_clock), period(_period), callback(_callback)
+  {
+  }
+
+  /// \brief Call the callback every period until stopped.
+  public: void Run();
+
+  /// \brief The clock.
+  public: const Clock &clock;
+
+  /// \brief Period of the timer.
+  public: std::chrono::nanoseconds period;
+
+  /// \brief Function called every period.
+  public: std::function<void(const std::chrono::nanoseconds &)> callback;
+
+  /// \brief Set to stop the timer.
+  public: std::atomic<bool> stop{false};
+
+  /// \brief Thread of the timer.
+  public: std::thread thread;
+};
+
+//////////////////////////////////////////////////
+void ClockTimer::Implementation::Run()
+{
+  // Wake up regularly to check the stop flag, in case the clock doesn't
+  // support WakeUp().
+  const std::chrono::milliseconds maxWait(100);
+
+  std::chrono::nanoseconds next = this->clock.Time() + this->period;
+  while (!this->stop)
+  {
+    if (!this->clock.WaitUntil(next, maxWait) || this->stop)
+      continue;
+    const std::chrono::nanoseconds now = this->clock.Time();
+    this->callback(now);
+    next += this->period;
+    // Skip the periods missed by a slow callback or a jump of the clock.
+    if (next <= now)
+      next = now + this->period;
+  }
+}
+
+//////////////////////////////////////////////////
+ClockTimer::ClockTimer(const Clock &_clock,
+                       const std::chrono::nanoseconds &_period,
+                       const std::function<void(
+                           const std::chrono::nanoseconds &_time)> &_callback)
+    : dataPtr(new ClockTimer::Implementation(_clock, _period, _callback))
+{
+  if (_period <= std::chrono::nanoseconds::zero() || !_callback)
+  {
+    std::cerr << "ClockTimer: invalid period or callback\n";
+    return;
+  }
+  this->dataPtr->thread =
+    std::thread(&ClockTimer::Implementation::Run, this->dataPtr.get());
+}
+
+//////////////////////////////////////////////////
+ClockTimer::~ClockTimer()
+{
+  this->Stop();
+}
+
+//////////////////////////////////////////////////
+void ClockTimer::Stop()
+{
+  this->dataPtr->stop = true;
+  if (!this->dataPtr->thread.joinable())
+    return;
+  this->dataPtr->clock.WakeUp();
+  this->dataPtr->thread.join();
+}
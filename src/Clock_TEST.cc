@@ -17,6 +17,7 @@
 #include <gz/msgs/clock.pb.h>
 #include <gz/msgs/time.pb.h>
 
+#include <atomic>
 #include <chrono>
 #include <string>
 #include <thread>
@@ -153,3 +154,73 @@ TEST(ClockTest, BadNetworkClock)
   std::this_thread::sleep_for(sleepTime);  // Wait for clock distribution
   EXPECT_FALSE(badTimebaseClock.IsReady());
 }
+
+//////////////////////////////////////////////////
+/// \brief Check that waits on a NetworkClock end with the clock messages.
+TEST(ClockTest, NetworkClockWaitUntil)
+{
+  const std::string clockTopicName{"/wait_clock"};
+  transport::NetworkClock clock(clockTopicName);
+
+  // Nothing publishes the clock yet.
+  EXPECT_FALSE(clock.WaitUntil(std::chrono::seconds(1),
+                               std::chrono::milliseconds(50)));
+
+  std::thread publisher([&clock]()
+  {
+    for (int i = 1; i <= 20; ++i)
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      clock.SetTime(std::chrono::milliseconds(100 * i));
+    }
+  });
+  EXPECT_TRUE(clock.WaitUntil(std::chrono::seconds(1),
+                              std::chrono::seconds(5)));
+  EXPECT_GE(clock.Time(), std::chrono::seconds(1));
+
+  // WakeUp() interrupts a wait.
+  std::thread waker([&clock]()
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    clock.WakeUp();
+  });
+  EXPECT_FALSE(clock.WaitUntil(std::chrono::seconds(100),
+                               std::chrono::nanoseconds::max()));
+  waker.join();
+  publisher.join();
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that a ClockTimer follows the time of its clock.
+TEST(ClockTest, ClockTimer)
+{
+  const std::string clockTopicName{"/timer_clock"};
+  transport::NetworkClock clock(clockTopicName);
+
+  std::atomic<int> calls{0};
+  std::chrono::nanoseconds lastTime{0};
+  {
+    transport::ClockTimer timer(clock, std::chrono::milliseconds(100),
+      [&](const std::chrono::nanoseconds &_time)
+      {
+        lastTime = _time;
+        ++calls;
+      });
+
+    // The clock doesn't advance, the timer doesn't fire.
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT_EQ(0, calls);
+
+    // 1 second of clock time in a few milliseconds of real time.
+    for (int i = 1; i <= 10; ++i)
+    {
+      clock.SetTime(std::chrono::milliseconds(100 * i));
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  }
+  // Some periods may be skipped when the clock messages come in bursts.
+  EXPECT_GE(calls, 5);
+  EXPECT_LE(calls, 10);
+  EXPECT_EQ(std::chrono::seconds(1), lastTime);
+}
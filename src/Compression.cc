@@ -0,0 +1,192 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include "gz/transport/config.hh"
+
+#ifdef HAVE_LZ4
+  #include <lz4.h>
+  #include <lz4hc.h>
+#endif
+#ifdef HAVE_ZSTD
+  #include <zstd.h>
+#endif
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+
+#include "Compression.hh"
+
+namespace gz
+{
+  namespace transport
+  {
+    inline namespace GZ_TRANSPORT_VERSION_NAMESPACE
+    {
+    /// \brief Largest message decompressed (bytes). This bounds the memory
+    /// allocated for a malformed message.
+    static const uint64_t kMaxDecompressedSize = 1ULL << 31;
+
+    //////////////////////////////////////////////////
+    bool CompressionAvailable(const Compression_t _codec)
+    {
+      switch (_codec)
+      {
+#ifdef HAVE_LZ4
+        case Compression_t::LZ4:
+          return true;
+#endif
+#ifdef HAVE_ZSTD
+        case Compression_t::ZSTD:
+          return true;
+#endif
+        default:
+          return false;
+      }
+    }
+
+    //////////////////////////////////////////////////
+    std::string CompressionName(const Compression_t _codec)
+    {
+      switch (_codec)
+      {
+        case Compression_t::LZ4:
+          return "LZ4";
+        case Compression_t::ZSTD:
+          return "ZSTD";
+        default:
+          return "NONE";
+      }
+    }
+
+    //////////////////////////////////////////////////
+    std::size_t CompressBound(const Compression_t _codec,
+      const std::size_t _size)
+    {
+      switch (_codec)
+      {
+#ifdef HAVE_LZ4
+        case Compression_t::LZ4:
+          if (_size > LZ4_MAX_INPUT_SIZE)
+            return 0;
+          return sizeof(uint64_t) +
+            static_cast<std::size_t>(LZ4_compressBound(static_cast<int>(_size)));
+#endif
+#ifdef HAVE_ZSTD
+        case Compression_t::ZSTD:
+          return sizeof(uint64_t) + ZSTD_compressBound(_size);
+#endif
+        default:
+          (void)_size;
+          return 0;
+      }
+    }
+
+    //////////////////////////////////////////////////
+    std::size_t Compress(const Compression_t _codec, const int _level,
+      const char *_data, const std::size_t _size, char *_dst,
+      const std::size_t _dstCapacity)
+    {
+      if (_dstCapacity < sizeof(uint64_t) || _size > kMaxDecompressedSize)
+        return 0;
+
+      const uint64_t size = _size;
+      std::memcpy(_dst, &size, sizeof(size));
+      char *dst = _dst + sizeof(size);
+      const std::size_t capacity = _dstCapacity - sizeof(size);
+
+      switch (_codec)
+      {
+#ifdef HAVE_LZ4
+        case Compression_t::LZ4:
+        {
+          if (_size > LZ4_MAX_INPUT_SIZE)
+            return 0;
+          const int maxSize = static_cast<int>(std::min<std::size_t>(
+            capacity, std::numeric_limits<int>::max()));
+          const int result = _level > 0 ?
+            LZ4_compress_HC(_data, dst, static_cast<int>(_size), maxSize,
+              _level) :
+            LZ4_compress_default(_data, dst, static_cast<int>(_size), maxSize);
+          return result > 0 ?
+            sizeof(size) + static_cast<std::size_t>(result) : 0;
+        }
+#endif
+#ifdef HAVE_ZSTD
+        case Compression_t::ZSTD:
+        {
+          const std::size_t result =
+            ZSTD_compress(dst, capacity, _data, _size, _level);
+          return ZSTD_isError(result) ? 0 : sizeof(size) + result;
+        }
+#endif
+        default:
+          (void)_level;
+          (void)_data;
+          (void)dst;
+          (void)capacity;
+          return 0;
+      }
+    }
+
+    //////////////////////////////////////////////////
+    bool Decompress(const Compression_t _codec, const char *_data,
+      const std::size_t _size, std::string &_msg)
+    {
+      uint64_t size;
+      if (_size < sizeof(size))
+        return false;
+
+      std::memcpy(&size, _data, sizeof(size));
+      if (size > kMaxDecompressedSize || !CompressionAvailable(_codec))
+        return false;
+
+      const char *src = _data + sizeof(size);
+      const std::size_t srcSize = _size - sizeof(size);
+      _msg.resize(static_cast<std::size_t>(size));
+
+      switch (_codec)
+      {
+#ifdef HAVE_LZ4
+        case Compression_t::LZ4:
+        {
+          if (srcSize > LZ4_MAX_INPUT_SIZE)
+            return false;
+          const int result = LZ4_decompress_safe(src, &_msg[0],
+            static_cast<int>(srcSize), static_cast<int>(size));
+          return result >= 0 && static_cast<uint64_t>(result) == size;
+        }
+#endif
+#ifdef HAVE_ZSTD
+        case Compression_t::ZSTD:
+        {
+          const std::size_t result =
+            ZSTD_decompress(&_msg[0], _msg.size(), src, srcSize);
+          return !ZSTD_isError(result) && result == size;
+        }
+#endif
+        default:
+          (void)src;
+          (void)srcSize;
+          return false;
+      }
+    }
+    }
+  }
+}
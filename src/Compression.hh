@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GZ_TRANSPORT_COMPRESSION_HH_
+#define GZ_TRANSPORT_COMPRESSION_HH_
+
+#include <cstddef>
+#include <string>
+
+#include "gz/transport/AdvertiseOptions.hh"
+#include "gz/transport/config.hh"
+#include "gz/transport/Export.hh"
+
+namespace gz
+{
+  namespace transport
+  {
+    inline namespace GZ_TRANSPORT_VERSION_NAMESPACE
+    {
+    /// \internal
+    /// \brief Whether a codec is available in this build. The codecs are
+    /// optional dependencies.
+    /// \param[in] _codec The codec.
+    /// \return True if messages can be compressed with _codec.
+    GZ_TRANSPORT_VISIBLE bool CompressionAvailable(const Compression_t _codec);
+
+    /// \internal
+    /// \brief Get the name of a codec.
+    /// \param[in] _codec The codec.
+    /// \return The name.
+    GZ_TRANSPORT_VISIBLE std::string CompressionName(
+      const Compression_t _codec);
+
+    /// \internal
+    /// \brief Get the maximum size of a compressed message.
+    /// \param[in] _codec The codec.
+    /// \param[in] _size Size of the message (bytes).
+    /// \return The maximum size (bytes) or 0 if the codec is not available
+    /// or the message is too big.
+    GZ_TRANSPORT_VISIBLE std::size_t CompressBound(
+      const Compression_t _codec, const std::size_t _size);
+
+    /// \internal
+    /// \brief Compress a message. The compressed message starts with the
+    /// size of the original message, as uint64_t.
+    /// \param[in] _codec The codec.
+    /// \param[in] _level Compression level, 0 for the default of the codec.
+    /// \param[in] _data Message.
+    /// \param[in] _size Size of the message (bytes).
+    /// \param[out] _dst Compressed message.
+    /// \param[in] _dstCapacity Capacity of _dst, see CompressBound().
+    /// \return Size of the compressed message (bytes) or 0 on failure.
+    GZ_TRANSPORT_VISIBLE std::size_t Compress(const Compression_t _codec,
+      const int _level, const char *_data, const std::size_t _size,
+      char *_dst, const std::size_t _dstCapacity);
+
+    /// \internal
+    /// \brief Decompress a message compressed with Compress().
+    /// \param[in] _codec The codec.
+    /// \param[in] _data Compressed message.
+    /// \param[in] _size Size of the compressed message (bytes).
+    /// \param[out] _msg The message.
+    /// \return True on success or false if the codec is not available or
+    /// the message is malformed.
+    GZ_TRANSPORT_VISIBLE bool Decompress(const Compression_t _codec,
+      const char *_data, const std::size_t _size, std::string &_msg);
+    }
+  }
+}
+#endif
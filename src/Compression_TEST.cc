@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <string>
+#include <vector>
+
+#include "Compression.hh"
+#include "gtest/gtest.h"
+
+using namespace gz;
+using namespace transport;
+
+//////////////////////////////////////////////////
+/// \brief Compress and decompress a message with every codec available.
+TEST(CompressionTest, RoundTrip)
+{
+  std::string msg;
+  for (int i = 0; i < 10000; ++i)
+    msg += "message " + std::to_string(i % 100);
+
+  for (const Compression_t codec : {Compression_t::LZ4, Compression_t::ZSTD})
+  {
+    if (!CompressionAvailable(codec))
+    {
+      EXPECT_EQ(0u, CompressBound(codec, msg.size()));
+      continue;
+    }
+
+    for (const int level : {0, 3})
+    {
+      const std::size_t bound = CompressBound(codec, msg.size());
+      ASSERT_GT(bound, 0u);
+
+      std::vector<char> compressed(bound);
+      const std::size_t size = Compress(codec, level, msg.data(), msg.size(),
+        compressed.data(), compressed.size());
+      ASSERT_GT(size, 0u);
+      EXPECT_LT(size, msg.size());
+
+      std::string out;
+      EXPECT_TRUE(Decompress(codec, compressed.data(), size, out));
+      EXPECT_EQ(msg, out);
+
+      // Truncated message.
+      EXPECT_FALSE(Decompress(codec, compressed.data(), size / 2, out));
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the invalid inputs.
+TEST(CompressionTest, Invalid)
+{
+  EXPECT_FALSE(CompressionAvailable(Compression_t::NONE));
+  EXPECT_EQ("NONE", CompressionName(Compression_t::NONE));
+  EXPECT_EQ("LZ4", CompressionName(Compression_t::LZ4));
+  EXPECT_EQ("ZSTD", CompressionName(Compression_t::ZSTD));
+
+  char dst[64];
+  EXPECT_EQ(0u, Compress(Compression_t::NONE, 0, "abc", 3, dst, sizeof(dst)));
+
+  std::string out;
+  EXPECT_FALSE(Decompress(Compression_t::NONE, dst, sizeof(dst), out));
+  EXPECT_FALSE(Decompress(Compression_t::LZ4, "abc", 3, out));
+  EXPECT_FALSE(Decompress(Compression_t::ZSTD, "abc", 3, out));
+}
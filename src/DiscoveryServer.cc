@@ -0,0 +1,477 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gz/transport/Discovery.hh"
+#include "gz/transport/DiscoveryServer.hh"
+
+using namespace gz;
+using namespace transport;
+
+/// \brief Header key of the requests of the state of a process.
+/// \sa Discovery
+static const char kStateReqKey[] = "state_req";
+
+/// \brief Header key added to the messages sent to a client in the host of
+/// the original sender.
+/// \sa Discovery
+static const char kServerLocalKey[] = "server_local";
+
+/// \brief Maximum size of a datagram (bytes).
+static const uint16_t kMaxRcvStr = 65535;
+
+/// \brief Maximum size of the datagrams sent (bytes).
+static const std::size_t kMaxDatagramSize = 1472;
+
+/// \brief Longest wait for a datagram (milliseconds). The silent clients
+/// are noticed after this time. Stop() wakes up the thread with a datagram.
+static const int kTimeout = 250;
+
+/// \brief A client of the server.
+struct DiscoveryClient
+{
+  /// \brief Address of the client.
+  sockaddr_in addr;
+
+  /// \brief Process UUID of the client.
+  std::string pUuid;
+
+  /// \brief Last time we heard from the client.
+  Timestamp lastSeen;
+};
+
+/// \internal
+/// \brief Private data for DiscoveryServer class.
+class gz::transport::DiscoveryServerPrivate
+{
+  /// \brief Receive the pending datagram and forward its messages.
+  public: void Recv();
+
+  /// \brief Forward messages to a client.
+  /// \param[in] _from Client that sent the messages.
+  /// \param[in] _to Recipient.
+  /// \param[in] _msgs Messages to forward.
+  public: void Forward(const DiscoveryClient &_from,
+                       const DiscoveryClient &_to,
+                       const std::vector<msgs::Discovery> &_msgs) const;
+
+  /// \brief Send a datagram to a client.
+  /// \param[in] _to Recipient.
+  /// \param[in] _data Datagram.
+  /// \param[in] _size Size of the datagram (bytes).
+  public: void Send(const DiscoveryClient &_to, const char *_data,
+                    const std::size_t _size) const;
+
+  /// \brief Forget the clients that became silent.
+  public: void ExpireClients();
+
+  /// \brief Receive and forward the messages until Stop() is called.
+  public: void Run();
+
+  /// \brief Requested UDP port.
+  public: int port;
+
+  /// \brief Print the forwarded messages.
+  public: bool verbose;
+
+  /// \brief UDP socket, or -1 if the server isn't running.
+  public: int sock = -1;
+
+  /// \brief UDP port the socket is bound to.
+  public: int boundPort = 0;
+
+  /// \brief Silence interval (ms).
+  public: std::atomic<unsigned int> silenceInterval{3000};
+
+  /// \brief Clients, indexed by their address ("ip:port").
+  public: std::map<std::string, DiscoveryClient> clients;
+
+  /// \brief Mutex protecting the clients.
+  public: mutable std::mutex mutex;
+
+  /// \brief True when the thread should exit.
+  public: std::atomic<bool> exit{false};
+
+  /// \brief Thread receiving and forwarding the messages.
+  public: std::thread thread;
+};
+
+//////////////////////////////////////////////////
+/// \brief Get the key of an address.
+/// \param[in] _addr Address.
+/// \return "ip:port".
+static std::string addrKey(const sockaddr_in &_addr)
+{
+  return std::string(inet_ntoa(_addr.sin_addr)) + ":" +
+    std::to_string(ntohs(_addr.sin_port));
+}
+
+//////////////////////////////////////////////////
+/// \brief Check if two clients run in the same host.
+/// \param[in] _a First client.
+/// \param[in] _b Second client.
+/// \return True if they share their IP address or they both talk to us
+/// through the loopback interface.
+static bool sameHost(const DiscoveryClient &_a, const DiscoveryClient &_b)
+{
+  const uint32_t a = ntohl(_a.addr.sin_addr.s_addr);
+  const uint32_t b = ntohl(_b.addr.sin_addr.s_addr);
+  return a == b || ((a >> 24) == 127 && (b >> 24) == 127);
+}
+
+//////////////////////////////////////////////////
+void DiscoveryServerPrivate::Recv()
+{
+  std::vector<char> rcvStr(kMaxRcvStr);
+  sockaddr_in clntAddr;
+  socklen_t addrLen = sizeof(clntAddr);
+
+  int64_t received = recvfrom(this->sock,
+    reinterpret_cast<raw_type *>(rcvStr.data()), kMaxRcvStr, 0,
+    reinterpret_cast<sockaddr *>(&clntAddr), &addrLen);
+  if (received <= 0)
+    return;
+
+  // Unpack the messages: <uint16 size><message> one after the other.
+  std::vector<msgs::Discovery> discMsgs;
+  int64_t offset = 0;
+  uint16_t len;
+  while (offset + static_cast<int64_t>(sizeof(len)) <= received)
+  {
+    memcpy(&len, &rcvStr[offset], sizeof(len));
+    offset += sizeof(len);
+    if (offset + len > received)
+      break;
+
+    msgs::Discovery msg;
+    if (msg.ParseFromArray(&rcvStr[offset], len))
+      discMsgs.push_back(msg);
+    offset += len;
+  }
+
+  if (discMsgs.empty())
+    return;
+
+  const std::string key = addrKey(clntAddr);
+  bool ack = false;
+  bool bye = false;
+  DiscoveryClient from;
+  std::vector<DiscoveryClient> to;
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    auto it = this->clients.find(key);
+    if (it == this->clients.end())
+    {
+      it = this->clients.emplace(key, DiscoveryClient()).first;
+      it->second.addr = clntAddr;
+      ack = true;
+
+      if (this->verbose)
+        std::cout << "New discovery client [" << key << "]" << std::endl;
+    }
+    it->second.pUuid = discMsgs.front().process_uuid();
+    it->second.lastSeen = std::chrono::steady_clock::now();
+    from = it->second;
+
+    for (const auto &client : this->clients)
+    {
+      if (client.first != key)
+        to.push_back(client.second);
+    }
+
+    for (const auto &msg : discMsgs)
+    {
+      ack = ack || msg.type() == msgs::Discovery::HEARTBEAT;
+      bye = bye || msg.type() == msgs::Discovery::BYE;
+    }
+
+    if (bye)
+      this->clients.erase(it);
+  }
+
+  // The acknowledgement lets the client stop using the multicast group.
+  if (ack && !bye)
+    this->Send(from, nullptr, 0);
+
+  for (const auto &client : to)
+  {
+    std::vector<msgs::Discovery> fwd;
+    for (const auto &msg : discMsgs)
+    {
+      // The requests of the state of a process go to that process only.
+      bool skip = false;
+      for (const auto &data : msg.header().data())
+      {
+        if (data.key() == kStateReqKey && data.value_size() > 0 &&
+            data.value(0) != client.pUuid)
+        {
+          skip = true;
+        }
+      }
+
+      if (!skip)
+        fwd.push_back(msg);
+    }
+
+    this->Forward(from, client, fwd);
+  }
+}
+
+//////////////////////////////////////////////////
+void DiscoveryServerPrivate::Forward(const DiscoveryClient &_from,
+  const DiscoveryClient &_to, const std::vector<msgs::Discovery> &_msgs) const
+{
+  const bool local = sameHost(_from, _to);
+  std::string datagram;
+  for (auto msg : _msgs)
+  {
+    // The recipient shouldn't relay the message again.
+    msg.mutable_flags()->set_relay(false);
+    msg.mutable_flags()->set_no_relay(true);
+    if (local)
+    {
+      auto *data = msg.mutable_header()->add_data();
+      data->set_key(kServerLocalKey);
+    }
+
+    const std::string body = msg.SerializeAsString();
+    if (body.size() + sizeof(uint16_t) > kMaxRcvStr)
+      continue;
+
+    if (!datagram.empty() &&
+        datagram.size() + sizeof(uint16_t) + body.size() > kMaxDatagramSize)
+    {
+      this->Send(_to, datagram.data(), datagram.size());
+      datagram.clear();
+    }
+
+    const uint16_t len = static_cast<uint16_t>(body.size());
+    datagram.append(reinterpret_cast<const char *>(&len), sizeof(len));
+    datagram.append(body);
+  }
+
+  if (!datagram.empty())
+    this->Send(_to, datagram.data(), datagram.size());
+
+  if (this->verbose && !_msgs.empty())
+  {
+    std::cout << "Forwarded " << _msgs.size() << " discovery messages from ["
+              << addrKey(_from.addr) << "] to [" << addrKey(_to.addr) << "]"
+              << std::endl;
+  }
+}
+
+//////////////////////////////////////////////////
+void DiscoveryServerPrivate::Send(const DiscoveryClient &_to,
+  const char *_data, const std::size_t _size) const
+{
+  errno = 0;
+  auto sent = sendto(this->sock, reinterpret_cast<const raw_type *>(_data),
+    _size, 0, reinterpret_cast<const sockaddr *>(&_to.addr),
+    sizeof(_to.addr));
+
+  // Ignore EPERM and ENOBUFS errors, like the discovery does.
+  if (sent != static_cast<int64_t>(_size) && errno != EPERM &&
+      errno != ENOBUFS)
+  {
+    std::cerr << "DiscoveryServer: error sending a message to ["
+              << addrKey(_to.addr) << "]: " << strerror(errno) << std::endl;
+  }
+}
+
+//////////////////////////////////////////////////
+void DiscoveryServerPrivate::ExpireClients()
+{
+  const auto silence = std::chrono::milliseconds(this->silenceInterval);
+  const auto now = std::chrono::steady_clock::now();
+
+  std::lock_guard<std::mutex> lock(this->mutex);
+  for (auto it = this->clients.begin(); it != this->clients.end();)
+  {
+    if (now - it->second.lastSeen > silence)
+    {
+      if (this->verbose)
+        std::cout << "Discovery client [" << it->first << "] expired\n";
+      it = this->clients.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+void DiscoveryServerPrivate::Run()
+{
+  while (!this->exit)
+  {
+    std::vector<bool> ready;
+    pollSockets({this->sock}, kTimeout, ready);
+    if (this->exit)
+      break;
+    if (ready[0])
+      this->Recv();
+
+    this->ExpireClients();
+  }
+}
+
+//////////////////////////////////////////////////
+DiscoveryServer::DiscoveryServer(const int _port, const bool _verbose)
+  : dataPtr(new DiscoveryServerPrivate)
+{
+  this->dataPtr->port = _port;
+  this->dataPtr->verbose = _verbose;
+}
+
+//////////////////////////////////////////////////
+DiscoveryServer::~DiscoveryServer()
+{
+  this->Stop();
+}
+
+//////////////////////////////////////////////////
+bool DiscoveryServer::Start()
+{
+  if (this->dataPtr->sock >= 0)
+    return true;
+
+  if (this->dataPtr->port < 0 || this->dataPtr->port > 65535)
+  {
+    std::cerr << "DiscoveryServer: invalid port [" << this->dataPtr->port
+              << "]" << std::endl;
+    return false;
+  }
+
+#ifdef _WIN32
+  WSADATA wsaData;
+  if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0)
+  {
+    std::cerr << "Unable to load WinSock DLL" << std::endl;
+    return false;
+  }
+#endif
+
+  int sock = static_cast<int>(socket(PF_INET, SOCK_DGRAM, IPPROTO_UDP));
+  if (sock < 0)
+  {
+    std::cerr << "DiscoveryServer: socket creation failed." << std::endl;
+    return false;
+  }
+
+  sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  addr.sin_port = htons(static_cast<u_short>(this->dataPtr->port));
+  socklen_t addrLen = sizeof(addr);
+
+  if (bind(sock, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0 ||
+      getsockname(sock, reinterpret_cast<sockaddr *>(&addr), &addrLen) < 0)
+  {
+    std::cerr << "DiscoveryServer: binding to port [" << this->dataPtr->port
+              << "] failed: " << strerror(errno) << std::endl;
+#ifdef _WIN32
+    closesocket(sock);
+    WSACleanup();
+#else
+    close(sock);
+#endif
+    return false;
+  }
+
+  this->dataPtr->sock = sock;
+  this->dataPtr->boundPort = ntohs(addr.sin_port);
+  this->dataPtr->exit = false;
+  this->dataPtr->thread =
+    std::thread(&DiscoveryServerPrivate::Run, this->dataPtr.get());
+
+  if (this->dataPtr->verbose)
+  {
+    std::cout << "Discovery server listening on [udp://0.0.0.0:"
+              << this->dataPtr->boundPort << "]" << std::endl;
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+void DiscoveryServer::Stop()
+{
+  if (this->dataPtr->sock < 0)
+    return;
+
+  // Wake up the thread with an empty datagram sent to the server.
+  this->dataPtr->exit = true;
+  sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port = htons(static_cast<u_short>(this->dataPtr->boundPort));
+  const char byte = 0;
+  sendto(this->dataPtr->sock, reinterpret_cast<const raw_type *>(&byte), 0,
+    0, reinterpret_cast<const sockaddr *>(&addr), sizeof(addr));
+
+  if (this->dataPtr->thread.joinable())
+    this->dataPtr->thread.join();
+
+#ifdef _WIN32
+  closesocket(this->dataPtr->sock);
+  WSACleanup();
+#else
+  close(this->dataPtr->sock);
+#endif
+  this->dataPtr->sock = -1;
+  this->dataPtr->boundPort = 0;
+
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  this->dataPtr->clients.clear();
+}
+
+//////////////////////////////////////////////////
+int DiscoveryServer::Port() const
+{
+  return this->dataPtr->boundPort;
+}
+
+//////////////////////////////////////////////////
+std::size_t DiscoveryServer::ClientCount() const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  return this->dataPtr->clients.size();
+}
+
+//////////////////////////////////////////////////
+unsigned int DiscoveryServer::SilenceInterval() const
+{
+  return this->dataPtr->silenceInterval;
+}
+
+//////////////////////////////////////////////////
+void DiscoveryServer::SetSilenceInterval(const unsigned int _ms)
+{
+  this->dataPtr->silenceInterval = _ms;
+}
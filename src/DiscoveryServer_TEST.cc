@@ -0,0 +1,184 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include "gz/transport/AdvertiseOptions.hh"
+#include "gz/transport/Discovery.hh"
+#include "gz/transport/DiscoveryServer.hh"
+#include "gz/transport/Publisher.hh"
+#include "gz/transport/TransportTypes.hh"
+#include "gz/transport/Uuid.hh"
+
+#include "test_utils.hh"
+
+using namespace gz;
+using namespace transport;
+
+static const std::string g_ip = "224.0.0.7"; // NOLINT(*)
+static const std::string addr = "tcp://127.0.0.1:12345"; // NOLINT(*)
+static const std::string ctrl = "tcp://127.0.0.1:12346"; // NOLINT(*)
+
+//////////////////////////////////////////////////
+/// \brief Wait until a discovery knows a publisher of a topic.
+/// \param[in] _discovery Discovery.
+/// \param[in] _topic Topic.
+/// \return True if the publisher was discovered.
+static bool waitForPublisher(const MsgDiscovery &_discovery,
+  const std::string &_topic)
+{
+  for (int i = 0; i < 200; ++i)
+  {
+    Addresses_M<MessagePublisher> publishers;
+    if (_discovery.Publishers(_topic, publishers) && !publishers.empty())
+      return true;
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  return false;
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that two processes that can't reach each other through the
+/// multicast group discover each other through the server.
+TEST(DiscoveryServerTest, ForwardThroughServer)
+{
+  DiscoveryServer server(0);
+  ASSERT_TRUE(server.Start());
+  ASSERT_NE(0, server.Port());
+
+  const std::string pUuid1 = Uuid().ToString();
+  const std::string pUuid2 = Uuid().ToString();
+  const std::string topic = "/foo" + testing::getRandomNumber();
+
+  // Different multicast ports: only the server connects them.
+  MsgDiscovery discovery1(pUuid1, g_ip, 11331);
+  MsgDiscovery discovery2(pUuid2, g_ip, 11332);
+  EXPECT_TRUE(discovery1.SetServer("127.0.0.1", server.Port()));
+  EXPECT_TRUE(discovery2.SetServer("127.0.0.1", server.Port()));
+
+  discovery1.Start();
+  MessagePublisher publisher(topic, addr, ctrl, pUuid1, Uuid().ToString(),
+    "type", AdvertiseMessageOptions());
+  EXPECT_TRUE(discovery1.Advertise(publisher));
+  discovery1.WaitForInit();
+
+  // The new process learns the publisher from the catalog.
+  discovery2.Start();
+  EXPECT_TRUE(waitForPublisher(discovery2, topic));
+  EXPECT_TRUE(discovery1.ServerReachable());
+  EXPECT_TRUE(discovery2.ServerReachable());
+  EXPECT_EQ(2u, server.ClientCount());
+
+  // A local ADVERTISE is accepted for a HOST scope publisher.
+  AdvertiseMessageOptions opts;
+  opts.SetScope(Scope_t::HOST);
+  MessagePublisher hostPublisher(topic + "_host", addr, ctrl, pUuid1,
+    Uuid().ToString(), "type", opts);
+  EXPECT_TRUE(discovery1.Advertise(hostPublisher));
+  EXPECT_TRUE(waitForPublisher(discovery2, topic + "_host"));
+
+  // The updates are forwarded too.
+  EXPECT_TRUE(discovery1.Unadvertise(topic, publisher.NUuid()));
+  bool gone = false;
+  for (int i = 0; i < 200 && !gone; ++i)
+  {
+    Addresses_M<MessagePublisher> publishers;
+    discovery2.Publishers(topic, publishers);
+    gone = publishers.empty();
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  EXPECT_TRUE(gone);
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that the multicast group is used while the server doesn't
+/// answer.
+TEST(DiscoveryServerTest, MulticastFallback)
+{
+  // Find a port without a server.
+  int port;
+  {
+    DiscoveryServer server(0);
+    ASSERT_TRUE(server.Start());
+    port = server.Port();
+  }
+
+  const std::string pUuid1 = Uuid().ToString();
+  const std::string pUuid2 = Uuid().ToString();
+  const std::string topic = "/bar" + testing::getRandomNumber();
+
+  MsgDiscovery discovery1(pUuid1, g_ip, 11333);
+  MsgDiscovery discovery2(pUuid2, g_ip, 11333);
+  EXPECT_TRUE(discovery1.SetServer("127.0.0.1", port));
+  EXPECT_TRUE(discovery2.SetServer("127.0.0.1", port));
+  discovery1.Start();
+  discovery2.Start();
+
+  MessagePublisher publisher(topic, addr, ctrl, pUuid1, Uuid().ToString(),
+    "type", AdvertiseMessageOptions());
+  EXPECT_TRUE(discovery1.Advertise(publisher));
+  EXPECT_TRUE(waitForPublisher(discovery2, topic));
+  EXPECT_FALSE(discovery1.ServerReachable());
+  EXPECT_FALSE(discovery2.ServerReachable());
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the server parameters.
+TEST(DiscoveryServerTest, Parameters)
+{
+  MsgDiscovery discovery(Uuid().ToString(), g_ip, 11334);
+  EXPECT_FALSE(discovery.SetServer("not_an_ip", 12000));
+  EXPECT_FALSE(discovery.SetServer("127.0.0.1", 0));
+  EXPECT_TRUE(discovery.SetServer("127.0.0.1", 12000));
+  EXPECT_FALSE(discovery.SetServer("127.0.0.1", 12001));
+  EXPECT_FALSE(discovery.ServerReachable());
+
+  DiscoveryServer invalid(70000);
+  EXPECT_FALSE(invalid.Start());
+  EXPECT_EQ(0, invalid.Port());
+
+  DiscoveryServer server(0);
+  EXPECT_EQ(0, server.Port());
+  EXPECT_EQ(0u, server.ClientCount());
+  server.SetSilenceInterval(500);
+  EXPECT_EQ(500u, server.SilenceInterval());
+  EXPECT_TRUE(server.Start());
+  EXPECT_NE(0, server.Port());
+  server.Stop();
+  EXPECT_EQ(0, server.Port());
+}
+
+//////////////////////////////////////////////////
+/// \brief Stop() wakes up the thread of the server instead of waiting for
+/// the timeout of its poll.
+TEST(DiscoveryServerTest, FastStop)
+{
+  DiscoveryServer server(0);
+  ASSERT_TRUE(server.Start());
+
+  // Let the thread start polling.
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+  const auto start = std::chrono::steady_clock::now();
+  server.Stop();
+  EXPECT_LT(std::chrono::steady_clock::now() - start,
+    std::chrono::milliseconds(100));
+}
@@ -17,8 +17,13 @@
 #include "gtest/gtest.h"
 
 #include <chrono>
+#include <cstring>
+#include <cstdio>
 #include <cstdlib>
 #include <memory>
+#include <mutex>
+#include <regex>
+#include <set>
 #include <string>
 #include <thread>
 
@@ -236,6 +241,14 @@ TEST(DiscoveryTest, TestAdvertise)
   EXPECT_TRUE(connectionExecuted);
   EXPECT_FALSE(disconnectionExecuted);
 
+  // The advertisement went through the network.
+  const DiscoveryTraffic traffic1 = discovery1.Traffic();
+  const DiscoveryTraffic traffic2 = Discovery2.Traffic();
+  EXPECT_GT(traffic1.sentDatagrams, 0u);
+  EXPECT_GE(traffic1.sentBytes, traffic1.sentDatagrams);
+  EXPECT_GT(traffic2.receivedDatagrams, 0u);
+  EXPECT_GE(traffic2.receivedBytes, traffic2.receivedDatagrams);
+
   reset();
 
   // This should not trigger a discovery response on discovery2. They are in
@@ -530,6 +543,491 @@ TEST(DiscoveryTest, TestActivity)
   discovery1.TestActivity(proc2Uuid, false);
 }
 
+//////////////////////////////////////////////////
+/// \brief Advertise topics before a second discovery node starts and check
+/// that it receives all of them after the first heartbeats.
+/// \param[in] _numTopics Number of topics advertised.
+void checkLateDiscovery(const int _numTopics)
+{
+  const std::string proc1Uuid = Uuid().ToString();
+  const std::string proc2Uuid = Uuid().ToString();
+
+  transport::Discovery<MessagePublisher> discovery1(proc1Uuid, g_ip,
+    g_msgPort);
+  discovery1.SetHeartbeatInterval(200);
+  discovery1.Start();
+
+  for (int i = 0; i < _numTopics; ++i)
+  {
+    MessagePublisher publisher("/late_" + std::to_string(i), addr1, ctrl1,
+      proc1Uuid, nUuid1, "type", AdvertiseMessageOptions());
+    EXPECT_TRUE(discovery1.Advertise(publisher));
+  }
+
+  // Unadvertise one of them.
+  EXPECT_TRUE(discovery1.Unadvertise("/late_0", nUuid1));
+
+  std::mutex mutex;
+  std::set<std::string> topics;
+  transport::Discovery<MessagePublisher> discovery2(proc2Uuid, g_ip,
+    g_msgPort);
+  discovery2.ConnectionsCb([&](const MessagePublisher &_pub)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (_pub.PUuid() == proc1Uuid)
+      topics.insert(_pub.Topic());
+  });
+  discovery2.DisconnectionsCb([&](const MessagePublisher &_pub)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (_pub.PUuid() == proc1Uuid)
+      topics.erase(_pub.Topic());
+  });
+  discovery2.Start();
+
+  for (int i = 0; i < 100; ++i)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (topics.size() == static_cast<std::size_t>(_numTopics - 1))
+        break;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(Nap * 5));
+  }
+
+  std::lock_guard<std::mutex> lock(mutex);
+  EXPECT_EQ(static_cast<std::size_t>(_numTopics - 1), topics.size());
+  EXPECT_EQ(0u, topics.count("/late_0"));
+}
+
+//////////////////////////////////////////////////
+/// \brief A late discovery node receives the changes made by a process.
+TEST(DiscoveryTest, TestLateDiscoveryChanges)
+{
+  checkLateDiscovery(100);
+}
+
+//////////////////////////////////////////////////
+/// \brief A late discovery node receives the whole state of a process when
+/// the process doesn't keep all its changes anymore.
+TEST(DiscoveryTest, TestLateDiscoveryFullState)
+{
+  checkLateDiscovery(2000);
+}
+
+//////////////////////////////////////////////////
+/// \brief A new discovery node receives the catalog of a peer when it
+/// starts, instead of waiting for the heartbeats.
+TEST(DiscoveryTest, TestCatalog)
+{
+  const std::string proc1Uuid = Uuid().ToString();
+  const std::string proc2Uuid = Uuid().ToString();
+  const int numTopics = 50;
+
+  transport::Discovery<MessagePublisher> discovery1(proc1Uuid, g_ip,
+    g_msgPort);
+  discovery1.Start();
+  for (int i = 0; i < numTopics; ++i)
+  {
+    MessagePublisher publisher("/catalog_" + std::to_string(i), addr1, ctrl1,
+      proc1Uuid, nUuid1, "type", AdvertiseMessageOptions());
+    EXPECT_TRUE(discovery1.Advertise(publisher));
+  }
+  discovery1.WaitForInit();
+
+  transport::Discovery<MessagePublisher> discovery2(proc2Uuid, g_ip,
+    g_msgPort);
+  auto start = std::chrono::steady_clock::now();
+  discovery2.Start();
+  discovery2.WaitForInit();
+
+  // Without the catalog, it takes two heartbeats.
+  EXPECT_LT(std::chrono::steady_clock::now() - start,
+    std::chrono::milliseconds(discovery2.HeartbeatInterval()));
+
+  for (int i = 0; i < numTopics; ++i)
+  {
+    Addresses_M<MessagePublisher> publishers;
+    EXPECT_TRUE(discovery2.Publishers("/catalog_" + std::to_string(i),
+      publishers));
+    EXPECT_EQ(1u, publishers.count(proc1Uuid));
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief A restarted discovery warm starts from its cache file and
+/// discards the publishers that aren't advertised anymore.
+TEST(DiscoveryTest, TestCache)
+{
+  const std::string proc1Uuid = Uuid().ToString();
+  const std::string cache = "discovery_cache_" + testing::getRandomNumber();
+  const std::string topicKept = "/cache_kept";
+  const std::string topicGone = "/cache_gone";
+
+  transport::Discovery<MessagePublisher> discovery1(proc1Uuid, g_ip,
+    g_msgPort);
+  discovery1.SetHeartbeatInterval(200);
+  discovery1.Start();
+  for (const auto &topic : {topicKept, topicGone})
+  {
+    MessagePublisher publisher(topic, addr1, ctrl1, proc1Uuid, nUuid1,
+      "type", AdvertiseMessageOptions());
+    EXPECT_TRUE(discovery1.Advertise(publisher));
+  }
+
+  // The first run writes the cache.
+  {
+    transport::Discovery<MessagePublisher> discovery2(Uuid().ToString(),
+      g_ip, g_msgPort);
+    EXPECT_TRUE(discovery2.SetCache(cache));
+    discovery2.SetHeartbeatInterval(200);
+    discovery2.Start();
+    EXPECT_FALSE(discovery2.SetCache(cache));
+
+    Addresses_M<MessagePublisher> publishers;
+    for (int i = 0; i < MaxIters && !discovery2.Publishers(topicGone,
+      publishers); ++i)
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(Nap));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+  }
+
+  EXPECT_TRUE(discovery1.Unadvertise(topicGone, nUuid1));
+
+  // The restart knows the publishers before hearing from anyone.
+  std::mutex mutex;
+  std::set<std::string> topics;
+  transport::Discovery<MessagePublisher> discovery3(Uuid().ToString(), g_ip,
+    g_msgPort);
+  discovery3.ConnectionsCb([&](const MessagePublisher &_pub)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (_pub.PUuid() == proc1Uuid)
+      topics.insert(_pub.Topic());
+  });
+  discovery3.DisconnectionsCb([&](const MessagePublisher &_pub)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (_pub.PUuid() == proc1Uuid)
+      topics.erase(_pub.Topic());
+  });
+  EXPECT_TRUE(discovery3.SetCache(cache));
+  discovery3.SetSilenceInterval(1000);
+  discovery3.Start();
+  EXPECT_TRUE(discovery3.WaitForInit(std::chrono::milliseconds(0)));
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    EXPECT_EQ((std::set<std::string>{topicGone, topicKept}), topics);
+  }
+
+  // Only the publisher advertised again is confirmed.
+  std::this_thread::sleep_for(std::chrono::milliseconds(1500));
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    EXPECT_EQ(std::set<std::string>{topicKept}, topics);
+  }
+  Addresses_M<MessagePublisher> publishers;
+  EXPECT_TRUE(discovery3.Publishers(topicKept, publishers));
+  EXPECT_FALSE(discovery3.Publishers(topicGone, publishers));
+
+  std::remove(cache.c_str());
+}
+
+//////////////////////////////////////////////////
+/// \brief The wait for the initialization can be bounded.
+TEST(DiscoveryTest, TestWaitForInitTimeout)
+{
+  transport::Discovery<MessagePublisher> discovery(Uuid().ToString(), g_ip,
+    g_msgPort);
+
+  // A discovery that isn't started never initializes.
+  auto start = std::chrono::steady_clock::now();
+  EXPECT_FALSE(discovery.WaitForInit(std::chrono::milliseconds(50)));
+  EXPECT_GE(std::chrono::steady_clock::now() - start,
+    std::chrono::milliseconds(50));
+
+  discovery.Start();
+  EXPECT_TRUE(discovery.WaitForInit(std::chrono::milliseconds(-1)));
+  EXPECT_TRUE(discovery.WaitForInit(std::chrono::milliseconds(0)));
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that only the publishers of the interesting topics are
+/// stored.
+TEST(DiscoveryTest, TestInterest)
+{
+  const std::string proc1Uuid = Uuid().ToString();
+  const std::string proc2Uuid = Uuid().ToString();
+
+  transport::Discovery<MessagePublisher> discovery1(proc1Uuid, g_ip,
+    g_msgPort);
+  transport::Discovery<MessagePublisher> discovery2(proc2Uuid, g_ip,
+    g_msgPort);
+  discovery2.SetInterest({std::regex("/interest_.*")});
+  EXPECT_TRUE(discovery2.Interested("/interest_a"));
+  EXPECT_TRUE(discovery2.Interested("@/partition@/interest_a"));
+  EXPECT_FALSE(discovery2.Interested("/other_a"));
+  EXPECT_FALSE(discovery2.Interested("/prefix/interest_a"));
+
+  discovery1.Start();
+  discovery2.Start();
+
+  MessagePublisher interesting("/interest_a", addr1, ctrl1, proc1Uuid, nUuid1,
+    "type", AdvertiseMessageOptions());
+  MessagePublisher other("/other_a", addr1, ctrl1, proc1Uuid, nUuid1, "type",
+    AdvertiseMessageOptions());
+  EXPECT_TRUE(discovery1.Advertise(interesting));
+  EXPECT_TRUE(discovery1.Advertise(other));
+
+  Addresses_M<MessagePublisher> publishers;
+  for (int i = 0; i < MaxIters && publishers.empty(); ++i)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(Nap));
+    discovery2.Publishers("/interest_a", publishers);
+  }
+  EXPECT_EQ(1u, publishers.count(proc1Uuid));
+
+  // The updates of /other_a have been received by now.
+  EXPECT_FALSE(discovery2.Publishers("/other_a", publishers));
+
+  // The topics that we look for become interesting.
+  EXPECT_TRUE(discovery2.Discover("/other_a"));
+  EXPECT_TRUE(discovery2.Interested("/other_a"));
+  publishers.clear();
+  for (int i = 0; i < MaxIters && publishers.empty(); ++i)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(Nap));
+    discovery2.Publishers("/other_a", publishers);
+  }
+  EXPECT_EQ(1u, publishers.count(proc1Uuid));
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that the adaptive heartbeat interval follows the number of
+/// peers and that the peers use it to expire the process.
+TEST(DiscoveryTest, TestAdaptiveIntervals)
+{
+  MsgDiscovery discovery1(pUuid1, g_ip, g_msgPort);
+  EXPECT_FALSE(discovery1.AdaptiveIntervals());
+  EXPECT_EQ(discovery1.HeartbeatInterval(),
+    discovery1.CurrentHeartbeatInterval());
+
+  discovery1.SetAdaptiveIntervals(true);
+  EXPECT_TRUE(discovery1.AdaptiveIntervals());
+  EXPECT_EQ(250u, discovery1.CurrentHeartbeatInterval());
+  discovery1.Start();
+
+  // 20 ms per peer.
+  const int numPeers = 15;
+  std::vector<std::unique_ptr<MsgDiscovery>> peers;
+  for (int i = 0; i < numPeers; ++i)
+  {
+    peers.emplace_back(new MsgDiscovery(Uuid().ToString(), g_ip, g_msgPort));
+    peers.back()->Start();
+  }
+
+  for (int i = 0; i < MaxIters * 2 &&
+       discovery1.CurrentHeartbeatInterval() != numPeers * 20u; ++i)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(Nap));
+  }
+  EXPECT_EQ(numPeers * 20u, discovery1.CurrentHeartbeatInterval());
+
+  // The change of interval doesn't make the peers expire us, even with a
+  // silence interval shorter than our heartbeats.
+  disconnectionExecuted = false;
+  peers.front()->DisconnectionsCb(onDisconnection);
+  peers.front()->SetSilenceInterval(100);
+  std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+  EXPECT_FALSE(disconnectionExecuted);
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that the reception thread is woken up when the discovery
+/// stops instead of waiting for its next deadline.
+TEST(DiscoveryTest, TestStopWakesUp)
+{
+  std::chrono::steady_clock::time_point start;
+  {
+    MsgDiscovery discovery(pUuid1, g_ip, g_msgPort);
+    discovery.SetHeartbeatInterval(60000);
+    discovery.SetActivityInterval(60000);
+    discovery.Start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(Nap * 10));
+    start = std::chrono::steady_clock::now();
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  EXPECT_LT(elapsed, std::chrono::milliseconds(200));
+}
+
+//////////////////////////////////////////////////
+/// \brief Once the peers know that they all understand the compact
+/// heartbeats, they keep each other alive with them.
+TEST(DiscoveryTest, TestCompactHeartbeats)
+{
+  DiscoveryDerived<MessagePublisher> discovery1(pUuid1, g_ip, g_msgPort);
+  DiscoveryDerived<MessagePublisher> discovery2(pUuid2, g_ip, g_msgPort);
+  for (auto *discovery : {&discovery1, &discovery2})
+  {
+    discovery->SetHeartbeatInterval(50);
+    discovery->SetSilenceInterval(300);
+    discovery->Start();
+  }
+
+  // Two heartbeats announce the support, the next ones are compact.
+  std::this_thread::sleep_for(std::chrono::milliseconds(500));
+  const DiscoveryTraffic before = discovery1.Traffic();
+  std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+  const DiscoveryTraffic after = discovery1.Traffic();
+
+  // A compact heartbeat and its size take 29 bytes, a protobuf heartbeat
+  // about four times more.
+  const uint64_t datagrams = after.sentDatagrams - before.sentDatagrams;
+  ASSERT_GT(datagrams, 5u);
+  EXPECT_LE((after.sentBytes - before.sentBytes) / datagrams, 40u);
+
+  // The peers are still alive after several silence intervals.
+  discovery1.TestActivity(pUuid2, true);
+  discovery2.TestActivity(pUuid1, true);
+}
+
+//////////////////////////////////////////////////
+/// \brief Send a discovery message as a process of the previous wire
+/// protocol (gz-transport 13 and before) would.
+/// \param[in] _msg Message to send, without its version.
+void sendLegacy(msgs::Discovery _msg)
+{
+  std::string stats;
+  env("GZ_TRANSPORT_TOPIC_STATISTICS", stats);
+  _msg.set_version(10 + (stats == "1") * 100);
+
+  const uint16_t len = static_cast<uint16_t>(_msg.ByteSizeLong());
+  std::string datagram(sizeof(len) + len, '\0');
+  memcpy(&datagram[0], &len, sizeof(len));
+  ASSERT_TRUE(_msg.SerializeToArray(&datagram[sizeof(len)], len));
+
+  const int sock = socket(AF_INET, SOCK_DGRAM, 0);
+  ASSERT_GE(sock, 0);
+  sockaddr_in group = {};
+  group.sin_family = AF_INET;
+  group.sin_addr.s_addr = inet_addr(g_ip.c_str());
+  group.sin_port = htons(g_msgPort);
+  sendto(sock, datagram.data(), datagram.size(), 0,
+    reinterpret_cast<const sockaddr *>(&group), sizeof(group));
+  close(sock);
+}
+
+//////////////////////////////////////////////////
+/// \brief The peers of the previous wire protocol are only discovered when
+/// an address is provided for them, otherwise they are ignored.
+TEST(DiscoveryTest, GZ_UTILS_TEST_DISABLED_ON_WIN32(TestLegacyPeers))
+{
+  msgs::Discovery msg;
+  msg.set_process_uuid(pUuid1);
+  msg.set_type(msgs::Discovery::ADVERTISE);
+  auto *pub = msg.mutable_pub();
+  pub->set_topic(g_topic);
+  pub->set_address(addr1);
+  pub->set_process_uuid(pUuid1);
+  pub->set_node_uuid(nUuid1);
+  pub->set_scope(msgs::Discovery::Publisher::ALL);
+  pub->mutable_msg_pub()->set_ctrl(ctrl1);
+  pub->mutable_msg_pub()->set_msg_type("gz.msgs.Int32");
+
+  for (const bool supported : {false, true})
+  {
+    reset();
+
+    DiscoveryDerived<MessagePublisher> discovery(pUuid2, g_ip, g_msgPort);
+    int asked = 0;
+    discovery.LegacyAddressCb([&asked, supported]()
+    {
+      ++asked;
+      return supported ? std::string("tcp://127.0.0.1:12349") : "";
+    });
+    discovery.ConnectionsCb(onDiscoveryResponse);
+    discovery.Start();
+    EXPECT_TRUE(discovery.Discover(g_topic));
+
+    for (int i = 0; i < MaxIters && !connectionExecuted; ++i)
+    {
+      sendLegacy(msg);
+      std::this_thread::sleep_for(std::chrono::milliseconds(Nap));
+    }
+
+    // The address is only requested once.
+    EXPECT_EQ(1, asked);
+    EXPECT_EQ(supported, connectionExecuted);
+    EXPECT_EQ(supported, discovery.LegacyPeer(pUuid1));
+    discovery.TestActivity(pUuid1, supported);
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief A service discovery running in the reception thread of a message
+/// discovery still discovers and is discovered, and both can be destroyed
+/// in any order.
+TEST(DiscoveryTest, TestSharedThread)
+{
+  for (const bool guestFirst : {true, false})
+  {
+    auto host = std::make_unique<MsgDiscovery>(pUuid1, g_ip, g_msgPort);
+    auto guest = std::make_unique<SrvDiscovery>(pUuid1, g_ip, g_srvPort);
+    MsgDiscovery msgDiscovery2(pUuid2, g_ip, g_msgPort);
+    SrvDiscovery srvDiscovery2(pUuid2, g_ip, g_srvPort);
+
+    std::mutex mutex;
+    bool msgDiscovered = false;
+    bool srvDiscovered = false;
+    bool srvDiscoveredByGuest = false;
+    msgDiscovery2.ConnectionsCb([&](const MessagePublisher &_pub)
+    {
+      std::lock_guard<std::mutex> lk(mutex);
+      msgDiscovered = msgDiscovered || _pub.PUuid() == pUuid1;
+    });
+    srvDiscovery2.ConnectionsCb([&](const ServicePublisher &_pub)
+    {
+      std::lock_guard<std::mutex> lk(mutex);
+      srvDiscovered = srvDiscovered || _pub.PUuid() == pUuid1;
+    });
+    guest->ConnectionsCb([&](const ServicePublisher &_pub)
+    {
+      std::lock_guard<std::mutex> lk(mutex);
+      srvDiscoveredByGuest = srvDiscoveredByGuest || _pub.PUuid() == pUuid2;
+    });
+
+    guest->Start(*host);
+    host->Start();
+    msgDiscovery2.Start();
+    srvDiscovery2.Start();
+
+    MessagePublisher msgPublisher(g_topic, addr1, ctrl1, pUuid1, nUuid1, "t",
+      AdvertiseMessageOptions());
+    EXPECT_TRUE(host->Advertise(msgPublisher));
+    ServicePublisher srvPublisher1(service, addr1, id1, pUuid1, nUuid1,
+      "reqType", "repType", AdvertiseServiceOptions());
+    EXPECT_TRUE(guest->Advertise(srvPublisher1));
+    ServicePublisher srvPublisher2(service, addr2, id2, pUuid2, nUuid2,
+      "reqType", "repType", AdvertiseServiceOptions());
+    EXPECT_TRUE(srvDiscovery2.Advertise(srvPublisher2));
+
+    auto discovered = [&]
+    {
+      std::lock_guard<std::mutex> lk(mutex);
+      return msgDiscovered && srvDiscovered && srvDiscoveredByGuest;
+    };
+    for (int i = 0; i < MaxIters && !discovered(); ++i)
+      std::this_thread::sleep_for(std::chrono::milliseconds(Nap));
+    EXPECT_TRUE(discovered());
+
+    if (guestFirst)
+      guest.reset();
+    host.reset();
+    guest.reset();
+  }
+}
+
 //////////////////////////////////////////////////
 /// \brief Check that a wrong GZ_IP value makes HostAddr() to return 127.0.0.1
 TEST(DiscoveryTest, GZ_UTILS_TEST_DISABLED_ON_LINUX(WrongGzIp))
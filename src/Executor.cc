@@ -0,0 +1,316 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "gz/transport/Executor.hh"
+#include "gz/transport/Helpers.hh"
+
+#include "ThreadSettings.hh"
+
+using namespace gz;
+using namespace transport;
+
+namespace gz
+{
+  namespace transport
+  {
+    inline namespace GZ_TRANSPORT_VERSION_NAMESPACE
+    {
+    /// \internal
+    /// \brief Functions waiting to be run by an executor. Shared with the
+    /// threads of the executor, which might outlive it when a callback
+    /// releases the last reference to the executor.
+    class ExecutorQueue
+    {
+      /// \brief Pop the oldest pending function.
+      /// \param[in, out] _lk Lock of mutex.
+      /// \param[in] _deadline Time until which to wait for a function.
+      /// \param[in] _untilStopped Wait until a stop instead of _deadline.
+      /// \param[out] _work The function.
+      /// \return False if there's no function to run.
+      public: bool Pop(std::unique_lock<std::mutex> &_lk,
+                       const std::chrono::steady_clock::time_point &_deadline,
+                       const bool _untilStopped,
+                       std::function<void()> &_work)
+      {
+        auto ready = [this, _untilStopped]
+        {
+          return !this->queue.empty() || this->exit ||
+            (_untilStopped && this->stopped);
+        };
+
+        if (_untilStopped)
+          this->condition.wait(_lk, ready);
+        else
+          this->condition.wait_until(_lk, _deadline, ready);
+
+        if (this->queue.empty() || this->exit)
+          return false;
+
+        _work = std::move(this->queue.front());
+        this->queue.pop_front();
+        return true;
+      }
+
+      /// \brief Run a function, reporting its exceptions. The function is
+      /// released before returning.
+      /// \param[in, out] _work The function.
+      public: static void Run(std::function<void()> &_work)
+      {
+        try
+        {
+          _work();
+        }
+        catch (...)
+        {
+          std::cerr << "Exception occurred in a callback run by an executor"
+                    << std::endl;
+        }
+        _work = nullptr;
+      }
+
+      /// \brief Loop of the threads owned by an executor. They keep
+      /// running after a stop.
+      /// \param[in] _queue The queue.
+      /// \param[in] _cpus CPUs of the NUMA node of the executor, or empty.
+      public: static void ThreadLoop(std::shared_ptr<ExecutorQueue> _queue,
+                                     const std::vector<int> _cpus)
+      {
+        configureThread("executor");
+
+        // The NUMA node of the executor overrides the settings of the
+        // executor threads.
+        if (!_cpus.empty())
+        {
+          ThreadSettings settings;
+          settings.cpus = _cpus;
+          std::string error;
+          if (!ApplyThreadSettings(settings, error))
+            std::cerr << "Executor: " << error << std::endl;
+        }
+
+        std::unique_lock<std::mutex> lk(_queue->mutex);
+        std::function<void()> work;
+        while (!_queue->exit)
+        {
+          if (!_queue->Pop(lk, {}, true, work))
+          {
+            // Stopped, wait for a new function or the exit.
+            _queue->condition.wait(lk, [&]
+            {
+              return !_queue->queue.empty() || _queue->exit;
+            });
+            continue;
+          }
+
+          lk.unlock();
+          Run(work);
+          lk.lock();
+        }
+      }
+
+      /// \brief Protects the queue and the flags.
+      public: std::mutex mutex;
+
+      /// \brief Notifies the spinning threads of a new function, of a stop
+      /// or of the exit.
+      public: std::condition_variable condition;
+
+      /// \brief Functions waiting to be run.
+      public: std::deque<std::function<void()>> queue;
+
+      /// \brief Set by Executor::Stop().
+      public: bool stopped = false;
+
+      /// \brief Set by the destructor of the executor.
+      public: bool exit = false;
+    };
+
+    /// \internal
+    /// \brief Private data for Executor class.
+    class ExecutorPrivate
+    {
+      /// \brief Functions waiting to be run.
+      public: std::shared_ptr<ExecutorQueue> queue =
+        std::make_shared<ExecutorQueue>();
+
+      /// \brief Threads owned by the executor.
+      public: std::vector<std::thread> threads;
+
+      /// \brief NUMA node of the threads, or -1.
+      public: int numaNode = -1;
+    };
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+Executor::Executor(const std::size_t _threads)
+  : Executor(_threads, -1)
+{
+}
+
+//////////////////////////////////////////////////
+Executor::Executor(const std::size_t _threads, const int _numaNode)
+  : dataPtr(new ExecutorPrivate())
+{
+  std::vector<int> cpus;
+  if (_numaNode >= 0)
+  {
+    if (NumaTopology::Host().NodeCpus(_numaNode, cpus))
+      this->dataPtr->numaNode = _numaNode;
+    else
+    {
+      std::cerr << "Executor: NUMA node [" << _numaNode << "] has no CPUs"
+                << std::endl;
+    }
+  }
+
+  for (std::size_t i = 0; i < _threads; ++i)
+  {
+    this->dataPtr->threads.emplace_back(&ExecutorQueue::ThreadLoop,
+      this->dataPtr->queue, cpus);
+  }
+}
+
+//////////////////////////////////////////////////
+Executor::~Executor()
+{
+  ExecutorQueue &q = *this->dataPtr->queue;
+  std::deque<std::function<void()>> discarded;
+  {
+    std::lock_guard<std::mutex> lk(q.mutex);
+    q.exit = true;
+    discarded.swap(q.queue);
+  }
+  q.condition.notify_all();
+
+  for (std::thread &thread : this->dataPtr->threads)
+  {
+    // The last reference might be released by a callback, the thread
+    // keeps the queue alive until it returns.
+    if (thread.get_id() == std::this_thread::get_id())
+      thread.detach();
+    else
+      thread.join();
+  }
+}
+
+//////////////////////////////////////////////////
+void Executor::Post(std::function<void()> _work)
+{
+  ExecutorQueue &q = *this->dataPtr->queue;
+  {
+    std::lock_guard<std::mutex> lk(q.mutex);
+    q.queue.push_back(std::move(_work));
+  }
+  q.condition.notify_one();
+}
+
+//////////////////////////////////////////////////
+bool Executor::SpinOnce(const std::chrono::nanoseconds &_timeout)
+{
+  ExecutorQueue &q = *this->dataPtr->queue;
+  std::function<void()> work;
+  {
+    std::unique_lock<std::mutex> lk(q.mutex);
+    if (!q.Pop(lk, std::chrono::steady_clock::now() + _timeout, false,
+          work))
+    {
+      return false;
+    }
+  }
+
+  ExecutorQueue::Run(work);
+  return true;
+}
+
+//////////////////////////////////////////////////
+std::size_t Executor::SpinSome()
+{
+  // Only the functions already pending, the callbacks might queue more.
+  std::deque<std::function<void()>> pending;
+  {
+    std::lock_guard<std::mutex> lk(this->dataPtr->queue->mutex);
+    pending.swap(this->dataPtr->queue->queue);
+  }
+
+  for (std::function<void()> &work : pending)
+    ExecutorQueue::Run(work);
+  return pending.size();
+}
+
+//////////////////////////////////////////////////
+void Executor::Spin()
+{
+  ExecutorQueue &q = *this->dataPtr->queue;
+  std::unique_lock<std::mutex> lk(q.mutex);
+  std::function<void()> work;
+  while (!q.stopped && q.Pop(lk, {}, true, work))
+  {
+    lk.unlock();
+    ExecutorQueue::Run(work);
+    lk.lock();
+  }
+}
+
+//////////////////////////////////////////////////
+void Executor::Stop()
+{
+  {
+    std::lock_guard<std::mutex> lk(this->dataPtr->queue->mutex);
+    this->dataPtr->queue->stopped = true;
+  }
+  this->dataPtr->queue->condition.notify_all();
+}
+
+//////////////////////////////////////////////////
+bool Executor::Stopped() const
+{
+  std::lock_guard<std::mutex> lk(this->dataPtr->queue->mutex);
+  return this->dataPtr->queue->stopped;
+}
+
+//////////////////////////////////////////////////
+std::size_t Executor::Pending() const
+{
+  std::lock_guard<std::mutex> lk(this->dataPtr->queue->mutex);
+  return this->dataPtr->queue->queue.size();
+}
+
+//////////////////////////////////////////////////
+std::size_t Executor::ThreadCount() const
+{
+  return this->dataPtr->threads.size();
+}
+
+//////////////////////////////////////////////////
+int Executor::NumaNode() const
+{
+  return this->dataPtr->numaNode;
+}
@@ -0,0 +1,200 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "gz/transport/Executor.hh"
+#include "gtest/gtest.h"
+
+#include "ThreadSettings.hh"
+
+using namespace gz;
+using namespace transport;
+
+//////////////////////////////////////////////////
+/// \brief An executor without threads runs the functions in the thread
+/// spinning it, in order.
+TEST(ExecutorTest, CallerSpun)
+{
+  Executor executor;
+  EXPECT_EQ(0u, executor.ThreadCount());
+  EXPECT_FALSE(executor.SpinOnce());
+
+  std::vector<int> order;
+  const auto caller = std::this_thread::get_id();
+  for (int i = 0; i < 3; ++i)
+  {
+    executor.Post([&order, &caller, i]
+    {
+      EXPECT_EQ(caller, std::this_thread::get_id());
+      order.push_back(i);
+    });
+  }
+  EXPECT_EQ(3u, executor.Pending());
+  EXPECT_TRUE(order.empty());
+
+  EXPECT_TRUE(executor.SpinOnce());
+  EXPECT_EQ(std::vector<int>({0}), order);
+
+  // The functions queued by a function are left for the next spin.
+  executor.Post([&executor, &order]
+  {
+    executor.Post([&order]{order.push_back(4);});
+    order.push_back(3);
+  });
+  EXPECT_EQ(3u, executor.SpinSome());
+  EXPECT_EQ(std::vector<int>({0, 1, 2, 3}), order);
+  EXPECT_EQ(1u, executor.Pending());
+  EXPECT_EQ(1u, executor.SpinSome());
+  EXPECT_EQ(0u, executor.Pending());
+}
+
+//////////////////////////////////////////////////
+/// \brief SpinOnce() waits for a function, and Spin() runs them until
+/// Stop().
+TEST(ExecutorTest, SpinAndStop)
+{
+  Executor executor;
+  const auto start = std::chrono::steady_clock::now();
+  EXPECT_FALSE(executor.SpinOnce(std::chrono::milliseconds(20)));
+  EXPECT_GE(std::chrono::steady_clock::now() - start,
+    std::chrono::milliseconds(20));
+
+  std::thread poster([&executor]
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    executor.Post([]{});
+  });
+  EXPECT_TRUE(executor.SpinOnce(std::chrono::seconds(5)));
+  poster.join();
+
+  int count = 0;
+  executor.Post([&count]{++count;});
+  executor.Post([&count, &executor]
+  {
+    ++count;
+    executor.Stop();
+  });
+  executor.Post([&count]{++count;});
+  executor.Spin();
+  EXPECT_TRUE(executor.Stopped());
+  EXPECT_EQ(2, count);
+
+  // Spin() returns for good, the pending functions can still be run.
+  executor.Spin();
+  EXPECT_EQ(2, count);
+  EXPECT_EQ(1u, executor.SpinSome());
+  EXPECT_EQ(3, count);
+}
+
+//////////////////////////////////////////////////
+/// \brief An executor with threads runs the functions on them, and an
+/// exception doesn't stop them.
+TEST(ExecutorTest, Threads)
+{
+  std::mutex mutex;
+  std::set<std::thread::id> threads;
+  std::atomic<int> count{0};
+  {
+    Executor executor(2);
+    EXPECT_EQ(2u, executor.ThreadCount());
+    executor.Post([]{throw 1;});
+    for (int i = 0; i < 100; ++i)
+    {
+      executor.Post([&]
+      {
+        std::lock_guard<std::mutex> lk(mutex);
+        threads.insert(std::this_thread::get_id());
+        ++count;
+      });
+    }
+
+    for (int i = 0; i < 500 && count < 100; ++i)
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    EXPECT_EQ(100, count);
+  }
+
+  EXPECT_FALSE(threads.empty());
+  EXPECT_LE(threads.size(), 2u);
+  EXPECT_EQ(0u, threads.count(std::this_thread::get_id()));
+}
+
+//////////////////////////////////////////////////
+/// \brief A function may release the last reference to its executor.
+TEST(ExecutorTest, DestroyedByFunction)
+{
+  std::atomic<bool> done{false};
+  auto executor = std::make_shared<Executor>(1);
+  std::weak_ptr<Executor> weak = executor;
+  executor->Post([executor, &done]() mutable
+  {
+    executor.reset();
+    done = true;
+  });
+  executor.reset();
+
+  for (int i = 0; i < 500 && !done; ++i)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_TRUE(done);
+  for (int i = 0; i < 500 && !weak.expired(); ++i)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_TRUE(weak.expired());
+}
+
+//////////////////////////////////////////////////
+/// \brief The threads of an executor bound to a NUMA node run on its CPUs.
+TEST(ExecutorTest, NumaNode)
+{
+  EXPECT_EQ(-1, Executor(1).NumaNode());
+  EXPECT_EQ(-1, Executor(1, 100000).NumaNode());
+
+  std::vector<int> cpus;
+  if (!NumaTopology::Host().NodeCpus(0, cpus))
+    GTEST_SKIP() << "The node 0 has no CPUs";
+
+  Executor executor(1, 0);
+  EXPECT_EQ(0, executor.NumaNode());
+
+  std::atomic<bool> done{false};
+  executor.Post([&cpus, &done]
+  {
+#ifdef __linux__
+    cpu_set_t set;
+    if (pthread_getaffinity_np(pthread_self(), sizeof(set), &set) == 0)
+    {
+      // The CPUs of the node outside the cpuset of the process are left
+      // out.
+      int inNode = 0;
+      for (const int cpu : cpus)
+        inNode += CPU_ISSET(cpu, &set) ? 1 : 0;
+      EXPECT_GT(inNode, 0);
+      EXPECT_EQ(inNode, CPU_COUNT(&set));
+    }
+#endif
+    done = true;
+  });
+
+  for (int i = 0; i < 500 && !done; ++i)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_TRUE(done);
+}
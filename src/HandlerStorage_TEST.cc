@@ -18,6 +18,7 @@
 #include <gz/msgs/vector3d.pb.h>
 
 #include <map>
+#include <memory>
 #include <string>
 
 #include "gz/transport/HandlerStorage.hh"
@@ -241,3 +242,128 @@ TEST(RepStorageTest, SubStorageNoCallbacks)
   EXPECT_EQ(handler->NodeUuid(), sub1HandlerPtr->NodeUuid());
   EXPECT_EQ(handler->HandlerUuid(), sub1HandlerPtr->HandlerUuid());
 }
+
+//////////////////////////////////////////////////
+/// \brief Check the cached lists of handlers matching a message type.
+TEST(RepStorageTest, SubStorageMatchingHandlers)
+{
+  transport::HandlerStorage<transport::ISubscriptionHandler> subs;
+  msgs::Int32 msg;
+
+  EXPECT_EQ(nullptr, subs.MatchingHandlers(topic, msg.GetTypeName()));
+
+  auto int32Handler =
+    std::make_shared<transport::SubscriptionHandler<msgs::Int32>>(nUuid1);
+  auto vector3dHandler =
+    std::make_shared<transport::SubscriptionHandler<msgs::Vector3d>>(nUuid1);
+  subs.AddHandler(topic, nUuid1, int32Handler);
+  subs.AddHandler(topic, nUuid1, vector3dHandler);
+
+  auto handlers = subs.MatchingHandlers(topic, msg.GetTypeName());
+  ASSERT_NE(nullptr, handlers);
+  ASSERT_EQ(1u, handlers->size());
+  EXPECT_EQ(int32Handler, handlers->front());
+  EXPECT_EQ(nullptr, subs.MatchingHandlers(topic, "incorrect type"));
+
+  // The list is cached.
+  EXPECT_EQ(handlers, subs.MatchingHandlers(topic, msg.GetTypeName()));
+
+  // A new handler invalidates the list.
+  auto genericHandler =
+    std::make_shared<transport::SubscriptionHandler<transport::ProtoMsg>>(
+      nUuid2);
+  subs.AddHandler(topic, nUuid2, genericHandler);
+  auto newHandlers = subs.MatchingHandlers(topic, msg.GetTypeName());
+  ASSERT_NE(nullptr, newHandlers);
+  EXPECT_EQ(2u, newHandlers->size());
+  EXPECT_EQ(1u, handlers->size());
+
+  // Removing handlers invalidates the list too.
+  EXPECT_TRUE(subs.RemoveHandlersForNode(topic, nUuid2));
+  newHandlers = subs.MatchingHandlers(topic, msg.GetTypeName());
+  ASSERT_NE(nullptr, newHandlers);
+  EXPECT_EQ(1u, newHandlers->size());
+
+  EXPECT_TRUE(subs.RemoveHandler(topic, nUuid1, int32Handler->HandlerUuid()));
+  EXPECT_EQ(nullptr, subs.MatchingHandlers(topic, msg.GetTypeName()));
+}
+
+//////////////////////////////////////////////////
+/// \brief A snapshot of the handlers of a topic is not modified by later
+/// insertions or removals.
+TEST(RepStorageTest, SubStorageTopicHandlers)
+{
+  transport::HandlerStorage<transport::ISubscriptionHandler> subs;
+  EXPECT_EQ(nullptr, subs.TopicHandlers(topic));
+
+  auto handler1 =
+    std::make_shared<transport::SubscriptionHandler<msgs::Int32>>(nUuid1);
+  subs.AddHandler(topic, nUuid1, handler1);
+
+  auto snapshot = subs.TopicHandlers(topic);
+  ASSERT_NE(nullptr, snapshot);
+  ASSERT_EQ(1u, snapshot->size());
+  EXPECT_EQ(nUuid1, snapshot->front().nUuid);
+  EXPECT_EQ(handler1->HandlerUuid(), snapshot->front().hUuid);
+  EXPECT_EQ(handler1, snapshot->front().handler);
+
+  // Adding the same handler twice does not modify the storage.
+  const uint64_t version = subs.Version();
+  subs.AddHandler(topic, nUuid1, handler1);
+  EXPECT_EQ(snapshot, subs.TopicHandlers(topic));
+  EXPECT_EQ(version, subs.Version());
+
+  auto handler2 =
+    std::make_shared<transport::SubscriptionHandler<msgs::Int32>>(nUuid2);
+  subs.AddHandler(topic, nUuid2, handler2);
+  EXPECT_GT(subs.Version(), version);
+  ASSERT_NE(nullptr, subs.TopicHandlers(topic));
+  EXPECT_EQ(2u, subs.TopicHandlers(topic)->size());
+  EXPECT_EQ(1u, snapshot->size());
+
+  EXPECT_TRUE(subs.RemoveHandlersForNode(topic, nUuid1));
+  EXPECT_TRUE(subs.RemoveHandlersForNode(topic, nUuid2));
+  EXPECT_EQ(nullptr, subs.TopicHandlers(topic));
+  EXPECT_FALSE(subs.HasHandlersForTopic(topic));
+
+  // The snapshot still owns the handler.
+  ASSERT_EQ(1u, snapshot->size());
+  EXPECT_EQ(handler1, snapshot->front().handler);
+}
+
+//////////////////////////////////////////////////
+/// \brief The messages of a subscription reusing its messages are recycled
+/// once released.
+TEST(RepStorageTest, SubReuseMessage)
+{
+  transport::SubscribeOptions opts;
+  opts.SetReuseMessage(true);
+  transport::SubscriptionHandler<msgs::Int32> handler(nUuid1, opts);
+
+  msgs::Int32 msg;
+  msg.set_data(intResult);
+  const std::string data = msg.SerializeAsString();
+
+  auto msg1 = handler.CreateMsg(data, msg.GetTypeName());
+  ASSERT_NE(nullptr, msg1);
+  const transport::ProtoMsg *address = msg1.get();
+
+  // A message still referenced is not recycled.
+  auto msg2 = handler.CreateMsg(data, msg.GetTypeName());
+  ASSERT_NE(nullptr, msg2);
+  EXPECT_NE(address, msg2.get());
+
+  msg1.reset();
+  auto msg3 = handler.CreateMsg(data, msg.GetTypeName());
+  ASSERT_NE(nullptr, msg3);
+  EXPECT_EQ(address, msg3.get());
+  EXPECT_EQ(intResult,
+    static_cast<const msgs::Int32 *>(msg3.get())->data());
+
+  // Without the option, every message is allocated.
+  transport::SubscriptionHandler<msgs::Int32> handler2(nUuid2);
+  auto msg4 = handler2.CreateMsg(data, msg.GetTypeName());
+  const transport::ProtoMsg *address2 = msg4.get();
+  auto msg5 = handler2.CreateMsg(data, msg.GetTypeName());
+  EXPECT_NE(address2, msg5.get());
+}
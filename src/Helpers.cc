@@ -16,16 +16,22 @@
 */
 
 #include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <set>
 #include <string>
 
 #ifdef _WIN32
 #include <windows.h>
 #else
+#include <pthread.h>
 #include <unistd.h>
 #endif
 
 #include "gz/transport/Helpers.hh"
 
+#include "ThreadSettings.hh"
+
 namespace gz
 {
   namespace transport
@@ -75,6 +81,33 @@ namespace gz
       return ::getpid();
 #endif
     }
+
+    //////////////////////////////////////////////////
+    void configureThread(const std::string &_name)
+    {
+#ifdef __linux__
+      // The name is limited to 15 characters.
+      pthread_setname_np(pthread_self(), ("gz-" + _name).substr(0, 15).c_str());
+#endif
+
+      ThreadSettings settings;
+      if (!ThreadSettingsTable::FromEnv().Find(_name, settings))
+        return;
+
+      std::string error;
+      if (ApplyThreadSettings(settings, error))
+        return;
+
+      // Report the failure once per kind of thread.
+      static std::mutex mutex;
+      static std::set<std::string> failed;
+      std::lock_guard<std::mutex> lk(mutex);
+      if (failed.insert(_name).second)
+      {
+        std::cerr << "Unable to configure the [" << _name << "] thread: "
+                  << error << std::endl;
+      }
+    }
     }
   }
 }
@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "HugePages.hh"
+
+namespace gz
+{
+  namespace transport
+  {
+    inline namespace GZ_TRANSPORT_VERSION_NAMESPACE
+    {
+    //////////////////////////////////////////////////
+    std::shared_ptr<char> AllocateHugePages(const std::size_t _size,
+      const HugePages_t _mode, uint64_t &_faultsSaved)
+    {
+      _faultsSaved = 0;
+#ifdef __linux__
+      if (_mode == HugePages_t::NONE || _size == 0)
+        return nullptr;
+
+      const std::size_t size =
+        (_size + kHugePageSize - 1) / kHugePageSize * kHugePageSize;
+      const uint64_t saved = size / kBasePageSize - size / kHugePageSize;
+
+      if (_mode == HugePages_t::EXPLICIT)
+      {
+        void *ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+          MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (ptr != MAP_FAILED)
+        {
+          _faultsSaved = saved;
+          return std::shared_ptr<char>(static_cast<char *>(ptr),
+            [size](char *_ptr) {munmap(_ptr, size);});
+        }
+      }
+
+      // A transparent huge page must be aligned, map one more and trim the
+      // ends.
+      void *ptr = mmap(nullptr, size + kHugePageSize, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if (ptr == MAP_FAILED)
+        return nullptr;
+
+      char *start = static_cast<char *>(ptr);
+      const std::size_t head = (kHugePageSize -
+        reinterpret_cast<uintptr_t>(start) % kHugePageSize) % kHugePageSize;
+      if (head > 0)
+        munmap(start, head);
+      munmap(start + head + size, kHugePageSize - head);
+      start += head;
+
+#ifdef MADV_HUGEPAGE
+      if (madvise(start, size, MADV_HUGEPAGE) == 0)
+        _faultsSaved = saved;
+#endif
+      return std::shared_ptr<char>(start,
+        [size](char *_ptr) {munmap(_ptr, size);});
+#else
+      (void)_size;
+      (void)_mode;
+      return nullptr;
+#endif
+    }
+    }
+  }
+}
@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GZ_TRANSPORT_HUGEPAGES_HH_
+#define GZ_TRANSPORT_HUGEPAGES_HH_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "gz/transport/AdvertiseOptions.hh"
+#include "gz/transport/config.hh"
+
+namespace gz
+{
+  namespace transport
+  {
+    inline namespace GZ_TRANSPORT_VERSION_NAMESPACE
+    {
+    /// \internal
+    /// \brief Size of a huge page (bytes).
+    static constexpr std::size_t kHugePageSize = std::size_t(2) << 20;
+
+    /// \internal
+    /// \brief Size of a regular page (bytes).
+    static constexpr std::size_t kBasePageSize = 4096;
+
+    /// \internal
+    /// \brief Allocate memory backed by huge pages, aligned on a huge page.
+    /// \param[in] _size Size of the memory (bytes). The mapping is rounded
+    /// up to a multiple of kHugePageSize.
+    /// \param[in] _mode TRANSPARENT advises the kernel with madvise().
+    /// EXPLICIT maps reserved huge pages, and falls back to TRANSPARENT
+    /// when none is left.
+    /// \param[out] _faultsSaved Page faults saved when the memory is first
+    /// written, compared to regular pages. 0 if the kernel refused the huge
+    /// pages.
+    /// \return The memory, unmapped when released, or null if the mode is
+    /// NONE, the platform isn't Linux or the mapping failed.
+    std::shared_ptr<char> AllocateHugePages(const std::size_t _size,
+                                            const HugePages_t _mode,
+                                            uint64_t &_faultsSaved);
+    }
+  }
+}
+#endif
@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+#include "gz/transport/AdvertiseOptions.hh"
+#include "BufferPool.hh"
+#include "HugePages.hh"
+#include "gtest/gtest.h"
+
+using namespace gz;
+using namespace transport;
+
+//////////////////////////////////////////////////
+/// \brief Allocate memory with each kind of huge pages.
+TEST(HugePagesTest, Allocate)
+{
+  uint64_t faultsSaved = 1;
+  EXPECT_EQ(nullptr,
+    AllocateHugePages(kHugePageSize, HugePages_t::NONE, faultsSaved));
+  EXPECT_EQ(0u, faultsSaved);
+
+#ifdef __linux__
+  // The explicit huge pages fall back to the transparent ones when none
+  // is reserved, the memory is usable either way.
+  for (auto mode : {HugePages_t::TRANSPARENT, HugePages_t::EXPLICIT})
+  {
+    std::shared_ptr<char> memory =
+      AllocateHugePages(3 * kHugePageSize + 1, mode, faultsSaved);
+    ASSERT_NE(nullptr, memory);
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(memory.get()) % kHugePageSize);
+    std::memset(memory.get(), 1, 4 * kHugePageSize);
+    if (faultsSaved > 0)
+    {
+      EXPECT_EQ(4 * (kHugePageSize / kBasePageSize - 1), faultsSaved);
+    }
+  }
+#endif
+}
+
+//////////////////////////////////////////////////
+/// \brief Only the buffers above the minimum size use huge pages, and they
+/// are reused by the pool.
+TEST(HugePagesTest, BufferPool)
+{
+  const std::size_t size = 3 * kHugePageSize;
+  BufferPool pool(8 * kHugePageSize, HugePages_t::TRANSPARENT,
+                  kHugePageSize);
+
+  uint64_t faultsSaved = 1;
+  {
+    SerializedBuffer small = pool.Acquire(1000, &faultsSaved);
+    EXPECT_EQ(1000u, small.Size());
+    EXPECT_EQ(0u, faultsSaved);
+  }
+  EXPECT_EQ(0u, pool.HugePageBuffers());
+
+  {
+    SerializedBuffer large = pool.Acquire(size, &faultsSaved);
+    ASSERT_NE(nullptr, large.Data());
+    std::memset(large.Data(), 1, size);
+    EXPECT_EQ(faultsSaved, pool.HugePageFaultsSaved());
+  }
+  const uint64_t buffers = pool.HugePageBuffers();
+  EXPECT_LE(buffers, 1u);
+
+  // The same buffer is reused without new faults.
+  {
+    SerializedBuffer large = pool.Acquire(size, &faultsSaved);
+    EXPECT_EQ(0u, faultsSaved);
+  }
+  EXPECT_EQ(1u, pool.Hits());
+  EXPECT_EQ(buffers, pool.HugePageBuffers());
+
+  // A buffer too big for the pool is still backed by huge pages.
+  {
+    SerializedBuffer huge = pool.Acquire(16 * kHugePageSize, &faultsSaved);
+    ASSERT_NE(nullptr, huge.Data());
+    std::memset(huge.Data(), 1, 16 * kHugePageSize);
+  }
+}
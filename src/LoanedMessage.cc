@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <cstddef>
+#include <utility>
+
+#include "gz/transport/LoanedMessage.hh"
+
+#include "LoanedMessagePrivate.hh"
+
+using namespace gz;
+using namespace transport;
+
+//////////////////////////////////////////////////
+LoanedMessage::LoanedMessage()
+  : dataPtr(new LoanedMessagePrivate())
+{
+}
+
+//////////////////////////////////////////////////
+LoanedMessage::LoanedMessage(LoanedMessage &&_other)  // NOLINT
+  : dataPtr(new LoanedMessagePrivate())
+{
+  std::swap(this->dataPtr, _other.dataPtr);
+}
+
+//////////////////////////////////////////////////
+LoanedMessage &LoanedMessage::operator=(LoanedMessage &&_other)  // NOLINT
+{
+  if (this != &_other)
+  {
+    *this->dataPtr = LoanedMessagePrivate();
+    std::swap(this->dataPtr, _other.dataPtr);
+  }
+  return *this;
+}
+
+//////////////////////////////////////////////////
+LoanedMessage::~LoanedMessage()
+{
+}
+
+//////////////////////////////////////////////////
+char *LoanedMessage::Data()
+{
+  return this->dataPtr->buffer.Data();
+}
+
+//////////////////////////////////////////////////
+std::size_t LoanedMessage::Size() const
+{
+  return this->dataPtr->size;
+}
+
+//////////////////////////////////////////////////
+bool LoanedMessage::Resize(const std::size_t _size)
+{
+  if (!this->Valid() || _size > this->dataPtr->buffer.Size())
+    return false;
+
+  this->dataPtr->size = _size;
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool LoanedMessage::Valid() const
+{
+  return static_cast<bool>(this->dataPtr->buffer);
+}
+
+//////////////////////////////////////////////////
+LoanedMessage::operator bool() const
+{
+  return this->Valid();
+}
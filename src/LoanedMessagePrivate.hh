@@ -0,0 +1,46 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GZ_TRANSPORT_LOANEDMESSAGEPRIVATE_HH_
+#define GZ_TRANSPORT_LOANEDMESSAGEPRIVATE_HH_
+
+#include <cstddef>
+
+#include "gz/transport/config.hh"
+
+#include "SerializedBuffer.hh"
+
+namespace gz
+{
+  namespace transport
+  {
+    inline namespace GZ_TRANSPORT_VERSION_NAMESPACE
+    {
+    /// \internal
+    /// \brief Private data for LoanedMessage class.
+    class LoanedMessagePrivate
+    {
+      /// \brief The loaned buffer.
+      public: SerializedBuffer buffer;
+
+      /// \brief Size of the message (bytes), at most buffer.Size().
+      public: std::size_t size = 0;
+    };
+    }
+  }
+}
+#endif
@@ -0,0 +1,463 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gz/msgs/statistic.pb.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "gz/transport/Lockstep.hh"
+#include "gz/transport/Node.hh"
+#include "gz/transport/NodeShared.hh"
+#include "gz/transport/TopicUtils.hh"
+
+#include "LockstepTracker.hh"
+#include "NodeSharedPrivate.hh"
+
+using namespace gz;
+using namespace transport;
+
+/// \brief Longest wait for the reports of a round before probing again.
+static const std::chrono::milliseconds kRoundTimeout(100);
+
+/// \brief Pause between two rounds whose counters aren't balanced.
+static const std::chrono::milliseconds kRoundInterval(1);
+
+/// \brief Counters reported by a process in a round.
+struct LockstepReport
+{
+  /// \brief Deliveries of the process whose callbacks haven't returned.
+  int64_t inFlight = 0;
+
+  /// \brief Messages received, by fully qualified topic tracked by the
+  /// process.
+  std::map<std::string, uint64_t> received;
+
+  /// \brief Messages sent, by fully qualified topic and process UUID of
+  /// the remote subscribers.
+  std::map<std::pair<std::string, std::string>, uint64_t> sent;
+};
+
+/// \brief Counters of the group, by fully qualified topic and process UUID
+/// of the subscribers: the messages sent to the process by the group, and
+/// the messages received by the process.
+using LockstepTotals = std::map<std::pair<std::string, std::string>,
+  std::pair<uint64_t, uint64_t>>;
+
+//////////////////////////////////////////////////
+/// \brief Add a counter to a report.
+/// \param[in, out] _msg The report.
+/// \param[in] _name Name of the counter.
+/// \param[in] _value Value of the counter.
+static void addCounter(msgs::StatisticsGroup &_msg, const std::string &_name,
+  const double _value)
+{
+  msgs::Statistic *stat = _msg.add_statistics();
+  stat->set_type(msgs::Statistic::SAMPLE_COUNT);
+  stat->set_name(_name);
+  stat->set_value(_value);
+}
+
+/// \internal
+/// \brief Private data for Lockstep class.
+class gz::transport::LockstepPrivate
+{
+  /// \brief Constructor.
+  /// \param[in] _options Options of the node.
+  public: explicit LockstepPrivate(const NodeOptions &_options)
+    : node(_options)
+  {
+  }
+
+  /// \brief Report the counters of the process, called by the probes.
+  /// \param[in] _msg The probe.
+  public: void OnProbe(const msgs::StatisticsGroup &_msg);
+
+  /// \brief Store the report of a process, called by the reports.
+  /// \param[in] _msg The report.
+  public: void OnReport(const msgs::StatisticsGroup &_msg);
+
+  /// \brief Sum the counters of a round.
+  /// \param[out] _totals The counters of the group.
+  /// \return The deliveries in flight in the group.
+  public: int64_t Totals(LockstepTotals &_totals) const;
+
+  /// \brief Node probing the processes.
+  public: Node node;
+
+  /// \brief Counters of the process.
+  public: LockstepTracker *tracker = nullptr;
+
+  /// \brief UUID of the process.
+  public: std::string pUuid;
+
+  /// \brief Topic of the probes.
+  public: std::string probeTopic;
+
+  /// \brief Topic of the reports.
+  public: std::string reportTopic;
+
+  /// \brief Publisher of the reports.
+  public: Node::Publisher reportPub;
+
+  /// \brief Publisher of the probes, advertised by the first barrier.
+  public: Node::Publisher probePub;
+
+  /// \brief The topics added, and their fully qualified names.
+  public: std::map<std::string, std::string> topics;
+
+  /// \brief Protects the fields below.
+  public: mutable std::mutex mutex;
+
+  /// \brief Notified when a report of the round is stored.
+  public: std::condition_variable reported;
+
+  /// \brief Number of the current round.
+  public: uint32_t round = 0;
+
+  /// \brief Reports of the current round, by process UUID.
+  public: std::map<std::string, LockstepReport> reports;
+
+  /// \brief Messages forgiven when a barrier timed out, by fully
+  /// qualified topic and process UUID of the subscribers.
+  public: std::map<std::pair<std::string, std::string>, uint64_t> forgiven;
+
+  /// \brief Number of processes of the last complete round.
+  public: std::size_t participants = 0;
+};
+
+//////////////////////////////////////////////////
+void LockstepPrivate::OnProbe(const msgs::StatisticsGroup &_msg)
+{
+  if (_msg.statistics_size() < 1)
+    return;
+
+  msgs::StatisticsGroup report;
+  report.set_name(this->pUuid);
+  addCounter(report, "round", _msg.statistics(0).value());
+
+  // The deliveries are read after the counters, see
+  // LockstepTracker::InFlight().
+  const auto counters = this->tracker->Snapshot();
+  addCounter(report, "inflight",
+    static_cast<double>(this->tracker->InFlight()));
+  for (const auto &topic : counters)
+  {
+    addCounter(report, "received " + topic.first,
+      static_cast<double>(topic.second.received));
+    for (const auto &sent : topic.second.sent)
+    {
+      addCounter(report, "sent " + topic.first + " " + sent.first,
+        static_cast<double>(sent.second));
+    }
+  }
+
+  this->reportPub.Publish(report);
+}
+
+//////////////////////////////////////////////////
+void LockstepPrivate::OnReport(const msgs::StatisticsGroup &_msg)
+{
+  if (_msg.statistics_size() < 2 || _msg.statistics(0).name() != "round")
+    return;
+
+  std::lock_guard<std::mutex> lock(this->mutex);
+  if (static_cast<uint32_t>(_msg.statistics(0).value()) != this->round)
+    return;
+
+  LockstepReport report;
+  report.inFlight = static_cast<int64_t>(_msg.statistics(1).value());
+  for (int i = 2; i < _msg.statistics_size(); ++i)
+  {
+    // The topic names don't contain spaces.
+    const std::string &name = _msg.statistics(i).name();
+    const uint64_t value =
+      static_cast<uint64_t>(_msg.statistics(i).value());
+    const auto first = name.find(' ');
+    if (first == std::string::npos)
+      continue;
+
+    const auto second = name.find(' ', first + 1);
+    if (name.compare(0, first, "received") == 0)
+    {
+      report.received[name.substr(first + 1)] = value;
+    }
+    else if (name.compare(0, first, "sent") == 0 &&
+             second != std::string::npos)
+    {
+      report.sent[{name.substr(first + 1, second - first - 1),
+                   name.substr(second + 1)}] = value;
+    }
+  }
+
+  this->reports[_msg.name()] = std::move(report);
+  this->reported.notify_all();
+}
+
+//////////////////////////////////////////////////
+int64_t LockstepPrivate::Totals(LockstepTotals &_totals) const
+{
+  int64_t inFlight = 0;
+  _totals.clear();
+
+  // Only the processes tracking a topic count its messages.
+  for (const auto &report : this->reports)
+  {
+    inFlight += report.second.inFlight;
+    for (const auto &received : report.second.received)
+      _totals[{received.first, report.first}].second = received.second;
+  }
+
+  for (const auto &report : this->reports)
+  {
+    for (const auto &sent : report.second.sent)
+    {
+      auto it = _totals.find(sent.first);
+      if (it != _totals.end())
+        it->second.first += sent.second;
+    }
+  }
+
+  return inFlight;
+}
+
+//////////////////////////////////////////////////
+Lockstep::Lockstep(const std::string &_group, const NodeOptions &_options)
+  : dataPtr(new LockstepPrivate(_options))
+{
+  NodeShared *shared = NodeShared::Instance();
+  this->dataPtr->tracker = &shared->dataPtr->lockstep;
+  this->dataPtr->pUuid = shared->pUuid;
+  this->dataPtr->probeTopic = _group + "/probe";
+  this->dataPtr->reportTopic = _group + "/report";
+
+  // The rounds of different barriers don't collide.
+  std::random_device rd;
+  this->dataPtr->round = static_cast<uint32_t>(rd());
+
+  this->dataPtr->reportPub =
+    this->dataPtr->node.Advertise<msgs::StatisticsGroup>(
+      this->dataPtr->reportTopic);
+  if (!this->dataPtr->reportPub)
+  {
+    std::cerr << "Lockstep: invalid group [" << _group << "]" << std::endl;
+    return;
+  }
+
+  std::function<void(const msgs::StatisticsGroup &)> cb =
+    [this](const msgs::StatisticsGroup &_msg)
+    {
+      this->dataPtr->OnProbe(_msg);
+    };
+  this->dataPtr->node.Subscribe(this->dataPtr->probeTopic, cb);
+}
+
+//////////////////////////////////////////////////
+Lockstep::~Lockstep()
+{
+  // Stop the callbacks before the state they use is destroyed.
+  this->dataPtr->node.Unsubscribe(this->dataPtr->probeTopic);
+  this->dataPtr->node.Unsubscribe(this->dataPtr->reportTopic);
+
+  for (const auto &topic : this->dataPtr->topics)
+    this->dataPtr->tracker->RemoveTopic(topic.second);
+}
+
+//////////////////////////////////////////////////
+bool Lockstep::AddTopic(const std::string &_topic)
+{
+  const NodeOptions &options = this->dataPtr->node.Options();
+  std::string topic = _topic;
+  options.TopicRemap(_topic, topic);
+
+  std::string fullyQualifiedTopic;
+  if (!TopicUtils::FullyQualifiedName(options.Partition(),
+    options.NameSpace(), topic, fullyQualifiedTopic))
+  {
+    std::cerr << "Lockstep: topic [" << _topic << "] is not valid."
+              << std::endl;
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  if (!this->dataPtr->topics.emplace(_topic, fullyQualifiedTopic).second)
+    return false;
+
+  this->dataPtr->tracker->AddTopic(fullyQualifiedTopic);
+  return true;
+}
+
+//////////////////////////////////////////////////
+std::vector<std::string> Lockstep::Topics() const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  std::vector<std::string> topics;
+  for (const auto &topic : this->dataPtr->topics)
+    topics.push_back(topic.first);
+  return topics;
+}
+
+//////////////////////////////////////////////////
+bool Lockstep::WaitForQuiescence(const std::chrono::milliseconds &_timeout)
+{
+  if (!this->dataPtr->reportPub)
+    return false;
+
+  const auto start = std::chrono::steady_clock::now();
+  const auto deadline = _timeout.count() < 0 ?
+    std::chrono::steady_clock::time_point::max() : start + _timeout;
+
+  // The probes and the reports only flow while a barrier is waited for.
+  if (!this->dataPtr->probePub)
+  {
+    this->dataPtr->probePub =
+      this->dataPtr->node.Advertise<msgs::StatisticsGroup>(
+        this->dataPtr->probeTopic);
+    std::function<void(const msgs::StatisticsGroup &)> cb =
+      [this](const msgs::StatisticsGroup &_msg)
+      {
+        this->dataPtr->OnReport(_msg);
+      };
+    this->dataPtr->node.Subscribe(this->dataPtr->reportTopic, cb);
+  }
+
+  // The counters of the last balanced round.
+  LockstepTotals previous;
+  bool balancedBefore = false;
+  LockstepTotals totals;
+  bool haveTotals = false;
+
+  while (true)
+  {
+    // Every process of the group advertises the reports.
+    std::vector<MessagePublisher> publishers;
+    std::vector<MessagePublisher> subscribers;
+    this->dataPtr->node.TopicInfo(this->dataPtr->reportTopic, publishers,
+      subscribers);
+    std::set<std::string> participants{this->dataPtr->pUuid};
+    for (const auto &publisher : publishers)
+      participants.insert(publisher.PUuid());
+
+    msgs::StatisticsGroup probe;
+    {
+      std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+      ++this->dataPtr->round;
+      this->dataPtr->reports.clear();
+      addCounter(probe, "round", this->dataPtr->round);
+    }
+    this->dataPtr->probePub.Publish(probe);
+
+    const auto roundDeadline =
+      std::min(deadline, std::chrono::steady_clock::now() + kRoundTimeout);
+    bool balanced = false;
+    bool complete;
+    {
+      std::unique_lock<std::mutex> lock(this->dataPtr->mutex);
+      auto allReported = [this, &participants]()
+      {
+        for (const auto &participant : participants)
+        {
+          if (this->dataPtr->reports.find(participant) ==
+              this->dataPtr->reports.end())
+          {
+            return false;
+          }
+        }
+        return true;
+      };
+      complete = this->dataPtr->reported.wait_until(lock, roundDeadline,
+        allReported);
+
+      if (complete)
+      {
+        haveTotals = true;
+        this->dataPtr->participants = this->dataPtr->reports.size();
+        balanced = this->dataPtr->Totals(totals) == 0;
+        for (const auto &topic : totals)
+        {
+          auto it = this->dataPtr->forgiven.find(topic.first);
+          const uint64_t forgiven =
+            it == this->dataPtr->forgiven.end() ? 0 : it->second;
+          if (topic.second.first > topic.second.second + forgiven)
+          {
+            balanced = false;
+            break;
+          }
+        }
+      }
+    }
+
+    // A message published between the reports of two processes can be
+    // missed by a round, not by two identical ones.
+    if (balanced && balancedBefore && totals == previous)
+      return true;
+
+    balancedBefore = balanced;
+    if (balanced)
+      previous = totals;
+
+    if (std::chrono::steady_clock::now() >= deadline)
+      break;
+
+    if (complete && !balanced)
+      std::this_thread::sleep_for(kRoundInterval);
+  }
+
+  // The messages still missing are considered lost.
+  if (haveTotals)
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+    for (const auto &topic : totals)
+    {
+      if (topic.second.first > topic.second.second)
+      {
+        this->dataPtr->forgiven[topic.first] =
+          topic.second.first - topic.second.second;
+      }
+    }
+  }
+
+  return false;
+}
+
+//////////////////////////////////////////////////
+bool Lockstep::Step(NetworkClock &_clock,
+    const std::chrono::nanoseconds &_time,
+    const std::chrono::milliseconds &_timeout)
+{
+  _clock.SetTime(_time);
+  return this->WaitForQuiescence(_timeout);
+}
+
+//////////////////////////////////////////////////
+std::size_t Lockstep::Participants() const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  return this->dataPtr->participants;
+}
@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "LockstepTracker.hh"
+
+using namespace gz;
+using namespace transport;
+
+//////////////////////////////////////////////////
+LockstepTracker::LockstepTracker()
+  : inFlight(std::make_shared<std::atomic<int64_t>>(0))
+{
+}
+
+//////////////////////////////////////////////////
+void LockstepTracker::AddTopic(const std::string &_topic)
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  ++this->topics[_topic].refs;
+  this->numTopics = this->topics.size();
+}
+
+//////////////////////////////////////////////////
+void LockstepTracker::RemoveTopic(const std::string &_topic)
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  auto it = this->topics.find(_topic);
+  if (it == this->topics.end())
+    return;
+
+  if (--it->second.refs == 0)
+    this->topics.erase(it);
+  this->numTopics = this->topics.size();
+}
+
+//////////////////////////////////////////////////
+bool LockstepTracker::Tracked(const std::string &_topic) const
+{
+  if (this->numTopics.load(std::memory_order_relaxed) == 0)
+    return false;
+
+  std::lock_guard<std::mutex> lock(this->mutex);
+  return this->topics.find(_topic) != this->topics.end();
+}
+
+//////////////////////////////////////////////////
+void LockstepTracker::Sent(const std::string &_topic,
+    const std::string &_pUuid)
+{
+  if (this->numTopics.load(std::memory_order_relaxed) == 0)
+    return;
+
+  std::lock_guard<std::mutex> lock(this->mutex);
+  auto it = this->topics.find(_topic);
+  if (it != this->topics.end())
+    ++it->second.sent[_pUuid];
+}
+
+//////////////////////////////////////////////////
+std::shared_ptr<void> LockstepTracker::Deliver(const std::string &_topic)
+{
+  if (!this->Tracked(_topic))
+    return nullptr;
+
+  return this->NewToken();
+}
+
+//////////////////////////////////////////////////
+std::shared_ptr<void> LockstepTracker::Receive(const std::string &_topic)
+{
+  if (this->numTopics.load(std::memory_order_relaxed) == 0)
+    return nullptr;
+
+  // The message is counted and in flight at once for the snapshots.
+  std::lock_guard<std::mutex> lock(this->mutex);
+  auto it = this->topics.find(_topic);
+  if (it == this->topics.end())
+    return nullptr;
+
+  ++it->second.received;
+  return this->NewToken();
+}
+
+//////////////////////////////////////////////////
+std::map<std::string, LockstepTracker::Counters>
+  LockstepTracker::Snapshot() const
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  return this->topics;
+}
+
+//////////////////////////////////////////////////
+int64_t LockstepTracker::InFlight() const
+{
+  return this->inFlight->load();
+}
+
+//////////////////////////////////////////////////
+std::shared_ptr<void> LockstepTracker::NewToken()
+{
+  this->inFlight->fetch_add(1);
+  auto counter = this->inFlight;
+  return std::shared_ptr<void>(counter.get(),
+    [counter](void *) {counter->fetch_sub(1);});
+}
@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GZ_TRANSPORT_LOCKSTEPTRACKER_HH_
+#define GZ_TRANSPORT_LOCKSTEPTRACKER_HH_
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "gz/transport/config.hh"
+
+namespace gz
+{
+  namespace transport
+  {
+    inline namespace GZ_TRANSPORT_VERSION_NAMESPACE
+    {
+    /// \internal
+    /// \brief Counters of the messages of the topics in lockstep, see
+    /// Lockstep. For each topic, the process counts the messages sent to
+    /// every remote process and the remote messages received, and the
+    /// deliveries whose callbacks haven't returned yet. A delivery is
+    /// tracked by a token, which the asynchronous callbacks keep until they
+    /// run.
+    ///
+    /// This class is thread-safe.
+    class LockstepTracker
+    {
+      /// \brief The counters of a topic.
+      public: struct Counters
+              {
+                /// \brief Messages sent, by process UUID of the remote
+                /// subscribers.
+                public: std::map<std::string, uint64_t> sent;
+
+                /// \brief Messages received from the remote processes.
+                public: uint64_t received = 0;
+
+                /// \brief Number of AddTopic() calls not matched by a
+                /// RemoveTopic().
+                public: unsigned int refs = 0;
+              };
+
+      /// \brief Constructor.
+      public: LockstepTracker();
+
+      /// \brief Track a topic. A topic can be added several times, it is
+      /// tracked until removed as many times.
+      /// \param[in] _topic Fully qualified topic.
+      public: void AddTopic(const std::string &_topic);
+
+      /// \brief Stop tracking a topic added with AddTopic().
+      /// \param[in] _topic Fully qualified topic.
+      public: void RemoveTopic(const std::string &_topic);
+
+      /// \brief Whether a topic is tracked. It doesn't lock when no topic
+      /// is tracked.
+      /// \param[in] _topic Fully qualified topic.
+      /// \return True if tracked.
+      public: bool Tracked(const std::string &_topic) const;
+
+      /// \brief Count a message sent to a remote process. It must be
+      /// counted before the message is sent.
+      /// \param[in] _topic Fully qualified topic.
+      /// \param[in] _pUuid Process UUID of the remote subscribers.
+      public: void Sent(const std::string &_topic, const std::string &_pUuid);
+
+      /// \brief Track the delivery of a message published in this process.
+      /// \param[in] _topic Fully qualified topic.
+      /// \return The token of the delivery, kept until the callbacks run,
+      /// or null if the topic isn't tracked.
+      public: std::shared_ptr<void> Deliver(const std::string &_topic);
+
+      /// \brief Count a message received from a remote process, and track
+      /// its delivery.
+      /// \param[in] _topic Fully qualified topic.
+      /// \return The token of the delivery, kept until the callbacks run,
+      /// or null if the topic isn't tracked.
+      public: std::shared_ptr<void> Receive(const std::string &_topic);
+
+      /// \brief Get the counters of the tracked topics.
+      /// \return The counters, by fully qualified topic.
+      public: std::map<std::string, Counters> Snapshot() const;
+
+      /// \brief Get the number of deliveries whose callbacks haven't run.
+      /// A message counted in a Snapshot() is in flight until its callbacks
+      /// return, so reading it after the snapshot covers the message.
+      /// \return The number of tokens alive.
+      public: int64_t InFlight() const;
+
+      /// \brief Create a token, incrementing the deliveries in flight.
+      /// \return The token.
+      private: std::shared_ptr<void> NewToken();
+
+      /// \brief Protect the topics.
+      private: mutable std::mutex mutex;
+
+      /// \brief The counters of the tracked topics.
+      private: std::map<std::string, Counters> topics;
+
+      /// \brief Number of topics tracked, read without the mutex.
+      private: std::atomic<std::size_t> numTopics{0};
+
+      /// \brief Deliveries in flight. The tokens share it, so that they
+      /// can outlive the tracker.
+      private: std::shared_ptr<std::atomic<int64_t>> inFlight;
+    };
+    }
+  }
+}
+#endif
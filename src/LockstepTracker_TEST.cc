@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <memory>
+#include <string>
+
+#include "LockstepTracker.hh"
+#include "gtest/gtest.h"
+
+using namespace gz;
+using namespace transport;
+
+//////////////////////////////////////////////////
+/// \brief Only the tracked topics are counted.
+TEST(LockstepTrackerTest, Counters)
+{
+  LockstepTracker tracker;
+  const std::string topic = "@@/foo";
+  EXPECT_FALSE(tracker.Tracked(topic));
+  EXPECT_EQ(nullptr, tracker.Deliver(topic));
+  EXPECT_EQ(nullptr, tracker.Receive(topic));
+  tracker.Sent(topic, "p1");
+  EXPECT_TRUE(tracker.Snapshot().empty());
+
+  tracker.AddTopic(topic);
+  EXPECT_TRUE(tracker.Tracked(topic));
+  EXPECT_FALSE(tracker.Tracked("@@/bar"));
+  tracker.Sent(topic, "p1");
+  tracker.Sent(topic, "p1");
+  tracker.Sent(topic, "p2");
+  tracker.Sent("@@/bar", "p1");
+
+  auto counters = tracker.Snapshot();
+  ASSERT_EQ(1u, counters.size());
+  EXPECT_EQ(2u, counters[topic].sent["p1"]);
+  EXPECT_EQ(1u, counters[topic].sent["p2"]);
+  EXPECT_EQ(0u, counters[topic].received);
+
+  // A topic added twice is tracked until removed twice.
+  tracker.AddTopic(topic);
+  tracker.RemoveTopic(topic);
+  EXPECT_TRUE(tracker.Tracked(topic));
+  tracker.RemoveTopic(topic);
+  EXPECT_FALSE(tracker.Tracked(topic));
+  EXPECT_TRUE(tracker.Snapshot().empty());
+  tracker.RemoveTopic(topic);
+}
+
+//////////////////////////////////////////////////
+/// \brief The deliveries are in flight until their tokens are released.
+TEST(LockstepTrackerTest, InFlight)
+{
+  std::shared_ptr<void> outlived;
+  {
+    LockstepTracker tracker;
+    const std::string topic = "@@/foo";
+    tracker.AddTopic(topic);
+    EXPECT_EQ(0, tracker.InFlight());
+
+    std::shared_ptr<void> local = tracker.Deliver(topic);
+    ASSERT_NE(nullptr, local);
+    EXPECT_EQ(1, tracker.InFlight());
+    EXPECT_EQ(0u, tracker.Snapshot()[topic].received);
+
+    std::shared_ptr<void> remote = tracker.Receive(topic);
+    ASSERT_NE(nullptr, remote);
+    EXPECT_EQ(2, tracker.InFlight());
+    EXPECT_EQ(1u, tracker.Snapshot()[topic].received);
+
+    // The copies of a token are a single delivery.
+    std::shared_ptr<void> copy = remote;
+    remote.reset();
+    EXPECT_EQ(2, tracker.InFlight());
+    copy.reset();
+    local.reset();
+    EXPECT_EQ(0, tracker.InFlight());
+
+    // A token can outlive the tracker.
+    outlived = tracker.Deliver(topic);
+  }
+  outlived.reset();
+}
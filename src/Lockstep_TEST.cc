@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gz/msgs/int32.pb.h>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include "gz/transport/Lockstep.hh"
+#include "gz/transport/Node.hh"
+#include "gz/transport/NodeOptions.hh"
+
+#include "gtest/gtest.h"
+#include "test_utils.hh"
+
+using namespace gz;
+using namespace transport;
+
+//////////////////////////////////////////////////
+/// \brief Check the misuses of the API.
+TEST(LockstepTest, Api)
+{
+  Lockstep lockstep;
+  EXPECT_TRUE(lockstep.AddTopic("/foo"));
+  EXPECT_FALSE(lockstep.AddTopic("/foo"));
+  EXPECT_FALSE(lockstep.AddTopic("////"));
+  ASSERT_EQ(1u, lockstep.Topics().size());
+  EXPECT_EQ("/foo", lockstep.Topics()[0]);
+  EXPECT_EQ(0u, lockstep.Participants());
+
+  Lockstep invalid("////");
+  EXPECT_FALSE(invalid.WaitForQuiescence(std::chrono::milliseconds(10)));
+}
+
+//////////////////////////////////////////////////
+/// \brief The barrier waits for the callbacks, and for the messages they
+/// publish.
+TEST(LockstepTest, WaitForCallbacks)
+{
+  NodeOptions options;
+  options.SetPartition("lockstep_" + testing::getRandomNumber());
+
+  Lockstep lockstep("/lockstep", options);
+  ASSERT_TRUE(lockstep.AddTopic("/a"));
+  ASSERT_TRUE(lockstep.AddTopic("/b"));
+
+  Node node(options);
+  auto pubA = node.Advertise<msgs::Int32>("/a");
+  auto pubB = node.Advertise<msgs::Int32>("/b");
+  ASSERT_TRUE(pubA);
+  ASSERT_TRUE(pubB);
+
+  std::atomic<int> done{0};
+  std::function<void(const msgs::Int32 &)> cbA =
+    [&pubB](const msgs::Int32 &_msg)
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      pubB.Publish(_msg);
+    };
+  std::function<void(const msgs::Int32 &)> cbB =
+    [&done](const msgs::Int32 &)
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      ++done;
+    };
+  ASSERT_TRUE(node.Subscribe("/a", cbA));
+  ASSERT_TRUE(node.Subscribe("/b", cbB));
+
+  // Nothing is in flight.
+  EXPECT_TRUE(lockstep.WaitForQuiescence(std::chrono::seconds(5)));
+  EXPECT_EQ(1u, lockstep.Participants());
+
+  for (int step = 1; step <= 3; ++step)
+  {
+    msgs::Int32 msg;
+    msg.set_data(step);
+    EXPECT_TRUE(pubA.Publish(msg));
+    EXPECT_TRUE(lockstep.WaitForQuiescence(std::chrono::seconds(5)));
+    EXPECT_EQ(step, done);
+  }
+}
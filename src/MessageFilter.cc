@@ -0,0 +1,818 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable: 4251)
+#endif
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/message.h>
+#include <google/protobuf/wire_format_lite.h>
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "gz/transport/MessageFilter.hh"
+
+using namespace gz;
+using namespace transport;
+
+using google::protobuf::Descriptor;
+using google::protobuf::DescriptorPool;
+using google::protobuf::FieldDescriptor;
+using google::protobuf::Reflection;
+using google::protobuf::io::CodedInputStream;
+using google::protobuf::internal::WireFormatLite;
+
+namespace
+{
+  /// \brief A condition as given by the user.
+  struct Condition
+  {
+    /// \brief Names of the fields, separated by dots.
+    std::string path;
+
+    /// \brief Expected value, as text.
+    std::string value;
+  };
+
+  /// \brief A condition resolved for a message type.
+  struct ResolvedCondition
+  {
+    /// \brief The fields of the path. Empty if the path doesn't exist in
+    /// the message type or if the value can't be converted to the type of
+    /// the field, the condition is then never satisfied.
+    std::vector<const FieldDescriptor *> fields;
+
+    /// \brief Whether the condition is satisfied by a message without the
+    /// field, for each depth of the path.
+    std::vector<bool> absentMatch;
+
+    /// \brief Expected value of a signed integer or enum field.
+    int64_t intValue = 0;
+
+    /// \brief Expected value of an unsigned integer field.
+    uint64_t uintValue = 0;
+
+    /// \brief Expected value of a floating point field.
+    double doubleValue = 0.0;
+
+    /// \brief Expected value of a boolean field.
+    bool boolValue = false;
+
+    /// \brief Expected value of a string or bytes field.
+    std::string stringValue;
+  };
+
+  /// \brief The conditions resolved for a message type.
+  using ResolvedConditions = std::vector<ResolvedCondition>;
+
+  //////////////////////////////////////////////////
+  /// \brief Check the syntax of a field path.
+  /// \param[in] _path The path.
+  /// \return True if the path is made of non-empty names separated by dots.
+  bool ValidPath(const std::string &_path)
+  {
+    if (_path.empty() || _path.front() == '.' || _path.back() == '.' ||
+        _path.find("..") != std::string::npos ||
+        _path.find_first_of("=&\\") != std::string::npos)
+    {
+      return false;
+    }
+    return true;
+  }
+
+  //////////////////////////////////////////////////
+  /// \brief Parse a whole string as a signed integer.
+  /// \param[in] _str The string.
+  /// \param[out] _value The integer.
+  /// \return True on success.
+  bool ParseInt(const std::string &_str, int64_t &_value)
+  {
+    if (_str.empty())
+      return false;
+    char *end = nullptr;
+    errno = 0;
+    _value = std::strtoll(_str.c_str(), &end, 10);
+    return errno == 0 && *end == '\0';
+  }
+
+  //////////////////////////////////////////////////
+  /// \brief Parse a whole string as an unsigned integer.
+  /// \param[in] _str The string.
+  /// \param[out] _value The integer.
+  /// \return True on success.
+  bool ParseUInt(const std::string &_str, uint64_t &_value)
+  {
+    if (_str.empty() || _str.front() == '-')
+      return false;
+    char *end = nullptr;
+    errno = 0;
+    _value = std::strtoull(_str.c_str(), &end, 10);
+    return errno == 0 && *end == '\0';
+  }
+
+  //////////////////////////////////////////////////
+  /// \brief Convert the expected value of a condition to the type of its
+  /// field.
+  /// \param[in] _field The field compared by the condition.
+  /// \param[in] _value The expected value, as text.
+  /// \param[in,out] _cond The condition.
+  /// \return False if the value can't be converted.
+  bool ParseValue(const FieldDescriptor *_field, const std::string &_value,
+                  ResolvedCondition &_cond)
+  {
+    switch (_field->cpp_type())
+    {
+      case FieldDescriptor::CPPTYPE_INT32:
+      case FieldDescriptor::CPPTYPE_INT64:
+        return ParseInt(_value, _cond.intValue);
+      case FieldDescriptor::CPPTYPE_UINT32:
+      case FieldDescriptor::CPPTYPE_UINT64:
+        return ParseUInt(_value, _cond.uintValue);
+      case FieldDescriptor::CPPTYPE_DOUBLE:
+      case FieldDescriptor::CPPTYPE_FLOAT:
+      {
+        if (_value.empty())
+          return false;
+        char *end = nullptr;
+        _cond.doubleValue = std::strtod(_value.c_str(), &end);
+        return *end == '\0';
+      }
+      case FieldDescriptor::CPPTYPE_BOOL:
+        if (_value == "true" || _value == "1")
+          _cond.boolValue = true;
+        else if (_value == "false" || _value == "0")
+          _cond.boolValue = false;
+        else
+          return false;
+        return true;
+      case FieldDescriptor::CPPTYPE_ENUM:
+      {
+        auto enumValue = _field->enum_type()->FindValueByName(_value);
+        if (enumValue)
+        {
+          _cond.intValue = enumValue->number();
+          return true;
+        }
+        return ParseInt(_value, _cond.intValue);
+      }
+      case FieldDescriptor::CPPTYPE_STRING:
+        _cond.stringValue = _value;
+        return true;
+      default:
+        return false;
+    }
+  }
+
+  //////////////////////////////////////////////////
+  /// \brief Compare the default value of a field to the expected value.
+  /// \param[in] _field The field.
+  /// \param[in] _cond The condition.
+  /// \return True if the default value satisfies the condition.
+  bool DefaultMatch(const FieldDescriptor *_field,
+                    const ResolvedCondition &_cond)
+  {
+    switch (_field->cpp_type())
+    {
+      case FieldDescriptor::CPPTYPE_INT32:
+        return _field->default_value_int32() == _cond.intValue;
+      case FieldDescriptor::CPPTYPE_INT64:
+        return _field->default_value_int64() == _cond.intValue;
+      case FieldDescriptor::CPPTYPE_UINT32:
+        return _field->default_value_uint32() == _cond.uintValue;
+      case FieldDescriptor::CPPTYPE_UINT64:
+        return _field->default_value_uint64() == _cond.uintValue;
+      case FieldDescriptor::CPPTYPE_DOUBLE:
+        return _field->default_value_double() == _cond.doubleValue;
+      case FieldDescriptor::CPPTYPE_FLOAT:
+        return _field->default_value_float() ==
+          static_cast<float>(_cond.doubleValue);
+      case FieldDescriptor::CPPTYPE_BOOL:
+        return _field->default_value_bool() == _cond.boolValue;
+      case FieldDescriptor::CPPTYPE_ENUM:
+        return _field->default_value_enum()->number() == _cond.intValue;
+      case FieldDescriptor::CPPTYPE_STRING:
+        return _field->default_value_string() == _cond.stringValue;
+      default:
+        return false;
+    }
+  }
+
+  //////////////////////////////////////////////////
+  /// \brief Resolve a condition for a message type.
+  /// \param[in] _desc The message type.
+  /// \param[in] _cond The condition.
+  /// \return The resolved condition, without fields on error.
+  ResolvedCondition Resolve(const Descriptor *_desc, const Condition &_cond)
+  {
+    ResolvedCondition resolved;
+
+    const Descriptor *desc = _desc;
+    std::size_t start = 0;
+    while (true)
+    {
+      const std::size_t end = _cond.path.find('.', start);
+      const std::string name = _cond.path.substr(start,
+        end == std::string::npos ? std::string::npos : end - start);
+
+      const FieldDescriptor *field = desc ?
+        desc->FindFieldByName(name) : nullptr;
+      if (!field)
+      {
+        std::cerr << "MessageFilter: no field [" << _cond.path
+                  << "] in message type [" << _desc->full_name() << "]"
+                  << std::endl;
+        resolved.fields.clear();
+        return resolved;
+      }
+      resolved.fields.push_back(field);
+
+      if (end == std::string::npos)
+        break;
+
+      desc = field->cpp_type() == FieldDescriptor::CPPTYPE_MESSAGE ?
+        field->message_type() : nullptr;
+      start = end + 1;
+    }
+
+    const FieldDescriptor *leaf = resolved.fields.back();
+    if (!ParseValue(leaf, _cond.value, resolved))
+    {
+      std::cerr << "MessageFilter: invalid value [" << _cond.value
+                << "] for field [" << _cond.path << "] of message type ["
+                << _desc->full_name() << "]" << std::endl;
+      resolved.fields.clear();
+      return resolved;
+    }
+
+    // A missing field has its default value, unless a field of the
+    // remaining path is repeated: an empty list has no element to match.
+    resolved.absentMatch.resize(resolved.fields.size());
+    bool match = !leaf->is_repeated() && DefaultMatch(leaf, resolved);
+    for (std::size_t i = resolved.fields.size(); i-- > 0;)
+    {
+      match = match && !resolved.fields[i]->is_repeated();
+      resolved.absentMatch[i] = match;
+    }
+
+    return resolved;
+  }
+
+  //////////////////////////////////////////////////
+  /// \brief Read a scalar value of a serialized message and compare it to
+  /// the expected value.
+  /// \param[in] _input The serialized message, positioned on the value.
+  /// \param[in] _field The field of the value.
+  /// \param[in] _cond The condition.
+  /// \param[out] _match Whether the value satisfies the condition.
+  /// \return False if the message is malformed.
+  bool ReadAndMatch(CodedInputStream &_input, const FieldDescriptor *_field,
+                    const ResolvedCondition &_cond, bool &_match)
+  {
+    uint64_t varint;
+    uint32_t fixed32;
+    uint64_t fixed64;
+
+    switch (_field->type())
+    {
+      case FieldDescriptor::TYPE_INT32:
+      case FieldDescriptor::TYPE_ENUM:
+        if (!_input.ReadVarint64(&varint))
+          return false;
+        _match = static_cast<int32_t>(varint) == _cond.intValue;
+        return true;
+      case FieldDescriptor::TYPE_INT64:
+        if (!_input.ReadVarint64(&varint))
+          return false;
+        _match = static_cast<int64_t>(varint) == _cond.intValue;
+        return true;
+      case FieldDescriptor::TYPE_SINT32:
+        if (!_input.ReadVarint64(&varint))
+          return false;
+        _match = WireFormatLite::ZigZagDecode32(
+          static_cast<uint32_t>(varint)) == _cond.intValue;
+        return true;
+      case FieldDescriptor::TYPE_SINT64:
+        if (!_input.ReadVarint64(&varint))
+          return false;
+        _match = WireFormatLite::ZigZagDecode64(varint) == _cond.intValue;
+        return true;
+      case FieldDescriptor::TYPE_UINT32:
+        if (!_input.ReadVarint64(&varint))
+          return false;
+        _match = static_cast<uint32_t>(varint) == _cond.uintValue;
+        return true;
+      case FieldDescriptor::TYPE_UINT64:
+        if (!_input.ReadVarint64(&varint))
+          return false;
+        _match = varint == _cond.uintValue;
+        return true;
+      case FieldDescriptor::TYPE_BOOL:
+        if (!_input.ReadVarint64(&varint))
+          return false;
+        _match = (varint != 0) == _cond.boolValue;
+        return true;
+      case FieldDescriptor::TYPE_FIXED32:
+        if (!_input.ReadLittleEndian32(&fixed32))
+          return false;
+        _match = fixed32 == _cond.uintValue;
+        return true;
+      case FieldDescriptor::TYPE_SFIXED32:
+        if (!_input.ReadLittleEndian32(&fixed32))
+          return false;
+        _match = static_cast<int32_t>(fixed32) == _cond.intValue;
+        return true;
+      case FieldDescriptor::TYPE_FLOAT:
+      {
+        if (!_input.ReadLittleEndian32(&fixed32))
+          return false;
+        float value;
+        std::memcpy(&value, &fixed32, sizeof(value));
+        _match = value == static_cast<float>(_cond.doubleValue);
+        return true;
+      }
+      case FieldDescriptor::TYPE_FIXED64:
+        if (!_input.ReadLittleEndian64(&fixed64))
+          return false;
+        _match = fixed64 == _cond.uintValue;
+        return true;
+      case FieldDescriptor::TYPE_SFIXED64:
+        if (!_input.ReadLittleEndian64(&fixed64))
+          return false;
+        _match = static_cast<int64_t>(fixed64) == _cond.intValue;
+        return true;
+      case FieldDescriptor::TYPE_DOUBLE:
+      {
+        if (!_input.ReadLittleEndian64(&fixed64))
+          return false;
+        double value;
+        std::memcpy(&value, &fixed64, sizeof(value));
+        _match = value == _cond.doubleValue;
+        return true;
+      }
+      case FieldDescriptor::TYPE_STRING:
+      case FieldDescriptor::TYPE_BYTES:
+      {
+        uint32_t length;
+        if (!_input.ReadVarint32(&length))
+          return false;
+        // Don't copy a string that can't match.
+        if (length != _cond.stringValue.size())
+        {
+          _match = false;
+          return _input.Skip(static_cast<int>(length));
+        }
+        std::string value;
+        if (!_input.ReadString(&value, static_cast<int>(length)))
+          return false;
+        _match = value == _cond.stringValue;
+        return true;
+      }
+      default:
+        return false;
+    }
+  }
+
+  //////////////////////////////////////////////////
+  /// \brief Evaluate the end of the path of a condition on a serialized
+  /// message.
+  /// \param[in] _input The serialized message, limited to the message of
+  /// the depth.
+  /// \param[in] _cond The condition.
+  /// \param[in] _depth Index of the field of the path in this message.
+  /// \param[out] _match Whether the message satisfies the condition.
+  /// \return False if the message is malformed.
+  bool Eval(CodedInputStream &_input, const ResolvedCondition &_cond,
+            const std::size_t _depth, bool &_match)
+  {
+    const FieldDescriptor *field = _cond.fields[_depth];
+    const bool leaf = _depth + 1 == _cond.fields.size();
+    const auto wireType = WireFormatLite::WireTypeForFieldType(
+      static_cast<WireFormatLite::FieldType>(field->type()));
+
+    bool seen = false;
+    bool any = false;
+    bool last = false;
+
+    while (true)
+    {
+      const uint32_t tag = _input.ReadTag();
+      if (tag == 0)
+        break;
+
+      if (static_cast<int>(WireFormatLite::GetTagFieldNumber(tag)) !=
+          field->number())
+      {
+        if (!WireFormatLite::SkipField(&_input, tag))
+          return false;
+        continue;
+      }
+
+      const auto tagWireType = WireFormatLite::GetTagWireType(tag);
+      bool match = false;
+
+      if (!leaf)
+      {
+        if (tagWireType != WireFormatLite::WIRETYPE_LENGTH_DELIMITED)
+          return false;
+        uint32_t length;
+        if (!_input.ReadVarint32(&length))
+          return false;
+        auto limit = _input.PushLimit(static_cast<int>(length));
+        if (!Eval(_input, _cond, _depth + 1, match))
+          return false;
+        _input.PopLimit(limit);
+        any = any || match;
+        last = match;
+        seen = true;
+      }
+      else if (tagWireType == wireType)
+      {
+        if (!ReadAndMatch(_input, field, _cond, match))
+          return false;
+        any = any || match;
+        last = match;
+        seen = true;
+      }
+      else if (field->is_repeated() &&
+               tagWireType == WireFormatLite::WIRETYPE_LENGTH_DELIMITED)
+      {
+        // Packed repeated scalars.
+        uint32_t length;
+        if (!_input.ReadVarint32(&length))
+          return false;
+        auto limit = _input.PushLimit(static_cast<int>(length));
+        while (_input.BytesUntilLimit() > 0)
+        {
+          if (!ReadAndMatch(_input, field, _cond, match))
+            return false;
+          any = any || match;
+          seen = true;
+        }
+        _input.PopLimit(limit);
+      }
+      else if (!WireFormatLite::SkipField(&_input, tag))
+      {
+        return false;
+      }
+    }
+
+    // The last occurrence of a singular field overrides the previous ones.
+    if (field->is_repeated())
+      _match = any;
+    else if (seen)
+      _match = last;
+    else
+      _match = _cond.absentMatch[_depth];
+    return true;
+  }
+
+  //////////////////////////////////////////////////
+  /// \brief Compare a value of a message to the expected value.
+  /// \param[in] _msg The message.
+  /// \param[in] _field The field of the value.
+  /// \param[in] _index Index of the value in a repeated field, ignored for
+  /// a singular field.
+  /// \param[in] _cond The condition.
+  /// \return True if the value satisfies the condition.
+  bool MatchValue(const ProtoMsg &_msg, const FieldDescriptor *_field,
+                  const int _index, const ResolvedCondition &_cond)
+  {
+    const Reflection *refl = _msg.GetReflection();
+    const bool rep = _field->is_repeated();
+
+    switch (_field->cpp_type())
+    {
+      case FieldDescriptor::CPPTYPE_INT32:
+        return (rep ? refl->GetRepeatedInt32(_msg, _field, _index) :
+          refl->GetInt32(_msg, _field)) == _cond.intValue;
+      case FieldDescriptor::CPPTYPE_INT64:
+        return (rep ? refl->GetRepeatedInt64(_msg, _field, _index) :
+          refl->GetInt64(_msg, _field)) == _cond.intValue;
+      case FieldDescriptor::CPPTYPE_UINT32:
+        return (rep ? refl->GetRepeatedUInt32(_msg, _field, _index) :
+          refl->GetUInt32(_msg, _field)) == _cond.uintValue;
+      case FieldDescriptor::CPPTYPE_UINT64:
+        return (rep ? refl->GetRepeatedUInt64(_msg, _field, _index) :
+          refl->GetUInt64(_msg, _field)) == _cond.uintValue;
+      case FieldDescriptor::CPPTYPE_DOUBLE:
+        return (rep ? refl->GetRepeatedDouble(_msg, _field, _index) :
+          refl->GetDouble(_msg, _field)) == _cond.doubleValue;
+      case FieldDescriptor::CPPTYPE_FLOAT:
+        return (rep ? refl->GetRepeatedFloat(_msg, _field, _index) :
+          refl->GetFloat(_msg, _field)) ==
+          static_cast<float>(_cond.doubleValue);
+      case FieldDescriptor::CPPTYPE_BOOL:
+        return (rep ? refl->GetRepeatedBool(_msg, _field, _index) :
+          refl->GetBool(_msg, _field)) == _cond.boolValue;
+      case FieldDescriptor::CPPTYPE_ENUM:
+        return (rep ? refl->GetRepeatedEnumValue(_msg, _field, _index) :
+          refl->GetEnumValue(_msg, _field)) == _cond.intValue;
+      case FieldDescriptor::CPPTYPE_STRING:
+      {
+        std::string scratch;
+        const std::string &value = rep ?
+          refl->GetRepeatedStringReference(_msg, _field, _index, &scratch) :
+          refl->GetStringReference(_msg, _field, &scratch);
+        return value == _cond.stringValue;
+      }
+      default:
+        return false;
+    }
+  }
+
+  //////////////////////////////////////////////////
+  /// \brief Evaluate the end of the path of a condition on a message.
+  /// \param[in] _msg The message of the depth.
+  /// \param[in] _cond The condition.
+  /// \param[in] _depth Index of the field of the path in this message.
+  /// \return True if the message satisfies the condition.
+  bool Eval(const ProtoMsg &_msg, const ResolvedCondition &_cond,
+            const std::size_t _depth)
+  {
+    const FieldDescriptor *field = _cond.fields[_depth];
+    const bool leaf = _depth + 1 == _cond.fields.size();
+    const Reflection *refl = _msg.GetReflection();
+
+    if (!field->is_repeated())
+    {
+      if (leaf)
+        return MatchValue(_msg, field, -1, _cond);
+      return Eval(refl->GetMessage(_msg, field), _cond, _depth + 1);
+    }
+
+    const int size = refl->FieldSize(_msg, field);
+    for (int i = 0; i < size; ++i)
+    {
+      if (leaf ? MatchValue(_msg, field, i, _cond) :
+          Eval(refl->GetRepeatedMessage(_msg, field, i), _cond, _depth + 1))
+      {
+        return true;
+      }
+    }
+    return false;
+  }
+}
+
+namespace gz
+{
+  namespace transport
+  {
+    inline namespace GZ_TRANSPORT_VERSION_NAMESPACE
+    {
+    /// \internal
+    /// \brief Private data for MessageFilter class.
+    class MessageFilterPrivate
+    {
+      /// \brief Get the conditions resolved for a message type.
+      /// \param[in] _msgType Fully qualified name of the type.
+      /// \param[in] _desc Descriptor of the type, or nullptr to look it up
+      /// in the generated pool.
+      /// \return The resolved conditions, or nullptr if the type is unknown.
+      public: std::shared_ptr<const ResolvedConditions> Resolved(
+        const std::string &_msgType, const Descriptor *_desc)
+      {
+        std::lock_guard<std::mutex> lk(this->mutex);
+        auto it = this->resolved.find(_msgType);
+        if (it != this->resolved.end())
+          return it->second;
+
+        if (!_desc)
+        {
+          _desc = DescriptorPool::generated_pool()->FindMessageTypeByName(
+            _msgType);
+        }
+
+        std::shared_ptr<ResolvedConditions> conds;
+        if (_desc)
+        {
+          conds = std::make_shared<ResolvedConditions>();
+          for (const Condition &cond : this->conditions)
+            conds->push_back(Resolve(_desc, cond));
+        }
+        this->resolved[_msgType] = conds;
+        return conds;
+      }
+
+      /// \brief The conditions.
+      public: std::vector<Condition> conditions;
+
+      /// \brief Protects the resolved conditions.
+      public: std::mutex mutex;
+
+      /// \brief Conditions resolved by message type, nullptr for an unknown
+      /// type.
+      public: std::unordered_map<std::string,
+        std::shared_ptr<const ResolvedConditions>> resolved;
+    };
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+MessageFilter::MessageFilter()
+  : dataPtr(new MessageFilterPrivate())
+{
+}
+
+//////////////////////////////////////////////////
+MessageFilter::MessageFilter(const MessageFilter &_other)
+  : dataPtr(new MessageFilterPrivate())
+{
+  this->dataPtr->conditions = _other.dataPtr->conditions;
+}
+
+//////////////////////////////////////////////////
+MessageFilter::~MessageFilter()
+{
+}
+
+//////////////////////////////////////////////////
+MessageFilter &MessageFilter::operator=(const MessageFilter &_other)
+{
+  if (this == &_other)
+    return *this;
+
+  std::lock_guard<std::mutex> lk(this->dataPtr->mutex);
+  this->dataPtr->conditions = _other.dataPtr->conditions;
+  this->dataPtr->resolved.clear();
+  return *this;
+}
+
+//////////////////////////////////////////////////
+bool MessageFilter::operator==(const MessageFilter &_other) const
+{
+  return this->ToString() == _other.ToString();
+}
+
+//////////////////////////////////////////////////
+bool MessageFilter::operator!=(const MessageFilter &_other) const
+{
+  return !(*this == _other);
+}
+
+//////////////////////////////////////////////////
+bool MessageFilter::AddCondition(const std::string &_fieldPath,
+  const std::string &_value)
+{
+  if (!ValidPath(_fieldPath))
+  {
+    std::cerr << "MessageFilter: invalid field path [" << _fieldPath << "]"
+              << std::endl;
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lk(this->dataPtr->mutex);
+  this->dataPtr->conditions.push_back({_fieldPath, _value});
+  this->dataPtr->resolved.clear();
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool MessageFilter::Empty() const
+{
+  return this->dataPtr->conditions.empty();
+}
+
+//////////////////////////////////////////////////
+bool MessageFilter::Match(const ProtoMsg &_msg) const
+{
+  if (this->Empty())
+    return true;
+
+  const Descriptor *desc = _msg.GetDescriptor();
+  auto conds = this->dataPtr->Resolved(desc->full_name(), desc);
+
+  for (const ResolvedCondition &cond : *conds)
+  {
+    if (cond.fields.empty() || !Eval(_msg, cond, 0))
+      return false;
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool MessageFilter::Match(const char *_data, const std::size_t _size,
+  const std::string &_msgType) const
+{
+  if (this->Empty())
+    return true;
+
+  auto conds = this->dataPtr->Resolved(_msgType, nullptr);
+  if (!conds)
+    return true;
+
+  for (const ResolvedCondition &cond : *conds)
+  {
+    if (cond.fields.empty())
+      return false;
+
+    CodedInputStream input(reinterpret_cast<const uint8_t *>(_data),
+      static_cast<int>(_size));
+    bool match = false;
+    if (!Eval(input, cond, 0, match) || !match)
+      return false;
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+std::string MessageFilter::ToString() const
+{
+  std::string str;
+  for (const Condition &cond : this->dataPtr->conditions)
+  {
+    if (!str.empty())
+      str += '&';
+    str += cond.path;
+    str += '=';
+    for (const char c : cond.value)
+    {
+      if (c == '&' || c == '\\')
+        str += '\\';
+      str += c;
+    }
+  }
+  return str;
+}
+
+//////////////////////////////////////////////////
+bool MessageFilter::Parse(const std::string &_str)
+{
+  std::vector<Condition> conditions;
+
+  std::string current;
+  bool escaped = false;
+  std::size_t valueStart = std::string::npos;
+  auto addCondition = [&]()
+  {
+    if (valueStart == std::string::npos)
+      return false;
+    Condition cond;
+    cond.path = current.substr(0, valueStart);
+    cond.value = current.substr(valueStart);
+    if (!ValidPath(cond.path))
+      return false;
+    conditions.push_back(cond);
+    current.clear();
+    valueStart = std::string::npos;
+    return true;
+  };
+
+  bool ok = true;
+  for (const char c : _str)
+  {
+    if (escaped)
+    {
+      current += c;
+      escaped = false;
+    }
+    else if (c == '\\')
+      escaped = true;
+    else if (c == '&')
+      ok = ok && addCondition();
+    else if (c == '=' && valueStart == std::string::npos)
+      valueStart = current.size();
+    else
+      current += c;
+  }
+  if (!_str.empty())
+    ok = ok && !escaped && addCondition();
+
+  std::lock_guard<std::mutex> lk(this->dataPtr->mutex);
+  this->dataPtr->resolved.clear();
+  if (!ok)
+  {
+    this->dataPtr->conditions.clear();
+    return false;
+  }
+  this->dataPtr->conditions = std::move(conditions);
+  return true;
+}
@@ -0,0 +1,200 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gz/msgs/boolean.pb.h>
+#include <gz/msgs/double.pb.h>
+#include <gz/msgs/int32.pb.h>
+#include <gz/msgs/int32_v.pb.h>
+#include <gz/msgs/stringmsg_v.pb.h>
+
+#include <string>
+
+#include "gz/transport/MessageFilter.hh"
+#include "gtest/gtest.h"
+
+using namespace gz;
+using namespace transport;
+
+//////////////////////////////////////////////////
+/// \brief Check a filter on both the message and the serialized message.
+/// \param[in] _filter The filter.
+/// \param[in] _msg The message.
+/// \return True if both agree that the message matches the filter.
+bool matchBoth(const MessageFilter &_filter, const ProtoMsg &_msg)
+{
+  const std::string data = _msg.SerializeAsString();
+  const bool match = _filter.Match(_msg);
+  EXPECT_EQ(match, _filter.Match(data.data(), data.size(),
+    _msg.GetDescriptor()->full_name()));
+  return match;
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the conditions on scalar fields.
+TEST(MessageFilterTest, Scalars)
+{
+  MessageFilter filter;
+  EXPECT_TRUE(filter.Empty());
+
+  msgs::Int32 msg;
+  msg.set_data(5);
+  EXPECT_TRUE(matchBoth(filter, msg));
+
+  EXPECT_TRUE(filter.AddCondition("data", "5"));
+  EXPECT_FALSE(filter.Empty());
+  EXPECT_TRUE(matchBoth(filter, msg));
+  msg.set_data(-5);
+  EXPECT_FALSE(matchBoth(filter, msg));
+
+  // A missing field has its default value.
+  MessageFilter zero;
+  EXPECT_TRUE(zero.AddCondition("data", "0"));
+  msg.clear_data();
+  EXPECT_TRUE(matchBoth(zero, msg));
+
+  MessageFilter negative;
+  EXPECT_TRUE(negative.AddCondition("data", "-5"));
+  msg.set_data(-5);
+  EXPECT_TRUE(matchBoth(negative, msg));
+
+  msgs::Double dbl;
+  dbl.set_data(0.25);
+  MessageFilter dblFilter;
+  EXPECT_TRUE(dblFilter.AddCondition("data", "0.25"));
+  EXPECT_TRUE(matchBoth(dblFilter, dbl));
+  dbl.set_data(0.5);
+  EXPECT_FALSE(matchBoth(dblFilter, dbl));
+
+  msgs::Boolean boolean;
+  boolean.set_data(true);
+  MessageFilter boolFilter;
+  EXPECT_TRUE(boolFilter.AddCondition("data", "true"));
+  EXPECT_TRUE(matchBoth(boolFilter, boolean));
+  boolean.set_data(false);
+  EXPECT_FALSE(matchBoth(boolFilter, boolean));
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the conditions on nested and repeated fields.
+TEST(MessageFilterTest, Paths)
+{
+  msgs::Int32 msg;
+  msg.set_data(1);
+  msg.mutable_header()->mutable_stamp()->set_sec(3);
+  auto *frame = msg.mutable_header()->add_data();
+  frame->set_key("frame_id");
+  frame->add_value("base_link");
+
+  MessageFilter filter;
+  EXPECT_TRUE(filter.AddCondition("header.stamp.sec", "3"));
+  EXPECT_TRUE(filter.AddCondition("header.data.value", "base_link"));
+  EXPECT_TRUE(matchBoth(filter, msg));
+
+  // All the conditions must be satisfied.
+  msg.mutable_header()->mutable_stamp()->set_sec(4);
+  EXPECT_FALSE(matchBoth(filter, msg));
+  msg.mutable_header()->mutable_stamp()->set_sec(3);
+
+  // One element of a repeated field is enough.
+  frame->set_value(0, "odom");
+  EXPECT_FALSE(matchBoth(filter, msg));
+  frame->add_value("base_link");
+  EXPECT_TRUE(matchBoth(filter, msg));
+
+  // An empty repeated field never matches.
+  msg.mutable_header()->clear_data();
+  EXPECT_FALSE(matchBoth(filter, msg));
+
+  // Packed repeated scalars.
+  msgs::Int32_V vec;
+  vec.add_data(1);
+  vec.add_data(2);
+  MessageFilter vecFilter;
+  EXPECT_TRUE(vecFilter.AddCondition("data", "2"));
+  EXPECT_TRUE(matchBoth(vecFilter, vec));
+  vec.set_data(1, 3);
+  EXPECT_FALSE(matchBoth(vecFilter, vec));
+
+  msgs::StringMsg_V strings;
+  strings.add_data("a");
+  strings.add_data("b");
+  MessageFilter strFilter;
+  EXPECT_TRUE(strFilter.AddCondition("data", "b"));
+  EXPECT_TRUE(matchBoth(strFilter, strings));
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the invalid conditions.
+TEST(MessageFilterTest, Invalid)
+{
+  MessageFilter filter;
+  EXPECT_FALSE(filter.AddCondition("", "1"));
+  EXPECT_FALSE(filter.AddCondition("header..stamp", "1"));
+  EXPECT_FALSE(filter.AddCondition(".data", "1"));
+  EXPECT_FALSE(filter.AddCondition("da=ta", "1"));
+  EXPECT_TRUE(filter.Empty());
+
+  msgs::Int32 msg;
+  msg.set_data(1);
+
+  // A field missing from the type or a value of the wrong type never
+  // matches.
+  MessageFilter missing;
+  EXPECT_TRUE(missing.AddCondition("nope", "1"));
+  EXPECT_FALSE(matchBoth(missing, msg));
+
+  MessageFilter wrongValue;
+  EXPECT_TRUE(wrongValue.AddCondition("data", "one"));
+  EXPECT_FALSE(matchBoth(wrongValue, msg));
+
+  MessageFilter message;
+  EXPECT_TRUE(message.AddCondition("header", "1"));
+  EXPECT_FALSE(matchBoth(message, msg));
+
+  // An unknown type always matches.
+  MessageFilter data;
+  EXPECT_TRUE(data.AddCondition("data", "2"));
+  const std::string str = msg.SerializeAsString();
+  EXPECT_TRUE(data.Match(str.data(), str.size(), "gz.msgs.Unknown"));
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the conversion to and from text.
+TEST(MessageFilterTest, Text)
+{
+  MessageFilter filter;
+  EXPECT_EQ(filter.ToString(), "");
+  EXPECT_TRUE(filter.AddCondition("header.data.value", "a&b\\c=d"));
+  EXPECT_TRUE(filter.AddCondition("data", "1"));
+  EXPECT_EQ(filter.ToString(), "header.data.value=a\\&b\\\\c=d&data=1");
+
+  MessageFilter parsed;
+  EXPECT_TRUE(parsed.Parse(filter.ToString()));
+  EXPECT_EQ(filter, parsed);
+
+  MessageFilter copy(filter);
+  EXPECT_EQ(filter, copy);
+  copy = MessageFilter();
+  EXPECT_TRUE(copy.Empty());
+  EXPECT_NE(filter, copy);
+
+  EXPECT_TRUE(parsed.Parse(""));
+  EXPECT_TRUE(parsed.Empty());
+  EXPECT_FALSE(parsed.Parse("data"));
+  EXPECT_FALSE(parsed.Parse("data=1&=2"));
+  EXPECT_TRUE(parsed.Empty());
+}
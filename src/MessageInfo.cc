@@ -15,7 +15,9 @@
  *
 */
 
+#include <memory>
 #include <string>
+#include <utility>
 
 #include "gz/transport/MessageInfo.hh"
 #include "gz/transport/TopicUtils.hh"
@@ -29,6 +31,21 @@ namespace gz
   {
     inline namespace GZ_TRANSPORT_VERSION_NAMESPACE
     {
+    /// \internal
+    /// \brief Names of the topic of a message. They are immutable once
+    /// shared, so that the copies of a MessageInfo share them.
+    struct MessageInfoNames
+    {
+      /// \brief Topic name.
+      std::string topic = "";
+
+      /// \brief Message type name.
+      std::string type = "";
+
+      /// \brief Partition name.
+      std::string partition = "";
+    };
+
     /// \internal
     /// \brief Private data for MessageInfo class.
     class MessageInfoPrivate
@@ -39,17 +56,38 @@ namespace gz
       /// \brief Destructor.
       public: virtual ~MessageInfoPrivate() = default;
 
-      /// \brief Topic name.
-      public: std::string topic = "";
-
-      /// \brief Message type name.
-      public: std::string type = "";
-
-      /// \brief Partition name.
-      public: std::string partition = "";
+      /// \brief Copy the names before modifying them.
+      /// \return The names, owned by this object only.
+      public: MessageInfoNames &MutableNames()
+      {
+        if (this->names == EmptyNames() || this->names.use_count() > 1)
+          this->names = std::make_shared<MessageInfoNames>(*this->names);
+        return *this->names;
+      }
+
+      /// \brief Names shared by the default constructed objects.
+      /// \return The empty names.
+      public: static const std::shared_ptr<MessageInfoNames> &EmptyNames()
+      {
+        static const std::shared_ptr<MessageInfoNames> kEmpty =
+          std::make_shared<MessageInfoNames>();
+        return kEmpty;
+      }
+
+      /// \brief Topic, type and partition names, shared with the copies.
+      public: std::shared_ptr<MessageInfoNames> names = EmptyNames();
 
       /// \brief Was the message sent via intra-process?
       public: bool isIntraProcess = false;
+
+      /// \brief Sequence number of a reliable message.
+      public: uint64_t seq = 0;
+
+      /// \brief Number of messages missed before this one.
+      public: uint64_t seqGap = 0;
+
+      /// \brief Was the message sent again from the history?
+      public: bool retransmitted = false;
     };
     }
   }
@@ -79,49 +117,58 @@ MessageInfo::~MessageInfo()
 {
 }
 
+//////////////////////////////////////////////////
+MessageInfo &MessageInfo::operator=(const MessageInfo &_other)
+{
+  if (this != &_other)
+    *this->dataPtr = *_other.dataPtr;
+  return *this;
+}
+
 //////////////////////////////////////////////////
 const std::string &MessageInfo::Topic() const
 {
-  return this->dataPtr->topic;
+  return this->dataPtr->names->topic;
 }
 
 //////////////////////////////////////////////////
 void MessageInfo::SetTopic(const std::string &_topic)
 {
-  this->dataPtr->topic = _topic;
+  this->dataPtr->MutableNames().topic = _topic;
 }
 
 //////////////////////////////////////////////////
 const std::string &MessageInfo::Type() const
 {
-  return this->dataPtr->type;
+  return this->dataPtr->names->type;
 }
 
 //////////////////////////////////////////////////
 void MessageInfo::SetType(const std::string &_type)
 {
-  this->dataPtr->type = _type;
+  this->dataPtr->MutableNames().type = _type;
 }
 
 //////////////////////////////////////////////////
 const std::string &MessageInfo::Partition() const
 {
-  return this->dataPtr->partition;
+  return this->dataPtr->names->partition;
 }
 
 //////////////////////////////////////////////////
 void MessageInfo::SetPartition(const std::string &_partition)
 {
-  this->dataPtr->partition = _partition;
+  this->dataPtr->MutableNames().partition = _partition;
 }
 
 //////////////////////////////////////////////////
 bool MessageInfo::SetTopicAndPartition(const std::string &_fullyQualifiedName)
 {
+  MessageInfoNames &names = this->dataPtr->MutableNames();
   return TopicUtils::DecomposeFullyQualifiedTopic(
         _fullyQualifiedName,
-        this->dataPtr->partition,
-        this->dataPtr->topic);
+        names.partition,
+        names.topic);
 }
 
 //////////////////////////////////////////////////
@@ -135,3 +182,39 @@ void MessageInfo::SetIntraProcess(bool _value)
 {
   this->dataPtr->isIntraProcess = _value;
 }
+
+//////////////////////////////////////////////////
+uint64_t MessageInfo::Sequence() const
+{
+  return this->dataPtr->seq;
+}
+
+//////////////////////////////////////////////////
+void MessageInfo::SetSequence(uint64_t _seq)
+{
+  this->dataPtr->seq = _seq;
+}
+
+//////////////////////////////////////////////////
+uint64_t MessageInfo::SequenceGap() const
+{
+  return this->dataPtr->seqGap;
+}
+
+//////////////////////////////////////////////////
+void MessageInfo::SetSequenceGap(uint64_t _gap)
+{
+  this->dataPtr->seqGap = _gap;
+}
+
+//////////////////////////////////////////////////
+bool MessageInfo::Retransmitted() const
+{
+  return this->dataPtr->retransmitted;
+}
+
+//////////////////////////////////////////////////
+void MessageInfo::SetRetransmitted(bool _value)
+{
+  this->dataPtr->retransmitted = _value;
+}
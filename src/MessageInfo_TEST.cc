@@ -111,6 +111,28 @@ TEST(MessageInfoTest, InterProcess)
   EXPECT_FALSE(info.IntraProcess());
 }
 
+//////////////////////////////////////////////////
+/// \brief Check the sequence information.
+TEST(MessageInfoTest, Sequence)
+{
+  transport::MessageInfo info;
+  EXPECT_EQ(0u, info.Sequence());
+  EXPECT_EQ(0u, info.SequenceGap());
+  EXPECT_FALSE(info.Retransmitted());
+
+  info.SetSequence(42);
+  info.SetSequenceGap(3);
+  info.SetRetransmitted(true);
+  EXPECT_EQ(42u, info.Sequence());
+  EXPECT_EQ(3u, info.SequenceGap());
+  EXPECT_TRUE(info.Retransmitted());
+
+  transport::MessageInfo infoCopy(info);
+  EXPECT_EQ(42u, infoCopy.Sequence());
+  EXPECT_EQ(3u, infoCopy.SequenceGap());
+  EXPECT_TRUE(infoCopy.Retransmitted());
+}
+
 //////////////////////////////////////////////////
 /// \brief Check Copy constructor.
 TEST(MessageInfoTest, CopyConstructor)
@@ -126,3 +148,34 @@ TEST(MessageInfoTest, CopyConstructor)
   EXPECT_EQ("/b_topic", infoCopy.Topic());
   EXPECT_TRUE(infoCopy.IntraProcess());
 }
+
+//////////////////////////////////////////////////
+/// \brief The copies share the names until one of them is modified.
+TEST(MessageInfoTest, SharedNames)
+{
+  transport::MessageInfo info;
+  info.SetTopicAndPartition("@/a_partition@/b_topic");
+  info.SetType(".msg.foo");
+
+  transport::MessageInfo infoCopy(info);
+  EXPECT_EQ(&info.Topic(), &infoCopy.Topic());
+  EXPECT_EQ(&info.Type(), &infoCopy.Type());
+  EXPECT_EQ(&info.Partition(), &infoCopy.Partition());
+
+  infoCopy.SetType(".msg.bar");
+  EXPECT_EQ(".msg.foo", info.Type());
+  EXPECT_EQ(".msg.bar", infoCopy.Type());
+  EXPECT_EQ("/b_topic", infoCopy.Topic());
+  EXPECT_EQ("/a_partition", infoCopy.Partition());
+
+  transport::MessageInfo infoAssigned;
+  infoAssigned.SetSequence(3);
+  infoAssigned = info;
+  EXPECT_EQ(&info.Topic(), &infoAssigned.Topic());
+  EXPECT_EQ(0u, infoAssigned.Sequence());
+
+  // A default constructed object doesn't share the names it modifies.
+  transport::MessageInfo other;
+  other.SetTopic("/c_topic");
+  EXPECT_TRUE(transport::MessageInfo().Topic().empty());
+}
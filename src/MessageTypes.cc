@@ -0,0 +1,211 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable: 4251)
+#endif
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/descriptor.pb.h>
+#include <google/protobuf/descriptor_database.h>
+#include <google/protobuf/dynamic_message.h>
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>  //NOLINT
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <gz/msgs/Factory.hh>
+
+#include "gz/transport/MessageTypes.hh"
+
+using namespace gz;
+using namespace transport;
+
+namespace
+{
+  /// \brief The registry of the message types.
+  struct Registry
+  {
+    /// \brief Find the prototype of a type without the cache.
+    /// The caller must hold the mutex exclusively.
+    /// \param[in] _type The message type.
+    /// \return The prototype or nullptr if the type is unknown.
+    const google::protobuf::Message *Find(const std::string &_type)
+    {
+      // The protobuf classes compiled in the process.
+      const google::protobuf::Descriptor *desc =
+        google::protobuf::DescriptorPool::generated_pool()
+          ->FindMessageTypeByName(_type);
+      if (desc)
+      {
+        return google::protobuf::MessageFactory::generated_factory()
+          ->GetPrototype(desc);
+      }
+
+      // The descriptors added at runtime.
+      desc = this->pool.FindMessageTypeByName(_type);
+      if (desc)
+        return this->factory.GetPrototype(desc);
+
+      // Fallback on Gazebo Msgs, keep the message as the prototype.
+      std::unique_ptr<google::protobuf::Message> msg =
+        gz::msgs::Factory::New(_type);
+      if (!msg)
+        return nullptr;
+      this->owned.push_back(std::move(msg));
+      return this->owned.back().get();
+    }
+
+    /// \brief Add a file descriptor to the database, and the missing
+    /// dependencies compiled in the process.
+    /// The caller must hold the mutex exclusively.
+    /// \param[in] _file The file descriptor.
+    void Add(const google::protobuf::FileDescriptorProto &_file)
+    {
+      google::protobuf::FileDescriptorProto existing;
+      if (this->database.FindFileByName(_file.name(), &existing))
+        return;
+
+      this->database.Add(_file);
+
+      for (const std::string &dep : _file.dependency())
+      {
+        if (this->database.FindFileByName(dep, &existing))
+          continue;
+
+        const google::protobuf::FileDescriptor *generated =
+          google::protobuf::DescriptorPool::generated_pool()
+            ->FindFileByName(dep);
+        if (!generated)
+          continue;
+
+        google::protobuf::FileDescriptorProto depFile;
+        generated->CopyTo(&depFile);
+        this->Add(depFile);
+      }
+    }
+
+    /// \brief Protects all the members.
+    std::shared_mutex mutex;
+
+    /// \brief Prototypes of the types already looked up.
+    std::unordered_map<std::string, const google::protobuf::Message *> cache;
+
+    /// \brief Descriptors added at runtime.
+    google::protobuf::SimpleDescriptorDatabase database;
+
+    /// \brief Pool of the descriptors added at runtime, built on demand.
+    google::protobuf::DescriptorPool pool{&database};
+
+    /// \brief Factory of the types added at runtime.
+    google::protobuf::DynamicMessageFactory factory{&pool};
+
+    /// \brief Prototypes created by the gz-msgs factory.
+    std::vector<std::unique_ptr<google::protobuf::Message>> owned;
+  };
+
+  /// \brief Add a file and its dependencies to a set, the dependencies
+  /// first.
+  /// \param[in] _file The file.
+  /// \param[in, out] _visited Names of the files already added.
+  /// \param[in, out] _files The set.
+  void addFile(const google::protobuf::FileDescriptor *_file,
+      std::unordered_set<std::string> &_visited,
+      google::protobuf::FileDescriptorSet &_files)
+  {
+    if (!_visited.insert(_file->name()).second)
+      return;
+
+    for (int i = 0; i < _file->dependency_count(); ++i)
+      addFile(_file->dependency(i), _visited, _files);
+    _file->CopyTo(_files.add_file());
+  }
+
+  /// \brief Get the registry. It is never destroyed, since the messages
+  /// created from its prototypes might outlive the static objects.
+  /// \return The registry.
+  Registry &registry()
+  {
+    static Registry *instance = new Registry();
+    return *instance;
+  }
+}
+
+//////////////////////////////////////////////////
+const google::protobuf::Message *MessageTypes::Prototype(
+  const std::string &_type)
+{
+  Registry &reg = registry();
+
+  {
+    std::shared_lock<std::shared_mutex> lk(reg.mutex);
+    auto it = reg.cache.find(_type);
+    if (it != reg.cache.end())
+      return it->second;
+  }
+
+  std::unique_lock<std::shared_mutex> lk(reg.mutex);
+  auto it = reg.cache.find(_type);
+  if (it != reg.cache.end())
+    return it->second;
+
+  // The unknown types aren't cached, their descriptors might be added
+  // later.
+  const google::protobuf::Message *prototype = reg.Find(_type);
+  if (prototype)
+    reg.cache[_type] = prototype;
+  return prototype;
+}
+
+//////////////////////////////////////////////////
+bool MessageTypes::AddDescriptors(const std::string &_descriptors)
+{
+  google::protobuf::FileDescriptorSet files;
+  if (!files.ParseFromString(_descriptors))
+  {
+    std::cerr << "MessageTypes::AddDescriptors() error: Unable to parse "
+              << "the descriptors" << std::endl;
+    return false;
+  }
+
+  Registry &reg = registry();
+  std::unique_lock<std::shared_mutex> lk(reg.mutex);
+  for (const auto &file : files.file())
+    reg.Add(file);
+  return true;
+}
+
+//////////////////////////////////////////////////
+std::string MessageTypes::Descriptors(const std::string &_type)
+{
+  const google::protobuf::Message *prototype = Prototype(_type);
+  if (!prototype)
+    return "";
+
+  google::protobuf::FileDescriptorSet files;
+  std::unordered_set<std::string> visited;
+  addFile(prototype->GetDescriptor()->file(), visited, files);
+  return files.SerializeAsString();
+}
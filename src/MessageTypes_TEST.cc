@@ -0,0 +1,157 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <google/protobuf/descriptor.pb.h>
+#include <gz/msgs/int32.pb.h>
+
+#include <memory>
+#include <string>
+
+#include "gz/transport/MessageTypes.hh"
+#include "gz/transport/SubscribeOptions.hh"
+#include "gz/transport/SubscriptionHandler.hh"
+#include "gtest/gtest.h"
+
+using namespace gz;
+using namespace transport;
+
+//////////////////////////////////////////////////
+/// \brief A serialized FileDescriptorSet with the type gz.test.Dynamic,
+/// which has an int32 field and a gz.msgs.Int32 field. The file of
+/// gz.msgs.Int32 isn't in the set.
+/// \return The serialized descriptors.
+std::string dynamicDescriptors()
+{
+  google::protobuf::FileDescriptorSet files;
+  auto *file = files.add_file();
+  file->set_name("gz/test/dynamic.proto");
+  file->set_package("gz.test");
+  file->set_syntax("proto3");
+  file->add_dependency(msgs::Int32::descriptor()->file()->name());
+
+  auto *msg = file->add_message_type();
+  msg->set_name("Dynamic");
+  auto *value = msg->add_field();
+  value->set_name("value");
+  value->set_number(1);
+  value->set_type(google::protobuf::FieldDescriptorProto::TYPE_INT32);
+  value->set_label(google::protobuf::FieldDescriptorProto::LABEL_OPTIONAL);
+  auto *nested = msg->add_field();
+  nested->set_name("nested");
+  nested->set_number(2);
+  nested->set_type(google::protobuf::FieldDescriptorProto::TYPE_MESSAGE);
+  nested->set_label(google::protobuf::FieldDescriptorProto::LABEL_OPTIONAL);
+  nested->set_type_name(".gz.msgs.Int32");
+
+  return files.SerializeAsString();
+}
+
+//////////////////////////////////////////////////
+/// \brief The prototypes of the compiled types are found and cached.
+TEST(MessageTypesTest, CompiledType)
+{
+  const google::protobuf::Message *prototype =
+    MessageTypes::Prototype("gz.msgs.Int32");
+  ASSERT_NE(nullptr, prototype);
+  EXPECT_EQ(&msgs::Int32::default_instance(), prototype);
+  EXPECT_EQ(prototype, MessageTypes::Prototype("gz.msgs.Int32"));
+
+  EXPECT_EQ(nullptr, MessageTypes::Prototype("gz.msgs.__bad_type__"));
+}
+
+//////////////////////////////////////////////////
+/// \brief The types added at runtime are created by the generic handlers.
+TEST(MessageTypesTest, RuntimeType)
+{
+  EXPECT_EQ(nullptr, MessageTypes::Prototype("gz.test.Dynamic"));
+  EXPECT_FALSE(MessageTypes::AddDescriptors("not a descriptor set"));
+  ASSERT_TRUE(MessageTypes::AddDescriptors(dynamicDescriptors()));
+
+  // Adding the same descriptors again is harmless.
+  EXPECT_TRUE(MessageTypes::AddDescriptors(dynamicDescriptors()));
+
+  const google::protobuf::Message *prototype =
+    MessageTypes::Prototype("gz.test.Dynamic");
+  ASSERT_NE(nullptr, prototype);
+  EXPECT_EQ("gz.test.Dynamic", prototype->GetTypeName());
+
+  // Serialize a message with the dynamic type.
+  std::unique_ptr<google::protobuf::Message> msg(prototype->New());
+  const auto *desc = msg->GetDescriptor();
+  const auto *reflection = msg->GetReflection();
+  reflection->SetInt32(msg.get(), desc->FindFieldByName("value"), 5);
+  msgs::Int32 nested;
+  nested.set_data(7);
+  // The field is a dynamic message too, it can't copy a compiled one.
+  EXPECT_TRUE(reflection->MutableMessage(msg.get(),
+    desc->FindFieldByName("nested"))->ParseFromString(
+      nested.SerializeAsString()));
+  const std::string data = msg->SerializeAsString();
+
+  SubscriptionHandler<ProtoMsg> handler("nUuid");
+  auto created = handler.CreateMsg(data, "gz.test.Dynamic");
+  ASSERT_NE(nullptr, created);
+  EXPECT_EQ(msg->DebugString(), created->DebugString());
+}
+
+//////////////////////////////////////////////////
+/// \brief The descriptors of a type include its dependencies first, so
+/// they can be added back to a pool.
+TEST(MessageTypesTest, Descriptors)
+{
+  EXPECT_TRUE(MessageTypes::Descriptors("gz.msgs.__bad_type__").empty());
+
+  ASSERT_TRUE(MessageTypes::AddDescriptors(dynamicDescriptors()));
+  google::protobuf::FileDescriptorSet files;
+  ASSERT_TRUE(files.ParseFromString(
+    MessageTypes::Descriptors("gz.test.Dynamic")));
+  ASSERT_GE(files.file_size(), 2);
+  const int last = files.file_size() - 1;
+  EXPECT_EQ("gz/test/dynamic.proto", files.file(last).name());
+  EXPECT_EQ(msgs::Int32::descriptor()->file()->name(),
+    files.file(last - 1).name());
+}
+
+//////////////////////////////////////////////////
+/// \brief The generic handlers recycle the messages of the same type.
+TEST(MessageTypesTest, ReuseGenericMessage)
+{
+  msgs::Int32 msg;
+  msg.set_data(3);
+  const std::string data = msg.SerializeAsString();
+
+  SubscribeOptions opts;
+  opts.SetReuseMessage(true);
+  SubscriptionHandler<ProtoMsg> handler("nUuid", opts);
+
+  const ProtoMsg *address = nullptr;
+  {
+    auto created = handler.CreateMsg(data, "gz.msgs.Int32");
+    ASSERT_NE(nullptr, created);
+    address = created.get();
+  }
+
+  auto created = handler.CreateMsg(data, "gz.msgs.Int32");
+  ASSERT_NE(nullptr, created);
+  EXPECT_EQ(address, created.get());
+  EXPECT_EQ(msg.DebugString(), created->DebugString());
+
+  // A message still referenced isn't reused.
+  auto other = handler.CreateMsg(data, "gz.msgs.Int32");
+  ASSERT_NE(nullptr, other);
+  EXPECT_NE(created.get(), other.get());
+}
@@ -0,0 +1,168 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GZ_TRANSPORT_MPSCQUEUE_HH_
+#define GZ_TRANSPORT_MPSCQUEUE_HH_
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+#include "gz/transport/config.hh"
+
+namespace gz
+{
+  namespace transport
+  {
+    inline namespace GZ_TRANSPORT_VERSION_NAMESPACE
+    {
+    /// \internal
+    /// \brief A bounded lock-free queue supporting multiple producers and a
+    /// single consumer. This is a ring of cells, each one tagged with a
+    /// sequence number that tells producers and the consumer whether the
+    /// cell is ready to be written or read. Pushing only requires one
+    /// compare-and-swap on the enqueue position, no memory is allocated.
+    /// \tparam T Type of the elements. It must be default constructible and
+    /// movable.
+    template <typename T>
+    class MpscQueue
+    {
+      /// \brief Constructor.
+      /// \param[in] _capacity Minimum capacity of the queue. The capacity is
+      /// rounded up to the next power of two.
+      public: explicit MpscQueue(std::size_t _capacity)
+      {
+        std::size_t capacity = 2;
+        while (capacity < _capacity)
+          capacity <<= 1;
+
+        this->mask = capacity - 1;
+        this->cells.reset(new Cell[capacity]);
+        for (std::size_t i = 0; i < capacity; ++i)
+          this->cells[i].sequence.store(i, std::memory_order_relaxed);
+      }
+
+      /// \brief No copy constructor.
+      public: MpscQueue(const MpscQueue &) = delete;
+
+      /// \brief No assignment operator.
+      public: MpscQueue &operator=(const MpscQueue &) = delete;
+
+      /// \brief Get the capacity of the queue.
+      /// \return The maximum number of elements.
+      public: std::size_t Capacity() const
+      {
+        return this->mask + 1;
+      }
+
+      /// \brief Push an element. This function can be called from any thread.
+      /// \param[in, out] _value The element. It is moved into the queue only
+      /// when this function succeeds.
+      /// \return True on success or false if the queue is full.
+      public: bool TryPush(T &_value)
+      {
+        std::size_t pos = this->enqueuePos.load(std::memory_order_relaxed);
+        Cell *cell;
+        for (;;)
+        {
+          cell = &this->cells[pos & this->mask];
+          const std::size_t seq =
+            cell->sequence.load(std::memory_order_acquire);
+          const auto diff =
+            static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+
+          if (diff == 0)
+          {
+            if (this->enqueuePos.compare_exchange_weak(pos, pos + 1,
+                  std::memory_order_relaxed))
+            {
+              break;
+            }
+          }
+          else if (diff < 0)
+          {
+            // The consumer has not released this cell yet: full.
+            return false;
+          }
+          else
+          {
+            pos = this->enqueuePos.load(std::memory_order_relaxed);
+          }
+        }
+
+        cell->data = std::move(_value);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+      }
+
+      /// \brief Pop an element. This function must only be called from the
+      /// consumer thread.
+      /// \param[out] _value The element.
+      /// \return True on success or false if the queue is empty.
+      public: bool TryPop(T &_value)
+      {
+        Cell *cell = &this->cells[this->dequeuePos & this->mask];
+        const std::size_t seq = cell->sequence.load(std::memory_order_acquire);
+        if (seq != this->dequeuePos + 1)
+          return false;
+
+        _value = std::move(cell->data);
+        cell->data = T();
+        cell->sequence.store(this->dequeuePos + this->mask + 1,
+            std::memory_order_release);
+        ++this->dequeuePos;
+        return true;
+      }
+
+      /// \brief Check whether the next element is ready to be popped. This
+      /// function must only be called from the consumer thread.
+      /// \return True if the queue is empty.
+      public: bool Empty() const
+      {
+        const Cell &cell = this->cells[this->dequeuePos & this->mask];
+        return cell.sequence.load(std::memory_order_acquire) !=
+          this->dequeuePos + 1;
+      }
+
+      /// \brief A slot of the ring.
+      private: struct alignas(64) Cell
+      {
+        /// \brief Sequence number of the cell.
+        std::atomic<std::size_t> sequence{0};
+
+        /// \brief The element.
+        T data;
+      };
+
+      /// \brief The ring.
+      private: std::unique_ptr<Cell[]> cells;
+
+      /// \brief Capacity minus one.
+      private: std::size_t mask = 0;
+
+      /// \brief Next position to write. Kept in its own cache line, it is
+      /// updated by all the producers.
+      private: alignas(64) std::atomic<std::size_t> enqueuePos{0};
+
+      /// \brief Next position to read. Only used by the consumer.
+      private: alignas(64) std::size_t dequeuePos = 0;
+    };
+    }
+  }
+}
+#endif
@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "MpscQueue.hh"
+#include "gtest/gtest.h"
+
+using namespace gz;
+
+//////////////////////////////////////////////////
+/// \brief Check the capacity and the basic push/pop operations.
+TEST(MpscQueueTest, PushPop)
+{
+  transport::MpscQueue<std::unique_ptr<int>> queue(3);
+  EXPECT_EQ(4u, queue.Capacity());
+  EXPECT_TRUE(queue.Empty());
+
+  std::unique_ptr<int> value;
+  EXPECT_FALSE(queue.TryPop(value));
+
+  for (int i = 0; i < 4; ++i)
+  {
+    auto v = std::make_unique<int>(i);
+    EXPECT_TRUE(queue.TryPush(v));
+    EXPECT_EQ(nullptr, v);
+  }
+  EXPECT_FALSE(queue.Empty());
+
+  // The queue is full, the value is left untouched.
+  auto extra = std::make_unique<int>(4);
+  EXPECT_FALSE(queue.TryPush(extra));
+  ASSERT_NE(nullptr, extra);
+
+  for (int i = 0; i < 4; ++i)
+  {
+    ASSERT_TRUE(queue.TryPop(value));
+    EXPECT_EQ(i, *value);
+  }
+  EXPECT_TRUE(queue.Empty());
+
+  // Wrap around.
+  EXPECT_TRUE(queue.TryPush(extra));
+  ASSERT_TRUE(queue.TryPop(value));
+  EXPECT_EQ(4, *value);
+}
+
+//////////////////////////////////////////////////
+/// \brief Several producers and one consumer. The elements of each producer
+/// must be received in order.
+TEST(MpscQueueTest, MultipleProducers)
+{
+  const int kProducers = 4;
+  const int kElements = 10000;
+  transport::MpscQueue<int> queue(64);
+
+  std::vector<std::thread> producers;
+  for (int p = 0; p < kProducers; ++p)
+  {
+    producers.emplace_back([&queue, p]()
+    {
+      for (int i = 0; i < kElements; ++i)
+      {
+        int value = p * kElements + i;
+        while (!queue.TryPush(value))
+          std::this_thread::yield();
+      }
+    });
+  }
+
+  std::vector<int> next(kProducers, 0);
+  int received = 0;
+  while (received < kProducers * kElements)
+  {
+    int value;
+    if (!queue.TryPop(value))
+    {
+      std::this_thread::yield();
+      continue;
+    }
+
+    const int p = value / kElements;
+    EXPECT_EQ(next[p], value % kElements);
+    next[p] = value % kElements + 1;
+    ++received;
+  }
+
+  for (auto &producer : producers)
+    producer.join();
+
+  EXPECT_TRUE(queue.Empty());
+}
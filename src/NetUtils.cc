@@ -18,6 +18,7 @@
 
 #ifdef _WIN32
   #include <Winsock2.h>
+  #include <ws2tcpip.h>
   #include <iphlpapi.h>
   #include <windows.h>
   #include <Lmcons.h>
@@ -30,10 +31,16 @@
 #endif
 
 #include <algorithm>
+#include <chrono>
 #include <cstdlib>
 #include <cstring>
+#include <future>
 #include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <unordered_set>
 #include <vector>
 
@@ -55,32 +62,199 @@ namespace transport
 {
 inline namespace GZ_TRANSPORT_VERSION_NAMESPACE
 {
+  /// \brief Default timeout (ms) of the hostname resolution.
+  static const int kDefaultResolveTimeout = 1000;
+
+  /// \brief A value determined once per process.
+  template<typename T>
+  struct Cached
+  {
+    /// \brief Set when the value is determined.
+    std::once_flag once;
+
+    /// \brief The value.
+    T value;
+  };
+
+  /// \brief The lookups determined once per process and their durations.
+  struct LookupCache
+  {
+    /// \brief Result of determineHost() without GZ_IP.
+    Cached<std::string> host;
+
+    /// \brief Result of determineInterfaces().
+    Cached<std::vector<std::string>> interfaces;
+
+    /// \brief Result of hostname().
+    Cached<std::string> hostname;
+
+    /// \brief Result of username().
+    Cached<std::string> username;
+
+    /// \brief Protects times.
+    std::mutex mutex;
+
+    /// \brief Duration of every lookup, see startupTimes().
+    std::map<std::string, std::chrono::nanoseconds> times;
+  };
+
+  /// \brief Get the cache of the lookups of this process.
+  /// \return The cache.
+  static LookupCache &lookupCache()
+  {
+    // Never destroyed, so the lookups stay valid in static destructors.
+    static LookupCache *cache = new LookupCache();
+    return *cache;
+  }
+
+  /// \brief Record the duration of a lookup.
+  /// \param[in] _lookup Name of the lookup, see startupTimes().
+  /// \param[in] _start When the lookup started.
+  static void recordTime(const std::string &_lookup,
+    const std::chrono::steady_clock::time_point &_start)
+  {
+    auto &cache = lookupCache();
+    std::lock_guard<std::mutex> lk(cache.mutex);
+    cache.times[_lookup] = std::chrono::steady_clock::now() - _start;
+  }
+
+  /// \brief Determine a value once per process and record how long it took.
+  /// \param[in] _entry The cached value.
+  /// \param[in] _lookup Name of the lookup, see startupTimes().
+  /// \param[in] _determine Function determining the value.
+  /// \return The value.
+  template<typename T, typename F>
+  static const T &cached(Cached<T> &_entry, const std::string &_lookup,
+    F &&_determine)
+  {
+    std::call_once(_entry.once, [&]()
+    {
+      const auto start = std::chrono::steady_clock::now();
+      _entry.value = _determine();
+      recordTime(_lookup, start);
+    });
+    return _entry.value;
+  }
+
+  /// \brief Resolve a hostname in a detached thread, so the caller can do
+  /// something else meanwhile and give up if the DNS server is too slow.
+  /// \param[in] _hostname Hostname.
+  /// \return The first IPv4 address of the hostname, or an empty string if
+  /// the resolution failed.
+  static std::shared_future<std::string> resolveAsync(
+    const std::string &_hostname)
+  {
+    auto promise = std::make_shared<std::promise<std::string>>();
+    std::shared_future<std::string> result = promise->get_future().share();
+    std::thread([promise, _hostname]()
+    {
+      struct addrinfo hints;
+      memset(&hints, 0, sizeof(hints));
+      hints.ai_family = AF_INET;
+      struct addrinfo *info = nullptr;
+      std::string ip;
+      if (getaddrinfo(_hostname.c_str(), nullptr, &hints, &info) == 0 &&
+          info)
+      {
+        char ip_[INET_ADDRSTRLEN];
+        const auto *addr =
+          reinterpret_cast<struct sockaddr_in *>(info->ai_addr);
+        if (inet_ntop(AF_INET, &addr->sin_addr, ip_, sizeof(ip_)))
+          ip = ip_;
+      }
+      if (info)
+        freeaddrinfo(info);
+      promise->set_value(ip);
+    }).detach();
+    return result;
+  }
+
+  /// \brief Wait for the resolution of a hostname, at most
+  /// GZ_TRANSPORT_RESOLVE_TIMEOUT milliseconds.
+  /// \param[in] _hostname Hostname.
+  /// \param[in] _resolution Pending resolution, see resolveAsync().
+  /// \param[out] _ip IP associated to the hostname.
+  /// \return true when the hostname was resolved in time.
+  static bool waitResolution(const std::string &_hostname,
+    const std::shared_future<std::string> &_resolution, std::string &_ip)
+  {
+    int timeout = kDefaultResolveTimeout;
+    std::string timeoutStr;
+    if (env("GZ_TRANSPORT_RESOLVE_TIMEOUT", timeoutStr) &&
+        !timeoutStr.empty())
+    {
+      try
+      {
+        timeout = std::max(0, std::stoi(timeoutStr));
+      }
+      catch (...)
+      {
+        std::cerr << "Invalid GZ_TRANSPORT_RESOLVE_TIMEOUT [" << timeoutStr
+                  << "]. Using " << kDefaultResolveTimeout << " ms."
+                  << std::endl;
+      }
+    }
+
+    if (_resolution.wait_for(std::chrono::milliseconds(timeout)) !=
+        std::future_status::ready)
+    {
+      std::cerr << "Resolving the hostname [" << _hostname << "] took more "
+                << "than " << timeout << " ms. Ignoring it, set GZ_IP to "
+                << "skip the resolution." << std::endl;
+      return false;
+    }
+
+    _ip = _resolution.get();
+    return !_ip.empty();
+  }
+
+  /// \brief Determine the IP of this host without GZ_IP, see
+  /// determineHost().
+  /// \return The IP or hostname of this host.
+  static std::string lookupHost();
+
+  /// \brief Determine the network interfaces, see determineInterfaces().
+  /// \return The list of network interfaces.
+  static std::vector<std::string> lookupInterfaces();
+
+  /// \brief Determine the hostname, see hostname().
+  /// \return The computer's hostname.
+  static std::string lookupHostname();
+
+  /// \brief Determine the login name, see username().
+  /// \return Name used to gain access to the computer.
+  static std::string lookupUsername();
+
   /// \brief Get the preferred local IP address.
   /// Note that we don't consider private IP addresses.
   /// \param[out] _ip The preferred local IP address.
   /// \return true if a public local IP was found or false otherwise.
   static bool preferredPublicIP(std::string &_ip)
   {
-    char host[1024];
-    memset(host, 0, sizeof(host));
-    if (gethostname(host, sizeof(host) - 1) != 0)
-      return false;
+    const std::string host = hostname();
 
     // We don't want "localhost" to be our hostname.
-    if (!strlen(host) || !strcmp("localhost", host))
+    if (host.empty() || host == "localhost")
       return false;
 
+    // The interfaces are listed while the hostname is resolved.
+    const auto start = std::chrono::steady_clock::now();
+    auto resolution = resolveAsync(host);
+
+    // Get the complete list of compatible interfaces.
+    auto interfaces = determineInterfaces();
+
     std::string hostIP;
+    const bool resolved = waitResolution(host, resolution, hostIP);
+    recordTime("resolve", start);
+
     const std::string kPrefix = "127.0.";
-    if ((hostnameToIp(host, hostIP) != 0) || isPrivateIP(hostIP.c_str()) ||
+    if (!resolved || isPrivateIP(hostIP.c_str()) ||
         hostIP.compare(0, kPrefix.size(), kPrefix) == 0)
     {
       return false;
     }
 
-    // Get the complete list of compatible interfaces.
-    auto interfaces = determineInterfaces();
-
     // Make sure that this interface is compatible with Discovery.
     if (std::find(interfaces.begin(), interfaces.end(), hostIP) ==
           interfaces.end())
@@ -103,23 +277,10 @@ inline namespace GZ_TRANSPORT_VERSION_NAMESPACE
   //////////////////////////////////////////////////
   int hostnameToIp(char *_hostname, std::string &_ip)
   {
-    struct hostent *he;
-    struct in_addr **addr_list;
-    int i;
-
-    if ((he = gethostbyname(_hostname)) == nullptr)
+    if (!_hostname)
       return 1;
 
-    addr_list = (struct in_addr **) he->h_addr_list;
-
-    for (i = 0; addr_list[i] != nullptr; ++i)
-    {
-      // Return the first one;
-      _ip = std::string(inet_ntoa(*addr_list[i]));
-      return 0;
-    }
-
-    return 1;
+    return waitResolution(_hostname, resolveAsync(_hostname), _ip) ? 0 : 1;
   }
 
   //////////////////////////////////////////////////
@@ -132,6 +293,24 @@ inline namespace GZ_TRANSPORT_VERSION_NAMESPACE
       return gzIp;
     }
 
+    return cached(lookupCache().host, "host", []()
+    {
+      return lookupHost();
+    });
+  }
+
+  //////////////////////////////////////////////////
+  std::vector<std::string> determineInterfaces()
+  {
+    return cached(lookupCache().interfaces, "interfaces", []()
+    {
+      return lookupInterfaces();
+    });
+  }
+
+  //////////////////////////////////////////////////
+  std::string lookupHost()
+  {
     // Second, try the preferred local and public IP address.
     std::string hostIP;
     if (preferredPublicIP(hostIP))
@@ -150,7 +329,7 @@ inline namespace GZ_TRANSPORT_VERSION_NAMESPACE
   }
 
   //////////////////////////////////////////////////
-  std::vector<std::string> determineInterfaces()
+  std::vector<std::string> lookupInterfaces()
   {
 #ifdef HAVE_IFADDRS
     std::vector<std::string> result;
@@ -338,8 +517,70 @@ inline namespace GZ_TRANSPORT_VERSION_NAMESPACE
 #endif
   }
 
+  //////////////////////////////////////////////////
+  std::string determineLocalInterface(const std::string &_remoteIp)
+  {
+#ifdef HAVE_IFADDRS
+    struct in_addr remote;
+    if (inet_pton(AF_INET, _remoteIp.c_str(), &remote) != 1)
+      return "";
+
+    struct ifaddrs *ifp = nullptr;
+    if (getifaddrs(&ifp) < 0)
+      return "";
+
+    std::string result;
+    uint32_t bestMask = 0;
+    for (struct ifaddrs *ifa = ifp; ifa; ifa = ifa->ifa_next)
+    {
+      if (!ifa->ifa_addr || !ifa->ifa_netmask ||
+          ifa->ifa_addr->sa_family != AF_INET || !(ifa->ifa_flags & IFF_UP))
+      {
+        continue;
+      }
+
+      const auto *addr = reinterpret_cast<struct sockaddr_in *>(ifa->ifa_addr);
+      const auto *mask =
+        reinterpret_cast<struct sockaddr_in *>(ifa->ifa_netmask);
+      const uint32_t netmask = ntohl(mask->sin_addr.s_addr);
+      if (addr->sin_addr.s_addr == remote.s_addr)
+      {
+        result = _remoteIp;
+        break;
+      }
+      if ((addr->sin_addr.s_addr & mask->sin_addr.s_addr) !=
+          (remote.s_addr & mask->sin_addr.s_addr) ||
+          (!result.empty() && netmask <= bestMask))
+      {
+        continue;
+      }
+
+      char ip[INET_ADDRSTRLEN];
+      if (inet_ntop(AF_INET, &addr->sin_addr, ip, sizeof(ip)))
+      {
+        result = ip;
+        bestMask = netmask;
+      }
+    }
+    freeifaddrs(ifp);
+    return result;
+#else
+    (void)_remoteIp;
+    return "";
+#endif
+  }
+
   //////////////////////////////////////////////////
   std::string hostname()
+  {
+    return cached(lookupCache().hostname, "hostname", []()
+    {
+      return lookupHostname();
+    });
+  }
+
+  //////////////////////////////////////////////////
+  std::string lookupHostname()
   {
 #ifdef _WIN32
     WSADATA wsaData;
@@ -358,6 +599,15 @@ inline namespace GZ_TRANSPORT_VERSION_NAMESPACE
 
   //////////////////////////////////////////////////
   std::string username()
+  {
+    return cached(lookupCache().username, "username", []()
+    {
+      return lookupUsername();
+    });
+  }
+
+  //////////////////////////////////////////////////
+  std::string lookupUsername()
   {
     char buffer[200 + 1];
     size_t bufferLen = sizeof(buffer);
@@ -403,6 +653,14 @@ inline namespace GZ_TRANSPORT_VERSION_NAMESPACE
     return result;
 #endif
   }
+
+  //////////////////////////////////////////////////
+  std::map<std::string, std::chrono::nanoseconds> startupTimes()
+  {
+    auto &cache = lookupCache();
+    std::lock_guard<std::mutex> lk(cache.mutex);
+    return cache.times;
+  }
 }
 }
 }
@@ -15,6 +15,10 @@
  *
 */
 
+#include <string>
+
+#include <gz/utils/Environment.hh>
+
 #include "gz/transport/NetUtils.hh"
 #include "gtest/gtest.h"
 
@@ -33,3 +37,50 @@ TEST(NetUtilsTest, username)
 {
   EXPECT_TRUE(!transport::username().empty());
 }
+
+//////////////////////////////////////////////////
+/// \brief Check the determineLocalInterface() function.
+TEST(NetUtilsTest, determineLocalInterface)
+{
+  EXPECT_TRUE(transport::determineLocalInterface("").empty());
+  EXPECT_TRUE(transport::determineLocalInterface("not an ip").empty());
+
+#ifndef _WIN32
+  // Every interface is in its own subnet.
+  for (const std::string &ip : transport::determineInterfaces())
+    EXPECT_FALSE(transport::determineLocalInterface(ip).empty()) << ip;
+#endif
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that the lookups are done once and timed.
+TEST(NetUtilsTest, startupTimes)
+{
+  const auto interfaces = transport::determineInterfaces();
+  EXPECT_EQ(interfaces, transport::determineInterfaces());
+  EXPECT_EQ(transport::hostname(), transport::hostname());
+
+  const auto times = transport::startupTimes();
+  EXPECT_NE(times.end(), times.find("interfaces"));
+  EXPECT_NE(times.end(), times.find("hostname"));
+
+  // GZ_IP is never cached.
+  ASSERT_TRUE(gz::utils::setenv("GZ_IP", "10.0.0.1"));
+  EXPECT_EQ("10.0.0.1", transport::determineHost());
+  ASSERT_TRUE(gz::utils::unsetenv("GZ_IP"));
+  EXPECT_FALSE(transport::determineHost().empty());
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the hostnameToIp() function.
+TEST(NetUtilsTest, hostnameToIp)
+{
+  std::string ip;
+  char localhost[] = "localhost";
+  EXPECT_EQ(0, transport::hostnameToIp(localhost, ip));
+  EXPECT_EQ(0u, ip.rfind("127.", 0)) << ip;
+
+  char invalid[] = "gz-transport.invalid";
+  EXPECT_NE(0, transport::hostnameToIp(invalid, ip));
+  EXPECT_NE(0, transport::hostnameToIp(nullptr, ip));
+}
@@ -18,15 +18,21 @@
 #include <gz/msgs/statistic.pb.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <chrono>
 #include <csignal>
+#include <cstring>
 #include <condition_variable>
 #include <iostream>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <shared_mutex>
 #include <string>
+#include <string_view>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "gz/transport/Helpers.hh"
@@ -37,9 +43,14 @@
 #include "gz/transport/TopicUtils.hh"
 #include "gz/transport/TransportTypes.hh"
 #include "gz/transport/Uuid.hh"
+#include "gz/transport/detail/Probes.hh"
 
 #include "NodePrivate.hh"
+#include "BufferPool.hh"
+#include "Compression.hh"
+#include "LoanedMessagePrivate.hh"
 #include "NodeSharedPrivate.hh"
+#include "SerializedBuffer.hh"
 
 using namespace gz;
 using namespace transport;
@@ -112,8 +123,51 @@ namespace gz
       /// \param[in] _publisher The message publisher.
       public: explicit PublisherPrivate(const MessagePublisher &_publisher)
         : shared(NodeShared::Instance()),
-          publisher(_publisher)
+          publisher(_publisher),
+          addr(_publisher.Addr())
       {
+        this->shared->dataPtr->AddAdvertisedType(this->publisher.Topic(),
+          this->publisher.MsgTypeName());
+        this->interest =
+          this->shared->dataPtr->Interest(this->publisher.Topic());
+
+        // The copies of this object share its names.
+        this->info.SetTopicAndPartition(this->publisher.Topic());
+        this->info.SetType(this->publisher.MsgTypeName());
+        this->info.SetIntraProcess(true);
+
+        // The buckets of the rate limit start full.
+        this->ApplyOptions(this->publisher.Options());
+        this->lastRateLimitTimestamp = std::chrono::steady_clock::now();
+        this->msgTokens =
+          static_cast<double>(this->options.RateLimitBurstMsgs());
+        this->byteTokens =
+          static_cast<double>(this->options.RateLimitBurstBytes());
+
+        if (this->shared->dataPtr->slowSubscriberThreshold > 0)
+        {
+          this->slowWatch = this->shared->dataPtr->WatchSlowSubscribers(
+            this->addr, this->publisher.Topic());
+        }
+      }
+
+      /// \brief Check whether the topic has any subscriber.
+      /// \return True if a local or a remote node subscribes to the topic.
+      public: bool Listened() const
+      {
+        return this->interest && NodeSharedPrivate::Listened(*this->shared,
+          this->publisher.Topic(), *this->interest);
+      }
+
+      /// \brief Check whether a publication can be dropped right away,
+      /// before it is serialized, because nobody would receive it: the
+      /// topic has no subscriber, no tap and doesn't keep a history for the
+      /// late joiners.
+      /// \return True if the publication can be dropped.
+      public: bool Unheard() const
+      {
+        return this->interest && this->shared->dataPtr->tappedTopics == 0 &&
+          this->publisher.Options().HistoryDepth() == 0 && !this->Listened();
       }
 
       /// \brief Check if this Publisher is ready to send an update based on
@@ -122,7 +176,7 @@ namespace gz
       /// \return True if it is okay to publish, false otherwise.
       public: bool ThrottledUpdateReady() const
       {
-        if (!this->publisher.Options().Throttled())
+        if (!this->throttled.load(std::memory_order_relaxed))
           return true;
 
         Timestamp now = std::chrono::steady_clock::now();
@@ -141,7 +195,7 @@ namespace gz
       /// \return True if it is okay to publish, false otherwise.
       public: bool UpdateThrottling()
       {
-        if (!this->publisher.Options().Throttled())
+        if (!this->throttled.load(std::memory_order_relaxed))
           return true;
 
         if (!this->ThrottledUpdateReady())
@@ -153,6 +207,119 @@ namespace gz
         return true;
       }
 
+      /// \brief Take the tokens of a message from the buckets of the rate
+      /// limit, see AdvertiseMessageOptions::SetRateLimit(). The buckets are
+      /// refilled first according to the time elapsed since the last call.
+      /// \param[in] _size Size of the serialized message.
+      /// \return True if the message can be published.
+      public: bool UpdateRateLimit(const std::size_t _size)
+      {
+        if (!this->rateLimited.load(std::memory_order_relaxed))
+          return true;
+
+        Timestamp now = std::chrono::steady_clock::now();
+
+        std::lock_guard<std::mutex> lk(this->mutex);
+        const AdvertiseMessageOptions &opts = this->options;
+        const double elapsed = std::chrono::duration<double>(
+          now - this->lastRateLimitTimestamp).count();
+        this->lastRateLimitTimestamp = now;
+
+        const double burstMsgs =
+          static_cast<double>(opts.RateLimitBurstMsgs());
+        const double burstBytes =
+          static_cast<double>(opts.RateLimitBurstBytes());
+        this->msgTokens = std::min(burstMsgs, this->msgTokens +
+          elapsed * static_cast<double>(opts.RateLimitMsgsPerSec()));
+        this->byteTokens = std::min(burstBytes, this->byteTokens +
+          elapsed * static_cast<double>(opts.RateLimitBytesPerSec()));
+
+        // A message bigger than the byte bucket waits for a full bucket and
+        // leaves a debt that delays the next messages.
+        const double size = static_cast<double>(_size);
+        if ((opts.RateLimitMsgsPerSec() > 0 && this->msgTokens < 1.0) ||
+            (opts.RateLimitBytesPerSec() > 0 &&
+             this->byteTokens < std::min(size, burstBytes)))
+        {
+          return false;
+        }
+
+        this->msgTokens -= 1.0;
+        this->byteTokens -= size;
+        return true;
+      }
+
+      /// \brief Check if a message has to be sent to the remote subscribers
+      /// given the highest rate that they requested, and if so, advance the
+      /// internal timestamp of the remote messages.
+      /// \param[in] _subscribers The subscribers of the message.
+      /// \return True if the message has to be sent.
+      public: bool UpdateRemoteThrottling(
+        const NodeShared::MatchingSubscriberInfo &_subscribers)
+      {
+        if (!_subscribers.haveRemote)
+          return false;
+
+        // The messages are sent at twice the requested rate, so the
+        // throttling of the subscribers still finds one message per period
+        // despite the jitter of the network.
+        double periodNs = 0.0;
+        if (_subscribers.remoteMsgsPerSec != kUnthrottled &&
+            _subscribers.remoteMsgsPerSec != 0)
+        {
+          periodNs =
+            0.5e9 / static_cast<double>(_subscribers.remoteMsgsPerSec);
+        }
+
+        // The messages are conflated while a subscriber of the socket is
+        // slow.
+        const uint64_t slowMsgsPerSec =
+          this->slowSubscriberMsgsPerSec.load(std::memory_order_relaxed);
+        if (this->slowWatch && this->slowWatch->slow > 0 &&
+            slowMsgsPerSec != kUnthrottled && slowMsgsPerSec > 0)
+        {
+          periodNs = std::max(periodNs,
+            1e9 / static_cast<double>(slowMsgsPerSec));
+        }
+
+        if (periodNs <= 0.0)
+          return true;
+
+        Timestamp now = std::chrono::steady_clock::now();
+
+        std::lock_guard<std::mutex> lk(this->mutex);
+        if (std::chrono::duration_cast<std::chrono::nanoseconds>(
+              now - this->lastRemoteTimestamp).count() < periodNs)
+        {
+          return false;
+        }
+
+        this->lastRemoteTimestamp = now;
+        return true;
+      }
+
+      /// \brief Apply the options that can change while the topic is
+      /// advertised, see Node::Publisher::UpdateOptions(). The publications
+      /// read them without locking mutex, which must be locked by the
+      /// caller unless the publisher is being constructed.
+      /// \param[in] _options The options.
+      public: void ApplyOptions(const AdvertiseMessageOptions &_options)
+      {
+        this->options = _options;
+        this->periodNs =
+          _options.Throttled() ? 1e9 / _options.MsgsPerSec() : 0.0;
+        this->throttled = _options.Throttled();
+        this->rateLimited = _options.RateLimited();
+        this->priority = _options.Priority();
+        this->slowSubscriberMsgsPerSec = _options.SlowSubscriberMsgsPerSec();
+
+        // The buckets keep their tokens, up to their new size.
+        this->msgTokens = std::min(this->msgTokens,
+          static_cast<double>(_options.RateLimitBurstMsgs()));
+        this->byteTokens = std::min(this->byteTokens,
+          static_cast<double>(_options.RateLimitBurstBytes()));
+      }
+
       /// \brief Check if this Publisher is valid
       /// \return True if we have a topic to publish to, otherwise false.
       public: bool Valid()
@@ -163,6 +330,22 @@ namespace gz
       /// \brief Destructor.
       public: virtual ~PublisherPrivate()
       {
+        // The watch may outlive this object while a callback is notified.
+        if (this->slowWatch)
+        {
+          std::lock_guard<std::mutex> slowLk(this->slowWatch->mutex);
+          this->slowWatch->callback = nullptr;
+        }
+
+        // Send the pending batch before the subscribers disconnect, the
+        // process might exit right after.
+        if (this->publisher.Options().Batched())
+        {
+          std::lock_guard<std::mutex> pubLk(
+            this->shared->dataPtr->publisherMutex);
+          this->shared->dataPtr->FlushBatches(this->publisher.Topic());
+        }
+
         std::lock_guard<std::recursive_mutex> lk(this->shared->mutex);
         // Notify the discovery service to unregister and unadvertise my topic.
         if (!this->shared->dataPtr->msgDiscovery->Unadvertise(
@@ -171,20 +354,136 @@ namespace gz
           std::cerr << "~PublisherPrivate() Error unadvertising topic ["
                     << this->publisher.Topic() << "]" << std::endl;
         }
+        this->shared->dataPtr->UnadvertiseAliases(this->publisher.Topic(),
+          this->publisher.NUuid());
+
+        if (this->Valid())
+        {
+          this->shared->dataPtr->RemoveAdvertisedType(this->publisher.Topic(),
+            this->publisher.MsgTypeName());
+        }
       }
 
-      /// \brief Create a MessageInfo object for this Publisher
-      MessageInfo CreateMessageInfo()
+      /// \brief Publish a message to all the local, raw and remote
+      /// subscribers.
+      /// \param[in] _msg The message to publish.
+      /// \param[in] _sharedMsg If not null, pointer to _msg that will be
+      /// shared with the local subscribers instead of copying _msg.
+      /// \param[in] _checkType False if the type of _msg is known to match
+      /// the advertised type.
+      /// \return true when success.
+      public: bool Publish(const ProtoMsg &_msg,
+                           const std::shared_ptr<const ProtoMsg> &_sharedMsg,
+                           bool _checkType = true);
+
+      /// \brief Get a buffer to store a serialized message. The buffer is
+      /// taken from the buffer pool if enabled.
+      /// \param[in] _size Size of the buffer (bytes).
+      /// \return The buffer.
+      public: SerializedBuffer NewBuffer(const std::size_t _size)
       {
-        MessageInfo info;
+        if (!this->bufferPool)
+          return SerializedBuffer(_size);
+
+        uint64_t faultsSaved = 0;
+        SerializedBuffer buffer =
+          this->bufferPool->Acquire(_size, &faultsSaved);
+        if (faultsSaved > 0 && this->shared->dataPtr->metrics)
+        {
+          auto &metrics = *this->shared->dataPtr->metrics;
+          metrics.Add(this->publisher.Topic(),
+            TransportMetrics::HUGE_PAGE_BUFFERS);
+          metrics.Add(this->publisher.Topic(),
+            TransportMetrics::HUGE_PAGE_FAULTS_SAVED, faultsSaved);
+        }
+        return buffer;
+      }
+
+      /// \brief Publish a serialized message to the remote subscribers.
+      /// The message is compressed and added to a batch if enabled.
+      /// \param[in] _data Serialized message.
+      /// \param[in] _size Size of the message (bytes).
+      /// \param[in] _msgType Type of the message.
+      /// \param[in] _buffer Buffer storing _data, shared with zmq. If null,
+      /// the message is copied when it is not batched.
+      /// \return true when success.
+      public: bool PublishRemote(const char *_data, std::size_t _size,
+                                 const std::string &_msgType,
+                                 const SerializedBuffer *_buffer)
+      {
+        // The messages of a topic in lockstep are counted before they are
+        // sent, so that a remote process never counts more of them.
+        LockstepTracker &lockstep = this->shared->dataPtr->lockstep;
+        if (lockstep.Tracked(this->publisher.Topic()))
+        {
+          MsgAddresses_M remotes;
+          {
+            std::lock_guard<std::recursive_mutex> lk(this->shared->mutex);
+            this->shared->remoteSubscribers.Publishers(
+              this->publisher.Topic(), remotes);
+          }
+          for (const auto &remote : remotes)
+            lockstep.Sent(this->publisher.Topic(), remote.first);
+        }
+
+        // The peers of the previous wire protocol receive the message as it
+        // is serialized, without the flags.
+        this->shared->dataPtr->PublishLegacy(this->publisher.Topic(), _data,
+          _size, _msgType);
 
-        // Set the topic and the partition at the same time
-        info.SetTopicAndPartition(this->publisher.Topic());
+        const AdvertiseMessageOptions &opts = this->publisher.Options();
+        uint32_t flags =
+          priorityFlags(this->priority.load(std::memory_order_relaxed));
+        if (opts.Reliable())
+          flags |= kHeaderReliable;
 
-        // Set the message type name
-        info.SetType(this->publisher.MsgTypeName());
+        // A data-plane backend sends the messages as they are serialized.
+        const bool backend = this->shared->dataPtr->backend != nullptr;
 
-        return info;
+        // Only keep the compressed message if it is smaller.
+        SerializedBuffer compressed;
+        if (!backend && opts.Compression() != Compression_t::NONE &&
+            _size >= opts.CompressionMinSize())
+        {
+          const std::size_t bound = CompressBound(opts.Compression(), _size);
+          if (bound > 0)
+          {
+            compressed = this->NewBuffer(bound);
+            const std::size_t compressedSize = Compress(opts.Compression(),
+              opts.CompressionLevel(), _data, _size, compressed.Data(),
+              bound);
+            if (compressedSize > 0 && compressedSize < _size)
+            {
+              _data = compressed.Data();
+              _size = compressedSize;
+              _buffer = &compressed;
+              flags |= static_cast<uint32_t>(opts.Compression()) <<
+                kHeaderCodecShift;
+            }
+          }
+        }
+
+        if (!backend && opts.Batched())
+        {
+          return this->shared->dataPtr->PublishBatched(
+            this->publisher.Topic(), this->addr, _data, _size,
+            _msgType, opts.BatchDelay(), opts.BatchSize(), flags);
+        }
+
+        SerializedBuffer copy;
+        if (!_buffer)
+        {
+          copy = this->NewBuffer(_size);
+          memcpy(copy.Data(), _data, _size);
+          _buffer = &copy;
+        }
+
+        // Zmq holds its own reference to the buffer and releases it through
+        // the deallocator when the message is published.
+        return this->shared->dataPtr->Publish(this->publisher.Topic(),
+          this->addr, _buffer->Data(), _size,
+          &SerializedBuffer::ZmqDeallocator, _msgType, _buffer->ZmqHint(),
+          flags);
       }
 
       /// \brief Pointer to the object shared between all the nodes within the
@@ -194,15 +493,67 @@ namespace gz
       /// \brief The message publisher.
       public: MessagePublisher publisher;
 
+      /// \brief Information of the messages published locally. It is
+      /// computed once and copied for every message, which shares the
+      /// topic, partition and type names instead of parsing them again.
+      public: MessageInfo info;
+
+      /// \brief Address of the publisher socket, the shared one or the one
+      /// of the channel of the topic.
+      public: std::string addr;
+
       /// \brief Timestamp of the last callback executed.
       public: Timestamp lastCbTimestamp;
 
+      /// \brief Timestamp of the last message sent to the remote
+      /// subscribers, see UpdateRemoteThrottling().
+      public: Timestamp lastRemoteTimestamp;
+
       /// \brief If throttling is enabled, the minimum period for receiving a
       /// message in nanoseconds.
       public: double periodNs = 0.0;
 
+      /// \brief Last time the buckets of the rate limit were refilled.
+      public: Timestamp lastRateLimitTimestamp;
+
+      /// \brief Tokens in the message bucket of the rate limit.
+      public: double msgTokens = 0.0;
+
+      /// \brief Tokens in the byte bucket of the rate limit.
+      public: double byteTokens = 0.0;
+
+      /// \brief Options of the publisher, with the changes made by
+      /// Node::Publisher::UpdateOptions(). Protected by mutex.
+      public: AdvertiseMessageOptions options;
+
+      /// \brief Whether the publications are throttled, see periodNs.
+      public: std::atomic<bool> throttled{false};
+
+      /// \brief Whether the publications are limited by the buckets.
+      public: std::atomic<bool> rateLimited{false};
+
+      /// \brief Priority of the publications.
+      public: std::atomic<Priority_t> priority{Priority_t::NORMAL};
+
+      /// \brief Rate of the messages sent to the remote subscribers while
+      /// a subscriber of the socket is slow.
+      public: std::atomic<uint64_t> slowSubscriberMsgsPerSec{kUnthrottled};
+
       /// \brief Mutex to protect the node::publisher from race conditions.
       public: mutable std::mutex mutex;
+
+      /// \brief Pool of serialization buffers. Null if neither the pool nor
+      /// the huge pages are enabled.
+      public: std::unique_ptr<BufferPool> bufferPool;
+
+      /// \brief Whether the topic has subscribers, shared with the other
+      /// publishers of the topic. Null for an invalid publisher.
+      public: std::shared_ptr<NodeSharedPrivate::TopicInterest> interest;
+
+      /// \brief Slow subscribers of the socket of the publisher. Null if
+      /// the detection is disabled (see GZ_TRANSPORT_SLOW_SUBSCRIBER).
+      public: std::shared_ptr<NodeSharedPrivate::SlowSubscriberWatch>
+        slowWatch;
     };
     }
   }
@@ -218,10 +569,23 @@ Node::Publisher::Publisher()
 Node::Publisher::Publisher(const MessagePublisher &_publisher)
   : dataPtr(std::make_shared<PublisherPrivate>(_publisher))
 {
-  if (this->dataPtr->publisher.Options().Throttled())
+  // Without a pool size, the pool only allocates the huge pages.
+  const AdvertiseMessageOptions &pubOpts = this->dataPtr->publisher.Options();
+  if (pubOpts.BufferPoolSize() > 0 ||
+      pubOpts.HugePages() != HugePages_t::NONE)
+  {
+    this->dataPtr->bufferPool = std::make_unique<BufferPool>(
+      pubOpts.BufferPoolSize(), pubOpts.HugePages(),
+      pubOpts.HugePagesMinSize());
+  }
+
+  const Compression_t codec = this->dataPtr->publisher.Options().Compression();
+  if (codec != Compression_t::NONE && !CompressionAvailable(codec))
   {
-    this->dataPtr->periodNs =
-      1e9 / this->dataPtr->publisher.Options().MsgsPerSec();
+    std::cerr << "Compression [" << CompressionName(codec) << "] is not "
+              << "available, the messages on topic ["
+              << this->dataPtr->publisher.Topic() << "] are sent "
+              << "uncompressed" << std::endl;
   }
 }
 
@@ -248,6 +612,13 @@ bool Node::Publisher::Valid() const
   return this->dataPtr->Valid();
 }
 
+//////////////////////////////////////////////////
+bool Node::Publisher::WantsData() const
+{
+  return this->Valid() && !this->dataPtr->Unheard() &&
+    this->dataPtr->ThrottledUpdateReady();
+}
+
 //////////////////////////////////////////////////
 bool Node::Publisher::HasConnections() const
 {
@@ -255,74 +626,106 @@ bool Node::Publisher::HasConnections() const
   const std::string &topic = publisher.Topic();
   const std::string &msgType = publisher.MsgTypeName();
 
-  std::lock_guard<std::recursive_mutex> lk(this->dataPtr->shared->mutex);
+  if (!this->Valid() || !this->dataPtr->Listened())
+    return false;
 
   /// \todo(anyone): Checking "remoteSubscribers.HasTopic()" will return
   /// true even
   /// if the subscriber has not successfully authenticated with the
   /// publisher.
   /// See Issue #73
-  return this->Valid() &&
-    (this->dataPtr->shared->localSubscribers.HasSubscriber(topic, msgType) ||
-     this->dataPtr->shared->remoteSubscribers.HasTopic(topic, msgType));
+  const NodeShared::MatchingSubscriberInfo subscribers =
+    this->dataPtr->shared->CheckMatchingSubscribers(topic, msgType);
+  return subscribers.localHandlers || subscribers.rawHandlers ||
+    subscribers.haveRemote;
 }
 
 //////////////////////////////////////////////////
-bool Node::Publisher::Publish(const ProtoMsg &_msg)
+bool Node::PublisherPrivate::Publish(const ProtoMsg &_msg,
+    const std::shared_ptr<const ProtoMsg> &_sharedMsg, bool _checkType)
 {
-  if (!this->Valid())
-    return false;
-
-  const std::string &publisherMsgType = this->dataPtr->publisher.MsgTypeName();
+  // Once checked below, the advertised type is the type of the message.
+  const std::string &publisherMsgType = this->publisher.MsgTypeName();
 
   // Check that the msg type matches the topic type previously advertised.
-  if (publisherMsgType != _msg.GetTypeName())
+  if (_checkType && publisherMsgType != _msg.GetTypeName())
   {
     std::cerr << "Node::Publisher::Publish() Type mismatch.\n"
               << "\t* Type advertised: "
-              << this->dataPtr->publisher.MsgTypeName()
+              << this->publisher.MsgTypeName()
               << "\n\t* Type published: " << _msg.GetTypeName() << std::endl;
     return false;
   }
 
+  // Nobody would receive the message, don't even compute its size.
+  if (this->Unheard())
+    return true;
+
   // Check the publication throttling option.
   if (!this->UpdateThrottling())
     return true;
 
-  const std::string &publisherTopic = this->dataPtr->publisher.Topic();
-
-  const NodeShared::SubscriberInfo &subscribers =
-      this->dataPtr->shared->CheckSubscriberInfo(
-        publisherTopic, publisherMsgType);
-
   // The serialized message size and buffer.
 #if GOOGLE_PROTOBUF_VERSION >= 3004000
   const std::size_t msgSize = static_cast<std::size_t>(_msg.ByteSizeLong());
 #else
   const std::size_t msgSize = static_cast<std::size_t>(_msg.ByteSize());
 #endif
-  char *msgBuffer = nullptr;
+  SerializedBuffer msgBuffer;
 
-  // Only serialize the message if we have a raw subscriber or a remote
-  // subscriber.
-  if (subscribers.haveRaw || subscribers.haveRemote)
+  // Check the rate limit option.
+  if (!this->UpdateRateLimit(msgSize))
+    return true;
+
+  const std::string &publisherTopic = this->publisher.Topic();
+
+  // The span of the publication travels with the message.
+  TraceScope span(this->shared->dataPtr->tracer.get(), "publish",
+    publisherTopic, Tracer::kFlowOut);
+  GZ_TRANSPORT_PROBE_SCOPE(publish, publisherTopic.c_str());
+
+  NodeShared::MatchingSubscriberInfo subscribers =
+      this->shared->CheckMatchingSubscribers(
+        publisherTopic, publisherMsgType);
+
+  // The taps of the topic replace some raw subscriptions.
+  const NodeSharedPrivate::TapList taps =
+    this->shared->dataPtr->Taps(publisherTopic);
+  if (taps)
+    NodeSharedPrivate::Untap(*taps, subscribers);
+
+  const bool haveLocal = subscribers.localHandlers != nullptr;
+  const bool haveRaw = subscribers.rawHandlers != nullptr;
+  const bool sendRemote = this->UpdateRemoteThrottling(subscribers);
+  const bool latched = this->publisher.Options().HistoryDepth() > 0;
+
+  // Only serialize the message if we have a raw subscriber, a remote
+  // subscriber or a tap, or if it is kept for the late joiners. The message
+  // is serialized once and the same buffer is shared between the raw
+  // handlers, the taps and the ZMQ socket.
+  if (haveRaw || sendRemote || latched || taps)
   {
     // Allocate the buffer to store the serialized data.
-    msgBuffer = static_cast<char *>(new char[msgSize]);
+    msgBuffer = this->NewBuffer(msgSize);
 
     // Fail out early if we are unable to serialize the message. We do not
     // want to send a corrupt/bad message to some subscribers and not others.
-    if (!_msg.SerializeToArray(msgBuffer, msgSize))
+    if (!_msg.SerializeToArray(msgBuffer.Data(), msgSize))
     {
-      delete[] msgBuffer;
       std::cerr << "Node::Publisher::Publish(): Error serializing data"
                 << std::endl;
       return false;
     }
   }
 
+  if (latched)
+  {
+    this->shared->dataPtr->Latch(publisherTopic, publisherMsgType,
+      msgBuffer.Data(), msgSize);
+  }
+
   // Local and raw subscribers.
-  if (subscribers.haveLocal || subscribers.haveRaw)
+  if (haveLocal || haveRaw)
   {
     std::unique_ptr<NodeSharedPrivate::PublishMsgDetails> pubMsgDetails(
       new NodeSharedPrivate::PublishMsgDetails);
@@ -331,106 +734,138 @@ bool Node::Publisher::Publish(const ProtoMsg &_msg)
     // This must be a shared pointer so that we can pass it to
     // multiple threads below, and then allow this function to go
     // out of scope.
-    pubMsgDetails->info.SetTopicAndPartition(this->dataPtr->publisher.Topic());
-    pubMsgDetails->info.SetType(this->dataPtr->publisher.MsgTypeName());
-    pubMsgDetails->info.SetIntraProcess(true);
+    pubMsgDetails->info = this->info;
+    pubMsgDetails->priority = this->priority.load(std::memory_order_relaxed);
 
-    pubMsgDetails->msgCopy.reset(_msg.New());
-    pubMsgDetails->msgCopy->CopyFrom(_msg);
+    // Publications dropped because a subscriber queue is full.
+    uint64_t queueDrops = 0;
 
-    if (subscribers.haveLocal)
+    if (haveLocal)
     {
-      for (const auto &node : subscribers.localHandlers)
+      // The handlers already match the type of the message.
+      for (const auto &handler : *subscribers.localHandlers)
       {
-        for (const auto &handler : node.second)
-        {
-          if (!handler.second)
-          {
-            std::cerr << "Node::Publisher::Publish(): "
-                      << "NULL local subscription handler" << std::endl;
-            continue;
-          }
-
-          if (handler.second->TypeName() != kGenericMessageType &&
-              handler.second->TypeName() != _msg.GetTypeName())
-          {
-            continue;
-          }
+        if (!handler->CheckFilter(_msg))
+          continue;
+
+        uint64_t seq;
+        uint64_t dropped;
+        const bool queued = handler->ReserveQueueSlot(seq, dropped, msgSize);
+        queueDrops += dropped;
+        if (!queued)
+          continue;
+
+        pubMsgDetails->localHandlers.push_back(handler);
+        pubMsgDetails->localSeqs.push_back(seq);
+      }
 
-          pubMsgDetails->localHandlers.push_back(handler.second);
+      // Don't copy a message discarded by the filters of all the handlers.
+      if (!pubMsgDetails->localHandlers.empty())
+      {
+        if (_sharedMsg)
+        {
+          // The caller handed over a read-only message, share it as is.
+          pubMsgDetails->msgCopy = _sharedMsg;
+        }
+        else
+        {
+          std::unique_ptr<ProtoMsg> msgCopy(_msg.New());
+          msgCopy->CopyFrom(_msg);
+          pubMsgDetails->msgCopy = std::move(msgCopy);
         }
       }
     }
 
-    if (subscribers.haveRaw)
+    if (haveRaw)
     {
-      for (auto &node : subscribers.rawHandlers)
+      for (const auto &rawHandler : *subscribers.rawHandlers)
       {
-        for (auto &handler : node.second)
-        {
-          const RawSubscriptionHandlerPtr &rawHandler = handler.second;
+        if (!rawHandler->CheckFilter(_msg))
+          continue;
 
-          if (!rawHandler)
-          {
-            std::cerr << "Node::Publisher::Publish(): "
-                      << "NULL raw subscription handler" << std::endl;
-            continue;
-          }
+        uint64_t seq;
+        uint64_t dropped;
+        const bool queued = rawHandler->ReserveQueueSlot(seq, dropped, msgSize);
+        queueDrops += dropped;
+        if (!queued)
+          continue;
 
-          if (rawHandler->TypeName() != kGenericMessageType &&
-              rawHandler->TypeName() != _msg.GetTypeName())
-          {
-            continue;
-          }
-
-          if (!pubMsgDetails->sharedBuffer)
-          {
-            pubMsgDetails->msgSize = msgSize;
-            // If the sharedBuffer has not been created, do so now.
-            pubMsgDetails->sharedBuffer.reset(new char[msgSize]);
-            memcpy(pubMsgDetails->sharedBuffer.get(), msgBuffer, msgSize);
-          }
-          pubMsgDetails->rawHandlers.push_back(rawHandler);
+        if (!pubMsgDetails->sharedBuffer)
+        {
+          pubMsgDetails->msgSize = msgSize;
+          pubMsgDetails->sharedBuffer = msgBuffer;
         }
+        pubMsgDetails->rawHandlers.push_back(rawHandler);
+        pubMsgDetails->rawSeqs.push_back(seq);
       }
     }
 
     // Add the publish message details to the publish queue. The message
     // will be published asynchronously to the local and raw callbacks.
+    if (!pubMsgDetails->localHandlers.empty() ||
+        !pubMsgDetails->rawHandlers.empty())
     {
-      std::unique_lock<std::mutex> queueLock(
-          this->dataPtr->shared->dataPtr->pubThreadMutex);
-      this->dataPtr->shared->dataPtr->pubQueue.push_back(
-          std::move(pubMsgDetails));
+      pubMsgDetails->lockstep =
+        this->shared->dataPtr->lockstep.Deliver(publisherTopic);
+      queueDrops +=
+        this->shared->dataPtr->EnqueuePublication(std::move(pubMsgDetails));
     }
 
-    this->dataPtr->shared->dataPtr->signalNewPub.notify_one();
+    if (queueDrops > 0)
+      this->shared->AddQueueDrops(publisherTopic, queueDrops);
   }
 
-  // Handle remote subscribers.
-  if (subscribers.haveRemote)
+  // The taps run on this thread.
+  if (taps)
   {
-    // Zmq will call this lambda when the message is published.
-    // We use it to deallocate the buffer.
-    auto myDeallocator = [](void *_buffer, void *)
-    {
-      delete[] reinterpret_cast<char*>(_buffer);
-    };
-
-    if (!this->dataPtr->shared->Publish(this->dataPtr->publisher.Topic(),
-          msgBuffer, msgSize, myDeallocator, _msg.GetTypeName()))
-    {
-      return false;
-    }
+    NodeSharedPrivate::RunTaps(*taps, msgBuffer.Shared(), msgSize,
+      this->info);
   }
-  else
+
+  // Handle remote subscribers.
+  if (sendRemote &&
+      !this->PublishRemote(msgBuffer.Data(), msgSize, publisherMsgType,
+        &msgBuffer))
   {
-    delete[] msgBuffer;
+    return false;
   }
 
   return true;
 }
 
+//////////////////////////////////////////////////
+bool Node::Publisher::Publish(const ProtoMsg &_msg)
+{
+  if (!this->Valid())
+    return false;
+
+  return this->dataPtr->Publish(_msg, nullptr);
+}
+
+//////////////////////////////////////////////////
+bool Node::Publisher::PublishTyped(const ProtoMsg &_msg)
+{
+  if (!this->Valid())
+    return false;
+
+  return this->dataPtr->Publish(_msg, nullptr, false);
+}
+
+//////////////////////////////////////////////////
+bool Node::Publisher::Publish(const std::shared_ptr<const ProtoMsg> &_msg)
+{
+  if (!this->Valid())
+    return false;
+
+  if (!_msg)
+  {
+    std::cerr << "Node::Publisher::Publish() NULL message" << std::endl;
+    return false;
+  }
+
+  return this->dataPtr->Publish(*_msg, _msg);
+}
+
 //////////////////////////////////////////////////
 bool Node::Publisher::PublishRaw(
     const std::string &_msgData,
@@ -450,43 +885,304 @@ bool Node::Publisher::PublishRaw(
     return false;
   }
 
+  return this->PublishRawData(_msgData, _msgType);
+}
+
+//////////////////////////////////////////////////
+bool Node::Publisher::PublishRaw(std::string_view _msgData)
+{
+  if (!this->dataPtr->Valid())
+    return false;
+
+  const std::string &msgType = this->dataPtr->publisher.MsgTypeName();
+  if (msgType == kGenericMessageType)
+  {
+    std::cerr << "Node::Publisher::PublishRaw() requires the type of the "
+              << "message on a topic advertised with kGenericMessageType"
+              << std::endl;
+    return false;
+  }
+
+  return this->PublishRawData(_msgData, msgType);
+}
+
+//////////////////////////////////////////////////
+bool Node::Publisher::PublishRawData(std::string_view _msgData,
+    const std::string &_msgType)
+{
+  if (this->dataPtr->Unheard())
+    return true;
+
   if (!this->dataPtr->UpdateThrottling())
     return true;
 
+  if (!this->dataPtr->UpdateRateLimit(_msgData.size()))
+    return true;
+
   const std::string &topic = this->dataPtr->publisher.Topic();
+  TraceScope span(this->dataPtr->shared->dataPtr->tracer.get(), "publish",
+    topic, Tracer::kFlowOut);
+  GZ_TRANSPORT_PROBE_SCOPE(publish, topic.c_str());
+
+  NodeShared::MatchingSubscriberInfo subscribers =
+      this->dataPtr->shared->CheckMatchingSubscribers(topic, _msgType);
+
+  // The taps of the topic replace some raw subscriptions.
+  const NodeSharedPrivate::TapList taps =
+    this->dataPtr->shared->dataPtr->Taps(topic);
+  if (taps)
+    NodeSharedPrivate::Untap(*taps, subscribers);
 
-  const NodeShared::SubscriberInfo &subscribers =
-      this->dataPtr->shared->CheckSubscriberInfo(topic, _msgType);
+  MessageInfo info(this->dataPtr->info);
+  if (info.Type() != _msgType)
+    info.SetType(_msgType);
 
-  MessageInfo info;
-  info.SetTopicAndPartition(topic);
-  info.SetType(_msgType);
-  info.SetIntraProcess(true);
+  if (this->dataPtr->publisher.Options().HistoryDepth() > 0)
+  {
+    this->dataPtr->shared->dataPtr->Latch(topic, _msgType, _msgData.data(),
+      _msgData.size());
+  }
 
   // Trigger local subscribers.
-  this->dataPtr->shared->TriggerCallbacks(info, _msgData, subscribers);
+  this->dataPtr->shared->TriggerCallbacks(info, _msgData.data(),
+    _msgData.size(), nullptr, subscribers, Priority_t::NORMAL,
+    this->dataPtr->shared->dataPtr->lockstep.Deliver(topic));
+
+  // The taps share a copy of the data, the view isn't owned.
+  if (taps)
+  {
+    SerializedBuffer buffer(_msgData.size());
+    memcpy(buffer.Data(), _msgData.data(), _msgData.size());
+    NodeSharedPrivate::RunTaps(*taps, buffer.Shared(), _msgData.size(), info);
+  }
 
   // Remote subscribers. Note that the data is already presumed to be
   // serialized, so we just pass it along for publication.
-  if (subscribers.haveRemote)
+  // Note: This will copy _msgData (i.e. not zero copy)
+  if (this->dataPtr->UpdateRemoteThrottling(subscribers) &&
+      !this->dataPtr->PublishRemote(_msgData.data(), _msgData.size(),
+        _msgType, nullptr))
   {
-    const std::size_t msgSize = _msgData.size();
-    char *msgBuffer = static_cast<char *>(new char[msgSize]);
-    memcpy(msgBuffer, _msgData.c_str(), msgSize);
-    auto myDeallocator = [](void *_buffer, void * /*_hint*/)
-    {
-      delete[] reinterpret_cast<char*>(_buffer);
-    };
+    return false;
+  }
 
-    // Note: This will copy _msgData (i.e. not zero copy)
-    if (!this->dataPtr->shared->Publish(
-          this->dataPtr->publisher.Topic(),
-          msgBuffer, msgSize, myDeallocator, _msgType))
-    {
+  return true;
+}
+
+//////////////////////////////////////////////////
+LoanedMessage Node::Publisher::Loan(const std::size_t _size)
+{
+  LoanedMessage msg;
+  if (!this->dataPtr->Valid())
+    return msg;
+
+  msg.dataPtr->buffer = this->dataPtr->NewBuffer(_size);
+  msg.dataPtr->size = _size;
+  return msg;
+}
+
+//////////////////////////////////////////////////
+LoanedMessage Node::Publisher::Adopt(char *_data, const std::size_t _size,
+    const std::function<void(char *_data)> &_release)
+{
+  LoanedMessage msg;
+  if (!_data)
+    return msg;
+
+  if (!this->dataPtr->Valid())
+  {
+    if (_release)
+      _release(_data);
+    return msg;
+  }
+
+  std::shared_ptr<char> storage = _release ?
+    std::shared_ptr<char>(_data, _release) :
+    std::shared_ptr<char>(_data, [](char *){});
+  msg.dataPtr->buffer = SerializedBuffer(std::move(storage), _size);
+  msg.dataPtr->size = _size;
+  return msg;
+}
+
+//////////////////////////////////////////////////
+bool Node::Publisher::PublishLoaned(
+    LoanedMessage &&_msg,
+    const std::string &_msgType)
+{
+  // The loan is released when this function returns.
+  LoanedMessage msg(std::move(_msg));
+
+  if (!this->dataPtr->Valid())
+    return false;
+
+  if (!msg.Valid())
+  {
+    std::cerr << "Node::Publisher::PublishLoaned() Invalid loan" << std::endl;
+    return false;
+  }
+
+  const std::string &publisherMsgType = this->dataPtr->publisher.MsgTypeName();
+
+  if (publisherMsgType != _msgType && publisherMsgType != kGenericMessageType)
+  {
+    std::cerr << "Node::Publisher::PublishLoaned() type mismatch.\n"
+              << "\t* Type advertised: "
+              << this->dataPtr->publisher.MsgTypeName()
+              << "\n\t* Type published: " << _msgType << std::endl;
+    return false;
+  }
+
+  if (this->dataPtr->Unheard())
+    return true;
+
+  if (!this->dataPtr->UpdateThrottling())
+    return true;
+
+  const SerializedBuffer &msgBuffer = msg.dataPtr->buffer;
+  const std::size_t msgSize = msg.dataPtr->size;
+
+  if (!this->dataPtr->UpdateRateLimit(msgSize))
+    return true;
+
+  const std::string &topic = this->dataPtr->publisher.Topic();
+  TraceScope span(this->dataPtr->shared->dataPtr->tracer.get(), "publish",
+    topic, Tracer::kFlowOut);
+  GZ_TRANSPORT_PROBE_SCOPE(publish, topic.c_str());
+
+  NodeShared::MatchingSubscriberInfo subscribers =
+      this->dataPtr->shared->CheckMatchingSubscribers(topic, _msgType);
+
+  // The taps of the topic replace some raw subscriptions.
+  const NodeSharedPrivate::TapList taps =
+    this->dataPtr->shared->dataPtr->Taps(topic);
+  if (taps)
+    NodeSharedPrivate::Untap(*taps, subscribers);
+
+  MessageInfo info(this->dataPtr->info);
+  if (info.Type() != _msgType)
+    info.SetType(_msgType);
+
+  if (this->dataPtr->publisher.Options().HistoryDepth() > 0)
+  {
+    this->dataPtr->shared->dataPtr->Latch(topic, _msgType, msgBuffer.Data(),
+      msgSize);
+  }
+
+  // Trigger local subscribers. The asynchronous raw callbacks keep a
+  // reference to the buffer.
+  this->dataPtr->shared->TriggerCallbacks(info, msgBuffer.Data(), msgSize,
+      &msgBuffer, subscribers,
+      this->dataPtr->priority.load(std::memory_order_relaxed),
+      this->dataPtr->shared->dataPtr->lockstep.Deliver(topic));
+
+  // The taps keep a reference to the buffer as well.
+  if (taps)
+    NodeSharedPrivate::RunTaps(*taps, msgBuffer.Shared(), msgSize, info);
+
+  // Remote subscribers. Zmq holds its own reference to the buffer.
+  if (this->dataPtr->UpdateRemoteThrottling(subscribers) &&
+      !this->dataPtr->PublishRemote(msgBuffer.Data(), msgSize, _msgType,
+        &msgBuffer))
+  {
+    return false;
+  }
+
+  return true;
+}
+
+//////////////////////////////////////////////////
+uint64_t Node::Publisher::BufferPoolHits() const
+{
+  if (!this->dataPtr->bufferPool ||
+      this->dataPtr->bufferPool->MaxBytes() == 0)
+  {
+    return 0;
+  }
+  return this->dataPtr->bufferPool->Hits();
+}
+
+//////////////////////////////////////////////////
+uint64_t Node::Publisher::BufferPoolMisses() const
+{
+  if (!this->dataPtr->bufferPool ||
+      this->dataPtr->bufferPool->MaxBytes() == 0)
+  {
+    return 0;
+  }
+  return this->dataPtr->bufferPool->Misses();
+}
+
+//////////////////////////////////////////////////
+uint64_t Node::Publisher::HugePageFaultsSaved() const
+{
+  if (!this->dataPtr->bufferPool)
+    return 0;
+  return this->dataPtr->bufferPool->HugePageFaultsSaved();
+}
+
+//////////////////////////////////////////////////
+bool Node::Publisher::SetSlowSubscriberCallback(
+    const SlowSubscriberCallback &_cb)
+{
+  auto &watch = this->dataPtr->slowWatch;
+  if (!watch)
+    return false;
+
+  std::lock_guard<std::mutex> lk(watch->mutex);
+  watch->callback = _cb;
+  return true;
+}
+
+//////////////////////////////////////////////////
+uint32_t Node::Publisher::SlowSubscribers() const
+{
+  const auto &watch = this->dataPtr->slowWatch;
+  return watch ? watch->slow.load() : 0u;
+}
+
+//////////////////////////////////////////////////
+AdvertiseMessageOptions Node::Publisher::Options() const
+{
+  std::lock_guard<std::mutex> lk(this->dataPtr->mutex);
+  return this->dataPtr->options;
+}
+
+//////////////////////////////////////////////////
+bool Node::Publisher::UpdateOptions(const AdvertiseMessageOptions &_options)
+{
+  if (!this->Valid())
+    return false;
+
+  {
+    std::lock_guard<std::mutex> lk(this->dataPtr->mutex);
+
+    // Only the options that the publications read at runtime can change.
+    AdvertiseMessageOptions expected = this->dataPtr->options;
+    expected.SetMsgsPerSec(_options.MsgsPerSec());
+    expected.SetRateLimit(_options.RateLimitMsgsPerSec(),
+      _options.RateLimitBytesPerSec(), _options.RateLimitBurstMsgs(),
+      _options.RateLimitBurstBytes());
+    expected.SetPriority(_options.Priority());
+    expected.SetSlowSubscriberMsgsPerSec(_options.SlowSubscriberMsgsPerSec());
+    if (expected != _options)
       return false;
-    }
+
+    if (_options == this->dataPtr->options)
+      return true;
+
+    this->dataPtr->ApplyOptions(_options);
   }
 
+  // The other processes replace the information of the publisher.
+  MessagePublisher updated(this->dataPtr->publisher);
+  updated.SetOptions(_options);
+
+  std::lock_guard<std::recursive_mutex> lk(this->dataPtr->shared->mutex);
+  if (!this->dataPtr->shared->dataPtr->msgDiscovery->Update(updated))
+  {
+    std::cerr << "Node::Publisher::UpdateOptions() Error updating topic ["
+              << updated.Topic() << "]" << std::endl;
+  }
   return true;
 }
 
@@ -523,10 +1219,14 @@ Node::Node():
 //////////////////////////////////////////////////
 Node::~Node()
 {
-  // Unsubscribe from all the topics.
-  auto subsTopics = this->SubscribedTopics();
-  for (auto const &topic : subsTopics)
-    this->Unsubscribe(topic);
+  // Unsubscribe from all the topics. The topics are already qualified and
+  // the lock is taken once, so the publishers are only held back briefly.
+  {
+    std::lock_guard<std::recursive_mutex> lk(this->dataPtr->shared->mutex);
+    const auto subsTopics = this->dataPtr->topicsSubscribed;
+    for (auto const &topic : subsTopics)
+      this->dataPtr->Unsubscribe(topic);
+  }
 
   // The list of subscribed topics should be empty.
   assert(this->SubscribedTopics().empty());
@@ -590,11 +1290,174 @@ std::vector<std::string> Node::SubscribedTopics() const
     v.push_back(topic);
   }
 
-  return v;
+  return v;
+}
+
+//////////////////////////////////////////////////
+bool Node::Unsubscribe(const std::string &_topic)
+{
+  // Topic remapping.
+  std::string topic = _topic;
+  this->Options().TopicRemap(_topic, topic);
+
+  std::string fullyQualifiedTopic;
+  if (!TopicUtils::FullyQualifiedName(this->Options().Partition(),
+    this->Options().NameSpace(), _topic, fullyQualifiedTopic))
+  {
+    std::cerr << "Topic [" << _topic << "] is not valid." << std::endl;
+    return false;
+  }
+
+  std::lock_guard<std::recursive_mutex> lk(this->dataPtr->shared->mutex);
+  return this->dataPtr->Unsubscribe(fullyQualifiedTopic);
+}
+
+//////////////////////////////////////////////////
+bool Node::UpdateSubscription(const std::string &_topic,
+    const SubscribeOptions &_opts)
+{
+  // Topic remapping.
+  std::string topic = _topic;
+  this->Options().TopicRemap(_topic, topic);
+
+  std::string fullyQualifiedTopic;
+  if (!TopicUtils::FullyQualifiedName(this->Options().Partition(),
+    this->Options().NameSpace(), topic, fullyQualifiedTopic))
+  {
+    std::cerr << "Topic [" << topic << "] is not valid." << std::endl;
+    return false;
+  }
+
+  std::lock_guard<std::recursive_mutex> lk(this->dataPtr->shared->mutex);
+  if (this->dataPtr->topicsSubscribed.count(fullyQualifiedTopic) == 0)
+    return false;
+
+  auto update = [&](const auto &_storage)
+  {
+    const auto entries = _storage.TopicHandlers(fullyQualifiedTopic);
+    if (!entries)
+      return;
+
+    for (const auto &entry : *entries)
+    {
+      if (entry.nUuid == this->dataPtr->nUuid)
+        entry.handler->UpdateOptions(_opts);
+    }
+  };
+  update(this->dataPtr->shared->localSubscribers.normal);
+  update(this->dataPtr->shared->localSubscribers.raw);
+
+  this->dataPtr->shared->dataPtr->UpdateSubscribers(*this->dataPtr->shared,
+    fullyQualifiedTopic, this->dataPtr->nUuid);
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool Node::SpinOnce(const std::chrono::nanoseconds &_timeout)
+{
+  const std::shared_ptr<Executor> &executor =
+    this->dataPtr->options.CallbackExecutor();
+  if (!executor)
+    return false;
+
+  return executor->SpinOnce(_timeout);
+}
+
+//////////////////////////////////////////////////
+bool NodePrivate::Unsubscribe(const std::string &_fullyQualifiedTopic)
+{
+  // Remove handlers from shared pubQueue to avoid invoking callbacks after
+  // unsuscribing to the topic
+  if (!this->RemoveHandlersFromPubQueue(_fullyQualifiedTopic))
+  {
+    std::cerr << "Error removing subscription handlers from publish queue "
+              << "when unsubscribing from Topic [" << _fullyQualifiedTopic
+              << "]" << std::endl;
+  }
+
+  // Remove the subscribers for the given topic that belong to this node.
+  this->shared->localSubscribers.RemoveHandlersForNode(
+        _fullyQualifiedTopic, this->nUuid);
+
+  auto tapIt = this->taps.find(_fullyQualifiedTopic);
+  if (tapIt != this->taps.end())
+  {
+    for (const uint64_t id : tapIt->second)
+      this->shared->RemoveTap(id);
+    this->taps.erase(tapIt);
+  }
+
+  // Remove the topic from the list of subscribed topics in this node.
+  this->topicsSubscribed.erase(_fullyQualifiedTopic);
+
+  // Remove the filter for this topic if I am the last subscriber, and
+  // disconnect from the publishers left without topics.
+  if (!this->shared->localSubscribers.HasSubscriber(_fullyQualifiedTopic))
+  {
+    this->shared->dataPtr->DisconnectSubscriber(_fullyQualifiedTopic, "");
+  }
+
+  // The subscribers of an alias are connected through the topic it names.
+  // Disconnect from the topic once neither the topic nor its aliases are
+  // subscribed anymore.
+  std::vector<std::string> unregistered = {_fullyQualifiedTopic};
+  const std::string target =
+    this->shared->dataPtr->AliasTarget(_fullyQualifiedTopic);
+  if (!target.empty())
+  {
+    if (!this->shared->localSubscribers.HasSubscriber(_fullyQualifiedTopic))
+      this->shared->dataPtr->RemoveAlias(_fullyQualifiedTopic, false);
+
+    if (!this->shared->dataPtr->TopicSubscribed(*this->shared, target))
+      this->shared->dataPtr->DisconnectSubscriber(target, "");
+
+    if (!this->SubscribedTo(target))
+      unregistered.push_back(target);
+  }
+
+  // Notify to the publishers that I am no longer interested in the topic.
+  MsgAddresses_M addresses;
+  if (!this->shared->dataPtr->msgDiscovery->Publishers(
+        _fullyQualifiedTopic, addresses))
+  {
+    return false;
+  }
+
+  for (auto &proc : addresses)
+  {
+    std::string dstPUuid = proc.first;
+    for (const std::string &topic : unregistered)
+    {
+      MessagePublisher pub(topic, this->shared->myAddress,
+        dstPUuid, this->shared->pUuid, this->nUuid,
+        kGenericMessageType, AdvertiseMessageOptions());
+
+      this->shared->dataPtr->msgDiscovery->Unregister(pub);
+    }
+  }
+
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool NodePrivate::SubscribedTo(const std::string &_fullyQualifiedTopic) const
+{
+  if (this->topicsSubscribed.count(_fullyQualifiedTopic) > 0)
+    return true;
+
+  const auto &topicAliases = this->shared->dataPtr->topicAliases;
+  auto it = topicAliases.find(_fullyQualifiedTopic);
+  return it != topicAliases.end() &&
+    std::any_of(it->second.begin(), it->second.end(),
+      [this](const std::string &_alias)
+      {
+        return this->topicsSubscribed.count(_alias) > 0;
+      });
 }
 
 //////////////////////////////////////////////////
-bool Node::Unsubscribe(const std::string &_topic)
+bool Node::AdvertiseHelper(const std::string &_topic,
+    const IRepHandlerPtr &_repHandler, const AdvertiseServiceOptions &_options)
 {
   // Topic remapping.
   std::string topic = _topic;
@@ -602,59 +1465,45 @@ bool Node::Unsubscribe(const std::string &_topic)
 
   std::string fullyQualifiedTopic;
   if (!TopicUtils::FullyQualifiedName(this->Options().Partition(),
-    this->Options().NameSpace(), _topic, fullyQualifiedTopic))
+    this->Options().NameSpace(), topic, fullyQualifiedTopic))
   {
-    std::cerr << "Topic [" << _topic << "] is not valid." << std::endl;
+    std::cerr << "Service [" << topic << "] is not valid." << std::endl;
     return false;
   }
 
-  // Remove handlers from shared pubQueue to avoid invoking callbacks after
-  // unsuscribing to the topic
-  if (!this->dataPtr->RemoveHandlersFromPubQueue(topic))
-  {
-    std::cerr << "Error removing subscription handlers from publish queue "
-              << "when unsubscribing from Topic [" << _topic << "]"
-              <<  std::endl;
-  }
+  _repHandler->SetConcurrency(_options.Concurrency());
+  _repHandler->SetCacheTtl(_options.CacheTtl());
+  _repHandler->SetPriority(_options.Priority());
 
   std::lock_guard<std::recursive_mutex> lk(this->dataPtr->shared->mutex);
 
-  // Remove the subscribers for the given topic that belong to this node.
-  this->dataPtr->shared->localSubscribers.RemoveHandlersForNode(
-        fullyQualifiedTopic, this->dataPtr->nUuid);
+  if (!this->dataPtr->shared->InitializeServiceSockets())
+    return false;
 
-  // Remove the topic from the list of subscribed topics in this node.
-  this->dataPtr->topicsSubscribed.erase(fullyQualifiedTopic);
+  // Add the topic to the list of advertised services.
+  this->dataPtr->srvsAdvertised.insert(fullyQualifiedTopic);
 
-  // Remove the filter for this topic if I am the last subscriber.
-  if (!this->dataPtr->shared->localSubscribers
-      .HasSubscriber(fullyQualifiedTopic))
-  {
-#ifdef GZ_CPPZMQ_POST_4_7_0
-    this->dataPtr->shared->dataPtr->subscriber->set(
-      zmq::sockopt::unsubscribe, fullyQualifiedTopic);
-#else
-    this->dataPtr->shared->dataPtr->subscriber->setsockopt(
-      ZMQ_UNSUBSCRIBE, fullyQualifiedTopic.data(), fullyQualifiedTopic.size());
-#endif
-  }
+  // Store the replier handler. Each replier handler is
+  // associated with a topic. When the receiving thread gets new requests,
+  // it will recover the replier handler associated to the topic and
+  // will invoke the service call.
+  this->dataPtr->shared->repliers.AddHandler(
+    fullyQualifiedTopic, this->NodeUuid(), _repHandler);
 
-  // Notify to the publishers that I am no longer interested in the topic.
-  MsgAddresses_M addresses;
-  if (!this->dataPtr->shared->dataPtr->msgDiscovery->Publishers(
-        fullyQualifiedTopic, addresses))
-  {
-    return false;
-  }
+  // Notify the discovery service to register and advertise my responser.
+  ServicePublisher publisher(fullyQualifiedTopic,
+    this->dataPtr->shared->myReplierAddress,
+    this->dataPtr->shared->replierId.ToString(),
+    this->dataPtr->shared->pUuid, this->NodeUuid(),
+    _repHandler->ReqTypeName(), _repHandler->RepTypeName(), _options);
 
-  for (auto &proc : addresses)
+  if (!this->dataPtr->shared->AdvertisePublisher(publisher))
   {
-    std::string dstPUuid = proc.first;
-    MessagePublisher pub(fullyQualifiedTopic, this->dataPtr->shared->myAddress,
-      dstPUuid, this->dataPtr->shared->pUuid, this->dataPtr->nUuid,
-      kGenericMessageType, AdvertiseMessageOptions());
-
-    this->Shared()->dataPtr->msgDiscovery->Unregister(pub);
+    std::cerr << "Node::Advertise(): Error advertising service ["
+              << topic
+              << "]. Did you forget to start the discovery service?"
+              << std::endl;
+    return false;
   }
 
   return true;
@@ -717,7 +1566,8 @@ void Node::TopicList(std::vector<std::string> &_topics) const
   std::vector<std::string> allTopics;
   _topics.clear();
 
-  this->dataPtr->shared->dataPtr->msgDiscovery->TopicList(allTopics);
+  this->dataPtr->shared->dataPtr->msgDiscovery->TopicList(allTopics,
+    this->Options().DiscoveryTimeout());
 
   for (const auto &fullyQualifiedTopic : allTopics)
   {
@@ -744,7 +1594,8 @@ void Node::ServiceList(std::vector<std::string> &_services) const
   std::vector<std::string> allServices;
   _services.clear();
 
-  this->dataPtr->shared->dataPtr->srvDiscovery->TopicList(allServices);
+  this->dataPtr->shared->dataPtr->srvDiscovery->TopicList(allServices,
+    this->Options().DiscoveryTimeout());
 
   for (auto &service : allServices)
   {
@@ -772,31 +1623,55 @@ bool Node::SubscribeRaw(
     const std::string &_msgType,
     const SubscribeOptions &_opts)
 {
-  // Topic remapping.
-  std::string topic = _topic;
-  this->Options().TopicRemap(_topic, topic);
+  const std::shared_ptr<RawSubscriptionHandler> handlerPtr =
+      std::make_shared<RawSubscriptionHandler>(
+        this->dataPtr->nUuid, _msgType, _opts);
 
-  std::string fullyQualifiedTopic;
-  if (!TopicUtils::FullyQualifiedName(this->dataPtr->options.Partition(),
-                                      this->dataPtr->options.NameSpace(),
-                                      _topic, fullyQualifiedTopic))
+  handlerPtr->SetCallback(_callback);
+
+  SharedRawCallback tap;
+  if (_opts.Tap())
   {
-    std::cerr << "Topic [" << _topic << "] is not valid." << std::endl;
-    return false;
+    tap = [_callback](const std::shared_ptr<const char> &_msgData,
+      const std::size_t _size, const MessageInfo &_info)
+    {
+      _callback(_msgData.get(), _size, _info);
+    };
   }
 
+  return this->dataPtr->SubscribeRawHelper(_topic, handlerPtr, tap);
+}
+
+//////////////////////////////////////////////////
+bool Node::SubscribeRaw(
+    const std::string &_topic,
+    const SharedRawCallback &_callback,
+    const std::string &_msgType,
+    const SubscribeOptions &_opts)
+{
   const std::shared_ptr<RawSubscriptionHandler> handlerPtr =
       std::make_shared<RawSubscriptionHandler>(
         this->dataPtr->nUuid, _msgType, _opts);
 
   handlerPtr->SetCallback(_callback);
 
-  std::lock_guard<std::recursive_mutex> lk(this->dataPtr->shared->mutex);
-
-  this->dataPtr->shared->localSubscribers.raw.AddHandler(
-        fullyQualifiedTopic, this->dataPtr->nUuid, handlerPtr);
+  return this->dataPtr->SubscribeRawHelper(_topic, handlerPtr,
+    _opts.Tap() ? _callback : SharedRawCallback());
+}
 
-  return this->dataPtr->SubscribeHelper(fullyQualifiedTopic);
+//////////////////////////////////////////////////
+bool Node::SubscribeRaw(
+    const std::string &_topic,
+    const RawViewCallback &_callback,
+    const std::string &_msgType,
+    const SubscribeOptions &_opts)
+{
+  return this->SubscribeRaw(_topic,
+    RawCallback([_callback](const char *_msgData, const size_t _size,
+      const MessageInfo &_info)
+    {
+      _callback(std::string_view(_msgData, _size), _info);
+    }), _msgType, _opts);
 }
 
 //////////////////////////////////////////////////
@@ -861,12 +1736,96 @@ bool Node::EnableStats(const std::string &_topic, bool _enable,
   return true;
 }
 
+//////////////////////////////////////////////////
+bool Node::EnableServiceStats(const std::string &_service, bool _enable)
+{
+  std::string fullyQualifiedTopic;
+  std::string service = _service;
+  this->Options().TopicRemap(_service, service);
+
+  if (!TopicUtils::FullyQualifiedName(this->Options().Partition(),
+    this->Options().NameSpace(), service, fullyQualifiedTopic))
+  {
+    return false;
+  }
+
+  this->dataPtr->shared->EnableServiceStats(fullyQualifiedTopic, _enable);
+  return true;
+}
+
+//////////////////////////////////////////////////
+std::optional<ServiceStatistics> Node::ServiceStats(
+    const std::string &_service) const
+{
+  std::string fullyQualifiedTopic;
+  std::string service = _service;
+  this->Options().TopicRemap(_service, service);
+
+  if (!TopicUtils::FullyQualifiedName(this->Options().Partition(),
+    this->Options().NameSpace(), service, fullyQualifiedTopic))
+  {
+    return std::nullopt;
+  }
+
+  return this->dataPtr->shared->ServiceStats(fullyQualifiedTopic);
+}
+
+//////////////////////////////////////////////////
+void Node::EnableCallbackStats(bool _enable)
+{
+  this->dataPtr->shared->EnableCallbackStats(_enable);
+}
+
+//////////////////////////////////////////////////
+std::vector<CallbackStatistics> Node::SubscriptionStats() const
+{
+  std::vector<CallbackStatistics> stats =
+    this->dataPtr->shared->CallbackStats(this->dataPtr->nUuid);
+
+  // Remove the partition information from the topics.
+  for (CallbackStatistics &entry : stats)
+    entry.topic.erase(0, entry.topic.find_last_of("@") + 1);
+  return stats;
+}
+
 //////////////////////////////////////////////////
 NodeShared *Node::Shared() const
 {
   return this->dataPtr->shared;
 }
 
+//////////////////////////////////////////////////
+std::shared_ptr<const std::string> Node::ResolveTopic(
+  const std::string &_topic) const
+{
+  {
+    std::shared_lock<std::shared_mutex> lk(this->dataPtr->resolvedMutex);
+    auto it = this->dataPtr->resolvedTopics.find(_topic);
+    if (it != this->dataPtr->resolvedTopics.end())
+      return it->second;
+  }
+
+  // Topic remapping.
+  std::string topic = _topic;
+  this->Options().TopicRemap(_topic, topic);
+
+  auto fullyQualifiedTopic = std::make_shared<std::string>();
+  if (!TopicUtils::FullyQualifiedName(this->Options().Partition(),
+    this->Options().NameSpace(), topic, *fullyQualifiedTopic))
+  {
+    return nullptr;
+  }
+
+  // The options of a node can't change, neither can the cached names.
+  std::unique_lock<std::shared_mutex> lk(this->dataPtr->resolvedMutex);
+  if (this->dataPtr->resolvedTopics.size() <
+        NodePrivate::kMaxResolvedTopics)
+  {
+    this->dataPtr->resolvedTopics.emplace(_topic, fullyQualifiedTopic);
+  }
+  return fullyQualifiedTopic;
+}
+
 //////////////////////////////////////////////////
 const std::string &Node::NodeUuid() const
 {
@@ -900,7 +1859,8 @@ bool Node::TopicInfo(const std::string &_topic,
 {
   // We trigger a topic list to update the list of remote subscribers.
   std::vector<std::string> allTopics;
-  this->dataPtr->shared->dataPtr->msgDiscovery->TopicList(allTopics);
+  this->dataPtr->shared->dataPtr->msgDiscovery->TopicList(allTopics,
+    this->Options().DiscoveryTimeout());
 
   // Construct a topic name with the partition and namespace
   std::string fullyQualifiedTopic;
@@ -958,7 +1918,8 @@ bool Node::TopicInfo(const std::string &_topic,
 bool Node::ServiceInfo(const std::string &_service,
                        std::vector<ServicePublisher> &_publishers) const
 {
-  this->dataPtr->shared->dataPtr->srvDiscovery->WaitForInit();
+  this->dataPtr->shared->dataPtr->srvDiscovery->WaitForInit(
+    this->Options().DiscoveryTimeout());
 
   // Construct a topic name with the partition and namespace
   std::string fullyQualifiedTopic;
@@ -1028,11 +1989,50 @@ Node::Publisher Node::Advertise(const std::string &_topic,
 
   std::lock_guard<std::recursive_mutex> lk(this->Shared()->mutex);
 
+  if (!this->Shared()->InitializeTopicSockets())
+    return Publisher();
+
+  // The topics advertised with a channel are sent through its socket. The
+  // subscribers find the channel in the control field. The topics with a
+  // CONTROL or BULK priority have a channel per priority by default, and
+  // the topics sent to a multicast group have a channel per group.
+  std::string channel = _options.Channel();
+  if (!_options.MulticastGroup().empty())
+    channel = kMulticastChannelPrefix + _options.MulticastGroup();
+  else if (channel.empty() && _options.Priority() == Priority_t::CONTROL)
+    channel = "priority:control";
+  else if (channel.empty() && _options.Priority() == Priority_t::BULK)
+    channel = "priority:bulk";
+
+  // The topics sent through another interface than the one of GZ_IP have
+  // a channel bound to it.
+  std::string iface = _options.Interface().empty() ?
+    this->Options().Interface() : _options.Interface();
+  if (iface.empty())
+    iface = this->Shared()->hostAddr;
+  else if (iface != this->Shared()->hostAddr && channel.empty())
+    channel = "interface";
+
+  // The channels are sockets of their own, a data-plane backend sends all
+  // the topics.
+  std::string addr = this->Shared()->myAddress;
+  std::string ctrl = "unused";
+  if (!channel.empty() && !this->Shared()->dataPtr->backend)
+  {
+    addr = this->Shared()->dataPtr->ChannelAddress(channel, iface,
+      _options.Priority());
+    if (addr.empty())
+      return Publisher();
+    ctrl = kChannelCtrlPrefix + channel;
+  }
+
+  // The subscribers ask for the last messages of a topic with a history
+  // depth when they connect.
+  if (_options.HistoryDepth() > 0)
+    ctrl += kLatchedCtrlSuffix;
+
   // Notify the discovery service to register and advertise my topic.
-  MessagePublisher publisher(fullyQualifiedTopic,
-      this->Shared()->myAddress,
-      // this->Shared()->myControlAddress,
-      "unused",
+  MessagePublisher publisher(fullyQualifiedTopic, addr, ctrl,
       this->Shared()->pUuid, this->NodeUuid(), _msgTypeName, _options);
 
   if (!this->Shared()->dataPtr->msgDiscovery->Advertise(publisher))
@@ -1044,12 +2044,72 @@ Node::Publisher Node::Advertise(const std::string &_topic,
     return Publisher();
   }
 
+  // The aliases are resolved like the topic, without the remapping.
+  std::vector<std::string> aliases;
+  for (const std::string &alias : _options.Aliases())
+  {
+    std::string fullyQualifiedAlias;
+    if (!TopicUtils::FullyQualifiedName(this->Options().Partition(),
+          this->Options().NameSpace(), alias, fullyQualifiedAlias))
+    {
+      std::cerr << "Alias [" << alias << "] is not valid." << std::endl;
+      continue;
+    }
+    aliases.push_back(fullyQualifiedAlias);
+  }
+  if (!aliases.empty())
+    this->Shared()->dataPtr->AdvertiseAliases(publisher, aliases);
+
+  // The messages are kept from the first one.
+  if (_options.HistorySize() > 0 || _options.HistoryDepth() > 0)
+  {
+    this->Shared()->dataPtr->EnableHistory(fullyQualifiedTopic, addr,
+      _options.HistorySize(), _options.HistoryDepth());
+  }
+
   return Publisher(publisher);
 }
 
+//////////////////////////////////////////////////
+bool NodePrivate::SubscribeRawHelper(const std::string &_topic,
+    const std::shared_ptr<RawSubscriptionHandler> &_handler,
+    const SharedRawCallback &_tap)
+{
+  // Topic remapping.
+  std::string topic = _topic;
+  this->options.TopicRemap(_topic, topic);
+
+  std::string fullyQualifiedTopic;
+  if (!TopicUtils::FullyQualifiedName(this->options.Partition(),
+                                      this->options.NameSpace(),
+                                      _topic, fullyQualifiedTopic))
+  {
+    std::cerr << "Topic [" << _topic << "] is not valid." << std::endl;
+    return false;
+  }
+
+  _handler->SetDefaultExecutor(this->options.CallbackExecutor());
+
+  std::lock_guard<std::recursive_mutex> lk(this->shared->mutex);
+
+  this->shared->localSubscribers.raw.AddHandler(
+        fullyQualifiedTopic, this->nUuid, _handler);
+
+  if (_tap)
+  {
+    this->taps[fullyQualifiedTopic].push_back(this->shared->AddTap(
+      fullyQualifiedTopic, _handler->HandlerUuid(), _tap));
+  }
+
+  return this->SubscribeHelper(fullyQualifiedTopic);
+}
+
 //////////////////////////////////////////////////
 bool NodePrivate::SubscribeHelper(const std::string &_fullyQualifiedTopic)
 {
+  if (!this->shared->InitializeTopicSockets())
+    return false;
+
   // Add the topic to the list of subscribed topics (if it was not before).
   this->topicsSubscribed.insert(_fullyQualifiedTopic);
 
@@ -1063,6 +2123,11 @@ bool NodePrivate::SubscribeHelper(const std::string &_fullyQualifiedTopic)
     return false;
   }
 
+  // The last messages of the topics with a history depth published in this
+  // process.
+  this->shared->dataPtr->DeliverLatched(*this->shared,
+    _fullyQualifiedTopic, this->nUuid);
+
   return true;
 }
 
@@ -1073,42 +2138,34 @@ bool Node::SubscribeHelper(const std::string &_fullyQualifiedTopic)
 }
 
 //////////////////////////////////////////////////
-bool NodePrivate::RemoveHandlersFromPubQueue(const std::string &_topic)
+bool NodePrivate::RemoveHandlersFromPubQueue(
+    const std::string &_fullyQualifiedTopic)
 {
-  // Remove from pubQueue
-  std::unique_lock<std::mutex> queueLock(
-      this->shared->dataPtr->pubThreadMutex);
-  for (auto &msgDetails : this->shared->dataPtr->pubQueue)
+  // The publish queues are lock-free and can't be modified in place.
+  // Instead, disable the handlers of this node, so the publish threads skip
+  // them when processing the publications already queued.
+  if (auto entries =
+        this->shared->localSubscribers.normal.TopicHandlers(
+          _fullyQualifiedTopic))
   {
-    // check if there is a pub queue with message details that has topic
-    // which the node unsubscribes to
-    if (msgDetails->info.Topic() != _topic)
-      continue;
-
-    // remove local handler if it is a handler for this node
-    for (auto handlerIt = msgDetails->localHandlers.begin();
-         handlerIt != msgDetails->localHandlers.end();)
+    for (const auto &entry : *entries)
     {
-      if ((*handlerIt)->NodeUuid() == this->nUuid)
-      {
-        msgDetails->localHandlers.erase(handlerIt);
-      }
-      else
-        ++handlerIt;
+      if (entry.nUuid == this->nUuid)
+        entry.handler->Disable();
     }
+  }
 
-    // remove raw handler if it is a handler for this node
-    for (auto handlerIt = msgDetails->rawHandlers.begin();
-         handlerIt != msgDetails->rawHandlers.end();)
+  if (auto entries =
+        this->shared->localSubscribers.raw.TopicHandlers(
+          _fullyQualifiedTopic))
+  {
+    for (const auto &entry : *entries)
     {
-      if ((*handlerIt)->NodeUuid() == this->nUuid)
-      {
-        msgDetails->rawHandlers.erase(handlerIt);
-      }
-      else
-        ++handlerIt;
+      if (entry.nUuid == this->nUuid)
+        entry.handler->Disable();
     }
   }
+
   return true;
 }
 
@@ -1139,3 +2196,174 @@ bool Node::RequestRaw(const std::string &_topic,
   bool executed = this->Request(_topic, *req, _timeout, *res, _result);
   return executed && res->SerializeToString(&_response);
 }
+
+//////////////////////////////////////////////////
+bool Node::RequestRaw(const std::string &_topic,
+    const std::string &_request, const std::string &_requestType,
+    const std::string &_responseType, unsigned int _timeout,
+    const std::function<void(const std::string &_response,
+                             const bool _result)> &_callback)
+{
+  std::unique_ptr<google::protobuf::Message> req =
+    msgs::Factory::New(_requestType);
+  if (!req)
+  {
+    std::cerr << "Unable to create request of type[" << _requestType << "].\n";
+    return false;
+  }
+  req->ParseFromString(_request);
+
+  std::unique_ptr<google::protobuf::Message> res =
+    msgs::Factory::New(_responseType);
+  if (!res)
+  {
+    std::cerr << "Unable to create response of type["
+      << _responseType << "].\n";
+    return false;
+  }
+
+  // The names are remapped and qualified once.
+  const std::shared_ptr<const std::string> resolved =
+    this->ResolveTopic(_topic);
+  if (!resolved)
+  {
+    std::cerr << "Service [" << _topic << "] is not valid." << std::endl;
+    return false;
+  }
+  const std::string &fullyQualifiedTopic = *resolved;
+
+  bool localResponserFound;
+  IRepHandlerPtr repHandler;
+  {
+    std::lock_guard<std::recursive_mutex> lk(this->Shared()->mutex);
+    localResponserFound = this->Shared()->repliers.FirstHandler(
+      fullyQualifiedTopic, _requestType, _responseType, repHandler);
+  }
+
+  // If the responser is within my process, let's use it.
+  if (localResponserFound)
+  {
+    if (!repHandler->Deferred())
+    {
+      bool result = repHandler->RunLocalCallback(*req, *res);
+      _callback(res->SerializeAsString(), result);
+      return true;
+    }
+
+    repHandler->RunLocalDeferredCallback(*req,
+      [_callback](const ProtoMsg &_rep, const bool _result)
+      {
+        _callback(_rep.SerializeAsString(), _result);
+      });
+    return true;
+  }
+
+  // Create a new request handler.
+  auto reqHandlerPtr = std::make_shared<
+    ReqHandler<google::protobuf::Message, google::protobuf::Message>>(
+      this->NodeUuid());
+  reqHandlerPtr->SetMessage(req.get());
+  reqHandlerPtr->SetResponse(res.get());
+  reqHandlerPtr->SetCallback(_callback);
+  reqHandlerPtr->SetCallbackExecutor(this->Options().ResponseExecutor());
+
+  std::lock_guard<std::recursive_mutex> lk(this->Shared()->mutex);
+
+  // The reception thread abandons the request after the timeout.
+  if (_timeout > 0)
+  {
+    reqHandlerPtr->SetDeadline(std::chrono::steady_clock::now() +
+      std::chrono::milliseconds(_timeout));
+  }
+
+  reqHandlerPtr->SetLoadBalancing(this->Options().LoadBalancing());
+
+  // Store the request handler.
+  this->Shared()->AddRequest(fullyQualifiedTopic, reqHandlerPtr);
+
+  // If the responser's address is known, make the request.
+  SrvAddresses_M addresses;
+  if (this->Shared()->TopicPublishers(fullyQualifiedTopic, addresses))
+  {
+    this->Shared()->SendPendingRemoteReqs(fullyQualifiedTopic,
+      _requestType, _responseType);
+  }
+  else if (!this->Shared()->DiscoverService(fullyQualifiedTopic))
+  {
+    std::cerr << "Node::RequestRaw(): Error discovering service ["
+              << _topic << "]. Did you forget to start the discovery service?"
+              << std::endl;
+    this->Shared()->RemoveRequest(reqHandlerPtr->HandlerUuid());
+    return false;
+  }
+
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool Node::RequestOneway(const std::string &_topic, const ProtoMsg &_request)
+{
+  // RequestHelper() reports the invalid names.
+  const std::shared_ptr<const std::string> resolved =
+    this->ResolveTopic(_topic);
+  if (!resolved)
+    return false;
+  const std::string &fullyQualifiedTopic = *resolved;
+
+  std::lock_guard<std::recursive_mutex> lk(this->dataPtr->shared->mutex);
+
+  // The responsers within my process run the callback directly.
+  IRepHandlerPtr repHandler;
+  if (this->dataPtr->shared->repliers.FirstHandler(fullyQualifiedTopic,
+        _request.GetTypeName(), msgs::Empty().GetTypeName(), repHandler))
+  {
+    return false;
+  }
+
+  return this->dataPtr->shared->SendOnewayRequest(fullyQualifiedTopic,
+    _request, this->Options().LoadBalancing());
+}
+
+//////////////////////////////////////////////////
+bool Node::PrepareService(const std::string &_topic,
+  const unsigned int _timeout)
+{
+  // Topic remapping.
+  std::string topic = _topic;
+  this->Options().TopicRemap(_topic, topic);
+
+  std::string fullyQualifiedTopic;
+  if (!TopicUtils::FullyQualifiedName(this->Options().Partition(),
+    this->Options().NameSpace(), topic, fullyQualifiedTopic))
+  {
+    std::cerr << "Service [" << topic << "] is not valid." << std::endl;
+    return false;
+  }
+
+  std::unique_lock<std::recursive_mutex> lk(this->dataPtr->shared->mutex);
+
+  // A responser within my process doesn't need a connection.
+  if (this->dataPtr->shared->repliers.HasHandlersForTopic(fullyQualifiedTopic))
+    return true;
+
+  if (!this->dataPtr->shared->InitializeServiceSockets())
+    return false;
+
+  // The responsers already known are connected now, the others as soon as
+  // they are discovered.
+  if (!this->dataPtr->shared->DiscoverService(fullyQualifiedTopic))
+  {
+    std::cerr << "Node::PrepareService(): Error discovering service ["
+              << topic
+              << "]. Did you forget to start the discovery service?"
+              << std::endl;
+    return false;
+  }
+
+  const auto &routes = this->dataPtr->shared->dataPtr->srvRoutes;
+  return this->dataPtr->shared->dataPtr->srvRoutesCondition.wait_for(lk,
+    std::chrono::milliseconds(_timeout), [&]
+    {
+      return routes.find(fullyQualifiedTopic) != routes.end();
+    });
+}
@@ -15,7 +15,9 @@
  *
 */
 
+#include <chrono>
 #include <iostream>
+#include <memory>
 #include <string>
 
 #include "gz/transport/Helpers.hh"
@@ -57,6 +59,11 @@ NodeOptions &NodeOptions::operator=(const NodeOptions &_other)
   this->SetNameSpace(_other.NameSpace());
   this->SetPartition(_other.Partition());
   this->dataPtr->topicsRemap = _other.dataPtr->topicsRemap;
+  this->dataPtr->loadBalancing = _other.dataPtr->loadBalancing;
+  this->dataPtr->interfaceIp = _other.dataPtr->interfaceIp;
+  this->dataPtr->executor = _other.dataPtr->executor;
+  this->dataPtr->responseExecutor = _other.dataPtr->responseExecutor;
+  this->dataPtr->discoveryTimeout = _other.dataPtr->discoveryTimeout;
   return *this;
 }
 
@@ -136,3 +143,66 @@ bool NodeOptions::TopicRemap(const std::string &_fromTopic,
 
   return topicIt != this->dataPtr->topicsRemap.end();
 }
+
+//////////////////////////////////////////////////
+void NodeOptions::SetLoadBalancing(const LoadBalancing_t _policy)
+{
+  this->dataPtr->loadBalancing = _policy;
+}
+
+//////////////////////////////////////////////////
+LoadBalancing_t NodeOptions::LoadBalancing() const
+{
+  return this->dataPtr->loadBalancing;
+}
+
+//////////////////////////////////////////////////
+void NodeOptions::SetInterface(const std::string &_ip)
+{
+  this->dataPtr->interfaceIp = _ip;
+}
+
+//////////////////////////////////////////////////
+const std::string &NodeOptions::Interface() const
+{
+  return this->dataPtr->interfaceIp;
+}
+
+//////////////////////////////////////////////////
+void NodeOptions::SetCallbackExecutor(
+  const std::shared_ptr<Executor> &_executor)
+{
+  this->dataPtr->executor = _executor;
+}
+
+//////////////////////////////////////////////////
+const std::shared_ptr<Executor> &NodeOptions::CallbackExecutor() const
+{
+  return this->dataPtr->executor;
+}
+
+//////////////////////////////////////////////////
+void NodeOptions::SetResponseExecutor(
+  const std::shared_ptr<Executor> &_executor)
+{
+  this->dataPtr->responseExecutor = _executor;
+}
+
+//////////////////////////////////////////////////
+const std::shared_ptr<Executor> &NodeOptions::ResponseExecutor() const
+{
+  return this->dataPtr->responseExecutor;
+}
+
+//////////////////////////////////////////////////
+void NodeOptions::SetDiscoveryTimeout(
+  const std::chrono::milliseconds &_timeout)
+{
+  this->dataPtr->discoveryTimeout = _timeout;
+}
+
+//////////////////////////////////////////////////
+std::chrono::milliseconds NodeOptions::DiscoveryTimeout() const
+{
+  return this->dataPtr->discoveryTimeout;
+}
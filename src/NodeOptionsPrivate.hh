@@ -18,11 +18,15 @@
 #ifndef GZ_TRANSPORT_NODEOPTIONSPRIVATE_HH_
 #define GZ_TRANSPORT_NODEOPTIONSPRIVATE_HH_
 
-#include <map>
+#include <chrono>
+#include <memory>
 #include <string>
+#include <unordered_map>
 
 #include "gz/transport/config.hh"
+#include "gz/transport/Executor.hh"
 #include "gz/transport/NetUtils.hh"
+#include "gz/transport/NodeOptions.hh"
 
 namespace gz
 {
@@ -49,7 +53,24 @@ namespace gz
 
       /// \brief Table of remappings. The key is the original topic name and
       /// its value is the new topic name to be used instead.
-      public: std::map<std::string, std::string> topicsRemap;
+      public: std::unordered_map<std::string, std::string> topicsRemap;
+
+      /// \brief Distribution of the service requests among the responsers.
+      public: LoadBalancing_t loadBalancing = LoadBalancing_t::FIRST;
+
+      /// \brief Address of the interface of the topics, empty for GZ_IP.
+      public: std::string interfaceIp;
+
+      /// \brief Executor running the callbacks of the node, or nullptr.
+      public: std::shared_ptr<Executor> executor;
+
+      /// \brief Executor running the response callbacks of the requests of
+      /// the node, or nullptr.
+      public: std::shared_ptr<Executor> responseExecutor;
+
+      /// \brief Maximum time waiting for the discovery, negative for no
+      /// limit.
+      public: std::chrono::milliseconds discoveryTimeout{-1};
     };
     }
   }
@@ -17,8 +17,11 @@
 
 #include "gtest/gtest.h"
 
+#include <chrono>
+#include <memory>
 #include <string>
 
+#include "gz/transport/Executor.hh"
 #include "gz/transport/NetUtils.hh"
 #include "gz/transport/NodeOptions.hh"
 
@@ -74,4 +77,42 @@ TEST(NodeOptionsTest, accessors)
   EXPECT_EQ(opts.Partition(), defaultPartition);
   EXPECT_TRUE(opts.SetPartition(aPartition));
   EXPECT_EQ(opts.Partition(), aPartition);
+
+  // Load balancing.
+  EXPECT_EQ(transport::LoadBalancing_t::FIRST, opts.LoadBalancing());
+  opts.SetLoadBalancing(transport::LoadBalancing_t::LEAST_OUTSTANDING);
+  EXPECT_EQ(transport::LoadBalancing_t::LEAST_OUTSTANDING,
+    opts.LoadBalancing());
+  transport::NodeOptions opts2(opts);
+  EXPECT_EQ(transport::LoadBalancing_t::LEAST_OUTSTANDING,
+    opts2.LoadBalancing());
+
+  // Interface.
+  EXPECT_TRUE(opts.Interface().empty());
+  opts.SetInterface("192.168.10.2");
+  EXPECT_EQ("192.168.10.2", opts.Interface());
+  transport::NodeOptions opts3(opts);
+  EXPECT_EQ("192.168.10.2", opts3.Interface());
+
+  // Callback executor.
+  EXPECT_EQ(nullptr, opts.CallbackExecutor());
+  auto executor = std::make_shared<transport::Executor>();
+  opts.SetCallbackExecutor(executor);
+  EXPECT_EQ(executor, opts.CallbackExecutor());
+  transport::NodeOptions opts4(opts);
+  EXPECT_EQ(executor, opts4.CallbackExecutor());
+
+  // Response executor.
+  EXPECT_EQ(nullptr, opts.ResponseExecutor());
+  opts.SetResponseExecutor(executor);
+  EXPECT_EQ(executor, opts.ResponseExecutor());
+  transport::NodeOptions opts5(opts);
+  EXPECT_EQ(executor, opts5.ResponseExecutor());
+
+  // Discovery timeout.
+  EXPECT_LT(opts.DiscoveryTimeout().count(), 0);
+  opts.SetDiscoveryTimeout(std::chrono::milliseconds(50));
+  EXPECT_EQ(std::chrono::milliseconds(50), opts.DiscoveryTimeout());
+  transport::NodeOptions opts6(opts);
+  EXPECT_EQ(std::chrono::milliseconds(50), opts6.DiscoveryTimeout());
 }
@@ -18,8 +18,12 @@
 #ifndef GZ_TRANSPORT_NODEPRIVATE_HH_
 #define GZ_TRANSPORT_NODEPRIVATE_HH_
 
+#include <memory>
+#include <shared_mutex>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include "gz/transport/NetUtils.hh"
 #include "gz/transport/NodeOptions.hh"
@@ -50,15 +54,49 @@ namespace gz
       /// \sa TopicUtils::FullyQualifiedName
       public: bool SubscribeHelper(const std::string &_fullyQualifiedTopic);
 
+      /// \brief Helper function for SubscribeRaw. It registers the handler
+      /// and subscribes to the topic.
+      /// \param[in] _topic Topic name, before remapping.
+      /// \param[in] _handler The raw handler with its callback set.
+      /// \param[in] _tap Callback of the tap replacing the handler for the
+      /// messages published within the process, see
+      /// SubscribeOptions::SetTap(). Empty if none.
+      /// \return True on success.
+      public: bool SubscribeRawHelper(const std::string &_topic,
+        const std::shared_ptr<RawSubscriptionHandler> &_handler,
+        const SharedRawCallback &_tap);
+
       /// \brief Helper function to remove handlers from the shared publish
-      /// queue. This is called when the node unsubscribes to a topic
-      /// \param[in] _topic Topic that the node unsubcribed to.
+      /// queues. This is called when the node unsubscribes to a topic. The
+      /// handlers of this node are disabled, so the pending publications are
+      /// not delivered to them. The queues aren't scanned, the cost only
+      /// depends on the number of handlers of the topic.
+      /// The caller must hold the mutex of the shared node.
+      /// \param[in] _fullyQualifiedTopic Topic that the node unsubcribed to.
       /// \return True on success.
-      public: bool RemoveHandlersFromPubQueue(const std::string &_topic);
+      public: bool RemoveHandlersFromPubQueue(
+        const std::string &_fullyQualifiedTopic);
+
+      /// \brief Unsubscribe the node from a topic.
+      /// The caller must hold the mutex of the shared node.
+      /// \param[in] _fullyQualifiedTopic Fully qualified topic name.
+      /// \return True if the publishers were notified.
+      public: bool Unsubscribe(const std::string &_fullyQualifiedTopic);
+
+      /// \brief Check whether the node subscribes to a topic, directly or
+      /// through one of its aliases.
+      /// The caller must hold the mutex of the shared node.
+      /// \param[in] _fullyQualifiedTopic Fully qualified topic name.
+      /// \return True if the node subscribes to the topic.
+      public: bool SubscribedTo(const std::string &_fullyQualifiedTopic) const;
 
       /// \brief The list of topics subscribed by this node.
       public: std::unordered_set<std::string> topicsSubscribed;
 
+      /// \brief Identifiers of the taps of the raw subscriptions of this
+      /// node, by fully qualified topic name (see NodeShared::AddTap()).
+      public: std::unordered_map<std::string, std::vector<uint64_t>> taps;
+
       /// \brief The list of service calls advertised by this node.
       public: std::unordered_set<std::string> srvsAdvertised;
 
@@ -80,6 +118,23 @@ namespace gz
 
       /// \brief Statistics publisher.
       public: Node::Publisher statPub;
+
+      /// \brief Maximum number of names cached in resolvedTopics, the
+      /// names beyond it are resolved on every call.
+#ifdef GZ_TRANSPORT_EMBEDDED
+      public: static constexpr std::size_t kMaxResolvedTopics = 64;
+#else
+      public: static constexpr std::size_t kMaxResolvedTopics = 1024;
+#endif
+
+      /// \brief Fully qualified names of the topics and services used by
+      /// the requests, indexed by the name before remapping. See
+      /// Node::ResolveTopic().
+      public: std::unordered_map<std::string,
+              std::shared_ptr<const std::string>> resolvedTopics;
+
+      /// \brief Protects resolvedTopics.
+      public: std::shared_mutex resolvedMutex;
     };
     }
   }
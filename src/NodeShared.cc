@@ -14,32 +14,62 @@
  * limitations under the License.
  *
 */
+#include <gz/msgs/bytes.pb.h>
 #include <gz/msgs/empty.pb.h>
 
 #include <zmq.hpp>
 
+#ifndef _WIN32
+  #include <sched.h>
+  #include <sys/stat.h>
+#endif
+
+#include <algorithm>
 #include <chrono>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
 #include <cstring>
+#include <deque>
+#include <fstream>
+#include <functional>
 #include <iostream>
+#include <limits>
 #include <map>
 #include <mutex>
+#include <new>
+#include <optional>
+#include <regex>
+#include <set>
 #include <shared_mutex>  //NOLINT
+#include <sstream>
 #include <string>
 #include <thread>
+#include <utility>
 #include <vector>
 #include <unordered_map>
 
 #include "gz/transport/AdvertiseOptions.hh"
 #include "gz/transport/Discovery.hh"
+#include "gz/transport/DiscoveryServer.hh"
+#include "gz/transport/Executor.hh"
 #include "gz/transport/Helpers.hh"
+#include "gz/transport/NetUtils.hh"
+#include "gz/transport/NodeOptions.hh"
 #include "gz/transport/NodeShared.hh"
 #include "gz/transport/RepHandler.hh"
 #include "gz/transport/ReqHandler.hh"
 #include "gz/transport/SubscriptionHandler.hh"
+#include "gz/transport/TopicUtils.hh"
+#include "gz/transport/TransportBackend.hh"
 #include "gz/transport/TransportTypes.hh"
 #include "gz/transport/Uuid.hh"
+#include "gz/transport/detail/Probes.hh"
 
+#include "Compression.hh"
 #include "NodeSharedPrivate.hh"
+#include "SocketOptions.hh"
+#include "ThreadSettings.hh"
 
 using namespace std::chrono_literals;
 using namespace gz;
@@ -47,32 +77,44 @@ using namespace transport;
 
 const char kGzAuthDomain[] = "gz-auth";
 
-// Enum that encapsulates the possible values for ZeroMQ's setsocketopt
-// for ZMQ_PLAIN_SERVER. A value of 1 enables
-// plain authentication server, and a value of 0 disables.
-enum class ZmqPlainSecurityServerOptions
-{
-  // Value to disable plain security server
-  ZMQ_PLAIN_SECURITY_SERVER_DISABLED = 0,
-  // Value to enable plain security server
-  ZMQ_PLAIN_SECURITY_SERVER_ENABLED = 1,
-};
+// Defaults of the environment variables shaping the threads and sockets of
+// the process. The embedded profile favors a small footprint over the
+// throughput: the sockets are created on first use, the discoveries share
+// a thread and the local callbacks run in the publishing thread.
+#ifdef GZ_TRANSPORT_EMBEDDED
+const char kDefaultLazySockets[] = "1";
+const char kDefaultSharedDiscoveryThread[] = "1";
+const int kDefaultDispatchThreads = 0;
+#else
+const char kDefaultLazySockets[] = "0";
+const char kDefaultSharedDiscoveryThread[] = "0";
+const int kDefaultDispatchThreads = 1;
+#endif
+
+// Discovery ports of the partitions with GZ_DISCOVERY_PARTITION_PORTS=1:
+// every partition hashes to a pair of ports starting at
+// kPartitionPortsBase, below the ephemeral ports.
+const int kPartitionPortsBase = 20000;
+const uint32_t kPartitionPortsSlots = 4096;
+
+// Publish queue processed by the calling thread, if it is a dispatch
+// thread.
+thread_local const void *tPublishQueue = nullptr;
 
 //////////////////////////////////////////////////
-// Helper to get the username and password
-bool userPass(std::string &_user, std::string &_pass)
+// Helper to get the message discovery port of a partition. The hash is
+// FNV-1a, so that every build and platform agree on the ports.
+int partitionMsgDiscPort(const std::string &_partition)
 {
-  char *username = std::getenv("GZ_TRANSPORT_USERNAME");
-  char *password = std::getenv("GZ_TRANSPORT_PASSWORD");
-
-  if (!username || !password)
+  std::size_t start = !_partition.empty() && _partition[0] == '/' ? 1 : 0;
+  uint32_t hash = 2166136261u;
+  for (std::size_t i = start; i < _partition.size(); ++i)
   {
-    return false;
+    hash ^= static_cast<unsigned char>(_partition[i]);
+    hash *= 16777619u;
   }
-
-  _user = username;
-  _pass = password;
-  return true;
+  return kPartitionPortsBase +
+    2 * static_cast<int>(hash % kPartitionPortsSlots);
 }
 
 //////////////////////////////////////////////////
@@ -151,6 +193,49 @@ void sendAuthErrorHelper(zmq::socket_t &_socket, const std::string &_err)
 #endif
 }
 
+//////////////////////////////////////////////////
+/// \brief Forwards the data received by the data-plane backend to the
+/// shared node.
+class BackendListener : public TransportBackendListener
+{
+  /// \brief Constructor.
+  /// \param[in] _shared The shared node, which owns the backend.
+  public: explicit BackendListener(NodeShared &_shared)
+    : shared(_shared)
+  {
+  }
+
+  // Documentation inherited.
+  public: void OnMessage(const std::string &_topic,
+                         const std::string &_msgType,
+                         const char *_data,
+                         const std::size_t _size) override
+  {
+    this->shared.RecvBackendMsg(_topic, _msgType, _data, _size);
+  }
+
+  // Documentation inherited.
+  public: void OnRequest(const BackendRequest &_request,
+                         ReplyFunc _reply) override
+  {
+    this->shared.RecvBackendRequest(_request, std::move(_reply));
+  }
+
+  // Documentation inherited.
+  public: void OnResponse(const std::string &_topic,
+                          const std::string &_nodeUuid,
+                          const std::string &_reqUuid,
+                          const std::string &_rep,
+                          const bool _result) override
+  {
+    this->shared.RecvBackendResponse(_topic, _nodeUuid, _reqUuid, _rep,
+      _result);
+  }
+
+  /// \brief The shared node.
+  private: NodeShared &shared;
+};
+
 //////////////////////////////////////////////////
 NodeShared *NodeShared::Instance()
 {
@@ -223,6 +308,20 @@ NodeShared::NodeShared()
   this->srvDiscPort = this->dataPtr->NonNegativeEnvVar(
     "GZ_DISCOVERY_SRV_PORT", this->kDefaultSrvDiscPort);
 
+  // With GZ_DISCOVERY_PARTITION_PORTS=1, the default ports are replaced by
+  // the ports of the partition of the process, so the kernel drops the
+  // discovery traffic of the other partitions.
+  std::string gzPartitionPorts;
+  std::string gzPort;
+  if (env("GZ_DISCOVERY_PARTITION_PORTS", gzPartitionPorts) &&
+      gzPartitionPorts == "1" &&
+      !env("GZ_DISCOVERY_MSG_PORT", gzPort) &&
+      !env("GZ_DISCOVERY_SRV_PORT", gzPort))
+  {
+    this->msgDiscPort = partitionMsgDiscPort(NodeOptions().Partition());
+    this->srvDiscPort = this->msgDiscPort + 1;
+  }
+
   // Sanity check: the discovery ports should be unique.
   if (this->msgDiscPort == this->srvDiscPort)
   {
@@ -243,39 +342,215 @@ NodeShared::NodeShared()
     this->dataPtr->topicStatsEnabled = (gzStats == "1");
   }
 
+  if (env("GZ_TRANSPORT_SERVICE_STATISTICS", gzStats) && !gzStats.empty())
+  {
+    this->dataPtr->srvStatsAll = (gzStats == "1");
+  }
+
+  if (env("GZ_TRANSPORT_CALLBACK_STATISTICS", gzStats) && !gzStats.empty())
+  {
+    this->dataPtr->callbackStats = (gzStats == "1");
+  }
+
+  this->dataPtr->srvSlowCall = this->dataPtr->NonNegativeEnvVar(
+    "GZ_TRANSPORT_SLOW_SERVICE_CALL", 0);
+
+  // Abandon the non-blocking requests made without a timeout after
+  // GZ_TRANSPORT_REQUEST_TIMEOUT ms.
+  this->dataPtr->requestTimeout = std::chrono::milliseconds(
+    this->dataPtr->NonNegativeEnvVar("GZ_TRANSPORT_REQUEST_TIMEOUT", 0));
+
+  // Keep polling for GZ_TRANSPORT_BUSY_POLL us after a message instead of
+  // blocking, to trade CPU for latency.
+  this->dataPtr->busyPoll = std::chrono::microseconds(
+    this->dataPtr->NonNegativeEnvVar("GZ_TRANSPORT_BUSY_POLL", 0));
+
+  // Detect the subscribers whose send queue stays above
+  // GZ_TRANSPORT_SLOW_SUBSCRIBER bytes. The queues are only sampled on Linux.
+#ifdef __linux__
+  this->dataPtr->slowSubscriberThreshold = static_cast<uint64_t>(
+    this->dataPtr->NonNegativeEnvVar("GZ_TRANSPORT_SLOW_SUBSCRIBER", 0));
+#endif
+
+  // Collect the metrics of the transport if GZ_TRANSPORT_METRICS=1.
+  std::string gzMetrics;
+  if (env("GZ_TRANSPORT_METRICS", gzMetrics) && gzMetrics == "1")
+  {
+    this->dataPtr->metrics = std::make_unique<TransportMetrics>();
+    this->dataPtr->metricsPeriod = this->dataPtr->NonNegativeEnvVar(
+      "GZ_TRANSPORT_METRICS_PERIOD", this->dataPtr->metricsPeriod);
+    if (this->dataPtr->metricsPeriod < 1)
+    {
+      std::cerr << "GZ_TRANSPORT_METRICS_PERIOD must be greater than zero. "
+                << "Using 1000 ms." << std::endl;
+      this->dataPtr->metricsPeriod = 1000;
+    }
+    env("GZ_TRANSPORT_METRICS_FILE", this->dataPtr->metricsFile);
+  }
+
+  // Cap the memory of the queues (MiB).
+  this->dataPtr->memoryCap = static_cast<uint64_t>(
+    this->dataPtr->NonNegativeEnvVar("GZ_TRANSPORT_MEMORY_CAP", 0)) << 20;
+
+  // Record the spans of the messages to the file GZ_TRANSPORT_TRACE, where
+  // %p is replaced by the process ID.
+  std::string gzTrace;
+  if (env("GZ_TRANSPORT_TRACE", gzTrace) && !gzTrace.empty())
+  {
+    const auto pos = gzTrace.find("%p");
+    if (pos != std::string::npos)
+      gzTrace.replace(pos, 2, std::to_string(getProcessId()));
+
+    this->dataPtr->tracer = std::make_unique<Tracer>(gzTrace);
+    if (!this->dataPtr->tracer->Valid())
+      this->dataPtr->tracer.reset();
+  }
+
   // My process UUID.
   Uuid uuid;
   this->pUuid = uuid.ToString();
+  if (this->dataPtr->metrics)
+  {
+    this->dataPtr->metrics->SetProcess(this->pUuid,
+      static_cast<unsigned int>(this->dataPtr->metricsPeriod));
+  }
 
   // Initialize my discovery services.
+  const auto discoveryStart = std::chrono::steady_clock::now();
   this->dataPtr->msgDiscovery.reset(
       new MsgDiscovery(this->pUuid, this->discoveryIP, this->msgDiscPort));
   this->dataPtr->srvDiscovery.reset(
       new SrvDiscovery(this->pUuid, this->discoveryIP, this->srvDiscPort));
+  const auto discoveryTime =
+    std::chrono::steady_clock::now() - discoveryStart;
+
+  // Use a discovery server if GZ_DISCOVERY_SERVER=<ip>[:<port>] is set. The
+  // server of the services discovery listens on the next port.
+  std::string gzServer;
+  if (env("GZ_DISCOVERY_SERVER", gzServer) && !gzServer.empty())
+  {
+    auto parts = transport::split(gzServer, ':');
+    int serverPort = DiscoveryServer::kDefaultPort;
+    if (parts.size() == 2)
+    {
+      try
+      {
+        serverPort = std::stoi(parts[1]);
+      }
+      catch (...)
+      {
+        serverPort = -1;
+      }
+    }
+
+    if (parts.size() > 2 || serverPort <= 0 || serverPort >= 65535 ||
+        !this->dataPtr->msgDiscovery->SetServer(parts[0], serverPort) ||
+        !this->dataPtr->srvDiscovery->SetServer(parts[0], serverPort + 1))
+    {
+      std::cerr << "Invalid GZ_DISCOVERY_SERVER [" << gzServer << "]. Using "
+                << "the multicast discovery only." << std::endl;
+    }
+  }
+
+  // Adapt the heartbeats to the number of peers if GZ_DISCOVERY_ADAPTIVE=1.
+  std::string gzAdaptive;
+  if (env("GZ_DISCOVERY_ADAPTIVE", gzAdaptive) && gzAdaptive == "1")
+  {
+    this->dataPtr->msgDiscovery->SetAdaptiveIntervals(true);
+    this->dataPtr->srvDiscovery->SetAdaptiveIntervals(true);
+  }
+
+  // Only track the remote topics matching GZ_DISCOVERY_INTEREST, a list of
+  // regular expressions separated by spaces.
+  std::string gzInterest;
+  if (env("GZ_DISCOVERY_INTEREST", gzInterest) && !gzInterest.empty())
+  {
+    std::vector<std::regex> patterns;
+    try
+    {
+      for (const auto &pattern : transport::split(gzInterest, ' '))
+      {
+        if (!pattern.empty())
+          patterns.emplace_back(pattern);
+      }
+      this->dataPtr->msgDiscovery->SetInterest(patterns);
+      this->dataPtr->srvDiscovery->SetInterest(patterns);
+    }
+    catch (const std::regex_error &_e)
+    {
+      std::cerr << "Invalid GZ_DISCOVERY_INTEREST [" << gzInterest << "]: "
+                << _e.what() << ". Tracking all the topics." << std::endl;
+    }
+  }
+
+  // Warm start from the publishers known before a restart, persisted to
+  // GZ_DISCOVERY_CACHE.msgs and GZ_DISCOVERY_CACHE.srvs.
+  std::string gzCache;
+  if (env("GZ_DISCOVERY_CACHE", gzCache) && !gzCache.empty())
+  {
+    this->dataPtr->msgDiscovery->SetCache(gzCache + ".msgs");
+    this->dataPtr->srvDiscovery->SetCache(gzCache + ".srvs");
+  }
+
+  // Set the hostname's ip address.
+  this->hostAddr = this->dataPtr->msgDiscovery->HostAddr();
+
+  // Wakes up the reception threads on exit.
+  this->dataPtr->CreateExitSocket();
+
+  // The data of the topics and of the services goes through the backend
+  // selected by GZ_TRANSPORT_BACKEND instead of the ZMQ sockets.
+  std::string gzBackend;
+  if (env("GZ_TRANSPORT_BACKEND", gzBackend) && !gzBackend.empty() &&
+      gzBackend != TransportBackend::kZmq)
+  {
+    this->dataPtr->backend = TransportBackend::Create(gzBackend);
+    if (this->dataPtr->backend)
+    {
+      this->dataPtr->backendListener =
+        std::make_unique<BackendListener>(*this);
+    }
+    else
+    {
+      std::cerr << "Unknown GZ_TRANSPORT_BACKEND [" << gzBackend << "]. "
+                << "Using [" << TransportBackend::kZmq << "]." << std::endl;
+    }
+  }
+
+  // With GZ_TRANSPORT_LAZY_SOCKETS=1 the sockets and the threads of the
+  // topics and of the services are only created on first use.
+  std::string gzLazySockets = kDefaultLazySockets;
+  env("GZ_TRANSPORT_LAZY_SOCKETS", gzLazySockets);
+  this->dataPtr->lazySockets = gzLazySockets == "1";
 
   // Initialize the 0MQ objects.
-  if (!this->InitializeSockets())
+  const auto socketsStart = std::chrono::steady_clock::now();
+  if (!this->dataPtr->lazySockets && !this->InitializeSockets())
     return;
+  const auto socketsTime = std::chrono::steady_clock::now() - socketsStart;
 
   if (this->verbose)
   {
+    // Where the time goes when the process is slow to start.
+    auto times = startupTimes();
+    times["discovery"] = discoveryTime;
+    times["sockets"] = socketsTime;
+    std::cout << "Startup times:";
+    for (const auto &[step, duration] : times)
+    {
+      std::cout << " " << step << " "
+                << std::chrono::duration<double, std::milli>(duration).count()
+                << " ms";
+    }
+    std::cout << std::endl;
     std::cout << "Current host address: " << this->hostAddr << std::endl;
     std::cout << "Process UUID: " << this->pUuid << std::endl;
     std::cout << "Bind at: [udp://" << this->discoveryIP << ":"
               << this->msgDiscPort << "] for msg discovery\n";
     std::cout << "Bind at: [udp://" << this->discoveryIP << ":"
               << this->srvDiscPort << "] for srv discovery\n";
-    std::cout << "Bind at: [" << this->myAddress << "] for pub/sub\n";
-    std::cout << "Bind at: [" << this->myReplierAddress << "] for srv. calls\n";
-    std::cout << "Identity for receiving srv. requests: ["
-              << this->replierId.ToString() << "]" << std::endl;
-    std::cout << "Identity for receiving srv. responses: ["
-              << this->responseReceiverId.ToString() << "]" << std::endl;
   }
 
-  // Start the service thread.
-  this->threadReception = std::thread(&NodeShared::RunReceptionTask, this);
-
   // Set the callback to notify discovery updates (new topics).
   this->dataPtr->msgDiscovery->ConnectionsCb(
       std::bind(&NodeShared::OnNewConnection, this, std::placeholders::_1));
@@ -293,6 +568,16 @@ NodeShared::NodeShared()
   this->dataPtr->msgDiscovery->SubscribersCb(
       std::bind(&NodeShared::OnSubscribers, this));
 
+  // The peers of the previous wire protocol receive the publications in
+  // their layout through their own socket, see PublishLegacy(). The data
+  // of a backend can't reach them.
+  this->dataPtr->msgDiscovery->LegacyAddressCb([this]()
+  {
+    if (this->dataPtr->backend || !this->InitializeTopicSockets())
+      return std::string();
+    return this->dataPtr->BindLegacyPublisher(this->hostAddr);
+  });
+
   // Set the callback to notify svc discovery updates (new services).
   this->dataPtr->srvDiscovery->ConnectionsCb(
       std::bind(&NodeShared::OnNewSrvConnection, this, std::placeholders::_1));
@@ -302,13 +587,41 @@ NodeShared::NodeShared()
       std::bind(&NodeShared::OnNewSrvDisconnection,
         this, std::placeholders::_1));
 
-  // Start the discovery services.
+  // The requests and the responses of the previous wire protocol are the
+  // same, without the optional frames.
+  this->dataPtr->srvDiscovery->LegacyAddressCb([this]()
+  {
+    if (this->dataPtr->backend || !this->InitializeServiceSockets())
+      return std::string();
+    return this->myReplierAddress;
+  });
+
+  // Start the discovery services. With GZ_DISCOVERY_SHARED_THREAD=1 the
+  // service discovery runs in the thread of the message discovery.
   this->dataPtr->msgDiscovery->Start();
-  this->dataPtr->srvDiscovery->Start();
+  std::string gzSharedThread = kDefaultSharedDiscoveryThread;
+  env("GZ_DISCOVERY_SHARED_THREAD", gzSharedThread);
+  if (gzSharedThread == "1")
+  {
+    this->dataPtr->srvDiscovery->Start(*this->dataPtr->msgDiscovery);
+  }
+  else
+  {
+    this->dataPtr->srvDiscovery->Start();
+  }
+
+  // Start exporting the metrics.
+  if (this->dataPtr->metrics)
+  {
+    this->dataPtr->metricsThread =
+      std::thread(&NodeSharedPrivate::MetricsThread, this->dataPtr.get());
+  }
 
-  // Create the local publish thread.
-  this->dataPtr->pubThread = std::thread(&NodeSharedPrivate::PublishThread,
-      this->dataPtr.get());
+  if (this->dataPtr->slowSubscriberThreshold > 0)
+  {
+    this->dataPtr->slowSubscriberThread = std::thread(
+      &NodeSharedPrivate::SlowSubscriberThread, this->dataPtr.get());
+  }
 }
 
 //////////////////////////////////////////////////
@@ -316,36 +629,265 @@ NodeShared::~NodeShared()
 {
   // Tell the service thread to terminate.
   this->dataPtr->exit = true;
+  this->dataPtr->SignalExit();
+
+  // Stop receiving the data of the backend.
+  this->dataPtr->backend.reset();
+
+  // Stop exporting the metrics first, the thread uses its own node.
+  {
+    std::lock_guard<std::mutex> lk(this->dataPtr->metricsMutex);
+    this->dataPtr->metricsCondition.notify_all();
+  }
+  if (this->dataPtr->metricsThread.joinable())
+    this->dataPtr->metricsThread.join();
+
+  // Stop monitoring the publisher sockets before they're closed. ZMQ
+  // blocks sending the events of a socket until its monitor reads them.
+  {
+    std::lock_guard<std::mutex> lk(this->dataPtr->publisherMutex);
+    std::lock_guard<std::mutex> monitorLk(
+      this->dataPtr->slowSubscriberMutex);
+    for (zmq::socket_t *socket : this->dataPtr->monitoredPublishers)
+      zmq_socket_monitor(static_cast<void *>(*socket), nullptr, 0);
+    this->dataPtr->monitoredPublishers.clear();
+  }
+  if (this->dataPtr->slowSubscriberThread.joinable())
+    this->dataPtr->slowSubscriberThread.join();
+  this->dataPtr->pendingMonitors.clear();
+
+  // Notify the local publish threads and join.
+  this->dataPtr->StopPublishThreads();
 
-  // Notify the local pubthread and join.
-  this->dataPtr->signalNewPub.notify_all();
-  this->dataPtr->pubThread.join();
+  // Wait for the thread sending the batches.
+  {
+    std::lock_guard<std::mutex> lk(this->dataPtr->publisherMutex);
+    this->dataPtr->batchCondition.notify_all();
+  }
+  if (this->dataPtr->batchThread.joinable())
+    this->dataPtr->batchThread.join();
 
   // Wait for the service thread before exit.
   if (this->threadReception.joinable())
     this->threadReception.join();
+  for (auto &thread : this->dataPtr->receptionThreads)
+    thread.join();
+
+  // Wait for the threads running the service requests.
+  {
+    std::lock_guard<std::mutex> lk(this->dataPtr->srvMutex);
+    this->dataPtr->srvCondition.notify_all();
+  }
+  for (auto &thread : this->dataPtr->srvThreads)
+    thread.join();
 
   // Wait for the authentication thread before exit.
   if (this->dataPtr->accessControlThread.joinable())
     this->dataPtr->accessControlThread.join();
+
+  if (this->dataPtr->exitSocket >= 0)
+  {
+#ifdef _WIN32
+    closesocket(this->dataPtr->exitSocket);
+#else
+    close(this->dataPtr->exitSocket);
+#endif
+  }
+}
+
+//////////////////////////////////////////////////
+void NodeSharedPrivate::CreateExitSocket()
+{
+  int sock = static_cast<int>(socket(PF_INET, SOCK_DGRAM, IPPROTO_UDP));
+  if (sock < 0)
+  {
+    std::cerr << "Unable to create the exit socket." << std::endl;
+    return;
+  }
+
+  sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port = 0;
+  socklen_t addrLen = sizeof(addr);
+
+  if (bind(sock, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0 ||
+      getsockname(sock, reinterpret_cast<sockaddr *>(&addr), &addrLen) < 0)
+  {
+    std::cerr << "Unable to bind the exit socket." << std::endl;
+#ifdef _WIN32
+    closesocket(sock);
+#else
+    close(sock);
+#endif
+    return;
+  }
+
+  this->exitSocket = sock;
+  this->exitAddr = addr;
+}
+
+//////////////////////////////////////////////////
+void NodeSharedPrivate::SignalExit()
+{
+  if (this->exitSocket < 0)
+    return;
+
+  const char byte = 0;
+  sendto(this->exitSocket, reinterpret_cast<const raw_type *>(&byte),
+    sizeof(byte), 0, reinterpret_cast<const sockaddr *>(&this->exitAddr),
+    sizeof(this->exitAddr));
+}
+
+//////////////////////////////////////////////////
+void NodeSharedPrivate::PollExitSocket(zmq::pollitem_t *_items,
+    std::size_t &_count) const
+{
+  if (this->exitSocket < 0)
+    return;
+
+  _items[_count++] = {nullptr,
+    static_cast<decltype(zmq::pollitem_t::fd)>(this->exitSocket),
+    ZMQ_POLLIN, 0};
+}
+
+//////////////////////////////////////////////////
+void NodeSharedPrivate::Poll(zmq::pollitem_t *_items,
+    const std::size_t _count, std::chrono::milliseconds _timeout,
+    Timestamp &_spinUntil) const
+{
+  if (this->busyPoll.count() == 0)
+  {
+    zmq::poll(_items, _count, _timeout);
+    return;
+  }
+
+  if (std::chrono::steady_clock::now() < _spinUntil)
+    _timeout = std::chrono::milliseconds(0);
+  if (zmq::poll(_items, _count, _timeout) > 0)
+    _spinUntil = std::chrono::steady_clock::now() + this->busyPoll;
+}
+
+//////////////////////////////////////////////////
+zmq::context_t *NodeSharedPrivate::CreateContext()
+{
+  int ioThreads = 1;
+  std::string ioThreadsStr;
+  if (env("GZ_TRANSPORT_ZMQ_IO_THREADS", ioThreadsStr))
+  {
+    try
+    {
+      ioThreads = std::stoi(ioThreadsStr);
+    }
+    catch (...)
+    {
+      ioThreads = 0;
+    }
+    if (ioThreads < 1)
+    {
+      std::cerr << "GZ_TRANSPORT_ZMQ_IO_THREADS must be a positive number. "
+                << "Using 1." << std::endl;
+      ioThreads = 1;
+    }
+  }
+
+  auto context = new zmq::context_t(ioThreads);
+
+  // The I/O threads are started with the first socket.
+  ThreadSettings settings;
+  if (ThreadSettingsTable::FromEnv().Find("zmq", settings))
+  {
+#ifdef GZ_CPPZMQ_POST_4_7_0
+    void *handle = context->handle();
+#else
+    void *handle = static_cast<void *>(*context);
+#endif
+    bool result = true;
+#ifdef ZMQ_THREAD_AFFINITY_CPU_ADD
+    for (const int cpu : settings.cpus)
+      result &= zmq_ctx_set(handle, ZMQ_THREAD_AFFINITY_CPU_ADD, cpu) == 0;
+#else
+    result &= settings.cpus.empty();
+#endif
+#if defined(ZMQ_THREAD_SCHED_POLICY) && !defined(_WIN32)
+    if (settings.policy != SchedPolicy::INHERIT)
+    {
+      int policy = SCHED_OTHER;
+      if (settings.policy == SchedPolicy::FIFO)
+        policy = SCHED_FIFO;
+      else if (settings.policy == SchedPolicy::RR)
+        policy = SCHED_RR;
+      result &= zmq_ctx_set(handle, ZMQ_THREAD_SCHED_POLICY, policy) == 0;
+      if (settings.policy != SchedPolicy::OTHER)
+      {
+        result &= zmq_ctx_set(handle, ZMQ_THREAD_PRIORITY,
+          settings.priority) == 0;
+      }
+    }
+#else
+    result &= settings.policy == SchedPolicy::INHERIT;
+#endif
+    if (!result)
+    {
+      std::cerr << "Unable to configure the ZMQ I/O threads, this version of "
+                << "ZMQ doesn't support the settings." << std::endl;
+    }
+  }
+
+  return context;
 }
 
 //////////////////////////////////////////////////
 void NodeShared::RunReceptionTask()
 {
+  configureThread("reception");
+
+  Timestamp spinUntil = Timestamp::min();
+  Timestamp expireAt = Timestamp::min();
   while (!this->dataPtr->exit)
   {
-    // Poll socket for a reply, with timeout.
-    zmq::pollitem_t items[] =
+    // The requests are expired by this thread, it wakes up at the next
+    // deadline. While busy polling, they are only expired at that deadline
+    // or when a request with an earlier one wakes it up.
+    std::chrono::milliseconds timeout(0);
+    const Timestamp now = std::chrono::steady_clock::now();
+    if (now >= spinUntil || now >= expireAt)
     {
-      {static_cast<void*>(*this->dataPtr->subscriber), 0, ZMQ_POLLIN, 0},
-      {static_cast<void*>(*this->dataPtr->replier), 0, ZMQ_POLLIN, 0},
-      {static_cast<void*>(*this->dataPtr->responseReceiver), 0, ZMQ_POLLIN, 0}
-    };
+      timeout = this->ExpireRequests();
+      expireAt = now + timeout;
+    }
+
+    // Poll the sockets initialized, with timeout. The sockets initialized
+    // on first use are polled from the next iteration. A backend receives
+    // the data in its own threads, this one only expires the requests.
+    zmq::pollitem_t items[5];
+    std::size_t count = 0;
+    const bool topics =
+      this->dataPtr->topicSocketsReady && !this->dataPtr->backend;
+    const bool wake = this->dataPtr->srvSocketsReady;
+    const bool services = wake && !this->dataPtr->backend;
+    if (topics)
+    {
+      items[count++] =
+        {static_cast<void*>(*this->dataPtr->subscriber), 0, ZMQ_POLLIN, 0};
+    }
+    if (wake)
+    {
+      items[count++] = {static_cast<void*>(*this->dataPtr->srvWakeReceiver),
+        0, ZMQ_POLLIN, 0};
+    }
+    if (services)
+    {
+      items[count++] =
+        {static_cast<void*>(*this->dataPtr->replier), 0, ZMQ_POLLIN, 0};
+      items[count++] = {static_cast<void*>(*this->dataPtr->responseReceiver),
+        0, ZMQ_POLLIN, 0};
+    }
+    this->dataPtr->PollExitSocket(items, count);
     try
     {
-      zmq::poll(&items[0], sizeof(items) / sizeof(items[0]),
-          std::chrono::milliseconds(NodeSharedPrivate::Timeout));
+      this->dataPtr->Poll(&items[0], count, timeout, spinUntil);
     }
     catch(...)
     {
@@ -353,12 +895,18 @@ void NodeShared::RunReceptionTask()
     }
 
     //  If we got a reply, process it.
-    if (items[0].revents & ZMQ_POLLIN)
+    const std::size_t wakeIndex = topics ? 1 : 0;
+    if (topics && (items[0].revents & ZMQ_POLLIN))
       this->RecvMsgUpdate();
-    if (items[1].revents & ZMQ_POLLIN)
+    if (services && (items[wakeIndex + 1].revents & ZMQ_POLLIN))
       this->RecvSrvRequest();
-    if (items[2].revents & ZMQ_POLLIN)
+    if (services && (items[wakeIndex + 2].revents & ZMQ_POLLIN))
       this->RecvSrvResponse();
+    if (wake && (items[wakeIndex].revents & ZMQ_POLLIN))
+    {
+      this->SendSrvReplies();
+      expireAt = Timestamp::min();
+    }
   }
 }
 
@@ -367,57 +915,87 @@ bool NodeShared::Publish(
     const std::string &_topic,
     char *_data,
     const size_t _dataSize, DeallocFunc *_ffn,
-    const std::string &_msgType)
+    const std::string &_msgType,
+    void *_hint)
 {
-  try
-  {
-    // Create the messages.
-    // Note that we use zero copy for passing the message data (msg2).
-    zmq::message_t msg0(_topic.data(), _topic.size()),
-                   msg1(this->myAddress.data(), this->myAddress.size()),
-                   msg2(_data, _dataSize, _ffn, nullptr),
-                   msg3(_msgType.data(), _msgType.size());
+  if (!this->InitializeTopicSockets())
+    return false;
 
-    // Send the messages
-    std::lock_guard<std::recursive_mutex> lock(this->mutex);
+  this->dataPtr->PublishLegacy(_topic, _data, _dataSize, _msgType);
+  return this->dataPtr->Publish(_topic, this->myAddress, _data, _dataSize,
+    _ffn, _msgType, _hint, 0);
+}
 
-#ifdef GZ_ZMQ_POST_4_3_1
-    this->dataPtr->publisher->send(msg0, zmq::send_flags::sndmore);
-    this->dataPtr->publisher->send(msg1, zmq::send_flags::sndmore);
-    this->dataPtr->publisher->send(msg2, zmq::send_flags::sndmore);
-#else
-    this->dataPtr->publisher->send(msg0, ZMQ_SNDMORE);
-    this->dataPtr->publisher->send(msg1, ZMQ_SNDMORE);
-    this->dataPtr->publisher->send(msg2, ZMQ_SNDMORE);
-#endif
+//////////////////////////////////////////////////
+bool NodeSharedPrivate::Publish(const std::string &_topic,
+    const std::string &_addr, char *_data, const std::size_t _dataSize,
+    DeallocFunc *_ffn, const std::string &_msgType, void *_hint,
+    const uint32_t _flags)
+{
+  // The backend sends the message as it is, without the flags of the ZMQ
+  // publications, and doesn't keep the data.
+  if (this->backend)
+  {
+    const bool result =
+      this->backend->Publish(_topic, _msgType, _data, _dataSize);
+    if (_ffn)
+      _ffn(_data, _hint);
 
-    if (this->dataPtr->topicStatsEnabled)
-    {
-      // Create publication metadata.
-      PublicationMetadata meta;
-      // Send the sequence number, which can be used to detect dropped
-      // messages.
-      meta.seq = this->dataPtr->topicPubSeq[_topic]++;
-      // Send the publication time.
-      meta.stamp = std::chrono::duration_cast<std::chrono::milliseconds>(
-          std::chrono::steady_clock::now().time_since_epoch()).count();
-      zmq::message_t msg4(&meta, sizeof(meta));
-#ifdef GZ_ZMQ_POST_4_3_1
-      this->dataPtr->publisher->send(msg3, zmq::send_flags::sndmore);
-      this->dataPtr->publisher->send(msg4, zmq::send_flags::none);
-#else
-      this->dataPtr->publisher->send(msg3, ZMQ_SNDMORE);
-      this->dataPtr->publisher->send(msg4, 0);
-#endif
-    }
-    else
+    if (this->metrics && result)
     {
-#ifdef GZ_ZMQ_POST_4_3_1
-      this->dataPtr->publisher->send(msg3, zmq::send_flags::none);
-#else
-      this->dataPtr->publisher->send(msg3, 0);
-#endif
+      this->metrics->Add(_topic, TransportMetrics::SENT_MSGS);
+      this->metrics->Add(_topic, TransportMetrics::SENT_BYTES, _dataSize);
     }
+    else if (this->metrics)
+      this->metrics->Add(_topic, TransportMetrics::SEND_FAILURES);
+    return result;
+  }
+
+  // Above the memory cap, the message is dropped as if the high water mark
+  // of the socket was reached.
+  if (this->DropForMemoryCap(flagsPriority(_flags), _dataSize))
+  {
+    if (_ffn)
+      _ffn(_data, _hint);
+    return true;
+  }
+
+  // Account for the message until ZMQ releases it, including its fragments.
+  this->zmqSendBytes->fetch_add(static_cast<int64_t>(_dataSize),
+    std::memory_order_relaxed);
+  _hint = new ZmqRelease{_ffn, _hint, _dataSize, this->zmqSendBytes};
+  _ffn = &NodeSharedPrivate::ReleaseZmqMessage;
+
+  // The large messages are sent in fragments, the other publications don't
+  // wait behind them.
+  if (this->fragmentSize > 0 && _dataSize > this->fragmentSize)
+  {
+    return this->PublishFragments(_topic, _addr, _data, _dataSize, _ffn,
+      _msgType, _hint, _flags);
+  }
+
+  try
+  {
+    // Note that we use zero copy for passing the message data.
+    zmq::message_t payload(_data, _dataSize, _ffn, _hint);
+
+    // Send the messages. The publisher socket has its own mutex, publishing
+    // doesn't contend with the discovery and subscription updates.
+    std::lock_guard<std::mutex> lock(this->publisherMutex);
+
+    // Create publication metadata.
+    const bool withMeta =
+      this->topicStatsEnabled || (_flags & kHeaderReliable);
+    PublicationMetadata meta;
+    if (withMeta)
+      meta = this->NextMetadata(_topic);
+
+    // The payload is only valid until it is sent.
+    const uint32_t flags = this->AddToHistory(_topic, meta, _msgType,
+      _flags, _data, _dataSize);
+
+    this->SendPublication(_topic, _addr, payload, _msgType, flags,
+      withMeta ? &meta : nullptr, 1);
   }
   catch(const zmq::error_t& ze)
   {
@@ -429,88 +1007,362 @@ bool NodeShared::Publish(
 }
 
 //////////////////////////////////////////////////
-void NodeShared::RecvMsgUpdate()
+/// \brief Check whether a remote message is delivered to conflated
+/// handlers.
+/// \param[in] _handlerInfo Handlers of the topic.
+/// \return True if at least one handler is conflated.
+static bool hasConflatedHandlers(
+    const NodeShared::MatchingHandlerInfo &_handlerInfo)
 {
-  zmq::message_t msg(0);
-  std::string topic;
-  std::string sender;
-  std::string data;
-  std::string msgType;
-  HandlerInfo handlerInfo;
-
+  if (_handlerInfo.localHandlers)
   {
-    std::lock_guard<std::recursive_mutex> lock(this->mutex);
-
-    try
+    for (const auto &handler : *_handlerInfo.localHandlers)
     {
-#ifdef GZ_ZMQ_POST_4_3_1
-      if (!this->dataPtr->subscriber->recv(msg))
-#else
-      if (!this->dataPtr->subscriber->recv(&msg, 0))
-#endif
-        return;
-      topic = std::string(reinterpret_cast<char *>(msg.data()), msg.size());
+      if (handler->Conflate())
+        return true;
+    }
+  }
 
-      // TODO(caguero): Use this as extra metadata for the subscriber.
-#ifdef GZ_ZMQ_POST_4_3_1
-      if (!this->dataPtr->subscriber->recv(msg))
-#else
-      if (!this->dataPtr->subscriber->recv(&msg, 0))
-#endif
-        return;
-      sender = std::string(reinterpret_cast<char *>(msg.data()), msg.size());
+  if (_handlerInfo.rawHandlers)
+  {
+    for (const auto &handler : *_handlerInfo.rawHandlers)
+    {
+      if (handler->Conflate())
+        return true;
+    }
+  }
 
-#ifdef GZ_ZMQ_POST_4_3_1
-      if (!this->dataPtr->subscriber->recv(msg))
-#else
-      if (!this->dataPtr->subscriber->recv(&msg, 0))
-#endif
-        return;
-      data = std::string(reinterpret_cast<char *>(msg.data()), msg.size());
+  return false;
+}
 
-#ifdef GZ_ZMQ_POST_4_3_1
-      if (!this->dataPtr->subscriber->recv(msg))
-#else
-      if (!this->dataPtr->subscriber->recv(&msg, 0))
-#endif
-        return;
-      msgType = std::string(reinterpret_cast<char *>(msg.data()), msg.size());
+//////////////////////////////////////////////////
+/// \brief Remove the conflated handlers from a list of handlers.
+/// \param[in, out] _handlers The list, which is shared and therefore
+/// replaced by a filtered copy.
+template <typename ListPtrT>
+static void removeConflatedHandlers(ListPtrT &_handlers)
+{
+  if (!_handlers)
+    return;
+
+  auto filtered = std::make_shared<
+    std::vector<typename ListPtrT::element_type::value_type>>();
+  for (const auto &handler : *_handlers)
+  {
+    if (!handler->Conflate())
+      filtered->push_back(handler);
+  }
+
+  if (filtered->empty())
+    _handlers = nullptr;
+  else
+    _handlers = std::move(filtered);
+}
+
+//////////////////////////////////////////////////
+/// \brief Check whether the fragments of a remote message are delivered to
+/// fragment callbacks.
+/// \param[in] _handlerInfo Handlers of the topic.
+/// \return True if at least one handler has a fragment callback.
+static bool hasFragmentCallbacks(
+    const NodeShared::MatchingHandlerInfo &_handlerInfo)
+{
+  if (_handlerInfo.localHandlers)
+  {
+    for (const auto &handler : *_handlerInfo.localHandlers)
+    {
+      if (handler->FragmentCallback())
+        return true;
+    }
+  }
+
+  if (_handlerInfo.rawHandlers)
+  {
+    for (const auto &handler : *_handlerInfo.rawHandlers)
+    {
+      if (handler->FragmentCallback())
+        return true;
+    }
+  }
+
+  return false;
+}
+
+//////////////////////////////////////////////////
+/// \brief Run the fragment callbacks of a list of handlers.
+/// \param[in] _handlers The list, or nullptr.
+/// \param[in] _data Data of the fragment.
+/// \param[in] _fragment Header of the fragment.
+/// \param[in] _info Information of the message.
+template <typename ListPtrT>
+static void runFragmentCallbacks(const ListPtrT &_handlers,
+    const SerializedBuffer &_data, const FragmentHeader &_fragment,
+    const MessageInfo &_info)
+{
+  if (!_handlers)
+    return;
+
+  for (const auto &handler : *_handlers)
+  {
+    const auto &callback = handler->FragmentCallback();
+    if (!callback || !handler->Enabled())
+      continue;
+
+    try
+    {
+      callback(_data.Data(), _data.Size(), _fragment.offset, _fragment.size,
+        _info);
+    }
+    catch (...)
+    {
+      std::cerr << "Exception occurred in a fragment callback on topic ["
+                << _info.Topic() << "]" << std::endl;
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief Run the fragment callbacks of the handlers of a topic.
+/// \param[in] _handlerInfo Handlers of the topic.
+/// \param[in] _data Data of the fragment.
+/// \param[in] _fragment Header of the fragment.
+/// \param[in] _info Information of the message.
+static void runFragmentCallbacks(
+    const NodeShared::MatchingHandlerInfo &_handlerInfo,
+    const SerializedBuffer &_data, const FragmentHeader &_fragment,
+    const MessageInfo &_info)
+{
+  runFragmentCallbacks(_handlerInfo.localHandlers, _data, _fragment, _info);
+  runFragmentCallbacks(_handlerInfo.rawHandlers, _data, _fragment, _info);
+}
+
+//////////////////////////////////////////////////
+void NodeShared::RecvMsgUpdate(const std::size_t _shard)
+{
+  // A message received from a remote publisher.
+  struct ReceivedMsg
+  {
+    /// \brief The topic, hashed once for all the lookups.
+    TopicKey topic;
+    std::string msgType;
+    MessageInfo info;
+    SerializedBuffer data;
+    Compression_t codec = Compression_t::NONE;
+    Priority_t priority = Priority_t::NORMAL;
+    MatchingHandlerInfo handlerInfo;
+    TraceContext trace;
+    ReliableSeq reliable;
+    bool isReliable = false;
+    bool history = false;
+
+    /// \brief Set for a fragment delivered to the fragment callbacks, the
+    /// data is the fragment.
+    std::optional<FragmentHeader> fragment;
+  };
+  std::vector<ReceivedMsg> batch;
+
+  {
+    std::lock_guard<std::recursive_mutex> lock(this->mutex);
 
-      if (this->dataPtr->topicStatsEnabled)
+    // If a subscription is conflated, keep receiving the messages already
+    // queued so the outdated ones can be skipped.
+    bool conflated = false;
+    do
+    {
+      ReceivedMsg received;
+      std::string topic;
+      uint32_t flags = 0;
+      std::vector<TraceContext> traces;
+      ReceivedFragment fragment;
+      if (!this->dataPtr->RecvMsg(_shard, topic, received.msgType,
+            received.data, flags, traces, received.reliable, fragment))
       {
-#ifdef GZ_ZMQ_POST_4_3_1
-        if (!this->dataPtr->subscriber->recv(msg))
-#else
-        if (!this->dataPtr->subscriber->recv(&msg, 0))
-#endif
-          return;
-        PublicationMetadata *meta =
-          reinterpret_cast<PublicationMetadata *>(msg.data());
+        break;
+      }
+      received.topic = TopicKey(std::move(topic));
+      received.codec =
+        static_cast<Compression_t>((flags >> kHeaderCodecShift) & 0xff);
+      received.priority = flagsPriority(flags);
+      received.isReliable = (flags & kHeaderReliable) != 0;
+      received.history = (flags & kHeaderHistory) != 0;
+
+      received.info =
+        this->dataPtr->RecvMsgInfo(received.topic, received.msgType);
+
+      received.handlerInfo =
+        this->CheckMatchingHandlers(received.topic.name, received.msgType);
+
+      // The fragments of a large message are handed to the fragment
+      // callbacks as they arrive, the message once complete.
+      if (flags & kHeaderFragment)
+      {
+        SerializedBuffer msgData;
+        if (!this->dataPtr->Reassemble(received.topic.name, fragment,
+              received.data, msgData))
+        {
+          continue;
+        }
 
-        // Update topic statistics.
-        if (this->dataPtr->enabledTopicStatistics.find(topic) !=
-            this->dataPtr->enabledTopicStatistics.end())
+        if (received.codec == Compression_t::NONE &&
+            hasFragmentCallbacks(received.handlerInfo))
         {
-          this->dataPtr->topicStats[topic].Update(sender,
-              meta->stamp, meta->seq);
-          this->dataPtr->enabledTopicStatistics[topic](
-              this->dataPtr->topicStats[topic]);
+          ReceivedMsg chunk;
+          chunk.topic = received.topic;
+          chunk.info = received.info;
+          chunk.data = received.data;
+          chunk.handlerInfo = received.handlerInfo;
+          chunk.fragment = fragment.header;
+          batch.push_back(std::move(chunk));
         }
+
+        if (!msgData)
+          continue;
+        received.data = std::move(msgData);
+      }
+
+      GZ_TRANSPORT_PROBE2(recv, received.topic.name.c_str(),
+        received.data.Size());
+
+      if (this->dataPtr->metrics)
+      {
+        this->dataPtr->metrics->Add(received.topic.name,
+          TransportMetrics::RECEIVED_MSGS);
+        this->dataPtr->metrics->Add(received.topic.name,
+          TransportMetrics::RECEIVED_BYTES, received.data.Size());
+      }
+
+      conflated = conflated || hasConflatedHandlers(received.handlerInfo);
+
+      if ((flags & kHeaderBatch) == 0)
+      {
+        if (!traces.empty())
+          received.trace = traces.front();
+        batch.push_back(std::move(received));
+        continue;
+      }
+
+      // The messages of a batch are processed as if received one by one.
+      // They share the received frame.
+      std::vector<SerializedBuffer> msgs;
+      if (!NodeSharedPrivate::UnpackBatch(received.data, msgs))
+      {
+        std::cerr << "Malformed batch received on topic ["
+                  << received.topic.name << "]" << std::endl;
+      }
+
+      for (std::size_t i = 0; i < msgs.size(); ++i)
+      {
+        ReceivedMsg msg;
+        msg.topic = received.topic;
+        msg.msgType = received.msgType;
+        msg.info = received.info;
+        msg.data = std::move(msgs[i]);
+        msg.priority = received.priority;
+        msg.handlerInfo = received.handlerInfo;
+        if (i < traces.size())
+          msg.trace = traces[i];
+        batch.push_back(std::move(msg));
       }
+    } while (conflated &&
+             batch.size() < NodeSharedPrivate::kMaxRecvBatch &&
+             this->dataPtr->MsgUpdatePending(_shard));
+  }
+
+  for (std::size_t i = 0; i < batch.size(); ++i)
+  {
+    ReceivedMsg &received = batch[i];
+
+    // The span of the reception is the parent of the callbacks.
+    TraceScope span(this->dataPtr->tracer.get(), "receive",
+      received.topic.name, received.trace,
+      Tracer::kFlowIn | Tracer::kFlowOut);
+
+    if (received.fragment)
+    {
+      runFragmentCallbacks(received.handlerInfo, received.data,
+        *received.fragment, received.info);
+      continue;
     }
-    catch(const zmq::error_t &_error)
+
+    // The message is in flight until its callbacks return.
+    const std::shared_ptr<void> lockstep =
+      this->dataPtr->lockstep.Receive(received.topic.name);
+
+    // Conflated handlers only receive the newest message of a topic.
+    for (std::size_t j = i + 1; j < batch.size(); ++j)
     {
-      std::cerr << "Error: " << _error.what() << std::endl;
-      return;
+      if (batch[j].topic == received.topic && !batch[j].fragment)
+      {
+        removeConflatedHandlers(received.handlerInfo.localHandlers);
+        removeConflatedHandlers(received.handlerInfo.rawHandlers);
+        break;
+      }
+    }
+
+    // Decompress the message out of NodeShared::mutex.
+    if (received.codec != Compression_t::NONE)
+    {
+      std::string data;
+      if (!Decompress(received.codec, received.data.Data(),
+            received.data.Size(), data))
+      {
+        std::cerr << "Unable to decompress a message received on topic ["
+                  << received.topic.name << "] with codec ["
+                  << CompressionName(received.codec) << "]" << std::endl;
+        continue;
+      }
+      received.data = SerializedBuffer::Adopt(std::move(data));
+    }
+
+    MessageInfo &info = received.info;
+    if (received.isReliable)
+    {
+      info.SetSequence(received.reliable.seq);
+      info.SetSequenceGap(received.reliable.gap);
+
+      // The missing messages are delivered when the publisher responds.
+      if (received.reliable.gap > 0 && received.history)
+      {
+        this->dataPtr->RequestHistory(received.topic.name,
+          received.reliable.sender,
+          received.reliable.seq - received.reliable.gap,
+          received.reliable.seq - 1);
+      }
     }
 
-    handlerInfo = this->CheckHandlerInfo(topic);
+    // The asynchronous raw callbacks share the buffer instead of copying it.
+    this->TriggerCallbacks(info, received.data.Data(), received.data.Size(),
+        &received.data, received.handlerInfo, received.priority, lockstep);
+  }
+}
+
+//////////////////////////////////////////////////
+void NodeShared::RecvBackendMsg(const std::string &_topic,
+    const std::string &_msgType, const char *_data, const std::size_t _size)
+{
+  GZ_TRANSPORT_PROBE2(recv, _topic.c_str(), _size);
+
+  if (this->dataPtr->metrics)
+  {
+    this->dataPtr->metrics->Add(_topic, TransportMetrics::RECEIVED_MSGS);
+    this->dataPtr->metrics->Add(_topic, TransportMetrics::RECEIVED_BYTES,
+      _size);
   }
 
   MessageInfo info;
-  info.SetTopicAndPartition(topic);
-  info.SetType(msgType);
-  this->TriggerCallbacks(info, data, handlerInfo);
+  MatchingHandlerInfo handlerInfo;
+  {
+    std::lock_guard<std::recursive_mutex> lock(this->mutex);
+
+    info = this->dataPtr->RecvMsgInfo(TopicKey(_topic), _msgType);
+
+    handlerInfo = this->CheckMatchingHandlers(_topic, _msgType);
+  }
+
+  // The data is only valid during the call, the asynchronous callbacks
+  // copy it.
+  this->TriggerCallbacks(info, _data, _size, nullptr, handlerInfo,
+    Priority_t::NORMAL, this->dataPtr->lockstep.Receive(_topic));
 }
 
 //////////////////////////////////////////////////
@@ -552,129 +1404,635 @@ NodeShared::SubscriberInfo NodeShared::CheckSubscriberInfo(
 }
 
 //////////////////////////////////////////////////
-void NodeShared::TriggerCallbacks(
-    const MessageInfo &_info,
-    const std::string &_msgData,
-    const HandlerInfo &_handlerInfo)
+NodeShared::MatchingHandlerInfo NodeShared::CheckMatchingHandlers(
+    const std::string &_topic,
+    const std::string &_msgType) const
 {
-  if (!_handlerInfo.haveLocal && !_handlerInfo.haveRaw)
-    return;
+  return this->CheckMatchingSubscribers(_topic, _msgType);
+}
 
-  if (_handlerInfo.haveRaw)
+//////////////////////////////////////////////////
+/// \brief Concatenate two lists of handlers.
+/// \param[in] _first The first list, or nullptr.
+/// \param[in] _second The second list, or nullptr.
+/// \return The handlers of both lists, or nullptr if there are none.
+template<typename T>
+static std::shared_ptr<const std::vector<T>> mergeHandlers(
+    const std::shared_ptr<const std::vector<T>> &_first,
+    const std::shared_ptr<const std::vector<T>> &_second)
+{
+  if (!_second)
+    return _first;
+  if (!_first)
+    return _second;
+
+  auto merged = std::make_shared<std::vector<T>>(*_first);
+  merged->insert(merged->end(), _second->begin(), _second->end());
+  return merged;
+}
+
+//////////////////////////////////////////////////
+NodeShared::MatchingSubscriberInfo NodeShared::CheckMatchingSubscribers(
+    const std::string &_topic,
+    const std::string &_msgType) const
+{
+  auto &cache = this->dataPtr->matchingSubscribers;
+  auto &cacheMutex = this->dataPtr->matchingSubscribersMutex;
+
+  NodeSharedPrivate::MatchingSubscribersEntry entry;
+  entry.normalVersion = this->localSubscribers.normal.Version();
+  entry.rawVersion = this->localSubscribers.raw.Version();
+  entry.remoteVersion = this->remoteSubscribers.Version();
+  entry.aliasVersion =
+    this->dataPtr->aliasVersion.load(std::memory_order_acquire);
+
+  // Fast path: the subscribers haven't changed since the last lookup.
   {
-    for (const auto &node : _handlerInfo.rawHandlers)
+    std::shared_lock<std::shared_mutex> lk(cacheMutex);
+    auto topicIt = cache.find(_topic);
+    if (topicIt != cache.end())
     {
-      for (const auto &handler : node.second)
+      auto typeIt = topicIt->second.find(_msgType);
+      if (typeIt != topicIt->second.end() &&
+          typeIt->second.normalVersion == entry.normalVersion &&
+          typeIt->second.rawVersion == entry.rawVersion &&
+          typeIt->second.remoteVersion == entry.remoteVersion &&
+          typeIt->second.aliasVersion == entry.aliasVersion)
       {
-        const RawSubscriptionHandlerPtr &rawHandler = handler.second;
-        if (rawHandler)
-        {
-          if (rawHandler->TypeName() == _info.Type() ||
-              rawHandler->TypeName() == kGenericMessageType)
-          {
-            rawHandler->RunRawCallback(_msgData.c_str(), _msgData.size(),
-                _info);
-          }
-        }
-        else
-          std::cerr << "Raw subscription handler is NULL" << std::endl;
+        return typeIt->second.info;
       }
     }
   }
 
-  if (_handlerInfo.haveLocal)
   {
-    // This will be instantiated by the first suitable handler that we
-    // encounter. If there is no suitable handler, then we can avoid
-    // deserializing the message altogether.
-    std::shared_ptr<ProtoMsg> msg;
+    std::lock_guard<std::recursive_mutex> lk(this->mutex);
 
-    for (const auto &node : _handlerInfo.localHandlers)
+    // The tables are only modified with the mutex locked, the versions
+    // can't change while the subscribers are collected.
+    entry.normalVersion = this->localSubscribers.normal.Version();
+    entry.rawVersion = this->localSubscribers.raw.Version();
+    entry.remoteVersion = this->remoteSubscribers.Version();
+    entry.aliasVersion =
+      this->dataPtr->aliasVersion.load(std::memory_order_acquire);
+
+    entry.info.localHandlers =
+      this->localSubscribers.normal.MatchingHandlers(_topic, _msgType);
+
+    entry.info.rawHandlers =
+      this->localSubscribers.raw.MatchingHandlers(_topic, _msgType);
+
+    // The subscribers of the aliases of the topic share its publications.
+    auto aliasIt = this->dataPtr->topicAliases.find(_topic);
+    if (aliasIt != this->dataPtr->topicAliases.end())
     {
-      for (const auto &handler : node.second)
+      for (const std::string &alias : aliasIt->second)
       {
-        const ISubscriptionHandlerPtr &localHandler = handler.second;
-        if (localHandler)
+        entry.info.localHandlers = mergeHandlers(entry.info.localHandlers,
+          this->localSubscribers.normal.MatchingHandlers(alias, _msgType));
+        entry.info.rawHandlers = mergeHandlers(entry.info.rawHandlers,
+          this->localSubscribers.raw.MatchingHandlers(alias, _msgType));
+      }
+    }
+
+    entry.info.haveRemote =
+      this->remoteSubscribers.HasTopic(_topic, _msgType);
+
+    // The remote subscribers send the highest rate of their callbacks when
+    // they register. An older version sends the options of the publisher
+    // instead, which don't throttle more than the publisher does already.
+    if (entry.info.haveRemote)
+    {
+      entry.info.remoteMsgsPerSec = 0;
+      MsgAddresses_M remotes;
+      this->remoteSubscribers.Publishers(_topic, remotes);
+      for (const auto &proc : remotes)
+      {
+        for (const MessagePublisher &remote : proc.second)
         {
-          if (localHandler->TypeName() == _info.Type() ||
-              localHandler->TypeName() == kGenericMessageType)
+          if (remote.MsgTypeName() != _msgType &&
+              remote.MsgTypeName() != kGenericMessageType)
           {
-            if (!msg)
-            {
-              // If the message has not been deserialized yet, do it now since
-              // we have allegedly found a subscriber which should be able to
-              // do it.
-              msg = localHandler->CreateMsg(_msgData, _info.Type());
-
-              if (!msg)
-              {
-                // If the message could not be created, then none of the
-                // handlers in this process will be able to create it, because
-                // protobuf has access to all message types that the current
-                // process is linked to. If CreateMsg(~,~) fails, then we may
-                // as well quit.
-                return;
-              }
-            }
-
-            localHandler->RunLocalCallback(*msg, _info);
+            continue;
           }
+
+          const uint64_t msgsPerSec = remote.Options().MsgsPerSec();
+          if (msgsPerSec > entry.info.remoteMsgsPerSec)
+            entry.info.remoteMsgsPerSec = msgsPerSec;
         }
-        else
-          std::cerr << "Local subscription handler is NULL" << std::endl;
       }
     }
   }
+
+  // Another thread might store a more recent entry concurrently. Either
+  // way, an outdated entry is detected by the next lookup.
+  std::unique_lock<std::shared_mutex> lk(cacheMutex);
+  cache[_topic][_msgType] = entry;
+  return entry.info;
 }
 
 //////////////////////////////////////////////////
-void NodeShared::RecvSrvRequest()
+std::shared_ptr<NodeSharedPrivate::TopicInterest>
+NodeSharedPrivate::Interest(const std::string &_topic)
 {
-  if (verbose)
-    std::cout << "Message received requesting a service call" << std::endl;
+  std::lock_guard<std::mutex> lk(this->interestMutex);
+  std::weak_ptr<TopicInterest> &entry = this->interests[_topic];
+  std::shared_ptr<TopicInterest> interest = entry.lock();
+  if (!interest)
+  {
+    // The records of the topics no longer advertised are dropped as the
+    // new ones are created.
+    for (auto it = this->interests.begin(); it != this->interests.end();)
+    {
+      if (it->second.expired() && it->first != _topic)
+        it = this->interests.erase(it);
+      else
+        ++it;
+    }
 
-  zmq::message_t msg(0);
-  std::string topic;
-  std::string sender;
-  std::string nodeUuid;
-  std::string reqUuid;
-  std::string req;
-  std::string rep;
-  std::string resultStr;
-  std::string dstId;
-  std::string reqType;
-  std::string repType;
+    interest = std::make_shared<TopicInterest>();
+    this->interests[_topic] = interest;
+  }
+  return interest;
+}
 
-  IRepHandlerPtr repHandler;
-  bool hasHandler;
+//////////////////////////////////////////////////
+bool NodeSharedPrivate::Listened(const NodeShared &_shared,
+    const std::string &_topic, TopicInterest &_interest)
+{
+  // Every subscription, unsubscription and connection event increments the
+  // version of a table.
+  auto version = [&_shared]()
+  {
+    return _shared.localSubscribers.normal.Version() +
+      _shared.localSubscribers.raw.Version() +
+      _shared.remoteSubscribers.Version() +
+      _shared.dataPtr->aliasVersion.load(std::memory_order_acquire);
+  };
+
+  if (_interest.version.load(std::memory_order_acquire) == version())
+    return _interest.listened.load(std::memory_order_relaxed);
+
+  std::lock_guard<std::recursive_mutex> lk(_shared.mutex);
+  const bool listened =
+    _shared.dataPtr->TopicSubscribed(_shared, _topic) ||
+    _shared.remoteSubscribers.HasTopic(_topic);
+  _interest.listened.store(listened, std::memory_order_relaxed);
+  _interest.version.store(version(), std::memory_order_release);
+  return listened;
+}
 
+//////////////////////////////////////////////////
+bool NodeSharedPrivate::AddAlias(const std::string &_alias,
+    const std::string &_topic, const bool _local)
+{
+  auto it = this->aliases.find(_alias);
+  if (it != this->aliases.end() && it->second.topic != _topic)
   {
-    std::lock_guard<std::recursive_mutex> lock(this->mutex);
+    std::cerr << "Alias [" << _alias << "] already names topic ["
+              << it->second.topic << "], not [" << _topic << "]"
+              << std::endl;
+    return false;
+  }
 
-    try
-    {
-#ifdef GZ_ZMQ_POST_4_3_1
-      if (!this->dataPtr->replier->recv(msg))
-#else
-      if (!this->dataPtr->replier->recv(&msg, 0))
-#endif
-        return;
+  if (it == this->aliases.end())
+  {
+    it = this->aliases.emplace(_alias, TopicAlias()).first;
+    it->second.topic = _topic;
+    this->topicAliases[_topic].insert(_alias);
+    this->aliasVersion.fetch_add(1, std::memory_order_release);
+  }
 
-#ifdef GZ_ZMQ_POST_4_3_1
-      if (!this->dataPtr->replier->recv(msg))
-#else
-      if (!this->dataPtr->replier->recv(&msg, 0))
-#endif
-        return;
-      topic = std::string(reinterpret_cast<char *>(msg.data()), msg.size());
+  if (_local)
+    ++it->second.publishers;
+  else
+    it->second.subscribed = true;
+  return true;
+}
 
-#ifdef GZ_ZMQ_POST_4_3_1
-      if (!this->dataPtr->replier->recv(msg))
-#else
-      if (!this->dataPtr->replier->recv(&msg, 0))
-#endif
-        return;
-      sender = std::string(reinterpret_cast<char *>(msg.data()), msg.size());
+//////////////////////////////////////////////////
+void NodeSharedPrivate::RemoveAlias(const std::string &_alias,
+    const bool _local)
+{
+  auto it = this->aliases.find(_alias);
+  if (it == this->aliases.end())
+    return;
+
+  if (_local && it->second.publishers > 0)
+    --it->second.publishers;
+  else if (!_local)
+    it->second.subscribed = false;
+
+  if (it->second.publishers > 0 || it->second.subscribed)
+    return;
+
+  auto topicIt = this->topicAliases.find(it->second.topic);
+  if (topicIt != this->topicAliases.end())
+  {
+    topicIt->second.erase(_alias);
+    if (topicIt->second.empty())
+      this->topicAliases.erase(topicIt);
+  }
+  this->aliases.erase(it);
+  this->aliasVersion.fetch_add(1, std::memory_order_release);
+}
+
+//////////////////////////////////////////////////
+std::string NodeSharedPrivate::AliasTarget(const std::string &_alias) const
+{
+  auto it = this->aliases.find(_alias);
+  return it == this->aliases.end() ? "" : it->second.topic;
+}
+
+//////////////////////////////////////////////////
+bool NodeSharedPrivate::TopicSubscribed(const NodeShared &_shared,
+    const std::string &_topic) const
+{
+  auto subscribed = [&_shared](const std::string &_name)
+  {
+    return _shared.localSubscribers.normal.HasHandlersForTopic(_name) ||
+      _shared.localSubscribers.raw.HasHandlersForTopic(_name);
+  };
+
+  if (subscribed(_topic))
+    return true;
+
+  auto it = this->topicAliases.find(_topic);
+  return it != this->topicAliases.end() &&
+    std::any_of(it->second.begin(), it->second.end(), subscribed);
+}
+
+//////////////////////////////////////////////////
+void NodeSharedPrivate::AdvertiseAliases(const MessagePublisher &_pub,
+    const std::vector<std::string> &_aliases)
+{
+  std::vector<std::string> &advertised =
+    this->advertisedAliases[{_pub.Topic(), _pub.NUuid()}];
+  for (const std::string &alias : _aliases)
+  {
+    if (alias == _pub.Topic() || !this->AddAlias(alias, _pub.Topic(), true))
+      continue;
+
+    // The record of the alias is the one of the topic, with the topic in
+    // the control field, so the subscribers of the alias connect to the
+    // publisher of the topic.
+    MessagePublisher record(_pub);
+    record.SetTopic(alias);
+    record.SetCtrl(_pub.Ctrl() + kAliasCtrlSeparator + _pub.Topic());
+    if (!this->msgDiscovery->Advertise(record))
+    {
+      this->RemoveAlias(alias, true);
+      continue;
+    }
+    advertised.push_back(alias);
+  }
+}
+
+//////////////////////////////////////////////////
+void NodeSharedPrivate::UnadvertiseAliases(const std::string &_topic,
+    const std::string &_nUuid)
+{
+  auto it = this->advertisedAliases.find({_topic, _nUuid});
+  if (it == this->advertisedAliases.end())
+    return;
+
+  for (const std::string &alias : it->second)
+  {
+    this->msgDiscovery->Unadvertise(alias, _nUuid);
+    this->RemoveAlias(alias, true);
+  }
+  this->advertisedAliases.erase(it);
+}
+
+//////////////////////////////////////////////////
+void NodeShared::TriggerCallbacks(
+    const MessageInfo &_info,
+    const std::string &_msgData,
+    const HandlerInfo &_handlerInfo)
+{
+  // Keep the handlers accepting the message type.
+  MatchingHandlerInfo matching;
+
+  if (_handlerInfo.haveRaw)
+  {
+    auto rawHandlers =
+      std::make_shared<std::vector<RawSubscriptionHandlerPtr>>();
+    for (const auto &node : _handlerInfo.rawHandlers)
+    {
+      for (const auto &handler : node.second)
+      {
+        const RawSubscriptionHandlerPtr &rawHandler = handler.second;
+        if (rawHandler)
+        {
+          if (rawHandler->TypeName() == _info.Type() ||
+              rawHandler->TypeName() == kGenericMessageType)
+          {
+            rawHandlers->push_back(rawHandler);
+          }
+        }
+        else
+          std::cerr << "Raw subscription handler is NULL" << std::endl;
+      }
+    }
+    if (!rawHandlers->empty())
+      matching.rawHandlers = std::move(rawHandlers);
+  }
+
+  if (_handlerInfo.haveLocal)
+  {
+    auto localHandlers =
+      std::make_shared<std::vector<ISubscriptionHandlerPtr>>();
+    for (const auto &node : _handlerInfo.localHandlers)
+    {
+      for (const auto &handler : node.second)
+      {
+        const ISubscriptionHandlerPtr &localHandler = handler.second;
+        if (localHandler)
+        {
+          if (localHandler->TypeName() == _info.Type() ||
+              localHandler->TypeName() == kGenericMessageType)
+          {
+            localHandlers->push_back(localHandler);
+          }
+        }
+        else
+          std::cerr << "Local subscription handler is NULL" << std::endl;
+      }
+    }
+    if (!localHandlers->empty())
+      matching.localHandlers = std::move(localHandlers);
+  }
+
+  this->TriggerCallbacks(_info, _msgData, matching);
+}
+
+//////////////////////////////////////////////////
+void NodeShared::TriggerCallbacks(
+    const MessageInfo &_info,
+    const std::string &_msgData,
+    const MatchingHandlerInfo &_handlerInfo)
+{
+  this->TriggerCallbacks(_info, _msgData.c_str(), _msgData.size(), nullptr,
+      _handlerInfo);
+}
+
+//////////////////////////////////////////////////
+void NodeShared::TriggerCallbacks(
+    const MessageInfo &_info,
+    const char *_msgData,
+    const std::size_t _msgSize,
+    const SerializedBuffer *_msgBuffer,
+    const MatchingHandlerInfo &_handlerInfo,
+    const Priority_t _priority,
+    const std::shared_ptr<void> &_lockstep)
+{
+  if (!_handlerInfo.localHandlers && !_handlerInfo.rawHandlers)
+    return;
+
+  GZ_TRANSPORT_PROBE_SCOPE(trigger, _info.Topic().c_str());
+
+  // Publication handed over to the dispatch threads for the handlers with
+  // asynchronous callbacks. Only created if there is such a handler.
+  std::unique_ptr<NodeSharedPrivate::PublishMsgDetails> asyncPub;
+  uint64_t queueDrops = 0;
+
+  // Reserve a queue slot in a handler with asynchronous callbacks.
+  // Return false if the message was dropped. Only the publishers of this
+  // process wait for a handler with QueuePolicy_t::BLOCK_PUBLISHER, the
+  // thread receiving the messages from other processes never blocks.
+  auto reserveAsync = [&](SubscriptionHandlerBase &_handler, uint64_t &_seq)
+  {
+    uint64_t dropped;
+    const bool queued = _handler.ReserveQueueSlot(_seq, dropped, _msgSize,
+      _info.IntraProcess());
+    queueDrops += dropped;
+    if (queued && !asyncPub)
+    {
+      asyncPub.reset(new NodeSharedPrivate::PublishMsgDetails);
+      asyncPub->info = _info;
+      asyncPub->priority = _priority;
+      asyncPub->lockstep = _lockstep;
+    }
+    return queued;
+  };
+
+  // Keep the serialized message for the asynchronous callbacks. The
+  // received data doesn't outlive this function, unless it is stored in a
+  // buffer that can be shared.
+  auto shareBuffer = [&]()
+  {
+    if (asyncPub->sharedBuffer)
+      return;
+
+    if (_msgBuffer)
+      asyncPub->sharedBuffer = *_msgBuffer;
+    else
+    {
+      asyncPub->sharedBuffer = SerializedBuffer(_msgSize);
+      memcpy(asyncPub->sharedBuffer.Data(), _msgData, _msgSize);
+    }
+    asyncPub->msgSize = _msgSize;
+  };
+
+  // Queue the asynchronous callbacks.
+  auto enqueueAsync = [&]()
+  {
+    if (asyncPub)
+      queueDrops += this->dataPtr->EnqueuePublication(std::move(asyncPub));
+
+    if (queueDrops > 0)
+    {
+      this->AddQueueDrops("@" + _info.Partition() + "@" + _info.Topic(),
+          queueDrops);
+    }
+  };
+
+  if (_handlerInfo.rawHandlers)
+  {
+    for (const RawSubscriptionHandlerPtr &rawHandler :
+           *_handlerInfo.rawHandlers)
+    {
+      // Don't copy the data for a callback discarded by the throttling or
+      // by the filter.
+      if (!rawHandler->CheckThrottling() ||
+          !rawHandler->CheckFilter(_msgData, _msgSize, _info.Type()))
+      {
+        continue;
+      }
+
+      if (rawHandler->AsyncCallbacks())
+      {
+        uint64_t seq;
+        if (!reserveAsync(*rawHandler, seq))
+          continue;
+
+        shareBuffer();
+        asyncPub->rawHandlers.push_back(rawHandler);
+        asyncPub->rawSeqs.push_back(seq);
+        continue;
+      }
+
+      // A callback can keep a reference to a shareable buffer.
+      TraceScope span(this->dataPtr->tracer.get(), "callback", _info.Topic(),
+        Tracer::Current());
+      this->dataPtr->RunCallback(*rawHandler, [&]()
+      {
+        if (_msgBuffer)
+          rawHandler->RunRawCallback(_msgBuffer->Shared(), _msgSize, _info);
+        else
+          rawHandler->RunRawCallback(_msgData, _msgSize, _info);
+      });
+    }
+  }
+
+  if (_handlerInfo.localHandlers && !_handlerInfo.localHandlers->empty())
+  {
+    // All the handlers accept the message type, deserialize it once, and
+    // only if at least one callback is not discarded by the throttling or
+    // by the filter. The filter is evaluated on the serialized message.
+    std::shared_ptr<ProtoMsg> msg;
+
+    // A large message is deserialized by the dispatch thread of its topic,
+    // unless a synchronous callback needs it here. The reception thread
+    // moves on to the next message, while the messages of different topics
+    // are parsed concurrently.
+    const std::size_t parseThreshold = this->dataPtr->parseThreshold;
+    const bool deferParse = parseThreshold > 0 && _msgSize >= parseThreshold;
+
+    for (const ISubscriptionHandlerPtr &localHandler :
+           *_handlerInfo.localHandlers)
+    {
+      if (!localHandler->CheckThrottling() ||
+          !localHandler->CheckFilter(_msgData, _msgSize, _info.Type()))
+      {
+        continue;
+      }
+
+      if (!msg && deferParse && localHandler->AsyncCallbacks())
+      {
+        uint64_t seq;
+        if (!reserveAsync(*localHandler, seq))
+          continue;
+
+        if (!asyncPub->parser)
+          asyncPub->parser = localHandler;
+        asyncPub->localHandlers.push_back(localHandler);
+        asyncPub->localSeqs.push_back(seq);
+        continue;
+      }
+
+      // A single synchronous handler may parse the message into one that
+      // it reuses between deliveries.
+      if (!msg && !localHandler->AsyncCallbacks() &&
+          _handlerInfo.localHandlers->size() == 1)
+      {
+        TraceScope span(this->dataPtr->tracer.get(), "callback",
+          _info.Topic(), Tracer::Current());
+        this->dataPtr->RunCallback(*localHandler, [&]()
+        {
+          localHandler->ParseAndRunLocalCallback(_msgData, _msgSize, _info);
+        });
+        continue;
+      }
+
+      if (!msg)
+      {
+        msg = localHandler->CreateMsg(_msgData, _msgSize, _info.Type());
+
+        // If the message could not be created, then none of the handlers in
+        // this process will be able to create it, because protobuf has
+        // access to all message types that the current process is linked to.
+        if (!msg)
+          break;
+      }
+
+      if (localHandler->AsyncCallbacks())
+      {
+        uint64_t seq;
+        if (!reserveAsync(*localHandler, seq))
+          continue;
+
+        asyncPub->msgCopy = msg;
+        asyncPub->localHandlers.push_back(localHandler);
+        asyncPub->localSeqs.push_back(seq);
+        continue;
+      }
+
+      TraceScope span(this->dataPtr->tracer.get(), "callback", _info.Topic(),
+        Tracer::Current());
+      this->dataPtr->RunCallback(*localHandler, [&]()
+      {
+        localHandler->RunLocalCallback(msg, _info);
+      });
+    }
+
+    // The message might have been parsed for a synchronous callback after
+    // the parse was deferred.
+    if (asyncPub && asyncPub->parser)
+    {
+      if (msg)
+      {
+        asyncPub->msgCopy = msg;
+        asyncPub->parser = nullptr;
+      }
+      else
+        shareBuffer();
+    }
+  }
+
+  enqueueAsync();
+}
+
+//////////////////////////////////////////////////
+void NodeShared::RecvSrvRequest()
+{
+  if (verbose)
+    std::cout << "Message received requesting a service call" << std::endl;
+
+  zmq::message_t msg(0);
+  std::string topic;
+  std::string sender;
+  std::string nodeUuid;
+  std::string reqUuid;
+  std::string req;
+  std::string rep;
+  std::string dstId;
+  std::string reqType;
+  std::string repType;
+  bool batch = false;
+  bool timing = false;
+  bool cache = false;
+  Timestamp received;
+
+  IRepHandlerPtr repHandler;
+  bool hasHandler;
+
+  {
+    std::lock_guard<std::recursive_mutex> lock(this->mutex);
+
+    try
+    {
+#ifdef GZ_ZMQ_POST_4_3_1
+      if (!this->dataPtr->replier->recv(msg))
+#else
+      if (!this->dataPtr->replier->recv(&msg, 0))
+#endif
+        return;
+
+#ifdef GZ_ZMQ_POST_4_3_1
+      if (!this->dataPtr->replier->recv(msg))
+#else
+      if (!this->dataPtr->replier->recv(&msg, 0))
+#endif
+        return;
+      topic = std::string(reinterpret_cast<char *>(msg.data()), msg.size());
+
+#ifdef GZ_ZMQ_POST_4_3_1
+      if (!this->dataPtr->replier->recv(msg))
+#else
+      if (!this->dataPtr->replier->recv(&msg, 0))
+#endif
+        return;
+      sender = std::string(reinterpret_cast<char *>(msg.data()), msg.size());
 
 #ifdef GZ_ZMQ_POST_4_3_1
       if (!this->dataPtr->replier->recv(msg))
@@ -723,6 +2081,28 @@ void NodeShared::RecvSrvRequest()
 #endif
         return;
       repType = std::string(reinterpret_cast<char *>(msg.data()), msg.size());
+
+      // Optional flags of the request.
+      while (msg.more())
+      {
+#ifdef GZ_ZMQ_POST_4_3_1
+        if (!this->dataPtr->replier->recv(msg))
+#else
+        if (!this->dataPtr->replier->recv(&msg, 0))
+#endif
+          return;
+        if (msg.size() != 1)
+          continue;
+
+        const char flag = *static_cast<const char *>(msg.data());
+        if (flag == kSrvRequestBatch)
+          batch = true;
+        else if (flag == kSrvRequestTiming)
+          timing = true;
+        else if (flag == kSrvRequestCache)
+          cache = true;
+      }
+      received = std::chrono::steady_clock::now();
     }
     catch(const zmq::error_t &_error)
     {
@@ -735,106 +2115,560 @@ void NodeShared::RecvSrvRequest()
       this->repliers.FirstHandler(topic, reqType, repType, repHandler);
   }
 
+  if (this->dataPtr->metrics)
+    this->dataPtr->metrics->Add(topic, TransportMetrics::SRV_REQUESTS);
+
   // Get the REP handler.
   if (hasHandler)
   {
-    // Run the service call and get the results.
-    bool result = repHandler->RunCallback(req, rep);
-
     // If 'reptype' is msgs::Empty", this is a oneway request
     // and we don't send response
-    if (repType == msgs::Empty().GetTypeName())
+    const bool oneway = repType == msgs::Empty().GetTypeName();
+    const bool timed = timing || this->dataPtr->SrvTimingEnabled(topic);
+
+    // A cacheable service answers an identical request with the response
+    // cached, without running the callback.
+    const std::chrono::milliseconds cacheTtl = oneway || batch ?
+      std::chrono::milliseconds(0) : repHandler->CacheTtl();
+    if (cacheTtl.count() > 0)
     {
-      return;
+      std::chrono::milliseconds ttl;
+      if (this->dataPtr->srvCache.Find(repHandler->HandlerUuid(), req, rep,
+            ttl))
+      {
+        this->SendSrvReply(sender, dstId, topic, nodeUuid, reqUuid, rep,
+          true, "", cache ? ttl : std::chrono::milliseconds(0));
+        return;
+      }
     }
 
-    if (result)
-      resultStr = "1";
-    else
-      resultStr = "0";
-
+    // Let a service thread run the callback, or the callback send the
+    // response later. The reception thread keeps receiving the other
+    // requests. The requests of a batch are run one after the other.
+    if (repHandler->Concurrency() > 0 || (repHandler->Deferred() && !batch))
     {
-      std::lock_guard<std::recursive_mutex> lock(this->mutex);
-      // I am still not connected to this address.
-      if (std::find(this->srvConnections.begin(), this->srvConnections.end(),
-            sender) == this->srvConnections.end())
+      NodeSharedPrivate::SrvRequest request;
+      request.handler = repHandler;
+      request.topic = std::move(topic);
+      request.sender = std::move(sender);
+      request.dstId = std::move(dstId);
+      request.nodeUuid = std::move(nodeUuid);
+      request.reqUuid = std::move(reqUuid);
+      request.req = std::move(req);
+      request.oneway = oneway;
+      request.batch = batch;
+      request.timed = timed;
+      request.timing = timing && !oneway;
+      request.cacheTtl = cacheTtl;
+      request.cache = cache;
+      request.received = received;
+      if (repHandler->Concurrency() > 0)
       {
-        this->dataPtr->replier->connect(sender.c_str());
-        this->srvConnections.push_back(sender);
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-
-        if (this->verbose)
-        {
-          std::cout << "\t* Connected to [" << sender
-                    << "] for sending a response" << std::endl;
-        }
+        this->dataPtr->DispatchSrvRequest(std::move(request));
+      }
+      else
+      {
+        repHandler->RunDeferredCallback(request.req,
+          this->dataPtr->SrvReplyFunc(request));
       }
+      return;
     }
 
-    // Send the reply.
-    try
-    {
-      std::lock_guard<std::recursive_mutex> lock(this->mutex);
-      zmq::message_t response;
+    // Run the service call and get the results.
+    const Timestamp started = timed ? std::chrono::steady_clock::now() :
+      Timestamp();
+    bool result = batch ?
+      NodeSharedPrivate::RunSrvBatch(*repHandler, req, rep) :
+      repHandler->RunCallback(req, rep);
 
-      response.rebuild(dstId.size());
-      memcpy(response.data(), dstId.data(), dstId.size());
-#ifdef GZ_ZMQ_POST_4_3_1
-      this->dataPtr->replier->send(response, zmq::send_flags::sndmore);
-#else
-      this->dataPtr->replier->send(response, ZMQ_SNDMORE);
-#endif
+    std::string times;
+    if (timed)
+      times = this->dataPtr->SrvCallDone(topic, received, started);
 
-      response.rebuild(topic.size());
-      memcpy(response.data(), topic.data(), topic.size());
+    if (oneway)
+      return;
+
+    // Only the responses of the successful calls are cached.
+    const bool cached = result && cacheTtl.count() > 0;
+    if (cached)
+    {
+      this->dataPtr->srvCache.Insert(repHandler->HandlerUuid(), req, rep,
+        cacheTtl);
+    }
+
+    this->SendSrvReply(sender, dstId, topic, nodeUuid, reqUuid, rep, result,
+      timing ? times : "", cached && cache ? cacheTtl :
+        std::chrono::milliseconds(0));
+  }
+  // else
+  //   std::cerr << "I do not have a service call registered for topic ["
+  //             << topic << "]\n";
+}
+
+//////////////////////////////////////////////////
+void NodeShared::RecvBackendRequest(const BackendRequest &_request,
+    TransportBackendListener::ReplyFunc _reply)
+{
+  IRepHandlerPtr repHandler;
+  bool hasHandler;
+  {
+    std::lock_guard<std::recursive_mutex> lock(this->mutex);
+    hasHandler = this->repliers.FirstHandler(_request.topic,
+      _request.reqType, _request.repType, repHandler);
+  }
+
+  if (this->dataPtr->metrics)
+  {
+    this->dataPtr->metrics->Add(_request.topic,
+      TransportMetrics::SRV_REQUESTS);
+  }
+
+  if (!hasHandler)
+    return;
+
+  // A oneway request has no response.
+  if (_request.repType == msgs::Empty().GetTypeName())
+    _reply = [](const std::string &, const bool) {};
+
+  // The callback runs in the thread of the backend, a deferred callback
+  // might reply later.
+  if (_request.batch)
+  {
+    std::string rep;
+    const bool result =
+      NodeSharedPrivate::RunSrvBatch(*repHandler, _request.data, rep);
+    _reply(rep, result);
+  }
+  else
+  {
+    repHandler->RunDeferredCallback(_request.data, _reply);
+  }
+}
+
+//////////////////////////////////////////////////
+void NodeShared::SendSrvReply(const std::string &_sender,
+    const std::string &_dstId, const std::string &_topic,
+    const std::string &_nodeUuid, const std::string &_reqUuid,
+    const std::string &_rep, const bool _result, const std::string &_timing,
+    const std::chrono::milliseconds &_cacheTtl)
+{
+  const std::string resultStr = _result ? "1" : "0";
+
+  {
+    std::lock_guard<std::recursive_mutex> lock(this->mutex);
+    // I am still not connected to this address.
+    if (std::find(this->srvConnections.begin(), this->srvConnections.end(),
+          _sender) == this->srvConnections.end())
+    {
+      this->dataPtr->replier->connect(_sender.c_str());
+      this->srvConnections.push_back(_sender);
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+      if (this->verbose)
+      {
+        std::cout << "\t* Connected to [" << _sender
+                  << "] for sending a response" << std::endl;
+      }
+    }
+  }
+
+  // Send the reply.
+  try
+  {
+    std::lock_guard<std::recursive_mutex> lock(this->mutex);
+    zmq::message_t response;
+
+    response.rebuild(_dstId.size());
+    memcpy(response.data(), _dstId.data(), _dstId.size());
 #ifdef GZ_ZMQ_POST_4_3_1
-      this->dataPtr->replier->send(response, zmq::send_flags::sndmore);
+    this->dataPtr->replier->send(response, zmq::send_flags::sndmore);
 #else
-      this->dataPtr->replier->send(response, ZMQ_SNDMORE);
+    this->dataPtr->replier->send(response, ZMQ_SNDMORE);
 #endif
 
-      response.rebuild(nodeUuid.size());
-      memcpy(response.data(), nodeUuid.data(), nodeUuid.size());
+    response.rebuild(_topic.size());
+    memcpy(response.data(), _topic.data(), _topic.size());
 #ifdef GZ_ZMQ_POST_4_3_1
-      this->dataPtr->replier->send(response, zmq::send_flags::sndmore);
+    this->dataPtr->replier->send(response, zmq::send_flags::sndmore);
 #else
-      this->dataPtr->replier->send(response, ZMQ_SNDMORE);
+    this->dataPtr->replier->send(response, ZMQ_SNDMORE);
 #endif
 
-      response.rebuild(reqUuid.size());
-      memcpy(response.data(), reqUuid.data(), reqUuid.size());
+    response.rebuild(_nodeUuid.size());
+    memcpy(response.data(), _nodeUuid.data(), _nodeUuid.size());
 #ifdef GZ_ZMQ_POST_4_3_1
-      this->dataPtr->replier->send(response, zmq::send_flags::sndmore);
+    this->dataPtr->replier->send(response, zmq::send_flags::sndmore);
 #else
-      this->dataPtr->replier->send(response, ZMQ_SNDMORE);
+    this->dataPtr->replier->send(response, ZMQ_SNDMORE);
 #endif
 
-      response.rebuild(rep.size());
-      memcpy(response.data(), rep.data(), rep.size());
+    response.rebuild(_reqUuid.size());
+    memcpy(response.data(), _reqUuid.data(), _reqUuid.size());
 #ifdef GZ_ZMQ_POST_4_3_1
-      this->dataPtr->replier->send(response, zmq::send_flags::sndmore);
+    this->dataPtr->replier->send(response, zmq::send_flags::sndmore);
 #else
-      this->dataPtr->replier->send(response, ZMQ_SNDMORE);
+    this->dataPtr->replier->send(response, ZMQ_SNDMORE);
 #endif
 
-      response.rebuild(resultStr.size());
-      memcpy(response.data(), resultStr.data(), resultStr.size());
+    response.rebuild(_rep.size());
+    memcpy(response.data(), _rep.data(), _rep.size());
 #ifdef GZ_ZMQ_POST_4_3_1
-      this->dataPtr->replier->send(response, zmq::send_flags::none);
+    this->dataPtr->replier->send(response, zmq::send_flags::sndmore);
 #else
-      this->dataPtr->replier->send(response, 0);
+    this->dataPtr->replier->send(response, ZMQ_SNDMORE);
 #endif
+
+    // The times of the call and the time to live of the response are sent
+    // only when the requester asked for them, other requesters don't
+    // expect more frames.
+    std::vector<std::string> frames;
+    if (!_timing.empty())
+      frames.push_back(std::string(1, kSrvRequestTiming) + _timing);
+    if (_cacheTtl.count() > 0)
+    {
+      frames.push_back(std::string(1, kSrvRequestCache) +
+        std::to_string(_cacheTtl.count()));
     }
-    catch(const zmq::error_t &_error)
+
+    response.rebuild(resultStr.size());
+    memcpy(response.data(), resultStr.data(), resultStr.size());
+#ifdef GZ_ZMQ_POST_4_3_1
+    this->dataPtr->replier->send(response, frames.empty() ?
+      zmq::send_flags::none : zmq::send_flags::sndmore);
+#else
+    this->dataPtr->replier->send(response, frames.empty() ? 0 : ZMQ_SNDMORE);
+#endif
+
+    for (std::size_t i = 0; i < frames.size(); ++i)
     {
-      std::cerr << "NodeShared::RecvSrvRequest() error sending response: "
-                << _error.what() << std::endl;
+      const bool last = i + 1 == frames.size();
+      response.rebuild(frames[i].size());
+      memcpy(response.data(), frames[i].data(), frames[i].size());
+#ifdef GZ_ZMQ_POST_4_3_1
+      this->dataPtr->replier->send(response,
+        last ? zmq::send_flags::none : zmq::send_flags::sndmore);
+#else
+      this->dataPtr->replier->send(response, last ? 0 : ZMQ_SNDMORE);
+#endif
+    }
+
+    if (this->dataPtr->metrics)
+      this->dataPtr->metrics->Add(_topic, TransportMetrics::SRV_RESPONSES);
+  }
+  catch(const zmq::error_t &_error)
+  {
+    std::cerr << "NodeShared::SendSrvReply() error sending response: "
+              << _error.what() << std::endl;
+  }
+}
+
+//////////////////////////////////////////////////
+void NodeShared::SendSrvReplies()
+{
+  std::deque<NodeSharedPrivate::SrvReply> replies;
+  try
+  {
+    // One wake up can cover several responses, discard all of them.
+    zmq::message_t msg;
+#ifdef GZ_ZMQ_POST_4_3_1
+    while (this->dataPtr->srvWakeReceiver->recv(msg,
+             zmq::recv_flags::dontwait))
+#else
+    while (this->dataPtr->srvWakeReceiver->recv(&msg, ZMQ_DONTWAIT))
+#endif
+    {
+    }
+  }
+  catch(const zmq::error_t &_error)
+  {
+    std::cerr << "NodeShared::SendSrvReplies() error: " << _error.what()
+              << std::endl;
+  }
+
+  {
+    std::lock_guard<std::mutex> lk(this->dataPtr->srvMutex);
+    replies.swap(this->dataPtr->srvReplies);
+  }
+
+  for (const auto &reply : replies)
+  {
+    this->SendSrvReply(reply.sender, reply.dstId, reply.topic,
+      reply.nodeUuid, reply.reqUuid, reply.rep, reply.result, reply.timing,
+      reply.cacheTtl);
+  }
+}
+
+//////////////////////////////////////////////////
+void NodeSharedPrivate::DispatchSrvRequest(SrvRequest &&_request)
+{
+  std::lock_guard<std::mutex> lk(this->srvMutex);
+  const std::string uuid = _request.handler->HandlerUuid();
+  const uint32_t concurrency = _request.handler->Concurrency();
+
+  SrvQueue &queue = this->srvQueues[uuid];
+  queue.priority = _request.handler->Priority();
+  queue.pending.push_back(std::move(_request));
+
+  // The other requests of the handler are run by the threads already
+  // working on it.
+  if (queue.running >= concurrency)
+    return;
+
+  // The jobs are started in order of priority, then of arrival.
+  ++queue.running;
+  auto pos = std::find_if(this->srvJobs.begin(), this->srvJobs.end(),
+    [this, &queue](const std::string &_job)
+    {
+      return this->srvQueues.at(_job).priority > queue.priority;
+    });
+  this->srvJobs.insert(pos, uuid);
+  if (this->srvIdleThreads < this->srvJobs.size())
+    this->srvThreads.emplace_back(&NodeSharedPrivate::SrvThread, this);
+  else
+    this->srvCondition.notify_one();
+}
+
+//////////////////////////////////////////////////
+std::function<void(const std::string &, const bool)>
+  NodeSharedPrivate::SrvReplyFunc(const SrvRequest &_request)
+{
+  if (_request.oneway && !_request.timed)
+    return [](const std::string &, const bool) {};
+
+  // The callback starts once the function is created.
+  const Timestamp started = _request.timed ?
+    std::chrono::steady_clock::now() : Timestamp();
+  const Timestamp received = _request.received;
+  const bool timed = _request.timed;
+  const bool timing = _request.timing;
+  const bool oneway = _request.oneway;
+  const std::chrono::milliseconds cacheTtl = _request.cacheTtl;
+  const bool cache = _request.cache;
+
+  // The request is the key of the response cached.
+  const std::string uuid =
+    cacheTtl.count() > 0 ? _request.handler->HandlerUuid() : "";
+  const std::string req = cacheTtl.count() > 0 ? _request.req : "";
+
+  SrvReply reply;
+  reply.sender = _request.sender;
+  reply.dstId = _request.dstId;
+  reply.topic = _request.topic;
+  reply.nodeUuid = _request.nodeUuid;
+  reply.reqUuid = _request.reqUuid;
+  return [this, reply, received, started, timed, timing, oneway, cacheTtl,
+          cache, uuid, req](const std::string &_rep, const bool _result)
+    mutable
+  {
+    if (timed)
+    {
+      std::string times = this->SrvCallDone(reply.topic, received, started);
+      if (timing)
+        reply.timing = std::move(times);
+    }
+
+    if (oneway)
       return;
+
+    // Only the responses of the successful calls are cached.
+    if (_result && cacheTtl.count() > 0)
+    {
+      this->srvCache.Insert(uuid, req, _rep, cacheTtl);
+      if (cache)
+        reply.cacheTtl = cacheTtl;
     }
+
+    reply.rep = _rep;
+    reply.result = _result;
+    this->QueueSrvReply(std::move(reply));
+  };
+}
+
+//////////////////////////////////////////////////
+void NodeSharedPrivate::QueueSrvReply(SrvReply &&_reply)
+{
+  {
+    std::lock_guard<std::mutex> lk(this->srvMutex);
+
+    // Wake up the reception thread, the replier socket is only used by it.
+    // A single wake up is pending until it takes the responses.
+    const bool wake = this->srvReplies.empty();
+    this->srvReplies.push_back(std::move(_reply));
+    if (!wake)
+      return;
   }
-  // else
-  //   std::cerr << "I do not have a service call registered for topic ["
-  //             << topic << "]\n";
+
+  this->WakeReception();
+}
+
+//////////////////////////////////////////////////
+void NodeSharedPrivate::WakeReception()
+{
+  std::lock_guard<std::mutex> lk(this->wakeMutex);
+  if (!this->srvWakeSender)
+    return;
+
+  try
+  {
+    zmq::message_t msg(0);
+#ifdef GZ_ZMQ_POST_4_3_1
+    this->srvWakeSender->send(msg, zmq::send_flags::dontwait);
+#else
+    this->srvWakeSender->send(msg, ZMQ_DONTWAIT);
+#endif
+  }
+  catch(const zmq::error_t &_error)
+  {
+    std::cerr << "Error waking up the reception thread: "
+              << _error.what() << std::endl;
+  }
+}
+
+//////////////////////////////////////////////////
+bool NodeSharedPrivate::RunSrvBatch(IRepHandler &_handler,
+    const std::string &_req, std::string &_rep)
+{
+  std::vector<std::string> reqs;
+  if (!IReqHandler::UnpackBatch(_req, reqs))
+  {
+    std::cerr << "Malformed batch of service requests" << std::endl;
+    return false;
+  }
+
+  // Each response is preceded by the result of its service call.
+  std::vector<std::string> reps(reqs.size());
+  for (std::size_t i = 0; i < reqs.size(); ++i)
+  {
+    std::string rep;
+    const bool result = _handler.RunCallback(reqs[i], rep);
+    reps[i].reserve(rep.size() + 1);
+    reps[i].push_back(result ? 1 : 0);
+    reps[i].append(rep);
+  }
+
+  IReqHandler::PackBatch(reps, _rep);
+  return true;
+}
+
+//////////////////////////////////////////////////
+void NodeSharedPrivate::SrvThread()
+{
+  configureThread("service");
+
+  std::unique_lock<std::mutex> lk(this->srvMutex);
+  while (true)
+  {
+    ++this->srvIdleThreads;
+    this->srvCondition.wait(lk, [this]
+    {
+      return this->exit || !this->srvJobs.empty();
+    });
+    --this->srvIdleThreads;
+
+    if (this->exit)
+      return;
+
+    const std::string uuid = std::move(this->srvJobs.front());
+    this->srvJobs.pop_front();
+
+    // The queue is not removed while a thread is running its requests.
+    auto it = this->srvQueues.find(uuid);
+    SrvQueue &queue = it->second;
+    while (!queue.pending.empty() && !this->exit)
+    {
+      SrvRequest request = std::move(queue.pending.front());
+      queue.pending.pop_front();
+
+      lk.unlock();
+      if (request.batch)
+      {
+        auto reply = this->SrvReplyFunc(request);
+        std::string rep;
+        const bool result = RunSrvBatch(*request.handler, request.req, rep);
+        reply(rep, result);
+      }
+      else
+      {
+        request.handler->RunDeferredCallback(request.req,
+          this->SrvReplyFunc(request));
+      }
+      lk.lock();
+    }
+
+    if (--queue.running == 0 && queue.pending.empty())
+      this->srvQueues.erase(it);
+  }
+}
+
+//////////////////////////////////////////////////
+void NodeShared::AddRequest(const std::string &_topic,
+  const IReqHandlerPtr &_handler)
+{
+  if (_handler->Deadline() == Timestamp::max() &&
+      this->dataPtr->requestTimeout.count() > 0)
+  {
+    _handler->SetDeadline(std::chrono::steady_clock::now() +
+      this->dataPtr->requestTimeout);
+  }
+
+  const Timestamp deadline = _handler->Deadline();
+  if (deadline == Timestamp::max())
+  {
+    this->dataPtr->requests.Add(_topic, _handler);
+    return;
+  }
+
+  // The deadlines are enforced by the reception thread, started with the
+  // sockets. Without it, the request is abandoned right away.
+  if (!this->InitializeServiceSockets())
+  {
+    NodeSharedPrivate::ExpireRequest(_handler);
+    return;
+  }
+
+  if (!this->dataPtr->requests.Add(_topic, _handler))
+    return;
+
+  // Wake up the reception thread if it sleeps past the deadline.
+  if (deadline < this->dataPtr->receptionWake)
+  {
+    this->dataPtr->receptionWake = deadline;
+    this->dataPtr->WakeReception();
+  }
+}
+
+//////////////////////////////////////////////////
+bool NodeShared::RemoveRequest(const std::string &_hUuid)
+{
+  this->dataPtr->UntrackSrvRequest(_hUuid, false);
+  return this->dataPtr->requests.Remove(_hUuid);
+}
+
+//////////////////////////////////////////////////
+std::chrono::milliseconds NodeShared::ExpireRequests()
+{
+  std::vector<IReqHandlerPtr> expired;
+  Timestamp now;
+  Timestamp wake;
+  {
+    std::lock_guard<std::recursive_mutex> lock(this->mutex);
+    now = std::chrono::steady_clock::now();
+    this->dataPtr->requests.Expire(now, expired);
+    for (const auto &handler : expired)
+      this->dataPtr->UntrackSrvRequest(handler->HandlerUuid(), false);
+    this->dataPtr->ExpirePartialMsgs(now);
+
+    // The requests added from now on with an earlier deadline wake us up.
+    wake = std::min(this->dataPtr->requests.NextDeadline(),
+      now + std::chrono::milliseconds(NodeSharedPrivate::Timeout));
+    this->dataPtr->receptionWake = wake;
+  }
+
+  for (const auto &handler : expired)
+    NodeSharedPrivate::ExpireRequest(handler);
+
+  return std::max(std::chrono::milliseconds(0),
+    std::chrono::ceil<std::chrono::milliseconds>(wake - now));
 }
 
 //////////////////////////////////////////////////
@@ -849,11 +2683,10 @@ void NodeShared::RecvSrvResponse()
   std::string reqUuid;
   std::string rep;
   std::string resultStr;
+  std::string timing;
+  std::chrono::milliseconds cacheTtl(0);
   bool result;
 
-  IReqHandlerPtr reqHandlerPtr;
-  bool hasHandler;
-
   {
     std::lock_guard<std::recursive_mutex> lock(this->mutex);
 
@@ -906,6 +2739,28 @@ void NodeShared::RecvSrvResponse()
         return;
       resultStr = std::string(reinterpret_cast<char *>(msg.data()), msg.size());
       result = resultStr == "1";
+
+      // Optional frames of the response.
+      while (msg.more())
+      {
+#ifdef GZ_ZMQ_POST_4_3_1
+        if (!this->dataPtr->responseReceiver->recv(msg))
+#else
+        if (!this->dataPtr->responseReceiver->recv(&msg, 0))
+#endif
+          return;
+        if (msg.size() < 2)
+          continue;
+
+        const char flag = *static_cast<const char *>(msg.data());
+        const std::string value(static_cast<const char *>(msg.data()) + 1,
+          msg.size() - 1);
+        if (flag == kSrvRequestTiming)
+          timing = value;
+        else if (flag == kSrvRequestCache)
+          cacheTtl = std::chrono::milliseconds(std::strtoll(value.c_str(),
+            nullptr, 10));
+      }
     }
     catch(const zmq::error_t &_error)
     {
@@ -913,119 +2768,518 @@ void NodeShared::RecvSrvResponse()
                 << _error.what() << std::endl;
       return;
     }
-
-    hasHandler =
-      this->requests.Handler(topic, nodeUuid, reqUuid, reqHandlerPtr);
   }
 
-  if (hasHandler)
-  {
-    // Notify the result.
-    reqHandlerPtr->NotifyResult(rep, result);
+  this->dataPtr->NotifySrvResponse(*this, topic, nodeUuid, reqUuid, rep,
+    result, timing, cacheTtl);
+}
 
-    // Remove the handler.
-    std::lock_guard<std::recursive_mutex> lock(this->mutex);
-    {
-      if (!this->requests.RemoveHandler(topic, nodeUuid, reqUuid))
-      {
-        std::cerr << "NodeShare::RecvSrvResponse(): "
-                  << "Error removing request handler" << std::endl;
-      }
-    }
+//////////////////////////////////////////////////
+void NodeSharedPrivate::NotifySrvResponse(NodeShared &_shared,
+    const std::string &_topic, const std::string &_nodeUuid,
+    const std::string &_reqUuid, const std::string &_rep, const bool _result,
+    const std::string &_timing, const std::chrono::milliseconds &_cacheTtl)
+{
+  IReqHandlerPtr reqHandlerPtr;
+  {
+    std::lock_guard<std::recursive_mutex> lock(_shared.mutex);
+    reqHandlerPtr = this->requests.Find(_topic, _nodeUuid, _reqUuid);
   }
-  else
+
+  if (!reqHandlerPtr)
   {
     std::cerr << "Received a service call response but I don't have a handler"
               << " for it" << std::endl;
+    return;
+  }
+
+  // The responser allows the identical requests to be answered with this
+  // response for a while.
+  std::string req;
+  if (_result && _cacheTtl.count() > 0 && !reqHandlerPtr->Batch() &&
+      reqHandlerPtr->Serialize(req))
+  {
+    this->reqCache.Insert(SrvCacheId(_topic, reqHandlerPtr->ReqTypeName(),
+      reqHandlerPtr->RepTypeName()), req, _rep, _cacheTtl);
+  }
+
+  // Notify the result.
+  NodeSharedPrivate::NotifyRequest(reqHandlerPtr, _rep, _result);
+
+  // Remove the handler.
+  std::lock_guard<std::recursive_mutex> lock(_shared.mutex);
+  this->UntrackSrvRequest(_reqUuid, true, _timing);
+  if (!this->requests.Remove(_reqUuid))
+  {
+    std::cerr << "NodeShare::RecvSrvResponse(): "
+              << "Error removing request handler" << std::endl;
   }
 }
 
 //////////////////////////////////////////////////
-void NodeShared::SendPendingRemoteReqs(const std::string &_topic,
-  const std::string &_reqType, const std::string &_repType)
+std::string NodeSharedPrivate::SrvCacheId(const std::string &_topic,
+    const std::string &_reqType, const std::string &_repType)
 {
-  std::string responserAddr;
-  std::string responserId;
-  SrvAddresses_M addresses;
-  this->dataPtr->srvDiscovery->Publishers(_topic, addresses);
-  if (addresses.empty())
-    return;
+  return _topic + " " + _reqType + " " + _repType;
+}
 
-  // Find a publisher that offers this service with a particular pair of REQ/REP
-  // types.
-  bool found = false;
-  for (auto &proc : addresses)
-  {
-    auto &v = proc.second;
-    for (auto &pub : v)
-    {
-      if (pub.ReqTypeName() == _reqType && pub.RepTypeName() == _repType)
-      {
-        found = true;
-        responserAddr = pub.Addr();
-        responserId = pub.SocketId();
-        break;
-      }
-    }
-    if (found)
-      break;
-  }
+//////////////////////////////////////////////////
+void NodeShared::RecvBackendResponse(const std::string &_topic,
+    const std::string &_nodeUuid, const std::string &_reqUuid,
+    const std::string &_rep, const bool _result)
+{
+  this->dataPtr->NotifySrvResponse(*this, _topic, _nodeUuid, _reqUuid, _rep,
+    _result, "", std::chrono::milliseconds(0));
+}
 
-  if (!found)
+//////////////////////////////////////////////////
+void NodeShared::ConnectToResponser(const ServicePublisher &_pub)
+{
+  // The responsers are connected by SendPendingRemoteReqs() when the
+  // sockets of the services are created on first use.
+  if (!this->dataPtr->srvSocketsReady)
     return;
 
-  if (verbose)
+  // The backend reaches the responsers by their address.
+  if (this->dataPtr->backend)
   {
-    std::cout << "Found a service call responser at ["
-              << responserAddr << "]" << std::endl;
+    this->dataPtr->AddSrvRoute(_pub);
+    return;
   }
 
-  std::lock_guard<std::recursive_mutex> lock(this->mutex);
+  const std::string &addr = _pub.Addr();
 
   // I am still not connected to this address.
   if (std::find(this->srvConnections.begin(), this->srvConnections.end(),
-        responserAddr) == this->srvConnections.end())
+        addr) == this->srvConnections.end())
   {
-    this->dataPtr->requester->connect(responserAddr.c_str());
-    this->srvConnections.push_back(responserAddr);
-    std::this_thread::sleep_for(std::chrono::milliseconds(100));
-    if (this->verbose)
+    if (this->dataPtr->IpcConnect(*this->dataPtr->requester, _pub.PUuid(),
+          "rep"))
     {
-      std::cout << "\t* Connected to [" << responserAddr
+      this->dataPtr->ipcSrvConnections.insert(addr);
+    }
+    else
+      this->dataPtr->requester->connect(addr.c_str());
+    this->srvConnections.push_back(addr);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    if (this->verbose)
+    {
+      std::cout << "\t* Connected to [" << addr
                 << "] for service requests" << std::endl;
     }
   }
 
-  // Send all the pending REQs.
-  IReqHandler_M reqs;
-  if (!this->requests.Handlers(_topic, reqs))
+  this->dataPtr->AddSrvRoute(_pub);
+}
+
+//////////////////////////////////////////////////
+NodeSharedPrivate::SrvRoute *NodeSharedPrivate::SelectSrvRoute(
+  const std::string &_topic, const std::string &_reqType,
+  const std::string &_repType, const LoadBalancing_t _policy)
+{
+  auto it = this->srvRoutes.find(_topic);
+  if (it == this->srvRoutes.end())
+    return nullptr;
+
+  std::vector<SrvRoute *> candidates;
+  for (SrvRoute &route : it->second)
+  {
+    if (route.reqType == _reqType && route.repType == _repType)
+    {
+      if (_policy == LoadBalancing_t::FIRST)
+        return &route;
+      candidates.push_back(&route);
+    }
+  }
+
+  if (candidates.empty())
+    return nullptr;
+
+  switch (_policy)
+  {
+    case LoadBalancing_t::ROUND_ROBIN:
+    {
+      return candidates[this->srvNextRoute[_topic]++ % candidates.size()];
+    }
+    case LoadBalancing_t::LEAST_OUTSTANDING:
+    {
+      return *std::min_element(candidates.begin(), candidates.end(),
+        [](const SrvRoute *_a, const SrvRoute *_b)
+        {
+          return _a->outstanding < _b->outstanding;
+        });
+    }
+    case LoadBalancing_t::LATENCY_WEIGHTED:
+    {
+      // Measure the responsers not used yet first.
+      double total = 0;
+      for (SrvRoute *route : candidates)
+      {
+        if (route->latency <= 0)
+          return route;
+        total += 1.0 / route->latency;
+      }
+
+      double pick =
+        std::uniform_real_distribution<double>(0, total)(this->srvRandom);
+      for (SrvRoute *route : candidates)
+      {
+        pick -= 1.0 / route->latency;
+        if (pick <= 0)
+          return route;
+      }
+      return candidates.back();
+    }
+    default:
+      return candidates.front();
+  }
+}
+
+//////////////////////////////////////////////////
+void NodeSharedPrivate::TrackSrvRequest(const std::string &_reqUuid,
+  const std::string &_topic, SrvRoute &_route)
+{
+  ++_route.outstanding;
+  this->srvInflight[_reqUuid] =
+    {_topic, _route.pUuid, std::chrono::steady_clock::now()};
+}
+
+//////////////////////////////////////////////////
+void NodeSharedPrivate::UntrackSrvRequest(const std::string &_reqUuid,
+  const bool _replied, const std::string &_timing)
+{
+  auto it = this->srvInflight.find(_reqUuid);
+  if (it == this->srvInflight.end())
     return;
 
-  for (auto &node : reqs)
+  // Weight of a new response time in the moving average.
+  static const double kLatencyAlpha = 0.2;
+
+  const SrvInflight &inflight = it->second;
+  const double elapsed = _replied ?
+    std::chrono::duration<double, std::milli>(
+      std::chrono::steady_clock::now() - inflight.sent).count() : 0;
+
+  auto routesIt = this->srvRoutes.find(inflight.topic);
+  if (routesIt != this->srvRoutes.end())
   {
-    for (auto &req : node.second)
+    for (SrvRoute &route : routesIt->second)
     {
-      // Check if this service call has been already requested.
-      if (req.second->Requested())
+      if (route.pUuid != inflight.pUuid)
         continue;
 
-      // Check that the pending service call has types that match the responser.
-      if (req.second->ReqTypeName() != _reqType ||
-          req.second->RepTypeName() != _repType)
+      if (route.outstanding > 0)
+        --route.outstanding;
+
+      if (_replied)
       {
-        continue;
+        route.latency = route.latency <= 0 ? elapsed :
+          (1 - kLatencyAlpha) * route.latency + kLatencyAlpha * elapsed;
       }
+    }
+  }
 
-      // Mark the handler as requested.
-      req.second->Requested(true);
+  if (_replied && this->SrvTimingEnabled(inflight.topic))
+    this->SrvResponseDone(inflight.topic, inflight.pUuid, elapsed, _timing);
 
-      std::string data;
-      if (!req.second->Serialize(data))
-        continue;
+  this->srvInflight.erase(it);
+}
+
+//////////////////////////////////////////////////
+bool NodeSharedPrivate::SrvTimingEnabled(const std::string &_topic)
+{
+  if (this->srvSlowCall > 0 || this->srvStatsAll)
+    return true;
+
+  std::lock_guard<std::mutex> lk(this->srvStatsMutex);
+  return this->enabledSrvStats.find(_topic) != this->enabledSrvStats.end();
+}
+
+//////////////////////////////////////////////////
+std::string NodeSharedPrivate::SrvCallDone(const std::string &_topic,
+  const Timestamp &_received, const Timestamp &_started)
+{
+  const Timestamp finished = std::chrono::steady_clock::now();
+  const int64_t queueUs = std::chrono::duration_cast<
+    std::chrono::microseconds>(_started - _received).count();
+  const int64_t callbackUs = std::chrono::duration_cast<
+    std::chrono::microseconds>(finished - _started).count();
+  const double queue = queueUs / 1000.0;
+  const double callback = callbackUs / 1000.0;
+
+  {
+    std::lock_guard<std::mutex> lk(this->srvStatsMutex);
+    if (this->srvStatsAll ||
+        this->enabledSrvStats.find(_topic) != this->enabledSrvStats.end())
+    {
+      this->srvStats[_topic].Update(queue, callback);
+    }
+  }
+
+  if (this->srvSlowCall > 0 && queue + callback >= this->srvSlowCall)
+  {
+    std::cerr << "Slow service call [" << _topic << "]: queue " << queue
+              << " ms, callback " << callback << " ms" << std::endl;
+  }
+
+  return std::to_string(queueUs) + " " + std::to_string(callbackUs);
+}
+
+//////////////////////////////////////////////////
+void NodeSharedPrivate::SrvResponseDone(const std::string &_topic,
+  const std::string &_pUuid, const double _roundTrip,
+  const std::string &_timing)
+{
+  // The responser reports its times only if it supports them.
+  int64_t queueUs = 0;
+  int64_t callbackUs = 0;
+  std::istringstream stream(_timing);
+  const bool timed = !_timing.empty() && (stream >> queueUs >> callbackUs);
+  const double queue = queueUs / 1000.0;
+  const double callback = callbackUs / 1000.0;
+
+  {
+    std::lock_guard<std::mutex> lk(this->srvStatsMutex);
+    if (this->srvStatsAll ||
+        this->enabledSrvStats.find(_topic) != this->enabledSrvStats.end())
+    {
+      ServiceStatistics &stats = this->srvStats[_topic];
+      if (timed)
+        stats.UpdateResponse(_pUuid, _roundTrip, queue, callback);
+      else
+        stats.UpdateResponse(_pUuid, _roundTrip);
+    }
+  }
+
+  if (this->srvSlowCall > 0 && _roundTrip >= this->srvSlowCall)
+  {
+    std::cerr << "Slow service call [" << _topic << "] to [" << _pUuid
+              << "]: " << _roundTrip << " ms";
+    if (timed)
+    {
+      std::cerr << " (queue " << queue << " ms, callback " << callback
+                << " ms, wire "
+                << std::max(0.0, _roundTrip - queue - callback) << " ms)";
+    }
+    std::cerr << std::endl;
+  }
+}
+
+//////////////////////////////////////////////////
+void NodeSharedPrivate::AddSrvRoute(const ServicePublisher &_pub)
+{
+  std::vector<SrvRoute> &routes = this->srvRoutes[_pub.Topic()];
+  for (const SrvRoute &route : routes)
+  {
+    if (route.pUuid == _pub.PUuid() && route.addr == _pub.Addr() &&
+        route.reqType == _pub.ReqTypeName() &&
+        route.repType == _pub.RepTypeName())
+    {
+      return;
+    }
+  }
+
+  routes.push_back({_pub.PUuid(), _pub.Addr(), _pub.SocketId(),
+    _pub.ReqTypeName(), _pub.RepTypeName()});
+  routes.back().legacy = this->srvDiscovery->LegacyPeer(_pub.PUuid());
+  this->srvRoutesCondition.notify_all();
+}
+
+//////////////////////////////////////////////////
+void NodeSharedPrivate::RemoveSrvRoutes(const ServicePublisher &_pub)
+{
+  for (auto it = this->srvRoutes.begin(); it != this->srvRoutes.end();)
+  {
+    if (!_pub.Topic().empty() && it->first != _pub.Topic())
+    {
+      ++it;
+      continue;
+    }
+
+    std::vector<SrvRoute> &routes = it->second;
+    routes.erase(std::remove_if(routes.begin(), routes.end(),
+      [&_pub](const SrvRoute &_route)
+      {
+        return _route.pUuid == _pub.PUuid();
+      }), routes.end());
+
+    if (routes.empty())
+      it = this->srvRoutes.erase(it);
+    else
+      ++it;
+  }
+}
+
+//////////////////////////////////////////////////
+void NodeSharedPrivate::NotifyRequest(const IReqHandlerPtr &_handler,
+  const std::string &_rep, const bool _result)
+{
+  const std::shared_ptr<Executor> &executor = _handler->CallbackExecutor();
+  if (!executor)
+  {
+    _handler->NotifyResult(_rep, _result);
+    return;
+  }
+
+  executor->Post([_handler, _rep, _result]()
+  {
+    _handler->NotifyResult(_rep, _result);
+  });
+}
+
+//////////////////////////////////////////////////
+void NodeSharedPrivate::ExpireRequest(const IReqHandlerPtr &_handler)
+{
+  const std::shared_ptr<Executor> &executor = _handler->CallbackExecutor();
+  if (!executor)
+  {
+    _handler->Expire();
+    return;
+  }
+
+  executor->Post([_handler]()
+  {
+    _handler->Expire();
+  });
+}
+
+//////////////////////////////////////////////////
+void NodeSharedPrivate::TakeSrvRequests(const ServicePublisher &_pub,
+  std::vector<IReqHandlerPtr> &_abandoned)
+{
+  std::vector<std::string> uuids;
+  for (const auto &[reqUuid, inflight] : this->srvInflight)
+  {
+    if (inflight.pUuid == _pub.PUuid() &&
+        (_pub.Topic().empty() || inflight.topic == _pub.Topic()))
+    {
+      uuids.push_back(reqUuid);
+    }
+  }
+
+  for (const std::string &reqUuid : uuids)
+  {
+    this->UntrackSrvRequest(reqUuid, false);
+    IReqHandlerPtr handler = this->requests.Take(reqUuid);
+    if (handler)
+      _abandoned.push_back(std::move(handler));
+  }
+}
+
+//////////////////////////////////////////////////
+void NodeShared::SendPendingRemoteReqs(const std::string &_topic,
+  const std::string &_reqType, const std::string &_repType)
+{
+  std::lock_guard<std::recursive_mutex> lock(this->mutex);
+
+  if (!this->InitializeServiceSockets())
+    return;
+
+  // Connect to the responsers discovered if none is connected yet.
+  if (!this->dataPtr->SelectSrvRoute(_topic, _reqType, _repType,
+        LoadBalancing_t::FIRST))
+  {
+    SrvAddresses_M addresses;
+    this->dataPtr->srvDiscovery->Publishers(_topic, addresses);
+
+    // Find the publishers that offer this service with a particular pair of
+    // REQ/REP types.
+    for (auto &proc : addresses)
+    {
+      for (auto &pub : proc.second)
+      {
+        if (pub.ReqTypeName() != _reqType || pub.RepTypeName() != _repType)
+          continue;
+
+        if (verbose)
+        {
+          std::cout << "Found a service call responser at ["
+                    << pub.Addr() << "]" << std::endl;
+        }
+
+        this->ConnectToResponser(pub);
+      }
+    }
+
+    if (!this->dataPtr->SelectSrvRoute(_topic, _reqType, _repType,
+          LoadBalancing_t::FIRST))
+    {
+      return;
+    }
+  }
+
+  // Send all the pending REQs.
+  std::vector<IReqHandlerPtr> reqs;
+  this->dataPtr->requests.TakePending(_topic, _reqType, _repType, reqs);
+
+  const bool oneway = _repType == msgs::Empty().GetTypeName();
+
+  // Ask the responsers for the times of the calls. A oneway request has no
+  // response.
+  const bool timing = !oneway && this->dataPtr->SrvTimingEnabled(_topic);
+  const std::string cacheId =
+    NodeSharedPrivate::SrvCacheId(_topic, _reqType, _repType);
+  for (auto &req : reqs)
+  {
+    std::string data;
+    if (!req->Serialize(data))
+      continue;
+
+    auto nodeUuid = req->NodeUuid();
+    auto reqUuid = req->HandlerUuid();
+
+    // The response of an identical request to a cacheable service might
+    // still be valid, the request isn't sent.
+    std::string rep;
+    std::chrono::milliseconds ttl;
+    if (!oneway && !req->Batch() &&
+        this->dataPtr->reqCache.Find(cacheId, data, rep, ttl))
+    {
+      NodeSharedPrivate::NotifyRequest(req, rep, true);
+      this->dataPtr->requests.Remove(reqUuid);
+      continue;
+    }
+
+    // There is at least one responser for these types.
+    NodeSharedPrivate::SrvRoute *route = this->dataPtr->SelectSrvRoute(
+      _topic, _reqType, _repType, req->LoadBalancing());
+
+    const std::string &responserAddr = route->addr;
+    const std::string &responserId = route->socketId;
+
+    // A responser of the previous wire protocol runs the requests one by
+    // one.
+    if (route->legacy && req->Batch())
+    {
+      std::cerr << "Unable to send a batch of requests to service ["
+                << _topic << "]: the responser at [" << responserAddr
+                << "] uses the previous wire protocol" << std::endl;
+      NodeSharedPrivate::NotifyRequest(req, "", false);
+      this->dataPtr->requests.Remove(reqUuid);
+      continue;
+    }
 
-      auto nodeUuid = req.second->NodeUuid();
-      auto reqUuid = req.second->HandlerUuid();
+    // The responser connects back to this address to send the responses,
+    // use IPC as well if it's available in both processes.
+    const std::string &requesterAddr =
+      !this->dataPtr->ipcRequesterAddress.empty() &&
+      this->dataPtr->ipcSrvConnections.count(responserAddr) > 0 ?
+        this->dataPtr->ipcRequesterAddress : this->myRequesterAddress;
 
+    if (this->dataPtr->backend)
+    {
+      BackendRequest request;
+      request.topic = _topic;
+      request.nodeUuid = nodeUuid;
+      request.reqUuid = reqUuid;
+      request.reqType = _reqType;
+      request.repType = _repType;
+      request.data = std::move(data);
+      request.batch = req->Batch();
+      this->dataPtr->backend->Request(responserAddr, request);
+    }
+    else
+    {
       try
       {
         zmq::message_t msg;
@@ -1046,9 +3300,8 @@ void NodeShared::SendPendingRemoteReqs(const std::string &_topic,
         this->dataPtr->requester->send(msg, ZMQ_SNDMORE);
 #endif
 
-        msg.rebuild(this->myRequesterAddress.size());
-        memcpy(msg.data(), this->myRequesterAddress.data(),
-          this->myRequesterAddress.size());
+        msg.rebuild(requesterAddr.size());
+        memcpy(msg.data(), requesterAddr.data(), requesterAddr.size());
 #ifdef GZ_ZMQ_POST_4_3_1
         this->dataPtr->requester->send(msg, zmq::send_flags::sndmore);
 #else
@@ -1096,28 +3349,155 @@ void NodeShared::SendPendingRemoteReqs(const std::string &_topic,
         this->dataPtr->requester->send(msg, ZMQ_SNDMORE);
 #endif
 
+        // A batch of requests, the requests timed and the requests whose
+        // response can be cached are flagged with an additional frame each.
+        // The responsers of the previous wire protocol don't expect them.
+        std::string flags;
+        if (req->Batch())
+          flags.push_back(kSrvRequestBatch);
+        if (timing)
+          flags.push_back(kSrvRequestTiming);
+        if (!oneway && !req->Batch())
+          flags.push_back(kSrvRequestCache);
+        if (route->legacy)
+          flags.clear();
+
         msg.rebuild(_repType.size());
         memcpy(msg.data(), _repType.data(), _repType.size());
 #ifdef GZ_ZMQ_POST_4_3_1
-        this->dataPtr->requester->send(msg, zmq::send_flags::none);
+        this->dataPtr->requester->send(msg,
+          flags.empty() ? zmq::send_flags::none : zmq::send_flags::sndmore);
+#else
+        this->dataPtr->requester->send(msg, flags.empty() ? 0 : ZMQ_SNDMORE);
+#endif
+
+        for (std::size_t i = 0; i < flags.size(); ++i)
+        {
+          const bool last = i + 1 == flags.size();
+          msg.rebuild(1);
+          *static_cast<char *>(msg.data()) = flags[i];
+#ifdef GZ_ZMQ_POST_4_3_1
+          this->dataPtr->requester->send(msg,
+            last ? zmq::send_flags::none : zmq::send_flags::sndmore);
 #else
-        this->dataPtr->requester->send(msg, 0);
+          this->dataPtr->requester->send(msg, last ? 0 : ZMQ_SNDMORE);
 #endif
+        }
       }
       catch(const zmq::error_t& /*ze*/)
       {
         // Debug output.
         // std::cerr << "Error connecting [" << ze.what() << "]\n";
       }
+    }
 
-      // Remove the handler associated to this service request. We won't
-      // receive a response because this is a oneway request.
-      if (_repType == msgs::Empty().GetTypeName())
-      {
-        this->requests.RemoveHandler(_topic, nodeUuid, reqUuid);
-      }
+    // Remove the handler associated to this service request. We won't
+    // receive a response because this is a oneway request.
+    if (oneway)
+      this->dataPtr->requests.Remove(reqUuid);
+    else
+      this->dataPtr->TrackSrvRequest(reqUuid, _topic, *route);
+  }
+}
+
+//////////////////////////////////////////////////
+bool NodeShared::SendOnewayRequest(const std::string &_topic,
+  const ProtoMsg &_request, const LoadBalancing_t _policy)
+{
+  const std::string reqType = _request.GetTypeName();
+  const std::string repType = msgs::Empty().GetTypeName();
+
+  std::lock_guard<std::recursive_mutex> lock(this->mutex);
+
+  if (!this->InitializeServiceSockets())
+    return false;
+
+  // A backend sends the oneway requests as the other requests, see
+  // SendPendingRemoteReqs().
+  if (this->dataPtr->backend)
+    return false;
+
+  // Keep the order of the requests queued before the connection.
+  if (this->dataPtr->requests.HasPending(_topic, reqType, repType))
+    return false;
+
+  NodeSharedPrivate::SrvRoute *route = this->dataPtr->SelectSrvRoute(
+    _topic, reqType, repType, _policy);
+  if (!route)
+    return false;
+
+  try
+  {
+    // Serialize the request straight into its frame, before sending any
+    // other frame.
+    zmq::message_t data(_request.ByteSizeLong());
+    if (!_request.SerializeToArray(data.data(), static_cast<int>(data.size())))
+    {
+      std::cerr << "NodeShared::SendOnewayRequest(): Error serializing the "
+                << "request" << std::endl;
+      return false;
+    }
+
+    zmq::message_t msg;
+
+    msg.rebuild(route->socketId.size());
+    memcpy(msg.data(), route->socketId.data(), route->socketId.size());
+#ifdef GZ_ZMQ_POST_4_3_1
+    this->dataPtr->requester->send(msg, zmq::send_flags::sndmore);
+#else
+    this->dataPtr->requester->send(msg, ZMQ_SNDMORE);
+#endif
+
+    msg.rebuild(_topic.size());
+    memcpy(msg.data(), _topic.data(), _topic.size());
+#ifdef GZ_ZMQ_POST_4_3_1
+    this->dataPtr->requester->send(msg, zmq::send_flags::sndmore);
+#else
+    this->dataPtr->requester->send(msg, ZMQ_SNDMORE);
+#endif
+
+    // The responser doesn't answer a oneway request: the requester address,
+    // the response receiver id and the node and request UUIDs are empty.
+    for (int i = 0; i < 4; ++i)
+    {
+      msg.rebuild(0);
+#ifdef GZ_ZMQ_POST_4_3_1
+      this->dataPtr->requester->send(msg, zmq::send_flags::sndmore);
+#else
+      this->dataPtr->requester->send(msg, ZMQ_SNDMORE);
+#endif
     }
+
+#ifdef GZ_ZMQ_POST_4_3_1
+    this->dataPtr->requester->send(data, zmq::send_flags::sndmore);
+#else
+    this->dataPtr->requester->send(data, ZMQ_SNDMORE);
+#endif
+
+    msg.rebuild(reqType.size());
+    memcpy(msg.data(), reqType.data(), reqType.size());
+#ifdef GZ_ZMQ_POST_4_3_1
+    this->dataPtr->requester->send(msg, zmq::send_flags::sndmore);
+#else
+    this->dataPtr->requester->send(msg, ZMQ_SNDMORE);
+#endif
+
+    msg.rebuild(repType.size());
+    memcpy(msg.data(), repType.data(), repType.size());
+#ifdef GZ_ZMQ_POST_4_3_1
+    this->dataPtr->requester->send(msg, zmq::send_flags::none);
+#else
+    this->dataPtr->requester->send(msg, 0);
+#endif
+  }
+  catch(const zmq::error_t &_error)
+  {
+    std::cerr << "NodeShared::SendOnewayRequest() error sending request: "
+              << _error.what() << std::endl;
+    return false;
   }
+
+  return true;
 }
 
 //////////////////////////////////////////////////
@@ -1133,55 +3513,55 @@ void NodeShared::OnNewConnection(const MessagePublisher &_pub)
     std::cout << _pub;
   }
 
+  // A new publisher of a topic advertised by this process.
+  this->dataPtr->UpdateFullHeaders(topic);
+
   std::lock_guard<std::recursive_mutex> lock(this->mutex);
 
   // Check if we are interested in this topic.
   if (this->localSubscribers.HasSubscriber(topic) &&
       this->pUuid.compare(procUuid) != 0)
   {
+    // The subscribers of an alias receive the messages of the topic it
+    // names, the connection is the one of the topic.
+    MessagePublisher connection(_pub);
+    const std::string target = ctrlAliasTarget(_pub.Ctrl());
+    if (!target.empty())
+    {
+      if (!this->dataPtr->AddAlias(topic, target, false))
+        return;
+      connection.SetTopic(target);
+    }
+
     // Handle security
     this->dataPtr->SecurityOnNewConnection();
 
-    // I am not connected to the process.
-    if (!this->connections.HasPublisher(addr))
-      this->dataPtr->subscriber->connect(addr.c_str());
-
-    // Add a new filter for the topic.
-#ifdef GZ_CPPZMQ_POST_4_7_0
-    this->dataPtr->subscriber->set(zmq::sockopt::subscribe, topic);
-#else
-    this->dataPtr->subscriber->setsockopt(ZMQ_SUBSCRIBE,
-        topic.data(), topic.size());
-#endif
+    this->dataPtr->ConnectSubscriber(connection, this->hostAddr);
 
     // Register the new connection with the publisher.
-    this->connections.AddPublisher(_pub);
+    this->connections.AddPublisher(connection);
 
     if (this->verbose)
       std::cout << "\t* Connected to [" << addr << "] for data\n";
 
-    MessagePublisher pub(_pub);
-    pub.SetPUuid(this->pUuid);
-
-    // Hack: We use this field to store the PUuid of the topic publisher.
-    pub.SetCtrl(_pub.PUuid());
-
     std::vector<std::string> handlerNodeUuids =
         this->localSubscribers.NodeUuids(topic, _pub.MsgTypeName());
     for (const std::string &nodeUuid : handlerNodeUuids)
-    {
-      pub.SetNUuid(nodeUuid);
+      this->dataPtr->RegisterSubscribers(*this, connection, topic, nodeUuid);
 
-      // Send a message to the publisher notify it
-      // about all my remoteSubscribers.
-      this->dataPtr->msgDiscovery->Register(pub);
-    }
+    // The topics with a history depth send their last messages to the
+    // late joiners.
+    if (ctrlLatched(_pub.Ctrl()))
+      this->dataPtr->RequestLatched(*this, connection);
   }
 }
 
 //////////////////////////////////////////////////
 void NodeShared::OnNewDisconnection(const MessagePublisher &_pub)
 {
+  if (!_pub.Topic().empty())
+    this->dataPtr->UpdateFullHeaders(_pub.Topic());
+
   std::lock_guard<std::recursive_mutex> lock(this->mutex);
 
   std::string topic = _pub.Topic();
@@ -1205,14 +3585,45 @@ void NodeShared::OnNewDisconnection(const MessagePublisher &_pub)
 
     // I am no longer connected.
     this->connections.DelPublisherByNode(topic, procUuid, nUuid);
+
+    // Keep the connection if another node of the process publishes the
+    // topic.
+    MsgAddresses_M remaining;
+    this->connections.Publishers(topic, remaining);
+    auto procIt = remaining.find(procUuid);
+    if (procIt == remaining.end() ||
+        std::none_of(procIt->second.begin(), procIt->second.end(),
+          [&connection](const MessagePublisher &_other)
+          {
+            return _other.Addr() == connection.Addr();
+          }))
+    {
+      this->dataPtr->DisconnectSubscriber(topic, connection.Addr());
+    }
   }
   else
   {
+    // A peer of the previous wire protocol that left doesn't receive its
+    // topics anymore.
+    this->dataPtr->RemoveLegacySubscribers(procUuid);
+
     // Note: We deliberately don't remove the list of remote subscribers
     // for this process. Remote nodes might suffer package delays (due to WiFi
     // or traffic load) and if we remove them, they won't be able to receive
     // data anymore.
 
+    // The messages being reassembled from the process won't be completed.
+    std::map<std::string, std::vector<MessagePublisher>> pubs;
+    this->connections.PublishersByProc(procUuid, pubs);
+    for (const auto &node : pubs)
+    {
+      for (const MessagePublisher &pub : node.second)
+      {
+        this->dataPtr->DropPartialMsgs(pub.Topic(), pub.Addr());
+        this->dataPtr->ForgetHeaderIds(pub.Topic(), pub.Addr());
+      }
+    }
+
     MsgAddresses_M info;
     if (!this->connections.Publishers(topic, info))
       return;
@@ -1226,7 +3637,6 @@ void NodeShared::OnNewDisconnection(const MessagePublisher &_pub)
 void NodeShared::OnNewSrvConnection(const ServicePublisher &_pub)
 {
   std::string topic = _pub.Topic();
-  std::string addr = _pub.Addr();
   std::string reqType = _pub.ReqTypeName();
   std::string repType = _pub.RepTypeName();
 
@@ -1238,24 +3648,11 @@ void NodeShared::OnNewSrvConnection(const ServicePublisher &_pub)
     std::cout << _pub;
   }
 
-  // I am still not connected to this address.
-  if (std::find(this->srvConnections.begin(), this->srvConnections.end(),
-        addr) == this->srvConnections.end())
-  {
-    this->dataPtr->requester->connect(addr.c_str());
-    this->srvConnections.push_back(addr);
-    std::this_thread::sleep_for(std::chrono::milliseconds(100));
-    if (this->verbose)
-    {
-      std::cout << "\t* Connected to [" << addr
-                << "] for service requests" << std::endl;
-    }
-  }
+  this->ConnectToResponser(_pub);
 
   // Check if there's a pending service request with this specific combination
   // of request and response types.
-  IReqHandlerPtr handler;
-  if (this->requests.FirstHandler(topic, reqType, repType, handler))
+  if (this->dataPtr->requests.HasPending(topic, reqType, repType))
   {
     // Request all pending service calls for this topic and req/rep types.
     this->SendPendingRemoteReqs(topic, reqType, repType);
@@ -1267,18 +3664,28 @@ void NodeShared::OnNewSrvDisconnection(const ServicePublisher &_pub)
 {
   std::string addr = _pub.Addr();
 
-  std::lock_guard<std::recursive_mutex> lock(this->mutex);
+  // The requests sent to the responser gone won't be answered.
+  std::vector<IReqHandlerPtr> abandoned;
+  {
+    std::lock_guard<std::recursive_mutex> lock(this->mutex);
 
-  // Remove the address from the list of connected addresses.
-  this->srvConnections.erase(std::remove(std::begin(this->srvConnections),
-    std::end(this->srvConnections), addr.c_str()),
-    std::end(this->srvConnections));
+    // Remove the address from the list of connected addresses.
+    this->srvConnections.erase(std::remove(std::begin(this->srvConnections),
+      std::end(this->srvConnections), addr.c_str()),
+      std::end(this->srvConnections));
+    this->dataPtr->ipcSrvConnections.erase(addr);
+    this->dataPtr->RemoveSrvRoutes(_pub);
+    this->dataPtr->TakeSrvRequests(_pub, abandoned);
 
-  if (this->verbose)
-  {
-    std::cout << "Service call disconnection callback" << std::endl;
-    std::cout << _pub;
+    if (this->verbose)
+    {
+      std::cout << "Service call disconnection callback" << std::endl;
+      std::cout << _pub;
+    }
   }
+
+  for (const auto &handler : abandoned)
+    NodeSharedPrivate::ExpireRequest(handler);
 }
 
 //////////////////////////////////////////////////
@@ -1298,9 +3705,27 @@ void NodeShared::OnNewRegistration(const MessagePublisher &_pub)
     std::cout << "\tNode UUID: [" << nodeUuid << "]" << std::endl;
   }
 
+  // The peers of the previous wire protocol receive the topic through
+  // their own socket.
+  if (this->dataPtr->msgDiscovery->LegacyPeer(procUuid))
+    this->dataPtr->UpdateLegacySubscriber(_pub, true);
+
   // Add a remote subscriber.
   std::lock_guard<std::recursive_mutex> lock(this->mutex);
-  this->remoteSubscribers.AddPublisher(_pub);
+  if (this->remoteSubscribers.AddPublisher(_pub))
+    return;
+
+  // A node registers again when it subscribes again, possibly at another
+  // rate.
+  MessagePublisher previous;
+  if (this->remoteSubscribers.Publisher(_pub.Topic(), procUuid, nodeUuid,
+        previous) &&
+      previous.Options().MsgsPerSec() != _pub.Options().MsgsPerSec())
+  {
+    this->remoteSubscribers.DelPublisherByNode(_pub.Topic(), procUuid,
+      nodeUuid);
+    this->remoteSubscribers.AddPublisher(_pub);
+  }
 }
 
 //////////////////////////////////////////////////
@@ -1321,6 +3746,8 @@ void NodeShared::OnEndRegistration(const MessagePublisher &_pub)
     std::cout << "\tNode UUID: [" << nodeUuid << "]" << std::endl;
   }
 
+  this->dataPtr->UpdateLegacySubscriber(_pub, false);
+
   // Delete a remote subscriber.
   std::lock_guard<std::recursive_mutex> lock(this->mutex);
   this->remoteSubscribers.DelPublisherByNode(topic, procUuid, nodeUuid);
@@ -1341,17 +3768,101 @@ void NodeShared::OnSubscribers()
 //////////////////////////////////////////////////
 bool NodeShared::InitializeSockets()
 {
-  try
+  return this->InitializeTopicSockets() && this->InitializeServiceSockets();
+}
+
+//////////////////////////////////////////////////
+bool NodeShared::InitializeTopicSockets()
+{
+  if (this->dataPtr->topicSocketsReady)
+    return true;
+
+  std::lock_guard<std::mutex> lk(this->dataPtr->socketsMutex);
+  if (this->dataPtr->topicSocketsReady || this->dataPtr->topicSocketsFailed)
+    return this->dataPtr->topicSocketsReady;
+
+  // Create the local publish threads. They are started before the sockets
+  // so local publications are always processed.
+  const int dispatchThreads = this->dataPtr->NonNegativeEnvVar(
+    "GZ_TRANSPORT_DISPATCH_THREADS", kDefaultDispatchThreads);
+  // Without threads, the callbacks run in the publishing thread.
+  if (dispatchThreads > 0)
+  {
+    this->dataPtr->StartPublishThreads(
+      static_cast<std::size_t>(dispatchThreads));
+
+    // The dispatch threads may deserialize the large messages received.
+    this->dataPtr->parseThreshold = static_cast<std::size_t>(
+      this->dataPtr->NonNegativeEnvVar("GZ_TRANSPORT_PARSE_THRESHOLD", 0));
+  }
+
+  // A backend replaces the sockets and the reception threads.
+  if (this->dataPtr->backend)
+  {
+    if (!this->dataPtr->StartBackend(this->pUuid))
+    {
+      this->dataPtr->topicSocketsFailed = true;
+      return false;
+    }
+    this->myAddress = this->dataPtr->backend->Address();
+    this->dataPtr->topicSocketsReady = true;
+    return true;
+  }
+
+  // Without the security requested, no socket is bound or connected.
+  if (!this->dataPtr->security.error.empty())
   {
-    // Set the hostname's ip address.
-    this->hostAddr = this->dataPtr->msgDiscovery->HostAddr();
+    std::cerr << this->dataPtr->security.error << ". The topics are "
+              << "disabled." << std::endl;
+    this->dataPtr->topicSocketsFailed = true;
+    return false;
+  }
+
+  // The messages larger than this are published in fragments.
+  this->dataPtr->fragmentSize = static_cast<std::size_t>(
+    this->dataPtr->NonNegativeEnvVar("GZ_TRANSPORT_FRAGMENT_SIZE", 0));
 
+  // The messages received in fragments are allocated from the size
+  // announced by their first fragment, which is bounded. The variable is
+  // in MiB.
+  const int maxMsgSize = this->dataPtr->NonNegativeEnvVar(
+    "GZ_TRANSPORT_MAX_MSG_SIZE", 0);
+  if (maxMsgSize > 0)
+    this->dataPtr->maxMsgSize = static_cast<uint64_t>(maxMsgSize) << 20;
+
+  try
+  {
     // Publisher socket listening in a random port.
     std::string anyTcpEp = "tcp://" + this->hostAddr + ":*";
 
+    this->dataPtr->publisher = std::make_unique<zmq::socket_t>(
+      *this->dataPtr->context, ZMQ_PUB);
+    this->dataPtr->subscriber = std::make_unique<zmq::socket_t>(
+      *this->dataPtr->context, ZMQ_SUB);
+
     // Initialize security
     this->dataPtr->SecurityInit();
 
+    // The topics are spread over several subscriber sockets, each one
+    // drained by its own reception thread.
+    const int receptionThreads = std::max(1,
+      this->dataPtr->NonNegativeEnvVar("GZ_TRANSPORT_RECEPTION_THREADS", 1));
+    for (int i = 1; i < receptionThreads; ++i)
+    {
+      this->dataPtr->subscriberShards.push_back(
+        std::make_unique<zmq::socket_t>(*this->dataPtr->context, ZMQ_SUB));
+    }
+    this->dataPtr->subscriberConnections.resize(receptionThreads);
+
+    // Kernel buffers, TCP keepalive and I/O threads of the sockets. They
+    // apply to the connections made after they are set.
+    const SocketOptions socketOptions = SocketOptions::FromEnv();
+    socketOptions.Apply(*this->dataPtr->publisher, "publisher");
+    for (int i = 0; i < receptionThreads; ++i)
+      socketOptions.Apply(this->dataPtr->Subscriber(i), "subscriber");
+    socketOptions.ApplyPriority(*this->dataPtr->publisher,
+      Priority_t::NORMAL);
+
     int lingerVal = 0;
 #ifdef GZ_CPPZMQ_POST_4_7_0
     this->dataPtr->publisher->set(zmq::sockopt::linger, lingerVal);
@@ -1364,12 +3875,15 @@ bool NodeShared::InitializeSockets()
     int rcvQueueVal = this->dataPtr->NonNegativeEnvVar(
       "GZ_TRANSPORT_RCVHWM", kDefaultRcvHwm);
 
+    for (int i = 0; i < receptionThreads; ++i)
+    {
 #ifdef GZ_CPPZMQ_POST_4_7_0
-    this->dataPtr->subscriber->set(zmq::sockopt::rcvhwm, rcvQueueVal);
+      this->dataPtr->Subscriber(i).set(zmq::sockopt::rcvhwm, rcvQueueVal);
 #else
-    this->dataPtr->subscriber->setsockopt(ZMQ_RCVHWM,
-          &rcvQueueVal, sizeof(rcvQueueVal));
+      this->dataPtr->Subscriber(i).setsockopt(ZMQ_RCVHWM,
+            &rcvQueueVal, sizeof(rcvQueueVal));
 #endif
+    }
 
     // Set the capacity of the buffer for sending messages.
     int sndQueueVal = this->dataPtr->NonNegativeEnvVar(
@@ -1381,7 +3895,115 @@ bool NodeShared::InitializeSockets()
     this->dataPtr->publisher->bind(anyTcpEp.c_str());
     this->myAddress =
         this->dataPtr->publisher->get(zmq::sockopt::last_endpoint);
+#else
+    char bindEndPoint[1024];
+    this->dataPtr->publisher->setsockopt(ZMQ_SNDHWM,
+        &sndQueueVal, sizeof(sndQueueVal));
+
+    this->dataPtr->publisher->bind(anyTcpEp.c_str());
+    size_t size = sizeof(bindEndPoint);
+    this->dataPtr->publisher->getsockopt(ZMQ_LAST_ENDPOINT,
+        &bindEndPoint, &size);
+    this->myAddress = bindEndPoint;
+#endif
+    this->dataPtr->MonitorPublisher(*this->dataPtr->publisher,
+      this->myAddress);
+
+    // Optional IPC endpoint and shared memory transport for the
+    // subscribers in this host.
+    this->dataPtr->IpcInit(this->pUuid, false);
+    this->dataPtr->ShmInit(this->pUuid, sndQueueVal);
+  }
+  catch(const zmq::error_t& ze)
+  {
+    std::cerr << "InitializeSockets() Error: " << ze.what() << std::endl;
+    std::cerr << "Gazebo Transport has not been correctly initialized"
+              << std::endl;
+    this->dataPtr->topicSocketsFailed = true;
+    return false;
+  }
+
+  if (this->verbose)
+    std::cout << "Bind at: [" << this->myAddress << "] for pub/sub\n";
+
+  // Start the reception threads.
+  this->dataPtr->topicSocketsReady = true;
+  this->StartReception();
+  for (std::size_t i = 1; i <= this->dataPtr->subscriberShards.size(); ++i)
+  {
+    this->dataPtr->receptionThreads.emplace_back(
+      &NodeSharedPrivate::RunShardReceptionTask, this->dataPtr.get(),
+      std::ref(*this), i);
+  }
+
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool NodeShared::InitializeServiceSockets()
+{
+  if (this->dataPtr->srvSocketsReady)
+    return true;
+
+  std::lock_guard<std::mutex> lk(this->dataPtr->socketsMutex);
+  if (this->dataPtr->srvSocketsReady || this->dataPtr->srvSocketsFailed)
+    return this->dataPtr->srvSocketsReady;
+
+  // A backend replaces the sockets. The reception thread only expires the
+  // requests.
+  if (this->dataPtr->backend)
+  {
+    try
+    {
+      this->dataPtr->InitWakeSockets();
+    }
+    catch(const zmq::error_t &_error)
+    {
+      std::cerr << "InitializeSockets() Error: " << _error.what()
+                << std::endl;
+      this->dataPtr->srvSocketsFailed = true;
+      return false;
+    }
+
+    if (!this->dataPtr->StartBackend(this->pUuid))
+    {
+      this->dataPtr->srvSocketsFailed = true;
+      return false;
+    }
+    this->myRequesterAddress = this->dataPtr->backend->Address();
+    this->myReplierAddress = this->myRequesterAddress;
+    this->dataPtr->srvSocketsReady = true;
+    this->StartReception();
+    return true;
+  }
+
+  try
+  {
+    // Sockets listening in a random port.
+    std::string anyTcpEp = "tcp://" + this->hostAddr + ":*";
 
+    auto &context = *this->dataPtr->context;
+    this->dataPtr->requester =
+      std::make_unique<zmq::socket_t>(context, ZMQ_ROUTER);
+    this->dataPtr->responseReceiver =
+      std::make_unique<zmq::socket_t>(context, ZMQ_ROUTER);
+    this->dataPtr->replier =
+      std::make_unique<zmq::socket_t>(context, ZMQ_ROUTER);
+
+    // Kernel buffers, TCP keepalive and I/O threads of the sockets. They
+    // apply to the connections made after they are set.
+    const SocketOptions socketOptions = SocketOptions::FromEnv();
+    socketOptions.Apply(*this->dataPtr->requester, "service");
+    socketOptions.Apply(*this->dataPtr->responseReceiver, "service");
+    socketOptions.Apply(*this->dataPtr->replier, "service");
+    socketOptions.ApplyPriority(*this->dataPtr->requester,
+      Priority_t::NORMAL);
+    socketOptions.ApplyPriority(*this->dataPtr->responseReceiver,
+      Priority_t::NORMAL);
+    socketOptions.ApplyPriority(*this->dataPtr->replier, Priority_t::NORMAL);
+
+    int lingerVal = 0;
+#ifdef GZ_CPPZMQ_POST_4_7_0
     // ResponseReceiver socket listening in a random port.
     std::string id = this->responseReceiverId.ToString();
     this->dataPtr->responseReceiver->set(zmq::sockopt::routing_id, id);
@@ -1403,14 +4025,7 @@ bool NodeShared::InitializeSockets()
     this->dataPtr->requester->set(zmq::sockopt::router_mandatory, routeOn);
 #else
     char bindEndPoint[1024];
-    this->dataPtr->publisher->setsockopt(ZMQ_SNDHWM,
-        &sndQueueVal, sizeof(sndQueueVal));
-
-    this->dataPtr->publisher->bind(anyTcpEp.c_str());
     size_t size = sizeof(bindEndPoint);
-    this->dataPtr->publisher->getsockopt(ZMQ_LAST_ENDPOINT,
-        &bindEndPoint, &size);
-    this->myAddress = bindEndPoint;
 
     // ResponseReceiver socket listening in a random port.
     std::string id = this->responseReceiverId.ToString();
@@ -1430,6 +4045,7 @@ bool NodeShared::InitializeSockets()
     this->dataPtr->replier->setsockopt(ZMQ_ROUTER_MANDATORY,
         &RouteOn, sizeof(RouteOn));
     this->dataPtr->replier->bind(anyTcpEp.c_str());
+    size = sizeof(bindEndPoint);
     this->dataPtr->replier->getsockopt(ZMQ_LAST_ENDPOINT, &bindEndPoint, &size);
     this->myReplierAddress = bindEndPoint;
 
@@ -1438,18 +4054,58 @@ bool NodeShared::InitializeSockets()
     this->dataPtr->requester->setsockopt(ZMQ_ROUTER_MANDATORY, &RouteOn,
       sizeof(RouteOn));
 #endif
+
+    // Inproc pair used by the service threads to signal the responses.
+    this->dataPtr->InitWakeSockets();
+
+    // Optional IPC endpoints for the requesters in this host.
+    this->dataPtr->IpcInit(this->pUuid, true);
   }
   catch(const zmq::error_t& ze)
   {
     std::cerr << "InitializeSockets() Error: " << ze.what() << std::endl;
     std::cerr << "Gazebo Transport has not been correctly initialized"
               << std::endl;
+    this->dataPtr->srvSocketsFailed = true;
     return false;
   }
 
+  if (this->verbose)
+  {
+    std::cout << "Bind at: [" << this->myReplierAddress << "] for srv. calls\n";
+    std::cout << "Identity for receiving srv. requests: ["
+              << this->replierId.ToString() << "]" << std::endl;
+    std::cout << "Identity for receiving srv. responses: ["
+              << this->responseReceiverId.ToString() << "]" << std::endl;
+  }
+
+  // Start the reception thread.
+  this->dataPtr->srvSocketsReady = true;
+  this->StartReception();
+
   return true;
 }
 
+//////////////////////////////////////////////////
+void NodeSharedPrivate::InitWakeSockets()
+{
+  auto receiver = std::make_unique<zmq::socket_t>(*this->context, ZMQ_PAIR);
+  auto sender = std::make_unique<zmq::socket_t>(*this->context, ZMQ_PAIR);
+  receiver->bind("inproc://srv-replies");
+  sender->connect("inproc://srv-replies");
+
+  std::lock_guard<std::mutex> lk(this->wakeMutex);
+  this->srvWakeReceiver = std::move(receiver);
+  this->srvWakeSender = std::move(sender);
+}
+
+//////////////////////////////////////////////////
+void NodeShared::StartReception()
+{
+  if (!this->threadReception.joinable())
+    this->threadReception = std::thread(&NodeShared::RunReceptionTask, this);
+}
+
 /////////////////////////////////////////////////
 bool NodeShared::TopicPublishers(const std::string &_topic,
                                  SrvAddresses_M &_publishers) const
@@ -1472,6 +4128,9 @@ bool NodeShared::AdvertisePublisher(const ServicePublisher &_publisher)
 /////////////////////////////////////////////////
 int NodeShared::RcvHwm()
 {
+  if (!this->dataPtr->topicSocketsReady || this->dataPtr->backend)
+    return -1;
+
   int rcvHwm;
   try
   {
@@ -1493,6 +4152,9 @@ int NodeShared::RcvHwm()
 /////////////////////////////////////////////////
 int NodeShared::SndHwm()
 {
+  if (!this->dataPtr->topicSocketsReady || this->dataPtr->backend)
+    return -1;
+
   int sndHwm;
   try
   {
@@ -1534,374 +4196,3765 @@ bool NodeShared::HandlerWrapper::HasSubscriber(
 }
 
 //////////////////////////////////////////////////
-template <typename HandlerT>
-static void AppendNodeUuids(const HandlerStorage<HandlerT> &_handlerStorage,
-                            const std::string &_fullyQualifiedTopic,
-                            const std::string &_msgTypeName,
-                            std::vector<std::string> &_uuids)
+template <typename HandlerT>
+static void AppendNodeUuids(const HandlerStorage<HandlerT> &_handlerStorage,
+                            const std::string &_fullyQualifiedTopic,
+                            const std::string &_msgTypeName,
+                            std::vector<std::string> &_uuids)
+{
+  using HandlerTPtr = std::shared_ptr<HandlerT>;
+  std::map<std::string, std::map<std::string, HandlerTPtr>> handlers;
+
+  _handlerStorage.Handlers(_fullyQualifiedTopic, handlers);
+  for (const auto &collection : handlers)
+  {
+    for (const auto &collectionEntry : collection.second)
+    {
+      const HandlerTPtr &handler = collectionEntry.second;
+      const std::string &handlerMsgType = handler->TypeName();
+      if (handlerMsgType == _msgTypeName
+          || handlerMsgType == kGenericMessageType)
+      {
+        _uuids.push_back(handler->NodeUuid());
+      }
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+std::vector<std::string> NodeShared::HandlerWrapper::NodeUuids(
+    const std::string &_fullyQualifiedTopic,
+    const std::string &_msgTypeName) const
+{
+  std::vector<std::string> uuids;
+  AppendNodeUuids(this->normal, _fullyQualifiedTopic, _msgTypeName, uuids);
+  AppendNodeUuids(this->raw, _fullyQualifiedTopic, _msgTypeName, uuids);
+
+  return uuids;
+}
+
+//////////////////////////////////////////////////
+template <typename HandlerT>
+static void MaxMsgsPerSec(const HandlerStorage<HandlerT> &_handlerStorage,
+                          const std::string &_fullyQualifiedTopic,
+                          const std::string &_msgTypeName,
+                          const std::string &_nUuid,
+                          uint64_t &_msgsPerSec)
+{
+  auto entries = _handlerStorage.TopicHandlers(_fullyQualifiedTopic);
+  if (!entries)
+    return;
+
+  for (const auto &entry : *entries)
+  {
+    const std::string &handlerMsgType = entry.handler->TypeName();
+    if (entry.nUuid == _nUuid &&
+        (handlerMsgType == _msgTypeName ||
+         handlerMsgType == kGenericMessageType))
+    {
+      const uint64_t msgsPerSec = entry.handler->MsgsPerSec();
+      if (_msgsPerSec == 0 || msgsPerSec > _msgsPerSec)
+        _msgsPerSec = msgsPerSec;
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+uint64_t NodeShared::HandlerWrapper::MsgsPerSec(
+    const std::string &_fullyQualifiedTopic,
+    const std::string &_msgTypeName,
+    const std::string &_nUuid) const
+{
+  uint64_t msgsPerSec = 0;
+  MaxMsgsPerSec(this->normal, _fullyQualifiedTopic, _msgTypeName, _nUuid,
+    msgsPerSec);
+  MaxMsgsPerSec(this->raw, _fullyQualifiedTopic, _msgTypeName, _nUuid,
+    msgsPerSec);
+
+  return msgsPerSec == 0 ? kUnthrottled : msgsPerSec;
+}
+
+//////////////////////////////////////////////////
+bool NodeShared::HandlerWrapper::RemoveHandlersForNode(
+    const std::string &_fullyQualifiedTopic,
+    const std::string &_nUuid)
+{
+  bool removed = false;
+  removed |= this->normal.RemoveHandlersForNode(_fullyQualifiedTopic, _nUuid);
+  removed |= this->raw.RemoveHandlersForNode(_fullyQualifiedTopic, _nUuid);
+
+  return removed;
+}
+
+//////////////////////////////////////////////////
+std::vector<MessagePublisher> NodeShared::HandlerWrapper::Convert(
+    const std::string &_addr, const std::string &_pUuid)
+{
+  std::vector<MessagePublisher> res;
+
+  for (const auto &[topic, handlerCollection] : this->normal.AllHandlers())
+  {
+    for (const auto &[nUuid, handlerNode] : handlerCollection)
+    {
+      for (const auto &[hUuid, handler] : handlerNode)
+      {
+        res.push_back(MessagePublisher(topic, _addr, "", _pUuid, nUuid,
+          handler->TypeName(), AdvertiseMessageOptions()));
+      }
+    }
+  }
+
+  for (const auto &[topic, handlerCollection] : this->raw.AllHandlers())
+  {
+    for (const auto &[nUuid, handlerNode] : handlerCollection)
+    {
+      for (const auto &[hUuid, handler] : handlerNode)
+      {
+        res.push_back(MessagePublisher(topic, _addr, "", _pUuid, nUuid,
+          handler->TypeName(), AdvertiseMessageOptions()));
+      }
+    }
+  }
+
+  return res;
+}
+
+//////////////////////////////////////////////////
+void NodeSharedPrivate::SecurityOnNewConnection()
+{
+  // Set the credentials if the security is enabled.
+  // \todo(anyone): This will cause the subscriber to connect only to secure
+  // connections. Would be nice if the subscriber could still connect to
+  // unsecure connections. This might require an unsecure and secure
+  // subscriber.
+  // See issue #74
+  if (this->security.mechanism == SecurityOptions::Mechanism::NONE)
+    return;
+
+  for (std::size_t i = 0; i < this->subscriberConnections.size(); ++i)
+    this->security.ApplyClient(this->Subscriber(i));
+}
+
+//////////////////////////////////////////////////
+void NodeSharedPrivate::SecurityInit()
+{
+  if (this->security.mechanism == SecurityOptions::Mechanism::NONE)
+    return;
+
+  // Create the access control thread, only needed to check the
+  // credentials.
+  if (this->security.NeedsZap())
+  {
+    this->accessControlThread = std::thread(
+        &NodeSharedPrivate::AccessControlHandler, this);
+  }
+
+  this->security.ApplyServer(*this->publisher, kGzAuthDomain);
+}
+
+//////////////////////////////////////////////////
+/// \brief Receive a ZAP request without waiting.
+/// \param[in] _socket The ZAP socket.
+/// \param[out] _request The frames of the request. Its strings are reused
+/// from a request to the next.
+/// \return True if a request was received.
+static bool receiveZapRequest(zmq::socket_t &_socket,
+  std::vector<std::string> &_request)
+{
+  std::size_t count = 0;
+  zmq::message_t msg;
+  do
+  {
+#ifdef GZ_ZMQ_POST_4_3_1
+    if (!_socket.recv(msg, count == 0 ?
+          zmq::recv_flags::dontwait : zmq::recv_flags::none))
+#else
+    if (!_socket.recv(&msg, count == 0 ? ZMQ_DONTWAIT : 0))
+#endif
+    {
+      return false;
+    }
+
+    if (_request.size() <= count)
+      _request.emplace_back();
+    _request[count++].assign(msg.data<char>(), msg.size());
+  } while (msg.more());
+
+  _request.resize(count);
+  return true;
+}
+
+//////////////////////////////////////////////////
+// Access control handler for the ZAP requests, see SecurityOptions.
+// This function is designed to be run in a thread.
+void NodeSharedPrivate::AccessControlHandler()
+{
+  configureThread("access");
+
+  zmq::socket_t *sock = new zmq::socket_t(*this->context, ZMQ_REP);
+
+  try
+  {
+    // Bind to the zap address
+    sock->bind("inproc://zeromq.zap.01");
+
+    std::vector<std::string> request;
+    zmq::pollitem_t items[2] =
+    {
+      {static_cast<void*>(*sock), 0, ZMQ_POLLIN, 0},
+    };
+    std::size_t count = 1;
+    this->PollExitSocket(items, count);
+
+    // Process
+    while (!this->exit)
+    {
+      try
+      {
+        zmq::poll(&items[0], count,
+            std::chrono::milliseconds(NodeSharedPrivate::Timeout));
+      }
+      catch(...)
+      {
+        continue;
+      }
+
+      if (!(items[0].revents & ZMQ_POLLIN))
+        continue;
+
+      // Answer all the requests queued by a burst of connections before
+      // polling again. The credentials are checked against the cached
+      // options.
+      while (!this->exit && receiveZapRequest(*sock, request))
+      {
+        // The reply starts with the version and the request id.
+        request.resize(std::max<std::size_t>(request.size(), 2));
+#ifdef GZ_ZMQ_POST_4_3_1
+        sendHelper(*sock, request[0], zmq::send_flags::sndmore);
+        sendHelper(*sock, request[1], zmq::send_flags::sndmore);
+#else
+        sendHelper(*sock, request[0], ZMQ_SNDMORE);
+        sendHelper(*sock, request[1], ZMQ_SNDMORE);
+#endif
+
+        const std::string error =
+          this->security.Check(request, kGzAuthDomain);
+        if (!error.empty())
+        {
+          sendAuthErrorHelper(*sock, error);
+          continue;
+        }
+
+#ifdef GZ_ZMQ_POST_4_3_1
+        sendHelper(*sock, "200", zmq::send_flags::sndmore);
+        sendHelper(*sock, "OK", zmq::send_flags::sndmore);
+        sendHelper(*sock, "anonymous", zmq::send_flags::sndmore);
+        sendHelper(*sock, "", zmq::send_flags::none);
+#else
+        sendHelper(*sock, "200", ZMQ_SNDMORE);
+        sendHelper(*sock, "OK", ZMQ_SNDMORE);
+        sendHelper(*sock, "anonymous", ZMQ_SNDMORE);
+        sendHelper(*sock, "", 0);
+#endif
+      }
+    }
+  }
+  catch (...)
+  {
+    // This catch can be triggered when ctrl-c is pressed and the context is
+    // deleted. Capture this case, and quit gracefully.
+  }
+
+  sock->close();
+  delete sock;
+}
+
+/////////////////////////////////////////////////
+void NodeSharedPrivate::StartPublishThreads(const std::size_t _numThreads)
+{
+  for (std::size_t i = 0; i < _numThreads; ++i)
+    this->pubQueues.push_back(std::make_unique<PublishQueue>());
+
+  // Start the threads once all the queues have been created, so the vector
+  // is not modified anymore.
+  for (auto &pubQueue : this->pubQueues)
+  {
+    pubQueue->thread = std::thread(&NodeSharedPrivate::PublishThread,
+        this, std::ref(*pubQueue));
+  }
+}
+
+/////////////////////////////////////////////////
+void NodeSharedPrivate::StopPublishThreads()
+{
+  for (auto &pubQueue : this->pubQueues)
+  {
+    // Lock and release the mutex so that a thread checking the exit flag
+    // does not miss the notification.
+    {
+      std::lock_guard<std::mutex> queueLock(pubQueue->mutex);
+    }
+    pubQueue->signalNewPub.notify_all();
+    pubQueue->signalRoom.notify_all();
+  }
+
+  for (auto &pubQueue : this->pubQueues)
+  {
+    if (pubQueue->thread.joinable())
+      pubQueue->thread.join();
+  }
+}
+
+/////////////////////////////////////////////////
+NodeSharedPrivate::PublishQueue &NodeSharedPrivate::PubQueue(
+    const std::string &_topic)
+{
+  if (this->pubQueues.size() == 1)
+    return *this->pubQueues.front();
+
+  return *this->pubQueues[
+    std::hash<std::string>()(_topic) % this->pubQueues.size()];
+}
+
+/////////////////////////////////////////////////
+uint64_t NodeSharedPrivate::EnqueuePublication(
+    std::unique_ptr<PublishMsgDetails> _details)
+{
+  if (this->metrics)
+    _details->enqueued = std::chrono::steady_clock::now();
+
+  // The span publishing or receiving the message.
+  if (this->tracer)
+  {
+    _details->enqueued = std::chrono::steady_clock::now();
+    _details->trace = Tracer::Current();
+  }
+
+  // The callbacks bound to an executor are handed over to it directly.
+  this->PostToExecutors(*_details);
+  if (_details->localHandlers.empty() && _details->rawHandlers.empty())
+    return 0;
+
+  // With GZ_TRANSPORT_DISPATCH_THREADS=0 the callbacks run in the calling
+  // thread.
+  if (this->pubQueues.empty())
+  {
+    this->Dispatch(*_details);
+    return 0;
+  }
+
+  // Above the memory cap, the publication is dropped.
+  const int64_t size = static_cast<int64_t>(_details->msgSize);
+  if (this->DropForMemoryCap(_details->priority, _details->msgSize))
+  {
+    ReleaseQueueSlots(*_details);
+    return 0;
+  }
+
+  PublishQueue &pubQueue = this->PubQueue(_details->info.Topic());
+  this->publishQueueBytes.fetch_add(size, std::memory_order_relaxed);
+
+  // The depth is incremented first, so the thread never sees it negative.
+  if (this->metrics)
+    pubQueue.depth.fetch_add(1, std::memory_order_relaxed);
+
+  auto unqueue = [&]()
+  {
+    if (this->metrics)
+      pubQueue.depth.fetch_sub(1, std::memory_order_relaxed);
+    this->publishQueueBytes.fetch_sub(size, std::memory_order_relaxed);
+  };
+
+  auto &ring = pubQueue.Ring(_details->priority);
+  if (!ring.TryPush(_details))
+  {
+    // A callback running on the thread of this queue publishes onto it.
+    // Nobody else makes room, so the callbacks run right away.
+    if (tPublishQueue == &pubQueue)
+    {
+      unqueue();
+      this->Dispatch(*_details);
+      return 0;
+    }
+
+    // A stalled callback must not block the publishers sharing its queue,
+    // unless one of the handlers asked for it.
+    if (!WaitForRoom(*_details))
+    {
+      unqueue();
+      return DropQueueSlots(*_details);
+    }
+
+    // Wait for the publish thread to make room. The thread signals the
+    // waiting publishers after each message, the timeout only covers the
+    // exit.
+    pubQueue.waitingPublishers.fetch_add(1);
+    std::unique_lock<std::mutex> queueLock(pubQueue.mutex);
+    while (!ring.TryPush(_details))
+    {
+      if (this->exit)
+      {
+        queueLock.unlock();
+        pubQueue.waitingPublishers.fetch_sub(1);
+        unqueue();
+        ReleaseQueueSlots(*_details);
+        return 0;
+      }
+      pubQueue.signalRoom.wait_for(queueLock, 100ms);
+    }
+    queueLock.unlock();
+    pubQueue.waitingPublishers.fetch_sub(1);
+  }
+
+  // Only wake up the publish thread if it is sleeping. The fence pairs with
+  // the one in PublishThread(), either the thread sees the new message or we
+  // see it sleeping.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (pubQueue.sleeping.load(std::memory_order_relaxed))
+  {
+    {
+      std::lock_guard<std::mutex> queueLock(pubQueue.mutex);
+    }
+    pubQueue.signalNewPub.notify_one();
+  }
+  return 0;
+}
+
+/////////////////////////////////////////////////
+void NodeSharedPrivate::ReleaseQueueSlots(PublishMsgDetails &_details)
+{
+  for (std::size_t i = 0; i < _details.localHandlers.size(); ++i)
+    _details.localHandlers[i]->ReleaseQueueSlot(_details.localSeqs[i]);
+  for (std::size_t i = 0; i < _details.rawHandlers.size(); ++i)
+    _details.rawHandlers[i]->ReleaseQueueSlot(_details.rawSeqs[i]);
+}
+
+/////////////////////////////////////////////////
+uint64_t NodeSharedPrivate::DropQueueSlots(PublishMsgDetails &_details)
+{
+  for (std::size_t i = 0; i < _details.localHandlers.size(); ++i)
+    _details.localHandlers[i]->DropQueueSlot(_details.localSeqs[i]);
+  for (std::size_t i = 0; i < _details.rawHandlers.size(); ++i)
+    _details.rawHandlers[i]->DropQueueSlot(_details.rawSeqs[i]);
+  return _details.localHandlers.size() + _details.rawHandlers.size();
+}
+
+/////////////////////////////////////////////////
+bool NodeSharedPrivate::WaitForRoom(const PublishMsgDetails &_details)
+{
+  // The thread receiving the messages from other processes never waits.
+  if (!_details.info.IntraProcess())
+    return false;
+
+  for (const auto &handler : _details.localHandlers)
+  {
+    if (handler->BlocksPublisher())
+      return true;
+  }
+  for (const auto &handler : _details.rawHandlers)
+  {
+    if (handler->BlocksPublisher())
+      return true;
+  }
+  return false;
+}
+
+/////////////////////////////////////////////////
+void NodeSharedPrivate::PostToExecutors(PublishMsgDetails &_details)
+{
+  // The publication for the handlers bound to each executor. There is
+  // usually none, or a single executor.
+  std::vector<std::pair<std::shared_ptr<Executor>,
+    std::shared_ptr<PublishMsgDetails>>> posts;
+  auto detailsFor = [&](const std::shared_ptr<Executor> &_executor)
+    -> PublishMsgDetails &
+  {
+    for (auto &post : posts)
+    {
+      if (post.first == _executor)
+        return *post.second;
+    }
+
+    auto details = std::make_shared<PublishMsgDetails>();
+    details->sharedBuffer = _details.sharedBuffer;
+    details->msgCopy = _details.msgCopy;
+    details->parser = _details.parser;
+    details->msgSize = _details.msgSize;
+    details->info = _details.info;
+    details->enqueued = _details.enqueued;
+    details->trace = _details.trace;
+    details->priority = _details.priority;
+    details->lockstep = _details.lockstep;
+    posts.emplace_back(_executor, details);
+    return *details;
+  };
+
+  // Move the handlers bound to an executor, keeping the others in order.
+  std::size_t kept = 0;
+  for (std::size_t i = 0; i < _details.localHandlers.size(); ++i)
+  {
+    const auto &executor = _details.localHandlers[i]->CallbackExecutor();
+    if (!executor)
+    {
+      if (kept != i)
+      {
+        _details.localHandlers[kept] = std::move(_details.localHandlers[i]);
+        _details.localSeqs[kept] = _details.localSeqs[i];
+      }
+      ++kept;
+      continue;
+    }
+
+    PublishMsgDetails &details = detailsFor(executor);
+    details.localHandlers.push_back(std::move(_details.localHandlers[i]));
+    details.localSeqs.push_back(_details.localSeqs[i]);
+  }
+  _details.localHandlers.resize(kept);
+  _details.localSeqs.resize(kept);
+
+  kept = 0;
+  for (std::size_t i = 0; i < _details.rawHandlers.size(); ++i)
+  {
+    const auto &executor = _details.rawHandlers[i]->CallbackExecutor();
+    if (!executor)
+    {
+      if (kept != i)
+      {
+        _details.rawHandlers[kept] = std::move(_details.rawHandlers[i]);
+        _details.rawSeqs[kept] = _details.rawSeqs[i];
+      }
+      ++kept;
+      continue;
+    }
+
+    PublishMsgDetails &details = detailsFor(executor);
+    details.rawHandlers.push_back(std::move(_details.rawHandlers[i]));
+    details.rawSeqs.push_back(_details.rawSeqs[i]);
+  }
+  _details.rawHandlers.resize(kept);
+  _details.rawSeqs.resize(kept);
+
+  for (auto &post : posts)
+  {
+    post.first->Post([this, details = std::move(post.second)]()
+    {
+      this->Dispatch(*details);
+    });
+  }
+}
+
+/////////////////////////////////////////////////
+void NodeSharedPrivate::PublishThread(PublishQueue &_queue)
+{
+  configureThread("dispatch");
+  tPublishQueue = &_queue;
+
+  // Loop until exits
+  while (!this->exit)
+  {
+    std::unique_ptr<PublishMsgDetails> msgDetails = nullptr;
+
+    // Acquire the next message to be published, in order of priority.
+    if (!this->SpinPop(_queue, msgDetails))
+    {
+      _queue.sleeping.store(true, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+
+      // Check again, a message might have been pushed before the
+      // publisher could see that this thread is sleeping.
+      if (!_queue.TryPop(msgDetails))
+      {
+        // Wait for more messages.
+        std::unique_lock<std::mutex> queueLock(_queue.mutex);
+        _queue.signalNewPub.wait_for(queueLock, 500ms,
+          [&]{return !_queue.Empty() || this->exit;});
+        _queue.sleeping.store(false, std::memory_order_relaxed);
+        continue;
+      }
+
+      _queue.sleeping.store(false, std::memory_order_relaxed);
+    }
+
+    // Wake up the publishers waiting for room. The fence pairs with their
+    // increment of waitingPublishers before pushing again.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (_queue.waitingPublishers.load(std::memory_order_relaxed) > 0)
+    {
+      {
+        std::lock_guard<std::mutex> queueLock(_queue.mutex);
+      }
+      _queue.signalRoom.notify_all();
+    }
+
+    // Stop early on exit.
+    if (this->exit)
+    {
+      ReleaseQueueSlots(*msgDetails);
+      break;
+    }
+
+    if (this->metrics)
+      _queue.depth.fetch_sub(1, std::memory_order_relaxed);
+    this->publishQueueBytes.fetch_sub(
+      static_cast<int64_t>(msgDetails->msgSize), std::memory_order_relaxed);
+
+    this->Dispatch(*msgDetails);
+  }
+}
+
+/////////////////////////////////////////////////
+bool NodeSharedPrivate::SpinPop(PublishQueue &_queue,
+    std::unique_ptr<PublishMsgDetails> &_details)
+{
+  if (_queue.TryPop(_details))
+    return true;
+
+  if (this->busyPoll.count() == 0)
+    return false;
+
+  // The publishers don't notify this thread while it isn't sleeping.
+  const Timestamp spinUntil =
+    std::chrono::steady_clock::now() + this->busyPoll;
+  while (!this->exit && std::chrono::steady_clock::now() < spinUntil)
+  {
+    if (_queue.TryPop(_details))
+      return true;
+    std::this_thread::yield();
+  }
+  return false;
+}
+
+/////////////////////////////////////////////////
+void NodeSharedPrivate::Dispatch(PublishMsgDetails &_details)
+{
+  GZ_TRANSPORT_PROBE_SCOPE(dispatch, _details.info.Topic().c_str());
+
+  if (this->metrics)
+  {
+    this->metrics->AddDispatchLatency(
+      std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - _details.enqueued).count());
+  }
+
+  // Record the time spent in the queue.
+  const TraceContext &trace = _details.trace;
+  if (this->tracer && trace.traceId != 0)
+  {
+    const int64_t now = Tracer::Now();
+    const int64_t queued = std::chrono::duration_cast<
+      std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - _details.enqueued).count();
+    this->tracer->Record("queue", _details.info.Topic(), now - queued,
+      now, {trace.traceId, Tracer::NewId()}, trace.spanId);
+  }
+
+  // Deserialize a received message left to this thread.
+  if (_details.parser && !_details.localHandlers.empty())
+  {
+    TraceScope span(this->tracer.get(), "parse", _details.info.Topic(),
+      trace);
+    _details.msgCopy = _details.parser->CreateMsg(
+      _details.sharedBuffer.Data(), _details.msgSize, _details.info.Type());
+    _details.parser = nullptr;
+  }
+
+  // Send the message to all the local handlers.
+  for (std::size_t i = 0; i < _details.localHandlers.size(); ++i)
+  {
+    auto &handler = _details.localHandlers[i];
+
+    // Skip the messages dropped by a full handler queue, the handlers
+    // unsubscribed after the message was queued, and the messages that
+    // couldn't be deserialized.
+    if (!handler->ReleaseQueueSlot(_details.localSeqs[i]) ||
+        !handler->Enabled() || !_details.msgCopy)
+    {
+      continue;
+    }
+
+    try
+    {
+      TraceScope span(this->tracer.get(), "callback",
+        _details.info.Topic(), trace, Tracer::kFlowIn);
+      this->RunCallback(*handler, [&]()
+      {
+        handler->RunLocalCallback(_details.msgCopy, _details.info);
+      });
+    }
+    catch (...)
+    {
+      std::cerr << "Exception occurred in a local callback "
+        << "on topic [" << _details.info.Topic() << "] with message ["
+        << _details.msgCopy->DebugString() << "]" << std::endl;
+    }
+  }
+
+  // Send the message to all the raw handlers.
+  for (std::size_t i = 0; i < _details.rawHandlers.size(); ++i)
+  {
+    auto &handler = _details.rawHandlers[i];
+    if (!handler->ReleaseQueueSlot(_details.rawSeqs[i]) ||
+        !handler->Enabled())
+    {
+      continue;
+    }
+
+    try
+    {
+      TraceScope span(this->tracer.get(), "callback",
+        _details.info.Topic(), trace, Tracer::kFlowIn);
+      this->RunCallback(*handler, [&]()
+      {
+        handler->RunRawCallback(_details.sharedBuffer.Shared(),
+            _details.msgSize, _details.info);
+      });
+    }
+    catch (...)
+    {
+      std::cerr << "Exception occured in a local raw callback "
+        << "on topic [" << _details.info.Topic() << "]";
+      if (_details.msgCopy)
+      {
+        std::cerr << " with message [" << _details.msgCopy->DebugString()
+                  << "]";
+      }
+      std::cerr << std::endl;
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+std::optional<transport::TopicStatistics> NodeShared::TopicStats(
+    const std::string &_topic) const
+{
+  std::lock_guard<std::recursive_mutex> lk(this->mutex);
+  auto it = this->dataPtr->topicStats.find(_topic);
+  if (it == this->dataPtr->topicStats.end())
+    return std::nullopt;
+
+  NodeSharedPrivate::TopicStatsEntry &entry = *it->second;
+  entry.stats.AddQueueDrops(entry.queueDrops.exchange(0));
+  entry.stats.AddSlowSubscribers(entry.slowSubscribers.exchange(0));
+  return entry.stats;
+}
+
+//////////////////////////////////////////////////
+void NodeShared::AddQueueDrops(const std::string &_topic,
+    const uint64_t _count)
+{
+  if (this->dataPtr->metrics)
+  {
+    this->dataPtr->metrics->Add(_topic, TransportMetrics::QUEUE_DROPS,
+      _count);
+  }
+
+  // The publishers don't take NodeShared::mutex, held by the reception
+  // thread, the drops are merged into the statistics when they're read.
+  std::shared_lock<std::shared_mutex> lk(this->dataPtr->topicStatsMutex);
+  auto it = this->dataPtr->topicStats.find(_topic);
+  if (it == this->dataPtr->topicStats.end() || !it->second->callback)
+    return;
+
+  it->second->queueDrops.fetch_add(_count, std::memory_order_relaxed);
+}
+
+//////////////////////////////////////////////////
+void NodeShared::EnableStats(const std::string &_topic, bool _enable,
+    std::function<void(const TopicStatistics &_stats)> _statCb)
+{
+  std::lock_guard<std::recursive_mutex> lk(this->mutex);
+  std::unique_lock<std::shared_mutex> statsLk(
+    this->dataPtr->topicStatsMutex);
+
+  // The statistics are kept once disabled, see TopicStats().
+  auto &entry = this->dataPtr->topicStats[_topic];
+  if (!entry)
+  {
+    if (!_enable)
+      return;
+    entry = std::make_unique<NodeSharedPrivate::TopicStatsEntry>();
+  }
+
+  if (_enable)
+    entry->callback = _statCb;
+  else
+    entry->callback = nullptr;
+}
+
+//////////////////////////////////////////////////
+void NodeShared::EnableServiceStats(const std::string &_topic, bool _enable)
+{
+  std::lock_guard<std::mutex> lk(this->dataPtr->srvStatsMutex);
+  if (_enable)
+    this->dataPtr->enabledSrvStats.insert(_topic);
+  else
+    this->dataPtr->enabledSrvStats.erase(_topic);
+}
+
+//////////////////////////////////////////////////
+std::optional<ServiceStatistics> NodeShared::ServiceStats(
+    const std::string &_topic) const
+{
+  std::lock_guard<std::mutex> lk(this->dataPtr->srvStatsMutex);
+  if (!this->dataPtr->srvStatsAll &&
+      this->dataPtr->enabledSrvStats.find(_topic) ==
+        this->dataPtr->enabledSrvStats.end())
+  {
+    return std::nullopt;
+  }
+
+  auto it = this->dataPtr->srvStats.find(_topic);
+  if (it == this->dataPtr->srvStats.end())
+    return ServiceStatistics();
+  return it->second;
+}
+
+//////////////////////////////////////////////////
+void NodeShared::EnableCallbackStats(const bool _enable)
+{
+  this->dataPtr->callbackStats = _enable;
+}
+
+//////////////////////////////////////////////////
+std::vector<CallbackStatistics> NodeShared::CallbackStats(
+    const std::string &_nUuid) const
+{
+  std::vector<CallbackStatistics> stats;
+  if (!this->dataPtr->callbackStats)
+    return stats;
+
+  auto add = [&](const std::string &_topic,
+                 SubscriptionHandlerBase &_handler,
+                 const std::string &_msgType, const bool _raw)
+  {
+    CallbackStatistics entry;
+    entry.topic = _topic;
+    entry.msgType = _msgType;
+    entry.handlerUuid = _handler.HandlerUuid();
+    entry.raw = _raw;
+    entry.calls = _handler.CallbackCount();
+    entry.totalDuration = _handler.CallbackDuration();
+    entry.maxDuration = _handler.MaxCallbackDuration();
+    stats.push_back(std::move(entry));
+  };
+
+  std::lock_guard<std::recursive_mutex> lk(this->mutex);
+  for (const auto &topic : this->localSubscribers.normal.AllHandlers())
+  {
+    for (const auto &node : topic.second)
+    {
+      if (!_nUuid.empty() && node.first != _nUuid)
+        continue;
+      for (const auto &handler : node.second)
+        add(topic.first, *handler.second, handler.second->TypeName(), false);
+    }
+  }
+  for (const auto &topic : this->localSubscribers.raw.AllHandlers())
+  {
+    for (const auto &node : topic.second)
+    {
+      if (!_nUuid.empty() && node.first != _nUuid)
+        continue;
+      for (const auto &handler : node.second)
+        add(topic.first, *handler.second, handler.second->TypeName(), true);
+    }
+  }
+  return stats;
+}
+
+//////////////////////////////////////////////////
+std::string NodeShared::MetricsText() const
+{
+  if (!this->dataPtr->metrics)
+    return "";
+
+  this->dataPtr->SampleMetrics(*this);
+  return this->dataPtr->metrics->PrometheusText();
+}
+
+//////////////////////////////////////////////////
+MemoryStatistics NodeShared::MemoryStats() const
+{
+  // The counters can be transiently negative, a release being accounted
+  // before the matching allocation.
+  auto bytes = [](const int64_t _value)
+  {
+    return static_cast<uint64_t>(std::max<int64_t>(_value, 0));
+  };
+
+  MemoryStatistics stats;
+  stats.publishQueueBytes = bytes(this->dataPtr->publishQueueBytes.load(
+    std::memory_order_relaxed));
+  stats.zmqSendBytes = bytes(this->dataPtr->zmqSendBytes->load(
+    std::memory_order_relaxed));
+  stats.externalBytes = bytes(this->dataPtr->externalBytes.load(
+    std::memory_order_relaxed));
+
+  {
+    std::lock_guard<std::mutex> lk(this->dataPtr->srvMutex);
+    for (const auto &srvQueue : this->dataPtr->srvQueues)
+    {
+      for (const auto &request : srvQueue.second.pending)
+      {
+        stats.serviceQueueBytes += sizeof(request) + request.topic.size() +
+          request.sender.size() + request.dstId.size() +
+          request.nodeUuid.size() + request.reqUuid.size() +
+          request.req.size();
+      }
+    }
+  }
+
+  auto historyBytes =
+    [](const std::unordered_map<std::string,
+         NodeSharedPrivate::TopicHistory> &_histories)
+  {
+    uint64_t total = 0;
+    for (const auto &history : _histories)
+    {
+      for (const auto &entry : history.second.entries)
+        total += sizeof(entry) + entry.msgType.size() + entry.data.size();
+    }
+    return total;
+  };
+  {
+    std::lock_guard<std::mutex> lk(this->dataPtr->publisherMutex);
+    stats.historyBytes += historyBytes(this->dataPtr->histories);
+  }
+  {
+    std::lock_guard<std::mutex> lk(this->dataPtr->latchedMutex);
+    stats.historyBytes += historyBytes(this->dataPtr->latched);
+  }
+
+  stats.discoveryBytes = this->dataPtr->msgDiscovery->MemoryUsage() +
+    this->dataPtr->srvDiscovery->MemoryUsage();
+
+  stats.totalBytes = stats.publishQueueBytes + stats.zmqSendBytes +
+    stats.serviceQueueBytes + stats.historyBytes + stats.discoveryBytes +
+    stats.externalBytes;
+  stats.capBytes = this->MemoryCap();
+  stats.capDroppedMessages = this->dataPtr->memoryCapDrops.load(
+    std::memory_order_relaxed);
+  return stats;
+}
+
+//////////////////////////////////////////////////
+void NodeShared::SetMemoryCap(const uint64_t _bytes)
+{
+  this->dataPtr->memoryCap.store(_bytes, std::memory_order_relaxed);
+}
+
+//////////////////////////////////////////////////
+uint64_t NodeShared::MemoryCap() const
+{
+  return this->dataPtr->memoryCap.load(std::memory_order_relaxed);
+}
+
+//////////////////////////////////////////////////
+bool NodeShared::MemoryCapExceeded(const uint64_t _extra) const
+{
+  return this->dataPtr->MemoryCapExceeded(_extra);
+}
+
+//////////////////////////////////////////////////
+void NodeShared::AddExternalMemory(const int64_t _bytes)
+{
+  this->dataPtr->externalBytes.fetch_add(_bytes, std::memory_order_relaxed);
+}
+
+//////////////////////////////////////////////////
+uint64_t NodeShared::AddTap(const std::string &_topic,
+    const std::string &_hUuid, const SharedRawCallback &_callback)
+{
+  std::lock_guard<std::mutex> lk(this->dataPtr->tapMutex);
+  NodeSharedPrivate::TapList &list = this->dataPtr->taps[_topic];
+  auto taps = list ? std::make_shared<std::vector<NodeSharedPrivate::Tap>>(
+    *list) : std::make_shared<std::vector<NodeSharedPrivate::Tap>>();
+  if (!list)
+    ++this->dataPtr->tappedTopics;
+
+  NodeSharedPrivate::Tap tap;
+  tap.id = ++this->dataPtr->tapId;
+  tap.hUuid = _hUuid;
+  tap.callback = _callback;
+  taps->push_back(std::move(tap));
+  list = std::move(taps);
+  return this->dataPtr->tapId;
+}
+
+//////////////////////////////////////////////////
+bool NodeShared::RemoveTap(const uint64_t _id)
+{
+  std::lock_guard<std::mutex> lk(this->dataPtr->tapMutex);
+  for (auto it = this->dataPtr->taps.begin();
+       it != this->dataPtr->taps.end(); ++it)
+  {
+    const std::vector<NodeSharedPrivate::Tap> &list = *it->second;
+    auto tap = std::find_if(list.begin(), list.end(),
+      [_id](const NodeSharedPrivate::Tap &_tap)
+      {
+        return _tap.id == _id;
+      });
+    if (tap == list.end())
+      continue;
+
+    if (list.size() == 1)
+    {
+      this->dataPtr->taps.erase(it);
+      --this->dataPtr->tappedTopics;
+      return true;
+    }
+
+    auto taps = std::make_shared<std::vector<NodeSharedPrivate::Tap>>(list);
+    taps->erase(taps->begin() + (tap - list.begin()));
+    it->second = std::move(taps);
+    return true;
+  }
+  return false;
+}
+
+//////////////////////////////////////////////////
+NodeSharedPrivate::TapList NodeSharedPrivate::Taps(
+  const std::string &_topic) const
+{
+  if (this->tappedTopics == 0)
+    return nullptr;
+
+  std::lock_guard<std::mutex> lk(this->tapMutex);
+  auto it = this->taps.find(_topic);
+  return it == this->taps.end() ? nullptr : it->second;
+}
+
+//////////////////////////////////////////////////
+bool NodeSharedPrivate::Tapped(const std::vector<Tap> &_taps,
+    const std::string &_hUuid)
+{
+  return std::any_of(_taps.begin(), _taps.end(), [&_hUuid](const Tap &_tap)
+    {
+      return !_tap.hUuid.empty() && _tap.hUuid == _hUuid;
+    });
+}
+
+//////////////////////////////////////////////////
+void NodeSharedPrivate::Untap(const std::vector<Tap> &_taps,
+    NodeShared::MatchingHandlerInfo &_subscribers)
+{
+  if (!_subscribers.rawHandlers)
+    return;
+
+  auto handlers = std::make_shared<std::vector<RawSubscriptionHandlerPtr>>();
+  for (const RawSubscriptionHandlerPtr &handler : *_subscribers.rawHandlers)
+  {
+    if (!Tapped(_taps, handler->HandlerUuid()))
+      handlers->push_back(handler);
+  }
+
+  if (handlers->empty())
+    _subscribers.rawHandlers = nullptr;
+  else if (handlers->size() < _subscribers.rawHandlers->size())
+    _subscribers.rawHandlers = std::move(handlers);
+}
+
+//////////////////////////////////////////////////
+void NodeSharedPrivate::RunTaps(const std::vector<Tap> &_taps,
+    const std::shared_ptr<const char> &_data, const std::size_t _size,
+    const MessageInfo &_info)
+{
+  for (const Tap &tap : _taps)
+  {
+    try
+    {
+      tap.callback(_data, _size, _info);
+    }
+    catch (...)
+    {
+      std::cerr << "Exception occurred in a tap on topic [" << _info.Topic()
+                << "]" << std::endl;
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+void NodeSharedPrivate::ReleaseZmqMessage(void *_data, void *_hint)
+{
+  std::unique_ptr<ZmqRelease> release(static_cast<ZmqRelease *>(_hint));
+  release->bytes->fetch_sub(static_cast<int64_t>(release->size),
+    std::memory_order_relaxed);
+  if (release->ffn)
+    release->ffn(_data, release->hint);
+}
+
+//////////////////////////////////////////////////
+bool NodeSharedPrivate::MemoryCapExceeded(const uint64_t _extra) const
+{
+  const uint64_t cap = this->memoryCap.load(std::memory_order_relaxed);
+  if (cap == 0)
+    return false;
+
+  // Only the memory growing with the rate of the messages is capped, the
+  // rest is bounded by the configuration.
+  const int64_t held =
+    this->publishQueueBytes.load(std::memory_order_relaxed) +
+    this->zmqSendBytes->load(std::memory_order_relaxed) +
+    this->externalBytes.load(std::memory_order_relaxed);
+  return static_cast<uint64_t>(std::max<int64_t>(held, 0)) + _extra > cap;
+}
+
+//////////////////////////////////////////////////
+bool NodeSharedPrivate::DropForMemoryCap(const Priority_t _priority,
+    const std::size_t _size)
+{
+  if (_priority == Priority_t::CONTROL || !this->MemoryCapExceeded(_size))
+    return false;
+
+  this->memoryCapDrops.fetch_add(1, std::memory_order_relaxed);
+  return true;
+}
+
+//////////////////////////////////////////////////
+void NodeSharedPrivate::SampleMetrics(const NodeShared &_shared)
+{
+  // The publish queues are created with the sockets of the topics.
+  int64_t pubDepth = 0;
+  if (this->topicSocketsReady)
+  {
+    for (const auto &pubQueue : this->pubQueues)
+      pubDepth += pubQueue->depth.load(std::memory_order_relaxed);
+  }
+  this->metrics->SetSample("publish_queue_depth",
+    static_cast<double>(std::max<int64_t>(pubDepth, 0)));
+
+  std::size_t srvDepth = 0;
+  {
+    std::lock_guard<std::mutex> lk(this->srvMutex);
+    for (const auto &srvQueue : this->srvQueues)
+      srvDepth += srvQueue.second.pending.size();
+  }
+  this->metrics->SetSample("service_queue_depth",
+    static_cast<double>(srvDepth));
+
+  const std::pair<std::string, DiscoveryTraffic> discoveries[] =
+  {
+    {"msg_discovery_", this->msgDiscovery->Traffic()},
+    {"srv_discovery_", this->srvDiscovery->Traffic()}
+  };
+  for (const auto &discovery : discoveries)
+  {
+    const DiscoveryTraffic &traffic = discovery.second;
+    this->metrics->SetSample(discovery.first + "sent_datagrams_total",
+      static_cast<double>(traffic.sentDatagrams));
+    this->metrics->SetSample(discovery.first + "sent_bytes_total",
+      static_cast<double>(traffic.sentBytes));
+    this->metrics->SetSample(discovery.first + "received_datagrams_total",
+      static_cast<double>(traffic.receivedDatagrams));
+    this->metrics->SetSample(discovery.first + "received_bytes_total",
+      static_cast<double>(traffic.receivedBytes));
+  }
+
+  const MemoryStatistics memory = _shared.MemoryStats();
+  const std::pair<std::string, uint64_t> memorySamples[] =
+  {
+    {"memory_publish_queue_bytes", memory.publishQueueBytes},
+    {"memory_zmq_send_bytes", memory.zmqSendBytes},
+    {"memory_service_queue_bytes", memory.serviceQueueBytes},
+    {"memory_history_bytes", memory.historyBytes},
+    {"memory_discovery_bytes", memory.discoveryBytes},
+    {"memory_external_bytes", memory.externalBytes},
+    {"memory_total_bytes", memory.totalBytes},
+    {"memory_cap_bytes", memory.capBytes},
+    {"memory_cap_dropped_messages_total", memory.capDroppedMessages}
+  };
+  for (const auto &sample : memorySamples)
+    this->metrics->SetSample(sample.first, static_cast<double>(sample.second));
+
+  // Empty if the accounting is disabled.
+  this->metrics->SetCallbackStats(_shared.CallbackStats(""));
+
+  // The latencies measured by the topic statistics, aggregated with those
+  // of the other processes by StatsAggregator.
+  std::vector<std::string> statsTopics;
+  {
+    std::shared_lock<std::shared_mutex> lk(this->topicStatsMutex);
+    for (const auto &entry : this->topicStats)
+    {
+      if (entry.second->callback)
+        statsTopics.push_back(entry.first);
+    }
+  }
+  for (const std::string &topic : statsTopics)
+  {
+    auto stats = _shared.TopicStats(topic);
+    if (stats)
+      this->metrics->SetTopicStats(topic, *stats);
+  }
+}
+
+//////////////////////////////////////////////////
+void NodeSharedPrivate::MetricsThread()
+{
+  configureThread("metrics");
+
+  // The node is created once the NodeShared instance is constructed, it
+  // can't be created by the constructor.
+  std::unique_ptr<Node> node;
+  Node::Publisher pub;
+
+  std::unique_lock<std::mutex> lk(this->metricsMutex);
+  while (!this->exit)
+  {
+    this->metricsCondition.wait_for(lk,
+      std::chrono::milliseconds(this->metricsPeriod),
+      [this]{return this->exit.load();});
+    if (this->exit)
+      break;
+
+    lk.unlock();
+    this->SampleMetrics(*NodeShared::Instance());
+
+    if (!node)
+    {
+      node = std::make_unique<Node>();
+      pub = node->Advertise<msgs::Metric>(kMetricsTopic);
+    }
+
+    msgs::Metric msg;
+    this->metrics->FillMessage(msg);
+    pub.Publish(msg);
+
+    // The file is replaced atomically, e.g.: for the textfile collector of
+    // the Prometheus node exporter.
+    if (!this->metricsFile.empty())
+    {
+      const std::string tmpFile = this->metricsFile + ".tmp";
+      {
+        std::ofstream out(tmpFile, std::ios::trunc);
+        out << this->metrics->PrometheusText();
+      }
+      if (std::rename(tmpFile.c_str(), this->metricsFile.c_str()) != 0)
+      {
+        std::cerr << "Unable to write the metrics to ["
+                  << this->metricsFile << "]" << std::endl;
+      }
+    }
+    lk.lock();
+  }
+}
+
+//////////////////////////////////////////////////
+std::shared_ptr<NodeSharedPrivate::SlowSubscriberWatch>
+NodeSharedPrivate::WatchSlowSubscribers(const std::string &_addr,
+    const std::string &_topic)
+{
+  auto watch = std::make_shared<SlowSubscriberWatch>();
+  watch->topic = _topic;
+
+  std::lock_guard<std::mutex> lk(this->slowSubscriberMutex);
+  auto slowIt = this->slowConnections.find(_addr);
+  if (slowIt != this->slowConnections.end())
+    watch->slow = slowIt->second;
+
+  // Forget the watches released by their publishers.
+  auto range = this->slowWatches.equal_range(_addr);
+  for (auto it = range.first; it != range.second;)
+  {
+    if (it->second.expired())
+      it = this->slowWatches.erase(it);
+    else
+      ++it;
+  }
+  this->slowWatches.emplace(_addr, watch);
+  return watch;
+}
+
+//////////////////////////////////////////////////
+void NodeSharedPrivate::MonitorPublisher(zmq::socket_t &_publisher,
+    const std::string &_addr)
+{
+  if (this->slowSubscriberThreshold == 0)
+    return;
+
+  std::lock_guard<std::mutex> lk(this->slowSubscriberMutex);
+  const std::string endpoint =
+    "inproc://gz-transport-monitor-" + std::to_string(this->monitorCount);
+  if (zmq_socket_monitor(static_cast<void *>(_publisher), endpoint.c_str(),
+        ZMQ_EVENT_ACCEPTED | ZMQ_EVENT_DISCONNECTED | ZMQ_EVENT_CLOSED) != 0)
+  {
+    std::cerr << "Unable to monitor the publisher socket [" << _addr
+              << "]: " << zmq_strerror(zmq_errno()) << std::endl;
+    return;
+  }
+
+  try
+  {
+    zmq::socket_t monitor(*this->context, ZMQ_PAIR);
+    int lingerVal = 0;
+#ifdef GZ_CPPZMQ_POST_4_7_0
+    monitor.set(zmq::sockopt::linger, lingerVal);
+#else
+    monitor.setsockopt(ZMQ_LINGER, &lingerVal, sizeof(lingerVal));
+#endif
+    monitor.connect(endpoint.c_str());
+    this->pendingMonitors.emplace_back(_addr, std::move(monitor));
+    this->monitoredPublishers.push_back(&_publisher);
+    ++this->monitorCount;
+  }
+  catch(const zmq::error_t &_error)
+  {
+    std::cerr << "Unable to monitor the publisher socket [" << _addr
+              << "]: " << _error.what() << std::endl;
+    zmq_socket_monitor(static_cast<void *>(_publisher), nullptr, 0);
+  }
+}
+
+//////////////////////////////////////////////////
+void NodeSharedPrivate::NotifySlowSubscribers(
+    const std::vector<SendQueueMonitor::Event> &_events)
+{
+  for (const SendQueueMonitor::Event &event : _events)
+  {
+    std::vector<std::shared_ptr<SlowSubscriberWatch>> watches;
+    {
+      std::lock_guard<std::mutex> lk(this->slowSubscriberMutex);
+      uint32_t &slow = this->slowConnections[event.socket];
+      if (event.slow)
+        ++slow;
+      else if (slow > 0)
+        --slow;
+
+      auto range = this->slowWatches.equal_range(event.socket);
+      for (auto it = range.first; it != range.second;)
+      {
+        if (auto watch = it->second.lock())
+        {
+          watch->slow = slow;
+          watches.push_back(std::move(watch));
+          ++it;
+        }
+        else
+        {
+          it = this->slowWatches.erase(it);
+        }
+      }
+    }
+
+    // A topic with several publishers counts a slow subscriber once.
+    if (event.slow)
+    {
+      std::set<std::string> topics;
+      for (const auto &watch : watches)
+        topics.insert(watch->topic);
+
+      std::shared_lock<std::shared_mutex> lk(this->topicStatsMutex);
+      for (const std::string &topic : topics)
+      {
+        auto it = this->topicStats.find(topic);
+        if (it != this->topicStats.end() && it->second->callback)
+          it->second->slowSubscribers.fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+
+    for (const auto &watch : watches)
+    {
+      std::lock_guard<std::mutex> lk(watch->mutex);
+      if (watch->callback)
+        watch->callback(event.peer, event.slow, event.backlog);
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+void NodeSharedPrivate::SlowSubscriberThread()
+{
+  configureThread("monitor");
+
+  SendQueueMonitor monitor(this->slowSubscriberThreshold);
+  std::vector<std::pair<std::string, zmq::socket_t>> monitors;
+  std::vector<zmq::pollitem_t> items;
+  std::vector<SendQueueMonitor::Event> events;
+  Timestamp nextCheck =
+    std::chrono::steady_clock::now() + kSlowSubscriberPeriod;
+
+  while (!this->exit)
+  {
+    {
+      std::lock_guard<std::mutex> lk(this->slowSubscriberMutex);
+      for (auto &pending : this->pendingMonitors)
+        monitors.push_back(std::move(pending));
+      this->pendingMonitors.clear();
+    }
+
+    items.clear();
+    for (auto &entry : monitors)
+      items.push_back({static_cast<void *>(entry.second), 0, ZMQ_POLLIN, 0});
+    std::size_t count = items.size();
+    items.resize(count + 1);
+    this->PollExitSocket(items.data(), count);
+
+    const auto timeout = std::max(std::chrono::milliseconds(0),
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+        nextCheck - std::chrono::steady_clock::now()));
+    try
+    {
+      zmq::poll(items.data(), count, timeout);
+    }
+    catch(const zmq::error_t &)
+    {
+      continue;
+    }
+    if (this->exit)
+      break;
+
+    // Each event is a frame with its number and the file descriptor of the
+    // connection, followed by a frame with the endpoint.
+    for (std::size_t i = 0; i < monitors.size(); ++i)
+    {
+      if (!(items[i].revents & ZMQ_POLLIN))
+        continue;
+
+      zmq::socket_t &socket = monitors[i].second;
+      zmq::message_t eventMsg;
+      zmq::message_t endpointMsg;
+      try
+      {
+#ifdef GZ_ZMQ_POST_4_3_1
+        while (socket.recv(eventMsg, zmq::recv_flags::dontwait) &&
+               socket.recv(endpointMsg))
+#else
+        while (socket.recv(&eventMsg, ZMQ_DONTWAIT) &&
+               socket.recv(&endpointMsg, 0))
+#endif
+        {
+          if (eventMsg.size() < sizeof(uint16_t) + sizeof(uint32_t))
+            continue;
+
+          uint16_t eventId;
+          uint32_t fd;
+          const char *data = static_cast<const char *>(eventMsg.data());
+          std::memcpy(&eventId, data, sizeof(eventId));
+          std::memcpy(&fd, data + sizeof(eventId), sizeof(fd));
+
+          if (eventId == ZMQ_EVENT_ACCEPTED)
+          {
+            std::string peer = SendQueueMonitor::PeerAddress(fd);
+            if (peer.empty())
+            {
+              peer.assign(static_cast<const char *>(endpointMsg.data()),
+                endpointMsg.size());
+            }
+            monitor.Add(static_cast<int>(fd), monitors[i].first, peer);
+          }
+          else if (eventId == ZMQ_EVENT_DISCONNECTED ||
+                   eventId == ZMQ_EVENT_CLOSED)
+          {
+            monitor.Remove(static_cast<int>(fd), events);
+          }
+        }
+      }
+      catch(const zmq::error_t &_error)
+      {
+        std::cerr << "SlowSubscriberThread() error: " << _error.what()
+                  << std::endl;
+      }
+    }
+
+    if (std::chrono::steady_clock::now() >= nextCheck)
+    {
+      monitor.Check(events);
+      nextCheck = std::chrono::steady_clock::now() + kSlowSubscriberPeriod;
+    }
+
+    if (!events.empty())
+    {
+      this->NotifySlowSubscribers(events);
+      events.clear();
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+bool NodeSharedPrivate::RecvMsg(const std::size_t _shard,
+    std::string &_topic, std::string &_msgType,
+    SerializedBuffer &_data, uint32_t &_flags,
+    std::vector<TraceContext> &_traces, ReliableSeq &_reliable,
+    ReceivedFragment &_fragment)
+{
+  zmq::socket_t &socket = this->Subscriber(_shard);
+  zmq::message_t msg(0);
+  std::string sender;
+
+  try
+  {
+#ifdef GZ_ZMQ_POST_4_3_1
+    if (!socket.recv(msg))
+#else
+    if (!socket.recv(&msg, 0))
+#endif
+      return false;
+    // The topic is followed by a terminator, see TopicFrame().
+    const char *topicData = static_cast<const char *>(msg.data());
+    std::size_t topicSize = msg.size();
+    const bool terminated = topicSize > 0 && topicData[topicSize - 1] == '\0';
+    if (terminated)
+      --topicSize;
+    _topic.assign(topicData, topicSize);
+
+    // The subscriptions are prefixes, a socket also receives the topics of
+    // other shards starting with one of its topics.
+    if (this->SubscriberShard(_topic) != _shard)
+    {
+      this->DiscardFrames(socket, msg);
+      return false;
+    }
+
+    // Only the publishers of the previous wire protocol don't terminate the
+    // topic.
+    if (!terminated)
+    {
+      _flags = 0;
+      return this->RecvLegacyMsg(socket, msg, _topic, _msgType, _data);
+    }
+
+#ifdef GZ_ZMQ_POST_4_3_1
+    if (!socket.recv(msg))
+#else
+    if (!socket.recv(&msg, 0))
+#endif
+      return false;
+
+    PublicationHeader header;
+    if (msg.size() >= PublicationHeader::kSize)
+      header.Parse(static_cast<const char *>(msg.data()));
+    if (msg.size() < PublicationHeader::kSize ||
+        msg.size() != PublicationHeader::kSize +
+          uint64_t{header.typeSize} + header.senderSize)
+    {
+      std::cerr << "Invalid header received on topic [" << _topic << "]"
+                << std::endl;
+      this->DiscardFrames(socket, msg);
+      return false;
+    }
+
+    const char *strings =
+      static_cast<const char *>(msg.data()) + PublicationHeader::kSize;
+    _msgType.assign(strings, header.typeSize);
+    sender.assign(strings + header.typeSize, header.senderSize);
+    if (!this->ResolveHeader(_topic, header, sender, _msgType))
+    {
+      std::cerr << "Unknown publisher or type on topic [" << _topic << "]"
+                << std::endl;
+      this->DiscardFrames(socket, msg);
+      return false;
+    }
+    _flags = header.flags;
+
+    // A fragment of a large message, see PublishFragments().
+    if (header.flags & kHeaderFragment)
+    {
+#ifdef GZ_ZMQ_POST_4_3_1
+      if (!socket.recv(msg))
+#else
+      if (!socket.recv(&msg, 0))
+#endif
+        return false;
+
+      if (msg.size() != sizeof(_fragment.header))
+      {
+        std::cerr << "Invalid fragment received on topic [" << _topic << "]"
+                  << std::endl;
+        this->DiscardFrames(socket, msg);
+        return false;
+      }
+      std::memcpy(&_fragment.header, msg.data(), sizeof(_fragment.header));
+      _fragment.sender = header.sender;
+    }
+
+#ifdef GZ_ZMQ_POST_4_3_1
+    if (!socket.recv(msg))
+#else
+    if (!socket.recv(&msg, 0))
+#endif
+      return false;
+
+    // Keep the received frame instead of copying it, the callbacks read
+    // the message straight from the ZMQ buffer.
+    _data = SerializedBuffer::Adopt(std::move(msg));
+
+    // The publishers connected through shared memory send a descriptor of
+    // the message instead of the message.
+    bool shmValid = true;
+    auto shmIt = this->shmConnections.find(sender);
+    if (shmIt != this->shmConnections.end())
+    {
+      ShmSlotDescriptor desc;
+      shmValid = _data.Size() == sizeof(desc);
+      if (shmValid)
+        std::memcpy(&desc, _data.Data(), sizeof(desc));
+
+      if (shmValid && desc.seq == 0)
+      {
+        // The message was too big or too small, it follows the descriptor.
+#ifdef GZ_ZMQ_POST_4_3_1
+        if (!socket.recv(msg))
+#else
+        if (!socket.recv(&msg, 0))
+#endif
+          return false;
+        _data = SerializedBuffer::Adopt(std::move(msg));
+      }
+      else if (shmValid)
+      {
+        // The message is dropped if the publisher has already reused its
+        // slot. The rest of the message still has to be received.
+        std::string shmData;
+        shmValid = shmIt->second->Read(desc, shmData);
+        _data = SerializedBuffer::Adopt(std::move(shmData));
+      }
+    }
+
+    // The reliable publishers always send the metadata, with the last
+    // fragment of a large message.
+    const bool lastFragment = (header.flags & kHeaderFragment) == 0 ||
+      _fragment.header.offset + _data.Size() == _fragment.header.size;
+    if ((this->topicStatsEnabled || (header.flags & kHeaderReliable)) &&
+        lastFragment)
+    {
+#ifdef GZ_ZMQ_POST_4_3_1
+      if (!socket.recv(msg))
+#else
+      if (!socket.recv(&msg, 0))
+#endif
+        return false;
+
+      // Update topic statistics. A message dropped from shared memory is
+      // reported as a gap in the sequence numbers. A batch carries the
+      // metadata of each one of its messages.
+      auto statsIt = shmValid ?
+        this->topicStats.find(_topic) : this->topicStats.end();
+      TopicStatsEntry *entry =
+        statsIt != this->topicStats.end() && statsIt->second->callback ?
+        statsIt->second.get() : nullptr;
+      const char *metaData = static_cast<const char *>(msg.data());
+      const std::size_t metaCount = msg.size() / sizeof(PublicationMetadata);
+      for (std::size_t i = 0; (entry || this->tracer) && i < metaCount; ++i)
+      {
+        PublicationMetadata meta;
+        std::memcpy(&meta, metaData + i * sizeof(meta), sizeof(meta));
+        if (entry)
+          entry->stats.Update(header.sender, meta.stamp, meta.seq);
+        if (this->tracer && meta.traceId != 0)
+          _traces.resize(metaCount);
+        if (!_traces.empty())
+          _traces[i] = {meta.traceId, meta.spanId};
+      }
+
+      if (entry)
+      {
+        entry->stats.AddQueueDrops(entry->queueDrops.exchange(0));
+        entry->stats.AddSlowSubscribers(entry->slowSubscribers.exchange(0));
+        entry->callback(entry->stats);
+      }
+
+      // The reliable messages are never batched. A sequence number lower
+      // than expected means that the publisher has restarted. A message
+      // dropped from shared memory is reported with the next one.
+      if ((header.flags & kHeaderReliable) && shmValid && metaCount == 1)
+      {
+        PublicationMetadata meta;
+        std::memcpy(&meta, metaData, sizeof(meta));
+        uint64_t &next = this->reliableSeqs[_topic][header.sender];
+        _reliable.sender = header.sender;
+        _reliable.seq = meta.seq;
+        _reliable.gap = next > 0 && meta.seq > next ? meta.seq - next : 0;
+        next = meta.seq + 1;
+      }
+    }
+
+    if (!shmValid)
+      return false;
+  }
+  catch(const zmq::error_t &_error)
+  {
+    std::cerr << "Error: " << _error.what() << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool NodeSharedPrivate::Reassemble(const std::string &_topic,
+    const ReceivedFragment &_fragment, const SerializedBuffer &_data,
+    SerializedBuffer &_msg)
+{
+  const FragmentHeader &header = _fragment.header;
+  if (header.offset > header.size ||
+      _data.Size() > header.size - header.offset)
+  {
+    std::cerr << "Invalid fragment received on topic [" << _topic << "]"
+              << std::endl;
+    return false;
+  }
+
+  if (header.size > this->maxMsgSize)
+  {
+    std::cerr << "Discarding a message of " << header.size << " bytes "
+              << "received on topic [" << _topic << "]: it is larger than "
+              << "the maximum size of " << this->maxMsgSize << " bytes (see "
+              << "GZ_TRANSPORT_MAX_MSG_SIZE)" << std::endl;
+    return false;
+  }
+
+  const auto key = std::make_tuple(_topic, _fragment.sender, header.id);
+  auto it = this->partialMsgs.find(key);
+  if (header.offset == 0)
+  {
+    // Only keep the newest messages of the publisher, the oldest ones have
+    // probably lost a fragment.
+    auto first = this->partialMsgs.lower_bound(
+      std::make_tuple(_topic, _fragment.sender, uint64_t{0}));
+    std::size_t count = 0;
+    for (auto pIt = first; pIt != this->partialMsgs.end() &&
+         std::get<0>(pIt->first) == _topic &&
+         std::get<1>(pIt->first) == _fragment.sender; ++pIt)
+    {
+      ++count;
+    }
+    if (count >= kMaxPartialMsgs)
+      this->partialMsgs.erase(first);
+
+    // The first fragment has the size of all of them but the last one, so
+    // the message is only allocated if the count matches.
+    const uint64_t fragmentSize = _data.Size();
+    if (fragmentSize == 0 || header.count < 2 ||
+        header.count != (header.size + fragmentSize - 1) / fragmentSize)
+    {
+      std::cerr << "Invalid fragment received on topic [" << _topic << "]"
+                << std::endl;
+      return false;
+    }
+
+    PartialMsg partial;
+    try
+    {
+      partial.data = SerializedBuffer(header.size);
+    }
+    catch (const std::bad_alloc &)
+    {
+      std::cerr << "Unable to allocate a message of " << header.size
+                << " bytes received on topic [" << _topic << "]" << std::endl;
+      return false;
+    }
+    partial.fragmentSize = fragmentSize;
+    partial.lastFragment = std::chrono::steady_clock::now();
+    it = this->partialMsgs.insert_or_assign(key, std::move(partial)).first;
+  }
+
+  // The fragments are received in order, a gap means one was dropped. Their
+  // header must match the first one.
+  if (it == this->partialMsgs.end() || it->second.received != header.offset ||
+      header.size != it->second.data.Size() ||
+      _data.Size() != std::min<uint64_t>(it->second.fragmentSize,
+        header.size - header.offset))
+  {
+    if (it != this->partialMsgs.end())
+      this->partialMsgs.erase(it);
+    return false;
+  }
+
+  PartialMsg &partial = it->second;
+  std::memcpy(partial.data.Data() + header.offset, _data.Data(),
+    _data.Size());
+  partial.received += _data.Size();
+  if (partial.received == header.size)
+  {
+    _msg = std::move(partial.data);
+    this->partialMsgs.erase(it);
+  }
+  else if (header.offset > 0)
+  {
+    partial.lastFragment = std::chrono::steady_clock::now();
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+void NodeSharedPrivate::DropPartialMsgs(const std::string &_topic,
+    const std::string &_addr)
+{
+  const uint64_t sender = _addr.empty() ? 0 : HeaderId(_addr);
+  auto it = this->partialMsgs.lower_bound(
+    std::make_tuple(_topic, sender, uint64_t{0}));
+  while (it != this->partialMsgs.end() && std::get<0>(it->first) == _topic &&
+         (_addr.empty() || std::get<1>(it->first) == sender))
+  {
+    it = this->partialMsgs.erase(it);
+  }
+}
+
+//////////////////////////////////////////////////
+void NodeSharedPrivate::ExpirePartialMsgs(const Timestamp &_now)
+{
+  const Timestamp expired =
+    _now - std::chrono::milliseconds(kPartialMsgTimeout);
+  for (auto it = this->partialMsgs.begin(); it != this->partialMsgs.end();)
+  {
+    if (it->second.lastFragment < expired)
+      it = this->partialMsgs.erase(it);
+    else
+      ++it;
+  }
+}
+
+//////////////////////////////////////////////////
+PublicationMetadata NodeSharedPrivate::NextMetadata(const std::string &_topic)
+{
+  PublicationMetadata meta;
+
+  // Send the sequence number, which can be used to detect dropped
+  // messages.
+  meta.seq = this->topicPubSeq[_topic]++;
+
+  // Send the publication time.
+  meta.stamp = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+
+  // Send the span publishing the message, see Node::Publisher::Publish().
+  if (this->tracer)
+  {
+    meta.traceId = Tracer::Current().traceId;
+    meta.spanId = Tracer::Current().spanId;
+  }
+
+  return meta;
+}
+
+//////////////////////////////////////////////////
+uint32_t NodeSharedPrivate::AddToHistory(const std::string &_topic,
+    const PublicationMetadata &_meta, const std::string &_msgType,
+    const uint32_t _flags, const char *_data, const std::size_t _size)
+{
+  if (this->histories.empty() || (_flags & kHeaderReliable) == 0)
+    return _flags;
+
+  auto historyIt = this->histories.find(_topic);
+  if (historyIt == this->histories.end())
+    return _flags;
+
+  TopicHistory &history = historyIt->second;
+  if (history.entries.size() >= history.capacity)
+    history.entries.pop_front();
+
+  TopicHistory::Entry entry;
+  entry.header.seq = _meta.seq;
+  entry.header.size = _size;
+  entry.header.flags = _flags;
+  entry.header.typeSize = static_cast<uint32_t>(_msgType.size());
+  entry.msgType = _msgType;
+  entry.data.assign(_data, _size);
+  history.entries.push_back(std::move(entry));
+
+  return _flags | kHeaderHistory;
+}
+
+//////////////////////////////////////////////////
+void NodeSharedPrivate::EnableHistory(const std::string &_topic,
+    const std::string &_addr, const uint64_t _size, const uint64_t _depth)
+{
+  std::string partition;
+  std::string topic;
+  if (!TopicUtils::DecomposeFullyQualifiedTopic(_topic, partition, topic))
+    return;
+
+  if (_size > 0)
+  {
+    std::lock_guard<std::mutex> lock(this->publisherMutex);
+    TopicHistory &history = this->histories[_topic];
+    history.capacity = std::max(history.capacity, _size);
+  }
+
+  if (_depth > 0)
+  {
+    std::lock_guard<std::mutex> lock(this->latchedMutex);
+    TopicHistory &history = this->latched[_topic];
+    history.capacity = std::max(history.capacity, _depth);
+  }
+
+  // The service is shared by the publishers of the topic in this process
+  // that use the same socket, they share the sequence numbers.
+  const std::string service = HistoryService(topic, HeaderId(_addr));
+  {
+    std::lock_guard<std::mutex> lock(this->historyNodesMutex);
+    if (!this->historyServices.insert(partition + service).second)
+      return;
+  }
+
+  std::function<bool(const msgs::Bytes &, msgs::Bytes &)> cb =
+    [this, _topic](const msgs::Bytes &_req, msgs::Bytes &_rep)
+    {
+      // An empty request comes from a late joiner. The latched messages
+      // have a sequence number of 0.
+      if (_req.data().empty())
+      {
+        std::lock_guard<std::mutex> lock(this->latchedMutex);
+        auto latchedIt = this->latched.find(_topic);
+        if (latchedIt == this->latched.end())
+          return false;
+
+        PackHistory(latchedIt->second, 0, 0, *_rep.mutable_data());
+        return true;
+      }
+
+      uint64_t range[2];
+      if (_req.data().size() != sizeof(range))
+        return false;
+      std::memcpy(range, _req.data().data(), sizeof(range));
+
+      std::lock_guard<std::mutex> lock(this->publisherMutex);
+      auto historyIt = this->histories.find(_topic);
+      if (historyIt == this->histories.end())
+        return false;
+
+      PackHistory(historyIt->second, range[0], range[1],
+        *_rep.mutable_data());
+      return true;
+    };
+
+  if (!this->HistoryNode(partition).Advertise(service, cb))
+  {
+    std::cerr << "Unable to advertise the history of topic [" << _topic
+              << "]" << std::endl;
+  }
+}
+
+//////////////////////////////////////////////////
+void NodeSharedPrivate::RequestHistory(const std::string &_topic,
+    const uint64_t _sender, const uint64_t _first, const uint64_t _last)
+{
+  std::string partition;
+  std::string topic;
+  if (!TopicUtils::DecomposeFullyQualifiedTopic(_topic, partition, topic))
+    return;
+
+  const uint64_t range[2] = {_first, _last};
+  msgs::Bytes req;
+  req.set_data(reinterpret_cast<const char *>(range), sizeof(range));
+
+  std::function<void(const msgs::Bytes &, const bool)> cb =
+    [_topic](const msgs::Bytes &_rep, const bool _result)
+    {
+      std::vector<TopicHistory::Entry> entries;
+      if (!_result || !UnpackHistory(_rep.data(), entries))
+        return;
+
+      NodeShared *shared = NodeShared::Instance();
+      for (TopicHistory::Entry &entry : entries)
+      {
+        const auto codec = static_cast<Compression_t>(
+          (entry.header.flags >> kHeaderCodecShift) & 0xff);
+        if (codec != Compression_t::NONE)
+        {
+          std::string data;
+          if (!Decompress(codec, entry.data.data(), entry.data.size(), data))
+            continue;
+          entry.data = std::move(data);
+        }
+
+        MessageInfo info;
+        info.SetTopicAndPartition(_topic);
+        info.SetType(entry.msgType);
+        info.SetSequence(entry.header.seq);
+        info.SetRetransmitted(true);
+        shared->TriggerCallbacks(info, entry.data,
+          shared->CheckMatchingHandlers(_topic, entry.msgType));
+      }
+    };
+
+  this->HistoryNode(partition).Request(HistoryService(topic, _sender), req,
+    cb);
+}
+
+//////////////////////////////////////////////////
+void NodeSharedPrivate::Latch(const std::string &_topic,
+    const std::string &_msgType, const char *_data, const std::size_t _size)
+{
+  std::lock_guard<std::mutex> lock(this->latchedMutex);
+  auto latchedIt = this->latched.find(_topic);
+  if (latchedIt == this->latched.end())
+    return;
+
+  TopicHistory &history = latchedIt->second;
+  if (history.entries.size() >= history.capacity)
+    history.entries.pop_front();
+
+  TopicHistory::Entry entry;
+  entry.header.size = _size;
+  entry.header.typeSize = static_cast<uint32_t>(_msgType.size());
+  entry.msgType = _msgType;
+  entry.data.assign(_data, _size);
+  history.entries.push_back(std::move(entry));
+}
+
+//////////////////////////////////////////////////
+NodeShared::MatchingHandlerInfo NodeSharedPrivate::NewLatchedHandlers(
+    NodeShared &_shared, const std::string &_topic,
+    const std::string &_msgType, const std::string &_source,
+    const std::string &_nUuid)
+{
+  NodeShared::MatchingHandlerInfo handlers =
+    _shared.CheckMatchingHandlers(_topic, _msgType);
+
+  auto filter = [this, &_source, &_nUuid](auto &_list)
+  {
+    if (!_list)
+      return;
+
+    using ListPtrT = std::decay_t<decltype(_list)>;
+    auto filtered = std::make_shared<
+      std::vector<typename ListPtrT::element_type::value_type>>();
+    for (const auto &handler : *_list)
+    {
+      if ((_nUuid.empty() || handler->NodeUuid() == _nUuid) &&
+          this->latchedDelivered[handler->HandlerUuid()].insert(
+            _source).second)
+      {
+        filtered->push_back(handler);
+      }
+    }
+
+    if (filtered->empty())
+      _list = nullptr;
+    else
+      _list = std::move(filtered);
+  };
+
+  filter(handlers.localHandlers);
+  filter(handlers.rawHandlers);
+  return handlers;
+}
+
+//////////////////////////////////////////////////
+void NodeSharedPrivate::RequestLatched(NodeShared &_shared,
+    const MessagePublisher &_pub)
+{
+  std::string partition;
+  std::string topic;
+  if (!TopicUtils::DecomposeFullyQualifiedTopic(_pub.Topic(), partition,
+        topic))
+  {
+    return;
+  }
+
+  // Only the handlers subscribed since the last request receive the
+  // messages.
+  const NodeShared::MatchingHandlerInfo handlers = this->NewLatchedHandlers(
+    _shared, _pub.Topic(), _pub.MsgTypeName(), _pub.Addr());
+  if (!handlers.localHandlers && !handlers.rawHandlers)
+    return;
+
+  std::function<void(const msgs::Bytes &, const bool)> cb =
+    [handlers, fullTopic = _pub.Topic()](const msgs::Bytes &_rep,
+                                          const bool _result)
+    {
+      std::vector<TopicHistory::Entry> entries;
+      if (!_result || !UnpackHistory(_rep.data(), entries))
+        return;
+
+      for (const TopicHistory::Entry &entry : entries)
+      {
+        MessageInfo info;
+        info.SetTopicAndPartition(fullTopic);
+        info.SetType(entry.msgType);
+        NodeShared::Instance()->TriggerCallbacks(info, entry.data, handlers);
+      }
+    };
+
+  this->HistoryNode(partition).Request(
+    HistoryService(topic, HeaderId(_pub.Addr())), msgs::Bytes(), cb);
+}
+
+//////////////////////////////////////////////////
+void NodeSharedPrivate::DeliverLatched(NodeShared &_shared,
+    const std::string &_topic, const std::string &_nUuid)
+{
+  std::deque<TopicHistory::Entry> entries;
+  {
+    std::lock_guard<std::mutex> lock(this->latchedMutex);
+    auto latchedIt = this->latched.find(_topic);
+    if (latchedIt == this->latched.end())
+      return;
+    entries = latchedIt->second.entries;
+  }
+
+  // The handlers are selected once per type, they receive all the
+  // messages of that type.
+  std::map<std::string, NodeShared::MatchingHandlerInfo> handlers;
+  for (const TopicHistory::Entry &entry : entries)
+  {
+    auto handlersIt = handlers.find(entry.msgType);
+    if (handlersIt == handlers.end())
+    {
+      handlersIt = handlers.emplace(entry.msgType, this->NewLatchedHandlers(
+        _shared, _topic, entry.msgType, "", _nUuid)).first;
+    }
+
+    MessageInfo info;
+    info.SetTopicAndPartition(_topic);
+    info.SetType(entry.msgType);
+    info.SetIntraProcess(true);
+    _shared.TriggerCallbacks(info, entry.data, handlersIt->second);
+  }
+}
+
+//////////////////////////////////////////////////
+std::string NodeSharedPrivate::HistoryService(const std::string &_topic,
+    const uint64_t _sender)
+{
+  std::ostringstream service;
+  service << _topic << "/_history/" << std::hex << _sender;
+  return service.str();
+}
+
+//////////////////////////////////////////////////
+void NodeSharedPrivate::PackHistory(const TopicHistory &_history,
+    const uint64_t _first, const uint64_t _last, std::string &_data)
+{
+  for (const TopicHistory::Entry &entry : _history.entries)
+  {
+    if (entry.header.seq < _first || entry.header.seq > _last)
+      continue;
+
+    _data.append(reinterpret_cast<const char *>(&entry.header),
+      sizeof(entry.header));
+    _data.append(entry.msgType);
+    _data.append(entry.data);
+  }
+}
+
+//////////////////////////////////////////////////
+bool NodeSharedPrivate::UnpackHistory(const std::string &_data,
+    std::vector<TopicHistory::Entry> &_entries)
+{
+  std::size_t pos = 0;
+  while (pos < _data.size())
+  {
+    TopicHistory::Entry entry;
+    if (_data.size() - pos < sizeof(entry.header))
+      return false;
+
+    std::memcpy(&entry.header, _data.data() + pos, sizeof(entry.header));
+    pos += sizeof(entry.header);
+    if (_data.size() - pos < entry.header.typeSize ||
+        _data.size() - pos - entry.header.typeSize < entry.header.size)
+    {
+      return false;
+    }
+
+    entry.msgType = _data.substr(pos, entry.header.typeSize);
+    pos += entry.header.typeSize;
+    entry.data = _data.substr(pos, entry.header.size);
+    pos += entry.header.size;
+    _entries.push_back(std::move(entry));
+  }
+
+  return true;
+}
+
+//////////////////////////////////////////////////
+Node &NodeSharedPrivate::HistoryNode(const std::string &_partition)
+{
+  std::lock_guard<std::mutex> lock(this->historyNodesMutex);
+  std::unique_ptr<Node> &node = this->historyNodes[_partition];
+  if (!node)
+  {
+    NodeOptions opts;
+    opts.SetPartition(_partition);
+    node = std::make_unique<Node>(opts);
+  }
+  return *node;
+}
+
+//////////////////////////////////////////////////
+void NodeSharedPrivate::SendPublication(const std::string &_topic,
+    const std::string &_addr, zmq::message_t &_payload,
+    const std::string &_msgType, const uint32_t _flags,
+    const PublicationMetadata *_meta, const std::size_t _metaCount)
+{
+  // Only traced when publishing a traced message.
+  TraceScope span(this->tracer.get(), "send", _topic, Tracer::Current());
+  GZ_TRANSPORT_PROBE_SCOPE(send, _topic.c_str());
+
+  zmq::socket_t *socket = this->PublicationSocket(_addr);
+  zmq::message_t msg0 = TopicFrame(_topic),
+                 msg1 = this->HeaderFrame(_topic, _addr, _msgType, _flags);
+
+  // The subscribers in this host. This must be done before sending the
+  // payload, ZMQ might release the data as soon as it is sent. The
+  // channels are only sent through TCP.
+  if (this->shmPublisher && socket == this->publisher.get())
+  {
+    this->ShmPublish(_topic, msg1, static_cast<const char *>(_payload.data()),
+      _payload.size(), _meta, _metaCount);
+  }
+
+  // ZMQ drops the publications silently when the high water mark is
+  // reached, only the errors can be counted.
+  const std::size_t payloadSize = _payload.size();
+  try
+  {
+#ifdef GZ_ZMQ_POST_4_3_1
+    socket->send(msg0, zmq::send_flags::sndmore);
+    socket->send(msg1, zmq::send_flags::sndmore);
+#else
+    socket->send(msg0, ZMQ_SNDMORE);
+    socket->send(msg1, ZMQ_SNDMORE);
+#endif
+
+    if (_meta)
+    {
+      zmq::message_t msg2(_meta, _metaCount * sizeof(*_meta));
+#ifdef GZ_ZMQ_POST_4_3_1
+      socket->send(_payload, zmq::send_flags::sndmore);
+      socket->send(msg2, zmq::send_flags::none);
+#else
+      socket->send(_payload, ZMQ_SNDMORE);
+      socket->send(msg2, 0);
+#endif
+    }
+    else
+    {
+#ifdef GZ_ZMQ_POST_4_3_1
+      socket->send(_payload, zmq::send_flags::none);
+#else
+      socket->send(_payload, 0);
+#endif
+    }
+  }
+  catch(const zmq::error_t &)
+  {
+    if (this->metrics)
+      this->metrics->Add(_topic, TransportMetrics::SEND_FAILURES);
+    throw;
+  }
+
+  if (this->metrics)
+  {
+    this->metrics->Add(_topic, TransportMetrics::SENT_MSGS);
+    this->metrics->Add(_topic, TransportMetrics::SENT_BYTES, payloadSize);
+  }
+}
+
+//////////////////////////////////////////////////
+zmq::socket_t *NodeSharedPrivate::PublicationSocket(const std::string &_addr)
+{
+  // The topics advertised with a channel have their own socket.
+  if (!this->channelPublishers.empty())
+  {
+    auto channelIt = this->channelPublishers.find(_addr);
+    if (channelIt != this->channelPublishers.end())
+      return channelIt->second.get();
+  }
+  return this->publisher.get();
+}
+
+//////////////////////////////////////////////////
+zmq::message_t NodeSharedPrivate::HeaderFrame(const std::string &_topic,
+    const std::string &_addr, const std::string &_msgType,
+    const uint32_t _flags)
+{
+  PublicationHeader header;
+  header.sender = HeaderId(_addr);
+  header.type = HeaderId(_msgType);
+  header.flags = _flags;
+
+  // The subscribers can't resolve the types that are not advertised, nor
+  // the identifiers that collide.
+  auto typesIt = this->advertisedTypes.find(_topic);
+  if (this->fullHeaderTopics.count(_topic) > 0)
+  {
+    header.typeSize = static_cast<uint32_t>(_msgType.size());
+    header.senderSize = static_cast<uint32_t>(_addr.size());
+  }
+  else if (typesIt == this->advertisedTypes.end() ||
+      std::find(typesIt->second.begin(), typesIt->second.end(), _msgType) ==
+      typesIt->second.end())
+  {
+    header.typeSize = static_cast<uint32_t>(_msgType.size());
+  }
+
+  zmq::message_t frame(
+    PublicationHeader::kSize + header.typeSize + header.senderSize);
+  char *data = static_cast<char *>(frame.data());
+  header.Serialize(data);
+  std::memcpy(data + PublicationHeader::kSize, _msgType.data(),
+    header.typeSize);
+  std::memcpy(data + PublicationHeader::kSize + header.typeSize,
+    _addr.data(), header.senderSize);
+  return frame;
+}
+
+//////////////////////////////////////////////////
+/// \brief A message sent in fragments without copying it. Each fragment
+/// holds a reference, the message is released with the last one.
+struct FragmentedPayload
+{
+  /// \brief Release a reference, the deallocation function of the
+  /// fragments.
+  /// \param[in] _hint The payload.
+  static void Release(void *, void *_hint)
+  {
+    auto *payload = static_cast<FragmentedPayload *>(_hint);
+    if (payload->refs.fetch_sub(1, std::memory_order_acq_rel) > 1)
+      return;
+
+    if (payload->ffn)
+      payload->ffn(payload->data, payload->hint);
+    delete payload;
+  }
+
+  /// \brief The message.
+  char *data = nullptr;
+
+  /// \brief Function releasing the message.
+  DeallocFunc *ffn = nullptr;
+
+  /// \brief Hint passed to ffn.
+  void *hint = nullptr;
+
+  /// \brief References to the message, one per fragment queued by ZMQ
+  /// and one held while sending.
+  std::atomic<std::size_t> refs{1};
+};
+
+//////////////////////////////////////////////////
+bool NodeSharedPrivate::PublishFragments(const std::string &_topic,
+    const std::string &_addr, char *_data, const std::size_t _dataSize,
+    DeallocFunc *_ffn, const std::string &_msgType, void *_hint,
+    const uint32_t _flags)
+{
+  TraceScope span(this->tracer.get(), "send", _topic, Tracer::Current());
+  GZ_TRANSPORT_PROBE_SCOPE(send, _topic.c_str());
+
+  auto *payload = new FragmentedPayload;
+  payload->data = _data;
+  payload->ffn = _ffn;
+  payload->hint = _hint;
+
+  bool result = true;
+  try
+  {
+    const bool withMeta =
+      this->topicStatsEnabled || (_flags & kHeaderReliable);
+    PublicationMetadata meta;
+    FragmentHeader fragment;
+    fragment.size = _dataSize;
+    fragment.count = (_dataSize + this->fragmentSize - 1) / this->fragmentSize;
+    zmq::message_t header;
+    {
+      std::lock_guard<std::mutex> lock(this->publisherMutex);
+      if (withMeta)
+        meta = this->NextMetadata(_topic);
+
+      // The payload is only valid until it is sent.
+      const uint32_t flags = this->AddToHistory(_topic, meta, _msgType,
+        _flags, _data, _dataSize);
+      header = this->HeaderFrame(_topic, _addr, _msgType,
+        flags | kHeaderFragment);
+      fragment.id = ++this->fragmentId;
+
+      // The subscribers in this host read the whole message at once.
+      if (this->shmPublisher &&
+          this->PublicationSocket(_addr) == this->publisher.get())
+      {
+        this->ShmPublish(_topic, this->HeaderFrame(_topic, _addr, _msgType,
+          flags), _data, _dataSize, withMeta ? &meta : nullptr, 1);
+      }
+    }
+
+    for (; fragment.offset < _dataSize; fragment.offset += this->fragmentSize)
+    {
+      const std::size_t size =
+        std::min(this->fragmentSize, _dataSize - fragment.offset);
+      const bool last = fragment.offset + size == _dataSize;
+
+      {
+        std::lock_guard<std::mutex> lock(this->publisherMutex);
+        zmq::socket_t *socket = this->PublicationSocket(_addr);
+        zmq::message_t msg0 = TopicFrame(_topic),
+                       msg1(header.data(), header.size()),
+                       msg2(&fragment, sizeof(fragment));
+        payload->refs.fetch_add(1, std::memory_order_relaxed);
+        zmq::message_t msg3(_data + fragment.offset, size,
+          &FragmentedPayload::Release, payload);
+        const bool sendMeta = last && withMeta;
+
+#ifdef GZ_ZMQ_POST_4_3_1
+        socket->send(msg0, zmq::send_flags::sndmore);
+        socket->send(msg1, zmq::send_flags::sndmore);
+        socket->send(msg2, zmq::send_flags::sndmore);
+        socket->send(msg3, sendMeta ?
+          zmq::send_flags::sndmore : zmq::send_flags::none);
+#else
+        socket->send(msg0, ZMQ_SNDMORE);
+        socket->send(msg1, ZMQ_SNDMORE);
+        socket->send(msg2, ZMQ_SNDMORE);
+        socket->send(msg3, sendMeta ? ZMQ_SNDMORE : 0);
+#endif
+        if (sendMeta)
+        {
+          zmq::message_t msg4(&meta, sizeof(meta));
+#ifdef GZ_ZMQ_POST_4_3_1
+          socket->send(msg4, zmq::send_flags::none);
+#else
+          socket->send(msg4, 0);
+#endif
+        }
+      }
+
+      // Let the publications waiting for the socket through.
+      if (!last)
+        std::this_thread::yield();
+    }
+  }
+  catch(const zmq::error_t &_error)
+  {
+    std::cerr << "NodeShared::Publish() Error: " << _error.what()
+              << std::endl;
+    result = false;
+  }
+  FragmentedPayload::Release(nullptr, payload);
+
+  if (this->metrics && result)
+  {
+    this->metrics->Add(_topic, TransportMetrics::SENT_MSGS);
+    this->metrics->Add(_topic, TransportMetrics::SENT_BYTES, _dataSize);
+  }
+  else if (this->metrics)
+    this->metrics->Add(_topic, TransportMetrics::SEND_FAILURES);
+  return result;
+}
+
+//////////////////////////////////////////////////
+void NodeSharedPrivate::AddAdvertisedType(const std::string &_topic,
+    const std::string &_msgType)
+{
+  {
+    std::lock_guard<std::mutex> lock(this->publisherMutex);
+    this->advertisedTypes[_topic].push_back(_msgType);
+  }
+  this->UpdateFullHeaders(_topic);
+}
+
+//////////////////////////////////////////////////
+void NodeSharedPrivate::RemoveAdvertisedType(const std::string &_topic,
+    const std::string &_msgType)
+{
+  std::lock_guard<std::mutex> lock(this->publisherMutex);
+  auto typesIt = this->advertisedTypes.find(_topic);
+  if (typesIt == this->advertisedTypes.end())
+    return;
+
+  auto &types = typesIt->second;
+  auto it = std::find(types.begin(), types.end(), _msgType);
+  if (it != types.end())
+    types.erase(it);
+  if (types.empty())
+  {
+    this->advertisedTypes.erase(typesIt);
+    this->fullHeaderTopics.erase(_topic);
+  }
+}
+
+//////////////////////////////////////////////////
+void NodeSharedPrivate::UpdateFullHeaders(const std::string &_topic)
+{
+  {
+    std::lock_guard<std::mutex> lock(this->publisherMutex);
+    if (this->advertisedTypes.count(_topic) == 0)
+      return;
+  }
+
+  // The identifiers only need to be distinct among the publishers of the
+  // topic, the subscribers resolve them per topic.
+  std::unordered_map<uint64_t, std::string> senders;
+  std::unordered_map<uint64_t, std::string> types;
+  bool collide = false;
+  Addresses_M<MessagePublisher> pubs;
+  this->msgDiscovery->Publishers(_topic, pubs);
+  for (const auto &proc : pubs)
+  {
+    for (const auto &pub : proc.second)
+    {
+      auto senderIt =
+        senders.emplace(HeaderId(pub.Addr()), pub.Addr()).first;
+      auto typeIt =
+        types.emplace(HeaderId(pub.MsgTypeName()), pub.MsgTypeName()).first;
+      collide = collide || senderIt->second != pub.Addr() ||
+        typeIt->second != pub.MsgTypeName();
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(this->publisherMutex);
+  if (!collide)
+    this->fullHeaderTopics.erase(_topic);
+  else if (this->advertisedTypes.count(_topic) > 0 &&
+           this->fullHeaderTopics.insert(_topic).second)
+  {
+    std::cerr << "The identifiers of the publishers of topic [" << _topic
+              << "] collide, their address and type are sent in full"
+              << std::endl;
+  }
+}
+
+//////////////////////////////////////////////////
+std::string NodeSharedPrivate::ChannelAddress(const std::string &_channel,
+    const std::string &_hostAddr, const Priority_t _priority)
+{
+  // A channel has a socket per interface.
+  const std::string key = _channel + "@" + _hostAddr;
+  std::lock_guard<std::mutex> lock(this->publisherMutex);
+  auto addrIt = this->channelAddresses.find(key);
+  if (addrIt != this->channelAddresses.end())
+    return addrIt->second;
+
+  std::string addr;
+  try
+  {
+    auto socket = std::make_unique<zmq::socket_t>(*this->context, ZMQ_PUB);
+
+    this->security.ApplyServer(*socket, kGzAuthDomain);
+
+    const SocketOptions socketOptions = SocketOptions::FromEnv();
+    socketOptions.Apply(*socket, "publisher");
+    socketOptions.ApplyPriority(*socket, _priority);
+
+    int lingerVal = 0;
+    int sndQueueVal = this->NonNegativeEnvVar(
+      "GZ_TRANSPORT_SNDHWM", kDefaultSndHwm);
+    const std::string anyTcpEp = "tcp://" + _hostAddr + ":*";
+#ifdef GZ_CPPZMQ_POST_4_7_0
+    socket->set(zmq::sockopt::linger, lingerVal);
+    socket->set(zmq::sockopt::sndhwm, sndQueueVal);
+    socket->bind(anyTcpEp.c_str());
+    addr = socket->get(zmq::sockopt::last_endpoint);
+#else
+    socket->setsockopt(ZMQ_LINGER, &lingerVal, sizeof(lingerVal));
+    socket->setsockopt(ZMQ_SNDHWM, &sndQueueVal, sizeof(sndQueueVal));
+    socket->bind(anyTcpEp.c_str());
+    char bindEndPoint[1024];
+    size_t size = sizeof(bindEndPoint);
+    socket->getsockopt(ZMQ_LAST_ENDPOINT, &bindEndPoint, &size);
+    addr = bindEndPoint;
+#endif
+
+    // The messages of a multicast channel are also sent to the group, for
+    // the subscribers in other hosts.
+    if (_channel.rfind(kMulticastChannelPrefix, 0) == 0)
+    {
+      this->MulticastConnect(*socket,
+        _channel.substr(sizeof(kMulticastChannelPrefix) - 1), _hostAddr);
+    }
+
+    this->MonitorPublisher(*socket, addr);
+    this->channelPublishers[addr] = std::move(socket);
+  }
+  catch(const zmq::error_t &_error)
+  {
+    std::cerr << "Unable to bind the socket of the publisher channel ["
+              << _channel << "]: " << _error.what() << std::endl;
+    return "";
+  }
+
+  this->channelAddresses[key] = addr;
+  return addr;
+}
+
+//////////////////////////////////////////////////
+std::string NodeSharedPrivate::BindLegacyPublisher(
+    const std::string &_hostAddr)
+{
+  std::lock_guard<std::mutex> lock(this->publisherMutex);
+  if (this->legacyPublisher)
+    return this->legacyAddress;
+
+  std::string addr;
+  try
+  {
+    auto socket = std::make_unique<zmq::socket_t>(*this->context, ZMQ_PUB);
+
+    this->security.ApplyServer(*socket, kGzAuthDomain);
+
+    const SocketOptions socketOptions = SocketOptions::FromEnv();
+    socketOptions.Apply(*socket, "publisher");
+    socketOptions.ApplyPriority(*socket, Priority_t::NORMAL);
+
+    int lingerVal = 0;
+    int sndQueueVal = this->NonNegativeEnvVar(
+      "GZ_TRANSPORT_SNDHWM", kDefaultSndHwm);
+    const std::string anyTcpEp = "tcp://" + _hostAddr + ":*";
+#ifdef GZ_CPPZMQ_POST_4_7_0
+    socket->set(zmq::sockopt::linger, lingerVal);
+    socket->set(zmq::sockopt::sndhwm, sndQueueVal);
+    socket->bind(anyTcpEp.c_str());
+    addr = socket->get(zmq::sockopt::last_endpoint);
+#else
+    socket->setsockopt(ZMQ_LINGER, &lingerVal, sizeof(lingerVal));
+    socket->setsockopt(ZMQ_SNDHWM, &sndQueueVal, sizeof(sndQueueVal));
+    socket->bind(anyTcpEp.c_str());
+    char bindEndPoint[1024];
+    size_t size = sizeof(bindEndPoint);
+    socket->getsockopt(ZMQ_LAST_ENDPOINT, &bindEndPoint, &size);
+    addr = bindEndPoint;
+#endif
+
+    this->legacyPublisher = std::move(socket);
+  }
+  catch(const zmq::error_t &_error)
+  {
+    std::cerr << "Unable to bind the socket of the peers of the previous "
+              << "wire protocol: " << _error.what() << std::endl;
+    return "";
+  }
+
+  this->legacyAddress = addr;
+  this->legacyReady.store(true, std::memory_order_release);
+  return addr;
+}
+
+//////////////////////////////////////////////////
+void NodeSharedPrivate::PublishLegacy(const std::string &_topic,
+    const char *_data, const std::size_t _size, const std::string &_msgType)
+{
+  if (!this->legacySubscribed.load(std::memory_order_relaxed) ||
+      !this->legacyReady.load(std::memory_order_acquire))
+  {
+    return;
+  }
+
+  // Only the topics subscribed by these peers are serialized again.
+  {
+    std::lock_guard<std::mutex> lock(this->legacyMutex);
+    if (this->legacySubscribers.count(_topic) == 0)
+      return;
+  }
+
+  std::lock_guard<std::mutex> lock(this->publisherMutex);
+  try
+  {
+    zmq::socket_t &socket = *this->legacyPublisher;
+    zmq::message_t msg;
+
+    msg.rebuild(_topic.size());
+    memcpy(msg.data(), _topic.data(), _topic.size());
+#ifdef GZ_ZMQ_POST_4_3_1
+    socket.send(msg, zmq::send_flags::sndmore);
+#else
+    socket.send(msg, ZMQ_SNDMORE);
+#endif
+
+    msg.rebuild(this->legacyAddress.size());
+    memcpy(msg.data(), this->legacyAddress.data(),
+      this->legacyAddress.size());
+#ifdef GZ_ZMQ_POST_4_3_1
+    socket.send(msg, zmq::send_flags::sndmore);
+#else
+    socket.send(msg, ZMQ_SNDMORE);
+#endif
+
+    msg.rebuild(_size);
+    memcpy(msg.data(), _data, _size);
+#ifdef GZ_ZMQ_POST_4_3_1
+    socket.send(msg, zmq::send_flags::sndmore);
+#else
+    socket.send(msg, ZMQ_SNDMORE);
+#endif
+
+    // The metadata of the previous wire protocol only has the timestamp
+    // and the sequence number.
+    msg.rebuild(_msgType.size());
+    memcpy(msg.data(), _msgType.data(), _msgType.size());
+#ifdef GZ_ZMQ_POST_4_3_1
+    socket.send(msg, this->topicStatsEnabled ?
+      zmq::send_flags::sndmore : zmq::send_flags::none);
+#else
+    socket.send(msg, this->topicStatsEnabled ? ZMQ_SNDMORE : 0);
+#endif
+
+    if (this->topicStatsEnabled)
+    {
+      const uint64_t meta[2] = {
+        static_cast<uint64_t>(
+          std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count()),
+        this->legacySeqs[_topic]++};
+      msg.rebuild(sizeof(meta));
+      memcpy(msg.data(), meta, sizeof(meta));
+#ifdef GZ_ZMQ_POST_4_3_1
+      socket.send(msg, zmq::send_flags::none);
+#else
+      socket.send(msg, 0);
+#endif
+    }
+  }
+  catch(const zmq::error_t &_error)
+  {
+    std::cerr << "NodeSharedPrivate::PublishLegacy() Error: "
+              << _error.what() << std::endl;
+  }
+}
+
+//////////////////////////////////////////////////
+void NodeSharedPrivate::UpdateLegacySubscriber(const MessagePublisher &_sub,
+    const bool _subscribed)
+{
+  std::lock_guard<std::mutex> lock(this->legacyMutex);
+  const auto node = std::make_pair(_sub.PUuid(), _sub.NUuid());
+  if (_subscribed)
+  {
+    this->legacySubscribers[_sub.Topic()].insert(node);
+  }
+  else
+  {
+    auto topicIt = this->legacySubscribers.find(_sub.Topic());
+    if (topicIt == this->legacySubscribers.end())
+      return;
+    topicIt->second.erase(node);
+    if (topicIt->second.empty())
+      this->legacySubscribers.erase(topicIt);
+  }
+  this->legacySubscribed = !this->legacySubscribers.empty();
+}
+
+//////////////////////////////////////////////////
+void NodeSharedPrivate::RemoveLegacySubscribers(const std::string &_pUuid)
+{
+  std::lock_guard<std::mutex> lock(this->legacyMutex);
+  for (auto topicIt = this->legacySubscribers.begin();
+       topicIt != this->legacySubscribers.end();)
+  {
+    auto &nodes = topicIt->second;
+    auto nodeIt = nodes.lower_bound(std::make_pair(_pUuid, std::string()));
+    while (nodeIt != nodes.end() && nodeIt->first == _pUuid)
+      nodeIt = nodes.erase(nodeIt);
+
+    if (nodes.empty())
+      topicIt = this->legacySubscribers.erase(topicIt);
+    else
+      ++topicIt;
+  }
+  this->legacySubscribed = !this->legacySubscribers.empty();
+}
+
+//////////////////////////////////////////////////
+bool NodeSharedPrivate::RecvLegacyMsg(zmq::socket_t &_socket,
+    zmq::message_t &_msg, const std::string &_topic, std::string &_msgType,
+    SerializedBuffer &_data)
+{
+  // The filter of the previous wire protocol also matches the topics
+  // starting with a topic subscribed.
+  if (this->legacySubscriptions.count(_topic) == 0)
+  {
+    this->DiscardFrames(_socket, _msg);
+    return false;
+  }
+
+  auto recv = [&_socket](zmq::message_t &_frame)
+  {
+#ifdef GZ_ZMQ_POST_4_3_1
+    return static_cast<bool>(_socket.recv(_frame));
+#else
+    return _socket.recv(&_frame, 0);
+#endif
+  };
+
+  // The address of the publisher, the message and its type.
+  if (!_msg.more() || !recv(_msg))
+    return false;
+  const std::string sender(static_cast<const char *>(_msg.data()),
+    _msg.size());
+
+  zmq::message_t payload;
+  if (!_msg.more() || !recv(payload) || !payload.more() || !recv(_msg))
+  {
+    std::cerr << "Invalid message received on topic [" << _topic << "]"
+              << std::endl;
+    return false;
+  }
+  _msgType.assign(static_cast<const char *>(_msg.data()), _msg.size());
+  _data = SerializedBuffer::Adopt(std::move(payload));
+
+  // The metadata, sent if the topic statistics are enabled.
+  if (_msg.more() && recv(_msg) && _msg.size() >= 2 * sizeof(uint64_t))
+  {
+    auto statsIt = this->topicStats.find(_topic);
+    if (statsIt != this->topicStats.end() && statsIt->second->callback)
+    {
+      uint64_t meta[2];
+      std::memcpy(meta, _msg.data(), sizeof(meta));
+      TopicStatsEntry &entry = *statsIt->second;
+      entry.stats.Update(HeaderId(sender), meta[0], meta[1]);
+      entry.stats.AddQueueDrops(entry.queueDrops.exchange(0));
+      entry.stats.AddSlowSubscribers(entry.slowSubscribers.exchange(0));
+      entry.callback(entry.stats);
+    }
+  }
+
+  this->DiscardFrames(_socket, _msg);
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool NodeSharedPrivate::MulticastConnect(zmq::socket_t &_socket,
+    const std::string &_group, const std::string &_hostAddr)
+{
+  // PGM encapsulated in UDP, which doesn't need raw sockets. The interface
+  // is selected by its address, as in the discovery.
+  const std::string ep = "epgm://" + _hostAddr + ";" + _group;
+  try
+  {
+    SocketOptions::FromEnv().ApplyMulticast(_socket);
+    _socket.connect(ep.c_str());
+  }
+  catch(const zmq::error_t &_error)
+  {
+    std::cerr << "Unable to connect to the multicast group [" << _group
+              << "], using TCP: " << _error.what() << std::endl;
+    return false;
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+void NodeSharedPrivate::RegisterSubscribers(const NodeShared &_shared,
+    const MessagePublisher &_connection, const std::string &_topic,
+    const std::string &_nUuid) const
+{
+  MessagePublisher pub(_connection);
+  pub.SetPUuid(_shared.pUuid);
+  pub.SetNUuid(_nUuid);
+
+  // Hack: We use this field to store the PUuid of the topic publisher.
+  pub.SetCtrl(_connection.PUuid());
+
+  // Tell the publisher the highest rate of the subscribers of the node,
+  // so it doesn't send the messages that they would discard.
+  AdvertiseMessageOptions opts = _connection.Options();
+  opts.SetMsgsPerSec(_shared.localSubscribers.MsgsPerSec(
+    _topic, _connection.MsgTypeName(), _nUuid));
+  pub.SetOptions(opts);
+
+  // Send a message to the publisher notify it
+  // about all my remoteSubscribers.
+  this->msgDiscovery->Register(pub);
+}
+
+//////////////////////////////////////////////////
+void NodeSharedPrivate::UpdateSubscribers(const NodeShared &_shared,
+    const std::string &_topic, const std::string &_nUuid) const
+{
+  // The subscribers of an alias are connected through the topic it names.
+  const std::string target = this->AliasTarget(_topic);
+  MsgAddresses_M connected;
+  if (!_shared.connections.Publishers(target.empty() ? _topic : target,
+        connected))
+  {
+    return;
+  }
+
+  for (const auto &proc : connected)
+  {
+    for (const MessagePublisher &connection : proc.second)
+    {
+      const std::vector<std::string> nodes =
+        _shared.localSubscribers.NodeUuids(_topic, connection.MsgTypeName());
+      if (std::find(nodes.begin(), nodes.end(), _nUuid) != nodes.end())
+        this->RegisterSubscribers(_shared, connection, _topic, _nUuid);
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+const MessageInfo &NodeSharedPrivate::RecvMsgInfo(const TopicKey &_topic,
+    const std::string &_msgType)
+{
+  // The names of the topic are parsed once, the copies share them.
+  auto &infos = this->recvMsgInfos[_topic];
+  auto infoIt = infos.find(_msgType);
+  if (infoIt == infos.end())
+  {
+    MessageInfo info;
+    info.SetTopicAndPartition(_topic.name);
+    info.SetType(_msgType);
+    infoIt = infos.emplace(_msgType, std::move(info)).first;
+  }
+  return infoIt->second;
+}
+
+//////////////////////////////////////////////////
+uint64_t NodeSharedPrivate::HeaderId(const std::string &_str)
+{
+  uint64_t hash = 14695981039346656037ULL;
+  for (const char c : _str)
+  {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+//////////////////////////////////////////////////
+/// \brief Write a little endian integer.
+/// \param[out] _data Buffer of sizeof(T) bytes.
+/// \param[in] _value The integer.
+template<typename T>
+static void writeLittleEndian(char *_data, const T _value)
+{
+  for (std::size_t i = 0; i < sizeof(T); ++i)
+    _data[i] = static_cast<char>((_value >> (8 * i)) & 0xFF);
+}
+
+//////////////////////////////////////////////////
+/// \brief Read a little endian integer.
+/// \param[in] _data Buffer of sizeof(T) bytes.
+/// \return The integer.
+template<typename T>
+static T readLittleEndian(const char *_data)
+{
+  T value = 0;
+  for (std::size_t i = 0; i < sizeof(T); ++i)
+    value |= static_cast<T>(static_cast<unsigned char>(_data[i])) << (8 * i);
+  return value;
+}
+
+//////////////////////////////////////////////////
+void PublicationHeader::Serialize(char *_data) const
+{
+  writeLittleEndian(_data, this->sender);
+  writeLittleEndian(_data + 8, this->type);
+  writeLittleEndian(_data + 16, this->flags);
+  writeLittleEndian(_data + 20, this->typeSize);
+  writeLittleEndian(_data + 24, this->senderSize);
+}
+
+//////////////////////////////////////////////////
+void PublicationHeader::Parse(const char *_data)
+{
+  this->sender = readLittleEndian<uint64_t>(_data);
+  this->type = readLittleEndian<uint64_t>(_data + 8);
+  this->flags = readLittleEndian<uint32_t>(_data + 16);
+  this->typeSize = readLittleEndian<uint32_t>(_data + 20);
+  this->senderSize = readLittleEndian<uint32_t>(_data + 24);
+}
+
+//////////////////////////////////////////////////
+bool NodeSharedPrivate::ResolveHeader(const std::string &_topic,
+    const PublicationHeader &_header, std::string &_sender,
+    std::string &_msgType)
+{
+  // The strings sent in full don't need to be resolved.
+  const bool resolveSender = _header.senderSize == 0;
+  const bool resolveType = _header.typeSize == 0;
+  if (!resolveSender && !resolveType)
+    return true;
+
+  auto known = [&](const HeaderIds &_ids)
+  {
+    return (!resolveSender || _ids.senders.count(_header.sender) > 0) &&
+           (!resolveType || _ids.types.count(_header.type) > 0);
+  };
+
+  HeaderIds &ids = this->headerIds[_topic];
+  if (!known(ids))
+  {
+    // A publisher sharing the socket of another topic, learn its
+    // identifiers. Unknown identifiers, e.g. from a publisher not
+    // discovered yet, don't look up the discovery at every message.
+    const Timestamp now = std::chrono::steady_clock::now();
+    if (now - ids.lastScan < std::chrono::milliseconds(Timeout))
+      return false;
+    ids.lastScan = now;
+
+    Addresses_M<MessagePublisher> pubs;
+    this->msgDiscovery->Publishers(_topic, pubs);
+    for (const auto &proc : pubs)
+    {
+      for (const auto &pub : proc.second)
+        this->LearnHeaderIds(_topic, pub);
+    }
+
+    if (!known(ids))
+      return false;
+  }
+
+  if ((resolveSender && ids.senderCollisions.count(_header.sender) > 0) ||
+      (resolveType && ids.typeCollisions.count(_header.type) > 0))
+  {
+    return false;
+  }
+
+  if (resolveSender)
+    _sender = ids.senders[_header.sender];
+  if (resolveType)
+    _msgType = ids.types[_header.type];
+  return true;
+}
+
+//////////////////////////////////////////////////
+void NodeSharedPrivate::LearnHeaderIds(const std::string &_topic,
+    const MessagePublisher &_pub)
+{
+  HeaderIds &ids = this->headerIds[_topic];
+
+  auto senderIt =
+    ids.senders.emplace(HeaderId(_pub.Addr()), _pub.Addr()).first;
+  if (senderIt->second != _pub.Addr())
+    ids.senderCollisions.insert(senderIt->first);
+
+  auto typeIt =
+    ids.types.emplace(HeaderId(_pub.MsgTypeName()), _pub.MsgTypeName()).first;
+  if (typeIt->second != _pub.MsgTypeName())
+    ids.typeCollisions.insert(typeIt->first);
+}
+
+//////////////////////////////////////////////////
+void NodeSharedPrivate::ForgetHeaderIds(const std::string &_topic,
+    const std::string &_addr)
+{
+  if (_addr.empty())
+  {
+    this->headerIds.erase(_topic);
+    return;
+  }
+
+  auto idsIt = this->headerIds.find(_topic);
+  if (idsIt == this->headerIds.end())
+    return;
+
+  // A colliding identifier stays unresolvable.
+  auto senderIt = idsIt->second.senders.find(HeaderId(_addr));
+  if (senderIt != idsIt->second.senders.end() && senderIt->second == _addr &&
+      idsIt->second.senderCollisions.count(senderIt->first) == 0)
+  {
+    idsIt->second.senders.erase(senderIt);
+  }
+}
+
+//////////////////////////////////////////////////
+void NodeSharedPrivate::DiscardFrames(zmq::socket_t &_socket,
+    zmq::message_t &_msg)
+{
+  while (_msg.more())
+  {
+#ifdef GZ_ZMQ_POST_4_3_1
+    if (!_socket.recv(_msg))
+#else
+    if (!_socket.recv(&_msg, 0))
+#endif
+      return;
+  }
+}
+
+//////////////////////////////////////////////////
+bool NodeSharedPrivate::PublishBatched(const std::string &_topic,
+    const std::string &_addr, const char *_data, const std::size_t _size,
+    const std::string &_msgType, const uint64_t _maxDelay,
+    const uint64_t _maxBytes, const uint32_t _flags)
+{
+  try
+  {
+    std::lock_guard<std::mutex> lock(this->publisherMutex);
+
+    PublishBatch &batch = this->batches[_topic];
+
+    // A batch only contains messages of one type and one priority.
+    const uint32_t priority = _flags & kHeaderPriorityMask;
+    if (!batch.data.empty() &&
+        (batch.msgType != _msgType || batch.priorityFlags != priority))
+    {
+      this->FlushBatch(_topic, batch);
+    }
+
+    const bool withMeta =
+      this->topicStatsEnabled || (_flags & kHeaderReliable);
+    PublicationMetadata meta;
+    if (withMeta)
+      meta = this->NextMetadata(_topic);
+
+    // Big, compressed or reliable messages are not batched. The pending
+    // messages are sent first to preserve the order.
+    if ((_flags & ~kHeaderPriorityMask) != 0 || _size >= _maxBytes ||
+        _size > std::numeric_limits<uint32_t>::max())
+    {
+      this->FlushBatch(_topic, batch);
+      zmq::message_t payload(_data, _size);
+      const uint32_t flags = this->AddToHistory(_topic, meta, _msgType,
+        _flags, _data, _size);
+      this->SendPublication(_topic, _addr, payload, _msgType, flags,
+        withMeta ? &meta : nullptr, 1);
+      return true;
+    }
+
+    if (batch.data.empty())
+    {
+      batch.msgType = _msgType;
+      batch.deadline = std::chrono::steady_clock::now() +
+        std::chrono::microseconds(_maxDelay);
+      batch.addr = _addr;
+      batch.priorityFlags = priority;
+
+      if (!this->batchThread.joinable())
+      {
+        this->batchThread =
+          std::thread(&NodeSharedPrivate::BatchThread, this);
+      }
+      this->batchCondition.notify_one();
+    }
+
+    const uint32_t size = static_cast<uint32_t>(_size);
+    batch.data.append(reinterpret_cast<const char *>(&size), sizeof(size));
+    batch.data.append(_data, _size);
+    if (this->topicStatsEnabled)
+      batch.meta.push_back(meta);
+
+    if (batch.data.size() >= _maxBytes)
+      this->FlushBatch(_topic, batch);
+  }
+  catch(const zmq::error_t &_error)
+  {
+    std::cerr << "NodeShared::Publish() Error: " << _error.what()
+              << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+//////////////////////////////////////////////////
+void NodeSharedPrivate::FlushBatch(const std::string &_topic,
+    PublishBatch &_batch)
+{
+  if (_batch.data.empty())
+    return;
+
+  // The storage of the batch is kept for the next messages.
+  zmq::message_t payload(_batch.data.data(), _batch.data.size());
+  const bool withMeta = this->topicStatsEnabled && !_batch.meta.empty();
+  _batch.data.clear();
+
+  this->SendPublication(_topic, _batch.addr, payload, _batch.msgType,
+    kHeaderBatch | _batch.priorityFlags,
+    withMeta ? _batch.meta.data() : nullptr,
+    _batch.meta.size());
+  _batch.meta.clear();
+}
+
+//////////////////////////////////////////////////
+void NodeSharedPrivate::FlushBatches(const std::string &_topic)
+{
+  for (auto &batch : this->batches)
+  {
+    if (batch.second.data.empty() ||
+        (!_topic.empty() && batch.first != _topic))
+    {
+      continue;
+    }
+
+    try
+    {
+      this->FlushBatch(batch.first, batch.second);
+    }
+    catch(const zmq::error_t &_error)
+    {
+      std::cerr << "Error sending a batch on topic [" << batch.first
+                << "]: " << _error.what() << std::endl;
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+void NodeSharedPrivate::BatchThread()
+{
+  configureThread("batch");
+
+  std::unique_lock<std::mutex> lk(this->publisherMutex);
+  while (!this->exit)
+  {
+    const Timestamp now = std::chrono::steady_clock::now();
+    Timestamp next = Timestamp::max();
+    for (auto &batch : this->batches)
+    {
+      if (batch.second.data.empty())
+        continue;
+
+      if (batch.second.deadline > now)
+      {
+        next = std::min(next, batch.second.deadline);
+        continue;
+      }
+
+      try
+      {
+        this->FlushBatch(batch.first, batch.second);
+      }
+      catch(const zmq::error_t &_error)
+      {
+        std::cerr << "Error sending a batch on topic [" << batch.first
+                  << "]: " << _error.what() << std::endl;
+      }
+    }
+
+    if (next == Timestamp::max())
+      this->batchCondition.wait(lk);
+    else
+      this->batchCondition.wait_until(lk, next);
+  }
+
+  // The messages published during the last delay are not lost, the
+  // publisher sockets are still open.
+  this->FlushBatches();
+}
+
+//////////////////////////////////////////////////
+bool NodeSharedPrivate::UnpackBatch(const SerializedBuffer &_data,
+    std::vector<SerializedBuffer> &_msgs)
+{
+  std::size_t pos = 0;
+  while (pos < _data.Size())
+  {
+    uint32_t size;
+    if (_data.Size() - pos < sizeof(size))
+      return false;
+
+    std::memcpy(&size, _data.Data() + pos, sizeof(size));
+    pos += sizeof(size);
+    if (_data.Size() - pos < size)
+      return false;
+
+    _msgs.push_back(_data.Slice(pos, size));
+    pos += size;
+  }
+
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool NodeSharedPrivate::MsgUpdatePending(const std::size_t _shard)
+{
+  zmq::pollitem_t items[] =
+  {
+    {static_cast<void*>(this->Subscriber(_shard)), 0, ZMQ_POLLIN, 0}
+  };
+
+  try
+  {
+    zmq::poll(&items[0], 1, std::chrono::milliseconds(0));
+  }
+  catch(...)
+  {
+    return false;
+  }
+
+  return items[0].revents & ZMQ_POLLIN;
+}
+
+//////////////////////////////////////////////////
+zmq::message_t NodeSharedPrivate::TopicFrame(const std::string &_topic)
+{
+  zmq::message_t frame(_topic.size() + 1);
+  std::memcpy(frame.data(), _topic.data(), _topic.size());
+  static_cast<char *>(frame.data())[_topic.size()] = '\0';
+  return frame;
+}
+
+//////////////////////////////////////////////////
+std::string NodeSharedPrivate::TopicFilter(const std::string &_topic)
+{
+  return _topic + '\0';
+}
+
+//////////////////////////////////////////////////
+void NodeSharedPrivate::ConnectSubscriber(const MessagePublisher &_pub,
+    const std::string &_hostAddr)
+{
+  if (!this->topicSocketsReady)
+    return;
+
+  if (this->backend)
+  {
+    this->backend->Connect(_pub);
+    return;
+  }
+
+  this->LearnHeaderIds(_pub.Topic(), _pub);
+
+  const std::string &topic = _pub.Topic();
+  const std::string &addr = _pub.Addr();
+  const std::size_t shard = this->SubscriberShard(topic);
+  zmq::socket_t &socket = this->Subscriber(shard);
+  auto &connections = this->subscriberConnections[shard];
+
+  // The data is received through the local interface in the subnet of the
+  // publisher, e.g. "10.0.0.2" in "tcp://10.0.0.2:4000", so it doesn't take
+  // the default route through another link.
+  const std::size_t portPos = addr.rfind(':');
+  const std::string pubIp = addr.rfind("tcp://", 0) == 0 && portPos > 6 ?
+    addr.substr(6, portPos - 6) : "";
+  const std::string localIp =
+    pubIp.empty() ? "" : determineLocalInterface(pubIp);
+  const bool remote = pubIp != _hostAddr && localIp != pubIp;
+
+  // The topics sent to a multicast group are received from the group if
+  // the publisher is in another host: the multicast messages aren't looped
+  // back to the sending host.
+  const std::string group = ctrlMulticastGroup(_pub.Ctrl());
+  const std::string groupIp = localIp.empty() ? _hostAddr : localIp;
+  auto connIt = connections.end();
+  if (!group.empty() && remote)
+  {
+    connIt = connections.find("epgm:" + group);
+    if (connIt == connections.end() &&
+        this->MulticastConnect(socket, group, groupIp))
+    {
+      connIt = connections.emplace("epgm:" + group, SubscriberConnection{
+        "epgm://" + groupIp + ";" + group, {}}).first;
+    }
+  }
+
+  // If the publisher is in this host use shared memory or IPC when it
+  // supports them, TCP otherwise. The topics advertised with a channel are
+  // only sent through the TCP endpoint of the channel.
+  if (connIt == connections.end())
+    connIt = connections.find(addr);
+  if (connIt == connections.end())
+  {
+    const bool channel = _pub.Ctrl().rfind(kChannelCtrlPrefix, 0) == 0;
+    std::string endpoint = addr;
+    if (!channel && this->ShmConnect(_pub, socket))
+      endpoint = "ipc://" + IpcPath(_pub.PUuid(), "shm");
+    else if (!channel && this->IpcConnect(socket, _pub.PUuid(), "pub"))
+      endpoint = "ipc://" + IpcPath(_pub.PUuid(), "pub");
+    else
+    {
+      if (remote && !localIp.empty())
+        endpoint = "tcp://" + localIp + ":0;" + addr.substr(6);
+      socket.connect(endpoint.c_str());
+    }
+    connIt = connections.emplace(addr,
+      SubscriberConnection{endpoint, {}}).first;
+  }
+  connIt->second.topics.insert(topic);
+
+  if (this->subscriptions.insert(topic).second)
+  {
+    const std::string filter = TopicFilter(topic);
+#ifdef GZ_CPPZMQ_POST_4_7_0
+    socket.set(zmq::sockopt::subscribe, filter);
+#else
+    socket.setsockopt(ZMQ_SUBSCRIBE, filter.data(), filter.size());
+#endif
+  }
+
+  // The publishers of the previous wire protocol don't terminate the
+  // topic, see RecvLegacyMsg().
+  if (this->msgDiscovery->LegacyPeer(_pub.PUuid()) &&
+      this->legacySubscriptions.insert(topic).second)
+  {
+#ifdef GZ_CPPZMQ_POST_4_7_0
+    socket.set(zmq::sockopt::subscribe, topic);
+#else
+    socket.setsockopt(ZMQ_SUBSCRIBE, topic.data(), topic.size());
+#endif
+  }
+}
+
+//////////////////////////////////////////////////
+void NodeSharedPrivate::DisconnectSubscriber(const std::string &_topic,
+    const std::string &_addr)
+{
+  if (!this->topicSocketsReady)
+    return;
+
+  if (this->backend)
+  {
+    this->backend->Disconnect(_topic, _addr);
+    return;
+  }
+
+  this->DropPartialMsgs(_topic, _addr);
+  this->ForgetHeaderIds(_topic, _addr);
+
+  const std::size_t shard = this->SubscriberShard(_topic);
+  zmq::socket_t &socket = this->Subscriber(shard);
+  auto &connections = this->subscriberConnections[shard];
+
+  if (_addr.empty() && this->subscriptions.erase(_topic) > 0)
+  {
+    const std::string filter = TopicFilter(_topic);
+#ifdef GZ_CPPZMQ_POST_4_7_0
+    socket.set(zmq::sockopt::unsubscribe, filter);
+#else
+    socket.setsockopt(ZMQ_UNSUBSCRIBE, filter.data(), filter.size());
+#endif
+  }
+
+  if (_addr.empty() && this->legacySubscriptions.erase(_topic) > 0)
+  {
+#ifdef GZ_CPPZMQ_POST_4_7_0
+    socket.set(zmq::sockopt::unsubscribe, _topic);
+#else
+    socket.setsockopt(ZMQ_UNSUBSCRIBE, _topic.data(), _topic.size());
+#endif
+  }
+
+  for (auto connIt = connections.begin(); connIt != connections.end();)
+  {
+    if (!_addr.empty() && connIt->first != _addr)
+    {
+      ++connIt;
+      continue;
+    }
+
+    connIt->second.topics.erase(_topic);
+    if (!connIt->second.topics.empty())
+    {
+      ++connIt;
+      continue;
+    }
+
+    try
+    {
+      socket.disconnect(connIt->second.endpoint.c_str());
+    }
+    catch(const zmq::error_t &)
+    {
+      // The connection has already been closed.
+    }
+    connIt = connections.erase(connIt);
+  }
+}
+
+//////////////////////////////////////////////////
+bool NodeSharedPrivate::StartBackend(const std::string &_pUuid)
 {
-  using HandlerTPtr = std::shared_ptr<HandlerT>;
-  std::map<std::string, std::map<std::string, HandlerTPtr>> handlers;
+  if (this->backendStarted)
+    return true;
 
-  _handlerStorage.Handlers(_fullyQualifiedTopic, handlers);
-  for (const auto &collection : handlers)
+  if (!this->backend->Start(_pUuid, *this->backendListener))
   {
-    for (const auto &collectionEntry : collection.second)
-    {
-      const HandlerTPtr &handler = collectionEntry.second;
-      const std::string &handlerMsgType = handler->TypeName();
-      if (handlerMsgType == _msgTypeName
-          || handlerMsgType == kGenericMessageType)
-      {
-        _uuids.push_back(handler->NodeUuid());
-      }
-    }
+    std::cerr << "Unable to start the data-plane backend" << std::endl;
+    std::cerr << "Gazebo Transport has not been correctly initialized"
+              << std::endl;
+    return false;
   }
+
+  this->backendStarted = true;
+  return true;
 }
 
 //////////////////////////////////////////////////
-std::vector<std::string> NodeShared::HandlerWrapper::NodeUuids(
-    const std::string &_fullyQualifiedTopic,
-    const std::string &_msgTypeName) const
+zmq::socket_t &NodeSharedPrivate::Subscriber(const std::size_t _shard)
 {
-  std::vector<std::string> uuids;
-  AppendNodeUuids(this->normal, _fullyQualifiedTopic, _msgTypeName, uuids);
-  AppendNodeUuids(this->raw, _fullyQualifiedTopic, _msgTypeName, uuids);
-
-  return uuids;
+  return _shard == 0 ? *this->subscriber : *this->subscriberShards[_shard - 1];
 }
 
 //////////////////////////////////////////////////
-bool NodeShared::HandlerWrapper::RemoveHandlersForNode(
-    const std::string &_fullyQualifiedTopic,
-    const std::string &_nUuid)
+std::size_t NodeSharedPrivate::SubscriberShard(const std::string &_topic) const
 {
-  bool removed = false;
-  removed |= this->normal.RemoveHandlersForNode(_fullyQualifiedTopic, _nUuid);
-  removed |= this->raw.RemoveHandlersForNode(_fullyQualifiedTopic, _nUuid);
-
-  return removed;
+  if (this->subscriberShards.empty())
+    return 0;
+  return std::hash<std::string>()(_topic) %
+    (this->subscriberShards.size() + 1);
 }
 
 //////////////////////////////////////////////////
-std::vector<MessagePublisher> NodeShared::HandlerWrapper::Convert(
-    const std::string &_addr, const std::string &_pUuid)
+void NodeSharedPrivate::RunShardReceptionTask(NodeShared &_shared,
+    const std::size_t _shard)
 {
-  std::vector<MessagePublisher> res;
+  configureThread("reception");
 
-  for (const auto &[topic, handlerCollection] : this->normal.AllHandlers())
+  Timestamp spinUntil = Timestamp::min();
+  while (!this->exit)
   {
-    for (const auto &[nUuid, handlerNode] : handlerCollection)
+    zmq::pollitem_t items[2] =
     {
-      for (const auto &[hUuid, handler] : handlerNode)
-      {
-        res.push_back(MessagePublisher(topic, _addr, "", _pUuid, nUuid,
-          handler->TypeName(), AdvertiseMessageOptions()));
-      }
+      {static_cast<void*>(this->Subscriber(_shard)), 0, ZMQ_POLLIN, 0}
+    };
+    std::size_t count = 1;
+    this->PollExitSocket(items, count);
+    try
+    {
+      this->Poll(&items[0], count, std::chrono::milliseconds(Timeout),
+        spinUntil);
     }
-  }
-
-  for (const auto &[topic, handlerCollection] : this->raw.AllHandlers())
-  {
-    for (const auto &[nUuid, handlerNode] : handlerCollection)
+    catch(...)
     {
-      for (const auto &[hUuid, handler] : handlerNode)
-      {
-        res.push_back(MessagePublisher(topic, _addr, "", _pUuid, nUuid,
-          handler->TypeName(), AdvertiseMessageOptions()));
-      }
+      continue;
     }
-  }
 
-  return res;
+    if (items[0].revents & ZMQ_POLLIN)
+      _shared.RecvMsgUpdate(_shard);
+  }
 }
 
 //////////////////////////////////////////////////
-void NodeSharedPrivate::SecurityOnNewConnection()
+std::string NodeSharedPrivate::IpcPath(const std::string &_pUuid,
+    const std::string &_socket)
 {
-  std::string user, pass;
-
-  // Set username and pass if they exist
-  // \todo(anyone): This will cause the subscriber to connect only to secure
-  // connections. Would be nice if the subscriber could still connect to
-  // unsecure connections. This might require an unsecure and secure
-  // subscriber.
-  // See issue #74
-  if (userPass(user, pass))
+  // The process UUID might be received from the network, it names a file.
+  if (_pUuid.empty() ||
+      _pUuid.find_first_not_of("0123456789abcdefABCDEF-") != std::string::npos)
   {
-#ifdef GZ_CPPZMQ_POST_4_7_0
-    this->subscriber->set(zmq::sockopt::plain_username, user);
-    this->subscriber->set(zmq::sockopt::plain_password, pass);
-#else
-    this->subscriber->setsockopt(ZMQ_PLAIN_USERNAME, user.c_str(), user.size());
-    this->subscriber->setsockopt(ZMQ_PLAIN_PASSWORD, pass.c_str(), pass.size());
-#endif
+    return "";
   }
+
+  return std::string(kIpcDir) + "gz-transport-" + _pUuid + "-" + _socket;
 }
 
 //////////////////////////////////////////////////
-void NodeSharedPrivate::SecurityInit()
+void NodeSharedPrivate::IpcInit(const std::string &_pUuid,
+    const bool _services)
 {
-  // Check if a username and password has been set. If so, then
-  // setup a PLAIN authentication server.
-  std::string user, pass;
-  if (userPass(user, pass))
+  std::string ipcEnv;
+  if (!env("GZ_TRANSPORT_IPC", ipcEnv) || ipcEnv != "1")
+    return;
+
+#ifndef _WIN32
+  try
   {
-    // Create the access control thread.
-    this->accessControlThread = std::thread(
-        &NodeSharedPrivate::AccessControlHandler, this);
+    if (!_services)
+    {
+      this->publisher->bind(("ipc://" + IpcPath(_pUuid, "pub")).c_str());
+      return;
+    }
 
-    int asPlainSecurityServer = static_cast<int>(
-        ZmqPlainSecurityServerOptions::ZMQ_PLAIN_SECURITY_SERVER_ENABLED);
+    this->replier->bind(("ipc://" + IpcPath(_pUuid, "rep")).c_str());
 
-#ifdef GZ_CPPZMQ_POST_4_7_0
-    this->publisher->set(zmq::sockopt::plain_server, asPlainSecurityServer);
-    this->publisher->set(zmq::sockopt::zap_domain, kGzAuthDomain);
+    const std::string requesterAddr = "ipc://" + IpcPath(_pUuid, "res");
+    this->responseReceiver->bind(requesterAddr.c_str());
+    this->ipcRequesterAddress = requesterAddr;
+  }
+  catch(const zmq::error_t &_error)
+  {
+    std::cerr << "Unable to bind the IPC endpoints: " << _error.what()
+              << ". Using TCP for the processes in this host." << std::endl;
+  }
 #else
-    this->publisher->setsockopt(ZMQ_PLAIN_SERVER,
-        &asPlainSecurityServer, sizeof(asPlainSecurityServer));
-    this->publisher->setsockopt(ZMQ_ZAP_DOMAIN, kGzAuthDomain,
-        std::strlen(kGzAuthDomain));
+  (void)_pUuid;
+  if (_services)
+    return;
+  std::cerr << "GZ_TRANSPORT_IPC is not supported on Windows. "
+            << "Using TCP for the processes in this host." << std::endl;
 #endif
-  }
 }
 
 //////////////////////////////////////////////////
-// Access control handler for plain security.
-// This function is designed to be run in a thread.
-void NodeSharedPrivate::AccessControlHandler()
+bool NodeSharedPrivate::IpcConnect(zmq::socket_t &_socket,
+    const std::string &_pUuid, const std::string &_name)
 {
-  zmq::socket_t *sock = new zmq::socket_t(*this->context, ZMQ_REP);
+#ifndef _WIN32
+  // The other process is in this host and it has bound the endpoint if the
+  // socket can be found.
+  const std::string path = IpcPath(_pUuid, _name);
+  struct stat st;
+  if (path.empty() || stat(path.c_str(), &st) != 0 || !S_ISSOCK(st.st_mode))
+    return false;
 
   try
   {
-    // Bind to the zap address
-    sock->bind("inproc://zeromq.zap.01");
-
-    // Get the username and password
-    std::string user, pass;
-    if (!userPass(user, pass))
-    {
-      std::cerr << "Username and password not set. "
-                << "Authentication is disabled\n";
-      sock->close();
-      delete sock;
-      return;
-    }
-
-    std::string sequence;
-    std::string domain;
-    std::string address;
-    std::string routingId;
-    std::string mechanism;
-    std::string givenUsername;
-    std::string givenPassword;
-    std::string version;
-
-    zmq::pollitem_t items[] =
-    {
-      {static_cast<void*>(*sock), 0, ZMQ_POLLIN, 0},
-    };
-
-    // Process
-    while (!this->exit)
-    {
-      try
-      {
-        zmq::poll(&items[0], sizeof(items) / sizeof(items[0]),
-            std::chrono::milliseconds(NodeSharedPrivate::Timeout));
-      }
-      catch(...)
-      {
-        continue;
-      }
-
-      if (items[0].revents & ZMQ_POLLIN)
-      {
-        // Get the version.
-        version = receiveHelper(*sock);
-        if (version.empty())
-          break;
+    _socket.connect(("ipc://" + path).c_str());
+  }
+  catch(const zmq::error_t &)
+  {
+    return false;
+  }
+  return true;
+#else
+  (void)_socket;
+  (void)_pUuid;
+  (void)_name;
+  return false;
+#endif
+}
 
-        // Get remaining data
-        sequence = receiveHelper(*sock);
-        domain = receiveHelper(*sock);
-        address = receiveHelper(*sock);
-        routingId = receiveHelper(*sock);
-        mechanism = receiveHelper(*sock);
-        givenUsername = receiveHelper(*sock);
-        givenPassword = receiveHelper(*sock);
-
-        // eliminate unused variable warning when debug statements are commented
-        (void)routingId;
-
-        // Debug statements
-        // std::cout << "Version[" << version << "]\n";
-        // std::cout << "Sequence[" << sequence << "]\n";
-        // std::cout << "Domain[" << domain << "]\n";
-        // std::cout << "Address[" << address << "]\n";
-        // std::cout << "Routing Id[" << routingId << "]\n";
-        // std::cout << "Mechanism[" << mechanism << "]\n";
-        // std::cout << "Username[" << givenUsername << "] [" << user << "]\n";
-        // std::cout << "Pass[" << givenPassword << "] [" << pass << "]\n";
-
-        // Check that we received some kind of address. This could be used
-        // in the future to only accept connections from specific addresses.
-        if (address.empty())
-        {
-          sendAuthErrorHelper(*sock, "Invalid address");
-          continue;
-        }
+//////////////////////////////////////////////////
+std::string NodeSharedPrivate::ShmName(const std::string &_pUuid)
+{
+  return "gz-transport-" + _pUuid;
+}
 
-        // Check the version
-        if (version != "1.0")
-        {
-          sendAuthErrorHelper(*sock, "Invalid version");
-          continue;
-        }
+//////////////////////////////////////////////////
+void NodeSharedPrivate::ShmInit(const std::string &_pUuid, const int _sndHwm)
+{
+  std::string shmEnv;
+  if (!env("GZ_TRANSPORT_SHM", shmEnv) || shmEnv != "1")
+    return;
 
-        // Check the mechanism
-        if (mechanism != "PLAIN")
-        {
-          sendAuthErrorHelper(*sock, "Invalid mechanism");
-          continue;
-        }
+#ifdef __linux__
+  if (this->security.mechanism != SecurityOptions::Mechanism::NONE)
+  {
+    std::cerr << "GZ_TRANSPORT_SHM is not supported with authentication. "
+              << "Using TCP for all the subscribers." << std::endl;
+    return;
+  }
 
-        // Check the domain
-        if (std::strcmp(domain.c_str(), kGzAuthDomain) != 0)
-        {
-          sendAuthErrorHelper(*sock, "Invalid domain");
-          continue;
-        }
+  const int numSlots = this->NonNegativeEnvVar(
+    "GZ_TRANSPORT_SHM_SLOTS", kDefaultShmSlots);
+  const int slotSize = this->NonNegativeEnvVar(
+    "GZ_TRANSPORT_SHM_SLOT_SIZE", kDefaultShmSlotSize);
+  this->shmThreshold = static_cast<std::size_t>(this->NonNegativeEnvVar(
+    "GZ_TRANSPORT_SHM_THRESHOLD", kDefaultShmThreshold));
+
+  const std::string name = ShmName(_pUuid);
+  auto ring = std::make_unique<ShmRing>();
+  if (numSlots == 0 || slotSize == 0 ||
+      !ring->Create("/" + name, static_cast<uint32_t>(numSlots),
+        static_cast<uint64_t>(slotSize)))
+  {
+    std::cerr << "Unable to create the shared memory segment. "
+              << "Using TCP for all the subscribers." << std::endl;
+    return;
+  }
 
-#ifdef GZ_ZMQ_POST_4_3_1
-        sendHelper(*sock, version, zmq::send_flags::sndmore);
-        sendHelper(*sock, sequence, zmq::send_flags::sndmore);
+  try
+  {
+    auto socket = std::make_unique<zmq::socket_t>(*this->context, ZMQ_XPUB);
+    int lingerVal = 0;
+#ifdef GZ_CPPZMQ_POST_4_7_0
+    socket->set(zmq::sockopt::linger, lingerVal);
+    socket->set(zmq::sockopt::sndhwm, _sndHwm);
 #else
-        sendHelper(*sock, version, ZMQ_SNDMORE);
-        sendHelper(*sock, sequence, ZMQ_SNDMORE);
+    socket->setsockopt(ZMQ_LINGER, &lingerVal, sizeof(lingerVal));
+    socket->setsockopt(ZMQ_SNDHWM, &_sndHwm, sizeof(_sndHwm));
 #endif
+    socket->bind(("ipc://" + IpcPath(_pUuid, "shm")).c_str());
 
-        // Check the username and password
-        if (givenUsername == user && givenPassword == pass)
-        {
-#ifdef GZ_ZMQ_POST_4_3_1
-          sendHelper(*sock, "200", zmq::send_flags::sndmore);
-          sendHelper(*sock, "OK", zmq::send_flags::sndmore);
-          sendHelper(*sock, "anonymous", zmq::send_flags::sndmore);
-          sendHelper(*sock, "", zmq::send_flags::none);
+    this->shmRing = std::move(ring);
+    this->shmPublisher = std::move(socket);
+  }
+  catch(const zmq::error_t &_error)
+  {
+    std::cerr << "Unable to bind the shared memory socket: "
+              << _error.what() << ". Using TCP for all the subscribers."
+              << std::endl;
+  }
 #else
-          sendHelper(*sock, "200", ZMQ_SNDMORE);
-          sendHelper(*sock, "OK", ZMQ_SNDMORE);
-          sendHelper(*sock, "anonymous", ZMQ_SNDMORE);
-          sendHelper(*sock, "", 0);
+  (void)_pUuid;
+  (void)_sndHwm;
+  std::cerr << "GZ_TRANSPORT_SHM is only supported on Linux. "
+            << "Using TCP for all the subscribers." << std::endl;
 #endif
-        }
-        else
-        {
-          sendAuthErrorHelper(*sock, "Invalid username or password");
-        }
-      }
-    }
-  }
-  catch (...)
+}
+
+//////////////////////////////////////////////////
+bool NodeSharedPrivate::ShmConnect(const MessagePublisher &_pub,
+    zmq::socket_t &_socket)
+{
+  if (!this->shmPublisher)
+    return false;
+
+#ifdef __linux__
+  // The publisher is in this host and it uses shared memory if both its
+  // segment and its socket can be found. The process UUID is validated by
+  // IpcPath(), it names the segment too.
+  const std::string path = IpcPath(_pub.PUuid(), "shm");
+  struct stat st;
+  if (path.empty() || stat(path.c_str(), &st) != 0)
+    return false;
+
+  // The ring is shared by the subscriber sockets connected to the
+  // publisher.
+  if (this->shmConnections.find(_pub.Addr()) == this->shmConnections.end())
   {
-    // This catch can be triggered when ctrl-c is pressed and the context is
-    // deleted. Capture this case, and quit gracefully.
+    auto ring = std::make_unique<ShmRing>();
+    if (!ring->Open("/" + ShmName(_pub.PUuid())))
+      return false;
+    this->shmConnections[_pub.Addr()] = std::move(ring);
   }
 
-  sock->close();
-  delete sock;
+  _socket.connect(("ipc://" + path).c_str());
+  return true;
+#else
+  (void)_socket;
+  return false;
+#endif
 }
 
-/////////////////////////////////////////////////
-void NodeSharedPrivate::PublishThread()
+//////////////////////////////////////////////////
+void NodeSharedPrivate::ShmPublish(const std::string &_topic,
+    const zmq::message_t &_header, const char *_data,
+    const std::size_t _size, const PublicationMetadata *_meta,
+    const std::size_t _metaCount)
 {
-  // Loop until exits
-  while (!this->exit)
+  // Update the topics subscribed, they are received by the XPUB socket.
+  zmq::message_t msg;
+#ifdef GZ_ZMQ_POST_4_3_1
+  while (this->shmPublisher->recv(msg, zmq::recv_flags::dontwait))
+#else
+  while (this->shmPublisher->recv(&msg, ZMQ_DONTWAIT))
+#endif
   {
-    std::unique_ptr<PublishMsgDetails> msgDetails = nullptr;
-    // Lock the mutex, and acquire the next message to be published.
-    {
-      std::unique_lock<std::mutex> queueLock(this->pubThreadMutex);
-
-      // Wait for more messages if the queue is empty. Otherwise get the
-      // next message and continue.
-      if (this->pubQueue.empty())
-      {
-        auto now = std::chrono::system_clock::now();
-        this->signalNewPub.wait_until(queueLock, now + 500ms,
-          [&]{return !this->pubQueue.empty() || this->exit;});
-      }
+    if (msg.size() < 1)
+      continue;
 
-      if (this->pubQueue.empty())
-        continue;
+    // The subscriptions end with the terminator of the topic frames.
+    const char *sub = static_cast<const char *>(msg.data());
+    std::size_t size = msg.size() - 1;
+    if (size > 0 && sub[size] == '\0')
+      --size;
+    const std::string topic(sub + 1, size);
+    if (sub[0] == 1)
+      this->shmSubscriptions.insert(topic);
+    else
+      this->shmSubscriptions.erase(topic);
+  }
 
-      // Stop early on exit.
-      if (this->exit)
-        break;
+  // Nobody in this host is interested, don't copy the message.
+  if (this->shmSubscriptions.find(_topic) == this->shmSubscriptions.end())
+    return;
 
-      // Get the message
-      msgDetails = std::move(this->pubQueue.front());
-      this->pubQueue.pop_front();
-    }
+  ShmSlotDescriptor desc;
+  const bool inShm = _size >= this->shmThreshold &&
+    this->shmRing->Write(_data, _size, desc);
 
-    // Send the message to all the local handlers.
-    for (auto &handler : msgDetails->localHandlers)
-    {
-      try
-      {
-        handler->RunLocalCallback(*(msgDetails->msgCopy.get()),
-            msgDetails->info);
-      }
-      catch (...)
-      {
-        std::cerr << "Exception occurred in a local callback "
-          << "on topic [" << msgDetails->info.Topic() << "] with message ["
-          << msgDetails->msgCopy->DebugString() << "]" << std::endl;
-      }
-    }
+  zmq::message_t msg0 = TopicFrame(_topic),
+                 msg1(_header.data(), _header.size()),
+                 msg2(&desc, sizeof(desc));
 
-    // Send the message to all the raw handlers.
-    for (auto &handler : msgDetails->rawHandlers)
-    {
-      try
-      {
-        handler->RunRawCallback(msgDetails->sharedBuffer.get(),
-            msgDetails->msgSize, msgDetails->info);
-      }
-      catch (...)
-      {
-        std::cerr << "Exception occured in a local raw callback "
-          << "on topic [" << msgDetails->info.Topic() << "] with "
-          << "message [" << msgDetails->msgCopy->DebugString() << "]"
-          << std::endl;
-      }
-    }
-  }
-}
+#ifdef GZ_ZMQ_POST_4_3_1
+  this->shmPublisher->send(msg0, zmq::send_flags::sndmore);
+  this->shmPublisher->send(msg1, zmq::send_flags::sndmore);
+#else
+  this->shmPublisher->send(msg0, ZMQ_SNDMORE);
+  this->shmPublisher->send(msg1, ZMQ_SNDMORE);
+#endif
 
-//////////////////////////////////////////////////
-std::optional<transport::TopicStatistics> NodeShared::TopicStats(
-    const std::string &_topic) const
-{
-  if (this->dataPtr->topicStats.find(_topic) != this->dataPtr->topicStats.end())
-    return this->dataPtr->topicStats.at(_topic);
-  return std::nullopt;
-}
+  // Small messages are cheaper to copy through the socket, and the big
+  // ones don't fit in a slot.
+  zmq::message_t payload;
+  if (!inShm)
+    payload.rebuild(_data, _size);
+  const bool last = _meta == nullptr;
 
-//////////////////////////////////////////////////
-void NodeShared::EnableStats(const std::string &_topic, bool _enable,
-    std::function<void(const TopicStatistics &_stats)> _statCb)
-{
-  if (_enable)
+#ifdef GZ_ZMQ_POST_4_3_1
+  this->shmPublisher->send(msg2, inShm && last ?
+    zmq::send_flags::none : zmq::send_flags::sndmore);
+  if (!inShm)
   {
-    this->dataPtr->enabledTopicStatistics.insert({_topic, _statCb});
+    this->shmPublisher->send(payload, last ?
+      zmq::send_flags::none : zmq::send_flags::sndmore);
   }
-  else
+#else
+  this->shmPublisher->send(msg2, inShm && last ? 0 : ZMQ_SNDMORE);
+  if (!inShm)
+    this->shmPublisher->send(payload, last ? 0 : ZMQ_SNDMORE);
+#endif
+
+  if (_meta)
   {
-    this->dataPtr->enabledTopicStatistics.extract(_topic);
-    // \todo Also cleanup topicStats.
+    zmq::message_t msg3(_meta, _metaCount * sizeof(*_meta));
+#ifdef GZ_ZMQ_POST_4_3_1
+    this->shmPublisher->send(msg3, zmq::send_flags::none);
+#else
+    this->shmPublisher->send(msg3, 0);
+#endif
   }
 }
 
@@ -20,15 +20,40 @@
 
 #include <zmq.hpp>
 
+#include <algorithm>
 #include <atomic>
-#include <list>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <random>
+#include <set>
+#include <shared_mutex>  //NOLINT
 #include <string>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "gz/transport/Discovery.hh"
 #include "gz/transport/Node.hh"
+#include "gz/transport/ServiceStatistics.hh"
+#include "gz/transport/TransportBackend.hh"
+
+#include "LockstepTracker.hh"
+#include "MpscQueue.hh"
+#include "ReplyCache.hh"
+#include "RequestTable.hh"
+#include "SecurityOptions.hh"
+#include "SendQueueMonitor.hh"
+#include "SerializedBuffer.hh"
+#include "ShmRing.hh"
+#include "TopicKey.hh"
+#include "Tracer.hh"
+#include "TransportMetrics.hh"
 
 namespace gz
 {
@@ -46,30 +71,280 @@ namespace gz
 
       /// \brief Sequence number, used to detect dropped messages.
       public: uint64_t seq = 0;
+
+      /// \brief Trace of the publication, or 0 if it is not traced (see
+      /// GZ_TRANSPORT_TRACE).
+      public: uint64_t traceId = 0;
+
+      /// \brief Span that published the message within the trace.
+      public: uint64_t spanId = 0;
+    };
+
+    /// \brief Sequence of a publication received from a reliable
+    /// publisher, see AdvertiseMessageOptions::SetReliable().
+    class ReliableSeq
+    {
+      /// \brief Identifier of the address of the publisher.
+      public: uint64_t sender = 0;
+
+      /// \brief Sequence number of the message.
+      public: uint64_t seq = 0;
+
+      /// \brief Number of messages missed before this one.
+      public: uint64_t gap = 0;
+    };
+
+    /// \brief Header of a fragment of a large publication, see
+    /// kHeaderFragment. The fragments of a message are sent in order.
+    class FragmentHeader
+    {
+      /// \brief Identifier of the message, unique for its publisher socket.
+      public: uint64_t id = 0;
+
+      /// \brief Size of the whole message.
+      public: uint64_t size = 0;
+
+      /// \brief Position of the fragment in the message.
+      public: uint64_t offset = 0;
+
+      /// \brief Number of fragments of the message. All of them but the
+      /// last one have the size of the first one.
+      public: uint64_t count = 0;
+    };
+
+    /// \brief Fragment of a publication received from a remote publisher.
+    class ReceivedFragment
+    {
+      /// \brief Identifier of the address of the publisher.
+      public: uint64_t sender = 0;
+
+      /// \brief Header of the fragment.
+      public: FragmentHeader header;
+    };
+
+    /// \brief Header of a message of the history of a topic, followed by
+    /// the type and the message, see NodeSharedPrivate::PackHistory().
+    class HistoryEntryHeader
+    {
+      /// \brief Sequence number of the message.
+      public: uint64_t seq = 0;
+
+      /// \brief Size of the message.
+      public: uint64_t size = 0;
+
+      /// \brief Flags of the PublicationHeader, for the codec of the
+      /// message.
+      public: uint32_t flags = 0;
+
+      /// \brief Size of the type name.
+      public: uint32_t typeSize = 0;
+    };
+
+    /// \brief Value of the optional frame flagging a batch of service
+    /// requests, sent after the response type.
+    static const char kSrvRequestBatch = 1;
+
+    /// \brief Value of the optional frame asking the responser to report
+    /// the queue and callback times of a service request. The responser
+    /// adds a frame after the result, starting with this value and followed
+    /// by both times (microseconds) separated by a space.
+    static const char kSrvRequestTiming = 2;
+
+    /// \brief Value of the optional frame announcing that the requester
+    /// caches the responses of the cacheable services (see
+    /// AdvertiseServiceOptions::SetCacheTtl()). The responser of such a
+    /// service adds a frame after the result, starting with this value and
+    /// followed by the time to live of the response (milliseconds).
+    static const char kSrvRequestCache = 3;
+
+    /// \brief Maximum size of the requests and responses cached by a
+    /// process, for each of the responser and requester caches (bytes).
+    static const uint64_t kReplyCacheBytes = 16 * 1024 * 1024;
+
+    /// \brief Header of a publication sent to the remote subscribers. The
+    /// address of the publisher and the type of the message are replaced by
+    /// their identifiers, see NodeSharedPrivate::HeaderId(). The subscribers
+    /// resolve them with the discovery information of the topic. The type is
+    /// only sent in full, following the header, when it differs from the
+    /// advertised types of the topic (e.g.: generic publishers). Both are
+    /// sent in full when the identifiers of the publishers of the topic
+    /// collide, see NodeSharedPrivate::UpdateFullHeaders().
+    class PublicationHeader
+    {
+      /// \brief Size of the serialized header (bytes).
+      public: static const std::size_t kSize = 28;
+
+      /// \brief Serialize the header. The integers are little endian.
+      /// \param[out] _data Buffer of kSize bytes.
+      public: void Serialize(char *_data) const;
+
+      /// \brief Parse a header serialized by Serialize().
+      /// \param[in] _data Buffer of kSize bytes.
+      public: void Parse(const char *_data);
+
+      /// \brief Identifier of the address of the publisher.
+      public: uint64_t sender = 0;
+
+      /// \brief Identifier of the type of the message.
+      public: uint64_t type = 0;
+
+      /// \brief Bitmask of kHeaderBatch, and codec of the payload in the
+      /// bits from kHeaderCodecShift.
+      public: uint32_t flags = 0;
+
+      /// \brief Size of the type name following the header, or 0.
+      public: uint32_t typeSize = 0;
+
+      /// \brief Size of the address of the publisher following the type
+      /// name, or 0.
+      public: uint32_t senderSize = 0;
     };
 
+    /// \brief The payload of the publication is a batch of messages.
+    static const uint32_t kHeaderBatch = 1;
+
+    /// \brief The publisher is reliable: the PublicationMetadata is always
+    /// sent and the subscribers report the gaps in its sequence numbers.
+    static const uint32_t kHeaderReliable = 2;
+
+    /// \brief The publisher keeps a history of the topic, the subscribers
+    /// can request the messages they have missed, see
+    /// NodeSharedPrivate::RequestHistory().
+    static const uint32_t kHeaderHistory = 4;
+
+    /// \brief The payload is a fragment of a large message, preceded by a
+    /// FragmentHeader frame. The PublicationMetadata is only sent with the
+    /// last fragment.
+    static const uint32_t kHeaderFragment = 8;
+
+    /// \brief Position of the codec (Compression_t) of a compressed payload
+    /// in the flags of the header. It takes 8 bits.
+    static const uint32_t kHeaderCodecShift = 8;
+
+    /// \brief Position of the priority of the publisher in the flags of the
+    /// header: 0 for Priority_t::NORMAL, 1 for CONTROL and 2 for BULK. It
+    /// takes 2 bits.
+    static const uint32_t kHeaderPriorityShift = 16;
+
+    /// \brief Bits of the priority in the flags of the header.
+    static const uint32_t kHeaderPriorityMask = 3u << kHeaderPriorityShift;
+
+    /// \brief Get the flags of the header encoding a priority.
+    /// \param[in] _priority The priority.
+    /// \return The flags.
+    inline uint32_t priorityFlags(const Priority_t _priority)
+    {
+      if (_priority == Priority_t::CONTROL)
+        return 1u << kHeaderPriorityShift;
+      if (_priority == Priority_t::BULK)
+        return 2u << kHeaderPriorityShift;
+      return 0;
+    }
+
+    /// \brief Get the priority encoded in the flags of a header.
+    /// \param[in] _flags The flags.
+    /// \return The priority.
+    inline Priority_t flagsPriority(const uint32_t _flags)
+    {
+      switch ((_flags & kHeaderPriorityMask) >> kHeaderPriorityShift)
+      {
+        case 1:
+          return Priority_t::CONTROL;
+        case 2:
+          return Priority_t::BULK;
+        default:
+          return Priority_t::NORMAL;
+      }
+    }
+
+    /// \brief Prefix of the control field of the topics advertised with a
+    /// publisher channel, followed by the name of the channel. The
+    /// subscribers receive these topics through the TCP endpoint of the
+    /// channel, see AdvertiseMessageOptions::SetChannel().
+    static const char kChannelCtrlPrefix[] = "channel:";
+
+    /// \brief Prefix of the name of the channels sending their messages to
+    /// a multicast group, followed by the group, see
+    /// AdvertiseMessageOptions::SetMulticastGroup().
+    static const char kMulticastChannelPrefix[] = "multicast:";
+
+    /// \brief Suffix of the control field of the topics delivering their
+    /// last messages to the late joiners, see
+    /// AdvertiseMessageOptions::SetHistoryDepth().
+    static const char kLatchedCtrlSuffix[] = ";latched";
+
+    /// \brief Separator ending the control field of the record of an alias,
+    /// followed by the fully qualified topic named by the alias, see
+    /// AdvertiseMessageOptions::AddAlias().
+    static const char kAliasCtrlSeparator[] = ";alias=";
+
+    /// \brief Get the topic named by an alias from the control field of a
+    /// publisher.
+    /// \param[in] _ctrl The control field.
+    /// \return The fully qualified topic, or an empty string if the record
+    /// isn't the one of an alias.
+    inline std::string ctrlAliasTarget(const std::string &_ctrl)
+    {
+      const std::size_t pos = _ctrl.find(kAliasCtrlSeparator);
+      if (pos == std::string::npos)
+        return "";
+      return _ctrl.substr(pos + sizeof(kAliasCtrlSeparator) - 1);
+    }
+
+    /// \brief Check whether the control field of a publisher flags a topic
+    /// delivering its last messages to the late joiners.
+    /// \param[in] _ctrl The control field.
+    /// \return True if the topic has a history depth.
+    inline bool ctrlLatched(const std::string &_ctrl)
+    {
+      // The suffix precedes the topic named by an alias.
+      const std::size_t end =
+        std::min(_ctrl.find(kAliasCtrlSeparator), _ctrl.size());
+      const std::size_t size = sizeof(kLatchedCtrlSuffix) - 1;
+      return end >= size &&
+        _ctrl.compare(end - size, size, kLatchedCtrlSuffix) == 0;
+    }
+
+    /// \brief Get the multicast group from the control field of a
+    /// publisher.
+    /// \param[in] _ctrl The control field.
+    /// \return The group, or an empty string if the topic isn't sent to a
+    /// multicast group.
+    inline std::string ctrlMulticastGroup(const std::string &_ctrl)
+    {
+      const std::string prefix =
+        std::string(kChannelCtrlPrefix) + kMulticastChannelPrefix;
+      if (_ctrl.rfind(prefix, 0) != 0)
+        return "";
+      return _ctrl.substr(prefix.size(),
+        _ctrl.find(';', prefix.size()) - prefix.size());
+    }
+
     //
     // Private data class for NodeShared.
     class NodeSharedPrivate
     {
       // Constructor
       public: NodeSharedPrivate() :
-                context(new zmq::context_t(1)),
-                publisher(new zmq::socket_t(*context, ZMQ_PUB)),
-                subscriber(new zmq::socket_t(*context, ZMQ_SUB)),
-                requester(new zmq::socket_t(*context, ZMQ_ROUTER)),
-                responseReceiver(new zmq::socket_t(*context, ZMQ_ROUTER)),
-                replier(new zmq::socket_t(*context, ZMQ_ROUTER))
+                context(CreateContext())
       {
       }
 
+      /// \brief Create the ZMQ context, with the number of I/O threads set
+      /// by GZ_TRANSPORT_ZMQ_IO_THREADS and the settings of the "zmq"
+      /// threads (see ThreadSettingsTable). They must be set before the
+      /// sockets are created.
+      /// \return The context.
+      public: static zmq::context_t *CreateContext();
+
       /// \brief Initialize security
       public: void SecurityInit();
 
       /// \brief Handle new secure connections
       public: void SecurityOnNewConnection();
 
-      /// \brief Access control handler for plain security.
+      /// \brief Access control handler answering the ZAP requests of the
+      /// publishers, see SecurityOptions.
       /// This function is designed to be run in a thread.
       public: void AccessControlHandler();
 
@@ -83,6 +358,231 @@ namespace gz
       public: int NonNegativeEnvVar(const std::string &_envVar,
                                     int _defaultValue) const;
 
+      /// \brief Receive a message from a remote publisher and update the
+      /// topic statistics. NodeShared::mutex must be locked by the caller.
+      /// The messages of the topics of other shards, received because a
+      /// subscription is a prefix of their topic, are discarded.
+      /// \param[in] _shard Index of the subscriber socket.
+      /// \param[out] _topic Topic of the message.
+      /// \param[out] _msgType Type of the message.
+      /// \param[out] _data Serialized message, or batch of messages. The
+      /// buffer holds the received ZMQ frame, the data is not copied.
+      /// \param[out] _flags Flags of the PublicationHeader: whether _data is
+      /// a batch of messages (see UnpackBatch()) or is compressed.
+      /// \param[out] _traces Spans that published the messages, one per
+      /// message of a batch. Only filled if the messages are traced.
+      /// \param[out] _reliable Sequence of the message if the flags contain
+      /// kHeaderReliable.
+      /// \param[out] _fragment Fragment received if the flags contain
+      /// kHeaderFragment, _data is then the fragment.
+      /// \return True on success.
+      public: bool RecvMsg(const std::size_t _shard,
+                           std::string &_topic, std::string &_msgType,
+                           SerializedBuffer &_data, uint32_t &_flags,
+                           std::vector<TraceContext> &_traces,
+                           ReliableSeq &_reliable,
+                           ReceivedFragment &_fragment);
+
+      /// \brief Add a fragment to the message being reassembled.
+      /// NodeShared::mutex must be locked by the caller.
+      /// \param[in] _topic Topic of the message.
+      /// \param[in] _fragment The fragment received.
+      /// \param[in] _data Data of the fragment.
+      /// \param[out] _msg The message, once its last fragment is added.
+      /// \return False if the fragment is discarded: a previous fragment of
+      /// the message was lost, the header is invalid or the message is
+      /// larger than maxMsgSize.
+      public: bool Reassemble(const std::string &_topic,
+                              const ReceivedFragment &_fragment,
+                              const SerializedBuffer &_data,
+                              SerializedBuffer &_msg);
+
+      /// \brief A large message being reassembled from its fragments.
+      public: struct PartialMsg
+      {
+        /// \brief The message, allocated with the first fragment.
+        public: SerializedBuffer data;
+
+        /// \brief Number of bytes received.
+        public: std::size_t received = 0;
+
+        /// \brief Size of the fragments, but the last one.
+        public: std::size_t fragmentSize = 0;
+
+        /// \brief When the last fragment was received.
+        public: Timestamp lastFragment;
+      };
+
+      /// \brief Discard the messages being reassembled from a publisher of
+      /// a topic. NodeShared::mutex must be locked by the caller.
+      /// \param[in] _topic Fully qualified topic.
+      /// \param[in] _addr Address of the publisher, or an empty string for
+      /// all of them.
+      public: void DropPartialMsgs(const std::string &_topic,
+                                   const std::string &_addr);
+
+      /// \brief Discard the messages being reassembled which haven't
+      /// received a fragment for kPartialMsgTimeout milliseconds.
+      /// NodeShared::mutex must be locked by the caller.
+      /// \param[in] _now Current time.
+      public: void ExpirePartialMsgs(const Timestamp &_now);
+
+      /// \brief The messages being reassembled. The key is the topic, the
+      /// identifier of the address of the publisher and the identifier of
+      /// the message. Protected by NodeShared::mutex.
+      public: std::map<std::tuple<std::string, uint64_t, uint64_t>,
+              PartialMsg> partialMsgs;
+
+      /// \brief Maximum number of messages of a publisher reassembled at
+      /// the same time on a topic. The oldest one is discarded, e.g. when
+      /// its last fragment was dropped.
+      public: static const std::size_t kMaxPartialMsgs = 4;
+
+      /// \brief Time (ms) after which a message being reassembled is
+      /// discarded if none of its fragments is received, e.g. when its
+      /// publisher has stopped.
+      public: static const int kPartialMsgTimeout = 5000;
+
+      /// \brief Next sequence number expected from the reliable publishers.
+      /// The first key is the topic and the second key is the identifier of
+      /// the address of the publisher. Protected by NodeShared::mutex.
+      public: std::unordered_map<std::string,
+              std::unordered_map<uint64_t, uint64_t>> reliableSeqs;
+
+      /// \brief Get the identifier of a string sent in a PublicationHeader.
+      /// This is the 64-bit FNV-1a hash of the string, which is the same in
+      /// all the processes.
+      /// \param[in] _str The string.
+      /// \return The identifier.
+      public: static uint64_t HeaderId(const std::string &_str);
+
+      /// \brief Resolve the identifiers of a PublicationHeader received.
+      /// The identifiers of the publishers connected are learned by
+      /// ConnectSubscriber(). The ones unknown are looked up in the discovery
+      /// information of the topic, at most once per polling timeout.
+      /// NodeShared::mutex must be locked by the caller.
+      /// \param[in] _topic Topic of the publication.
+      /// \param[in] _header The header.
+      /// \param[in, out] _sender Address of the publisher. If it was sent in
+      /// full it is kept.
+      /// \param[in, out] _msgType Type of the message. If it was sent in
+      /// full it is kept.
+      /// \return True on success or false if an identifier is unknown or
+      /// is shared by several publishers of the topic.
+      public: bool ResolveHeader(const std::string &_topic,
+                                 const PublicationHeader &_header,
+                                 std::string &_sender,
+                                 std::string &_msgType);
+
+      /// \brief Identifiers of the PublicationHeader of a topic received.
+      public: struct HeaderIds
+      {
+        /// \brief Addresses of the publishers. The key is the identifier.
+        public: std::unordered_map<uint64_t, std::string> senders;
+
+        /// \brief Types of the publishers. The key is the identifier.
+        public: std::unordered_map<uint64_t, std::string> types;
+
+        /// \brief Identifiers of several addresses, which can't be
+        /// resolved.
+        public: std::unordered_set<uint64_t> senderCollisions;
+
+        /// \brief Identifiers of several types, which can't be resolved.
+        public: std::unordered_set<uint64_t> typeCollisions;
+
+        /// \brief Last time the discovery information was looked up.
+        public: Timestamp lastScan;
+      };
+
+      /// \brief Record the identifiers of a publisher.
+      /// NodeShared::mutex must be locked by the caller.
+      /// \param[in] _topic Topic of the publications received.
+      /// \param[in] _pub The publisher.
+      public: void LearnHeaderIds(const std::string &_topic,
+                                  const MessagePublisher &_pub);
+
+      /// \brief Forget the identifiers of a publisher, or of a topic.
+      /// NodeShared::mutex must be locked by the caller.
+      /// \param[in] _topic Topic of the publications received.
+      /// \param[in] _addr Address of the publisher, or an empty string for
+      /// all of them.
+      public: void ForgetHeaderIds(const std::string &_topic,
+                                   const std::string &_addr);
+
+      /// \brief Identifiers of the publications received. The key is the
+      /// topic. Protected by NodeShared::mutex.
+      public: std::unordered_map<std::string, HeaderIds> headerIds;
+
+      /// \brief Discard the remaining frames of a message received by a
+      /// subscriber socket.
+      /// \param[in] _socket The subscriber socket.
+      /// \param[in, out] _msg The last frame received.
+      public: void DiscardFrames(zmq::socket_t &_socket,
+                                 zmq::message_t &_msg);
+
+      /// \brief Check, without blocking, whether a message from a remote
+      /// publisher is ready to be received.
+      /// \param[in] _shard Index of the subscriber socket.
+      /// \return True if a message is pending.
+      public: bool MsgUpdatePending(const std::size_t _shard);
+
+      /// \brief Build the first frame of a publication: the topic followed
+      /// by a NUL character. A ZMQ subscription matches a prefix of the
+      /// frame, the terminator makes it match the topic exactly, so a
+      /// subscription to "/a/b" doesn't receive "/a/bc".
+      /// \param[in] _topic Fully qualified topic.
+      /// \return The frame.
+      public: static zmq::message_t TopicFrame(const std::string &_topic);
+
+      /// \brief Get the subscription filter of a topic, see TopicFrame().
+      /// \param[in] _topic Fully qualified topic.
+      /// \return The filter.
+      public: static std::string TopicFilter(const std::string &_topic);
+
+      /// \brief Connect the subscriber socket of a topic to a publisher,
+      /// unless it's already connected, and subscribe to the topic.
+      /// NodeShared::mutex must be locked by the caller.
+      /// \param[in] _pub The publisher.
+      /// \param[in] _hostAddr IP address of this host.
+      public: void ConnectSubscriber(const MessagePublisher &_pub,
+                                     const std::string &_hostAddr);
+
+      /// \brief Stop receiving a topic from a publisher, or from all of
+      /// them. The subscriber socket disconnects from the publishers and
+      /// the multicast groups left without topics. NodeShared::mutex must
+      /// be locked by the caller.
+      /// \param[in] _topic Fully qualified topic.
+      /// \param[in] _addr Address of the publisher, or an empty string for
+      /// all of them, which also removes the subscription to the topic.
+      public: void DisconnectSubscriber(const std::string &_topic,
+                                        const std::string &_addr);
+
+      /// \brief Start the data-plane backend, unless it's already started.
+      /// socketsMutex must be locked by the caller.
+      /// \param[in] _pUuid UUID of the process.
+      /// \return True if the backend is started.
+      public: bool StartBackend(const std::string &_pUuid);
+
+      /// \brief Get a subscriber socket.
+      /// \param[in] _shard Index of the socket, 0 for the subscriber socket
+      /// polled by NodeShared::RunReceptionTask().
+      /// \return The socket.
+      public: zmq::socket_t &Subscriber(const std::size_t _shard);
+
+      /// \brief Get the subscriber socket receiving a topic. A topic is
+      /// always received by the same socket, so its messages keep their
+      /// order.
+      /// \param[in] _topic Fully qualified topic.
+      /// \return Index of the socket.
+      public: std::size_t SubscriberShard(const std::string &_topic) const;
+
+      /// \brief Receive the topic updates of an additional subscriber
+      /// socket until the node exits.
+      /// \param[in] _shared The NodeShared instance.
+      /// \param[in] _shard Index of the socket.
+      public: void RunShardReceptionTask(NodeShared &_shared,
+                                         const std::size_t _shard);
+
       //////////////////////////////////////////////////
       ///////    Declare here the ZMQ Context    ///////
       //////////////////////////////////////////////////
@@ -95,12 +595,56 @@ namespace gz
       ///////     Declare here all ZMQ sockets   ///////
       //////////////////////////////////////////////////
 
+      // The sockets of the topics are created by
+      // NodeShared::InitializeTopicSockets() and the ones of the services by
+      // NodeShared::InitializeServiceSockets(), on first use with
+      // GZ_TRANSPORT_LAZY_SOCKETS=1.
+
+      /// \brief Create the sockets on first use, see
+      /// GZ_TRANSPORT_LAZY_SOCKETS.
+      public: bool lazySockets = false;
+
+      /// \brief Serialize the initialization of the sockets.
+      public: std::mutex socketsMutex;
+
+      /// \brief True once the sockets of the topics are initialized.
+      public: std::atomic<bool> topicSocketsReady = false;
+
+      /// \brief True once the sockets of the services are initialized.
+      public: std::atomic<bool> srvSocketsReady = false;
+
+      /// \brief True if the initialization of the sockets of the topics
+      /// failed, it isn't retried. Protected by socketsMutex.
+      public: bool topicSocketsFailed = false;
+
+      /// \brief True if the initialization of the sockets of the services
+      /// failed, it isn't retried. Protected by socketsMutex.
+      public: bool srvSocketsFailed = false;
+
+      /// \brief Receives the data of the backend.
+      public: std::unique_ptr<TransportBackendListener> backendListener;
+
+      /// \brief Data-plane backend used instead of the ZMQ sockets of the
+      /// topics and of the services, see GZ_TRANSPORT_BACKEND. Null for the
+      /// ZMQ sockets. Only set by the constructor of NodeShared.
+      public: std::unique_ptr<TransportBackend> backend;
+
+      /// \brief True once the backend is started. Protected by
+      /// socketsMutex.
+      public: bool backendStarted = false;
+
       /// \brief ZMQ socket to send topic updates.
       public: std::unique_ptr<zmq::socket_t> publisher;
 
       /// \brief ZMQ socket to receive topic updates.
       public: std::unique_ptr<zmq::socket_t> subscriber;
 
+      /// \brief Additional ZMQ sockets to receive topic updates, each one
+      /// drained by its own thread, see GZ_TRANSPORT_RECEPTION_THREADS. The
+      /// topics are spread over the subscriber sockets by SubscriberShard().
+      /// The element i is the socket of the shard i + 1.
+      public: std::vector<std::unique_ptr<zmq::socket_t>> subscriberShards;
+
       /// \brief ZMQ socket for sending service call requests.
       public: std::unique_ptr<zmq::socket_t> requester;
 
@@ -110,9 +654,31 @@ namespace gz
       /// \brief ZMQ socket to receive service call requests.
       public: std::unique_ptr<zmq::socket_t> replier;
 
+      /// \brief Inproc socket used by the service threads to wake up the
+      /// reception thread when responses are ready, or when a request
+      /// expires before the end of its poll. Protected by wakeMutex.
+      public: std::unique_ptr<zmq::socket_t> srvWakeSender;
+
+      /// \brief Protect srvWakeSender.
+      public: std::mutex wakeMutex;
+
+      /// \brief Inproc socket polled by the reception thread, connected to
+      /// srvWakeSender.
+      public: std::unique_ptr<zmq::socket_t> srvWakeReceiver;
+
+      /// \brief ZMQ socket to send topic updates to the subscribers in this
+      /// host through shared memory, or nullptr if shared memory is
+      /// disabled. It is a XPUB socket, so the topics subscribed are known
+      /// before copying a message to shared memory.
+      public: std::unique_ptr<zmq::socket_t> shmPublisher;
+
       /// \brief Thread the handle access control
       public: std::thread accessControlThread;
 
+      /// \brief Authentication of the subscribers, read from the
+      /// environment once.
+      public: const SecurityOptions security = SecurityOptions::FromEnv();
+
       //////////////////////////////////////////////////
       /////// Declare here the discovery object  ///////
       //////////////////////////////////////////////////
@@ -127,22 +693,361 @@ namespace gz
       /////// Other private member variables     ///////
       //////////////////////////////////////////////////
 
-      /// \brief When true, the reception thread will finish.
+      /// \brief Threads receiving the topic updates of subscriberShards.
+      public: std::vector<std::thread> receptionThreads;
+
+      /// \brief A connection of a subscriber socket to a publisher or a
+      /// multicast group.
+      public: struct SubscriberConnection
+      {
+        /// \brief Endpoint the socket is connected to.
+        std::string endpoint;
+
+        /// \brief Topics received through the connection.
+        std::unordered_set<std::string> topics;
+      };
+
+      /// \brief Connections of each subscriber socket, indexed by shard.
+      /// The key is the address of the publisher, or "epgm:<group>" for a
+      /// multicast group. Protected by NodeShared::mutex.
+      public: std::vector<std::unordered_map<std::string,
+              SubscriberConnection>> subscriberConnections;
+
+      /// \brief Topics subscribed on their subscriber socket. ZMQ counts
+      /// the subscriptions, a topic is only subscribed once. Protected by
+      /// NodeShared::mutex.
+      public: std::unordered_set<std::string> subscriptions;
+
+      /// \brief When true, the reception threads will finish.
       public: std::atomic<bool> exit = false;
 
-      /// \brief Timeout used for receiving messages (ms.).
+      /// \brief Pending service call requests. Protected by
+      /// NodeShared::mutex.
+      public: RequestTable requests;
+
+      /// \brief When the reception thread wakes up next, to expire the
+      /// requests. A request with an earlier deadline wakes it up before.
+      /// Protected by NodeShared::mutex.
+      public: Timestamp receptionWake = Timestamp::min();
+
+      /// \brief Deadline of the non-blocking requests made without a
+      /// timeout, zero for none (see GZ_TRANSPORT_REQUEST_TIMEOUT).
+      public: std::chrono::milliseconds requestTimeout{0};
+
+      /// \brief Create the inproc pair waking up the reception thread.
+      /// Throws zmq::error_t on failure.
+      public: void InitWakeSockets();
+
+      /// \brief Wake up the reception thread, see srvWakeSender.
+      public: void WakeReception();
+
+      /// \brief Notify the result of a request, see
+      /// IReqHandler::NotifyResult(). The callback runs on the executor of
+      /// the request if it has one, on the calling thread otherwise.
+      /// \param[in] _handler The request.
+      /// \param[in] _rep Serialized response.
+      /// \param[in] _result Result of the service call.
+      public: static void NotifyRequest(const IReqHandlerPtr &_handler,
+                                        const std::string &_rep,
+                                        const bool _result);
+
+      /// \brief Abandon a request, see IReqHandler::Expire(), on the
+      /// executor of the request if it has one.
+      /// \param[in] _handler The request.
+      public: static void ExpireRequest(const IReqHandlerPtr &_handler);
+
+      /// \brief Remove the requests sent to a responser that is gone.
+      /// NodeShared::mutex must be locked by the caller.
+      /// \param[in] _pub The responser. When its topic is empty, the
+      /// requests sent to all the services of its process are removed.
+      /// \param[out] _abandoned The requests removed, to be abandoned
+      /// without the lock.
+      public: void TakeSrvRequests(const ServicePublisher &_pub,
+                                   std::vector<IReqHandlerPtr> &_abandoned);
+
+      /// \brief A responser of a service that the requester socket is
+      /// connected to.
+      public: struct SrvRoute
+      {
+        /// \brief UUID of the responser's process.
+        std::string pUuid;
+
+        /// \brief Address of the responser.
+        std::string addr;
+
+        /// \brief ZMQ identity of the responser's socket.
+        std::string socketId;
+
+        /// \brief Type of the service requests.
+        std::string reqType;
+
+        /// \brief Type of the service responses.
+        std::string repType;
+
+        /// \brief Number of requests sent and waiting for a response.
+        uint32_t outstanding = 0;
+
+        /// \brief Moving average of the response time (ms), zero until the
+        /// first response.
+        double latency = 0;
+
+        /// \brief True if the responser uses the previous wire protocol,
+        /// which doesn't understand the flags of the requests.
+        bool legacy = false;
+      };
+
+      /// \brief A request sent to a responser, waiting for a response.
+      public: struct SrvInflight
+      {
+        /// \brief Service name.
+        std::string topic;
+
+        /// \brief UUID of the responser's process.
+        std::string pUuid;
+
+        /// \brief When the request was sent.
+        Timestamp sent;
+      };
+
+      /// \brief Choose a responser of a service ready to receive requests.
+      /// \param[in] _topic Service name.
+      /// \param[in] _reqType Type of the request.
+      /// \param[in] _repType Type of the response.
+      /// \param[in] _policy How the responser is chosen when there are
+      /// several.
+      /// \return The responser or nullptr if none was found. The pointer is
+      /// invalidated by the next change to srvRoutes.
+      public: SrvRoute *SelectSrvRoute(const std::string &_topic,
+                                       const std::string &_reqType,
+                                       const std::string &_repType,
+                                       const LoadBalancing_t _policy);
+
+      /// \brief Count a request sent to a responser.
+      /// \param[in] _reqUuid UUID of the request handler.
+      /// \param[in] _topic Service name.
+      /// \param[in] _route The responser.
+      public: void TrackSrvRequest(const std::string &_reqUuid,
+                                   const std::string &_topic,
+                                   SrvRoute &_route);
+
+      /// \brief Stop counting a request sent to a responser.
+      /// \param[in] _reqUuid UUID of the request handler.
+      /// \param[in] _replied True if the response was received, in which
+      /// case the response time of the responser is updated.
+      /// \param[in] _timing Times reported by the responser (see
+      /// kSrvRequestTiming), without the leading flag. Empty if none.
+      public: void UntrackSrvRequest(const std::string &_reqUuid,
+                                     const bool _replied,
+                                     const std::string &_timing = "");
+
+      /// \brief Store a responser connected and notify srvRoutesCondition.
+      /// \param[in] _pub The responser.
+      public: void AddSrvRoute(const ServicePublisher &_pub);
+
+      /// \brief Remove the responsers of a process.
+      /// \param[in] _pub The responser gone. When its topic is empty, all the
+      /// services of its process are removed.
+      public: void RemoveSrvRoutes(const ServicePublisher &_pub);
+
+      /// \brief Responsers that the requester socket is connected to, so
+      /// the requests are sent without looking up the discovery information.
+      /// The key is the service name. Protected by NodeShared::mutex.
+      public: std::unordered_map<std::string, std::vector<SrvRoute>>
+        srvRoutes;
+
+      /// \brief Notified when a responser is added to srvRoutes. Used with
+      /// NodeShared::mutex.
+      public: std::condition_variable_any srvRoutesCondition;
+
+      /// \brief Index of the next responser of each service used by
+      /// LoadBalancing_t::ROUND_ROBIN. The key is the service name. Protected
+      /// by NodeShared::mutex.
+      public: std::unordered_map<std::string, std::size_t> srvNextRoute;
+
+      /// \brief Requests sent and waiting for a response. The key is the
+      /// request handler UUID. Protected by NodeShared::mutex.
+      public: std::unordered_map<std::string, SrvInflight> srvInflight;
+
+      /// \brief Random generator used by LoadBalancing_t::LATENCY_WEIGHTED.
+      /// Protected by NodeShared::mutex.
+      public: std::mt19937 srvRandom{std::random_device{}()};
+
+      /// \brief Timeout used for receiving messages (ms.). The threads
+      /// polling exitSocket notice the exit before.
       public: inline static const int Timeout = 250;
 
+      /// \brief Create exitSocket, bound to an ephemeral port in the
+      /// loopback interface.
+      public: void CreateExitSocket();
+
+      /// \brief Wake up the threads polling exitSocket. A datagram is sent
+      /// to it and never read, so it stays readable for all of them.
+      public: void SignalExit();
+
+      /// \brief Add exitSocket to the items polled by a thread.
+      /// \param[in, out] _items The items.
+      /// \param[in, out] _count Number of items, incremented if exitSocket
+      /// was added.
+      public: void PollExitSocket(zmq::pollitem_t *_items,
+                                  std::size_t &_count) const;
+
+      /// \brief Poll the items like zmq::poll(), without blocking while
+      /// busy polling: up to busyPoll after the last event.
+      /// \param[in, out] _items The items.
+      /// \param[in] _count Number of items.
+      /// \param[in] _timeout Timeout of the poll when not busy polling.
+      /// \param[in, out] _spinUntil End of the busy polling, extended by
+      /// the events.
+      public: void Poll(zmq::pollitem_t *_items, std::size_t _count,
+                        std::chrono::milliseconds _timeout,
+                        Timestamp &_spinUntil) const;
+
+      /// \brief Time spent polling the sockets and the publish queues
+      /// without blocking after a message, zero to always block (see
+      /// GZ_TRANSPORT_BUSY_POLL).
+      public: std::chrono::microseconds busyPoll{0};
+
+      /// \brief UDP socket polled by the reception and the access control
+      /// threads, so they exit without waiting for the timeout of their
+      /// poll. -1 if it couldn't be created.
+      public: int exitSocket = -1;
+
+      /// \brief Address of exitSocket.
+      public: sockaddr_in exitAddr;
+
+      /// \brief Maximum number of remote messages received at once when a
+      /// subscription is conflated.
+#ifdef GZ_TRANSPORT_EMBEDDED
+      public: inline static const std::size_t kMaxRecvBatch = 32;
+#else
+      public: inline static const std::size_t kMaxRecvBatch = 128;
+#endif
+
+      ////////////////////////////////////////////////////////////////
+      /////// The following is for the IPC endpoints used by    ///////
+      /////// the processes in the same host.                   ///////
+      ////////////////////////////////////////////////////////////////
+
+      /// \brief Directory of the IPC sockets.
+      public: inline static const char *kIpcDir = "/tmp/";
+
+      /// \brief Get the path of an IPC socket of a process. The path is
+      /// derived from the process UUID, so the processes in the same host
+      /// find the endpoints of each other without advertising them.
+      /// \param[in] _pUuid Process UUID.
+      /// \param[in] _socket Name of the socket: "pub", "rep", "res" or "shm".
+      /// \return The path or an empty string if _pUuid is not a valid UUID.
+      public: static std::string IpcPath(const std::string &_pUuid,
+                                         const std::string &_socket);
+
+      /// \brief Bind the publisher, or the replier and the response
+      /// receiver sockets, to IPC endpoints too if GZ_TRANSPORT_IPC is set
+      /// to 1. On failure, a message is printed and only TCP is used.
+      /// \param[in] _pUuid Process UUID.
+      /// \param[in] _services True to bind the sockets of the services,
+      /// false to bind the publisher.
+      public: void IpcInit(const std::string &_pUuid, const bool _services);
+
+      /// \brief Connect a socket to an IPC endpoint of another process.
+      /// This only succeeds if the process is in the same host and it has
+      /// bound the endpoint.
+      /// \param[in] _socket The socket to connect.
+      /// \param[in] _pUuid UUID of the other process.
+      /// \param[in] _name Name of the endpoint, see IpcPath().
+      /// \return True if the socket is connected through IPC.
+      public: bool IpcConnect(zmq::socket_t &_socket,
+                              const std::string &_pUuid,
+                              const std::string &_name);
+
+      /// \brief IPC address of the response receiver socket or an empty
+      /// string if IPC is disabled.
+      public: std::string ipcRequesterAddress;
+
+      /// \brief Addresses of the service repliers that the requester socket
+      /// is connected to through IPC. Protected by NodeShared::mutex.
+      public: std::unordered_set<std::string> ipcSrvConnections;
+
+      ////////////////////////////////////////////////////////////////
+      /////// The following is for the shared memory transport  ///////
+      /////// between processes in the same host.               ///////
+      ////////////////////////////////////////////////////////////////
+
+      /// \brief Default number of slots of the shared memory ring.
+      public: inline static const int kDefaultShmSlots = 16;
+
+      /// \brief Default capacity of a slot of the shared memory ring (bytes).
+      public: inline static const int kDefaultShmSlotSize = 4 * 1024 * 1024;
+
+      /// \brief Default minimum size of the messages stored in shared
+      /// memory (bytes). Smaller messages are sent through the socket.
+      public: inline static const int kDefaultShmThreshold = 64 * 1024;
+
+      /// \brief Get the name of the shared memory segment of a process.
+      /// \param[in] _pUuid Process UUID.
+      /// \return The name.
+      public: static std::string ShmName(const std::string &_pUuid);
+
+      /// \brief Create the shared memory ring and its socket if
+      /// GZ_TRANSPORT_SHM is set to 1. On failure, a message is printed and
+      /// all the subscribers use TCP.
+      /// \param[in] _pUuid Process UUID.
+      /// \param[in] _sndHwm Capacity of the socket send buffer.
+      public: void ShmInit(const std::string &_pUuid, const int _sndHwm);
+
+      /// \brief Connect to a publisher through shared memory. This only
+      /// succeeds if shared memory is enabled in both processes and they are
+      /// in the same host. NodeShared::mutex must be locked by the caller.
+      /// \param[in] _pub The publisher.
+      /// \param[in] _socket The subscriber socket to connect.
+      /// \return True if the subscriber socket is connected to the
+      /// publisher through shared memory.
+      public: bool ShmConnect(const MessagePublisher &_pub,
+                              zmq::socket_t &_socket);
+
+      /// \brief Send a message to the subscribers connected through shared
+      /// memory. Messages between the threshold and the slot size are
+      /// copied to the ring and only their descriptor is sent.
+      /// publisherMutex must be locked by the caller.
+      /// \param[in] _topic Topic.
+      /// \param[in] _header Header of the publication.
+      /// \param[in] _data Serialized message.
+      /// \param[in] _size Size of the message (bytes).
+      /// \param[in] _meta Metadata for the topic statistics or nullptr.
+      /// \param[in] _metaCount Number of elements of _meta.
+      public: void ShmPublish(const std::string &_topic,
+                              const zmq::message_t &_header,
+                              const char *_data,
+                              const std::size_t _size,
+                              const PublicationMetadata *_meta,
+                              const std::size_t _metaCount);
+
+      /// \brief Shared memory ring written by this process, or nullptr if
+      /// shared memory is disabled.
+      public: std::unique_ptr<ShmRing> shmRing;
+
+      /// \brief Minimum size of the messages stored in the ring (bytes).
+      public: std::size_t shmThreshold = kDefaultShmThreshold;
+
+      /// \brief Topics subscribed through shmPublisher. Protected by
+      /// publisherMutex.
+      public: std::unordered_set<std::string> shmSubscriptions;
+
+      /// \brief Rings of the publishers connected through shared memory.
+      /// The key is the address of the publisher. Protected by
+      /// NodeShared::mutex.
+      public: std::unordered_map<std::string, std::unique_ptr<ShmRing>>
+                shmConnections;
+
       ////////////////////////////////////////////////////////////////
       /////// The following is for asynchronous publication of ///////
       /////// messages to local subscribers.                    ///////
       ////////////////////////////////////////////////////////////////
 
       /// \brief Encapsulates information needed to publish a message. An
-      /// instance of this class is pushed onto a publish queue, pubQueue, when
-      /// a message is published through Node::Publisher::Publish.
-      /// The pubThread processes the pubQueue in the
-      /// NodeSharedPrivate::PublishThread function.
+      /// instance of this class is pushed onto a publish queue, see
+      /// PublishQueue, when a message is published through
+      /// Node::Publisher::Publish. The thread of each queue processes it in
+      /// the NodeSharedPrivate::PublishThread function.
       ///
       /// A producer-consumer mechanism is used to send messages so that
       /// Node::Publisher::Publish function does not block while executing
@@ -155,11 +1060,26 @@ namespace gz
                 /// \brief All the raw handlers.
                 public: std::vector<RawSubscriptionHandlerPtr> rawHandlers;
 
-                /// \brief Buffer for the raw handlers.
-                public: std::unique_ptr<char[]> sharedBuffer = nullptr;
+                /// \brief Queue slot reserved in each local handler, see
+                /// SubscriptionHandlerBase::ReserveQueueSlot().
+                public: std::vector<uint64_t> localSeqs;
 
-                /// \brief Msg copy for the local handlers.
-                public: std::unique_ptr<ProtoMsg> msgCopy = nullptr;
+                /// \brief Queue slot reserved in each raw handler.
+                public: std::vector<uint64_t> rawSeqs;
+
+                /// \brief Serialized message for the raw handlers. The
+                /// buffer may be shared with the ZMQ socket.
+                public: SerializedBuffer sharedBuffer;
+
+                /// \brief Msg for the local handlers. This is either a copy
+                /// of the published message or, when publishing by shared
+                /// ownership, the very same object handed over by the caller.
+                public: std::shared_ptr<const ProtoMsg> msgCopy = nullptr;
+
+                /// \brief Handler deserializing sharedBuffer into msgCopy
+                /// before running the local callbacks, when the parse of a
+                /// received message is left to the dispatch thread.
+                public: ISubscriptionHandlerPtr parser = nullptr;
 
                 /// \brief Message size.
                 // cppcheck-suppress unusedStructMember
@@ -167,38 +1087,1494 @@ namespace gz
 
                 /// \brief Information about the topic and type.
                 public: MessageInfo info;
+
+                /// \brief When the message was queued. Only set if the
+                /// metrics or the traces are enabled, for the dispatch
+                /// latency.
+                public: Timestamp enqueued;
+
+                /// \brief Span that published or received the message.
+                /// Only set if the traces are enabled.
+                public: TraceContext trace;
+
+                /// \brief Priority of the publisher, which selects the ring
+                /// of the publish queue.
+                public: Priority_t priority = Priority_t::NORMAL;
+
+                /// \brief Token of the delivery if the topic is in
+                /// lockstep, see LockstepTracker. It is released once the
+                /// callbacks have run.
+                public: std::shared_ptr<void> lockstep;
               };
 
-      /// \brief Publish thread used to process the pubQueue.
-      public: std::thread pubThread;
+      /// \brief A queue of publications processed by a dedicated thread.
+      /// All the publications of a topic are pushed onto the same queue, which
+      /// preserves the order of the callbacks within a topic, while a slow
+      /// callback only delays the topics sharing its queue.
+      ///
+      /// Publishers push onto a bounded lock-free ring, so publishing from
+      /// many threads does not serialize on a mutex. The mutex and condition
+      /// variable are only used to wake up the thread when it is sleeping.
+      /// There is one ring per priority, the CONTROL messages are dispatched
+      /// first and the BULK messages last.
+      public: struct PublishQueue
+              {
+                /// \brief Constructor.
+                public: PublishQueue()
+                  : queue(kPublishQueueCapacity),
+                    controlQueue(kPublishQueueCapacity),
+                    bulkQueue(kPublishQueueCapacity)
+                {
+                }
+
+                /// \brief Get the ring of a priority.
+                /// \param[in] _priority The priority.
+                /// \return The ring.
+                public: MpscQueue<std::unique_ptr<PublishMsgDetails>> &Ring(
+                  const Priority_t _priority)
+                {
+                  if (_priority == Priority_t::CONTROL)
+                    return this->controlQueue;
+                  if (_priority == Priority_t::BULK)
+                    return this->bulkQueue;
+                  return this->queue;
+                }
+
+                /// \brief Pop the next message, in order of priority.
+                /// \param[out] _details The message.
+                /// \return False if all the rings are empty.
+                public: bool TryPop(
+                            std::unique_ptr<PublishMsgDetails> &_details)
+                {
+                  return this->controlQueue.TryPop(_details) ||
+                         this->queue.TryPop(_details) ||
+                         this->bulkQueue.TryPop(_details);
+                }
+
+                /// \brief Check whether all the rings are empty.
+                /// \return True if there is no message.
+                public: bool Empty() const
+                {
+                  return this->controlQueue.Empty() && this->queue.Empty() &&
+                         this->bulkQueue.Empty();
+                }
+
+                /// \brief Thread used to process the queue.
+                public: std::thread thread;
+
+                /// \brief Ring onto which new messages are pushed. The thread
+                /// will pop off the messages and send them to local
+                /// subscribers.
+                public: MpscQueue<std::unique_ptr<PublishMsgDetails>> queue;
+
+                /// \brief Ring of the CONTROL messages.
+                public: MpscQueue<std::unique_ptr<PublishMsgDetails>>
+                  controlQueue;
 
-      /// \brief Mutex to protect the pubThread and pubQueue.
-      public: std::mutex pubThreadMutex;
+                /// \brief Ring of the BULK messages.
+                public: MpscQueue<std::unique_ptr<PublishMsgDetails>>
+                  bulkQueue;
 
-      /// \brief List onto which new messages are pushed. The pubThread
-      /// will pop off the messages and send them to local subscribers.
-      public: std::list<std::unique_ptr<PublishMsgDetails>> pubQueue;
+                /// \brief True while the thread is waiting for new messages.
+                public: std::atomic<bool> sleeping{false};
 
-      /// \brief used to signal when new work is available
-      public: std::condition_variable signalNewPub;
+                /// \brief Mutex used along with signalNewPub.
+                public: std::mutex mutex;
+
+                /// \brief used to signal when new work is available
+                public: std::condition_variable signalNewPub;
+
+                /// \brief Number of publishers waiting for room in a full
+                /// ring.
+                public: std::atomic<int> waitingPublishers{0};
+
+                /// \brief Used to signal the waiting publishers when the
+                /// thread makes room.
+                public: std::condition_variable signalRoom;
+
+                /// \brief Number of messages in the queue. Only updated if
+                /// the metrics are enabled.
+                public: std::atomic<int64_t> depth{0};
+              };
+
+      /// \brief Capacity of each publish queue. The publications are dropped
+      /// when the queue is full, see EnqueuePublication().
+#ifdef GZ_TRANSPORT_EMBEDDED
+      public: inline static const std::size_t kPublishQueueCapacity = 256;
+#else
+      public: inline static const std::size_t kPublishQueueCapacity = 4096;
+#endif
 
-      /// \brief Handles local publication of messages on the pubQueue.
-      public: void PublishThread();
+      /// \brief Start the threads processing the publish queues.
+      /// \param[in] _numThreads Number of threads (and queues).
+      public: void StartPublishThreads(const std::size_t _numThreads);
+
+      /// \brief Stop and join the threads processing the publish queues.
+      public: void StopPublishThreads();
+
+      /// \brief Get the queue used for the publications of a topic.
+      /// \param[in] _topic Fully qualified topic name.
+      /// \return The publish queue.
+      public: PublishQueue &PubQueue(const std::string &_topic);
+
+      /// \brief Push a new publication onto its publish queue. The message
+      /// will be published asynchronously to the local and raw callbacks,
+      /// or right away if there are no publish threads. When the queue is
+      /// full, the publication is dropped, unless one of its handlers
+      /// blocks the publishers of this process: the caller waits for the
+      /// publish thread to make room then. If the caller is that thread,
+      /// the callbacks run right away.
+      /// \param[in] _details The publication.
+      /// \return Number of handlers that missed the publication because the
+      /// queue was full.
+      /// \sa SubscriptionHandlerBase::BlocksPublisher
+      public: uint64_t EnqueuePublication(
+        std::unique_ptr<PublishMsgDetails> _details);
+
+      /// \brief Release the slots reserved in the queues of the handlers of
+      /// a publication that is not dispatched, so that the publishers they
+      /// block can go on.
+      /// \param[in] _details The publication.
+      public: static void ReleaseQueueSlots(PublishMsgDetails &_details);
+
+      /// \brief Release the slots reserved in the queues of the handlers of
+      /// a publication that is dropped, and count the drop in each handler.
+      /// \param[in] _details The publication.
+      /// \return Number of handlers of the publication.
+      public: static uint64_t DropQueueSlots(PublishMsgDetails &_details);
+
+      /// \brief Whether the publisher of a publication waits for room in a
+      /// full publish queue: it is published by this process and one of its
+      /// handlers blocks the publishers.
+      /// \param[in] _details The publication.
+      /// \return True if the publisher waits.
+      public: static bool WaitForRoom(const PublishMsgDetails &_details);
+
+      /// \brief Hand over the callbacks of the handlers bound to an executor
+      /// to their executor, and remove these handlers from the publication.
+      /// \param[in, out] _details The publication.
+      /// \sa SubscribeOptions::SetCallbackExecutor
+      public: void PostToExecutors(PublishMsgDetails &_details);
+
+      /// \brief Handles local publication of messages on a publish queue.
+      /// \param[in] _queue The queue processed by this thread.
+      public: void PublishThread(PublishQueue &_queue);
+
+      /// \brief Pop the next message of a publish queue, trying again
+      /// without blocking for up to busyPoll.
+      /// \param[in] _queue The queue.
+      /// \param[out] _details The message popped.
+      /// \return True if a message was popped.
+      public: bool SpinPop(PublishQueue &_queue,
+                           std::unique_ptr<PublishMsgDetails> &_details);
+
+      /// \brief Run the local and raw callbacks of a publication.
+      /// \param[in] _details The publication.
+      public: void Dispatch(PublishMsgDetails &_details);
+
+      /// \brief The publish queues. The size is set by the
+      /// GZ_TRANSPORT_DISPATCH_THREADS environment variable, there are none
+      /// if it's 0.
+      public: std::vector<std::unique_ptr<PublishQueue>> pubQueues;
+
+      /// \brief The received messages of this size (bytes) or larger are
+      /// deserialized by the dispatch threads instead of the reception
+      /// thread, when all their local callbacks are asynchronous. Zero
+      /// disables it (see GZ_TRANSPORT_PARSE_THRESHOLD).
+      public: std::size_t parseThreshold = 0;
+
+      ////////////////////////////////////////////////////////////////
+      /////// The following is for the taps of the messages     ///////
+      /////// published within the process (see                ///////
+      /////// NodeShared::AddTap).                              ///////
+      ////////////////////////////////////////////////////////////////
+
+      /// \brief A tap of a topic.
+      public: struct Tap
+      {
+        /// \brief Identifier of the tap.
+        uint64_t id = 0;
+
+        /// \brief UUID of the raw subscription handler replaced.
+        std::string hUuid;
+
+        /// \brief The callback.
+        SharedRawCallback callback;
+      };
+
+      /// \brief Taps of a topic. A list is replaced, not modified, so the
+      /// publishers use it without holding tapMutex.
+      public: using TapList = std::shared_ptr<const std::vector<Tap>>;
+
+      /// \brief Get the taps of a topic.
+      /// \param[in] _topic Fully qualified topic name.
+      /// \return The taps, or nullptr if there are none.
+      public: TapList Taps(const std::string &_topic) const;
+
+      /// \brief Check whether a raw subscription handler is replaced by a
+      /// tap.
+      /// \param[in] _taps The taps of the topic.
+      /// \param[in] _hUuid UUID of the handler.
+      /// \return True if a tap replaces the handler.
+      public: static bool Tapped(const std::vector<Tap> &_taps,
+                                 const std::string &_hUuid);
+
+      /// \brief Remove the raw subscriptions replaced by the taps of a
+      /// topic from its subscribers.
+      /// \param[in] _taps The taps of the topic.
+      /// \param[in, out] _subscribers The subscribers of the topic.
+      public: static void Untap(const std::vector<Tap> &_taps,
+                                NodeShared::MatchingHandlerInfo &_subscribers);
+
+      /// \brief Run the taps of a message.
+      /// \param[in] _taps The taps of the topic.
+      /// \param[in] _data The serialized message.
+      /// \param[in] _size Size of the message (bytes).
+      /// \param[in] _info Information of the message.
+      public: static void RunTaps(const std::vector<Tap> &_taps,
+                                  const std::shared_ptr<const char> &_data,
+                                  const std::size_t _size,
+                                  const MessageInfo &_info);
+
+      /// \brief Protect taps and tapId.
+      public: mutable std::mutex tapMutex;
+
+      /// \brief The taps, by fully qualified topic name.
+      public: std::unordered_map<std::string, TapList> taps;
+
+      /// \brief Number of topics tapped, checked before locking tapMutex.
+      public: std::atomic<std::size_t> tappedTopics{0};
+
+      /// \brief Identifier of the last tap added.
+      public: uint64_t tapId = 0;
+
+      /// \brief Subscribers of a topic accepting a message type, as computed
+      /// by NodeShared::CheckMatchingSubscribers(), and the versions of the
+      /// subscriber tables used to compute them.
+      public: struct MatchingSubscribersEntry
+      {
+        /// \brief The subscribers.
+        public: NodeShared::MatchingSubscriberInfo info;
+
+        /// \brief Version of NodeShared::localSubscribers.normal.
+        public: uint64_t normalVersion = 0;
+
+        /// \brief Version of NodeShared::localSubscribers.raw.
+        public: uint64_t rawVersion = 0;
+
+        /// \brief Version of NodeShared::remoteSubscribers.
+        public: uint64_t remoteVersion = 0;
+
+        /// \brief Version of the aliases, see aliasVersion.
+        public: uint64_t aliasVersion = 0;
+      };
+
+      /// \brief Version of a TopicInterest not computed yet.
+      public: static constexpr uint64_t kStaleInterest = ~uint64_t{0};
+
+      /// \brief Whether a topic has any subscriber, local or remote, of
+      /// any message type. The record is shared by the publishers of the
+      /// topic and recomputed only after a subscription or a connection
+      /// changed the subscriber tables, see Listened().
+      public: struct TopicInterest
+      {
+        /// \brief Sum of the versions of the subscriber tables when
+        /// listened was computed, or kStaleInterest.
+        public: std::atomic<uint64_t> version{kStaleInterest};
+
+        /// \brief True if the topic has a subscriber.
+        public: std::atomic<bool> listened{false};
+      };
+
+      /// \brief Get the interest record of a topic, created on first use.
+      /// \param[in] _topic Fully qualified topic name.
+      /// \return The record.
+      public: std::shared_ptr<TopicInterest> Interest(
+                  const std::string &_topic);
+
+      /// \brief Check whether a topic has any subscriber. While the
+      /// subscriber tables are unchanged, it costs a few atomic loads and
+      /// doesn't lock NodeShared::mutex, so the publishers detect that
+      /// nobody is listening before serializing the messages.
+      /// \param[in] _shared The shared node.
+      /// \param[in] _topic Fully qualified topic name.
+      /// \param[in] _interest The record of the topic.
+      /// \return True if the topic has a local or a remote subscriber.
+      public: static bool Listened(const NodeShared &_shared,
+                                   const std::string &_topic,
+                                   TopicInterest &_interest);
+
+      /// \brief The interest records, by fully qualified topic name. The
+      /// records are owned by the publishers.
+      public: std::unordered_map<std::string, std::weak_ptr<TopicInterest>>
+                interests;
+
+      /// \brief Protect interests.
+      public: std::mutex interestMutex;
+
+      /// \brief Cache of the subscribers used by the publishers. The first
+      /// key is the topic and the second key is the message type. An entry
+      /// is only valid while the versions of the subscriber tables match,
+      /// so the publishers don't need to lock NodeShared::mutex unless the
+      /// subscribers have changed.
+      public: std::unordered_map<std::string,
+              std::unordered_map<std::string, MatchingSubscribersEntry>>
+                matchingSubscribers;
+
+      /// \brief Protect matchingSubscribers. The publishers share the lock,
+      /// it is only exclusive while an entry is updated.
+      public: std::shared_mutex matchingSubscribersMutex;
+
+      ////////////////////////////////////////////////////////////////
+      /////// The following is for the aliases of the topics     ///////
+      /////// (see AdvertiseMessageOptions::AddAlias()).         ///////
+      ////////////////////////////////////////////////////////////////
+
+      /// \brief An alias of a topic known by this process.
+      public: struct TopicAlias
+      {
+        /// \brief Fully qualified name of the topic.
+        std::string topic;
+
+        /// \brief Number of publishers of this process advertising the
+        /// alias.
+        uint32_t publishers = 0;
+
+        /// \brief True if the alias was discovered from a remote publisher
+        /// by a subscriber of this process.
+        bool subscribed = false;
+      };
+
+      /// \brief Add an alias, or a reference to it. The subscribers of the
+      /// alias are then matched with the publications of the topic.
+      /// NodeShared::mutex must be locked by the caller.
+      /// \param[in] _alias Fully qualified alias.
+      /// \param[in] _topic Fully qualified topic.
+      /// \param[in] _local True for a publisher of this process, false for
+      /// an alias discovered by a subscriber.
+      /// \return False if the alias already names another topic.
+      public: bool AddAlias(const std::string &_alias,
+                            const std::string &_topic,
+                            const bool _local);
+
+      /// \brief Release a reference to an alias, see AddAlias(). The alias
+      /// is removed with its last reference. NodeShared::mutex must be
+      /// locked by the caller.
+      /// \param[in] _alias Fully qualified alias.
+      /// \param[in] _local True for a publisher of this process, false for
+      /// an alias discovered by a subscriber.
+      public: void RemoveAlias(const std::string &_alias, const bool _local);
+
+      /// \brief Get the topic named by an alias. NodeShared::mutex must be
+      /// locked by the caller.
+      /// \param[in] _alias Fully qualified name.
+      /// \return The fully qualified topic, or an empty string if the name
+      /// isn't an alias.
+      public: std::string AliasTarget(const std::string &_alias) const;
+
+      /// \brief Check whether a topic or one of its aliases has a local
+      /// subscriber. NodeShared::mutex must be locked by the caller.
+      /// \param[in] _shared The NodeShared owning this object.
+      /// \param[in] _topic Fully qualified topic.
+      /// \return True if the topic is subscribed.
+      public: bool TopicSubscribed(const NodeShared &_shared,
+                                   const std::string &_topic) const;
+
+      /// \brief Tell a remote publisher the highest rate of the subscribers
+      /// of a node, so it doesn't send the messages that they would
+      /// discard. NodeShared::mutex must be locked by the caller.
+      /// \param[in] _shared The NodeShared owning this object.
+      /// \param[in] _connection The remote publisher connected.
+      /// \param[in] _topic Fully qualified topic of the subscribers, which
+      /// is an alias of the topic of _connection if they subscribe to it.
+      /// \param[in] _nUuid UUID of the node of the subscribers.
+      public: void RegisterSubscribers(const NodeShared &_shared,
+                                       const MessagePublisher &_connection,
+                                       const std::string &_topic,
+                                       const std::string &_nUuid) const;
+
+      /// \brief Register again the subscribers of a node with the remote
+      /// publishers already connected, after their rate has changed. The
+      /// publishers replace the rate, the connections stay.
+      /// NodeShared::mutex must be locked by the caller.
+      /// \param[in] _shared The NodeShared owning this object.
+      /// \param[in] _topic Fully qualified topic of the subscribers.
+      /// \param[in] _nUuid UUID of the node of the subscribers.
+      /// \sa Node::UpdateSubscription
+      public: void UpdateSubscribers(const NodeShared &_shared,
+                                     const std::string &_topic,
+                                     const std::string &_nUuid) const;
+
+      /// \brief Advertise the aliases of a publisher of this process through
+      /// discovery. NodeShared::mutex must be locked by the caller.
+      /// \param[in] _pub The publisher.
+      /// \param[in] _aliases Fully qualified aliases.
+      public: void AdvertiseAliases(const MessagePublisher &_pub,
+                  const std::vector<std::string> &_aliases);
+
+      /// \brief Unadvertise the aliases of a publisher of this process.
+      /// NodeShared::mutex must be locked by the caller.
+      /// \param[in] _topic Fully qualified topic of the publisher.
+      /// \param[in] _nUuid UUID of the node of the publisher.
+      public: void UnadvertiseAliases(const std::string &_topic,
+                                      const std::string &_nUuid);
+
+      /// \brief The aliases by fully qualified name. Protected by
+      /// NodeShared::mutex.
+      public: std::unordered_map<std::string, TopicAlias> aliases;
+
+      /// \brief The aliases of each topic. Protected by NodeShared::mutex.
+      public: std::unordered_map<std::string,
+              std::unordered_set<std::string>> topicAliases;
+
+      /// \brief The aliases advertised by the publishers of this process.
+      /// The key is the topic and the UUID of the node of the publisher.
+      /// Protected by NodeShared::mutex.
+      public: std::map<std::pair<std::string, std::string>,
+              std::vector<std::string>> advertisedAliases;
+
+      /// \brief Incremented whenever an alias is added or removed, which
+      /// invalidates the subscribers cached for the topics.
+      public: std::atomic<uint64_t> aliasVersion{0};
+
+      /// \brief Information of the messages received from the remote
+      /// publishers. The first key is the topic and the second key is the
+      /// message type. The information of every message received is copied
+      /// from here, sharing the names of the topic instead of parsing them.
+      /// Protected by NodeShared::mutex.
+      public: std::unordered_map<TopicKey,
+              std::unordered_map<std::string, MessageInfo>, TopicKeyHash>
+                recvMsgInfos;
+
+      /// \brief Get the information of a message received from a remote
+      /// publisher, from recvMsgInfos. NodeShared::mutex must be locked by
+      /// the caller.
+      /// \param[in] _topic Topic of the message.
+      /// \param[in] _msgType Type of the message.
+      /// \return The information.
+      public: const MessageInfo &RecvMsgInfo(const TopicKey &_topic,
+                                             const std::string &_msgType);
+
+      /// \brief Mutex to serialize the messages sent by the publisher socket
+      /// and to protect topicPubSeq.
+      public: std::mutex publisherMutex;
+
+      /// \brief The remote publications larger than this are sent in
+      /// fragments of this size (bytes). Zero disables the fragmentation
+      /// (see GZ_TRANSPORT_FRAGMENT_SIZE).
+      public: std::size_t fragmentSize = 0;
+
+      /// \brief The messages received in fragments that are larger than this
+      /// size (bytes) are discarded before allocating them (see
+      /// GZ_TRANSPORT_MAX_MSG_SIZE).
+      public: uint64_t maxMsgSize = kDefaultMaxMsgSize;
+
+      /// \brief Default value of maxMsgSize: 1 GiB.
+      public: static const uint64_t kDefaultMaxMsgSize = uint64_t{1} << 30;
+
+      /// \brief Identifier of the last message sent in fragments. Protected
+      /// by publisherMutex.
+      public: uint64_t fragmentId = 0;
 
       /// \brief Topic publication sequence numbers.
-      public: std::map<std::string, uint64_t> topicPubSeq;
+      public: std::unordered_map<std::string, uint64_t> topicPubSeq;
+
+      /// \brief Last messages sent on a topic, for retransmission.
+      public: struct TopicHistory
+      {
+        /// \brief A message sent.
+        struct Entry
+        {
+          /// \brief Header of the message.
+          HistoryEntryHeader header;
+
+          /// \brief Type of the message.
+          std::string msgType;
+
+          /// \brief Serialized message, compressed if flagged in header.
+          std::string data;
+        };
+
+        /// \brief Maximum number of messages kept.
+        uint64_t capacity = 0;
+
+        /// \brief The messages, oldest first.
+        std::deque<Entry> entries;
+      };
+
+      /// \brief Histories by topic, see
+      /// AdvertiseMessageOptions::SetHistorySize(). Protected by
+      /// publisherMutex.
+      public: std::unordered_map<std::string, TopicHistory> histories;
+
+      /// \brief Last messages published on a topic for the late joiners,
+      /// with a sequence number of 0. The key is the topic, see
+      /// AdvertiseMessageOptions::SetHistoryDepth(). Protected by
+      /// latchedMutex.
+      public: std::unordered_map<std::string, TopicHistory> latched;
+
+      /// \brief Protect latched.
+      public: std::mutex latchedMutex;
+
+      /// \brief Sources of the latched messages already delivered to a
+      /// subscription handler: the address of a remote publisher, or an
+      /// empty string for the publishers of this process. The key is the
+      /// UUID of the handler. Protected by NodeShared::mutex.
+      public: std::unordered_map<std::string,
+              std::unordered_set<std::string>> latchedDelivered;
+
+      /// \brief Keep the last messages sent by this process on a topic and
+      /// advertise the service answering the requests of the subscribers
+      /// that have missed some of them (see RequestHistory()), or that
+      /// have just joined (see RequestLatched()).
+      /// \param[in] _topic Fully qualified topic.
+      /// \param[in] _addr Address of the publisher.
+      /// \param[in] _size Number of messages kept for retransmission.
+      /// \param[in] _depth Number of messages kept for the late joiners.
+      public: void EnableHistory(const std::string &_topic,
+                                 const std::string &_addr,
+                                 const uint64_t _size,
+                                 const uint64_t _depth);
+
+      /// \brief Keep a message published on a topic for the late joiners,
+      /// if the topic has a history depth.
+      /// \param[in] _topic Topic.
+      /// \param[in] _msgType Type of the message.
+      /// \param[in] _data Serialized message.
+      /// \param[in] _size Size of the message (bytes).
+      public: void Latch(const std::string &_topic,
+                         const std::string &_msgType,
+                         const char *_data,
+                         const std::size_t _size);
+
+      /// \brief Ask a remote publisher for the last messages of its topic,
+      /// for the local handlers that haven't received them yet.
+      /// NodeShared::mutex must be locked by the caller.
+      /// \param[in] _shared The NodeShared owning this object.
+      /// \param[in] _pub The publisher, with a history depth.
+      public: void RequestLatched(NodeShared &_shared,
+                                  const MessagePublisher &_pub);
+
+      /// \brief Deliver the last messages published by this process on a
+      /// topic to the handlers of a node that haven't received them yet.
+      /// NodeShared::mutex must be locked by the caller.
+      /// \param[in] _shared The NodeShared owning this object.
+      /// \param[in] _topic Fully qualified topic.
+      /// \param[in] _nUuid UUID of the node that has just subscribed.
+      public: void DeliverLatched(NodeShared &_shared,
+                                  const std::string &_topic,
+                                  const std::string &_nUuid);
+
+      /// \brief Get the local handlers of a topic that haven't received the
+      /// latched messages of a source yet, and mark them as served.
+      /// NodeShared::mutex must be locked by the caller.
+      /// \param[in] _shared The NodeShared owning this object.
+      /// \param[in] _topic Fully qualified topic.
+      /// \param[in] _msgType Type of the messages.
+      /// \param[in] _source Address of the remote publisher, or empty for
+      /// the publishers of this process.
+      /// \param[in] _nUuid Only select the handlers of this node, unless
+      /// empty.
+      /// \return The handlers.
+      public: NodeShared::MatchingHandlerInfo NewLatchedHandlers(
+                  NodeShared &_shared,
+                  const std::string &_topic,
+                  const std::string &_msgType,
+                  const std::string &_source,
+                  const std::string &_nUuid = "");
+
+      /// \brief Add a message sent to the history of its topic, if the
+      /// topic has one. publisherMutex must be locked by the caller.
+      /// \param[in] _topic Topic.
+      /// \param[in] _meta Metadata of the message.
+      /// \param[in] _msgType Type of the message.
+      /// \param[in] _flags Flags of the PublicationHeader.
+      /// \param[in] _data Serialized message.
+      /// \param[in] _size Size of the message (bytes).
+      /// \return _flags, with kHeaderHistory if the message was added.
+      public: uint32_t AddToHistory(const std::string &_topic,
+                                    const PublicationMetadata &_meta,
+                                    const std::string &_msgType,
+                                    const uint32_t _flags,
+                                    const char *_data,
+                                    const std::size_t _size);
+
+      /// \brief Ask a reliable publisher for the messages missed by this
+      /// process. The messages still in its history are delivered to the
+      /// subscribers when the response arrives, flagged as retransmitted.
+      /// \param[in] _topic Fully qualified topic.
+      /// \param[in] _sender Identifier of the address of the publisher.
+      /// \param[in] _first Sequence number of the first message missed.
+      /// \param[in] _last Sequence number of the last message missed.
+      public: void RequestHistory(const std::string &_topic,
+                                  const uint64_t _sender,
+                                  const uint64_t _first,
+                                  const uint64_t _last);
+
+      /// \brief Get the service answering the requests for the history of
+      /// a topic sent by a publisher.
+      /// \param[in] _topic Topic, without the partition.
+      /// \param[in] _sender Identifier of the address of the publisher.
+      /// \return The name of the service.
+      public: static std::string HistoryService(const std::string &_topic,
+                                                const uint64_t _sender);
+
+      /// \brief Serialize the messages of a history within a range of
+      /// sequence numbers.
+      /// \param[in] _history The history.
+      /// \param[in] _first First sequence number.
+      /// \param[in] _last Last sequence number.
+      /// \param[out] _data The messages, each one a HistoryEntryHeader
+      /// followed by the type and the message.
+      public: static void PackHistory(const TopicHistory &_history,
+                                      const uint64_t _first,
+                                      const uint64_t _last,
+                                      std::string &_data);
+
+      /// \brief Parse the messages serialized by PackHistory().
+      /// \param[in] _data The serialized messages.
+      /// \param[out] _entries The messages.
+      /// \return True on success or false if _data is malformed.
+      public: static bool UnpackHistory(const std::string &_data,
+                  std::vector<TopicHistory::Entry> &_entries);
+
+      /// \brief Nodes advertising and requesting the history services, by
+      /// partition. Protected by historyNodesMutex.
+      public: std::map<std::string, std::unique_ptr<Node>> historyNodes;
+
+      /// \brief History services advertised, prefixed by their partition.
+      /// Protected by historyNodesMutex.
+      public: std::unordered_set<std::string> historyServices;
+
+      /// \brief Protect historyNodes and historyServices.
+      public: std::mutex historyNodesMutex;
+
+      /// \brief Get the node of a partition used for the history services,
+      /// created on first use.
+      /// \param[in] _partition The partition.
+      /// \return The node.
+      public: Node &HistoryNode(const std::string &_partition);
+
+      /// \brief Publish a serialized message to the remote subscribers.
+      /// \param[in] _topic Topic.
+      /// \param[in] _addr Address of the publisher.
+      /// \param[in] _data Serialized message. Zmq takes ownership, it is
+      /// released with _ffn.
+      /// \param[in] _dataSize Size of the message (bytes).
+      /// \param[in] _ffn Deallocation function.
+      /// \param[in] _msgType Type of the message.
+      /// \param[in] _hint Hint passed to _ffn.
+      /// \param[in] _flags Flags of the PublicationHeader.
+      /// \return True when success.
+      public: bool Publish(const std::string &_topic,
+                           const std::string &_addr,
+                           char *_data,
+                           const std::size_t _dataSize,
+                           DeallocFunc *_ffn,
+                           const std::string &_msgType,
+                           void *_hint,
+                           const uint32_t _flags);
+
+      /// \brief Publish a large serialized message to the remote
+      /// subscribers in fragments of fragmentSize bytes. publisherMutex is
+      /// released between the fragments, so the other publications are
+      /// sent in between instead of waiting for the whole message. The
+      /// subscribers in shared memory receive the whole message. The
+      /// parameters are the ones of Publish().
+      /// \return True when success.
+      public: bool PublishFragments(const std::string &_topic,
+                                    const std::string &_addr,
+                                    char *_data,
+                                    const std::size_t _dataSize,
+                                    DeallocFunc *_ffn,
+                                    const std::string &_msgType,
+                                    void *_hint,
+                                    const uint32_t _flags);
+
+      /// \brief Get the socket sending the publications of a publisher.
+      /// publisherMutex must be locked by the caller.
+      /// \param[in] _addr Address of the publisher.
+      /// \return The socket of the channel bound to this address, or the
+      /// publisher socket.
+      public: zmq::socket_t *PublicationSocket(const std::string &_addr);
+
+      /// \brief Create the frame of the PublicationHeader of a publication.
+      /// publisherMutex must be locked by the caller.
+      /// \param[in] _topic Topic.
+      /// \param[in] _addr Address of the publisher.
+      /// \param[in] _msgType Type of the message.
+      /// \param[in] _flags Flags of the PublicationHeader.
+      /// \return The frame.
+      public: zmq::message_t HeaderFrame(const std::string &_topic,
+                                         const std::string &_addr,
+                                         const std::string &_msgType,
+                                         const uint32_t _flags);
+
+      /// \brief Get the metadata of the next publication of a topic.
+      /// publisherMutex must be locked by the caller.
+      /// \param[in] _topic Topic.
+      /// \return The metadata.
+      public: PublicationMetadata NextMetadata(const std::string &_topic);
+
+      /// \brief Send a publication to the remote subscribers, through
+      /// shared memory too if enabled. publisherMutex must be locked by the
+      /// caller.
+      /// \param[in] _topic Topic.
+      /// \param[in] _addr Address of the publisher. The publication is sent
+      /// through the socket of a channel if it is bound to this address.
+      /// \param[in] _payload Serialized message or batch of messages.
+      /// \param[in] _msgType Type of the message, or of the batch.
+      /// \param[in] _flags Flags of the PublicationHeader.
+      /// \param[in] _meta Metadata for the topic statistics or nullptr.
+      /// \param[in] _metaCount Number of elements of _meta, one per message.
+      public: void SendPublication(const std::string &_topic,
+                                   const std::string &_addr,
+                                   zmq::message_t &_payload,
+                                   const std::string &_msgType,
+                                   const uint32_t _flags,
+                                   const PublicationMetadata *_meta,
+                                   const std::size_t _metaCount);
+
+      /// \brief Register a type advertised on a topic by this process. The
+      /// remote subscribers know these types through discovery, they are not
+      /// sent in full in the PublicationHeader.
+      /// \param[in] _topic Topic.
+      /// \param[in] _msgType Type advertised.
+      public: void AddAdvertisedType(const std::string &_topic,
+                                     const std::string &_msgType);
+
+      /// \brief Unregister a type registered with AddAdvertisedType().
+      /// \param[in] _topic Topic.
+      /// \param[in] _msgType Type advertised.
+      public: void RemoveAdvertisedType(const std::string &_topic,
+                                        const std::string &_msgType);
+
+      /// \brief Types advertised by this process. The key is the topic, each
+      /// type appears once per publisher. Protected by publisherMutex.
+      public: std::unordered_map<std::string, std::vector<std::string>>
+        advertisedTypes;
+
+      /// \brief Check whether the identifiers of the publishers of a topic
+      /// known by the discovery collide, in which case the publications of
+      /// the topic send the address and the type in full. publisherMutex
+      /// must not be locked by the caller.
+      /// \param[in] _topic Topic.
+      public: void UpdateFullHeaders(const std::string &_topic);
+
+      /// \brief Topics advertised by this process whose publications send
+      /// the address and the type in full, see UpdateFullHeaders().
+      /// Protected by publisherMutex.
+      public: std::unordered_set<std::string> fullHeaderTopics;
+
+      ////////////////////////////////////////////////////////////////
+      /////// The following is for the publisher channels, see ///////
+      /////// AdvertiseMessageOptions::SetChannel().           ///////
+      ////////////////////////////////////////////////////////////////
+
+      /// \brief Get the address of the publisher socket of a channel. The
+      /// socket is created and bound to a random port the first time, with
+      /// the options of the shared publisher socket. It is kept until the
+      /// process exits.
+      /// \param[in] _channel Name of the channel.
+      /// \param[in] _hostAddr IP address of the interface the socket is
+      /// bound to. A channel has a socket per interface.
+      /// \param[in] _priority Priority of the traffic of the socket, which
+      /// sets its DSCP. The first topic advertised on the channel sets it.
+      /// \return The address or an empty string if the socket can't be
+      /// bound.
+      public: std::string ChannelAddress(const std::string &_channel,
+                                         const std::string &_hostAddr,
+                                         const Priority_t _priority);
+
+      /// \brief Publisher sockets of the channels. The key is the address
+      /// of the socket. Protected by publisherMutex.
+      public: std::unordered_map<std::string, std::unique_ptr<zmq::socket_t>>
+        channelPublishers;
+
+      /// \brief Address of the socket of each channel. The key is the name
+      /// of the channel followed by "@<interface>". Protected by
+      /// publisherMutex.
+      public: std::unordered_map<std::string, std::string> channelAddresses;
+
+      ////////////////////////////////////////////////////////////////
+      /////// The following is for the peers of the previous    ///////
+      /////// wire protocol, see Discovery::LegacyAddressCb().   ///////
+      ////////////////////////////////////////////////////////////////
+
+      /// \brief Bind the socket sending the publications to the peers of the
+      /// previous wire protocol to a random port, with the options of the
+      /// shared publisher socket.
+      /// \param[in] _hostAddr IP address of the interface the socket is
+      /// bound to.
+      /// \return The address or an empty string if the socket can't be
+      /// bound.
+      public: std::string BindLegacyPublisher(const std::string &_hostAddr);
+
+      /// \brief Send a message to the subscribers of the previous wire
+      /// protocol, in its layout: the topic, the address of the publisher,
+      /// the message and its type, followed by the metadata if the topic
+      /// statistics are enabled. The message is copied. Nothing is sent
+      /// before one of these peers is discovered.
+      /// \param[in] _topic Topic.
+      /// \param[in] _data Serialized message, not compressed.
+      /// \param[in] _size Size of the message (bytes).
+      /// \param[in] _msgType Type of the message.
+      public: void PublishLegacy(const std::string &_topic,
+                                 const char *_data, const std::size_t _size,
+                                 const std::string &_msgType);
+
+      /// \brief Receive the rest of a publication of a peer of the previous
+      /// wire protocol, whose topic frame has just been received.
+      /// NodeShared::mutex must be locked by the caller.
+      /// \param[in] _socket Subscriber socket.
+      /// \param[in, out] _msg The frame of the topic, then the last frame
+      /// received.
+      /// \param[in] _topic Topic.
+      /// \param[out] _msgType Type of the message.
+      /// \param[out] _data The message.
+      /// \return True if a message was received.
+      public: bool RecvLegacyMsg(zmq::socket_t &_socket, zmq::message_t &_msg,
+                                 const std::string &_topic,
+                                 std::string &_msgType,
+                                 SerializedBuffer &_data);
+
+      /// \brief Socket sending the publications to the peers of the previous
+      /// wire protocol, or nullptr. Protected by publisherMutex.
+      public: std::unique_ptr<zmq::socket_t> legacyPublisher;
+
+      /// \brief Address of legacyPublisher. Protected by publisherMutex.
+      public: std::string legacyAddress;
+
+      /// \brief True once legacyPublisher is bound.
+      public: std::atomic<bool> legacyReady{false};
+
+      /// \brief Sequence numbers of the publications sent through
+      /// legacyPublisher. Protected by publisherMutex.
+      public: std::unordered_map<std::string, uint64_t> legacySeqs;
+
+      /// \brief Record that a node of a peer of the previous wire protocol
+      /// subscribes to a topic, or doesn't anymore.
+      /// \param[in] _sub The subscriber registered.
+      /// \param[in] _subscribed Whether the node subscribes to the topic.
+      public: void UpdateLegacySubscriber(const MessagePublisher &_sub,
+                                          const bool _subscribed);
+
+      /// \brief Forget the subscriptions of a peer of the previous wire
+      /// protocol, e.g. when it has left.
+      /// \param[in] _pUuid UUID of the process.
+      public: void RemoveLegacySubscribers(const std::string &_pUuid);
+
+      /// \brief Protects legacySubscribers.
+      public: std::mutex legacyMutex;
+
+      /// \brief Nodes of the peers of the previous wire protocol subscribed
+      /// to the topics, the only ones sent through legacyPublisher. The key
+      /// is the topic and the values are the process and node UUIDs.
+      /// Protected by legacyMutex.
+      public: std::unordered_map<std::string,
+              std::set<std::pair<std::string, std::string>>>
+        legacySubscribers;
+
+      /// \brief Whether legacySubscribers isn't empty.
+      public: std::atomic<bool> legacySubscribed{false};
+
+      /// \brief Topics also subscribed with the filter of the previous wire
+      /// protocol, which doesn't terminate the topic. Protected by
+      /// NodeShared::mutex.
+      public: std::unordered_set<std::string> legacySubscriptions;
+
+      /// \brief Connect a socket to a multicast group through PGM, on the
+      /// interface of an address. The socket of a publisher sends its
+      /// messages to the group, the socket of a subscriber receives them.
+      /// On failure, e.g. if ZMQ is built without PGM support, a message is
+      /// printed and the caller keeps using TCP.
+      /// \param[in] _socket The socket to connect.
+      /// \param[in] _group Multicast group and port, e.g.
+      /// "239.255.0.8:5555".
+      /// \param[in] _hostAddr IP address of the interface.
+      /// \return True if the socket is connected to the group.
+      public: bool MulticastConnect(zmq::socket_t &_socket,
+                                    const std::string &_group,
+                                    const std::string &_hostAddr);
+
+      ////////////////////////////////////////////////////////////////
+      /////// The following is for the batching of the messages ///////
+      /////// sent to the remote subscribers.                   ///////
+      ////////////////////////////////////////////////////////////////
+
+      /// \brief Messages of a topic waiting to be sent together.
+      public: struct PublishBatch
+      {
+        /// \brief Type of the messages.
+        public: std::string msgType;
+
+        /// \brief The messages, each one preceded by its size as uint32_t.
+        public: std::string data;
+
+        /// \brief Metadata of the messages if topic statistics are enabled.
+        public: std::vector<PublicationMetadata> meta;
+
+        /// \brief Time at which the batch must be sent.
+        public: Timestamp deadline;
+
+        /// \brief Address of the publisher, which selects the socket.
+        public: std::string addr;
+
+        /// \brief Priority of the messages, see priorityFlags().
+        public: uint32_t priorityFlags = 0;
+      };
+
+      /// \brief Add a message to the batch of its topic. The batch is sent
+      /// when it reaches _maxBytes or when _maxDelay has elapsed since its
+      /// first message was added. Messages of _maxBytes or bigger are sent
+      /// immediately.
+      /// \param[in] _topic Topic.
+      /// \param[in] _addr Address of the publisher.
+      /// \param[in] _data Serialized message.
+      /// \param[in] _size Size of the message (bytes).
+      /// \param[in] _msgType Type of the message.
+      /// \param[in] _maxDelay Maximum delay of the batch (microseconds).
+      /// \param[in] _maxBytes Size that triggers sending the batch (bytes).
+      /// \param[in] _flags Flags of the PublicationHeader. Messages with
+      /// flags, e.g.: compressed, are sent immediately.
+      /// \return True when success.
+      public: bool PublishBatched(const std::string &_topic,
+                                  const std::string &_addr,
+                                  const char *_data,
+                                  const std::size_t _size,
+                                  const std::string &_msgType,
+                                  const uint64_t _maxDelay,
+                                  const uint64_t _maxBytes,
+                                  const uint32_t _flags);
+
+      /// \brief Send a batch and empty it. publisherMutex must be locked by
+      /// the caller.
+      /// \param[in] _topic Topic.
+      /// \param[in, out] _batch The batch.
+      public: void FlushBatch(const std::string &_topic,
+                              PublishBatch &_batch);
+
+      /// \brief Send the pending batches right away, e.g.: before their
+      /// publisher is removed or on exit. publisherMutex must be locked by
+      /// the caller.
+      /// \param[in] _topic Topic of the batch to send, all the batches are
+      /// sent if empty.
+      public: void FlushBatches(const std::string &_topic = "");
+
+      /// \brief Send the batches once their delay has elapsed. The pending
+      /// batches are sent on exit.
+      public: void BatchThread();
+
+      /// \brief Pending batches. The key is the topic. Protected by
+      /// publisherMutex.
+      public: std::unordered_map<std::string, PublishBatch> batches;
+
+      /// \brief Notify BatchThread() that a new batch has been created or
+      /// that it must exit.
+      public: std::condition_variable batchCondition;
+
+      /// \brief Thread sending the batches, started with the first batch.
+      public: std::thread batchThread;
+
+      /// \brief Unpack a batch received from a remote publisher.
+      /// \param[in] _data The batch.
+      /// \param[out] _msgs The messages. They share the storage of the
+      /// batch.
+      /// \return True on success or false if the batch is malformed.
+      public: static bool UnpackBatch(const SerializedBuffer &_data,
+                                      std::vector<SerializedBuffer> &_msgs);
 
       /// \brief True if topic statistics have been enabled.
       public: bool topicStatsEnabled = false;
 
-      /// \brief Statistics for a topic. The key in the map is the topic
-      /// name and the value contains the topic statistics.
-      public: std::map<std::string, TopicStatistics> topicStats;
+      /// \brief Statistics of a topic.
+      public: struct TopicStatsEntry
+      {
+        /// \brief Function called when the statistics are updated. Empty
+        /// if the statistics are disabled.
+        std::function<void(const TopicStatistics &_stats)> callback;
+
+        /// \brief The statistics. Protected by NodeShared::mutex, which the
+        /// reception thread already holds.
+        TopicStatistics stats;
+
+        /// \brief Messages dropped by the subscriber queues since they were
+        /// last added to the statistics. The publishers add to it without
+        /// taking NodeShared::mutex, it is merged into the statistics when
+        /// they are read.
+        std::atomic<uint64_t> queueDrops{0};
+
+        /// \brief Slow subscribers detected since they were last added to
+        /// the statistics, see NotifySlowSubscribers().
+        std::atomic<uint64_t> slowSubscribers{0};
+      };
+
+      /// \brief Statistics by topic name. Modified with both
+      /// NodeShared::mutex and topicStatsMutex held, so reading it only
+      /// requires one of them.
+      public: std::unordered_map<std::string,
+              std::unique_ptr<TopicStatsEntry>> topicStats;
+
+      /// \brief Protect topicStats for the publishers, see AddQueueDrops().
+      public: std::shared_mutex topicStatsMutex;
+
+      ////////////////////////////////////////////////////////////////
+      /////// The following is for the metrics of the transport ///////
+      /////// (see GZ_TRANSPORT_METRICS).                       ///////
+      ////////////////////////////////////////////////////////////////
+
+      /// \brief Sample the values exported along with the counters: the
+      /// depth of the publish queues, the discovery traffic and the
+      /// execution time of the callbacks.
+      /// \param[in] _shared The NodeShared owning this object.
+      public: void SampleMetrics(const NodeShared &_shared);
+
+      /// \brief Export the metrics every metricsPeriod until exit: they
+      /// are published on kMetricsTopic and written to metricsFile.
+      public: void MetricsThread();
+
+      /// \brief Topic on which the metrics are published.
+      public: inline static const std::string kMetricsTopic =
+        TransportMetrics::kTopic;
+
+      /// \brief The metrics, or nullptr if they are disabled.
+      public: std::unique_ptr<TransportMetrics> metrics;
+
+      /// \brief Period (ms) of the export of the metrics.
+      public: int metricsPeriod = 1000;
+
+      /// \brief File where the metrics are written in the Prometheus text
+      /// format, or empty.
+      public: std::string metricsFile;
+
+      /// \brief Thread exporting the metrics.
+      public: std::thread metricsThread;
+
+      /// \brief Mutex used along with metricsCondition.
+      public: std::mutex metricsMutex;
+
+      /// \brief Wake up MetricsThread() on exit.
+      public: std::condition_variable metricsCondition;
+
+      ////////////////////////////////////////////////////////////////
+      /////// The following is for the detection of the slow     ///////
+      /////// subscribers (see GZ_TRANSPORT_SLOW_SUBSCRIBER).     ///////
+      ////////////////////////////////////////////////////////////////
+
+      /// \brief The slow subscribers of the socket of a publisher.
+      public: struct SlowSubscriberWatch
+      {
+        /// \brief Fully qualified topic of the publisher.
+        std::string topic;
+
+        /// \brief Protects callback.
+        std::mutex mutex;
+
+        /// \brief Function called when a subscriber becomes slow or
+        /// recovers.
+        SlowSubscriberCallback callback;
+
+        /// \brief Number of slow subscribers of the socket now.
+        std::atomic<uint32_t> slow{0};
+      };
+
+      /// \brief Watch the slow subscribers of a publisher socket.
+      /// \param[in] _addr Address of the publisher socket.
+      /// \param[in] _topic Fully qualified topic of the publisher.
+      /// \return The watch, updated until it is released.
+      public: std::shared_ptr<SlowSubscriberWatch> WatchSlowSubscribers(
+                  const std::string &_addr, const std::string &_topic);
+
+      /// \brief Monitor the connections accepted by a publisher socket.
+      /// Must be called before the socket is shared with other threads.
+      /// \param[in] _publisher The publisher socket.
+      /// \param[in] _addr Address of the socket.
+      public: void MonitorPublisher(zmq::socket_t &_publisher,
+                                    const std::string &_addr);
+
+      /// \brief Update the watches of the sockets of some events, call
+      /// their callbacks and count the slow subscribers in the topic
+      /// statistics.
+      /// \param[in] _events The events.
+      public: void NotifySlowSubscribers(
+                  const std::vector<SendQueueMonitor::Event> &_events);
+
+      /// \brief Track the connections of the publisher sockets and sample
+      /// their send queue every kSlowSubscriberPeriod until exit.
+      public: void SlowSubscriberThread();
+
+      /// \brief Period of the samples of the send queues.
+      public: static constexpr std::chrono::milliseconds
+        kSlowSubscriberPeriod{100};
+
+      /// \brief Send queue of a slow subscriber (bytes), 0 if the
+      /// detection is disabled.
+      public: uint64_t slowSubscriberThreshold = 0;
+
+      /// \brief Thread running SlowSubscriberThread().
+      public: std::thread slowSubscriberThread;
+
+      /// \brief Protects the members below. Locked after publisherMutex.
+      public: std::mutex slowSubscriberMutex;
+
+      /// \brief Monitor sockets of the publisher sockets not yet polled by
+      /// SlowSubscriberThread(), with the address of the publisher socket.
+      public: std::vector<std::pair<std::string, zmq::socket_t>>
+        pendingMonitors;
+
+      /// \brief Number of publisher sockets monitored.
+      public: std::size_t monitorCount = 0;
+
+      /// \brief The publisher sockets monitored, stopped on exit.
+      public: std::vector<zmq::socket_t *> monitoredPublishers;
+
+      /// \brief Watches by address of the publisher socket.
+      public: std::multimap<std::string, std::weak_ptr<SlowSubscriberWatch>>
+        slowWatches;
+
+      /// \brief Number of slow subscribers by address of the publisher
+      /// socket.
+      public: std::unordered_map<std::string, uint32_t> slowConnections;
+
+      ////////////////////////////////////////////////////////////////
+      /////// The following is for the accounting of the memory  ///////
+      /////// (see NodeShared::MemoryStats()).                   ///////
+      ////////////////////////////////////////////////////////////////
+
+      /// \brief Release function of the messages handed to ZMQ, wrapping
+      /// the one of the publisher to account for their size.
+      public: struct ZmqRelease
+      {
+        /// \brief Release function of the publisher, or nullptr.
+        DeallocFunc *ffn;
+
+        /// \brief Hint of the publisher.
+        void *hint;
+
+        /// \brief Size of the message (bytes).
+        std::size_t size;
+
+        /// \brief Counter of the bytes held by ZMQ.
+        std::shared_ptr<std::atomic<int64_t>> bytes;
+      };
+
+      /// \brief Release a message handed to ZMQ, see ZmqRelease.
+      /// \param[in] _data The message.
+      /// \param[in] _hint The ZmqRelease.
+      public: static void ReleaseZmqMessage(void *_data, void *_hint);
+
+      /// \brief Check whether the capped memory exceeds the cap, see
+      /// NodeShared::MemoryCapExceeded().
+      /// \param[in] _extra Bytes about to be added.
+      /// \return True if the cap is exceeded.
+      public: bool MemoryCapExceeded(const uint64_t _extra) const;
+
+      /// \brief Whether a publication is dropped because of the memory cap.
+      /// CONTROL messages are never dropped.
+      /// \param[in] _priority Priority of the publication.
+      /// \param[in] _size Size of the publication (bytes).
+      /// \return True if the publication has to be dropped.
+      public: bool DropForMemoryCap(const Priority_t _priority,
+                                    const std::size_t _size);
+
+      /// \brief Bytes of the publications in the publish queues.
+      public: std::atomic<int64_t> publishQueueBytes{0};
+
+      /// \brief Bytes of the messages handed to ZMQ and not released yet.
+      /// Shared with the release functions, which can run after the
+      /// destruction of this object.
+      public: std::shared_ptr<std::atomic<int64_t>> zmqSendBytes =
+        std::make_shared<std::atomic<int64_t>>(0);
+
+      /// \brief Bytes reported with NodeShared::AddExternalMemory().
+      public: std::atomic<int64_t> externalBytes{0};
+
+      /// \brief Memory cap (bytes), 0 for no cap.
+      public: std::atomic<uint64_t> memoryCap{0};
+
+      /// \brief Publications dropped because of the memory cap.
+      public: std::atomic<uint64_t> memoryCapDrops{0};
+
+      /// \brief Records the spans of the messages if GZ_TRANSPORT_TRACE is
+      /// set, or nullptr.
+      public: std::unique_ptr<Tracer> tracer;
+
+      /// \brief Counters of the topics in lockstep, see Lockstep.
+      public: LockstepTracker lockstep;
+
+      /// \brief Run a subscription callback, accounting for its duration if
+      /// callbackStats is set or the handler has an adaptive queue.
+      /// \param[in] _handler The subscription handler.
+      /// \param[in] _callback Function running the callback.
+      public: template<typename F>
+      void RunCallback(SubscriptionHandlerBase &_handler, F &&_callback)
+      {
+        const bool stats = this->callbackStats.load(std::memory_order_relaxed);
+        if (!stats && !_handler.AdaptiveQueue())
+        {
+          _callback();
+          return;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        _callback();
+        const std::chrono::nanoseconds duration =
+          std::chrono::steady_clock::now() - start;
+        if (stats)
+          _handler.AddCallbackDuration(duration);
+        _handler.AddServiceTime(duration);
+      }
+
+      /// \brief True if the execution time of the subscription callbacks is
+      /// accounted (see GZ_TRANSPORT_CALLBACK_STATISTICS).
+      public: std::atomic<bool> callbackStats{false};
+
+      ////////////////////////////////////////////////////////////////
+      /////// The following is for the service requests run by  ///////
+      /////// the service threads (see                          ///////
+      /////// AdvertiseServiceOptions::SetConcurrency).         ///////
+      ////////////////////////////////////////////////////////////////
+
+      /// \brief A service request received, waiting for a service thread.
+      public: struct SrvRequest
+      {
+        /// \brief Handler of the service.
+        IRepHandlerPtr handler;
+
+        /// \brief Service name.
+        std::string topic;
+
+        /// \brief Address of the requester.
+        std::string sender;
+
+        /// \brief ZMQ identity of the requester.
+        std::string dstId;
+
+        /// \brief UUID of the requesting node.
+        std::string nodeUuid;
+
+        /// \brief UUID of the request.
+        std::string reqUuid;
+
+        /// \brief Serialized request.
+        std::string req;
+
+        /// \brief True if no response is expected.
+        bool oneway = false;
+
+        /// \brief True if req is a batch of requests.
+        bool batch = false;
+
+        /// \brief True if the call is timed, see SrvTimingEnabled().
+        bool timed = false;
+
+        /// \brief True if the requester asked for the times of the call.
+        bool timing = false;
+
+        /// \brief Time to live of the response if it's cached, zero
+        /// otherwise.
+        std::chrono::milliseconds cacheTtl{0};
+
+        /// \brief True if the requester caches the responses, see
+        /// kSrvRequestCache.
+        bool cache = false;
+
+        /// \brief When the request was received.
+        Timestamp received;
+      };
+
+      /// \brief A response produced by a service thread, waiting to be sent
+      /// by the reception thread.
+      public: struct SrvReply
+      {
+        /// \brief Address of the requester.
+        std::string sender;
+
+        /// \brief ZMQ identity of the requester.
+        std::string dstId;
+
+        /// \brief Service name.
+        std::string topic;
+
+        /// \brief UUID of the requesting node.
+        std::string nodeUuid;
+
+        /// \brief UUID of the request.
+        std::string reqUuid;
+
+        /// \brief Serialized response.
+        std::string rep;
+
+        /// \brief Result of the service call.
+        bool result = false;
+
+        /// \brief Times of the call reported to the requester, see
+        /// kSrvRequestTiming. Empty if not requested.
+        std::string timing;
+
+        /// \brief Time to live of the response reported to the requester,
+        /// see kSrvRequestCache. Zero if none.
+        std::chrono::milliseconds cacheTtl{0};
+      };
+
+      /// \brief Requests of a service handler.
+      public: struct SrvQueue
+      {
+        /// \brief Requests not started yet, in order of arrival.
+        std::deque<SrvRequest> pending;
+
+        /// \brief Number of service threads running requests of the
+        /// handler. It never exceeds the concurrency of the handler.
+        uint32_t running = 0;
+
+        /// \brief Priority of the handler, which orders its jobs.
+        Priority_t priority = Priority_t::NORMAL;
+      };
+
+      /// \brief Queue a service request. The request is run by a service
+      /// thread, a new thread is started if none is idle.
+      /// \param[in] _request The request.
+      public: void DispatchSrvRequest(SrvRequest &&_request);
+
+      /// \brief Get the function sending the response of a request. The
+      /// response is queued and sent by the reception thread.
+      /// \param[in] _request The request.
+      /// \return The function, which can be called from any thread.
+      public: std::function<void(const std::string &, const bool)>
+        SrvReplyFunc(const SrvRequest &_request);
+
+      /// \brief Queue a response and wake up the reception thread.
+      /// \param[in] _reply The response.
+      public: void QueueSrvReply(SrvReply &&_reply);
+
+      /// \brief Run a batch of service requests, one after the other.
+      /// \param[in] _handler Handler of the service.
+      /// \param[in] _req The requests, see IReqHandler::PackBatch().
+      /// \param[out] _rep The responses, each one preceded by a byte
+      /// containing the result of its service call.
+      /// \return False if the batch is malformed.
+      public: static bool RunSrvBatch(IRepHandler &_handler,
+                                      const std::string &_req,
+                                      std::string &_rep);
+
+      /// \brief Run the service requests queued.
+      /// This function is designed to be run in a thread.
+      public: void SrvThread();
+
+      /// \brief Protect the service queues, the responses and srvWakeSender.
+      public: std::mutex srvMutex;
+
+      /// \brief Notify the service threads that a job is available or that
+      /// they must exit.
+      public: std::condition_variable srvCondition;
+
+      /// \brief Requests queued. The key is the handler UUID.
+      public: std::map<std::string, SrvQueue> srvQueues;
+
+      /// \brief Handlers (UUID) with requests that can be started, in order
+      /// of priority. A handler appears once per service thread allowed to
+      /// run it.
+      public: std::deque<std::string> srvJobs;
+
+      /// \brief Responses waiting to be sent by the reception thread.
+      public: std::deque<SrvReply> srvReplies;
+
+      /// \brief Service threads.
+      public: std::vector<std::thread> srvThreads;
+
+      /// \brief Number of service threads waiting for a job.
+      public: std::size_t srvIdleThreads = 0;
+
+      ////////////////////////////////////////////////////////////////
+      /////// The following is for the service statistics and   ///////
+      /////// the slow service calls.                           ///////
+      ////////////////////////////////////////////////////////////////
+
+      /// \brief Whether the service calls must be timed: the statistics of
+      /// the service are enabled or the slow service calls are logged.
+      /// \param[in] _topic Service name.
+      /// \return True if the service calls must be timed.
+      public: bool SrvTimingEnabled(const std::string &_topic);
+
+      /// \brief Account for a service request served by this process, once
+      /// its response is ready.
+      /// \param[in] _topic Service name.
+      /// \param[in] _received When the request was received.
+      /// \param[in] _started When the callback started.
+      /// \return The times to report to the requester, see
+      /// kSrvRequestTiming.
+      public: std::string SrvCallDone(const std::string &_topic,
+                                      const Timestamp &_received,
+                                      const Timestamp &_started);
+
+      /// \brief Account for a response received.
+      /// \param[in] _topic Service name.
+      /// \param[in] _pUuid Process UUID of the responser.
+      /// \param[in] _roundTrip Round trip time (ms).
+      /// \param[in] _timing Times reported by the responser, without the
+      /// leading flag. Empty if none.
+      public: void SrvResponseDone(const std::string &_topic,
+                                   const std::string &_pUuid,
+                                   const double _roundTrip,
+                                   const std::string &_timing);
+
+      /// \brief Notify a response received to its request handler and
+      /// remove the handler.
+      /// \param[in] _shared The shared node.
+      /// \param[in] _topic Service name.
+      /// \param[in] _nodeUuid UUID of the requesting node.
+      /// \param[in] _reqUuid UUID of the request.
+      /// \param[in] _rep Serialized response.
+      /// \param[in] _result Result of the service call.
+      /// \param[in] _timing Times reported by the responser, see
+      /// SrvResponseDone().
+      /// \param[in] _cacheTtl Time to live of the response reported by the
+      /// responser, zero if it can't be cached.
+      public: void NotifySrvResponse(NodeShared &_shared,
+                                     const std::string &_topic,
+                                     const std::string &_nodeUuid,
+                                     const std::string &_reqUuid,
+                                     const std::string &_rep,
+                                     const bool _result,
+                                     const std::string &_timing,
+                                     const std::chrono::milliseconds
+                                       &_cacheTtl);
+
+      /// \brief Get the identifier of a service in reqCache.
+      /// \param[in] _topic Service name.
+      /// \param[in] _reqType Type of the request.
+      /// \param[in] _repType Type of the response.
+      /// \return The identifier.
+      public: static std::string SrvCacheId(const std::string &_topic,
+                                            const std::string &_reqType,
+                                            const std::string &_repType);
+
+      /// \brief Responses of the cacheable services advertised by this
+      /// process, by handler UUID and request.
+      public: ReplyCache srvCache{kReplyCacheBytes};
+
+      /// \brief Responses received from the cacheable services, by service
+      /// (see SrvCacheId()) and request. The identical requests are
+      /// answered without being sent.
+      public: ReplyCache reqCache{kReplyCacheBytes};
+
+      /// \brief True if the statistics of all the services are enabled
+      /// (see GZ_TRANSPORT_SERVICE_STATISTICS).
+      public: bool srvStatsAll = false;
+
+      /// \brief The service calls slower than this are logged (ms). Zero
+      /// disables the log (see GZ_TRANSPORT_SLOW_SERVICE_CALL).
+      public: double srvSlowCall = 0;
+
+      /// \brief Protect enabledSrvStats and srvStats. The responses of the
+      /// service threads are accounted without NodeShared::mutex.
+      public: std::mutex srvStatsMutex;
+
+      /// \brief Services with statistics enabled by a node.
+      public: std::unordered_set<std::string> enabledSrvStats;
 
-      /// \brief Set of topics that have statistics enabled.
-      public: std::map<std::string,
-              std::function<void(const TopicStatistics &_stats)>>
-                enabledTopicStatistics;
+      /// \brief Statistics of the services. The key is the service name.
+      public: std::map<std::string, ServiceStatistics> srvStats;
     };
     }
   }
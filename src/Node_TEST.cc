@@ -20,16 +20,26 @@
 #include <gz/msgs/stringmsg.pb.h>
 #include <gz/msgs/vector3d.pb.h>
 
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <csignal>
 #include <cstdlib>
 #include <functional>
+#include <future>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <string_view>
 #include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #include "gz/transport/MessageInfo.hh"
 #include "gz/transport/Node.hh"
+#include "gz/transport/NodeShared.hh"
+#include "gz/transport/TopicUtils.hh"
 #include "gz/transport/TransportTypes.hh"
 
 #include <gz/utils/Environment.hh>
@@ -644,6 +654,144 @@ TEST(NodeTest, PubSubSameThread)
   reset();
 }
 
+//////////////////////////////////////////////////
+/// \brief The subscribers cached by the publishers are updated when a
+/// subscription is added or removed.
+TEST(NodeTest, PubSubCachedSubscribers)
+{
+  reset();
+
+  msgs::Int32 msg;
+  msg.set_data(data);
+
+  transport::Node node;
+  auto pub = node.Advertise<msgs::Int32>(g_topic);
+  EXPECT_TRUE(pub);
+
+  // No subscribers yet.
+  EXPECT_FALSE(pub.HasConnections());
+  EXPECT_TRUE(pub.Publish(msg));
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  EXPECT_FALSE(cbExecuted);
+
+  EXPECT_TRUE(node.Subscribe(g_topic, cb));
+  EXPECT_TRUE(pub.HasConnections());
+  EXPECT_TRUE(pub.Publish(msg));
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  EXPECT_TRUE(cbExecuted);
+
+  reset();
+
+  EXPECT_TRUE(node.Unsubscribe(g_topic));
+  EXPECT_FALSE(pub.HasConnections());
+  EXPECT_TRUE(pub.Publish(msg));
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  EXPECT_FALSE(cbExecuted);
+
+  reset();
+}
+
+//////////////////////////////////////////////////
+/// \brief The publishers of a topic share whether it has subscribers, and
+/// the publications without subscribers are dropped, unless they are kept
+/// for the late joiners.
+TEST(NodeTest, PubSubUnheardPublications)
+{
+  reset();
+
+  msgs::Int32 msg;
+  msg.set_data(data);
+
+  transport::Node node;
+  auto pub1 = node.Advertise<msgs::Int32>(g_topic);
+  auto pub2 = node.Advertise<msgs::Int32>(g_topic);
+  ASSERT_TRUE(pub1);
+  ASSERT_TRUE(pub2);
+  EXPECT_FALSE(pub1.HasConnections());
+  EXPECT_FALSE(pub2.HasConnections());
+  EXPECT_TRUE(pub1.Publish(msg));
+
+  std::atomic<int> rawReceived{0};
+  transport::RawCallback rawCb =
+    [&rawReceived](const char *, const std::size_t,
+                   const transport::MessageInfo &)
+  {
+    ++rawReceived;
+  };
+  ASSERT_TRUE(node.SubscribeRaw(g_topic, rawCb));
+  EXPECT_TRUE(pub1.HasConnections());
+  EXPECT_TRUE(pub2.HasConnections());
+  EXPECT_TRUE(pub2.Publish(msg));
+  for (int i = 0; i < 100 && rawReceived == 0; ++i)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_EQ(1, rawReceived);
+
+  EXPECT_TRUE(node.Unsubscribe(g_topic));
+  EXPECT_FALSE(pub1.HasConnections());
+  EXPECT_FALSE(pub2.HasConnections());
+
+  // A latched message published without subscribers reaches the next one.
+  transport::AdvertiseMessageOptions opts;
+  opts.SetHistoryDepth(1);
+  auto latched = node.Advertise<msgs::Int32>(g_topic_remap, opts);
+  ASSERT_TRUE(latched);
+  EXPECT_FALSE(latched.HasConnections());
+  EXPECT_TRUE(latched.Publish(msg));
+  EXPECT_TRUE(node.Subscribe(g_topic_remap, cb));
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  EXPECT_TRUE(cbExecuted);
+
+  reset();
+}
+
+//////////////////////////////////////////////////
+/// \brief PublishLazy() only builds the message when it would be sent.
+TEST(NodeTest, PubSubLazyPublications)
+{
+  reset();
+
+  transport::Node node;
+  auto pub = node.Advertise<msgs::Int32>(g_topic);
+  ASSERT_TRUE(pub);
+  EXPECT_FALSE(pub.WantsData());
+
+  int filled = 0;
+  std::function<void(msgs::Int32 &)> fill =
+    [&filled](msgs::Int32 &_msg)
+  {
+    _msg.set_data(data);
+    ++filled;
+  };
+  EXPECT_TRUE(pub.PublishLazy(fill));
+  EXPECT_EQ(0, filled);
+
+  EXPECT_TRUE(node.Subscribe(g_topic, cb));
+  EXPECT_TRUE(pub.WantsData());
+  EXPECT_TRUE(pub.PublishLazy(fill));
+  EXPECT_EQ(1, filled);
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  EXPECT_TRUE(cbExecuted);
+
+  // The type is checked at runtime through the untyped publisher.
+  transport::Node::Publisher untyped = pub;
+  EXPECT_TRUE(untyped.PublishLazy(fill));
+  EXPECT_EQ(2, filled);
+  std::function<void(msgs::Vector3d &)> wrongFill =
+    [](msgs::Vector3d &) {};
+  EXPECT_FALSE(untyped.PublishLazy(wrongFill));
+
+  EXPECT_TRUE(node.Unsubscribe(g_topic));
+  EXPECT_FALSE(pub.WantsData());
+  EXPECT_TRUE(pub.PublishLazy(fill));
+  EXPECT_EQ(2, filled);
+
+  transport::Node::Publisher invalid;
+  EXPECT_FALSE(invalid.WantsData());
+  EXPECT_FALSE(invalid.PublishLazy(fill));
+
+  reset();
+}
+
 //////////////////////////////////////////////////
 /// \brief A thread can create a node, and send and receive messages.
 TEST(NodeTest, PubSubSameThreadGenericCb)
@@ -729,6 +877,85 @@ TEST(NodeTest, PubSubSameThreadMessageInfo)
   reset();
 }
 
+//////////////////////////////////////////////////
+/// \brief Publish a message by shared ownership and check that local
+/// subscribers receive the same object, without any copy.
+TEST(NodeTest, PubSubSameThreadSharedPtr)
+{
+  reset();
+
+  auto msg = std::make_shared<msgs::Int32>();
+  msg->set_data(data);
+
+  transport::Node node;
+  auto pub = node.Advertise<msgs::Int32>(g_topic);
+  EXPECT_TRUE(pub);
+
+  std::mutex mutex;
+  std::condition_variable condition;
+  const msgs::Int32 *received = nullptr;
+
+  std::function<void(const std::shared_ptr<const msgs::Int32> &,
+                     const transport::MessageInfo &)> sharedCb =
+    [&](const std::shared_ptr<const msgs::Int32> &_msg,
+        const transport::MessageInfo &_info)
+  {
+    EXPECT_EQ(_msg->data(), data);
+    EXPECT_TRUE(_info.IntraProcess());
+    std::lock_guard<std::mutex> lk(mutex);
+    received = _msg.get();
+    condition.notify_all();
+  };
+
+  EXPECT_TRUE(node.Subscribe(g_topic, sharedCb));
+  EXPECT_TRUE(node.Subscribe(g_topic, cbInfo));
+
+  // Wait some time before publishing.
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  // A NULL message is rejected.
+  EXPECT_FALSE(pub.Publish(std::shared_ptr<const msgs::Int32>()));
+
+  EXPECT_TRUE(pub.Publish(msg));
+
+  {
+    std::unique_lock<std::mutex> lk(mutex);
+    condition.wait_for(lk, std::chrono::seconds(1),
+      [&received]{return received != nullptr;});
+    EXPECT_EQ(msg.get(), received);
+  }
+
+  // Give some time to the subscribers.
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  EXPECT_TRUE(cbExecuted);
+
+  reset();
+
+  // Transfer the ownership of a message.
+  auto uniqueMsg = std::make_unique<msgs::Int32>();
+  uniqueMsg->set_data(data);
+  const msgs::Int32 *expected = uniqueMsg.get();
+  {
+    std::lock_guard<std::mutex> lk(mutex);
+    received = nullptr;
+  }
+
+  EXPECT_TRUE(pub.Publish(std::move(uniqueMsg)));
+
+  {
+    std::unique_lock<std::mutex> lk(mutex);
+    condition.wait_for(lk, std::chrono::seconds(1),
+      [&received]{return received != nullptr;});
+    EXPECT_EQ(expected, received);
+  }
+
+  // Give some time to the subscribers.
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  EXPECT_TRUE(cbExecuted);
+
+  reset();
+}
+
 //////////////////////////////////////////////////
 TEST(NodeTest, RawPubSubSameThreadMessageInfo)
 {
@@ -769,6 +996,58 @@ TEST(NodeTest, RawPubSubSameThreadMessageInfo)
   reset();
 }
 
+//////////////////////////////////////////////////
+/// \brief Deserialize the raw publications on an arena and keep a message
+/// after its callback.
+TEST(NodeTest, RawPubSubArenaAllocation)
+{
+  reset();
+
+  msgs::Int32 msg;
+  msg.set_data(data);
+
+  transport::Node node;
+  auto pub = node.Advertise<msgs::Int32>(g_topic);
+  EXPECT_TRUE(pub);
+
+  std::mutex mutex;
+  std::vector<std::shared_ptr<const msgs::Int32>> received;
+  std::function<void(const std::shared_ptr<const msgs::Int32> &,
+                     const transport::MessageInfo &)> sharedCb =
+    [&](const std::shared_ptr<const msgs::Int32> &_msg,
+        const transport::MessageInfo &)
+  {
+    EXPECT_NE(nullptr, _msg->GetArena());
+    std::lock_guard<std::mutex> lk(mutex);
+    received.push_back(_msg);
+  };
+
+  transport::SubscribeOptions opts;
+  opts.SetArenaAllocation(true);
+  EXPECT_TRUE(node.Subscribe(g_topic, sharedCb, opts));
+
+  // Wait some time before publishing.
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  for (auto i = 0; i < 3; ++i)
+  {
+    msg.set_data(i);
+    EXPECT_TRUE(pub.PublishRaw(msg.SerializeAsString(), msg.GetTypeName()));
+  }
+
+  // Give some time to the subscribers.
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  // Every message kept its own arena.
+  std::lock_guard<std::mutex> lk(mutex);
+  ASSERT_EQ(3u, received.size());
+  for (auto i = 0; i < 3; ++i)
+    EXPECT_EQ(i, received[i]->data());
+  EXPECT_NE(received[0]->GetArena(), received[1]->GetArena());
+
+  reset();
+}
+
 //////////////////////////////////////////////////
 TEST(NodeTest, RawPubRawSubSameThreadMessageInfo)
 {
@@ -850,55 +1129,144 @@ TEST(NodeTest, PubRawSubSameThreadMessageInfo)
 }
 
 //////////////////////////////////////////////////
-/// \brief Subscribe to a topic using a lambda function.
-TEST(NodeTest, PubSubSameThreadLambda)
+/// \brief Subscriber whose member function records the messages.
+class RecordingSubscriber
+{
+  /// \brief Member function callback.
+  public: void OnMsg(const msgs::Int32 &_msg)
+  {
+    std::lock_guard<std::mutex> lk(this->mutex);
+    this->values.push_back(_msg.data());
+    this->condition.notify_all();
+  }
+
+  /// \brief Protects values.
+  public: std::mutex mutex;
+
+  /// \brief Signaled when a message is received.
+  public: std::condition_variable condition;
+
+  /// \brief Values of the messages received.
+  public: std::vector<int> values;
+};
+
+//////////////////////////////////////////////////
+/// \brief A member function subscriber receiving serialized messages,
+/// which are parsed into a message reused between deliveries. Fields not
+/// present in a message must not keep the value of the previous one.
+TEST(NodeTest, PubRawSubMemberFunctionReusedMessage)
+{
+  transport::Node node;
+  auto pub = node.Advertise<msgs::Int32>(g_topic);
+  EXPECT_TRUE(pub);
+
+  RecordingSubscriber sub;
+  EXPECT_TRUE(node.Subscribe(g_topic, &RecordingSubscriber::OnMsg, &sub));
+
+  msgs::Int32 msg;
+  msg.set_data(data);
+  EXPECT_TRUE(pub.PublishRaw(msg.SerializeAsString(), msg.GetTypeName()));
+  // A zero is not serialized.
+  msg.set_data(0);
+  EXPECT_TRUE(pub.PublishRaw(msg.SerializeAsString(), msg.GetTypeName()));
+  msg.set_data(data + 1);
+  EXPECT_TRUE(pub.PublishRaw(msg.SerializeAsString(), msg.GetTypeName()));
+
+  std::unique_lock<std::mutex> lk(sub.mutex);
+  EXPECT_TRUE(sub.condition.wait_for(lk, std::chrono::seconds(5),
+    [&sub]{return sub.values.size() == 3u;}));
+  EXPECT_EQ((std::vector<int>{data, 0, data + 1}), sub.values);
+}
+
+//////////////////////////////////////////////////
+/// \brief Publish raw messages from a buffer of the caller, with the
+/// advertised type, and receive them as views.
+TEST(NodeTest, PubRawSubView)
 {
   reset();
 
   msgs::Int32 msg;
   msg.set_data(data);
+  const std::string serialized = msg.SerializeAsString();
 
   transport::Node node;
-
   auto pub = node.Advertise<msgs::Int32>(g_topic);
   EXPECT_TRUE(pub);
 
   std::mutex mutex;
-  std::condition_variable condition;
+  std::vector<int> values;
+  EXPECT_TRUE(node.SubscribeRaw(g_topic,
+    [&](std::string_view _msgData, const transport::MessageInfo &_info)
+    {
+      std::lock_guard<std::mutex> lk(mutex);
+      EXPECT_EQ(msg.GetTypeName(), _info.Type());
+      msgs::Int32 received;
+      EXPECT_TRUE(received.ParseFromArray(_msgData.data(),
+        static_cast<int>(_msgData.size())));
+      values.push_back(received.data());
+    }));
 
-  bool executed = false;
-  std::function<void(const msgs::Int32&)> subCb =
-    [&executed, &mutex, &condition](const msgs::Int32 &_msg)
+  std::vector<char> buffer(serialized.begin(), serialized.end());
+  EXPECT_TRUE(pub.PublishRaw(std::string_view(buffer.data(), buffer.size())));
+
+  // The buffer can be reused right away.
+  std::fill(buffer.begin(), buffer.end(), 0);
+  EXPECT_TRUE(pub.PublishRaw(serialized));
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
   {
-    EXPECT_EQ(_msg.data(), data);
     std::lock_guard<std::mutex> lk(mutex);
-    executed = true;
-    condition.notify_all();
-  };
+    EXPECT_EQ((std::vector<int>{data, data}), values);
+  }
 
-  EXPECT_TRUE(node.Subscribe(g_topic, subCb));
+  // A generic publisher doesn't know the type of the message.
+  auto genericPub = node.Advertise(g_topic + "_generic",
+    transport::kGenericMessageType);
+  EXPECT_TRUE(genericPub);
+  EXPECT_FALSE(genericPub.PublishRaw(std::string_view(serialized)));
 
-  // Give some time to the subscribers.
-  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  transport::Node::Publisher invalid;
+  EXPECT_FALSE(invalid.PublishRaw(std::string_view(serialized)));
+}
 
-  // Publish a first message.
-  EXPECT_TRUE(pub.Publish(msg));
+//////////////////////////////////////////////////
+/// \brief The slow subscribers aren't detected unless
+/// GZ_TRANSPORT_SLOW_SUBSCRIBER is set, and the rate of the topic is kept.
+TEST(NodeTest, SlowSubscriberDisabled)
+{
+  reset();
 
-  // The local publish is asynchronous, which means we need to wait
-  // for the callback.
-  std::unique_lock<std::mutex> lk(mutex);
-  condition.wait(lk, [&executed]{return executed;});
+  transport::Node node;
+  transport::AdvertiseMessageOptions opts;
+  opts.SetSlowSubscriberMsgsPerSec(1);
+  auto pub = node.Advertise<msgs::Int32>(g_topic, opts);
+  EXPECT_TRUE(pub);
+  EXPECT_FALSE(pub.SetSlowSubscriberCallback(
+    [](const std::string &, const bool, const uint64_t) {}));
+  EXPECT_EQ(0u, pub.SlowSubscribers());
 
-  EXPECT_TRUE(executed);
+  std::atomic<int> count{0};
+  std::function<void(const msgs::Int32 &)> countCb =
+    [&](const msgs::Int32 &) { ++count; };
+  EXPECT_TRUE(node.Subscribe(g_topic, countCb));
 
-  reset();
+  msgs::Int32 msg;
+  msg.set_data(data);
+  for (int i = 0; i < 5; ++i)
+    EXPECT_TRUE(pub.Publish(msg));
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  EXPECT_EQ(5, count);
+
+  transport::Node::Publisher invalid;
+  EXPECT_FALSE(invalid.SetSlowSubscriberCallback(nullptr));
+  EXPECT_EQ(0u, invalid.SlowSubscribers());
 }
 
 //////////////////////////////////////////////////
-/// \brief Subscribe to a topic using a lambda function.
-/// This test uses a callback that accepts a parameter with the message
-/// information.
-TEST(NodeTest, PubSubSameThreadLambdaMessageInfo)
+/// \brief Check that a raw callback can keep a reference to the message data
+/// after it returns.
+TEST(NodeTest, PubRawSubShared)
 {
   reset();
 
@@ -906,40 +1274,268 @@ TEST(NodeTest, PubSubSameThreadLambdaMessageInfo)
   msg.set_data(data);
 
   transport::Node node;
-
   auto pub = node.Advertise<msgs::Int32>(g_topic);
   EXPECT_TRUE(pub);
 
-  bool executed = false;
-  std::function<void(const msgs::Int32&,
-                     const transport::MessageInfo &)> subCb =
-    [&executed](const msgs::Int32 &_msg,
-                const transport::MessageInfo &_info)
-  {
-    EXPECT_EQ(_info.Topic(), g_topic);
-    EXPECT_EQ(_msg.data(), data);
-    EXPECT_EQ(g_FQNPartition, _info.Partition());
-    EXPECT_EQ(_msg.GetTypeName(), _info.Type());
-    EXPECT_TRUE(_info.IntraProcess());
-    std::lock_guard<std::mutex> lk(cbMutex);
-    executed = true;
-    cbCondition.notify_all();
-  };
-
-  EXPECT_TRUE(node.Subscribe(g_topic, subCb));
+  std::mutex mutex;
+  std::shared_ptr<const char> kept;
+  std::size_t keptSize = 0;
+  EXPECT_TRUE(node.SubscribeRaw(g_topic,
+    [&](const std::shared_ptr<const char> &_msgData, const size_t _size,
+        const transport::MessageInfo &_info)
+    {
+      std::lock_guard<std::mutex> lk(mutex);
+      EXPECT_EQ(msg.GetTypeName(), _info.Type());
+      kept = _msgData;
+      keptSize = _size;
+      cbExecuted = true;
+    }));
 
-  // Give some time to the subscribers.
   std::this_thread::sleep_for(std::chrono::milliseconds(100));
 
-  // Publish a first message.
-  std::unique_lock<std::mutex> lk(cbMutex);
-  EXPECT_TRUE(pub.Publish(msg));
-  cbCondition.wait(lk, [&executed]{return executed;});
+  // Raw and regular publications are both shared.
+  for (const bool raw : {false, true})
+  {
+    if (raw)
+      EXPECT_TRUE(pub.PublishRaw(msg.SerializeAsString(), msg.GetTypeName()));
+    else
+      EXPECT_TRUE(pub.Publish(msg));
 
-  EXPECT_TRUE(executed);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT_TRUE(cbExecuted);
 
-  reset();
-}
+    std::lock_guard<std::mutex> lk(mutex);
+    ASSERT_NE(nullptr, kept);
+    msgs::Int32 received;
+    EXPECT_TRUE(received.ParseFromArray(kept.get(),
+      static_cast<int>(keptSize)));
+    EXPECT_EQ(data, received.data());
+    kept.reset();
+
+    reset();
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that the serialization buffers are recycled when the
+/// buffer pool is enabled.
+TEST(NodeTest, PubRawSubBufferPool)
+{
+  reset();
+
+  msgs::Int32 msg;
+  msg.set_data(data);
+
+  transport::Node node;
+  auto pub = node.Advertise<msgs::Int32>(g_topic);
+  EXPECT_TRUE(pub);
+
+  // The pool is disabled by default.
+  EXPECT_EQ(0u, pub.BufferPoolHits());
+  EXPECT_EQ(0u, pub.BufferPoolMisses());
+
+  EXPECT_TRUE(node.SubscribeRaw(g_topic, rawCbInfo));
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  EXPECT_TRUE(pub.Publish(msg));
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  EXPECT_TRUE(cbExecuted);
+  EXPECT_EQ(0u, pub.BufferPoolHits());
+  EXPECT_EQ(0u, pub.BufferPoolMisses());
+
+  reset();
+
+  transport::Node node2;
+  transport::AdvertiseMessageOptions opts;
+  opts.SetBufferPoolSize(4096u);
+  auto pooledPub = node2.Advertise<msgs::Int32>(g_topic + "_pool", opts);
+  EXPECT_TRUE(pooledPub);
+
+  EXPECT_TRUE(node2.SubscribeRaw(g_topic + "_pool",
+    [](const char *, const size_t, const transport::MessageInfo &)
+    {
+      cbExecuted = true;
+    }));
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  // The first publication allocates a new buffer.
+  EXPECT_TRUE(pooledPub.Publish(msg));
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  EXPECT_TRUE(cbExecuted);
+  EXPECT_EQ(0u, pooledPub.BufferPoolHits());
+  EXPECT_EQ(1u, pooledPub.BufferPoolMisses());
+
+  reset();
+
+  // The buffer has been released and it should be reused now.
+  EXPECT_TRUE(pooledPub.Publish(msg));
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  EXPECT_TRUE(cbExecuted);
+  EXPECT_EQ(1u, pooledPub.BufferPoolHits());
+  EXPECT_EQ(1u, pooledPub.BufferPoolMisses());
+
+  reset();
+}
+
+//////////////////////////////////////////////////
+/// \brief Publish a message serialized into a loaned buffer.
+TEST(NodeTest, PubLoanedSubSameThread)
+{
+  msgs::Int32 msg;
+  msg.set_data(data);
+  const std::string serialized = msg.SerializeAsString();
+
+  transport::Node node;
+  transport::Node::Publisher invalidPub;
+  EXPECT_FALSE(invalidPub.Loan(serialized.size()));
+
+  auto pub = node.Advertise<msgs::Int32>(g_topic);
+  EXPECT_TRUE(pub);
+
+  std::mutex mutex;
+  std::condition_variable condition;
+  std::string rawData;
+  int localData = 0;
+
+  std::function<void(const msgs::Int32 &)> cb =
+    [&](const msgs::Int32 &_msg)
+  {
+    std::lock_guard<std::mutex> lk(mutex);
+    localData = _msg.data();
+    condition.notify_all();
+  };
+
+  EXPECT_TRUE(node.Subscribe(g_topic, cb));
+  EXPECT_TRUE(node.SubscribeRaw(g_topic,
+    [&](const char *_data, const size_t _size, const transport::MessageInfo &)
+    {
+      std::lock_guard<std::mutex> lk(mutex);
+      rawData.assign(_data, _size);
+      condition.notify_all();
+    }));
+
+  // Loan a larger buffer and shrink it to the size of the message.
+  auto loan = pub.Loan(serialized.size() + 16);
+  ASSERT_TRUE(loan);
+  EXPECT_EQ(serialized.size() + 16, loan.Size());
+  EXPECT_FALSE(loan.Resize(serialized.size() + 17));
+  EXPECT_TRUE(loan.Resize(serialized.size()));
+  EXPECT_EQ(serialized.size(), loan.Size());
+  ASSERT_TRUE(msg.SerializeToArray(loan.Data(),
+    static_cast<int>(loan.Size())));
+
+  // The type must match the advertised type.
+  auto wrongLoan = pub.Loan(serialized.size());
+  EXPECT_FALSE(pub.PublishLoaned(std::move(wrongLoan), "gz.msgs.Vector3d"));
+  EXPECT_FALSE(wrongLoan);
+
+  EXPECT_TRUE(pub.PublishLoaned(std::move(loan), msg.GetTypeName()));
+  EXPECT_FALSE(loan);
+  EXPECT_EQ(0u, loan.Size());
+  EXPECT_EQ(nullptr, loan.Data());
+
+  // A loan can only be published once.
+  EXPECT_FALSE(pub.PublishLoaned(std::move(loan), msg.GetTypeName()));
+
+  std::unique_lock<std::mutex> lk(mutex);
+  condition.wait_for(lk, std::chrono::seconds(1),
+    [&]{return !rawData.empty() && localData != 0;});
+  EXPECT_EQ(serialized, rawData);
+  EXPECT_EQ(data, localData);
+}
+
+//////////////////////////////////////////////////
+/// \brief Subscribe to a topic using a lambda function.
+TEST(NodeTest, PubSubSameThreadLambda)
+{
+  reset();
+
+  msgs::Int32 msg;
+  msg.set_data(data);
+
+  transport::Node node;
+
+  auto pub = node.Advertise<msgs::Int32>(g_topic);
+  EXPECT_TRUE(pub);
+
+  std::mutex mutex;
+  std::condition_variable condition;
+
+  bool executed = false;
+  std::function<void(const msgs::Int32&)> subCb =
+    [&executed, &mutex, &condition](const msgs::Int32 &_msg)
+  {
+    EXPECT_EQ(_msg.data(), data);
+    std::lock_guard<std::mutex> lk(mutex);
+    executed = true;
+    condition.notify_all();
+  };
+
+  EXPECT_TRUE(node.Subscribe(g_topic, subCb));
+
+  // Give some time to the subscribers.
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  // Publish a first message.
+  EXPECT_TRUE(pub.Publish(msg));
+
+  // The local publish is asynchronous, which means we need to wait
+  // for the callback.
+  std::unique_lock<std::mutex> lk(mutex);
+  condition.wait(lk, [&executed]{return executed;});
+
+  EXPECT_TRUE(executed);
+
+  reset();
+}
+
+//////////////////////////////////////////////////
+/// \brief Subscribe to a topic using a lambda function.
+/// This test uses a callback that accepts a parameter with the message
+/// information.
+TEST(NodeTest, PubSubSameThreadLambdaMessageInfo)
+{
+  reset();
+
+  msgs::Int32 msg;
+  msg.set_data(data);
+
+  transport::Node node;
+
+  auto pub = node.Advertise<msgs::Int32>(g_topic);
+  EXPECT_TRUE(pub);
+
+  bool executed = false;
+  std::function<void(const msgs::Int32&,
+                     const transport::MessageInfo &)> subCb =
+    [&executed](const msgs::Int32 &_msg,
+                const transport::MessageInfo &_info)
+  {
+    EXPECT_EQ(_info.Topic(), g_topic);
+    EXPECT_EQ(_msg.data(), data);
+    EXPECT_EQ(g_FQNPartition, _info.Partition());
+    EXPECT_EQ(_msg.GetTypeName(), _info.Type());
+    EXPECT_TRUE(_info.IntraProcess());
+    std::lock_guard<std::mutex> lk(cbMutex);
+    executed = true;
+    cbCondition.notify_all();
+  };
+
+  EXPECT_TRUE(node.Subscribe(g_topic, subCb));
+
+  // Give some time to the subscribers.
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  // Publish a first message.
+  std::unique_lock<std::mutex> lk(cbMutex);
+  EXPECT_TRUE(pub.Publish(msg));
+  cbCondition.wait(lk, [&executed]{return executed;});
+
+  EXPECT_TRUE(executed);
+
+  reset();
+}
 
 //////////////////////////////////////////////////
 /// \brief Advertise two topics with the same name. It's not possible to do it
@@ -1200,6 +1796,58 @@ TEST(NodeTest, TypeMismatch)
   reset();
 }
 
+//////////////////////////////////////////////////
+/// \brief Advertise<MessageT>() returns a TypedPublisher, which publishes
+/// MessageT without runtime type check and is still a Publisher.
+TEST(NodeTest, TypedPublisher)
+{
+  static_assert(std::is_same_v<transport::Node::TypedPublisher<msgs::Int32>,
+    decltype(std::declval<transport::Node>().Advertise<msgs::Int32>(""))>);
+
+  msgs::Int32 msg;
+  msg.set_data(data);
+  msgs::Vector3d wrongMsg;
+
+  transport::Node node;
+  auto pub = node.Advertise<msgs::Int32>(g_topic);
+  EXPECT_TRUE(pub);
+
+  std::mutex mutex;
+  std::condition_variable condition;
+  int received = 0;
+  std::function<void(const msgs::Int32&)> subCb =
+    [&received, &mutex, &condition](const msgs::Int32 &_msg)
+  {
+    EXPECT_EQ(_msg.data(), data);
+    std::lock_guard<std::mutex> lk(mutex);
+    ++received;
+    condition.notify_all();
+  };
+  EXPECT_TRUE(node.Subscribe(g_topic, subCb));
+
+  // Statically typed.
+  EXPECT_TRUE(pub.Publish(msg));
+
+  // The other overloads are checked at runtime.
+  const transport::ProtoMsg &wrongRef = wrongMsg;
+  EXPECT_FALSE(pub.Publish(wrongRef));
+  EXPECT_TRUE(pub.Publish(std::make_unique<msgs::Int32>(msg)));
+
+  // Same publication through the base class.
+  transport::Node::Publisher base = pub;
+  EXPECT_FALSE(base.Publish(wrongMsg));
+  EXPECT_TRUE(base.Publish(msg));
+
+  std::unique_lock<std::mutex> lk(mutex);
+  EXPECT_TRUE(condition.wait_for(lk, std::chrono::seconds(5),
+    [&received]{return received == 3;}));
+
+  // A default constructed publisher is invalid.
+  transport::Node::TypedPublisher<msgs::Int32> invalid;
+  EXPECT_FALSE(invalid);
+  EXPECT_FALSE(invalid.Publish(msg));
+}
+
 //////////////////////////////////////////////////
 /// \brief Make an asynchronous service call using free function.
 TEST(NodeTest, ServiceCallAsync)
@@ -1407,6 +2055,127 @@ TEST(NodeTest, ServiceCallAsyncLambda)
   reset();
 }
 
+//////////////////////////////////////////////////
+/// \brief Advertise a service sending its responses from another thread,
+/// after the callback returned.
+TEST(NodeTest, ServiceCallDeferred)
+{
+  reset();
+
+  std::vector<std::thread> workers;
+  std::function<void(const msgs::Int32 &,
+                     transport::ServiceResponder<msgs::Int32>)> advCb =
+    [&workers](const msgs::Int32 &_req,
+               transport::ServiceResponder<msgs::Int32> _responder)
+  {
+    // Drop the requests with a negative value without replying.
+    if (_req.data() < 0)
+      return;
+
+    workers.emplace_back([_req, _responder]()
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+      msgs::Int32 rep;
+      rep.set_data(_req.data());
+      EXPECT_TRUE(_responder.Pending());
+      EXPECT_TRUE(_responder.Reply(rep));
+      EXPECT_FALSE(_responder.Reply(rep));
+      EXPECT_FALSE(_responder.Pending());
+    });
+  };
+
+  transport::Node node;
+  EXPECT_TRUE(node.Advertise(g_topic, advCb));
+
+  msgs::Int32 req;
+  msgs::Int32 rep;
+  bool result = false;
+  req.set_data(data);
+  EXPECT_TRUE(node.Request(g_topic, req, 1000, rep, result));
+  EXPECT_TRUE(result);
+  EXPECT_EQ(data, rep.data());
+
+  // A responder destroyed without replying sends a failed response.
+  req.set_data(-1);
+  EXPECT_TRUE(node.Request(g_topic, req, 1000, rep, result));
+  EXPECT_FALSE(result);
+
+  for (auto &worker : workers)
+    worker.join();
+
+  reset();
+}
+
+//////////////////////////////////////////////////
+/// \brief An asynchronous request to a responder in the same process that
+/// defers its response doesn't block the requester.
+TEST(NodeTest, ServiceCallDeferredAsync)
+{
+  std::vector<transport::ServiceResponder<msgs::Int32>> responders;
+  std::function<void(const msgs::Int32 &,
+                     transport::ServiceResponder<msgs::Int32>)> advCb =
+    [&responders](const msgs::Int32 &,
+                  transport::ServiceResponder<msgs::Int32> _responder)
+  {
+    responders.push_back(_responder);
+  };
+
+  transport::Node node;
+  EXPECT_TRUE(node.Advertise(g_topic, advCb));
+
+  bool replied = false;
+  int repData = 0;
+  std::function<void(const msgs::Int32 &, const bool)> cb =
+    [&replied, &repData](const msgs::Int32 &_rep, const bool _result)
+  {
+    EXPECT_TRUE(_result);
+    repData = _rep.data();
+    replied = true;
+  };
+
+  msgs::Int32 req;
+  req.set_data(data);
+  EXPECT_TRUE(node.Request(g_topic, req, cb));
+  ASSERT_EQ(1u, responders.size());
+  EXPECT_FALSE(replied);
+
+  // The callback is executed by the thread replying.
+  msgs::Int32 rep;
+  rep.set_data(data);
+  EXPECT_TRUE(responders[0].Reply(rep));
+  EXPECT_TRUE(replied);
+  EXPECT_EQ(data, repData);
+}
+
+//////////////////////////////////////////////////
+/// \brief Make asynchronous service calls returning a future.
+TEST(NodeTest, ServiceCallAsyncFuture)
+{
+  reset();
+
+  transport::Node node;
+  EXPECT_TRUE(node.Advertise(g_topic, srvEcho));
+
+  msgs::Int32 req;
+  req.set_data(data);
+  auto future =
+    node.RequestAsync<msgs::Int32, msgs::Int32>(g_topic, req, 1000);
+  ASSERT_EQ(std::future_status::ready,
+    future.wait_for(std::chrono::milliseconds(1000)));
+  auto response = future.get();
+  EXPECT_TRUE(response.second);
+  EXPECT_EQ(data, response.first.data());
+
+  // Without responder, the request is abandoned after the timeout.
+  future = node.RequestAsync<msgs::Int32, msgs::Int32>(
+    "/unknown_service", req, 200);
+  ASSERT_EQ(std::future_status::ready,
+    future.wait_for(std::chrono::milliseconds(2000)));
+  EXPECT_FALSE(future.get().second);
+
+  reset();
+}
+
 //////////////////////////////////////////////////
 /// \brief Make an asynchronous service call without input using lambdas.
 TEST(NodeTest, ServiceCallWithoutInputAsyncLambda)
@@ -1721,21 +2490,94 @@ TEST(NodeTest, ServiceCallSyncTimeout)
 }
 
 //////////////////////////////////////////////////
-/// \brief Check a timeout in a synchronous service call without input.
-TEST(NodeTest, ServiceCallWithoutInputSyncTimeout)
+/// \brief Many blocking requests expire concurrently, each one close to its
+/// own timeout, shorter than the polling period of the reception thread.
+TEST(NodeTest, ServiceCallSyncTimeoutConcurrent)
 {
-  reset();
-
-  msgs::Int32 rep;
-  bool result;
-  int64_t timeout = 1000;
-
   transport::Node node;
+  std::vector<std::thread> threads;
+  std::atomic<int> expired{0};
+  for (int i = 0; i < 32; ++i)
+  {
+    threads.emplace_back([&node, &expired, i]()
+    {
+      msgs::Int32 req;
+      msgs::Int32 rep;
+      bool result;
+      const int64_t timeout = 50 + 5 * (i % 4);
+      auto t1 = std::chrono::steady_clock::now();
+      if (!node.Request("/sync_timeout_concurrent", req,
+            static_cast<unsigned int>(timeout), rep, result))
+      {
+        ++expired;
+      }
+      const int64_t elapsed = std::chrono::duration_cast<
+        std::chrono::milliseconds>(std::chrono::steady_clock::now() - t1)
+          .count();
+      EXPECT_GE(elapsed, timeout);
+      EXPECT_LE(elapsed, timeout + 150);
+    });
+  }
 
-  auto t1 = std::chrono::steady_clock::now();
-  bool executed = node.Request(g_topic, static_cast<unsigned int>(timeout),
-      rep, result);
-  auto t2 = std::chrono::steady_clock::now();
+  for (auto &thread : threads)
+    thread.join();
+  EXPECT_EQ(32, expired);
+}
+
+//////////////////////////////////////////////////
+/// \brief The response callbacks of a node with a response executor run on
+/// the executor, including the ones of the requests that time out.
+TEST(NodeTest, ServiceCallResponseExecutor)
+{
+  auto executor = std::make_shared<transport::Executor>();
+  transport::NodeOptions opts;
+  opts.SetResponseExecutor(executor);
+  transport::Node node(opts);
+
+  std::atomic<bool> called{false};
+  std::atomic<bool> result{true};
+  std::thread::id thread;
+  std::function<void(const std::string &, const bool)> cb =
+    [&](const std::string &, const bool _result)
+  {
+    thread = std::this_thread::get_id();
+    result = _result;
+    called = true;
+  };
+
+  msgs::Int32 req;
+  req.set_data(data);
+  EXPECT_TRUE(node.RequestRaw("/response_executor", req.SerializeAsString(),
+    req.GetTypeName(), req.GetTypeName(), 50, cb));
+
+  // The request expires, its callback waits for the executor.
+  for (int i = 0; i < 100 && executor->Pending() == 0; ++i)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_FALSE(called);
+  EXPECT_EQ(1u, executor->Pending());
+
+  EXPECT_TRUE(executor->SpinOnce());
+  EXPECT_TRUE(called);
+  EXPECT_FALSE(result);
+  EXPECT_EQ(std::this_thread::get_id(), thread);
+}
+
+//////////////////////////////////////////////////
+/// \brief Check a timeout in a synchronous service call without input.
+TEST(NodeTest, ServiceCallWithoutInputSyncTimeout)
+{
+  reset();
+
+  msgs::Int32 rep;
+  bool result;
+  int64_t timeout = 1000;
+
+  transport::Node node;
+
+  auto t1 = std::chrono::steady_clock::now();
+  bool executed = node.Request(g_topic, static_cast<unsigned int>(timeout),
+      rep, result);
+  auto t2 = std::chrono::steady_clock::now();
 
   int64_t elapsed =
     std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count();
@@ -1865,93 +2707,610 @@ TEST(NodeTest, PubSubWrongTypesOnPublish)
 
   reset();
 
-  // Publish a second message on topic.
-  EXPECT_TRUE(pub.Publish(msg));
+  // Publish a second message on topic.
+  EXPECT_TRUE(pub.Publish(msg));
+
+  // Give some time to the subscribers.
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  // Check that the data was received.
+  EXPECT_TRUE(cbExecuted);
+
+  reset();
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that a message is not received if the callback does not use
+/// the advertised types.
+TEST(NodeTest, PubSubWrongTypesOnSubscription)
+{
+  reset();
+
+  msgs::Vector3d msgV;
+  msgV.set_x(1);
+  msgV.set_y(2);
+  msgV.set_z(3);
+
+  transport::Node node;
+
+  auto pub = node.Advertise<msgs::Vector3d>(g_topic);
+  EXPECT_TRUE(pub);
+
+  EXPECT_TRUE(node.Subscribe(g_topic, cb));
+
+  // Wait some time before publishing.
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  // Send a message with a wrong type.
+  EXPECT_TRUE(pub.Publish(msgV));
+
+  // Check that the message was not received.
+  EXPECT_FALSE(cbExecuted);
+
+  reset();
+}
+
+//////////////////////////////////////////////////
+/// \brief This test spawns two subscribers on the same topic. One of the
+/// subscribers has a wrong callback (types in the callback does not match the
+/// advertised type). Check that only the good callback is executed.
+TEST(NodeTest, PubSubWrongTypesTwoSubscribers)
+{
+  reset();
+
+  msgs::Int32 msg;
+  msg.set_data(data);
+
+  transport::Node node1;
+  transport::Node node2;
+
+  auto pub1 = node1.Advertise<msgs::Int32>(g_topic);
+  EXPECT_TRUE(pub1);
+
+  // Good subscriber.
+  EXPECT_TRUE(node1.Subscribe(g_topic, cb));
+
+  // Bad subscriber: cbVector does not match the types advertised by node1.
+  EXPECT_TRUE(node2.Subscribe(g_topic, cbVector));
+
+  // Wait some time before publishing.
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  EXPECT_TRUE(pub1.Publish(msg));
+
+  // Give some time to the subscribers.
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  // Check that the message was received by node1.
+  EXPECT_TRUE(cbExecuted);
+
+  // Check that the message was not received by node2.
+  EXPECT_FALSE(cbVectorExecuted);
+
+  reset();
+}
+
+//////////////////////////////////////////////////
+/// \brief Subscribe with a callback that receives a lazy message and only
+/// deserializes some of the updates.
+TEST(NodeTest, PubSubSameThreadLazy)
+{
+  reset();
+
+  msgs::Int32 msg;
+  msg.set_data(data);
+
+  transport::Node node;
+  auto pub = node.Advertise<msgs::Int32>(g_topic);
+  EXPECT_TRUE(pub);
+
+  std::atomic<int> received{0};
+  std::atomic<int> parsed{0};
+
+  // Only parse every other message.
+  std::function<void(const transport::LazyMsg<msgs::Int32> &,
+                     const transport::MessageInfo &)> lazyCb =
+    [&](const transport::LazyMsg<msgs::Int32> &_msg,
+        const transport::MessageInfo &_info)
+  {
+    EXPECT_EQ(msg.GetTypeName(), _info.Type());
+    EXPECT_EQ(msg.ByteSizeLong(), _msg.Size());
+    EXPECT_FALSE(_msg.Parsed());
+    if (received++ % 2 == 0)
+    {
+      EXPECT_TRUE(_msg.Parse());
+      EXPECT_TRUE(_msg.Parsed());
+      EXPECT_EQ(data, _msg->data());
+      ++parsed;
+    }
+  };
+
+  EXPECT_TRUE(node.Subscribe(g_topic, lazyCb));
+
+  // Wait some time before publishing.
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  for (auto i = 0; i < 4; ++i)
+    EXPECT_TRUE(pub.Publish(msg));
+
+  // Give some time to the subscribers.
+  for (auto i = 0; i < 10 && received < 4; ++i)
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  EXPECT_EQ(4, received);
+  EXPECT_EQ(2, parsed);
+
+  // A lazy subscriber is throttled like any other subscriber.
+  transport::Node node2;
+  transport::SubscribeOptions opts;
+  opts.SetMsgsPerSec(1u);
+  std::atomic<int> throttled{0};
+  std::function<void(const transport::LazyMsg<msgs::Int32> &)> throttledCb =
+    [&](const transport::LazyMsg<msgs::Int32> &_msg)
+  {
+    EXPECT_EQ(data, _msg.Msg().data());
+    ++throttled;
+  };
+  EXPECT_TRUE(node2.Subscribe(g_topic, throttledCb, opts));
+
+  for (auto i = 0; i < 3; ++i)
+  {
+    EXPECT_TRUE(pub.Publish(msg));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+  EXPECT_EQ(1, throttled);
+
+  reset();
+}
+
+//////////////////////////////////////////////////
+/// \brief This test creates one publisher and one subscriber. The publisher
+/// publishes at higher frequency than the rate set by the subscriber.
+TEST(NodeTest, SubThrottled)
+{
+  reset();
+
+  msgs::Int32 msg;
+  msg.set_data(data);
+
+  transport::Node node;
+
+  auto pub = node.Advertise<msgs::Int32>(g_topic);
+  EXPECT_TRUE(pub);
+
+  transport::SubscribeOptions opts;
+  opts.SetMsgsPerSec(1u);
+  EXPECT_TRUE(node.Subscribe(g_topic, cb, opts));
+
+  for (auto i = 0; i < 3; ++i)
+  {
+    // Should always be true, because this is unthrottled.
+    EXPECT_TRUE(pub.ThrottledUpdateReady());
+    EXPECT_TRUE(pub.Publish(msg));
+
+    // Rate: 10 msgs/sec.
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+
+  // Node published 3 messages in ~0.3 sec. We should only receive 1 message.
+  EXPECT_EQ(1, counter);
+
+  reset();
+}
+
+//////////////////////////////////////////////////
+/// \brief A subscriber with a filter on the content of the messages only
+/// receives the matching messages, published as messages or serialized.
+TEST(NodeTest, SubFiltered)
+{
+  reset();
+
+  msgs::Int32 msg;
+  msgs::Int32 other;
+  msg.set_data(data);
+  other.set_data(data + 1);
+
+  transport::Node node;
+
+  auto pub = node.Advertise<msgs::Int32>(g_topic);
+  EXPECT_TRUE(pub);
+
+  // cb() checks that the data of the received messages is data.
+  transport::MessageFilter filter;
+  EXPECT_TRUE(filter.AddCondition("data", std::to_string(data)));
+  transport::SubscribeOptions opts;
+  opts.SetFilter(filter);
+  EXPECT_TRUE(node.Subscribe(g_topic, cb, opts));
+
+  for (auto i = 0; i < 3; ++i)
+  {
+    EXPECT_TRUE(pub.Publish(msg));
+    EXPECT_TRUE(pub.Publish(other));
+    EXPECT_TRUE(pub.PublishRaw(msg.SerializeAsString(), msg.GetTypeName()));
+    EXPECT_TRUE(pub.PublishRaw(other.SerializeAsString(),
+      other.GetTypeName()));
+  }
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  EXPECT_EQ(6, counter);
+
+  reset();
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the rate that a node requests from the remote publishers:
+/// the highest rate of its subscribers, unless one isn't throttled.
+TEST(NodeTest, SubThrottledRequestedRate)
+{
+  transport::Node slowNode;
+  transport::Node fastNode;
+
+  transport::SubscribeOptions slow;
+  slow.SetMsgsPerSec(5u);
+  transport::SubscribeOptions fast;
+  fast.SetMsgsPerSec(20u);
+
+  EXPECT_TRUE(slowNode.Subscribe(g_topic, cb, slow));
+  EXPECT_TRUE(slowNode.Subscribe(g_topic, cb, fast));
+  EXPECT_TRUE(fastNode.Subscribe(g_topic, cb, slow));
+  EXPECT_TRUE(fastNode.SubscribeRaw(g_topic, rawCbInfo));
+
+  std::string topic;
+  ASSERT_TRUE(transport::TopicUtils::FullyQualifiedName(partition, "",
+    g_topic, topic));
+
+  auto *shared = transport::NodeShared::Instance();
+  const auto entries = shared->localSubscribers.normal.TopicHandlers(topic);
+  ASSERT_NE(nullptr, entries);
+  ASSERT_EQ(3u, entries->size());
+  const std::string slowNodeUuid = entries->at(0).nUuid;
+  const std::string fastNodeUuid = entries->at(2).nUuid;
+  ASSERT_NE(slowNodeUuid, fastNodeUuid);
+
+  const std::string type = msgs::Int32().GetTypeName();
+  EXPECT_EQ(20u, shared->localSubscribers.MsgsPerSec(topic, type,
+    slowNodeUuid));
+  EXPECT_EQ(transport::kUnthrottled, shared->localSubscribers.MsgsPerSec(
+    topic, type, fastNodeUuid));
+
+  // The subscribers of other types don't count.
+  EXPECT_EQ(transport::kUnthrottled, shared->localSubscribers.MsgsPerSec(
+    topic, msgs::Vector3d().GetTypeName(), slowNodeUuid));
+}
+
+//////////////////////////////////////////////////
+/// \brief Block the callback of a subscription, publish 5 messages and
+/// return the messages received.
+/// \param[in] _topic Topic name.
+/// \param[in] _opts Subscribe options.
+/// \param[out] _queueDrops Drops reported by the topic statistics.
+/// \return The data of the messages received, in order.
+static std::vector<int> receivedWithQueueOptions(const std::string &_topic,
+    const transport::SubscribeOptions &_opts, uint64_t &_queueDrops)
+{
+  transport::Node node;
+  auto pub = node.Advertise<msgs::Int32>(_topic);
+  EXPECT_TRUE(pub);
+  EXPECT_TRUE(node.EnableStats(_topic, true));
+
+  std::mutex mutex;
+  std::condition_variable condition;
+  bool release = false;
+  std::vector<int> received;
+
+  std::function<void(const msgs::Int32 &)> slowCb =
+    [&](const msgs::Int32 &_msg)
+  {
+    std::unique_lock<std::mutex> lk(mutex);
+    condition.wait_for(lk, std::chrono::seconds(2), [&]{return release;});
+    received.push_back(_msg.data());
+  };
+
+  EXPECT_TRUE(node.Subscribe(_topic, slowCb, _opts));
+
+  msgs::Int32 msg;
+  msg.set_data(0);
+  EXPECT_TRUE(pub.Publish(msg));
+
+  // Wait for the callback to block.
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  for (int i = 1; i < 5; ++i)
+  {
+    msg.set_data(i);
+    EXPECT_TRUE(pub.Publish(msg));
+  }
+
+  {
+    std::lock_guard<std::mutex> lk(mutex);
+    release = true;
+  }
+  condition.notify_all();
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+  auto stats = node.TopicStats(_topic);
+  _queueDrops = stats ? stats->QueueDroppedMsgCount() : 0u;
+  EXPECT_TRUE(node.EnableStats(_topic, false));
+
+  std::lock_guard<std::mutex> lk(mutex);
+  return received;
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the policies applied when the intra-process queue of a
+/// subscription is full.
+TEST(NodeTest, PubSubQueuePolicy)
+{
+  uint64_t queueDrops = 0;
+  transport::SubscribeOptions opts;
+  opts.SetQueueDepth(2u);
+
+  // The newest messages are discarded.
+  opts.SetQueuePolicy(transport::QueuePolicy_t::DROP_NEWEST);
+  std::vector<int> received =
+    receivedWithQueueOptions("/drop_newest", opts, queueDrops);
+  EXPECT_EQ(std::vector<int>({0, 1, 2}), received);
+  EXPECT_EQ(2u, queueDrops);
+
+  // The oldest pending messages are discarded.
+  opts.SetQueuePolicy(transport::QueuePolicy_t::DROP_OLDEST);
+  received = receivedWithQueueOptions("/drop_oldest", opts, queueDrops);
+  EXPECT_EQ(std::vector<int>({0, 3, 4}), received);
+  EXPECT_EQ(2u, queueDrops);
+}
+
+//////////////////////////////////////////////////
+/// \brief An adaptive queue absorbs a burst, within the depth set.
+TEST(NodeTest, PubSubAdaptiveQueue)
+{
+  uint64_t queueDrops = 0;
+  transport::SubscribeOptions opts;
+  opts.SetAdaptiveQueue(true);
+
+  std::vector<int> received =
+    receivedWithQueueOptions("/adaptive", opts, queueDrops);
+  EXPECT_EQ(std::vector<int>({0, 1, 2, 3, 4}), received);
+  EXPECT_EQ(0u, queueDrops);
+
+  // The depth set is the maximum.
+  opts.SetQueueDepth(2u);
+  opts.SetQueuePolicy(transport::QueuePolicy_t::DROP_NEWEST);
+  received = receivedWithQueueOptions("/adaptive_max", opts, queueDrops);
+  EXPECT_EQ(std::vector<int>({0, 1, 2}), received);
+  EXPECT_EQ(2u, queueDrops);
+}
+
+//////////////////////////////////////////////////
+/// \brief A conflated subscription only receives the newest message
+/// published while its callback was busy.
+TEST(NodeTest, PubSubConflate)
+{
+  uint64_t queueDrops = 0;
+  transport::SubscribeOptions opts;
+  opts.SetConflate(true);
+
+  std::vector<int> received =
+    receivedWithQueueOptions("/conflate", opts, queueDrops);
+  EXPECT_EQ(std::vector<int>({0, 4}), received);
+  EXPECT_EQ(3u, queueDrops);
+}
+
+//////////////////////////////////////////////////
+/// \brief A stalled callback doesn't block its publisher once the publish
+/// queue is full, the new messages are dropped and counted instead.
+TEST(NodeTest, PubStalledCallbackFullQueue)
+{
+  const int kMsgs = 5000;
+  const std::string topic = "/stalled";
+
+  transport::Node node;
+  auto pub = node.Advertise<msgs::Int32>(topic);
+  EXPECT_TRUE(pub);
+  EXPECT_TRUE(node.EnableStats(topic, true));
+
+  std::mutex mutex;
+  std::condition_variable condition;
+  bool release = false;
+  std::atomic<int> count{0};
+  std::function<void(const msgs::Int32 &)> stalledCb =
+    [&](const msgs::Int32 &)
+  {
+    std::unique_lock<std::mutex> lk(mutex);
+    condition.wait_for(lk, std::chrono::seconds(5), [&]{return release;});
+    ++count;
+  };
+  EXPECT_TRUE(node.Subscribe(topic, stalledCb));
+
+  msgs::Int32 msg;
+  msg.set_data(data);
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < kMsgs; ++i)
+    EXPECT_TRUE(pub.Publish(msg));
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(4));
+
+  {
+    std::lock_guard<std::mutex> lk(mutex);
+    release = true;
+  }
+  condition.notify_all();
+  std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+  auto stats = node.TopicStats(topic);
+  ASSERT_TRUE(stats);
+  EXPECT_GT(stats->QueueDroppedMsgCount(), 0u);
+  EXPECT_EQ(kMsgs, count + static_cast<int>(stats->QueueDroppedMsgCount()));
+  EXPECT_TRUE(node.EnableStats(topic, false));
+}
+
+//////////////////////////////////////////////////
+/// \brief A callback publishing more messages than its publish queue holds
+/// doesn't wait for its own dispatch thread to make room.
+TEST(NodeTest, PubFromCallbackFullQueue)
+{
+  const int kMsgs = 5000;
+
+  transport::Node node;
+  auto pub = node.Advertise<msgs::Int32>(g_topic);
+  EXPECT_TRUE(pub);
+  auto republisher = node.Advertise<msgs::Int32>("/republished");
+  EXPECT_TRUE(republisher);
+
+  std::atomic<int> count{0};
+  std::function<void(const msgs::Int32 &)> countCb =
+    [&](const msgs::Int32 &) { ++count; };
+  EXPECT_TRUE(node.Subscribe("/republished", countCb));
+
+  std::atomic<bool> republished{false};
+  std::function<void(const msgs::Int32 &)> republishCb =
+    [&](const msgs::Int32 &_msg)
+    {
+      for (int i = 0; i < kMsgs; ++i)
+        republisher.Publish(_msg);
+      republished = true;
+    };
+  EXPECT_TRUE(node.Subscribe(g_topic, republishCb));
+
+  msgs::Int32 msg;
+  msg.set_data(data);
+  EXPECT_TRUE(pub.Publish(msg));
+
+  for (int i = 0; i < 500 && count < kMsgs; ++i)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_TRUE(republished);
+  EXPECT_EQ(kMsgs, count);
+}
+
+//////////////////////////////////////////////////
+/// \brief Messages not published through the publish queues, such as raw
+/// publications, run asynchronous callbacks on the dispatch threads.
+TEST(NodeTest, PubRawSubAsyncCallbacks)
+{
+  transport::Node node;
+  auto pub = node.Advertise<msgs::Int32>(g_topic);
+  EXPECT_TRUE(pub);
+
+  std::mutex mutex;
+  std::condition_variable condition;
+  std::thread::id syncThread;
+  std::thread::id asyncThread;
+
+  std::function<void(const msgs::Int32 &)> syncCb =
+    [&](const msgs::Int32 &)
+  {
+    std::lock_guard<std::mutex> lk(mutex);
+    syncThread = std::this_thread::get_id();
+  };
+
+  std::function<void(const msgs::Int32 &)> asyncCb =
+    [&](const msgs::Int32 &_msg)
+  {
+    EXPECT_EQ(data, _msg.data());
+    std::lock_guard<std::mutex> lk(mutex);
+    asyncThread = std::this_thread::get_id();
+    condition.notify_all();
+  };
+
+  transport::SubscribeOptions opts;
+  opts.SetAsyncCallbacks(true);
+  EXPECT_TRUE(node.Subscribe(g_topic, syncCb));
+  EXPECT_TRUE(node.Subscribe(g_topic, asyncCb, opts));
 
-  // Give some time to the subscribers.
-  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  msgs::Int32 msg;
+  msg.set_data(data);
+  EXPECT_TRUE(pub.PublishRaw(msg.SerializeAsString(), msg.GetTypeName()));
 
-  // Check that the data was received.
-  EXPECT_TRUE(cbExecuted);
+  std::unique_lock<std::mutex> lk(mutex);
+  condition.wait_for(lk, std::chrono::seconds(1),
+    [&]{return asyncThread != std::thread::id();});
 
-  reset();
+  // The synchronous callback runs on the publishing thread.
+  EXPECT_EQ(std::this_thread::get_id(), syncThread);
+  EXPECT_NE(std::thread::id(), asyncThread);
+  EXPECT_NE(std::this_thread::get_id(), asyncThread);
 }
 
 //////////////////////////////////////////////////
-/// \brief Check that a message is not received if the callback does not use
-/// the advertised types.
-TEST(NodeTest, PubSubWrongTypesOnSubscription)
+/// \brief This test creates one publisher and one subscriber. The publisher
+/// publishes at a throttled frequency .
+TEST(NodeTest, PubThrottled)
 {
   reset();
 
-  msgs::Vector3d msgV;
-  msgV.set_x(1);
-  msgV.set_y(2);
-  msgV.set_z(3);
+  msgs::Int32 msg;
+  msg.set_data(data);
 
   transport::Node node;
 
-  auto pub = node.Advertise<msgs::Vector3d>(g_topic);
+  transport::AdvertiseMessageOptions opts;
+  opts.SetMsgsPerSec(1u);
+  auto pub = node.Advertise<msgs::Int32>(g_topic, opts);
   EXPECT_TRUE(pub);
 
   EXPECT_TRUE(node.Subscribe(g_topic, cb));
 
-  // Wait some time before publishing.
-  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  // Should be true the first time
+  EXPECT_TRUE(pub.ThrottledUpdateReady());
+  for (auto i = 0; i < 3; ++i)
+  {
+    EXPECT_TRUE(pub.Publish(msg));
+    // False afterwards, because targeting 1 msg/second.
+    EXPECT_FALSE(pub.ThrottledUpdateReady());
 
-  // Send a message with a wrong type.
-  EXPECT_TRUE(pub.Publish(msgV));
+    // Rate: 10 msgs/sec.
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
 
-  // Check that the message was not received.
-  EXPECT_FALSE(cbExecuted);
+  // Node published 3 messages in ~0.3 sec. We should only receive 1 message.
+  EXPECT_EQ(1, counter);
 
   reset();
 }
 
 //////////////////////////////////////////////////
-/// \brief This test spawns two subscribers on the same topic. One of the
-/// subscribers has a wrong callback (types in the callback does not match the
-/// advertised type). Check that only the good callback is executed.
-TEST(NodeTest, PubSubWrongTypesTwoSubscribers)
+/// \brief This test creates one publisher limited by a token bucket and one
+/// subscriber. A burst fits in the bucket, and the next messages are limited
+/// by the rate of the bucket.
+TEST(NodeTest, PubRateLimited)
 {
   reset();
 
   msgs::Int32 msg;
   msg.set_data(data);
 
-  transport::Node node1;
-  transport::Node node2;
-
-  auto pub1 = node1.Advertise<msgs::Int32>(g_topic);
-  EXPECT_TRUE(pub1);
+  transport::Node node;
 
-  // Good subscriber.
-  EXPECT_TRUE(node1.Subscribe(g_topic, cb));
+  transport::AdvertiseMessageOptions opts;
+  opts.SetRateLimit(1u, 0u, 3u);
+  auto pub = node.Advertise<msgs::Int32>(g_topic, opts);
+  EXPECT_TRUE(pub);
 
-  // Bad subscriber: cbVector does not match the types advertised by node1.
-  EXPECT_TRUE(node2.Subscribe(g_topic, cbVector));
+  EXPECT_TRUE(node.Subscribe(g_topic, cb));
 
-  // Wait some time before publishing.
-  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  // The burst of 3 messages is published at once, the next ones are
+  // discarded until the bucket refills.
+  for (auto i = 0; i < 5; ++i)
+    EXPECT_TRUE(pub.Publish(msg));
 
-  EXPECT_TRUE(pub1.Publish(msg));
+  // Rate: 10 msgs/sec during ~0.5 sec, but limited to 1 msg/sec. This also
+  // leaves time for the callbacks of the burst.
+  for (auto i = 0; i < 5; ++i)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT_TRUE(pub.Publish(msg));
+  }
+  EXPECT_EQ(3, counter);
 
-  // Give some time to the subscribers.
+  std::this_thread::sleep_for(std::chrono::milliseconds(600));
+  EXPECT_TRUE(pub.Publish(msg));
   std::this_thread::sleep_for(std::chrono::milliseconds(100));
-
-  // Check that the message was received by node1.
-  EXPECT_TRUE(cbExecuted);
-
-  // Check that the message was not received by node2.
-  EXPECT_FALSE(cbVectorExecuted);
+  EXPECT_EQ(4, counter);
 
   reset();
 }
 
 //////////////////////////////////////////////////
-/// \brief This test creates one publisher and one subscriber. The publisher
-/// publishes at higher frequency than the rate set by the subscriber.
-TEST(NodeTest, SubThrottled)
+/// \brief A publisher updates its throttling and priority without being
+/// advertised again. The options that change the connection are rejected.
+TEST(NodeTest, PubUpdateOptions)
 {
   reset();
 
@@ -1963,15 +3322,29 @@ TEST(NodeTest, SubThrottled)
   auto pub = node.Advertise<msgs::Int32>(g_topic);
   EXPECT_TRUE(pub);
 
-  transport::SubscribeOptions opts;
+  EXPECT_TRUE(node.Subscribe(g_topic, cb));
+
+  // The compression is negotiated at advertise time.
+  transport::AdvertiseMessageOptions opts = pub.Options();
+  opts.SetCompression(transport::Compression_t::LZ4);
+  EXPECT_FALSE(pub.UpdateOptions(opts));
+  EXPECT_EQ(0u, pub.Options().MsgsPerSec());
+
+  opts = pub.Options();
   opts.SetMsgsPerSec(1u);
-  EXPECT_TRUE(node.Subscribe(g_topic, cb, opts));
+  opts.SetPriority(transport::Priority_t::CONTROL);
+  EXPECT_TRUE(pub.UpdateOptions(opts));
+  EXPECT_EQ(1u, pub.Options().MsgsPerSec());
+  EXPECT_EQ(transport::Priority_t::CONTROL, pub.Options().Priority());
 
+  // Nothing changes.
+  EXPECT_TRUE(pub.UpdateOptions(opts));
+
+  EXPECT_TRUE(pub.ThrottledUpdateReady());
   for (auto i = 0; i < 3; ++i)
   {
-    // Should always be true, because this is unthrottled.
-    EXPECT_TRUE(pub.ThrottledUpdateReady());
     EXPECT_TRUE(pub.Publish(msg));
+    EXPECT_FALSE(pub.ThrottledUpdateReady());
 
     // Rate: 10 msgs/sec.
     std::this_thread::sleep_for(std::chrono::milliseconds(100));
@@ -1984,9 +3357,8 @@ TEST(NodeTest, SubThrottled)
 }
 
 //////////////////////////////////////////////////
-/// \brief This test creates one publisher and one subscriber. The publisher
-/// publishes at a throttled frequency .
-TEST(NodeTest, PubThrottled)
+/// \brief A subscriber updates its throttling without subscribing again.
+TEST(NodeTest, SubUpdateSubscription)
 {
   reset();
 
@@ -1995,20 +3367,21 @@ TEST(NodeTest, PubThrottled)
 
   transport::Node node;
 
-  transport::AdvertiseMessageOptions opts;
-  opts.SetMsgsPerSec(1u);
-  auto pub = node.Advertise<msgs::Int32>(g_topic, opts);
+  auto pub = node.Advertise<msgs::Int32>(g_topic);
   EXPECT_TRUE(pub);
 
+  transport::SubscribeOptions opts;
+  opts.SetMsgsPerSec(1u);
+
+  // Not subscribed yet.
+  EXPECT_FALSE(node.UpdateSubscription(g_topic, opts));
+
   EXPECT_TRUE(node.Subscribe(g_topic, cb));
+  EXPECT_TRUE(node.UpdateSubscription(g_topic, opts));
 
-  // Should be true the first time
-  EXPECT_TRUE(pub.ThrottledUpdateReady());
   for (auto i = 0; i < 3; ++i)
   {
     EXPECT_TRUE(pub.Publish(msg));
-    // False afterwards, because targeting 1 msg/second.
-    EXPECT_FALSE(pub.ThrottledUpdateReady());
 
     // Rate: 10 msgs/sec.
     std::this_thread::sleep_for(std::chrono::milliseconds(100));
@@ -2017,6 +3390,16 @@ TEST(NodeTest, PubThrottled)
   // Node published 3 messages in ~0.3 sec. We should only receive 1 message.
   EXPECT_EQ(1, counter);
 
+  // Remove the throttling.
+  reset();
+  EXPECT_TRUE(node.UpdateSubscription(g_topic, transport::SubscribeOptions()));
+  for (auto i = 0; i < 3; ++i)
+  {
+    EXPECT_TRUE(pub.Publish(msg));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+  EXPECT_EQ(3, counter);
+
   reset();
 }
 
@@ -2267,6 +3650,36 @@ TEST(NodeTest, ServiceListRemap)
   EXPECT_EQ(g_topic_remap, services.at(0));
 }
 
+//////////////////////////////////////////////////
+/// \brief The requests resolve the remapped service name once and reuse it.
+TEST(NodeTest, ServiceCallRemap)
+{
+  reset();
+
+  transport::NodeOptions nodeOptions;
+  nodeOptions.AddTopicRemap(g_topic, g_topic_remap);
+  transport::Node node(nodeOptions);
+  transport::Node responser;
+  EXPECT_TRUE(responser.Advertise(g_topic_remap, srvEcho));
+
+  msgs::Int32 req;
+  msgs::Int32 rep;
+  bool result;
+  req.set_data(data);
+  for (int i = 0; i < 3; ++i)
+  {
+    result = false;
+    EXPECT_TRUE(node.Request(g_topic, req, 1000, rep, result));
+    EXPECT_TRUE(result);
+    EXPECT_EQ(data, rep.data());
+
+    // The invalid names are not cached.
+    EXPECT_FALSE(node.Request("invalid service", req, 1000, rep, result));
+  }
+
+  reset();
+}
+
 //////////////////////////////////////////////////
 /// \brief Check bad topic remap use cases.
 TEST(NodeTest, WrongTopicRemap)
@@ -2308,6 +3721,119 @@ TEST(NodePubTest, DestructionOrder)
   }
 }
 
+//////////////////////////////////////////////////
+/// \brief Destroy a node subscribed to many topics while publications are
+/// queued. It must not receive the later publications and the subscriptions
+/// of the other nodes must be kept.
+TEST(NodeTest, DestructionWithManySubscriptions)
+{
+  const int kNumTopics = 200;
+  transport::Node pubNode;
+  transport::Node otherNode;
+  std::vector<transport::Node::Publisher> pubs;
+
+  std::atomic<int> otherReceived{0};
+  std::function<void(const msgs::Int32 &)> otherCb =
+    [&otherReceived](const msgs::Int32 &)
+  {
+    ++otherReceived;
+  };
+
+  auto received = std::make_shared<std::atomic<int>>(0);
+  std::function<void(const msgs::Int32 &)> cb =
+    [received](const msgs::Int32 &)
+  {
+    ++(*received);
+  };
+
+  msgs::Int32 msg;
+  msg.set_data(data);
+  {
+    transport::Node node;
+    for (int i = 0; i < kNumTopics; ++i)
+    {
+      const std::string topic = "/many_" + std::to_string(i);
+      pubs.push_back(pubNode.Advertise<msgs::Int32>(topic));
+      ASSERT_TRUE(pubs.back());
+      EXPECT_TRUE(node.Subscribe(topic, cb));
+    }
+    EXPECT_TRUE(otherNode.Subscribe("/many_0", otherCb));
+
+    for (auto &pub : pubs)
+      EXPECT_TRUE(pub.Publish(msg));
+  }
+
+  // The new publications don't reach the destroyed node, and the queued
+  // ones reach it at most once.
+  EXPECT_TRUE(pubs.front().Publish(msg));
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  EXPECT_LE(*received, kNumTopics);
+  EXPECT_EQ(2, otherReceived);
+}
+
+//////////////////////////////////////////////////
+/// \brief The callbacks of the subscriptions bound to an executor run in
+/// the thread spinning it.
+TEST(NodeTest, CallbackExecutor)
+{
+  auto executor = std::make_shared<transport::Executor>();
+  transport::NodeOptions nodeOpts;
+  nodeOpts.SetCallbackExecutor(executor);
+  transport::Node node(nodeOpts);
+  transport::Node pubNode;
+
+  std::thread::id cbThread;
+  int received = 0;
+  std::function<void(const msgs::Int32 &)> cb =
+    [&](const msgs::Int32 &_msg)
+  {
+    EXPECT_EQ(data, _msg.data());
+    cbThread = std::this_thread::get_id();
+    ++received;
+  };
+
+  // A subscription bound to another executor keeps it.
+  auto otherExecutor = std::make_shared<transport::Executor>();
+  transport::SubscribeOptions opts;
+  opts.SetCallbackExecutor(otherExecutor);
+  int otherReceived = 0;
+  std::function<void(const msgs::Int32 &)> otherCb =
+    [&otherReceived](const msgs::Int32 &)
+  {
+    ++otherReceived;
+  };
+
+  auto pub = pubNode.Advertise<msgs::Int32>(g_topic);
+  ASSERT_TRUE(pub);
+  EXPECT_TRUE(node.Subscribe(g_topic, cb));
+  EXPECT_TRUE(pubNode.Subscribe(g_topic, otherCb, opts));
+
+  msgs::Int32 msg;
+  msg.set_data(data);
+  EXPECT_TRUE(pub.Publish(msg));
+  EXPECT_TRUE(pub.Publish(msg));
+
+  // Nothing runs until the executors are spun.
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  EXPECT_EQ(0, received);
+  EXPECT_EQ(0, otherReceived);
+  EXPECT_EQ(2u, executor->Pending());
+  EXPECT_EQ(2u, otherExecutor->Pending());
+
+  EXPECT_TRUE(node.SpinOnce(std::chrono::seconds(1)));
+  EXPECT_EQ(1, received);
+  EXPECT_EQ(std::this_thread::get_id(), cbThread);
+  EXPECT_TRUE(node.SpinOnce());
+  EXPECT_EQ(2, received);
+  EXPECT_FALSE(node.SpinOnce());
+
+  EXPECT_EQ(2u, otherExecutor->SpinSome());
+  EXPECT_EQ(2, otherReceived);
+
+  // A node without an executor has nothing to spin.
+  EXPECT_FALSE(pubNode.SpinOnce());
+}
+
 //////////////////////////////////////////////////
 /// \brief Create a separate thread, block it calling waitForShutdown() and
 /// emit a SIGINT signal. Check that the transport library captures the signal
@@ -2341,6 +3867,244 @@ TEST(NodeTest, statistics)
   EXPECT_EQ(std::nullopt, node.TopicStats("/test"));
 }
 
+//////////////////////////////////////////////////
+/// \brief Check the execution time accounted for each subscription.
+TEST(NodeTest, SubscriptionStats)
+{
+  transport::Node node;
+  EXPECT_TRUE(node.SubscriptionStats().empty());
+
+  std::atomic<int> slowCalls{0};
+  std::function<void(const msgs::Int32 &)> slowCb =
+    [&slowCalls](const msgs::Int32 &)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    ++slowCalls;
+  };
+  transport::RawCallback rawCb = [](const char *, const std::size_t,
+                                    const transport::MessageInfo &)
+  {
+  };
+
+  const std::string topic = "/subscription_stats";
+  auto pub = node.Advertise<msgs::Int32>(topic);
+  ASSERT_TRUE(pub);
+  ASSERT_TRUE(node.Subscribe(topic, slowCb));
+  ASSERT_TRUE(node.SubscribeRaw(topic, rawCb, "gz.msgs.Int32"));
+
+  // Only the callbacks executed while the accounting is enabled count.
+  msgs::Int32 msg;
+  msg.set_data(data);
+  EXPECT_TRUE(pub.Publish(msg));
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  EXPECT_EQ(1, slowCalls);
+
+  node.EnableCallbackStats(true);
+  for (int i = 0; i < 3; ++i)
+    EXPECT_TRUE(pub.Publish(msg));
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  EXPECT_EQ(4, slowCalls);
+
+  const auto stats = node.SubscriptionStats();
+  node.EnableCallbackStats(false);
+  ASSERT_EQ(2u, stats.size());
+  for (const transport::CallbackStatistics &entry : stats)
+  {
+    EXPECT_EQ(topic, entry.topic);
+    EXPECT_EQ("gz.msgs.Int32", entry.msgType);
+    EXPECT_FALSE(entry.handlerUuid.empty());
+    EXPECT_EQ(3u, entry.calls);
+    EXPECT_LE(entry.maxDuration, entry.totalDuration);
+    if (entry.raw)
+      continue;
+    EXPECT_GE(entry.totalDuration, std::chrono::milliseconds(15));
+    EXPECT_GE(entry.maxDuration, std::chrono::milliseconds(5));
+  }
+  EXPECT_NE(stats[0].raw, stats[1].raw);
+
+  // The subscriptions of the other nodes are not included.
+  transport::Node otherNode;
+  otherNode.EnableCallbackStats(true);
+  EXPECT_TRUE(otherNode.SubscriptionStats().empty());
+  otherNode.EnableCallbackStats(false);
+  EXPECT_TRUE(node.SubscriptionStats().empty());
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the accounting of the publish queues and the memory cap.
+TEST(NodeTest, MemoryStats)
+{
+  auto *shared = transport::NodeShared::Instance();
+  EXPECT_EQ(0u, shared->MemoryCap());
+  EXPECT_FALSE(shared->MemoryCapExceeded(1u << 30));
+
+  // Block the dispatch thread, so that the publications stay queued.
+  std::mutex blockMutex;
+  std::unique_lock<std::mutex> block(blockMutex);
+  std::atomic<int> calls{0};
+  std::function<void(const msgs::StringMsg &)> cb =
+    [&blockMutex, &calls](const msgs::StringMsg &)
+  {
+    std::lock_guard<std::mutex> lk(blockMutex);
+    ++calls;
+  };
+
+  transport::Node node;
+  const std::string topic = "/memory_stats";
+  auto pub = node.Advertise<msgs::StringMsg>(topic);
+  ASSERT_TRUE(pub);
+  ASSERT_TRUE(node.Subscribe(topic, cb));
+
+  msgs::StringMsg msg;
+  msg.set_data(std::string(1000, 'x'));
+  const uint64_t dropped = shared->MemoryStats().capDroppedMessages;
+  for (int i = 0; i < 10; ++i)
+    EXPECT_TRUE(pub.Publish(msg));
+
+  transport::MemoryStatistics stats = shared->MemoryStats();
+  EXPECT_GE(stats.publishQueueBytes, 8000u);
+  EXPECT_GT(stats.discoveryBytes, 0u);
+  EXPECT_GE(stats.totalBytes, stats.publishQueueBytes +
+    stats.discoveryBytes);
+
+  // Above the cap, the new publications are dropped.
+  shared->SetMemoryCap(stats.publishQueueBytes);
+  EXPECT_TRUE(shared->MemoryCapExceeded(1000));
+  EXPECT_TRUE(pub.Publish(msg));
+  EXPECT_EQ(dropped + 1, shared->MemoryStats().capDroppedMessages);
+  EXPECT_EQ(stats.publishQueueBytes,
+    shared->MemoryStats().publishQueueBytes);
+
+  // The external memory counts towards the cap.
+  shared->SetMemoryCap(0);
+  shared->AddExternalMemory(1 << 20);
+  EXPECT_GE(shared->MemoryStats().externalBytes, 1u << 20);
+  shared->SetMemoryCap(1 << 20);
+  EXPECT_TRUE(shared->MemoryCapExceeded());
+  shared->AddExternalMemory(-(1 << 20));
+  shared->SetMemoryCap(0);
+
+  block.unlock();
+  for (int i = 0; i < 300 && calls < 10; ++i)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_EQ(10, calls);
+  EXPECT_EQ(0u, shared->MemoryStats().publishQueueBytes);
+}
+
+//////////////////////////////////////////////////
+/// \brief A raw subscription with a tap receives the messages published
+/// within the process on the publishing thread, once.
+TEST(NodeTest, SubscribeRawTap)
+{
+  transport::Node node;
+  const std::string topic = "/raw_tap";
+  auto pub = node.Advertise<msgs::Int32>(topic);
+  ASSERT_TRUE(pub);
+
+  std::mutex mutex;
+  std::vector<std::thread::id> threads;
+  std::vector<std::string> received;
+  std::function<void(const std::shared_ptr<const char> &, std::size_t,
+    const transport::MessageInfo &)> cb =
+    [&](const std::shared_ptr<const char> &_data, std::size_t _size,
+        const transport::MessageInfo &_info)
+    {
+      EXPECT_TRUE(_info.IntraProcess());
+      std::lock_guard<std::mutex> lk(mutex);
+      threads.push_back(std::this_thread::get_id());
+      received.emplace_back(_data.get(), _size);
+    };
+
+  transport::SubscribeOptions opts;
+  opts.SetTap(true);
+  ASSERT_TRUE(node.SubscribeRaw(topic, cb, transport::kGenericMessageType,
+    opts));
+
+  msgs::Int32 msg;
+  msg.set_data(data);
+  EXPECT_TRUE(pub.Publish(msg));
+  EXPECT_TRUE(pub.PublishRaw(msg.SerializeAsString(), msg.GetTypeName()));
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  {
+    std::lock_guard<std::mutex> lk(mutex);
+    ASSERT_EQ(2u, received.size());
+    EXPECT_EQ(msg.SerializeAsString(), received[0]);
+    EXPECT_EQ(msg.SerializeAsString(), received[1]);
+    for (const std::thread::id &id : threads)
+      EXPECT_EQ(std::this_thread::get_id(), id);
+  }
+
+  // The tap is removed with the subscription.
+  EXPECT_TRUE(node.Unsubscribe(topic));
+  EXPECT_TRUE(pub.Publish(msg));
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  std::lock_guard<std::mutex> lk(mutex);
+  EXPECT_EQ(2u, received.size());
+}
+
+//////////////////////////////////////////////////
+/// \brief The subscribers of an alias receive the messages of the topic,
+/// reported under the topic name.
+TEST(NodeTest, TopicAlias)
+{
+  const std::string topic = "/alias_topic";
+  const std::string alias = "/alias_name";
+
+  std::atomic<int> topicCalls{0};
+  std::atomic<int> aliasCalls{0};
+  std::function<void(const msgs::Int32 &)> topicCb =
+    [&topicCalls](const msgs::Int32 &)
+  {
+    ++topicCalls;
+  };
+  std::function<void(const msgs::Int32 &, const transport::MessageInfo &)>
+    aliasCb = [&aliasCalls, &topic](const msgs::Int32 &_msg,
+        const transport::MessageInfo &_info)
+  {
+    EXPECT_EQ(data, _msg.data());
+    EXPECT_EQ(topic, _info.Topic());
+    ++aliasCalls;
+  };
+
+  transport::Node pubNode;
+  transport::AdvertiseMessageOptions opts;
+  EXPECT_FALSE(opts.AddAlias("bad alias"));
+  EXPECT_TRUE(opts.AddAlias(alias));
+  auto pub = pubNode.Advertise<msgs::Int32>(topic, opts);
+  ASSERT_TRUE(pub);
+
+  // The alias is advertised as a topic of its own.
+  std::vector<std::string> topics;
+  pubNode.TopicList(topics);
+  EXPECT_NE(topics.end(), std::find(topics.begin(), topics.end(), alias));
+
+  transport::Node subNode;
+  ASSERT_TRUE(subNode.Subscribe(alias, aliasCb));
+  ASSERT_TRUE(subNode.Subscribe(topic, topicCb));
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  msgs::Int32 msg;
+  msg.set_data(data);
+  EXPECT_TRUE(pub.Publish(msg));
+  for (int i = 0; i < 100 && (aliasCalls < 1 || topicCalls < 1); ++i)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_EQ(1, aliasCalls);
+  EXPECT_EQ(1, topicCalls);
+
+  // The alias subscription alone keeps the topic listened.
+  EXPECT_TRUE(subNode.Unsubscribe(topic));
+  EXPECT_TRUE(pub.HasConnections());
+  EXPECT_TRUE(pub.Publish(msg));
+  for (int i = 0; i < 100 && aliasCalls < 2; ++i)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_EQ(2, aliasCalls);
+  EXPECT_EQ(1, topicCalls);
+
+  EXPECT_TRUE(subNode.Unsubscribe(alias));
+  EXPECT_FALSE(pub.HasConnections());
+}
+
 //////////////////////////////////////////////////
 int main(int argc, char **argv)
 {
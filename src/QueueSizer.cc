@@ -0,0 +1,213 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "gz/transport/Helpers.hh"
+
+#include "QueueSizer.hh"
+
+using namespace gz;
+using namespace transport;
+
+//////////////////////////////////////////////////
+QueueBudget::QueueBudget(const uint64_t _bytes)
+  : bytes(_bytes)
+{
+}
+
+//////////////////////////////////////////////////
+uint64_t QueueBudget::Update(const uint64_t _previous,
+    const uint64_t _demand)
+{
+  // The unsigned arithmetic wraps around when the demand decreases.
+  const uint64_t delta = _demand - _previous;
+  const uint64_t total =
+    this->demand.fetch_add(delta, std::memory_order_relaxed) + delta;
+  if (total <= this->bytes)
+    return _demand;
+
+  return static_cast<uint64_t>(static_cast<double>(_demand) *
+    static_cast<double>(this->bytes) / static_cast<double>(total));
+}
+
+//////////////////////////////////////////////////
+uint64_t QueueBudget::Bytes() const
+{
+  return this->bytes;
+}
+
+//////////////////////////////////////////////////
+uint64_t QueueBudget::Demand() const
+{
+  return this->demand.load(std::memory_order_relaxed);
+}
+
+//////////////////////////////////////////////////
+std::shared_ptr<QueueBudget> QueueBudget::Global()
+{
+  static const std::shared_ptr<QueueBudget> budget = []()
+  {
+    uint64_t budgetBytes = kDefaultBytes;
+    std::string value;
+    if (env("GZ_TRANSPORT_QUEUE_BUDGET", value) && !value.empty())
+    {
+      try
+      {
+        budgetBytes = std::stoull(value);
+      }
+      catch (...)
+      {
+        std::cerr << "Invalid GZ_TRANSPORT_QUEUE_BUDGET [" << value
+                  << "], using " << budgetBytes << " bytes." << std::endl;
+      }
+    }
+    return std::make_shared<QueueBudget>(budgetBytes);
+  }();
+  return budget;
+}
+
+//////////////////////////////////////////////////
+QueueSizer::QueueSizer(std::shared_ptr<QueueBudget> _budget,
+    const uint64_t _maxDepth)
+  : budget(std::move(_budget)),
+    maxDepth(_maxDepth)
+{
+  if (this->maxDepth > 0)
+    this->depth = std::min(this->depth, this->maxDepth);
+}
+
+//////////////////////////////////////////////////
+QueueSizer::~QueueSizer()
+{
+  this->budget->Update(this->demand, 0);
+}
+
+//////////////////////////////////////////////////
+uint64_t QueueSizer::Arrival(const std::size_t _size,
+    const uint64_t _pending, const Timestamp &_now)
+{
+  const double size = static_cast<double>(std::max<std::size_t>(_size, 1));
+  if (this->periodStart == Timestamp())
+  {
+    this->periodStart = _now;
+    this->avgSize = size;
+    this->Resize(this->depth);
+  }
+  else
+  {
+    this->avgSize += (size - this->avgSize) / 8.0;
+    ++this->periodArrivals;
+  }
+
+  this->periodPeak = std::max(this->periodPeak, _pending + 1);
+
+  // A full queue grows right away, a burst doesn't wait for the period.
+  if (_pending >= this->depth)
+  {
+    this->Resize(2 * this->depth);
+  }
+  else if (_now - this->periodStart >= kPeriod)
+  {
+    const double elapsed =
+      std::chrono::duration<double>(_now - this->periodStart).count();
+    const double periodRate =
+      static_cast<double>(this->periodArrivals) / elapsed;
+
+    // The rate follows the increases right away and the decreases slowly.
+    if (periodRate > this->rate)
+      this->rate = periodRate;
+    else
+      this->rate += (periodRate - this->rate) / 4.0;
+
+    // Keep the depth until the latency of the consumer is known.
+    uint64_t wanted = 2 * this->periodPeak;
+    const int64_t ns = this->serviceNs.load(std::memory_order_relaxed);
+    if (ns > 0)
+    {
+      wanted = std::max(wanted, static_cast<uint64_t>(
+        std::ceil(2.0 * this->rate * static_cast<double>(ns) / 1e9)));
+    }
+    else
+    {
+      wanted = std::max(wanted, this->depth);
+    }
+
+    // Shrink by a quarter per period at most.
+    if (wanted < this->depth)
+    {
+      wanted = std::max(wanted,
+        this->depth - std::max<uint64_t>(this->depth / 4, 1));
+    }
+    this->Resize(wanted);
+
+    this->periodStart = _now;
+    this->periodArrivals = 0;
+    this->periodPeak = 0;
+  }
+
+  return this->depth;
+}
+
+//////////////////////////////////////////////////
+void QueueSizer::AddServiceTime(const std::chrono::nanoseconds _duration)
+{
+  // The consumers of a queue rarely run concurrently, a lost update only
+  // delays the average.
+  const int64_t ns = _duration.count();
+  const int64_t avg = this->serviceNs.load(std::memory_order_relaxed);
+  this->serviceNs.store(avg == 0 ? std::max<int64_t>(ns, 1) :
+    avg + (ns - avg) / 8, std::memory_order_relaxed);
+}
+
+//////////////////////////////////////////////////
+uint64_t QueueSizer::Depth() const
+{
+  return this->depth;
+}
+
+//////////////////////////////////////////////////
+uint64_t QueueSizer::Demand() const
+{
+  return this->demand;
+}
+
+//////////////////////////////////////////////////
+void QueueSizer::Resize(uint64_t _wanted)
+{
+  _wanted = std::max(_wanted, kMinDepth);
+  if (this->maxDepth > 0)
+    _wanted = std::min(_wanted, this->maxDepth);
+
+  const double size = std::max(this->avgSize, 1.0);
+  const uint64_t newDemand =
+    static_cast<uint64_t>(static_cast<double>(_wanted) * size);
+  const uint64_t granted = this->budget->Update(this->demand, newDemand);
+  this->demand = newDemand;
+
+  const uint64_t affordable =
+    static_cast<uint64_t>(static_cast<double>(granted) / size);
+  this->depth = std::max(std::min(affordable, _wanted),
+    std::min(kMinDepth, _wanted));
+}
@@ -0,0 +1,173 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GZ_TRANSPORT_QUEUESIZER_HH_
+#define GZ_TRANSPORT_QUEUESIZER_HH_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "gz/transport/config.hh"
+#include "gz/transport/TransportTypes.hh"
+
+namespace gz
+{
+  namespace transport
+  {
+    inline namespace GZ_TRANSPORT_VERSION_NAMESPACE
+    {
+    /// \internal
+    /// \brief Memory shared by the adaptive intra-process queues (see
+    /// SubscribeOptions::SetAdaptiveQueue()). Each queue demands the bytes
+    /// that it needs. When the demands exceed the budget, each queue is
+    /// granted a share proportional to its demand.
+    ///
+    /// This class is thread-safe.
+    class QueueBudget
+    {
+      /// \brief Constructor.
+      /// \param[in] _bytes Size of the budget (bytes).
+      public: explicit QueueBudget(const uint64_t _bytes);
+
+      /// \brief Replace the demand of a queue.
+      /// \param[in] _previous Previous demand of the queue (bytes).
+      /// \param[in] _demand New demand of the queue (bytes).
+      /// \return The bytes granted to the queue.
+      public: uint64_t Update(const uint64_t _previous,
+                              const uint64_t _demand);
+
+      /// \brief Get the size of the budget.
+      /// \return The size (bytes).
+      public: uint64_t Bytes() const;
+
+      /// \brief Get the sum of the demands of the queues.
+      /// \return The demands (bytes).
+      public: uint64_t Demand() const;
+
+      /// \brief Get the budget of the process, GZ_TRANSPORT_QUEUE_BUDGET
+      /// bytes or kDefaultBytes.
+      /// \return The budget.
+      public: static std::shared_ptr<QueueBudget> Global();
+
+      /// \brief Default size of the budget of the process (bytes).
+      public: static constexpr uint64_t kDefaultBytes = 64u << 20;
+
+      /// \brief Size of the budget (bytes).
+      private: const uint64_t bytes;
+
+      /// \brief Sum of the demands of the queues (bytes).
+      private: std::atomic<uint64_t> demand{0};
+    };
+
+    /// \internal
+    /// \brief Sizes an intra-process queue from the measured arrival rate,
+    /// message size and consumer latency. The queue holds the messages
+    /// arrived during twice the latency of the consumer, at least twice the
+    /// peak of pending messages seen in the last period, and grows twice as
+    /// deep as soon as it is full. It shrinks slowly once the load drops.
+    /// Its memory is bounded by a QueueBudget.
+    ///
+    /// This class is not thread-safe, except AddServiceTime().
+    class QueueSizer
+    {
+      /// \brief Constructor.
+      /// \param[in] _budget Memory shared with the other queues.
+      /// \param[in] _maxDepth Maximum depth of the queue, 0 for no limit.
+      public: explicit QueueSizer(std::shared_ptr<QueueBudget> _budget,
+                                  const uint64_t _maxDepth = 0);
+
+      /// \brief Destructor. Returns the demand of the queue to the budget.
+      public: ~QueueSizer();
+
+      /// \brief No copy constructor.
+      public: QueueSizer(const QueueSizer &) = delete;
+
+      /// \brief No assignment operator.
+      public: QueueSizer &operator=(const QueueSizer &) = delete;
+
+      /// \brief Account for a message arriving.
+      /// \param[in] _size Size of the message (bytes).
+      /// \param[in] _pending Number of messages already pending.
+      /// \param[in] _now Current time.
+      /// \return The depth of the queue for this message.
+      public: uint64_t Arrival(const std::size_t _size,
+                               const uint64_t _pending,
+                               const Timestamp &_now =
+                                 std::chrono::steady_clock::now());
+
+      /// \brief Account for the time the consumer spent on a message.
+      /// \param[in] _duration The time spent.
+      public: void AddServiceTime(const std::chrono::nanoseconds _duration);
+
+      /// \brief Get the current depth of the queue.
+      /// \return The depth.
+      public: uint64_t Depth() const;
+
+      /// \brief Get the memory demanded by the queue.
+      /// \return The demand (bytes).
+      public: uint64_t Demand() const;
+
+      /// \brief Smallest depth of a queue.
+      public: static constexpr uint64_t kMinDepth = 2;
+
+      /// \brief Depth of a queue until its load is measured.
+      public: static constexpr uint64_t kInitialDepth = 64;
+
+      /// \brief Period of the measures of the load.
+      public: static constexpr std::chrono::milliseconds kPeriod{100};
+
+      /// \brief Resize the queue and update its demand.
+      /// \param[in] _wanted Depth wanted for the load.
+      private: void Resize(uint64_t _wanted);
+
+      /// \brief Memory shared with the other queues.
+      private: std::shared_ptr<QueueBudget> budget;
+
+      /// \brief Maximum depth of the queue, 0 for no limit.
+      private: const uint64_t maxDepth;
+
+      /// \brief Current depth.
+      private: uint64_t depth = kInitialDepth;
+
+      /// \brief Memory demanded (bytes).
+      private: uint64_t demand = 0;
+
+      /// \brief Average size of the messages (bytes).
+      private: double avgSize = 0.0;
+
+      /// \brief Arrival rate (messages per second).
+      private: double rate = 0.0;
+
+      /// \brief Start of the current period.
+      private: Timestamp periodStart;
+
+      /// \brief Messages arrived in the current period.
+      private: uint64_t periodArrivals = 0;
+
+      /// \brief Most messages pending in the current period.
+      private: uint64_t periodPeak = 0;
+
+      /// \brief Average time spent by the consumer on a message (ns).
+      private: std::atomic<int64_t> serviceNs{0};
+    };
+    }
+  }
+}
+#endif
@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <chrono>
+#include <memory>
+
+#include "QueueSizer.hh"
+#include "gtest/gtest.h"
+
+using namespace gz;
+using namespace transport;
+using namespace std::chrono_literals;
+
+//////////////////////////////////////////////////
+/// \brief The queue holds the messages arrived during twice the latency of
+/// the consumer.
+TEST(QueueSizerTest, Latency)
+{
+  auto budget = std::make_shared<QueueBudget>(1u << 30);
+  QueueSizer sizer(budget);
+  Timestamp now = std::chrono::steady_clock::now();
+
+  EXPECT_EQ(QueueSizer::kInitialDepth, sizer.Arrival(100, 0, now));
+  EXPECT_EQ(QueueSizer::kInitialDepth * 100, budget->Demand());
+
+  // 1000 messages per second, 10 ms each: 20 messages.
+  sizer.AddServiceTime(10ms);
+  for (int i = 0; i < 1000; ++i)
+  {
+    now += 1ms;
+    sizer.Arrival(100, 0, now);
+  }
+  EXPECT_EQ(20u, sizer.Depth());
+  EXPECT_EQ(2000u, sizer.Demand());
+  EXPECT_EQ(2000u, budget->Demand());
+
+  // A slower consumer needs a deeper queue.
+  for (int i = 0; i < 100; ++i)
+    sizer.AddServiceTime(50ms);
+  for (int i = 0; i < 200; ++i)
+  {
+    now += 1ms;
+    sizer.Arrival(100, 0, now);
+  }
+  EXPECT_GE(sizer.Depth(), 90u);
+  EXPECT_LE(sizer.Depth(), 100u);
+}
+
+//////////////////////////////////////////////////
+/// \brief A full queue grows right away and shrinks slowly.
+TEST(QueueSizerTest, Burst)
+{
+  auto budget = std::make_shared<QueueBudget>(1u << 30);
+  QueueSizer sizer(budget);
+  Timestamp now = std::chrono::steady_clock::now();
+
+  EXPECT_EQ(64u, sizer.Arrival(10, 0, now));
+  EXPECT_EQ(64u, sizer.Arrival(10, 63, now));
+  EXPECT_EQ(128u, sizer.Arrival(10, 64, now));
+  EXPECT_EQ(256u, sizer.Arrival(10, 128, now));
+
+  // Twice the peak of the period, even without a measure of the consumer.
+  now += QueueSizer::kPeriod;
+  EXPECT_EQ(258u, sizer.Arrival(10, 0, now));
+
+  // Then shrinks by a quarter per period.
+  sizer.AddServiceTime(1us);
+  now += QueueSizer::kPeriod;
+  EXPECT_EQ(194u, sizer.Arrival(10, 0, now));
+  now += QueueSizer::kPeriod;
+  EXPECT_EQ(146u, sizer.Arrival(10, 0, now));
+  for (int i = 0; i < 20; ++i)
+  {
+    now += QueueSizer::kPeriod;
+    sizer.Arrival(10, 0, now);
+  }
+  EXPECT_EQ(QueueSizer::kMinDepth, sizer.Depth());
+}
+
+//////////////////////////////////////////////////
+/// \brief The queues share the budget in proportion to their demand, and
+/// return it when destroyed.
+TEST(QueueSizerTest, Budget)
+{
+  auto budget = std::make_shared<QueueBudget>(6400);
+  Timestamp now = std::chrono::steady_clock::now();
+  {
+    QueueSizer small(budget);
+    EXPECT_EQ(64u, small.Arrival(100, 0, now));
+
+    // Twice the demand of the first queue: two thirds of the budget.
+    QueueSizer large(budget);
+    EXPECT_EQ(21u, large.Arrival(200, 0, now));
+    EXPECT_EQ(19200u, budget->Demand());
+
+    // Each queue keeps its minimum depth.
+    QueueSizer huge(budget);
+    EXPECT_EQ(QueueSizer::kMinDepth, huge.Arrival(1u << 20, 0, now));
+  }
+  EXPECT_EQ(0u, budget->Demand());
+}
+
+//////////////////////////////////////////////////
+/// \brief The depth never exceeds the maximum.
+TEST(QueueSizerTest, MaxDepth)
+{
+  auto budget = std::make_shared<QueueBudget>(1u << 30);
+  QueueSizer sizer(budget, 10);
+  Timestamp now = std::chrono::steady_clock::now();
+  EXPECT_EQ(10u, sizer.Arrival(1, 0, now));
+  EXPECT_EQ(10u, sizer.Arrival(1, 10, now));
+
+  QueueSizer single(budget, 1);
+  EXPECT_EQ(1u, single.Arrival(1, 0, now));
+}
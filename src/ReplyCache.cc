@@ -0,0 +1,178 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "ReplyCache.hh"
+
+using namespace gz;
+using namespace transport;
+
+namespace gz
+{
+  namespace transport
+  {
+    inline namespace GZ_TRANSPORT_VERSION_NAMESPACE
+    {
+    /// \internal
+    /// \brief Private data for ReplyCache class.
+    class ReplyCachePrivate
+    {
+      /// \brief A response stored.
+      public: struct Entry
+      {
+        /// \brief Serialized response.
+        std::string rep;
+
+        /// \brief When the response expires.
+        Timestamp expiry;
+
+        /// \brief Position of the key in lru.
+        std::list<std::string>::iterator lruPos;
+      };
+
+      /// \brief Get the key of a request. The service identifiers don't
+      /// contain null characters.
+      /// \param[in] _service Identifies the service.
+      /// \param[in] _req Serialized request.
+      /// \return The key.
+      public: static std::string Key(const std::string &_service,
+                                     const std::string &_req)
+      {
+        std::string key;
+        key.reserve(_service.size() + 1 + _req.size());
+        key.append(_service);
+        key.push_back('\0');
+        key.append(_req);
+        return key;
+      }
+
+      /// \brief Remove an entry.
+      /// \param[in] _it The entry.
+      public: void Evict(
+        std::unordered_map<std::string, Entry>::iterator _it)
+      {
+        this->bytes -= _it->first.size() + _it->second.rep.size();
+        this->lru.erase(_it->second.lruPos);
+        this->entries.erase(_it);
+      }
+
+      /// \brief Protects the entries.
+      public: mutable std::mutex mutex;
+
+      /// \brief The responses, by key.
+      public: std::unordered_map<std::string, Entry> entries;
+
+      /// \brief The keys, from the most recently used to the least.
+      public: std::list<std::string> lru;
+
+      /// \brief Size of the keys and responses stored (bytes).
+      public: uint64_t bytes = 0;
+
+      /// \brief Maximum size of the keys and responses stored (bytes).
+      public: uint64_t maxBytes = 0;
+    };
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+ReplyCache::ReplyCache(const uint64_t _maxBytes)
+  : dataPtr(new ReplyCachePrivate())
+{
+  this->dataPtr->maxBytes = _maxBytes;
+}
+
+//////////////////////////////////////////////////
+ReplyCache::~ReplyCache() = default;
+
+//////////////////////////////////////////////////
+bool ReplyCache::Find(const std::string &_service, const std::string &_req,
+    std::string &_rep, std::chrono::milliseconds &_ttl, const Timestamp &_now)
+{
+  std::lock_guard<std::mutex> lk(this->dataPtr->mutex);
+  if (this->dataPtr->entries.empty())
+    return false;
+
+  auto it = this->dataPtr->entries.find(
+    ReplyCachePrivate::Key(_service, _req));
+  if (it == this->dataPtr->entries.end())
+    return false;
+
+  if (_now >= it->second.expiry)
+  {
+    this->dataPtr->Evict(it);
+    return false;
+  }
+
+  this->dataPtr->lru.splice(this->dataPtr->lru.begin(), this->dataPtr->lru,
+    it->second.lruPos);
+  _rep = it->second.rep;
+  _ttl = std::chrono::duration_cast<std::chrono::milliseconds>(
+    it->second.expiry - _now);
+  return true;
+}
+
+//////////////////////////////////////////////////
+void ReplyCache::Insert(const std::string &_service, const std::string &_req,
+    const std::string &_rep, const std::chrono::milliseconds &_ttl,
+    const Timestamp &_now)
+{
+  std::string key = ReplyCachePrivate::Key(_service, _req);
+  const uint64_t size = key.size() + _rep.size();
+
+  std::lock_guard<std::mutex> lk(this->dataPtr->mutex);
+  auto it = this->dataPtr->entries.find(key);
+  if (it != this->dataPtr->entries.end())
+    this->dataPtr->Evict(it);
+
+  if (_ttl.count() <= 0 || size > this->dataPtr->maxBytes)
+    return;
+
+  while (this->dataPtr->bytes + size > this->dataPtr->maxBytes)
+  {
+    this->dataPtr->Evict(
+      this->dataPtr->entries.find(this->dataPtr->lru.back()));
+  }
+
+  this->dataPtr->lru.push_front(key);
+  ReplyCachePrivate::Entry &entry = this->dataPtr->entries[std::move(key)];
+  entry.rep = _rep;
+  entry.expiry = _now + _ttl;
+  entry.lruPos = this->dataPtr->lru.begin();
+  this->dataPtr->bytes += size;
+}
+
+//////////////////////////////////////////////////
+std::size_t ReplyCache::Size() const
+{
+  std::lock_guard<std::mutex> lk(this->dataPtr->mutex);
+  return this->dataPtr->entries.size();
+}
+
+//////////////////////////////////////////////////
+uint64_t ReplyCache::Bytes() const
+{
+  std::lock_guard<std::mutex> lk(this->dataPtr->mutex);
+  return this->dataPtr->bytes;
+}
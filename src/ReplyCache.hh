@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GZ_TRANSPORT_REPLYCACHE_HH_
+#define GZ_TRANSPORT_REPLYCACHE_HH_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "gz/transport/config.hh"
+#include "gz/transport/TransportTypes.hh"
+
+namespace gz
+{
+  namespace transport
+  {
+    inline namespace GZ_TRANSPORT_VERSION_NAMESPACE
+    {
+    class ReplyCachePrivate;
+
+    /// \internal
+    /// \brief The responses of the cacheable services (see
+    /// AdvertiseServiceOptions::SetCacheTtl()), by service and serialized
+    /// request. A response is valid until its time to live elapses. The
+    /// amount of memory used by the responses is capped, the least recently
+    /// used ones are evicted first.
+    ///
+    /// This class is thread-safe.
+    class ReplyCache
+    {
+      /// \brief Constructor.
+      /// \param[in] _maxBytes Maximum size of the requests and responses
+      /// stored (bytes).
+      public: explicit ReplyCache(const uint64_t _maxBytes);
+
+      /// \brief Destructor.
+      public: ~ReplyCache();
+
+      /// \brief No copy constructor.
+      public: ReplyCache(const ReplyCache &) = delete;
+
+      /// \brief No assignment operator.
+      public: ReplyCache &operator=(const ReplyCache &) = delete;
+
+      /// \brief Get a response stored.
+      /// \param[in] _service Identifies the service, e.g. its handler UUID.
+      /// \param[in] _req Serialized request.
+      /// \param[out] _rep Serialized response.
+      /// \param[out] _ttl Remaining time to live of the response.
+      /// \param[in] _now Current time.
+      /// \return True if a response is stored and still valid.
+      public: bool Find(const std::string &_service,
+                        const std::string &_req,
+                        std::string &_rep,
+                        std::chrono::milliseconds &_ttl,
+                        const Timestamp &_now =
+                          std::chrono::steady_clock::now());
+
+      /// \brief Store a response, replacing the previous one of the request.
+      /// Nothing is stored if it doesn't fit in the cache.
+      /// \param[in] _service Identifies the service, e.g. its handler UUID.
+      /// \param[in] _req Serialized request.
+      /// \param[in] _rep Serialized response.
+      /// \param[in] _ttl Time to live of the response.
+      /// \param[in] _now Current time.
+      public: void Insert(const std::string &_service,
+                          const std::string &_req,
+                          const std::string &_rep,
+                          const std::chrono::milliseconds &_ttl,
+                          const Timestamp &_now =
+                            std::chrono::steady_clock::now());
+
+      /// \brief Get the number of responses stored, including the ones
+      /// expired but not evicted yet.
+      /// \return The number of responses.
+      public: std::size_t Size() const;
+
+      /// \brief Get the size of the requests and responses stored.
+      /// \return The size (bytes).
+      public: uint64_t Bytes() const;
+
+      /// \brief Private data.
+      private: std::unique_ptr<ReplyCachePrivate> dataPtr;
+    };
+    }
+  }
+}
+#endif
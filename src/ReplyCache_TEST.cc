@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <chrono>
+#include <string>
+
+#include "ReplyCache.hh"
+#include "gtest/gtest.h"
+
+using namespace gz;
+using namespace transport;
+using namespace std::chrono_literals;
+
+//////////////////////////////////////////////////
+/// \brief The responses are found by service and request until they
+/// expire.
+TEST(ReplyCacheTest, FindExpire)
+{
+  ReplyCache cache(1024);
+  const Timestamp now = std::chrono::steady_clock::now();
+  std::string rep;
+  std::chrono::milliseconds ttl;
+
+  EXPECT_FALSE(cache.Find("srv", "req", rep, ttl, now));
+  cache.Insert("srv", "req", "rep", 100ms, now);
+  EXPECT_EQ(1u, cache.Size());
+  EXPECT_EQ(10u, cache.Bytes());
+
+  EXPECT_TRUE(cache.Find("srv", "req", rep, ttl, now + 99ms));
+  EXPECT_EQ("rep", rep);
+  EXPECT_EQ(1, ttl.count());
+  EXPECT_FALSE(cache.Find("srv", "other", rep, ttl, now));
+  EXPECT_FALSE(cache.Find("other", "req", rep, ttl, now));
+
+  // A response replaces the previous one of the request.
+  cache.Insert("srv", "req", "rep2", 100ms, now);
+  EXPECT_EQ(1u, cache.Size());
+  EXPECT_TRUE(cache.Find("srv", "req", rep, ttl, now));
+  EXPECT_EQ("rep2", rep);
+
+  // The expired responses are evicted.
+  EXPECT_FALSE(cache.Find("srv", "req", rep, ttl, now + 100ms));
+  EXPECT_EQ(0u, cache.Size());
+  EXPECT_EQ(0u, cache.Bytes());
+
+  // Nothing is stored without a time to live.
+  cache.Insert("srv", "req", "rep", 0ms, now);
+  EXPECT_EQ(0u, cache.Size());
+
+  // The empty requests and responses are cached.
+  cache.Insert("srv", "", "", 100ms, now);
+  EXPECT_TRUE(cache.Find("srv", "", rep, ttl, now));
+  EXPECT_TRUE(rep.empty());
+}
+
+//////////////////////////////////////////////////
+/// \brief The least recently used responses are evicted when the cache is
+/// full.
+TEST(ReplyCacheTest, Eviction)
+{
+  // Each entry takes 4 bytes: "s", the separator, the request and the
+  // response.
+  ReplyCache cache(12);
+  const Timestamp now = std::chrono::steady_clock::now();
+  std::string rep;
+  std::chrono::milliseconds ttl;
+
+  cache.Insert("s", "a", "1", 1s, now);
+  cache.Insert("s", "b", "2", 1s, now);
+  cache.Insert("s", "c", "3", 1s, now);
+  EXPECT_EQ(3u, cache.Size());
+  EXPECT_EQ(12u, cache.Bytes());
+
+  // "a" is used, "b" becomes the least recently used.
+  EXPECT_TRUE(cache.Find("s", "a", rep, ttl, now));
+  cache.Insert("s", "d", "4", 1s, now);
+  EXPECT_EQ(3u, cache.Size());
+  EXPECT_FALSE(cache.Find("s", "b", rep, ttl, now));
+  EXPECT_TRUE(cache.Find("s", "a", rep, ttl, now));
+  EXPECT_TRUE(cache.Find("s", "c", rep, ttl, now));
+  EXPECT_TRUE(cache.Find("s", "d", rep, ttl, now));
+
+  // A response larger than the cache isn't stored.
+  cache.Insert("s", "e", std::string(16, 'x'), 1s, now);
+  EXPECT_FALSE(cache.Find("s", "e", rep, ttl, now));
+  EXPECT_EQ(3u, cache.Size());
+}
+
@@ -0,0 +1,404 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "gz/transport/ReqHandler.hh"
+#include "RequestTable.hh"
+#include "UuidKey.hh"
+
+namespace gz
+{
+  namespace transport
+  {
+    inline namespace GZ_TRANSPORT_VERSION_NAMESPACE
+    {
+    /// \brief Interval of time covered by each bucket of the timer wheel.
+    static const std::chrono::milliseconds kWheelResolution{10};
+
+    /// \brief Number of buckets of the timer wheel (power of two).
+    static const uint64_t kWheelSize = 512;
+
+    /// \brief Index of a slot used by the requests not sent yet.
+    static const std::size_t kNotPending = static_cast<std::size_t>(-1);
+
+    /// \brief Get the index of the bucket covering a time.
+    /// \param[in] _time The time.
+    /// \param[in] _roundUp True to round up to the next bucket.
+    /// \return The tick (unbounded bucket index).
+    static int64_t wheelTick(const Timestamp &_time, const bool _roundUp)
+    {
+      // Rounded in the native duration of the clock, so a deadline is never
+      // moved earlier.
+      const auto res = std::chrono::duration_cast<Timestamp::duration>(
+        kWheelResolution).count();
+      const auto time = _time.time_since_epoch().count();
+      return time / res + (_roundUp && time % res != 0 ? 1 : 0);
+    }
+
+    /// \brief A request stored in the table.
+    struct RequestSlot
+    {
+      /// \brief The request, nullptr if the slot is free.
+      IReqHandlerPtr handler;
+
+      /// \brief Service name.
+      std::string topic;
+
+      /// \brief UUID of the handler.
+      UuidKey key;
+
+      /// \brief Incremented every time the slot is released, so the ids of
+      /// the previous requests stored in the slot become invalid.
+      uint32_t generation = 0;
+
+      /// \brief Position in the list of requests not sent of the topic, or
+      /// kNotPending.
+      std::size_t pendingPos = kNotPending;
+    };
+
+    /// \brief A deadline stored in the timer wheel.
+    struct RequestTimer
+    {
+      /// \brief Id of the request.
+      uint64_t id;
+
+      /// \brief Tick of the deadline.
+      int64_t tick;
+    };
+
+    /// \internal
+    /// \brief Private data for RequestTable class.
+    class RequestTablePrivate
+    {
+      /// \brief Get the id of the request stored in a slot.
+      /// \param[in] _index Index of the slot.
+      /// \return The id.
+      public: uint64_t Id(const uint32_t _index) const
+      {
+        return (static_cast<uint64_t>(this->slots[_index].generation) << 32) |
+          _index;
+      }
+
+      /// \brief Get the slot of a request.
+      /// \param[in] _id Id of the request.
+      /// \return The slot or nullptr if the request has been removed.
+      public: RequestSlot *Slot(const uint64_t _id)
+      {
+        const uint32_t index = static_cast<uint32_t>(_id);
+        if (index >= this->slots.size() || this->Id(index) != _id ||
+            !this->slots[index].handler)
+        {
+          return nullptr;
+        }
+        return &this->slots[index];
+      }
+
+      /// \brief Remove a request from the list of requests not sent.
+      /// \param[in] _index Index of the slot.
+      public: void RemovePending(const uint32_t _index)
+      {
+        RequestSlot &slot = this->slots[_index];
+        if (slot.pendingPos == kNotPending)
+          return;
+
+        auto it = this->pending.find(slot.topic);
+        std::vector<uint32_t> &list = it->second;
+        const uint32_t last = list.back();
+        list[slot.pendingPos] = last;
+        this->slots[last].pendingPos = slot.pendingPos;
+        list.pop_back();
+        slot.pendingPos = kNotPending;
+        if (list.empty())
+          this->pending.erase(it);
+      }
+
+      /// \brief Release a slot.
+      /// \param[in] _index Index of the slot.
+      public: void Release(const uint32_t _index)
+      {
+        this->RemovePending(_index);
+        RequestSlot &slot = this->slots[_index];
+        slot.handler.reset();
+        slot.topic.clear();
+        ++slot.generation;
+        this->freeSlots.push_back(_index);
+      }
+
+      /// \brief The slots.
+      public: std::vector<RequestSlot> slots;
+
+      /// \brief Indexes of the free slots.
+      public: std::vector<uint32_t> freeSlots;
+
+      /// \brief Ids of the requests. The key is the handler UUID.
+      public: std::unordered_map<UuidKey, uint64_t, UuidKeyHash> ids;
+
+      /// \brief Slots of the requests not sent yet. The key is the topic.
+      public: std::unordered_map<std::string, std::vector<uint32_t>> pending;
+
+      /// \brief The buckets of the timer wheel. The timers of the requests
+      /// removed are discarded once their bucket is visited.
+      public: std::vector<std::vector<RequestTimer>> wheel{kWheelSize};
+
+      /// \brief Number of timers stored in the wheel.
+      public: std::size_t numTimers = 0;
+
+      /// \brief Last tick visited by Expire().
+      public: int64_t currentTick =
+        wheelTick(std::chrono::steady_clock::now(), false);
+    };
+
+    //////////////////////////////////////////////////
+    RequestTable::RequestTable()
+      : dataPtr(new RequestTablePrivate)
+    {
+    }
+
+    //////////////////////////////////////////////////
+    RequestTable::~RequestTable()
+    {
+    }
+
+    //////////////////////////////////////////////////
+    bool RequestTable::Add(const std::string &_topic,
+      const IReqHandlerPtr &_handler)
+    {
+      UuidKey key;
+      if (!UuidKey::Parse(_handler->HandlerUuid(), key))
+        return false;
+
+      auto inserted = this->dataPtr->ids.emplace(key, 0);
+      if (!inserted.second)
+        return false;
+
+      uint32_t index;
+      if (this->dataPtr->freeSlots.empty())
+      {
+        index = static_cast<uint32_t>(this->dataPtr->slots.size());
+        this->dataPtr->slots.emplace_back();
+      }
+      else
+      {
+        index = this->dataPtr->freeSlots.back();
+        this->dataPtr->freeSlots.pop_back();
+      }
+
+      RequestSlot &slot = this->dataPtr->slots[index];
+      slot.handler = _handler;
+      slot.topic = _topic;
+      slot.key = key;
+
+      std::vector<uint32_t> &list = this->dataPtr->pending[_topic];
+      slot.pendingPos = list.size();
+      list.push_back(index);
+
+      const uint64_t id = this->dataPtr->Id(index);
+      inserted.first->second = id;
+
+      const Timestamp deadline = _handler->Deadline();
+      if (deadline != Timestamp::max())
+      {
+        const int64_t tick = std::max(wheelTick(deadline, true),
+          this->dataPtr->currentTick + 1);
+        this->dataPtr->wheel[static_cast<uint64_t>(tick) & (kWheelSize - 1)]
+          .push_back({id, tick});
+        ++this->dataPtr->numTimers;
+      }
+      return true;
+    }
+
+    //////////////////////////////////////////////////
+    IReqHandlerPtr RequestTable::Find(const std::string &_topic,
+      const std::string &_nUuid, const std::string &_hUuid) const
+    {
+      UuidKey key;
+      if (!UuidKey::Parse(_hUuid, key))
+        return nullptr;
+
+      auto it = this->dataPtr->ids.find(key);
+      if (it == this->dataPtr->ids.end())
+        return nullptr;
+
+      const RequestSlot &slot =
+        this->dataPtr->slots[static_cast<uint32_t>(it->second)];
+      if (slot.topic != _topic || slot.handler->NodeUuid() != _nUuid)
+        return nullptr;
+
+      return slot.handler;
+    }
+
+    //////////////////////////////////////////////////
+    bool RequestTable::Remove(const std::string &_hUuid)
+    {
+      return this->Take(_hUuid) != nullptr;
+    }
+
+    //////////////////////////////////////////////////
+    IReqHandlerPtr RequestTable::Take(const std::string &_hUuid)
+    {
+      UuidKey key;
+      if (!UuidKey::Parse(_hUuid, key))
+        return nullptr;
+
+      auto it = this->dataPtr->ids.find(key);
+      if (it == this->dataPtr->ids.end())
+        return nullptr;
+
+      const uint32_t index = static_cast<uint32_t>(it->second);
+      IReqHandlerPtr handler = this->dataPtr->slots[index].handler;
+      this->dataPtr->Release(index);
+      this->dataPtr->ids.erase(it);
+      return handler;
+    }
+
+    //////////////////////////////////////////////////
+    bool RequestTable::HasPending(const std::string &_topic,
+      const std::string &_reqType, const std::string &_repType) const
+    {
+      auto it = this->dataPtr->pending.find(_topic);
+      if (it == this->dataPtr->pending.end())
+        return false;
+
+      for (const uint32_t index : it->second)
+      {
+        const IReqHandlerPtr &handler = this->dataPtr->slots[index].handler;
+        if (handler->ReqTypeName() == _reqType &&
+            handler->RepTypeName() == _repType)
+        {
+          return true;
+        }
+      }
+      return false;
+    }
+
+    //////////////////////////////////////////////////
+    void RequestTable::TakePending(const std::string &_topic,
+      const std::string &_reqType, const std::string &_repType,
+      std::vector<IReqHandlerPtr> &_handlers)
+    {
+      _handlers.clear();
+      auto it = this->dataPtr->pending.find(_topic);
+      if (it == this->dataPtr->pending.end())
+        return;
+
+      // Keep the requests with other types.
+      std::vector<uint32_t> &list = it->second;
+      std::size_t kept = 0;
+      for (const uint32_t index : list)
+      {
+        RequestSlot &slot = this->dataPtr->slots[index];
+        if (slot.handler->ReqTypeName() == _reqType &&
+            slot.handler->RepTypeName() == _repType)
+        {
+          slot.handler->Requested(true);
+          slot.pendingPos = kNotPending;
+          _handlers.push_back(slot.handler);
+        }
+        else
+        {
+          slot.pendingPos = kept;
+          list[kept++] = index;
+        }
+      }
+
+      list.resize(kept);
+      if (list.empty())
+        this->dataPtr->pending.erase(it);
+    }
+
+    //////////////////////////////////////////////////
+    void RequestTable::Expire(const Timestamp &_now,
+      std::vector<IReqHandlerPtr> &_expired)
+    {
+      const int64_t nowTick = wheelTick(_now, false);
+      const int64_t lastTick = this->dataPtr->currentTick;
+      if (nowTick <= lastTick)
+        return;
+
+      this->dataPtr->currentTick = nowTick;
+      if (this->dataPtr->numTimers == 0)
+        return;
+
+      // Visit each bucket at most once, even after a long interval.
+      const int64_t steps =
+        std::min(nowTick - lastTick, static_cast<int64_t>(kWheelSize));
+      for (int64_t i = 1; i <= steps; ++i)
+      {
+        std::vector<RequestTimer> &bucket = this->dataPtr->wheel[
+          static_cast<uint64_t>(lastTick + i) & (kWheelSize - 1)];
+
+        std::size_t kept = 0;
+        for (const RequestTimer &timer : bucket)
+        {
+          RequestSlot *slot = this->dataPtr->Slot(timer.id);
+          if (slot && timer.tick > nowTick)
+          {
+            // The deadline is in a later turn of the wheel.
+            bucket[kept++] = timer;
+            continue;
+          }
+
+          if (slot)
+          {
+            _expired.push_back(slot->handler);
+            this->dataPtr->ids.erase(slot->key);
+            this->dataPtr->Release(static_cast<uint32_t>(timer.id));
+          }
+        }
+
+        this->dataPtr->numTimers -= bucket.size() - kept;
+        bucket.resize(kept);
+      }
+    }
+
+    //////////////////////////////////////////////////
+    Timestamp RequestTable::NextDeadline() const
+    {
+      if (this->dataPtr->numTimers == 0)
+        return Timestamp::max();
+
+      // The first bucket not empty. Its timers might belong to a later turn
+      // of the wheel, waking up earlier is harmless.
+      const int64_t current = this->dataPtr->currentTick;
+      for (int64_t tick = current + 1;
+           tick <= current + static_cast<int64_t>(kWheelSize); ++tick)
+      {
+        if (!this->dataPtr->wheel[
+              static_cast<uint64_t>(tick) & (kWheelSize - 1)].empty())
+        {
+          return Timestamp(std::chrono::duration_cast<Timestamp::duration>(
+            tick * kWheelResolution));
+        }
+      }
+      return Timestamp::max();
+    }
+
+    //////////////////////////////////////////////////
+    std::size_t RequestTable::Size() const
+    {
+      return this->dataPtr->ids.size();
+    }
+    }
+  }
+}
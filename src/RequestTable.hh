@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GZ_TRANSPORT_REQUESTTABLE_HH_
+#define GZ_TRANSPORT_REQUESTTABLE_HH_
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gz/transport/config.hh"
+#include "gz/transport/TransportTypes.hh"
+
+namespace gz
+{
+  namespace transport
+  {
+    inline namespace GZ_TRANSPORT_VERSION_NAMESPACE
+    {
+    class RequestTablePrivate;
+
+    /// \internal
+    /// \brief The service call requests waiting for a response. Each request
+    /// is stored in a slot of a table and identified internally by a compact
+    /// id (the index of the slot and a generation number), a hash table maps
+    /// the handler UUIDs received with the responses to the ids. The
+    /// requests not sent yet are also listed per topic, so sending them
+    /// doesn't visit the requests already in flight.
+    ///
+    /// The requests with a deadline are stored in a timer wheel: a ring of
+    /// buckets, each one covering a fixed interval of time. Expire() only
+    /// visits the buckets of the time elapsed since its previous call.
+    ///
+    /// This class is not thread-safe, the caller must serialize the calls.
+    class RequestTable
+    {
+      /// \brief Constructor.
+      public: RequestTable();
+
+      /// \brief Destructor.
+      public: ~RequestTable();
+
+      /// \brief No copy constructor.
+      public: RequestTable(const RequestTable &) = delete;
+
+      /// \brief No assignment operator.
+      public: RequestTable &operator=(const RequestTable &) = delete;
+
+      /// \brief Add a request not sent yet. The request expires at the time
+      /// returned by IReqHandler::Deadline().
+      /// \param[in] _topic Service name.
+      /// \param[in] _handler The request handler.
+      /// \return True on success or false if a handler with the same UUID is
+      /// already stored or its UUID isn't valid.
+      public: bool Add(const std::string &_topic,
+                       const IReqHandlerPtr &_handler);
+
+      /// \brief Get a request.
+      /// \param[in] _topic Service name.
+      /// \param[in] _nUuid UUID of the node that made the request.
+      /// \param[in] _hUuid UUID of the request handler.
+      /// \return The handler or nullptr if there's no such request.
+      public: IReqHandlerPtr Find(const std::string &_topic,
+                                  const std::string &_nUuid,
+                                  const std::string &_hUuid) const;
+
+      /// \brief Remove a request.
+      /// \param[in] _hUuid UUID of the request handler.
+      /// \return True if the request was removed or false if it wasn't
+      /// stored.
+      public: bool Remove(const std::string &_hUuid);
+
+      /// \brief Remove a request and get it.
+      /// \param[in] _hUuid UUID of the request handler.
+      /// \return The handler or nullptr if it wasn't stored.
+      public: IReqHandlerPtr Take(const std::string &_hUuid);
+
+      /// \brief Check whether there are requests not sent yet for a service
+      /// with a specific pair of request/response types.
+      /// \param[in] _topic Service name.
+      /// \param[in] _reqType Type of the request.
+      /// \param[in] _repType Type of the response.
+      /// \return True if at least one request is waiting to be sent.
+      public: bool HasPending(const std::string &_topic,
+                              const std::string &_reqType,
+                              const std::string &_repType) const;
+
+      /// \brief Get the requests not sent yet for a service with a specific
+      /// pair of request/response types and mark them as requested. The
+      /// requests remain stored until they are removed.
+      /// \param[in] _topic Service name.
+      /// \param[in] _reqType Type of the request.
+      /// \param[in] _repType Type of the response.
+      /// \param[out] _handlers The requests.
+      public: void TakePending(const std::string &_topic,
+                               const std::string &_reqType,
+                               const std::string &_repType,
+                               std::vector<IReqHandlerPtr> &_handlers);
+
+      /// \brief Remove the requests whose deadline has passed.
+      /// \param[in] _now Current time.
+      /// \param[out] _expired The requests removed.
+      public: void Expire(const Timestamp &_now,
+                          std::vector<IReqHandlerPtr> &_expired);
+
+      /// \brief Get the time of the next call to Expire() that might remove
+      /// a request, rounded up to the resolution of the wheel. The time
+      /// might be earlier than the next deadline if requests with a deadline
+      /// were removed.
+      /// \return The time or Timestamp::max() if no request has a deadline.
+      public: Timestamp NextDeadline() const;
+
+      /// \brief Get the number of requests stored.
+      /// \return The number of requests.
+      public: std::size_t Size() const;
+
+      /// \brief Private data.
+      private: std::unique_ptr<RequestTablePrivate> dataPtr;
+    };
+    }
+  }
+}
+#endif
@@ -0,0 +1,210 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gz/msgs/int32.pb.h>
+#include <gz/msgs/stringmsg.pb.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gz/transport/ReqHandler.hh"
+#include "RequestTable.hh"
+#include "gtest/gtest.h"
+
+using namespace gz;
+
+using StringReqHandler =
+  transport::ReqHandler<msgs::StringMsg, msgs::StringMsg>;
+
+/// \brief Create a request handler.
+/// \param[in] _deadline Deadline of the request.
+/// \return The handler.
+static std::shared_ptr<StringReqHandler> makeHandler(
+  const transport::Timestamp &_deadline = transport::Timestamp::max())
+{
+  auto handler = std::make_shared<StringReqHandler>("node");
+  handler->SetDeadline(_deadline);
+  return handler;
+}
+
+//////////////////////////////////////////////////
+/// \brief Add, find and remove requests.
+TEST(RequestTableTest, AddFindRemove)
+{
+  transport::RequestTable table;
+  auto h1 = makeHandler();
+  auto h2 = makeHandler();
+
+  EXPECT_TRUE(table.Add("/foo", h1));
+  EXPECT_FALSE(table.Add("/foo", h1));
+  EXPECT_TRUE(table.Add("/bar", h2));
+  EXPECT_EQ(2u, table.Size());
+
+  EXPECT_EQ(h1, table.Find("/foo", "node", h1->HandlerUuid()));
+  EXPECT_EQ(h2, table.Find("/bar", "node", h2->HandlerUuid()));
+  EXPECT_EQ(nullptr, table.Find("/bar", "node", h1->HandlerUuid()));
+  EXPECT_EQ(nullptr, table.Find("/foo", "other", h1->HandlerUuid()));
+  EXPECT_EQ(nullptr, table.Find("/foo", "node", "unknown"));
+
+  EXPECT_TRUE(table.Remove(h1->HandlerUuid()));
+  EXPECT_FALSE(table.Remove(h1->HandlerUuid()));
+  EXPECT_EQ(nullptr, table.Find("/foo", "node", h1->HandlerUuid()));
+  EXPECT_EQ(1u, table.Size());
+
+  // The slot released is reused.
+  auto h3 = makeHandler();
+  EXPECT_TRUE(table.Add("/foo", h3));
+  EXPECT_EQ(h3, table.Find("/foo", "node", h3->HandlerUuid()));
+  EXPECT_EQ(h2, table.Find("/bar", "node", h2->HandlerUuid()));
+
+  // Take returns the request removed.
+  EXPECT_EQ(h3, table.Take(h3->HandlerUuid()));
+  EXPECT_EQ(nullptr, table.Take(h3->HandlerUuid()));
+  EXPECT_EQ(1u, table.Size());
+}
+
+//////////////////////////////////////////////////
+/// \brief Take the requests not sent yet.
+TEST(RequestTableTest, TakePending)
+{
+  transport::RequestTable table;
+  const std::string strType = msgs::StringMsg().GetTypeName();
+  const std::string intType = msgs::Int32().GetTypeName();
+
+  auto h1 = makeHandler();
+  auto h2 = makeHandler();
+  auto h3 = std::make_shared<
+    transport::ReqHandler<msgs::Int32, msgs::Int32>>("node");
+  auto h4 = makeHandler();
+  EXPECT_TRUE(table.Add("/foo", h1));
+  EXPECT_TRUE(table.Add("/foo", h2));
+  EXPECT_TRUE(table.Add("/foo", h3));
+  EXPECT_TRUE(table.Add("/foo", h4));
+
+  // A request removed before being sent.
+  EXPECT_TRUE(table.Remove(h2->HandlerUuid()));
+
+  EXPECT_TRUE(table.HasPending("/foo", strType, strType));
+  EXPECT_FALSE(table.HasPending("/foo", strType, intType));
+  EXPECT_FALSE(table.HasPending("/bar", strType, strType));
+
+  std::vector<transport::IReqHandlerPtr> handlers;
+  table.TakePending("/foo", strType, strType, handlers);
+  ASSERT_EQ(2u, handlers.size());
+  EXPECT_TRUE(handlers[0] == h1 || handlers[1] == h1);
+  EXPECT_TRUE(handlers[0] == h4 || handlers[1] == h4);
+  EXPECT_TRUE(h1->Requested());
+  EXPECT_TRUE(h4->Requested());
+  EXPECT_FALSE(h3->Requested());
+
+  // The requests sent are still stored.
+  EXPECT_FALSE(table.HasPending("/foo", strType, strType));
+  EXPECT_EQ(h1, table.Find("/foo", "node", h1->HandlerUuid()));
+  table.TakePending("/foo", strType, strType, handlers);
+  EXPECT_TRUE(handlers.empty());
+
+  EXPECT_TRUE(table.HasPending("/foo", intType, intType));
+  table.TakePending("/foo", intType, intType, handlers);
+  ASSERT_EQ(1u, handlers.size());
+  EXPECT_EQ(h3, handlers[0]);
+  EXPECT_EQ(3u, table.Size());
+}
+
+//////////////////////////////////////////////////
+/// \brief Expire the requests with a deadline.
+TEST(RequestTableTest, Expire)
+{
+  transport::RequestTable table;
+  const auto now = std::chrono::steady_clock::now();
+
+  auto h1 = makeHandler(now + std::chrono::milliseconds(50));
+  auto h2 = makeHandler(now + std::chrono::milliseconds(200));
+  auto h3 = makeHandler(now + std::chrono::milliseconds(100));
+  auto h4 = makeHandler();
+  // Beyond a turn of the wheel.
+  auto h5 = makeHandler(now + std::chrono::seconds(20));
+  EXPECT_TRUE(table.Add("/foo", h1));
+  EXPECT_TRUE(table.Add("/foo", h2));
+  EXPECT_TRUE(table.Add("/foo", h3));
+  EXPECT_TRUE(table.Add("/foo", h4));
+  EXPECT_TRUE(table.Add("/foo", h5));
+
+  // A request completed before its deadline.
+  EXPECT_TRUE(table.Remove(h3->HandlerUuid()));
+
+  std::vector<transport::IReqHandlerPtr> expired;
+  table.Expire(now + std::chrono::milliseconds(40), expired);
+  EXPECT_TRUE(expired.empty());
+
+  table.Expire(now + std::chrono::milliseconds(150), expired);
+  ASSERT_EQ(1u, expired.size());
+  EXPECT_EQ(h1, expired[0]);
+  EXPECT_EQ(nullptr, table.Find("/foo", "node", h1->HandlerUuid()));
+  EXPECT_FALSE(table.Remove(h1->HandlerUuid()));
+
+  // Skip several turns of the wheel at once.
+  expired.clear();
+  table.Expire(now + std::chrono::seconds(10), expired);
+  ASSERT_EQ(1u, expired.size());
+  EXPECT_EQ(h2, expired[0]);
+
+  expired.clear();
+  table.Expire(now + std::chrono::seconds(30), expired);
+  ASSERT_EQ(1u, expired.size());
+  EXPECT_EQ(h5, expired[0]);
+
+  // The requests without a deadline never expire.
+  EXPECT_EQ(1u, table.Size());
+  EXPECT_EQ(h4, table.Find("/foo", "node", h4->HandlerUuid()));
+}
+
+//////////////////////////////////////////////////
+/// \brief Get the time of the next deadline.
+TEST(RequestTableTest, NextDeadline)
+{
+  transport::RequestTable table;
+  EXPECT_EQ(transport::Timestamp::max(), table.NextDeadline());
+
+  EXPECT_TRUE(table.Add("/foo", makeHandler()));
+  EXPECT_EQ(transport::Timestamp::max(), table.NextDeadline());
+
+  // The deadlines are on a bucket boundary of the wheel (10 ms) plus a
+  // fraction of a millisecond, which must not be truncated.
+  const auto bucket = std::chrono::time_point_cast<std::chrono::seconds>(
+    std::chrono::steady_clock::now()) + std::chrono::seconds(1);
+  const auto fraction = std::chrono::microseconds(500);
+  auto h1 = makeHandler(bucket + std::chrono::milliseconds(200) + fraction);
+  auto h2 = makeHandler(bucket + std::chrono::milliseconds(100) + fraction);
+  EXPECT_TRUE(table.Add("/foo", h1));
+  EXPECT_TRUE(table.Add("/foo", h2));
+
+  // Rounded up to the resolution of the wheel.
+  transport::Timestamp next = table.NextDeadline();
+  EXPECT_EQ(bucket + std::chrono::milliseconds(110), next);
+
+  std::vector<transport::IReqHandlerPtr> expired;
+  table.Expire(next - std::chrono::nanoseconds(1), expired);
+  EXPECT_TRUE(expired.empty());
+  table.Expire(next, expired);
+  ASSERT_EQ(1u, expired.size());
+  EXPECT_EQ(h2, expired[0]);
+
+  next = table.NextDeadline();
+  EXPECT_EQ(bucket + std::chrono::milliseconds(210), next);
+}
@@ -0,0 +1,319 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <zmq.hpp>
+
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <istream>
+#include <string>
+#include <vector>
+
+#include "gz/transport/Helpers.hh"
+
+#include "SecurityOptions.hh"
+
+using namespace gz;
+using namespace transport;
+
+/// \brief Length of a CURVE key in Z85 format.
+static const std::size_t kZ85KeyLen = 40;
+
+/// \brief Size of a CURVE key in binary form (bytes).
+static const std::size_t kKeySize = 32;
+
+//////////////////////////////////////////////////
+/// \brief Decode a CURVE key.
+/// \param[in] _z85 The key in Z85 format.
+/// \param[out] _key The key in binary form.
+/// \return True if _z85 is a valid key.
+static bool decodeKey(const std::string &_z85, std::string &_key)
+{
+  if (_z85.size() != kZ85KeyLen)
+    return false;
+
+  _key.resize(kKeySize);
+  return zmq_z85_decode(reinterpret_cast<uint8_t *>(&_key[0]),
+    _z85.c_str()) != nullptr;
+}
+
+#if ZMQ_VERSION >= ZMQ_MAKE_VERSION(4, 2, 1)
+//////////////////////////////////////////////////
+/// \brief Decode a CURVE secret key and derive its public key.
+/// \param[in] _z85Secret The secret key in Z85 format.
+/// \param[out] _secret The secret key in binary form.
+/// \param[out] _public The public key in binary form.
+/// \return True if _z85Secret is a valid key.
+static bool decodeKeyPair(const std::string &_z85Secret,
+  std::string &_secret, std::string &_public)
+{
+  char z85Public[kZ85KeyLen + 1];
+  return decodeKey(_z85Secret, _secret) &&
+    zmq_curve_public(z85Public, _z85Secret.c_str()) == 0 &&
+    decodeKey(z85Public, _public);
+}
+#endif
+
+//////////////////////////////////////////////////
+bool SecurityOptions::SetCurveKeys(const std::string &_serverKey,
+  const std::string &_clientKey, std::string &_error)
+{
+#if ZMQ_VERSION >= ZMQ_MAKE_VERSION(4, 2, 1)
+  if (!zmq_has("curve"))
+  {
+    _error = "ZMQ was built without CURVE support";
+    return false;
+  }
+
+  std::string serverSecret;
+  std::string serverPublic;
+  if (!decodeKeyPair(_serverKey, serverSecret, serverPublic))
+  {
+    _error = "Invalid server key";
+    return false;
+  }
+
+  std::string clientKey = _clientKey;
+  if (clientKey.empty())
+  {
+    char z85Public[kZ85KeyLen + 1];
+    char z85Secret[kZ85KeyLen + 1];
+    if (zmq_curve_keypair(z85Public, z85Secret) != 0)
+    {
+      _error = "Unable to generate a key pair";
+      return false;
+    }
+    clientKey = z85Secret;
+  }
+
+  std::string clientSecret;
+  std::string clientPublic;
+  if (!decodeKeyPair(clientKey, clientSecret, clientPublic))
+  {
+    _error = "Invalid secret key";
+    return false;
+  }
+
+  this->mechanism = Mechanism::CURVE;
+  this->serverSecretKey = serverSecret;
+  this->serverPublicKey = serverPublic;
+  this->clientSecretKey = clientSecret;
+  this->clientPublicKey = clientPublic;
+  return true;
+#else
+  (void)_serverKey;
+  (void)_clientKey;
+  _error = "CURVE requires ZMQ 4.2.1 or newer";
+  return false;
+#endif
+}
+
+//////////////////////////////////////////////////
+bool SecurityOptions::ParseAuthorizedKeys(std::istream &_in,
+  std::string &_error)
+{
+  this->authorize = true;
+
+  bool result = true;
+  std::string line;
+  while (std::getline(_in, line))
+  {
+    const auto start = line.find_first_not_of(" \t\r");
+    if (start == std::string::npos || line[start] == '#')
+      continue;
+    const auto end = line.find_last_not_of(" \t\r");
+    const std::string z85 = line.substr(start, end - start + 1);
+
+    std::string key;
+    if (!decodeKey(z85, key))
+    {
+      if (result)
+        _error = "Invalid key [" + z85 + "]";
+      result = false;
+      continue;
+    }
+    this->authorizedKeys.insert(key);
+  }
+  return result;
+}
+
+//////////////////////////////////////////////////
+bool SecurityOptions::NeedsZap() const
+{
+  return this->mechanism == Mechanism::PLAIN ||
+    (this->mechanism == Mechanism::CURVE && this->authorize);
+}
+
+//////////////////////////////////////////////////
+std::string SecurityOptions::Check(const std::vector<std::string> &_request,
+  const std::string &_domain) const
+{
+  if (_request.size() < 6)
+    return "Invalid request";
+
+  const std::string &version = _request[0];
+  const std::string &domain = _request[2];
+  const std::string &address = _request[3];
+  const std::string &mechanismName = _request[5];
+
+  // Check that we received some kind of address. This could be used
+  // in the future to only accept connections from specific addresses.
+  if (address.empty())
+    return "Invalid address";
+
+  if (version != "1.0")
+    return "Invalid version";
+
+  if (domain != _domain)
+    return "Invalid domain";
+
+  if (this->mechanism == Mechanism::PLAIN && mechanismName == "PLAIN" &&
+      _request.size() == 8)
+  {
+    if (_request[6] != this->username || _request[7] != this->password)
+      return "Invalid username or password";
+    return "";
+  }
+
+  if (this->mechanism == Mechanism::CURVE && mechanismName == "CURVE" &&
+      _request.size() == 7)
+  {
+    if (this->authorize && this->authorizedKeys.count(_request[6]) == 0)
+      return "Unauthorized key";
+    return "";
+  }
+
+  return "Invalid mechanism";
+}
+
+//////////////////////////////////////////////////
+void SecurityOptions::ApplyServer(zmq::socket_t &_socket,
+  const std::string &_domain) const
+{
+  const int server = 1;
+  if (this->mechanism == Mechanism::PLAIN)
+  {
+#ifdef GZ_CPPZMQ_POST_4_7_0
+    _socket.set(zmq::sockopt::plain_server, server);
+#else
+    _socket.setsockopt(ZMQ_PLAIN_SERVER, &server, sizeof(server));
+#endif
+  }
+  else if (this->mechanism == Mechanism::CURVE)
+  {
+#ifdef GZ_CPPZMQ_POST_4_7_0
+    _socket.set(zmq::sockopt::curve_server, server);
+    _socket.set(zmq::sockopt::curve_secretkey, this->serverSecretKey);
+#else
+    _socket.setsockopt(ZMQ_CURVE_SERVER, &server, sizeof(server));
+    _socket.setsockopt(ZMQ_CURVE_SECRETKEY, this->serverSecretKey.data(),
+      this->serverSecretKey.size());
+#endif
+  }
+
+  if (!this->NeedsZap())
+    return;
+
+#ifdef GZ_CPPZMQ_POST_4_7_0
+  _socket.set(zmq::sockopt::zap_domain, _domain);
+#else
+  _socket.setsockopt(ZMQ_ZAP_DOMAIN, _domain.data(), _domain.size());
+#endif
+}
+
+//////////////////////////////////////////////////
+void SecurityOptions::ApplyClient(zmq::socket_t &_socket) const
+{
+  if (this->mechanism == Mechanism::PLAIN)
+  {
+#ifdef GZ_CPPZMQ_POST_4_7_0
+    _socket.set(zmq::sockopt::plain_username, this->username);
+    _socket.set(zmq::sockopt::plain_password, this->password);
+#else
+    _socket.setsockopt(ZMQ_PLAIN_USERNAME, this->username.data(),
+      this->username.size());
+    _socket.setsockopt(ZMQ_PLAIN_PASSWORD, this->password.data(),
+      this->password.size());
+#endif
+  }
+  else if (this->mechanism == Mechanism::CURVE)
+  {
+#ifdef GZ_CPPZMQ_POST_4_7_0
+    _socket.set(zmq::sockopt::curve_serverkey, this->serverPublicKey);
+    _socket.set(zmq::sockopt::curve_publickey, this->clientPublicKey);
+    _socket.set(zmq::sockopt::curve_secretkey, this->clientSecretKey);
+#else
+    _socket.setsockopt(ZMQ_CURVE_SERVERKEY, this->serverPublicKey.data(),
+      this->serverPublicKey.size());
+    _socket.setsockopt(ZMQ_CURVE_PUBLICKEY, this->clientPublicKey.data(),
+      this->clientPublicKey.size());
+    _socket.setsockopt(ZMQ_CURVE_SECRETKEY, this->clientSecretKey.data(),
+      this->clientSecretKey.size());
+#endif
+  }
+}
+
+//////////////////////////////////////////////////
+SecurityOptions SecurityOptions::FromEnv()
+{
+  SecurityOptions options;
+
+  std::string serverKey;
+  if (env("GZ_TRANSPORT_CURVE_SERVER_KEY", serverKey) && !serverKey.empty())
+  {
+    std::string clientKey;
+    env("GZ_TRANSPORT_CURVE_SECRET_KEY", clientKey);
+    // The encryption requested is never downgraded to PLAIN or none.
+    std::string error;
+    if (!options.SetCurveKeys(serverKey, clientKey, error))
+    {
+      options.error = "Unable to enable the CURVE security: " + error;
+      return options;
+    }
+
+    std::string path;
+    if (options.mechanism == Mechanism::CURVE &&
+        env("GZ_TRANSPORT_CURVE_AUTHORIZED_KEYS", path) && !path.empty())
+    {
+      // The subscribers are only accepted with a key of the file, none if
+      // it can't be read.
+      std::ifstream in(path);
+      if (!in)
+      {
+        options.authorize = true;
+        std::cerr << "Unable to read GZ_TRANSPORT_CURVE_AUTHORIZED_KEYS ["
+                  << path << "], no subscriber is accepted" << std::endl;
+      }
+      else if (!options.ParseAuthorizedKeys(in, error))
+      {
+        std::cerr << "GZ_TRANSPORT_CURVE_AUTHORIZED_KEYS: " << error
+                  << ", ignoring it" << std::endl;
+      }
+    }
+  }
+
+  if (options.mechanism == Mechanism::NONE)
+  {
+    const bool user = env("GZ_TRANSPORT_USERNAME", options.username);
+    const bool pass = env("GZ_TRANSPORT_PASSWORD", options.password);
+    if (user && pass)
+      options.mechanism = Mechanism::PLAIN;
+  }
+
+  return options;
+}
@@ -0,0 +1,159 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef GZ_TRANSPORT_SECURITYOPTIONS_HH_
+#define GZ_TRANSPORT_SECURITYOPTIONS_HH_
+
+#include <zmq.hpp>
+
+#include <istream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "gz/transport/config.hh"
+
+namespace gz
+{
+  namespace transport
+  {
+    inline namespace GZ_TRANSPORT_VERSION_NAMESPACE
+    {
+    /// \internal
+    /// \brief Authentication of the subscribers of NodeShared, read once
+    /// from the environment variables:
+    ///
+    /// * GZ_TRANSPORT_CURVE_SERVER_KEY: Z85 secret key shared by the
+    ///   publishers of the trusted processes. It enables the CURVE
+    ///   mechanism, which also encrypts the messages. The subscribers use its
+    ///   public key to connect.
+    /// * GZ_TRANSPORT_CURVE_SECRET_KEY: Z85 secret key of the subscribers of
+    ///   the process, a new key pair by default.
+    /// * GZ_TRANSPORT_CURVE_AUTHORIZED_KEYS: file with the Z85 public keys
+    ///   of the subscribers accepted, one per line. Every subscriber with the
+    ///   public key of the server is accepted without it.
+    /// * GZ_TRANSPORT_USERNAME and GZ_TRANSPORT_PASSWORD: the PLAIN
+    ///   mechanism, when CURVE isn't enabled.
+    ///
+    /// The ZAP handler checks the requests against the credentials and the
+    /// keys cached here, so the environment and the file aren't read for
+    /// each connection.
+    class SecurityOptions
+    {
+      /// \brief Security mechanisms.
+      public: enum class Mechanism
+      {
+        /// \brief No authentication.
+        NONE,
+
+        /// \brief Username and password.
+        PLAIN,
+
+        /// \brief Public keys, with encryption.
+        CURVE
+      };
+
+      /// \brief Use the CURVE mechanism.
+      /// \param[in] _serverKey Z85 secret key of the publishers.
+      /// \param[in] _clientKey Z85 secret key of the subscribers, or empty
+      /// for a new key pair.
+      /// \param[out] _error Description of the failure.
+      /// \return True on success, false if a key is invalid or ZMQ doesn't
+      /// support CURVE.
+      public: bool SetCurveKeys(const std::string &_serverKey,
+                                const std::string &_clientKey,
+                                std::string &_error);
+
+      /// \brief Parse the public keys of the subscribers accepted with
+      /// CURVE. The empty lines and the lines starting with '#' are
+      /// ignored.
+      /// \param[in] _in The Z85 public keys, one per line.
+      /// \param[out] _error Description of the first invalid key.
+      /// \return True if all the keys are valid. The valid keys are kept
+      /// otherwise.
+      public: bool ParseAuthorizedKeys(std::istream &_in,
+                                       std::string &_error);
+
+      /// \brief Whether the publishers authenticate their subscribers with
+      /// the ZAP handler.
+      /// \return True for PLAIN, and for CURVE with authorized keys.
+      public: bool NeedsZap() const;
+
+      /// \brief Check a ZAP request.
+      /// \param[in] _request The frames of the request: version, request id,
+      /// domain, address, routing id, mechanism and the credentials.
+      /// \param[in] _domain ZAP domain of the publishers.
+      /// \return Empty if the subscriber is accepted, the reason of the
+      /// rejection otherwise.
+      public: std::string Check(const std::vector<std::string> &_request,
+                                const std::string &_domain) const;
+
+      /// \brief Configure a publisher socket to authenticate its
+      /// subscribers. Call it before the socket is bound.
+      /// \param[in] _socket The socket.
+      /// \param[in] _domain ZAP domain of the publishers.
+      public: void ApplyServer(zmq::socket_t &_socket,
+                               const std::string &_domain) const;
+
+      /// \brief Configure a subscriber socket with its credentials. Call it
+      /// before the socket is connected.
+      /// \param[in] _socket The socket.
+      public: void ApplyClient(zmq::socket_t &_socket) const;
+
+      /// \brief Read the options from the environment variables. The
+      /// invalid authorized keys are reported and ignored. If CURVE is
+      /// requested but can't be enabled, the error is set instead: the
+      /// security is never downgraded.
+      /// \return The options.
+      public: static SecurityOptions FromEnv();
+
+      /// \brief The mechanism.
+      public: Mechanism mechanism = Mechanism::NONE;
+
+      /// \brief Why the security requested can't be enabled, empty if it
+      /// can. The sockets must not be bound or connected otherwise.
+      public: std::string error;
+
+      /// \brief PLAIN username.
+      public: std::string username;
+
+      /// \brief PLAIN password.
+      public: std::string password;
+
+      /// \brief CURVE secret key of the publishers (32 bytes).
+      public: std::string serverSecretKey;
+
+      /// \brief CURVE public key of the publishers (32 bytes).
+      public: std::string serverPublicKey;
+
+      /// \brief CURVE secret key of the subscribers (32 bytes).
+      public: std::string clientSecretKey;
+
+      /// \brief CURVE public key of the subscribers (32 bytes).
+      public: std::string clientPublicKey;
+
+      /// \brief Whether only the subscribers with authorizedKeys are
+      /// accepted with CURVE.
+      public: bool authorize = false;
+
+      /// \brief CURVE public keys of the subscribers accepted (32 bytes
+      /// each).
+      public: std::unordered_set<std::string> authorizedKeys;
+    };
+    }
+  }
+}
+#endif
@@ -0,0 +1,176 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <gz/utils/Environment.hh>
+
+#include "SecurityOptions.hh"
+#include "gtest/gtest.h"
+
+using namespace gz;
+using namespace transport;
+
+/// \brief Key pairs of the ZMQ CURVE documentation.
+static const char kServerSecret[] = "JTKVSB%%)wK0E.X)V>+}o?pNmC{O&4W4b!Ni{Lh6";
+static const char kServerPublic[] = "rq:rM>}U?@Lns47E1%kR.o@n%FcmmsL/@{H8]yf7";
+static const char kClientSecret[] = "D:)Q[IlAW!ahhC2ac:9*A}h:p?([4%wOTJ%JR%cs";
+static const char kClientPublic[] = "Yne@$w-vo<fVvi]a<NY6T1ed:M$fCG*[IaLV{hID";
+
+/// \brief ZAP domain of the tests.
+static const char kDomain[] = "gz-auth";
+
+//////////////////////////////////////////////////
+/// \brief Decode a Z85 key.
+/// \param[in] _z85 The key.
+/// \return The key in binary form.
+static std::string decode(const std::string &_z85)
+{
+  std::string key(32, '\0');
+  zmq_z85_decode(reinterpret_cast<uint8_t *>(&key[0]), _z85.c_str());
+  return key;
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the PLAIN requests.
+TEST(SecurityOptionsTest, Plain)
+{
+  SecurityOptions options;
+  EXPECT_FALSE(options.NeedsZap());
+  options.mechanism = SecurityOptions::Mechanism::PLAIN;
+  options.username = "user";
+  options.password = "pass";
+  EXPECT_TRUE(options.NeedsZap());
+
+  std::vector<std::string> request =
+    {"1.0", "1", kDomain, "127.0.0.1", "", "PLAIN", "user", "pass"};
+  EXPECT_EQ("", options.Check(request, kDomain));
+
+  request[7] = "wrong";
+  EXPECT_EQ("Invalid username or password", options.Check(request, kDomain));
+  request[7] = "pass";
+
+  EXPECT_EQ("Invalid domain", options.Check(request, "other"));
+
+  request[0] = "2.0";
+  EXPECT_EQ("Invalid version", options.Check(request, kDomain));
+  request[0] = "1.0";
+
+  request[3] = "";
+  EXPECT_EQ("Invalid address", options.Check(request, kDomain));
+  request[3] = "127.0.0.1";
+
+  request[5] = "CURVE";
+  EXPECT_EQ("Invalid mechanism", options.Check(request, kDomain));
+
+  EXPECT_EQ("Invalid request", options.Check({"1.0", "1"}, kDomain));
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the CURVE keys and requests.
+TEST(SecurityOptionsTest, Curve)
+{
+  if (!zmq_has("curve"))
+    GTEST_SKIP() << "ZMQ was built without CURVE support";
+
+  SecurityOptions options;
+  std::string error;
+  EXPECT_FALSE(options.SetCurveKeys("invalid", "", error));
+  EXPECT_EQ("Invalid server key", error);
+  EXPECT_FALSE(options.SetCurveKeys(kServerSecret, "invalid", error));
+  EXPECT_EQ("Invalid secret key", error);
+  EXPECT_EQ(SecurityOptions::Mechanism::NONE, options.mechanism);
+
+  ASSERT_TRUE(options.SetCurveKeys(kServerSecret, kClientSecret, error));
+  EXPECT_EQ(SecurityOptions::Mechanism::CURVE, options.mechanism);
+  EXPECT_EQ(decode(kServerPublic), options.serverPublicKey);
+  EXPECT_EQ(decode(kClientPublic), options.clientPublicKey);
+
+  // Every subscriber is accepted without authorized keys, ZMQ doesn't need
+  // the ZAP handler.
+  EXPECT_FALSE(options.NeedsZap());
+  std::vector<std::string> request =
+    {"1.0", "1", kDomain, "127.0.0.1", "", "CURVE", decode(kClientPublic)};
+  EXPECT_EQ("", options.Check(request, kDomain));
+
+  std::istringstream keys(std::string("# Subscribers\n\n  ") +
+    kClientPublic + "\r\ninvalid\n");
+  EXPECT_FALSE(options.ParseAuthorizedKeys(keys, error));
+  EXPECT_EQ("Invalid key [invalid]", error);
+  EXPECT_TRUE(options.NeedsZap());
+  EXPECT_EQ(1u, options.authorizedKeys.size());
+  EXPECT_EQ("", options.Check(request, kDomain));
+
+  request[6] = decode(kServerPublic);
+  EXPECT_EQ("Unauthorized key", options.Check(request, kDomain));
+
+  // A new key pair is generated for the subscribers.
+  SecurityOptions generated;
+  ASSERT_TRUE(generated.SetCurveKeys(kServerSecret, "", error));
+  EXPECT_EQ(32u, generated.clientPublicKey.size());
+  EXPECT_NE(decode(kClientPublic), generated.clientPublicKey);
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the environment variables.
+TEST(SecurityOptionsTest, FromEnv)
+{
+  ASSERT_TRUE(gz::utils::unsetenv("GZ_TRANSPORT_CURVE_SERVER_KEY"));
+  ASSERT_TRUE(gz::utils::unsetenv("GZ_TRANSPORT_USERNAME"));
+  ASSERT_TRUE(gz::utils::unsetenv("GZ_TRANSPORT_PASSWORD"));
+  EXPECT_EQ(SecurityOptions::Mechanism::NONE,
+    SecurityOptions::FromEnv().mechanism);
+
+  ASSERT_TRUE(gz::utils::setenv("GZ_TRANSPORT_USERNAME", "user"));
+  EXPECT_EQ(SecurityOptions::Mechanism::NONE,
+    SecurityOptions::FromEnv().mechanism);
+
+  ASSERT_TRUE(gz::utils::setenv("GZ_TRANSPORT_PASSWORD", "pass"));
+  SecurityOptions options = SecurityOptions::FromEnv();
+  EXPECT_EQ(SecurityOptions::Mechanism::PLAIN, options.mechanism);
+  EXPECT_EQ("user", options.username);
+  EXPECT_EQ("pass", options.password);
+
+  // CURVE takes precedence over PLAIN.
+  if (zmq_has("curve"))
+  {
+    ASSERT_TRUE(gz::utils::setenv("GZ_TRANSPORT_CURVE_SERVER_KEY",
+      kServerSecret));
+    ASSERT_TRUE(gz::utils::setenv("GZ_TRANSPORT_CURVE_AUTHORIZED_KEYS",
+      "/nonexistent/authorized_keys"));
+    options = SecurityOptions::FromEnv();
+    EXPECT_EQ(SecurityOptions::Mechanism::CURVE, options.mechanism);
+
+    // No subscriber is accepted if the file can't be read.
+    EXPECT_TRUE(options.NeedsZap());
+    EXPECT_TRUE(options.authorizedKeys.empty());
+    ASSERT_TRUE(gz::utils::unsetenv("GZ_TRANSPORT_CURVE_AUTHORIZED_KEYS"));
+    EXPECT_TRUE(options.error.empty());
+  }
+
+  // An invalid key doesn't fall back to PLAIN, nor to no security.
+  ASSERT_TRUE(gz::utils::setenv("GZ_TRANSPORT_CURVE_SERVER_KEY", "invalid"));
+  options = SecurityOptions::FromEnv();
+  EXPECT_EQ(SecurityOptions::Mechanism::NONE, options.mechanism);
+  EXPECT_FALSE(options.error.empty());
+  ASSERT_TRUE(gz::utils::unsetenv("GZ_TRANSPORT_CURVE_SERVER_KEY"));
+
+  ASSERT_TRUE(gz::utils::unsetenv("GZ_TRANSPORT_USERNAME"));
+  ASSERT_TRUE(gz::utils::unsetenv("GZ_TRANSPORT_PASSWORD"));
+}
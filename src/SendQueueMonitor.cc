@@ -0,0 +1,186 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifdef __linux__
+  #include <arpa/inet.h>
+  #include <linux/sockios.h>
+  #include <netinet/in.h>
+  #include <sys/ioctl.h>
+  #include <sys/socket.h>
+#endif
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "SendQueueMonitor.hh"
+
+using namespace gz;
+using namespace transport;
+
+namespace gz
+{
+  namespace transport
+  {
+    inline namespace GZ_TRANSPORT_VERSION_NAMESPACE
+    {
+    /// \internal
+    /// \brief Private data for SendQueueMonitor class.
+    class SendQueueMonitorPrivate
+    {
+      /// \brief A connection tracked.
+      public: struct Connection
+      {
+        /// \brief Address of the publisher socket.
+        std::string socket;
+
+        /// \brief Address of the subscriber.
+        std::string peer;
+
+        /// \brief Whether the previous sample was above the threshold.
+        bool above = false;
+
+        /// \brief Whether the connection is slow.
+        bool slow = false;
+      };
+
+      /// \brief Backlog of a slow connection (bytes).
+      public: uint64_t threshold;
+
+      /// \brief Samples the backlog of a connection.
+      public: SendQueueMonitor::BacklogFunc backlog;
+
+      /// \brief The connections by file descriptor.
+      public: std::map<int, Connection> connections;
+    };
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+SendQueueMonitor::SendQueueMonitor(const uint64_t _threshold,
+    const BacklogFunc &_backlog)
+  : dataPtr(new SendQueueMonitorPrivate)
+{
+  this->dataPtr->threshold = _threshold;
+  this->dataPtr->backlog = _backlog;
+}
+
+//////////////////////////////////////////////////
+SendQueueMonitor::~SendQueueMonitor() = default;
+
+//////////////////////////////////////////////////
+void SendQueueMonitor::Add(const int _fd, const std::string &_socket,
+    const std::string &_peer)
+{
+  auto &conn = this->dataPtr->connections[_fd];
+  conn = SendQueueMonitorPrivate::Connection();
+  conn.socket = _socket;
+  conn.peer = _peer;
+}
+
+//////////////////////////////////////////////////
+void SendQueueMonitor::Remove(const int _fd, std::vector<Event> &_events)
+{
+  auto it = this->dataPtr->connections.find(_fd);
+  if (it == this->dataPtr->connections.end())
+    return;
+
+  if (it->second.slow)
+    _events.push_back({it->second.socket, it->second.peer, false, 0});
+  this->dataPtr->connections.erase(it);
+}
+
+//////////////////////////////////////////////////
+void SendQueueMonitor::Check(std::vector<Event> &_events)
+{
+  const uint64_t threshold = this->dataPtr->threshold;
+  for (auto &[fd, conn] : this->dataPtr->connections)
+  {
+    const int64_t sample = this->dataPtr->backlog(fd);
+    if (sample < 0)
+      continue;
+
+    const uint64_t backlog = static_cast<uint64_t>(sample);
+    const bool above = backlog >= threshold;
+    if (!conn.slow && above && conn.above)
+    {
+      conn.slow = true;
+      _events.push_back({conn.socket, conn.peer, true, backlog});
+    }
+    else if (conn.slow && backlog < threshold / 2)
+    {
+      conn.slow = false;
+      _events.push_back({conn.socket, conn.peer, false, backlog});
+    }
+    conn.above = above;
+  }
+}
+
+//////////////////////////////////////////////////
+std::size_t SendQueueMonitor::Size() const
+{
+  return this->dataPtr->connections.size();
+}
+
+//////////////////////////////////////////////////
+int64_t SendQueueMonitor::SocketBacklog(const int _fd)
+{
+#ifdef __linux__
+  int queued = 0;
+  if (ioctl(_fd, SIOCOUTQ, &queued) == 0)
+    return queued;
+#else
+  (void)_fd;
+#endif
+  return -1;
+}
+
+//////////////////////////////////////////////////
+std::string SendQueueMonitor::PeerAddress(const int _fd)
+{
+#ifdef __linux__
+  sockaddr_storage addr{};
+  socklen_t len = sizeof(addr);
+  if (getpeername(_fd, reinterpret_cast<sockaddr *>(&addr), &len) != 0)
+    return "";
+
+  char host[INET6_ADDRSTRLEN] = {};
+  uint16_t port = 0;
+  if (addr.ss_family == AF_INET)
+  {
+    const auto *in = reinterpret_cast<const sockaddr_in *>(&addr);
+    inet_ntop(AF_INET, &in->sin_addr, host, sizeof(host));
+    port = ntohs(in->sin_port);
+  }
+  else if (addr.ss_family == AF_INET6)
+  {
+    const auto *in6 = reinterpret_cast<const sockaddr_in6 *>(&addr);
+    inet_ntop(AF_INET6, &in6->sin6_addr, host, sizeof(host));
+    port = ntohs(in6->sin6_port);
+  }
+  else
+  {
+    return "";
+  }
+  return std::string(host) + ":" + std::to_string(port);
+#else
+  (void)_fd;
+  return "";
+#endif
+}
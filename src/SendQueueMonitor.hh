@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GZ_TRANSPORT_SENDQUEUEMONITOR_HH_
+#define GZ_TRANSPORT_SENDQUEUEMONITOR_HH_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gz/transport/config.hh"
+
+namespace gz
+{
+  namespace transport
+  {
+    inline namespace GZ_TRANSPORT_VERSION_NAMESPACE
+    {
+    class SendQueueMonitorPrivate;
+
+    /// \internal
+    /// \brief Tracks the send queue of the connections accepted by the
+    /// publisher sockets and detects the slow subscribers: the ones whose
+    /// backlog stays above a threshold for two samples in a row. A slow
+    /// connection recovers when its backlog drops below half the threshold.
+    ///
+    /// This class is not thread-safe.
+    class SendQueueMonitor
+    {
+      /// \brief A connection became slow or recovered.
+      public: struct Event
+      {
+        /// \brief Address of the publisher socket.
+        std::string socket;
+
+        /// \brief Address of the subscriber.
+        std::string peer;
+
+        /// \brief True if the connection became slow, false if it
+        /// recovered.
+        bool slow = false;
+
+        /// \brief Bytes queued when the event was detected.
+        uint64_t backlog = 0;
+      };
+
+      /// \brief Get the bytes queued in a connection, or -1 if unknown.
+      public: using BacklogFunc = std::function<int64_t(int _fd)>;
+
+      /// \brief Constructor.
+      /// \param[in] _threshold Backlog of a slow connection (bytes).
+      /// \param[in] _backlog Samples the backlog of a connection.
+      public: explicit SendQueueMonitor(const uint64_t _threshold,
+                  const BacklogFunc &_backlog = SocketBacklog);
+
+      /// \brief Destructor.
+      public: ~SendQueueMonitor();
+
+      /// \brief No copy constructor.
+      public: SendQueueMonitor(const SendQueueMonitor &) = delete;
+
+      /// \brief No assignment operator.
+      public: SendQueueMonitor &operator=(const SendQueueMonitor &) = delete;
+
+      /// \brief Start tracking a connection.
+      /// \param[in] _fd File descriptor of the connection.
+      /// \param[in] _socket Address of the publisher socket.
+      /// \param[in] _peer Address of the subscriber.
+      public: void Add(const int _fd,
+                       const std::string &_socket,
+                       const std::string &_peer);
+
+      /// \brief Stop tracking a connection.
+      /// \param[in] _fd File descriptor of the connection.
+      /// \param[out] _events A recovery event is appended if the connection
+      /// was slow.
+      public: void Remove(const int _fd, std::vector<Event> &_events);
+
+      /// \brief Sample the backlog of every connection.
+      /// \param[out] _events The connections that became slow or recovered.
+      public: void Check(std::vector<Event> &_events);
+
+      /// \brief Get the number of connections tracked.
+      /// \return The number of connections.
+      public: std::size_t Size() const;
+
+      /// \brief Get the bytes queued in the kernel send buffer of a socket.
+      /// \param[in] _fd File descriptor of the socket.
+      /// \return The bytes queued, or -1 if unsupported on this platform.
+      public: static int64_t SocketBacklog(const int _fd);
+
+      /// \brief Get the address of the peer of a socket.
+      /// \param[in] _fd File descriptor of the socket.
+      /// \return The address as "host:port", or empty if unknown.
+      public: static std::string PeerAddress(const int _fd);
+
+      /// \brief Private data.
+      private: std::unique_ptr<SendQueueMonitorPrivate> dataPtr;
+    };
+    }
+  }
+}
+#endif
@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <cstdint>
+#include <map>
+#include <vector>
+
+#include "SendQueueMonitor.hh"
+#include "gtest/gtest.h"
+
+using namespace gz;
+using namespace transport;
+
+//////////////////////////////////////////////////
+/// \brief A connection is slow after two samples above the threshold and
+/// recovers below half of it.
+TEST(SendQueueMonitorTest, SlowRecover)
+{
+  std::map<int, int64_t> backlogs;
+  SendQueueMonitor monitor(1000, [&](int _fd) { return backlogs[_fd]; });
+  std::vector<SendQueueMonitor::Event> events;
+
+  monitor.Add(3, "tcp://10.0.0.1:5000", "10.0.0.2:40000");
+  monitor.Add(4, "tcp://10.0.0.1:5000", "10.0.0.3:40000");
+  EXPECT_EQ(2u, monitor.Size());
+
+  // A single spike isn't enough.
+  backlogs[3] = 2000;
+  monitor.Check(events);
+  EXPECT_TRUE(events.empty());
+  backlogs[3] = 0;
+  monitor.Check(events);
+  EXPECT_TRUE(events.empty());
+
+  backlogs[3] = 1000;
+  monitor.Check(events);
+  backlogs[3] = 1500;
+  monitor.Check(events);
+  ASSERT_EQ(1u, events.size());
+  EXPECT_EQ("tcp://10.0.0.1:5000", events[0].socket);
+  EXPECT_EQ("10.0.0.2:40000", events[0].peer);
+  EXPECT_TRUE(events[0].slow);
+  EXPECT_EQ(1500u, events[0].backlog);
+
+  // Still slow: no new event.
+  events.clear();
+  backlogs[3] = 600;
+  monitor.Check(events);
+  EXPECT_TRUE(events.empty());
+
+  backlogs[3] = 499;
+  monitor.Check(events);
+  ASSERT_EQ(1u, events.size());
+  EXPECT_FALSE(events[0].slow);
+  EXPECT_EQ(499u, events[0].backlog);
+}
+
+//////////////////////////////////////////////////
+/// \brief Removing a slow connection reports its recovery.
+TEST(SendQueueMonitorTest, Remove)
+{
+  std::map<int, int64_t> backlogs;
+  SendQueueMonitor monitor(10, [&](int _fd) { return backlogs[_fd]; });
+  std::vector<SendQueueMonitor::Event> events;
+
+  monitor.Add(3, "sock", "a");
+  monitor.Add(4, "sock", "b");
+  monitor.Remove(5, events);
+  EXPECT_TRUE(events.empty());
+
+  backlogs[3] = 10;
+  monitor.Check(events);
+  monitor.Check(events);
+  ASSERT_EQ(1u, events.size());
+
+  events.clear();
+  monitor.Remove(4, events);
+  EXPECT_TRUE(events.empty());
+  monitor.Remove(3, events);
+  ASSERT_EQ(1u, events.size());
+  EXPECT_EQ("a", events[0].peer);
+  EXPECT_FALSE(events[0].slow);
+  EXPECT_EQ(0u, monitor.Size());
+}
+
+//////////////////////////////////////////////////
+/// \brief The connections without a backlog sample are ignored.
+TEST(SendQueueMonitorTest, Unknown)
+{
+  SendQueueMonitor monitor(1, [](int) { return -1; });
+  std::vector<SendQueueMonitor::Event> events;
+  monitor.Add(3, "sock", "a");
+  monitor.Check(events);
+  monitor.Check(events);
+  EXPECT_TRUE(events.empty());
+  EXPECT_EQ("", SendQueueMonitor::PeerAddress(-1));
+}
@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GZ_TRANSPORT_SERIALIZEDBUFFER_HH_
+#define GZ_TRANSPORT_SERIALIZEDBUFFER_HH_
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+#include "gz/transport/config.hh"
+
+namespace gz
+{
+  namespace transport
+  {
+    inline namespace GZ_TRANSPORT_VERSION_NAMESPACE
+    {
+    /// \internal
+    /// \brief A reference-counted buffer storing a serialized message.
+    /// Copies of a SerializedBuffer share the same storage, which is released
+    /// when the last copy goes away. This allows the raw local handlers and
+    /// the ZMQ socket to use the very same serialized data: ZMQ holds its own
+    /// reference through the hint of the zero copy deallocation function.
+    /// \sa ZmqHint() and ZmqDeallocator().
+    class SerializedBuffer
+    {
+      /// \brief Default constructor. The buffer is empty.
+      public: SerializedBuffer() = default;
+
+      /// \brief Allocate a new buffer.
+      /// \param[in] _size Size of the buffer (bytes).
+      public: explicit SerializedBuffer(const std::size_t _size)
+        : data(new char[_size], std::default_delete<char[]>()),
+          size(_size)
+      {
+      }
+
+      /// \brief Wrap an existing storage. This is used when the storage
+      /// requires a custom release function.
+      /// \param[in] _data The storage.
+      /// \param[in] _size Size of the storage (bytes).
+      public: SerializedBuffer(std::shared_ptr<char> _data,
+                               const std::size_t _size)
+        : data(std::move(_data)),
+          size(_size)
+      {
+      }
+
+      /// \brief Take the ownership of a container storing the data, such as
+      /// a std::string or a received zmq::message_t, without copying it.
+      /// \param[in] _storage The container. It must provide data() and
+      /// size().
+      /// \return The buffer, it keeps the container alive.
+      public: template <typename T>
+      static SerializedBuffer Adopt(T _storage)
+      {
+        auto owner = std::make_shared<T>(std::move(_storage));
+        char *ptr = static_cast<char *>(static_cast<void *>(owner->data()));
+        return SerializedBuffer(std::shared_ptr<char>(owner, ptr),
+          owner->size());
+      }
+
+      /// \brief Get a part of this buffer. The part shares the storage,
+      /// no data is copied.
+      /// \param[in] _offset Offset of the part (bytes).
+      /// \param[in] _size Size of the part (bytes).
+      /// \return The part of the buffer.
+      public: SerializedBuffer Slice(const std::size_t _offset,
+                                     const std::size_t _size) const
+      {
+        return SerializedBuffer(
+          std::shared_ptr<char>(this->data, this->data.get() + _offset),
+          _size);
+      }
+
+      /// \brief Get a pointer to the serialized data.
+      /// \return Pointer to the data or nullptr if the buffer is empty.
+      public: char *Data() const
+      {
+        return this->data.get();
+      }
+
+      /// \brief Get a read-only reference to the serialized data, which
+      /// keeps the storage alive.
+      /// \return Shared pointer to the data or nullptr if the buffer is
+      /// empty.
+      public: std::shared_ptr<const char> Shared() const
+      {
+        return this->data;
+      }
+
+      /// \brief Get the buffer size.
+      /// \return The size of the buffer (bytes).
+      public: std::size_t Size() const
+      {
+        return this->size;
+      }
+
+      /// \brief Number of references sharing this buffer.
+      /// \return The number of references.
+      public: long UseCount() const
+      {
+        return this->data.use_count();
+      }
+
+      /// \brief True if a storage is allocated.
+      public: explicit operator bool() const
+      {
+        return this->data != nullptr;
+      }
+
+      /// \brief Create a new reference to this buffer that ZMQ will own.
+      /// The returned pointer is meant to be passed as the hint of a zero
+      /// copy zmq::message_t along with ZmqDeallocator().
+      /// \return An opaque pointer to the new reference.
+      public: void *ZmqHint() const
+      {
+        return new SerializedBuffer(*this);
+      }
+
+      /// \brief Deallocation function compatible with DeallocFunc. It
+      /// releases the reference created with ZmqHint().
+      /// \param[in] _data Unused. The data is owned by the buffer.
+      /// \param[in] _hint The pointer returned by ZmqHint().
+      public: static void ZmqDeallocator(void * /*_data*/, void *_hint)
+      {
+        delete static_cast<SerializedBuffer *>(_hint);
+      }
+
+      /// \brief The shared storage.
+      private: std::shared_ptr<char> data;
+
+      /// \brief Size of the storage (bytes).
+      private: std::size_t size = 0;
+    };
+    }
+  }
+}
+#endif
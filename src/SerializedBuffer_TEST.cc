@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <cstring>
+#include <string>
+#include <utility>
+
+#include "gz/transport/TransportTypes.hh"
+#include "SerializedBuffer.hh"
+#include "gtest/gtest.h"
+
+using namespace gz;
+
+//////////////////////////////////////////////////
+/// \brief Check an empty buffer.
+TEST(SerializedBufferTest, Empty)
+{
+  transport::SerializedBuffer buffer;
+  EXPECT_FALSE(buffer);
+  EXPECT_EQ(nullptr, buffer.Data());
+  EXPECT_EQ(0u, buffer.Size());
+  EXPECT_EQ(0, buffer.UseCount());
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that copies share the same storage.
+TEST(SerializedBufferTest, Shared)
+{
+  transport::SerializedBuffer buffer(6);
+  ASSERT_TRUE(buffer);
+  EXPECT_EQ(6u, buffer.Size());
+  memcpy(buffer.Data(), "hello", 6);
+
+  transport::SerializedBuffer copy = buffer;
+  EXPECT_EQ(buffer.Data(), copy.Data());
+  EXPECT_EQ(buffer.Size(), copy.Size());
+  EXPECT_EQ(2, buffer.UseCount());
+  EXPECT_STREQ("hello", copy.Data());
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the reference held through the ZMQ deallocation hook.
+TEST(SerializedBufferTest, ZmqHint)
+{
+  transport::SerializedBuffer buffer(16);
+  EXPECT_EQ(1, buffer.UseCount());
+
+  void *hint = buffer.ZmqHint();
+  EXPECT_EQ(2, buffer.UseCount());
+
+  transport::DeallocFunc *ffn = &transport::SerializedBuffer::ZmqDeallocator;
+  ffn(buffer.Data(), hint);
+  EXPECT_EQ(1, buffer.UseCount());
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the buffers sharing an adopted container.
+TEST(SerializedBufferTest, AdoptAndSlice)
+{
+  std::string str = "hello world";
+  const char *data = str.data();
+  transport::SerializedBuffer buffer =
+    transport::SerializedBuffer::Adopt(std::move(str));
+  ASSERT_TRUE(buffer);
+  EXPECT_EQ(11u, buffer.Size());
+  EXPECT_EQ(0, memcmp(buffer.Data(), "hello world", 11));
+
+  // Long strings are moved without copying their data.
+  std::string longStr(1000, 'a');
+  data = longStr.data();
+  buffer = transport::SerializedBuffer::Adopt(std::move(longStr));
+  EXPECT_EQ(data, buffer.Data());
+  EXPECT_EQ(1000u, buffer.Size());
+
+  transport::SerializedBuffer slice = buffer.Slice(10, 20);
+  EXPECT_EQ(buffer.Data() + 10, slice.Data());
+  EXPECT_EQ(20u, slice.Size());
+  EXPECT_EQ(2, buffer.UseCount());
+
+  // The slice keeps the storage alive.
+  buffer = transport::SerializedBuffer();
+  EXPECT_EQ(1, slice.UseCount());
+  EXPECT_EQ('a', slice.Data()[19]);
+}
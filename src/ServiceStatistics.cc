@@ -0,0 +1,158 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "gz/transport/ServiceStatistics.hh"
+
+using namespace gz;
+using namespace transport;
+
+class gz::transport::ServiceStatisticsPrivate
+{
+  /// \brief Latencies of the requests sent to a responser.
+  public: struct Responser
+  {
+    /// \brief Round trip time.
+    LatencyHistogram roundTrip;
+
+    /// \brief Queue time reported by the responser.
+    LatencyHistogram queue;
+
+    /// \brief Callback time reported by the responser.
+    LatencyHistogram callback;
+
+    /// \brief Wire time.
+    LatencyHistogram wire;
+  };
+
+  /// \brief Queue time of the requests served by this process.
+  public: LatencyHistogram queue;
+
+  /// \brief Callback time of the requests served by this process.
+  public: LatencyHistogram callback;
+
+  /// \brief Latencies of the requests sent by this process. The key is
+  /// the process UUID of the responser.
+  public: std::map<std::string, Responser> responsers;
+};
+
+//////////////////////////////////////////////////
+ServiceStatistics::ServiceStatistics()
+  : dataPtr(new ServiceStatisticsPrivate)
+{
+}
+
+//////////////////////////////////////////////////
+ServiceStatistics::ServiceStatistics(const ServiceStatistics &_stats)
+  : dataPtr(new ServiceStatisticsPrivate(*(_stats.dataPtr.get())))
+{
+}
+
+//////////////////////////////////////////////////
+ServiceStatistics::~ServiceStatistics()
+{
+}
+
+//////////////////////////////////////////////////
+void ServiceStatistics::Update(double _queue, double _callback)
+{
+  this->dataPtr->queue.Update(_queue);
+  this->dataPtr->callback.Update(_callback);
+}
+
+//////////////////////////////////////////////////
+void ServiceStatistics::UpdateResponse(const std::string &_responser,
+    double _roundTrip)
+{
+  this->dataPtr->responsers[_responser].roundTrip.Update(_roundTrip);
+}
+
+//////////////////////////////////////////////////
+void ServiceStatistics::UpdateResponse(const std::string &_responser,
+    double _roundTrip, double _queue, double _callback)
+{
+  ServiceStatisticsPrivate::Responser &stats = this->dataPtr->responsers[_responser];
+  stats.roundTrip.Update(_roundTrip);
+  stats.queue.Update(_queue);
+  stats.callback.Update(_callback);
+
+  // The clocks of both processes are not compared, the wire time is what
+  // the responser didn't spend on the request.
+  stats.wire.Update(std::max(0.0, _roundTrip - _queue - _callback));
+}
+
+//////////////////////////////////////////////////
+LatencyHistogram ServiceStatistics::QueueTime() const
+{
+  return this->dataPtr->queue;
+}
+
+//////////////////////////////////////////////////
+LatencyHistogram ServiceStatistics::CallbackTime() const
+{
+  return this->dataPtr->callback;
+}
+
+//////////////////////////////////////////////////
+std::vector<std::string> ServiceStatistics::Responsers() const
+{
+  std::vector<std::string> responsers;
+  for (const auto &responser : this->dataPtr->responsers)
+    responsers.push_back(responser.first);
+  return responsers;
+}
+
+//////////////////////////////////////////////////
+LatencyHistogram ServiceStatistics::RoundTripTime(
+    const std::string &_responser) const
+{
+  auto it = this->dataPtr->responsers.find(_responser);
+  return it != this->dataPtr->responsers.end() ?
+    it->second.roundTrip : LatencyHistogram();
+}
+
+//////////////////////////////////////////////////
+LatencyHistogram ServiceStatistics::QueueTime(
+    const std::string &_responser) const
+{
+  auto it = this->dataPtr->responsers.find(_responser);
+  return it != this->dataPtr->responsers.end() ?
+    it->second.queue : LatencyHistogram();
+}
+
+//////////////////////////////////////////////////
+LatencyHistogram ServiceStatistics::CallbackTime(
+    const std::string &_responser) const
+{
+  auto it = this->dataPtr->responsers.find(_responser);
+  return it != this->dataPtr->responsers.end() ?
+    it->second.callback : LatencyHistogram();
+}
+
+//////////////////////////////////////////////////
+LatencyHistogram ServiceStatistics::WireTime(
+    const std::string &_responser) const
+{
+  auto it = this->dataPtr->responsers.find(_responser);
+  return it != this->dataPtr->responsers.end() ?
+    it->second.wire : LatencyHistogram();
+}
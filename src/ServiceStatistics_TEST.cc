@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "gz/transport/ServiceStatistics.hh"
+
+using namespace gz;
+using namespace transport;
+
+//////////////////////////////////////////////////
+TEST(ServiceStatistics, Histogram)
+{
+  LatencyHistogram histogram;
+  EXPECT_EQ(0u, histogram.Count());
+  EXPECT_DOUBLE_EQ(0.0, histogram.Percentile(50));
+
+  // 1ms, 2ms, ..., 100ms.
+  for (int i = 1; i <= 100; ++i)
+    histogram.Update(i);
+
+  EXPECT_EQ(100u, histogram.Count());
+  EXPECT_DOUBLE_EQ(50.5, histogram.Summary().Avg());
+  EXPECT_DOUBLE_EQ(1.0, histogram.Summary().Min());
+  EXPECT_DOUBLE_EQ(100.0, histogram.Summary().Max());
+
+  // The percentiles are within 10% of the samples.
+  EXPECT_NEAR(50.0, histogram.Percentile(50), 5.0);
+  EXPECT_NEAR(90.0, histogram.Percentile(90), 9.0);
+  EXPECT_NEAR(99.0, histogram.Percentile(99), 9.9);
+  EXPECT_DOUBLE_EQ(1.0, histogram.Percentile(0));
+  EXPECT_DOUBLE_EQ(100.0, histogram.Percentile(100));
+  EXPECT_DOUBLE_EQ(100.0, histogram.Percentile(200));
+
+  // A single slow sample shows in the tail.
+  LatencyHistogram spike;
+  for (int i = 0; i < 99; ++i)
+    spike.Update(0.1);
+  spike.Update(250);
+  EXPECT_NEAR(0.1, spike.Percentile(99), 0.01);
+  EXPECT_DOUBLE_EQ(250.0, spike.Percentile(99.5));
+
+  // Out of range samples.
+  LatencyHistogram extremes;
+  extremes.Update(0);
+  extremes.Update(-1);
+  extremes.Update(1e9);
+  EXPECT_EQ(3u, extremes.Count());
+  EXPECT_DOUBLE_EQ(-1.0, extremes.Percentile(0));
+  EXPECT_NEAR(0.0, extremes.Percentile(50), 0.01);
+  EXPECT_DOUBLE_EQ(1e9, extremes.Percentile(99));
+}
+
+//////////////////////////////////////////////////
+TEST(ServiceStatistics, Served)
+{
+  ServiceStatistics stats;
+  EXPECT_EQ(0u, stats.QueueTime().Count());
+  EXPECT_EQ(0u, stats.CallbackTime().Count());
+  EXPECT_TRUE(stats.Responsers().empty());
+
+  stats.Update(1.0, 4.0);
+  stats.Update(3.0, 6.0);
+  EXPECT_EQ(2u, stats.QueueTime().Count());
+  EXPECT_DOUBLE_EQ(2.0, stats.QueueTime().Summary().Avg());
+  EXPECT_DOUBLE_EQ(5.0, stats.CallbackTime().Summary().Avg());
+  EXPECT_TRUE(stats.Responsers().empty());
+}
+
+//////////////////////////////////////////////////
+TEST(ServiceStatistics, Responsers)
+{
+  ServiceStatistics stats;
+  stats.UpdateResponse("p1", 10.0, 2.0, 5.0);
+  stats.UpdateResponse("p1", 20.0, 4.0, 10.0);
+
+  // A responser that doesn't report its times.
+  stats.UpdateResponse("p2", 8.0);
+
+  // The clocks might not be precise enough: the wire time is never
+  // negative.
+  stats.UpdateResponse("p3", 1.0, 0.5, 0.6);
+
+  std::vector<std::string> responsers = stats.Responsers();
+  ASSERT_EQ(3u, responsers.size());
+  EXPECT_EQ("p1", responsers[0]);
+  EXPECT_EQ("p2", responsers[1]);
+  EXPECT_EQ("p3", responsers[2]);
+
+  EXPECT_EQ(2u, stats.RoundTripTime("p1").Count());
+  EXPECT_DOUBLE_EQ(15.0, stats.RoundTripTime("p1").Summary().Avg());
+  EXPECT_DOUBLE_EQ(3.0, stats.QueueTime("p1").Summary().Avg());
+  EXPECT_DOUBLE_EQ(7.5, stats.CallbackTime("p1").Summary().Avg());
+  EXPECT_DOUBLE_EQ(4.5, stats.WireTime("p1").Summary().Avg());
+
+  EXPECT_EQ(1u, stats.RoundTripTime("p2").Count());
+  EXPECT_EQ(0u, stats.QueueTime("p2").Count());
+  EXPECT_EQ(0u, stats.CallbackTime("p2").Count());
+  EXPECT_EQ(0u, stats.WireTime("p2").Count());
+
+  EXPECT_DOUBLE_EQ(0.0, stats.WireTime("p3").Summary().Avg());
+
+  EXPECT_EQ(0u, stats.RoundTripTime("unknown").Count());
+
+  // The requests served by this process are not affected.
+  EXPECT_EQ(0u, stats.QueueTime().Count());
+
+  // Copy.
+  ServiceStatistics copy(stats);
+  EXPECT_EQ(3u, copy.Responsers().size());
+  EXPECT_EQ(2u, copy.RoundTripTime("p1").Count());
+  stats.UpdateResponse("p1", 30.0);
+  EXPECT_EQ(2u, copy.RoundTripTime("p1").Count());
+}
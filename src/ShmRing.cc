@@ -0,0 +1,305 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifdef __linux__
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <string>
+
+#include "ShmRing.hh"
+
+namespace gz
+{
+  namespace transport
+  {
+    inline namespace GZ_TRANSPORT_VERSION_NAMESPACE
+    {
+    static_assert(std::atomic<uint64_t>::is_always_lock_free,
+      "The shared memory rings require lock-free 64-bit atomics");
+
+    /// \brief Value stored at the beginning of the segment.
+    static const uint64_t kShmMagic = 0x677a2d73686d3031;
+
+    /// \brief Alignment of the header and the slots.
+    static const uint64_t kShmAlignment = 64;
+
+    /// \brief Header of the segment.
+    struct alignas(kShmAlignment) ShmHeader
+    {
+      /// \brief kShmMagic once the segment is initialized.
+      std::atomic<uint64_t> magic;
+
+      /// \brief Number of slots.
+      uint64_t numSlots;
+
+      /// \brief Capacity of each slot (bytes).
+      uint64_t slotSize;
+
+      /// \brief Distance between two slots (bytes).
+      uint64_t slotStride;
+    };
+
+    /// \brief Header of a slot, followed by the data.
+    struct ShmSlotHeader
+    {
+      /// \brief Twice the sequence number of the message stored, plus one
+      /// while the message is being written.
+      std::atomic<uint64_t> seq;
+
+      /// \brief Size of the message (bytes).
+      uint64_t size;
+    };
+
+    /// \internal
+    /// \brief Private data for ShmRing class.
+    class ShmRingPrivate
+    {
+      /// \brief Get the header of a slot.
+      /// \param[in] _seq Sequence number of a message.
+      /// \return The header of the slot storing the message.
+      public: ShmSlotHeader *Slot(const uint64_t _seq) const
+      {
+        const uint64_t index = _seq % this->header->numSlots;
+        return reinterpret_cast<ShmSlotHeader *>(
+          this->base + sizeof(ShmHeader) + index * this->header->slotStride);
+      }
+
+      /// \brief Name of the segment.
+      public: std::string name;
+
+      /// \brief Start of the mapping.
+      public: char *base = nullptr;
+
+      /// \brief Size of the mapping (bytes).
+      public: std::size_t mappedSize = 0;
+
+      /// \brief Header of the segment.
+      public: ShmHeader *header = nullptr;
+
+      /// \brief True if this object created the segment.
+      public: bool owner = false;
+
+      /// \brief Sequence number of the last message written.
+      public: uint64_t lastSeq = 0;
+    };
+
+    //////////////////////////////////////////////////
+    ShmRing::ShmRing()
+      : dataPtr(new ShmRingPrivate)
+    {
+    }
+
+    //////////////////////////////////////////////////
+    ShmRing::~ShmRing()
+    {
+#ifdef __linux__
+      if (this->dataPtr->base)
+        munmap(this->dataPtr->base, this->dataPtr->mappedSize);
+      if (this->dataPtr->owner)
+        shm_unlink(this->dataPtr->name.c_str());
+#endif
+    }
+
+    //////////////////////////////////////////////////
+    bool ShmRing::Create(const std::string &_name, const uint32_t _numSlots,
+      const uint64_t _slotSize)
+    {
+#ifdef __linux__
+      if (this->Valid() || _numSlots == 0 || _slotSize == 0)
+        return false;
+
+      const uint64_t stride = (sizeof(ShmSlotHeader) + _slotSize +
+        kShmAlignment - 1) / kShmAlignment * kShmAlignment;
+      const uint64_t size = sizeof(ShmHeader) + _numSlots * stride;
+
+      int fd = shm_open(_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+      if (fd < 0)
+      {
+        std::cerr << "ShmRing::Create(): Unable to create [" << _name << "]: "
+                  << std::strerror(errno) << std::endl;
+        return false;
+      }
+
+      // Reserve the memory now: writing to a sparse segment that can't be
+      // backed (e.g.: /dev/shm is full) would raise SIGBUS later.
+      int err = ftruncate(fd, static_cast<off_t>(size)) == 0 ?
+        posix_fallocate(fd, 0, static_cast<off_t>(size)) : errno;
+      void *addr = MAP_FAILED;
+      if (err == 0)
+      {
+        addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (addr == MAP_FAILED)
+          err = errno;
+      }
+      close(fd);
+
+      if (err != 0)
+      {
+        std::cerr << "ShmRing::Create(): Unable to allocate " << size
+                  << " bytes for [" << _name << "]: " << std::strerror(err)
+                  << std::endl;
+        shm_unlink(_name.c_str());
+        return false;
+      }
+
+      this->dataPtr->name = _name;
+      this->dataPtr->base = static_cast<char *>(addr);
+      this->dataPtr->mappedSize = size;
+      this->dataPtr->owner = true;
+
+      // The segment is zero-filled: the sequence numbers of all the slots
+      // are already zero.
+      ShmHeader *header = new (this->dataPtr->base) ShmHeader;
+      header->numSlots = _numSlots;
+      header->slotSize = _slotSize;
+      header->slotStride = stride;
+      header->magic.store(kShmMagic, std::memory_order_release);
+      this->dataPtr->header = header;
+      return true;
+#else
+      (void)_name;
+      (void)_numSlots;
+      (void)_slotSize;
+      return false;
+#endif
+    }
+
+    //////////////////////////////////////////////////
+    bool ShmRing::Open(const std::string &_name)
+    {
+#ifdef __linux__
+      if (this->Valid())
+        return false;
+
+      int fd = shm_open(_name.c_str(), O_RDONLY, 0);
+      if (fd < 0)
+        return false;
+
+      struct stat st;
+      void *addr = MAP_FAILED;
+      if (fstat(fd, &st) == 0 &&
+          static_cast<uint64_t>(st.st_size) >= sizeof(ShmHeader))
+      {
+        addr = mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ,
+          MAP_SHARED, fd, 0);
+      }
+      close(fd);
+
+      if (addr == MAP_FAILED)
+        return false;
+
+      const std::size_t size = static_cast<std::size_t>(st.st_size);
+      const ShmHeader *header = static_cast<const ShmHeader *>(addr);
+      if (header->magic.load(std::memory_order_acquire) != kShmMagic ||
+          header->numSlots == 0 ||
+          header->slotStride < sizeof(ShmSlotHeader) + header->slotSize ||
+          sizeof(ShmHeader) + header->numSlots * header->slotStride > size)
+      {
+        munmap(addr, size);
+        return false;
+      }
+
+      this->dataPtr->name = _name;
+      this->dataPtr->base = static_cast<char *>(addr);
+      this->dataPtr->mappedSize = size;
+      this->dataPtr->header = const_cast<ShmHeader *>(header);
+      return true;
+#else
+      (void)_name;
+      return false;
+#endif
+    }
+
+    //////////////////////////////////////////////////
+    bool ShmRing::Valid() const
+    {
+      return this->dataPtr->header != nullptr;
+    }
+
+    //////////////////////////////////////////////////
+    uint64_t ShmRing::SlotSize() const
+    {
+      return this->Valid() ? this->dataPtr->header->slotSize : 0;
+    }
+
+    //////////////////////////////////////////////////
+    uint32_t ShmRing::NumSlots() const
+    {
+      return this->Valid() ?
+        static_cast<uint32_t>(this->dataPtr->header->numSlots) : 0;
+    }
+
+    //////////////////////////////////////////////////
+    bool ShmRing::Write(const char *_data, const std::size_t _size,
+      ShmSlotDescriptor &_desc)
+    {
+      if (!this->Valid() || !this->dataPtr->owner ||
+          _size > this->dataPtr->header->slotSize)
+      {
+        return false;
+      }
+
+      const uint64_t seq = ++this->dataPtr->lastSeq;
+      ShmSlotHeader *slot = this->dataPtr->Slot(seq);
+
+      // Mark the slot as being written before modifying the data.
+      slot->seq.store(2 * seq - 1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+
+      slot->size = _size;
+      std::memcpy(reinterpret_cast<char *>(slot + 1), _data, _size);
+
+      slot->seq.store(2 * seq, std::memory_order_release);
+
+      _desc.seq = seq;
+      _desc.size = _size;
+      return true;
+    }
+
+    //////////////////////////////////////////////////
+    bool ShmRing::Read(const ShmSlotDescriptor &_desc,
+      std::string &_data) const
+    {
+      if (!this->Valid() || _desc.seq == 0 ||
+          _desc.size > this->dataPtr->header->slotSize)
+      {
+        return false;
+      }
+
+      const ShmSlotHeader *slot = this->dataPtr->Slot(_desc.seq);
+      const uint64_t before = slot->seq.load(std::memory_order_acquire);
+      if (before != 2 * _desc.seq || slot->size != _desc.size)
+        return false;
+
+      _data.assign(reinterpret_cast<const char *>(slot + 1), _desc.size);
+
+      // The writer might have reused the slot while it was copied.
+      std::atomic_thread_fence(std::memory_order_acquire);
+      return slot->seq.load(std::memory_order_relaxed) == before;
+    }
+    }
+  }
+}
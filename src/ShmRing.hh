@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GZ_TRANSPORT_SHMRING_HH_
+#define GZ_TRANSPORT_SHMRING_HH_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "gz/transport/config.hh"
+
+namespace gz
+{
+  namespace transport
+  {
+    inline namespace GZ_TRANSPORT_VERSION_NAMESPACE
+    {
+    class ShmRingPrivate;
+
+    /// \internal
+    /// \brief Location of a message stored in a ShmRing. The descriptor is
+    /// sent to the subscribers instead of the message.
+    struct ShmSlotDescriptor
+    {
+      /// \brief Sequence number of the message, starting at 1. Zero means
+      /// that the message is not stored in shared memory.
+      uint64_t seq = 0;
+
+      /// \brief Size of the message (bytes).
+      uint64_t size = 0;
+    };
+
+    /// \internal
+    /// \brief A ring of fixed size slots in a POSIX shared memory segment.
+    /// One process creates the ring and writes the messages, the processes
+    /// on the same host open it read-only. A slot is overwritten once the
+    /// writer wraps around, Read() detects it (and a slot being written
+    /// concurrently) using the sequence number stored with every slot.
+    ///
+    /// Shared memory is only supported on Linux. On the other platforms
+    /// Create() and Open() always fail.
+    class ShmRing
+    {
+      /// \brief Constructor. The ring is not valid until Create() or Open()
+      /// succeeds.
+      public: ShmRing();
+
+      /// \brief Destructor. Unmap the segment and remove it if this object
+      /// created it.
+      public: ~ShmRing();
+
+      /// \brief No copy constructor.
+      public: ShmRing(const ShmRing &) = delete;
+
+      /// \brief No assignment operator.
+      public: ShmRing &operator=(const ShmRing &) = delete;
+
+      /// \brief Create a new segment.
+      /// \param[in] _name Name of the segment.
+      /// \param[in] _numSlots Number of slots.
+      /// \param[in] _slotSize Capacity of each slot (bytes).
+      /// \return True on success or false if the segment could not be
+      /// created or the memory could not be reserved.
+      public: bool Create(const std::string &_name,
+                          const uint32_t _numSlots,
+                          const uint64_t _slotSize);
+
+      /// \brief Open an existing segment, read-only.
+      /// \param[in] _name Name of the segment.
+      /// \return True on success or false if the segment does not exist or
+      /// it is not a valid ring.
+      public: bool Open(const std::string &_name);
+
+      /// \brief Whether the ring has been created or opened.
+      /// \return True if the ring can be used.
+      public: bool Valid() const;
+
+      /// \brief Get the capacity of a slot.
+      /// \return The capacity (bytes) or 0 if the ring is not valid.
+      public: uint64_t SlotSize() const;
+
+      /// \brief Get the number of slots.
+      /// \return The number of slots or 0 if the ring is not valid.
+      public: uint32_t NumSlots() const;
+
+      /// \brief Store a message. The calls must be serialized by the caller
+      /// and the ring must have been created by this object.
+      /// \param[in] _data Message.
+      /// \param[in] _size Size of the message (bytes).
+      /// \param[out] _desc Location of the message.
+      /// \return True on success or false if the message doesn't fit in a
+      /// slot or the ring was opened read-only.
+      public: bool Write(const char *_data, const std::size_t _size,
+                         ShmSlotDescriptor &_desc);
+
+      /// \brief Copy a message out of the ring.
+      /// \param[in] _desc Location of the message.
+      /// \param[out] _data The message.
+      /// \return True on success or false if the message has already been
+      /// overwritten.
+      public: bool Read(const ShmSlotDescriptor &_desc,
+                        std::string &_data) const;
+
+      /// \brief Private data.
+      private: std::unique_ptr<ShmRingPrivate> dataPtr;
+    };
+    }
+  }
+}
+#endif
@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <string>
+
+#include "gz/transport/Uuid.hh"
+#include "ShmRing.hh"
+#include "gtest/gtest.h"
+
+using namespace gz;
+
+/// \brief Get a unique segment name.
+static std::string segmentName()
+{
+  return "/gz-transport-test-" + transport::Uuid().ToString();
+}
+
+#ifdef __linux__
+//////////////////////////////////////////////////
+/// \brief Write messages and read them from another mapping.
+TEST(ShmRingTest, WriteRead)
+{
+  const std::string name = segmentName();
+
+  transport::ShmRing writer;
+  EXPECT_FALSE(writer.Valid());
+  ASSERT_TRUE(writer.Create(name, 4, 100));
+  EXPECT_TRUE(writer.Valid());
+  EXPECT_EQ(4u, writer.NumSlots());
+  EXPECT_EQ(100u, writer.SlotSize());
+
+  // The name is already used.
+  transport::ShmRing other;
+  EXPECT_FALSE(other.Create(name, 4, 100));
+
+  transport::ShmRing reader;
+  ASSERT_TRUE(reader.Open(name));
+  EXPECT_EQ(4u, reader.NumSlots());
+  EXPECT_EQ(100u, reader.SlotSize());
+
+  const std::string msg1 = "first message";
+  transport::ShmSlotDescriptor desc1;
+  ASSERT_TRUE(writer.Write(msg1.data(), msg1.size(), desc1));
+  EXPECT_EQ(msg1.size(), desc1.size);
+
+  const std::string msg2(100, 'x');
+  transport::ShmSlotDescriptor desc2;
+  ASSERT_TRUE(writer.Write(msg2.data(), msg2.size(), desc2));
+  EXPECT_NE(desc1.seq, desc2.seq);
+
+  std::string data;
+  ASSERT_TRUE(reader.Read(desc1, data));
+  EXPECT_EQ(msg1, data);
+  ASSERT_TRUE(reader.Read(desc2, data));
+  EXPECT_EQ(msg2, data);
+
+  // Too big for a slot.
+  const std::string tooBig(101, 'x');
+  transport::ShmSlotDescriptor desc;
+  EXPECT_FALSE(writer.Write(tooBig.data(), tooBig.size(), desc));
+
+  // A read-only ring can't be written.
+  EXPECT_FALSE(reader.Write(msg1.data(), msg1.size(), desc));
+
+  // Messages not stored in shared memory.
+  EXPECT_FALSE(reader.Read(transport::ShmSlotDescriptor(), data));
+}
+
+//////////////////////////////////////////////////
+/// \brief A message overwritten by the writer can't be read.
+TEST(ShmRingTest, Overwritten)
+{
+  const std::string name = segmentName();
+
+  transport::ShmRing writer;
+  ASSERT_TRUE(writer.Create(name, 2, 16));
+  transport::ShmRing reader;
+  ASSERT_TRUE(reader.Open(name));
+
+  transport::ShmSlotDescriptor first;
+  ASSERT_TRUE(writer.Write("0", 1, first));
+
+  transport::ShmSlotDescriptor desc;
+  ASSERT_TRUE(writer.Write("1", 1, desc));
+  ASSERT_TRUE(writer.Write("2", 1, desc));
+
+  std::string data;
+  EXPECT_FALSE(reader.Read(first, data));
+  ASSERT_TRUE(reader.Read(desc, data));
+  EXPECT_EQ("2", data);
+
+  // The size doesn't match the slot.
+  desc.size = 2;
+  EXPECT_FALSE(reader.Read(desc, data));
+}
+
+//////////////////////////////////////////////////
+/// \brief The segment is removed when the writer is destroyed.
+TEST(ShmRingTest, Lifetime)
+{
+  const std::string name = segmentName();
+
+  transport::ShmRing reader;
+  EXPECT_FALSE(reader.Open(name));
+
+  {
+    transport::ShmRing writer;
+    ASSERT_TRUE(writer.Create(name, 1, 8));
+    EXPECT_FALSE(writer.Create(name, 1, 8));
+  }
+
+  EXPECT_FALSE(reader.Open(name));
+  EXPECT_FALSE(reader.Valid());
+  EXPECT_EQ(0u, reader.SlotSize());
+  EXPECT_EQ(0u, reader.NumSlots());
+}
+#else
+//////////////////////////////////////////////////
+/// \brief Shared memory is not supported on this platform.
+TEST(ShmRingTest, NotSupported)
+{
+  transport::ShmRing ring;
+  EXPECT_FALSE(ring.Create(segmentName(), 4, 100));
+  EXPECT_FALSE(ring.Open(segmentName()));
+  EXPECT_FALSE(ring.Valid());
+}
+#endif
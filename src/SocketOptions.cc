@@ -0,0 +1,274 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <zmq.hpp>
+
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "gz/transport/Helpers.hh"
+
+#include "SocketOptions.hh"
+#include "ThreadSettings.hh"
+
+using namespace gz;
+using namespace transport;
+
+//////////////////////////////////////////////////
+/// \brief Parse a non-negative integer.
+/// \param[in] _str The string.
+/// \param[out] _value The integer.
+/// \return True if the whole string is a non-negative integer.
+static bool parseInt(const std::string &_str, int &_value)
+{
+  if (_str.empty() ||
+      _str.find_first_not_of("0123456789") != std::string::npos)
+  {
+    return false;
+  }
+
+  try
+  {
+    _value = std::stoi(_str);
+  }
+  catch (const std::out_of_range &)
+  {
+    return false;
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+/// \brief Read a non-negative integer environment variable.
+/// \param[in] _name Name of the variable.
+/// \param[out] _value The value, unchanged if the variable is not set or
+/// invalid.
+static void nonNegativeEnv(const std::string &_name, int &_value)
+{
+  std::string str;
+  if (env(_name, str) && !parseInt(str, _value))
+  {
+    std::cerr << _name << " must be a non-negative number, ignoring ["
+              << str << "]" << std::endl;
+  }
+}
+
+//////////////////////////////////////////////////
+bool SocketOptions::ParseKeepAlive(const std::string &_value)
+{
+  if (_value == "0")
+  {
+    this->keepAlive = 0;
+    return true;
+  }
+
+  const std::vector<std::string> fields = split(_value, ',');
+  if (fields.size() > 3)
+    return false;
+
+  std::vector<int> values;
+  for (const std::string &field : fields)
+  {
+    int value;
+    if (!parseInt(field, value) || value == 0)
+      return false;
+    values.push_back(value);
+  }
+
+  this->keepAlive = 1;
+  this->keepAliveIdle = values[0];
+  if (values.size() > 1)
+    this->keepAliveInterval = values[1];
+  if (values.size() > 2)
+    this->keepAliveCount = values[2];
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool SocketOptions::ParseAffinity(const std::string &_value,
+  std::string &_error)
+{
+  bool result = true;
+  for (const std::string &entry : split(_value, ' '))
+  {
+    if (entry.empty())
+      continue;
+
+    const auto equal = entry.find('=');
+    std::vector<int> threads;
+    if (equal == std::string::npos || equal == 0 ||
+        !ParseIndexList(entry.substr(equal + 1), threads))
+    {
+      if (result)
+        _error = "Invalid entry [" + entry + "]";
+      result = false;
+      continue;
+    }
+
+    uint64_t mask = 0;
+    for (const int thread : threads)
+    {
+      if (thread < 64)
+        mask |= uint64_t{1} << thread;
+    }
+    this->affinity[entry.substr(0, equal)] = mask;
+  }
+  return result;
+}
+
+//////////////////////////////////////////////////
+uint64_t SocketOptions::Affinity(const std::string &_class) const
+{
+  auto it = this->affinity.find(_class);
+  return it == this->affinity.end() ? 0 : it->second;
+}
+
+//////////////////////////////////////////////////
+bool SocketOptions::ParseDscp(const std::string &_value, std::string &_error)
+{
+  bool result = true;
+  for (const std::string &entry : split(_value, ' '))
+  {
+    if (entry.empty())
+      continue;
+
+    const auto equal = entry.find('=');
+    const std::string name = entry.substr(0, equal);
+    int value = -1;
+    int index = -1;
+    if (name == "control")
+      index = static_cast<int>(Priority_t::CONTROL);
+    else if (name == "normal")
+      index = static_cast<int>(Priority_t::NORMAL);
+    else if (name == "bulk")
+      index = static_cast<int>(Priority_t::BULK);
+
+    if (equal == std::string::npos || index < 0 ||
+        !parseInt(entry.substr(equal + 1), value) || value > 63)
+    {
+      if (result)
+        _error = "Invalid entry [" + entry + "]";
+      result = false;
+      continue;
+    }
+
+    this->dscp[index] = value;
+  }
+  return result;
+}
+
+//////////////////////////////////////////////////
+int SocketOptions::Dscp(const Priority_t _priority) const
+{
+  return this->dscp[static_cast<int>(_priority)];
+}
+
+//////////////////////////////////////////////////
+void SocketOptions::ApplyPriority(zmq::socket_t &_socket,
+  const Priority_t _priority) const
+{
+  const int value = this->Dscp(_priority);
+  if (value < 0)
+    return;
+
+  // The DSCP is the upper 6 bits of the TOS byte.
+  const int tos = value << 2;
+#ifdef GZ_CPPZMQ_POST_4_7_0
+  _socket.set(zmq::sockopt::tos, tos);
+#else
+  _socket.setsockopt(ZMQ_TOS, &tos, sizeof(tos));
+#endif
+}
+
+//////////////////////////////////////////////////
+void SocketOptions::ApplyMulticast(zmq::socket_t &_socket) const
+{
+#ifdef GZ_CPPZMQ_POST_4_7_0
+  _socket.set(zmq::sockopt::rate, this->multicastRate);
+#else
+  _socket.setsockopt(ZMQ_RATE, &this->multicastRate,
+    sizeof(this->multicastRate));
+#endif
+}
+
+//////////////////////////////////////////////////
+void SocketOptions::Apply(zmq::socket_t &_socket,
+  const std::string &_class) const
+{
+  const uint64_t threads = this->Affinity(_class);
+#ifdef GZ_CPPZMQ_POST_4_7_0
+  if (this->sndBuf >= 0)
+    _socket.set(zmq::sockopt::sndbuf, this->sndBuf);
+  if (this->rcvBuf >= 0)
+    _socket.set(zmq::sockopt::rcvbuf, this->rcvBuf);
+  if (this->keepAlive >= 0)
+    _socket.set(zmq::sockopt::tcp_keepalive, this->keepAlive);
+  if (this->keepAliveIdle >= 0)
+    _socket.set(zmq::sockopt::tcp_keepalive_idle, this->keepAliveIdle);
+  if (this->keepAliveInterval >= 0)
+    _socket.set(zmq::sockopt::tcp_keepalive_intvl, this->keepAliveInterval);
+  if (this->keepAliveCount >= 0)
+    _socket.set(zmq::sockopt::tcp_keepalive_cnt, this->keepAliveCount);
+  if (threads != 0)
+    _socket.set(zmq::sockopt::affinity, threads);
+#else
+  auto setInt = [&_socket](const int _option, const int _value)
+  {
+    if (_value >= 0)
+      _socket.setsockopt(_option, &_value, sizeof(_value));
+  };
+  setInt(ZMQ_SNDBUF, this->sndBuf);
+  setInt(ZMQ_RCVBUF, this->rcvBuf);
+  setInt(ZMQ_TCP_KEEPALIVE, this->keepAlive);
+  setInt(ZMQ_TCP_KEEPALIVE_IDLE, this->keepAliveIdle);
+  setInt(ZMQ_TCP_KEEPALIVE_INTVL, this->keepAliveInterval);
+  setInt(ZMQ_TCP_KEEPALIVE_CNT, this->keepAliveCount);
+  if (threads != 0)
+    _socket.setsockopt(ZMQ_AFFINITY, &threads, sizeof(threads));
+#endif
+}
+
+//////////////////////////////////////////////////
+SocketOptions SocketOptions::FromEnv()
+{
+  SocketOptions options;
+  nonNegativeEnv("GZ_TRANSPORT_SNDBUF", options.sndBuf);
+  nonNegativeEnv("GZ_TRANSPORT_RCVBUF", options.rcvBuf);
+  nonNegativeEnv("GZ_TRANSPORT_MULTICAST_RATE", options.multicastRate);
+
+  std::string value;
+  if (env("GZ_TRANSPORT_TCP_KEEPALIVE", value) &&
+      !options.ParseKeepAlive(value))
+  {
+    std::cerr << "Invalid GZ_TRANSPORT_TCP_KEEPALIVE [" << value << "], "
+              << "expected 0 or <idle>[,<interval>[,<count>]]" << std::endl;
+  }
+
+  std::string error;
+  if (env("GZ_TRANSPORT_ZMQ_AFFINITY", value) &&
+      !options.ParseAffinity(value, error))
+  {
+    std::cerr << "Invalid GZ_TRANSPORT_ZMQ_AFFINITY: " << error << std::endl;
+  }
+
+  if (env("GZ_TRANSPORT_DSCP", value) && !options.ParseDscp(value, error))
+    std::cerr << "Invalid GZ_TRANSPORT_DSCP: " << error << std::endl;
+  return options;
+}
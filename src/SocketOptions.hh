@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GZ_TRANSPORT_SOCKETOPTIONS_HH_
+#define GZ_TRANSPORT_SOCKETOPTIONS_HH_
+
+#include <zmq.hpp>
+
+#include <cstdint>
+#include <map>
+#include <string>
+
+#include "gz/transport/AdvertiseOptions.hh"
+#include "gz/transport/config.hh"
+
+namespace gz
+{
+  namespace transport
+  {
+    inline namespace GZ_TRANSPORT_VERSION_NAMESPACE
+    {
+    /// \internal
+    /// \brief Tuning of the ZMQ sockets of NodeShared, read from the
+    /// GZ_TRANSPORT_SNDBUF, GZ_TRANSPORT_RCVBUF, GZ_TRANSPORT_TCP_KEEPALIVE,
+    /// GZ_TRANSPORT_ZMQ_AFFINITY, GZ_TRANSPORT_DSCP and
+    /// GZ_TRANSPORT_MULTICAST_RATE environment variables. The sockets are
+    /// grouped in classes: "publisher", "subscriber" and "service" (the
+    /// sockets of the service calls). The options left to -1 keep the ZMQ
+    /// defaults.
+    class SocketOptions
+    {
+      /// \brief Parse the TCP keepalive option.
+      /// \param[in] _value "0" to disable the keepalive, or
+      /// "<idle>[,<interval>[,<count>]]" to enable it: the connection is
+      /// probed after <idle> seconds without traffic, every <interval>
+      /// seconds, and dropped after <count> unanswered probes.
+      /// \return True if the value is valid.
+      public: bool ParseKeepAlive(const std::string &_value);
+
+      /// \brief Parse the mapping of the socket classes to the ZMQ I/O
+      /// threads.
+      /// \param[in] _value Space delimited list of <class>=<threads>, where
+      /// <threads> is a comma separated list of I/O thread indexes or
+      /// ranges, e.g.: "publisher=1,2 subscriber=0".
+      /// \param[out] _error Description of the first invalid entry.
+      /// \return True if the list is valid. The valid entries are kept
+      /// otherwise.
+      public: bool ParseAffinity(const std::string &_value,
+                                 std::string &_error);
+
+      /// \brief Get the I/O threads of a class of sockets.
+      /// \param[in] _class The class of sockets.
+      /// \return The ZMQ_AFFINITY bit mask, 0 for any thread.
+      public: uint64_t Affinity(const std::string &_class) const;
+
+      /// \brief Parse the DSCP of the priority classes.
+      /// \param[in] _value Space delimited list of <priority>=<dscp>, where
+      /// <priority> is "control", "normal" or "bulk" and <dscp> is a
+      /// number from 0 to 63, e.g.: "control=46 bulk=8".
+      /// \param[out] _error Description of the first invalid entry.
+      /// \return True if the list is valid. The valid entries are kept
+      /// otherwise.
+      public: bool ParseDscp(const std::string &_value, std::string &_error);
+
+      /// \brief Get the DSCP of a priority class.
+      /// \param[in] _priority The priority.
+      /// \return The DSCP, or -1 to keep the default of the system.
+      public: int Dscp(const Priority_t _priority) const;
+
+      /// \brief Mark the TCP traffic of a socket with the DSCP of a priority
+      /// class (ZMQ_TOS). Call it before the socket is bound or connected.
+      /// \param[in] _socket The socket.
+      /// \param[in] _priority The priority.
+      public: void ApplyPriority(zmq::socket_t &_socket,
+                                 const Priority_t _priority) const;
+
+      /// \brief Set the rate of the multicast transport on a socket
+      /// (ZMQ_RATE). Call it before the socket is connected.
+      /// \param[in] _socket The socket.
+      public: void ApplyMulticast(zmq::socket_t &_socket) const;
+
+      /// \brief Set the options on a socket. Call it before the socket is
+      /// bound or connected.
+      /// \param[in] _socket The socket.
+      /// \param[in] _class Class of the socket.
+      public: void Apply(zmq::socket_t &_socket,
+                         const std::string &_class) const;
+
+      /// \brief Read the options from the environment variables. The
+      /// invalid values are reported and ignored.
+      /// \return The options.
+      public: static SocketOptions FromEnv();
+
+      /// \brief Size (bytes) of the kernel send buffer (ZMQ_SNDBUF).
+      public: int sndBuf = -1;
+
+      /// \brief Size (bytes) of the kernel receive buffer (ZMQ_RCVBUF).
+      public: int rcvBuf = -1;
+
+      /// \brief 1 to enable the TCP keepalive, 0 to disable it.
+      public: int keepAlive = -1;
+
+      /// \brief Time (s) without traffic before the first probe.
+      public: int keepAliveIdle = -1;
+
+      /// \brief Time (s) between the probes.
+      public: int keepAliveInterval = -1;
+
+      /// \brief Number of unanswered probes dropping the connection.
+      public: int keepAliveCount = -1;
+
+      /// \brief Maximum rate (kbit/s) of the multicast publishers. The ZMQ
+      /// default, 100 kbit/s, is too low for the streams sent over
+      /// multicast.
+      public: int multicastRate = 100000;
+
+      /// \brief ZMQ_AFFINITY bit mask by class of sockets.
+      private: std::map<std::string, uint64_t> affinity;
+
+      /// \brief DSCP by priority class, indexed by Priority_t. By default,
+      /// the CONTROL traffic is expedited forwarding (46) and the BULK
+      /// traffic is lower effort class selector 1 (8).
+      private: int dscp[3] = {46, -1, 8};
+    };
+    }
+  }
+}
+#endif
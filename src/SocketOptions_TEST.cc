@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <string>
+
+#include <gz/utils/Environment.hh>
+
+#include "SocketOptions.hh"
+#include "gtest/gtest.h"
+
+using namespace gz;
+using namespace transport;
+
+//////////////////////////////////////////////////
+/// \brief Check the TCP keepalive option.
+TEST(SocketOptionsTest, KeepAlive)
+{
+  SocketOptions options;
+  EXPECT_EQ(-1, options.keepAlive);
+
+  EXPECT_TRUE(options.ParseKeepAlive("0"));
+  EXPECT_EQ(0, options.keepAlive);
+  EXPECT_EQ(-1, options.keepAliveIdle);
+
+  EXPECT_TRUE(options.ParseKeepAlive("30"));
+  EXPECT_EQ(1, options.keepAlive);
+  EXPECT_EQ(30, options.keepAliveIdle);
+  EXPECT_EQ(-1, options.keepAliveInterval);
+  EXPECT_EQ(-1, options.keepAliveCount);
+
+  EXPECT_TRUE(options.ParseKeepAlive("10,5,3"));
+  EXPECT_EQ(10, options.keepAliveIdle);
+  EXPECT_EQ(5, options.keepAliveInterval);
+  EXPECT_EQ(3, options.keepAliveCount);
+
+  for (const std::string value : {"", "-1", "a", "10,", "10,0", "1,2,3,4"})
+  {
+    SocketOptions invalid;
+    EXPECT_FALSE(invalid.ParseKeepAlive(value)) << value;
+    EXPECT_EQ(-1, invalid.keepAlive) << value;
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the mapping of the sockets to the I/O threads.
+TEST(SocketOptionsTest, Affinity)
+{
+  SocketOptions options;
+  std::string error;
+  EXPECT_TRUE(options.ParseAffinity("publisher=1,2  subscriber=0-1", error));
+  EXPECT_EQ(6u, options.Affinity("publisher"));
+  EXPECT_EQ(3u, options.Affinity("subscriber"));
+  EXPECT_EQ(0u, options.Affinity("service"));
+
+  EXPECT_FALSE(options.ParseAffinity("service=x publisher=0", error));
+  EXPECT_NE(std::string::npos, error.find("service=x"));
+  EXPECT_EQ(0u, options.Affinity("service"));
+  EXPECT_EQ(1u, options.Affinity("publisher"));
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the DSCP of the priority classes.
+TEST(SocketOptionsTest, Dscp)
+{
+  SocketOptions options;
+  EXPECT_EQ(46, options.Dscp(Priority_t::CONTROL));
+  EXPECT_EQ(-1, options.Dscp(Priority_t::NORMAL));
+  EXPECT_EQ(8, options.Dscp(Priority_t::BULK));
+
+  std::string error;
+  EXPECT_TRUE(options.ParseDscp("control=34 normal=0", error));
+  EXPECT_EQ(34, options.Dscp(Priority_t::CONTROL));
+  EXPECT_EQ(0, options.Dscp(Priority_t::NORMAL));
+  EXPECT_EQ(8, options.Dscp(Priority_t::BULK));
+
+  EXPECT_FALSE(options.ParseDscp("bulk=64 urgent=1 control=10", error));
+  EXPECT_NE(std::string::npos, error.find("bulk=64"));
+  EXPECT_EQ(8, options.Dscp(Priority_t::BULK));
+  EXPECT_EQ(10, options.Dscp(Priority_t::CONTROL));
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the options read from the environment.
+TEST(SocketOptionsTest, FromEnv)
+{
+  ASSERT_TRUE(gz::utils::setenv("GZ_TRANSPORT_SNDBUF", "4194304"));
+  ASSERT_TRUE(gz::utils::setenv("GZ_TRANSPORT_RCVBUF", "-5"));
+  ASSERT_TRUE(gz::utils::setenv("GZ_TRANSPORT_TCP_KEEPALIVE", "60,10"));
+  ASSERT_TRUE(gz::utils::setenv("GZ_TRANSPORT_ZMQ_AFFINITY", "service=1"));
+  ASSERT_TRUE(gz::utils::setenv("GZ_TRANSPORT_DSCP", "bulk=0"));
+  ASSERT_TRUE(gz::utils::setenv("GZ_TRANSPORT_MULTICAST_RATE", "1000000"));
+
+  const SocketOptions options = SocketOptions::FromEnv();
+  EXPECT_EQ(4194304, options.sndBuf);
+  EXPECT_EQ(-1, options.rcvBuf);
+  EXPECT_EQ(1, options.keepAlive);
+  EXPECT_EQ(60, options.keepAliveIdle);
+  EXPECT_EQ(10, options.keepAliveInterval);
+  EXPECT_EQ(2u, options.Affinity("service"));
+  EXPECT_EQ(0, options.Dscp(Priority_t::BULK));
+  EXPECT_EQ(1000000, options.multicastRate);
+
+  for (const char *name : {"GZ_TRANSPORT_SNDBUF", "GZ_TRANSPORT_RCVBUF",
+         "GZ_TRANSPORT_TCP_KEEPALIVE", "GZ_TRANSPORT_ZMQ_AFFINITY",
+         "GZ_TRANSPORT_DSCP", "GZ_TRANSPORT_MULTICAST_RATE"})
+  {
+    EXPECT_TRUE(gz::utils::unsetenv(name));
+  }
+}
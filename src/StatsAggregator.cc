@@ -0,0 +1,307 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gz/msgs/statistic.pb.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gz/transport/Node.hh"
+#include "gz/transport/StatsAggregator.hh"
+
+#include "TransportMetrics.hh"
+
+using namespace gz;
+using namespace transport;
+
+/// \brief A process is forgotten after this number of periods without
+/// report.
+static const int kMissedReports = 3;
+
+//////////////////////////////////////////////////
+/// \brief Report of a topic by a process.
+struct TopicReport
+{
+  /// \brief Cumulative counters, see TransportMetrics::Counter.
+  std::array<double, TransportMetrics::NUM_COUNTERS> counters{};
+
+  /// \brief Messages dropped, detected from the sequence numbers.
+  double gaps = 0;
+
+  /// \brief Rates of the counters and of the gaps, between the last two
+  /// reports.
+  std::array<double, TransportMetrics::NUM_COUNTERS + 1> rates{};
+
+  /// \brief Median message age (ms).
+  double ageP50 = 0;
+
+  /// \brief 99th percentile of the message age (ms).
+  double ageP99 = 0;
+
+  /// \brief Maximum message age (ms).
+  double ageMax = 0;
+
+  /// \brief Number of messages whose age was measured.
+  uint64_t ageCount = 0;
+};
+
+//////////////////////////////////////////////////
+/// \brief Last report of a process.
+struct ProcessReport
+{
+  /// \brief Reception time of the report.
+  std::chrono::steady_clock::time_point time;
+
+  /// \brief Period (ms) of the reports.
+  double period = 0;
+
+  /// \brief Reports by fully qualified topic name.
+  std::map<std::string, TopicReport> topics;
+};
+
+/// \internal
+/// \brief Private data for the StatsAggregator class.
+class gz::transport::StatsAggregatorPrivate
+{
+  /// \brief Constructor.
+  /// \param[in] _options Options of the node.
+  public: explicit StatsAggregatorPrivate(const NodeOptions &_options)
+    : options(_options)
+  {
+  }
+
+  /// \brief Forget the processes that stopped reporting.
+  /// \param[in] _now Current time.
+  public: void Expire(const std::chrono::steady_clock::time_point &_now);
+
+  /// \brief Options of the node.
+  public: NodeOptions options;
+
+  /// \brief Node subscribed to the metrics, null if not started.
+  public: std::unique_ptr<Node> node;
+
+  /// \brief Last report by process UUID.
+  public: std::map<std::string, ProcessReport> processes;
+
+  /// \brief Protect processes.
+  public: mutable std::mutex mutex;
+};
+
+//////////////////////////////////////////////////
+void StatsAggregatorPrivate::Expire(
+  const std::chrono::steady_clock::time_point &_now)
+{
+  for (auto it = this->processes.begin(); it != this->processes.end();)
+  {
+    const auto timeout = std::chrono::duration<double, std::milli>(
+      kMissedReports * std::max(it->second.period, 1.0));
+    if (_now - it->second.time > timeout)
+      it = this->processes.erase(it);
+    else
+      ++it;
+  }
+}
+
+//////////////////////////////////////////////////
+StatsAggregator::StatsAggregator(const NodeOptions &_options)
+  : dataPtr(new StatsAggregatorPrivate(_options))
+{
+}
+
+//////////////////////////////////////////////////
+StatsAggregator::~StatsAggregator()
+{
+  this->Stop();
+}
+
+//////////////////////////////////////////////////
+bool StatsAggregator::Start()
+{
+  if (this->dataPtr->node)
+    return false;
+
+  std::function<void(const msgs::Metric &)> cb =
+    [this](const msgs::Metric &_msg)
+    {
+      this->AddMetrics(_msg);
+    };
+
+  auto node = std::make_unique<Node>(this->dataPtr->options);
+  if (!node->Subscribe(TransportMetrics::kTopic, cb))
+    return false;
+
+  this->dataPtr->node = std::move(node);
+  return true;
+}
+
+//////////////////////////////////////////////////
+void StatsAggregator::Stop()
+{
+  // The node destructor waits for the callbacks in progress.
+  this->dataPtr->node.reset();
+}
+
+//////////////////////////////////////////////////
+void StatsAggregator::AddMetrics(const msgs::Metric &_msg,
+  const std::chrono::steady_clock::time_point &_now)
+{
+  const std::string prefix = TransportMetrics::kProcessGroupPrefix;
+  std::string pUuid;
+  double period = 0;
+  for (const msgs::StatisticsGroup &group : _msg.statistics_groups())
+  {
+    if (group.name().compare(0, prefix.size(), prefix) != 0)
+      continue;
+    pUuid = group.name().substr(prefix.size());
+    for (const msgs::Statistic &stat : group.statistics())
+    {
+      if (stat.name() == "period")
+        period = stat.value();
+    }
+  }
+  if (pUuid.empty())
+    return;
+
+  std::lock_guard<std::mutex> lk(this->dataPtr->mutex);
+  this->dataPtr->Expire(_now);
+
+  ProcessReport &process = this->dataPtr->processes[pUuid];
+  const bool first = process.time == std::chrono::steady_clock::time_point();
+  const double elapsed =
+    std::chrono::duration<double>(_now - process.time).count();
+  process.time = _now;
+  process.period = period;
+
+  for (const msgs::StatisticsGroup &group : _msg.statistics_groups())
+  {
+    // The topics are fully qualified: "@<partition>@<topic>".
+    if (group.name().empty() || group.name()[0] != '@')
+      continue;
+
+    const bool known = process.topics.count(group.name()) > 0;
+    TopicReport &topic = process.topics[group.name()];
+    const TopicReport previous = topic;
+    for (const msgs::Statistic &stat : group.statistics())
+    {
+      const std::string &name = stat.name();
+      if (name == "age_p50")
+        topic.ageP50 = stat.value();
+      else if (name == "age_p99")
+        topic.ageP99 = stat.value();
+      else if (name == "age_max")
+        topic.ageMax = stat.value();
+      else if (name == "age_count")
+        topic.ageCount = static_cast<uint64_t>(stat.value());
+      else if (name == "dropped_messages")
+        topic.gaps = stat.value();
+      else
+      {
+        for (int i = 0; i < TransportMetrics::NUM_COUNTERS; ++i)
+        {
+          if (name == TransportMetrics::CounterName(
+                static_cast<TransportMetrics::Counter>(i)))
+          {
+            topic.counters[i] = stat.value();
+            break;
+          }
+        }
+      }
+    }
+
+    // The first report of a process, or of a topic, is the baseline of
+    // the rates.
+    if (first || !known || elapsed <= 0)
+      continue;
+    for (int i = 0; i < TransportMetrics::NUM_COUNTERS; ++i)
+    {
+      topic.rates[i] = std::max(
+        topic.counters[i] - previous.counters[i], 0.0) / elapsed;
+    }
+    topic.rates[TransportMetrics::NUM_COUNTERS] =
+      std::max(topic.gaps - previous.gaps, 0.0) / elapsed;
+  }
+}
+
+//////////////////////////////////////////////////
+std::vector<AggregatedTopicStatistics> StatsAggregator::Topics(
+  const std::chrono::steady_clock::time_point &_now) const
+{
+  std::map<std::string, AggregatedTopicStatistics> topics;
+  std::map<std::string, double> weightedP50;
+
+  std::lock_guard<std::mutex> lk(this->dataPtr->mutex);
+  this->dataPtr->Expire(_now);
+  for (const auto &process : this->dataPtr->processes)
+  {
+    for (const auto &report : process.second.topics)
+    {
+      const TopicReport &topic = report.second;
+      AggregatedTopicStatistics &stats = topics[report.first];
+      stats.topic = report.first;
+      ++stats.processes;
+      stats.sentMsgsPerSec += topic.rates[TransportMetrics::SENT_MSGS];
+      stats.sentBytesPerSec += topic.rates[TransportMetrics::SENT_BYTES];
+      stats.receivedMsgsPerSec +=
+        topic.rates[TransportMetrics::RECEIVED_MSGS];
+      stats.receivedBytesPerSec +=
+        topic.rates[TransportMetrics::RECEIVED_BYTES];
+      stats.droppedMsgsPerSec +=
+        topic.rates[TransportMetrics::SEND_FAILURES] +
+        topic.rates[TransportMetrics::QUEUE_DROPS] +
+        topic.rates[TransportMetrics::NUM_COUNTERS];
+
+      stats.latencyCount += topic.ageCount;
+      weightedP50[report.first] +=
+        topic.ageP50 * static_cast<double>(topic.ageCount);
+      stats.latencyP99 = std::max(stats.latencyP99, topic.ageP99);
+      stats.latencyMax = std::max(stats.latencyMax, topic.ageMax);
+    }
+  }
+
+  std::vector<AggregatedTopicStatistics> result;
+  result.reserve(topics.size());
+  for (auto &topic : topics)
+  {
+    AggregatedTopicStatistics &stats = topic.second;
+    const double total = stats.receivedMsgsPerSec + stats.droppedMsgsPerSec;
+    if (total > 0)
+      stats.dropRate = stats.droppedMsgsPerSec / total;
+    if (stats.latencyCount > 0)
+    {
+      stats.latencyP50 = weightedP50[topic.first] /
+        static_cast<double>(stats.latencyCount);
+    }
+    result.push_back(stats);
+  }
+  return result;
+}
+
+//////////////////////////////////////////////////
+std::size_t StatsAggregator::ProcessCount() const
+{
+  std::lock_guard<std::mutex> lk(this->dataPtr->mutex);
+  return this->dataPtr->processes.size();
+}
@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gz/msgs/statistic.pb.h>
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "gz/transport/StatsAggregator.hh"
+#include "gz/transport/TopicStatistics.hh"
+#include "TransportMetrics.hh"
+#include "gtest/gtest.h"
+
+using namespace gz;
+using namespace transport;
+
+//////////////////////////////////////////////////
+/// \brief Check the aggregation of the metrics of two processes.
+TEST(StatsAggregatorTest, Aggregation)
+{
+  TransportMetrics pub;
+  pub.SetProcess("pub", 1000);
+  TransportMetrics sub;
+  sub.SetProcess("sub", 1000);
+
+  StatsAggregator aggregator;
+  const auto start = std::chrono::steady_clock::now();
+  msgs::Metric msg;
+  pub.FillMessage(msg);
+  aggregator.AddMetrics(msg, start);
+  msg.Clear();
+  sub.FillMessage(msg);
+  aggregator.AddMetrics(msg, start);
+  EXPECT_EQ(2u, aggregator.ProcessCount());
+
+  // The first report of a topic is the baseline of its rates.
+  pub.Add("@@/foo", TransportMetrics::SENT_MSGS, 10);
+  sub.Add("@@/foo", TransportMetrics::RECEIVED_MSGS, 8);
+  msg.Clear();
+  pub.FillMessage(msg);
+  aggregator.AddMetrics(msg, start + std::chrono::seconds(1));
+  msg.Clear();
+  sub.FillMessage(msg);
+  aggregator.AddMetrics(msg, start + std::chrono::seconds(1));
+
+  auto topics = aggregator.Topics(start + std::chrono::seconds(1));
+  ASSERT_EQ(1u, topics.size());
+  EXPECT_EQ("@@/foo", topics[0].topic);
+  EXPECT_EQ(2u, topics[0].processes);
+  EXPECT_DOUBLE_EQ(0.0, topics[0].sentMsgsPerSec);
+
+  pub.Add("@@/foo", TransportMetrics::SENT_MSGS, 200);
+  sub.Add("@@/foo", TransportMetrics::RECEIVED_MSGS, 150);
+  sub.Add("@@/foo", TransportMetrics::QUEUE_DROPS, 30);
+
+  // The subscriber measures the age and the gaps of the messages.
+  TopicStatistics stats;
+  const uint64_t stamp =
+    std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count() - 2;
+  uint64_t seq = 0;
+  for (int i = 0; i < 100; ++i)
+  {
+    stats.Update("pub", stamp, seq);
+    seq += (i % 5 == 4) ? 2 : 1;
+  }
+  sub.SetTopicStats("@@/foo", stats);
+
+  msg.Clear();
+  pub.FillMessage(msg);
+  aggregator.AddMetrics(msg, start + std::chrono::seconds(3));
+  msg.Clear();
+  sub.FillMessage(msg);
+  aggregator.AddMetrics(msg, start + std::chrono::seconds(3));
+
+  topics = aggregator.Topics(start + std::chrono::seconds(3));
+  ASSERT_EQ(1u, topics.size());
+  EXPECT_DOUBLE_EQ(100.0, topics[0].sentMsgsPerSec);
+  EXPECT_DOUBLE_EQ(75.0, topics[0].receivedMsgsPerSec);
+
+  // 30 queue drops and 19 gaps in 2 seconds.
+  EXPECT_EQ(19u, stats.DroppedMsgCount());
+  EXPECT_DOUBLE_EQ(24.5, topics[0].droppedMsgsPerSec);
+  EXPECT_DOUBLE_EQ(24.5 / 99.5, topics[0].dropRate);
+  EXPECT_EQ(stats.AgeHistogram().Count(), topics[0].latencyCount);
+  EXPECT_DOUBLE_EQ(stats.AgeHistogram().Percentile(50),
+    topics[0].latencyP50);
+  EXPECT_DOUBLE_EQ(stats.AgeHistogram().Percentile(99),
+    topics[0].latencyP99);
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that the processes that stop reporting are forgotten, and
+/// that the messages without a process are ignored.
+TEST(StatsAggregatorTest, Expiration)
+{
+  StatsAggregator aggregator;
+  const auto start = std::chrono::steady_clock::now();
+
+  TransportMetrics anonymous;
+  anonymous.Add("@@/foo", TransportMetrics::SENT_MSGS);
+  msgs::Metric msg;
+  anonymous.FillMessage(msg);
+  aggregator.AddMetrics(msg, start);
+  EXPECT_EQ(0u, aggregator.ProcessCount());
+  EXPECT_TRUE(aggregator.Topics(start).empty());
+
+  TransportMetrics metrics;
+  metrics.SetProcess("a", 100);
+  metrics.Add("@@/foo", TransportMetrics::SENT_MSGS);
+  msg.Clear();
+  metrics.FillMessage(msg);
+  aggregator.AddMetrics(msg, start);
+  EXPECT_EQ(1u, aggregator.ProcessCount());
+  EXPECT_EQ(1u, aggregator.Topics(start + std::chrono::milliseconds(300))
+    .size());
+  EXPECT_TRUE(aggregator.Topics(start + std::chrono::milliseconds(301))
+    .empty());
+  EXPECT_EQ(0u, aggregator.ProcessCount());
+}
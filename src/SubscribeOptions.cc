@@ -16,6 +16,7 @@
 */
 
 #include <cstdint>
+#include <memory>
 
 #include "gz/transport/Helpers.hh"
 #include "gz/transport/SubscribeOptions.hh"
@@ -36,6 +37,17 @@ SubscribeOptions::SubscribeOptions(const SubscribeOptions &_otherSubscribeOpts)
   : dataPtr(new SubscribeOptionsPrivate())
 {
   this->SetMsgsPerSec(_otherSubscribeOpts.MsgsPerSec());
+  this->SetQueueDepth(_otherSubscribeOpts.QueueDepth());
+  this->SetQueuePolicy(_otherSubscribeOpts.QueuePolicy());
+  this->SetAdaptiveQueue(_otherSubscribeOpts.AdaptiveQueue());
+  this->SetConflate(_otherSubscribeOpts.Conflate());
+  this->SetAsyncCallbacks(_otherSubscribeOpts.AsyncCallbacks());
+  this->SetArenaAllocation(_otherSubscribeOpts.ArenaAllocation());
+  this->SetReuseMessage(_otherSubscribeOpts.ReuseMessage());
+  this->SetFilter(_otherSubscribeOpts.Filter());
+  this->SetCallbackExecutor(_otherSubscribeOpts.CallbackExecutor());
+  this->SetFragmentCallback(_otherSubscribeOpts.FragmentCallback());
+  this->SetTap(_otherSubscribeOpts.Tap());
 }
 
 //////////////////////////////////////////////////
@@ -60,3 +72,137 @@ void SubscribeOptions::SetMsgsPerSec(const uint64_t _newMsgsPerSec)
 {
   this->dataPtr->msgsPerSec = _newMsgsPerSec;
 }
+
+//////////////////////////////////////////////////
+void SubscribeOptions::SetQueueDepth(const uint64_t _depth)
+{
+  this->dataPtr->queueDepth = _depth;
+}
+
+//////////////////////////////////////////////////
+uint64_t SubscribeOptions::QueueDepth() const
+{
+  return this->dataPtr->queueDepth;
+}
+
+//////////////////////////////////////////////////
+void SubscribeOptions::SetQueuePolicy(const QueuePolicy_t _policy)
+{
+  this->dataPtr->queuePolicy = _policy;
+}
+
+//////////////////////////////////////////////////
+QueuePolicy_t SubscribeOptions::QueuePolicy() const
+{
+  return this->dataPtr->queuePolicy;
+}
+
+//////////////////////////////////////////////////
+void SubscribeOptions::SetAdaptiveQueue(const bool _adaptive)
+{
+  this->dataPtr->adaptiveQueue = _adaptive;
+}
+
+//////////////////////////////////////////////////
+bool SubscribeOptions::AdaptiveQueue() const
+{
+  return this->dataPtr->adaptiveQueue;
+}
+
+//////////////////////////////////////////////////
+void SubscribeOptions::SetConflate(const bool _conflate)
+{
+  this->dataPtr->conflate = _conflate;
+}
+
+//////////////////////////////////////////////////
+bool SubscribeOptions::Conflate() const
+{
+  return this->dataPtr->conflate;
+}
+
+//////////////////////////////////////////////////
+void SubscribeOptions::SetAsyncCallbacks(const bool _async)
+{
+  this->dataPtr->asyncCallbacks = _async;
+}
+
+//////////////////////////////////////////////////
+bool SubscribeOptions::AsyncCallbacks() const
+{
+  return this->dataPtr->asyncCallbacks;
+}
+
+//////////////////////////////////////////////////
+void SubscribeOptions::SetArenaAllocation(const bool _arena)
+{
+  this->dataPtr->arenaAllocation = _arena;
+}
+
+//////////////////////////////////////////////////
+bool SubscribeOptions::ArenaAllocation() const
+{
+  return this->dataPtr->arenaAllocation;
+}
+
+//////////////////////////////////////////////////
+void SubscribeOptions::SetReuseMessage(const bool _reuse)
+{
+  this->dataPtr->reuseMessage = _reuse;
+}
+
+//////////////////////////////////////////////////
+bool SubscribeOptions::ReuseMessage() const
+{
+  return this->dataPtr->reuseMessage;
+}
+
+//////////////////////////////////////////////////
+void SubscribeOptions::SetFilter(const MessageFilter &_filter)
+{
+  this->dataPtr->filter = _filter;
+}
+
+//////////////////////////////////////////////////
+const MessageFilter &SubscribeOptions::Filter() const
+{
+  return this->dataPtr->filter;
+}
+
+//////////////////////////////////////////////////
+void SubscribeOptions::SetCallbackExecutor(
+  const std::shared_ptr<Executor> &_executor)
+{
+  this->dataPtr->executor = _executor;
+}
+
+//////////////////////////////////////////////////
+const std::shared_ptr<Executor> &SubscribeOptions::CallbackExecutor() const
+{
+  return this->dataPtr->executor;
+}
+
+//////////////////////////////////////////////////
+void SubscribeOptions::SetFragmentCallback(
+  const transport::FragmentCallback &_callback)
+{
+  this->dataPtr->fragmentCallback = _callback;
+}
+
+//////////////////////////////////////////////////
+const transport::FragmentCallback &SubscribeOptions::FragmentCallback() const
+{
+  return this->dataPtr->fragmentCallback;
+}
+
+//////////////////////////////////////////////////
+void SubscribeOptions::SetTap(const bool _tap)
+{
+  this->dataPtr->tap = _tap;
+}
+
+//////////////////////////////////////////////////
+bool SubscribeOptions::Tap() const
+{
+  return this->dataPtr->tap;
+}
@@ -19,8 +19,12 @@
 #define GZ_TRANSPORT_SUBSCRIBEOPTIONSPRIVATE_HH_
 
 #include <cstdint>
+#include <memory>
 
+#include "gz/transport/Executor.hh"
 #include "gz/transport/Helpers.hh"
+#include "gz/transport/MessageFilter.hh"
+#include "gz/transport/SubscribeOptions.hh"
 
 namespace gz
 {
@@ -41,6 +45,39 @@ namespace gz
 
       /// \brief Default message subscription rate.
       public: uint64_t msgsPerSec = kUnthrottled;
+
+      /// \brief Maximum number of pending intra-process messages.
+      public: uint64_t queueDepth = 0;
+
+      /// \brief Policy applied when the intra-process queue is full.
+      public: QueuePolicy_t queuePolicy = QueuePolicy_t::DROP_OLDEST;
+
+      /// \brief Size the intra-process queue from the load.
+      public: bool adaptiveQueue = false;
+
+      /// \brief Only deliver the newest pending message.
+      public: bool conflate = false;
+
+      /// \brief Run the remote callbacks on the dispatch threads.
+      public: bool asyncCallbacks = false;
+
+      /// \brief Deserialize the remote messages on a protobuf arena.
+      public: bool arenaAllocation = false;
+
+      /// \brief Recycle the messages received from other processes.
+      public: bool reuseMessage = false;
+
+      /// \brief Filter on the content of the messages.
+      public: MessageFilter filter;
+
+      /// \brief Executor running the callbacks, or nullptr.
+      public: std::shared_ptr<Executor> executor;
+
+      /// \brief Callback receiving the fragments of the messages.
+      public: transport::FragmentCallback fragmentCallback;
+
+      /// \brief Tap the messages published within the process.
+      public: bool tap = false;
     };
     }
   }
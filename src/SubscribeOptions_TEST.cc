@@ -15,7 +15,12 @@
  *
 */
 
+#include <cstddef>
+#include <memory>
+
+#include "gz/transport/Executor.hh"
 #include "gz/transport/Helpers.hh"
+#include "gz/transport/MessageInfo.hh"
 #include "gz/transport/SubscribeOptions.hh"
 #include "gtest/gtest.h"
 
@@ -29,8 +34,34 @@ TEST(SubscribeOptionsTest, copyConstructor)
   SubscribeOptions opts1;
   opts1.SetMsgsPerSec(2u);
   EXPECT_EQ(opts1.MsgsPerSec(), 2u);
+  opts1.SetQueueDepth(5u);
+  opts1.SetQueuePolicy(QueuePolicy_t::BLOCK_PUBLISHER);
+  opts1.SetAdaptiveQueue(true);
+  opts1.SetConflate(true);
+  opts1.SetAsyncCallbacks(true);
+  opts1.SetArenaAllocation(true);
+  opts1.SetReuseMessage(true);
+  MessageFilter filter;
+  EXPECT_TRUE(filter.AddCondition("data", "1"));
+  opts1.SetFilter(filter);
+  auto executor = std::make_shared<Executor>();
+  opts1.SetCallbackExecutor(executor);
+  opts1.SetFragmentCallback([](const char *, const size_t, const size_t,
+    const size_t, const MessageInfo &){});
+  opts1.SetTap(true);
   SubscribeOptions opts2(opts1);
   EXPECT_EQ(opts2.MsgsPerSec(), opts1.MsgsPerSec());
+  EXPECT_EQ(opts2.QueueDepth(), 5u);
+  EXPECT_EQ(opts2.QueuePolicy(), QueuePolicy_t::BLOCK_PUBLISHER);
+  EXPECT_TRUE(opts2.AdaptiveQueue());
+  EXPECT_TRUE(opts2.Conflate());
+  EXPECT_TRUE(opts2.AsyncCallbacks());
+  EXPECT_TRUE(opts2.ArenaAllocation());
+  EXPECT_TRUE(opts2.ReuseMessage());
+  EXPECT_EQ(opts2.Filter(), filter);
+  EXPECT_EQ(opts2.CallbackExecutor(), executor);
+  EXPECT_TRUE(opts2.FragmentCallback());
+  EXPECT_TRUE(opts2.Tap());
 }
 
 //////////////////////////////////////////////////
@@ -42,6 +73,69 @@ TEST(SubscribeOptionsTest, accessors)
   EXPECT_EQ(opts.MsgsPerSec(), kUnthrottled);
   opts.SetMsgsPerSec(3u);
   EXPECT_EQ(opts.MsgsPerSec(), 3u);
+
+  // Intra-process queue.
+  EXPECT_EQ(opts.QueueDepth(), 0u);
+  EXPECT_EQ(opts.QueuePolicy(), QueuePolicy_t::DROP_OLDEST);
+  opts.SetQueueDepth(10u);
+  EXPECT_EQ(opts.QueueDepth(), 10u);
+  opts.SetQueuePolicy(QueuePolicy_t::DROP_NEWEST);
+  EXPECT_EQ(opts.QueuePolicy(), QueuePolicy_t::DROP_NEWEST);
+  EXPECT_FALSE(opts.AdaptiveQueue());
+  opts.SetAdaptiveQueue(true);
+  EXPECT_TRUE(opts.AdaptiveQueue());
+
+  // Conflate.
+  EXPECT_FALSE(opts.Conflate());
+  opts.SetConflate(true);
+  EXPECT_TRUE(opts.Conflate());
+
+  // Asynchronous callbacks.
+  EXPECT_FALSE(opts.AsyncCallbacks());
+  opts.SetAsyncCallbacks(true);
+  EXPECT_TRUE(opts.AsyncCallbacks());
+
+  // Arena allocation.
+  EXPECT_FALSE(opts.ArenaAllocation());
+  opts.SetArenaAllocation(true);
+  EXPECT_TRUE(opts.ArenaAllocation());
+
+  // Message recycling.
+  EXPECT_FALSE(opts.ReuseMessage());
+  opts.SetReuseMessage(true);
+  EXPECT_TRUE(opts.ReuseMessage());
+
+  // Filter.
+  EXPECT_TRUE(opts.Filter().Empty());
+  MessageFilter filter;
+  EXPECT_TRUE(filter.AddCondition("header.stamp.sec", "1"));
+  opts.SetFilter(filter);
+  EXPECT_EQ(opts.Filter().ToString(), "header.stamp.sec=1");
+
+  // Callback executor.
+  EXPECT_EQ(opts.CallbackExecutor(), nullptr);
+  auto executor = std::make_shared<Executor>();
+  opts.SetCallbackExecutor(executor);
+  EXPECT_EQ(opts.CallbackExecutor(), executor);
+
+  // Fragment callback.
+  EXPECT_FALSE(opts.FragmentCallback());
+  std::size_t total = 0;
+  opts.SetFragmentCallback([&total](const char *, const size_t,
+    const size_t, const size_t _total, const MessageInfo &)
+  {
+    total = _total;
+  });
+  ASSERT_TRUE(opts.FragmentCallback());
+  opts.FragmentCallback()(nullptr, 0, 0, 10, MessageInfo());
+  EXPECT_EQ(10u, total);
+  opts.SetFragmentCallback(nullptr);
+  EXPECT_FALSE(opts.FragmentCallback());
+
+  // Tap.
+  EXPECT_FALSE(opts.Tap());
+  opts.SetTap(true);
+  EXPECT_TRUE(opts.Tap());
 }
 
 //////////////////////////////////////////////////
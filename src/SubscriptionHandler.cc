@@ -15,14 +15,90 @@
  *
 */
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <memory>
+#include <mutex>
+
 #include "gz/transport/SubscriptionHandler.hh"
 
+#include "QueueSizer.hh"
+
 namespace gz
 {
   namespace transport
   {
     inline namespace GZ_TRANSPORT_VERSION_NAMESPACE
     {
+    /// \internal
+    /// \brief Private data for the SubscriptionHandlerBase class.
+    class SubscriptionHandlerBasePrivate
+    {
+      /// \brief Constructor.
+      /// \param[in] _opts Subscription options.
+      public: explicit SubscriptionHandlerBasePrivate(
+        const SubscribeOptions &_opts)
+        : msgsPerSec(_opts.MsgsPerSec()),
+          queueDepth(_opts.QueueDepth()),
+          queuePolicy(_opts.QueuePolicy())
+      {
+      }
+
+      /// \brief Minimum period between two callbacks (ns), 0 if the
+      /// subscription isn't throttled, see UpdateOptions().
+      public: std::atomic<double> periodNs{0.0};
+
+      /// \brief Maximum rate of the callbacks, see UpdateOptions().
+      public: std::atomic<uint64_t> msgsPerSec;
+
+      /// \brief Depth of the intra-process queue, see UpdateOptions().
+      public: std::atomic<uint64_t> queueDepth;
+
+      /// \brief Policy of the intra-process queue, see UpdateOptions().
+      public: std::atomic<QueuePolicy_t> queuePolicy;
+
+      /// \brief False once the handler has been disabled.
+      public: std::atomic<bool> enabled{true};
+
+      /// \brief Protects the queue counters below. Only used when the queue
+      /// is bounded.
+      public: std::mutex queueMutex;
+
+      /// \brief Signaled when a queue slot is released or the handler is
+      /// disabled, used by QueuePolicy_t::BLOCK_PUBLISHER.
+      public: std::condition_variable queueCv;
+
+      /// \brief Sequence number of the next queued publication.
+      public: uint64_t queueNextSeq = 0;
+
+      /// \brief Sequence number following the last released publication.
+      public: uint64_t queueReleasedSeq = 0;
+
+      /// \brief Publications with a lower sequence number were dropped.
+      public: uint64_t queueMinSeq = 0;
+
+      /// \brief Number of dropped publications.
+      public: std::atomic<uint64_t> queueDropped{0};
+
+      /// \brief Sizes an adaptive queue, null otherwise. Protected by
+      /// queueMutex, except QueueSizer::AddServiceTime().
+      public: std::unique_ptr<QueueSizer> queueSizer;
+
+      /// \brief Depth of an adaptive queue for the last publication.
+      public: std::atomic<uint64_t> queueSizerDepth{0};
+
+      /// \brief Number of callbacks accounted.
+      public: std::atomic<uint64_t> cbCount{0};
+
+      /// \brief Total duration (ns) of the callbacks accounted.
+      public: std::atomic<int64_t> cbDuration{0};
+
+      /// \brief Longest callback (ns).
+      public: std::atomic<int64_t> cbMaxDuration{0};
+    };
+
     /////////////////////////////////////////////////
     SubscriptionHandlerBase::SubscriptionHandlerBase(
         const std::string &_nUuid,
@@ -31,10 +107,20 @@ namespace gz
         periodNs(0.0),
         hUuid(Uuid().ToString()),
         lastCbTimestamp(std::chrono::seconds{0}),
-        nUuid(_nUuid)
+        nUuid(_nUuid),
+        dataPtr(std::make_shared<SubscriptionHandlerBasePrivate>(_opts))
     {
       if (this->opts.Throttled())
         this->periodNs = 1e9 / this->opts.MsgsPerSec();
+      this->dataPtr->periodNs = this->periodNs;
+
+      // A conflated subscription already has a queue of depth one.
+      if (this->opts.AdaptiveQueue() && !this->opts.Conflate())
+      {
+        this->dataPtr->queueSizer = std::make_unique<QueueSizer>(
+          QueueBudget::Global(), this->opts.QueueDepth());
+        this->dataPtr->queueSizerDepth = this->dataPtr->queueSizer->Depth();
+      }
     }
 
     /////////////////////////////////////////////////
@@ -49,10 +135,305 @@ namespace gz
       return this->hUuid;
     }
 
+    /////////////////////////////////////////////////
+    bool SubscriptionHandlerBase::Enabled() const
+    {
+      return this->dataPtr->enabled;
+    }
+
+    /////////////////////////////////////////////////
+    void SubscriptionHandlerBase::Disable()
+    {
+      {
+        std::lock_guard<std::mutex> lk(this->dataPtr->queueMutex);
+        this->dataPtr->enabled = false;
+      }
+      // Wake up publishers blocked on a full queue.
+      this->dataPtr->queueCv.notify_all();
+    }
+
+    /////////////////////////////////////////////////
+    bool SubscriptionHandlerBase::ReserveQueueSlot(uint64_t &_seq,
+        uint64_t &_dropped, const std::size_t _size, const bool _wait)
+    {
+      _seq = 0;
+      _dropped = 0;
+
+      // A conflated subscription only keeps the newest message.
+      uint64_t depth =
+        this->opts.Conflate() ? 1u : this->dataPtr->queueDepth.load();
+      if (depth == 0 && !this->dataPtr->queueSizer)
+        return true;
+
+      QueuePolicy_t policy = this->opts.Conflate() ?
+        QueuePolicy_t::DROP_OLDEST : this->dataPtr->queuePolicy.load();
+
+      // A caller that can't wait discards the new publication.
+      if (!_wait && policy == QueuePolicy_t::BLOCK_PUBLISHER)
+        policy = QueuePolicy_t::DROP_NEWEST;
+
+      std::unique_lock<std::mutex> lk(this->dataPtr->queueMutex);
+
+      // Sequence number of the oldest publication still pending.
+      auto oldest = [this]()
+      {
+        return std::max(this->dataPtr->queueReleasedSeq,
+                        this->dataPtr->queueMinSeq);
+      };
+
+      if (this->dataPtr->queueSizer)
+      {
+        depth = this->dataPtr->queueSizer->Arrival(_size,
+          this->dataPtr->queueNextSeq - oldest());
+        this->dataPtr->queueSizerDepth.store(depth, std::memory_order_relaxed);
+      }
+
+      if (this->dataPtr->queueNextSeq - oldest() >= depth)
+      {
+        switch (policy)
+        {
+          case QueuePolicy_t::DROP_NEWEST:
+            _dropped = 1;
+            ++this->dataPtr->queueDropped;
+            return false;
+
+          case QueuePolicy_t::BLOCK_PUBLISHER:
+            // The depth or the policy may be updated while waiting.
+            this->dataPtr->queueCv.wait(lk, [&]
+            {
+              if (!this->dataPtr->queueSizer && !this->opts.Conflate())
+              {
+                depth = this->dataPtr->queueDepth;
+                if (depth == 0 ||
+                    this->dataPtr->queuePolicy !=
+                      QueuePolicy_t::BLOCK_PUBLISHER)
+                {
+                  return true;
+                }
+              }
+              return this->dataPtr->queueNextSeq - oldest() < depth ||
+                     !this->dataPtr->enabled;
+            });
+            if (!this->dataPtr->enabled)
+              return false;
+            break;
+
+          case QueuePolicy_t::DROP_OLDEST:
+          default:
+          {
+            // Keep the newest depth - 1 publications plus this one.
+            const uint64_t newMin = this->dataPtr->queueNextSeq - depth + 1;
+            _dropped = newMin - oldest();
+            this->dataPtr->queueDropped += _dropped;
+            this->dataPtr->queueMinSeq = newMin;
+            break;
+          }
+        }
+      }
+
+      _seq = this->dataPtr->queueNextSeq++;
+      return true;
+    }
+
+    /////////////////////////////////////////////////
+    bool SubscriptionHandlerBase::ReleaseQueueSlot(const uint64_t _seq)
+    {
+      if (this->dataPtr->queueDepth == 0 && !this->opts.Conflate() &&
+          !this->dataPtr->queueSizer)
+      {
+        return true;
+      }
+
+      bool deliver;
+      {
+        std::lock_guard<std::mutex> lk(this->dataPtr->queueMutex);
+
+        // The publications of different priorities are dispatched out of
+        // order.
+        this->dataPtr->queueReleasedSeq =
+          std::max(this->dataPtr->queueReleasedSeq, _seq + 1);
+        deliver = _seq >= this->dataPtr->queueMinSeq;
+      }
+
+      if (this->dataPtr->queuePolicy == QueuePolicy_t::BLOCK_PUBLISHER &&
+          !this->opts.Conflate())
+      {
+        this->dataPtr->queueCv.notify_all();
+      }
+
+      return deliver;
+    }
+
+    /////////////////////////////////////////////////
+    void SubscriptionHandlerBase::DropQueueSlot(const uint64_t _seq)
+    {
+      this->ReleaseQueueSlot(_seq);
+      ++this->dataPtr->queueDropped;
+    }
+
+    /////////////////////////////////////////////////
+    bool SubscriptionHandlerBase::BlocksPublisher() const
+    {
+      return this->dataPtr->queuePolicy == QueuePolicy_t::BLOCK_PUBLISHER &&
+        !this->opts.Conflate();
+    }
+
+    /////////////////////////////////////////////////
+    uint64_t SubscriptionHandlerBase::QueueDroppedMsgCount() const
+    {
+      return this->dataPtr->queueDropped;
+    }
+
+    /////////////////////////////////////////////////
+    bool SubscriptionHandlerBase::AdaptiveQueue() const
+    {
+      return this->dataPtr->queueSizer != nullptr;
+    }
+
+    /////////////////////////////////////////////////
+    void SubscriptionHandlerBase::AddServiceTime(
+        const std::chrono::nanoseconds _duration)
+    {
+      if (this->dataPtr->queueSizer)
+        this->dataPtr->queueSizer->AddServiceTime(_duration);
+    }
+
+    /////////////////////////////////////////////////
+    uint64_t SubscriptionHandlerBase::CurrentQueueDepth() const
+    {
+      if (this->opts.Conflate())
+        return 1u;
+      if (this->dataPtr->queueSizer)
+        return this->dataPtr->queueSizerDepth.load(std::memory_order_relaxed);
+      return this->dataPtr->queueDepth;
+    }
+
+    /////////////////////////////////////////////////
+    bool SubscriptionHandlerBase::Conflate() const
+    {
+      return this->opts.Conflate();
+    }
+
+    /////////////////////////////////////////////////
+    bool SubscriptionHandlerBase::AsyncCallbacks() const
+    {
+      return this->opts.AsyncCallbacks() || this->opts.CallbackExecutor();
+    }
+
+    /////////////////////////////////////////////////
+    const std::shared_ptr<Executor> &
+        SubscriptionHandlerBase::CallbackExecutor() const
+    {
+      return this->opts.CallbackExecutor();
+    }
+
+    /////////////////////////////////////////////////
+    const transport::FragmentCallback &
+        SubscriptionHandlerBase::FragmentCallback() const
+    {
+      return this->opts.FragmentCallback();
+    }
+
+    /////////////////////////////////////////////////
+    void SubscriptionHandlerBase::SetDefaultExecutor(
+      const std::shared_ptr<Executor> &_executor)
+    {
+      if (!this->opts.CallbackExecutor())
+        this->opts.SetCallbackExecutor(_executor);
+    }
+
+    /////////////////////////////////////////////////
+    uint64_t SubscriptionHandlerBase::MsgsPerSec() const
+    {
+      return this->dataPtr->msgsPerSec;
+    }
+
+    /////////////////////////////////////////////////
+    void SubscriptionHandlerBase::UpdateOptions(const SubscribeOptions &_opts)
+    {
+      this->dataPtr->msgsPerSec = _opts.MsgsPerSec();
+      this->periodNs = _opts.Throttled() ? 1e9 / _opts.MsgsPerSec() : 0.0;
+      this->dataPtr->periodNs = this->periodNs;
+
+      {
+        std::lock_guard<std::mutex> lk(this->dataPtr->queueMutex);
+        this->dataPtr->queueDepth = _opts.QueueDepth();
+        this->dataPtr->queuePolicy = _opts.QueuePolicy();
+      }
+      // The publishers blocked on a full queue check it again.
+      this->dataPtr->queueCv.notify_all();
+    }
+
+    /////////////////////////////////////////////////
+    bool SubscriptionHandlerBase::CheckThrottling() const
+    {
+      if (this->dataPtr->periodNs <= 0.0)
+        return true;
+
+      // Elapsed time since the last callback execution.
+      auto elapsed = std::chrono::steady_clock::now() - this->lastCbTimestamp;
+
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        elapsed).count() >= this->dataPtr->periodNs;
+    }
+
+    /////////////////////////////////////////////////
+    bool SubscriptionHandlerBase::CheckFilter(const char *_msgData,
+        const std::size_t _size, const std::string &_msgType) const
+    {
+      const MessageFilter &filter = this->opts.Filter();
+      return filter.Empty() || filter.Match(_msgData, _size, _msgType);
+    }
+
+    /////////////////////////////////////////////////
+    bool SubscriptionHandlerBase::CheckFilter(const ProtoMsg &_msg) const
+    {
+      const MessageFilter &filter = this->opts.Filter();
+      return filter.Empty() || filter.Match(_msg);
+    }
+
+    /////////////////////////////////////////////////
+    void SubscriptionHandlerBase::AddCallbackDuration(
+        const std::chrono::nanoseconds _duration)
+    {
+      const int64_t ns = _duration.count();
+      this->dataPtr->cbCount.fetch_add(1, std::memory_order_relaxed);
+      this->dataPtr->cbDuration.fetch_add(ns, std::memory_order_relaxed);
+
+      // The callbacks of a handler can run concurrently on several threads.
+      int64_t max =
+        this->dataPtr->cbMaxDuration.load(std::memory_order_relaxed);
+      while (ns > max && !this->dataPtr->cbMaxDuration.compare_exchange_weak(
+               max, ns, std::memory_order_relaxed))
+      {
+      }
+    }
+
+    /////////////////////////////////////////////////
+    uint64_t SubscriptionHandlerBase::CallbackCount() const
+    {
+      return this->dataPtr->cbCount.load(std::memory_order_relaxed);
+    }
+
+    /////////////////////////////////////////////////
+    std::chrono::nanoseconds SubscriptionHandlerBase::CallbackDuration() const
+    {
+      return std::chrono::nanoseconds(
+        this->dataPtr->cbDuration.load(std::memory_order_relaxed));
+    }
+
+    /////////////////////////////////////////////////
+    std::chrono::nanoseconds
+      SubscriptionHandlerBase::MaxCallbackDuration() const
+    {
+      return std::chrono::nanoseconds(
+        this->dataPtr->cbMaxDuration.load(std::memory_order_relaxed));
+    }
+
     /////////////////////////////////////////////////
     bool SubscriptionHandlerBase::UpdateThrottling()
     {
-      if (!this->opts.Throttled())
+      if (this->dataPtr->periodNs <= 0.0)
         return true;
 
       Timestamp now = std::chrono::steady_clock::now();
@@ -61,7 +442,7 @@ namespace gz
       auto elapsed = now - this->lastCbTimestamp;
 
       if (std::chrono::duration_cast<std::chrono::nanoseconds>(
-            elapsed).count() < this->periodNs)
+            elapsed).count() < this->dataPtr->periodNs)
       {
         return false;
       }
@@ -77,7 +458,52 @@ namespace gz
         const SubscribeOptions &_opts)
       : SubscriptionHandlerBase(_nUuid, _opts)
     {
-      // Do nothing
+      if (_opts.ArenaAllocation())
+        this->arenaPool.reset(new ArenaPool());
+    }
+
+    /////////////////////////////////////////////////
+    bool ISubscriptionHandler::RunLocalCallback(
+        const std::shared_ptr<const ProtoMsg> &_msg,
+        const MessageInfo &_info)
+    {
+      if (!_msg)
+      {
+        std::cerr << "ISubscriptionHandler::RunLocalCallback() "
+                  << "error: NULL message" << std::endl;
+        return false;
+      }
+
+      // Checked, the handlers might be derived by the users.
+      auto *shared = dynamic_cast<SharedSubscriptionHandler *>(this);
+      if (shared)
+        return shared->RunSharedCallback(_msg, _info);
+
+      return this->RunLocalCallback(*_msg, _info);
+    }
+
+    /////////////////////////////////////////////////
+    const std::shared_ptr<ProtoMsg> ISubscriptionHandler::CreateMsg(
+        const char *_data,
+        const std::size_t _size,
+        const std::string &_type) const
+    {
+      return this->CreateMsg(std::string(_data, _size), _type);
+    }
+
+    /////////////////////////////////////////////////
+    bool ISubscriptionHandler::ParseAndRunLocalCallback(
+        const char *_data,
+        const std::size_t _size,
+        const MessageInfo &_info)
+    {
+      const std::shared_ptr<ProtoMsg> msg =
+        this->CreateMsg(_data, _size, _info.Type());
+      if (!msg)
+        return false;
+
+      return this->RunLocalCallback(
+        std::shared_ptr<const ProtoMsg>(msg), _info);
     }
 
     /////////////////////////////////////////////////
@@ -92,6 +518,8 @@ namespace gz
       public: std::string msgType;
 
       public: RawCallback callback;
+
+      public: SharedRawCallback sharedCallback;
     };
 
     /////////////////////////////////////////////////
@@ -117,13 +545,53 @@ namespace gz
       pimpl->callback = _callback;
     }
 
+    /////////////////////////////////////////////////
+    void RawSubscriptionHandler::SetCallback(
+        const SharedRawCallback &_callback)
+    {
+      pimpl->sharedCallback = _callback;
+    }
+
     /////////////////////////////////////////////////
     bool RawSubscriptionHandler::RunRawCallback(
         const char *_msgData, const size_t _size,
         const MessageInfo &_info)
     {
       // Make sure we have a callback
-      if (!this->pimpl->callback)
+      if (!this->pimpl->callback && !this->pimpl->sharedCallback)
+      {
+        std::cerr << "RawSubscriptionHandler::RunRawCallback() "
+                  << "error: Callback is NULL" << std::endl;
+        return false;
+      }
+
+      // Check if we need to throttle
+      if (!this->UpdateThrottling())
+        return true;
+
+      // Trigger the callback
+      if (this->pimpl->sharedCallback)
+      {
+        // The data doesn't outlive this call, share a copy of it.
+        std::shared_ptr<char> copy(new char[_size],
+          std::default_delete<char[]>());
+        memcpy(copy.get(), _msgData, _size);
+        this->pimpl->sharedCallback(copy, _size, _info);
+      }
+      else
+      {
+        this->pimpl->callback(_msgData, _size, _info);
+      }
+      return true;
+    }
+
+    /////////////////////////////////////////////////
+    bool RawSubscriptionHandler::RunRawCallback(
+        const std::shared_ptr<const char> &_msgData, const size_t _size,
+        const MessageInfo &_info)
+    {
+      // Make sure we have a callback
+      if (!this->pimpl->callback && !this->pimpl->sharedCallback)
       {
         std::cerr << "RawSubscriptionHandler::RunRawCallback() "
                   << "error: Callback is NULL" << std::endl;
@@ -135,7 +603,10 @@ namespace gz
         return true;
 
       // Trigger the callback
-      this->pimpl->callback(_msgData, _size, _info);
+      if (this->pimpl->sharedCallback)
+        this->pimpl->sharedCallback(_msgData, _size, _info);
+      else
+        this->pimpl->callback(_msgData.get(), _size, _info);
       return true;
     }
 
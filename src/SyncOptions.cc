@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+
+#include "gz/transport/SubscribeOptions.hh"
+#include "gz/transport/SyncOptions.hh"
+
+using namespace gz;
+using namespace transport;
+
+namespace gz
+{
+  namespace transport
+  {
+    inline namespace GZ_TRANSPORT_VERSION_NAMESPACE
+    {
+    /// \internal
+    /// \brief Private data for SyncOptions class.
+    class SyncOptionsPrivate
+    {
+      /// \brief Policy used to match the messages.
+      public: SyncPolicy_t policy = SyncPolicy_t::EXACT;
+
+      /// \brief Maximum number of messages waiting per topic.
+      public: std::size_t queueSize = 10;
+
+      /// \brief Maximum difference between the stamps of approximate
+      /// matches.
+      public: std::chrono::nanoseconds maxInterval =
+        std::chrono::milliseconds(10);
+
+      /// \brief Options of the subscription to each topic.
+      public: std::unique_ptr<SubscribeOptions> subscribeOpts =
+        std::make_unique<SubscribeOptions>();
+    };
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+SyncOptions::SyncOptions()
+  : dataPtr(new SyncOptionsPrivate())
+{
+}
+
+//////////////////////////////////////////////////
+SyncOptions::SyncOptions(const SyncOptions &_other)
+  : dataPtr(new SyncOptionsPrivate())
+{
+  (*this) = _other;
+}
+
+//////////////////////////////////////////////////
+SyncOptions::~SyncOptions()
+{
+}
+
+//////////////////////////////////////////////////
+SyncOptions &SyncOptions::operator=(const SyncOptions &_other)
+{
+  this->SetPolicy(_other.Policy());
+  this->SetQueueSize(_other.QueueSize());
+  this->SetMaxInterval(_other.MaxInterval());
+  this->SetSubscriptionOptions(_other.SubscriptionOptions());
+  return *this;
+}
+
+//////////////////////////////////////////////////
+void SyncOptions::SetPolicy(const SyncPolicy_t _policy)
+{
+  this->dataPtr->policy = _policy;
+}
+
+//////////////////////////////////////////////////
+SyncPolicy_t SyncOptions::Policy() const
+{
+  return this->dataPtr->policy;
+}
+
+//////////////////////////////////////////////////
+void SyncOptions::SetQueueSize(const std::size_t _size)
+{
+  this->dataPtr->queueSize = std::max<std::size_t>(_size, 1u);
+}
+
+//////////////////////////////////////////////////
+std::size_t SyncOptions::QueueSize() const
+{
+  return this->dataPtr->queueSize;
+}
+
+//////////////////////////////////////////////////
+void SyncOptions::SetMaxInterval(const std::chrono::nanoseconds &_interval)
+{
+  this->dataPtr->maxInterval =
+    std::max(_interval, std::chrono::nanoseconds::zero());
+}
+
+//////////////////////////////////////////////////
+std::chrono::nanoseconds SyncOptions::MaxInterval() const
+{
+  return this->dataPtr->maxInterval;
+}
+
+//////////////////////////////////////////////////
+void SyncOptions::SetSubscriptionOptions(const SubscribeOptions &_opts)
+{
+  if (&_opts == this->dataPtr->subscribeOpts.get())
+    return;
+  this->dataPtr->subscribeOpts = std::make_unique<SubscribeOptions>(_opts);
+}
+
+//////////////////////////////////////////////////
+const SubscribeOptions &SyncOptions::SubscriptionOptions() const
+{
+  return *this->dataPtr->subscribeOpts;
+}
@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <chrono>
+
+#include "gz/transport/SyncOptions.hh"
+#include "gtest/gtest.h"
+
+using namespace gz;
+using namespace transport;
+
+//////////////////////////////////////////////////
+/// \brief Check the default values and the accessors.
+TEST(SyncOptionsTest, Accessors)
+{
+  SyncOptions opts;
+  EXPECT_EQ(SyncPolicy_t::EXACT, opts.Policy());
+  EXPECT_EQ(10u, opts.QueueSize());
+  EXPECT_EQ(std::chrono::milliseconds(10), opts.MaxInterval());
+  EXPECT_FALSE(opts.SubscriptionOptions().AsyncCallbacks());
+
+  opts.SetPolicy(SyncPolicy_t::APPROXIMATE);
+  EXPECT_EQ(SyncPolicy_t::APPROXIMATE, opts.Policy());
+  opts.SetQueueSize(0u);
+  EXPECT_EQ(1u, opts.QueueSize());
+  opts.SetQueueSize(3u);
+  EXPECT_EQ(3u, opts.QueueSize());
+  opts.SetMaxInterval(std::chrono::milliseconds(-1));
+  EXPECT_EQ(std::chrono::nanoseconds::zero(), opts.MaxInterval());
+  opts.SetMaxInterval(std::chrono::milliseconds(5));
+  EXPECT_EQ(std::chrono::milliseconds(5), opts.MaxInterval());
+  SubscribeOptions subOpts;
+  subOpts.SetAsyncCallbacks(true);
+  opts.SetSubscriptionOptions(subOpts);
+  EXPECT_TRUE(opts.SubscriptionOptions().AsyncCallbacks());
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the copy constructor and the assignment operator.
+TEST(SyncOptionsTest, Copy)
+{
+  SyncOptions opts1;
+  opts1.SetPolicy(SyncPolicy_t::APPROXIMATE);
+  opts1.SetQueueSize(3u);
+  opts1.SetMaxInterval(std::chrono::milliseconds(5));
+  SubscribeOptions subOpts;
+  subOpts.SetAsyncCallbacks(true);
+  opts1.SetSubscriptionOptions(subOpts);
+
+  SyncOptions opts2(opts1);
+  EXPECT_EQ(SyncPolicy_t::APPROXIMATE, opts2.Policy());
+  EXPECT_EQ(3u, opts2.QueueSize());
+  EXPECT_EQ(std::chrono::milliseconds(5), opts2.MaxInterval());
+  EXPECT_TRUE(opts2.SubscriptionOptions().AsyncCallbacks());
+
+  SyncOptions opts3;
+  opts3 = opts1;
+  EXPECT_EQ(SyncPolicy_t::APPROXIMATE, opts3.Policy());
+  EXPECT_EQ(3u, opts3.QueueSize());
+  EXPECT_EQ(std::chrono::milliseconds(5), opts3.MaxInterval());
+  EXPECT_TRUE(opts3.SubscriptionOptions().AsyncCallbacks());
+}
@@ -0,0 +1,166 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gz/msgs/empty.pb.h>
+#include <gz/msgs/int32.pb.h>
+
+#include <chrono>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "gz/transport/Synchronizer.hh"
+#include "gtest/gtest.h"
+
+using namespace gz;
+using namespace transport;
+
+using Sync = Synchronizer<msgs::Int32, msgs::Empty>;
+
+//////////////////////////////////////////////////
+/// \brief Create a message with a stamp.
+/// \param[in] _ms Stamp (ms).
+/// \param[in] _data Data of the message.
+/// \return The message.
+std::shared_ptr<const msgs::Int32> int32Msg(const int64_t _ms,
+  const int _data = 0)
+{
+  auto msg = std::make_shared<msgs::Int32>();
+  msg->mutable_header()->mutable_stamp()->set_sec(_ms / 1000);
+  msg->mutable_header()->mutable_stamp()->set_nsec(
+    static_cast<int>(_ms % 1000) * 1000000);
+  msg->set_data(_data);
+  return msg;
+}
+
+//////////////////////////////////////////////////
+/// \brief Create a message with a stamp.
+/// \param[in] _ms Stamp (ms).
+/// \return The message.
+std::shared_ptr<const msgs::Empty> emptyMsg(const int64_t _ms)
+{
+  auto msg = std::make_shared<msgs::Empty>();
+  msg->mutable_header()->mutable_stamp()->set_sec(_ms / 1000);
+  msg->mutable_header()->mutable_stamp()->set_nsec(
+    static_cast<int>(_ms % 1000) * 1000000);
+  return msg;
+}
+
+//////////////////////////////////////////////////
+/// \brief Get the stamp of a message.
+/// \param[in] _msg The message.
+/// \return The stamp (ms).
+template<typename T>
+int64_t stampMs(const T &_msg)
+{
+  return _msg.header().stamp().sec() * 1000 +
+    _msg.header().stamp().nsec() / 1000000;
+}
+
+//////////////////////////////////////////////////
+/// \brief The exact policy only matches the messages with the same stamp.
+TEST(SynchronizerTest, Exact)
+{
+  std::vector<std::pair<int64_t, int64_t>> matches;
+  auto sync = std::make_shared<Sync>(SyncOptions(),
+    [&](const std::shared_ptr<const msgs::Int32> &_a,
+        const std::shared_ptr<const msgs::Empty> &_b)
+    {
+      matches.push_back({stampMs(*_a), stampMs(*_b)});
+    });
+
+  sync->Add<0>(int32Msg(1000));
+  sync->Add<0>(int32Msg(1100));
+  sync->Add<1>(emptyMsg(1050));
+  EXPECT_TRUE(matches.empty());
+
+  sync->Add<1>(emptyMsg(1100));
+  ASSERT_EQ(1u, matches.size());
+  EXPECT_EQ(1100, matches[0].first);
+  EXPECT_EQ(1100, matches[0].second);
+
+  // The messages before the match can't be matched anymore.
+  EXPECT_EQ(2u, sync->Dropped());
+  sync->Add<1>(emptyMsg(1000));
+  EXPECT_EQ(1u, matches.size());
+}
+
+//////////////////////////////////////////////////
+/// \brief The approximate policy matches the closest messages within the
+/// maximum interval, without copying them.
+TEST(SynchronizerTest, Approximate)
+{
+  SyncOptions opts;
+  opts.SetPolicy(SyncPolicy_t::APPROXIMATE);
+  opts.SetMaxInterval(std::chrono::milliseconds(10));
+
+  std::vector<std::pair<const msgs::Int32 *, int64_t>> matches;
+  auto sync = std::make_shared<Sync>(opts,
+    [&](const std::shared_ptr<const msgs::Int32> &_a,
+        const std::shared_ptr<const msgs::Empty> &_b)
+    {
+      matches.push_back({_a.get(), stampMs(*_b)});
+    });
+
+  auto a1 = int32Msg(1000, 1);
+  auto a2 = int32Msg(1033, 2);
+  auto a3 = int32Msg(1066, 3);
+  sync->Add<0>(a1);
+  sync->Add<0>(a2);
+  sync->Add<0>(a3);
+
+  // Too far from any message of the other topic.
+  sync->Add<1>(emptyMsg(1020));
+  EXPECT_TRUE(matches.empty());
+
+  sync->Add<1>(emptyMsg(1040));
+  ASSERT_EQ(1u, matches.size());
+  EXPECT_EQ(a2.get(), matches[0].first);
+  EXPECT_EQ(1040, matches[0].second);
+
+  sync->Add<1>(emptyMsg(1060));
+  ASSERT_EQ(2u, matches.size());
+  EXPECT_EQ(a3.get(), matches[1].first);
+  EXPECT_EQ(1060, matches[1].second);
+}
+
+//////////////////////////////////////////////////
+/// \brief The queues are bounded.
+TEST(SynchronizerTest, QueueSize)
+{
+  SyncOptions opts;
+  opts.SetQueueSize(2);
+
+  int matches = 0;
+  auto sync = std::make_shared<Sync>(opts,
+    [&](const std::shared_ptr<const msgs::Int32> &,
+        const std::shared_ptr<const msgs::Empty> &)
+    {
+      ++matches;
+    });
+
+  auto input = Sync::Input<0>(sync);
+  for (int i = 0; i < 5; ++i)
+    input(int32Msg(1000 + i), MessageInfo());
+  EXPECT_EQ(3u, sync->Dropped());
+
+  // The oldest messages were dropped.
+  sync->Add<1>(emptyMsg(1001));
+  EXPECT_EQ(0, matches);
+  sync->Add<1>(emptyMsg(1004));
+  EXPECT_EQ(1, matches);
+}
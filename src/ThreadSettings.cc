@@ -0,0 +1,400 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef _WIN32
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gz/transport/Helpers.hh"
+
+#include "ThreadSettings.hh"
+
+using namespace gz;
+using namespace transport;
+
+//////////////////////////////////////////////////
+/// \brief Parse a non-negative integer.
+/// \param[in] _str The string.
+/// \param[out] _value The integer.
+/// \return True if the whole string is a non-negative integer.
+static bool parseInt(const std::string &_str, int &_value)
+{
+  if (_str.empty() ||
+      _str.find_first_not_of("0123456789") != std::string::npos)
+  {
+    return false;
+  }
+
+  try
+  {
+    _value = std::stoi(_str);
+  }
+  catch (const std::out_of_range &)
+  {
+    return false;
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+/// \brief Parse a scheduling policy.
+/// \param[in] _str The policy: "other", "fifo:<priority>" or
+/// "rr:<priority>".
+/// \param[out] _settings Settings updated with the policy and priority.
+/// \return True if the policy is valid.
+static bool parsePolicy(const std::string &_str, ThreadSettings &_settings)
+{
+  if (_str == "other")
+  {
+    _settings.policy = SchedPolicy::OTHER;
+    _settings.priority = 0;
+    return true;
+  }
+
+  const auto colon = _str.find(':');
+  if (colon == std::string::npos ||
+      !parseInt(_str.substr(colon + 1), _settings.priority))
+  {
+    return false;
+  }
+
+  const std::string policy = _str.substr(0, colon);
+  if (policy == "fifo")
+    _settings.policy = SchedPolicy::FIFO;
+  else if (policy == "rr")
+    _settings.policy = SchedPolicy::RR;
+  else
+    return false;
+  return true;
+}
+
+//////////////////////////////////////////////////
+/// \brief Parse a space delimited list of <name>=<value>.
+/// \param[in] _list The list.
+/// \param[in] _parse Function parsing a value into the settings of a
+/// thread.
+/// \param[in,out] _settings Settings by thread name.
+/// \param[out] _error Description of the first invalid entry.
+/// \return True if all the entries are valid.
+template<typename F>
+static bool parseList(const std::string &_list, F _parse,
+  std::map<std::string, ThreadSettings> &_settings, std::string &_error)
+{
+  bool result = true;
+  for (const std::string &entry : split(_list, ' '))
+  {
+    if (entry.empty())
+      continue;
+
+    const auto equal = entry.find('=');
+    if (equal == std::string::npos || equal == 0)
+    {
+      if (result)
+        _error = "Invalid entry [" + entry + "]";
+      result = false;
+      continue;
+    }
+
+    const std::string name = entry.substr(0, equal);
+    ThreadSettings settings;
+    auto it = _settings.find(name);
+    if (it != _settings.end())
+      settings = it->second;
+
+    if (!_parse(entry.substr(equal + 1), settings))
+    {
+      if (result)
+        _error = "Invalid entry [" + entry + "]";
+      result = false;
+      continue;
+    }
+    _settings[name] = settings;
+  }
+  return result;
+}
+
+//////////////////////////////////////////////////
+bool ThreadSettingsTable::Parse(const std::string &_affinity,
+  const std::string &_priority, std::string &_error)
+{
+  auto affinity = [](const std::string &_value, ThreadSettings &_settings)
+  {
+    static const std::string kNuma = "numa:";
+    if (_value.compare(0, kNuma.size(), kNuma) != 0)
+      return ParseIndexList(_value, _settings.cpus);
+
+    // The CPUs of the NUMA nodes.
+    std::vector<int> nodes;
+    if (!ParseIndexList(_value.substr(kNuma.size()), nodes))
+      return false;
+
+    _settings.cpus.clear();
+    for (const int node : nodes)
+    {
+      std::vector<int> cpus;
+      if (!NumaTopology::Host().NodeCpus(node, cpus))
+        return false;
+      _settings.cpus.insert(_settings.cpus.end(), cpus.begin(), cpus.end());
+    }
+    return true;
+  };
+
+  std::string error;
+  const bool affinityOk =
+    parseList(_affinity, affinity, this->settings, _error);
+  const bool priorityOk =
+    parseList(_priority, parsePolicy, this->settings, error);
+  if (affinityOk && !priorityOk)
+    _error = error;
+  return affinityOk && priorityOk;
+}
+
+//////////////////////////////////////////////////
+bool ThreadSettingsTable::Find(const std::string &_name,
+  ThreadSettings &_settings) const
+{
+  auto it = this->settings.find(_name);
+  if (it == this->settings.end())
+    it = this->settings.find("*");
+  if (it == this->settings.end())
+    return false;
+
+  _settings = it->second;
+  return true;
+}
+
+//////////////////////////////////////////////////
+const ThreadSettingsTable &ThreadSettingsTable::FromEnv()
+{
+  static const ThreadSettingsTable table = []()
+  {
+    std::string affinity;
+    std::string priority;
+    env("GZ_TRANSPORT_THREAD_AFFINITY", affinity);
+    env("GZ_TRANSPORT_THREAD_PRIORITY", priority);
+
+    ThreadSettingsTable result;
+    std::string error;
+    if (!result.Parse(affinity, priority, error))
+    {
+      std::cerr << "Invalid GZ_TRANSPORT_THREAD_AFFINITY or "
+                << "GZ_TRANSPORT_THREAD_PRIORITY: " << error << std::endl;
+    }
+    return result;
+  }();
+  return table;
+}
+
+//////////////////////////////////////////////////
+bool NumaTopology::Load(const std::string &_root)
+{
+  this->nodes.clear();
+  this->cpuNodes.clear();
+
+  std::ifstream onlineFile(_root + "/online");
+  std::string online;
+  std::vector<int> ids;
+  if (std::getline(onlineFile, online) && ParseIndexList(online, ids))
+  {
+    for (const int id : ids)
+    {
+      std::ifstream cpuFile(_root + "/node" + std::to_string(id) +
+        "/cpulist");
+      std::string cpuList;
+      std::vector<int> cpus;
+
+      // A node without CPUs, e.g. only memory, has an empty list.
+      if (std::getline(cpuFile, cpuList) && ParseIndexList(cpuList, cpus))
+        this->nodes[id] = cpus;
+      else if (cpuFile.is_open())
+        this->nodes[id] = {};
+    }
+  }
+
+  const bool loaded = !this->nodes.empty();
+  if (!loaded)
+  {
+    std::vector<int> &cpus = this->nodes[0];
+    const unsigned int count = std::thread::hardware_concurrency();
+    for (unsigned int cpu = 0; cpu < count; ++cpu)
+      cpus.push_back(static_cast<int>(cpu));
+  }
+
+  for (const auto &node : this->nodes)
+  {
+    for (const int cpu : node.second)
+    {
+      if (static_cast<std::size_t>(cpu) >= this->cpuNodes.size())
+        this->cpuNodes.resize(cpu + 1, 0);
+      this->cpuNodes[cpu] = node.first;
+    }
+  }
+  return loaded;
+}
+
+//////////////////////////////////////////////////
+std::size_t NumaTopology::NodeCount() const
+{
+  if (this->nodes.empty())
+    return 1;
+  return static_cast<std::size_t>(this->nodes.rbegin()->first) + 1;
+}
+
+//////////////////////////////////////////////////
+bool NumaTopology::NodeCpus(const int _node, std::vector<int> &_cpus) const
+{
+  auto it = this->nodes.find(_node);
+  if (it == this->nodes.end() || it->second.empty())
+    return false;
+
+  _cpus = it->second;
+  return true;
+}
+
+//////////////////////////////////////////////////
+int NumaTopology::NodeOfCpu(const int _cpu) const
+{
+  if (_cpu < 0 || static_cast<std::size_t>(_cpu) >= this->cpuNodes.size())
+    return 0;
+  return this->cpuNodes[_cpu];
+}
+
+//////////////////////////////////////////////////
+const NumaTopology &NumaTopology::Host()
+{
+  static const NumaTopology topology = []()
+  {
+    NumaTopology result;
+    result.Load("/sys/devices/system/node");
+    return result;
+  }();
+  return topology;
+}
+
+namespace gz
+{
+  namespace transport
+  {
+    inline namespace GZ_TRANSPORT_VERSION_NAMESPACE
+    {
+    //////////////////////////////////////////////////
+    int CurrentNumaNode()
+    {
+#ifdef __linux__
+      return NumaTopology::Host().NodeOfCpu(sched_getcpu());
+#else
+      return 0;
+#endif
+    }
+
+    //////////////////////////////////////////////////
+    bool ParseIndexList(const std::string &_str, std::vector<int> &_indexes)
+    {
+      _indexes.clear();
+      for (const std::string &item : split(_str, ','))
+      {
+        const auto dash = item.find('-');
+        int first;
+        int last;
+        if (dash == std::string::npos)
+        {
+          if (!parseInt(item, first))
+            return false;
+          last = first;
+        }
+        else if (!parseInt(item.substr(0, dash), first) ||
+                 !parseInt(item.substr(dash + 1), last) || last < first)
+        {
+          return false;
+        }
+
+        for (int index = first; index <= last; ++index)
+          _indexes.push_back(index);
+      }
+      return !_indexes.empty();
+    }
+
+    //////////////////////////////////////////////////
+    bool ApplyThreadSettings(const ThreadSettings &_settings,
+      std::string &_error)
+    {
+      bool result = true;
+
+      if (!_settings.cpus.empty())
+      {
+#ifdef __linux__
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (const int cpu : _settings.cpus)
+        {
+          if (cpu < CPU_SETSIZE)
+            CPU_SET(cpu, &set);
+        }
+        const int err =
+          pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        if (err != 0)
+        {
+          _error = std::string("Unable to set the CPU affinity: ") +
+            std::strerror(err);
+          result = false;
+        }
+#else
+        _error = "The CPU affinity is not supported on this platform";
+        result = false;
+#endif
+      }
+
+      if (_settings.policy != SchedPolicy::INHERIT)
+      {
+#ifndef _WIN32
+        int policy = SCHED_OTHER;
+        if (_settings.policy == SchedPolicy::FIFO)
+          policy = SCHED_FIFO;
+        else if (_settings.policy == SchedPolicy::RR)
+          policy = SCHED_RR;
+
+        sched_param param;
+        std::memset(&param, 0, sizeof(param));
+        param.sched_priority = _settings.priority;
+        const int err = pthread_setschedparam(pthread_self(), policy, &param);
+        if (err != 0)
+        {
+          _error = std::string("Unable to set the scheduling policy: ") +
+            std::strerror(err);
+          result = false;
+        }
+#else
+        _error = "The scheduling policy is not supported on this platform";
+        result = false;
+#endif
+      }
+
+      return result;
+    }
+    }
+  }
+}
@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GZ_TRANSPORT_THREADSETTINGS_HH_
+#define GZ_TRANSPORT_THREADSETTINGS_HH_
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "gz/transport/config.hh"
+
+namespace gz
+{
+  namespace transport
+  {
+    inline namespace GZ_TRANSPORT_VERSION_NAMESPACE
+    {
+    /// \internal
+    /// \brief Scheduling policy of a thread.
+    enum class SchedPolicy
+    {
+      /// \brief Keep the policy inherited from the creating thread.
+      INHERIT,
+      /// \brief SCHED_OTHER, the default time sharing policy.
+      OTHER,
+      /// \brief SCHED_FIFO, real-time first in first out.
+      FIFO,
+      /// \brief SCHED_RR, real-time round robin.
+      RR
+    };
+
+    /// \internal
+    /// \brief CPU affinity and scheduling of an internal thread.
+    struct ThreadSettings
+    {
+      /// \brief CPUs the thread may run on. Empty keeps the inherited
+      /// affinity.
+      std::vector<int> cpus;
+
+      /// \brief Scheduling policy.
+      SchedPolicy policy = SchedPolicy::INHERIT;
+
+      /// \brief Priority for SCHED_FIFO and SCHED_RR.
+      int priority = 0;
+    };
+
+    /// \internal
+    /// \brief The settings of the internal threads of the transport, by
+    /// thread name: "reception", "dispatch", "service", "access",
+    /// "batch", "metrics", "discovery" and "zmq" (the ZMQ I/O threads).
+    /// The name "*" applies to the threads without their own settings.
+    class ThreadSettingsTable
+    {
+      /// \brief Parse the settings.
+      /// \param[in] _affinity Space delimited list of <name>=<cpus>, where
+      /// <cpus> is a comma separated list of CPUs or ranges of CPUs, e.g.:
+      /// "reception=2 dispatch=3,4 *=5-7", or "numa:" followed by a list of
+      /// NUMA nodes whose CPUs are used, e.g.: "reception=numa:1".
+      /// \param[in] _priority Space delimited list of <name>=<policy>, where
+      /// <policy> is "other", "fifo:<priority>" or "rr:<priority>", e.g.:
+      /// "reception=fifo:80 dispatch=rr:10".
+      /// \param[out] _error Description of the first invalid entry.
+      /// \return True if both lists are valid. The valid entries are kept
+      /// otherwise.
+      public: bool Parse(const std::string &_affinity,
+                         const std::string &_priority,
+                         std::string &_error);
+
+      /// \brief Get the settings of a thread.
+      /// \param[in] _name Name of the thread.
+      /// \param[out] _settings The settings of the thread, or of "*".
+      /// \return True if the thread has settings.
+      public: bool Find(const std::string &_name,
+                        ThreadSettings &_settings) const;
+
+      /// \brief The settings read from GZ_TRANSPORT_THREAD_AFFINITY and
+      /// GZ_TRANSPORT_THREAD_PRIORITY, parsed once.
+      /// \return The table.
+      public: static const ThreadSettingsTable &FromEnv();
+
+      /// \brief Settings by thread name.
+      private: std::map<std::string, ThreadSettings> settings;
+    };
+
+    /// \internal
+    /// \brief The NUMA nodes of the host and their CPUs.
+    class NumaTopology
+    {
+      /// \brief Read the nodes from sysfs.
+      /// \param[in] _root Directory of the nodes, e.g.:
+      /// "/sys/devices/system/node".
+      /// \return True if the nodes were read. Otherwise the topology is a
+      /// single node 0 with all the CPUs of the host.
+      public: bool Load(const std::string &_root);
+
+      /// \brief Get the number of node ids, the highest id plus one.
+      /// \return The number of node ids, at least 1.
+      public: std::size_t NodeCount() const;
+
+      /// \brief Get the CPUs of a node.
+      /// \param[in] _node The node.
+      /// \param[out] _cpus The CPUs of the node.
+      /// \return True if the node exists and has CPUs.
+      public: bool NodeCpus(const int _node, std::vector<int> &_cpus) const;
+
+      /// \brief Get the node of a CPU.
+      /// \param[in] _cpu The CPU.
+      /// \return The node, or 0 if the CPU is unknown.
+      public: int NodeOfCpu(const int _cpu) const;
+
+      /// \brief The topology of the host, loaded once.
+      /// \return The topology.
+      public: static const NumaTopology &Host();
+
+      /// \brief CPUs by node.
+      private: std::map<int, std::vector<int>> nodes;
+
+      /// \brief Node by CPU.
+      private: std::vector<int> cpuNodes;
+    };
+
+    /// \internal
+    /// \brief Get the NUMA node of the CPU running the calling thread. The
+    /// memory first touched by the thread is allocated on this node.
+    /// \return The node, or 0 if unknown.
+    int CurrentNumaNode();
+
+    /// \internal
+    /// \brief Parse a comma separated list of indexes or ranges of indexes,
+    /// e.g.: CPUs.
+    /// \param[in] _str The list, e.g.: "1,4-6".
+    /// \param[out] _indexes The indexes, e.g.: {1, 4, 5, 6}.
+    /// \return True if the list is valid and not empty.
+    bool ParseIndexList(const std::string &_str, std::vector<int> &_indexes);
+
+    /// \internal
+    /// \brief Apply settings to the calling thread.
+    /// \param[in] _settings The settings.
+    /// \param[out] _error Description of the failure, e.g.: the process
+    /// isn't allowed to use a real-time policy.
+    /// \return True on success.
+    bool ApplyThreadSettings(const ThreadSettings &_settings,
+                             std::string &_error);
+    }
+  }
+}
+#endif
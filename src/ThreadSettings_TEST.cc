@@ -0,0 +1,183 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ThreadSettings.hh"
+#include "gtest/gtest.h"
+#include "test_utils.hh"
+
+using namespace gz;
+using namespace transport;
+
+//////////////////////////////////////////////////
+/// \brief Check the parsing of the affinity and priority lists.
+TEST(ThreadSettingsTest, Parse)
+{
+  ThreadSettingsTable table;
+  std::string error;
+  EXPECT_TRUE(table.Parse("reception=2  dispatch=3,5-7 *=0",
+    "reception=fifo:80 discovery=rr:10 dispatch=other", error));
+
+  ThreadSettings settings;
+  ASSERT_TRUE(table.Find("reception", settings));
+  EXPECT_EQ(std::vector<int>({2}), settings.cpus);
+  EXPECT_EQ(SchedPolicy::FIFO, settings.policy);
+  EXPECT_EQ(80, settings.priority);
+
+  ASSERT_TRUE(table.Find("dispatch", settings));
+  EXPECT_EQ(std::vector<int>({3, 5, 6, 7}), settings.cpus);
+  EXPECT_EQ(SchedPolicy::OTHER, settings.policy);
+
+  ASSERT_TRUE(table.Find("discovery", settings));
+  EXPECT_TRUE(settings.cpus.empty());
+  EXPECT_EQ(SchedPolicy::RR, settings.policy);
+  EXPECT_EQ(10, settings.priority);
+
+  // The other threads use "*".
+  ASSERT_TRUE(table.Find("service", settings));
+  EXPECT_EQ(std::vector<int>({0}), settings.cpus);
+  EXPECT_EQ(SchedPolicy::INHERIT, settings.policy);
+
+  ThreadSettingsTable empty;
+  EXPECT_TRUE(empty.Parse("", "", error));
+  EXPECT_FALSE(empty.Find("reception", settings));
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that the invalid entries are reported and skipped.
+TEST(ThreadSettingsTest, ParseInvalid)
+{
+  const std::vector<std::string> affinities =
+  {
+    "reception", "=1", "reception=", "reception=a", "reception=3-1",
+    "reception=1,,2", "reception=-1"
+  };
+  for (const std::string &affinity : affinities)
+  {
+    ThreadSettingsTable table;
+    std::string error;
+    EXPECT_FALSE(table.Parse(affinity + " dispatch=1", "", error))
+      << affinity;
+    EXPECT_NE(std::string::npos, error.find(affinity)) << affinity;
+
+    ThreadSettings settings;
+    EXPECT_TRUE(table.Find("dispatch", settings));
+    EXPECT_FALSE(table.Find("reception", settings));
+  }
+
+  const std::vector<std::string> priorities =
+  {
+    "reception=fifo", "reception=fifo:", "reception=idle:1",
+    "reception=rr:-1", "reception=other:1"
+  };
+  for (const std::string &priority : priorities)
+  {
+    ThreadSettingsTable table;
+    std::string error;
+    EXPECT_FALSE(table.Parse("", priority, error)) << priority;
+    EXPECT_NE(std::string::npos, error.find(priority)) << priority;
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief Apply settings to a thread. Only the affinity can be checked
+/// without privileges.
+TEST(ThreadSettingsTest, Apply)
+{
+  std::thread thread([]
+  {
+    std::string error;
+    ThreadSettings settings;
+    EXPECT_TRUE(ApplyThreadSettings(settings, error)) << error;
+
+#ifdef __linux__
+    settings.cpus = {0};
+    EXPECT_TRUE(ApplyThreadSettings(settings, error)) << error;
+    cpu_set_t set;
+    ASSERT_EQ(0, pthread_getaffinity_np(pthread_self(), sizeof(set), &set));
+    EXPECT_EQ(1, CPU_COUNT(&set));
+    EXPECT_TRUE(CPU_ISSET(0, &set));
+
+    settings.cpus.clear();
+    settings.policy = SchedPolicy::OTHER;
+    EXPECT_TRUE(ApplyThreadSettings(settings, error)) << error;
+#endif
+  });
+  thread.join();
+}
+
+//////////////////////////////////////////////////
+/// \brief Read the NUMA nodes from a copy of the sysfs layout.
+TEST(ThreadSettingsTest, NumaTopology)
+{
+  const std::filesystem::path root = std::filesystem::temp_directory_path() /
+    ("gz_numa_" + testing::getRandomNumber());
+  std::filesystem::create_directories(root / "node0");
+  std::filesystem::create_directories(root / "node2");
+  std::filesystem::create_directories(root / "node3");
+  std::ofstream(root / "online") << "0,2-3\n";
+  std::ofstream(root / "node0" / "cpulist") << "0-1,4\n";
+  std::ofstream(root / "node2" / "cpulist") << "2-3\n";
+  std::ofstream(root / "node3" / "cpulist") << "\n";
+
+  NumaTopology topology;
+  ASSERT_TRUE(topology.Load(root.string()));
+  EXPECT_EQ(4u, topology.NodeCount());
+
+  std::vector<int> cpus;
+  ASSERT_TRUE(topology.NodeCpus(0, cpus));
+  EXPECT_EQ(std::vector<int>({0, 1, 4}), cpus);
+  ASSERT_TRUE(topology.NodeCpus(2, cpus));
+  EXPECT_EQ(std::vector<int>({2, 3}), cpus);
+  EXPECT_FALSE(topology.NodeCpus(1, cpus));
+  EXPECT_FALSE(topology.NodeCpus(3, cpus));
+
+  EXPECT_EQ(0, topology.NodeOfCpu(1));
+  EXPECT_EQ(2, topology.NodeOfCpu(3));
+  EXPECT_EQ(0, topology.NodeOfCpu(4));
+  EXPECT_EQ(0, topology.NodeOfCpu(100));
+
+  // Without sysfs, all the CPUs are on node 0.
+  EXPECT_FALSE(topology.Load((root / "missing").string()));
+  EXPECT_EQ(1u, topology.NodeCount());
+  EXPECT_EQ(0, topology.NodeOfCpu(0));
+
+  std::filesystem::remove_all(root);
+
+  // The host has at least the node 0, and the affinity lists accept it.
+  EXPECT_GE(NumaTopology::Host().NodeCount(), 1u);
+  EXPECT_GE(CurrentNumaNode(), 0);
+  if (NumaTopology::Host().NodeCpus(0, cpus))
+  {
+    ThreadSettingsTable table;
+    std::string error;
+    EXPECT_TRUE(table.Parse("dispatch=numa:0", "", error)) << error;
+    ThreadSettings settings;
+    ASSERT_TRUE(table.Find("dispatch", settings));
+    EXPECT_EQ(cpus, settings.cpus);
+  }
+
+  ThreadSettingsTable table;
+  std::string error;
+  EXPECT_FALSE(table.Parse("dispatch=numa:", "", error));
+  EXPECT_FALSE(table.Parse("dispatch=numa:100000", "", error));
+}
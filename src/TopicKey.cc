@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#if defined(__SSE2__) || defined(_M_X64)
+  #include <emmintrin.h>
+  #define GZ_TRANSPORT_TOPICKEY_SSE2
+#elif defined(__aarch64__)
+  #include <arm_neon.h>
+  #define GZ_TRANSPORT_TOPICKEY_NEON
+#endif
+
+#include <cstddef>
+
+#include "TopicKey.hh"
+
+using namespace gz;
+using namespace transport;
+
+//////////////////////////////////////////////////
+bool TopicKey::ValidCharacters(const char *_data, std::size_t _size)
+{
+  std::size_t i = 0;
+
+  // The sequences of two characters are found comparing each block with
+  // the one starting a character later, which must be within the name.
+#if defined(GZ_TRANSPORT_TOPICKEY_SSE2)
+  const __m128i space = _mm_set1_epi8(' ');
+  const __m128i tilde = _mm_set1_epi8('~');
+  const __m128i at = _mm_set1_epi8('@');
+  const __m128i slash = _mm_set1_epi8('/');
+  const __m128i colon = _mm_set1_epi8(':');
+  const __m128i equal = _mm_set1_epi8('=');
+  for (; i + 17 <= _size; i += 16)
+  {
+    const __m128i cur =
+      _mm_loadu_si128(reinterpret_cast<const __m128i *>(_data + i));
+    const __m128i next =
+      _mm_loadu_si128(reinterpret_cast<const __m128i *>(_data + i + 1));
+    __m128i bad = _mm_or_si128(_mm_cmpeq_epi8(cur, space),
+      _mm_or_si128(_mm_cmpeq_epi8(cur, tilde), _mm_cmpeq_epi8(cur, at)));
+    bad = _mm_or_si128(bad, _mm_and_si128(_mm_cmpeq_epi8(cur, slash),
+      _mm_cmpeq_epi8(next, slash)));
+    bad = _mm_or_si128(bad, _mm_and_si128(_mm_cmpeq_epi8(cur, colon),
+      _mm_cmpeq_epi8(next, equal)));
+    if (_mm_movemask_epi8(bad) != 0)
+      return false;
+  }
+#elif defined(GZ_TRANSPORT_TOPICKEY_NEON)
+  const uint8_t *data = reinterpret_cast<const uint8_t *>(_data);
+  for (; i + 17 <= _size; i += 16)
+  {
+    const uint8x16_t cur = vld1q_u8(data + i);
+    const uint8x16_t next = vld1q_u8(data + i + 1);
+    uint8x16_t bad = vorrq_u8(vceqq_u8(cur, vdupq_n_u8(' ')),
+      vorrq_u8(vceqq_u8(cur, vdupq_n_u8('~')),
+               vceqq_u8(cur, vdupq_n_u8('@'))));
+    bad = vorrq_u8(bad, vandq_u8(vceqq_u8(cur, vdupq_n_u8('/')),
+      vceqq_u8(next, vdupq_n_u8('/'))));
+    bad = vorrq_u8(bad, vandq_u8(vceqq_u8(cur, vdupq_n_u8(':')),
+      vceqq_u8(next, vdupq_n_u8('='))));
+    if (vmaxvq_u8(bad) != 0)
+      return false;
+  }
+#endif
+
+  for (; i < _size; ++i)
+  {
+    const char c = _data[i];
+    if (c == ' ' || c == '~' || c == '@')
+      return false;
+
+    if (i + 1 < _size &&
+        ((c == '/' && _data[i + 1] == '/') ||
+         (c == ':' && _data[i + 1] == '=')))
+    {
+      return false;
+    }
+  }
+  return true;
+}
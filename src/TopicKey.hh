@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef GZ_TRANSPORT_TOPICKEY_HH_
+#define GZ_TRANSPORT_TOPICKEY_HH_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+
+#include "gz/transport/config.hh"
+
+namespace gz
+{
+  namespace transport
+  {
+    inline namespace GZ_TRANSPORT_VERSION_NAMESPACE
+    {
+    /// \internal
+    /// \brief A topic name with its hash, computed once. The name of a
+    /// message received is turned into a key when it is received, the
+    /// lookups after that compare the hashes and the lengths before the
+    /// characters, and don't hash the name again.
+    ///
+    /// The hash is only meaningful within a process, it isn't the same on
+    /// every architecture. NodeSharedPrivate::HeaderId() is the one sent
+    /// to the other processes.
+    struct TopicKey
+    {
+      /// \brief Default constructor, the empty name.
+      TopicKey()
+        : hash(Hash(nullptr, 0))
+      {
+      }
+
+      /// \brief Constructor.
+      /// \param[in] _name The topic name.
+      explicit TopicKey(std::string _name)
+        : name(std::move(_name)),
+          hash(Hash(this->name.data(), this->name.size()))
+      {
+      }
+
+      /// \brief Hash a string, 8 characters at once.
+      /// \param[in] _data The characters.
+      /// \param[in] _size Number of characters.
+      /// \return The hash.
+      static uint64_t Hash(const char *_data, std::size_t _size)
+      {
+        const uint64_t kMul = 0x9e3779b97f4a7c15ull;
+        uint64_t h = (_size + 1) * kMul;
+        while (_size > 0)
+        {
+          uint64_t word = 0;
+          const std::size_t n = _size < sizeof(word) ? _size : sizeof(word);
+          std::memcpy(&word, _data, n);
+          h = (h ^ word) * kMul;
+          h ^= h >> 32;
+          _data += n;
+          _size -= n;
+        }
+
+        // The buckets use the low bits, they must depend on all the others.
+        h ^= h >> 29;
+        h *= 0xbf58476d1ce4e5b9ull;
+        h ^= h >> 32;
+        return h;
+      }
+
+      /// \brief Hash a string, 8 characters at once.
+      /// \param[in] _str The string.
+      /// \return The hash.
+      static uint64_t Hash(const std::string &_str)
+      {
+        return Hash(_str.data(), _str.size());
+      }
+
+      /// \brief Check that a name has none of the characters and sequences
+      /// forbidden in the topic names: ' ', '~', '@', "//" and ":=". The
+      /// name is checked 16 characters at once where SSE2 or NEON are
+      /// available. The other rules are checked by TopicUtils.
+      /// \param[in] _data The characters.
+      /// \param[in] _size Number of characters.
+      /// \return True if none of them is found.
+      static bool ValidCharacters(const char *_data, std::size_t _size);
+
+      /// \brief Equality operator.
+      /// \param[in] _other The other key.
+      /// \return True if both names are equal.
+      bool operator==(const TopicKey &_other) const
+      {
+        return this->hash == _other.hash && this->name == _other.name;
+      }
+
+      /// \brief Inequality operator.
+      /// \param[in] _other The other key.
+      /// \return True if the names are different.
+      bool operator!=(const TopicKey &_other) const
+      {
+        return !(*this == _other);
+      }
+
+      /// \brief The topic name.
+      std::string name;
+
+      /// \brief Hash of the name, see Hash().
+      uint64_t hash;
+    };
+
+    /// \internal
+    /// \brief Hash of a TopicKey, the one stored in it.
+    struct TopicKeyHash
+    {
+      /// \brief Hash a key.
+      /// \param[in] _key The key.
+      /// \return The hash.
+      std::size_t operator()(const TopicKey &_key) const
+      {
+        return static_cast<std::size_t>(_key.hash);
+      }
+    };
+
+    /// \internal
+    /// \brief Hash of a topic name stored as a string, the same as the one
+    /// of its TopicKey.
+    struct TopicNameHash
+    {
+      /// \brief Hash a name.
+      /// \param[in] _name The name.
+      /// \return The hash.
+      std::size_t operator()(const std::string &_name) const
+      {
+        return static_cast<std::size_t>(TopicKey::Hash(_name));
+      }
+    };
+    }
+  }
+}
+#endif
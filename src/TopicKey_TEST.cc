@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "gz/transport/TopicUtils.hh"
+#include "TopicKey.hh"
+#include "gtest/gtest.h"
+
+using namespace gz;
+using namespace transport;
+
+//////////////////////////////////////////////////
+/// \brief Keys of the same name are equal and have the same hash.
+TEST(TopicKeyTest, EqualityAndHash)
+{
+  const TopicKey a("@partition@/robot/camera/image");
+  const TopicKey b(std::string("@partition@/robot/camera/image"));
+  const TopicKey c("@partition@/robot/camera/imagf");
+  EXPECT_EQ(a, b);
+  EXPECT_EQ(a.hash, b.hash);
+  EXPECT_NE(a, c);
+  EXPECT_NE(a.hash, c.hash);
+  EXPECT_EQ(TopicKey().hash, TopicKey("").hash);
+  EXPECT_EQ(static_cast<std::size_t>(a.hash), TopicNameHash()(a.name));
+
+  // The names that differ only by their length or by a character of each
+  // word have different hashes.
+  std::unordered_set<uint64_t> hashes;
+  std::string name;
+  for (int i = 0; i < 64; ++i)
+  {
+    name += '\0';
+    EXPECT_TRUE(hashes.insert(TopicKey::Hash(name)).second);
+  }
+  for (std::size_t i = 0; i < name.size(); ++i)
+  {
+    std::string other = name;
+    other[i] = 'x';
+    EXPECT_TRUE(hashes.insert(TopicKey::Hash(other)).second);
+  }
+
+  std::unordered_map<TopicKey, int, TopicKeyHash> map;
+  map[a] = 1;
+  map[c] = 2;
+  EXPECT_EQ(1, map.at(b));
+  EXPECT_EQ(2u, map.size());
+}
+
+//////////////////////////////////////////////////
+/// \brief The forbidden characters and sequences are found at every
+/// position, including across the blocks checked at once.
+TEST(TopicKeyTest, ValidCharacters)
+{
+  const std::string valid(40, 'a');
+  EXPECT_TRUE(TopicKey::ValidCharacters(valid.data(), valid.size()));
+  EXPECT_TRUE(TopicKey::ValidCharacters(nullptr, 0));
+
+  for (const std::string forbidden : {" ", "~", "@", "//", ":="})
+  {
+    for (std::size_t i = 0; i + forbidden.size() <= valid.size(); ++i)
+    {
+      std::string name = valid;
+      name.replace(i, forbidden.size(), forbidden);
+      EXPECT_FALSE(TopicKey::ValidCharacters(name.data(), name.size()))
+        << "[" << forbidden << "] at " << i;
+      EXPECT_FALSE(TopicUtils::IsValidTopic(name));
+    }
+  }
+
+  // A single '/' or ':', or a '=' before a ':', are valid.
+  std::string name = valid;
+  for (std::size_t i = 0; i < name.size(); i += 2)
+    name[i] = (i % 4 == 0) ? '/' : ':';
+  name[14] = 'a';
+  name[15] = '=';
+  name[16] = ':';
+  EXPECT_TRUE(TopicKey::ValidCharacters(name.data(), name.size()));
+  EXPECT_TRUE(TopicUtils::IsValidTopic(name));
+
+  // The name ends where the size says, the next character isn't checked.
+  const std::string slashes = "/a/b/c/d/e/f/g/h/i//";
+  EXPECT_TRUE(TopicKey::ValidCharacters(slashes.data(), slashes.size() - 1));
+  EXPECT_FALSE(TopicKey::ValidCharacters(slashes.data(), slashes.size()));
+}
@@ -16,9 +16,15 @@
 */
 #include <gz/msgs/statistic.pb.h>
 
+#include <algorithm>
 #include <chrono>
 #include <cmath>
+#include <functional>
+#include <iterator>
 #include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "gz/transport/TopicStatistics.hh"
 
@@ -38,27 +44,36 @@ class gz::transport::TopicStatisticsPrivate
             reception(_stats.reception),
             age(_stats.age),
             droppedMsgCount(_stats.droppedMsgCount),
+            queueDroppedMsgCount(_stats.queueDroppedMsgCount),
+            slowSubscriberCount(_stats.slowSubscriberCount),
             prevPublicationStamp(_stats.prevPublicationStamp),
             prevReceptionStamp(_stats.prevReceptionStamp)
   {
   }
 
-  /// \brief Map of address to sequence numbers. This is used to
-  /// identify dropped messages.
-  public: std::map<std::string, uint64_t> seq;
+  /// \brief Last sequence number of each sender, by sender identifier.
+  /// This is used to identify dropped messages. A topic has few
+  /// publishers, a linear search is faster than a map.
+  public: std::vector<std::pair<uint64_t, uint64_t>> seq;
 
   /// \brief Statistics for the publisher.
   public: Statistics publication;
 
   /// \brief Statistics for the subscriber.
-  public: Statistics reception;
+  public: LatencyHistogram reception;
 
   /// \brief Age statistics.
-  public: Statistics age;
+  public: LatencyHistogram age;
 
   /// \brief Total number of dropped messages.
   public: uint64_t droppedMsgCount = 0;
 
+  /// \brief Number of messages dropped by full subscriber queues.
+  public: uint64_t queueDroppedMsgCount = 0;
+
+  /// \brief Number of slow subscribers detected.
+  public: uint64_t slowSubscriberCount = 0;
+
   /// \brief Previous publication time stamp.
   public: uint64_t prevPublicationStamp = 0;
 
@@ -118,6 +133,68 @@ uint64_t Statistics::Count() const
   return this->count;
 }
 
+//////////////////////////////////////////////////
+void LatencyHistogram::Update(double _duration)
+{
+  ++this->buckets[Bucket(_duration)];
+  this->summary.Update(_duration);
+}
+
+//////////////////////////////////////////////////
+uint64_t LatencyHistogram::Count() const
+{
+  return this->summary.Count();
+}
+
+//////////////////////////////////////////////////
+double LatencyHistogram::Percentile(double _percent) const
+{
+  const uint64_t count = this->summary.Count();
+  if (count == 0)
+    return 0;
+
+  const double percent = std::clamp(_percent, 0.0, 100.0);
+  const uint64_t rank =
+    static_cast<uint64_t>(std::ceil(percent / 100.0 * count));
+  if (rank == 0)
+    return this->summary.Min();
+  if (rank >= count)
+    return this->summary.Max();
+
+  uint64_t seen = 0;
+  for (std::size_t i = 0; i < kNumBuckets - 1; ++i)
+  {
+    seen += this->buckets[i];
+    if (seen >= rank)
+    {
+      // Upper bound of the bucket, the samples are not stored.
+      const double bound = std::exp2((i + 1) / 8.0) / 1000.0;
+      return std::clamp(bound, this->summary.Min(), this->summary.Max());
+    }
+  }
+
+  // The sample is in the last bucket, with no upper bound.
+  return this->summary.Max();
+}
+
+//////////////////////////////////////////////////
+Statistics LatencyHistogram::Summary() const
+{
+  return this->summary;
+}
+
+//////////////////////////////////////////////////
+std::size_t LatencyHistogram::Bucket(double _duration)
+{
+  const double us = _duration * 1000.0;
+  if (!(us > 1.0))
+    return 0;
+
+  const double index = std::floor(8.0 * std::log2(us));
+  return index >= kNumBuckets ?
+    kNumBuckets - 1 : static_cast<std::size_t>(index);
+}
+
 //////////////////////////////////////////////////
 TopicStatistics::TopicStatistics()
   : dataPtr(new TopicStatisticsPrivate)
@@ -139,6 +216,25 @@ TopicStatistics::~TopicStatistics()
 void TopicStatistics::Update(const std::string &_sender,
     uint64_t _stamp, uint64_t _seq)
 {
+  this->Update(static_cast<uint64_t>(std::hash<std::string>()(_sender)),
+    _stamp, _seq);
+}
+
+//////////////////////////////////////////////////
+void TopicStatistics::Update(uint64_t _senderId, uint64_t _stamp,
+    uint64_t _seq)
+{
+  auto senderIt = std::find_if(this->dataPtr->seq.begin(),
+    this->dataPtr->seq.end(), [_senderId](const auto &_entry)
+    {
+      return _entry.first == _senderId;
+    });
+  if (senderIt == this->dataPtr->seq.end())
+  {
+    this->dataPtr->seq.emplace_back(_senderId, 0);
+    senderIt = std::prev(this->dataPtr->seq.end());
+  }
+
   // Current wall time
   uint64_t now =
     std::chrono::duration_cast<std::chrono::milliseconds>(
@@ -152,7 +248,7 @@ void TopicStatistics::Update(const std::string &_sender,
           this->dataPtr->prevReceptionStamp));
     this->dataPtr->age.Update(static_cast<double>(now - _stamp));
 
-    if (this->dataPtr->seq[_sender] + 1 != _seq)
+    if (senderIt->second + 1 != _seq)
     {
       this->dataPtr->droppedMsgCount++;
     }
@@ -161,18 +257,53 @@ void TopicStatistics::Update(const std::string &_sender,
   this->dataPtr->prevPublicationStamp = _stamp;
   this->dataPtr->prevReceptionStamp = now;
 
-  this->dataPtr->seq[_sender] = _seq;
+  senderIt->second = _seq;
+}
+
+//////////////////////////////////////////////////
+/// \brief Add the p50, p90, p99 and p999 of a histogram to a group of
+/// statistics. There is no type for a percentile, it is in the name.
+/// \param[in] _histogram The histogram.
+/// \param[in] _suffix Suffix of the names of the statistics.
+/// \param[in,out] _group The group.
+static void addPercentiles(const LatencyHistogram &_histogram,
+  const std::string &_suffix, msgs::StatisticsGroup &_group)
+{
+  static const std::pair<const char *, double> kPercentiles[] =
+  {
+    {"p50_", 50.0}, {"p90_", 90.0}, {"p99_", 99.0}, {"p999_", 99.9}
+  };
+
+  for (const auto &percentile : kPercentiles)
+  {
+    msgs::Statistic *stat = _group.add_statistics();
+    stat->set_name(percentile.first + _suffix);
+    stat->set_value(_histogram.Percentile(percentile.second));
+  }
 }
 
 //////////////////////////////////////////////////
 void TopicStatistics::FillMessage(msgs::Metric &_msg) const
 {
+  const Statistics reception = this->dataPtr->reception.Summary();
+  const Statistics age = this->dataPtr->age.Summary();
+
   _msg.set_unit("milliseconds");
   msgs::Statistic *stat = _msg.add_statistics();
   stat->set_type(msgs::Statistic::SAMPLE_COUNT);
   stat->set_name("dropped_message_count");
   stat->set_value(static_cast<double>(this->dataPtr->droppedMsgCount));
 
+  stat = _msg.add_statistics();
+  stat->set_type(msgs::Statistic::SAMPLE_COUNT);
+  stat->set_name("queue_dropped_message_count");
+  stat->set_value(static_cast<double>(this->dataPtr->queueDroppedMsgCount));
+
+  stat = _msg.add_statistics();
+  stat->set_type(msgs::Statistic::SAMPLE_COUNT);
+  stat->set_name("slow_subscriber_count");
+  stat->set_value(static_cast<double>(this->dataPtr->slowSubscriberCount));
+
   // Publication statistics
   msgs::StatisticsGroup *statGroup = _msg.add_statistics_groups();
   statGroup->set_name("publication_statistics");
@@ -203,22 +334,23 @@ void TopicStatistics::FillMessage(msgs::Metric &_msg) const
   stat = statGroup->add_statistics();
   stat->set_type(msgs::Statistic::AVERAGE);
   stat->set_name("avg_hz");
-  stat->set_value(1000.0 / this->dataPtr->reception.Avg());
+  stat->set_value(1000.0 / reception.Avg());
 
   stat = statGroup->add_statistics();
   stat->set_type(msgs::Statistic::MINIMUM);
   stat->set_name("min_period");
-  stat->set_value(this->dataPtr->reception.Min());
+  stat->set_value(reception.Min());
 
   stat = statGroup->add_statistics();
   stat->set_type(msgs::Statistic::MAXIMUM);
   stat->set_name("max_period");
-  stat->set_value(this->dataPtr->reception.Max());
+  stat->set_value(reception.Max());
 
   stat = statGroup->add_statistics();
   stat->set_type(msgs::Statistic::STDDEV);
   stat->set_name("period_standard_devation");
-  stat->set_value(this->dataPtr->reception.StdDev());
+  stat->set_value(reception.StdDev());
+  addPercentiles(this->dataPtr->reception, "period", *statGroup);
 
   // Age statistics
   statGroup = _msg.add_statistics_groups();
@@ -227,22 +359,23 @@ void TopicStatistics::FillMessage(msgs::Metric &_msg) const
   stat = statGroup->add_statistics();
   stat->set_type(msgs::Statistic::AVERAGE);
   stat->set_name("avg_age");
-  stat->set_value(this->dataPtr->age.Avg());
+  stat->set_value(age.Avg());
 
   stat = statGroup->add_statistics();
   stat->set_type(msgs::Statistic::MINIMUM);
   stat->set_name("min_age");
-  stat->set_value(this->dataPtr->age.Min());
+  stat->set_value(age.Min());
 
   stat = statGroup->add_statistics();
   stat->set_type(msgs::Statistic::MAXIMUM);
   stat->set_name("max_age");
-  stat->set_value(this->dataPtr->age.Max());
+  stat->set_value(age.Max());
 
   stat = statGroup->add_statistics();
   stat->set_type(msgs::Statistic::STDDEV);
   stat->set_name("age_standard_devation");
-  stat->set_value(this->dataPtr->age.StdDev());
+  stat->set_value(age.StdDev());
+  addPercentiles(this->dataPtr->age, "age", *statGroup);
 }
 
 //////////////////////////////////////////////////
@@ -251,6 +384,30 @@ uint64_t TopicStatistics::DroppedMsgCount() const
   return this->dataPtr->droppedMsgCount;
 }
 
+//////////////////////////////////////////////////
+void TopicStatistics::AddQueueDrops(uint64_t _count)
+{
+  this->dataPtr->queueDroppedMsgCount += _count;
+}
+
+//////////////////////////////////////////////////
+uint64_t TopicStatistics::QueueDroppedMsgCount() const
+{
+  return this->dataPtr->queueDroppedMsgCount;
+}
+
+//////////////////////////////////////////////////
+void TopicStatistics::AddSlowSubscribers(uint64_t _count)
+{
+  this->dataPtr->slowSubscriberCount += _count;
+}
+
+//////////////////////////////////////////////////
+uint64_t TopicStatistics::SlowSubscriberCount() const
+{
+  return this->dataPtr->slowSubscriberCount;
+}
+
 //////////////////////////////////////////////////
 Statistics TopicStatistics::PublicationStatistics() const
 {
@@ -260,11 +417,23 @@ Statistics TopicStatistics::PublicationStatistics() const
 //////////////////////////////////////////////////
 Statistics TopicStatistics::ReceptionStatistics() const
 {
-  return this->dataPtr->reception;
+  return this->dataPtr->reception.Summary();
 }
 
 //////////////////////////////////////////////////
 Statistics TopicStatistics::AgeStatistics() const
+{
+  return this->dataPtr->age.Summary();
+}
+
+//////////////////////////////////////////////////
+LatencyHistogram TopicStatistics::ReceptionHistogram() const
+{
+  return this->dataPtr->reception;
+}
+
+//////////////////////////////////////////////////
+LatencyHistogram TopicStatistics::AgeHistogram() const
 {
   return this->dataPtr->age;
 }
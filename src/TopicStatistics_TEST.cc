@@ -15,6 +15,10 @@
  *
 */
 
+#include <algorithm>
+#include <string>
+#include <vector>
+
 #include "gtest/gtest.h"
 #include "gz/transport/TopicStatistics.hh"
 
@@ -65,6 +69,71 @@ TEST(TopicsStatistics, DroppedMsg)
   EXPECT_EQ(2u, topicStats.DroppedMsgCount());
 }
 
+//////////////////////////////////////////////////
+TEST(TopicsStatistics, DroppedMsgSenderId)
+{
+  TopicStatistics topicStats;
+  topicStats.Update(7u, 1, 0);
+  topicStats.Update(7u, 2, 1);
+  EXPECT_EQ(0u, topicStats.DroppedMsgCount());
+
+  // The sequence numbers are tracked by sender.
+  topicStats.Update(8u, 3, 1);
+  topicStats.Update(7u, 4, 2);
+  topicStats.Update(8u, 5, 2);
+  EXPECT_EQ(0u, topicStats.DroppedMsgCount());
+
+  topicStats.Update(8u, 6, 4);
+  EXPECT_EQ(1u, topicStats.DroppedMsgCount());
+
+  TopicStatistics copy(topicStats);
+  copy.Update(7u, 7, 3);
+  EXPECT_EQ(1u, copy.DroppedMsgCount());
+}
+
+//////////////////////////////////////////////////
+TEST(TopicsStatistics, QueueDroppedMsg)
+{
+  TopicStatistics topicStats;
+  EXPECT_EQ(0u, topicStats.QueueDroppedMsgCount());
+
+  topicStats.AddQueueDrops(3);
+  topicStats.AddQueueDrops(2);
+  EXPECT_EQ(5u, topicStats.QueueDroppedMsgCount());
+  EXPECT_EQ(0u, topicStats.DroppedMsgCount());
+
+  TopicStatistics copy(topicStats);
+  EXPECT_EQ(5u, copy.QueueDroppedMsgCount());
+}
+
+//////////////////////////////////////////////////
+TEST(TopicsStatistics, SlowSubscribers)
+{
+  TopicStatistics topicStats;
+  EXPECT_EQ(0u, topicStats.SlowSubscriberCount());
+
+  topicStats.AddSlowSubscribers(1);
+  topicStats.AddSlowSubscribers(2);
+  EXPECT_EQ(3u, topicStats.SlowSubscriberCount());
+  EXPECT_EQ(0u, topicStats.QueueDroppedMsgCount());
+
+  TopicStatistics copy(topicStats);
+  EXPECT_EQ(3u, copy.SlowSubscriberCount());
+
+  msgs::Metric msg;
+  copy.FillMessage(msg);
+  bool found = false;
+  for (const auto &stat : msg.statistics())
+  {
+    if (stat.name() == "slow_subscriber_count")
+    {
+      found = true;
+      EXPECT_DOUBLE_EQ(3.0, stat.value());
+    }
+  }
+  EXPECT_TRUE(found);
+}
+
 //////////////////////////////////////////////////
 TEST(TopicsStatistics, MinMax)
 {
@@ -101,3 +170,38 @@ TEST(TopicsStatistics, AvgStdDev)
   EXPECT_DOUBLE_EQ(2.0, stats.Avg());
   EXPECT_NEAR(0.816, stats.StdDev(), 1e-3);
 }
+
+//////////////////////////////////////////////////
+TEST(TopicsStatistics, Percentiles)
+{
+  TopicStatistics topicStats;
+  for (uint64_t i = 1; i <= 100; ++i)
+    topicStats.Update("foo", i, i);
+
+  // The first message only starts the statistics.
+  EXPECT_EQ(99u, topicStats.ReceptionHistogram().Count());
+  EXPECT_EQ(99u, topicStats.AgeHistogram().Count());
+  EXPECT_EQ(topicStats.AgeStatistics().Count(),
+            topicStats.AgeHistogram().Count());
+  EXPECT_LE(topicStats.AgeHistogram().Percentile(50),
+            topicStats.AgeHistogram().Percentile(99));
+
+  msgs::Metric msg;
+  topicStats.FillMessage(msg);
+  ASSERT_EQ(3, msg.statistics_groups_size());
+
+  // The percentiles of the reception and the age.
+  for (int i = 1; i < 3; ++i)
+  {
+    const auto &group = msg.statistics_groups(i);
+    const std::string suffix = i == 1 ? "period" : "age";
+    std::vector<std::string> names;
+    for (const auto &stat : group.statistics())
+      names.push_back(stat.name());
+    for (const char *prefix : {"p50_", "p90_", "p99_", "p999_"})
+    {
+      EXPECT_NE(names.end(),
+        std::find(names.begin(), names.end(), prefix + suffix));
+    }
+  }
+}
@@ -423,6 +423,53 @@ TEST(TopicStorageTest, TopicList)
   EXPECT_EQ(0u, topics.size());
 }
 
+//////////////////////////////////////////////////
+/// \brief Check that the version changes only when the storage is modified.
+TEST(TopicStorageTest, Version)
+{
+  init();
+
+  Publisher publisher1(g_topic1, g_addr1, g_pUuid1, g_nUuid1, g_opts1);
+  Publisher publisher2(g_topic2, g_addr2, g_pUuid2, g_nUuid2, g_opts2);
+
+  TopicStorage<Publisher> test;
+  uint64_t version = test.Version();
+
+  EXPECT_TRUE(test.AddPublisher(publisher1));
+  EXPECT_NE(version, test.Version());
+  version = test.Version();
+
+  EXPECT_FALSE(test.AddPublisher(publisher1));
+  EXPECT_EQ(version, test.Version());
+
+  EXPECT_FALSE(test.DelPublisherByNode(g_topic1, g_pUuid1, g_nUuid2));
+  EXPECT_EQ(version, test.Version());
+
+  EXPECT_TRUE(test.DelPublisherByNode(g_topic1, g_pUuid1, g_nUuid1));
+  EXPECT_NE(version, test.Version());
+  version = test.Version();
+
+  EXPECT_TRUE(test.AddPublisher(publisher2));
+  version = test.Version();
+  EXPECT_FALSE(test.DelPublishersByProc(g_pUuid1));
+  EXPECT_EQ(version, test.Version());
+  EXPECT_TRUE(test.DelPublishersByProc(g_pUuid2));
+  EXPECT_NE(version, test.Version());
+
+  // The storage is copyable. A copy starts at the same version, and an
+  // assignment changes the version of the storage assigned.
+  EXPECT_TRUE(test.AddPublisher(publisher1));
+  TopicStorage<Publisher> copy(test);
+  EXPECT_EQ(test.Version(), copy.Version());
+  EXPECT_TRUE(copy.HasTopic(g_topic1));
+
+  TopicStorage<Publisher> assigned;
+  version = assigned.Version();
+  assigned = test;
+  EXPECT_NE(version, assigned.Version());
+  EXPECT_TRUE(assigned.HasTopic(g_topic1));
+}
+
 //////////////////////////////////////////////////
 /// \brief Check PublishersByProc().
 TEST(TopicStorageTest, PublishersByProc)
@@ -506,3 +553,89 @@ TEST(TopicStorageTest, HasTopicWithType)
   EXPECT_TRUE(test.AddPublisher(publisher2));
   EXPECT_TRUE(test.HasTopic(g_topic1));
 }
+
+//////////////////////////////////////////////////
+/// \brief Check that the indexes by process and address follow the changes
+/// of the storage.
+TEST(TopicStorageTest, Indexes)
+{
+  init();
+
+  TopicStorage<Publisher> test;
+  const int numTopics = 1000;
+  for (int i = 0; i < numTopics; ++i)
+  {
+    const std::string topic = "topic" + std::to_string(i);
+    EXPECT_TRUE(test.AddPublisher(
+      Publisher(topic, g_addr1, g_pUuid1, g_nUuid1, g_opts1)));
+    EXPECT_TRUE(test.AddPublisher(
+      Publisher(topic, g_addr2, g_pUuid2, g_nUuid2, g_opts1)));
+  }
+
+  // Remove all the topics of the second process, but one.
+  for (int i = 1; i < numTopics; ++i)
+  {
+    EXPECT_TRUE(test.DelPublisherByNode("topic" + std::to_string(i),
+      g_pUuid2, g_nUuid2));
+  }
+  EXPECT_TRUE(test.HasPublisher(g_addr2));
+  EXPECT_TRUE(test.HasPublisher("topic0", g_pUuid2, g_nUuid2));
+  EXPECT_FALSE(test.HasPublisher("topic1", g_pUuid2, g_nUuid2));
+  EXPECT_FALSE(test.HasPublisher("topic0", g_pUuid2, g_nUuid1));
+  EXPECT_FALSE(test.HasPublisher("unknown", g_pUuid1, g_nUuid1));
+
+  std::map<std::string, std::vector<Publisher>> pubs;
+  test.PublishersByProc(g_pUuid2, pubs);
+  ASSERT_EQ(1u, pubs.size());
+  ASSERT_EQ(1u, pubs[g_nUuid2].size());
+  EXPECT_EQ("topic0", pubs[g_nUuid2].at(0).Topic());
+
+  std::vector<Publisher> nodePubs;
+  test.PublishersByNode(g_pUuid1, g_nUuid1, nodePubs);
+  EXPECT_EQ(static_cast<std::size_t>(numTopics), nodePubs.size());
+
+  EXPECT_TRUE(test.DelPublisherByNode("topic0", g_pUuid2, g_nUuid2));
+  EXPECT_FALSE(test.HasPublisher(g_addr2));
+  EXPECT_FALSE(test.DelPublishersByProc(g_pUuid2));
+
+  // The first process is still there.
+  EXPECT_TRUE(test.HasPublisher(g_addr1));
+  EXPECT_TRUE(test.DelPublishersByProc(g_pUuid1));
+  EXPECT_FALSE(test.HasPublisher(g_addr1));
+  EXPECT_FALSE(test.HasTopic("topic0"));
+  test.PublishersByProc(g_pUuid1, pubs);
+  EXPECT_TRUE(pubs.empty());
+
+  // Clear() resets the indexes too.
+  EXPECT_TRUE(test.AddPublisher(
+    Publisher(g_topic1, g_addr1, g_pUuid1, g_nUuid1, g_opts1)));
+  test.Clear();
+  EXPECT_FALSE(test.HasPublisher(g_addr1));
+  EXPECT_FALSE(test.DelPublishersByProc(g_pUuid1));
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the estimate of the memory used by the storage.
+TEST(TopicStorageTest, MemoryUsage)
+{
+  init();
+
+  TopicStorage<Publisher> test;
+  EXPECT_EQ(0u, test.MemoryUsage());
+
+  EXPECT_TRUE(test.AddPublisher(
+    Publisher(g_topic1, g_addr1, g_pUuid1, g_nUuid1, g_opts1)));
+  const uint64_t one = test.MemoryUsage();
+  EXPECT_GT(one, g_topic1.size() + g_addr1.size() + g_pUuid1.size() +
+    g_nUuid1.size() + sizeof(Publisher));
+
+  EXPECT_TRUE(test.AddPublisher(
+    Publisher(g_topic2, g_addr2, g_pUuid2, g_nUuid2, g_opts1)));
+  EXPECT_GT(test.MemoryUsage(), one);
+
+  EXPECT_TRUE(test.DelPublishersByProc(g_pUuid2));
+  EXPECT_EQ(one, test.MemoryUsage());
+
+  test.Clear();
+  EXPECT_EQ(0u, test.MemoryUsage());
+}
@@ -15,10 +15,10 @@
  *
 */
 
-#include <regex>
 #include <string>
 
 #include "gz/transport/TopicUtils.hh"
+#include "TopicKey.hh"
 
 using namespace gz;
 using namespace transport;
@@ -38,27 +38,9 @@ bool TopicUtils::IsValidNamespace(const std::string &_ns)
   if (_ns == "/")
     return false;
 
-  // If the topic name has a '~' is not valid.
-  if (_ns.find("~") != std::string::npos)
-    return false;
-
-  // If the topic name has a white space is not valid.
-  if (_ns.find(" ") != std::string::npos)
-    return false;
-
-  // It is not allowed to have two consecutive slashes.
-  if (_ns.find("//") != std::string::npos)
-    return false;
-
-  // It the topic name has a '@' is not valid.
-  if (_ns.find("@") != std::string::npos)
-    return false;
-
-  // If the topic name has a ':=' is not valid.
-  if (_ns.find(":=") != std::string::npos)
-    return false;
-
-  return true;
+  // A '~', a white space, a '@', two consecutive slashes or a ':=' are not
+  // valid. They are all searched in a single pass.
+  return TopicKey::ValidCharacters(_ns.data(), _ns.size());
 }
 
 //////////////////////////////////////////////////
@@ -159,13 +141,24 @@ bool TopicUtils::DecomposeFullyQualifiedTopic(
 //////////////////////////////////////////////////
 std::string TopicUtils::AsValidTopic(const std::string &_topic)
 {
-  std::string validTopic{_topic};
+  std::string validTopic;
+  validTopic.reserve(_topic.size());
 
-  // Substitute spaces with _
-  validTopic = std::regex_replace(validTopic, std::regex(" "), "_");
-
-  // Remove special characters and combinations
-  validTopic = std::regex_replace(validTopic, std::regex("@|~|//|:="), "");
+  // Substitute spaces with _ and remove the special characters and
+  // combinations (@, ~, // and :=), from left to right.
+  for (std::size_t i = 0; i < _topic.size(); ++i)
+  {
+    const char c = _topic[i];
+    const char next = i + 1 < _topic.size() ? _topic[i + 1] : '\0';
+    if (c == '@' || c == '~')
+      continue;
+    if ((c == '/' && next == '/') || (c == ':' && next == '='))
+    {
+      ++i;
+      continue;
+    }
+    validTopic += c == ' ' ? '_' : c;
+  }
 
   if (!IsValidTopic(validTopic))
   {
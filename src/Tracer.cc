@@ -0,0 +1,292 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gz/transport/Helpers.hh"
+
+#include "Tracer.hh"
+
+using namespace gz;
+using namespace transport;
+
+/// \brief Size (bytes) of the pending events written at once.
+static const std::size_t kFlushSize = 64 * 1024;
+
+/// \brief Maximum time (us) before the pending events are written.
+static const int64_t kFlushPeriod = 100000;
+
+//////////////////////////////////////////////////
+/// \brief The tracers of the process, flushed when it exits.
+/// \return The tracers.
+static std::vector<Tracer *> &tracers()
+{
+  static std::vector<Tracer *> instances;
+  return instances;
+}
+
+//////////////////////////////////////////////////
+/// \brief Protect tracers().
+/// \return The mutex.
+static std::mutex &tracersMutex()
+{
+  static std::mutex mutex;
+  return mutex;
+}
+
+//////////////////////////////////////////////////
+/// \brief Flush the tracers when the process exits. The NodeShared
+/// instances, which own them, are never destroyed.
+static void flushTracers()
+{
+  std::lock_guard<std::mutex> lk(tracersMutex());
+  for (Tracer *tracer : tracers())
+    tracer->Flush();
+}
+
+//////////////////////////////////////////////////
+/// \brief Write an identifier in hexadecimal, as a JSON string.
+/// \param[in] _id The identifier.
+/// \param[in,out] _out String to append to.
+static void appendId(const uint64_t _id, std::string &_out)
+{
+  char buffer[24];
+  std::snprintf(buffer, sizeof(buffer), "\"0x%016llx\"",
+    static_cast<unsigned long long>(_id));  // NOLINT
+  _out += buffer;
+}
+
+//////////////////////////////////////////////////
+/// \brief Write a string as a JSON string.
+/// \param[in] _str The string.
+/// \param[in,out] _out String to append to.
+static void appendString(const std::string &_str, std::string &_out)
+{
+  _out += '"';
+  for (const char c : _str)
+  {
+    if (c == '"' || c == '\\')
+      _out += '\\';
+    if (static_cast<unsigned char>(c) >= 0x20)
+      _out += c;
+  }
+  _out += '"';
+}
+
+//////////////////////////////////////////////////
+/// \brief Small identifier of the calling thread, for the trace viewer.
+/// \return The identifier.
+static uint64_t threadId()
+{
+  static std::atomic<uint64_t> next{1};
+  thread_local const uint64_t id = next++;
+  return id;
+}
+
+//////////////////////////////////////////////////
+Tracer::Tracer(const std::string &_path)
+  : file(_path, std::ios::trunc)
+{
+  if (!this->file)
+  {
+    std::cerr << "Unable to open the trace file [" << _path << "]"
+              << std::endl;
+    return;
+  }
+  this->file << "[\n";
+  this->lastFlush = Now();
+
+  static std::once_flag registered;
+  std::call_once(registered, []{std::atexit(flushTracers);});
+
+  std::lock_guard<std::mutex> lk(tracersMutex());
+  tracers().push_back(this);
+}
+
+//////////////////////////////////////////////////
+Tracer::~Tracer()
+{
+  {
+    std::lock_guard<std::mutex> lk(tracersMutex());
+    auto &instances = tracers();
+    instances.erase(std::remove(instances.begin(), instances.end(), this),
+      instances.end());
+  }
+  this->Flush();
+}
+
+//////////////////////////////////////////////////
+bool Tracer::Valid() const
+{
+  return this->file.is_open();
+}
+
+//////////////////////////////////////////////////
+void Tracer::Record(const char *_name, const std::string &_topic,
+  const int64_t _start, const int64_t _end, const TraceContext &_span,
+  const uint64_t _parent, const uint32_t _flags)
+{
+  if (!this->Valid())
+    return;
+
+  // Events common to a span and its arrows.
+  std::string common = ",\"pid\":" + std::to_string(getProcessId()) +
+    ",\"tid\":" + std::to_string(threadId()) +
+    ",\"ts\":" + std::to_string(_start);
+
+  std::string event = "{\"name\":";
+  appendString(_name, event);
+  event += ",\"cat\":\"gz\",\"ph\":\"X\"" + common + ",\"dur\":" +
+    std::to_string(std::max<int64_t>(_end - _start, 0)) +
+    ",\"args\":{\"topic\":";
+  appendString(_topic, event);
+  event += ",\"trace\":";
+  appendId(_span.traceId, event);
+  event += ",\"span\":";
+  appendId(_span.spanId, event);
+  if (_parent != 0)
+  {
+    event += ",\"parent\":";
+    appendId(_parent, event);
+  }
+  event += "}},\n";
+
+  if ((_flags & kFlowIn) && _parent != 0)
+  {
+    event += "{\"name\":\"message\",\"cat\":\"gz\",\"ph\":\"f\",\"bp\":\"e\","
+      "\"id\":";
+    appendId(_parent, event);
+    event += common + "},\n";
+  }
+
+  if (_flags & kFlowOut)
+  {
+    event += "{\"name\":\"message\",\"cat\":\"gz\",\"ph\":\"s\",\"id\":";
+    appendId(_span.spanId, event);
+    event += common + "},\n";
+  }
+
+  std::lock_guard<std::mutex> lk(this->mutex);
+  this->pending += event;
+  if (this->pending.size() >= kFlushSize ||
+      _end - this->lastFlush >= kFlushPeriod)
+  {
+    this->file << this->pending;
+    this->file.flush();
+    this->pending.clear();
+    this->lastFlush = _end;
+  }
+}
+
+//////////////////////////////////////////////////
+void Tracer::Flush()
+{
+  std::lock_guard<std::mutex> lk(this->mutex);
+  if (!this->Valid())
+    return;
+
+  this->file << this->pending;
+  this->file.flush();
+  this->pending.clear();
+  this->lastFlush = Now();
+}
+
+//////////////////////////////////////////////////
+int64_t Tracer::Now()
+{
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+    std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+//////////////////////////////////////////////////
+uint64_t Tracer::NewId()
+{
+  thread_local std::mt19937_64 generator(std::random_device{}());
+  uint64_t id;
+  do
+  {
+    id = generator();
+  } while (id == 0);
+  return id;
+}
+
+//////////////////////////////////////////////////
+TraceContext &Tracer::Current()
+{
+  thread_local TraceContext current;
+  return current;
+}
+
+//////////////////////////////////////////////////
+TraceScope::TraceScope(Tracer *_tracer, const char *_name,
+  const std::string &_topic, const uint32_t _flags)
+  : tracer(_tracer), name(_name), topic(_topic), flags(_flags)
+{
+  if (this->tracer)
+    this->Start(Tracer::Current());
+}
+
+//////////////////////////////////////////////////
+TraceScope::TraceScope(Tracer *_tracer, const char *_name,
+  const std::string &_topic, const TraceContext &_parent,
+  const uint32_t _flags)
+  : tracer(_parent.traceId != 0 ? _tracer : nullptr), name(_name),
+    topic(_topic), flags(_flags)
+{
+  if (this->tracer)
+    this->Start(_parent);
+}
+
+//////////////////////////////////////////////////
+void TraceScope::Start(const TraceContext &_parent)
+{
+  this->previous = Tracer::Current();
+  this->parent = _parent.spanId;
+  this->span.traceId =
+    _parent.traceId != 0 ? _parent.traceId : Tracer::NewId();
+  this->span.spanId = Tracer::NewId();
+  this->start = Tracer::Now();
+  Tracer::Current() = this->span;
+}
+
+//////////////////////////////////////////////////
+TraceScope::~TraceScope()
+{
+  if (!this->tracer)
+    return;
+
+  Tracer::Current() = this->previous;
+  this->tracer->Record(this->name, this->topic, this->start, Tracer::Now(),
+    this->span, this->parent, this->flags);
+}
+
+//////////////////////////////////////////////////
+const TraceContext &TraceScope::Span() const
+{
+  return this->span;
+}
@@ -0,0 +1,192 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GZ_TRANSPORT_TRACER_HH_
+#define GZ_TRANSPORT_TRACER_HH_
+
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+
+#include "gz/transport/config.hh"
+
+namespace gz
+{
+  namespace transport
+  {
+    inline namespace GZ_TRANSPORT_VERSION_NAMESPACE
+    {
+    /// \internal
+    /// \brief Identifies a span of a trace. The context of the span that
+    /// published a message is sent along with the message, see
+    /// PublicationMetadata.
+    struct TraceContext
+    {
+      /// \brief Trace (a chain of publications and callbacks), or 0 if the
+      /// message is not traced.
+      uint64_t traceId = 0;
+
+      /// \brief Span within the trace.
+      uint64_t spanId = 0;
+    };
+
+    /// \internal
+    /// \brief Records the spans of the traced messages to a file in the
+    /// JSON array format of the Chrome trace viewer, which Perfetto also
+    /// opens. The events are appended to the file as they are recorded, the
+    /// closing bracket is optional in this format. The timestamps use the
+    /// system clock, so the files of several processes of a host can be
+    /// concatenated into one timeline.
+    class Tracer
+    {
+      /// \brief The span draws an arrow to the spans linked to it.
+      public: static const uint32_t kFlowOut = 1;
+
+      /// \brief The span ends the arrow of its parent span.
+      public: static const uint32_t kFlowIn = 2;
+
+      /// \brief Constructor.
+      /// \param[in] _path Path of the file, created or truncated.
+      public: explicit Tracer(const std::string &_path);
+
+      /// \brief Destructor. Write the pending events.
+      public: ~Tracer();
+
+      /// \brief Whether the file could be opened.
+      /// \return True if the spans are recorded.
+      public: bool Valid() const;
+
+      /// \brief Record a span.
+      /// \param[in] _name Name of the span, e.g.: "publish".
+      /// \param[in] _topic Topic of the message.
+      /// \param[in] _start Start of the span (us), see Now().
+      /// \param[in] _end End of the span (us).
+      /// \param[in] _span The span.
+      /// \param[in] _parent Parent span, or 0.
+      /// \param[in] _flags Bitmask of kFlowOut and kFlowIn.
+      public: void Record(const char *_name, const std::string &_topic,
+                          const int64_t _start, const int64_t _end,
+                          const TraceContext &_span, const uint64_t _parent,
+                          const uint32_t _flags = 0);
+
+      /// \brief Write the pending events to the file.
+      public: void Flush();
+
+      /// \brief Current time (us since the epoch of the system clock).
+      /// \return The time.
+      public: static int64_t Now();
+
+      /// \brief Create a random identifier of a trace or a span.
+      /// \return The identifier, never 0.
+      public: static uint64_t NewId();
+
+      /// \brief The span that the calling thread is running, e.g.: the
+      /// callback of a traced message. The messages published meanwhile
+      /// are part of its trace.
+      /// \return The span, traceId is 0 if there is none.
+      public: static TraceContext &Current();
+
+      /// \brief The file.
+      private: std::ofstream file;
+
+      /// \brief Events not written yet.
+      private: std::string pending;
+
+      /// \brief When the pending events were last written (us).
+      private: int64_t lastFlush = 0;
+
+      /// \brief Protect file, pending and lastFlush.
+      private: std::mutex mutex;
+    };
+
+    /// \internal
+    /// \brief Record a span covering the lifetime of this object. The span
+    /// is a child of the current span of the thread (a new trace starts
+    /// otherwise) and becomes the current span until it ends. Nothing is
+    /// done without a tracer.
+    class TraceScope
+    {
+      /// \brief Constructor.
+      /// \param[in] _tracer The tracer, or nullptr.
+      /// \param[in] _name Name of the span. The string must outlive this
+      /// object.
+      /// \param[in] _topic Topic of the message. The string must outlive
+      /// this object.
+      /// \param[in] _flags Bitmask of Tracer::kFlowOut and Tracer::kFlowIn.
+      public: TraceScope(Tracer *_tracer, const char *_name,
+                         const std::string &_topic, const uint32_t _flags = 0);
+
+      /// \brief Constructor of a span with an explicit parent, e.g.: the
+      /// span that published the message received.
+      /// \param[in] _tracer The tracer, or nullptr.
+      /// \param[in] _name Name of the span.
+      /// \param[in] _topic Topic of the message.
+      /// \param[in] _parent The parent span. Nothing is recorded if it is
+      /// not traced.
+      /// \param[in] _flags Bitmask of Tracer::kFlowOut and Tracer::kFlowIn.
+      public: TraceScope(Tracer *_tracer, const char *_name,
+                         const std::string &_topic,
+                         const TraceContext &_parent,
+                         const uint32_t _flags = 0);
+
+      /// \brief Destructor. Record the span and restore the previous span
+      /// of the thread.
+      public: ~TraceScope();
+
+      /// \brief No copy constructor.
+      public: TraceScope(const TraceScope &) = delete;
+
+      /// \brief No assignment operator.
+      public: TraceScope &operator=(const TraceScope &) = delete;
+
+      /// \brief Get the span.
+      /// \return The span, traceId is 0 if nothing is recorded.
+      public: const TraceContext &Span() const;
+
+      /// \brief Start the span.
+      /// \param[in] _parent The parent span.
+      private: void Start(const TraceContext &_parent);
+
+      /// \brief The tracer, or nullptr if nothing is recorded.
+      private: Tracer *tracer;
+
+      /// \brief Name of the span.
+      private: const char *name;
+
+      /// \brief Topic of the message.
+      private: const std::string &topic;
+
+      /// \brief Bitmask of Tracer::kFlowOut and Tracer::kFlowIn.
+      private: uint32_t flags;
+
+      /// \brief The span.
+      private: TraceContext span;
+
+      /// \brief The parent span.
+      private: uint64_t parent = 0;
+
+      /// \brief Previous span of the thread.
+      private: TraceContext previous;
+
+      /// \brief Start of the span (us).
+      private: int64_t start = 0;
+    };
+    }
+  }
+}
+#endif
@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "Tracer.hh"
+#include "gtest/gtest.h"
+
+#include "test_utils.hh"
+
+using namespace gz;
+using namespace transport;
+
+//////////////////////////////////////////////////
+/// \brief Read a trace file.
+/// \param[in] _path Path of the file.
+/// \return The content.
+static std::string readTrace(const std::filesystem::path &_path)
+{
+  std::ifstream in(_path);
+  std::stringstream content;
+  content << in.rdbuf();
+  return content.str();
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that the spans are nested and propagated.
+TEST(TracerTest, Scopes)
+{
+  const std::filesystem::path path = std::filesystem::temp_directory_path() /
+    ("gz_trace_" + testing::getRandomNumber() + ".json");
+  const std::string topic = "@@/foo";
+
+  TraceContext sent;
+  {
+    Tracer tracer(path.string());
+    ASSERT_TRUE(tracer.Valid());
+
+    // Nothing is recorded without a tracer.
+    {
+      TraceScope scope(nullptr, "publish", topic);
+      EXPECT_EQ(0u, scope.Span().traceId);
+      EXPECT_EQ(0u, Tracer::Current().traceId);
+    }
+
+    // A publication starts a trace, and it's the current span meanwhile.
+    {
+      TraceScope publish(&tracer, "publish", topic, Tracer::kFlowOut);
+      sent = publish.Span();
+      EXPECT_NE(0u, sent.traceId);
+      EXPECT_NE(0u, sent.spanId);
+      EXPECT_EQ(sent.spanId, Tracer::Current().spanId);
+
+      TraceScope send(&tracer, "send", topic);
+      EXPECT_EQ(sent.traceId, send.Span().traceId);
+      EXPECT_NE(sent.spanId, send.Span().spanId);
+    }
+    EXPECT_EQ(0u, Tracer::Current().traceId);
+
+    // A callback in another thread continues the trace of the message.
+    std::thread thread([&]()
+    {
+      TraceScope callback(&tracer, "callback", topic, sent, Tracer::kFlowIn);
+      EXPECT_EQ(sent.traceId, callback.Span().traceId);
+
+      // A message published by the callback is part of the trace.
+      TraceScope publish(&tracer, "publish", topic);
+      EXPECT_EQ(sent.traceId, publish.Span().traceId);
+    });
+    thread.join();
+
+    // A message without a trace is not traced.
+    TraceScope untraced(&tracer, "callback", topic, TraceContext());
+    EXPECT_EQ(0u, untraced.Span().traceId);
+  }
+
+  const std::string trace = readTrace(path);
+  std::filesystem::remove(path);
+
+  EXPECT_EQ(0u, trace.find("[\n"));
+  EXPECT_NE(std::string::npos, trace.find("\"name\":\"publish\""));
+  EXPECT_NE(std::string::npos, trace.find("\"name\":\"send\""));
+  EXPECT_NE(std::string::npos, trace.find("\"name\":\"callback\""));
+  EXPECT_NE(std::string::npos, trace.find("\"topic\":\"@@/foo\""));
+
+  // The arrow goes from the publication to the callback.
+  char id[24];
+  std::snprintf(id, sizeof(id), "\"0x%016llx\"",
+    static_cast<unsigned long long>(sent.spanId));  // NOLINT
+  EXPECT_NE(std::string::npos,
+    trace.find(std::string("\"ph\":\"s\",\"id\":") + id));
+  EXPECT_NE(std::string::npos,
+    trace.find(std::string("\"ph\":\"f\",\"bp\":\"e\",\"id\":") + id));
+
+  // 4 spans and 2 flow events.
+  std::size_t events = 0;
+  for (std::size_t pos = trace.find("\"cat\":\"gz\""); pos != std::string::npos;
+       pos = trace.find("\"cat\":\"gz\"", pos + 1))
+  {
+    ++events;
+  }
+  EXPECT_EQ(6u, events);
+}
+
+//////////////////////////////////////////////////
+/// \brief Check a file that can't be created.
+TEST(TracerTest, InvalidPath)
+{
+  Tracer tracer("/this/path/does/not/exist.json");
+  EXPECT_FALSE(tracer.Valid());
+  tracer.Record("publish", "@@/foo", 0, 1, TraceContext(), 0);
+  tracer.Flush();
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gz/transport/TransportBackend.hh"
+
+using namespace gz;
+using namespace transport;
+
+//////////////////////////////////////////////////
+/// \brief The backends registered, by name.
+struct BackendRegistry
+{
+  /// \brief Protects the factories.
+  std::mutex mutex;
+
+  /// \brief Function creating each backend.
+  std::map<std::string, TransportBackend::Factory> factories;
+};
+
+//////////////////////////////////////////////////
+/// \brief Get the registry of the backends. It is created on first use, the
+/// backends might be registered from static initializers.
+/// \return The registry.
+static BackendRegistry &registry()
+{
+  static BackendRegistry backends;
+  return backends;
+}
+
+//////////////////////////////////////////////////
+bool TransportBackend::Register(const std::string &_name, Factory _factory)
+{
+  if (_name.empty() || _name == kZmq || !_factory)
+    return false;
+
+  BackendRegistry &backends = registry();
+  std::lock_guard<std::mutex> lk(backends.mutex);
+  return backends.factories.emplace(_name, std::move(_factory)).second;
+}
+
+//////////////////////////////////////////////////
+std::unique_ptr<TransportBackend> TransportBackend::Create(
+  const std::string &_name)
+{
+  Factory factory;
+  {
+    BackendRegistry &backends = registry();
+    std::lock_guard<std::mutex> lk(backends.mutex);
+    auto it = backends.factories.find(_name);
+    if (it == backends.factories.end())
+      return nullptr;
+    factory = it->second;
+  }
+  return factory();
+}
+
+//////////////////////////////////////////////////
+std::vector<std::string> TransportBackend::Names()
+{
+  std::vector<std::string> names;
+  names.push_back(kZmq);
+
+  BackendRegistry &backends = registry();
+  std::lock_guard<std::mutex> lk(backends.mutex);
+  for (const auto &backend : backends.factories)
+    names.push_back(backend.first);
+  std::sort(names.begin(), names.end());
+  return names;
+}
@@ -0,0 +1,165 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gz/transport/TransportBackend.hh"
+#include "gtest/gtest.h"
+
+using namespace gz;
+using namespace transport;
+
+//////////////////////////////////////////////////
+/// \brief A backend sending the messages back to its own listener.
+class LoopbackBackend : public TransportBackend
+{
+  // Documentation inherited.
+  public: bool Start(const std::string &_pUuid,
+                     TransportBackendListener &_listener) override
+  {
+    this->address = "loopback://" + _pUuid;
+    this->listener = &_listener;
+    return true;
+  }
+
+  // Documentation inherited.
+  public: std::string Address() const override
+  {
+    return this->address;
+  }
+
+  // Documentation inherited.
+  public: bool Publish(const std::string &_topic,
+                       const std::string &_msgType,
+                       const char *_data,
+                       const std::size_t _size) override
+  {
+    this->listener->OnMessage(_topic, _msgType, _data, _size);
+    return true;
+  }
+
+  // Documentation inherited.
+  public: void Connect(const MessagePublisher &) override
+  {
+  }
+
+  // Documentation inherited.
+  public: void Disconnect(const std::string &, const std::string &) override
+  {
+  }
+
+  // Documentation inherited.
+  public: bool Request(const std::string &,
+                       const BackendRequest &_request) override
+  {
+    this->listener->OnRequest(_request,
+      [this, _request](const std::string &_rep, const bool _result)
+      {
+        this->listener->OnResponse(_request.topic, _request.nodeUuid,
+          _request.reqUuid, _rep, _result);
+      });
+    return true;
+  }
+
+  /// \brief Address of the backend.
+  private: std::string address;
+
+  /// \brief Receives the data.
+  private: TransportBackendListener *listener = nullptr;
+};
+
+//////////////////////////////////////////////////
+/// \brief Records the data delivered by a backend and answers the
+/// requests with their data.
+class RecordingListener : public TransportBackendListener
+{
+  // Documentation inherited.
+  public: void OnMessage(const std::string &_topic,
+                         const std::string &,
+                         const char *_data,
+                         const std::size_t _size) override
+  {
+    this->messages.push_back(_topic + ":" + std::string(_data, _size));
+  }
+
+  // Documentation inherited.
+  public: void OnRequest(const BackendRequest &_request,
+                         ReplyFunc _reply) override
+  {
+    _reply(_request.data, true);
+  }
+
+  // Documentation inherited.
+  public: void OnResponse(const std::string &,
+                          const std::string &,
+                          const std::string &_reqUuid,
+                          const std::string &_rep,
+                          const bool _result) override
+  {
+    this->responses.push_back(_reqUuid + ":" + _rep);
+    EXPECT_TRUE(_result);
+  }
+
+  /// \brief Messages received, as "<topic>:<data>".
+  public: std::vector<std::string> messages;
+
+  /// \brief Responses received, as "<request uuid>:<response>".
+  public: std::vector<std::string> responses;
+};
+
+//////////////////////////////////////////////////
+/// \brief The backends are created by name, the built-in one can't be
+/// replaced.
+TEST(TransportBackendTest, Registry)
+{
+  EXPECT_EQ(nullptr, TransportBackend::Create("loopback"));
+  EXPECT_EQ(nullptr, TransportBackend::Create(TransportBackend::kZmq));
+
+  auto factory = []
+  {
+    return std::make_unique<LoopbackBackend>();
+  };
+  EXPECT_FALSE(TransportBackend::Register("", factory));
+  EXPECT_FALSE(TransportBackend::Register(TransportBackend::kZmq, factory));
+  EXPECT_FALSE(TransportBackend::Register("loopback", nullptr));
+  EXPECT_TRUE(TransportBackend::Register("loopback", factory));
+  EXPECT_FALSE(TransportBackend::Register("loopback", factory));
+
+  EXPECT_EQ(std::vector<std::string>({"loopback", "zmq"}),
+    TransportBackend::Names());
+
+  auto backend = TransportBackend::Create("loopback");
+  ASSERT_NE(nullptr, backend);
+  RecordingListener listener;
+  ASSERT_TRUE(backend->Start("p1", listener));
+  EXPECT_EQ("loopback://p1", backend->Address());
+
+  const std::string data = "data";
+  EXPECT_TRUE(backend->Publish("/foo", "gz.msgs.StringMsg", data.data(),
+    data.size()));
+  EXPECT_EQ(std::vector<std::string>({"/foo:data"}), listener.messages);
+
+  BackendRequest request;
+  request.topic = "/srv";
+  request.reqUuid = "r1";
+  request.data = "req";
+  EXPECT_TRUE(backend->Request(backend->Address(), request));
+  EXPECT_EQ(std::vector<std::string>({"r1:req"}), listener.responses);
+}
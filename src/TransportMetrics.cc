@@ -0,0 +1,368 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gz/msgs/statistic.pb.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>  //NOLINT
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "TransportMetrics.hh"
+
+using namespace gz;
+using namespace transport;
+
+/// \brief Percentiles of the dispatch latency, as a Prometheus quantile
+/// label and as a statistic name.
+static const struct
+{
+  const char *quantile;
+  const char *name;
+  double percent;
+} kPercentiles[] =
+{
+  {"0.5", "p50", 50.0}, {"0.9", "p90", 90.0}, {"0.99", "p99", 99.0},
+  {"0.999", "p999", 99.9}
+};
+
+//////////////////////////////////////////////////
+/// \brief Escape a Prometheus label value.
+/// \param[in] _value The value.
+/// \return The value with its backslashes, quotes and line feeds escaped.
+static std::string escapeLabel(const std::string &_value)
+{
+  std::string escaped;
+  escaped.reserve(_value.size());
+  for (const char c : _value)
+  {
+    if (c == '\\' || c == '"')
+    {
+      escaped += '\\';
+      escaped += c;
+    }
+    else if (c == '\n')
+    {
+      escaped += "\\n";
+    }
+    else
+    {
+      escaped += c;
+    }
+  }
+  return escaped;
+}
+
+//////////////////////////////////////////////////
+const char *TransportMetrics::CounterName(const Counter _counter)
+{
+  static const char *kNames[NUM_COUNTERS] =
+  {
+    "sent_messages", "sent_bytes", "send_failures", "received_messages",
+    "received_bytes", "queue_dropped_messages", "service_requests",
+    "service_responses", "huge_page_buffers", "huge_page_faults_saved"
+  };
+  return _counter < NUM_COUNTERS ? kNames[_counter] : "";
+}
+
+//////////////////////////////////////////////////
+void TransportMetrics::Add(const std::string &_topic, const Counter _counter,
+  const uint64_t _count)
+{
+  {
+    std::shared_lock<std::shared_mutex> lk(this->topicsMutex);
+    auto it = this->topics.find(_topic);
+    if (it != this->topics.end())
+    {
+      it->second->values[_counter].fetch_add(_count,
+        std::memory_order_relaxed);
+      return;
+    }
+  }
+
+  std::unique_lock<std::shared_mutex> lk(this->topicsMutex);
+  auto &entry = this->topics[_topic];
+  if (!entry)
+    entry = std::make_unique<TopicCounters>();
+  entry->values[_counter].fetch_add(_count, std::memory_order_relaxed);
+}
+
+//////////////////////////////////////////////////
+uint64_t TransportMetrics::Value(const std::string &_topic,
+  const Counter _counter) const
+{
+  std::shared_lock<std::shared_mutex> lk(this->topicsMutex);
+  auto it = this->topics.find(_topic);
+  if (it == this->topics.end())
+    return 0;
+  return it->second->values[_counter].load(std::memory_order_relaxed);
+}
+
+//////////////////////////////////////////////////
+void TransportMetrics::AddDispatchLatency(const double _latency)
+{
+  std::lock_guard<std::mutex> lk(this->mutex);
+  this->dispatchLatency.Update(_latency);
+}
+
+//////////////////////////////////////////////////
+void TransportMetrics::SetSample(const std::string &_name,
+  const double _value)
+{
+  std::lock_guard<std::mutex> lk(this->mutex);
+  this->samples[_name] = _value;
+}
+
+//////////////////////////////////////////////////
+void TransportMetrics::SetCallbackStats(
+  const std::vector<CallbackStatistics> &_stats)
+{
+  std::lock_guard<std::mutex> lk(this->mutex);
+  this->callbacks = _stats;
+}
+
+//////////////////////////////////////////////////
+void TransportMetrics::SetTopicStats(const std::string &_topic,
+  const TopicStatistics &_stats)
+{
+  const LatencyHistogram age = _stats.AgeHistogram();
+  TopicSummary summary;
+  for (std::size_t i = 0; i < summary.agePercentiles.size(); ++i)
+    summary.agePercentiles[i] = age.Percentile(kPercentiles[i].percent);
+  summary.ageMax = age.Count() > 0 ? age.Summary().Max() : 0;
+  summary.ageCount = age.Count();
+  summary.dropped = _stats.DroppedMsgCount();
+
+  std::lock_guard<std::mutex> lk(this->mutex);
+  this->topicStats[_topic] = summary;
+}
+
+//////////////////////////////////////////////////
+void TransportMetrics::SetProcess(const std::string &_pUuid,
+  const unsigned int _period)
+{
+  std::lock_guard<std::mutex> lk(this->mutex);
+  this->pUuid = _pUuid;
+  this->period = _period;
+}
+
+//////////////////////////////////////////////////
+std::map<std::string, std::array<uint64_t, TransportMetrics::NUM_COUNTERS>>
+  TransportMetrics::Snapshot() const
+{
+  std::map<std::string, std::array<uint64_t, NUM_COUNTERS>> snapshot;
+  std::shared_lock<std::shared_mutex> lk(this->topicsMutex);
+  for (const auto &topic : this->topics)
+  {
+    auto &values = snapshot[topic.first];
+    for (std::size_t i = 0; i < NUM_COUNTERS; ++i)
+      values[i] = topic.second->values[i].load(std::memory_order_relaxed);
+  }
+  return snapshot;
+}
+
+//////////////////////////////////////////////////
+std::string TransportMetrics::PrometheusText() const
+{
+  const auto snapshot = this->Snapshot();
+  std::ostringstream out;
+
+  // The series of a counter are only exported once it's been updated.
+  for (int i = 0; i < NUM_COUNTERS; ++i)
+  {
+    const std::string name = std::string("gz_transport_") +
+      CounterName(static_cast<Counter>(i)) + "_total";
+    bool typed = false;
+    for (const auto &topic : snapshot)
+    {
+      if (topic.second[i] == 0)
+        continue;
+
+      if (!typed)
+      {
+        out << "# TYPE " << name << " counter\n";
+        typed = true;
+      }
+      out << name << "{topic=\"" << escapeLabel(topic.first) << "\"} "
+          << topic.second[i] << "\n";
+    }
+  }
+
+  std::lock_guard<std::mutex> lk(this->mutex);
+  const uint64_t count = this->dispatchLatency.Count();
+  if (count > 0)
+  {
+    const std::string name = "gz_transport_dispatch_latency_seconds";
+    out << "# TYPE " << name << " summary\n";
+    for (const auto &percentile : kPercentiles)
+    {
+      out << name << "{quantile=\"" << percentile.quantile << "\"} "
+          << this->dispatchLatency.Percentile(percentile.percent) / 1000.0
+          << "\n";
+    }
+    out << name << "_sum "
+        << this->dispatchLatency.Summary().Avg() * count / 1000.0 << "\n"
+        << name << "_count " << count << "\n";
+  }
+
+  for (const auto &sample : this->samples)
+  {
+    const std::string &key = sample.first;
+    const bool counter = key.size() > 6 &&
+      key.compare(key.size() - 6, 6, "_total") == 0;
+    out << "# TYPE gz_transport_" << key
+        << (counter ? " counter\n" : " gauge\n")
+        << "gz_transport_" << key << " " << sample.second << "\n";
+  }
+
+  if (!this->callbacks.empty())
+  {
+    const struct
+    {
+      const char *name;
+      const char *type;
+      std::function<double(const CallbackStatistics &)> value;
+    } kCallbackMetrics[] =
+    {
+      {"gz_transport_callback_calls_total", "counter",
+       [](const CallbackStatistics &_s)
+       {return static_cast<double>(_s.calls);}},
+      {"gz_transport_callback_seconds_total", "counter",
+       [](const CallbackStatistics &_s)
+       {return std::chrono::duration<double>(_s.totalDuration).count();}},
+      {"gz_transport_callback_max_seconds", "gauge",
+       [](const CallbackStatistics &_s)
+       {return std::chrono::duration<double>(_s.maxDuration).count();}}
+    };
+    for (const auto &metric : kCallbackMetrics)
+    {
+      out << "# TYPE " << metric.name << " " << metric.type << "\n";
+      for (const CallbackStatistics &callback : this->callbacks)
+      {
+        out << metric.name << "{topic=\"" << escapeLabel(callback.topic)
+            << "\",handler=\"" << callback.handlerUuid << "\"} "
+            << metric.value(callback) << "\n";
+      }
+    }
+  }
+
+  return out.str();
+}
+
+//////////////////////////////////////////////////
+void TransportMetrics::FillMessage(msgs::Metric &_msg) const
+{
+  _msg.set_unit("milliseconds");
+  const auto snapshot = this->Snapshot();
+
+  std::lock_guard<std::mutex> lk(this->mutex);
+  for (const auto &topic : snapshot)
+  {
+    msgs::StatisticsGroup *group = _msg.add_statistics_groups();
+    group->set_name(topic.first);
+    for (int i = 0; i < NUM_COUNTERS; ++i)
+    {
+      msgs::Statistic *stat = group->add_statistics();
+      stat->set_type(msgs::Statistic::SAMPLE_COUNT);
+      stat->set_name(CounterName(static_cast<Counter>(i)));
+      stat->set_value(static_cast<double>(topic.second[i]));
+    }
+
+    auto summaryIt = this->topicStats.find(topic.first);
+    if (summaryIt == this->topicStats.end())
+      continue;
+
+    const TopicSummary &summary = summaryIt->second;
+    for (std::size_t i = 0; i < summary.agePercentiles.size(); ++i)
+    {
+      msgs::Statistic *stat = group->add_statistics();
+      stat->set_name(std::string("age_") + kPercentiles[i].name);
+      stat->set_value(summary.agePercentiles[i]);
+    }
+    msgs::Statistic *stat = group->add_statistics();
+    stat->set_type(msgs::Statistic::MAXIMUM);
+    stat->set_name("age_max");
+    stat->set_value(summary.ageMax);
+    stat = group->add_statistics();
+    stat->set_type(msgs::Statistic::SAMPLE_COUNT);
+    stat->set_name("age_count");
+    stat->set_value(static_cast<double>(summary.ageCount));
+    stat = group->add_statistics();
+    stat->set_type(msgs::Statistic::SAMPLE_COUNT);
+    stat->set_name("dropped_messages");
+    stat->set_value(static_cast<double>(summary.dropped));
+  }
+
+  msgs::StatisticsGroup *group = _msg.add_statistics_groups();
+  group->set_name("dispatch_latency");
+  for (const auto &percentile : kPercentiles)
+  {
+    msgs::Statistic *stat = group->add_statistics();
+    stat->set_name(percentile.name);
+    stat->set_value(this->dispatchLatency.Percentile(percentile.percent));
+  }
+  msgs::Statistic *stat = group->add_statistics();
+  stat->set_type(msgs::Statistic::SAMPLE_COUNT);
+  stat->set_name("count");
+  stat->set_value(static_cast<double>(this->dispatchLatency.Count()));
+
+  for (const CallbackStatistics &callback : this->callbacks)
+  {
+    group = _msg.add_statistics_groups();
+    group->set_name(std::string(kCallbackGroupPrefix) + callback.topic +
+      " " + callback.handlerUuid);
+    stat = group->add_statistics();
+    stat->set_type(msgs::Statistic::SAMPLE_COUNT);
+    stat->set_name("calls");
+    stat->set_value(static_cast<double>(callback.calls));
+    stat = group->add_statistics();
+    stat->set_type(msgs::Statistic::SUM);
+    stat->set_name("total");
+    stat->set_value(std::chrono::duration<double, std::milli>(
+      callback.totalDuration).count());
+    stat = group->add_statistics();
+    stat->set_type(msgs::Statistic::MAXIMUM);
+    stat->set_name("max");
+    stat->set_value(std::chrono::duration<double, std::milli>(
+      callback.maxDuration).count());
+  }
+
+  if (!this->pUuid.empty())
+  {
+    group = _msg.add_statistics_groups();
+    group->set_name(std::string(kProcessGroupPrefix) + this->pUuid);
+    stat = group->add_statistics();
+    stat->set_name("period");
+    stat->set_value(static_cast<double>(this->period));
+  }
+
+  for (const auto &sample : this->samples)
+  {
+    stat = _msg.add_statistics();
+    stat->set_name(sample.first);
+    stat->set_value(sample.second);
+  }
+}
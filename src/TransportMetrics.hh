@@ -0,0 +1,218 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GZ_TRANSPORT_TRANSPORTMETRICS_HH_
+#define GZ_TRANSPORT_TRANSPORTMETRICS_HH_
+
+#include <gz/msgs/statistic.pb.h>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>  //NOLINT
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "gz/transport/CallbackStatistics.hh"
+#include "gz/transport/TopicStatistics.hh"
+#include "gz/transport/config.hh"
+
+namespace gz
+{
+  namespace transport
+  {
+    inline namespace GZ_TRANSPORT_VERSION_NAMESPACE
+    {
+    /// \internal
+    /// \brief Registry of the metrics of a NodeShared, enabled with
+    /// GZ_TRANSPORT_METRICS=1. The counters are updated by the publishers,
+    /// the reception thread and the service threads without contending on
+    /// NodeShared::mutex. NodeShared samples the other values (e.g.: the
+    /// depth of the publish queues) and exports everything periodically.
+    class TransportMetrics
+    {
+      /// \brief Counters kept per topic or service.
+      public: enum Counter
+      {
+        /// \brief Publications sent through the ZMQ socket.
+        SENT_MSGS = 0,
+        /// \brief Size (bytes) of the publications sent.
+        SENT_BYTES,
+        /// \brief Publications that ZMQ failed to send.
+        SEND_FAILURES,
+        /// \brief Publications received from remote publishers.
+        RECEIVED_MSGS,
+        /// \brief Size (bytes) of the publications received.
+        RECEIVED_BYTES,
+        /// \brief Messages dropped by a full subscriber queue.
+        QUEUE_DROPS,
+        /// \brief Service requests received.
+        SRV_REQUESTS,
+        /// \brief Service responses sent.
+        SRV_RESPONSES,
+        /// \brief Serialization buffers backed by huge pages.
+        HUGE_PAGE_BUFFERS,
+        /// \brief Page faults saved by the huge pages.
+        HUGE_PAGE_FAULTS_SAVED,
+        /// \brief Number of counters.
+        NUM_COUNTERS
+      };
+
+      /// \brief Add to a counter of a topic or service.
+      /// \param[in] _topic Fully qualified topic or service name.
+      /// \param[in] _counter The counter.
+      /// \param[in] _count Value added.
+      public: void Add(const std::string &_topic, const Counter _counter,
+                       const uint64_t _count = 1);
+
+      /// \brief Get a counter of a topic or service.
+      /// \param[in] _topic Fully qualified topic or service name.
+      /// \param[in] _counter The counter.
+      /// \return The value of the counter, 0 if it was never updated.
+      public: uint64_t Value(const std::string &_topic,
+                             const Counter _counter) const;
+
+      /// \brief Add the latency of a message dispatched to the local
+      /// subscribers, from the publication to the dispatch thread.
+      /// \param[in] _latency The latency (ms).
+      public: void AddDispatchLatency(const double _latency);
+
+      /// \brief Set a value sampled when the metrics are exported. The
+      /// values named with a "_total" suffix are exported as counters, the
+      /// other ones as gauges.
+      /// \param[in] _name Name of the value, in the Prometheus format
+      /// without the "gz_transport_" prefix, e.g.: "publish_queue_depth".
+      /// \param[in] _value The value.
+      public: void SetSample(const std::string &_name, const double _value);
+
+      /// \brief Set the execution time of the subscription callbacks,
+      /// sampled when the metrics are exported.
+      /// \param[in] _stats The statistics of each subscription handler.
+      public: void SetCallbackStats(
+                  const std::vector<CallbackStatistics> &_stats);
+
+      /// \brief Set the statistics of a topic with topic statistics
+      /// enabled, sampled when the metrics are exported. Their summary is
+      /// added to the group of the topic in the metric message.
+      /// \param[in] _topic Fully qualified topic name.
+      /// \param[in] _stats The statistics of the topic.
+      public: void SetTopicStats(const std::string &_topic,
+                                 const TopicStatistics &_stats);
+
+      /// \brief Identify the process in the metric message, so the messages
+      /// of several processes can be aggregated, see StatsAggregator.
+      /// \param[in] _pUuid UUID of the process.
+      /// \param[in] _period Period (ms) of the export of the metrics.
+      public: void SetProcess(const std::string &_pUuid,
+                              const unsigned int _period);
+
+      /// \brief Render the metrics in the Prometheus text exposition format.
+      /// \return The metrics, one sample per line.
+      public: std::string PrometheusText() const;
+
+      /// \brief Fill a metric message. There is one group of statistics per
+      /// topic, one for the dispatch latency percentiles, one per
+      /// subscription handler named kCallbackGroupPrefix followed by
+      /// "<topic> <handler UUID>", one named kProcessGroupPrefix followed by
+      /// the process UUID if it's set, and the sampled values are top level
+      /// statistics. The group of a topic with topic statistics also has
+      /// the percentiles of the message age and the messages dropped.
+      /// \param[out] _msg The message.
+      public: void FillMessage(msgs::Metric &_msg) const;
+
+      /// \brief Prefix of the names of the groups of statistics of the
+      /// callbacks in the metric message.
+      public: static constexpr const char *kCallbackGroupPrefix = "callback ";
+
+      /// \brief Prefix of the name of the group identifying the process in
+      /// the metric message. The group has the export period (ms).
+      public: static constexpr const char *kProcessGroupPrefix = "process ";
+
+      /// \brief Topic on which the metrics are published.
+      public: static constexpr const char *kTopic = "/gz/transport/metrics";
+
+      /// \brief Name of a counter, e.g.: "sent_messages".
+      /// \param[in] _counter The counter.
+      /// \return The name.
+      public: static const char *CounterName(const Counter _counter);
+
+      /// \brief Counters of a topic.
+      private: struct TopicCounters
+      {
+        /// \brief Values of the counters.
+        std::array<std::atomic<uint64_t>, NUM_COUNTERS> values{};
+      };
+
+      /// \brief Copy the counters, sorted by topic.
+      /// \return Counters by topic.
+      private: std::map<std::string, std::array<uint64_t, NUM_COUNTERS>>
+        Snapshot() const;
+
+      /// \brief Counters by topic. The entries are never removed.
+      private: std::unordered_map<std::string,
+                 std::unique_ptr<TopicCounters>> topics;
+
+      /// \brief Protect topics. New entries take an exclusive lock.
+      private: mutable std::shared_mutex topicsMutex;
+
+      /// \brief Latencies of the local dispatch.
+      private: LatencyHistogram dispatchLatency;
+
+      /// \brief Values sampled when the metrics are exported.
+      private: std::map<std::string, double> samples;
+
+      /// \brief Execution time of the subscription callbacks.
+      private: std::vector<CallbackStatistics> callbacks;
+
+      /// \brief Summary of the statistics of a topic.
+      private: struct TopicSummary
+      {
+        /// \brief Percentiles of the message age (ms), see kPercentiles.
+        std::array<double, 4> agePercentiles{};
+
+        /// \brief Maximum message age (ms).
+        double ageMax = 0;
+
+        /// \brief Number of messages in the age histogram.
+        uint64_t ageCount = 0;
+
+        /// \brief Messages dropped, detected from the sequence numbers.
+        uint64_t dropped = 0;
+      };
+
+      /// \brief Summary of the topics with topic statistics enabled.
+      private: std::map<std::string, TopicSummary> topicStats;
+
+      /// \brief UUID of the process, empty if it's not identified.
+      private: std::string pUuid;
+
+      /// \brief Period (ms) of the export of the metrics.
+      private: unsigned int period = 0;
+
+      /// \brief Protect dispatchLatency, samples, callbacks, topicStats,
+      /// pUuid and period.
+      private: mutable std::mutex mutex;
+    };
+    }
+  }
+}
+#endif
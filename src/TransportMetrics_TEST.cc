@@ -0,0 +1,195 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gz/msgs/statistic.pb.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "TransportMetrics.hh"
+#include "gtest/gtest.h"
+
+using namespace gz;
+using namespace transport;
+
+//////////////////////////////////////////////////
+/// \brief Check the counters updated from several threads.
+TEST(TransportMetricsTest, Counters)
+{
+  TransportMetrics metrics;
+  EXPECT_EQ(0u, metrics.Value("@@/foo", TransportMetrics::SENT_MSGS));
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i)
+  {
+    threads.emplace_back([&metrics]()
+    {
+      for (int j = 0; j < 1000; ++j)
+      {
+        metrics.Add("@@/foo", TransportMetrics::SENT_MSGS);
+        metrics.Add("@@/foo", TransportMetrics::SENT_BYTES, 10);
+      }
+    });
+  }
+  for (auto &thread : threads)
+    thread.join();
+
+  EXPECT_EQ(4000u, metrics.Value("@@/foo", TransportMetrics::SENT_MSGS));
+  EXPECT_EQ(40000u, metrics.Value("@@/foo", TransportMetrics::SENT_BYTES));
+  EXPECT_EQ(0u, metrics.Value("@@/foo", TransportMetrics::SEND_FAILURES));
+  EXPECT_EQ(0u, metrics.Value("@@/bar", TransportMetrics::SENT_MSGS));
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the Prometheus text format.
+TEST(TransportMetricsTest, PrometheusText)
+{
+  TransportMetrics metrics;
+  EXPECT_TRUE(metrics.PrometheusText().empty());
+
+  metrics.Add("@@/foo", TransportMetrics::RECEIVED_MSGS, 2);
+  metrics.Add("@@/\"bar\"", TransportMetrics::RECEIVED_MSGS);
+  metrics.Add("@@/srv", TransportMetrics::SRV_REQUESTS);
+  metrics.SetSample("publish_queue_depth", 3);
+  metrics.SetSample("msg_discovery_sent_datagrams_total", 5);
+  for (int i = 1; i <= 100; ++i)
+    metrics.AddDispatchLatency(1.0);
+
+  const std::string text = metrics.PrometheusText();
+  EXPECT_NE(std::string::npos, text.find(
+    "# TYPE gz_transport_received_messages_total counter\n"
+    "gz_transport_received_messages_total{topic=\"@@/\\\"bar\\\"\"} 1\n"
+    "gz_transport_received_messages_total{topic=\"@@/foo\"} 2\n"));
+  EXPECT_NE(std::string::npos, text.find(
+    "gz_transport_service_requests_total{topic=\"@@/srv\"} 1\n"));
+  EXPECT_NE(std::string::npos, text.find(
+    "# TYPE gz_transport_publish_queue_depth gauge\n"
+    "gz_transport_publish_queue_depth 3\n"));
+  EXPECT_NE(std::string::npos, text.find(
+    "# TYPE gz_transport_msg_discovery_sent_datagrams_total counter\n"));
+  EXPECT_NE(std::string::npos, text.find(
+    "gz_transport_dispatch_latency_seconds_count 100\n"));
+
+  // The counters never updated are not exported.
+  EXPECT_EQ(std::string::npos, text.find("sent_messages"));
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the metric message.
+TEST(TransportMetricsTest, FillMessage)
+{
+  TransportMetrics metrics;
+  metrics.Add("@@/foo", TransportMetrics::QUEUE_DROPS, 7);
+  metrics.SetSample("publish_queue_depth", 1);
+  metrics.AddDispatchLatency(2.0);
+
+  msgs::Metric msg;
+  metrics.FillMessage(msg);
+  EXPECT_EQ("milliseconds", msg.unit());
+
+  ASSERT_EQ(2, msg.statistics_groups_size());
+  const msgs::StatisticsGroup &topic = msg.statistics_groups(0);
+  EXPECT_EQ("@@/foo", topic.name());
+  ASSERT_EQ(TransportMetrics::NUM_COUNTERS, topic.statistics_size());
+  const msgs::Statistic &drops =
+    topic.statistics(TransportMetrics::QUEUE_DROPS);
+  EXPECT_EQ("queue_dropped_messages", drops.name());
+  EXPECT_DOUBLE_EQ(7.0, drops.value());
+
+  const msgs::StatisticsGroup &latency = msg.statistics_groups(1);
+  EXPECT_EQ("dispatch_latency", latency.name());
+  ASSERT_EQ(5, latency.statistics_size());
+  EXPECT_EQ("p50", latency.statistics(0).name());
+  EXPECT_NEAR(2.0, latency.statistics(0).value(), 0.2);
+
+  ASSERT_EQ(1, msg.statistics_size());
+  EXPECT_EQ("publish_queue_depth", msg.statistics(0).name());
+  EXPECT_DOUBLE_EQ(1.0, msg.statistics(0).value());
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the export of the execution time of the callbacks.
+TEST(TransportMetricsTest, CallbackStats)
+{
+  CallbackStatistics callback;
+  callback.topic = "@@/foo";
+  callback.handlerUuid = "1234";
+  callback.calls = 4;
+  callback.totalDuration = std::chrono::milliseconds(10);
+  callback.maxDuration = std::chrono::milliseconds(4);
+
+  TransportMetrics metrics;
+  metrics.SetCallbackStats({callback});
+
+  const std::string text = metrics.PrometheusText();
+  EXPECT_NE(std::string::npos, text.find(
+    "# TYPE gz_transport_callback_calls_total counter\n"
+    "gz_transport_callback_calls_total{topic=\"@@/foo\",handler=\"1234\"} "
+    "4\n"));
+  EXPECT_NE(std::string::npos, text.find(
+    "gz_transport_callback_seconds_total{topic=\"@@/foo\",handler=\"1234\"} "
+    "0.01\n"));
+  EXPECT_NE(std::string::npos, text.find(
+    "gz_transport_callback_max_seconds{topic=\"@@/foo\",handler=\"1234\"} "
+    "0.004\n"));
+
+  msgs::Metric msg;
+  metrics.FillMessage(msg);
+  ASSERT_EQ(2, msg.statistics_groups_size());
+  const msgs::StatisticsGroup &group = msg.statistics_groups(1);
+  EXPECT_EQ(std::string(TransportMetrics::kCallbackGroupPrefix) +
+    "@@/foo 1234", group.name());
+  ASSERT_EQ(3, group.statistics_size());
+  EXPECT_EQ("calls", group.statistics(0).name());
+  EXPECT_DOUBLE_EQ(4.0, group.statistics(0).value());
+  EXPECT_EQ("total", group.statistics(1).name());
+  EXPECT_DOUBLE_EQ(10.0, group.statistics(1).value());
+  EXPECT_EQ("max", group.statistics(2).name());
+  EXPECT_DOUBLE_EQ(4.0, group.statistics(2).value());
+
+  // The callbacks are removed when the accounting is disabled.
+  metrics.SetCallbackStats({});
+  EXPECT_EQ(std::string::npos, metrics.PrometheusText().find("callback"));
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the export of the process and of the topic statistics.
+TEST(TransportMetricsTest, ProcessAndTopicStats)
+{
+  TransportMetrics metrics;
+  metrics.SetProcess("1234", 500);
+  metrics.Add("@@/foo", TransportMetrics::RECEIVED_MSGS);
+  metrics.SetTopicStats("@@/foo", TopicStatistics());
+
+  msgs::Metric msg;
+  metrics.FillMessage(msg);
+  ASSERT_EQ(3, msg.statistics_groups_size());
+  const msgs::StatisticsGroup &topic = msg.statistics_groups(0);
+  ASSERT_EQ(TransportMetrics::NUM_COUNTERS + 7, topic.statistics_size());
+  EXPECT_EQ("age_p50", topic.statistics(TransportMetrics::NUM_COUNTERS)
+    .name());
+  EXPECT_EQ("dropped_messages",
+    topic.statistics(TransportMetrics::NUM_COUNTERS + 6).name());
+
+  const msgs::StatisticsGroup &process = msg.statistics_groups(2);
+  EXPECT_EQ(std::string(TransportMetrics::kProcessGroupPrefix) + "1234",
+    process.name());
+  ASSERT_EQ(1, process.statistics_size());
+  EXPECT_EQ("period", process.statistics(0).name());
+  EXPECT_DOUBLE_EQ(500.0, process.statistics(0).value());
+}
@@ -16,9 +16,9 @@
 */
 
 #include <string>
-#include <vector>
 
 #include "gz/transport/Uuid.hh"
+#include "UuidKey.hh"
 
 using namespace gz;
 using namespace transport;
@@ -59,10 +59,89 @@ std::string Uuid::ToString() const
 #else
 /* Unix implementation using libuuid library */
 
+#include <pthread.h>
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+namespace
+{
+  /// \brief Incremented in the child after a fork(), so that the child
+  /// doesn't generate the same UUIDs as its parent.
+  std::atomic<uint64_t> forkGeneration{0};
+
+  /// \brief Random number generator of a thread (xoshiro256**). It is
+  /// seeded once per thread by libuuid, which reads the random device on
+  /// every call.
+  struct UuidGenerator
+  {
+    /// \brief Fill a UUID with random bytes.
+    /// \param[out] _uuid The UUID.
+    void Generate(uuid_t _uuid)
+    {
+      const uint64_t generation = forkGeneration.load();
+      if (!this->seeded || generation != this->generation)
+      {
+        static_assert(sizeof(this->state) == 2 * sizeof(uuid_t),
+          "Two UUIDs seed the generator");
+        uuid_t seed;
+        uuid_generate(seed);
+        std::memcpy(this->state, seed, sizeof(seed));
+        uuid_generate(seed);
+        std::memcpy(this->state + 2, seed, sizeof(seed));
+        this->generation = generation;
+        this->seeded = true;
+      }
+
+      const uint64_t values[2] = {this->Next(), this->Next()};
+      std::memcpy(_uuid, values, sizeof(values));
+    }
+
+    /// \brief Get the next random number.
+    /// \return The number.
+    uint64_t Next()
+    {
+      const uint64_t result = rotl(this->state[1] * 5, 7) * 9;
+      const uint64_t t = this->state[1] << 17;
+      this->state[2] ^= this->state[0];
+      this->state[3] ^= this->state[1];
+      this->state[1] ^= this->state[2];
+      this->state[0] ^= this->state[3];
+      this->state[2] ^= t;
+      this->state[3] = rotl(this->state[3], 45);
+      return result;
+    }
+
+    /// \brief Rotate bits to the left.
+    static uint64_t rotl(const uint64_t _x, const int _k)
+    {
+      return (_x << _k) | (_x >> (64 - _k));
+    }
+
+    /// \brief State of the generator.
+    uint64_t state[4] = {0, 0, 0, 0};
+
+    /// \brief Value of forkGeneration when the generator was seeded.
+    uint64_t generation = 0;
+
+    /// \brief Whether the generator was seeded.
+    bool seeded = false;
+  };
+
+  /// \brief Register the fork handler once per process.
+  const int kForkHandler = pthread_atfork(nullptr, nullptr,
+    []() { ++forkGeneration; });
+}
+
 //////////////////////////////////////////////////
 Uuid::Uuid()
 {
-  uuid_generate(this->data);
+  // A random (version 4) UUID.
+  thread_local UuidGenerator generator;
+  generator.Generate(this->data);
+  this->data[6] = static_cast<unsigned char>((this->data[6] & 0x0f) | 0x40);
+  this->data[8] = static_cast<unsigned char>((this->data[8] & 0x3f) | 0x80);
 }
 
 //////////////////////////////////////////////////
@@ -74,17 +153,9 @@ Uuid::~Uuid()
 //////////////////////////////////////////////////
 std::string Uuid::ToString() const
 {
-  std::vector<char> uuidStr(Uuid::UuidStrLen);
-
-  snprintf(&uuidStr[0], Uuid::UuidStrLen,
-    "%02x%02x%02x%02x-%02x%02x-%02x%02x-%02x%02x-%02x%02x%02x%02x%02x%02x",
-    this->data[0], this->data[1], this->data[2], this->data[3],
-    this->data[4], this->data[5], this->data[6], this->data[7],
-    this->data[8], this->data[9], this->data[10], this->data[11],
-    this->data[12], this->data[13], this->data[14], this->data[15]);
-
-  // Do not include the \0 in the string.
-  return std::string(uuidStr.begin(), uuidStr.end() - 1);
+  std::string uuidStr(kUuidStrLen, '\0');
+  FormatUuid(this->data, &uuidStr[0]);
+  return uuidStr;
 }
 
 #endif
@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <cstdint>
+#include <string>
+
+#include "UuidKey.hh"
+
+namespace gz
+{
+  namespace transport
+  {
+    inline namespace GZ_TRANSPORT_VERSION_NAMESPACE
+    {
+    /// \brief Lowercase hexadecimal digits.
+    static const char kHexDigits[] = "0123456789abcdef";
+
+    /// \brief Whether a hyphen follows the byte at each position of a UUID.
+    static const bool kHyphenAfter[kUuidSize] =
+      {false, false, false, true, false, true, false, true,
+       false, true, false, false, false, false, false, false};
+
+    /// \brief Value of a hexadecimal digit.
+    /// \param[in] _c The digit.
+    /// \return The value or -1 if _c isn't a hexadecimal digit.
+    static int hexValue(const char _c)
+    {
+      if (_c >= '0' && _c <= '9')
+        return _c - '0';
+      if (_c >= 'a' && _c <= 'f')
+        return _c - 'a' + 10;
+      if (_c >= 'A' && _c <= 'F')
+        return _c - 'A' + 10;
+      return -1;
+    }
+
+    //////////////////////////////////////////////////
+    void FormatUuid(const unsigned char *_bytes, char *_str)
+    {
+      for (std::size_t i = 0; i < kUuidSize; ++i)
+      {
+        *_str++ = kHexDigits[_bytes[i] >> 4];
+        *_str++ = kHexDigits[_bytes[i] & 0x0f];
+        if (kHyphenAfter[i])
+          *_str++ = '-';
+      }
+    }
+
+    //////////////////////////////////////////////////
+    bool UuidKey::Parse(const std::string &_str, UuidKey &_key)
+    {
+      if (_str.size() != kUuidStrLen)
+        return false;
+
+      uint64_t halves[2] = {0, 0};
+      std::size_t pos = 0;
+      for (std::size_t i = 0; i < kUuidSize; ++i)
+      {
+        const int high = hexValue(_str[pos++]);
+        const int low = hexValue(_str[pos++]);
+        if (high < 0 || low < 0)
+          return false;
+        if (kHyphenAfter[i] && _str[pos++] != '-')
+          return false;
+
+        uint64_t &half = halves[i / 8];
+        half = (half << 8) | static_cast<uint64_t>((high << 4) | low);
+      }
+
+      _key.hi = halves[0];
+      _key.lo = halves[1];
+      return true;
+    }
+
+    //////////////////////////////////////////////////
+    std::string UuidKey::ToString() const
+    {
+      unsigned char bytes[kUuidSize];
+      for (std::size_t i = 0; i < 8; ++i)
+      {
+        bytes[i] = static_cast<unsigned char>(this->hi >> (56 - 8 * i));
+        bytes[i + 8] = static_cast<unsigned char>(this->lo >> (56 - 8 * i));
+      }
+
+      std::string str(kUuidStrLen, '\0');
+      FormatUuid(bytes, &str[0]);
+      return str;
+    }
+    }
+  }
+}
@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef GZ_TRANSPORT_UUIDKEY_HH_
+#define GZ_TRANSPORT_UUIDKEY_HH_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "gz/transport/config.hh"
+
+namespace gz
+{
+  namespace transport
+  {
+    inline namespace GZ_TRANSPORT_VERSION_NAMESPACE
+    {
+    /// \internal
+    /// \brief Size of a UUID in binary form (bytes).
+    static const std::size_t kUuidSize = 16;
+
+    /// \internal
+    /// \brief Length of a UUID in string format, without the \0.
+    static const std::size_t kUuidStrLen = 36;
+
+    /// \internal
+    /// \brief Format a UUID in the 8-4-4-4-12 form, with lowercase
+    /// hexadecimal digits.
+    /// \param[in] _bytes The UUID, kUuidSize bytes.
+    /// \param[out] _str The string, kUuidStrLen characters. No \0 is written.
+    void FormatUuid(const unsigned char *_bytes, char *_str);
+
+    /// \internal
+    /// \brief A UUID in binary form: 16 bytes instead of the 37 of its
+    /// string, compared and hashed as two integers. The UUIDs are kept in
+    /// this form in the internal tables and formatted as strings only when
+    /// they leave them.
+    struct UuidKey
+    {
+      /// \brief Parse a UUID in the 8-4-4-4-12 form. The hexadecimal digits
+      /// can be lowercase or uppercase.
+      /// \param[in] _str The UUID.
+      /// \param[out] _key The key.
+      /// \return True on success or false if _str isn't a UUID.
+      static bool Parse(const std::string &_str, UuidKey &_key);
+
+      /// \brief Format the key in the 8-4-4-4-12 form.
+      /// \return The UUID in string format.
+      std::string ToString() const;
+
+      /// \brief Equality operator.
+      /// \param[in] _other The other key.
+      /// \return True if both keys are equal.
+      bool operator==(const UuidKey &_other) const
+      {
+        return this->hi == _other.hi && this->lo == _other.lo;
+      }
+
+      /// \brief Inequality operator.
+      /// \param[in] _other The other key.
+      /// \return True if the keys are different.
+      bool operator!=(const UuidKey &_other) const
+      {
+        return !(*this == _other);
+      }
+
+      /// \brief Less than operator, the order of the strings.
+      /// \param[in] _other The other key.
+      /// \return True if this key is before _other.
+      bool operator<(const UuidKey &_other) const
+      {
+        return this->hi < _other.hi ||
+          (this->hi == _other.hi && this->lo < _other.lo);
+      }
+
+      /// \brief First 8 bytes, big-endian.
+      uint64_t hi = 0;
+
+      /// \brief Last 8 bytes, big-endian.
+      uint64_t lo = 0;
+    };
+
+    /// \internal
+    /// \brief Hash of a UuidKey. The UUIDs are random, so mixing the two
+    /// halves is enough.
+    struct UuidKeyHash
+    {
+      /// \brief Hash a key.
+      /// \param[in] _key The key.
+      /// \return The hash.
+      std::size_t operator()(const UuidKey &_key) const
+      {
+        return static_cast<std::size_t>(
+          _key.hi ^ (_key.lo * 0x9e3779b97f4a7c15ull));
+      }
+    };
+    }
+  }
+}
+#endif
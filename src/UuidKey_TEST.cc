@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <string>
+#include <unordered_set>
+
+#include "gz/transport/Uuid.hh"
+#include "UuidKey.hh"
+#include "gtest/gtest.h"
+
+using namespace gz;
+using namespace transport;
+
+//////////////////////////////////////////////////
+/// \brief Parse and format a UUID.
+TEST(UuidKeyTest, ParseAndFormat)
+{
+  UuidKey key;
+  ASSERT_TRUE(UuidKey::Parse("0123abcd-4567-89EF-0a1b-2c3d4e5f6789", key));
+  EXPECT_EQ(0x0123abcd456789efull, key.hi);
+  EXPECT_EQ(0x0a1b2c3d4e5f6789ull, key.lo);
+  EXPECT_EQ("0123abcd-4567-89ef-0a1b-2c3d4e5f6789", key.ToString());
+
+  UuidKey other;
+  EXPECT_FALSE(UuidKey::Parse("", other));
+  EXPECT_FALSE(UuidKey::Parse("0123abcd-4567-89ef-0a1b-2c3d4e5f678", other));
+  EXPECT_FALSE(UuidKey::Parse("0123abcd-4567-89ef-0a1b-2c3d4e5f678g", other));
+  EXPECT_FALSE(UuidKey::Parse("0123abcd04567-89ef-0a1b-2c3d4e5f6789", other));
+  EXPECT_FALSE(UuidKey::Parse("0123abcd-4567-89ef-0a1b-2c3d4e5f67890",
+    other));
+
+  ASSERT_TRUE(UuidKey::Parse("0123abcd-4567-89ef-0a1b-2c3d4e5f678a", other));
+  EXPECT_NE(key, other);
+  EXPECT_TRUE(key < other);
+  EXPECT_FALSE(other < key);
+  ASSERT_TRUE(UuidKey::Parse(key.ToString(), other));
+  EXPECT_EQ(key, other);
+  EXPECT_EQ(UuidKeyHash()(key), UuidKeyHash()(other));
+}
+
+//////////////////////////////////////////////////
+/// \brief The generated UUIDs are random (version 4) UUIDs, parsed back to
+/// distinct keys.
+TEST(UuidKeyTest, GeneratedUuids)
+{
+  std::unordered_set<UuidKey, UuidKeyHash> keys;
+  for (int i = 0; i < 1000; ++i)
+  {
+    const std::string str = Uuid().ToString();
+    EXPECT_EQ('4', str[14]);
+    EXPECT_NE(std::string::npos, std::string("89ab").find(str[19]));
+
+    UuidKey key;
+    ASSERT_TRUE(UuidKey::Parse(str, key));
+    EXPECT_EQ(str, key.ToString());
+    EXPECT_TRUE(keys.insert(key).second);
+  }
+}
@@ -0,0 +1,198 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gz/utils/cli/CLI.hpp>
+#include <gz/utils/cli/GzFormatter.hpp>
+
+#include <gz/transport/Bridge.hh>
+#include <gz/transport/config.hh>
+#include <gz/transport/Node.hh>
+#include <gz/transport/NodeOptions.hh>
+
+//////////////////////////////////////////////////
+/// \brief Structure to hold all available bridge options
+struct BridgeOptions
+{
+  /// \brief TCP port to listen on, or 0 to connect.
+  int listen{0};
+
+  /// \brief IPv4 address of the interface to listen on.
+  std::string interface{"127.0.0.1"};
+
+  /// \brief Remote bridge to connect to: <host>[:<port>].
+  std::string connect;
+
+  /// \brief Topics forwarded: <topic>[@<max rate>].
+  std::vector<std::string> topics;
+
+  /// \brief Topics accepted from the remote bridge.
+  std::vector<std::string> allowed;
+
+  /// \brief Codec of the messages: none, lz4 or zstd.
+  std::string compression{"none"};
+
+  /// \brief Disable the delta encoding.
+  bool noDelta{false};
+
+  /// \brief Partition of the bridge, or empty for the default one.
+  std::string partition;
+};
+
+//////////////////////////////////////////////////
+/// \brief Callback fired when options are successfully parsed
+int runBridge(const BridgeOptions &_opt)
+{
+  gz::transport::NodeOptions nodeOptions;
+  if (!_opt.partition.empty() && !nodeOptions.SetPartition(_opt.partition))
+    return -1;
+
+  gz::transport::Bridge bridge(nodeOptions);
+
+  gz::transport::BridgeTopicOptions topicOptions;
+  topicOptions.deltaEncoding = !_opt.noDelta;
+  if (_opt.compression == "lz4")
+    topicOptions.compression = gz::transport::Compression_t::LZ4;
+  else if (_opt.compression == "zstd")
+    topicOptions.compression = gz::transport::Compression_t::ZSTD;
+
+  for (const std::string &topicAndRate : _opt.topics)
+  {
+    // The topic names can't contain '@', it separates the rate.
+    gz::transport::BridgeTopicOptions options = topicOptions;
+    std::string topic = topicAndRate;
+    const auto at = topicAndRate.find('@');
+    if (at != std::string::npos)
+    {
+      topic = topicAndRate.substr(0, at);
+      try
+      {
+        options.maxRate = std::stoull(topicAndRate.substr(at + 1));
+      }
+      catch (...)
+      {
+        std::cerr << "Invalid rate in [" << topicAndRate << "]" << std::endl;
+        return -1;
+      }
+    }
+
+    if (!bridge.AddTopic(topic, options))
+    {
+      std::cerr << "Failed to forward [" << topic << "]" << std::endl;
+      return -1;
+    }
+  }
+
+  for (const std::string &topic : _opt.allowed)
+  {
+    if (!bridge.AllowRemoteTopic(topic))
+      return -1;
+  }
+
+  if (_opt.listen > 0)
+  {
+    if (!bridge.Listen(_opt.listen, _opt.interface))
+      return -1;
+    std::cout << "Bridge listening on TCP port [" << bridge.Port() << "]"
+              << std::endl;
+  }
+  else
+  {
+    std::string host = _opt.connect;
+    int port = gz::transport::Bridge::kDefaultPort;
+    const auto colon = _opt.connect.rfind(':');
+    if (colon != std::string::npos)
+    {
+      host = _opt.connect.substr(0, colon);
+      try
+      {
+        port = std::stoi(_opt.connect.substr(colon + 1));
+      }
+      catch (...)
+      {
+        std::cerr << "Invalid address [" << _opt.connect << "]" << std::endl;
+        return -1;
+      }
+    }
+
+    if (!bridge.Connect(host, port))
+      return -1;
+    std::cout << "Bridge connecting to [" << host << ":" << port << "]"
+              << std::endl;
+  }
+
+  gz::transport::waitForShutdown();
+  return 0;
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char** argv)
+{
+  CLI::App app{"Forward Gazebo topics to a remote bridge over one TCP "
+    "connection"};
+
+  app.add_flag_callback("-v,--version", [](){
+      std::cout << GZ_TRANSPORT_VERSION_FULL << std::endl;
+      throw CLI::Success();
+  });
+
+  BridgeOptions opt;
+  auto listenOpt = app.add_option("-l,--listen", opt.listen,
+    "TCP port to wait for the remote bridge on.")
+    ->check(CLI::Range(1, 65535));
+  auto connectOpt = app.add_option("-c,--connect", opt.connect,
+    "Remote bridge to connect to: <host>[:<port>]. The default port is " +
+    std::to_string(gz::transport::Bridge::kDefaultPort) + ".");
+  auto interfaceOpt = app.add_option("--interface", opt.interface,
+    "IPv4 address of the interface to listen on, 127.0.0.1 by default. Any "
+    "other interface, e.g. 0.0.0.0 for all of them, requires the credentials "
+    "set with GZ_TRANSPORT_USERNAME and GZ_TRANSPORT_PASSWORD. The remote "
+    "bridge must have the same ones.");
+  listenOpt->excludes(connectOpt);
+  connectOpt->excludes(listenOpt);
+  interfaceOpt->needs(listenOpt);
+  app.add_option("-t,--topic", opt.topics,
+    "Topic forwarded to the remote bridge, with an optional maximum rate "
+    "(messages per second): <topic>[@<rate>]. Repeat it for several "
+    "topics.");
+  app.add_option("-a,--allow", opt.allowed,
+    "Topic accepted from the remote bridge. Repeat it for several topics, "
+    "the others are ignored.");
+  app.add_option("--compression", opt.compression,
+    "Codec compressing the forwarded messages.")
+    ->check(CLI::IsMember({"none", "lz4", "zstd"}));
+  app.add_flag("--no-delta", opt.noDelta,
+    "Send every message in full, instead of repeat frames and differences "
+    "with the previous message.");
+  app.add_option("--partition", opt.partition,
+    "Partition of the forwarded and published topics.");
+
+  int ret = 0;
+  app.callback([&opt, &ret, listenOpt, connectOpt](){
+    if (listenOpt->count() == 0 && connectOpt->count() == 0)
+      throw CLI::RequiredError("--listen or --connect");
+    ret = runBridge(opt);
+  });
+  app.formatter(std::make_shared<GzFormatter>(&app));
+  CLI11_PARSE(app, argc, argv);
+  return ret;
+}
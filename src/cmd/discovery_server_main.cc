@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <iostream>
+
+#include <gz/utils/cli/CLI.hpp>
+#include <gz/utils/cli/GzFormatter.hpp>
+
+#include <gz/transport/config.hh>
+#include <gz/transport/DiscoveryServer.hh>
+#include <gz/transport/Node.hh>
+
+//////////////////////////////////////////////////
+/// \brief Structure to hold all available server options
+struct ServerOptions
+{
+  /// \brief UDP port of the messages discovery. The services discovery uses
+  /// the next port.
+  int port{gz::transport::DiscoveryServer::kDefaultPort};
+
+  /// \brief Print the forwarded messages.
+  bool verbose{false};
+};
+
+//////////////////////////////////////////////////
+/// \brief Callback fired when options are successfully parsed
+int runServer(const ServerOptions &_opt)
+{
+  gz::transport::DiscoveryServer msgServer(_opt.port, _opt.verbose);
+  gz::transport::DiscoveryServer srvServer(_opt.port + 1, _opt.verbose);
+  if (!msgServer.Start() || !srvServer.Start())
+    return -1;
+
+  std::cout << "Discovery server running on UDP ports [" << _opt.port
+            << "] (messages) and [" << _opt.port + 1 << "] (services)."
+            << std::endl << "Use GZ_DISCOVERY_SERVER=<this host IP>:"
+            << _opt.port << " on the clients." << std::endl;
+
+  gz::transport::waitForShutdown();
+  return 0;
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char** argv)
+{
+  CLI::App app{"Forward the Gazebo discovery messages without multicast"};
+
+  app.add_flag_callback("-v,--version", [](){
+      std::cout << GZ_TRANSPORT_VERSION_FULL << std::endl;
+      throw CLI::Success();
+  });
+
+  ServerOptions opt;
+  app.add_option("-p,--port", opt.port,
+    "UDP port of the messages discovery. The services discovery uses the "
+    "next port.")
+    ->check(CLI::Range(1, 65534));
+  app.add_flag("--verbose", opt.verbose, "Print the forwarded messages.");
+
+  int ret = 0;
+  app.callback([&opt, &ret](){ ret = runServer(opt); });
+  app.formatter(std::make_shared<GzFormatter>(&app));
+  CLI11_PARSE(app, argc, argv);
+  return ret;
+}
@@ -15,10 +15,22 @@
  *
 */
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
 #include <functional>
+#include <iomanip>
 #include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <regex>
+#include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
 #ifdef _MSC_VER
@@ -31,11 +43,14 @@
 #endif
 
 #include <gz/msgs/Factory.hh>
+#include <gz/msgs/metric.pb.h>
 
 #include "gz.hh"
 #include "gz/transport/config.hh"
 #include "gz/transport/Helpers.hh"
 #include "gz/transport/Node.hh"
+#include "gz/transport/NodeOptions.hh"
+#include "gz/transport/StatsAggregator.hh"
 
 using namespace gz;
 using namespace transport;
@@ -43,7 +58,15 @@ using namespace transport;
 //////////////////////////////////////////////////
 extern "C" void cmdTopicList()
 {
-  Node node;
+  cmdTopicListWait(-1);
+}
+
+//////////////////////////////////////////////////
+extern "C" void cmdTopicListWait(const int _wait)
+{
+  NodeOptions options;
+  options.SetDiscoveryTimeout(std::chrono::milliseconds(_wait));
+  Node node(options);
 
   std::vector<std::string> topics;
   node.TopicList(topics);
@@ -54,6 +77,12 @@ extern "C" void cmdTopicList()
 
 //////////////////////////////////////////////////
 extern "C" void cmdTopicInfo(const char *_topic)
+{
+  cmdTopicInfoWait(_topic, -1);
+}
+
+//////////////////////////////////////////////////
+extern "C" void cmdTopicInfoWait(const char *_topic, const int _wait)
 {
   if (!_topic || std::string(_topic).empty())
   {
@@ -64,7 +93,9 @@ extern "C" void cmdTopicInfo(const char *_topic)
   // Get the publishers on the requested topic
   std::vector<MessagePublisher> publishers;
   std::vector<MessagePublisher> subscribers;
-  Node node;
+  NodeOptions options;
+  options.SetDiscoveryTimeout(std::chrono::milliseconds(_wait));
+  Node node(options);
   node.TopicInfo(_topic, publishers, subscribers);
 
   if (!publishers.empty())
@@ -106,7 +137,15 @@ extern "C" void cmdTopicInfo(const char *_topic)
 //////////////////////////////////////////////////
 extern "C" void cmdServiceList()
 {
-  Node node;
+  cmdServiceListWait(-1);
+}
+
+//////////////////////////////////////////////////
+extern "C" void cmdServiceListWait(const int _wait)
+{
+  NodeOptions options;
+  options.SetDiscoveryTimeout(std::chrono::milliseconds(_wait));
+  Node node(options);
 
   std::vector<std::string> services;
   node.ServiceList(services);
@@ -117,6 +156,12 @@ extern "C" void cmdServiceList()
 
 //////////////////////////////////////////////////
 extern "C" void cmdServiceInfo(const char *_service)
+{
+  cmdServiceInfoWait(_service, -1);
+}
+
+//////////////////////////////////////////////////
+extern "C" void cmdServiceInfoWait(const char *_service, const int _wait)
 {
   if (!_service || std::string(_service).empty())
   {
@@ -124,7 +169,9 @@ extern "C" void cmdServiceInfo(const char *_service)
     return;
   }
 
-  Node node;
+  NodeOptions options;
+  options.SetDiscoveryTimeout(std::chrono::milliseconds(_wait));
+  Node node(options);
 
   // Get the publishers on the requested topic
   std::vector<ServicePublisher> publishers;
@@ -272,9 +319,157 @@ extern "C" void cmdServiceReq(const char *_service,
   }
 }
 
+//////////////////////////////////////////////////
+/// \brief Print a row of the latencies of a responser.
+/// \param[in] _name Name of the row.
+/// \param[in] _histogram The latencies.
+static void printLatencies(const std::string &_name,
+  const LatencyHistogram &_histogram)
+{
+  std::cout << "  " << std::left << std::setw(12) << _name << std::right
+            << std::setw(8) << _histogram.Count();
+  if (_histogram.Count() == 0)
+  {
+    std::cout << std::endl;
+    return;
+  }
+
+  std::cout << std::fixed << std::setprecision(3)
+            << std::setw(10) << _histogram.Summary().Avg()
+            << std::setw(10) << _histogram.Percentile(50)
+            << std::setw(10) << _histogram.Percentile(90)
+            << std::setw(10) << _histogram.Percentile(99)
+            << std::setw(10) << _histogram.Summary().Max() << std::endl;
+}
+
+//////////////////////////////////////////////////
+extern "C" void cmdServiceStats(const char *_service,
+  const char *_reqType, const char *_repType, const int _timeout,
+  const char *_reqData, const int _count)
+{
+  if (!_service || !_reqType || !_repType || !_reqData)
+  {
+    std::cerr << "Service name, types and request data must not be null\n";
+    return;
+  }
+
+  if (!strcmp(_repType, "gz.msgs.Empty"))
+  {
+    std::cerr << "The statistics require a response, oneway services are not "
+              << "supported.\n";
+    return;
+  }
+
+  if (_count <= 0)
+  {
+    std::cerr << "The number of requests must be positive.\n";
+    return;
+  }
+
+  auto req = msgs::Factory::New(_reqType, _reqData);
+  if (!req)
+  {
+    std::cerr << "Unable to create request of type[" << _reqType << "] "
+              << "with data[" << _reqData << "].\n";
+    return;
+  }
+
+  auto rep = msgs::Factory::New(_repType);
+  if (!rep)
+  {
+    std::cerr << "Unable to create response of type[" << _repType << "].\n";
+    return;
+  }
+
+  Node node;
+  if (!node.EnableServiceStats(_service, true))
+  {
+    std::cerr << "Invalid service [" << _service << "].\n";
+    return;
+  }
+
+  // Don't count the connection in the first request.
+  node.PrepareService(_service, _timeout);
+
+  int failed = 0;
+  int timedOut = 0;
+  for (int i = 0; i < _count; ++i)
+  {
+    bool result;
+    if (!node.Request(_service, *req, _timeout, *rep, result))
+      ++timedOut;
+    else if (!result)
+      ++failed;
+  }
+
+  std::cout << _count << " requests, " << failed << " failed, " << timedOut
+            << " timed out" << std::endl;
+
+  auto stats = node.ServiceStats(_service);
+  if (!stats)
+    return;
+
+  for (const std::string &responser : stats->Responsers())
+  {
+    std::cout << std::endl << "Responser [" << responser << "]" << std::endl
+              << "  " << std::left << std::setw(12) << "(ms)" << std::right
+              << std::setw(8) << "count" << std::setw(10) << "avg"
+              << std::setw(10) << "p50" << std::setw(10) << "p90"
+              << std::setw(10) << "p99" << std::setw(10) << "max"
+              << std::endl;
+    printLatencies("round trip", stats->RoundTripTime(responser));
+    printLatencies("wire", stats->WireTime(responser));
+    printLatencies("queue", stats->QueueTime(responser));
+    printLatencies("callback", stats->CallbackTime(responser));
+  }
+}
+
 //////////////////////////////////////////////////
 extern "C" void cmdTopicEcho(const char *_topic,
   const double _duration, int _count, MsgOutputFormat _outputFormat)
+{
+  cmdTopicEchoSampled(_topic, _duration, _count, _outputFormat, 1, 0);
+}
+
+//////////////////////////////////////////////////
+/// \brief Wait until the end of an echo: the duration elapsed, the number
+/// of messages was received or the user pressed Ctrl-C.
+/// \param[in] _duration Duration (seconds), or a negative value
+/// \param[in] _count Number of messages, or a value <= 0
+/// \param[in] _mutex Mutex protecting _received
+/// \param[in] _condition Signaled when _received changes
+/// \param[in] _received Number of messages received
+static void waitForEcho(const double _duration, const int _count,
+  std::mutex &_mutex, std::condition_variable &_condition,
+  const uint64_t &_received)
+{
+  if (_duration >= 0)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(
+      static_cast<int64_t>(_duration * 1000)));
+    return;
+  }
+
+  // Wait forever if _count <= 0. Otherwise wait for a specific number of
+  // messages.
+  if (_count <= 0)
+  {
+    waitForShutdown();
+  }
+  else
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _condition.wait(lock, [&]
+    {
+      return _received >= static_cast<uint64_t>(_count);
+    });
+  }
+}
+
+//////////////////////////////////////////////////
+extern "C" void cmdTopicEchoSampled(const char *_topic,
+  const double _duration, int _count, MsgOutputFormat _outputFormat,
+  int _every, uint64_t _maxRate)
 {
   if (!_topic || std::string(_topic).empty())
   {
@@ -282,13 +477,24 @@ extern "C" void cmdTopicEcho(const char *_topic,
     return;
   }
 
+  if (_every < 1)
+  {
+    std::cerr << "Invalid sampling. Every message must be 1 or more.\n";
+    return;
+  }
+
   std::mutex mutex;
   std::condition_variable condition;
-  int count = 0;
+  uint64_t count = 0;
+  uint64_t received = 0;
 
   std::function<void(const ProtoMsg&)> cb = [&](const ProtoMsg &_msg)
   {
     std::lock_guard<std::mutex> lock(mutex);
+    // Skip the messages between the samples before formatting them, which
+    // is the expensive part.
+    if (received++ % _every != 0)
+      return;
     switch (_outputFormat)
     {
       case MsgOutputFormat::kDefault:
@@ -318,31 +524,817 @@ extern "C" void cmdTopicEcho(const char *_topic,
     condition.notify_one();
   };
 
+  // The publishers of other processes don't even send the messages beyond
+  // the maximum rate.
+  SubscribeOptions opts;
+  if (_maxRate > 0)
+    opts.SetMsgsPerSec(_maxRate);
+
   Node node;
-  if (!node.Subscribe(_topic, cb))
+  if (!node.Subscribe(_topic, cb, opts))
     return;
 
-  if (_duration >= 0)
+  waitForEcho(_duration, _count, mutex, condition, count);
+}
+
+//////////////////////////////////////////////////
+extern "C" void cmdTopicEchoRaw(const char *_topic,
+  const double _duration, int _count, const char *_dumpFile)
+{
+  if (!_topic || std::string(_topic).empty())
   {
-    std::this_thread::sleep_for(std::chrono::milliseconds(
-      static_cast<int64_t>(_duration * 1000)));
+    std::cerr << "Invalid topic. Topic must not be empty.\n";
     return;
   }
 
-  // Wait forever if _count <= 0. Otherwise wait for a specific number of
-  // messages.
+  std::ofstream dump;
+  if (_dumpFile && *_dumpFile)
+  {
+    dump.open(_dumpFile, std::ios::binary | std::ios::trunc);
+    if (!dump)
+    {
+      std::cerr << "Unable to open [" << _dumpFile << "].\n";
+      return;
+    }
+  }
+
+  std::mutex mutex;
+  std::condition_variable condition;
+  uint64_t count = 0;
+  uint64_t bytes = 0;
+  uint64_t lastCount = 0;
+  uint64_t lastBytes = 0;
+  bool done = false;
+
+  // The messages are never deserialized, only counted and copied.
+  RawCallback cb = [&](const char *_data, const std::size_t _size,
+                       const MessageInfo &)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (_count > 0 && count >= static_cast<uint64_t>(_count))
+      return;
+    ++count;
+    bytes += _size;
+    if (dump.is_open())
+    {
+      // Every message is its size, as 8 little-endian bytes, and its data.
+      const uint64_t size = _size;
+      char header[8];
+      for (int i = 0; i < 8; ++i)
+        header[i] = static_cast<char>(size >> (8 * i));
+      dump.write(header, sizeof(header));
+      dump.write(_data, static_cast<std::streamsize>(_size));
+    }
+    condition.notify_all();
+  };
+
+  Node node;
+  if (!node.SubscribeRaw(_topic, cb))
+    return;
+
+  // Print the rates every second until the end of the echo.
+  std::thread printer([&]
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!done)
+    {
+      if (condition.wait_for(lock, std::chrono::seconds(1),
+                             [&]{return done;}))
+      {
+        break;
+      }
+      std::cout << (count - lastCount) << " msgs/s, "
+                << (bytes - lastBytes) << " bytes/s" << std::endl;
+      lastCount = count;
+      lastBytes = bytes;
+    }
+  });
+
+  waitForEcho(_duration, _count, mutex, condition, count);
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    done = true;
+  }
+  condition.notify_all();
+  printer.join();
+
+  std::lock_guard<std::mutex> lock(mutex);
+  std::cout << "Total: " << count << " messages, " << bytes << " bytes"
+            << std::endl;
+}
+
+//////////////////////////////////////////////////
+extern "C" void cmdTopicStats(const char *_topic, const double _duration)
+{
+  if (!_topic || std::string(_topic).empty())
+  {
+    std::cerr << "Invalid topic. Topic must not be empty.\n";
+    return;
+  }
+
+  if (_duration <= 0)
+  {
+    std::cerr << "The duration must be positive.\n";
+    return;
+  }
+
+  std::string gzStats;
+  if (!env("GZ_TRANSPORT_TOPIC_STATISTICS", gzStats) || gzStats != "1")
+  {
+    std::cerr << "Topic statistics require GZ_TRANSPORT_TOPIC_STATISTICS=1, "
+              << "for this command and for the publishers.\n";
+    return;
+  }
+
+  // The messages are not deserialized, only their reception is measured.
+  RawCallback cb = [](const char *, const std::size_t,
+                      const MessageInfo &)
+  {
+  };
+
+  Node node;
+  if (!node.EnableStats(_topic, true, "/_gz_topic_stats"))
+  {
+    std::cerr << "Invalid topic [" << _topic << "].\n";
+    return;
+  }
+
+  if (!node.SubscribeRaw(_topic, cb))
+    return;
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(
+    static_cast<int64_t>(_duration * 1000)));
+
+  auto stats = node.TopicStats(_topic);
+  if (!stats || stats->AgeHistogram().Count() == 0)
+  {
+    std::cout << "Not enough messages received on [" << _topic << "]"
+              << std::endl;
+    return;
+  }
+
+  std::cout << "Dropped messages: " << stats->DroppedMsgCount() << std::endl
+            << "  " << std::left << std::setw(12) << "(ms)" << std::right
+            << std::setw(8) << "count" << std::setw(10) << "avg"
+            << std::setw(10) << "p50" << std::setw(10) << "p90"
+            << std::setw(10) << "p99" << std::setw(10) << "max"
+            << std::endl;
+  printLatencies("period", stats->ReceptionHistogram());
+  printLatencies("age", stats->AgeHistogram());
+}
+
+//////////////////////////////////////////////////
+/// \brief Measurements of a topic by cmdTopicRate().
+struct TopicRate
+{
+  /// \brief Number of bytes received.
+  uint64_t bytes = 0;
+
+  /// \brief Sizes of the messages (bytes).
+  Statistics sizes;
+
+  /// \brief Durations between the messages (ms).
+  LatencyHistogram periods;
+
+  /// \brief Reception time of the last message.
+  std::chrono::steady_clock::time_point last;
+};
+
+//////////////////////////////////////////////////
+/// \brief Format a number of bytes per second.
+/// \param[in] _rate Number of bytes per second.
+/// \return The rate with a unit, e.g. "1.50 MB/s".
+static std::string formatBandwidth(double _rate)
+{
+  const char *units[] = {"B/s", "KB/s", "MB/s", "GB/s"};
+  std::size_t unit = 0;
+  while (_rate >= 1000 && unit < 3)
+  {
+    _rate /= 1000;
+    ++unit;
+  }
+  std::ostringstream oss;
+  oss << std::fixed << std::setprecision(2) << _rate << " " << units[unit];
+  return oss.str();
+}
+
+//////////////////////////////////////////////////
+extern "C" void cmdTopicRate(const char *_topics, const double _duration)
+{
+  if (!_topics || std::string(_topics).empty())
+  {
+    std::cerr << "Invalid topic. Topic must not be empty.\n";
+    return;
+  }
+
+  if (_duration <= 0)
+  {
+    std::cerr << "The duration must be positive.\n";
+    return;
+  }
+
+  std::regex pattern;
+  try
+  {
+    pattern = std::regex(_topics);
+  }
+  catch (const std::regex_error &)
+  {
+    std::cerr << "Invalid pattern [" << _topics << "].\n";
+    return;
+  }
+
+  // Declared before the node, so they outlive its subscriptions.
+  std::mutex mutex;
+  std::map<std::string, TopicRate> rates;
+
+  Node node;
+  std::vector<std::string> topics;
+  std::vector<std::string> allTopics;
+  node.TopicList(allTopics);
+  for (const std::string &topic : allTopics)
+  {
+    if (std::regex_match(topic, pattern))
+      topics.push_back(topic);
+  }
+  // The topic may not have publishers yet.
+  if (topics.empty())
+    topics.push_back(_topics);
+
+  for (const std::string &topic : topics)
+  {
+    TopicRate &rate = rates[topic];
+    // The messages are not deserialized, only their size and reception
+    // time are measured.
+    RawCallback cb = [&mutex, &rate](const char *, const std::size_t _size,
+                                     const MessageInfo &)
+    {
+      const auto now = std::chrono::steady_clock::now();
+      std::lock_guard<std::mutex> lk(mutex);
+      if (rate.sizes.Count() > 0)
+      {
+        rate.periods.Update(std::chrono::duration<double, std::milli>(
+          now - rate.last).count());
+      }
+      rate.last = now;
+      rate.bytes += _size;
+      rate.sizes.Update(static_cast<double>(_size));
+    };
+    if (!node.SubscribeRaw(topic, cb))
+      return;
+  }
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(
+    static_cast<int64_t>(_duration * 1000)));
+  for (const std::string &topic : topics)
+    node.Unsubscribe(topic);
+
+  std::lock_guard<std::mutex> lk(mutex);
+  for (const auto &[topic, rate] : rates)
+  {
+    std::cout << "Topic [" << topic << "]" << std::endl;
+    if (rate.sizes.Count() == 0)
+    {
+      std::cout << "  No messages received" << std::endl;
+      continue;
+    }
+
+    const Statistics period = rate.periods.Summary();
+    const double hz = rate.periods.Count() > 0 && period.Avg() > 0 ?
+      1000.0 / period.Avg() : rate.sizes.Count() / _duration;
+    std::cout << std::fixed << std::setprecision(2)
+              << "  messages: " << rate.sizes.Count()
+              << "  rate: " << hz << " Hz"
+              << "  bandwidth: " << formatBandwidth(rate.bytes / _duration)
+              << std::endl
+              << "  size (bytes):  avg " << rate.sizes.Avg()
+              << "  min " << rate.sizes.Min()
+              << "  max " << rate.sizes.Max() << std::endl;
+    if (rate.periods.Count() > 0)
+    {
+      std::cout << std::setprecision(3)
+                << "  period (ms):   avg " << period.Avg()
+                << "  p50 " << rate.periods.Percentile(50)
+                << "  p99 " << rate.periods.Percentile(99)
+                << "  max " << period.Max()
+                << "  jitter (std dev) " << period.StdDev() << std::endl;
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+extern "C" void cmdTopicCallbacks(const char *_topic, const double _duration)
+{
+  if (!_topic)
+  {
+    std::cerr << "Topic name must not be null.\n";
+    return;
+  }
+
+  if (_duration <= 0)
+  {
+    std::cerr << "The duration must be positive.\n";
+    return;
+  }
+
+  // The processes publish the execution time of their callbacks with their
+  // metrics, in a group of statistics per subscription handler named
+  // "callback <fully qualified topic> <handler UUID>".
+  const std::string prefix = "callback ";
+  std::mutex mutex;
+  std::map<std::string, CallbackStatistics> callbacks;
+  std::function<void(const msgs::Metric &)> cb =
+    [&](const msgs::Metric &_msg)
+  {
+    std::lock_guard<std::mutex> lk(mutex);
+    for (const msgs::StatisticsGroup &group : _msg.statistics_groups())
+    {
+      const std::string &name = group.name();
+      const auto space = name.rfind(' ');
+      if (name.compare(0, prefix.size(), prefix) != 0 ||
+          space < prefix.size())
+      {
+        continue;
+      }
+
+      CallbackStatistics entry;
+      entry.topic = name.substr(prefix.size(), space - prefix.size());
+      entry.topic.erase(0, entry.topic.find_last_of("@") + 1);
+      entry.handlerUuid = name.substr(space + 1);
+      if (*_topic != '\0' && entry.topic != _topic)
+        continue;
+
+      for (const msgs::Statistic &stat : group.statistics())
+      {
+        const auto ns = std::chrono::nanoseconds(
+          static_cast<int64_t>(stat.value() * 1e6));
+        if (stat.name() == "calls")
+          entry.calls = static_cast<uint64_t>(stat.value());
+        else if (stat.name() == "total")
+          entry.totalDuration = ns;
+        else if (stat.name() == "max")
+          entry.maxDuration = ns;
+      }
+
+      // The counters are cumulative, keep the latest ones.
+      callbacks[entry.handlerUuid] = entry;
+    }
+  };
+
+  Node node;
+  if (!node.Subscribe("/gz/transport/metrics", cb))
+    return;
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(
+    static_cast<int64_t>(_duration * 1000)));
+
+  std::lock_guard<std::mutex> lk(mutex);
+  if (callbacks.empty())
+  {
+    std::cout << "No callback statistics received. The subscribers must run "
+              << "with GZ_TRANSPORT_METRICS=1 and "
+              << "GZ_TRANSPORT_CALLBACK_STATISTICS=1." << std::endl;
+    return;
+  }
+
+  // The most expensive callbacks first.
+  std::vector<CallbackStatistics> sorted;
+  for (const auto &callback : callbacks)
+    sorted.push_back(callback.second);
+  std::sort(sorted.begin(), sorted.end(),
+    [](const CallbackStatistics &_a, const CallbackStatistics &_b)
+    {
+      return _a.totalDuration > _b.totalDuration;
+    });
+
+  auto ms = [](const std::chrono::nanoseconds _duration)
+  {
+    return std::chrono::duration<double, std::milli>(_duration).count();
+  };
+
+  std::cout << std::left << std::setw(32) << "topic" << std::setw(38)
+            << "handler" << std::right << std::setw(10) << "calls"
+            << std::setw(12) << "total (ms)" << std::setw(10) << "avg"
+            << std::setw(10) << "max" << std::endl;
+  for (const CallbackStatistics &callback : sorted)
+  {
+    std::cout << std::left << std::setw(32) << callback.topic
+              << std::setw(38) << callback.handlerUuid << std::right
+              << std::setw(10) << callback.calls << std::fixed
+              << std::setprecision(3) << std::setw(12)
+              << ms(callback.totalDuration) << std::setw(10)
+              << (callback.calls > 0 ?
+                  ms(callback.totalDuration) / callback.calls : 0.0)
+              << std::setw(10) << ms(callback.maxDuration) << std::endl;
+  }
+}
+
+//////////////////////////////////////////////////
+extern "C" void cmdTopicStatsAll(const char *_topic, const double _duration)
+{
+  if (!_topic)
+  {
+    std::cerr << "Topic name must not be null.\n";
+    return;
+  }
+
+  if (_duration <= 0)
+  {
+    std::cerr << "The duration must be positive.\n";
+    return;
+  }
+
+  StatsAggregator aggregator;
+  if (!aggregator.Start())
+    return;
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(
+    static_cast<int64_t>(_duration * 1000)));
+
+  std::vector<AggregatedTopicStatistics> topics;
+  for (AggregatedTopicStatistics &stats : aggregator.Topics())
+  {
+    stats.topic.erase(0, stats.topic.find_last_of("@") + 1);
+    if (*_topic == '\0' || stats.topic == _topic)
+      topics.push_back(stats);
+  }
+
+  if (topics.empty())
+  {
+    std::cout << "No topic statistics received. The processes must run "
+              << "with GZ_TRANSPORT_METRICS=1, and report their metrics "
+              << "twice during the duration, see "
+              << "GZ_TRANSPORT_METRICS_PERIOD." << std::endl;
+    return;
+  }
+
+  std::cout << "Processes: " << aggregator.ProcessCount() << std::endl
+            << std::left << std::setw(32) << "topic" << std::right
+            << std::setw(6) << "procs" << std::setw(10) << "sent/s"
+            << std::setw(10) << "recv/s" << std::setw(14) << "recv bw"
+            << std::setw(10) << "drops/s" << std::setw(8) << "drop%"
+            << std::setw(10) << "p50 (ms)" << std::setw(10) << "p99"
+            << std::setw(10) << "max" << std::endl;
+  for (const AggregatedTopicStatistics &stats : topics)
+  {
+    std::cout << std::left << std::setw(32) << stats.topic << std::right
+              << std::setw(6) << stats.processes << std::fixed
+              << std::setprecision(1) << std::setw(10)
+              << stats.sentMsgsPerSec << std::setw(10)
+              << stats.receivedMsgsPerSec << std::setw(14)
+              << formatBandwidth(stats.receivedBytesPerSec)
+              << std::setw(10) << stats.droppedMsgsPerSec << std::setw(8)
+              << stats.dropRate * 100;
+
+    // The latencies are only measured with topic statistics.
+    if (stats.latencyCount > 0)
+    {
+      std::cout << std::setprecision(3) << std::setw(10)
+                << stats.latencyP50 << std::setw(10) << stats.latencyP99
+                << std::setw(10) << stats.latencyMax;
+    }
+    else
+    {
+      std::cout << std::setw(10) << "-" << std::setw(10) << "-"
+                << std::setw(10) << "-";
+    }
+    std::cout << std::endl;
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief Size of a varint.
+/// \param[in] _value The value.
+/// \return The number of bytes encoding the value.
+static std::size_t varintSize(uint64_t _value)
+{
+  std::size_t size = 1;
+  while (_value >= 0x80)
+  {
+    _value >>= 7;
+    ++size;
+  }
+  return size;
+}
+
+//////////////////////////////////////////////////
+/// \brief Append a varint to a string.
+/// \param[in] _value The value.
+/// \param[in, out] _data The string.
+static void appendVarint(uint64_t _value, std::string &_data)
+{
+  while (_value >= 0x80)
+  {
+    _data.push_back(static_cast<char>((_value & 0x7F) | 0x80));
+    _value >>= 7;
+  }
+  _data.push_back(static_cast<char>(_value));
+}
+
+//////////////////////////////////////////////////
+/// \brief Pad a serialized message to a size with an unknown
+/// length-delimited field, which the receivers skip when they parse it.
+/// \param[in, out] _data The serialized message.
+/// \param[in] _size Size (bytes) of the padded message, or 0 to keep it.
+/// \return False if the message is already larger than _size, or less than
+/// 5 bytes smaller, the size of the smallest padding field.
+static bool padMessage(std::string &_data, const int _size)
+{
+  if (_size <= 0 || _data.size() == static_cast<std::size_t>(_size))
+    return true;
+
+  if (_data.size() > static_cast<std::size_t>(_size))
+    return false;
+
+  // The largest field numbers have a 5 bytes tag, the ones below 2^25 have a
+  // 4 bytes tag. One of them always reaches the exact size.
+  const std::size_t missing = _size - _data.size();
+  for (const uint64_t field : {uint64_t{536870911}, uint64_t{33554431}})
+  {
+    const uint64_t tag = (field << 3) | 2;
+    const std::size_t tagSize = varintSize(tag);
+    for (std::size_t lenSize = 1; lenSize <= 5; ++lenSize)
+    {
+      if (missing < tagSize + lenSize)
+        break;
+
+      const std::size_t len = missing - tagSize - lenSize;
+      if (varintSize(len) != lenSize)
+        continue;
+
+      appendVarint(tag, _data);
+      appendVarint(len, _data);
+      _data.append(len, '\0');
+      return true;
+    }
+  }
+  return false;
+}
+
+//////////////////////////////////////////////////
+/// \brief Result of runLoad().
+struct LoadResult
+{
+  /// \brief Latencies of the operations (ms).
+  LatencyHistogram latencies;
+
+  /// \brief Number of failed operations.
+  uint64_t failed = 0;
+
+  /// \brief Duration of the whole load (seconds).
+  double elapsed = 0;
+};
+
+//////////////////////////////////////////////////
+/// \brief Execute an operation several times from several threads, at a
+/// given rate.
+/// \param[in] _count Number of operations.
+/// \param[in] _rate Number of operations per second, for all the threads, or
+/// 0 for as fast as possible.
+/// \param[in] _concurrency Number of threads.
+/// \param[in] _send The operation, returning false on failure.
+/// \return The latencies, measured from the time each operation was
+/// scheduled at when there is a rate, so that the time waiting for a slow
+/// operation of the same thread isn't hidden.
+static LoadResult runLoad(const int _count, const double _rate,
+  const int _concurrency, const std::function<bool()> &_send)
+{
+  using Clock = std::chrono::steady_clock;
+  std::vector<std::vector<double>> latencies(_concurrency);
+  std::vector<uint64_t> failed(_concurrency, 0);
+
+  const auto start = Clock::now();
+  std::vector<std::thread> threads;
+  for (int t = 0; t < _concurrency; ++t)
+  {
+    threads.emplace_back([&, t]()
+    {
+      latencies[t].reserve(_count / _concurrency + 1);
+      for (int i = t; i < _count; i += _concurrency)
+      {
+        auto begin = Clock::now();
+        if (_rate > 0)
+        {
+          const auto scheduled = start +
+            std::chrono::duration_cast<Clock::duration>(
+              std::chrono::duration<double>(i / _rate));
+          std::this_thread::sleep_until(scheduled);
+          begin = scheduled;
+        }
+
+        if (!_send())
+          ++failed[t];
+
+        latencies[t].push_back(std::chrono::duration<double, std::milli>(
+          Clock::now() - begin).count());
+      }
+    });
+  }
+
+  for (std::thread &thread : threads)
+    thread.join();
+
+  LoadResult result;
+  result.elapsed =
+    std::chrono::duration<double>(Clock::now() - start).count();
+  for (int t = 0; t < _concurrency; ++t)
+  {
+    result.failed += failed[t];
+    for (const double latency : latencies[t])
+      result.latencies.Update(latency);
+  }
+  return result;
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the options of the load generation.
+/// \param[in] _count Number of operations.
+/// \param[in] _rate Number of operations per second.
+/// \param[in] _size Size of the payload.
+/// \param[in] _concurrency Number of threads.
+/// \return True if the options are valid, otherwise an error is printed.
+static bool checkLoad(const int _count, const double _rate,
+  const int _size, const int _concurrency)
+{
   if (_count <= 0)
   {
-    waitForShutdown();
+    std::cerr << "The count must be positive.\n";
+    return false;
   }
-  else
+
+  if (_rate < 0 || _size < 0)
+  {
+    std::cerr << "The rate and the size must not be negative.\n";
+    return false;
+  }
+
+  if (_concurrency <= 0)
+  {
+    std::cerr << "The concurrency must be positive.\n";
+    return false;
+  }
+
+  return true;
+}
+
+//////////////////////////////////////////////////
+extern "C" void cmdTopicPubLoad(const char *_topic,
+  const char *_msgType, const char *_msgData, const int _count,
+  const double _rate, const int _size, const int _concurrency)
+{
+  if (!_topic || !_msgType || !_msgData)
   {
-    while (count < _count)
+    std::cerr << "Topic name, type and message data must not be null\n";
+    return;
+  }
+
+  if (!checkLoad(_count, _rate, _size, _concurrency))
+    return;
+
+  auto msg = msgs::Factory::New(_msgType, _msgData);
+  if (!msg)
+  {
+    std::cerr << "Unable to create message of type[" << _msgType << "] "
+      << "with data[" << _msgData << "].\n";
+    return;
+  }
+
+  // The message is serialized once, every publication sends the same bytes.
+  std::string payload;
+  msg->SerializeToString(&payload);
+  if (!padMessage(payload, _size))
+  {
+    std::cerr << "Unable to pad the message of " << payload.size()
+              << " bytes to " << _size << " bytes.\n";
+    return;
+  }
+
+  Node node;
+  const std::string msgType = msg->GetTypeName();
+  auto pub = node.Advertise(_topic, msgType);
+  if (!pub)
+  {
+    std::cerr << "Unable to publish on topic[" << _topic << "] "
+      << "with message type[" << _msgType << "].\n";
+    return;
+  }
+
+  // \todo(anyone) Change this sleep to a WaitForSubscribers() call.
+  // See issue #47.
+  std::this_thread::sleep_for(std::chrono::milliseconds(800));
+
+  const LoadResult result = runLoad(_count, _rate, _concurrency,
+    [&pub, &payload, &msgType]()
+    {
+      return pub.PublishRaw(payload, msgType);
+    });
+
+  const double achieved = result.elapsed > 0 ? _count / result.elapsed : 0;
+  std::cout << _count << " messages of " << payload.size() << " bytes in "
+            << std::fixed << std::setprecision(3) << result.elapsed
+            << " s: " << std::setprecision(1) << achieved << " msg/s, "
+            << formatBandwidth(achieved * payload.size()) << ", "
+            << result.failed << " failed" << std::endl
+            << "  " << std::left << std::setw(12) << "(ms)" << std::right
+            << std::setw(8) << "count" << std::setw(10) << "avg"
+            << std::setw(10) << "p50" << std::setw(10) << "p90"
+            << std::setw(10) << "p99" << std::setw(10) << "max"
+            << std::endl;
+  printLatencies("publish", result.latencies);
+}
+
+//////////////////////////////////////////////////
+extern "C" void cmdServiceReqLoad(const char *_service,
+  const char *_reqType, const char *_repType, const int _timeout,
+  const char *_reqData, const int _count, const double _rate,
+  const int _size, const int _concurrency)
+{
+  if (!_service || !_reqType || !_repType || !_reqData)
+  {
+    std::cerr << "Service name, types and request data must not be null\n";
+    return;
+  }
+
+  if (!strcmp(_repType, "gz.msgs.Empty"))
+  {
+    std::cerr << "The load generation requires a response, oneway services "
+              << "are not supported.\n";
+    return;
+  }
+
+  if (!checkLoad(_count, _rate, _size, _concurrency))
+    return;
+
+  auto req = msgs::Factory::New(_reqType, _reqData);
+  if (!req)
+  {
+    std::cerr << "Unable to create request of type[" << _reqType << "] "
+              << "with data[" << _reqData << "].\n";
+    return;
+  }
+
+  // The padding is kept as an unknown field of the request, built once.
+  std::string payload;
+  req->SerializeToString(&payload);
+  if (!padMessage(payload, _size) || !req->ParseFromString(payload))
+  {
+    std::cerr << "Unable to pad the request of " << payload.size()
+              << " bytes to " << _size << " bytes.\n";
+    return;
+  }
+
+  // One response per thread.
+  std::vector<std::unique_ptr<google::protobuf::Message>> reps;
+  for (int t = 0; t < _concurrency; ++t)
+  {
+    reps.push_back(msgs::Factory::New(_repType));
+    if (!reps.back())
     {
-      std::unique_lock<std::mutex> lock(mutex);
-      condition.wait(lock, [&]{return count >= _count;});
+      std::cerr << "Unable to create response of type[" << _repType
+                << "].\n";
+      return;
     }
   }
+
+  Node node;
+
+  // Don't count the connection in the first request.
+  node.PrepareService(_service, _timeout);
+
+  std::mutex repsMutex;
+  std::atomic<uint64_t> timedOut{0};
+  const LoadResult result = runLoad(_count, _rate, _concurrency,
+    [&]()
+    {
+      std::unique_ptr<google::protobuf::Message> rep;
+      {
+        std::lock_guard<std::mutex> lk(repsMutex);
+        rep = std::move(reps.back());
+        reps.pop_back();
+      }
+
+      bool ok = false;
+      if (!node.Request(_service, *req, _timeout, *rep, ok))
+        ++timedOut;
+
+      std::lock_guard<std::mutex> lk(repsMutex);
+      reps.push_back(std::move(rep));
+      return ok;
+    });
+
+  const double achieved = result.elapsed > 0 ? _count / result.elapsed : 0;
+  std::cout << _count << " requests of " << payload.size() << " bytes in "
+            << std::fixed << std::setprecision(3) << result.elapsed
+            << " s: " << std::setprecision(1) << achieved << " req/s, "
+            << result.failed - timedOut << " failed, " << timedOut
+            << " timed out" << std::endl
+            << "  " << std::left << std::setw(12) << "(ms)" << std::right
+            << std::setw(8) << "count" << std::setw(10) << "avg"
+            << std::setw(10) << "p50" << std::setw(10) << "p90"
+            << std::setw(10) << "p99" << std::setw(10) << "max"
+            << std::endl;
+  printLatencies("round trip", result.latencies);
 }
 
 //////////////////////////////////////////////////
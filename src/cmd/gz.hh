@@ -18,6 +18,7 @@
 #ifndef GZ_TRANSPORT_GZ_HH_
 #define GZ_TRANSPORT_GZ_HH_
 
+#include <cstdint>
 #include <cstring>
 
 #include "gz/transport/Export.hh"
@@ -26,16 +27,43 @@
 /// \param[in] _topic Topic name.
 extern "C" void cmdTopicInfo(const char *_topic);
 
+/// \brief External hook to execute 'gz topic -i --wait' from the command
+/// line. It waits at most _wait ms for the discovery, see
+/// NodeOptions::SetDiscoveryTimeout().
+/// \param[in] _topic Topic name.
+/// \param[in] _wait Maximum time (ms) waiting for the discovery, or a
+/// negative value to wait until it's initialized.
+extern "C" void cmdTopicInfoWait(const char *_topic, const int _wait);
+
 /// \brief External hook to execute 'gz service -i' from the command line.
 /// \param[in] _service Service name.
 extern "C" void cmdServiceInfo(const char *_service);
 
+/// \brief External hook to execute 'gz service -i --wait' from the command
+/// line. See cmdTopicInfoWait().
+/// \param[in] _service Service name.
+/// \param[in] _wait Maximum time (ms) waiting for the discovery, or a
+/// negative value to wait until it's initialized.
+extern "C" void cmdServiceInfoWait(const char *_service, const int _wait);
+
 /// \brief External hook to execute 'gz topic -l' from the command line.
 extern "C" void cmdTopicList();
 
+/// \brief External hook to execute 'gz topic -l --wait' from the command
+/// line. See cmdTopicInfoWait().
+/// \param[in] _wait Maximum time (ms) waiting for the discovery, or a
+/// negative value to wait until it's initialized.
+extern "C" void cmdTopicListWait(const int _wait);
+
 /// \brief External hook to execute 'gz service -l' from the command line.
 extern "C" void cmdServiceList();
 
+/// \brief External hook to execute 'gz service -l --wait' from the command
+/// line. See cmdTopicInfoWait().
+/// \param[in] _wait Maximum time (ms) waiting for the discovery, or a
+/// negative value to wait until it's initialized.
+extern "C" void cmdServiceListWait(const int _wait);
+
 /// \brief External hook to execute 'gz topic -p' from the command line.
 /// \param[in] _topic Topic name.
 /// \param[in] _msgType Message type.
@@ -65,6 +93,65 @@ extern "C" void cmdServiceReq(const char *_service,
                               const int _timeout,
                               const char *_reqData);
 
+/// \brief External hook to execute 'gz service -r --stats' from the command
+/// line. The service is requested several times and the latencies of each
+/// responser are printed.
+/// \param[in] _service Service name.
+/// \param[in] _reqType Message type used in the request.
+/// \param[in] _repType Message type used in the response.
+/// \param[in] _timeout Each request will timeout after '_timeout' ms.
+/// \param[in] _reqData Input data sent in the requests.
+/// \param[in] _count Number of requests.
+extern "C" void cmdServiceStats(const char *_service,
+                                const char *_reqType,
+                                const char *_repType,
+                                const int _timeout,
+                                const char *_reqData,
+                                const int _count);
+
+/// \brief External hook to execute 'gz topic -p' as a load generator. A
+/// single node publishes the message, serialized once, from several threads.
+/// The achieved rate and the latencies of the publications are printed.
+/// \param[in] _topic Topic name.
+/// \param[in] _msgType Message type.
+/// \param[in] _msgData Message data, see cmdTopicPub().
+/// \param[in] _count Number of messages.
+/// \param[in] _rate Number of messages per second, 0 for no limit.
+/// \param[in] _size Size (bytes) of the serialized message, padded with a
+/// field unknown to the subscribers, or 0 to keep its size.
+/// \param[in] _concurrency Number of publishing threads.
+extern "C" void cmdTopicPubLoad(const char *_topic,
+                                const char *_msgType,
+                                const char *_msgData,
+                                const int _count,
+                                const double _rate,
+                                const int _size,
+                                const int _concurrency);
+
+/// \brief External hook to execute 'gz service -r' as a load generator.
+/// A single node requests the service from several threads. The achieved
+/// rate and the latencies of the requests are printed.
+/// \param[in] _service Service name.
+/// \param[in] _reqType Message type used in the request.
+/// \param[in] _repType Message type used in the response.
+/// \param[in] _timeout Each request will timeout after '_timeout' ms.
+/// \param[in] _reqData Input data sent in the requests.
+/// \param[in] _count Number of requests.
+/// \param[in] _rate Number of requests per second, 0 for no limit.
+/// \param[in] _size Size (bytes) of the serialized request, padded with a
+/// field unknown to the responsers, or 0 to keep its size.
+/// \param[in] _concurrency Number of requesting threads, each one waiting
+/// for its response before the next request.
+extern "C" void cmdServiceReqLoad(const char *_service,
+                                  const char *_reqType,
+                                  const char *_repType,
+                                  const int _timeout,
+                                  const char *_reqData,
+                                  const int _count,
+                                  const double _rate,
+                                  const int _size,
+                                  const int _concurrency);
+
 extern "C" {
   /// \brief Enum used for specifing the message output format for functions
   /// like cmdTopicEcho.
@@ -92,6 +179,61 @@ extern "C" {
 extern "C" void cmdTopicEcho(const char *_topic, const double _duration,
                              int _count, MsgOutputFormat _outputFormat);
 
+/// \brief External hook to execute 'gz topic -e' with sampling, to keep up
+/// with high rate topics. See cmdTopicEcho() for the other parameters.
+/// \param[in] _every Print one message every _every messages received.
+/// The other messages aren't formatted.
+/// \param[in] _maxRate Maximum number of messages per second, 0 for no
+/// limit. The publishers of other processes don't send the messages beyond
+/// this rate, see SubscribeOptions::SetMsgsPerSec().
+extern "C" void cmdTopicEchoSampled(const char *_topic,
+                                    const double _duration, int _count,
+                                    MsgOutputFormat _outputFormat,
+                                    int _every, uint64_t _maxRate);
+
+/// \brief External hook to execute 'gz topic -e --raw' from the command
+/// line. The messages aren't deserialized: the number of messages and bytes
+/// received are printed every second, and the messages can be dumped to a
+/// file. See cmdTopicEcho() for the other parameters.
+/// \param[in] _dumpFile Path of a file where the serialized messages are
+/// written, or nullptr or an empty string. Every message is its size, as 8
+/// little-endian bytes, followed by its data.
+extern "C" void cmdTopicEchoRaw(const char *_topic, const double _duration,
+                                int _count, const char *_dumpFile);
+
+/// \brief External hook to execute 'gz topic --stats' from the command
+/// line. It subscribes to a topic and prints the statistics of the messages
+/// received: the time between messages and their age, with percentiles.
+/// \param[in] _topic Topic name.
+/// \param[in] _duration Duration (seconds) of the measurement.
+extern "C" void cmdTopicStats(const char *_topic, const double _duration);
+
+/// \brief External hook to execute 'gz topic --hz' from the command line.
+/// It subscribes to the topics matching a pattern without deserializing
+/// their messages, and prints the rate, bandwidth, sizes and jitter of the
+/// messages received during the duration.
+/// \param[in] _topics Topic name, or ECMAScript regular expression matching
+/// the names of the topics.
+/// \param[in] _duration Duration (seconds) of the measurement.
+extern "C" void cmdTopicRate(const char *_topics, const double _duration);
+
+/// \brief External hook to execute 'gz topic --callbacks' from the command
+/// line. It listens to the metrics published by the processes during the
+/// duration and prints the execution time of their subscription callbacks,
+/// the most expensive first.
+/// \param[in] _topic Topic name of the subscriptions, or an empty string
+/// for all the topics.
+/// \param[in] _duration Duration (seconds) of the measurement.
+extern "C" void cmdTopicCallbacks(const char *_topic, const double _duration);
+
+/// \brief External hook to execute 'gz topic --stats-all' from the command
+/// line. It listens to the metrics published by the processes during the
+/// duration and prints the system-wide statistics of each topic: its
+/// throughput, the messages dropped and their age, see StatsAggregator.
+/// \param[in] _topic Topic name, or an empty string for all the topics.
+/// \param[in] _duration Duration (seconds) of the measurement.
+extern "C" void cmdTopicStatsAll(const char *_topic, const double _duration);
+
 /// \brief External hook to read the library version.
 /// \return C-string representing the version. Ex.: 0.1.2
 extern "C" const char *gzVersion();
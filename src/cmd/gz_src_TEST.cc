@@ -18,10 +18,16 @@
 
 #include <gz/msgs/int32.pb.h>
 
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
 #include <future>
+#include <iterator>
 #include <string>
 #include <iostream>
 #include <sstream>
+#include <thread>
 
 #include "gz.hh"
 #include "gz/transport/Node.hh"
@@ -288,6 +294,175 @@ TEST(gzTest, cmdTopicEchoOutputFormats)
   restoreIO();
 }
 
+/////////////////////////////////////////////////
+TEST(gzTest, cmdTopicEchoRaw)
+{
+  std::stringstream  stdOutBuffer;
+  std::stringstream  stdErrBuffer;
+  redirectIO(stdOutBuffer, stdErrBuffer);
+
+  cmdTopicEchoSampled(g_topic.c_str(), 1.00, 0, MsgOutputFormat::kDefault,
+                      0, 0);
+  EXPECT_EQ(stdErrBuffer.str(),
+            "Invalid sampling. Every message must be 1 or more.\n");
+  clearIOStreams(stdOutBuffer, stdErrBuffer);
+
+  transport::Node node;
+  gz::msgs::Int32 msg;
+  msg.set_data(5);
+
+  const std::string dumpFile = "gz_src_TEST_dump.bin";
+  auto rawOutput = std::async(std::launch::async, [&]
+  {
+    cmdTopicEchoRaw(g_topic.c_str(), -1, 1, dumpFile.c_str());
+    return stdOutBuffer.str();
+  });
+
+  cmdTopicPub(g_topic.c_str(), g_intType.c_str(), msg.DebugString().c_str());
+  const std::string output = rawOutput.get();
+  const std::string size = std::to_string(msg.ByteSizeLong());
+  EXPECT_NE(std::string::npos,
+            output.find("Total: 1 messages, " + size + " bytes"));
+
+  // The dump is the size of the message and the message.
+  std::ifstream dump(dumpFile, std::ios::binary);
+  const std::string data{std::istreambuf_iterator<char>(dump),
+                         std::istreambuf_iterator<char>()};
+  ASSERT_EQ(8u + msg.ByteSizeLong(), data.size());
+  EXPECT_EQ(static_cast<char>(msg.ByteSizeLong()), data[0]);
+  gz::msgs::Int32 dumped;
+  EXPECT_TRUE(dumped.ParseFromString(data.substr(8)));
+  EXPECT_EQ(5, dumped.data());
+  dump.close();
+  std::remove(dumpFile.c_str());
+
+  restoreIO();
+}
+
+/////////////////////////////////////////////////
+TEST(gzTest, cmdTopicRate)
+{
+  std::stringstream  stdOutBuffer;
+  std::stringstream  stdErrBuffer;
+  redirectIO(stdOutBuffer, stdErrBuffer);
+
+  cmdTopicRate("/rate", 0);
+  EXPECT_EQ(stdErrBuffer.str(), "The duration must be positive.\n");
+  clearIOStreams(stdOutBuffer, stdErrBuffer);
+
+  cmdTopicRate("/rate[", 1.0);
+  EXPECT_EQ(stdErrBuffer.str(), "Invalid pattern [/rate[].\n");
+  clearIOStreams(stdOutBuffer, stdErrBuffer);
+
+  transport::Node node;
+  auto pub = node.Advertise<gz::msgs::Int32>("/rate_topic");
+  ASSERT_TRUE(pub);
+  std::atomic<bool> stop{false};
+  std::thread publisher([&]
+  {
+    gz::msgs::Int32 msg;
+    msg.set_data(5);
+    while (!stop)
+    {
+      pub.Publish(msg);
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+  });
+
+  cmdTopicRate("/rate_.*", 1.0);
+  stop = true;
+  publisher.join();
+
+  const std::string output = stdOutBuffer.str();
+  EXPECT_NE(std::string::npos, output.find("Topic [/rate_topic]"));
+  EXPECT_NE(std::string::npos, output.find(" Hz  bandwidth: "));
+  EXPECT_NE(std::string::npos, output.find("size (bytes):  avg 2.00"));
+
+  restoreIO();
+}
+
+/////////////////////////////////////////////////
+TEST(gzTest, cmdTopicPubLoad)
+{
+  std::stringstream  stdOutBuffer;
+  std::stringstream  stdErrBuffer;
+  redirectIO(stdOutBuffer, stdErrBuffer);
+
+  cmdTopicPubLoad(g_topic.c_str(), g_intType.c_str(), g_reqData.c_str(),
+                  0, 0, 0, 1);
+  EXPECT_EQ(stdErrBuffer.str(), "The count must be positive.\n");
+  clearIOStreams(stdOutBuffer, stdErrBuffer);
+
+  cmdTopicPubLoad(g_topic.c_str(), g_intType.c_str(), g_reqData.c_str(),
+                  10, 0, 1, 1);
+  EXPECT_EQ(stdErrBuffer.str(),
+            "Unable to pad the message of 2 bytes to 1 bytes.\n");
+  clearIOStreams(stdOutBuffer, stdErrBuffer);
+
+  // The padded messages are parsed by the subscribers.
+  std::atomic<int> received{0};
+  std::atomic<int> badMessages{0};
+  transport::RawCallback cb = [&](const char *_data,
+    const std::size_t _size, const transport::MessageInfo &)
+  {
+    gz::msgs::Int32 msg;
+    if (_size != 256u || !msg.ParseFromArray(_data, static_cast<int>(_size))
+        || msg.data() != 10)
+    {
+      ++badMessages;
+    }
+    ++received;
+  };
+  transport::Node node;
+  ASSERT_TRUE(node.SubscribeRaw(g_topic, cb));
+
+  cmdTopicPubLoad(g_topic.c_str(), g_intType.c_str(), g_reqData.c_str(),
+                  20, 1000, 256, 2);
+  for (int i = 0; i < 100 && received < 20; ++i)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_EQ(20, received);
+  EXPECT_EQ(0, badMessages);
+
+  const std::string output = stdOutBuffer.str();
+  EXPECT_NE(std::string::npos, output.find("20 messages of 256 bytes in "));
+  EXPECT_NE(std::string::npos, output.find("0 failed"));
+  EXPECT_NE(std::string::npos, output.find("  publish           20"));
+
+  restoreIO();
+}
+
+/////////////////////////////////////////////////
+TEST(gzTest, cmdServiceReqLoad)
+{
+  std::stringstream  stdOutBuffer;
+  std::stringstream  stdErrBuffer;
+  redirectIO(stdOutBuffer, stdErrBuffer);
+
+  cmdServiceReqLoad(g_service.c_str(), g_intType.c_str(), "gz.msgs.Empty",
+                    100, g_reqData.c_str(), 10, 0, 0, 1);
+  EXPECT_EQ(stdErrBuffer.str(), "The load generation requires a response, "
+            "oneway services are not supported.\n");
+  clearIOStreams(stdOutBuffer, stdErrBuffer);
+
+  cmdServiceReqLoad(g_service.c_str(), g_intType.c_str(), g_intType.c_str(),
+                    100, g_reqData.c_str(), 10, 0, 0, 0);
+  EXPECT_EQ(stdErrBuffer.str(), "The concurrency must be positive.\n");
+  clearIOStreams(stdOutBuffer, stdErrBuffer);
+
+  // The echo service answers with a failure.
+  transport::Node node;
+  EXPECT_TRUE(node.Advertise(g_service, srvEcho));
+  cmdServiceReqLoad(g_service.c_str(), g_intType.c_str(), g_intType.c_str(),
+                    1000, g_reqData.c_str(), 20, 0, 64, 4);
+
+  const std::string output = stdOutBuffer.str();
+  EXPECT_NE(std::string::npos, output.find("20 requests of 64 bytes in "));
+  EXPECT_NE(std::string::npos, output.find("20 failed, 0 timed out"));
+  EXPECT_NE(std::string::npos, output.find("  round trip        20"));
+
+  restoreIO();
+}
+
 /////////////////////////////////////////////////
 /// Main
 int main(int argc, char **argv)
@@ -53,6 +53,29 @@ struct ServiceOptions
 
   /// \brief Timeout to use when requesting (in milliseconds)
   int timeout{1000};
+
+  /// \brief Print the latency statistics of the requests
+  bool stats{false};
+
+  /// \brief Number of requests when printing the statistics or generating
+  /// load
+  int count{100};
+
+  /// \brief Number of requests per second, 0 for no limit
+  double rate{0};
+
+  /// \brief Size (bytes) of the requests, 0 to keep their size
+  int size{0};
+
+  /// \brief Number of requesting threads
+  int concurrency{1};
+
+  /// \brief Request as a load generator
+  bool load{false};
+
+  /// \brief Maximum time (ms) waiting for the discovery, negative for no
+  /// limit
+  int wait{-1};
 };
 
 //////////////////////////////////////////////////
@@ -62,10 +85,10 @@ void runServiceCommand(const ServiceOptions &_opt)
   switch(_opt.command)
   {
     case ServiceCommand::kServiceList:
-      cmdServiceList();
+      cmdServiceListWait(_opt.wait);
       break;
     case ServiceCommand::kServiceInfo:
-      cmdServiceInfo(_opt.service.c_str());
+      cmdServiceInfoWait(_opt.service.c_str(), _opt.wait);
       break;
     case ServiceCommand::kServiceReq:
       if (_opt.repType.empty())
@@ -75,19 +98,30 @@ void runServiceCommand(const ServiceOptions &_opt)
             _opt.reqType.c_str(), "gz.msgs.Empty",
             0, _opt.reqData.c_str());
       }
-      else if (_opt.reqType.empty())
-      {
-        // No input service request.
-        cmdServiceReq(_opt.service.c_str(),
-            "gz.msgs.Empty", _opt.repType.c_str(),
-            _opt.timeout, "unused:true");
-      }
       else
       {
-        // Two-way service request.
-        cmdServiceReq(_opt.service.c_str(),
-            _opt.reqType.c_str(), _opt.repType.c_str(),
-            _opt.timeout, _opt.reqData.c_str());
+        // No input or two-way service request.
+        const bool noInput = _opt.reqType.empty();
+        const char *reqType =
+          noInput ? "gz.msgs.Empty" : _opt.reqType.c_str();
+        const char *reqData =
+          noInput ? "unused:true" : _opt.reqData.c_str();
+        if (_opt.load)
+        {
+          cmdServiceReqLoad(_opt.service.c_str(), reqType,
+              _opt.repType.c_str(), _opt.timeout, reqData, _opt.count,
+              _opt.rate, _opt.size, _opt.concurrency);
+        }
+        else if (_opt.stats)
+        {
+          cmdServiceStats(_opt.service.c_str(), reqType,
+              _opt.repType.c_str(), _opt.timeout, reqData, _opt.count);
+        }
+        else
+        {
+          cmdServiceReq(_opt.service.c_str(), reqType,
+              _opt.repType.c_str(), _opt.timeout, reqData);
+        }
       }
       break;
     case ServiceCommand::kNone:
@@ -108,6 +142,25 @@ void addServiceFlags(CLI::App &_app)
   _app.add_option("--reqtype", opt->reqType, "Type of a request.");
   _app.add_option("--reptype", opt->repType, "Type of a response.");
   _app.add_option("--timeout", opt->timeout, "Timeout in milliseconds.");
+  _app.add_flag("--stats", opt->stats,
+      "Request the service several times and print the latencies.");
+  _app.add_option("-n,--num,--count", opt->count,
+      "Number of requests used with --stats or the load options.");
+  auto rateOpt = _app.add_option("--rate", opt->rate,
+R"(Request the service -n times at this rate (requests per
+second), and print the achieved rate and the latencies.)");
+  auto sizeOpt = _app.add_option("--size", opt->size,
+R"(Pad the request to this size (bytes) with a field unknown
+to the responser.)");
+  auto concurrencyOpt = _app.add_option("--concurrency", opt->concurrency,
+      "Number of threads requesting the service -n times.");
+  for (CLI::Option *loadOpt : {rateOpt, sizeOpt, concurrencyOpt})
+    loadOpt->each([opt](const std::string &){ opt->load = true; });
+
+  _app.add_option("--wait", opt->wait,
+R"(Maximum time (ms) -l and -i wait for the discovery to
+learn the services of the other processes. The result
+might be incomplete if it's not done in time.)");
 
   auto command = _app.add_option_group("command", "Command to be executed.");
 
@@ -136,6 +189,12 @@ the same used by Protobuf DebugString(). E.g.:
     --reptype gz.msgs.StringMsg \
     --timeout 2000 \
     --req 'data: "Hello"'
+With --rate, --size or --concurrency, request the
+service -n times as a load generator. E.g.:
+  gz service -s /echo \
+    --reqtype gz.msgs.StringMsg \
+    --reptype gz.msgs.StringMsg \
+    --req 'data: "Hello"' -n 10000 --concurrency 8
 )")
     ->needs(serviceOpt)
     ->expected(0, 1);
@@ -30,7 +30,11 @@ enum class TopicCommand
   kTopicList,
   kTopicInfo,
   kTopicPub,
-  kTopicEcho
+  kTopicEcho,
+  kTopicStats,
+  kTopicRate,
+  kTopicCallbacks,
+  kTopicStatsAll
 };
 
 //////////////////////////////////////////////////
@@ -57,6 +61,34 @@ struct TopicOptions
 
   /// \brief Message output format
   MsgOutputFormat msgOutputFormat {MsgOutputFormat::kDefault};
+
+  /// \brief Echo one message every this number of messages
+  int every{1};
+
+  /// \brief Maximum number of messages per second to echo, 0 for no limit
+  uint64_t maxRate{0};
+
+  /// \brief Echo the number of messages and bytes, without deserializing
+  bool raw{false};
+
+  /// \brief File where the serialized messages are dumped
+  std::string dumpFile{""};
+
+  /// \brief Number of messages per second to publish, 0 for no limit
+  double rate{0};
+
+  /// \brief Size (bytes) of the published messages, 0 to keep their size
+  int size{0};
+
+  /// \brief Number of publishing threads
+  int concurrency{1};
+
+  /// \brief Publish as a load generator
+  bool load{false};
+
+  /// \brief Maximum time (ms) waiting for the discovery, negative for no
+  /// limit
+  int wait{-1};
 };
 
 //////////////////////////////////////////////////
@@ -66,19 +98,53 @@ void runTopicCommand(const TopicOptions &_opt)
   switch(_opt.command)
   {
     case TopicCommand::kTopicList:
-      cmdTopicList();
+      cmdTopicListWait(_opt.wait);
       break;
     case TopicCommand::kTopicInfo:
-      cmdTopicInfo(_opt.topic.c_str());
+      cmdTopicInfoWait(_opt.topic.c_str(), _opt.wait);
       break;
     case TopicCommand::kTopicPub:
-      cmdTopicPub(_opt.topic.c_str(),
-                  _opt.msgType.c_str(),
-                  _opt.msgData.c_str());
+      if (_opt.load)
+      {
+        cmdTopicPubLoad(_opt.topic.c_str(), _opt.msgType.c_str(),
+                        _opt.msgData.c_str(),
+                        _opt.count > 0 ? _opt.count : 1000, _opt.rate,
+                        _opt.size, _opt.concurrency);
+      }
+      else
+      {
+        cmdTopicPub(_opt.topic.c_str(),
+                    _opt.msgType.c_str(),
+                    _opt.msgData.c_str());
+      }
       break;
     case TopicCommand::kTopicEcho:
-      cmdTopicEcho(_opt.topic.c_str(), _opt.duration, _opt.count,
-                   _opt.msgOutputFormat);
+      if (_opt.raw || !_opt.dumpFile.empty())
+      {
+        cmdTopicEchoRaw(_opt.topic.c_str(), _opt.duration, _opt.count,
+                        _opt.dumpFile.c_str());
+      }
+      else
+      {
+        cmdTopicEchoSampled(_opt.topic.c_str(), _opt.duration, _opt.count,
+                            _opt.msgOutputFormat, _opt.every, _opt.maxRate);
+      }
+      break;
+    case TopicCommand::kTopicStats:
+      cmdTopicStats(_opt.topic.c_str(),
+                    _opt.duration < 0 ? 5.0 : _opt.duration);
+      break;
+    case TopicCommand::kTopicRate:
+      cmdTopicRate(_opt.topic.c_str(),
+                   _opt.duration < 0 ? 5.0 : _opt.duration);
+      break;
+    case TopicCommand::kTopicCallbacks:
+      cmdTopicCallbacks(_opt.topic.c_str(),
+                        _opt.duration < 0 ? 3.0 : _opt.duration);
+      break;
+    case TopicCommand::kTopicStatsAll:
+      cmdTopicStatsAll(_opt.topic.c_str(),
+                       _opt.duration < 0 ? 3.0 : _opt.duration);
       break;
     case TopicCommand::kNone:
     default:
@@ -99,9 +165,42 @@ void addTopicFlags(CLI::App &_app)
   auto durationOpt = _app.add_option("-d,--duration",
                                      opt->duration,
                                      "Duration (seconds) to run.");
-  auto countOpt = _app.add_option("-n,--num",
+  auto countOpt = _app.add_option("-n,--num,--count",
                                   opt->count,
-                                  "Number of messages to echo and then exit.");
+R"(Number of messages to echo and then exit, or to
+publish with the load options (1000 by default).)");
+
+  _app.add_option("--every", opt->every,
+R"(Echo one message every N messages received, the
+others aren't formatted.)");
+  _app.add_option("--max-rate", opt->maxRate,
+R"(Maximum number of messages per second to echo. The
+publishers don't even send the other messages.)");
+  _app.add_flag("--raw", opt->raw,
+R"(Echo the number of messages and bytes received every
+second, without deserializing the messages.)");
+  _app.add_option("--dump", opt->dumpFile,
+R"(Write the serialized messages to a file, each one
+preceded by its size as 8 little-endian bytes.
+Implies --raw.)");
+
+  auto rateOpt = _app.add_option("--rate", opt->rate,
+R"(Publish -n messages at this rate (messages per second),
+and print the achieved rate and the publication latencies.)");
+  auto sizeOpt = _app.add_option("--size", opt->size,
+R"(Pad the published message to this size (bytes) with a
+field unknown to the subscribers.)");
+  auto concurrencyOpt = _app.add_option("--concurrency", opt->concurrency,
+    "Number of threads publishing the -n messages.");
+  for (CLI::Option *loadOpt : {rateOpt, sizeOpt, concurrencyOpt})
+    loadOpt->each([opt](const std::string &){ opt->load = true; });
+
+  _app.add_option("--wait", opt->wait,
+R"(Maximum time (ms) -l and -i wait for the discovery to
+learn the topics of the other processes. It's usually
+done as soon as a process answers, or after two
+heartbeats if there isn't any. The result might be
+incomplete if it's not done in time.)");
 
   durationOpt->excludes(countOpt);
   countOpt->excludes(durationOpt);
@@ -127,9 +226,59 @@ R"(Get info about a topic. E.g.:
       opt->command = TopicCommand::kTopicEcho;
     },
 R"(Output data to screen. E.g.:
-  gz topic -e -t /foo)")
+  gz topic -e -t /foo
+High rate topics can be sampled or only measured:
+  gz topic -e -t /foo --every 100
+  gz topic -e -t /foo --raw --dump foo.bin)")
+    ->needs(topicOpt);
+
+  command->add_flag_callback("--stats",
+    [opt](){
+      opt->command = TopicCommand::kTopicStats;
+    },
+R"(Print the time between the messages and their age, with
+percentiles, measured during the duration (5 seconds by default).
+The publishers and this command must run with
+GZ_TRANSPORT_TOPIC_STATISTICS=1. E.g.:
+  gz topic --stats -t /foo -d 10)")
     ->needs(topicOpt);
 
+  command->add_flag_callback("--hz,--bw",
+    [opt](){
+      opt->command = TopicCommand::kTopicRate;
+    },
+R"(Print the rate, bandwidth, message sizes and jitter of
+the topics matching -t, a topic name or a regular
+expression, measured during the duration (5 seconds by
+default). The messages aren't deserialized and the
+publishers don't need to enable statistics. E.g.:
+  gz topic --hz -t '/camera/.*' -d 10)")
+    ->needs(topicOpt);
+
+  command->add_flag_callback("--callbacks",
+    [opt](){
+      opt->command = TopicCommand::kTopicCallbacks;
+    },
+R"(Print the number of callbacks executed by each subscription
+and their execution time, the most expensive first, listening
+during the duration (3 seconds by default). -t only keeps the
+subscriptions of a topic. The subscribers must run with
+GZ_TRANSPORT_METRICS=1 and GZ_TRANSPORT_CALLBACK_STATISTICS=1.
+E.g.:
+  gz topic --callbacks -d 10)");
+
+  command->add_flag_callback("--stats-all",
+    [opt](){
+      opt->command = TopicCommand::kTopicStatsAll;
+    },
+R"(Print the system-wide rate, bandwidth, drops and latency of
+every topic, aggregated from the metrics of all the processes
+during the duration (3 seconds by default). -t only keeps a
+topic. The processes must run with GZ_TRANSPORT_METRICS=1,
+the latencies also need GZ_TRANSPORT_TOPIC_STATISTICS=1 and
+Node::EnableStats() in the subscribers. E.g.:
+  gz topic --stats-all -d 5)");
+
   command->add_flag_callback("--json-output",
       [opt]() { opt->msgOutputFormat = MsgOutputFormat::kJSON; },
       "Output messages in JSON format.");
@@ -143,7 +292,11 @@ R"(Publish a message.
 TEXT is the message data. The format expected is
 the same used by Protobuf DebugString(). E.g.:
   gz topic -t /foo -m gz.msgs.StringMsg \
-    -p 'data:"Custom data"')")
+    -p 'data:"Custom data"'
+With --rate, --size or --concurrency, publish -n messages
+as a load generator. E.g.:
+  gz topic -t /foo -m gz.msgs.StringMsg -p 'data:"x"' \
+    -n 10000 --rate 1000 --size 4096 --concurrency 2)")
     ->needs(topicOpt)
     ->needs(msgTypeOpt);
 
@@ -23,6 +23,9 @@
 GZ_LOG_SUBCOMMANDS="
 record
 playback
+convert
+reindex
+export
 "
 
 GZ_LOG_COMPLETION_LIST="
@@ -40,6 +43,30 @@ GZ_PLAYBACK_COMPLETION_LIST="
   -f
 "
 
+GZ_CONVERT_COMPLETION_LIST="
+  -h --help
+  -v --verbose
+  --file
+  --output
+  --format
+  --compression
+"
+
+GZ_REINDEX_COMPLETION_LIST="
+  -h --help
+  -v --verbose
+  --file
+"
+
+GZ_EXPORT_COMPLETION_LIST="
+  -h --help
+  -v --verbose
+  --file
+  --output
+  --pattern
+  --threads
+"
+
 GZ_RECORD_COMPLETION_LIST="
   -h --help
   -v --verbose
@@ -55,6 +82,12 @@ GZ_SERVICE_COMPLETION_LIST="
   --reqtype
   --reptype
   --timeout
+  --stats
+  -n --num --count
+  --rate
+  --size
+  --concurrency
+  --wait
   -l --list
   -i --info
   -r --req
@@ -65,13 +98,26 @@ GZ_TOPIC_COMPLETION_LIST="
   -t --topic
   -m --msgtype
   -d --duration
-  -n --num
+  -n --num --count
   -l --list
   -i --info
   -e --echo
   -p --pub
   -v --version
   --json-output
+  --stats
+  --stats-all
+  --callbacks
+  --hz
+  --bw
+  --every
+  --max-rate
+  --raw
+  --dump
+  --rate
+  --size
+  --concurrency
+  --wait
 "
 
 function __get_comp_from_list {
@@ -94,6 +140,21 @@ function _gz_log_playback
   __get_comp_from_list "$GZ_PLAYBACK_COMPLETION_LIST"
 }
 
+function _gz_log_convert
+{
+  __get_comp_from_list "$GZ_CONVERT_COMPLETION_LIST"
+}
+
+function _gz_log_reindex
+{
+  __get_comp_from_list "$GZ_REINDEX_COMPLETION_LIST"
+}
+
+function _gz_log_export
+{
+  __get_comp_from_list "$GZ_EXPORT_COMPLETION_LIST"
+}
+
 function _gz_log_record
 {
   __get_comp_from_list "$GZ_RECORD_COMPLETION_LIST"
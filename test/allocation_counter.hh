@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GZ_TRANSPORT_TEST_ALLOCATION_COUNTER_HH_
+#define GZ_TRANSPORT_TEST_ALLOCATION_COUNTER_HH_
+
+// This header replaces the global operator new and delete of the test
+// executable to count the allocations of all the threads. Include it in
+// exactly one translation unit of the executable, the test file.
+//
+// Only the allocations made with operator new are counted: the ones made
+// with malloc, such as the ZeroMQ frames or the SQLite pages, are not.
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+namespace testing
+{
+  /// \brief Number of allocations made by operator new since the start of
+  /// the executable.
+  inline std::atomic<uint64_t> g_allocations{0};
+
+  /// \brief Number of bytes allocated by operator new since the start of
+  /// the executable.
+  inline std::atomic<uint64_t> g_allocatedBytes{0};
+
+  /// \brief Counts the allocations of all the threads of the process since
+  /// its creation. Background threads, such as the discovery, allocate too,
+  /// so measure many operations and compare the mean to a bound.
+  class AllocationCounter
+  {
+    /// \brief Constructor, starts counting.
+    public: AllocationCounter()
+      : allocations(g_allocations.load()),
+        bytes(g_allocatedBytes.load())
+    {
+    }
+
+    /// \brief Number of allocations since the creation of the counter.
+    /// \return The number of allocations.
+    public: uint64_t Allocations() const
+    {
+      return g_allocations.load() - this->allocations;
+    }
+
+    /// \brief Number of bytes allocated since the creation of the counter.
+    /// \return The number of bytes.
+    public: uint64_t Bytes() const
+    {
+      return g_allocatedBytes.load() - this->bytes;
+    }
+
+    /// \brief Allocations at the creation of the counter.
+    private: const uint64_t allocations;
+
+    /// \brief Bytes allocated at the creation of the counter.
+    private: const uint64_t bytes;
+  };
+
+  /// \brief Allocate and count memory for operator new.
+  /// \param[in] _size Number of bytes.
+  /// \return The memory, nullptr if the allocation failed.
+  inline void *countedAlloc(std::size_t _size)
+  {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    g_allocatedBytes.fetch_add(_size, std::memory_order_relaxed);
+    return std::malloc(_size == 0 ? 1 : _size);
+  }
+}  // namespace testing
+
+//////////////////////////////////////////////////
+void *operator new(std::size_t _size)
+{
+  if (void *ptr = testing::countedAlloc(_size))
+    return ptr;
+  throw std::bad_alloc();
+}
+
+//////////////////////////////////////////////////
+void *operator new[](std::size_t _size)
+{
+  if (void *ptr = testing::countedAlloc(_size))
+    return ptr;
+  throw std::bad_alloc();
+}
+
+//////////////////////////////////////////////////
+void *operator new(std::size_t _size, const std::nothrow_t &) noexcept
+{
+  return testing::countedAlloc(_size);
+}
+
+//////////////////////////////////////////////////
+void *operator new[](std::size_t _size, const std::nothrow_t &) noexcept
+{
+  return testing::countedAlloc(_size);
+}
+
+//////////////////////////////////////////////////
+void operator delete(void *_ptr) noexcept
+{
+  std::free(_ptr);
+}
+
+//////////////////////////////////////////////////
+void operator delete[](void *_ptr) noexcept
+{
+  std::free(_ptr);
+}
+
+//////////////////////////////////////////////////
+void operator delete(void *_ptr, std::size_t) noexcept
+{
+  std::free(_ptr);
+}
+
+//////////////////////////////////////////////////
+void operator delete[](void *_ptr, std::size_t) noexcept
+{
+  std::free(_ptr);
+}
+
+#endif  // GZ_TRANSPORT_TEST_ALLOCATION_COUNTER_HH_
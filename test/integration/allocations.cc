@@ -0,0 +1,196 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include <gz/msgs/int32.pb.h>
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "gz/transport/Node.hh"
+
+#include <gz/utils/Environment.hh>
+#include <gz/utils/Subprocess.hh>
+
+#include "gtest/gtest.h"
+#include "allocation_counter.hh"
+#include "test_config.hh"
+#include "test_utils.hh"
+
+using namespace gz;
+
+// Upper bounds of the mean number of allocations per message in steady
+// state. Lower them when an allocation is removed from a hot path, so that
+// it stays removed.
+
+/// \brief Publish() without any subscriber.
+static const double kMaxPublishNoSubscriber = 2;
+
+/// \brief Publish() to a subscriber of the same process, including the
+/// publish queue and the callback.
+static const double kMaxPublishLocal = 24;
+
+/// \brief PublishRaw() to a raw subscriber of the same process, including
+/// the publish queue and the callback.
+static const double kMaxPublishRawLocal = 24;
+
+/// \brief Reception of a message of another process: RecvMsgUpdate() and
+/// TriggerCallbacks().
+static const double kMaxReceive = 32;
+
+/// \brief Number of messages measured.
+static const int kMessages = 1000;
+
+static std::string partition;  // NOLINT(*)
+
+//////////////////////////////////////////////////
+/// \brief Wait until a counter reaches a value.
+/// \param[in] _counter The counter.
+/// \param[in] _value The value.
+/// \return True if the value was reached within 5 seconds.
+static bool waitFor(const std::atomic<int> &_counter, int _value)
+{
+  for (int i = 0; i < 500 && _counter < _value; ++i)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  return _counter >= _value;
+}
+
+//////////////////////////////////////////////////
+/// \brief Mean number of allocations per message of a counter.
+/// \param[in] _counter The counter.
+/// \param[in] _name Name of the path, printed with the result.
+/// \return The mean.
+static double perMessage(const testing::AllocationCounter &_counter,
+  const std::string &_name)
+{
+  const double allocs = static_cast<double>(_counter.Allocations()) /
+    kMessages;
+  std::cout << _name << ": " << allocs << " allocations, "
+            << static_cast<double>(_counter.Bytes()) / kMessages
+            << " bytes per message" << std::endl;
+  return allocs;
+}
+
+//////////////////////////////////////////////////
+TEST(allocations, PublishNoSubscriber)
+{
+  transport::Node node;
+  auto pub = node.Advertise<msgs::Int32>("/alloc_none");
+  msgs::Int32 msg;
+  // Warm up the caches of the path.
+  for (int i = 0; i < 100; ++i)
+    pub.Publish(msg);
+
+  testing::AllocationCounter counter;
+  for (int i = 0; i < kMessages; ++i)
+    EXPECT_TRUE(pub.Publish(msg));
+  EXPECT_LE(perMessage(counter, "Publish, no subscriber"),
+    kMaxPublishNoSubscriber);
+}
+
+//////////////////////////////////////////////////
+TEST(allocations, PublishLocal)
+{
+  transport::Node node;
+  std::atomic<int> received{0};
+  std::function<void(const msgs::Int32 &)> cb =
+    [&received](const msgs::Int32 &)
+  {
+    ++received;
+  };
+  auto pub = node.Advertise<msgs::Int32>("/alloc_local");
+  ASSERT_TRUE(node.Subscribe("/alloc_local", cb));
+  msgs::Int32 msg;
+  for (int i = 0; i < 100; ++i)
+    pub.Publish(msg);
+  ASSERT_TRUE(waitFor(received, 100));
+
+  testing::AllocationCounter counter;
+  for (int i = 0; i < kMessages; ++i)
+    EXPECT_TRUE(pub.Publish(msg));
+  ASSERT_TRUE(waitFor(received, 100 + kMessages));
+  EXPECT_LE(perMessage(counter, "Publish, local subscriber"),
+    kMaxPublishLocal);
+}
+
+//////////////////////////////////////////////////
+TEST(allocations, PublishRawLocal)
+{
+  transport::Node node;
+  std::atomic<int> received{0};
+  transport::RawCallback cb = [&received](const char *, const std::size_t,
+    const transport::MessageInfo &)
+  {
+    ++received;
+  };
+  msgs::Int32 msg;
+  const std::string data = msg.SerializeAsString();
+  auto pub = node.Advertise<msgs::Int32>("/alloc_raw");
+  ASSERT_TRUE(node.SubscribeRaw("/alloc_raw", cb, msg.GetTypeName()));
+  for (int i = 0; i < 100; ++i)
+    pub.PublishRaw(data, msg.GetTypeName());
+  ASSERT_TRUE(waitFor(received, 100));
+
+  testing::AllocationCounter counter;
+  for (int i = 0; i < kMessages; ++i)
+    EXPECT_TRUE(pub.PublishRaw(data, msg.GetTypeName()));
+  ASSERT_TRUE(waitFor(received, 100 + kMessages));
+  EXPECT_LE(perMessage(counter, "PublishRaw, local subscriber"),
+    kMaxPublishRawLocal);
+}
+
+//////////////////////////////////////////////////
+TEST(allocations, Receive)
+{
+  auto pi = gz::utils::Subprocess(
+    {test_executables::kSteadyPublisher, partition});
+
+  transport::Node node;
+  std::atomic<int> received{0};
+  std::function<void(const msgs::Int32 &)> cb =
+    [&received](const msgs::Int32 &)
+  {
+    ++received;
+  };
+  ASSERT_TRUE(node.Subscribe("/steady", cb));
+  ASSERT_TRUE(waitFor(received, 100));
+
+  // Only this process receives, the publisher allocates in its own.
+  const int start = received;
+  testing::AllocationCounter counter;
+  ASSERT_TRUE(waitFor(received, start + kMessages));
+  const double allocs = static_cast<double>(counter.Allocations()) /
+    (received - start);
+  std::cout << "Receive: " << allocs << " allocations per message"
+            << std::endl;
+  EXPECT_LE(allocs, kMaxReceive);
+  pi.Terminate();
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  // Get a random partition name.
+  partition = testing::getRandomNumber();
+
+  // Set the partition name for this process.
+  gz::utils::setenv("GZ_PARTITION", partition);
+
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
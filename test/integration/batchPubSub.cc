@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include <gz/msgs/int32.pb.h>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include "gz/transport/Node.hh"
+
+#include <gz/utils/Environment.hh>
+#include <gz/utils/Subprocess.hh>
+
+#include "gtest/gtest.h"
+#include "test_config.hh"
+#include "test_utils.hh"
+
+using namespace gz;
+
+static std::string partition;  // NOLINT(*)
+
+//////////////////////////////////////////////////
+/// \brief Receive the messages of a batched publisher running in another
+/// process. The messages must be delivered one by one and in order.
+TEST(batchPubSub, PubSubTwoProcs)
+{
+  std::atomic<int> counter{0};
+  std::atomic<int> last{-1};
+  std::function<void(const msgs::Int32 &)> cb =
+    [&counter, &last](const msgs::Int32 &_msg)
+  {
+    EXPECT_GT(_msg.data(), last);
+    last = _msg.data();
+    ++counter;
+  };
+
+  transport::Node node;
+  EXPECT_TRUE(node.Subscribe("/batch", cb));
+
+  auto pi = gz::utils::Subprocess(
+    {test_executables::kBatchPublisher, partition});
+
+  // The publisher runs for three seconds.
+  std::this_thread::sleep_for(std::chrono::milliseconds(3500));
+
+  // Some messages are published before the connection is established.
+  EXPECT_GT(counter, 1000);
+  EXPECT_EQ(2999, last);
+  pi.Join();
+}
+
+//////////////////////////////////////////////////
+/// \brief The messages still batched when the publisher destroys its node
+/// and exits are delivered.
+TEST(batchPubSub, FlushOnExit)
+{
+  std::atomic<int> counter{0};
+  std::function<void(const msgs::Int32 &)> cb =
+    [&counter](const msgs::Int32 &) { ++counter; };
+
+  transport::Node node;
+  EXPECT_TRUE(node.Subscribe("/batch_exit", cb));
+
+  auto pi = gz::utils::Subprocess(
+    {test_executables::kBatchPublisher, partition, "exit"});
+  pi.Join();
+
+  // The batch delay is 10 seconds, the messages are sent on exit.
+  for (auto i = 0; i < 100 && counter < 10; ++i)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_EQ(10, counter);
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  // Get a random partition name.
+  partition = testing::getRandomNumber();
+
+  // Set the partition name for this process.
+  gz::utils::setenv("GZ_PARTITION", partition);
+
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
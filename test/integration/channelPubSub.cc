@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include <gz/msgs/bytes.pb.h>
+#include <gz/msgs/int32.pb.h>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gz/transport/Node.hh"
+
+#include <gz/utils/Environment.hh>
+#include <gz/utils/Subprocess.hh>
+
+#include "gtest/gtest.h"
+#include "test_config.hh"
+#include "test_utils.hh"
+
+using namespace gz;
+
+static std::string partition;  // NOLINT(*)
+
+//////////////////////////////////////////////////
+/// \brief Receive the topics of a process publishing on a channel and on
+/// the shared publisher socket. IPC is enabled in both processes, the
+/// channel must be received through its TCP endpoint anyway.
+TEST(channelPubSub, PubSubTwoProcs)
+{
+  std::atomic<int> bulkCounter{0};
+  std::function<void(const msgs::Bytes &)> bulkCb =
+    [&bulkCounter](const msgs::Bytes &_msg)
+  {
+    EXPECT_EQ(1024u * 1024u, _msg.data().size());
+    ++bulkCounter;
+  };
+
+  std::atomic<int> controlCounter{0};
+  std::function<void(const msgs::Int32 &)> controlCb =
+    [&controlCounter](const msgs::Int32 &)
+  {
+    ++controlCounter;
+  };
+
+  transport::Node node;
+  EXPECT_TRUE(node.Subscribe("/bulk", bulkCb));
+  EXPECT_TRUE(node.Subscribe("/control", controlCb));
+
+  // Both topics are advertised with different addresses.
+  auto pi = gz::utils::Subprocess(
+    {test_executables::kChannelPublisher, partition});
+
+  // The publisher runs for three seconds.
+  std::this_thread::sleep_for(std::chrono::milliseconds(3500));
+
+  // Some messages are published before the connection is established.
+  EXPECT_GT(bulkCounter, 10);
+  EXPECT_GT(controlCounter, 10);
+  pi.Join();
+}
+
+//////////////////////////////////////////////////
+/// \brief A topic advertised with a channel is published through a socket
+/// with its own address, shared by the topics of the channel.
+TEST(channelPubSub, ChannelAddress)
+{
+  transport::Node node;
+  transport::AdvertiseMessageOptions opts;
+  opts.SetChannel("bulk");
+  auto pub1 = node.Advertise<msgs::Int32>("/channel1", opts);
+  auto pub2 = node.Advertise<msgs::Int32>("/channel2", opts);
+  auto pub3 = node.Advertise<msgs::Int32>("/channel3");
+  EXPECT_TRUE(pub1);
+  EXPECT_TRUE(pub2);
+  EXPECT_TRUE(pub3);
+
+  std::vector<transport::MessagePublisher> publishers;
+  for (const auto &topic : {"/channel1", "/channel2", "/channel3"})
+  {
+    std::vector<transport::MessagePublisher> topicPublishers;
+    std::vector<transport::MessagePublisher> topicSubscribers;
+    ASSERT_TRUE(node.TopicInfo(topic, topicPublishers, topicSubscribers));
+    ASSERT_EQ(1u, topicPublishers.size());
+    publishers.push_back(topicPublishers.front());
+  }
+
+  EXPECT_EQ(publishers[0].Addr(), publishers[1].Addr());
+  EXPECT_NE(publishers[0].Addr(), publishers[2].Addr());
+}
+
+//////////////////////////////////////////////////
+/// \brief The topics of a node with an interface are published through a
+/// socket bound to this interface.
+TEST(channelPubSub, InterfaceAddress)
+{
+  transport::NodeOptions nodeOpts;
+  nodeOpts.SetInterface("127.0.0.1");
+  transport::Node node(nodeOpts);
+  auto pub = node.Advertise<msgs::Int32>("/interface");
+  EXPECT_TRUE(pub);
+
+  std::vector<transport::MessagePublisher> publishers;
+  std::vector<transport::MessagePublisher> subscribers;
+  ASSERT_TRUE(node.TopicInfo("/interface", publishers, subscribers));
+  ASSERT_EQ(1u, publishers.size());
+  EXPECT_EQ(0u, publishers.front().Addr().rfind("tcp://127.0.0.1:", 0));
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  // Get a random partition name.
+  partition = testing::getRandomNumber();
+
+  // Set the partition name for this process.
+  gz::utils::setenv("GZ_PARTITION", partition);
+  gz::utils::setenv("GZ_TRANSPORT_IPC", "1");
+
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
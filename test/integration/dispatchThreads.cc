@@ -0,0 +1,148 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include <gz/msgs/int32.pb.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "gz/transport/Node.hh"
+
+#include <gz/utils/Environment.hh>
+
+#include "test_utils.hh"
+
+using namespace gz;
+
+//////////////////////////////////////////////////
+/// \brief A slow callback should not delay the callbacks of the topics
+/// processed by other dispatch threads.
+TEST(dispatchThreads, SlowCallbackDoesNotBlockOtherTopics)
+{
+  transport::Node node;
+
+  std::mutex mutex;
+  std::condition_variable condition;
+  bool release = false;
+
+  std::function<void(const msgs::Int32 &)> slowCb =
+    [&](const msgs::Int32 &)
+  {
+    std::unique_lock<std::mutex> lk(mutex);
+    condition.wait_for(lk, std::chrono::seconds(5), [&]{return release;});
+  };
+
+  const std::string slowTopic = "/slow";
+  auto slowPub = node.Advertise<msgs::Int32>(slowTopic);
+  ASSERT_TRUE(slowPub);
+  EXPECT_TRUE(node.Subscribe(slowTopic, slowCb));
+
+  std::atomic<int> received{0};
+  std::function<void(const msgs::Int32 &)> fastCb =
+    [&received](const msgs::Int32 &)
+  {
+    ++received;
+  };
+
+  // Use several topics, at least one of them will be processed by a
+  // different thread than the slow topic.
+  std::vector<transport::Node::Publisher> fastPubs;
+  for (int i = 0; i < 16; ++i)
+  {
+    const std::string topic = "/fast_" + std::to_string(i);
+    fastPubs.push_back(node.Advertise<msgs::Int32>(topic));
+    ASSERT_TRUE(fastPubs.back());
+    EXPECT_TRUE(node.Subscribe(topic, fastCb));
+  }
+
+  msgs::Int32 msg;
+  msg.set_data(1);
+
+  // Block one of the dispatch threads.
+  EXPECT_TRUE(slowPub.Publish(msg));
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  for (auto &pub : fastPubs)
+    EXPECT_TRUE(pub.Publish(msg));
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(500));
+  EXPECT_GT(received, 0);
+
+  {
+    std::lock_guard<std::mutex> lk(mutex);
+    release = true;
+  }
+  condition.notify_all();
+
+  // Once released, all the pending callbacks are executed.
+  std::this_thread::sleep_for(std::chrono::milliseconds(500));
+  EXPECT_EQ(16, received);
+}
+
+//////////////////////////////////////////////////
+/// \brief The callbacks of a topic are executed in order.
+TEST(dispatchThreads, TopicOrder)
+{
+  transport::Node node;
+  const std::string topic = "/order";
+  auto pub = node.Advertise<msgs::Int32>(topic);
+  ASSERT_TRUE(pub);
+
+  std::mutex mutex;
+  std::vector<int> received;
+  std::function<void(const msgs::Int32 &)> cb =
+    [&](const msgs::Int32 &_msg)
+  {
+    std::lock_guard<std::mutex> lk(mutex);
+    received.push_back(_msg.data());
+  };
+  EXPECT_TRUE(node.Subscribe(topic, cb));
+
+  const int kNumMsgs = 200;
+  msgs::Int32 msg;
+  for (int i = 0; i < kNumMsgs; ++i)
+  {
+    msg.set_data(i);
+    EXPECT_TRUE(pub.Publish(msg));
+  }
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+  std::lock_guard<std::mutex> lk(mutex);
+  ASSERT_EQ(static_cast<std::size_t>(kNumMsgs), received.size());
+  for (int i = 0; i < kNumMsgs; ++i)
+    EXPECT_EQ(i, received[i]);
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  // Get a random partition name.
+  std::string partition = testing::getRandomNumber();
+
+  // Set the partition name for this process.
+  gz::utils::setenv("GZ_PARTITION", partition);
+  gz::utils::setenv("GZ_TRANSPORT_DISPATCH_THREADS", "4");
+
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include <gz/msgs/stringmsg.pb.h>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include "gz/transport/Node.hh"
+
+#include <gz/utils/Environment.hh>
+#include <gz/utils/Subprocess.hh>
+
+#include "gtest/gtest.h"
+#include "test_config.hh"
+#include "test_utils.hh"
+
+using namespace gz;
+
+static std::string partition;  // NOLINT(*)
+
+//////////////////////////////////////////////////
+/// \brief Receive small messages and big messages sent in fragments from
+/// another process. The fragments are delivered as they arrive.
+TEST(fragmentPubSub, PubSubTwoProcs)
+{
+  std::atomic<int> smallCounter{0};
+  std::atomic<int> largeCounter{0};
+  std::atomic<int> fragmentCounter{0};
+  std::size_t nextOffset = 0;
+
+  std::function<void(const msgs::StringMsg &)> smallCb =
+    [&smallCounter](const msgs::StringMsg &_msg)
+  {
+    EXPECT_EQ("small", _msg.data());
+    ++smallCounter;
+  };
+
+  std::function<void(const msgs::StringMsg &)> largeCb =
+    [&largeCounter](const msgs::StringMsg &_msg)
+  {
+    EXPECT_EQ(std::string(1024 * 1024, 'x'), _msg.data());
+    ++largeCounter;
+  };
+
+  // The fragments of a message are received in order, the first one might
+  // be missed before the connection is established.
+  auto fragmentCb = [&](const char *, const size_t _size,
+    const size_t _offset, const size_t _total,
+    const transport::MessageInfo &_info)
+  {
+    EXPECT_EQ("/fragment_large", _info.Topic());
+    EXPECT_LE(_size, 65536u);
+    EXPECT_GT(_total, 1024u * 1024u);
+    if (_offset != 0 && nextOffset != 0)
+      EXPECT_EQ(nextOffset, _offset);
+    nextOffset = _offset + _size == _total ? 0 : _offset + _size;
+    ++fragmentCounter;
+  };
+
+  transport::SubscribeOptions opts;
+  opts.SetFragmentCallback(fragmentCb);
+
+  transport::Node node;
+  EXPECT_TRUE(node.Subscribe("/fragment_small", smallCb));
+  EXPECT_TRUE(node.Subscribe("/fragment_large", largeCb, opts));
+
+  auto pi = gz::utils::Subprocess(
+    {test_executables::kFragmentPublisher, partition});
+
+  // The publisher runs for three seconds.
+  std::this_thread::sleep_for(std::chrono::milliseconds(3500));
+
+  // Some messages are published before the connection is established.
+  EXPECT_GT(smallCounter, 10);
+  EXPECT_GT(largeCounter, 10);
+  EXPECT_GE(fragmentCounter, largeCounter * 16);
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  // Get a random partition name.
+  partition = testing::getRandomNumber();
+
+  // Set the partition name for this process.
+  gz::utils::setenv("GZ_PARTITION", partition);
+
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include <gz/msgs/int32.pb.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "gz/transport/Node.hh"
+
+#include <gz/utils/Environment.hh>
+
+#include "test_utils.hh"
+
+using namespace gz;
+
+//////////////////////////////////////////////////
+/// \brief With GZ_TRANSPORT_DISPATCH_THREADS=0 the local callbacks run in
+/// the publishing thread, before Publish() returns.
+TEST(inlineDispatch, CallbacksRunInPublishingThread)
+{
+  transport::Node node;
+  const std::string topic = "/foo";
+  auto pub = node.Advertise<msgs::Int32>(topic);
+  ASSERT_TRUE(pub);
+
+  std::vector<int> received;
+  std::thread::id callbackThread;
+  std::function<void(const msgs::Int32 &)> cb =
+    [&](const msgs::Int32 &_msg)
+  {
+    received.push_back(_msg.data());
+    callbackThread = std::this_thread::get_id();
+  };
+  EXPECT_TRUE(node.Subscribe(topic, cb));
+
+  const int kNumMsgs = 10;
+  msgs::Int32 msg;
+  for (int i = 0; i < kNumMsgs; ++i)
+  {
+    msg.set_data(i);
+    EXPECT_TRUE(pub.Publish(msg));
+    ASSERT_EQ(static_cast<std::size_t>(i + 1), received.size());
+  }
+
+  EXPECT_EQ(std::this_thread::get_id(), callbackThread);
+  for (int i = 0; i < kNumMsgs; ++i)
+    EXPECT_EQ(i, received[i]);
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  // Get a random partition name.
+  std::string partition = testing::getRandomNumber();
+
+  // Set the partition name for this process.
+  gz::utils::setenv("GZ_PARTITION", partition);
+  gz::utils::setenv("GZ_TRANSPORT_DISPATCH_THREADS", "0");
+
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,134 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include <gz/msgs/int32.pb.h>
+#include <gz/msgs/vector3d.pb.h>
+
+#ifndef _WIN32
+  #include <sys/stat.h>
+#endif
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include "gz/transport/Node.hh"
+#include "gz/transport/NodeShared.hh"
+
+#include <gz/utils/Environment.hh>
+#include <gz/utils/Subprocess.hh>
+
+#include "gtest/gtest.h"
+#include "test_config.hh"
+#include "test_utils.hh"
+
+using namespace gz;
+
+static std::string partition;  // NOLINT(*)
+
+//////////////////////////////////////////////////
+/// \brief Check whether an IPC socket of this process exists.
+/// \param[in] _name Name of the socket.
+/// \return True if the socket exists.
+bool ipcSocketExists(const std::string &_name)
+{
+#ifndef _WIN32
+  const std::string path = "/tmp/gz-transport-" +
+    transport::NodeShared::Instance()->pUuid + "-" + _name;
+  struct stat st;
+  return stat(path.c_str(), &st) == 0 && S_ISSOCK(st.st_mode);
+#else
+  (void)_name;
+  return false;
+#endif
+}
+
+//////////////////////////////////////////////////
+/// \brief Receive messages from a process in the same host with IPC
+/// enabled in both processes.
+TEST(ipcPubSub, PubSubTwoProcs)
+{
+#ifdef _WIN32
+  GTEST_SKIP() << "IPC endpoints are not supported on Windows";
+#endif
+
+  std::atomic<int> counter{0};
+  std::function<void(const msgs::Vector3d &)> cb =
+    [&counter](const msgs::Vector3d &_msg)
+  {
+    EXPECT_DOUBLE_EQ(1.0, _msg.x());
+    ++counter;
+  };
+
+  transport::Node node;
+  EXPECT_TRUE(ipcSocketExists("pub"));
+  EXPECT_TRUE(ipcSocketExists("rep"));
+  EXPECT_TRUE(ipcSocketExists("res"));
+
+  EXPECT_TRUE(node.Subscribe("/foo", cb));
+
+  auto pi = gz::utils::Subprocess(
+    {test_executables::kTwoProcsPublisher, partition});
+
+  // The publisher sends two messages in three seconds. The first one might
+  // be published before the connection is established.
+  for (int i = 0; i < 400 && counter < 2; ++i)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+  EXPECT_GE(counter, 1);
+  pi.Join();
+}
+
+//////////////////////////////////////////////////
+/// \brief Call a service provided by a process in the same host with IPC
+/// enabled in both processes.
+TEST(ipcPubSub, SrvTwoProcs)
+{
+#ifdef _WIN32
+  GTEST_SKIP() << "IPC endpoints are not supported on Windows";
+#endif
+
+  auto pi = gz::utils::Subprocess(
+    {test_executables::kTwoProcsSrvCallReplier, partition});
+
+  msgs::Int32 req;
+  req.set_data(5);
+  msgs::Int32 rep;
+  bool result = false;
+
+  transport::Node node;
+  EXPECT_TRUE(node.Request("/foo", req, 5000, rep, result));
+  EXPECT_TRUE(result);
+  EXPECT_EQ(5, rep.data());
+
+  pi.Terminate();
+  pi.Join();
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  // Get a random partition name.
+  partition = testing::getRandomNumber();
+
+  // Set the partition name for this process.
+  gz::utils::setenv("GZ_PARTITION", partition);
+  gz::utils::setenv("GZ_TRANSPORT_IPC", "1");
+
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include <gz/msgs/int32.pb.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gz/transport/Node.hh"
+
+#include <gz/utils/Environment.hh>
+#include <gz/utils/Subprocess.hh>
+
+#include "gtest/gtest.h"
+#include "test_config.hh"
+#include "test_utils.hh"
+
+using namespace gz;
+
+static std::string partition;  // NOLINT(*)
+
+//////////////////////////////////////////////////
+/// \brief A subscriber in another process receives the last message of a
+/// topic with a history depth, although it was published before the
+/// subscriber was connected.
+TEST(latchedPubSub, LateJoinerTwoProcs)
+{
+  std::atomic<int> counter{0};
+  std::function<void(const msgs::Int32 &)> cb =
+    [&counter](const msgs::Int32 &_msg)
+  {
+    EXPECT_EQ(42, _msg.data());
+    ++counter;
+  };
+
+  transport::Node node;
+  EXPECT_TRUE(node.Subscribe("/latched", cb));
+
+  auto pi = gz::utils::Subprocess(
+    {test_executables::kLatchedPublisher, partition});
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+  EXPECT_GE(counter, 1);
+  pi.Join();
+}
+
+//////////////////////////////////////////////////
+/// \brief A subscriber in this process receives the last messages of a
+/// topic with a history depth when it subscribes, the other subscribers
+/// don't receive them again.
+TEST(latchedPubSub, LateJoinerIntraProcess)
+{
+  transport::Node pubNode;
+  transport::AdvertiseMessageOptions opts;
+  opts.SetHistoryDepth(2);
+  auto pub = pubNode.Advertise<msgs::Int32>("/latched_local", opts);
+  EXPECT_TRUE(pub);
+
+  std::mutex mutex;
+  std::vector<int> firstReceived;
+  std::function<void(const msgs::Int32 &)> firstCb =
+    [&](const msgs::Int32 &_msg)
+  {
+    std::lock_guard<std::mutex> lk(mutex);
+    firstReceived.push_back(_msg.data());
+  };
+
+  transport::Node firstNode;
+  EXPECT_TRUE(firstNode.Subscribe("/latched_local", firstCb));
+
+  msgs::Int32 msg;
+  for (int i = 0; i < 3; ++i)
+  {
+    msg.set_data(i);
+    EXPECT_TRUE(pub.Publish(msg));
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  std::vector<int> received;
+  std::function<void(const msgs::Int32 &)> cb =
+    [&](const msgs::Int32 &_msg)
+  {
+    std::lock_guard<std::mutex> lk(mutex);
+    received.push_back(_msg.data());
+  };
+
+  transport::Node node;
+  EXPECT_TRUE(node.Subscribe("/latched_local", cb));
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  std::lock_guard<std::mutex> lk(mutex);
+  EXPECT_EQ(std::vector<int>({1, 2}), received);
+  EXPECT_EQ(std::vector<int>({0, 1, 2}), firstReceived);
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  // Get a random partition name.
+  partition = testing::getRandomNumber();
+
+  // Set the partition name for this process.
+  gz::utils::setenv("GZ_PARTITION", partition);
+
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
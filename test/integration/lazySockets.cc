@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gz/msgs/int32.pb.h>
+#include <gz/msgs/vector3d.pb.h>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include "gz/transport/Node.hh"
+#include "gz/transport/NodeShared.hh"
+
+#include <gz/utils/Environment.hh>
+#include <gz/utils/Subprocess.hh>
+
+#include "gtest/gtest.h"
+#include "test_config.hh"
+#include "test_utils.hh"
+
+using namespace gz;
+
+static std::string partition;  // NOLINT(*)
+
+//////////////////////////////////////////////////
+/// \brief With GZ_TRANSPORT_LAZY_SOCKETS=1 the sockets of the topics are
+/// only bound by the first subscription and the ones of the services by the
+/// first request. The processes started inherit the variable.
+TEST(lazySockets, SocketsCreatedOnFirstUse)
+{
+  transport::Node node;
+  transport::NodeShared *shared = transport::NodeShared::Instance();
+  EXPECT_TRUE(shared->myAddress.empty());
+  EXPECT_TRUE(shared->myRequesterAddress.empty());
+  EXPECT_TRUE(shared->myReplierAddress.empty());
+  EXPECT_EQ(-1, shared->RcvHwm());
+
+  // Subscribe to the topic of the publisher.
+  std::atomic<int> received{0};
+  std::function<void(const msgs::Vector3d &)> cb =
+    [&received](const msgs::Vector3d &)
+  {
+    ++received;
+  };
+  EXPECT_TRUE(node.Subscribe("/foo", cb));
+  EXPECT_FALSE(shared->myAddress.empty());
+  EXPECT_TRUE(shared->myRequesterAddress.empty());
+  EXPECT_EQ(transport::kDefaultRcvHwm, shared->RcvHwm());
+
+  auto publisher = gz::utils::Subprocess(
+    {test_executables::kTwoProcsPublisher, partition});
+  for (int i = 0; i < 300 && received == 0; ++i)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_GT(received, 0);
+  publisher.Join();
+
+  // Call the service of the replier.
+  auto replier = gz::utils::Subprocess(
+    {test_executables::kTwoProcsSrvCallReplier, partition});
+
+  msgs::Int32 req;
+  req.set_data(5);
+  msgs::Int32 rep;
+  bool result = false;
+  EXPECT_TRUE(node.Request("/foo", req, 5000, rep, result));
+  EXPECT_TRUE(result);
+  EXPECT_EQ(5, rep.data());
+  EXPECT_FALSE(shared->myRequesterAddress.empty());
+  EXPECT_FALSE(shared->myReplierAddress.empty());
+
+  replier.Terminate();
+  replier.Join();
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  // Get a random partition name.
+  partition = testing::getRandomNumber();
+
+  // Set the partition name for this process.
+  gz::utils::setenv("GZ_PARTITION", partition);
+  gz::utils::setenv("GZ_TRANSPORT_LAZY_SOCKETS", "1");
+
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gz/msgs/int32.pb.h>
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gz/transport/Node.hh"
+
+#include <gz/utils/Environment.hh>
+#include <gz/utils/Subprocess.hh>
+
+#include "gtest/gtest.h"
+#include "test_config.hh"
+#include "test_utils.hh"
+
+using namespace gz;
+
+static std::string partition;  // NOLINT(*)
+
+//////////////////////////////////////////////////
+/// \brief Receive several topics from another process with several
+/// reception threads. Every topic is received once and in order, even if
+/// its name starts with the name of a topic received by another thread.
+TEST(receptionThreads, TopicsKeepTheirOrder)
+{
+  const std::vector<std::string> topics =
+    {"/shard", "/shard_a", "/shard_ab", "/shard_abc", "/shard_b", "/shard_c"};
+
+  std::mutex mutex;
+  std::map<std::string, std::vector<int>> received;
+
+  transport::Node node;
+  for (const std::string &topic : topics)
+  {
+    std::function<void(const msgs::Int32 &)> cb =
+      [&mutex, &received, topic](const msgs::Int32 &_msg)
+    {
+      std::lock_guard<std::mutex> lk(mutex);
+      received[topic].push_back(_msg.data());
+    };
+    EXPECT_TRUE(node.Subscribe(topic, cb));
+  }
+
+  auto pi = gz::utils::Subprocess(
+    {test_executables::kShardedPublisher, partition});
+
+  // The publisher runs for three seconds.
+  std::this_thread::sleep_for(std::chrono::milliseconds(4000));
+  pi.Join();
+
+  std::lock_guard<std::mutex> lk(mutex);
+  for (const std::string &topic : topics)
+  {
+    // The first messages might be published before the connection.
+    const std::vector<int> &msgs = received[topic];
+    ASSERT_FALSE(msgs.empty()) << topic;
+    EXPECT_EQ(199, msgs.back()) << topic;
+    for (std::size_t i = 1; i < msgs.size(); ++i)
+      EXPECT_EQ(msgs[i - 1] + 1, msgs[i]) << topic;
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief The subscriber disconnects from the publisher when it
+/// unsubscribes from its last topic, and connects again when it subscribes.
+TEST(receptionThreads, SubscribeAfterDisconnection)
+{
+  std::mutex mutex;
+  std::vector<int> received;
+  std::function<void(const msgs::Int32 &)> cb =
+    [&mutex, &received](const msgs::Int32 &_msg)
+  {
+    std::lock_guard<std::mutex> lk(mutex);
+    received.push_back(_msg.data());
+  };
+
+  transport::Node node;
+  EXPECT_TRUE(node.Subscribe("/shard_b", cb));
+
+  auto pi = gz::utils::Subprocess(
+    {test_executables::kShardedPublisher, partition});
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(1500));
+  EXPECT_TRUE(node.Unsubscribe("/shard_b"));
+  std::this_thread::sleep_for(std::chrono::milliseconds(300));
+
+  std::size_t count;
+  {
+    std::lock_guard<std::mutex> lk(mutex);
+    count = received.size();
+    EXPECT_GT(count, 0u);
+  }
+
+  EXPECT_TRUE(node.Subscribe("/shard_b", cb));
+  std::this_thread::sleep_for(std::chrono::milliseconds(2200));
+  pi.Join();
+
+  std::lock_guard<std::mutex> lk(mutex);
+  EXPECT_GT(received.size(), count);
+  EXPECT_EQ(199, received.back());
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  // Get a random partition name.
+  partition = testing::getRandomNumber();
+
+  // Set the partition name for this process.
+  gz::utils::setenv("GZ_PARTITION", partition);
+  gz::utils::setenv("GZ_TRANSPORT_RECEPTION_THREADS", "3");
+
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
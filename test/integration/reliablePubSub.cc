@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include <gz/msgs/int32.pb.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gz/transport/Node.hh"
+
+#include <gz/utils/Environment.hh>
+#include <gz/utils/Subprocess.hh>
+
+#include "gtest/gtest.h"
+#include "test_config.hh"
+#include "test_utils.hh"
+
+using namespace gz;
+
+static std::string partition;  // NOLINT(*)
+
+//////////////////////////////////////////////////
+/// \brief Receive a reliable topic from another process. The publisher
+/// sends its sequence numbers as data, every message received must match
+/// its sequence number and the gaps must account for the missing ones.
+TEST(reliablePubSub, PubSubTwoProcs)
+{
+  std::mutex mutex;
+  std::vector<uint64_t> received;
+  uint64_t last = 0;
+  bool first = true;
+  std::function<void(const msgs::Int32 &, const transport::MessageInfo &)>
+    cb = [&](const msgs::Int32 &_msg, const transport::MessageInfo &_info)
+  {
+    std::lock_guard<std::mutex> lk(mutex);
+    EXPECT_EQ(static_cast<uint64_t>(_msg.data()), _info.Sequence());
+    received.push_back(_info.Sequence());
+    if (_info.Retransmitted())
+      return;
+
+    if (!first)
+      EXPECT_EQ(last + _info.SequenceGap() + 1, _info.Sequence());
+    first = false;
+    last = _info.Sequence();
+  };
+
+  transport::Node node;
+  EXPECT_TRUE(node.Subscribe("/reliable", cb));
+
+  auto pi = gz::utils::Subprocess(
+    {test_executables::kReliablePublisher, partition});
+
+  // The publisher runs for three seconds.
+  std::this_thread::sleep_for(std::chrono::milliseconds(4000));
+  pi.Join();
+
+  // The messages missed after the first one are retransmitted.
+  std::lock_guard<std::mutex> lk(mutex);
+  ASSERT_FALSE(received.empty());
+  std::sort(received.begin(), received.end());
+  EXPECT_EQ(received.back() - received.front() + 1, received.size());
+  EXPECT_EQ(299u, received.back());
+}
+
+//////////////////////////////////////////////////
+/// \brief A topic with a history advertises the service answering the
+/// requests of the subscribers for the messages they have missed.
+TEST(reliablePubSub, HistoryService)
+{
+  transport::Node node;
+  transport::AdvertiseMessageOptions opts;
+  opts.SetHistorySize(10);
+  auto pub = node.Advertise<msgs::Int32>("/history", opts);
+  EXPECT_TRUE(pub);
+
+  std::vector<std::string> services;
+  node.ServiceList(services);
+  EXPECT_NE(std::find_if(services.begin(), services.end(),
+    [](const std::string &_service)
+    {
+      return _service.rfind("/history/_history/", 0) == 0;
+    }), services.end());
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  // Get a random partition name.
+  partition = testing::getRandomNumber();
+
+  // Set the partition name for this process.
+  gz::utils::setenv("GZ_PARTITION", partition);
+
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include <gz/msgs/stringmsg.pb.h>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include "gz/transport/Node.hh"
+
+#include <gz/utils/Environment.hh>
+#include <gz/utils/Subprocess.hh>
+
+#include "gtest/gtest.h"
+#include "test_config.hh"
+#include "test_utils.hh"
+
+using namespace gz;
+
+static std::string partition;  // NOLINT(*)
+
+//////////////////////////////////////////////////
+/// \brief Receive small and big messages from a process in the same host
+/// with shared memory enabled in both processes.
+TEST(shmPubSub, PubSubTwoProcs)
+{
+#ifndef __linux__
+  GTEST_SKIP() << "Shared memory is only supported on Linux";
+#endif
+
+  std::atomic<int> smallCounter{0};
+  std::atomic<int> largeCounter{0};
+  std::atomic<int> rawCounter{0};
+
+  std::function<void(const msgs::StringMsg &)> smallCb =
+    [&smallCounter](const msgs::StringMsg &_msg)
+  {
+    EXPECT_EQ("small", _msg.data());
+    ++smallCounter;
+  };
+
+  std::function<void(const msgs::StringMsg &)> largeCb =
+    [&largeCounter](const msgs::StringMsg &_msg)
+  {
+    EXPECT_EQ(std::string(1024 * 1024, 'x'), _msg.data());
+    ++largeCounter;
+  };
+
+  auto rawCb = [&rawCounter](const char *_msgData, const size_t _size,
+    const transport::MessageInfo &_info)
+  {
+    msgs::StringMsg msg;
+    EXPECT_EQ(msg.GetTypeName(), _info.Type());
+    EXPECT_FALSE(_info.IntraProcess());
+    EXPECT_TRUE(msg.ParseFromArray(_msgData, static_cast<int>(_size)));
+    EXPECT_EQ(1024u * 1024u, msg.data().size());
+    ++rawCounter;
+  };
+
+  transport::Node node;
+  EXPECT_TRUE(node.Subscribe("/shm_small", smallCb));
+  EXPECT_TRUE(node.Subscribe("/shm_large", largeCb));
+  EXPECT_TRUE(node.SubscribeRaw("/shm_large", rawCb,
+    msgs::StringMsg().GetTypeName()));
+
+  auto pi = gz::utils::Subprocess(
+    {test_executables::kShmPublisher, partition});
+
+  // The publisher runs for three seconds.
+  std::this_thread::sleep_for(std::chrono::milliseconds(3500));
+
+  // Some messages are published before the connection is established.
+  EXPECT_GT(smallCounter, 10);
+  EXPECT_GT(largeCounter, 10);
+  EXPECT_EQ(largeCounter, rawCounter);
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  // Get a random partition name.
+  partition = testing::getRandomNumber();
+
+  // Set the partition name for this process.
+  gz::utils::setenv("GZ_PARTITION", partition);
+  gz::utils::setenv("GZ_TRANSPORT_SHM", "1");
+
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
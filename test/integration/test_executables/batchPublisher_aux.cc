@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include <gz/msgs/int32.pb.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include "gtest/gtest.h"
+#include "gz/transport/Node.hh"
+
+#include <gz/utils/Environment.hh>
+
+#include "test_config.hh"
+
+using namespace gz;
+
+//////////////////////////////////////////////////
+/// \brief Publish bursts of small messages with batching enabled.
+void advertiseAndPublish()
+{
+  transport::Node node;
+
+  transport::AdvertiseMessageOptions opts;
+  opts.SetBatchDelay(1000);
+  opts.SetBatchSize(1024);
+
+  auto pub = node.Advertise<msgs::Int32>("/batch", opts);
+  std::this_thread::sleep_for(std::chrono::milliseconds(300));
+
+  msgs::Int32 msg;
+  for (auto i = 0; i < 30; ++i)
+  {
+    for (auto j = 0; j < 100; ++j)
+    {
+      msg.set_data(i * 100 + j);
+      EXPECT_TRUE(pub.Publish(msg));
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief Publish a few messages batched for much longer than the process
+/// lives, then destroy the node and exit right away.
+void publishAndExit()
+{
+  transport::Node node;
+
+  transport::AdvertiseMessageOptions opts;
+  opts.SetBatchDelay(10000000);
+  opts.SetBatchSize(1024 * 1024);
+
+  auto pub = node.Advertise<msgs::Int32>("/batch_exit", opts);
+  std::this_thread::sleep_for(std::chrono::milliseconds(300));
+
+  msgs::Int32 msg;
+  for (auto i = 0; i < 10; ++i)
+  {
+    msg.set_data(i);
+    EXPECT_TRUE(pub.Publish(msg));
+  }
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  if (argc < 2)
+  {
+    std::cerr << "Partition name has not be passed as argument" << std::endl;
+    return -1;
+  }
+
+  // Set the partition name for this test.
+  gz::utils::setenv("GZ_PARTITION", argv[1]);
+
+  if (argc > 2 && std::string(argv[2]) == "exit")
+    publishAndExit();
+  else
+    advertiseAndPublish();
+}
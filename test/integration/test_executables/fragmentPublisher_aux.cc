@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include <gz/msgs/stringmsg.pb.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include "gtest/gtest.h"
+#include "gz/transport/Node.hh"
+
+#include <gz/utils/Environment.hh>
+
+#include "test_config.hh"
+
+using namespace gz;
+
+//////////////////////////////////////////////////
+/// \brief Publish a small message, sent whole, and a big message, sent in
+/// fragments.
+void advertiseAndPublish()
+{
+  transport::Node node;
+
+  auto smallPub = node.Advertise<msgs::StringMsg>("/fragment_small");
+  auto largePub = node.Advertise<msgs::StringMsg>("/fragment_large");
+  std::this_thread::sleep_for(std::chrono::milliseconds(300));
+
+  msgs::StringMsg smallMsg;
+  smallMsg.set_data("small");
+
+  msgs::StringMsg largeMsg;
+  largeMsg.set_data(std::string(1024 * 1024, 'x'));
+
+  for (auto i = 0; i < 30; ++i)
+  {
+    EXPECT_TRUE(largePub.Publish(largeMsg));
+    EXPECT_TRUE(smallPub.Publish(smallMsg));
+
+    // Rate: 10 msgs/sec.
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  if (argc < 2)
+  {
+    std::cerr << "Partition name has not be passed as argument" << std::endl;
+    return -1;
+  }
+
+  // Set the partition name for this test.
+  gz::utils::setenv("GZ_PARTITION", argv[1]);
+  gz::utils::setenv("GZ_TRANSPORT_FRAGMENT_SIZE", "65536");
+
+  advertiseAndPublish();
+}
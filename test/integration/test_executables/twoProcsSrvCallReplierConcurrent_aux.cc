@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gz/msgs/int32.pb.h>
+
+#include <chrono>
+#include <climits>
+#include <string>
+#include <thread>
+
+#include "gz/transport/AdvertiseOptions.hh"
+#include "gz/transport/Node.hh"
+
+#include <gz/utils/Environment.hh>
+
+#include "gtest/gtest.h"
+#include "test_config.hh"
+
+using namespace gz;
+
+static std::string g_topic = "/foo"; // NOLINT(*)
+static int Forever = INT_MAX;
+
+//////////////////////////////////////////////////
+/// \brief Provide a slow service.
+bool srvSlowEcho(const msgs::Int32 &_req, msgs::Int32 &_rep)
+{
+  std::this_thread::sleep_for(std::chrono::milliseconds(500));
+  _rep.set_data(_req.data());
+  return true;
+}
+
+//////////////////////////////////////////////////
+void runReplier()
+{
+  transport::AdvertiseServiceOptions opts;
+  opts.SetConcurrency(4);
+
+  transport::Node node;
+  EXPECT_TRUE(node.Advertise(g_topic, srvSlowEcho, opts));
+
+  // Run the node forever. Should be killed by the test that uses this.
+  std::this_thread::sleep_for(std::chrono::milliseconds(Forever));
+}
+
+//////////////////////////////////////////////////
+TEST(twoProcSrvCallReplierAux, SrvProcReplier)
+{
+  runReplier();
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  if (argc != 2)
+  {
+    std::cerr << "Partition name has not be passed as argument" << std::endl;
+    return -1;
+  }
+
+  // Set the partition name for this test.
+  gz::utils::setenv("GZ_PARTITION", argv[1]);
+
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -142,6 +142,53 @@ TEST_F(twoProcSrvCall, SrvTwoProcs)
   reset();
 }
 
+//////////////////////////////////////////////////
+/// \brief Send a batch of requests to the service responser in another
+/// process, in a single message.
+TEST_F(twoProcSrvCall, SrvRequestBatch)
+{
+  std::vector<msgs::Int32> reqs(100);
+  for (std::size_t i = 0; i < reqs.size(); ++i)
+    reqs[i].set_data(static_cast<int>(i));
+
+  transport::Node node;
+  std::vector<msgs::Int32> reps;
+  std::vector<bool> results;
+  ASSERT_TRUE(node.RequestBatch(g_topic, reqs, 5000, reps, results));
+  ASSERT_EQ(reqs.size(), reps.size());
+  ASSERT_EQ(reqs.size(), results.size());
+  for (std::size_t i = 0; i < reqs.size(); ++i)
+  {
+    EXPECT_TRUE(results[i]);
+    EXPECT_EQ(reqs[i].data(), reps[i].data());
+  }
+
+  // An empty batch.
+  ASSERT_TRUE(node.RequestBatch(g_topic, std::vector<msgs::Int32>(), 5000,
+    reps, results));
+  EXPECT_TRUE(reps.empty());
+}
+
+//////////////////////////////////////////////////
+/// \brief Connect to the service responser in another process before the
+/// first request.
+TEST_F(twoProcSrvCall, PrepareService)
+{
+  transport::Node node;
+  EXPECT_FALSE(node.PrepareService("invalid service"));
+  ASSERT_TRUE(node.PrepareService(g_topic, 5000));
+
+  // The responser is already connected: the request doesn't wait for the
+  // discovery nor the connection.
+  msgs::Int32 req;
+  req.set_data(data);
+  msgs::Int32 rep;
+  bool result = false;
+  ASSERT_TRUE(node.Request(g_topic, req, 1000, rep, result));
+  EXPECT_TRUE(result);
+  EXPECT_EQ(data, rep.data());
+}
+
 //////////////////////////////////////////////////
 /// \brief This test spawns a service responser and a service requester. The
 /// requester uses a wrong type for the request argument. The test should verify
@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gz/msgs/int32.pb.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gz/transport/Node.hh"
+
+#include <gz/utils/Environment.hh>
+#include <gz/utils/Subprocess.hh>
+
+#include "gtest/gtest.h"
+
+#include "test_config.hh"
+#include "test_utils.hh"
+
+using namespace gz;
+
+static std::string partition; // NOLINT(*)
+static std::string g_topic = "/foo"; // NOLINT(*)
+
+//////////////////////////////////////////////////
+/// \brief Four requests to a service with a concurrency level of four,
+/// taking 500 ms each, are processed at the same time.
+TEST(twoProcSrvCallConcurrent, ConcurrentRequests)
+{
+  auto pi = gz::utils::Subprocess(
+    {test_executables::kTwoProcsSrvCallReplierConcurrent, partition});
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(3000));
+
+  const int kNumRequests = 4;
+  std::vector<int> responses(kNumRequests, -1);
+  std::vector<std::thread> requesters;
+
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < kNumRequests; ++i)
+  {
+    requesters.emplace_back([i, &responses]()
+    {
+      transport::Node node;
+      msgs::Int32 req;
+      msgs::Int32 rep;
+      bool result = false;
+      req.set_data(i);
+      if (node.Request(g_topic, req, 5000, rep, result) && result)
+        responses[i] = rep.data();
+    });
+  }
+
+  for (auto &requester : requesters)
+    requester.join();
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+
+  for (int i = 0; i < kNumRequests; ++i)
+    EXPECT_EQ(i, responses[i]);
+
+  // Processed one after the other, the requests would take two seconds.
+  EXPECT_LT(elapsed, std::chrono::milliseconds(1800));
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  // Get a random partition name.
+  partition = testing::getRandomNumber();
+
+  // Set the partition name for this process.
+  gz::utils::setenv("GZ_PARTITION", partition);
+
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -14,6 +14,7 @@
  * limitations under the License.
  *
 */
+#include <gz/msgs/int32.pb.h>
 #include <gz/msgs/vector3d.pb.h>
 
 #include <chrono>
@@ -106,6 +107,24 @@ TEST_F(twoProcSrvCallWithoutOutput, SrvRequestWrongReq)
   reset();
 }
 
+//////////////////////////////////////////////////
+/// \brief Once the responser is connected, the oneway requests are sent
+/// straight away without storing any request handler.
+TEST_F(twoProcSrvCallWithoutOutput, SrvRequestOnewayConnected)
+{
+  msgs::Int32 req;
+  req.set_data(5);
+
+  transport::Node node;
+  ASSERT_TRUE(node.PrepareService(g_topic, 5000));
+
+  for (int i = 0; i < 100; ++i)
+    EXPECT_TRUE(node.Request(g_topic, req));
+
+  // The requests to an invalid service are still rejected.
+  EXPECT_FALSE(node.Request("invalid service", req));
+}
+
 //////////////////////////////////////////////////
 /// \brief This test spawns two nodes on different processes. One of the nodes
 /// advertises a service without output and the other uses ServiceList() for
@@ -0,0 +1,234 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gz/msgs/bytes.pb.h>
+#include <gz/msgs/stringmsg.pb.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "gz/transport/Node.hh"
+
+#include <gz/utils/Environment.hh>
+#include <gz/utils/Subprocess.hh>
+
+#include "test_config.hh"
+#include "test_utils.hh"
+
+using namespace gz;
+
+/// \brief Key pairs of the ZMQ CURVE documentation.
+static const char kServerSecret[] = "JTKVSB%%)wK0E.X)V>+}o?pNmC{O&4W4b!Ni{Lh6";
+static const char kClientSecret[] = "D:)Q[IlAW!ahhC2ac:9*A}h:p?([4%wOTJ%JR%cs";
+static const char kClientPublic[] = "Yne@$w-vo<fVvi]a<NY6T1ed:M$fCG*[IaLV{hID";
+
+/// \brief Maximum time to wait for the connections or the results (ms).
+static const int kTimeout = 30000;
+
+/// \brief Path of this executable, which runs the storms in a child
+/// process with the security settings of each scenario.
+static std::string g_self;  // NOLINT(*)
+
+//////////////////////////////////////////////////
+/// \brief Wait until a condition is true.
+/// \param[in] _cond The condition.
+/// \param[in] _each Called every 10 ms while waiting.
+/// \return True if the condition became true before kTimeout.
+static bool waitFor(const std::function<bool()> &_cond,
+  const std::function<void()> &_each)
+{
+  const auto deadline = std::chrono::steady_clock::now() +
+    std::chrono::milliseconds(kTimeout);
+  while (!_cond())
+  {
+    if (std::chrono::steady_clock::now() > deadline)
+      return false;
+    _each();
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+/// \brief A connection storm: start subscriber processes at once and
+/// measure the time until all of them receive the messages of a
+/// publisher. Every process is both a publisher and a subscriber (of the
+/// control topics), so each one makes two authenticated connections. It
+/// runs with the security settings of the environment and prints the time
+/// (ms), or -1 on timeout.
+/// \param[in] _processes Number of subscriber processes.
+/// \return 0 on success.
+static int storm(const int _processes)
+{
+  std::string partition;
+  gz::utils::env("GZ_PARTITION", partition);
+  const std::string type = msgs::Bytes().GetTypeName();
+
+  transport::Node node;
+  std::mutex mutex;
+  std::set<std::string> readyIds;
+  int results = 0;
+  std::function<void(const msgs::StringMsg &)> onReady =
+    [&](const msgs::StringMsg &_msg)
+  {
+    std::lock_guard<std::mutex> lk(mutex);
+    readyIds.insert(_msg.data());
+  };
+  std::function<void(const msgs::StringMsg &)> onResults =
+    [&](const msgs::StringMsg &)
+  {
+    std::lock_guard<std::mutex> lk(mutex);
+    ++results;
+  };
+  node.Subscribe("/fan_ready", onReady);
+  node.Subscribe("/fan_results", onResults);
+  auto done = node.Advertise<msgs::StringMsg>("/fan_done");
+  auto pub = node.Advertise<msgs::Bytes>("/fan_0");
+
+  const auto start = std::chrono::steady_clock::now();
+  std::vector<std::unique_ptr<gz::utils::Subprocess>> procs;
+  for (int i = 0; i < _processes; ++i)
+  {
+    procs.push_back(std::make_unique<gz::utils::Subprocess>(
+      std::vector<std::string>{test_executables::kBenchSubscriber,
+      partition, "1", "1"}));
+  }
+
+  // The subscribers ignore the unstamped messages.
+  const std::string warmUp(64, '\0');
+  const bool connected = waitFor([&]
+  {
+    std::lock_guard<std::mutex> lk(mutex);
+    return static_cast<int>(readyIds.size()) >= _processes;
+  }, [&]{pub.PublishRaw(warmUp, type);});
+  const double elapsed = std::chrono::duration<double, std::milli>(
+    std::chrono::steady_clock::now() - start).count();
+
+  msgs::StringMsg msg;
+  waitFor([&]
+  {
+    std::lock_guard<std::mutex> lk(mutex);
+    return results >= _processes;
+  }, [&]{done.Publish(msg);});
+  for (auto &proc : procs)
+    proc->Join();
+
+  std::cout << (connected ? elapsed : -1) << std::endl;
+  return 0;
+}
+
+//////////////////////////////////////////////////
+/// \brief Security settings of a scenario.
+struct Security
+{
+  /// \brief Name of the scenario.
+  std::string name;
+
+  /// \brief Environment variables set in the processes.
+  std::vector<std::pair<std::string, std::string>> env;
+};
+
+//////////////////////////////////////////////////
+/// \brief Time to connect storms of processes started at once, without
+/// security, with PLAIN and with CURVE. The publishers of a process
+/// authenticate all their subscribers with the ZAP handler of the process,
+/// which checks the credentials cached at startup.
+TEST(authConnections, ConnectionStorm)
+{
+  const std::string keysPath = (std::filesystem::temp_directory_path() /
+    ("gz_authorized_keys_" + testing::getRandomNumber())).string();
+  {
+    std::ofstream keys(keysPath);
+    keys << kClientPublic << std::endl;
+  }
+
+  const std::vector<Security> scenarios =
+  {
+    {"none", {}},
+    {"PLAIN", {{"GZ_TRANSPORT_USERNAME", "user"},
+               {"GZ_TRANSPORT_PASSWORD", "pass"}}},
+    {"CURVE", {{"GZ_TRANSPORT_CURVE_SERVER_KEY", kServerSecret}}},
+    {"CURVE+keys", {{"GZ_TRANSPORT_CURVE_SERVER_KEY", kServerSecret},
+                    {"GZ_TRANSPORT_CURVE_SECRET_KEY", kClientSecret},
+                    {"GZ_TRANSPORT_CURVE_AUTHORIZED_KEYS", keysPath}}},
+  };
+
+  std::cout << std::left << std::setw(14) << "security" << std::right
+            << std::setw(12) << "processes"
+            << std::setw(16) << "connect (ms)"
+            << std::setw(18) << "connections/s" << std::endl;
+  for (const auto &scenario : scenarios)
+  {
+    for (const int processes : {4, 16})
+    {
+      for (const auto &var : scenario.env)
+        ASSERT_TRUE(gz::utils::setenv(var.first, var.second));
+      auto proc = gz::utils::Subprocess(
+        {g_self, "--storm", std::to_string(processes)});
+      proc.Join();
+      for (const auto &var : scenario.env)
+        ASSERT_TRUE(gz::utils::unsetenv(var.first));
+
+      double elapsed = -1;
+      std::istringstream(proc.Stdout()) >> elapsed;
+      EXPECT_GT(elapsed, 0) << scenario.name << " " << processes;
+      if (elapsed <= 0)
+        continue;
+
+      const double rate = 2 * processes / (elapsed / 1000.0);
+      std::cout << std::left << std::setw(14) << scenario.name << std::right
+                << std::setw(12) << processes << std::fixed
+                << std::setprecision(1) << std::setw(16) << elapsed
+                << std::setw(18) << rate << std::endl;
+      ::testing::Test::RecordProperty("auth_" + scenario.name + "_" +
+        std::to_string(processes) + "_connections_per_sec",
+        std::to_string(rate));
+    }
+  }
+
+  std::filesystem::remove(keysPath);
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  if (argc == 3 && std::string(argv[1]) == "--storm")
+    return storm(std::stoi(argv[2]));
+
+  g_self = argv[0];
+
+  // Get a random partition name.
+  const std::string partition = testing::getRandomNumber();
+
+  // Set the partition name for this process and the storms.
+  gz::utils::setenv("GZ_PARTITION", partition);
+
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
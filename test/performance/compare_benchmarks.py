@@ -0,0 +1,98 @@
+# Copyright (C) 2026 Open Source Robotics Foundation
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+"""Compare the results of PERFORMANCE_transportBenchmarks to a baseline.
+
+Both files contain the JSON lines written to GZ_TRANSPORT_BENCH_OUTPUT. When
+a benchmark appears several times (--gtest_repeat), its best run is kept,
+which filters most of the noise of a shared machine. The script exits with
+1 when the throughput drops or the p99 latency grows by more than the
+threshold, relative to the baseline.
+"""
+
+import argparse
+import json
+import sys
+import urllib.request
+
+
+def load(path):
+    """Return the best result of every (benchmark, size) of a file or URL."""
+    if path.startswith(('http://', 'https://')):
+        with urllib.request.urlopen(path) as response:
+            lines = response.read().decode().splitlines()
+    else:
+        with open(path) as f:
+            lines = f.read().splitlines()
+
+    results = {}
+    for line in lines:
+        if not line.strip():
+            continue
+        r = json.loads(line)
+        key = (r['benchmark'], r['size'])
+        best = results.setdefault(key, r)
+        best['msgs_per_sec'] = max(best['msgs_per_sec'], r['msgs_per_sec'])
+        best['p99_us'] = min(best['p99_us'], r['p99_us'])
+    return results
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument('results', help='results of the benchmarks')
+    parser.add_argument('baseline', help='baseline, a file or a URL')
+    parser.add_argument('--threshold', type=float, default=0.2,
+                        help='relative regression tolerated (default 0.2)')
+    args = parser.parse_args()
+
+    results = load(args.results)
+    baseline = load(args.baseline)
+
+    regressions = 0
+    fmt = '{:<24}{:>10}{:>16}{:>16}{:>12}{:>12}  {}'
+    print(fmt.format('benchmark', 'size (B)', 'base msgs/s', 'msgs/s',
+                     'base p99', 'p99', ''))
+    for key in sorted(baseline):
+        base = baseline[key]
+        if key not in results:
+            print(fmt.format(key[0], key[1], '', '', '', '', 'MISSING'))
+            regressions += 1
+            continue
+        cur = results[key]
+        status = []
+        if (base['msgs_per_sec'] > 0 and cur['msgs_per_sec'] <
+                base['msgs_per_sec'] * (1 - args.threshold)):
+            status.append('THROUGHPUT')
+        if (base['p99_us'] > 0 and
+                cur['p99_us'] > base['p99_us'] * (1 + args.threshold)):
+            status.append('P99')
+        regressions += bool(status)
+        print(fmt.format(key[0], key[1],
+                         '{:.1f}'.format(base['msgs_per_sec']),
+                         '{:.1f}'.format(cur['msgs_per_sec']),
+                         '{:.1f}'.format(base['p99_us']),
+                         '{:.1f}'.format(cur['p99_us']),
+                         ' '.join(status)))
+
+    if regressions:
+        print('{} benchmark(s) regressed by more than {:.0%}'.format(
+            regressions, args.threshold))
+        return 1
+    print('No regression beyond {:.0%}'.format(args.threshold))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,314 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "gz/transport/AdvertiseOptions.hh"
+#include "gz/transport/Discovery.hh"
+#include "gz/transport/Publisher.hh"
+#include "gz/transport/TransportTypes.hh"
+#include "gz/transport/Uuid.hh"
+
+using namespace gz;
+using namespace transport;
+
+/// \brief Multicast group used by the simulated processes.
+static const char kGroup[] = "224.0.0.7";
+
+/// \brief Discovery port used by the simulated processes. It's not the
+/// default one, so the benchmark doesn't interfere with other processes.
+static const int kPort = 11419;
+
+/// \brief Scenarios: number of processes and number of topics advertised
+/// by each process.
+static const std::vector<std::pair<int, int>> kScenarios =
+  {{2, 10}, {8, 10}, {8, 100}, {32, 10}, {32, 100}};
+
+/// \brief Maximum time to wait for the convergence (ms).
+static const int kMaxConvergence = 30000;
+
+/// \brief Duration of the steady state measurement (ms).
+static const int kSteadyState = 3000;
+
+//////////////////////////////////////////////////
+/// \brief Count the discovery traffic sent to the multicast group.
+class TrafficCounter
+{
+  /// \brief Constructor. Joins the multicast group.
+  public: TrafficCounter()
+  {
+    this->sock = static_cast<int>(socket(PF_INET, SOCK_DGRAM, IPPROTO_UDP));
+    int reuse = 1;
+    setsockopt(this->sock, SOL_SOCKET, SO_REUSEADDR,
+      reinterpret_cast<const char *>(&reuse), sizeof(reuse));
+#ifdef SO_REUSEPORT
+    setsockopt(this->sock, SOL_SOCKET, SO_REUSEPORT,
+      reinterpret_cast<const char *>(&reuse), sizeof(reuse));
+#endif
+
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(static_cast<u_short>(kPort));
+    EXPECT_EQ(0, bind(this->sock, reinterpret_cast<sockaddr *>(&addr),
+      sizeof(addr)));
+
+    ip_mreq group;
+    group.imr_multiaddr.s_addr = inet_addr(kGroup);
+    group.imr_interface.s_addr = htonl(INADDR_ANY);
+    EXPECT_EQ(0, setsockopt(this->sock, IPPROTO_IP, IP_ADD_MEMBERSHIP,
+      reinterpret_cast<const char *>(&group), sizeof(group)));
+
+    this->thread = std::thread([this]()
+    {
+      std::vector<char> buffer(65535);
+      while (!this->exit)
+      {
+        std::vector<bool> ready;
+        pollSockets({this->sock}, 50, ready);
+        if (!ready[0])
+          continue;
+
+        auto received = recv(this->sock,
+          reinterpret_cast<raw_type *>(buffer.data()), buffer.size(), 0);
+        if (received > 0)
+        {
+          this->bytes += static_cast<uint64_t>(received);
+          ++this->datagrams;
+        }
+      }
+    });
+  }
+
+  /// \brief Destructor.
+  public: ~TrafficCounter()
+  {
+    this->exit = true;
+    this->thread.join();
+#ifdef _WIN32
+    closesocket(this->sock);
+#else
+    close(this->sock);
+#endif
+  }
+
+  /// \brief Start counting again.
+  public: void Reset()
+  {
+    this->bytes = 0;
+    this->datagrams = 0;
+  }
+
+  /// \brief Bytes received since the last reset.
+  public: std::atomic<uint64_t> bytes{0};
+
+  /// \brief Datagrams received since the last reset.
+  public: std::atomic<uint64_t> datagrams{0};
+
+  /// \brief Socket joined to the multicast group.
+  private: int sock;
+
+  /// \brief True when the thread should exit.
+  private: std::atomic<bool> exit{false};
+
+  /// \brief Thread receiving the datagrams.
+  private: std::thread thread;
+};
+
+//////////////////////////////////////////////////
+/// \brief A simulated process: a discovery instance with its own UUID.
+struct SimProcess
+{
+  /// \brief Constructor.
+  SimProcess()
+    : pUuid(Uuid().ToString()),
+      nUuid(Uuid().ToString()),
+      discovery(pUuid, kGroup, kPort)
+  {
+    this->discovery.ConnectionsCb([this](const MessagePublisher &_pub)
+    {
+      if (_pub.PUuid() != this->pUuid)
+        ++this->remotePublishers;
+    });
+  }
+
+  /// \brief Start the discovery and advertise the topics.
+  /// \param[in] _numTopics Number of topics to advertise.
+  void Start(const int _numTopics)
+  {
+    this->discovery.Start();
+    for (int i = 0; i < _numTopics; ++i)
+    {
+      MessagePublisher pub("/" + this->pUuid + "/topic_" + std::to_string(i),
+        "tcp://127.0.0.1:6000", "tcp://127.0.0.1:6001", this->pUuid,
+        this->nUuid, "gz.msgs.Int32", AdvertiseMessageOptions());
+      this->discovery.Advertise(pub);
+    }
+  }
+
+  /// \brief Process UUID.
+  std::string pUuid;
+
+  /// \brief Node UUID of all the publishers.
+  std::string nUuid;
+
+  /// \brief Discovery instance.
+  MsgDiscovery discovery;
+
+  /// \brief Number of remote publishers discovered.
+  std::atomic<int> remotePublishers{0};
+};
+
+/// \brief Results of a scenario.
+struct ScenarioResult
+{
+  /// \brief Time until all the processes know all the publishers (ms).
+  double convergence = 0;
+
+  /// \brief Discovery bytes sent until the convergence.
+  uint64_t convergenceBytes = 0;
+
+  /// \brief Discovery traffic in the steady state (bytes/s).
+  double steadyRate = 0;
+
+  /// \brief Average CPU used by each process in the steady state (%).
+  double steadyCpu = 0;
+
+  /// \brief Time until a new process knows all the publishers (ms).
+  double lateJoin = 0;
+};
+
+//////////////////////////////////////////////////
+/// \brief Wait until every process has discovered a number of publishers.
+/// \param[in] _procs Processes.
+/// \param[in] _expected Number of remote publishers expected by each one.
+/// \param[in] _start Time at which the processes started.
+/// \return Elapsed time since _start (ms), or -1 if the processes didn't
+/// converge.
+static double waitForConvergence(
+  const std::vector<std::unique_ptr<SimProcess>> &_procs, const int _expected,
+  const std::chrono::steady_clock::time_point &_start)
+{
+  const auto deadline = _start + std::chrono::milliseconds(kMaxConvergence);
+  while (std::chrono::steady_clock::now() < deadline)
+  {
+    bool converged = true;
+    for (const auto &proc : _procs)
+      converged = converged && proc->remotePublishers >= _expected;
+
+    if (converged)
+    {
+      return std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - _start).count();
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return -1;
+}
+
+//////////////////////////////////////////////////
+/// \brief Run a scenario.
+/// \param[in] _numProcs Number of processes.
+/// \param[in] _numTopics Number of topics advertised by each process.
+/// \param[in] _traffic Traffic counter.
+/// \return The results.
+static ScenarioResult runScenario(const int _numProcs, const int _numTopics,
+  TrafficCounter &_traffic)
+{
+  ScenarioResult result;
+  std::vector<std::unique_ptr<SimProcess>> procs;
+  for (int i = 0; i < _numProcs; ++i)
+    procs.emplace_back(new SimProcess());
+
+  // All the processes start at the same time.
+  _traffic.Reset();
+  auto start = std::chrono::steady_clock::now();
+  for (auto &proc : procs)
+    proc->Start(_numTopics);
+  result.convergence =
+    waitForConvergence(procs, (_numProcs - 1) * _numTopics, start);
+  result.convergenceBytes = _traffic.bytes;
+  EXPECT_GE(result.convergence, 0);
+
+  // Nothing changes: only the heartbeats should be sent.
+  _traffic.Reset();
+  const std::clock_t cpuStart = std::clock();
+  std::this_thread::sleep_for(std::chrono::milliseconds(kSteadyState));
+  const double cpu =
+    static_cast<double>(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+  const double seconds = kSteadyState / 1000.0;
+  result.steadyRate = _traffic.bytes / seconds;
+  result.steadyCpu = 100.0 * cpu / seconds / _numProcs;
+
+  // A new process joins.
+  std::vector<std::unique_ptr<SimProcess>> late;
+  late.emplace_back(new SimProcess());
+  start = std::chrono::steady_clock::now();
+  late.back()->Start(0);
+  result.lateJoin = waitForConvergence(late, _numProcs * _numTopics, start);
+  EXPECT_GE(result.lateJoin, 0);
+
+  return result;
+}
+
+//////////////////////////////////////////////////
+/// \brief Measure how the discovery scales with the number of processes and
+/// topics: time to converge, traffic and CPU.
+///
+/// All the simulated processes run inside this process, so the CPU column
+/// is the CPU of the whole benchmark divided by the number of processes.
+TEST(discoveryScaling, Convergence)
+{
+  TrafficCounter traffic;
+
+  std::cout << std::setw(6) << "procs"
+            << std::setw(8) << "topics"
+            << std::setw(16) << "converge (ms)"
+            << std::setw(16) << "converge (KB)"
+            << std::setw(16) << "steady (B/s)"
+            << std::setw(16) << "CPU/proc (%)"
+            << std::setw(16) << "late join (ms)" << std::endl;
+
+  for (const auto &scenario : kScenarios)
+  {
+    const ScenarioResult r =
+      runScenario(scenario.first, scenario.second, traffic);
+    std::cout << std::setw(6) << scenario.first
+              << std::setw(8) << scenario.second
+              << std::fixed << std::setprecision(1)
+              << std::setw(16) << r.convergence
+              << std::setw(16) << r.convergenceBytes / 1024.0
+              << std::setw(16) << r.steadyRate
+              << std::setw(16) << std::setprecision(2) << r.steadyCpu
+              << std::setw(16) << std::setprecision(1) << r.lateJoin
+              << std::endl;
+
+    // Let the processes of the previous scenario expire.
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+}
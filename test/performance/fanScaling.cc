@@ -0,0 +1,394 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include <gz/msgs/bytes.pb.h>
+#include <gz/msgs/stringmsg.pb.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "gz/transport/Node.hh"
+#include "gz/transport/TopicStatistics.hh"
+
+#include <gz/utils/Environment.hh>
+#include <gz/utils/Subprocess.hh>
+
+#include "test_config.hh"
+#include "test_utils.hh"
+
+using namespace gz;
+
+/// \brief Size of the messages (bytes).
+static const std::size_t kSize = 256;
+
+/// \brief Number of messages published by every publisher.
+static const int kMessages = 1000;
+
+/// \brief Maximum time to wait for the connections or the messages (ms).
+static const int kTimeout = 10000;
+
+/// \brief Partition of the benchmark.
+static std::string g_partition;  // NOLINT(*)
+
+//////////////////////////////////////////////////
+/// \brief A configuration of the benchmark.
+struct Scenario
+{
+  /// \brief Number of subscriber processes, 0 for subscribers in the
+  /// process of the publishers.
+  int processes;
+
+  /// \brief Number of publishers, each one with its own node and thread.
+  int publishers;
+
+  /// \brief Number of subscribers per process, each one subscribed to all
+  /// the topics.
+  int subscribers;
+
+  /// \brief Number of topics.
+  int topics;
+};
+
+//////////////////////////////////////////////////
+/// \brief Result of a subscriber.
+struct SubscriberResult
+{
+  /// \brief Number of messages received.
+  uint64_t count = 0;
+
+  /// \brief Median latency (ms).
+  double p50 = 0;
+
+  /// \brief 99th percentile of the latency (ms).
+  double p99 = 0;
+
+  /// \brief Time the last message was received (steady clock, ns).
+  int64_t lastNs = 0;
+};
+
+//////////////////////////////////////////////////
+/// \brief A subscriber in the process of the publishers, measuring the
+/// latency like benchSubscriber_aux does.
+struct LocalSubscriber
+{
+  /// \brief Node of the subscriber.
+  transport::Node node;
+
+  /// \brief Protects the members below.
+  std::mutex mutex;
+
+  /// \brief Topics from which a message was received.
+  std::set<std::string> topics;
+
+  /// \brief Latency of the messages (ms).
+  transport::LatencyHistogram latency;
+
+  /// \brief Time the last message was received (steady clock, ns).
+  int64_t lastNs = 0;
+};
+
+//////////////////////////////////////////////////
+/// \brief Current time of the steady clock, shared by all the processes.
+/// \return The time in nanoseconds.
+static int64_t nowNs()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//////////////////////////////////////////////////
+/// \brief Wait until a condition is true.
+/// \param[in] _cond The condition.
+/// \param[in] _each Called every 10 ms while waiting.
+/// \return True if the condition became true before kTimeout.
+static bool waitFor(const std::function<bool()> &_cond,
+  const std::function<void()> &_each = {})
+{
+  const auto deadline = std::chrono::steady_clock::now() +
+    std::chrono::milliseconds(kTimeout);
+  while (!_cond())
+  {
+    if (std::chrono::steady_clock::now() > deadline)
+      return false;
+    if (_each)
+      _each();
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+/// \brief Run a scenario and print its results.
+/// \param[in] _s The scenario.
+static void run(const Scenario &_s)
+{
+  std::vector<std::string> topics;
+  for (int t = 0; t < _s.topics; ++t)
+    topics.push_back("/fan_" + std::to_string(t));
+  const std::string type = msgs::Bytes().GetTypeName();
+
+  // Control topics of the subscriber processes.
+  transport::Node control;
+  std::mutex mutex;
+  std::set<std::string> readyIds;
+  std::vector<std::string> results;
+  std::function<void(const msgs::StringMsg &)> onReady =
+    [&](const msgs::StringMsg &_msg)
+  {
+    std::lock_guard<std::mutex> lk(mutex);
+    readyIds.insert(_msg.data());
+  };
+  std::function<void(const msgs::StringMsg &)> onResults =
+    [&](const msgs::StringMsg &_msg)
+  {
+    std::lock_guard<std::mutex> lk(mutex);
+    results.push_back(_msg.data());
+  };
+  ASSERT_TRUE(control.Subscribe("/fan_ready", onReady));
+  ASSERT_TRUE(control.Subscribe("/fan_results", onResults));
+  auto done = control.Advertise<msgs::StringMsg>("/fan_done");
+
+  // One node per publisher, as separate components of a process would do.
+  std::vector<std::unique_ptr<transport::Node>> pubNodes;
+  std::vector<std::vector<transport::Node::Publisher>> pubs(_s.publishers);
+  for (int p = 0; p < _s.publishers; ++p)
+  {
+    pubNodes.push_back(std::make_unique<transport::Node>());
+    for (const auto &topic : topics)
+      pubs[p].push_back(pubNodes.back()->Advertise<msgs::Bytes>(topic));
+  }
+
+  std::vector<std::unique_ptr<LocalSubscriber>> locals;
+  std::vector<std::unique_ptr<gz::utils::Subprocess>> procs;
+  if (_s.processes == 0)
+  {
+    for (int s = 0; s < _s.subscribers; ++s)
+    {
+      locals.push_back(std::make_unique<LocalSubscriber>());
+      LocalSubscriber *sub = locals.back().get();
+      transport::RawCallback cb = [sub](const char *_data,
+        const std::size_t _size, const transport::MessageInfo &_info)
+      {
+        const int64_t now = nowNs();
+        int64_t stamp = 0;
+        if (_size < sizeof(stamp))
+          return;
+        std::memcpy(&stamp, _data, sizeof(stamp));
+        std::lock_guard<std::mutex> lk(sub->mutex);
+        sub->topics.insert(_info.Topic());
+        if (stamp == 0)
+          return;
+        sub->latency.Update((now - stamp) / 1e6);
+        sub->lastNs = now;
+      };
+      for (const auto &topic : topics)
+        ASSERT_TRUE(sub->node.SubscribeRaw(topic, cb, type));
+    }
+  }
+  else
+  {
+    for (int i = 0; i < _s.processes; ++i)
+    {
+      procs.push_back(std::make_unique<gz::utils::Subprocess>(
+        std::vector<std::string>{test_executables::kBenchSubscriber,
+        g_partition, std::to_string(_s.topics),
+        std::to_string(_s.subscribers)}));
+    }
+  }
+
+  // Publish unstamped messages until every subscriber is connected to all
+  // the topics.
+  const std::string warmUp(kSize, '\0');
+  auto publishWarmUp = [&]
+  {
+    for (auto &topicPubs : pubs)
+      for (auto &pub : topicPubs)
+        pub.PublishRaw(warmUp, type);
+  };
+  auto connected = [&]
+  {
+    for (auto &sub : locals)
+    {
+      std::lock_guard<std::mutex> lk(sub->mutex);
+      if (sub->topics.size() < topics.size())
+        return false;
+    }
+    std::lock_guard<std::mutex> lk(mutex);
+    return static_cast<int>(readyIds.size()) >= _s.processes;
+  };
+  ASSERT_TRUE(waitFor(connected, publishWarmUp));
+  // Let the warm up messages in flight arrive.
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+  const int64_t start = nowNs();
+  std::vector<std::thread> threads;
+  for (int p = 0; p < _s.publishers; ++p)
+  {
+    threads.emplace_back([&, p]
+    {
+      std::string data(kSize, 'x');
+      for (int i = 0; i < kMessages; ++i)
+      {
+        const int64_t stamp = nowNs();
+        std::memcpy(&data[0], &stamp, sizeof(stamp));
+        pubs[p][(p + i) % _s.topics].PublishRaw(data, type);
+      }
+    });
+  }
+  for (auto &thread : threads)
+    thread.join();
+
+  const uint64_t perSubscriber =
+    static_cast<uint64_t>(_s.publishers) * kMessages;
+  std::vector<SubscriberResult> subResults;
+  if (_s.processes == 0)
+  {
+    // Messages may be dropped, only wait for the ones that arrive.
+    waitFor([&]
+    {
+      for (auto &sub : locals)
+      {
+        std::lock_guard<std::mutex> lk(sub->mutex);
+        if (sub->latency.Count() < perSubscriber)
+          return false;
+      }
+      return true;
+    });
+    for (auto &sub : locals)
+    {
+      std::lock_guard<std::mutex> lk(sub->mutex);
+      subResults.push_back({sub->latency.Count(), sub->latency.Percentile(50),
+        sub->latency.Percentile(99), sub->lastNs});
+    }
+  }
+  else
+  {
+    // The subscriber processes can't be observed, give them time to
+    // receive the messages in flight.
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+    msgs::StringMsg msg;
+    ASSERT_TRUE(waitFor([&]
+    {
+      std::lock_guard<std::mutex> lk(mutex);
+      return static_cast<int>(results.size()) >= _s.processes;
+    }, [&]{done.Publish(msg);}));
+    for (auto &proc : procs)
+      proc->Join();
+
+    std::lock_guard<std::mutex> lk(mutex);
+    for (const auto &result : results)
+    {
+      std::istringstream iss(result);
+      SubscriberResult subResult;
+      while (iss >> subResult.count >> subResult.p50 >> subResult.p99 >>
+             subResult.lastNs)
+      {
+        subResults.push_back(subResult);
+      }
+    }
+  }
+
+  uint64_t delivered = 0;
+  int64_t last = start;
+  double p50 = 0;
+  double worstP99 = 0;
+  for (const auto &subResult : subResults)
+  {
+    delivered += subResult.count;
+    last = std::max(last, subResult.lastNs);
+    p50 += subResult.p50;
+    worstP99 = std::max(worstP99, subResult.p99);
+  }
+  if (!subResults.empty())
+    p50 /= subResults.size();
+  const double expected = static_cast<double>(perSubscriber) *
+    std::max(_s.processes, 1) * _s.subscribers;
+  const double elapsed = std::max<int64_t>(last - start, 1) / 1e9;
+
+  std::ostringstream name;
+  name << _s.processes << "/" << _s.publishers << "/" << _s.subscribers
+       << "/" << _s.topics;
+  std::cout << std::left << std::setw(12) << name.str() << std::right
+            << std::fixed << std::setprecision(1)
+            << std::setw(12) << 100.0 * delivered / expected
+            << std::setw(14) << delivered / elapsed
+            << std::setw(12) << p50 * 1000
+            << std::setw(16) << worstP99 * 1000 << std::endl;
+  ::testing::Test::RecordProperty("fan_" + std::to_string(_s.processes) +
+    "_" + std::to_string(_s.publishers) + "_" +
+    std::to_string(_s.subscribers) + "_" + std::to_string(_s.topics) +
+    "_deliveries_per_sec", std::to_string(delivered / elapsed));
+  EXPECT_EQ(static_cast<int>(subResults.size()),
+    std::max(_s.processes, 1) * _s.subscribers);
+}
+
+//////////////////////////////////////////////////
+/// \brief Aggregate throughput and per subscriber latency when the number
+/// of publishers, subscribers, topics and processes grows. The deliveries
+/// of all the subscribers of a process go through its reception thread,
+/// and all the publishers of a process share its node and its mutex.
+TEST(fanScaling, FanInFanOut)
+{
+  // {processes, publishers, subscribers, topics}
+  const std::vector<Scenario> scenarios =
+  {
+    {0, 1, 1, 1},
+    {0, 4, 1, 1},
+    {0, 1, 8, 1},
+    {0, 4, 8, 4},
+    {0, 8, 8, 8},
+    {1, 1, 1, 1},
+    {1, 4, 1, 1},
+    {1, 1, 8, 1},
+    {1, 4, 4, 4},
+    {2, 4, 4, 4},
+    {4, 8, 8, 8},
+  };
+
+  std::cout << std::left << std::setw(12) << "P/pub/sub/T" << std::right
+            << std::setw(12) << "recv (%)"
+            << std::setw(14) << "deliveries/s"
+            << std::setw(12) << "p50 (us)"
+            << std::setw(16) << "worst p99 (us)" << std::endl;
+  for (const auto &scenario : scenarios)
+    run(scenario);
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  // Get a random partition name.
+  g_partition = testing::getRandomNumber();
+
+  // Set the partition name for this process.
+  gz::utils::setenv("GZ_PARTITION", g_partition);
+
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
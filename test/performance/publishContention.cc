@@ -0,0 +1,148 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include <gz/msgs/int32.pb.h>
+
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "gz/transport/Node.hh"
+
+#include <gz/utils/Environment.hh>
+
+#include "test_utils.hh"
+
+using namespace gz;
+
+/// \brief Number of messages published by each thread.
+static const int kMsgsPerThread = 20000;
+
+/// \brief Numbers of publishing threads.
+static const std::vector<int> kNumThreads = {1, 4, 16};
+
+//////////////////////////////////////////////////
+/// \brief Publish from several threads, each one on its own topic, while
+/// another thread keeps subscribing and unsubscribing.
+/// \param[in] _numThreads Number of publishing threads.
+/// \param[in] _withSubscribers Whether the published topics have a local
+/// subscriber.
+/// \return Mean publish latency in nanoseconds.
+static double publishLatency(int _numThreads, bool _withSubscribers)
+{
+  transport::Node node;
+  std::atomic<int> received{0};
+  std::function<void(const msgs::Int32 &)> cb =
+    [&received](const msgs::Int32 &)
+  {
+    ++received;
+  };
+
+  std::vector<transport::Node::Publisher> pubs;
+  for (int t = 0; t < _numThreads; ++t)
+  {
+    const std::string topic = "/contention_" + std::to_string(t);
+    pubs.push_back(node.Advertise<msgs::Int32>(topic));
+    EXPECT_TRUE(pubs.back());
+    if (_withSubscribers)
+      EXPECT_TRUE(node.Subscribe(topic, cb));
+  }
+
+  // Modify the subscriber tables while publishing.
+  std::atomic<bool> done{false};
+  std::thread writer([&]()
+  {
+    transport::Node otherNode;
+    while (!done)
+    {
+      otherNode.Subscribe("/contention_other", cb);
+      otherNode.Unsubscribe("/contention_other");
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  });
+
+  std::atomic<int64_t> elapsedNs{0};
+  std::vector<std::thread> publishers;
+  for (int t = 0; t < _numThreads; ++t)
+  {
+    publishers.emplace_back([&, t]()
+    {
+      msgs::Int32 msg;
+      const auto start = std::chrono::steady_clock::now();
+      for (int i = 0; i < kMsgsPerThread; ++i)
+      {
+        msg.set_data(i);
+        pubs[t].Publish(msg);
+      }
+      elapsedNs += std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    });
+  }
+
+  for (auto &p : publishers)
+    p.join();
+
+  done = true;
+  writer.join();
+
+  // Wait for the callbacks before destroying the node.
+  const int total = _numThreads * kMsgsPerThread;
+  if (_withSubscribers)
+  {
+    for (int i = 0; i < 100 && received < total; ++i)
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(total, received);
+  }
+
+  return static_cast<double>(elapsedNs) / total;
+}
+
+//////////////////////////////////////////////////
+/// \brief Measure how the publish latency scales with the number of
+/// publishing threads when the subscriptions change concurrently.
+TEST(publishContention, PublishLatency)
+{
+  std::cout << std::setw(10) << "threads"
+            << std::setw(20) << "no subs (ns)"
+            << std::setw(20) << "local subs (ns)" << std::endl;
+
+  for (int n : kNumThreads)
+  {
+    const double noSubs = publishLatency(n, false);
+    const double localSubs = publishLatency(n, true);
+    std::cout << std::setw(10) << n
+              << std::setw(20) << std::fixed << std::setprecision(1) << noSubs
+              << std::setw(20) << localSubs << std::endl;
+  }
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  // Get a random partition name.
+  std::string partition = testing::getRandomNumber();
+
+  // Set the partition name for this process.
+  gz::utils::setenv("GZ_PARTITION", partition);
+
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
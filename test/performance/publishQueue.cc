@@ -0,0 +1,448 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include <gz/msgs/bytes.pb.h>
+#include <gz/msgs/int32.pb.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "gz/transport/Node.hh"
+#include "gz/transport/TopicStatistics.hh"
+
+#include <gz/utils/Environment.hh>
+
+#include "MpscQueue.hh"
+#include "test_utils.hh"
+
+using namespace gz;
+
+/// \brief Number of messages published by each thread.
+static const int kMsgsPerThread = 20000;
+
+/// \brief Numbers of publishing threads.
+static const std::vector<int> kNumThreads = {1, 4, 16};
+
+/// \brief Sizes of the messages of the end to end benchmark (bytes).
+static const std::vector<std::size_t> kSizes =
+  {64, 1024, 64 * 1024, 1024 * 1024, 16 * 1024 * 1024};
+
+/// \brief Numbers of publishing threads of the end to end benchmark, less
+/// than kNumThreads because the large messages are queued by copy.
+static const std::vector<int> kNumSizeThreads = {1, 4};
+
+/// \brief Bytes published by each thread of the end to end benchmark, the
+/// number of messages is clamped to [8, 5000].
+static const std::size_t kBytesPerThread = 64 * 1024 * 1024;
+
+/// \brief Element pushed onto the queues.
+using Element = std::unique_ptr<int>;
+
+//////////////////////////////////////////////////
+/// \brief The publish queue used before the lock-free ring: a std::list
+/// protected by a mutex and a condition variable.
+class ListQueue
+{
+  public: void Push(Element _e)
+  {
+    {
+      std::lock_guard<std::mutex> lk(this->mutex);
+      this->queue.push_back(std::move(_e));
+    }
+    this->cv.notify_one();
+  }
+
+  public: bool Pop(Element &_e)
+  {
+    std::unique_lock<std::mutex> lk(this->mutex);
+    if (this->queue.empty())
+    {
+      this->cv.wait_for(lk, std::chrono::milliseconds(500),
+        [this]{return !this->queue.empty() || this->exit;});
+    }
+    if (this->queue.empty())
+      return false;
+    _e = std::move(this->queue.front());
+    this->queue.pop_front();
+    return true;
+  }
+
+  public: void Stop()
+  {
+    {
+      std::lock_guard<std::mutex> lk(this->mutex);
+      this->exit = true;
+    }
+    this->cv.notify_all();
+  }
+
+  private: std::mutex mutex;
+  private: std::condition_variable cv;
+  private: std::list<Element> queue;
+  private: bool exit = false;
+};
+
+//////////////////////////////////////////////////
+/// \brief The lock-free ring with a wakeup only when the consumer sleeps,
+/// as used by NodeShared.
+class RingQueue
+{
+  public: void Push(Element _e)
+  {
+    while (!this->queue.TryPush(_e))
+      std::this_thread::yield();
+
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (this->sleeping.load(std::memory_order_relaxed))
+    {
+      {
+        std::lock_guard<std::mutex> lk(this->mutex);
+      }
+      this->cv.notify_one();
+    }
+  }
+
+  public: bool Pop(Element &_e)
+  {
+    if (this->queue.TryPop(_e))
+      return true;
+
+    this->sleeping.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (this->queue.TryPop(_e))
+    {
+      this->sleeping.store(false, std::memory_order_relaxed);
+      return true;
+    }
+
+    std::unique_lock<std::mutex> lk(this->mutex);
+    this->cv.wait_for(lk, std::chrono::milliseconds(500),
+      [this]{return !this->queue.Empty() || this->exit;});
+    this->sleeping.store(false, std::memory_order_relaxed);
+    return false;
+  }
+
+  public: void Stop()
+  {
+    {
+      std::lock_guard<std::mutex> lk(this->mutex);
+      this->exit = true;
+    }
+    this->cv.notify_all();
+  }
+
+  private: transport::MpscQueue<Element> queue{4096};
+  private: std::atomic<bool> sleeping{false};
+  private: std::mutex mutex;
+  private: std::condition_variable cv;
+  private: bool exit = false;
+};
+
+//////////////////////////////////////////////////
+/// \brief Measure the mean time spent pushing an element.
+/// \param[in] _numThreads Number of producer threads.
+/// \return Mean push latency in nanoseconds.
+template <typename QueueT>
+double pushLatency(int _numThreads)
+{
+  QueueT queue;
+  std::atomic<int> received{0};
+  const int total = _numThreads * kMsgsPerThread;
+
+  std::thread consumer([&]()
+  {
+    Element e;
+    while (received < total)
+    {
+      if (queue.Pop(e))
+        ++received;
+    }
+  });
+
+  std::atomic<int64_t> elapsedNs{0};
+  std::vector<std::thread> producers;
+  for (int t = 0; t < _numThreads; ++t)
+  {
+    producers.emplace_back([&]()
+    {
+      const auto start = std::chrono::steady_clock::now();
+      for (int i = 0; i < kMsgsPerThread; ++i)
+        queue.Push(std::make_unique<int>(i));
+      elapsedNs += std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    });
+  }
+
+  for (auto &p : producers)
+    p.join();
+
+  queue.Stop();
+  consumer.join();
+  EXPECT_EQ(total, received);
+
+  return static_cast<double>(elapsedNs) / total;
+}
+
+//////////////////////////////////////////////////
+/// \brief Compare the publish-side latency of the list-based and the
+/// lock-free publish queues.
+TEST(publishQueue, PushLatency)
+{
+  std::cout << std::setw(10) << "threads"
+            << std::setw(16) << "list (ns)"
+            << std::setw(16) << "ring (ns)" << std::endl;
+
+  for (int n : kNumThreads)
+  {
+    const double list = pushLatency<ListQueue>(n);
+    const double ring = pushLatency<RingQueue>(n);
+    std::cout << std::setw(10) << n
+              << std::setw(16) << std::fixed << std::setprecision(1) << list
+              << std::setw(16) << ring << std::endl;
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief Measure the latency of Node::Publisher::Publish with a local
+/// subscriber when publishing from several threads.
+TEST(publishQueue, PublishLatency)
+{
+  std::cout << std::setw(10) << "threads"
+            << std::setw(16) << "publish (ns)" << std::endl;
+
+  for (int n : kNumThreads)
+  {
+    transport::Node node;
+    std::atomic<int> received{0};
+    std::function<void(const msgs::Int32 &)> cb =
+      [&received](const msgs::Int32 &)
+    {
+      ++received;
+    };
+
+    std::vector<transport::Node::Publisher> pubs;
+    for (int t = 0; t < n; ++t)
+    {
+      const std::string topic = "/bench_" + std::to_string(t);
+      pubs.push_back(node.Advertise<msgs::Int32>(topic));
+      ASSERT_TRUE(pubs.back());
+      ASSERT_TRUE(node.Subscribe(topic, cb));
+    }
+
+    std::atomic<int64_t> elapsedNs{0};
+    std::vector<std::thread> publishers;
+    for (int t = 0; t < n; ++t)
+    {
+      publishers.emplace_back([&, t]()
+      {
+        msgs::Int32 msg;
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < kMsgsPerThread; ++i)
+        {
+          msg.set_data(i);
+          pubs[t].Publish(msg);
+        }
+        elapsedNs += std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now() - start).count();
+      });
+    }
+
+    for (auto &p : publishers)
+      p.join();
+
+    // Wait for the callbacks before destroying the node.
+    const int total = n * kMsgsPerThread;
+    for (int i = 0; i < 100 && received < total; ++i)
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(total, received);
+
+    std::cout << std::setw(10) << n << std::setw(16) << std::fixed
+              << std::setprecision(1)
+              << static_cast<double>(elapsedNs) / total << std::endl;
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief Current time of the steady clock.
+/// \return The time in nanoseconds.
+static int64_t nowNs()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//////////////////////////////////////////////////
+/// \brief Result of the end to end benchmark.
+struct EndToEnd
+{
+  /// \brief Mean duration of a publish call (ns).
+  double publishNs = 0;
+
+  /// \brief Time from the publish call to the callback (ms).
+  transport::LatencyHistogram latency;
+};
+
+//////////////////////////////////////////////////
+/// \brief Publish stamped messages from several threads to subscribers of
+/// the same process, one topic per thread, and measure the duration of the
+/// publish calls and the time until the callbacks run.
+/// \param[in] _raw Use raw publishers and subscribers.
+/// \param[in] _size Size of the messages.
+/// \param[in] _numThreads Number of publishing threads.
+/// \return The result.
+static EndToEnd publishToCallback(bool _raw, std::size_t _size,
+  int _numThreads)
+{
+  EndToEnd result;
+  std::mutex mutex;
+  auto received = [&](const char *_data)
+  {
+    const int64_t now = nowNs();
+    int64_t stamp;
+    std::memcpy(&stamp, _data, sizeof(stamp));
+    std::lock_guard<std::mutex> lk(mutex);
+    result.latency.Update((now - stamp) / 1e6);
+  };
+  std::function<void(const msgs::Bytes &)> cb =
+    [&](const msgs::Bytes &_msg)
+  {
+    received(_msg.data().data());
+  };
+  transport::RawCallback rawCb = [&](const char *_data, const std::size_t,
+    const transport::MessageInfo &)
+  {
+    received(_data);
+  };
+
+  transport::Node node;
+  std::vector<transport::Node::Publisher> pubs;
+  const std::string type = msgs::Bytes().GetTypeName();
+  for (int t = 0; t < _numThreads; ++t)
+  {
+    const std::string topic = "/bench_e2e_" + std::to_string(t);
+    pubs.push_back(node.Advertise<msgs::Bytes>(topic));
+    if (_raw)
+      EXPECT_TRUE(node.SubscribeRaw(topic, rawCb, type));
+    else
+      EXPECT_TRUE(node.Subscribe(topic, cb));
+  }
+
+  const std::size_t count = std::clamp<std::size_t>(
+    kBytesPerThread / _size, 8, 5000);
+  std::atomic<int64_t> elapsedNs{0};
+  std::vector<std::thread> publishers;
+  for (int t = 0; t < _numThreads; ++t)
+  {
+    publishers.emplace_back([&, t]()
+    {
+      // The raw subscribers receive the buffer published, the typed ones a
+      // copy of the message: the stamp is at the start of both.
+      msgs::Bytes msg;
+      msg.set_data(std::string(std::max(_size, sizeof(int64_t)), 'x'));
+      std::string &data = *msg.mutable_data();
+      int64_t spent = 0;
+      for (std::size_t i = 0; i < count; ++i)
+      {
+        const int64_t stamp = nowNs();
+        std::memcpy(&data[0], &stamp, sizeof(stamp));
+        if (_raw)
+          pubs[t].PublishRaw(data, type);
+        else
+          pubs[t].Publish(msg);
+        spent += nowNs() - stamp;
+      }
+      elapsedNs += spent;
+    });
+  }
+  for (auto &p : publishers)
+    p.join();
+
+  // Wait for the callbacks before destroying the node.
+  const uint64_t total = count * _numThreads;
+  for (int i = 0; i < 200; ++i)
+  {
+    {
+      std::lock_guard<std::mutex> lk(mutex);
+      if (result.latency.Count() >= total)
+        break;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  }
+  std::lock_guard<std::mutex> lk(mutex);
+  EXPECT_EQ(total, result.latency.Count());
+  result.publishNs = static_cast<double>(elapsedNs) / total;
+  return result;
+}
+
+//////////////////////////////////////////////////
+/// \brief Cost of the publish call and time until the callback of a
+/// subscriber of the same process, through the publish queue and the
+/// publish thread, without any network, for typed and raw subscribers.
+TEST(publishQueue, PublishToCallback)
+{
+  std::cout << std::left << std::setw(8) << "mode" << std::right
+            << std::setw(10) << "size (B)"
+            << std::setw(10) << "threads"
+            << std::setw(16) << "publish (ns)"
+            << std::setw(12) << "p50 (us)"
+            << std::setw(12) << "p99 (us)" << std::endl;
+
+  for (bool raw : {false, true})
+  {
+    for (std::size_t size : kSizes)
+    {
+      for (int n : kNumSizeThreads)
+      {
+        const EndToEnd result = publishToCallback(raw, size, n);
+        std::cout << std::left << std::setw(8) << (raw ? "raw" : "typed")
+                  << std::right << std::setw(10) << size
+                  << std::setw(10) << n
+                  << std::fixed << std::setprecision(1)
+                  << std::setw(16) << result.publishNs
+                  << std::setw(12) << result.latency.Percentile(50) * 1000
+                  << std::setw(12) << result.latency.Percentile(99) * 1000
+                  << std::endl;
+      }
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  // Get a random partition name.
+  std::string partition = testing::getRandomNumber();
+
+  // Set the partition name for this process.
+  gz::utils::setenv("GZ_PARTITION", partition);
+
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
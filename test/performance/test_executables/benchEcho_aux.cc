@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include <gz/msgs/bytes.pb.h>
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "gz/transport/Node.hh"
+
+#include <gz/utils/Environment.hh>
+
+using namespace gz;
+
+//////////////////////////////////////////////////
+/// \brief Peer of the inter-process benchmarks: it echoes the messages
+/// published on /bench_ping and /bench_ping_raw to /bench_pong and
+/// /bench_pong_raw, and answers the /bench_echo service, until a message is
+/// published on /bench_quit.
+int main(int argc, char **argv)
+{
+  if (argc != 2)
+  {
+    std::cerr << "Partition name has not be passed as argument" << std::endl;
+    return -1;
+  }
+
+  // Set the partition name for this test.
+  gz::utils::setenv("GZ_PARTITION", argv[1]);
+
+  transport::Node node;
+  auto pong = node.Advertise<msgs::Bytes>("/bench_pong");
+  auto pongRaw = node.Advertise<msgs::Bytes>("/bench_pong_raw");
+
+  std::function<void(const msgs::Bytes &)> echo =
+    [&pong](const msgs::Bytes &_msg)
+  {
+    pong.Publish(_msg);
+  };
+  node.Subscribe("/bench_ping", echo);
+
+  transport::RawCallback echoRaw =
+    [&pongRaw](const char *_data, const std::size_t _size,
+               const transport::MessageInfo &_info)
+  {
+    pongRaw.PublishRaw(std::string(_data, _size), _info.Type());
+  };
+  node.SubscribeRaw("/bench_ping_raw", echoRaw);
+
+  std::function<bool(const msgs::Bytes &, msgs::Bytes &)> reply =
+    [](const msgs::Bytes &_req, msgs::Bytes &_rep)
+  {
+    _rep = _req;
+    return true;
+  };
+  node.Advertise("/bench_echo", reply);
+
+  std::atomic<bool> quit{false};
+  std::function<void(const msgs::Bytes &)> onQuit =
+    [&quit](const msgs::Bytes &)
+  {
+    quit = true;
+  };
+  node.Subscribe("/bench_quit", onQuit);
+
+  // Don't outlive a benchmark that crashed.
+  const auto deadline =
+    std::chrono::steady_clock::now() + std::chrono::minutes(10);
+  while (!quit && std::chrono::steady_clock::now() < deadline)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+}
@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include <gz/msgs/bytes.pb.h>
+#include <gz/msgs/stringmsg.pb.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gz/transport/Node.hh"
+#include "gz/transport/TopicStatistics.hh"
+
+#include <gz/utils/Environment.hh>
+
+using namespace gz;
+
+//////////////////////////////////////////////////
+/// \brief A subscriber measuring the latency of the messages it receives.
+struct Subscriber
+{
+  /// \brief Node of the subscriber.
+  transport::Node node;
+
+  /// \brief Protects latency and topics.
+  std::mutex mutex;
+
+  /// \brief Topics from which a message was received.
+  std::set<std::string> topics;
+
+  /// \brief Latency of the messages (ms).
+  transport::LatencyHistogram latency;
+
+  /// \brief Time the last message was received (steady clock, ns).
+  int64_t lastNs = 0;
+};
+
+//////////////////////////////////////////////////
+/// \brief Subscriber process of the fan-in/fan-out benchmark. Each of its
+/// subscribers subscribes to all the topics /fan_<i> and measures the
+/// latency of the messages, which start with the time they were published
+/// (steady clock, in nanoseconds, or 0 for the warm up messages). It
+/// publishes a random identifier on /fan_ready once connected. When a
+/// message is published on /fan_done, it publishes
+/// "<count> <p50> <p99> <last>" per subscriber on /fan_results, where last
+/// is the time the last message was received, and exits.
+/// Arguments: partition, number of topics, number of subscribers.
+int main(int argc, char **argv)
+{
+  if (argc != 4)
+  {
+    std::cerr << "Usage: benchSubscriber_aux <partition> <topics> "
+              << "<subscribers>" << std::endl;
+    return -1;
+  }
+
+  // Set the partition name for this test.
+  gz::utils::setenv("GZ_PARTITION", argv[1]);
+  const int numTopics = std::stoi(argv[2]);
+  const int numSubscribers = std::stoi(argv[3]);
+
+  std::vector<std::unique_ptr<Subscriber>> subscribers;
+  for (int s = 0; s < numSubscribers; ++s)
+  {
+    subscribers.push_back(std::make_unique<Subscriber>());
+    Subscriber *sub = subscribers.back().get();
+    transport::RawCallback cb = [sub](const char *_data,
+      const std::size_t _size, const transport::MessageInfo &_info)
+    {
+      const auto now = std::chrono::steady_clock::now().time_since_epoch();
+      int64_t stamp = 0;
+      if (_size < sizeof(stamp))
+        return;
+      std::memcpy(&stamp, _data, sizeof(stamp));
+      std::lock_guard<std::mutex> lk(sub->mutex);
+      sub->topics.insert(_info.Topic());
+      // The warm up messages aren't stamped.
+      if (stamp == 0)
+        return;
+      sub->latency.Update(std::chrono::duration<double, std::milli>(
+        now - std::chrono::nanoseconds(stamp)).count());
+      sub->lastNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        now).count();
+    };
+    for (int t = 0; t < numTopics; ++t)
+    {
+      sub->node.SubscribeRaw("/fan_" + std::to_string(t), cb,
+        msgs::Bytes().GetTypeName());
+    }
+  }
+
+  transport::Node node;
+  auto results = node.Advertise<msgs::StringMsg>("/fan_results");
+  auto ready = node.Advertise<msgs::StringMsg>("/fan_ready");
+  std::atomic<bool> done{false};
+  std::function<void(const msgs::StringMsg &)> onDone =
+    [&done](const msgs::StringMsg &)
+  {
+    done = true;
+  };
+  node.Subscribe("/fan_done", onDone);
+
+  // Tell the benchmark when every subscriber received the warm up messages
+  // of all the topics, so the publishers are connected.
+  auto allConnected = [&]
+  {
+    for (auto &sub : subscribers)
+    {
+      std::lock_guard<std::mutex> lk(sub->mutex);
+      if (static_cast<int>(sub->topics.size()) < numTopics)
+        return false;
+    }
+    return true;
+  };
+  const auto deadline =
+    std::chrono::steady_clock::now() + std::chrono::minutes(10);
+  msgs::StringMsg readyMsg;
+  readyMsg.set_data(std::to_string(std::random_device()()));
+  while (!done && std::chrono::steady_clock::now() < deadline)
+  {
+    if (allConnected())
+      ready.Publish(readyMsg);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+
+  std::ostringstream oss;
+  for (auto &sub : subscribers)
+  {
+    std::lock_guard<std::mutex> lk(sub->mutex);
+    oss << sub->latency.Count() << " " << sub->latency.Percentile(50) << " "
+        << sub->latency.Percentile(99) << " " << sub->lastNs << "\n";
+  }
+  msgs::StringMsg msg;
+  msg.set_data(oss.str());
+  results.Publish(msg);
+
+  // Let the results go out before the node is destroyed.
+  std::this_thread::sleep_for(std::chrono::milliseconds(500));
+}
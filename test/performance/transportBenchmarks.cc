@@ -0,0 +1,436 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include <gz/msgs/bytes.pb.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "gz/transport/Node.hh"
+#include "gz/transport/TopicStatistics.hh"
+
+#include <gz/utils/Environment.hh>
+#include <gz/utils/Subprocess.hh>
+
+#include "test_config.hh"
+#include "test_utils.hh"
+
+using namespace gz;
+
+/// \brief Sizes of the messages (bytes) of every benchmark, so the results
+/// of two releases can be compared.
+static const std::vector<std::size_t> kSizes =
+  {64, 1024, 16 * 1024, 256 * 1024, 1024 * 1024};
+
+/// \brief Number of round trips measured per message size.
+static const int kRoundTrips = 200;
+
+/// \brief Number of bytes published to measure the throughput, the number
+/// of messages is clamped to [kMinMsgs, kMaxMsgs].
+static const std::size_t kThroughputBytes = 64 * 1024 * 1024;
+
+/// \brief Minimum number of messages to measure the throughput.
+static const std::size_t kMinMsgs = 50;
+
+/// \brief Maximum number of messages to measure the throughput.
+static const std::size_t kMaxMsgs = 5000;
+
+/// \brief Maximum time to wait for a message or a response (ms).
+static const int kTimeout = 5000;
+
+/// \brief Partition of the benchmarks.
+static std::string g_partition;  // NOLINT(*)
+
+/// \brief Suffix of the names of the results, "_busy" when measured with
+/// GZ_TRANSPORT_BUSY_POLL, to compare them with the blocking ones.
+static std::string g_suffix;  // NOLINT(*)
+
+//////////////////////////////////////////////////
+/// \brief Result of a benchmark for a message size.
+struct BenchResult
+{
+  /// \brief Name of the benchmark.
+  std::string name;
+
+  /// \brief Size of the messages (bytes).
+  std::size_t size = 0;
+
+  /// \brief Round trip times (ms).
+  transport::LatencyHistogram latency;
+
+  /// \brief Messages per second, 0 if not measured.
+  double msgsPerSec = 0;
+};
+
+//////////////////////////////////////////////////
+/// \brief Report a result: print it, record it as properties of the test,
+/// which --gtest_output=json|xml writes, and append it as a JSON line to
+/// the file GZ_TRANSPORT_BENCH_OUTPUT when set.
+/// \param[in] _result The result.
+static void report(const BenchResult &_result)
+{
+  const std::string name = _result.name + g_suffix;
+  const double p50 = _result.latency.Percentile(50) * 1000;
+  const double p99 = _result.latency.Percentile(99) * 1000;
+  const double mbPerSec = _result.msgsPerSec * _result.size / 1e6;
+
+  std::cout << std::left << std::setw(24) << name << std::right
+            << std::setw(10) << _result.size
+            << std::fixed << std::setprecision(1)
+            << std::setw(12) << p50
+            << std::setw(12) << p99
+            << std::setw(14) << _result.msgsPerSec
+            << std::setw(12) << mbPerSec << std::endl;
+
+  const std::string key = name + "_" + std::to_string(_result.size);
+  ::testing::Test::RecordProperty(key + "_p50_us", std::to_string(p50));
+  ::testing::Test::RecordProperty(key + "_p99_us", std::to_string(p99));
+  if (_result.msgsPerSec > 0)
+  {
+    ::testing::Test::RecordProperty(key + "_msgs_per_sec",
+      std::to_string(_result.msgsPerSec));
+  }
+
+  std::string output;
+  if (!gz::utils::env("GZ_TRANSPORT_BENCH_OUTPUT", output) || output.empty())
+    return;
+  std::ofstream file(output, std::ios::app);
+  file << "{\"benchmark\":\"" << name << "\""
+       << ",\"size\":" << _result.size
+       << ",\"p50_us\":" << p50
+       << ",\"p99_us\":" << p99
+       << ",\"msgs_per_sec\":" << _result.msgsPerSec
+       << ",\"mb_per_sec\":" << mbPerSec << "}" << std::endl;
+}
+
+//////////////////////////////////////////////////
+/// \brief Print the header of the results.
+static void printHeader()
+{
+  std::cout << std::left << std::setw(24) << "benchmark" << std::right
+            << std::setw(10) << "size (B)"
+            << std::setw(12) << "p50 (us)"
+            << std::setw(12) << "p99 (us)"
+            << std::setw(14) << "msgs/s"
+            << std::setw(12) << "MB/s" << std::endl;
+}
+
+//////////////////////////////////////////////////
+/// \brief Number of messages published to measure the throughput.
+/// \param[in] _size Size of the messages.
+/// \return The number of messages.
+static std::size_t throughputMsgs(std::size_t _size)
+{
+  return std::clamp(kThroughputBytes / _size, kMinMsgs, kMaxMsgs);
+}
+
+//////////////////////////////////////////////////
+/// \brief Counts the messages received by a subscription.
+class Receiver
+{
+  /// \brief Count a message.
+  public: void Received()
+  {
+    {
+      std::lock_guard<std::mutex> lk(this->mutex);
+      ++this->count;
+    }
+    this->condition.notify_all();
+  }
+
+  /// \brief Wait until a number of messages were received.
+  /// \param[in] _count Number of messages.
+  /// \return True if they were received before the timeout.
+  public: bool WaitFor(std::size_t _count)
+  {
+    std::unique_lock<std::mutex> lk(this->mutex);
+    return this->condition.wait_for(lk, std::chrono::milliseconds(kTimeout),
+      [&]{return this->count >= _count;});
+  }
+
+  /// \brief Get the number of messages received.
+  /// \return The number of messages.
+  public: std::size_t Count()
+  {
+    std::lock_guard<std::mutex> lk(this->mutex);
+    return this->count;
+  }
+
+  /// \brief Protects count.
+  private: std::mutex mutex;
+
+  /// \brief Signaled when a message is received.
+  private: std::condition_variable condition;
+
+  /// \brief Number of messages received.
+  private: std::size_t count = 0;
+};
+
+//////////////////////////////////////////////////
+/// \brief Measure the round trip time and the throughput of a topic.
+/// \param[in] _name Name of the benchmark.
+/// \param[in] _size Size of the messages.
+/// \param[in] _publish Publish a message.
+/// \param[in] _receiver Counts the messages coming back.
+/// \return The result.
+static BenchResult pingPong(const std::string &_name, std::size_t _size,
+  const std::function<void()> &_publish, Receiver &_receiver)
+{
+  BenchResult result;
+  result.name = _name;
+  result.size = _size;
+
+  std::size_t expected = _receiver.Count();
+  for (int i = 0; i < kRoundTrips; ++i)
+  {
+    const auto start = std::chrono::steady_clock::now();
+    _publish();
+    if (!_receiver.WaitFor(++expected))
+    {
+      ADD_FAILURE() << _name << ": no response for size " << _size;
+      return result;
+    }
+    result.latency.Update(std::chrono::duration<double, std::milli>(
+      std::chrono::steady_clock::now() - start).count());
+  }
+
+  const std::size_t before = _receiver.Count();
+  const std::size_t count = throughputMsgs(_size);
+  const auto start = std::chrono::steady_clock::now();
+  for (std::size_t i = 0; i < count; ++i)
+    _publish();
+  // Messages may be dropped by the send queues, only count what arrived.
+  _receiver.WaitFor(before + count);
+  const double elapsed = std::chrono::duration<double>(
+    std::chrono::steady_clock::now() - start).count();
+  result.msgsPerSec = (_receiver.Count() - before) / elapsed;
+  return result;
+}
+
+//////////////////////////////////////////////////
+/// \brief Measure the round trip time of a service.
+/// \param[in] _name Name of the benchmark.
+/// \param[in] _node Node making the requests.
+/// \param[in] _service Service echoing the requests.
+/// \param[in] _size Size of the requests.
+/// \return The result.
+static BenchResult requestLatency(const std::string &_name,
+  transport::Node &_node, const std::string &_service, std::size_t _size)
+{
+  BenchResult result;
+  result.name = _name;
+  result.size = _size;
+
+  msgs::Bytes req;
+  req.set_data(std::string(_size, 'x'));
+  msgs::Bytes rep;
+  bool ok = false;
+  // The first request connects to the responser.
+  EXPECT_TRUE(_node.Request(_service, req, kTimeout, rep, ok));
+
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < kRoundTrips; ++i)
+  {
+    const auto reqStart = std::chrono::steady_clock::now();
+    if (!_node.Request(_service, req, kTimeout, rep, ok) || !ok)
+    {
+      ADD_FAILURE() << _name << ": request failed for size " << _size;
+      return result;
+    }
+    result.latency.Update(std::chrono::duration<double, std::milli>(
+      std::chrono::steady_clock::now() - reqStart).count());
+  }
+  result.msgsPerSec = kRoundTrips / std::chrono::duration<double>(
+    std::chrono::steady_clock::now() - start).count();
+  return result;
+}
+
+//////////////////////////////////////////////////
+/// \brief Typed and raw publications to subscribers of the same process.
+TEST(transportBenchmarks, IntraProcess)
+{
+  printHeader();
+  transport::Node node;
+  Receiver typed;
+  std::function<void(const msgs::Bytes &)> cb =
+    [&typed](const msgs::Bytes &)
+  {
+    typed.Received();
+  };
+  Receiver raw;
+  transport::RawCallback rawCb =
+    [&raw](const char *, const std::size_t, const transport::MessageInfo &)
+  {
+    raw.Received();
+  };
+  auto pub = node.Advertise<msgs::Bytes>("/bench_intra");
+  auto pubRaw = node.Advertise<msgs::Bytes>("/bench_intra_raw");
+  ASSERT_TRUE(node.Subscribe("/bench_intra", cb));
+  ASSERT_TRUE(node.SubscribeRaw("/bench_intra_raw", rawCb,
+    msgs::Bytes().GetTypeName()));
+
+  for (std::size_t size : kSizes)
+  {
+    msgs::Bytes msg;
+    msg.set_data(std::string(size, 'x'));
+    report(pingPong("intra_typed", size, [&]{pub.Publish(msg);}, typed));
+
+    const std::string data = msg.SerializeAsString();
+    report(pingPong("intra_raw", size,
+      [&]{pubRaw.PublishRaw(data, msg.GetTypeName());}, raw));
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief Typed and raw publications echoed by another process, and the
+/// time to discover a topic of another process.
+TEST(transportBenchmarks, InterProcess)
+{
+  auto peer = gz::utils::Subprocess(
+    {test_executables::kBenchEcho, g_partition});
+
+  printHeader();
+  transport::Node node;
+  Receiver typed;
+  std::function<void(const msgs::Bytes &)> cb =
+    [&typed](const msgs::Bytes &)
+  {
+    typed.Received();
+  };
+  Receiver raw;
+  transport::RawCallback rawCb =
+    [&raw](const char *, const std::size_t, const transport::MessageInfo &)
+  {
+    raw.Received();
+  };
+  auto pub = node.Advertise<msgs::Bytes>("/bench_ping");
+  auto pubRaw = node.Advertise<msgs::Bytes>("/bench_ping_raw");
+  auto quit = node.Advertise<msgs::Bytes>("/bench_quit");
+  ASSERT_TRUE(node.Subscribe("/bench_pong", cb));
+  ASSERT_TRUE(node.SubscribeRaw("/bench_pong_raw", rawCb,
+    msgs::Bytes().GetTypeName()));
+
+  // Wait for the connections in both directions.
+  msgs::Bytes probe;
+  for (int i = 0; i < kTimeout && typed.Count() == 0; ++i)
+  {
+    pub.Publish(probe);
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  for (int i = 0; i < kTimeout && raw.Count() == 0; ++i)
+  {
+    pubRaw.PublishRaw(probe.SerializeAsString(), probe.GetTypeName());
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  ASSERT_GT(typed.Count(), 0u);
+  ASSERT_GT(raw.Count(), 0u);
+  // Let the echoes of the probes arrive.
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  for (std::size_t size : kSizes)
+  {
+    msgs::Bytes msg;
+    msg.set_data(std::string(size, 'x'));
+    report(pingPong("inter_typed", size, [&]{pub.Publish(msg);}, typed));
+
+    const std::string data = msg.SerializeAsString();
+    report(pingPong("inter_raw", size,
+      [&]{pubRaw.PublishRaw(data, msg.GetTypeName());}, raw));
+  }
+
+  // Time for a new node to receive the messages of a topic of the peer:
+  // discovery of the publisher and connection.
+  BenchResult discovery;
+  discovery.name = "inter_discovery";
+  for (int i = 0; i < 10; ++i)
+  {
+    transport::Node newNode;
+    Receiver received;
+    std::function<void(const msgs::Bytes &)> newCb =
+      [&received](const msgs::Bytes &)
+    {
+      received.Received();
+    };
+    const auto start = std::chrono::steady_clock::now();
+    ASSERT_TRUE(newNode.Subscribe("/bench_pong", newCb));
+    for (int j = 0; j < kTimeout && received.Count() == 0; ++j)
+    {
+      pub.Publish(probe);
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_GT(received.Count(), 0u);
+    discovery.latency.Update(std::chrono::duration<double, std::milli>(
+      std::chrono::steady_clock::now() - start).count());
+  }
+  report(discovery);
+
+  for (std::size_t size : kSizes)
+    report(requestLatency("inter_service", node, "/bench_echo", size));
+
+  quit.Publish(probe);
+  peer.Join();
+}
+
+//////////////////////////////////////////////////
+/// \brief Requests to a responser of the same process.
+TEST(transportBenchmarks, IntraProcessService)
+{
+  printHeader();
+  transport::Node node;
+  std::function<bool(const msgs::Bytes &, msgs::Bytes &)> reply =
+    [](const msgs::Bytes &_req, msgs::Bytes &_rep)
+  {
+    _rep = _req;
+    return true;
+  };
+  ASSERT_TRUE(node.Advertise("/bench_intra_echo", reply));
+
+  for (std::size_t size : kSizes)
+    report(requestLatency("intra_service", node, "/bench_intra_echo", size));
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  // Get a random partition name.
+  g_partition = testing::getRandomNumber();
+
+  // Set the partition name for this process.
+  gz::utils::setenv("GZ_PARTITION", g_partition);
+
+  // The busy polling applies to this process and to its peers.
+  std::string busyPoll;
+  if (gz::utils::env("GZ_TRANSPORT_BUSY_POLL", busyPoll) &&
+      !busyPoll.empty() && busyPoll != "0")
+  {
+    g_suffix = "_busy";
+  }
+
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}